@@ -44,6 +44,7 @@ CREATE TABLE device_%deviceid_songs (
   filetype INTEGER NOT NULL DEFAULT 0,
   filesize INTEGER NOT NULL DEFAULT -1,
   mtime INTEGER NOT NULL DEFAULT -1,
+  content_hash TEXT,
   ctime INTEGER NOT NULL DEFAULT -1,
   unavailable INTEGER DEFAULT 0,
 
@@ -60,6 +61,10 @@ CREATE TABLE device_%deviceid_songs (
   compilation_effective INTEGER NOT NULL DEFAULT 0,
 
   art_embedded INTEGER DEFAULT 0,
+  art_embedded_size INTEGER NOT NULL DEFAULT -1,
+  art_embedded_width INTEGER NOT NULL DEFAULT -1,
+  art_embedded_height INTEGER NOT NULL DEFAULT -1,
+  art_embedded_hash TEXT,
   art_automatic TEXT,
   art_manual TEXT,
   art_unset INTEGER DEFAULT 0,
@@ -0,0 +1,6 @@
+CREATE TABLE IF NOT EXISTS scan_journal (
+  directory_id INTEGER NOT NULL,
+  path TEXT NOT NULL
+);
+
+UPDATE schema_version SET version=19;
@@ -0,0 +1,9 @@
+ALTER TABLE %allsongstables ADD COLUMN art_embedded_size INTEGER NOT NULL DEFAULT -1;
+
+ALTER TABLE %allsongstables ADD COLUMN art_embedded_width INTEGER NOT NULL DEFAULT -1;
+
+ALTER TABLE %allsongstables ADD COLUMN art_embedded_height INTEGER NOT NULL DEFAULT -1;
+
+ALTER TABLE %allsongstables ADD COLUMN art_embedded_hash TEXT;
+
+UPDATE schema_version SET version=21;
@@ -0,0 +1,13 @@
+CREATE TABLE IF NOT EXISTS cover_provider_lookups (
+  provider TEXT NOT NULL,
+  artist TEXT NOT NULL,
+  album TEXT NOT NULL,
+  title TEXT NOT NULL,
+  results TEXT,
+  duration INTEGER NOT NULL DEFAULT 0,
+  time INTEGER NOT NULL DEFAULT 0
+);
+
+CREATE UNIQUE INDEX IF NOT EXISTS idx_cover_provider_lookups ON cover_provider_lookups (provider, artist, album, title);
+
+UPDATE schema_version SET version=22;
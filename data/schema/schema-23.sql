@@ -0,0 +1,11 @@
+CREATE TABLE IF NOT EXISTS album_art (
+  directory TEXT NOT NULL,
+  path TEXT NOT NULL,
+  hash TEXT NOT NULL,
+  width INTEGER NOT NULL DEFAULT -1,
+  height INTEGER NOT NULL DEFAULT -1
+);
+
+CREATE UNIQUE INDEX IF NOT EXISTS idx_album_art_directory ON album_art (directory);
+
+UPDATE schema_version SET version=23;
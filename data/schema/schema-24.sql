@@ -0,0 +1,8 @@
+CREATE TABLE IF NOT EXISTS subsonic_albums (
+  album_id TEXT NOT NULL,
+  signature TEXT NOT NULL
+);
+
+CREATE UNIQUE INDEX IF NOT EXISTS idx_subsonic_albums_album_id ON subsonic_albums (album_id);
+
+UPDATE schema_version SET version=24;
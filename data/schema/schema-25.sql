@@ -0,0 +1,11 @@
+CREATE TABLE IF NOT EXISTS lyrics_lookups (
+  artist TEXT NOT NULL,
+  title TEXT NOT NULL,
+  provider TEXT,
+  lyrics TEXT,
+  time INTEGER NOT NULL DEFAULT 0
+);
+
+CREATE UNIQUE INDEX IF NOT EXISTS idx_lyrics_lookups ON lyrics_lookups (artist, title);
+
+UPDATE schema_version SET version=25;
@@ -0,0 +1,3 @@
+CREATE INDEX IF NOT EXISTS idx_fingerprint ON songs (fingerprint);
+
+UPDATE schema_version SET version=26;
@@ -0,0 +1,3 @@
+ALTER TABLE scan_journal ADD COLUMN scan_started INTEGER NOT NULL DEFAULT 0;
+
+UPDATE schema_version SET version=27;
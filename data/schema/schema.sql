@@ -4,7 +4,7 @@ CREATE TABLE IF NOT EXISTS schema_version (
 
 DELETE FROM schema_version;
 
-INSERT INTO schema_version (version) VALUES (18);
+INSERT INTO schema_version (version) VALUES (27);
 
 CREATE TABLE IF NOT EXISTS directories (
   path TEXT NOT NULL,
@@ -17,6 +17,22 @@ CREATE TABLE IF NOT EXISTS subdirectories (
   mtime INTEGER NOT NULL
 );
 
+CREATE TABLE IF NOT EXISTS scan_journal (
+  directory_id INTEGER NOT NULL,
+  path TEXT NOT NULL,
+  scan_started INTEGER NOT NULL DEFAULT 0
+);
+
+CREATE TABLE IF NOT EXISTS album_art (
+  directory TEXT NOT NULL,
+  path TEXT NOT NULL,
+  hash TEXT NOT NULL,
+  width INTEGER NOT NULL DEFAULT -1,
+  height INTEGER NOT NULL DEFAULT -1
+);
+
+CREATE UNIQUE INDEX IF NOT EXISTS idx_album_art_directory ON album_art (directory);
+
 CREATE TABLE IF NOT EXISTS songs (
 
   title TEXT,
@@ -52,6 +68,7 @@ CREATE TABLE IF NOT EXISTS songs (
   filetype INTEGER NOT NULL DEFAULT 0,
   filesize INTEGER NOT NULL DEFAULT -1,
   mtime INTEGER NOT NULL DEFAULT -1,
+  content_hash TEXT,
   ctime INTEGER NOT NULL DEFAULT -1,
   unavailable INTEGER DEFAULT 0,
 
@@ -68,6 +85,10 @@ CREATE TABLE IF NOT EXISTS songs (
   compilation_effective INTEGER NOT NULL DEFAULT 0,
 
   art_embedded INTEGER DEFAULT 0,
+  art_embedded_size INTEGER NOT NULL DEFAULT -1,
+  art_embedded_width INTEGER NOT NULL DEFAULT -1,
+  art_embedded_height INTEGER NOT NULL DEFAULT -1,
+  art_embedded_hash TEXT,
   art_automatic TEXT,
   art_manual TEXT,
   art_unset INTEGER DEFAULT 0,
@@ -133,6 +154,7 @@ CREATE TABLE IF NOT EXISTS subsonic_songs (
   filetype INTEGER NOT NULL DEFAULT 0,
   filesize INTEGER NOT NULL DEFAULT -1,
   mtime INTEGER NOT NULL DEFAULT -1,
+  content_hash TEXT,
   ctime INTEGER NOT NULL DEFAULT -1,
   unavailable INTEGER DEFAULT 0,
 
@@ -149,6 +171,10 @@ CREATE TABLE IF NOT EXISTS subsonic_songs (
   compilation_effective INTEGER NOT NULL DEFAULT 0,
 
   art_embedded INTEGER DEFAULT 0,
+  art_embedded_size INTEGER NOT NULL DEFAULT -1,
+  art_embedded_width INTEGER NOT NULL DEFAULT -1,
+  art_embedded_height INTEGER NOT NULL DEFAULT -1,
+  art_embedded_hash TEXT,
   art_automatic TEXT,
   art_manual TEXT,
   art_unset INTEGER DEFAULT 0,
@@ -179,6 +205,13 @@ CREATE TABLE IF NOT EXISTS subsonic_songs (
 
 );
 
+CREATE TABLE IF NOT EXISTS subsonic_albums (
+  album_id TEXT NOT NULL,
+  signature TEXT NOT NULL
+);
+
+CREATE UNIQUE INDEX IF NOT EXISTS idx_subsonic_albums_album_id ON subsonic_albums (album_id);
+
 CREATE TABLE IF NOT EXISTS tidal_artists_songs (
 
   title TEXT,
@@ -214,6 +247,7 @@ CREATE TABLE IF NOT EXISTS tidal_artists_songs (
   filetype INTEGER NOT NULL DEFAULT 0,
   filesize INTEGER NOT NULL DEFAULT -1,
   mtime INTEGER NOT NULL DEFAULT -1,
+  content_hash TEXT,
   ctime INTEGER NOT NULL DEFAULT -1,
   unavailable INTEGER DEFAULT 0,
 
@@ -230,6 +264,10 @@ CREATE TABLE IF NOT EXISTS tidal_artists_songs (
   compilation_effective INTEGER NOT NULL DEFAULT 0,
 
   art_embedded INTEGER DEFAULT 0,
+  art_embedded_size INTEGER NOT NULL DEFAULT -1,
+  art_embedded_width INTEGER NOT NULL DEFAULT -1,
+  art_embedded_height INTEGER NOT NULL DEFAULT -1,
+  art_embedded_hash TEXT,
   art_automatic TEXT,
   art_manual TEXT,
   art_unset INTEGER DEFAULT 0,
@@ -295,6 +333,7 @@ CREATE TABLE IF NOT EXISTS tidal_albums_songs (
   filetype INTEGER NOT NULL DEFAULT 0,
   filesize INTEGER NOT NULL DEFAULT -1,
   mtime INTEGER NOT NULL DEFAULT -1,
+  content_hash TEXT,
   ctime INTEGER NOT NULL DEFAULT -1,
   unavailable INTEGER DEFAULT 0,
 
@@ -311,6 +350,10 @@ CREATE TABLE IF NOT EXISTS tidal_albums_songs (
   compilation_effective INTEGER NOT NULL DEFAULT 0,
 
   art_embedded INTEGER DEFAULT 0,
+  art_embedded_size INTEGER NOT NULL DEFAULT -1,
+  art_embedded_width INTEGER NOT NULL DEFAULT -1,
+  art_embedded_height INTEGER NOT NULL DEFAULT -1,
+  art_embedded_hash TEXT,
   art_automatic TEXT,
   art_manual TEXT,
   art_unset INTEGER DEFAULT 0,
@@ -376,6 +419,7 @@ CREATE TABLE IF NOT EXISTS tidal_songs (
   filetype INTEGER NOT NULL DEFAULT 0,
   filesize INTEGER NOT NULL DEFAULT -1,
   mtime INTEGER NOT NULL DEFAULT -1,
+  content_hash TEXT,
   ctime INTEGER NOT NULL DEFAULT -1,
   unavailable INTEGER DEFAULT 0,
 
@@ -392,6 +436,10 @@ CREATE TABLE IF NOT EXISTS tidal_songs (
   compilation_effective INTEGER NOT NULL DEFAULT 0,
 
   art_embedded INTEGER DEFAULT 0,
+  art_embedded_size INTEGER NOT NULL DEFAULT -1,
+  art_embedded_width INTEGER NOT NULL DEFAULT -1,
+  art_embedded_height INTEGER NOT NULL DEFAULT -1,
+  art_embedded_hash TEXT,
   art_automatic TEXT,
   art_manual TEXT,
   art_unset INTEGER DEFAULT 0,
@@ -457,6 +505,7 @@ CREATE TABLE IF NOT EXISTS qobuz_artists_songs (
   filetype INTEGER NOT NULL DEFAULT 0,
   filesize INTEGER NOT NULL DEFAULT -1,
   mtime INTEGER NOT NULL DEFAULT -1,
+  content_hash TEXT,
   ctime INTEGER NOT NULL DEFAULT -1,
   unavailable INTEGER DEFAULT 0,
 
@@ -473,6 +522,10 @@ CREATE TABLE IF NOT EXISTS qobuz_artists_songs (
   compilation_effective INTEGER NOT NULL DEFAULT 0,
 
   art_embedded INTEGER DEFAULT 0,
+  art_embedded_size INTEGER NOT NULL DEFAULT -1,
+  art_embedded_width INTEGER NOT NULL DEFAULT -1,
+  art_embedded_height INTEGER NOT NULL DEFAULT -1,
+  art_embedded_hash TEXT,
   art_automatic TEXT,
   art_manual TEXT,
   art_unset INTEGER DEFAULT 0,
@@ -538,6 +591,7 @@ CREATE TABLE IF NOT EXISTS qobuz_albums_songs (
   filetype INTEGER NOT NULL DEFAULT 0,
   filesize INTEGER NOT NULL DEFAULT -1,
   mtime INTEGER NOT NULL DEFAULT -1,
+  content_hash TEXT,
   ctime INTEGER NOT NULL DEFAULT -1,
   unavailable INTEGER DEFAULT 0,
 
@@ -554,6 +608,10 @@ CREATE TABLE IF NOT EXISTS qobuz_albums_songs (
   compilation_effective INTEGER NOT NULL DEFAULT 0,
 
   art_embedded INTEGER DEFAULT 0,
+  art_embedded_size INTEGER NOT NULL DEFAULT -1,
+  art_embedded_width INTEGER NOT NULL DEFAULT -1,
+  art_embedded_height INTEGER NOT NULL DEFAULT -1,
+  art_embedded_hash TEXT,
   art_automatic TEXT,
   art_manual TEXT,
   art_unset INTEGER DEFAULT 0,
@@ -619,6 +677,7 @@ CREATE TABLE IF NOT EXISTS qobuz_songs (
   filetype INTEGER NOT NULL DEFAULT 0,
   filesize INTEGER NOT NULL DEFAULT -1,
   mtime INTEGER NOT NULL DEFAULT -1,
+  content_hash TEXT,
   ctime INTEGER NOT NULL DEFAULT -1,
   unavailable INTEGER DEFAULT 0,
 
@@ -635,6 +694,10 @@ CREATE TABLE IF NOT EXISTS qobuz_songs (
   compilation_effective INTEGER NOT NULL DEFAULT 0,
 
   art_embedded INTEGER DEFAULT 0,
+  art_embedded_size INTEGER NOT NULL DEFAULT -1,
+  art_embedded_width INTEGER NOT NULL DEFAULT -1,
+  art_embedded_height INTEGER NOT NULL DEFAULT -1,
+  art_embedded_hash TEXT,
   art_automatic TEXT,
   art_manual TEXT,
   art_unset INTEGER DEFAULT 0,
@@ -720,6 +783,7 @@ CREATE TABLE IF NOT EXISTS playlist_items (
   filetype INTEGER,
   filesize INTEGER,
   mtime INTEGER,
+  content_hash TEXT,
   ctime INTEGER,
   unavailable INTEGER DEFAULT 0,
 
@@ -736,6 +800,10 @@ CREATE TABLE IF NOT EXISTS playlist_items (
   compilation_effective INTEGER DEFAULT 0,
 
   art_embedded INTEGER DEFAULT 0,
+  art_embedded_size INTEGER NOT NULL DEFAULT -1,
+  art_embedded_width INTEGER NOT NULL DEFAULT -1,
+  art_embedded_height INTEGER NOT NULL DEFAULT -1,
+  art_embedded_hash TEXT,
   art_automatic TEXT,
   art_manual TEXT,
   art_unset INTEGER DEFAULT 0,
@@ -783,8 +851,30 @@ CREATE TABLE IF NOT EXISTS radio_channels (
   thumbnail_url TEXT
 );
 
+CREATE TABLE IF NOT EXISTS cover_provider_lookups (
+  provider TEXT NOT NULL,
+  artist TEXT NOT NULL,
+  album TEXT NOT NULL,
+  title TEXT NOT NULL,
+  results TEXT,
+  duration INTEGER NOT NULL DEFAULT 0,
+  time INTEGER NOT NULL DEFAULT 0
+);
+
+CREATE TABLE IF NOT EXISTS lyrics_lookups (
+  artist TEXT NOT NULL,
+  title TEXT NOT NULL,
+  provider TEXT,
+  lyrics TEXT,
+  time INTEGER NOT NULL DEFAULT 0
+);
+
 CREATE INDEX IF NOT EXISTS idx_url ON songs (url);
 
+CREATE UNIQUE INDEX IF NOT EXISTS idx_cover_provider_lookups ON cover_provider_lookups (provider, artist, album, title);
+
+CREATE UNIQUE INDEX IF NOT EXISTS idx_lyrics_lookups ON lyrics_lookups (artist, title);
+
 CREATE INDEX IF NOT EXISTS idx_comp_artist ON songs (compilation_effective, artist);
 
 CREATE INDEX IF NOT EXISTS idx_albumartist ON songs (albumartist);
@@ -795,6 +885,8 @@ CREATE INDEX IF NOT EXISTS idx_album ON songs (album);
 
 CREATE INDEX IF NOT EXISTS idx_title ON songs (title);
 
+CREATE INDEX IF NOT EXISTS idx_fingerprint ON songs (fingerprint);
+
 CREATE VIEW IF NOT EXISTS duplicated_songs as select artist dup_artist, album dup_album, title dup_title from songs as inner_songs where artist != '' and album != '' and title != '' and unavailable = 0 group by artist, album , title having count(*) > 1;
 
 CREATE VIRTUAL TABLE IF NOT EXISTS songs_fts USING fts5(
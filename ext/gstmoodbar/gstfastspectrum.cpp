@@ -108,7 +108,14 @@ static void gst_fastspectrum_class_init(GstFastSpectrumClass *klass) {
   gst_audio_filter_class_add_pad_templates(filter_class, caps);
   gst_caps_unref(caps);
 
-  klass->fftw_lock = new QMutex;
+  klass->fftw_lock = gst_fastspectrum_fftw_lock();
+}
+
+QMutex *gst_fastspectrum_fftw_lock(void) {
+
+  static QMutex fftw_lock;
+  return &fftw_lock;
+
 }
 
 static void gst_fastspectrum_init(GstFastSpectrum *spectrum) {
@@ -91,6 +91,9 @@ struct GstFastSpectrumClass {
 
 GType gst_fastspectrum_get_type(void);
 
+// FFTW plans are created and destroyed under this lock, it's shared with the analyzers.
+QMutex *gst_fastspectrum_fftw_lock(void);
+
 G_END_DECLS
 
 #endif  // GST_MOODBAR_FASTSPECTRUM_H
@@ -31,6 +31,8 @@
 #include <QLocalSocket>
 #include <QAbstractSocket>
 
+#include <google/protobuf/arena.h>
+
 #include "core/messagereply.h"
 
 class QIODevice;
@@ -50,6 +52,10 @@ class _MessageHandlerBase : public QObject {
   // After this is true, messages cannot be sent to the handler any more.
   bool is_device_closed() const { return is_device_closed_; }
 
+ signals:
+  // Emitted after a reply to one of our requests has arrived.
+  void ReplyArrived();
+
  protected slots:
   void WriteMessage(const QByteArray &data);
   void DeviceReadyRead();
@@ -100,6 +106,9 @@ class AbstractMessageHandler : public _MessageHandlerBase {
   // Sets the "id" field of reply to the same as the request, and sends the reply on the socket.  Used on the worker side.
   void SendReply(const MessageType &request, MessageType *reply);
 
+  // Returns the number of requests still waiting for a reply.
+  int pending_reply_count() const { return static_cast<int>(pending_replies_.count()); }
+
  protected:
   // Called when a message is received from the socket.
   virtual void MessageArrived(const MessageType &message) { Q_UNUSED(message); }
@@ -145,18 +154,21 @@ void AbstractMessageHandler<MT>::SendReply(const MessageType &request, MessageTy
 template<typename MT>
 bool AbstractMessageHandler<MT>::RawMessageArrived(const QByteArray &data) {
 
-  MessageType message;
-  if (!message.ParseFromArray(data.constData(), data.size())) {
+  // Parse into an arena, so a big message with many nested messages and strings is freed at once.
+  google::protobuf::Arena arena;
+  MessageType *message = google::protobuf::Arena::Create<MessageType>(&arena);
+  if (!message->ParseFromArray(data.constData(), static_cast<int>(data.size()))) {
     return false;
   }
 
-  if (pending_replies_.contains(message.id())) {
+  if (pending_replies_.contains(message->id())) {
     // This is a reply to a message that we created earlier.
-    ReplyType *reply = pending_replies_.take(message.id());
-    reply->SetReply(message);
+    ReplyType *reply = pending_replies_.take(message->id());
+    reply->SetReply(*message);
+    emit ReplyArrived();
   }
   else {
-    MessageArrived(message);
+    MessageArrived(*message);
   }
 
   return true;
@@ -24,7 +24,7 @@
 #include "core/logging.h"
 
 _MessageReplyBase::_MessageReplyBase(QObject *parent)
-    : QObject(parent), finished_(false), success_(false) {}
+    : QObject(parent), finished_(false), success_(false), cancelled_(0) {}
 
 bool _MessageReplyBase::WaitForFinished() {
 
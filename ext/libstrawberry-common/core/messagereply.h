@@ -21,6 +21,7 @@
 
 #include <QtGlobal>
 #include <QObject>
+#include <QAtomicInt>
 #include <QSemaphore>
 #include <QString>
 #include <QTimer>
@@ -45,12 +46,18 @@ class _MessageReplyBase : public QObject {
 
   void Abort();
 
+  // Marks the request as no longer needed.  If it hasn't been sent yet, it's dropped and aborted instead.
+  // Can be called from any thread.
+  void Cancel() { cancelled_.storeRelease(1); }
+  bool is_cancelled() const { return cancelled_.loadAcquire() != 0; }
+
  signals:
   void Finished();
 
  protected:
   bool finished_;
   bool success_;
+  QAtomicInt cancelled_;
 
   QSemaphore semaphore_;
 };
@@ -0,0 +1,123 @@
+/* This file is part of Strawberry.
+
+   Strawberry is free software: you can redistribute it and/or modify
+   it under the terms of the GNU General Public License as published by
+   the Free Software Foundation, either version 3 of the License, or
+   (at your option) any later version.
+
+   Strawberry is distributed in the hope that it will be useful,
+   but WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+   GNU General Public License for more details.
+
+   You should have received a copy of the GNU General Public License
+   along with Strawberry.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#include <QtGlobal>
+#include <QIODevice>
+#include <QDir>
+#include <QFile>
+#include <QFileInfo>
+#include <QTemporaryFile>
+#include <QStandardPaths>
+#include <QDateTime>
+#include <QByteArray>
+#include <QString>
+#include <QStringList>
+
+#include "core/logging.h"
+#include "sharedpayload.h"
+
+namespace {
+constexpr char kFilenamePrefix[] = "strawberry-payload-";
+constexpr qint64 kStaleAgeSecs = 3600;
+}  // namespace
+
+const qint64 SharedPayload::kMinimumSize = 256 * 1024;
+
+SharedPayload::SharedPayload(const QString &filename) : data_(nullptr), size_(0) {
+
+  // Only touch files that look like payloads, the name comes from another process.
+  if (!IsPayloadFilename(filename)) {
+    qLog(Error) << "Ignoring invalid payload filename" << filename;
+    return;
+  }
+
+  file_.setFileName(filename);
+  if (!file_.open(QIODevice::ReadOnly)) {
+    qLog(Error) << "Failed to open payload" << filename << file_.errorString();
+    return;
+  }
+
+  size_ = file_.size();
+  if (size_ > 0) {
+    data_ = file_.map(0, size_);
+    if (!data_) {
+      qLog(Error) << "Failed to map payload" << filename << file_.errorString();
+      size_ = 0;
+    }
+  }
+
+}
+
+SharedPayload::~SharedPayload() {
+
+  if (data_) file_.unmap(data_);
+  if (file_.isOpen()) file_.close();
+  if (!file_.fileName().isEmpty() && IsPayloadFilename(file_.fileName())) {
+    file_.remove();
+  }
+
+}
+
+QString SharedPayload::Directory() {
+
+  QString directory = QStandardPaths::writableLocation(QStandardPaths::RuntimeLocation);
+  if (directory.isEmpty()) {
+    directory = QDir::tempPath();
+  }
+  return directory;
+
+}
+
+bool SharedPayload::IsPayloadFilename(const QString &filename) {
+
+  const QFileInfo fileinfo(filename);
+  return fileinfo.fileName().startsWith(QLatin1String(kFilenamePrefix)) && QDir(fileinfo.absolutePath()) == QDir(Directory());
+
+}
+
+QString SharedPayload::Write(const QByteArray &data) {
+
+  QTemporaryFile file(Directory() + QLatin1Char('/') + QLatin1String(kFilenamePrefix) + QStringLiteral("XXXXXX"));
+  file.setAutoRemove(false);
+  if (!file.open()) {
+    qLog(Error) << "Failed to create payload" << file.errorString();
+    return QString();
+  }
+
+  if (file.write(data) != data.size()) {
+    qLog(Error) << "Failed to write payload" << file.fileName() << file.errorString();
+    file.remove();
+    return QString();
+  }
+  file.close();
+
+  return file.fileName();
+
+}
+
+void SharedPayload::RemoveStale() {
+
+  QDir dir(Directory());
+  const QDateTime now = QDateTime::currentDateTime();
+  const QStringList filenames = dir.entryList(QStringList() << QLatin1String(kFilenamePrefix) + QLatin1Char('*'), QDir::Files);
+  for (const QString &filename : filenames) {
+    const QFileInfo fileinfo(dir.filePath(filename));
+    if (fileinfo.lastModified().secsTo(now) > kStaleAgeSecs) {
+      QFile::remove(fileinfo.absoluteFilePath());
+    }
+  }
+
+}
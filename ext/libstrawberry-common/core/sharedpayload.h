@@ -0,0 +1,59 @@
+/* This file is part of Strawberry.
+
+   Strawberry is free software: you can redistribute it and/or modify
+   it under the terms of the GNU General Public License as published by
+   the Free Software Foundation, either version 3 of the License, or
+   (at your option) any later version.
+
+   Strawberry is distributed in the hope that it will be useful,
+   but WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+   GNU General Public License for more details.
+
+   You should have received a copy of the GNU General Public License
+   along with Strawberry.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#ifndef SHAREDPAYLOAD_H
+#define SHAREDPAYLOAD_H
+
+#include <QtGlobal>
+#include <QByteArray>
+#include <QString>
+#include <QFile>
+
+// Large message payloads, passed to the other process as a file in the runtime directory instead of over the socket.
+// The runtime directory is normally a tmpfs, so the data stays in memory.
+// The sender writes the file and sends its name, the receiver maps it, uses the data in place and removes the file.
+class SharedPayload {
+ public:
+  // Payloads smaller than this are cheaper to send in the message itself.
+  static const qint64 kMinimumSize;
+
+  // Maps the payload written by the other process, the file is removed when this is destroyed.
+  explicit SharedPayload(const QString &filename);
+  ~SharedPayload();
+
+  bool is_valid() const { return data_ != nullptr; }
+  const uchar *data() const { return data_; }
+  qint64 size() const { return size_; }
+
+  // Returns the name of the file to send, or an empty string if it couldn't be written.
+  static QString Write(const QByteArray &data);
+
+  // Removes payloads left behind by a process that crashed before they were received.
+  static void RemoveStale();
+
+ private:
+  static QString Directory();
+  static bool IsPayloadFilename(const QString &filename);
+
+ private:
+  QFile file_;
+  uchar *data_;
+  qint64 size_;
+
+  Q_DISABLE_COPY(SharedPayload)
+};
+
+#endif  // SHAREDPAYLOAD_H
@@ -24,6 +24,7 @@
 #include <cstdio>
 #include <cstddef>
 #include <utility>
+#include <initializer_list>
 
 #include <QtGlobal>
 #include <QObject>
@@ -31,7 +32,9 @@
 #include <QThread>
 #include <QMutex>
 #include <QLocalServer>
+#include <QLocalSocket>
 #include <QProcess>
+#include <QTimer>
 #include <QDir>
 #include <QFile>
 #include <QList>
@@ -52,6 +55,14 @@ class _WorkerPoolBase : public QObject {
  public:
   explicit _WorkerPoolBase(QObject *parent = nullptr);
 
+  // Interactive requests are for something the user is waiting on, they are sent first and don't wait for a free worker.
+  // Playback requests are for the current playlist and playing song, they are sent before background requests like scans.
+  enum class Priority {
+    Interactive,
+    Playback,
+    Background
+  };
+
  signals:
   // Emitted when a worker failed to start.  This usually happens when the worker wasn't found, or couldn't be executed.
   void WorkerFailedToStart();
@@ -63,6 +74,7 @@ class _WorkerPoolBase : public QObject {
   virtual void ProcessReadyReadStandardError() {}
   virtual void ProcessError(QProcess::ProcessError) {}
   virtual void SendQueuedMessages() {}
+  virtual void StopIdleWorkers() {}
 };
 
 
@@ -70,6 +82,8 @@ class _WorkerPoolBase : public QObject {
 // A local socket server is started for each process, and the address is passed to the process as argv[1].
 // The process is expected to connect back to the socket server, and when it does a HandlerType is created for it.
 // Instances of HandlerType are created in the WorkerPool's thread.
+// Each request goes to the worker with the fewest requests in flight, and only a few are sent to a worker at a time so the rest can wait in the pool's queues.
+// More workers are started while the queue is backed up, up to the maximum, and stopped again when they have been idle for a while.
 template<typename HandlerType>
 class WorkerPool : public _WorkerPoolBase {
  public:
@@ -83,9 +97,15 @@ class WorkerPool : public _WorkerPoolBase {
   // You must call this before calling Start().
   void SetExecutableName(const QString &executable_name);
 
-  // Sets the number of worker process to use.  Defaults to 1 <= (processors / 2) <= 2.
+  // Sets the number of worker process that are always running.  Defaults to 1.
   void SetWorkerCount(const int count);
 
+  // Sets the number of worker processes that can run while there is a backlog.  Defaults to the worker count.
+  void SetMaxWorkerCount(const int count);
+
+  // Returns the maximum number of worker processes.
+  int worker_count() const { return qMax(worker_count_, max_worker_count_); }
+
   // Sets the prefix to use for the local server (on unix this is a named pipe in /tmp).
   // Defaults to QApplication::applicationName().
   // A random number is appended to this name when creating each server.
@@ -96,8 +116,10 @@ class WorkerPool : public _WorkerPoolBase {
 
   // Fills in the message's "id" field and creates a reply future.
   // The message is queued and the WorkerPool's thread will send it to the next available worker.
+  // Messages are sent in order of priority, and in the order they were queued within the same priority.
+  // Messages whose reply has been cancelled before they were sent are dropped.
   // Can be called from any thread.
-  ReplyType *SendMessageWithReply(MessageType *message);
+  ReplyType *SendMessageWithReply(MessageType *message, const Priority priority = Priority::Interactive);
 
  protected:
   // These are all reimplemented slots, they are called on the WorkerPool's thread.
@@ -107,20 +129,38 @@ class WorkerPool : public _WorkerPoolBase {
   void ProcessReadyReadStandardError() override;
   void ProcessError(QProcess::ProcessError error) override;
   void SendQueuedMessages() override;
+  void StopIdleWorkers() override;
 
  private:
+  // Keep the worker busy while the next reply is on its way, but leave the rest in our queues.
+  static constexpr int kMaxPendingRequestsPerWorker = 2;
+  // Extra workers are stopped after being idle for this many checks in a row.
+  static constexpr int kIdleCheckIntervalMsec = 10000;
+  static constexpr int kIdleChecksBeforeStop = 3;
+
   struct Worker {
-    Worker() : local_server_(nullptr), local_socket_(nullptr), process_(nullptr), handler_(nullptr) {}
+    Worker() : local_server_(nullptr), local_socket_(nullptr), process_(nullptr), handler_(nullptr), idle_checks_(0) {}
 
     QLocalServer *local_server_;
     QLocalSocket *local_socket_;
     QProcess *process_;
     HandlerType *handler_;
+    // Number of idle timer checks in a row where the worker had nothing to do.
+    int idle_checks_;
   };
 
   // Must only ever be called on my thread.
   void StartOneWorker(Worker *worker);
 
+  // Sends the queued messages that fit, dropping cancelled ones.  Must be called from my thread with the queues locked.
+  void SendMessagesFromQueue(QQueue<ReplyType*> *queue, const bool ignore_limit);
+
+  // Starts another worker if the queue is backed up and we're below the maximum.  Must be called from my thread with the queues locked.
+  void MaybeStartExtraWorker();
+
+  // Closes the socket of a worker and lets the process exit.  Must be called from my thread.
+  void StopWorker(const Worker &worker);
+
   template<typename T>
   Worker *FindWorker(T Worker::*member, T value) {
     for (typename QList<Worker>::iterator it = workers_.begin(); it != workers_.end(); ++it) {
@@ -143,8 +183,10 @@ class WorkerPool : public _WorkerPoolBase {
   // and sets the request's ID to the ID of the reply.  Can be called from any thread
   ReplyType *NewReply(MessageType *message);
 
-  // Returns the next handler, or nullptr if there isn't one.  Must be called from my thread.
-  HandlerType *NextHandler() const;
+  // Returns the connected handler with the fewest pending replies.
+  // Unless ignore_limit is set, handlers that already have the maximum number of pending replies are skipped.
+  // Returns nullptr if there isn't one.  Must be called from my thread.
+  HandlerType *NextHandler(const bool ignore_limit) const;
 
  private:
   QString local_server_name_;
@@ -152,13 +194,17 @@ class WorkerPool : public _WorkerPoolBase {
   QString executable_path_;
 
   int worker_count_;
+  int max_worker_count_;
   mutable int next_worker_;
   QList<Worker> workers_;
+  QTimer *idle_timer_;
 
   QAtomicInt next_id_;
 
   QMutex message_queue_mutex_;
-  QQueue<ReplyType *> message_queue_;
+  QQueue<ReplyType*> interactive_message_queue_;
+  QQueue<ReplyType*> playback_message_queue_;
+  QQueue<ReplyType*> message_queue_;
 };
 
 
@@ -166,7 +212,9 @@ template<typename HandlerType>
 WorkerPool<HandlerType>::WorkerPool(QObject *parent)
     : _WorkerPoolBase(parent),
       worker_count_(1),
+      max_worker_count_(0),
       next_worker_(0),
+      idle_timer_(nullptr),
       next_id_(0) {
 
   local_server_name_ = qApp->applicationName().toLower();
@@ -202,8 +250,10 @@ WorkerPool<HandlerType>::~WorkerPool() {
     }
   }
 
-  for (ReplyType *reply : message_queue_) {
-    reply->Abort();
+  for (QQueue<ReplyType*> *queue : { &interactive_message_queue_, &playback_message_queue_, &message_queue_ }) {
+    for (ReplyType *reply : std::as_const(*queue)) {
+      reply->Abort();
+    }
   }
 
 }
@@ -214,6 +264,12 @@ void WorkerPool<HandlerType>::SetWorkerCount(const int count) {
   worker_count_ = count;
 }
 
+template<typename HandlerType>
+void WorkerPool<HandlerType>::SetMaxWorkerCount(const int count) {
+  Q_ASSERT(workers_.isEmpty());
+  max_worker_count_ = count;
+}
+
 template<typename HandlerType>
 void WorkerPool<HandlerType>::SetLocalServerName(const QString &local_server_name) {
   Q_ASSERT(workers_.isEmpty());
@@ -272,6 +328,13 @@ void WorkerPool<HandlerType>::DoStart() {
     workers_ << worker;
   }
 
+  if (max_worker_count_ > worker_count_) {
+    idle_timer_ = new QTimer(this);
+    idle_timer_->setInterval(kIdleCheckIntervalMsec);
+    QObject::connect(idle_timer_, &QTimer::timeout, this, &WorkerPool::StopIdleWorkers);
+    idle_timer_->start();
+  }
+
 }
 
 template<typename HandlerType>
@@ -336,6 +399,7 @@ void WorkerPool<HandlerType>::NewConnection() {
 
   // Create the handler.
   worker->handler_ = new HandlerType(worker->local_socket_, this);
+  QObject::connect(worker->handler_, &_MessageHandlerBase::ReplyArrived, this, &WorkerPool::SendQueuedMessages);
 
   SendQueuedMessages();
 
@@ -408,14 +472,24 @@ WorkerPool<HandlerType>::NewReply(MessageType *message) {
 
 template <typename HandlerType>
 typename WorkerPool<HandlerType>::ReplyType*
-WorkerPool<HandlerType>::SendMessageWithReply(MessageType *message) {
+WorkerPool<HandlerType>::SendMessageWithReply(MessageType *message, const Priority priority) {
 
   ReplyType *reply = NewReply(message);
 
   // Add the pending reply to the queue
   {
     QMutexLocker l(&message_queue_mutex_);
-    message_queue_.enqueue(reply);
+    switch (priority) {
+      case Priority::Interactive:
+        interactive_message_queue_.enqueue(reply);
+        break;
+      case Priority::Playback:
+        playback_message_queue_.enqueue(reply);
+        break;
+      case Priority::Background:
+        message_queue_.enqueue(reply);
+        break;
+    }
   }
 
   // Wake up the main thread
@@ -430,36 +504,120 @@ void WorkerPool<HandlerType>::SendQueuedMessages() {
 
   QMutexLocker l(&message_queue_mutex_);
 
-  while (!message_queue_.isEmpty()) {
-    ReplyType *reply = message_queue_.dequeue();
+  // Interactive messages don't wait for a free slot, they go straight to the least busy worker.
+  SendMessagesFromQueue(&interactive_message_queue_, true);
+  SendMessagesFromQueue(&playback_message_queue_, false);
+  if (playback_message_queue_.isEmpty()) {
+    SendMessagesFromQueue(&message_queue_, false);
+  }
+
+  MaybeStartExtraWorker();
 
-    // Find a worker for this message
-    HandlerType *handler = NextHandler();
-    if (!handler) {
-      // No available handlers - put the message on the front of the queue.
-      message_queue_.prepend(reply);
-      qLog(Debug) << "No available handlers to process request";
-      break;
+}
+
+template<typename HandlerType>
+void WorkerPool<HandlerType>::SendMessagesFromQueue(QQueue<ReplyType*> *queue, const bool ignore_limit) {
+
+  while (!queue->isEmpty()) {
+    if (queue->head()->is_cancelled()) {
+      queue->dequeue()->Abort();
+      continue;
+    }
+    HandlerType *handler = NextHandler(ignore_limit);
+    if (!handler) break;
+    handler->SendRequest(queue->dequeue());
+  }
+
+}
+
+template<typename HandlerType>
+void WorkerPool<HandlerType>::MaybeStartExtraWorker() {
+
+  if ((message_queue_.isEmpty() && playback_message_queue_.isEmpty()) || workers_.isEmpty() || workers_.count() >= max_worker_count_) return;
+
+  // Only start one worker at a time, wait for it to connect before deciding if we need another.
+  for (const Worker &worker : std::as_const(workers_)) {
+    if (!worker.handler_) return;
+  }
+
+  qLog(Debug) << "Starting extra worker for" << message_queue_.count() + playback_message_queue_.count() << "queued requests";
+
+  Worker worker;
+  StartOneWorker(&worker);
+  workers_ << worker;
+
+}
+
+template<typename HandlerType>
+void WorkerPool<HandlerType>::StopIdleWorkers() {
+
+  Q_ASSERT(QThread::currentThread() == thread());
+
+  QMutexLocker l(&message_queue_mutex_);
+
+  for (int i = static_cast<int>(workers_.count()) - 1; i >= 0; --i) {
+    Worker &worker = workers_[i];
+    if (!worker.handler_ || worker.handler_->pending_reply_count() > 0 || !message_queue_.isEmpty() || !playback_message_queue_.isEmpty()) {
+      worker.idle_checks_ = 0;
+      continue;
+    }
+    ++worker.idle_checks_;
+    if (workers_.count() > worker_count_ && worker.idle_checks_ >= kIdleChecksBeforeStop) {
+      qLog(Debug) << "Stopping idle worker" << &worker;
+      StopWorker(worker);
+      workers_.removeAt(i);
     }
+  }
+
+}
+
+template<typename HandlerType>
+void WorkerPool<HandlerType>::StopWorker(const Worker &worker) {
+
+  Q_ASSERT(QThread::currentThread() == thread());
 
-    handler->SendRequest(reply);
+  // Don't restart the worker when it exits.
+  QObject::disconnect(worker.process_, &QProcess::errorOccurred, this, &WorkerPool::ProcessError);
+  QObject::connect(worker.process_, QOverload<int, QProcess::ExitStatus>::of(&QProcess::finished), worker.process_, &QObject::deleteLater);
+
+  // The server is normally destroyed when the worker connects, but make sure it doesn't stay listening.
+  if (worker.local_server_) {
+    worker.local_server_->close();
+    worker.local_server_->deleteLater();
+  }
+
+  // The worker exits when its socket is closed.
+  if (worker.handler_) worker.handler_->deleteLater();
+  if (worker.local_socket_) {
+    worker.local_socket_->close();
+    worker.local_socket_->deleteLater();
   }
 
 }
 
 template<typename HandlerType>
-HandlerType *WorkerPool<HandlerType>::NextHandler() const {
+HandlerType *WorkerPool<HandlerType>::NextHandler(const bool ignore_limit) const {
 
-  for (int i = 0; i < workers_.count(); ++i) {
-    const int worker_index = (next_worker_ + i) % workers_.count();
+  HandlerType *next_handler = nullptr;
+  int next_worker_index = 0;
 
-    if (workers_[worker_index].handler_ && !workers_[worker_index].handler_->is_device_closed()) {
-      next_worker_ = (worker_index + 1) % workers_.count();
-      return workers_[worker_index].handler_;
+  // Start at the worker after the last one we used, so equally busy workers take turns.
+  for (int i = 0; i < workers_.count(); ++i) {
+    const int worker_index = (next_worker_ + i) % static_cast<int>(workers_.count());
+    HandlerType *handler = workers_[worker_index].handler_;
+    if (!handler || handler->is_device_closed()) continue;
+    if (!ignore_limit && handler->pending_reply_count() >= kMaxPendingRequestsPerWorker) continue;
+    if (!next_handler || handler->pending_reply_count() < next_handler->pending_reply_count()) {
+      next_handler = handler;
+      next_worker_index = worker_index;
     }
   }
 
-  return nullptr;
+  if (next_handler) {
+    next_worker_ = (next_worker_index + 1) % static_cast<int>(workers_.count());
+  }
+
+  return next_handler;
 
 }
 
@@ -25,6 +25,9 @@
 #include <QFile>
 #include <QBuffer>
 #include <QImage>
+#include <QImageReader>
+#include <QSize>
+#include <QCryptographicHash>
 #include <QMimeDatabase>
 
 #include "core/logging.h"
@@ -145,3 +148,26 @@ TagReaderBase::Cover TagReaderBase::LoadCoverFromRequest(const QString &song_fil
   return Cover();
 
 }
+
+void TagReaderBase::SetEmbeddedArtInfo(const QByteArray &data, spb::tagreader::SongMetadata *song) {
+
+  if (data.isEmpty()) return;
+
+  song->set_art_embedded_size(data.size());
+
+  QBuffer buffer;
+  buffer.setData(data);
+  if (buffer.open(QIODevice::ReadOnly)) {
+    QImageReader image_reader(&buffer);
+    const QSize size = image_reader.size();
+    if (size.isValid()) {
+      song->set_art_embedded_width(size.width());
+      song->set_art_embedded_height(size.height());
+    }
+    buffer.close();
+  }
+
+  const QByteArray hash = QCryptographicHash::hash(data, QCryptographicHash::Sha1).toHex();
+  song->set_art_embedded_hash(hash.constData(), hash.size());
+
+}
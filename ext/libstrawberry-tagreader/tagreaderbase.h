@@ -34,7 +34,7 @@
 class TagReaderBase {
  public:
   explicit TagReaderBase();
-  ~TagReaderBase();
+  virtual ~TagReaderBase();
 
   class Cover {
    public:
@@ -46,7 +46,9 @@ class TagReaderBase {
 
   virtual bool IsMediaFile(const QString &filename) const = 0;
 
-  virtual bool ReadFile(const QString &filename, spb::tagreader::SongMetadata *song) const = 0;
+  using ReadLevel = spb::tagreader::ReadFileRequest_ReadLevel;
+
+  virtual bool ReadFile(const QString &filename, spb::tagreader::SongMetadata *song, const ReadLevel read_level = spb::tagreader::ReadFileRequest::FULL) const = 0;
   virtual bool SaveFile(const spb::tagreader::SaveFileRequest &request) const = 0;
 
   virtual QByteArray LoadEmbeddedArt(const QString &filename) const = 0;
@@ -61,6 +63,9 @@ class TagReaderBase {
   static Cover LoadCoverFromRequest(const spb::tagreader::SaveFileRequest &request);
   static Cover LoadCoverFromRequest(const spb::tagreader::SaveEmbeddedArtRequest &request);
 
+  // Records the size, dimensions and SHA-1 of embedded cover data in the song, reading only the image header.
+  static void SetEmbeddedArtInfo(const QByteArray &data, spb::tagreader::SongMetadata *song);
+
  private:
   static Cover LoadCoverFromRequest(const QString &song_filename, const QString &cover_filename, QByteArray cover_data, QString cover_mime_type);
 
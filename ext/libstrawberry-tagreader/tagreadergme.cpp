@@ -19,6 +19,8 @@
 
 #include "tagreadergme.h"
 
+#include <algorithm>
+
 #include <tag.h>
 #include <apefile.h>
 
@@ -27,6 +29,10 @@
 #include <QChar>
 #include <QFileInfo>
 #include <QFile>
+#include <QDir>
+#include <QDateTime>
+#include <QStringList>
+#include <QUrl>
 #include <QTextStream>
 
 #include "utilities/timeconstants.h"
@@ -36,12 +42,12 @@
 #include "tagreadertaglib.h"
 
 bool GME::IsSupportedFormat(const QFileInfo &file_info) {
-  return file_info.exists() && (file_info.completeSuffix().endsWith(QLatin1String("spc"), Qt::CaseInsensitive) || file_info.completeSuffix().endsWith(QLatin1String("vgm")), Qt::CaseInsensitive);
+  return file_info.exists() && (file_info.completeSuffix().endsWith(QLatin1String("spc"), Qt::CaseInsensitive) || file_info.completeSuffix().endsWith(QLatin1String("vgm"), Qt::CaseInsensitive));
 }
 
 bool GME::ReadFile(const QFileInfo &file_info, spb::tagreader::SongMetadata *song_info) {
 
-  if (file_info.completeSuffix().endsWith(QLatin1String("spc")), Qt::CaseInsensitive) {
+  if (file_info.completeSuffix().endsWith(QLatin1String("spc"), Qt::CaseInsensitive)) {
     SPC::Read(file_info, song_info);
     return true;
   }
@@ -54,6 +60,24 @@ bool GME::ReadFile(const QFileInfo &file_info, spb::tagreader::SongMetadata *son
 
 }
 
+void GME::ReadDirectory(const QString &path, spb::tagreader::ReadDirectoryResponse *response) {
+
+  const QFileInfoList file_infos = QDir(path).entryInfoList(QStringList() << QStringLiteral("*.spc") << QStringLiteral("*.vgm"), QDir::Files | QDir::Readable, QDir::Name);
+  for (const QFileInfo &file_info : file_infos) {
+    spb::tagreader::SongMetadata song_info;
+    if (!ReadFile(file_info, &song_info) || !song_info.valid()) continue;
+    const QByteArray url = QUrl::fromLocalFile(file_info.filePath()).toEncoded();
+    const QByteArray basefilename = file_info.fileName().toUtf8();
+    song_info.set_url(url.constData(), url.size());
+    song_info.set_basefilename(basefilename.constData(), basefilename.size());
+    song_info.set_filesize(file_info.size());
+    song_info.set_mtime(file_info.lastModified().isValid() ? std::max(file_info.lastModified().toSecsSinceEpoch(), 0LL) : 0LL);
+    song_info.set_ctime(song_info.mtime());
+    response->add_metadata()->Swap(&song_info);
+  }
+
+}
+
 quint32 GME::UnpackBytes32(const char *const bytes, size_t length) {
 
   Q_ASSERT(length <= 4 && length > 0);
@@ -274,7 +298,7 @@ bool TagReaderGME::IsMediaFile(const QString &filename) const {
   return GME::IsSupportedFormat(fileinfo);
 }
 
-bool TagReaderGME::ReadFile(const QString &filename, spb::tagreader::SongMetadata *song) const {
+bool TagReaderGME::ReadFile(const QString &filename, spb::tagreader::SongMetadata *song, const ReadLevel) const {
   QFileInfo fileinfo(filename);
   return GME::ReadFile(fileinfo, song);
 }
@@ -33,6 +33,8 @@
 namespace GME {
 bool IsSupportedFormat(const QFileInfo &file_info);
 bool ReadFile(const QFileInfo &file_info, spb::tagreader::SongMetadata *song_info);
+// Reads all supported files in the directory, not including subdirectories.
+void ReadDirectory(const QString &path, spb::tagreader::ReadDirectoryResponse *response);
 
 uint32_t UnpackBytes32(const char *const bytes, size_t length);
 
@@ -106,7 +108,7 @@ class TagReaderGME : public TagReaderBase {
 
   bool IsMediaFile(const QString &filename) const override;
 
-  bool ReadFile(const QString &filename, spb::tagreader::SongMetadata *song) const override;
+  bool ReadFile(const QString &filename, spb::tagreader::SongMetadata *song, const ReadLevel read_level = spb::tagreader::ReadFileRequest::FULL) const override;
   bool SaveFile(const spb::tagreader::SaveFileRequest &request) const override;
 
   QByteArray LoadEmbeddedArt(const QString &filename) const override;
@@ -0,0 +1,142 @@
+/* This file is part of Strawberry.
+
+   Strawberry is free software: you can redistribute it and/or modify
+   it under the terms of the GNU General Public License as published by
+   the Free Software Foundation, either version 3 of the License, or
+   (at your option) any later version.
+
+   Strawberry is distributed in the hope that it will be useful,
+   but WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+   GNU General Public License for more details.
+
+   You should have received a copy of the GNU General Public License
+   along with Strawberry.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#include "config.h"
+
+#include <memory>
+#include <string>
+
+#include <QtGlobal>
+#include <QByteArray>
+#include <QString>
+
+#include "tagreaderbase.h"
+#if defined(USE_TAGLIB)
+#  include "tagreadertaglib.h"
+#  include "tagreadergme.h"
+#elif defined(USE_TAGPARSER)
+#  include "tagreadertagparser.h"
+#endif
+#include "tagreaderhandler.h"
+
+TagReaderHandler::TagReaderHandler()
+#if defined(USE_TAGLIB)
+    : tag_reader_(new TagReaderTagLib),
+      tag_reader_fallback_(new TagReaderGME)
+#elif defined(USE_TAGPARSER)
+    : tag_reader_(new TagReaderTagParser)
+#endif
+    {}
+
+TagReaderHandler::~TagReaderHandler() = default;
+
+void TagReaderHandler::HandleMessage(const spb::tagreader::Message &message, spb::tagreader::Message *reply) const {
+
+  if (message.has_read_files_request()) {
+    ReadFiles(message.read_files_request(), reply->mutable_read_files_response());
+  }
+  else if (message.has_save_files_request()) {
+    SaveFiles(message.save_files_request(), reply->mutable_save_files_response());
+  }
+  else if (message.has_read_directory_request()) {
+    ReadDirectory(message.read_directory_request(), reply->mutable_read_directory_response());
+  }
+  else {
+    bool success = HandleMessage(message, reply, tag_reader_.get());
+    if (!success && tag_reader_fallback_) {
+      HandleMessage(message, reply, tag_reader_fallback_.get());
+    }
+  }
+
+}
+
+void TagReaderHandler::ReadFiles(const spb::tagreader::ReadFilesRequest &request, spb::tagreader::ReadFilesResponse *response) const {
+
+  for (const std::string &filename_data : request.filenames()) {
+    const QString filename = QString::fromUtf8(filename_data.data(), static_cast<qint64>(filename_data.size()));
+    spb::tagreader::SongMetadata *metadata = response->add_metadata();
+    if (!tag_reader_->ReadFile(filename, metadata, request.read_level()) && tag_reader_fallback_) {
+      metadata->Clear();
+      tag_reader_fallback_->ReadFile(filename, metadata, request.read_level());
+    }
+  }
+
+}
+
+void TagReaderHandler::ReadDirectory(const spb::tagreader::ReadDirectoryRequest &request, spb::tagreader::ReadDirectoryResponse *response) {
+
+#if defined(USE_TAGLIB)
+  GME::ReadDirectory(QString::fromUtf8(request.directory().data(), static_cast<qint64>(request.directory().size())), response);
+#else
+  Q_UNUSED(request)
+  Q_UNUSED(response)
+#endif
+
+}
+
+void TagReaderHandler::SaveFiles(const spb::tagreader::SaveFilesRequest &request, spb::tagreader::SaveFilesResponse *response) const {
+
+  for (const spb::tagreader::SaveFileRequest &save_file_request : request.requests()) {
+    response->add_success(tag_reader_->SaveFile(save_file_request));
+  }
+
+}
+
+bool TagReaderHandler::HandleMessage(const spb::tagreader::Message &message, spb::tagreader::Message *reply, const TagReaderBase *reader) {
+
+  if (message.has_is_media_file_request()) {
+    const QString filename = QString::fromUtf8(message.is_media_file_request().filename().data(), static_cast<qint64>(message.is_media_file_request().filename().size()));
+    bool success = reader->IsMediaFile(filename);
+    reply->mutable_is_media_file_response()->set_success(success);
+    return success;
+  }
+  else if (message.has_read_file_request()) {
+    const QString filename = QString::fromUtf8(message.read_file_request().filename().data(), static_cast<qint64>(message.read_file_request().filename().size()));
+    bool success = reader->ReadFile(filename, reply->mutable_read_file_response()->mutable_metadata(), message.read_file_request().read_level());
+    return success;
+  }
+  else if (message.has_save_file_request()) {
+    bool success = reader->SaveFile(message.save_file_request());
+    reply->mutable_save_file_response()->set_success(success);
+    return success;
+  }
+  else if (message.has_load_embedded_art_request()) {
+    const QString filename = QString::fromUtf8(message.load_embedded_art_request().filename().data(), static_cast<qint64>(message.load_embedded_art_request().filename().size()));
+    QByteArray data = reader->LoadEmbeddedArt(filename);
+    reply->mutable_load_embedded_art_response()->set_data(data.constData(), data.size());
+    return true;
+  }
+  else if (message.has_save_embedded_art_request()) {
+    bool success = reader->SaveEmbeddedArt(message.save_embedded_art_request());
+    reply->mutable_save_embedded_art_response()->set_success(success);
+    return success;
+  }
+  else if (message.has_save_song_playcount_to_file_request()) {
+    const QString filename = QString::fromUtf8(message.save_song_playcount_to_file_request().filename().data(), static_cast<qint64>(message.save_song_playcount_to_file_request().filename().size()));
+    bool success = reader->SaveSongPlaycountToFile(filename, message.save_song_playcount_to_file_request().metadata());
+    reply->mutable_save_song_playcount_to_file_response()->set_success(success);
+    return success;
+  }
+  else if (message.has_save_song_rating_to_file_request()) {
+    const QString filename = QString::fromUtf8(message.save_song_rating_to_file_request().filename().data(), static_cast<qint64>(message.save_song_rating_to_file_request().filename().size()));
+    bool success = reader->SaveSongRatingToFile(filename, message.save_song_rating_to_file_request().metadata());
+    reply->mutable_save_song_rating_to_file_response()->set_success(success);
+    return success;
+  }
+
+  return false;
+
+}
@@ -0,0 +1,57 @@
+/* This file is part of Strawberry.
+
+   Strawberry is free software: you can redistribute it and/or modify
+   it under the terms of the GNU General Public License as published by
+   the Free Software Foundation, either version 3 of the License, or
+   (at your option) any later version.
+
+   Strawberry is distributed in the hope that it will be useful,
+   but WITHOUT ANY WARRANTY; without even the implied warranty of
+   MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+   GNU General Public License for more details.
+
+   You should have received a copy of the GNU General Public License
+   along with Strawberry.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+#ifndef TAGREADERHANDLER_H
+#define TAGREADERHANDLER_H
+
+#include "config.h"
+
+#include <memory>
+
+#include "tagreadermessages.pb.h"
+
+class TagReaderBase;
+
+// Answers tag reader requests with the available TagReaderBase implementations.
+// Used by the strawberry-tagreader worker process, and by TagReaderClient when reading tags in the main process.
+// All methods are const and can be called from several threads at the same time.
+class TagReaderHandler {
+ public:
+  explicit TagReaderHandler();
+  ~TagReaderHandler();
+
+  void HandleMessage(const spb::tagreader::Message &message, spb::tagreader::Message *reply) const;
+
+ private:
+  // Handle message using specific TagReaderBase implementation. Returns true on successful message handle.
+  static bool HandleMessage(const spb::tagreader::Message &message, spb::tagreader::Message *reply, const TagReaderBase *reader);
+
+  // Reads all files in a batched request, with one metadata entry per filename in the same order.
+  void ReadFiles(const spb::tagreader::ReadFilesRequest &request, spb::tagreader::ReadFilesResponse *response) const;
+
+  // Reads all chiptune files in a directory, only supported with TagLib, which includes the GME reader.
+  static void ReadDirectory(const spb::tagreader::ReadDirectoryRequest &request, spb::tagreader::ReadDirectoryResponse *response);
+
+  // Saves all files in a batched request, with one success entry per request in the same order.
+  void SaveFiles(const spb::tagreader::SaveFilesRequest &request, spb::tagreader::SaveFilesResponse *response) const;
+
+ private:
+  std::unique_ptr<TagReaderBase> tag_reader_;
+  // Tried when tag_reader_ fails to handle the request.
+  std::unique_ptr<TagReaderBase> tag_reader_fallback_;
+};
+
+#endif  // TAGREADERHANDLER_H
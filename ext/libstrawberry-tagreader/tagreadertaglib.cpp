@@ -101,7 +101,7 @@ class FileRefFactory {
  public:
   FileRefFactory() = default;
   virtual ~FileRefFactory() = default;
-  virtual TagLib::FileRef *GetFileRef(const QString &filename) = 0;
+  virtual TagLib::FileRef *GetFileRef(const QString &filename, const TagLib::AudioProperties::ReadStyle read_style = TagLib::AudioProperties::Average) = 0;
 
  private:
   Q_DISABLE_COPY(FileRefFactory)
@@ -110,11 +110,11 @@ class FileRefFactory {
 class TagLibFileRefFactory : public FileRefFactory {
  public:
   TagLibFileRefFactory() = default;
-  TagLib::FileRef *GetFileRef(const QString &filename) override {
+  TagLib::FileRef *GetFileRef(const QString &filename, const TagLib::AudioProperties::ReadStyle read_style = TagLib::AudioProperties::Average) override {
 #ifdef Q_OS_WIN32
-    return new TagLib::FileRef(filename.toStdWString().c_str());
+    return new TagLib::FileRef(filename.toStdWString().c_str(), true, read_style);
 #else
-    return new TagLib::FileRef(QFile::encodeName(filename).constData());
+    return new TagLib::FileRef(QFile::encodeName(filename).constData(), true, read_style);
 #endif
   }
 
@@ -229,7 +229,7 @@ spb::tagreader::SongMetadata_FileType TagReaderTagLib::GuessFileType(TagLib::Fil
 
 }
 
-bool TagReaderTagLib::ReadFile(const QString &filename, spb::tagreader::SongMetadata *song) const {
+bool TagReaderTagLib::ReadFile(const QString &filename, spb::tagreader::SongMetadata *song, const ReadLevel read_level) const {
 
   const QByteArray url(QUrl::fromLocalFile(filename).toEncoded());
   const QFileInfo fileinfo(filename);
@@ -250,7 +250,10 @@ bool TagReaderTagLib::ReadFile(const QString &filename, spb::tagreader::SongMeta
 
   song->set_lastseen(QDateTime::currentSecsSinceEpoch());
 
-  std::unique_ptr<TagLib::FileRef> fileref(factory_->GetFileRef(filename));
+  // The fast level takes the audio properties from the headers instead of scanning the stream, and skips decoding pictures.
+  const bool fast = read_level == spb::tagreader::ReadFileRequest::FAST;
+
+  std::unique_ptr<TagLib::FileRef> fileref(factory_->GetFileRef(filename, fast ? TagLib::AudioProperties::Fast : TagLib::AudioProperties::Average));
   if (fileref->isNull()) {
     qLog(Info) << "TagLib hasn't been able to read" << filename << "file";
     return false;
@@ -283,7 +286,7 @@ bool TagReaderTagLib::ReadFile(const QString &filename, spb::tagreader::SongMeta
   // apart, so we keep specific behavior for some formats by adding another "else if" block below.
   if (TagLib::Ogg::XiphComment *xiph_comment = dynamic_cast<TagLib::Ogg::XiphComment*>(fileref->file()->tag())) {
     ParseOggTag(xiph_comment->fieldListMap(), &disc, &compilation, song);
-    TagLib::List<TagLib::FLAC::Picture*> pictures = xiph_comment->pictureList();
+    TagLib::List<TagLib::FLAC::Picture*> pictures = fast ? TagLib::List<TagLib::FLAC::Picture*>() : xiph_comment->pictureList();
     if (!pictures.isEmpty()) {
       for (TagLib::FLAC::Picture *picture : pictures) {
         if (picture->type() == TagLib::FLAC::Picture::FrontCover && picture->data().size() > 0) {
@@ -298,7 +301,7 @@ bool TagReaderTagLib::ReadFile(const QString &filename, spb::tagreader::SongMeta
     song->set_bitdepth(file_flac->audioProperties()->bitsPerSample());
     if (file_flac->xiphComment()) {
       ParseOggTag(file_flac->xiphComment()->fieldListMap(), &disc, &compilation, song);
-      TagLib::List<TagLib::FLAC::Picture*> pictures = file_flac->pictureList();
+      TagLib::List<TagLib::FLAC::Picture*> pictures = fast ? TagLib::List<TagLib::FLAC::Picture*>() : file_flac->pictureList();
       if (!pictures.isEmpty()) {
         for (TagLib::FLAC::Picture *picture : pictures) {
           if (picture->type() == TagLib::FLAC::Picture::FrontCover && picture->data().size() > 0) {
@@ -564,6 +567,11 @@ bool TagReaderTagLib::ReadFile(const QString &filename, spb::tagreader::SongMeta
 
   if (!lyrics.isEmpty()) song->set_lyrics(lyrics.toStdString());
 
+  // The file is already open, so record the embedded cover details now instead of loading it again for the collection.
+  if (!fast && song->art_embedded()) {
+    SetEmbeddedArtInfo(LoadEmbeddedArt(fileref.get()), song);
+  }
+
   // Set integer fields to -1 if they're not valid
 
   if (song->track() <= 0) { song->set_track(-1); }
@@ -581,9 +589,24 @@ bool TagReaderTagLib::ReadFile(const QString &filename, spb::tagreader::SongMeta
 
 void TagReaderTagLib::TStringToStdString(const TagLib::String &tag, std::string *output) {
 
-  const QString tmp = TStringToQString(tag).trimmed();
-  const QByteArray data = tmp.toUtf8();
-  output->assign(data.constData(), data.size());
+  // Convert straight to UTF-8 and trim ASCII whitespace in place, without going through QString.
+  // Other Unicode whitespace is only possible when the string starts or ends with a non-ASCII character, then QString is used to trim it.
+  *output = tag.to8Bit(true);
+
+  const auto is_space = [](const char c) { return c == ' ' || (c >= '\t' && c <= '\r'); };
+  std::string::size_type begin = 0;
+  while (begin < output->size() && is_space((*output)[begin])) ++begin;
+  std::string::size_type end = output->size();
+  while (end > begin && is_space((*output)[end - 1])) --end;
+
+  if (begin < end && (static_cast<unsigned char>((*output)[begin]) >= 0x80 || static_cast<unsigned char>((*output)[end - 1]) >= 0x80)) {
+    const QByteArray data = QString::fromStdString(*output).trimmed().toUtf8();
+    output->assign(data.constData(), data.size());
+    return;
+  }
+
+  if (end < output->size()) output->erase(end);
+  if (begin > 0) output->erase(0, begin);
 
 }
 
@@ -1168,8 +1191,14 @@ QByteArray TagReaderTagLib::LoadEmbeddedArt(const QString &filename) const {
 
   if (fileref.isNull() || !fileref.file()) return QByteArray();
 
+  return LoadEmbeddedArt(&fileref);
+
+}
+
+QByteArray TagReaderTagLib::LoadEmbeddedArt(TagLib::FileRef *fileref) const {
+
   // FLAC
-  if (TagLib::FLAC::File *flac_file = dynamic_cast<TagLib::FLAC::File*>(fileref.file())) {
+  if (TagLib::FLAC::File *flac_file = dynamic_cast<TagLib::FLAC::File*>(fileref->file())) {
     if (flac_file->xiphComment()) {
       TagLib::List<TagLib::FLAC::Picture*> pictures = flac_file->pictureList();
       if (!pictures.isEmpty()) {
@@ -1186,28 +1215,28 @@ QByteArray TagReaderTagLib::LoadEmbeddedArt(const QString &filename) const {
   }
 
   // WavPack
-  if (TagLib::WavPack::File *wavpack_file = dynamic_cast<TagLib::WavPack::File*>(fileref.file())) {
+  if (TagLib::WavPack::File *wavpack_file = dynamic_cast<TagLib::WavPack::File*>(fileref->file())) {
     if (wavpack_file->APETag()) {
       return LoadEmbeddedAPEArt(wavpack_file->APETag()->itemListMap());
     }
   }
 
   // APE
-  if (TagLib::APE::File *ape_file = dynamic_cast<TagLib::APE::File*>(fileref.file())) {
+  if (TagLib::APE::File *ape_file = dynamic_cast<TagLib::APE::File*>(fileref->file())) {
     if (ape_file->APETag()) {
       return LoadEmbeddedAPEArt(ape_file->APETag()->itemListMap());
     }
   }
 
   // MPC
-  if (TagLib::MPC::File *mpc_file = dynamic_cast<TagLib::MPC::File*>(fileref.file())) {
+  if (TagLib::MPC::File *mpc_file = dynamic_cast<TagLib::MPC::File*>(fileref->file())) {
     if (mpc_file->APETag()) {
       return LoadEmbeddedAPEArt(mpc_file->APETag()->itemListMap());
     }
   }
 
   // Ogg Vorbis / Opus / Speex
-  if (TagLib::Ogg::XiphComment *xiph_comment = dynamic_cast<TagLib::Ogg::XiphComment*>(fileref.file()->tag())) {
+  if (TagLib::Ogg::XiphComment *xiph_comment = dynamic_cast<TagLib::Ogg::XiphComment*>(fileref->file()->tag())) {
     TagLib::Ogg::FieldListMap map = xiph_comment->fieldListMap();
 
     TagLib::List<TagLib::FLAC::Picture*> pictures = xiph_comment->pictureList();
@@ -1231,7 +1260,7 @@ QByteArray TagReaderTagLib::LoadEmbeddedArt(const QString &filename) const {
   }
 
   // MP3
-  if (TagLib::MPEG::File *file_mp3 = dynamic_cast<TagLib::MPEG::File*>(fileref.file())) {
+  if (TagLib::MPEG::File *file_mp3 = dynamic_cast<TagLib::MPEG::File*>(fileref->file())) {
     if (file_mp3->ID3v2Tag()) {
       TagLib::ID3v2::FrameList apic_frames = file_mp3->ID3v2Tag()->frameListMap()["APIC"];
       if (apic_frames.isEmpty()) {
@@ -1245,7 +1274,7 @@ QByteArray TagReaderTagLib::LoadEmbeddedArt(const QString &filename) const {
   }
 
   // MP4/AAC
-  if (TagLib::MP4::File *aac_file = dynamic_cast<TagLib::MP4::File*>(fileref.file())) {
+  if (TagLib::MP4::File *aac_file = dynamic_cast<TagLib::MP4::File*>(fileref->file())) {
     TagLib::MP4::Tag *tag = aac_file->tag();
     if (tag && tag->item("covr").isValid()) {
       const TagLib::MP4::CoverArtList &art_list = tag->item("covr").toCoverArtList();
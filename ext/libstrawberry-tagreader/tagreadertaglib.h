@@ -54,7 +54,7 @@ class TagReaderTagLib : public TagReaderBase {
 
   bool IsMediaFile(const QString &filename) const override;
 
-  bool ReadFile(const QString &filename, spb::tagreader::SongMetadata *song) const override;
+  bool ReadFile(const QString &filename, spb::tagreader::SongMetadata *song, const ReadLevel read_level = spb::tagreader::ReadFileRequest::FULL) const override;
   bool SaveFile(const spb::tagreader::SaveFileRequest &request) const override;
 
   QByteArray LoadEmbeddedArt(const QString &filename) const override;
@@ -82,6 +82,7 @@ class TagReaderTagLib : public TagReaderBase {
   void SetUserTextFrame(const std::string &description, const std::string &value, TagLib::ID3v2::Tag *tag) const;
   void SetUnsyncLyricsFrame(const std::string &value, TagLib::ID3v2::Tag *tag) const;
 
+  QByteArray LoadEmbeddedArt(TagLib::FileRef *fileref) const;
   QByteArray LoadEmbeddedAPEArt(const TagLib::APE::ItemListMap &map) const;
 
   static TagLib::ID3v2::PopularimeterFrame *GetPOPMFrameFromTag(TagLib::ID3v2::Tag *tag);
@@ -94,7 +94,7 @@ bool TagReaderTagParser::IsMediaFile(const QString &filename) const {
 
 }
 
-bool TagReaderTagParser::ReadFile(const QString &filename, spb::tagreader::SongMetadata *song) const {
+bool TagReaderTagParser::ReadFile(const QString &filename, spb::tagreader::SongMetadata *song, const ReadLevel read_level) const {
 
   qLog(Debug) << "Reading tags from" << filename;
 
@@ -225,6 +225,9 @@ bool TagReaderTagParser::ReadFile(const QString &filename, spb::tagreader::SongM
       song->set_disc(tag->value(TagParser::KnownField::DiskPosition).toInteger());
       if (!tag->value(TagParser::KnownField::Cover).empty() && tag->value(TagParser::KnownField::Cover).dataSize() > 0) {
         song->set_art_embedded(true);
+        if (read_level == spb::tagreader::ReadFileRequest::FULL && !song->has_art_embedded_hash()) {
+          SetEmbeddedArtInfo(QByteArray::fromRawData(tag->value(TagParser::KnownField::Cover).dataPointer(), static_cast<qint64>(tag->value(TagParser::KnownField::Cover).dataSize())), song);
+        }
       }
       const float rating = ConvertPOPMRating(tag->value(TagParser::KnownField::Rating));
       if (song->rating() <= 0 && rating > 0.0 && rating <= 1.0) {
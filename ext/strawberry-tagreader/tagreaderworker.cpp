@@ -25,6 +25,9 @@
 #include <QIODevice>
 #include <QByteArray>
 
+#include <google/protobuf/arena.h>
+
+#include "core/sharedpayload.h"
 #include "tagreaderworker.h"
 
 TagReaderWorker::TagReaderWorker(QIODevice *socket, QObject *parent)
@@ -32,16 +35,23 @@ TagReaderWorker::TagReaderWorker(QIODevice *socket, QObject *parent)
 
 void TagReaderWorker::MessageArrived(const spb::tagreader::Message &message) {
 
-  spb::tagreader::Message reply;
+  // The reply and all the metadata in it are allocated in the arena and freed together after sending.
+  google::protobuf::Arena arena;
+  spb::tagreader::Message *reply = google::protobuf::Arena::Create<spb::tagreader::Message>(&arena);
+
+  handler_.HandleMessage(message, reply);
 
-  bool success = HandleMessage(message, reply, &tag_reader_);
-  if (!success) {
-#if defined(USE_TAGLIB)
-    HandleMessage(message, reply, &tag_reader_gme_);
-#endif
+  // Big covers are passed through a file instead of the socket.
+  if (reply->has_load_embedded_art_response() && static_cast<qint64>(reply->load_embedded_art_response().data().size()) >= SharedPayload::kMinimumSize) {
+    const std::string &data = reply->load_embedded_art_response().data();
+    const QString data_filename = SharedPayload::Write(QByteArray::fromRawData(data.data(), static_cast<qint64>(data.size())));
+    if (!data_filename.isEmpty()) {
+      reply->mutable_load_embedded_art_response()->clear_data();
+      reply->mutable_load_embedded_art_response()->set_data_filename(data_filename.toStdString());
+    }
   }
 
-  SendReply(message, &reply);
+  SendReply(message, reply);
 
 }
 
@@ -52,49 +62,3 @@ void TagReaderWorker::DeviceClosed() {
   QCoreApplication::exit();
 
 }
-
-bool TagReaderWorker::HandleMessage(const spb::tagreader::Message &message, spb::tagreader::Message &reply, TagReaderBase *reader) {
-
-  if (message.has_is_media_file_request()) {
-    const QString filename = QString::fromUtf8(message.is_media_file_request().filename().data(), static_cast<qint64>(message.is_media_file_request().filename().size()));
-    bool success = reader->IsMediaFile(filename);
-    reply.mutable_is_media_file_response()->set_success(success);
-    return success;
-  }
-  else if (message.has_read_file_request()) {
-    const QString filename = QString::fromUtf8(message.read_file_request().filename().data(), static_cast<qint64>(message.read_file_request().filename().size()));
-    bool success = reader->ReadFile(filename, reply.mutable_read_file_response()->mutable_metadata());
-    return success;
-  }
-  else if (message.has_save_file_request()) {
-    bool success = reader->SaveFile(message.save_file_request());
-    reply.mutable_save_file_response()->set_success(success);
-    return success;
-  }
-  else if (message.has_load_embedded_art_request()) {
-    const QString filename = QString::fromUtf8(message.load_embedded_art_request().filename().data(), static_cast<qint64>(message.load_embedded_art_request().filename().size()));
-    QByteArray data = reader->LoadEmbeddedArt(filename);
-    reply.mutable_load_embedded_art_response()->set_data(data.constData(), data.size());
-    return true;
-  }
-  else if (message.has_save_embedded_art_request()) {
-    bool success = reader->SaveEmbeddedArt(message.save_embedded_art_request());
-    reply.mutable_save_embedded_art_response()->set_success(success);
-    return success;
-  }
-  else if (message.has_save_song_playcount_to_file_request()) {
-    const QString filename = QString::fromUtf8(message.save_song_playcount_to_file_request().filename().data(), static_cast<qint64>(message.save_song_playcount_to_file_request().filename().size()));
-    bool success = reader->SaveSongPlaycountToFile(filename, message.save_song_playcount_to_file_request().metadata());
-    reply.mutable_save_song_playcount_to_file_response()->set_success(success);
-    return success;
-  }
-  else if (message.has_save_song_rating_to_file_request()) {
-    const QString filename = QString::fromUtf8(message.save_song_rating_to_file_request().filename().data(), static_cast<qint64>(message.save_song_rating_to_file_request().filename().size()));
-    bool success = reader->SaveSongRatingToFile(filename, message.save_song_rating_to_file_request().metadata());
-    reply.mutable_save_song_rating_to_file_response()->set_success(success);
-    return success;
-  }
-
-  return false;
-
-}
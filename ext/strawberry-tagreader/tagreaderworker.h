@@ -24,12 +24,7 @@
 #include <QObject>
 
 #include "core/messagehandler.h"
-#if defined(USE_TAGLIB)
-#  include "tagreadertaglib.h"
-#  include "tagreadergme.h"
-#elif defined(USE_TAGPARSER)
-#  include "tagreadertagparser.h"
-#endif
+#include "tagreaderhandler.h"
 
 #include "tagreadermessages.pb.h"
 
@@ -46,15 +41,7 @@ class TagReaderWorker : public AbstractMessageHandler<spb::tagreader::Message> {
   void DeviceClosed() override;
 
  private:
-  // Handle message using specific TagReaderBase implementation. Returns true on successful message handle.
-  bool HandleMessage(const spb::tagreader::Message &message, spb::tagreader::Message &reply, TagReaderBase* reader);
-
-#if defined(USE_TAGLIB)
-  TagReaderTagLib tag_reader_;
-  TagReaderGME tag_reader_gme_;
-#elif defined(USE_TAGPARSER)
-  TagReaderTagParser tag_reader_;
-#endif
+  TagReaderHandler handler_;
 };
 
 #endif  // TAGREADERWORKER_H
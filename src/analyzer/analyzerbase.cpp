@@ -36,6 +36,11 @@
 #include <QShowEvent>
 #include <QHideEvent>
 #include <QTimerEvent>
+#include <QMutexLocker>
+#include <QtConcurrentRun>
+#include <QWindow>
+#include <QScreen>
+#include <QtMath>
 
 #include "engine/enginebase.h"
 
@@ -50,6 +55,8 @@
 // Make an INSTRUCTIONS file
 // can't mod scope in analyze you have to use transform for 2D use setErasePixmap Qt function insetead of m_background
 
+const int AnalyzerBase::kThrottledTimeoutMsec = 500;
+
 AnalyzerBase::AnalyzerBase(QWidget *parent, const uint scopeSize)
     : QWidget(parent),
       fht_(new FHT(scopeSize)),
@@ -57,30 +64,43 @@ AnalyzerBase::AnalyzerBase(QWidget *parent, const uint scopeSize)
       lastscope_(512),
       new_frame_(false),
       is_playing_(false),
-      timeout_(40) {
+      timeout_(40),
+      exposed_(true),
+      interval_(40),
+      frame_ready_(false) {
 
   setAttribute(Qt::WA_OpaquePaintEvent, true);
 
+  producer_pool_.setMaxThreadCount(1);
+
 }
 
 AnalyzerBase::~AnalyzerBase() {
+  StopProducer();
   delete fht_;
 }
 
 void AnalyzerBase::showEvent(QShowEvent*) {
-  timer_.start(timeout(), this);
+  exposed_ = true;
+  RestartTimer();
 }
 
 void AnalyzerBase::hideEvent(QHideEvent*) {
   timer_.stop();
+  StopProducer();
+}
+
+void AnalyzerBase::StopProducer() {
+
+  producer_future_.waitForFinished();
+
 }
 
 void AnalyzerBase::ChangeTimeout(const int timeout) {
 
   timeout_ = timeout;
   if (timer_.isActive()) {
-    timer_.stop();
-    timer_.start(timeout_, this);
+    RestartTimer();
   }
 
 }
@@ -109,21 +129,17 @@ void AnalyzerBase::paintEvent(QPaintEvent *e) {
 
   switch (engine_->state()) {
     case EngineBase::State::Playing:{
-      const EngineBase::Scope &thescope = engine_->scope(timeout_);
-      int i = 0;
-
-      // convert to mono here - our built in analyzers need mono, but the engines provide interleaved pcm
-      for (uint x = 0; static_cast<int>(x) < fht_->size(); ++x) {
-        lastscope_[x] = static_cast<float>(thescope[i] + thescope[i + 1]) / (2 * (1U << 15U));
-        i += 2;
+      {
+        QMutexLocker l(&frame_mutex_);
+        if (frame_ready_) {
+          lastscope_.swap(ready_frame_);
+          frame_ready_ = false;
+        }
       }
 
       is_playing_ = true;
-      transform(lastscope_);
       analyze(p, lastscope_, new_frame_);
 
-      lastscope_.resize(fht_->size());
-
       break;
     }
     case EngineBase::State::Paused:
@@ -150,6 +166,7 @@ int AnalyzerBase::resizeExponent(int exp) {
   }
 
   if (exp != fht_->sizeExp()) {
+    QMutexLocker l(&transform_mutex_);
     delete fht_;
     fht_ = new FHT(exp);
   }
@@ -254,7 +271,78 @@ void AnalyzerBase::timerEvent(QTimerEvent *e) {
     return;
   }
 
+  // Stop pulling the scope while the window is minimized, hidden in the tray or covered, and only check back now and then.
+  const bool exposed = IsWindowExposed();
+  if (exposed != exposed_) {
+    exposed_ = exposed;
+    RestartTimer();
+  }
+  if (!exposed_) return;
+
   new_frame_ = true;
+  StartFrame();
   update();
 
 }
+
+int AnalyzerBase::FrameInterval() const {
+
+  if (!exposed_) return kThrottledTimeoutMsec;
+
+  // Painting faster than the screen refreshes only costs CPU.
+  int interval = timeout_;
+  const QWindow *window_handle = window()->windowHandle();
+  if (window_handle && window_handle->screen() && window_handle->screen()->refreshRate() > 1.0) {
+    interval = qMax(interval, qCeil(1000.0 / window_handle->screen()->refreshRate()));
+  }
+
+  return interval;
+
+}
+
+bool AnalyzerBase::IsWindowExposed() const {
+
+  if (window()->isMinimized()) return false;
+  const QWindow *window_handle = window()->windowHandle();
+  return !window_handle || window_handle->isExposed();
+
+}
+
+void AnalyzerBase::RestartTimer() {
+
+  interval_ = FrameInterval();
+  timer_.start(interval_, this);
+
+}
+
+void AnalyzerBase::StartFrame() {
+
+  // A frame still being computed is not queued behind, the next tick picks up the newer samples instead.
+  if (!engine_ || engine_->state() != EngineBase::State::Playing || producer_future_.isRunning()) return;
+
+  const EngineBase::Scope &thescope = engine_->scope(interval_);
+
+  // convert to mono here - our built in analyzers need mono, but the engines provide interleaved pcm
+  Scope frame(static_cast<size_t>(fht_->size()));
+  int i = 0;
+  for (uint x = 0; static_cast<int>(x) < fht_->size(); ++x) {
+    frame[x] = static_cast<float>(thescope[i] + thescope[i + 1]) / (2 * (1U << 15U));
+    i += 2;
+  }
+
+  producer_future_ = QtConcurrent::run(&producer_pool_, [this, frame]() { ProduceFrame(frame); });
+
+}
+
+void AnalyzerBase::ProduceFrame(Scope frame) {
+
+  {
+    QMutexLocker l(&transform_mutex_);
+    transform(frame);
+  }
+
+  QMutexLocker l(&frame_mutex_);
+  ready_frame_.swap(frame);
+  frame_ready_ = true;
+
+}
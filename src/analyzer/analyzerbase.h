@@ -37,6 +37,9 @@
 #include <QBasicTimer>
 #include <QString>
 #include <QPainter>
+#include <QMutex>
+#include <QThreadPool>
+#include <QFuture>
 
 #include "core/shared_ptr.h"
 #include "analyzer/fht.h"
@@ -61,6 +64,9 @@ class AnalyzerBase : public QWidget {
 
   virtual void framerateChanged() {}
 
+  // Waits for the spectrum frame being computed, call before deleting the analyzer.
+  void StopProducer();
+
  protected:
   using Scope = std::vector<float>;
   explicit AnalyzerBase(QWidget*, const uint scopeSize = 7);
@@ -89,6 +95,31 @@ class AnalyzerBase : public QWidget {
   bool new_frame_;
   bool is_playing_;
   int timeout_;
+
+  // transform() runs in the producer thread with this locked.
+  // Lock it when changing anything transform() reads or when replacing fht_.
+  QMutex transform_mutex_;
+
+ private:
+  static const int kThrottledTimeoutMsec;
+
+  // How often to paint, limited to the refresh rate of the screen, and slowed down while the window can't be seen.
+  int FrameInterval() const;
+  bool IsWindowExposed() const;
+  void RestartTimer();
+
+  void StartFrame();
+  void ProduceFrame(Scope frame);
+
+  bool exposed_;
+  int interval_;
+
+  // Spectrum frames are computed in one thread off the paint path, the widget only paints the last completed frame.
+  QThreadPool producer_pool_;
+  QFuture<void> producer_future_;
+  QMutex frame_mutex_;
+  Scope ready_frame_;
+  bool frame_ready_;
 };
 
 #endif  // ANALYZERBASE_H
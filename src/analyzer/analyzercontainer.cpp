@@ -103,6 +103,13 @@ AnalyzerContainer::AnalyzerContainer(QWidget *parent)
 
 }
 
+AnalyzerContainer::~AnalyzerContainer() {
+
+  // The analyzer is deleted as a child after this, its spectrum frame must not be computed while it's destroyed.
+  if (current_analyzer_) current_analyzer_->StopProducer();
+
+}
+
 void AnalyzerContainer::mouseReleaseEvent(QMouseEvent *e) {
 
   if (engine_->type() != EngineBase::Type::GStreamer) {
@@ -135,6 +142,7 @@ void AnalyzerContainer::SetEngine(SharedPtr<EngineBase> engine) {
 }
 
 void AnalyzerContainer::DisableAnalyzer() {
+  if (current_analyzer_) current_analyzer_->StopProducer();
   delete current_analyzer_;
   current_analyzer_ = nullptr;
 
@@ -150,6 +158,7 @@ void AnalyzerContainer::ChangeAnalyzer(const int id) {
     return;
   }
 
+  if (current_analyzer_) current_analyzer_->StopProducer();
   delete current_analyzer_;
   current_analyzer_ = qobject_cast<AnalyzerBase*>(instance);
   current_analyzer_->set_engine(engine_);
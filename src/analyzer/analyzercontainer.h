@@ -44,6 +44,7 @@ class AnalyzerContainer : public QWidget {
 
  public:
   explicit AnalyzerContainer(QWidget *parent);
+  ~AnalyzerContainer() override;
 
   void SetEngine(SharedPtr<EngineBase> engine);
   void SetActions(QAction *visualisation);
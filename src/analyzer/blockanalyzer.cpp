@@ -32,6 +32,7 @@
 #include <QPainter>
 #include <QPalette>
 #include <QColor>
+#include <QMutexLocker>
 
 #include "analyzerbase.h"
 #include "fht.h"
@@ -83,7 +84,10 @@ void BlockAnalyzer::resizeEvent(QResizeEvent *e) {
   // this is the y-offset for drawing from the top of the widget
   y_ = (height() - (rows_ * (kHeight + 1)) + 2) / 2;
 
-  scope_.resize(columns_);
+  {
+    QMutexLocker l(&transform_mutex_);
+    scope_.resize(columns_);
+  }
 
   if (rows_ != oldRows) {
     barpixmap_ = QPixmap(kWidth, rows_ * (kHeight + 1));
@@ -31,6 +31,7 @@
 #include <QPainter>
 #include <QPalette>
 #include <QColor>
+#include <QMutexLocker>
 
 #include "engine/enginebase.h"
 #include "fht.h"
@@ -76,7 +77,10 @@ void BoomAnalyzer::resizeEvent(QResizeEvent *e) {
   const double h = 1.2 / HEIGHT;
 
   bands_ = qMin(static_cast<int>(static_cast<double>(width() + 1) / (kColumnWidth + 1)) + 1, kMaxBandCount);
-  scope_.resize(bands_);
+  {
+    QMutexLocker l(&transform_mutex_);
+    scope_.resize(bands_);
+  }
 
   F_ = static_cast<double>(HEIGHT) / (log10(256) * 1.1 /*<- max. amplitude*/);
 
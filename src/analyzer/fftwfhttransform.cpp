@@ -0,0 +1,68 @@
+/*
+ * Strawberry Music Player
+ *
+ * Strawberry is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Strawberry is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Strawberry.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#include "config.h"
+
+#include <fftw3.h>
+
+#include <QtGlobal>
+#include <QMutex>
+#include <QMutexLocker>
+
+#include "ext/gstmoodbar/gstfastspectrum.h"
+
+#include "fftwfhttransform.h"
+
+FFTWFHTTransform::FFTWFHTTransform(const int size)
+    : size_(size),
+      buffer_(reinterpret_cast<double*>(fftw_malloc(sizeof(double) * static_cast<size_t>(size)))),
+      plan_(nullptr) {
+
+  // The planner isn't thread-safe, the moodbar creates its plans in the streaming threads.
+  if (buffer_) {
+    QMutexLocker l(gst_fastspectrum_fftw_lock());
+    plan_ = fftw_plan_r2r_1d(size_, buffer_, buffer_, FFTW_DHT, FFTW_ESTIMATE);
+  }
+
+}
+
+FFTWFHTTransform::~FFTWFHTTransform() {
+
+  if (plan_) {
+    QMutexLocker l(gst_fastspectrum_fftw_lock());
+    fftw_destroy_plan(plan_);
+  }
+  if (buffer_) {
+    fftw_free(buffer_);
+  }
+
+}
+
+void FFTWFHTTransform::Transform(float *p) {
+
+  for (int i = 0; i < size_; ++i) {
+    buffer_[i] = static_cast<double>(p[i]);
+  }
+
+  fftw_execute(plan_);
+
+  for (int i = 0; i < size_; ++i) {
+    p[i] = static_cast<float>(buffer_[i]);
+  }
+
+}
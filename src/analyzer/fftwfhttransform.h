@@ -0,0 +1,48 @@
+/*
+ * Strawberry Music Player
+ *
+ * Strawberry is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Strawberry is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Strawberry.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#ifndef FFTWFHTTRANSFORM_H
+#define FFTWFHTTRANSFORM_H
+
+#include "config.h"
+
+#include <fftw3.h>
+
+#include <QtGlobal>
+
+#include "fhttransform.h"
+
+// Hartley transform using FFTW's vectorized DHT plan.
+class FFTWFHTTransform : public FHTTransform {
+ public:
+  explicit FFTWFHTTransform(const int size);
+  ~FFTWFHTTransform() override;
+
+  bool is_valid() const { return plan_ != nullptr; }
+
+  void Transform(float *p) override;
+
+ private:
+  Q_DISABLE_COPY(FFTWFHTTransform)
+
+  const int size_;
+  double *buffer_;
+  fftw_plan plan_;
+};
+
+#endif  // FFTWFHTTRANSFORM_H
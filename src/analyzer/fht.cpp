@@ -20,14 +20,22 @@
    along with Strawberry.  If not, see <http://www.gnu.org/licenses/>.
 */
 
+#include "config.h"
+
 #include "fht.h"
 
 #include <algorithm>
 #include <cmath>
+#include <memory>
+#include <utility>
 
 #include <QVector>
 #include <QtMath>
 
+#ifdef HAVE_MOODBAR
+#  include "fftwfhttransform.h"
+#endif
+
 FHT::FHT(uint n) : num_((n < 3) ? 0 : 1 << n), exp2_((n < 3) ? -1 : static_cast<int>(n)) {
 
   if (n > 3) {
@@ -36,6 +44,13 @@ FHT::FHT(uint n) : num_((n < 3) ? 0 : 1 << n), exp2_((n < 3) ? -1 : static_cast<
     makeCasTable();
   }
 
+#ifdef HAVE_MOODBAR
+  if (n > 3) {
+    std::unique_ptr<FFTWFHTTransform> backend = std::make_unique<FFTWFHTTransform>(num_);
+    if (backend->is_valid()) backend_ = std::move(backend);
+  }
+#endif
+
 }
 
 FHT::~FHT() = default;
@@ -126,7 +141,7 @@ void FHT::power(float *p) {
 
 void FHT::power2(float *p) {
 
-  _transform(p, num_, 0);
+  transformFull(p);
 
   *p = static_cast<float>(2 * pow(*p, 2));
   p++;
@@ -145,6 +160,17 @@ void FHT::transform(float *p) {
   if (num_ == 8) {
     transform8(p);
   }
+  else {
+    transformFull(p);
+  }
+
+}
+
+void FHT::transformFull(float *p) {
+
+  if (backend_) {
+    backend_->Transform(p);
+  }
   else {
     _transform(p, num_, 0);
   }
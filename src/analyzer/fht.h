@@ -23,8 +23,12 @@
 #ifndef FHT_H
 #define FHT_H
 
+#include <memory>
+
 #include <QVector>
 
+#include "fhttransform.h"
+
 /**
  * Implementation of the Hartley Transform after Bracewell's discrete
  * algorithm. The algorithm is subject to US patent No. 4,646,256 (1987)
@@ -41,6 +45,9 @@ class FHT {
   QVector<float> tab_vector_;
   QVector<int> log_vector_;
 
+  // Faster backend for the full size transform if available, otherwise the recursive transform below is used.
+  std::unique_ptr<FHTTransform> backend_;
+
   float *buf_();
   float *tab_();
   int *log_();
@@ -57,6 +64,11 @@ class FHT {
    */
   void _transform(float*, int, int);
 
+  /**
+   * In-place Hartley transform of the full data set, using the backend if there is one.
+   */
+  void transformFull(float*);
+
  public:
   /**
   * Prepare transform for data sets with @f$2^n@f$ numbers, whereby @f$n@f$
@@ -0,0 +1,34 @@
+/*
+ * Strawberry Music Player
+ *
+ * Strawberry is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Strawberry is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Strawberry.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#ifndef FHTTRANSFORM_H
+#define FHTTRANSFORM_H
+
+#include "config.h"
+
+// Backend computing the discrete Hartley transform for FHT.
+// The output is unnormalized and in natural order, the same as FHT's own transform.
+class FHTTransform {
+ public:
+  virtual ~FHTTransform() = default;
+
+  // In-place transform of the number of values the backend was created for.
+  virtual void Transform(float *p) = 0;
+};
+
+#endif  // FHTTRANSFORM_H
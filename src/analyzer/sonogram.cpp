@@ -21,7 +21,11 @@
    along with Strawberry.  If not, see <http://www.gnu.org/licenses/>.
  */
 
+#include <QImage>
+#include <QColor>
 #include <QPainter>
+#include <QRect>
+#include <QPoint>
 #include <QResizeEvent>
 
 #include "engine/enginebase.h"
@@ -31,53 +35,66 @@
 const char *Sonogram::kName = QT_TRANSLATE_NOOP("AnalyzerContainer", "Sonogram");
 
 Sonogram::Sonogram(QWidget *parent)
-    : AnalyzerBase(parent, 9) {}
+    : AnalyzerBase(parent, 9),
+      column_(0) {}
 
 void Sonogram::resizeEvent(QResizeEvent *e) {
 
   Q_UNUSED(e)
 
-  canvas_ = QPixmap(size());
+  canvas_ = QImage(size(), QImage::Format_RGB32);
   canvas_.fill(palette().color(QPalette::Window));
+  column_ = 0;
 
 }
 
 void Sonogram::analyze(QPainter &p, const Scope &s, bool new_frame) {
 
+  if (canvas_.isNull()) return;
+
   if (!new_frame || engine_->state() == EngineBase::State::Paused) {
-    p.drawPixmap(0, 0, canvas_);
+    drawCanvas(p);
     return;
   }
 
-  QPainter canvas_painter(&canvas_);
-  canvas_painter.drawPixmap(0, 0, canvas_, 1, 0, width() - 1, -1);
-
   Scope::const_iterator it = s.begin(), end = s.end();
 
-  for (int y = height() - 1; y;) {
-    QColor c;
+  const QRgb background = palette().color(QPalette::Window).rgb();
+  for (int y = canvas_.height() - 1; y;) {
+    QRgb c = 0;
     if (it >= end || *it < .005) {
-      c = palette().color(QPalette::Window);
+      c = background;
     }
     else if (*it < .05) {
-      c.setHsv(95, 255, 255 - static_cast<int>(*it * 4000.0));
+      c = QColor::fromHsv(95, 255, 255 - static_cast<int>(*it * 4000.0)).rgb();
     }
     else if (*it < 1.0) {
-      c.setHsv(95 - static_cast<int>(*it * 90.0), 255, 255);
+      c = QColor::fromHsv(95 - static_cast<int>(*it * 90.0), 255, 255).rgb();
     }
     else {
-      c = Qt::red;
+      c = QColor(Qt::red).rgb();
     }
 
-    canvas_painter.setPen(c);
-    canvas_painter.drawPoint(width() - 1, y--);
+    reinterpret_cast<QRgb*>(canvas_.scanLine(y--))[column_] = c;
 
     if (it < end) ++it;
   }
 
-  canvas_painter.end();
+  column_ = (column_ + 1) % canvas_.width();
 
-  p.drawPixmap(0, 0, canvas_);
+  drawCanvas(p);
+
+}
+
+void Sonogram::drawCanvas(QPainter &p) const {
+
+  // The column after the newest is the oldest one, it goes on the left.
+  const int width = canvas_.width();
+  const int height = canvas_.height();
+  p.drawImage(QPoint(0, 0), canvas_, QRect(column_, 0, width - column_, height));
+  if (column_ > 0) {
+    p.drawImage(QPoint(width - column_, 0), canvas_, QRect(0, 0, column_, height));
+  }
 
 }
 
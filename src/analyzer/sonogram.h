@@ -24,7 +24,7 @@
 #ifndef SONOGRAM_H
 #define SONOGRAM_H
 
-#include <QPixmap>
+#include <QImage>
 #include <QPainter>
 
 #include "analyzerbase.h"
@@ -43,7 +43,12 @@ class Sonogram : public AnalyzerBase {
   void demo(QPainter &p) override;
 
  private:
-  QPixmap canvas_;
+  void drawCanvas(QPainter &p) const;
+
+  // Ring of columns, the newest column is written in place and the image is painted in two parts starting at the oldest.
+  // This avoids scrolling the whole canvas every frame.
+  QImage canvas_;
+  int column_;
 };
 
 #endif  // SONOGRAM_H
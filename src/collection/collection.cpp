@@ -22,15 +22,21 @@
 #include "config.h"
 
 #include <memory>
+#include <algorithm>
+#include <utility>
 
 #include <QtGlobal>
 #include <QObject>
 #include <QThread>
 #include <QList>
+#include <QMap>
+#include <QHash>
+#include <QString>
+#include <QStorageInfo>
 #include <QSettings>
-#include <QtConcurrentRun>
 
 #include "core/application.h"
+#include "core/player.h"
 #include "core/taskmanager.h"
 #include "core/database.h"
 #include "core/tagreaderclient.h"
@@ -43,6 +49,7 @@
 #include "collectionwatcher.h"
 #include "collectionbackend.h"
 #include "collectionmodel.h"
+#include "collectionanalysisqueue.h"
 #include "scrobbler/lastfmimport.h"
 #include "settings/collectionsettingspage.h"
 
@@ -58,9 +65,9 @@ SCollection::SCollection(Application *app, QObject *parent)
       app_(app),
       backend_(nullptr),
       model_(nullptr),
-      watcher_(nullptr),
-      watcher_thread_(nullptr),
+      watchers_paused_(false),
       original_thread_(nullptr),
+      analysis_queue_(nullptr),
       save_playcounts_to_files_(false),
       save_ratings_to_files_(false) {
 
@@ -74,75 +81,135 @@ SCollection::SCollection(Application *app, QObject *parent)
 
   model_ = new CollectionModel(backend_, app_, this);
 
+  analysis_queue_ = new CollectionAnalysisQueue(app_->task_manager(), backend_, this);
+
   ReloadSettings();
 
 }
 
 SCollection::~SCollection() {
 
-  if (watcher_) {
-    watcher_->Stop();
-    watcher_->deleteLater();
+  for (CollectionWatcher *watcher : std::as_const(watchers_)) {
+    watcher->Stop();
+    watcher->deleteLater();
   }
-  if (watcher_thread_) {
-    watcher_thread_->exit();
-    watcher_thread_->wait(5000);
+  for (Thread *watcher_thread : std::as_const(watcher_threads_)) {
+    watcher_thread->exit();
+    watcher_thread->wait(5000);
   }
 
 }
 
 void SCollection::Init() {
 
-  watcher_ = new CollectionWatcher(Song::Source::Collection);
-  watcher_thread_ = new Thread(this);
+  QObject::connect(&*backend_, &CollectionBackend::Error, this, &SCollection::Error);
+  QObject::connect(&*backend_, &CollectionBackend::DirectoryDiscovered, this, &SCollection::DirectoryDiscovered);
+  QObject::connect(&*backend_, &CollectionBackend::DirectoryDeleted, this, &SCollection::DirectoryDeleted);
+  QObject::connect(&*backend_, &CollectionBackend::SongsRatingChanged, this, &SCollection::SongsRatingChanged);
+  QObject::connect(&*backend_, &CollectionBackend::SongsStatisticsChanged, this, &SCollection::SongsPlaycountChanged);
 
-  watcher_thread_->SetIoPriority(Utilities::IoPriority::IOPRIO_CLASS_IDLE);
+  // Fingerprints and EBU R 128 loudness characteristics are created after the directory is scanned, and paused during playback.
+  QObject::connect(analysis_queue_, &CollectionAnalysisQueue::SongsAnalyzed, &*backend_, &CollectionBackend::UpdateAnalysisResults);
+  QObject::connect(&*app_->player(), &Player::Playing, analysis_queue_, [this]() { analysis_queue_->SetPaused(true); });
+  QObject::connect(&*app_->player(), &Player::Paused, analysis_queue_, [this]() { analysis_queue_->SetPaused(false); });
+  QObject::connect(&*app_->player(), &Player::Stopped, analysis_queue_, [this]() { analysis_queue_->SetPaused(false); });
 
-  watcher_->moveToThread(watcher_thread_);
+  QObject::connect(&*app_->lastfm_import(), &LastFMImport::UpdatePlayStatistics, &*backend_, &CollectionBackend::UpdatePlayStatisticsByMetadata);
 
-  qLog(Debug) << watcher_ << "moved to thread" << watcher_thread_;
+  // This will start the watchers checking for updates
+  backend_->LoadDirectoriesAsync();
 
-  watcher_thread_->start(QThread::IdlePriority);
+}
 
-  watcher_->set_backend(backend_);
-  watcher_->set_task_manager(app_->task_manager());
+CollectionWatcher *SCollection::WatcherForDevice(const QString &device) {
 
-  QObject::connect(&*backend_, &CollectionBackend::Error, this, &SCollection::Error);
-  QObject::connect(&*backend_, &CollectionBackend::DirectoryDiscovered, watcher_, &CollectionWatcher::AddDirectory);
-  QObject::connect(&*backend_, &CollectionBackend::DirectoryDeleted, watcher_, &CollectionWatcher::RemoveDirectory);
-  QObject::connect(&*backend_, &CollectionBackend::SongsRatingChanged, this, &SCollection::SongsRatingChanged);
-  QObject::connect(&*backend_, &CollectionBackend::SongsStatisticsChanged, this, &SCollection::SongsPlaycountChanged);
+  if (watchers_.contains(device)) return watchers_.value(device);
 
-  QObject::connect(watcher_, &CollectionWatcher::NewOrUpdatedSongs, &*backend_, &CollectionBackend::AddOrUpdateSongs);
-  QObject::connect(watcher_, &CollectionWatcher::SongsMTimeUpdated, &*backend_, &CollectionBackend::UpdateMTimesOnly);
-  QObject::connect(watcher_, &CollectionWatcher::SongsDeleted, &*backend_, &CollectionBackend::DeleteSongs);
-  QObject::connect(watcher_, &CollectionWatcher::SongsUnavailable, &*backend_, &CollectionBackend::MarkSongsUnavailable);
-  QObject::connect(watcher_, &CollectionWatcher::SongsReadded, &*backend_, &CollectionBackend::MarkSongsUnavailable);
-  QObject::connect(watcher_, &CollectionWatcher::SubdirsDiscovered, &*backend_, &CollectionBackend::AddOrUpdateSubdirs);
-  QObject::connect(watcher_, &CollectionWatcher::SubdirsMTimeUpdated, &*backend_, &CollectionBackend::AddOrUpdateSubdirs);
-  QObject::connect(watcher_, &CollectionWatcher::CompilationsNeedUpdating, &*backend_, &CollectionBackend::CompilationsNeedUpdating);
-  QObject::connect(watcher_, &CollectionWatcher::UpdateLastSeen, &*backend_, &CollectionBackend::UpdateLastSeen);
+  CollectionWatcher *watcher = new CollectionWatcher(Song::Source::Collection);
+  Thread *watcher_thread = new Thread(this);
 
-  QObject::connect(&*app_->lastfm_import(), &LastFMImport::UpdateLastPlayed, &*backend_, &CollectionBackend::UpdateLastPlayed);
-  QObject::connect(&*app_->lastfm_import(), &LastFMImport::UpdatePlayCount, &*backend_, &CollectionBackend::UpdatePlayCount);
+  watcher_thread->SetIoPriority(Utilities::IoPriority::IOPRIO_CLASS_IDLE);
 
-  // This will start the watcher checking for updates
-  backend_->LoadDirectoriesAsync();
+  watcher->moveToThread(watcher_thread);
+
+  qLog(Debug) << watcher << "for device" << device << "moved to thread" << watcher_thread;
+
+  watcher_thread->start(QThread::IdlePriority);
+
+  watcher->set_backend(backend_);
+  watcher->set_task_manager(app_->task_manager());
+
+  QObject::connect(watcher, &CollectionWatcher::NewOrUpdatedSongs, &*backend_, &CollectionBackend::AddOrUpdateSongs);
+  QObject::connect(watcher, &CollectionWatcher::SongsMTimeUpdated, &*backend_, &CollectionBackend::UpdateMTimesOnly);
+  QObject::connect(watcher, &CollectionWatcher::SongsDeleted, &*backend_, &CollectionBackend::DeleteSongs);
+  QObject::connect(watcher, &CollectionWatcher::SongsUnavailable, &*backend_, &CollectionBackend::MarkSongsUnavailable);
+  QObject::connect(watcher, &CollectionWatcher::SongsReadded, &*backend_, &CollectionBackend::MarkSongsUnavailable);
+  QObject::connect(watcher, &CollectionWatcher::SubdirsDiscovered, &*backend_, &CollectionBackend::AddOrUpdateSubdirs);
+  QObject::connect(watcher, &CollectionWatcher::SubdirsMTimeUpdated, &*backend_, &CollectionBackend::AddOrUpdateSubdirs);
+  QObject::connect(watcher, &CollectionWatcher::CompilationsNeedUpdating, &*backend_, &CollectionBackend::CompilationsNeedUpdating);
+  QObject::connect(watcher, &CollectionWatcher::UpdateLastSeen, &*backend_, &CollectionBackend::UpdateLastSeen);
+  QObject::connect(watcher, &CollectionWatcher::ScanStarted, &*backend_, &CollectionBackend::ClearScanJournal);
+  QObject::connect(watcher, &CollectionWatcher::ScanCheckpoint, &*backend_, &CollectionBackend::AddToScanJournal);
+  QObject::connect(watcher, &CollectionWatcher::ScanCompleted, &*backend_, &CollectionBackend::ClearScanJournal);
+  QObject::connect(watcher, &CollectionWatcher::BestAlbumArtPicked, &*backend_, &CollectionBackend::UpdateBestAlbumArt);
+  QObject::connect(watcher, &CollectionWatcher::DirectoryScanned, analysis_queue_, &CollectionAnalysisQueue::AnalyzeDirectory);
+
+  if (watchers_paused_) watcher->SetRescanPausedAsync(true);
+
+  watchers_.insert(device, watcher);
+  watcher_threads_ << watcher_thread;
+
+  return watcher;
+
+}
+
+void SCollection::DirectoryDiscovered(const CollectionDirectory &dir, const CollectionSubdirectoryList &subdirs) {
+
+  // Directories that aren't mounted yet get the device of the parent mount, they're moved when they're discovered again.
+  const QString device = QString::fromUtf8(QStorageInfo(dir.path).device());
+  if (directory_devices_.contains(dir.id) && directory_devices_.value(dir.id) != device) {
+    DirectoryDeleted(dir);
+  }
+  directory_devices_.insert(dir.id, device);
+
+  CollectionWatcher *watcher = WatcherForDevice(device);
+  QMetaObject::invokeMethod(watcher, [watcher, dir, subdirs]() { watcher->AddDirectory(dir, subdirs); }, Qt::QueuedConnection);
+
+}
+
+void SCollection::DirectoryDeleted(const CollectionDirectory &dir) {
+
+  if (!directory_devices_.contains(dir.id)) return;
+
+  CollectionWatcher *watcher = watchers_.value(directory_devices_.take(dir.id));
+  if (watcher) {
+    QMetaObject::invokeMethod(watcher, [watcher, dir]() { watcher->RemoveDirectory(dir); }, Qt::QueuedConnection);
+  }
 
 }
 
 void SCollection::Exit() {
 
-  wait_for_exit_ << &*backend_ << watcher_;
+  wait_for_exit_ << &*backend_;
+  for (CollectionWatcher *watcher : std::as_const(watchers_)) {
+    wait_for_exit_ << watcher;
+  }
 
-  QObject::disconnect(&*backend_, nullptr, watcher_, nullptr);
-  QObject::disconnect(watcher_, nullptr, &*backend_, nullptr);
+  analysis_queue_->Stop();
+  QObject::disconnect(analysis_queue_, nullptr, &*backend_, nullptr);
+
+  QObject::disconnect(&*backend_, &CollectionBackend::DirectoryDiscovered, this, &SCollection::DirectoryDiscovered);
+  QObject::disconnect(&*backend_, &CollectionBackend::DirectoryDeleted, this, &SCollection::DirectoryDeleted);
 
   QObject::connect(&*backend_, &CollectionBackend::ExitFinished, this, &SCollection::ExitReceived);
-  QObject::connect(watcher_, &CollectionWatcher::ExitFinished, this, &SCollection::ExitReceived);
   backend_->ExitAsync();
-  watcher_->Abort();
-  watcher_->ExitAsync();
+
+  for (CollectionWatcher *watcher : std::as_const(watchers_)) {
+    QObject::disconnect(watcher, nullptr, &*backend_, nullptr);
+    QObject::connect(watcher, &CollectionWatcher::ExitFinished, this, &SCollection::ExitReceived);
+    watcher->Abort();
+    watcher->ExitAsync();
+  }
 
 }
 
@@ -156,29 +223,74 @@ void SCollection::ExitReceived() {
 
 }
 
-void SCollection::IncrementalScan() { watcher_->IncrementalScanAsync(); }
+void SCollection::IncrementalScan() {
+
+  for (CollectionWatcher *watcher : std::as_const(watchers_)) {
+    watcher->IncrementalScanAsync();
+  }
+
+}
 
-void SCollection::FullScan() { watcher_->FullScanAsync(); }
+void SCollection::FullScan() {
 
-void SCollection::AbortScan() { watcher_->Stop(); }
+  for (CollectionWatcher *watcher : std::as_const(watchers_)) {
+    watcher->FullScanAsync();
+  }
+
+}
+
+void SCollection::AbortScan() {
+
+  for (CollectionWatcher *watcher : std::as_const(watchers_)) {
+    watcher->Stop();
+  }
+
+}
 
 void SCollection::Rescan(const SongList &songs) {
 
   qLog(Debug) << "Rescan" << songs.size() << "songs";
-  if (!songs.isEmpty()) {
-    watcher_->RescanSongsAsync(songs);
+
+  // Each watcher rescans the songs in its own directories.
+  QMap<QString, SongList> device_songs;
+  for (const Song &song : songs) {
+    device_songs[directory_devices_.value(song.directory_id())] << song;
+  }
+
+  for (QMap<QString, SongList>::const_iterator it = device_songs.constBegin(); it != device_songs.constEnd(); ++it) {
+    CollectionWatcher *watcher = watchers_.value(it.key(), watchers_.isEmpty() ? nullptr : watchers_.first());
+    if (watcher) {
+      watcher->RescanSongsAsync(it.value());
+    }
+  }
+
+}
+
+void SCollection::PauseWatcher() {
+
+  watchers_paused_ = true;
+  for (CollectionWatcher *watcher : std::as_const(watchers_)) {
+    watcher->SetRescanPausedAsync(true);
   }
 
 }
 
-void SCollection::PauseWatcher() { watcher_->SetRescanPausedAsync(true); }
+void SCollection::ResumeWatcher() {
 
-void SCollection::ResumeWatcher() { watcher_->SetRescanPausedAsync(false); }
+  watchers_paused_ = false;
+  for (CollectionWatcher *watcher : std::as_const(watchers_)) {
+    watcher->SetRescanPausedAsync(false);
+  }
+
+}
 
 void SCollection::ReloadSettings() {
 
-  watcher_->ReloadSettingsAsync();
+  for (CollectionWatcher *watcher : std::as_const(watchers_)) {
+    watcher->ReloadSettingsAsync();
+  }
   model_->ReloadSettings();
+  analysis_queue_->ReloadSettings();
 
   Settings s;
   s.beginGroup(CollectionSettingsPage::kSettingsGroup);
@@ -190,11 +302,7 @@ void SCollection::ReloadSettings() {
 
 void SCollection::SyncPlaycountAndRatingToFilesAsync() {
 
-#if QT_VERSION >= QT_VERSION_CHECK(6, 0, 0)
-  (void)QtConcurrent::run(&SCollection::SyncPlaycountAndRatingToFiles, this);
-#else
-  (void)QtConcurrent::run(this, &SCollection::SyncPlaycountAndRatingToFiles);
-#endif
+  (void)app_->task_manager()->Run(TaskManager::Pool::IO, TaskManager::Priority::Low, [this]() { SyncPlaycountAndRatingToFiles(); });
 
 }
 
@@ -205,11 +313,11 @@ void SCollection::SyncPlaycountAndRatingToFiles() {
 
   const SongList songs = backend_->GetAllSongs();
   const qint64 nb_songs = songs.size();
-  int i = 0;
-  for (const Song &song : songs) {
-    TagReaderClient::Instance()->UpdateSongPlaycountBlocking(song);
-    TagReaderClient::Instance()->UpdateSongRatingBlocking(song);
-    app_->task_manager()->SetTaskProgress(task_id, ++i, nb_songs);
+  // Write the playcount and rating together, with one file rewrite per song.
+  constexpr qint64 kChunkSize = 200;
+  for (qint64 i = 0; i < nb_songs; i += kChunkSize) {
+    TagReaderClient::Instance()->SaveFilesBlocking(songs.mid(i, kChunkSize), TagReaderClient::SaveTypes() | TagReaderClient::SaveType::PlayCount | TagReaderClient::SaveType::Rating);
+    app_->task_manager()->SetTaskProgress(task_id, std::min(i + kChunkSize, nb_songs), nb_songs);
   }
   app_->task_manager()->SetTaskFinished(task_id);
 
@@ -27,10 +27,12 @@
 #include <QObject>
 #include <QList>
 #include <QHash>
+#include <QMap>
 #include <QString>
 
 #include "core/shared_ptr.h"
 #include "core/song.h"
+#include "collectiondirectory.h"
 
 class QThread;
 class Application;
@@ -38,6 +40,7 @@ class Thread;
 class CollectionBackend;
 class CollectionModel;
 class CollectionWatcher;
+class CollectionAnalysisQueue;
 
 class SCollection : public QObject {
   Q_OBJECT
@@ -56,6 +59,7 @@ class SCollection : public QObject {
 
   SharedPtr<CollectionBackend> backend() const { return backend_; }
   CollectionModel *model() const { return model_; }
+  CollectionAnalysisQueue *analysis_queue() const { return analysis_queue_; }
 
   QString full_rescan_reason(int schema_version) const { return full_rescan_revisions_.value(schema_version, QString()); }
 
@@ -63,6 +67,7 @@ class SCollection : public QObject {
 
  private:
   void SyncPlaycountAndRatingToFiles();
+  CollectionWatcher *WatcherForDevice(const QString &device);
 
  public slots:
   void ReloadSettings();
@@ -78,6 +83,8 @@ class SCollection : public QObject {
 
  private slots:
   void ExitReceived();
+  void DirectoryDiscovered(const CollectionDirectory &dir, const CollectionSubdirectoryList &subdirs);
+  void DirectoryDeleted(const CollectionDirectory &dir);
   void SongsPlaycountChanged(const SongList &songs, const bool save_tags = false);
   void SongsRatingChanged(const SongList &songs, const bool save_tags = false);
 
@@ -90,10 +97,16 @@ class SCollection : public QObject {
   SharedPtr<CollectionBackend> backend_;
   CollectionModel *model_;
 
-  CollectionWatcher *watcher_;
-  Thread *watcher_thread_;
+  // There is one watcher with its own thread for each storage device, the directories on one device are scanned one after another,
+  // while directories on different devices are scanned at the same time.
+  QMap<QString, CollectionWatcher*> watchers_;
+  QList<Thread*> watcher_threads_;
+  QHash<int, QString> directory_devices_;
+  bool watchers_paused_;
   QThread *original_thread_;
 
+  CollectionAnalysisQueue *analysis_queue_;
+
   // DB schema versions which should trigger a full collection rescan (each of those with a short reason why).
   QHash<int, QString> full_rescan_revisions_;
 
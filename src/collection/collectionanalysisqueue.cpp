@@ -0,0 +1,205 @@
+/*
+ * Strawberry Music Player
+ *
+ * Strawberry is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Strawberry is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Strawberry.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+
+#include "config.h"
+
+#include <utility>
+#include <chrono>
+
+#include <QtGlobal>
+#include <QObject>
+#include <QThreadPool>
+#include <QFuture>
+#include <QFutureWatcher>
+#include <QPointer>
+#include <QTimer>
+#include <QString>
+
+#include "core/logging.h"
+#include "core/settings.h"
+#include "core/taskmanager.h"
+#include "collectionbackend.h"
+#include "collectionanalysisqueue.h"
+#include "settings/collectionsettingspage.h"
+#if defined(HAVE_SONGFINGERPRINTING) || defined(HAVE_EBUR128)
+#  include "engine/songanalysis.h"
+#endif
+
+using namespace std::chrono_literals;
+
+namespace {
+constexpr int kResultsBatchSize = 50;
+}  // namespace
+
+CollectionAnalysisQueue::CollectionAnalysisQueue(SharedPtr<TaskManager> task_manager, SharedPtr<CollectionBackend> backend, QObject *parent)
+    : QObject(parent),
+      task_manager_(task_manager),
+      backend_(backend),
+      timer_flush_results_(new QTimer(this)),
+      song_tracking_(false),
+      song_ebur128_loudness_analysis_(false),
+      paused_(false),
+      running_jobs_(0) {
+
+  timer_flush_results_->setSingleShot(true);
+  timer_flush_results_->setInterval(5s);
+  QObject::connect(timer_flush_results_, &QTimer::timeout, this, &CollectionAnalysisQueue::FlushResults);
+
+  ReloadSettings();
+
+}
+
+CollectionAnalysisQueue::~CollectionAnalysisQueue() {
+
+  Stop();
+
+}
+
+void CollectionAnalysisQueue::ReloadSettings() {
+
+  Settings s;
+  s.beginGroup(CollectionSettingsPage::kSettingsGroup);
+#ifdef HAVE_SONGFINGERPRINTING
+  song_tracking_ = s.value("song_tracking", false).toBool();
+#endif
+#ifdef HAVE_EBUR128
+  song_ebur128_loudness_analysis_ = s.value("song_ebur128_loudness_analysis", false).toBool();
+#endif
+  s.endGroup();
+
+}
+
+void CollectionAnalysisQueue::AnalyzeDirectory(const int directory_id) {
+
+  if (!song_tracking_ && !song_ebur128_loudness_analysis_) return;
+
+  // Query the songs in the backend thread, so the songs from the scan are already written.
+  QPointer<CollectionAnalysisQueue> analysis_queue(this);
+  SharedPtr<CollectionBackend> backend = backend_;
+  const bool song_tracking = song_tracking_;
+  const bool song_ebur128_loudness_analysis = song_ebur128_loudness_analysis_;
+  QMetaObject::invokeMethod(&*backend_, [analysis_queue, backend, directory_id, song_tracking, song_ebur128_loudness_analysis]() {
+    SongList songs;
+    if (song_tracking) {
+      songs << backend->SongsWithMissingFingerprint(directory_id);
+    }
+    if (song_ebur128_loudness_analysis) {
+      songs << backend->SongsWithMissingLoudnessCharacteristics(directory_id);
+    }
+    if (songs.isEmpty() || !analysis_queue) return;
+    QMetaObject::invokeMethod(analysis_queue, [analysis_queue, songs]() {
+      if (analysis_queue) analysis_queue->AnalyzeSongs(songs);
+    }, Qt::QueuedConnection);
+  }, Qt::QueuedConnection);
+
+}
+
+void CollectionAnalysisQueue::AnalyzeSongs(const SongList &songs) {
+
+  for (const Song &song : songs) {
+    if (!song.is_valid() || song.id() == -1 || queued_ids_.contains(song.id())) continue;
+    queued_ids_.insert(song.id());
+    queue_ << song;
+  }
+
+  qLog(Debug) << queue_.count() << "songs queued for analysis";
+
+  StartJobs();
+
+}
+
+void CollectionAnalysisQueue::SetPaused(const bool paused) {
+
+  paused_ = paused;
+
+  if (!paused_) {
+    StartJobs();
+  }
+
+}
+
+void CollectionAnalysisQueue::Stop() {
+
+  for (const Song &song : std::as_const(queue_)) {
+    queued_ids_.remove(song.id());
+  }
+  queue_.clear();
+  FlushResults();
+
+}
+
+void CollectionAnalysisQueue::StartJobs() {
+
+  // Only as many jobs as there are cores are queued, so jobs from other subsystems don't end up behind all of the analysis.
+  while (!paused_ && !queue_.isEmpty() && running_jobs_ < task_manager_->thread_pool(TaskManager::Pool::CPU)->maxThreadCount()) {
+    const Song song = queue_.takeFirst();
+    ++running_jobs_;
+    const bool fingerprint = song_tracking_;
+    const bool ebur128 = song_ebur128_loudness_analysis_;
+    QFuture<Song> future = task_manager_->Run(TaskManager::Pool::CPU, TaskManager::Priority::Low, [song, fingerprint, ebur128]() { return Analyze(song, fingerprint, ebur128); });
+    QFutureWatcher<Song> *watcher = new QFutureWatcher<Song>(this);
+    QObject::connect(watcher, &QFutureWatcher<Song>::finished, this, &CollectionAnalysisQueue::JobFinished);
+    watcher->setFuture(future);
+  }
+
+}
+
+void CollectionAnalysisQueue::JobFinished() {
+
+  QFutureWatcher<Song> *watcher = static_cast<QFutureWatcher<Song>*>(sender());
+  const Song song = watcher->result();
+  watcher->deleteLater();
+
+  --running_jobs_;
+  queued_ids_.remove(song.id());
+  results_ << song;
+
+  if (results_.count() >= kResultsBatchSize || (queue_.isEmpty() && running_jobs_ == 0)) {
+    FlushResults();
+  }
+  else if (!timer_flush_results_->isActive()) {
+    timer_flush_results_->start();
+  }
+
+  StartJobs();
+
+}
+
+void CollectionAnalysisQueue::FlushResults() {
+
+  timer_flush_results_->stop();
+
+  if (results_.isEmpty()) return;
+
+  emit SongsAnalyzed(results_);
+  results_.clear();
+
+}
+
+Song CollectionAnalysisQueue::Analyze(Song song, const bool fingerprint, const bool ebur128) {
+
+#if defined(HAVE_SONGFINGERPRINTING) || defined(HAVE_EBUR128)
+  return SongAnalysis::Analyze(song, fingerprint, ebur128);
+#else
+  Q_UNUSED(fingerprint)
+  Q_UNUSED(ebur128)
+  return song;
+#endif
+
+}
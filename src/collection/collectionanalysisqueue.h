@@ -0,0 +1,83 @@
+/*
+ * Strawberry Music Player
+ *
+ * Strawberry is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Strawberry is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Strawberry.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+
+#ifndef COLLECTIONANALYSISQUEUE_H
+#define COLLECTIONANALYSISQUEUE_H
+
+#include "config.h"
+
+#include <QObject>
+#include <QList>
+#include <QSet>
+
+#include "core/shared_ptr.h"
+#include "core/song.h"
+
+class QTimer;
+class TaskManager;
+class CollectionBackend;
+
+// Creates missing fingerprints and EBU R 128 loudness characteristics for collection songs.
+// The songs are decoded once for all analyses as low priority jobs in the CPU pool of the task manager, and the results are written to the database in batches.
+class CollectionAnalysisQueue : public QObject {
+  Q_OBJECT
+
+ public:
+  explicit CollectionAnalysisQueue(SharedPtr<TaskManager> task_manager, SharedPtr<CollectionBackend> backend, QObject *parent = nullptr);
+  ~CollectionAnalysisQueue() override;
+
+  void ReloadSettings();
+
+  bool is_paused() const { return paused_; }
+  int queued_count() const { return static_cast<int>(queue_.count()); }
+
+ public slots:
+  // Queues all songs in the directory which are missing analysis results.
+  void AnalyzeDirectory(const int directory_id);
+  void AnalyzeSongs(const SongList &songs);
+  void SetPaused(const bool paused);
+  void Stop();
+
+ signals:
+  void SongsAnalyzed(const SongList &songs);
+
+ private:
+  static Song Analyze(Song song, const bool fingerprint, const bool ebur128);
+  void StartJobs();
+
+ private slots:
+  void JobFinished();
+  void FlushResults();
+
+ private:
+  SharedPtr<TaskManager> task_manager_;
+  SharedPtr<CollectionBackend> backend_;
+  QTimer *timer_flush_results_;
+
+  bool song_tracking_;
+  bool song_ebur128_loudness_analysis_;
+  bool paused_;
+
+  SongList queue_;
+  QSet<int> queued_ids_;
+  SongList results_;
+  int running_jobs_;
+};
+
+#endif  // COLLECTIONANALYSISQUEUE_H
@@ -22,6 +22,7 @@
 #include "config.h"
 
 #include <optional>
+#include <memory>
 #include <utility>
 
 #include <QtGlobal>
@@ -30,6 +31,8 @@
 #include <QThread>
 #include <QMutex>
 #include <QSet>
+#include <QHash>
+#include <QMultiHash>
 #include <QMap>
 #include <QVector>
 #include <QVariant>
@@ -54,19 +57,51 @@
 
 #include "collectiondirectory.h"
 #include "collectionbackend.h"
+#include "collectionsimilarityindex.h"
 #include "collectionfilteroptions.h"
 #include "collectionquery.h"
 #include "collectiontask.h"
 
+using std::make_shared;
+
+namespace {
+constexpr qint64 kSongsQueryBatchSize = 500;
+constexpr qint64 kTotalsVerifyIntervalMsec = 1800000;
+// Each URL is bound in the 4 forms it could be stored in, this keeps the bound values below the SQLite limit.
+constexpr qint64 kUrlsQueryBatchSize = 200;
+
+struct PlayStatisticsSong {
+  PlayStatisticsSong() : id(-1), playcount(0) {}
+  int id;
+  QString album;
+  int playcount;
+};
+
+// Artists and titles are compared without case, like COLLATE NOCASE in GetSongsBy().
+QString PlayStatisticsKey(const QString &artist, const QString &title) {
+  return artist.toLower() + QLatin1Char('\n') + title.toLower();
+}
+
+}  // namespace
+
 CollectionBackend::CollectionBackend(QObject *parent)
     : CollectionBackendInterface(parent),
       db_(nullptr),
+      similarity_index_(make_shared<CollectionSimilarityIndex>()),
       task_manager_(nullptr),
       source_(Song::Source::Unknown),
-      original_thread_(nullptr) {
+      original_thread_(nullptr),
+      totals_loaded_(false),
+      compilations_checked_(false) {
 
   original_thread_ = thread();
 
+  QObject::connect(this, &CollectionBackend::SongsDiscovered, this, [this]() { similarity_index_->Invalidate(); }, Qt::DirectConnection);
+  QObject::connect(this, &CollectionBackend::SongsDeleted, this, [this]() { similarity_index_->Invalidate(); }, Qt::DirectConnection);
+  QObject::connect(this, &CollectionBackend::SongsStatisticsChanged, this, [this]() { similarity_index_->Invalidate(); }, Qt::DirectConnection);
+  QObject::connect(this, &CollectionBackend::SongsRatingChanged, this, [this]() { similarity_index_->Invalidate(); }, Qt::DirectConnection);
+  QObject::connect(this, &CollectionBackend::DatabaseReset, this, [this]() { similarity_index_->Invalidate(); }, Qt::DirectConnection);
+
 }
 
 CollectionBackend::~CollectionBackend() {
@@ -154,6 +189,10 @@ void CollectionBackend::ResetPlayStatisticsAsync(const QList<int> &id_list, cons
   QMetaObject::invokeMethod(this, "ResetPlayStatistics", Qt::QueuedConnection, Q_ARG(QList<int>, id_list), Q_ARG(bool, save_tags));
 }
 
+void CollectionBackend::UpdatePlayStatisticsAsync(const PlayStatisticsUpdateList &updates, const bool save_tags) {
+  QMetaObject::invokeMethod(this, [this, updates, save_tags]() { UpdatePlayStatistics(updates, save_tags); }, Qt::QueuedConnection);
+}
+
 void CollectionBackend::LoadDirectories() {
 
   const CollectionDirectoryList dirs = GetAllDirectories();
@@ -220,8 +259,8 @@ void CollectionBackend::ChangeDirPath(const int id, const QString &old_path, con
 
 CollectionDirectoryList CollectionBackend::GetAllDirectories() {
 
-  QMutexLocker l(db_->Mutex());
-  QSqlDatabase db(db_->Connect());
+  QMutexLocker l(db_->ReadMutex());
+  QSqlDatabase db(db_->ReadConnection());
 
   CollectionDirectoryList ret;
 
@@ -245,8 +284,8 @@ CollectionDirectoryList CollectionBackend::GetAllDirectories() {
 
 CollectionSubdirectoryList CollectionBackend::SubdirsInDirectory(const int id) {
 
-  QMutexLocker l(db_->Mutex());
-  QSqlDatabase db = db_->Connect();
+  QMutexLocker l(db_->ReadMutex());
+  QSqlDatabase db = db_->ReadConnection();
   return SubdirsInDirectory(id, db);
 
 }
@@ -276,61 +315,153 @@ CollectionSubdirectoryList CollectionBackend::SubdirsInDirectory(const int id, Q
 
 void CollectionBackend::UpdateTotalSongCount() {
 
-  QMutexLocker l(db_->Mutex());
-  QSqlDatabase db(db_->Connect());
+  QMutexLocker l(db_->ReadMutex());
+  QSqlDatabase db(db_->ReadConnection());
 
-  SqlQuery q(db);
-  q.prepare(QStringLiteral("SELECT COUNT(*) FROM %1 WHERE unavailable = 0").arg(songs_table_));
-  if (!q.Exec()) {
-    db_->ReportErrors(q);
-    return;
-  }
-  if (!q.next()) {
-    db_->ReportErrors(q);
-    return;
+  int count = 0;
+  {
+    QMutexLocker totals_locker(&totals_mutex_);
+    if (!totals_loaded_ && !LoadTotals(db)) return;
+    count = static_cast<int>(totals_songs_.count());
   }
 
-  emit TotalSongCountUpdated(q.value(0).toInt());
+  emit TotalSongCountUpdated(count);
 
 }
 
 void CollectionBackend::UpdateTotalArtistCount() {
 
-  QMutexLocker l(db_->Mutex());
-  QSqlDatabase db(db_->Connect());
+  QMutexLocker l(db_->ReadMutex());
+  QSqlDatabase db(db_->ReadConnection());
 
-  SqlQuery q(db);
-  q.prepare(QStringLiteral("SELECT COUNT(DISTINCT artist) FROM %1 WHERE unavailable = 0").arg(songs_table_));
-  if (!q.Exec()) {
-    db_->ReportErrors(q);
-    return;
-  }
-  if (!q.next()) {
-    db_->ReportErrors(q);
-    return;
+  int count = 0;
+  {
+    QMutexLocker totals_locker(&totals_mutex_);
+    if (!totals_loaded_ && !LoadTotals(db)) return;
+    count = static_cast<int>(totals_artists_.count());
   }
 
-  emit TotalArtistCountUpdated(q.value(0).toInt());
+  emit TotalArtistCountUpdated(count);
 
 }
 
 void CollectionBackend::UpdateTotalAlbumCount() {
 
-  QMutexLocker l(db_->Mutex());
-  QSqlDatabase db(db_->Connect());
+  QMutexLocker l(db_->ReadMutex());
+  QSqlDatabase db(db_->ReadConnection());
+
+  int count = 0;
+  {
+    QMutexLocker totals_locker(&totals_mutex_);
+    if (!totals_loaded_ && !LoadTotals(db)) return;
+    count = static_cast<int>(totals_albums_.count());
+  }
+
+  emit TotalAlbumCountUpdated(count);
+
+}
+
+bool CollectionBackend::LoadTotals(QSqlDatabase &db) {
 
   SqlQuery q(db);
-  q.prepare(QStringLiteral("SELECT COUNT(*) FROM (SELECT DISTINCT effective_albumartist, album FROM %1 WHERE unavailable = 0)").arg(songs_table_));
+  q.prepare(QStringLiteral("SELECT ROWID, artist, effective_albumartist, album FROM %1 WHERE unavailable = 0").arg(songs_table_));
   if (!q.Exec()) {
     db_->ReportErrors(q);
-    return;
+    return false;
   }
-  if (!q.next()) {
-    db_->ReportErrors(q);
-    return;
+
+  const bool verify = totals_loaded_;
+  const qint64 song_count = totals_songs_.count();
+  const qint64 artist_count = totals_artists_.count();
+  const qint64 album_count = totals_albums_.count();
+
+  totals_songs_.clear();
+  totals_artists_.clear();
+  totals_albums_.clear();
+  while (q.next()) {
+    TotalsEntry entry;
+    entry.artist = q.value(1).toString();
+    entry.album_key = q.value(2).toString() + QLatin1Char('\n') + q.value(3).toString();
+    ++totals_artists_[entry.artist];
+    ++totals_albums_[entry.album_key];
+    totals_songs_.insert(q.value(0).toInt(), entry);
+  }
+
+  if (verify && (song_count != totals_songs_.count() || artist_count != totals_artists_.count() || album_count != totals_albums_.count())) {
+    qLog(Warning) << "Corrected" << Song::TextForSource(source_) << "totals from" << song_count << artist_count << album_count << "to" << totals_songs_.count() << totals_artists_.count() << totals_albums_.count();
+  }
+
+  totals_loaded_ = true;
+  totals_verified_.start();
+
+  return true;
+
+}
+
+void CollectionBackend::AddToTotals(const Song &song) {
+
+  TotalsEntry entry;
+  entry.artist = song.artist();
+  entry.album_key = song.effective_albumartist() + QLatin1Char('\n') + song.album();
+  ++totals_artists_[entry.artist];
+  ++totals_albums_[entry.album_key];
+  totals_songs_.insert(song.id(), entry);
+
+}
+
+void CollectionBackend::RemoveFromTotals(const int id) {
+
+  QHash<int, TotalsEntry>::iterator it = totals_songs_.find(id);
+  if (it == totals_songs_.end()) return;
+
+  QHash<QString, int>::iterator artist_it = totals_artists_.find(it->artist);
+  if (artist_it != totals_artists_.end() && --artist_it.value() <= 0) {
+    totals_artists_.erase(artist_it);
+  }
+  QHash<QString, int>::iterator album_it = totals_albums_.find(it->album_key);
+  if (album_it != totals_albums_.end() && --album_it.value() <= 0) {
+    totals_albums_.erase(album_it);
+  }
+
+  totals_songs_.erase(it);
+
+}
+
+void CollectionBackend::UpdateTotals(const SongList &removed_songs, const SongList &added_songs) {
+
+  QMutexLocker l(&totals_mutex_);
+
+  // Until the totals are loaded there's nothing to update, they are read in full the next time they are emitted.
+  if (!totals_loaded_) return;
+
+  for (const Song &song : removed_songs) {
+    RemoveFromTotals(song.id());
+  }
+  for (const Song &song : added_songs) {
+    if (song.id() == -1 || song.unavailable()) continue;
+    RemoveFromTotals(song.id());
+    AddToTotals(song);
+  }
+
+}
+
+void CollectionBackend::EmitTotals(QSqlDatabase &db) {
+
+  int song_count = 0;
+  int artist_count = 0;
+  int album_count = 0;
+  {
+    QMutexLocker l(&totals_mutex_);
+    // Verify the incremental totals against the database now and then.
+    if ((!totals_loaded_ || totals_verified_.hasExpired(kTotalsVerifyIntervalMsec)) && !LoadTotals(db)) return;
+    song_count = static_cast<int>(totals_songs_.count());
+    artist_count = static_cast<int>(totals_artists_.count());
+    album_count = static_cast<int>(totals_albums_.count());
   }
 
-  emit TotalAlbumCountUpdated(q.value(0).toInt());
+  emit TotalSongCountUpdated(song_count);
+  emit TotalArtistCountUpdated(artist_count);
+  emit TotalAlbumCountUpdated(album_count);
 
 }
 
@@ -379,6 +510,16 @@ void CollectionBackend::RemoveDirectory(const CollectionDirectory &dir) {
     }
   }
 
+  if (source_ == Song::Source::Collection) {
+    SqlQuery q(db);
+    q.prepare(QStringLiteral("DELETE FROM scan_journal WHERE directory_id = :id"));
+    q.BindValue(QStringLiteral(":id"), dir.id);
+    if (!q.Exec()) {
+      db_->ReportErrors(q);
+      return;
+    }
+  }
+
   // Now remove the directory itself
   {
     SqlQuery q(db);
@@ -398,8 +539,8 @@ void CollectionBackend::RemoveDirectory(const CollectionDirectory &dir) {
 
 SongList CollectionBackend::FindSongsInDirectory(const int id) {
 
-  QMutexLocker l(db_->Mutex());
-  QSqlDatabase db(db_->Connect());
+  QMutexLocker l(db_->ReadMutex());
+  QSqlDatabase db(db_->ReadConnection());
 
   SqlQuery q(db);
   q.prepare(QStringLiteral("SELECT %1 FROM %2 WHERE directory_id = :directory_id").arg(Song::kRowIdColumnSpec, songs_table_));
@@ -410,9 +551,10 @@ SongList CollectionBackend::FindSongsInDirectory(const int id) {
   }
 
   SongList ret;
+  const Song::QueryColumns columns(q.record());
   while (q.next()) {
     Song song(source_);
-    song.InitFromQuery(q, true);
+    song.InitFromQuery(q, columns, true);
     ret << song;
   }
   return ret;
@@ -421,8 +563,8 @@ SongList CollectionBackend::FindSongsInDirectory(const int id) {
 
 SongList CollectionBackend::SongsWithMissingFingerprint(const int id) {
 
-  QMutexLocker l(db_->Mutex());
-  QSqlDatabase db(db_->Connect());
+  QMutexLocker l(db_->ReadMutex());
+  QSqlDatabase db(db_->ReadConnection());
 
   SqlQuery q(db);
   q.prepare(QStringLiteral("SELECT %1 FROM %2 WHERE directory_id = :directory_id AND unavailable = 0 AND (fingerprint IS NULL OR fingerprint = '')").arg(Song::kRowIdColumnSpec, songs_table_));
@@ -433,9 +575,10 @@ SongList CollectionBackend::SongsWithMissingFingerprint(const int id) {
   }
 
   SongList ret;
+  const Song::QueryColumns columns(q.record());
   while (q.next()) {
     Song song(source_);
-    song.InitFromQuery(q, true);
+    song.InitFromQuery(q, columns, true);
     ret << song;
   }
   return ret;
@@ -444,8 +587,8 @@ SongList CollectionBackend::SongsWithMissingFingerprint(const int id) {
 
 SongList CollectionBackend::SongsWithMissingLoudnessCharacteristics(const int id) {
 
-  QMutexLocker l(db_->Mutex());
-  QSqlDatabase db(db_->Connect());
+  QMutexLocker l(db_->ReadMutex());
+  QSqlDatabase db(db_->ReadConnection());
 
   SqlQuery q(db);
   q.prepare(QStringLiteral("SELECT %1 FROM %2 WHERE directory_id = :directory_id AND unavailable = 0 AND (ebur128_integrated_loudness_lufs IS NULL OR ebur128_loudness_range_lu IS NULL)").arg(Song::kRowIdColumnSpec, songs_table_));
@@ -456,28 +599,29 @@ SongList CollectionBackend::SongsWithMissingLoudnessCharacteristics(const int id
   }
 
   SongList ret;
+  const Song::QueryColumns columns(q.record());
   while (q.next()) {
     Song song(source_);
-    song.InitFromQuery(q, true);
+    song.InitFromQuery(q, columns, true);
     ret << song;
   }
   return ret;
 
 }
 
-void CollectionBackend::SongPathChanged(const Song &song, const QFileInfo &new_file, const std::optional<int> new_collection_directory_id) {
+void CollectionBackend::SongPathsChanged(const SongList &songs) {
 
-  // Take a song and update its path
-  Song updated_song = song;
-  updated_song.set_source(source_);
-  updated_song.set_url(QUrl::fromLocalFile(new_file.absoluteFilePath()));
-  updated_song.set_basefilename(new_file.fileName());
-  updated_song.InitArtManual();
-  if (updated_song.is_collection_song() && new_collection_directory_id) {
-    updated_song.set_directory_id(new_collection_directory_id.value());
+  // Take the songs that have their new path set, and update them in one go
+  SongList updated_songs;
+  updated_songs.reserve(songs.count());
+  for (const Song &song : songs) {
+    Song updated_song = song;
+    updated_song.set_source(source_);
+    updated_song.InitArtManual();
+    updated_songs << updated_song;
   }
 
-  AddOrUpdateSongs(SongList() << updated_song);
+  AddOrUpdateSongs(updated_songs);
 
 }
 
@@ -545,8 +689,8 @@ void CollectionBackend::AddOrUpdateSubdirs(const CollectionSubdirectoryList &sub
 
 SongList CollectionBackend::GetAllSongs() {
 
-  QMutexLocker l(db_->Mutex());
-  QSqlDatabase db(db_->Connect());
+  QMutexLocker l(db_->ReadMutex());
+  QSqlDatabase db(db_->ReadConnection());
 
   SqlQuery q(db);
   q.prepare(QStringLiteral("SELECT %1 FROM %2").arg(Song::kRowIdColumnSpec, songs_table_));
@@ -556,9 +700,10 @@ SongList CollectionBackend::GetAllSongs() {
   }
 
   SongList songs;
+  const Song::QueryColumns columns(q.record());
   while (q.next()) {
     Song song;
-    song.InitFromQuery(q, true);
+    song.InitFromQuery(q, columns, true);
     songs << song;
   }
   return songs;
@@ -576,143 +721,143 @@ void CollectionBackend::AddOrUpdateSongs(const SongList &songs) {
 
   ScopedTransaction transaction(&db);
 
+  // Do a sanity check first - make sure the song's directory still exists
+  // This is to fix a possible race condition when a directory is removed while CollectionWatcher is scanning it.
+  QSet<int> directory_ids;
+  if (!dirs_table_.isEmpty()) {
+    SqlQuery q(db);
+    q.prepare(QStringLiteral("SELECT ROWID FROM %1").arg(dirs_table_));
+    if (!q.Exec()) {
+      db_->ReportErrors(q);
+      return;
+    }
+    while (q.next()) {
+      directory_ids.insert(q.value(0).toInt());
+    }
+  }
+
+  // Get the previous song data for the whole batch first.
+  QStringList ids;
+  QStringList song_ids;
+  for (const Song &song : songs) {
+    if (song.id() != -1) {
+      ids << QString::number(song.id());
+    }
+    else if (!song.song_id().isEmpty()) {
+      song_ids << song.song_id();
+    }
+  }
+  QHash<int, Song> old_songs_by_id;
+  for (qint64 i = 0; i < ids.count(); i += kSongsQueryBatchSize) {
+    const SongList old_songs = GetSongsById(ids.mid(i, kSongsQueryBatchSize), db);
+    for (const Song &old_song : old_songs) {
+      old_songs_by_id.insert(old_song.id(), old_song);
+    }
+  }
+  QHash<QString, Song> old_songs_by_song_id;
+  for (qint64 i = 0; i < song_ids.count(); i += kSongsQueryBatchSize) {
+    const SongList old_songs = GetSongsBySongId(song_ids.mid(i, kSongsQueryBatchSize), db);
+    for (const Song &old_song : old_songs) {
+      old_songs_by_song_id.insert(old_song.song_id(), old_song);
+    }
+  }
+
+  // Prepare the statements once and reuse them for every song.
+  SqlQuery update(db);
+  update.prepare(QStringLiteral("UPDATE %1 SET %2 WHERE ROWID = :id").arg(songs_table_, Song::kUpdateSpec));
+  SqlQuery update_fts(db);
+  update_fts.prepare(QStringLiteral("UPDATE %1 SET %2 WHERE ROWID = :id").arg(fts_table_, Song::kFtsUpdateSpec));
+  SqlQuery insert(db);
+  insert.prepare(QStringLiteral("INSERT INTO %1 (%2) VALUES (%3)").arg(songs_table_, Song::kColumnSpec, Song::kBindSpec));
+  SqlQuery insert_fts(db);
+  insert_fts.prepare(QStringLiteral("INSERT INTO %1 (ROWID, %2) VALUES (:id, %3)").arg(fts_table_, Song::kFtsColumnSpec, Song::kFtsBindSpec));
+
   SongList added_songs;
   SongList deleted_songs;
 
   for (const Song &song : songs) {
 
-    // Do a sanity check first - make sure the song's directory still exists
-    // This is to fix a possible race condition when a directory is removed while CollectionWatcher is scanning it.
-    if (!dirs_table_.isEmpty()) {
-      SqlQuery check_dir(db);
-      check_dir.prepare(QStringLiteral("SELECT ROWID FROM %1 WHERE ROWID = :id").arg(dirs_table_));
-      check_dir.BindValue(QStringLiteral(":id"), song.directory_id());
-      if (!check_dir.Exec()) {
-        db_->ReportErrors(check_dir);
-        return;
-      }
-
-      if (!check_dir.next()) continue;
+    if (!dirs_table_.isEmpty() && !directory_ids.contains(song.directory_id())) continue;
 
+    Song old_song;
+    if (song.id() != -1) {  // This song exists in the DB.
+      old_song = old_songs_by_id.value(song.id());
+      if (!old_song.is_valid()) continue;
+    }
+    else if (!song.song_id().isEmpty()) {  // Song has a unique id, check if the song exists.
+      old_song = old_songs_by_song_id.value(song.song_id());
     }
 
-    if (song.id() != -1) {  // This song exists in the DB.
+    if (old_song.is_valid() && old_song.id() != -1) {
 
-      // Get the previous song data first
-      Song old_song(GetSongById(song.id()));
-      if (!old_song.is_valid()) continue;
+      Song new_song = song;
+      new_song.set_id(old_song.id());
 
       // Update
-      {
-        SqlQuery q(db);
-        q.prepare(QStringLiteral("UPDATE %1 SET %2 WHERE ROWID = :id").arg(songs_table_, Song::kUpdateSpec));
-        song.BindToQuery(&q);
-        q.BindValue(QStringLiteral(":id"), song.id());
-        if (!q.Exec()) {
-          db_->ReportErrors(q);
-          return;
-        }
+      new_song.BindToQuery(&update);
+      update.BindValue(QStringLiteral(":id"), new_song.id());
+      if (!update.Exec()) {
+        db_->ReportErrors(update);
+        return;
       }
 
-      {
-        SqlQuery q(db);
-        q.prepare(QStringLiteral("UPDATE %1 SET %2 WHERE ROWID = :id").arg(fts_table_, Song::kFtsUpdateSpec));
-        song.BindToFtsQuery(&q);
-        q.BindValue(QStringLiteral(":id"), song.id());
-        if (!q.Exec()) {
-          db_->ReportErrors(q);
-          return;
-        }
+      new_song.BindToFtsQuery(&update_fts);
+      update_fts.BindValue(QStringLiteral(":id"), new_song.id());
+      if (!update_fts.Exec()) {
+        db_->ReportErrors(update_fts);
+        return;
       }
 
+      // The same song might be updated again later in the batch.
+      old_songs_by_id.insert(new_song.id(), new_song);
+      if (!new_song.song_id().isEmpty()) old_songs_by_song_id.insert(new_song.song_id(), new_song);
+
       deleted_songs << old_song;
-      added_songs << song;
+      added_songs << new_song;
 
       continue;
 
     }
-    else if (!song.song_id().isEmpty()) {  // Song has a unique id, check if the song exists.
-
-      // Get the previous song data first
-      Song old_song(GetSongBySongId(song.song_id()));
-
-      if (old_song.is_valid() && old_song.id() != -1) {
-
-        Song new_song = song;
-        new_song.set_id(old_song.id());
-
-        // Update
-        {
-          SqlQuery q(db);
-          q.prepare(QStringLiteral("UPDATE %1 SET %2 WHERE ROWID = :id").arg(songs_table_, Song::kUpdateSpec));
-          new_song.BindToQuery(&q);
-          q.BindValue(QStringLiteral(":id"), new_song.id());
-          if (!q.Exec()) {
-            db_->ReportErrors(q);
-            return;
-          }
-        }
-
-        {
-          SqlQuery q(db);
-          q.prepare(QStringLiteral("UPDATE %1 SET %2 WHERE ROWID = :id").arg(fts_table_, Song::kFtsUpdateSpec));
-          new_song.BindToFtsQuery(&q);
-          q.BindValue(QStringLiteral(":id"), new_song.id());
-          if (!q.Exec()) {
-            db_->ReportErrors(q);
-            return;
-          }
-        }
-
-        deleted_songs << old_song;
-        added_songs << new_song;
-
-        continue;
-      }
-    }
 
     // Create new song
 
-    int id = -1;
-    {  // Insert the row and create a new ID
-      SqlQuery q(db);
-      q.prepare(QStringLiteral("INSERT INTO %1 (%2) VALUES (%3)").arg(songs_table_, Song::kColumnSpec, Song::kBindSpec));
-      song.BindToQuery(&q);
-      if (!q.Exec()) {
-        db_->ReportErrors(q);
-        return;
-      }
-      // Get the new ID
-      id = q.lastInsertId().toInt();
+    // Insert the row and create a new ID
+    song.BindToQuery(&insert);
+    if (!insert.Exec()) {
+      db_->ReportErrors(insert);
+      return;
     }
+    // Get the new ID
+    const int id = insert.lastInsertId().toInt();
 
     if (id == -1) return;
 
-    {  // Add to the FTS index
-      SqlQuery q(db);
-      q.prepare(QStringLiteral("INSERT INTO %1 (ROWID, %2) VALUES (:id, %3)").arg(fts_table_, Song::kFtsColumnSpec, Song::kFtsBindSpec));
-      q.BindValue(QStringLiteral(":id"), id);
-      song.BindToFtsQuery(&q);
-      if (!q.Exec()) {
-        db_->ReportErrors(q);
-        return;
-      }
+    // Add to the FTS index
+    insert_fts.BindValue(QStringLiteral(":id"), id);
+    song.BindToFtsQuery(&insert_fts);
+    if (!insert_fts.Exec()) {
+      db_->ReportErrors(insert_fts);
+      return;
     }
 
     Song song_copy(song);
     song_copy.set_id(id);
+    old_songs_by_id.insert(id, song_copy);
+    if (!song_copy.song_id().isEmpty()) old_songs_by_song_id.insert(song_copy.song_id(), song_copy);
     added_songs << song_copy;
 
   }
 
   transaction.Commit();
 
+  UpdateTotals(deleted_songs, added_songs);
+  AddCompilationAlbums(deleted_songs);
+  AddCompilationAlbums(added_songs);
+
   if (!deleted_songs.isEmpty()) emit SongsDeleted(deleted_songs);
   if (!added_songs.isEmpty()) emit SongsDiscovered(added_songs);
 
-  UpdateTotalSongCountAsync();
-  UpdateTotalArtistCountAsync();
-  UpdateTotalAlbumCountAsync();
+  EmitTotals(db);
 
 }
 
@@ -839,12 +984,14 @@ void CollectionBackend::UpdateSongsBySongID(const SongMap &new_songs) {
 
   transaction.Commit();
 
+  UpdateTotals(deleted_songs, added_songs);
+  AddCompilationAlbums(deleted_songs);
+  AddCompilationAlbums(added_songs);
+
   if (!deleted_songs.isEmpty()) emit SongsDeleted(deleted_songs);
   if (!added_songs.isEmpty()) emit SongsDiscovered(added_songs);
 
-  UpdateTotalSongCountAsync();
-  UpdateTotalArtistCountAsync();
-  UpdateTotalAlbumCountAsync();
+  EmitTotals(db);
 
 }
 
@@ -854,11 +1001,44 @@ void CollectionBackend::UpdateMTimesOnly(const SongList &songs) {
   QSqlDatabase db(db_->Connect());
 
   SqlQuery q(db);
-  q.prepare(QStringLiteral("UPDATE %1 SET mtime = :mtime WHERE ROWID = :id").arg(songs_table_));
+  q.prepare(QStringLiteral("UPDATE %1 SET mtime = :mtime, content_hash = :content_hash WHERE ROWID = :id").arg(songs_table_));
 
   ScopedTransaction transaction(&db);
   for (const Song &song : songs) {
     q.BindValue(QStringLiteral(":mtime"), song.mtime());
+    q.BindValue(QStringLiteral(":content_hash"), song.content_hash().isEmpty() ? QVariant() : QVariant(song.content_hash()));
+    q.BindValue(QStringLiteral(":id"), song.id());
+    if (!q.Exec()) {
+      db_->ReportErrors(q);
+      return;
+    }
+  }
+  transaction.Commit();
+
+}
+
+void CollectionBackend::UpdateAnalysisResults(const SongList &songs) {
+
+  QMutexLocker l(db_->Mutex());
+  QSqlDatabase db(db_->Connect());
+
+  SqlQuery q(db);
+  q.prepare(QStringLiteral("UPDATE %1 SET fingerprint = :fingerprint, ebur128_integrated_loudness_lufs = :ebur128_integrated_loudness_lufs, ebur128_loudness_range_lu = :ebur128_loudness_range_lu WHERE ROWID = :id").arg(songs_table_));
+
+  QStringList ids;
+  ids.reserve(songs.count());
+  for (const Song &song : songs) {
+    ids << QString::number(song.id());
+  }
+
+  // The songs are replaced in the model and playlists, so the new loudness characteristics are used without a restart.
+  const SongList old_songs = GetSongsById(ids, db);
+
+  ScopedTransaction transaction(&db);
+  for (const Song &song : songs) {
+    q.BindStringValue(QStringLiteral(":fingerprint"), song.fingerprint());
+    q.BindDoubleOrNullValue(QStringLiteral(":ebur128_integrated_loudness_lufs"), song.ebur128_integrated_loudness_lufs());
+    q.BindDoubleOrNullValue(QStringLiteral(":ebur128_loudness_range_lu"), song.ebur128_loudness_range_lu());
     q.BindValue(QStringLiteral(":id"), song.id());
     if (!q.Exec()) {
       db_->ReportErrors(q);
@@ -867,6 +1047,11 @@ void CollectionBackend::UpdateMTimesOnly(const SongList &songs) {
   }
   transaction.Commit();
 
+  const SongList new_songs = GetSongsById(ids, db);
+
+  if (!old_songs.isEmpty()) emit SongsDeleted(old_songs);
+  if (!new_songs.isEmpty()) emit SongsDiscovered(new_songs);
+
 }
 
 void CollectionBackend::DeleteSongs(const SongList &songs) {
@@ -895,11 +1080,44 @@ void CollectionBackend::DeleteSongs(const SongList &songs) {
   }
   transaction.Commit();
 
+  UpdateTotals(songs, SongList());
+  AddCompilationAlbums(songs);
+
   emit SongsDeleted(songs);
 
-  UpdateTotalSongCountAsync();
-  UpdateTotalArtistCountAsync();
-  UpdateTotalAlbumCountAsync();
+  EmitTotals(db);
+
+}
+
+void CollectionBackend::ReplaceSongsInDirectory(const int directory_id, const SongList &songs) {
+
+  QHash<QUrl, Song> old_songs;
+  const SongList songs_in_directory = FindSongsInDirectory(directory_id);
+  for (const Song &song : songs_in_directory) {
+    old_songs.insert(song.url(), song);
+  }
+
+  SongList changed_songs;
+  for (const Song &song : songs) {
+    if (old_songs.contains(song.url())) {
+      const Song old_song = old_songs.take(song.url());
+      if (song.IsAllMetadataEqual(old_song)) continue;
+      Song changed_song = song;
+      changed_song.set_id(old_song.id());
+      changed_songs << changed_song;
+    }
+    else {
+      changed_songs << song;
+    }
+  }
+
+  // What's left wasn't found anymore.
+  const SongList deleted_songs = old_songs.values();
+
+  qLog(Debug) << "Replacing songs in directory" << directory_id << changed_songs.count() << "added or changed," << deleted_songs.count() << "removed";
+
+  if (!deleted_songs.isEmpty()) DeleteSongs(deleted_songs);
+  if (!changed_songs.isEmpty()) AddOrUpdateSongs(changed_songs);
 
 }
 
@@ -921,23 +1139,31 @@ void CollectionBackend::MarkSongsUnavailable(const SongList &songs, const bool u
   }
   transaction.Commit();
 
+  AddCompilationAlbums(songs);
+
   if (unavailable) {
+    UpdateTotals(songs, SongList());
     emit SongsDeleted(songs);
   }
   else {
+    SongList available_songs;
+    available_songs.reserve(songs.count());
+    for (Song song : songs) {
+      song.set_unavailable(false);
+      available_songs << song;
+    }
+    UpdateTotals(SongList(), available_songs);
     emit SongsDiscovered(songs);
   }
 
-  UpdateTotalSongCountAsync();
-  UpdateTotalArtistCountAsync();
-  UpdateTotalAlbumCountAsync();
+  EmitTotals(db);
 
 }
 
 QStringList CollectionBackend::GetAll(const QString &column, const CollectionFilterOptions &filter_options) {
 
-  QMutexLocker l(db_->Mutex());
-  QSqlDatabase db(db_->Connect());
+  QMutexLocker l(db_->ReadMutex());
+  QSqlDatabase db(db_->ReadConnection());
 
   CollectionQuery query(db, songs_table_, fts_table_, filter_options);
   query.SetColumnSpec(QStringLiteral("DISTINCT ") + column);
@@ -963,8 +1189,8 @@ QStringList CollectionBackend::GetAllArtists(const CollectionFilterOptions &opt)
 
 QStringList CollectionBackend::GetAllArtistsWithAlbums(const CollectionFilterOptions &opt) {
 
-  QMutexLocker l(db_->Mutex());
-  QSqlDatabase db(db_->Connect());
+  QMutexLocker l(db_->ReadMutex());
+  QSqlDatabase db(db_->ReadConnection());
 
   // Albums with 'albumartist' field set:
   CollectionQuery query(db, songs_table_, fts_table_, opt);
@@ -1011,8 +1237,8 @@ CollectionBackend::AlbumList CollectionBackend::GetAlbumsByArtist(const QString
 
 SongList CollectionBackend::GetArtistSongs(const QString &effective_albumartist, const CollectionFilterOptions &opt) {
 
-  QSqlDatabase db(db_->Connect());
-  QMutexLocker l(db_->Mutex());
+  QSqlDatabase db(db_->ReadConnection());
+  QMutexLocker l(db_->ReadMutex());
 
   CollectionQuery query(db, songs_table_, fts_table_, opt);
   query.AddCompilationRequirement(false);
@@ -1029,8 +1255,8 @@ SongList CollectionBackend::GetArtistSongs(const QString &effective_albumartist,
 
 SongList CollectionBackend::GetAlbumSongs(const QString &effective_albumartist, const QString &album, const CollectionFilterOptions &opt) {
 
-  QSqlDatabase db(db_->Connect());
-  QMutexLocker l(db_->Mutex());
+  QSqlDatabase db(db_->ReadConnection());
+  QMutexLocker l(db_->ReadMutex());
 
   CollectionQuery query(db, songs_table_, fts_table_, opt);
   query.AddCompilationRequirement(false);
@@ -1048,8 +1274,8 @@ SongList CollectionBackend::GetAlbumSongs(const QString &effective_albumartist,
 
 SongList CollectionBackend::GetSongsByAlbum(const QString &album, const CollectionFilterOptions &opt) {
 
-  QSqlDatabase db(db_->Connect());
-  QMutexLocker l(db_->Mutex());
+  QSqlDatabase db(db_->ReadConnection());
+  QMutexLocker l(db_->ReadMutex());
 
   CollectionQuery query(db, songs_table_, fts_table_, opt);
   query.AddCompilationRequirement(false);
@@ -1070,9 +1296,10 @@ bool CollectionBackend::ExecCollectionQuery(CollectionQuery *query, SongList &so
 
   if (!query->Exec()) return false;
 
+  const Song::QueryColumns columns(query->record());
   while (query->Next()) {
     Song song(source_);
-    song.InitFromQuery(*query, true);
+    song.InitFromQuery(*query, columns, true);
     songs << song;
   }
   return true;
@@ -1085,9 +1312,10 @@ bool CollectionBackend::ExecCollectionQuery(CollectionQuery *query, SongMap &son
 
   if (!query->Exec()) return false;
 
+  const Song::QueryColumns columns(query->record());
   while (query->Next()) {
     Song song(source_);
-    song.InitFromQuery(*query, true);
+    song.InitFromQuery(*query, columns, true);
     songs.insert(song.song_id(), song);
   }
   return true;
@@ -1096,16 +1324,16 @@ bool CollectionBackend::ExecCollectionQuery(CollectionQuery *query, SongMap &son
 
 Song CollectionBackend::GetSongById(const int id) {
 
-  QMutexLocker l(db_->Mutex());
-  QSqlDatabase db(db_->Connect());
+  QMutexLocker l(db_->ReadMutex());
+  QSqlDatabase db(db_->ReadConnection());
   return GetSongById(id, db);
 
 }
 
 SongList CollectionBackend::GetSongsById(const QList<int> &ids) {
 
-  QMutexLocker l(db_->Mutex());
-  QSqlDatabase db(db_->Connect());
+  QMutexLocker l(db_->ReadMutex());
+  QSqlDatabase db(db_->ReadConnection());
 
   QStringList str_ids;
   str_ids.reserve(ids.count());
@@ -1119,8 +1347,8 @@ SongList CollectionBackend::GetSongsById(const QList<int> &ids) {
 
 SongList CollectionBackend::GetSongsById(const QStringList &ids) {
 
-  QMutexLocker l(db_->Mutex());
-  QSqlDatabase db(db_->Connect());
+  QMutexLocker l(db_->ReadMutex());
+  QSqlDatabase db(db_->ReadConnection());
 
   return GetSongsById(ids, db);
 
@@ -1128,8 +1356,8 @@ SongList CollectionBackend::GetSongsById(const QStringList &ids) {
 
 SongList CollectionBackend::GetSongsByForeignId(const QStringList &ids, const QString &table, const QString &column) {
 
-  QMutexLocker l(db_->Mutex());
-  QSqlDatabase db(db_->Connect());
+  QMutexLocker l(db_->ReadMutex());
+  QSqlDatabase db(db_->ReadConnection());
 
   QString in = ids.join(QStringLiteral(","));
 
@@ -1141,12 +1369,13 @@ SongList CollectionBackend::GetSongsByForeignId(const QStringList &ids, const QS
   }
 
   QVector<Song> ret(ids.count());
+  const Song::QueryColumns columns(q.record());
   while (q.next()) {
     const QString foreign_id = q.value(static_cast<int>(Song::kColumns.count()) + 1).toString();
     const qint64 index = ids.indexOf(foreign_id);
     if (index == -1) continue;
 
-    ret[index].InitFromQuery(q, true);
+    ret[index].InitFromQuery(q, columns, true);
   }
   return ret.toList();
 
@@ -1172,9 +1401,10 @@ SongList CollectionBackend::GetSongsById(const QStringList &ids, QSqlDatabase &d
   }
 
   SongList ret;
+  const Song::QueryColumns columns(q.record());
   while (q.next()) {
     Song song(source_);
-    song.InitFromQuery(q, true);
+    song.InitFromQuery(q, columns, true);
     ret << song;
   }
   return ret;
@@ -1183,8 +1413,8 @@ SongList CollectionBackend::GetSongsById(const QStringList &ids, QSqlDatabase &d
 
 Song CollectionBackend::GetSongByUrl(const QUrl &url, const qint64 beginning) {
 
-  QMutexLocker l(db_->Mutex());
-  QSqlDatabase db(db_->Connect());
+  QMutexLocker l(db_->ReadMutex());
+  QSqlDatabase db(db_->ReadConnection());
 
   SqlQuery q(db);
   q.prepare(QStringLiteral("SELECT %1 FROM %2 WHERE (url = :url1 OR url = :url2 OR url = :url3 OR url = :url4) AND beginning = :beginning AND unavailable = 0").arg(Song::kRowIdColumnSpec, songs_table_));
@@ -1213,8 +1443,8 @@ Song CollectionBackend::GetSongByUrl(const QUrl &url, const qint64 beginning) {
 
 Song CollectionBackend::GetSongByUrlAndTrack(const QUrl &url, const int track) {
 
-  QMutexLocker l(db_->Mutex());
-  QSqlDatabase db(db_->Connect());
+  QMutexLocker l(db_->ReadMutex());
+  QSqlDatabase db(db_->ReadConnection());
 
   SqlQuery q(db);
   q.prepare(QStringLiteral("SELECT %1 FROM %2 WHERE (url = :url1 OR url = :url2 OR url = :url3 OR url = :url4) AND track = :track AND unavailable = 0").arg(Song::kRowIdColumnSpec, songs_table_));
@@ -1243,8 +1473,8 @@ Song CollectionBackend::GetSongByUrlAndTrack(const QUrl &url, const int track) {
 
 SongList CollectionBackend::GetSongsByUrl(const QUrl &url, const bool unavailable) {
 
-  QMutexLocker l(db_->Mutex());
-  QSqlDatabase db(db_->Connect());
+  QMutexLocker l(db_->ReadMutex());
+  QSqlDatabase db(db_->ReadConnection());
 
   SqlQuery q(db);
   q.prepare(QStringLiteral("SELECT %1 FROM %2 WHERE (url = :url1 OR url = :url2 OR url = :url3 OR url = :url4) AND unavailable = :unavailable").arg(Song::kRowIdColumnSpec, songs_table_));
@@ -1257,9 +1487,10 @@ SongList CollectionBackend::GetSongsByUrl(const QUrl &url, const bool unavailabl
 
   SongList songs;
   if (q.Exec()) {
+    const Song::QueryColumns columns(q.record());
     while (q.next()) {
       Song song(source_);
-      song.InitFromQuery(q, true);
+      song.InitFromQuery(q, columns, true);
       songs << song;
     }
   }
@@ -1271,19 +1502,63 @@ SongList CollectionBackend::GetSongsByUrl(const QUrl &url, const bool unavailabl
 
 }
 
+QHash<QUrl, SongList> CollectionBackend::GetSongsByUrls(const QList<QUrl> &urls) {
 
-Song CollectionBackend::GetSongBySongId(const QString &song_id) {
+  QHash<QUrl, SongList> songs;
+  if (urls.isEmpty()) return songs;
 
-  QMutexLocker l(db_->Mutex());
-  QSqlDatabase db(db_->Connect());
-  return GetSongBySongId(song_id, db);
+  QMutexLocker l(db_->ReadMutex());
+  QSqlDatabase db(db_->ReadConnection());
 
-}
+  for (qint64 i = 0; i < urls.count(); i += kUrlsQueryBatchSize) {
+    const QList<QUrl> batch = urls.mid(i, kUrlsQueryBatchSize);
+
+    QStringList placeholders;
+    placeholders.reserve(batch.count());
+    for (qint64 j = 0; j < batch.count(); ++j) {
+      placeholders << QStringLiteral(":url%1_1, :url%1_2, :url%1_3, :url%1_4").arg(j);
+    }
+
+    SqlQuery q(db);
+    q.prepare(QStringLiteral("SELECT %1 FROM %2 WHERE url IN (%3) AND unavailable = 0").arg(Song::kRowIdColumnSpec, songs_table_, placeholders.join(QStringLiteral(", "))));
+
+    for (qint64 j = 0; j < batch.count(); ++j) {
+      const QUrl &url = batch[j];
+      q.BindValue(QStringLiteral(":url%1_1").arg(j), url);
+      q.BindValue(QStringLiteral(":url%1_2").arg(j), url.toString());
+      q.BindValue(QStringLiteral(":url%1_3").arg(j), url.toString(QUrl::FullyEncoded));
+      q.BindValue(QStringLiteral(":url%1_4").arg(j), url.toEncoded());
+    }
+
+    if (!q.Exec()) {
+      db_->ReportErrors(q);
+      return songs;
+    }
+
+    const Song::QueryColumns columns(q.record());
+    while (q.next()) {
+      Song song(source_);
+      song.InitFromQuery(q, columns, true);
+      songs[song.url()] << song;
+    }
+  }
+
+  return songs;
+
+}
+
+Song CollectionBackend::GetSongBySongId(const QString &song_id) {
+
+  QMutexLocker l(db_->ReadMutex());
+  QSqlDatabase db(db_->ReadConnection());
+  return GetSongBySongId(song_id, db);
+
+}
 
 SongList CollectionBackend::GetSongsBySongId(const QStringList &song_ids) {
 
-  QMutexLocker l(db_->Mutex());
-  QSqlDatabase db(db_->Connect());
+  QMutexLocker l(db_->ReadMutex());
+  QSqlDatabase db(db_->ReadConnection());
 
   return GetSongsBySongId(song_ids, db);
 
@@ -1314,9 +1589,10 @@ SongList CollectionBackend::GetSongsBySongId(const QStringList &song_ids, QSqlDa
   }
 
   SongList ret;
+  const Song::QueryColumns columns(q.record());
   while (q.next()) {
     Song song(source_);
-    song.InitFromQuery(q, true);
+    song.InitFromQuery(q, columns, true);
     ret << song;
   }
 
@@ -1324,27 +1600,25 @@ SongList CollectionBackend::GetSongsBySongId(const QStringList &song_ids, QSqlDa
 
 }
 
-SongList CollectionBackend::GetSongsByFingerprint(const QString &fingerprint) {
+QMultiHash<QString, int> CollectionBackend::GetSongIdsByFingerprint() {
 
-  QMutexLocker l(db_->Mutex());
-  QSqlDatabase db(db_->Connect());
+  QMutexLocker l(db_->ReadMutex());
+  QSqlDatabase db(db_->ReadConnection());
 
+  // Only the index on the fingerprint is read.
   SqlQuery q(db);
-  q.prepare(QStringLiteral("SELECT %1 FROM %2 WHERE fingerprint = :fingerprint").arg(Song::kRowIdColumnSpec, songs_table_));
-  q.BindValue(QStringLiteral(":fingerprint"), fingerprint);
+  q.prepare(QStringLiteral("SELECT fingerprint, ROWID FROM %1 WHERE fingerprint IS NOT NULL AND fingerprint != '' AND fingerprint != 'NONE'").arg(songs_table_));
   if (!q.Exec()) {
     db_->ReportErrors(q);
-    return SongList();
+    return QMultiHash<QString, int>();
   }
 
-  SongList songs;
+  QMultiHash<QString, int> song_ids;
   while (q.next()) {
-    Song song(source_);
-    song.InitFromQuery(q, true);
-    songs << song;
+    song_ids.insert(q.value(0).toString(), q.value(1).toInt());
   }
 
-  return songs;
+  return song_ids;
 
 }
 
@@ -1355,8 +1629,8 @@ CollectionBackend::AlbumList CollectionBackend::GetCompilationAlbums(const Colle
 
 SongList CollectionBackend::GetCompilationSongs(const QString &album, const CollectionFilterOptions &opt) {
 
-  QMutexLocker l(db_->Mutex());
-  QSqlDatabase db(db_->Connect());
+  QMutexLocker l(db_->ReadMutex());
+  QSqlDatabase db(db_->ReadConnection());
 
   CollectionQuery query(db, songs_table_, fts_table_, opt);
   query.SetColumnSpec(QStringLiteral("%songs_table.ROWID, ") + Song::kColumnSpec);
@@ -1369,79 +1643,98 @@ SongList CollectionBackend::GetCompilationSongs(const QString &album, const Coll
   }
 
   SongList ret;
+  const Song::QueryColumns columns(query.record());
   while (query.Next()) {
     Song song(source_);
-    song.InitFromQuery(query, true);
+    song.InitFromQuery(query, columns, true);
     ret << song;
   }
   return ret;
 
 }
 
-void CollectionBackend::CompilationsNeedUpdating() {
-
-  QMutexLocker l(db_->Mutex());
-  QSqlDatabase db(db_->Connect());
-
-  // Look for albums that have songs by more than one 'effective album artist' in the same directory
+void CollectionBackend::AddCompilationAlbums(const SongList &songs) {
 
-  SqlQuery q(db);
-  q.prepare(QStringLiteral("SELECT effective_albumartist, album, url, compilation_detected FROM %1 WHERE unavailable = 0 ORDER BY album").arg(songs_table_));
-  if (!q.Exec()) {
-    db_->ReportErrors(q);
-    return;
+  for (const Song &song : songs) {
+    if (!song.album().isEmpty()) compilation_albums_.insert(song.album());
   }
 
-  QMap<QString, CompilationInfo> compilation_info;
-  while (q.next()) {
-    QString artist = q.value(0).toString();
-    QString album = q.value(1).toString();
-    QUrl url = QUrl::fromEncoded(q.value(2).toString().toUtf8());
-    bool compilation_detected = q.value(3).toBool();
-
-    // Ignore songs that don't have an album field set
-    if (album.isEmpty()) continue;
+}
 
-    // Find the directory the song is in
-    QString directory = url.toString(QUrl::PreferLocalFile | QUrl::RemoveFilename);
+void CollectionBackend::CompilationsNeedUpdating() {
 
-    CompilationInfo &info = compilation_info[directory + album];
-    info.urls << url;
-    if (!info.artists.contains(artist)) {
-      info.artists << artist;
-    }
-    if (compilation_detected) info.has_compilation_detected++;
-    else info.has_not_compilation_detected++;
-  }
+  QMutexLocker l(db_->Mutex());
+  QSqlDatabase db(db_->Connect());
 
-  // Now mark the songs that we think are in compilations
-  SongList deleted_songs;
-  SongList added_songs;
+  // The first pass checks every album, after that only the albums touched since the previous pass can change.
+  const bool full_pass = !compilations_checked_;
+  if (!full_pass && compilation_albums_.isEmpty()) return;
 
   ScopedTransaction transaction(&db);
 
-  QMap<QString, CompilationInfo>::const_iterator it = compilation_info.constBegin();
-  for (; it != compilation_info.constEnd(); ++it) {
-    const CompilationInfo &info = it.value();
-
-    // If there were more than one 'effective album artist' for this album directory, then it's a compilation.
+  if (!full_pass) {
+    {
+      SqlQuery q(db);
+      q.prepare(QStringLiteral("CREATE TEMP TABLE IF NOT EXISTS compilation_albums (album TEXT PRIMARY KEY)"));
+      if (!q.Exec()) {
+        db_->ReportErrors(q);
+        return;
+      }
+    }
+    {
+      SqlQuery q(db);
+      q.prepare(QStringLiteral("DELETE FROM temp.compilation_albums"));
+      if (!q.Exec()) {
+        db_->ReportErrors(q);
+        return;
+      }
+    }
+    SqlQuery q(db);
+    q.prepare(QStringLiteral("INSERT OR IGNORE INTO temp.compilation_albums (album) VALUES (:album)"));
+    for (const QString &album : std::as_const(compilation_albums_)) {
+      q.BindValue(QStringLiteral(":album"), album);
+      if (!q.Exec()) {
+        db_->ReportErrors(q);
+        return;
+      }
+    }
+  }
 
-    for (const QUrl &url : info.urls) {
-      if (info.artists.count() > 1) {  // This directory+album is a compilation.
-        if (info.has_not_compilation_detected > 0) {  // Run updates if any of the songs is not marked as compilations.
-          UpdateCompilations(db, deleted_songs, added_songs, url, true);
-        }
+  // Albums that have songs by more than one 'effective album artist' in the same directory are compilations.
+  // Find the songs where compilation_detected doesn't match that.
+  QStringList detected_ids;
+  QStringList not_detected_ids;
+  {
+    SqlQuery q(db);
+    q.prepare(QStringLiteral("WITH albums AS (SELECT rtrim(url, replace(url, '/', '')) AS directory, album, COUNT(DISTINCT effective_albumartist) > 1 AS detected FROM %1 WHERE unavailable = 0 AND album != ''%2 GROUP BY directory, album) "
+                             "SELECT %1.ROWID, albums.detected FROM %1 JOIN albums ON %1.album = albums.album AND rtrim(%1.url, replace(%1.url, '/', '')) = albums.directory WHERE %1.unavailable = 0 AND IFNULL(%1.compilation_detected, 0) != albums.detected")
+                  .arg(songs_table_, full_pass ? QString() : QStringLiteral(" AND album IN (SELECT album FROM temp.compilation_albums)")));
+    if (!q.Exec()) {
+      db_->ReportErrors(q);
+      return;
+    }
+    while (q.next()) {
+      if (q.value(1).toBool()) {
+        detected_ids << q.value(0).toString();
       }
       else {
-        if (info.has_compilation_detected > 0) {
-          UpdateCompilations(db, deleted_songs, added_songs, url, false);
-        }
+        not_detected_ids << q.value(0).toString();
       }
     }
   }
 
+  // Now mark the songs that we think are in compilations
+  SongList deleted_songs;
+  SongList added_songs;
+
+  if (!UpdateCompilations(db, detected_ids, true, deleted_songs, added_songs)) return;
+  if (!UpdateCompilations(db, not_detected_ids, false, deleted_songs, added_songs)) return;
+
   transaction.Commit();
 
+  compilations_checked_ = true;
+  compilation_albums_.clear();
+
   if (!deleted_songs.isEmpty()) {
     emit SongsDeleted(deleted_songs);
     emit SongsDiscovered(added_songs);
@@ -1449,51 +1742,36 @@ void CollectionBackend::CompilationsNeedUpdating() {
 
 }
 
-bool CollectionBackend::UpdateCompilations(const QSqlDatabase &db, SongList &deleted_songs, SongList &added_songs, const QUrl &url, const bool compilation_detected) {
+bool CollectionBackend::UpdateCompilations(QSqlDatabase &db, const QStringList &ids, const bool compilation_detected, SongList &deleted_songs, SongList &added_songs) {
 
-  {  // Get song, so we can tell the model its updated
-    SqlQuery q(db);
-    q.prepare(QStringLiteral("SELECT %1 FROM %2 WHERE (url = :url1 OR url = :url2 OR url = :url3 OR url = :url4) AND unavailable = 0").arg(Song::kRowIdColumnSpec, songs_table_));
-    q.BindValue(QStringLiteral(":url1"), url);
-    q.BindValue(QStringLiteral(":url2"), url.toString());
-    q.BindValue(QStringLiteral(":url3"), url.toString(QUrl::FullyEncoded));
-    q.BindValue(QStringLiteral(":url4"), url.toEncoded());
-    if (q.Exec()) {
-      while (q.next()) {
-        Song song(source_);
-        song.InitFromQuery(q, true);
-        deleted_songs << song;
-        song.set_compilation_detected(compilation_detected);
-        added_songs << song;
-      }
+  for (qint64 i = 0; i < ids.count(); i += kSongsQueryBatchSize) {
+    const QStringList batch_ids = ids.mid(i, kSongsQueryBatchSize);
+
+    // Get the songs, so we can tell the model they're updated
+    const SongList songs = GetSongsById(batch_ids, db);
+    for (Song song : songs) {
+      deleted_songs << song;
+      song.set_compilation_detected(compilation_detected);
+      added_songs << song;
     }
-    else {
+
+    SqlQuery q(db);
+    q.prepare(QStringLiteral("UPDATE %1 SET compilation_detected = :compilation_detected, compilation_effective = ((compilation OR :compilation_detected OR compilation_on) AND NOT compilation_off) + 0 WHERE ROWID IN (%2)").arg(songs_table_, batch_ids.join(QLatin1Char(','))));
+    q.BindValue(QStringLiteral(":compilation_detected"), static_cast<int>(compilation_detected));
+    if (!q.Exec()) {
       db_->ReportErrors(q);
       return false;
     }
   }
 
-  // Update the song
-  SqlQuery q(db);
-  q.prepare(QStringLiteral("UPDATE %1 SET compilation_detected = :compilation_detected, compilation_effective = ((compilation OR :compilation_detected OR compilation_on) AND NOT compilation_off) + 0 WHERE (url = :url1 OR url = :url2 OR url = :url3 OR url = :url4) AND unavailable = 0").arg(songs_table_));
-  q.BindValue(QStringLiteral(":compilation_detected"), static_cast<int>(compilation_detected));
-  q.BindValue(QStringLiteral(":url1"), url);
-  q.BindValue(QStringLiteral(":url2"), url.toString());
-  q.BindValue(QStringLiteral(":url3"), url.toString(QUrl::FullyEncoded));
-  q.BindValue(QStringLiteral(":url4"), url.toEncoded());
-  if (!q.Exec()) {
-    db_->ReportErrors(q);
-    return false;
-  }
-
   return true;
 
 }
 
 CollectionBackend::AlbumList CollectionBackend::GetAlbums(const QString &artist, const bool compilation_required, const CollectionFilterOptions &opt) {
 
-  QMutexLocker l(db_->Mutex());
-  QSqlDatabase db(db_->Connect());
+  QMutexLocker l(db_->ReadMutex());
+  QSqlDatabase db(db_->ReadConnection());
 
   CollectionQuery query(db, songs_table_, fts_table_, opt);
   query.SetColumnSpec(QStringLiteral("url, filetype, cue_path, effective_albumartist, album, compilation_effective, art_embedded, art_automatic, art_manual, art_unset"));
@@ -1579,8 +1857,8 @@ CollectionBackend::AlbumList CollectionBackend::GetAlbums(const QString &artist,
 
 CollectionBackend::Album CollectionBackend::GetAlbumArt(const QString &effective_albumartist, const QString &album) {
 
-  QMutexLocker l(db_->Mutex());
-  QSqlDatabase db(db_->Connect());
+  QMutexLocker l(db_->ReadMutex());
+  QSqlDatabase db(db_->ReadConnection());
 
   Album ret;
   ret.album = album;
@@ -1633,9 +1911,10 @@ void CollectionBackend::UpdateEmbeddedAlbumArt(const QString &effective_albumart
   }
 
   SongList deleted_songs;
+  const Song::QueryColumns columns(query.record());
   while (query.Next()) {
     Song song(source_);
-    song.InitFromQuery(query, true);
+    song.InitFromQuery(query, columns, true);
     deleted_songs << song;
   }
 
@@ -1660,9 +1939,10 @@ void CollectionBackend::UpdateEmbeddedAlbumArt(const QString &effective_albumart
   }
 
   SongList added_songs;
+  const Song::QueryColumns columns(query.record());
   while (query.Next()) {
     Song song(source_);
-    song.InitFromQuery(query, true);
+    song.InitFromQuery(query, columns, true);
     added_songs << song;
   }
 
@@ -1695,9 +1975,10 @@ void CollectionBackend::UpdateManualAlbumArt(const QString &effective_albumartis
   }
 
   SongList deleted_songs;
+  const Song::QueryColumns columns(query.record());
   while (query.Next()) {
     Song song(source_);
-    song.InitFromQuery(query, true);
+    song.InitFromQuery(query, columns, true);
     deleted_songs << song;
   }
 
@@ -1718,9 +1999,10 @@ void CollectionBackend::UpdateManualAlbumArt(const QString &effective_albumartis
   }
 
   SongList added_songs;
+  const Song::QueryColumns columns(query.record());
   while (query.Next()) {
     Song song(source_);
-    song.InitFromQuery(query, true);
+    song.InitFromQuery(query, columns, true);
     added_songs << song;
   }
 
@@ -1753,9 +2035,10 @@ void CollectionBackend::UnsetAlbumArt(const QString &effective_albumartist, cons
   }
 
   SongList deleted_songs;
+  const Song::QueryColumns columns(query.record());
   while (query.Next()) {
     Song song(source_);
-    song.InitFromQuery(query, true);
+    song.InitFromQuery(query, columns, true);
     deleted_songs << song;
   }
 
@@ -1775,9 +2058,10 @@ void CollectionBackend::UnsetAlbumArt(const QString &effective_albumartist, cons
   }
 
   SongList added_songs;
+  const Song::QueryColumns columns(query.record());
   while (query.Next()) {
     Song song(source_);
-    song.InitFromQuery(query, true);
+    song.InitFromQuery(query, columns, true);
     added_songs << song;
   }
 
@@ -1810,9 +2094,10 @@ void CollectionBackend::ClearAlbumArt(const QString &effective_albumartist, cons
   }
 
   SongList deleted_songs;
+  const Song::QueryColumns columns(query.record());
   while (query.Next()) {
     Song song(source_);
-    song.InitFromQuery(query, true);
+    song.InitFromQuery(query, columns, true);
     deleted_songs << song;
   }
 
@@ -1833,9 +2118,10 @@ void CollectionBackend::ClearAlbumArt(const QString &effective_albumartist, cons
   }
 
   SongList added_songs;
+  const Song::QueryColumns columns(query.record());
   while (query.Next()) {
     Song song(source_);
-    song.InitFromQuery(query, true);
+    song.InitFromQuery(query, columns, true);
     added_songs << song;
   }
 
@@ -1864,9 +2150,10 @@ void CollectionBackend::ForceCompilation(const QString &album, const QStringList
       return;
     }
 
+    const Song::QueryColumns columns(query.record());
     while (query.Next()) {
       Song song(source_);
-      song.InitFromQuery(query, true);
+      song.InitFromQuery(query, columns, true);
       deleted_songs << song;
     }
 
@@ -1892,9 +2179,10 @@ void CollectionBackend::ForceCompilation(const QString &album, const QStringList
       return;
     }
 
+    const Song::QueryColumns columns(query.record());
     while (query.Next()) {
       Song song(source_);
-      song.InitFromQuery(query, true);
+      song.InitFromQuery(query, columns, true);
       added_songs << song;
     }
   }
@@ -1910,20 +2198,11 @@ void CollectionBackend::IncrementPlayCount(const int id) {
 
   if (id == -1) return;
 
-  QMutexLocker l(db_->Mutex());
-  QSqlDatabase db(db_->Connect());
-
-  SqlQuery q(db);
-  q.prepare(QStringLiteral("UPDATE %1 SET playcount = playcount + 1, lastplayed = :now WHERE ROWID = :id").arg(songs_table_));
-  q.BindValue(QStringLiteral(":now"), QDateTime::currentSecsSinceEpoch());
-  q.BindValue(QStringLiteral(":id"), id);
-  if (!q.Exec()) {
-    db_->ReportErrors(q);
-    return;
-  }
-
-  Song new_song = GetSongById(id, db);
-  emit SongsStatisticsChanged(SongList() << new_song);
+  PlayStatisticsUpdate update;
+  update.id = id;
+  update.playcount = 1;
+  update.lastplayed = QDateTime::currentSecsSinceEpoch();
+  UpdatePlayStatistics(PlayStatisticsUpdateList() << update);
 
 }
 
@@ -1933,19 +2212,49 @@ void CollectionBackend::IncrementSkipCount(const int id, const float progress) {
 
   if (id == -1) return;
 
+  PlayStatisticsUpdate update;
+  update.id = id;
+  update.skipcount = 1;
+  UpdatePlayStatistics(PlayStatisticsUpdateList() << update);
+
+}
+
+void CollectionBackend::UpdatePlayStatistics(const PlayStatisticsUpdateList &updates, const bool save_tags) {
+
+  if (updates.isEmpty()) return;
+
   QMutexLocker l(db_->Mutex());
   QSqlDatabase db(db_->Connect());
 
   SqlQuery q(db);
-  q.prepare(QStringLiteral("UPDATE %1 SET skipcount = skipcount + 1 WHERE ROWID = :id").arg(songs_table_));
-  q.BindValue(QStringLiteral(":id"), id);
-  if (!q.Exec()) {
-    db_->ReportErrors(q);
-    return;
+  q.prepare(QStringLiteral("UPDATE %1 SET playcount = MAX(playcount + :playcount, 0), skipcount = MAX(skipcount + :skipcount, 0), lastplayed = MAX(lastplayed, :lastplayed) WHERE ROWID = :id").arg(songs_table_));
+
+  QStringList ids;
+  ids.reserve(updates.count());
+
+  ScopedTransaction transaction(&db);
+  for (const PlayStatisticsUpdate &update : updates) {
+    if (update.id == -1) continue;
+    q.BindValue(QStringLiteral(":playcount"), update.playcount);
+    q.BindValue(QStringLiteral(":skipcount"), update.skipcount);
+    q.BindValue(QStringLiteral(":lastplayed"), update.lastplayed);
+    q.BindValue(QStringLiteral(":id"), update.id);
+    if (!q.Exec()) {
+      db_->ReportErrors(q);
+      return;
+    }
+    ids << QString::number(update.id);
   }
+  transaction.Commit();
 
-  Song new_song = GetSongById(id, db);
-  emit SongsStatisticsChanged(SongList() << new_song);
+  ids.removeDuplicates();
+
+  SongList songs;
+  for (qint64 i = 0; i < ids.count(); i += kSongsQueryBatchSize) {
+    songs << GetSongsById(ids.mid(i, kSongsQueryBatchSize), db);
+  }
+
+  if (!songs.isEmpty()) emit SongsStatisticsChanged(songs, save_tags);
 
 }
 
@@ -2026,16 +2335,31 @@ void CollectionBackend::DeleteAll() {
     }
 
     t.Commit();
+
+    compilation_albums_.clear();
+  }
+
+  {
+    QMutexLocker l(&totals_mutex_);
+    totals_loaded_ = true;
+    totals_verified_.start();
+    totals_songs_.clear();
+    totals_artists_.clear();
+    totals_albums_.clear();
   }
 
   emit DatabaseReset();
 
+  emit TotalSongCountUpdated(0);
+  emit TotalArtistCountUpdated(0);
+  emit TotalAlbumCountUpdated(0);
+
 }
 
 SongList CollectionBackend::SmartPlaylistsFindSongs(const SmartPlaylistSearch &search) {
 
-  QMutexLocker l(db_->Mutex());
-  QSqlDatabase db(db_->Connect());
+  QMutexLocker l(db_->ReadMutex());
+  QSqlDatabase db(db_->ReadConnection());
 
   // Build the query
   QString sql = search.ToSql(songs_table());
@@ -2050,15 +2374,52 @@ SongList CollectionBackend::SmartPlaylistsFindSongs(const SmartPlaylistSearch &s
   }
 
   // Read the results
+  const Song::QueryColumns columns(query.record());
   while (query.next()) {
     Song song;
-    song.InitFromQuery(query, true);
+    song.InitFromQuery(query, columns, true);
     ret << song;
   }
   return ret;
 
 }
 
+QList<int> CollectionBackend::SmartPlaylistsFindSongIds(const SmartPlaylistSearch &search) {
+
+  QMutexLocker l(db_->ReadMutex());
+  QSqlDatabase db(db_->ReadConnection());
+
+  QList<int> ret;
+  SqlQuery query(db);
+  query.prepare(search.ToIdsSql(songs_table()));
+  if (!query.Exec()) {
+    db_->ReportErrors(query);
+    return ret;
+  }
+
+  while (query.next()) {
+    ret << query.value(0).toInt();
+  }
+  return ret;
+
+}
+
+int CollectionBackend::SmartPlaylistsCountSongs(const SmartPlaylistSearch &search) {
+
+  QMutexLocker l(db_->ReadMutex());
+  QSqlDatabase db(db_->ReadConnection());
+
+  SqlQuery query(db);
+  query.prepare(QStringLiteral("SELECT COUNT(*) FROM (%1)").arg(search.ToIdsSql(songs_table())));
+  if (!query.Exec()) {
+    db_->ReportErrors(query);
+    return 0;
+  }
+
+  return query.next() ? query.value(0).toInt() : 0;
+
+}
+
 SongList CollectionBackend::SmartPlaylistsGetAllSongs() {
 
   // Get all the songs!
@@ -2068,8 +2429,8 @@ SongList CollectionBackend::SmartPlaylistsGetAllSongs() {
 
 SongList CollectionBackend::GetSongsBy(const QString &artist, const QString &album, const QString &title) {
 
-  QMutexLocker l(db_->Mutex());
-  QSqlDatabase db(db_->Connect());
+  QMutexLocker l(db_->ReadMutex());
+  QSqlDatabase db(db_->ReadConnection());
 
   SongList songs;
   SqlQuery q(db);
@@ -2086,9 +2447,10 @@ SongList CollectionBackend::GetSongsBy(const QString &artist, const QString &alb
     db_->ReportErrors(q);
     return SongList();
   }
+  const Song::QueryColumns columns(q.record());
   while (q.next()) {
     Song song(source_);
-    song.InitFromQuery(q, true);
+    song.InitFromQuery(q, columns, true);
     songs << song;
   }
 
@@ -2098,56 +2460,101 @@ SongList CollectionBackend::GetSongsBy(const QString &artist, const QString &alb
 
 void CollectionBackend::UpdateLastPlayed(const QString &artist, const QString &album, const QString &title, const qint64 lastplayed) {
 
-  const SongList songs = GetSongsBy(artist, album, title);
-  if (songs.isEmpty()) {
-    qLog(Debug) << "Could not find a matching song in the database for" << artist << album << title;
-    return;
-  }
+  PlayStatisticsByMetadata pending;
+  pending.artist = artist;
+  pending.album = album;
+  pending.title = title;
+  pending.lastplayed = lastplayed;
 
-  QMutexLocker l(db_->Mutex());
-  QSqlDatabase db(db_->Connect());
-
-  for (const Song &song : songs) {
-    if (song.lastplayed() >= lastplayed) {
-      continue;
-    }
-    SqlQuery q(db);
-    q.prepare(QStringLiteral("UPDATE %1 SET lastplayed = :lastplayed WHERE ROWID = :id").arg(songs_table_));
-    q.BindValue(QStringLiteral(":lastplayed"), lastplayed);
-    q.BindValue(QStringLiteral(":id"), song.id());
-    if (!q.Exec()) {
-      db_->ReportErrors(q);
-      continue;
-    }
+  // Imports call this for every track, collect them and apply them all at once when the queued calls are handled.
+  if (pending_play_statistics_.isEmpty()) {
+    QMetaObject::invokeMethod(this, &CollectionBackend::FlushPendingPlayStatistics, Qt::QueuedConnection);
   }
-
-  emit SongsStatisticsChanged(SongList() << songs);
+  pending_play_statistics_ << pending;
 
 }
 
 void CollectionBackend::UpdatePlayCount(const QString &artist, const QString &title, const int playcount, const bool save_tags) {
 
-  const SongList songs = GetSongsBy(artist, QString(), title);
-  if (songs.isEmpty()) {
-    qLog(Debug) << "Could not find a matching song in the database for" << artist << title;
-    return;
+  PlayStatisticsByMetadata pending;
+  pending.artist = artist;
+  pending.title = title;
+  pending.playcount = playcount;
+  pending.save_tags = save_tags;
+
+  if (pending_play_statistics_.isEmpty()) {
+    QMetaObject::invokeMethod(this, &CollectionBackend::FlushPendingPlayStatistics, Qt::QueuedConnection);
   }
+  pending_play_statistics_ << pending;
 
-  QMutexLocker l(db_->Mutex());
-  QSqlDatabase db(db_->Connect());
+}
 
-  for (const Song &song : songs) {
+void CollectionBackend::FlushPendingPlayStatistics() {
+
+  const PlayStatisticsByMetadataList pending_play_statistics = pending_play_statistics_;
+  pending_play_statistics_.clear();
+
+  UpdatePlayStatisticsByMetadata(pending_play_statistics);
+
+}
+
+void CollectionBackend::UpdatePlayStatisticsByMetadata(const PlayStatisticsByMetadataList &statistics) {
+
+  if (statistics.isEmpty()) return;
+
+  // Imports can have hundreds of thousands of entries, so the songs are matched in memory from a single query instead of one query for each entry.
+  QMultiHash<QString, PlayStatisticsSong> songs;
+  {
+    QMutexLocker l(db_->ReadMutex());
+    QSqlDatabase db(db_->ReadConnection());
     SqlQuery q(db);
-    q.prepare(QStringLiteral("UPDATE %1 SET playcount = :playcount WHERE ROWID = :id").arg(songs_table_));
-    q.BindValue(QStringLiteral(":playcount"), playcount);
-    q.BindValue(QStringLiteral(":id"), song.id());
+    q.prepare(QStringLiteral("SELECT ROWID, artist, album, title, playcount FROM %1").arg(songs_table_));
     if (!q.Exec()) {
       db_->ReportErrors(q);
       return;
     }
+    while (q.next()) {
+      PlayStatisticsSong song;
+      song.id = q.value(0).toInt();
+      song.album = q.value(2).toString().toLower();
+      song.playcount = q.value(4).toInt();
+      songs.insert(PlayStatisticsKey(q.value(1).toString(), q.value(3).toString()), song);
+    }
+  }
+
+  // Play counts are absolute, so keep the resulting counts per song to turn them into deltas.
+  QMap<int, int> playcounts;
+  PlayStatisticsUpdateList updates;
+  PlayStatisticsUpdateList updates_save_tags;
+  for (const PlayStatisticsByMetadata &pending : statistics) {
+    const QString album = pending.album.toLower();
+    bool found = false;
+    const QList<PlayStatisticsSong> matches = songs.values(PlayStatisticsKey(pending.artist, pending.title));
+    for (const PlayStatisticsSong &song : matches) {
+      if (!album.isEmpty() && song.album != album) continue;
+      found = true;
+      PlayStatisticsUpdate update;
+      update.id = song.id;
+      if (pending.playcount >= 0) {
+        const int playcount = playcounts.value(song.id, song.playcount);
+        update.playcount = pending.playcount - playcount;
+        playcounts[song.id] = pending.playcount;
+      }
+      update.lastplayed = pending.lastplayed;
+      if (pending.save_tags) {
+        updates_save_tags << update;
+      }
+      else {
+        updates << update;
+      }
+    }
+    if (!found) {
+      qLog(Debug) << "Could not find a matching song in the database for" << pending.artist << pending.album << pending.title;
+    }
   }
 
-  emit SongsStatisticsChanged(SongList() << songs, save_tags);
+  UpdatePlayStatistics(updates);
+  UpdatePlayStatistics(updates_save_tags, true);
 
 }
 
@@ -2228,9 +2635,10 @@ void CollectionBackend::ExpireSongs(const int directory_id, const int expire_una
       db_->ReportErrors(q);
       return;
     }
+    const Song::QueryColumns columns(q.record());
     while (q.next()) {
       Song song(source_);
-      song.InitFromQuery(q, true);
+      song.InitFromQuery(q, columns, true);
       songs << song;
     }
   }
@@ -2239,4 +2647,120 @@ void CollectionBackend::ExpireSongs(const int directory_id, const int expire_una
 
 }
 
+QStringList CollectionBackend::ScanJournal(const int directory_id, qint64 *scan_started) {
+
+  *scan_started = 0;
+
+  QMutexLocker l(db_->ReadMutex());
+  QSqlDatabase db(db_->ReadConnection());
+
+  SqlQuery q(db);
+  q.prepare(QStringLiteral("SELECT scan_started, path FROM scan_journal WHERE directory_id = :directory_id ORDER BY scan_started DESC"));
+  q.BindValue(QStringLiteral(":directory_id"), directory_id);
+  if (!q.Exec()) {
+    db_->ReportErrors(q);
+    return QStringList();
+  }
+
+  QStringList paths;
+  while (q.next()) {
+    const qint64 started = q.value(0).toLongLong();
+    if (paths.isEmpty()) {
+      *scan_started = started;
+    }
+    // Entries left behind by other scans are ignored.
+    else if (started != *scan_started) {
+      break;
+    }
+    paths << q.value(1).toString();
+  }
+
+  return paths;
+
+}
+
+void CollectionBackend::AddToScanJournal(const int directory_id, const qint64 scan_started, const QStringList &paths) {
+
+  QMutexLocker l(db_->Mutex());
+  QSqlDatabase db(db_->Connect());
+
+  ScopedTransaction transaction(&db);
+
+  {
+    SqlQuery q(db);
+    q.prepare(QStringLiteral("DELETE FROM scan_journal WHERE directory_id = :directory_id AND scan_started != :scan_started"));
+    q.BindValue(QStringLiteral(":directory_id"), directory_id);
+    q.BindValue(QStringLiteral(":scan_started"), scan_started);
+    if (!q.Exec()) {
+      db_->ReportErrors(q);
+      return;
+    }
+  }
+
+  SqlQuery q(db);
+  q.prepare(QStringLiteral("INSERT INTO scan_journal (directory_id, path, scan_started) VALUES (:directory_id, :path, :scan_started)"));
+  for (const QString &path : paths) {
+    q.BindValue(QStringLiteral(":directory_id"), directory_id);
+    q.BindValue(QStringLiteral(":path"), path);
+    q.BindValue(QStringLiteral(":scan_started"), scan_started);
+    if (!q.Exec()) {
+      db_->ReportErrors(q);
+      return;
+    }
+  }
 
+  transaction.Commit();
+
+}
+
+void CollectionBackend::ClearScanJournal(const int directory_id) {
+
+  QMutexLocker l(db_->Mutex());
+  QSqlDatabase db(db_->Connect());
+
+  SqlQuery q(db);
+  q.prepare(QStringLiteral("DELETE FROM scan_journal WHERE directory_id = :directory_id"));
+  q.BindValue(QStringLiteral(":directory_id"), directory_id);
+  if (!q.Exec()) {
+    db_->ReportErrors(q);
+  }
+
+}
+
+QString CollectionBackend::BestAlbumArt(const QString &directory, const QString &hash) {
+
+  QMutexLocker l(db_->ReadMutex());
+  QSqlDatabase db(db_->ReadConnection());
+
+  SqlQuery q(db);
+  q.prepare(QStringLiteral("SELECT path FROM album_art WHERE directory = :directory AND hash = :hash"));
+  q.BindValue(QStringLiteral(":directory"), directory);
+  q.BindValue(QStringLiteral(":hash"), hash);
+  if (!q.Exec()) {
+    db_->ReportErrors(q);
+    return QString();
+  }
+
+  if (!q.next()) return QString();
+
+  return q.value(0).toString();
+
+}
+
+void CollectionBackend::UpdateBestAlbumArt(const QString &directory, const QString &path, const QString &hash, const int width, const int height) {
+
+  QMutexLocker l(db_->Mutex());
+  QSqlDatabase db(db_->Connect());
+
+  SqlQuery q(db);
+  q.prepare(QStringLiteral("INSERT OR REPLACE INTO album_art (directory, path, hash, width, height) VALUES (:directory, :path, :hash, :width, :height)"));
+  q.BindValue(QStringLiteral(":directory"), directory);
+  q.BindValue(QStringLiteral(":path"), path);
+  q.BindValue(QStringLiteral(":hash"), hash);
+  q.BindValue(QStringLiteral(":width"), width);
+  q.BindValue(QStringLiteral(":height"), height);
+  if (!q.Exec()) {
+    db_->ReportErrors(q);
+  }
+
+}
@@ -31,6 +31,10 @@
 #include <QObject>
 #include <QFileInfo>
 #include <QList>
+#include <QHash>
+#include <QSet>
+#include <QMutex>
+#include <QElapsedTimer>
 #include <QString>
 #include <QStringList>
 #include <QUrl>
@@ -46,6 +50,7 @@ class QThread;
 class TaskManager;
 class Database;
 class SmartPlaylistSearch;
+class CollectionSimilarityIndex;
 
 class CollectionBackendInterface : public QObject {
   Q_OBJECT
@@ -123,7 +128,8 @@ class CollectionBackendInterface : public QObject {
 
   virtual Song GetSongById(const int id) = 0;
 
-  virtual SongList GetSongsByFingerprint(const QString &fingerprint) = 0;
+  // Returns the IDs of all songs with a fingerprint, so song tracking can look up fingerprints without a query for each file.
+  virtual QMultiHash<QString, int> GetSongIdsByFingerprint() = 0;
 
   // Returns all sections of a song with the given filename. If there's just one section the resulting list will have it's size equal to 1.
   virtual SongList GetSongsByUrl(const QUrl &url, const bool unavailable = false) = 0;
@@ -131,6 +137,9 @@ class CollectionBackendInterface : public QObject {
   // Using default beginning value is suitable when searching for single-section songs.
   virtual Song GetSongByUrl(const QUrl &url, const qint64 beginning = 0) = 0;
   virtual Song GetSongByUrlAndTrack(const QUrl &url, const int track) = 0;
+  // Returns all sections of the songs with the given filenames, keyed by URL. Songs that are not present in collection are left out.
+  // This uses a single query for many URLs, so it's suitable when many files are added at once.
+  virtual QHash<QUrl, SongList> GetSongsByUrls(const QList<QUrl> &urls) = 0;
 
   virtual void AddDirectory(const QString &path) = 0;
   virtual void RemoveDirectory(const CollectionDirectory &dir) = 0;
@@ -141,6 +150,32 @@ class CollectionBackend : public CollectionBackendInterface {
 
  public:
 
+  // Play statistics changes for one song, applied in bulk by UpdatePlayStatistics().
+  struct PlayStatisticsUpdate {
+    PlayStatisticsUpdate() : id(-1), playcount(0), skipcount(0), lastplayed(-1) {}
+    int id;
+    // Added to the current play and skip counts.
+    int playcount;
+    int skipcount;
+    // Replaces the last played time if it's more recent, -1 leaves it unchanged.
+    qint64 lastplayed;
+  };
+  using PlayStatisticsUpdateList = QList<PlayStatisticsUpdate>;
+
+  // Play statistics for the songs matching an artist, album and title, applied in bulk by UpdatePlayStatisticsByMetadata().
+  struct PlayStatisticsByMetadata {
+    PlayStatisticsByMetadata() : playcount(-1), lastplayed(-1), save_tags(false) {}
+    QString artist;
+    // Matches songs on any album if empty.
+    QString album;
+    QString title;
+    // Replaces the current play count, -1 leaves it unchanged.
+    int playcount;
+    qint64 lastplayed;
+    bool save_tags;
+  };
+  using PlayStatisticsByMetadataList = QList<PlayStatisticsByMetadata>;
+
   Q_INVOKABLE explicit CollectionBackend(QObject *parent = nullptr);
 
   ~CollectionBackend();
@@ -205,6 +240,7 @@ class CollectionBackend : public CollectionBackendInterface {
   SongList GetSongsByUrl(const QUrl &url, const bool unavailable = false) override;
   Song GetSongByUrl(const QUrl &url, qint64 beginning = 0) override;
   Song GetSongByUrlAndTrack(const QUrl &url, const int track) override;
+  QHash<QUrl, SongList> GetSongsByUrls(const QList<QUrl> &urls) override;
 
   void AddDirectory(const QString &path) override;
   void RemoveDirectory(const CollectionDirectory &dir) override;
@@ -216,16 +252,22 @@ class CollectionBackend : public CollectionBackendInterface {
   void IncrementSkipCountAsync(const int id, const float progress);
   void ResetPlayStatisticsAsync(const int id, const bool save_tags = false);
   void ResetPlayStatisticsAsync(const QList<int> &id_list, const bool save_tags = false);
+  void UpdatePlayStatisticsAsync(const PlayStatisticsUpdateList &updates, const bool save_tags = false);
 
   void DeleteAllAsync();
 
   Song GetSongBySongId(const QString &song_id);
   SongList GetSongsBySongId(const QStringList &song_ids);
 
-  SongList GetSongsByFingerprint(const QString &fingerprint) override;
+  QMultiHash<QString, int> GetSongIdsByFingerprint() override;
 
   SongList SmartPlaylistsGetAllSongs();
   SongList SmartPlaylistsFindSongs(const SmartPlaylistSearch &search);
+  QList<int> SmartPlaylistsFindSongIds(const SmartPlaylistSearch &search);
+  int SmartPlaylistsCountSongs(const SmartPlaylistSearch &search);
+
+  // Marked dirty when the songs change, it's built again by the generator that uses it.
+  SharedPtr<CollectionSimilarityIndex> similarity_index() const { return similarity_index_; }
 
   void AddOrUpdateSongsAsync(const SongList &songs);
   void UpdateSongsBySongIDAsync(const SongMap &new_songs);
@@ -233,6 +275,13 @@ class CollectionBackend : public CollectionBackendInterface {
   void UpdateSongRatingAsync(const int id, const float rating, const bool save_tags = false);
   void UpdateSongsRatingAsync(const QList<int> &ids, const float rating, const bool save_tags = false);
 
+  // Subdirectories already completed by an interrupted full scan.
+  // Returns the subdirectories completed by the latest journaled scan of the directory, and when that scan started.
+  QStringList ScanJournal(const int directory_id, qint64 *scan_started);
+
+  // The image picked as album art for a directory with more than one image, or an empty string if the images changed since it was picked.
+  QString BestAlbumArt(const QString &directory, const QString &hash);
+
  public slots:
   void Exit();
   void LoadDirectories();
@@ -242,7 +291,10 @@ class CollectionBackend : public CollectionBackendInterface {
   void AddOrUpdateSongs(const SongList &songs);
   void UpdateSongsBySongID(const SongMap &new_songs);
   void UpdateMTimesOnly(const SongList &songs);
+  void UpdateAnalysisResults(const SongList &songs);
   void DeleteSongs(const SongList &songs);
+  // Makes the directory contain the given songs, only the songs that were added, changed or removed are updated.
+  void ReplaceSongsInDirectory(const int directory_id, const SongList &songs);
   void MarkSongsUnavailable(const SongList &songs, const bool unavailable = true);
   void AddOrUpdateSubdirs(const CollectionSubdirectoryList &subdirs);
   void CompilationsNeedUpdating();
@@ -256,12 +308,14 @@ class CollectionBackend : public CollectionBackendInterface {
   void ResetPlayStatistics(const int id, const bool save_tags = false);
   void ResetPlayStatistics(const QList<int> &id_list, const bool save_tags = false);
   bool ResetPlayStatistics(const QStringList &id_str_list);
+  void UpdatePlayStatistics(const PlayStatisticsUpdateList &updates, const bool save_tags = false);
   void DeleteAll();
-  void SongPathChanged(const Song &song, const QFileInfo &new_file, const std::optional<int> new_collection_directory_id);
+  void SongPathsChanged(const SongList &songs);
 
   SongList GetSongsBy(const QString &artist, const QString &album, const QString &title);
   void UpdateLastPlayed(const QString &artist, const QString &album, const QString &title, const qint64 lastplayed);
   void UpdatePlayCount(const QString &artist, const QString &title, const int playcount, const bool save_tags = false);
+  void UpdatePlayStatisticsByMetadata(const PlayStatisticsByMetadataList &statistics);
 
   void UpdateSongRating(const int id, const float rating, const bool save_tags = false);
   void UpdateSongsRating(const QList<int> &id_list, const float rating, const bool save_tags = false);
@@ -269,6 +323,14 @@ class CollectionBackend : public CollectionBackendInterface {
   void UpdateLastSeen(const int directory_id, const int expire_unavailable_songs_days);
   void ExpireSongs(const int directory_id, const int expire_unavailable_songs_days);
 
+  void AddToScanJournal(const int directory_id, const qint64 scan_started, const QStringList &paths);
+  void ClearScanJournal(const int directory_id);
+
+  void UpdateBestAlbumArt(const QString &directory, const QString &path, const QString &hash, const int width, const int height);
+
+ private slots:
+  void FlushPendingPlayStatistics();
+
  signals:
   void DirectoryDiscovered(const CollectionDirectory &dir, const CollectionSubdirectoryList &subdir);
   void DirectoryDeleted(const CollectionDirectory &dir);
@@ -289,17 +351,13 @@ class CollectionBackend : public CollectionBackendInterface {
   void Error(const QString &error);
 
  private:
-  struct CompilationInfo {
-    CompilationInfo() : has_compilation_detected(0), has_not_compilation_detected(0) {}
-
-    QList<QUrl> urls;
-    QStringList artists;
-
-    int has_compilation_detected;
-    int has_not_compilation_detected;
+  struct TotalsEntry {
+    QString artist;
+    QString album_key;
   };
 
-  bool UpdateCompilations(const QSqlDatabase &db, SongList &deleted_songs, SongList &added_songs, const QUrl &url, const bool compilation_detected);
+  bool UpdateCompilations(QSqlDatabase &db, const QStringList &ids, const bool compilation_detected, SongList &deleted_songs, SongList &added_songs);
+  void AddCompilationAlbums(const SongList &songs);
   AlbumList GetAlbums(const QString &artist, const QString &album_artist, const bool compilation_required = false, const CollectionFilterOptions &opt = CollectionFilterOptions());
   AlbumList GetAlbums(const QString &artist, const bool compilation_required, const CollectionFilterOptions &opt = CollectionFilterOptions());
   CollectionSubdirectoryList SubdirsInDirectory(const int id, QSqlDatabase &db);
@@ -310,8 +368,17 @@ class CollectionBackend : public CollectionBackendInterface {
   Song GetSongBySongId(const QString &song_id, QSqlDatabase &db);
   SongList GetSongsBySongId(const QStringList &song_ids, QSqlDatabase &db);
 
+  // These must be called with totals_mutex_ locked.
+  bool LoadTotals(QSqlDatabase &db);
+  void AddToTotals(const Song &song);
+  void RemoveFromTotals(const int id);
+
+  void UpdateTotals(const SongList &removed_songs, const SongList &added_songs);
+  void EmitTotals(QSqlDatabase &db);
+
  private:
   SharedPtr<Database> db_;
+  SharedPtr<CollectionSimilarityIndex> similarity_index_;
   SharedPtr<TaskManager> task_manager_;
   Song::Source source_;
   QString songs_table_;
@@ -319,7 +386,25 @@ class CollectionBackend : public CollectionBackendInterface {
   QString subdirs_table_;
   QString fts_table_;
   QThread *original_thread_;
+
+  // Totals for the available songs, kept up to date from the changes made through the backend instead of counting the songs table each time.
+  QMutex totals_mutex_;
+  bool totals_loaded_;
+  QElapsedTimer totals_verified_;
+  QHash<int, TotalsEntry> totals_songs_;
+  QHash<QString, int> totals_artists_;
+  QHash<QString, int> totals_albums_;
+
+  // Albums touched since the last compilation detection pass, protected by the database mutex.
+  bool compilations_checked_;
+  QSet<QString> compilation_albums_;
+
+  // Collected from UpdatePlayCount() and UpdateLastPlayed(), only used from the backend thread.
+  PlayStatisticsByMetadataList pending_play_statistics_;
 };
 
+Q_DECLARE_METATYPE(CollectionBackend::PlayStatisticsUpdateList)
+Q_DECLARE_METATYPE(CollectionBackend::PlayStatisticsByMetadataList)
+
 #endif  // COLLECTIONBACKEND_H
 
@@ -32,7 +32,7 @@
 #include "core/filesystemmusicstorage.h"
 #include "core/iconloader.h"
 #include "core/musicstorage.h"
-#include "utilities/diskutils.h"
+#include "core/diskspacemonitor.h"
 #include "collectiondirectory.h"
 #include "collectionbackend.h"
 #include "collectiondirectorymodel.h"
@@ -42,10 +42,12 @@ using std::make_shared;
 CollectionDirectoryModel::CollectionDirectoryModel(SharedPtr<CollectionBackend> backend, QObject *parent)
     : QStandardItemModel(parent),
       dir_icon_(IconLoader::Load(QStringLiteral("document-open-folder"))),
-      backend_(backend) {
+      backend_(backend),
+      disk_space_monitor_(new DiskSpaceMonitor(this)) {
 
   QObject::connect(&*backend_, &CollectionBackend::DirectoryDiscovered, this, &CollectionDirectoryModel::DirectoryDiscovered);
   QObject::connect(&*backend_, &CollectionBackend::DirectoryDeleted, this, &CollectionDirectoryModel::DirectoryDeleted);
+  QObject::connect(disk_space_monitor_, &DiskSpaceMonitor::UsageChanged, this, &CollectionDirectoryModel::DiskUsageChanged);
 
 }
 
@@ -57,12 +59,15 @@ void CollectionDirectoryModel::DirectoryDiscovered(const CollectionDirectory &di
   storage_ << make_shared<FilesystemMusicStorage>(backend_->source(), dir.path, dir.id);
   appendRow(item);
 
+  disk_space_monitor_->Watch(dir.path);
+
 }
 
 void CollectionDirectoryModel::DirectoryDeleted(const CollectionDirectory &dir) {
 
   for (int i = 0; i < rowCount(); ++i) {
     if (item(i, 0)->data(kIdRole).toInt() == dir.id) {
+      disk_space_monitor_->Unwatch(item(i, 0)->text());
       removeRow(i);
       storage_.removeAt(i);
       break;
@@ -97,12 +102,24 @@ QVariant CollectionDirectoryModel::data(const QModelIndex &idx, int role) const
     case MusicStorage::Role_Storage:
     case MusicStorage::Role_StorageForceConnect:
       return QVariant::fromValue(storage_[idx.row()]);
+    // The usage is only read from the cache, the filesystems are polled in the background.
     case MusicStorage::Role_FreeSpace:
-      return Utilities::FileSystemFreeSpace(data(idx, Qt::DisplayRole).toString());
+      return disk_space_monitor_->usage(data(idx, Qt::DisplayRole).toString()).free_space;
     case MusicStorage::Role_Capacity:
-      return Utilities::FileSystemCapacity(data(idx, Qt::DisplayRole).toString());
+      return disk_space_monitor_->usage(data(idx, Qt::DisplayRole).toString()).capacity;
     default:
       return QStandardItemModel::data(idx, role);
   }
 
 }
+
+void CollectionDirectoryModel::DiskUsageChanged(const QString &path) {
+
+  for (int i = 0; i < rowCount(); ++i) {
+    if (item(i, 0)->text() == path) {
+      const QModelIndex idx = index(i, 0);
+      emit dataChanged(idx, idx, { MusicStorage::Role_Capacity, MusicStorage::Role_FreeSpace });
+    }
+  }
+
+}
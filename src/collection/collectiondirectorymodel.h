@@ -37,6 +37,7 @@ class QModelIndex;
 struct CollectionDirectory;
 class CollectionBackend;
 class MusicStorage;
+class DiskSpaceMonitor;
 
 class CollectionDirectoryModel : public QStandardItemModel {
   Q_OBJECT
@@ -55,11 +56,14 @@ class CollectionDirectoryModel : public QStandardItemModel {
   void DirectoryDiscovered(const CollectionDirectory &directories);
   void DirectoryDeleted(const CollectionDirectory &directories);
 
+  void DiskUsageChanged(const QString &path);
+
  private:
   static const int kIdRole = Qt::UserRole + 1;
 
   QIcon dir_icon_;
   SharedPtr<CollectionBackend> backend_;
+  DiskSpaceMonitor *disk_space_monitor_;
   QList<SharedPtr<MusicStorage>> storage_;
 };
 
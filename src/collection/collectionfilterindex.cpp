@@ -0,0 +1,514 @@
+/*
+ * Strawberry Music Player
+ *
+ * Strawberry is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Strawberry is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Strawberry.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#include "config.h"
+
+#include <algorithm>
+#include <utility>
+#include <vector>
+
+#include <QtGlobal>
+#include <QList>
+#include <QHash>
+#include <QChar>
+#include <QString>
+#include <QStringList>
+#include <QVariant>
+#include <QRegularExpression>
+#include <QMutexLocker>
+#include <QReadLocker>
+#include <QWriteLocker>
+#include <QSqlDatabase>
+#include <QSqlError>
+
+#include "core/logging.h"
+#include "core/song.h"
+#include "core/sqlquery.h"
+#include "utilities/searchparserutils.h"
+#include "collectionfilterindex.h"
+
+namespace {
+
+// Same as the tolerance CollectionQuery uses for ratings.
+constexpr double kRatingTolerance = 0.001;
+
+template<typename Predicate>
+void FilterRows(const QList<double> &column, std::vector<quint8> *row_matches, Predicate predicate) {
+
+  const double *values = column.constData();
+  quint8 *matches = row_matches->data();
+  const qint64 count = column.count();
+  for (qint64 i = 0; i < count; ++i) {
+    matches[i] &= predicate(values[i]) ? 1 : 0;
+  }
+
+}
+
+}  // namespace
+
+CollectionFilterIndex::CollectionFilterIndex() : loaded_(false), generation_(0), cached_generation_(0) {
+
+  strings_ << QString();
+  string_ids_.insert(QString(), 0);
+
+}
+
+bool CollectionFilterIndex::loaded() const {
+
+  QReadLocker l(&lock_);
+  return loaded_;
+
+}
+
+int CollectionFilterIndex::size() const {
+
+  QReadLocker l(&lock_);
+  return static_cast<int>(ids_.count());
+
+}
+
+QString CollectionFilterIndex::Normalize(const QString &text) {
+
+  // Match the FTS5 "unicode61 remove_diacritics 1" tokenizer: case folded tokens of letters and numbers, without diacritics.
+  const QString decomposed = text.normalized(QString::NormalizationForm_KD).toCaseFolded();
+
+  QString normalized;
+  normalized.reserve(decomposed.size());
+  bool separator = true;
+  for (const QChar c : decomposed) {
+    if (c.category() == QChar::Mark_NonSpacing) continue;
+    if (c.isLetterOrNumber()) {
+      normalized.append(c);
+      separator = false;
+    }
+    else if (!separator) {
+      normalized.append(QLatin1Char(' '));
+      separator = true;
+    }
+  }
+  if (normalized.endsWith(QLatin1Char(' '))) normalized.chop(1);
+
+  return normalized;
+
+}
+
+bool CollectionFilterIndex::StringMatches(const QString &str, const QString &term) {
+
+  // Phrase match where the last token is a prefix, like "term"* in FTS5.
+  qint64 pos = 0;
+  while ((pos = str.indexOf(term, pos)) != -1) {
+    if (pos == 0 || str.at(pos - 1) == QLatin1Char(' ')) return true;
+    ++pos;
+  }
+
+  return false;
+
+}
+
+CollectionFilterIndex::Row CollectionFilterIndex::RowFromSong(const Song &song) {
+
+  Row row;
+  row.id = song.id();
+
+  row.strings[StringColumn_Title] = song.title();
+  row.strings[StringColumn_Album] = song.album();
+  row.strings[StringColumn_Artist] = song.artist();
+  row.strings[StringColumn_AlbumArtist] = song.albumartist();
+  row.strings[StringColumn_Composer] = song.composer();
+  row.strings[StringColumn_Performer] = song.performer();
+  row.strings[StringColumn_Grouping] = song.grouping();
+  row.strings[StringColumn_Genre] = song.genre();
+  row.strings[StringColumn_Comment] = song.comment();
+
+  row.numbers[NumericColumn_Year] = song.year();
+  row.numbers[NumericColumn_Length] = static_cast<double>(song.length_nanosec());
+  row.numbers[NumericColumn_Samplerate] = song.samplerate();
+  row.numbers[NumericColumn_Bitdepth] = song.bitdepth();
+  row.numbers[NumericColumn_Bitrate] = song.bitrate();
+  row.numbers[NumericColumn_Rating] = song.rating();
+  row.numbers[NumericColumn_PlayCount] = song.playcount();
+  row.numbers[NumericColumn_SkipCount] = song.skipcount();
+
+  return row;
+
+}
+
+quint32 CollectionFilterIndex::Intern(const QString &str) {
+
+  const QString normalized = Normalize(str);
+  QHash<QString, quint32>::const_iterator it = string_ids_.constFind(normalized);
+  if (it != string_ids_.constEnd()) return it.value();
+
+  const quint32 id = static_cast<quint32>(strings_.count());
+  strings_ << normalized;
+  string_ids_.insert(normalized, id);
+
+  return id;
+
+}
+
+void CollectionFilterIndex::SetRow(const int row, const Row &values) {
+
+  for (int column = 0; column < StringColumnCount; ++column) {
+    string_columns_[column][row] = Intern(values.strings[column]);
+  }
+  for (int column = 0; column < NumericColumnCount; ++column) {
+    numeric_columns_[column][row] = values.numbers[column];
+  }
+
+}
+
+void CollectionFilterIndex::AppendRow(const Row &values) {
+
+  rows_.insert(values.id, static_cast<int>(ids_.count()));
+  ids_ << values.id;
+  for (int column = 0; column < StringColumnCount; ++column) {
+    string_columns_[column] << 0;
+  }
+  for (int column = 0; column < NumericColumnCount; ++column) {
+    numeric_columns_[column] << 0;
+  }
+  SetRow(static_cast<int>(ids_.count() - 1), values);
+
+}
+
+void CollectionFilterIndex::RemoveRow(const int row) {
+
+  // Move the last row into the hole, so the columns stay packed.
+  const int last = static_cast<int>(ids_.count() - 1);
+  rows_.remove(ids_[row]);
+  if (row != last) {
+    ids_[row] = ids_[last];
+    rows_[ids_[row]] = row;
+    for (int column = 0; column < StringColumnCount; ++column) {
+      string_columns_[column][row] = string_columns_[column][last];
+    }
+    for (int column = 0; column < NumericColumnCount; ++column) {
+      numeric_columns_[column][row] = numeric_columns_[column][last];
+    }
+  }
+  ids_.removeLast();
+  for (int column = 0; column < StringColumnCount; ++column) {
+    string_columns_[column].removeLast();
+  }
+  for (int column = 0; column < NumericColumnCount; ++column) {
+    numeric_columns_[column].removeLast();
+  }
+
+}
+
+bool CollectionFilterIndex::Load(const QSqlDatabase &db, const QString &songs_table) {
+
+  SqlQuery q(db);
+  q.prepare(QStringLiteral("SELECT ROWID, title, album, artist, albumartist, composer, performer, grouping, genre, comment, year, length, samplerate, bitdepth, bitrate, rating, playcount, skipcount FROM %1 WHERE unavailable = 0").arg(songs_table));
+  if (!q.Exec()) {
+    qLog(Error) << "Failed to load collection filter index" << q.lastError().text();
+    return false;
+  }
+
+  QList<Row> rows;
+  while (q.next()) {
+    Row row;
+    row.id = q.value(0).toInt();
+    for (int column = 0; column < StringColumnCount; ++column) {
+      row.strings[column] = q.value(1 + column).toString();
+    }
+    for (int column = 0; column < NumericColumnCount; ++column) {
+      const QVariant value = q.value(1 + StringColumnCount + column);
+      row.numbers[column] = value.isNull() ? -1 : value.toDouble();
+    }
+    rows << row;
+  }
+
+  QWriteLocker l(&lock_);
+
+  ids_.clear();
+  rows_.clear();
+  ids_.reserve(rows.count());
+  rows_.reserve(rows.count());
+  for (int column = 0; column < StringColumnCount; ++column) {
+    string_columns_[column].clear();
+    string_columns_[column].reserve(rows.count());
+  }
+  for (int column = 0; column < NumericColumnCount; ++column) {
+    numeric_columns_[column].clear();
+    numeric_columns_[column].reserve(rows.count());
+  }
+  for (const Row &row : std::as_const(rows)) {
+    AppendRow(row);
+  }
+  loaded_ = true;
+  ++generation_;
+
+  qLog(Debug) << "Collection filter index loaded with" << ids_.count() << "songs and" << strings_.count() << "strings";
+
+  return true;
+
+}
+
+void CollectionFilterIndex::AddOrUpdateSongs(const SongList &songs) {
+
+  QWriteLocker l(&lock_);
+
+  for (const Song &song : songs) {
+    if (song.id() == -1) continue;
+    QHash<int, int>::const_iterator it = rows_.constFind(song.id());
+    if (song.unavailable()) {
+      if (it != rows_.constEnd()) RemoveRow(it.value());
+    }
+    else if (it != rows_.constEnd()) {
+      SetRow(it.value(), RowFromSong(song));
+    }
+    else {
+      AppendRow(RowFromSong(song));
+    }
+  }
+
+  ++generation_;
+
+}
+
+void CollectionFilterIndex::RemoveSongs(const SongList &songs) {
+
+  QWriteLocker l(&lock_);
+
+  for (const Song &song : songs) {
+    QHash<int, int>::const_iterator it = rows_.constFind(song.id());
+    if (it != rows_.constEnd()) RemoveRow(it.value());
+  }
+
+  ++generation_;
+
+}
+
+bool CollectionFilterIndex::ParseFilterText(const QString &filter_text, QList<TextTerm> *text_terms, QList<NumericTerm> *numeric_terms) {
+
+  // This follows how CollectionQuery turns the filter text into an FTS5 query and numeric where clauses.
+  static const QStringList kStringColumnNames = QStringList() << QStringLiteral("title")
+                                                              << QStringLiteral("album")
+                                                              << QStringLiteral("artist")
+                                                              << QStringLiteral("albumartist")
+                                                              << QStringLiteral("composer")
+                                                              << QStringLiteral("performer")
+                                                              << QStringLiteral("grouping")
+                                                              << QStringLiteral("genre")
+                                                              << QStringLiteral("comment");
+  static const QStringList kNumericColumnNames = QStringList() << QStringLiteral("year")
+                                                               << QStringLiteral("length")
+                                                               << QStringLiteral("samplerate")
+                                                               << QStringLiteral("bitdepth")
+                                                               << QStringLiteral("bitrate")
+                                                               << QStringLiteral("rating")
+                                                               << QStringLiteral("playcount")
+                                                               << QStringLiteral("skipcount");
+  static const QRegularExpression kOperatorRegex(QStringLiteral("^(=|<[>=]?|>=?|!=)"));
+
+  auto add_text_term = [text_terms](const QString &text, const int column) {
+    const QString normalized = Normalize(text);
+    if (!normalized.isEmpty()) {
+      text_terms->append(TextTerm{normalized, column});
+    }
+  };
+
+  const QString text = QString(filter_text).replace(QRegularExpression(QStringLiteral(":\\s+")), QStringLiteral(":"));
+#if QT_VERSION >= QT_VERSION_CHECK(5, 14, 0)
+  const QStringList tokens = text.split(QRegularExpression(QStringLiteral("\\s+")), Qt::SkipEmptyParts);
+#else
+  const QStringList tokens = text.split(QRegularExpression(QStringLiteral("\\s+")), QString::SkipEmptyParts);
+#endif
+  for (QString token : tokens) {
+    token.remove(QLatin1Char('('))
+         .remove(QLatin1Char(')'))
+         .remove(QLatin1Char('"'))
+         .replace(QLatin1Char('-'), QLatin1Char(' '));
+
+    if (!token.contains(QLatin1Char(':'))) {
+      add_text_term(token, -1);
+      continue;
+    }
+
+    const QString columntoken = token.section(QLatin1Char(':'), 0, 0);
+    QString subtoken = token.section(QLatin1Char(':'), 1, -1).replace(QLatin1String(":"), QLatin1String(" ")).trimmed();
+    if (subtoken.isEmpty()) continue;
+
+    const qint64 string_column = kStringColumnNames.indexOf(columntoken.toLower());
+    const qint64 numeric_column = kNumericColumnNames.indexOf(columntoken.toLower());
+    if (string_column != -1) {
+      add_text_term(subtoken, static_cast<int>(string_column));
+    }
+    else if (numeric_column != -1) {
+      const QRegularExpressionMatch match = kOperatorRegex.match(subtoken);
+      const QString op = match.hasMatch() ? match.captured(0) : QStringLiteral("=");
+      subtoken.remove(kOperatorRegex);
+
+      NumericTerm term;
+      term.column = static_cast<NumericColumn>(numeric_column);
+      term.value2 = 0;
+      if (op == QLatin1String("!=") || op == QLatin1String("<>")) term.comparison = Comparison::NotEqual;
+      else if (op == QLatin1String("<")) term.comparison = Comparison::Less;
+      else if (op == QLatin1String("<=")) term.comparison = Comparison::LessOrEqual;
+      else if (op == QLatin1String(">")) term.comparison = Comparison::Greater;
+      else if (op == QLatin1String(">=")) term.comparison = Comparison::GreaterOrEqual;
+      else term.comparison = Comparison::Equal;
+
+      if (term.column == NumericColumn_Rating) {
+        const double rating = Utilities::ParseSearchRating(subtoken);
+        term.value = rating;
+        switch (term.comparison) {
+          case Comparison::Less:
+          case Comparison::GreaterOrEqual:
+            term.value = rating - kRatingTolerance;
+            break;
+          case Comparison::Greater:
+          case Comparison::LessOrEqual:
+            term.value = rating + kRatingTolerance;
+            break;
+          case Comparison::NotEqual:
+            term.comparison = Comparison::Outside;
+            term.value = rating - kRatingTolerance;
+            term.value2 = rating + kRatingTolerance;
+            break;
+          default:
+            term.comparison = Comparison::Between;
+            term.value = rating - kRatingTolerance;
+            term.value2 = rating + kRatingTolerance;
+            break;
+        }
+      }
+      else if (term.column == NumericColumn_Length) {
+        // Time is saved in nanoseconds
+        term.value = static_cast<double>(Utilities::ParseSearchTime(subtoken)) * 1e9;
+      }
+      else {
+        bool ok = false;
+        term.value = subtoken.toDouble(&ok);
+        // SQLite compares numbers as less than any text.
+        if (!ok) {
+          if (term.comparison == Comparison::Equal || term.comparison == Comparison::Greater || term.comparison == Comparison::GreaterOrEqual) {
+            return false;
+          }
+          continue;
+        }
+      }
+      numeric_terms->append(term);
+    }
+    // Not a valid column, search for the whole token
+    else {
+      add_text_term(token.replace(QLatin1String(":"), QLatin1String(" ")), -1);
+    }
+  }
+
+  return true;
+
+}
+
+QList<int> CollectionFilterIndex::MatchTerms(const QList<TextTerm> &text_terms, const QList<NumericTerm> &numeric_terms) const {
+
+  const qint64 row_count = ids_.count();
+  std::vector<quint8> row_matches(static_cast<size_t>(row_count), 1);
+
+  for (const TextTerm &term : text_terms) {
+    // Match each distinct string once, then look the rows up by string ID.
+    std::vector<quint8> string_matches(static_cast<size_t>(strings_.count()));
+    for (qint64 i = 0; i < strings_.count(); ++i) {
+      string_matches[static_cast<size_t>(i)] = StringMatches(strings_[i], term.text) ? 1 : 0;
+    }
+
+    std::vector<quint8> term_matches(static_cast<size_t>(row_count), 0);
+    for (int column = 0; column < StringColumnCount; ++column) {
+      if (term.column != -1 && term.column != column) continue;
+      const quint32 *string_ids = string_columns_[column].constData();
+      for (qint64 row = 0; row < row_count; ++row) {
+        term_matches[static_cast<size_t>(row)] |= string_matches[string_ids[row]];
+      }
+    }
+    for (qint64 row = 0; row < row_count; ++row) {
+      row_matches[static_cast<size_t>(row)] &= term_matches[static_cast<size_t>(row)];
+    }
+  }
+
+  for (const NumericTerm &term : numeric_terms) {
+    const QList<double> &column = numeric_columns_[term.column];
+    const double value = term.value;
+    const double value2 = term.value2;
+    switch (term.comparison) {
+      case Comparison::Equal:
+        FilterRows(column, &row_matches, [value](const double v) { return v == value; });
+        break;
+      case Comparison::NotEqual:
+        FilterRows(column, &row_matches, [value](const double v) { return v != value; });
+        break;
+      case Comparison::Less:
+        FilterRows(column, &row_matches, [value](const double v) { return v < value; });
+        break;
+      case Comparison::LessOrEqual:
+        FilterRows(column, &row_matches, [value](const double v) { return v <= value; });
+        break;
+      case Comparison::Greater:
+        FilterRows(column, &row_matches, [value](const double v) { return v > value; });
+        break;
+      case Comparison::GreaterOrEqual:
+        FilterRows(column, &row_matches, [value](const double v) { return v >= value; });
+        break;
+      case Comparison::Between:
+        FilterRows(column, &row_matches, [value, value2](const double v) { return v > value && v < value2; });
+        break;
+      case Comparison::Outside:
+        FilterRows(column, &row_matches, [value, value2](const double v) { return v < value || v > value2; });
+        break;
+    }
+  }
+
+  QList<int> ids;
+  for (qint64 row = 0; row < row_count; ++row) {
+    if (row_matches[static_cast<size_t>(row)]) ids << ids_[row];
+  }
+
+  return ids;
+
+}
+
+std::optional<QList<int>> CollectionFilterIndex::Match(const QString &filter_text) const {
+
+  QReadLocker l(&lock_);
+
+  {
+    QMutexLocker cache_lock(&cache_mutex_);
+    if (cached_generation_ == generation_ && !cached_filter_text_.isNull() && cached_filter_text_ == filter_text) {
+      return cached_match_;
+    }
+  }
+
+  QList<TextTerm> text_terms;
+  QList<NumericTerm> numeric_terms;
+  std::optional<QList<int>> match;
+  if (!ParseFilterText(filter_text, &text_terms, &numeric_terms)) {
+    match = QList<int>();
+  }
+  else if (!text_terms.isEmpty() || !numeric_terms.isEmpty()) {
+    match = MatchTerms(text_terms, numeric_terms);
+  }
+
+  QMutexLocker cache_lock(&cache_mutex_);
+  cached_generation_ = generation_;
+  cached_filter_text_ = filter_text;
+  cached_match_ = match;
+
+  return match;
+
+}
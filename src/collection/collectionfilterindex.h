@@ -0,0 +1,144 @@
+/*
+ * Strawberry Music Player
+ *
+ * Strawberry is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Strawberry is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Strawberry.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#ifndef COLLECTIONFILTERINDEX_H
+#define COLLECTIONFILTERINDEX_H
+
+#include "config.h"
+
+#include <array>
+#include <optional>
+
+#include <QtGlobal>
+#include <QList>
+#include <QHash>
+#include <QString>
+#include <QStringList>
+#include <QMutex>
+#include <QReadWriteLock>
+#include <QSqlDatabase>
+
+#include "core/song.h"
+
+// In-memory, column oriented copy of the searchable song fields, so the collection filter text can be evaluated without the FTS join.
+// Strings are normalized like the FTS5 unicode61 tokenizer sees them and interned, so each distinct string is matched once per filter,
+// and the work per song is a scan over packed integer and number columns.
+class CollectionFilterIndex {
+ public:
+  explicit CollectionFilterIndex();
+
+  bool Load(const QSqlDatabase &db, const QString &songs_table);
+  void AddOrUpdateSongs(const SongList &songs);
+  void RemoveSongs(const SongList &songs);
+
+  bool loaded() const;
+  int size() const;
+
+  // ROWIDs of the songs matching the filter text, nullopt if the filter text doesn't restrict the songs at all.
+  std::optional<QList<int>> Match(const QString &filter_text) const;
+
+  static QString Normalize(const QString &text);
+
+ private:
+  enum StringColumn {
+    StringColumn_Title,
+    StringColumn_Album,
+    StringColumn_Artist,
+    StringColumn_AlbumArtist,
+    StringColumn_Composer,
+    StringColumn_Performer,
+    StringColumn_Grouping,
+    StringColumn_Genre,
+    StringColumn_Comment,
+    StringColumnCount
+  };
+
+  enum NumericColumn {
+    NumericColumn_Year,
+    NumericColumn_Length,
+    NumericColumn_Samplerate,
+    NumericColumn_Bitdepth,
+    NumericColumn_Bitrate,
+    NumericColumn_Rating,
+    NumericColumn_PlayCount,
+    NumericColumn_SkipCount,
+    NumericColumnCount
+  };
+
+  enum class Comparison {
+    Equal,
+    NotEqual,
+    Less,
+    LessOrEqual,
+    Greater,
+    GreaterOrEqual,
+    Between,
+    Outside
+  };
+
+  struct TextTerm {
+    QString text;
+    int column;  // StringColumn, or -1 for all columns
+  };
+
+  struct NumericTerm {
+    NumericColumn column;
+    Comparison comparison;
+    double value;
+    double value2;
+  };
+
+  struct Row {
+    int id;
+    std::array<QString, StringColumnCount> strings;
+    std::array<double, NumericColumnCount> numbers;
+  };
+
+  static Row RowFromSong(const Song &song);
+  static bool ParseFilterText(const QString &filter_text, QList<TextTerm> *text_terms, QList<NumericTerm> *numeric_terms);
+  static bool StringMatches(const QString &str, const QString &term);
+
+  quint32 Intern(const QString &str);
+  void SetRow(const int row, const Row &values);
+  void AppendRow(const Row &values);
+  void RemoveRow(const int row);
+
+  QList<int> MatchTerms(const QList<TextTerm> &text_terms, const QList<NumericTerm> &numeric_terms) const;
+
+  mutable QReadWriteLock lock_;
+  bool loaded_;
+  // Incremented on every change, so cached matches from before the change aren't used.
+  quint64 generation_;
+
+  // Interned normalized strings, with the empty string always at 0.
+  QStringList strings_;
+  QHash<QString, quint32> string_ids_;
+
+  QList<int> ids_;
+  QHash<int, int> rows_;
+  std::array<QList<quint32>, StringColumnCount> string_columns_;
+  std::array<QList<double>, NumericColumnCount> numeric_columns_;
+
+  // Typing in the filter repeats the same query for every lazy loaded node, so keep the last result.
+  mutable QMutex cache_mutex_;
+  mutable quint64 cached_generation_;
+  mutable QString cached_filter_text_;
+  mutable std::optional<QList<int>> cached_match_;
+};
+
+#endif  // COLLECTIONFILTERINDEX_H
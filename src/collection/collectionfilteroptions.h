@@ -20,6 +20,9 @@
 #ifndef COLLECTIONFILTEROPTIONS_H
 #define COLLECTIONFILTEROPTIONS_H
 
+#include <optional>
+
+#include <QList>
 #include <QString>
 
 #include "core/song.h"
@@ -43,16 +46,24 @@ class CollectionFilterOptions {
   FilterMode filter_mode() const { return filter_mode_; }
   int max_age() const { return max_age_; }
   QString filter_text() const { return filter_text_; }
+  // ROWIDs of the songs matching the filter text, when it was evaluated by the in-memory filter index.
+  const std::optional<QList<int>> &filter_ids() const { return filter_ids_; }
+  // Match the words of the filter text anywhere in the columns using the trigram index, instead of only at the start of words.
+  bool substring_search() const { return substring_search_; }
 
   void set_filter_mode(const FilterMode filter_mode) {
     filter_mode_ = filter_mode;
     filter_text_.clear();
+    filter_ids_.reset();
   }
   void set_max_age(const int max_age) { max_age_ = max_age; }
   void set_filter_text(const QString &filter_text) {
     filter_mode_ = FilterMode::All;
     filter_text_ = filter_text;
+    filter_ids_.reset();
   }
+  void set_filter_ids(const QList<int> &filter_ids) { filter_ids_ = filter_ids; }
+  void set_substring_search(const bool substring_search) { substring_search_ = substring_search; }
 
   bool Matches(const Song &song) const;
 
@@ -60,6 +71,8 @@ class CollectionFilterOptions {
   FilterMode filter_mode_;
   int max_age_;
   QString filter_text_;
+  std::optional<QList<int>> filter_ids_;
+  bool substring_search_;
 };
 
 #endif  // COLLECTIONFILTEROPTIONS_H
@@ -0,0 +1,272 @@
+/*
+ * Strawberry Music Player
+ *
+ * Strawberry is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Strawberry is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Strawberry.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+
+#include "config.h"
+
+#include <cstring>
+#include <algorithm>
+
+#include <QtGlobal>
+#include <QtEndian>
+#include <QList>
+#include <QHash>
+#include <QByteArray>
+#include <QString>
+#include <QImage>
+#include <QPainter>
+#include <QFile>
+#include <QFileInfo>
+#include <QDir>
+#include <QCryptographicHash>
+
+#include "core/logging.h"
+#include "collectioniconatlas.h"
+
+namespace {
+constexpr quint32 kMagic = 0x41434953;  // "SICA"
+constexpr quint32 kVersion = 1;
+// The index starts after a fixed size header, so it stays aligned if the header grows.
+constexpr qint64 kHeaderSize = 64;
+constexpr quint32 kMinCapacity = 64;
+constexpr quint32 kMaxCapacity = 1U << 20U;
+}  // namespace
+
+CollectionIconAtlas::CollectionIconAtlas(const QString &filename, const int tile_size)
+    : file_(filename),
+      tile_size_(tile_size),
+      data_(nullptr) {}
+
+CollectionIconAtlas::~CollectionIconAtlas() {
+  Close();
+}
+
+quint64 CollectionIconAtlas::KeyHash(const QString &key) {
+
+  // qHash is seeded per process, the hashes stored in the file need to be the same every time.
+  const QByteArray hash = QCryptographicHash::hash(key.toUtf8(), QCryptographicHash::Md5);
+  const quint64 key_hash = qFromLittleEndian<quint64>(hash.constData());
+
+  // Zero marks an unused tile.
+  return key_hash == 0 ? 1 : key_hash;
+
+}
+
+qint64 CollectionIconAtlas::FileSize(const quint32 capacity) const {
+  return kHeaderSize + static_cast<qint64>(capacity) * (static_cast<qint64>(sizeof(quint64)) + TileBytes());
+}
+
+quint32 CollectionIconAtlas::CapacityForSize(const qint64 max_size) const {
+
+  const qint64 capacity = (max_size - kHeaderSize) / (static_cast<qint64>(sizeof(quint64)) + TileBytes());
+  return static_cast<quint32>(std::clamp(capacity, static_cast<qint64>(kMinCapacity), static_cast<qint64>(kMaxCapacity)));
+
+}
+
+quint64 *CollectionIconAtlas::index() const {
+  return reinterpret_cast<quint64*>(data_ + kHeaderSize);
+}
+
+uchar *CollectionIconAtlas::tile(const quint32 i) const {
+  return data_ + kHeaderSize + static_cast<qint64>(header()->capacity) * static_cast<qint64>(sizeof(quint64)) + static_cast<qint64>(i) * TileBytes();
+}
+
+bool CollectionIconAtlas::Open(const qint64 max_size) {
+
+  const quint32 capacity = CapacityForSize(max_size);
+  if (is_open() && header()->capacity == capacity) return true;
+
+  Close();
+
+  if (!QDir().mkpath(QFileInfo(file_.fileName()).absolutePath())) {
+    qLog(Error) << "Could not create directory for" << file_.fileName();
+    return false;
+  }
+
+  if (!file_.open(QIODevice::ReadWrite)) {
+    qLog(Error) << "Could not open" << file_.fileName() << file_.errorString();
+    return false;
+  }
+
+  if (file_.size() == FileSize(capacity)) {
+    data_ = file_.map(0, file_.size());
+    if (data_) {
+      const Header *h = header();
+      if (h->magic == kMagic && h->version == kVersion && h->tile_size == static_cast<quint32>(tile_size_) && h->capacity == capacity && h->used <= capacity && h->next < capacity) {
+        const quint64 *idx = index();
+        for (quint32 i = 0; i < h->used; ++i) {
+          if (idx[i] == 0) {
+            free_tiles_ << i;
+          }
+          else {
+            tiles_.insert(idx[i], i);
+          }
+        }
+        return true;
+      }
+      file_.unmap(data_);
+      data_ = nullptr;
+    }
+  }
+
+  // The file is new, from another version or for a different size.
+  return Create(capacity);
+
+}
+
+bool CollectionIconAtlas::Create(const quint32 capacity) {
+
+  tiles_.clear();
+  free_tiles_.clear();
+
+  if (!file_.resize(0) || !file_.resize(FileSize(capacity))) {
+    qLog(Error) << "Could not resize" << file_.fileName() << file_.errorString();
+    file_.close();
+    return false;
+  }
+
+  data_ = file_.map(0, file_.size());
+  if (!data_) {
+    qLog(Error) << "Could not map" << file_.fileName() << file_.errorString();
+    file_.close();
+    return false;
+  }
+
+  // Only the header and index need to be cleared, the tiles are written before they are added to the index.
+  memset(data_, 0, static_cast<size_t>(kHeaderSize + static_cast<qint64>(capacity) * static_cast<qint64>(sizeof(quint64))));
+  Header *h = header();
+  h->magic = kMagic;
+  h->version = kVersion;
+  h->tile_size = static_cast<quint32>(tile_size_);
+  h->capacity = capacity;
+  h->used = 0;
+  h->next = 0;
+
+  return true;
+
+}
+
+void CollectionIconAtlas::Close() {
+
+  if (data_) {
+    file_.unmap(data_);
+    data_ = nullptr;
+  }
+  if (file_.isOpen()) {
+    file_.close();
+  }
+  tiles_.clear();
+  free_tiles_.clear();
+
+}
+
+bool CollectionIconAtlas::Contains(const QString &key) const {
+
+  return is_open() && tiles_.contains(KeyHash(key));
+
+}
+
+QImage CollectionIconAtlas::Find(const QString &key) const {
+
+  if (!is_open()) return QImage();
+
+  const quint64 key_hash = KeyHash(key);
+  if (!tiles_.contains(key_hash)) return QImage();
+
+  // Copy the pixels, the mapping can go away while the image is still in use.
+  return QImage(tile(tiles_.value(key_hash)), tile_size_, tile_size_, tile_size_ * 4, QImage::Format_ARGB32_Premultiplied).copy();
+
+}
+
+void CollectionIconAtlas::Insert(const QString &key, const QImage &image) {
+
+  if (!is_open() || image.isNull()) return;
+
+  QImage tile_image = image.convertToFormat(QImage::Format_ARGB32_Premultiplied);
+  if (tile_image.width() != tile_size_ || tile_image.height() != tile_size_) {
+    // Scale and pad to the tile size.
+    const QImage scaled_image = tile_image.scaled(tile_size_, tile_size_, Qt::KeepAspectRatio, Qt::SmoothTransformation);
+    tile_image = QImage(tile_size_, tile_size_, QImage::Format_ARGB32_Premultiplied);
+    tile_image.fill(Qt::transparent);
+    QPainter p(&tile_image);
+    p.drawImage((tile_size_ - scaled_image.width()) / 2, (tile_size_ - scaled_image.height()) / 2, scaled_image);
+    p.end();
+  }
+
+  Header *h = header();
+  quint64 *idx = index();
+  const quint64 key_hash = KeyHash(key);
+
+  quint32 i = 0;
+  if (tiles_.contains(key_hash)) {
+    i = tiles_.value(key_hash);
+  }
+  else if (!free_tiles_.isEmpty()) {
+    i = free_tiles_.takeLast();
+  }
+  else if (h->used < h->capacity) {
+    i = h->used++;
+  }
+  else {
+    // Full, overwrite the oldest tile.
+    i = h->next;
+    h->next = (h->next + 1) % h->capacity;
+    if (idx[i] != 0) tiles_.remove(idx[i]);
+  }
+
+  // Clear the index entry while the pixels are written, so a crash doesn't leave a tile with the wrong image.
+  idx[i] = 0;
+  uchar *pixels = tile(i);
+  const qint64 bytes_per_line = static_cast<qint64>(tile_size_) * 4;
+  for (int y = 0; y < tile_size_; ++y) {
+    memcpy(pixels + y * bytes_per_line, tile_image.constScanLine(y), static_cast<size_t>(bytes_per_line));
+  }
+  idx[i] = key_hash;
+  tiles_.insert(key_hash, i);
+
+}
+
+void CollectionIconAtlas::Remove(const QString &key) {
+
+  if (!is_open()) return;
+
+  const quint64 key_hash = KeyHash(key);
+  if (!tiles_.contains(key_hash)) return;
+
+  const quint32 i = tiles_.take(key_hash);
+  index()[i] = 0;
+  free_tiles_ << i;
+
+}
+
+void CollectionIconAtlas::Clear() {
+
+  if (!is_open()) return;
+
+  const quint32 capacity = header()->capacity;
+  file_.unmap(data_);
+  data_ = nullptr;
+  Create(capacity);
+
+}
+
+qint64 CollectionIconAtlas::size() const {
+
+  return static_cast<qint64>(tiles_.count()) * TileBytes();
+
+}
@@ -0,0 +1,83 @@
+/*
+ * Strawberry Music Player
+ *
+ * Strawberry is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Strawberry is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Strawberry.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+
+#ifndef COLLECTIONICONATLAS_H
+#define COLLECTIONICONATLAS_H
+
+#include "config.h"
+
+#include <QtGlobal>
+#include <QList>
+#include <QHash>
+#include <QString>
+#include <QImage>
+#include <QFile>
+
+// Disk cache for the collection album icons, stored as fixed size pre-scaled tiles in a single memory-mapped file.
+// The file has a header, an index with the key hash of each tile, and the tiles themselves as premultiplied ARGB32 pixels,
+// so opening it reads the index once, and a lookup is a copy of the tile pixels.
+// When the file is full, the oldest tiles are overwritten first.
+class CollectionIconAtlas {
+ public:
+  explicit CollectionIconAtlas(const QString &filename, const int tile_size);
+  ~CollectionIconAtlas();
+
+  // The number of tiles is derived from the maximum size, the atlas is recreated if that changes.
+  bool Open(const qint64 max_size);
+  void Close();
+  bool is_open() const { return data_ != nullptr; }
+
+  bool Contains(const QString &key) const;
+  QImage Find(const QString &key) const;
+  void Insert(const QString &key, const QImage &image);
+  void Remove(const QString &key);
+  void Clear();
+
+  // Bytes used by the stored tiles.
+  qint64 size() const;
+
+ private:
+  struct Header {
+    quint32 magic;
+    quint32 version;
+    quint32 tile_size;
+    quint32 capacity;
+    quint32 used;
+    quint32 next;
+  };
+
+  static quint64 KeyHash(const QString &key);
+  qint64 TileBytes() const { return static_cast<qint64>(tile_size_) * tile_size_ * 4; }
+  qint64 FileSize(const quint32 capacity) const;
+  quint32 CapacityForSize(const qint64 max_size) const;
+  bool Create(const quint32 capacity);
+  Header *header() const { return reinterpret_cast<Header*>(data_); }
+  quint64 *index() const;
+  uchar *tile(const quint32 i) const;
+
+  QFile file_;
+  const int tile_size_;
+  uchar *data_;
+  QHash<quint64, quint32> tiles_;
+  QList<quint32> free_tiles_;
+
+  Q_DISABLE_COPY(CollectionIconAtlas)
+};
+
+#endif  // COLLECTIONICONATLAS_H
@@ -26,6 +26,7 @@
 
 #include "core/simpletreeitem.h"
 #include "core/song.h"
+#include "core/memorystats.h"
 
 class CollectionItem : public SimpleTreeItem<CollectionItem> {
  public:
@@ -40,18 +41,26 @@ class CollectionItem : public SimpleTreeItem<CollectionItem> {
   explicit CollectionItem(SimpleTreeModel<CollectionItem> *_model)
       : SimpleTreeItem<CollectionItem>(Type_Root, _model),
         container_level(-1),
-        compilation_artist_node_(nullptr) {}
+        partial_metadata(false),
+        compilation_artist_node_(nullptr),
+        memory_counter_(sizeof(CollectionItem)) {}
 
   explicit CollectionItem(Type _type, CollectionItem *_parent = nullptr)
       : SimpleTreeItem<CollectionItem>(_type, _parent),
         container_level(-1),
-        compilation_artist_node_(nullptr) {}
+        partial_metadata(false),
+        compilation_artist_node_(nullptr),
+        memory_counter_(sizeof(CollectionItem)) {}
 
   int container_level;
   Song metadata;
+  // Song items populated from a query only have the columns needed to display them.
+  bool partial_metadata;
   CollectionItem *compilation_artist_node_;
 
  private:
+  memorystats::ObjectCounter<memorystats::Counter::CollectionItem> memory_counter_;
+
   Q_DISABLE_COPY(CollectionItem)
 };
 
@@ -40,6 +40,7 @@
 #include <QList>
 #include <QSet>
 #include <QMap>
+#include <QHash>
 #include <QMetaType>
 #include <QVariant>
 #include <QString>
@@ -49,25 +50,31 @@
 #include <QChar>
 #include <QRegularExpression>
 #include <QPixmapCache>
-#include <QNetworkDiskCache>
+#include <QDir>
 #include <QSettings>
 #include <QStandardPaths>
+#include <QTimer>
 
 #include "core/scoped_ptr.h"
 #include "core/shared_ptr.h"
 #include "core/application.h"
+#include "core/trace.h"
 #include "core/database.h"
 #include "core/iconloader.h"
 #include "core/logging.h"
 #include "core/taskmanager.h"
 #include "core/sqlrow.h"
 #include "core/settings.h"
+#include "utilities/collationkey.h"
 #include "collectionfilteroptions.h"
+#include "collectionfilterindex.h"
 #include "collectionquery.h"
 #include "collectionqueryoptions.h"
 #include "collectionbackend.h"
 #include "collectiondirectorymodel.h"
 #include "collectionitem.h"
+#include "collectioniconatlas.h"
+#include "collectiontreesnapshot.h"
 #include "collectionmodel.h"
 #include "playlist/playlistmanager.h"
 #include "playlist/songmimedata.h"
@@ -76,10 +83,65 @@
 #include "covermanager/albumcoverloader.h"
 #include "settings/collectionsettingspage.h"
 
+using std::make_shared;
+
+namespace {
+
+// Columns needed to display, sort and load covers for song items.
+// Lyrics, fingerprints, MusicBrainz IDs and so on are loaded by ROWID when the songs are actually used.
+const QStringList kSongItemColumns = QStringList() << QStringLiteral("title")
+                                                   << QStringLiteral("album")
+                                                   << QStringLiteral("artist")
+                                                   << QStringLiteral("albumartist")
+                                                   << QStringLiteral("track")
+                                                   << QStringLiteral("disc")
+                                                   << QStringLiteral("year")
+                                                   << QStringLiteral("originalyear")
+                                                   << QStringLiteral("genre")
+                                                   << QStringLiteral("compilation")
+                                                   << QStringLiteral("composer")
+                                                   << QStringLiteral("performer")
+                                                   << QStringLiteral("grouping")
+                                                   << QStringLiteral("album_id")
+                                                   << QStringLiteral("song_id")
+                                                   << QStringLiteral("beginning")
+                                                   << QStringLiteral("length")
+                                                   << QStringLiteral("bitrate")
+                                                   << QStringLiteral("samplerate")
+                                                   << QStringLiteral("bitdepth")
+                                                   << QStringLiteral("source")
+                                                   << QStringLiteral("directory_id")
+                                                   << QStringLiteral("url")
+                                                   << QStringLiteral("filetype")
+                                                   << QStringLiteral("unavailable")
+                                                   << QStringLiteral("rating")
+                                                   << QStringLiteral("compilation_detected")
+                                                   << QStringLiteral("compilation_on")
+                                                   << QStringLiteral("compilation_off")
+                                                   << QStringLiteral("art_embedded")
+                                                   << QStringLiteral("art_automatic")
+                                                   << QStringLiteral("art_manual")
+                                                   << QStringLiteral("art_unset")
+                                                   << QStringLiteral("cue_path");
+
+// Maximum number of album covers requested from the cover loader at once, the oldest requests are cancelled first.
+constexpr int kMaxPendingArt = 100;
+
+// Bounds for prefetching children of containers that are likely to be expanded.
+constexpr int kMaxPrefetchQueue = 16;
+constexpr int kMaxPrefetchJobs = 2;
+constexpr int kPrefetchCacheMaxRows = 20000;
+
+constexpr int kTreeSnapshotDelay = 10000;
+
+}  // namespace
+
 const int CollectionModel::kPrettyCoverSize = 32;
 const char *CollectionModel::kPixmapDiskCacheDir = "pixmapcache";
+const char *CollectionModel::kIconAtlasFile = "collectionicons.atlas";
+const char *CollectionModel::kTreeSnapshotFile = "collectiontree.snapshot";
 
-QNetworkDiskCache *CollectionModel::sIconCache = nullptr;
+ScopedPtr<CollectionIconAtlas> CollectionModel::sIconCache;
 
 CollectionModel::CollectionModel(SharedPtr<CollectionBackend> backend, Application *app, QObject *parent)
     : SimpleTreeModel<CollectionItem>(new CollectionItem(this), parent),
@@ -92,13 +154,19 @@ CollectionModel::CollectionModel(SharedPtr<CollectionBackend> backend, Applicati
       total_artist_count_(0),
       total_album_count_(0),
       separate_albums_by_grouping_(false),
+      tree_generation_(0),
+      tree_populated_(false),
+      tree_separate_albums_by_grouping_(false),
       artist_icon_(IconLoader::Load(QStringLiteral("folder-sound"))),
       album_icon_(IconLoader::Load(QStringLiteral("cdcase"))),
       init_task_id_(-1),
       use_pretty_covers_(true),
       show_dividers_(true),
       use_disk_cache_(false),
-      use_lazy_loading_(true) {
+      use_lazy_loading_(true),
+      prefetch_cache_(kPrefetchCacheMaxRows),
+      prefetch_generation_(0),
+      tree_snapshot_timer_(new QTimer(this)) {
 
   root_->lazy_loaded = true;
 
@@ -117,10 +185,21 @@ CollectionModel::CollectionModel(SharedPtr<CollectionBackend> backend, Applicati
   }
 
   if (app_ && !sIconCache) {
-    sIconCache = new QNetworkDiskCache(this);
-    sIconCache->setCacheDirectory(QStandardPaths::writableLocation(QStandardPaths::CacheLocation) + QLatin1Char('/') + QLatin1String(kPixmapDiskCacheDir));
-    QObject::connect(app_, &Application::ClearPixmapDiskCache, this, &CollectionModel::ClearDiskCache);
+    const QString cache_location = QStandardPaths::writableLocation(QStandardPaths::CacheLocation);
+    // Remove the disk cache from before the icons were stored in the atlas.
+    QDir old_cache_dir(cache_location + QLatin1Char('/') + QLatin1String(kPixmapDiskCacheDir));
+    if (old_cache_dir.exists()) old_cache_dir.removeRecursively();
+    sIconCache.reset(new CollectionIconAtlas(cache_location + QLatin1Char('/') + QLatin1String(kIconAtlasFile), kPrettyCoverSize));
+    // The atlas is shared by all models, so it's not cleared through the model that created it.
+    QObject::connect(app_, &Application::ClearPixmapDiskCache, app_, &CollectionModel::ClearDiskCache);
+  }
+
+  if (app_ && backend_->source() == Song::Source::Collection) {
+    tree_snapshot_filename_ = QStandardPaths::writableLocation(QStandardPaths::CacheLocation) + QLatin1Char('/') + QLatin1String(kTreeSnapshotFile);
   }
+  tree_snapshot_timer_->setSingleShot(true);
+  tree_snapshot_timer_->setInterval(kTreeSnapshotDelay);
+  QObject::connect(tree_snapshot_timer_, &QTimer::timeout, this, &CollectionModel::SaveTreeSnapshotAsync);
 
   QObject::connect(&*backend_, &CollectionBackend::SongsDiscovered, this, &CollectionModel::SongsDiscovered);
   QObject::connect(&*backend_, &CollectionBackend::SongsDeleted, this, &CollectionModel::SongsDeleted);
@@ -187,11 +266,28 @@ void CollectionModel::ReloadSettings() {
   QPixmapCache::setCacheLimit(static_cast<int>(MaximumCacheSize(&s, CollectionSettingsPage::kSettingsCacheSize, CollectionSettingsPage::kSettingsCacheSizeUnit, CollectionSettingsPage::kSettingsCacheSizeDefault) / 1024));
 
   if (sIconCache) {
-    sIconCache->setMaximumCacheSize(MaximumCacheSize(&s, CollectionSettingsPage::kSettingsDiskCacheSize, CollectionSettingsPage::kSettingsDiskCacheSizeUnit, CollectionSettingsPage::kSettingsDiskCacheSizeDefault));
+    if (use_disk_cache_) {
+      sIconCache->Open(MaximumCacheSize(&s, CollectionSettingsPage::kSettingsDiskCacheSize, CollectionSettingsPage::kSettingsDiskCacheSizeUnit, CollectionSettingsPage::kSettingsDiskCacheSizeDefault));
+    }
+    else {
+      sIconCache->Close();
+    }
   }
 
+  const bool use_filter_index = backend_->source() == Song::Source::Collection && s.value("filter_index", false).toBool();
+
   s.endGroup();
 
+  filter_options_.set_substring_search(backend_->db() && backend_->db()->HasFtsTrigramTable(backend_->fts_table()));
+
+  if (use_filter_index && !filter_index_) {
+    filter_index_ = make_shared<CollectionFilterIndex>();
+    (void)QtConcurrent::run(&CollectionModel::LoadFilterIndex, backend_, filter_index_);
+  }
+  else if (!use_filter_index && filter_index_) {
+    filter_index_.reset();
+  }
+
   cover_types_ = AlbumCoverLoaderOptions::LoadTypes();
 
   if (!use_disk_cache_) {
@@ -227,8 +323,29 @@ void CollectionModel::Init(const bool async) {
 
 void CollectionModel::SongsDiscovered(const SongList &songs) {
 
+  if (filter_index_) filter_index_->AddOrUpdateSongs(songs);
+
+  ClearPrefetch();
+  if (!tree_snapshot_filename_.isEmpty()) tree_snapshot_timer_->start();
+
   if (!root_) return;
 
+  // New items are created outside of the model first, so they can be inserted as one range for each parent that is already in the tree.
+  QHash<CollectionItem*, CollectionItem*> staging_items;
+  QList<CollectionItem*> staging_parents;
+  auto staging_item = [&staging_items, &staging_parents](CollectionItem *parent) {
+    CollectionItem *staging = staging_items.value(parent);
+    if (!staging) {
+      staging = new CollectionItem(CollectionItem::Type_Container);
+      staging->key = parent->key;
+      staging->model = parent->model;
+      staging_items.insert(parent, staging);
+      staging_parents << parent;
+    }
+    return staging;
+  };
+  QSet<CollectionItem*> new_containers;
+
   for (const Song &song : songs) {
 
     // Sanity check to make sure we don't add songs that are outside the user's filter
@@ -243,6 +360,7 @@ void CollectionModel::SongsDiscovered(const SongList &songs) {
 
     // Find parent containers in the tree
     CollectionItem *container = root_;
+    bool container_is_new = false;
     QString key;
     for (int i = 0; i < 3; ++i) {
       GroupBy group_by = group_by_[i];
@@ -253,7 +371,7 @@ void CollectionModel::SongsDiscovered(const SongList &songs) {
       // Special case: if the song is a compilation and the current GroupBy level is Artists, then we want the Various Artists node :(
       if (IsArtistGroupBy(group_by) && song.is_compilation()) {
         if (container->compilation_artist_node_ == nullptr) {
-          CreateCompilationArtistNode(true, container);
+          CreateCompilationArtistNode(!container_is_new, container);
         }
         container = container->compilation_artist_node_;
         key = container->key;
@@ -263,13 +381,17 @@ void CollectionModel::SongsDiscovered(const SongList &songs) {
         key.append(ContainerKey(group_by, separate_albums_by_grouping_, song));
 
         // Does it exist already?
-        if (container_nodes_[i].contains(key)) {
-          container = container_nodes_[i][key];
+        CollectionItem *existing_container = container_nodes_[i].value(key);
+        if (existing_container) {
+          container = existing_container;
+          container_is_new = new_containers.contains(container);
         }
         else {
-          // Create the container
-          container = ItemFromSong(group_by, separate_albums_by_grouping_, true, i == 0, container, song, i);
+          // Create the container, new containers get their children directly since they are inserted together with them.
+          container = ItemFromSong(group_by, separate_albums_by_grouping_, false, false, container_is_new ? container : staging_item(container), song, i);
           container_nodes_[i].insert(key, container);
+          new_containers << container;
+          container_is_new = true;
         }
 
       }
@@ -280,18 +402,40 @@ void CollectionModel::SongsDiscovered(const SongList &songs) {
     if (!container->lazy_loaded && use_lazy_loading_) continue;
 
     // We've gone all the way down to the deepest level and everything was already lazy loaded, so now we have to create the song in the container.
-    song_nodes_.insert(song.id(), ItemFromSong(GroupBy::None, separate_albums_by_grouping_, true, false, container, song, -1));
+    song_nodes_.insert(song.id(), ItemFromSong(GroupBy::None, separate_albums_by_grouping_, false, false, container_is_new ? container : staging_item(container), song, -1));
   }
 
+  QStringList divider_keys;
+  if (staging_items.contains(root_) && group_by_[0] != GroupBy::None && show_dividers_) {
+    divider_keys = NewDividerKeys(group_by_[0], staging_items[root_]->children);
+  }
+
+  for (CollectionItem *parent : std::as_const(staging_parents)) {
+    CollectionItem *staging = staging_items[parent];
+    const QList<CollectionItem*> items = staging->children;
+    staging->children.clear();
+    delete staging;
+    InsertChildItems(parent, items);
+  }
+
+  InsertDividerItems(group_by_[0], divider_keys);
+
 }
 
 void CollectionModel::SongsSlightlyChanged(const SongList &songs) {
 
   // This is called if there was a minor change to the songs that will not normally require the collection to be restructured.
   // We can just update our internal cache of Song objects without worrying about resetting the model.
+  if (filter_index_) filter_index_->AddOrUpdateSongs(songs);
+
+  ClearPrefetch();
+
   for (const Song &song : songs) {
     if (song_nodes_.contains(song.id())) {
-      song_nodes_[song.id()]->metadata = song;
+      CollectionItem *item = song_nodes_[song.id()];
+      item->metadata = SongItemMetadata(song);
+      item->partial_metadata = true;
+      InternSongItemMetadata(&item->metadata);
     }
   }
 
@@ -526,100 +670,83 @@ QString CollectionModel::DividerDisplayText(const GroupBy group_by, const QStrin
 
 void CollectionModel::SongsDeleted(const SongList &songs) {
 
-  if (!root_) return;
+  if (filter_index_) filter_index_->RemoveSongs(songs);
 
-  // Delete the actual song nodes first, keeping track of each parent so we might check to see if they're empty later.
-  QSet<CollectionItem*> parents;
-  for (const Song &song : songs) {
+  ClearPrefetch();
+  if (!tree_snapshot_filename_.isEmpty()) tree_snapshot_timer_->start();
 
-    if (song_nodes_.contains(song.id())) {
-      CollectionItem *node = song_nodes_[song.id()];
+  if (!root_) return;
 
-      if (node->parent != root_) parents << node->parent;
+  // If some of the songs we want to delete haven't been lazy-loaded yet, cleaning up empty parents would mean lazy-loading them all individually to see if they're empty.
+  // This can take a very long time, so better to just reset the model and be done with it.
+  if (std::any_of(songs.begin(), songs.end(), [this](const Song &song) { return !song_nodes_.contains(song.id()); })) {
+    Reset();
+    return;
+  }
 
-      beginRemoveRows(ItemToIndex(node->parent), node->row, node->row);
-      node->parent->Delete(node->row);
-      song_nodes_.remove(song.id());
-      endRemoveRows();
+  // Delete the actual song nodes first, one range at a time for each parent, keeping track of each parent so we might check to see if they're empty later.
+  QHash<CollectionItem*, QList<int>> rows_by_parent;
+  QSet<int> song_ids;
+  for (const Song &song : songs) {
+    if (song_ids.contains(song.id())) continue;
+    song_ids << song.id();
+    CollectionItem *node = song_nodes_[song.id()];
+    rows_by_parent[node->parent] << node->row;
+  }
 
-    }
-    else {
-      // If we get here it means some of the songs we want to delete haven't been lazy-loaded yet.
-      // This is bad, because it would mean that to clean up empty parents we would need to lazy-load them all individually to see if they're empty.
-      // This can take a very long time, so better to just reset the model and be done with it.
-      Reset();
-      return;
-    }
+  QSet<CollectionItem*> parents;
+  for (QHash<CollectionItem*, QList<int>>::const_iterator it = rows_by_parent.constBegin(); it != rows_by_parent.constEnd(); ++it) {
+    RemoveChildItems(it.key(), it.value());
+    if (it.key() != root_) parents << it.key();
   }
 
-  // Now delete empty parents
+  // Now delete empty parents, one level at a time.
   QSet<QString> divider_keys;
   while (!parents.isEmpty()) {
-    // Since we are going to remove elements from the container, we need a copy to iterate over.
-    // If we iterate over the original, the behavior will be undefined.
-    QSet<CollectionItem*> parents_copy = parents;
-    for (CollectionItem *node : parents_copy) {
-      parents.remove(node);
+    QHash<CollectionItem*, QList<int>> empty_rows_by_parent;
+    QSet<CollectionItem*> next_parents;
+    for (CollectionItem *node : std::as_const(parents)) {
       if (node->children.count() != 0) continue;
 
       // Consider its parent for the next round
-      if (node->parent != root_) parents << node->parent;
+      if (node->parent != root_) next_parents << node->parent;
 
       // Maybe consider its divider node
       if (node->container_level == 0) {
         divider_keys << DividerKey(group_by_[0], node);
       }
 
-      // Special case the Various Artists node
-      if (IsCompilationArtistNode(node)) {
-        node->parent->compilation_artist_node_ = nullptr;
-      }
-      else if (container_nodes_[node->container_level].contains(node->key)) {
-        container_nodes_[node->container_level].remove(node->key);
-      }
-
       // Remove from pixmap cache
       const QString cache_key = AlbumIconPixmapCacheKey(ItemToIndex(node));
       QPixmapCache::remove(cache_key);
-      if (use_disk_cache_ && sIconCache) sIconCache->remove(AlbumIconPixmapDiskCacheKey(cache_key));
-      if (pending_cache_keys_.contains(cache_key)) {
-        pending_cache_keys_.remove(cache_key);
-      }
+      if (use_disk_cache_ && sIconCache) sIconCache->Remove(cache_key);
+      pending_cache_keys_.remove(cache_key);
 
-      // Remove from pending art loading
-      for (QMap<quint64, ItemAndCacheKey>::iterator it = pending_art_.begin(); it != pending_art_.end();) {
-        if (it.value().first == node) {
-          it = pending_art_.erase(it);  // clazy:exclude=strict-iterators
-        }
-        else {
-          ++it;
-        }
-      }
+      empty_rows_by_parent[node->parent] << node->row;
+    }
 
-      // It was empty - delete it
-      beginRemoveRows(ItemToIndex(node->parent), node->row, node->row);
-      node->parent->Delete(node->row);
-      endRemoveRows();
+    // It was empty - delete it
+    for (QHash<CollectionItem*, QList<int>>::const_iterator it = empty_rows_by_parent.constBegin(); it != empty_rows_by_parent.constEnd(); ++it) {
+      RemoveChildItems(it.key(), it.value());
     }
+
+    parents = next_parents;
   }
 
-  // Delete empty dividers
-  for (const QString &divider_key : std::as_const(divider_keys)) {
-    if (!divider_nodes_.contains(divider_key)) continue;
+  if (divider_keys.isEmpty()) return;
 
-    // Look to see if there are any other items still under this divider
-    QList<CollectionItem*> container_nodes = container_nodes_[0].values();
-    if (std::any_of(container_nodes.begin(), container_nodes.end(), [this, divider_key](CollectionItem *node){ return DividerKey(group_by_[0], node) == divider_key; })) {
-      continue;
+  // Delete dividers that don't have any items under them anymore
+  QSet<QString> used_divider_keys;
+  for (CollectionItem *node : std::as_const(container_nodes_[0])) {
+    used_divider_keys << DividerKey(group_by_[0], node);
+  }
+  QList<int> divider_rows;
+  for (const QString &divider_key : std::as_const(divider_keys)) {
+    if (divider_nodes_.contains(divider_key) && !used_divider_keys.contains(divider_key)) {
+      divider_rows << divider_nodes_[divider_key]->row;
     }
-
-    // Remove the divider
-    int row = divider_nodes_[divider_key]->row;
-    beginRemoveRows(ItemToIndex(root_), row, row);
-    root_->Delete(row);
-    endRemoveRows();
-    divider_nodes_.remove(divider_key);
   }
+  RemoveChildItems(root_, divider_rows);
 
 }
 
@@ -636,12 +763,6 @@ QString CollectionModel::AlbumIconPixmapCacheKey(const QModelIndex &idx) const {
 
 }
 
-QUrl CollectionModel::AlbumIconPixmapDiskCacheKey(const QString &cache_key) const {
-
-  return QUrl(QString::fromLatin1(QUrl::toPercentEncoding(cache_key)));
-
-}
-
 QVariant CollectionModel::AlbumIcon(const QModelIndex &idx) {
 
   CollectionItem *item = IndexToItem(idx);
@@ -655,25 +776,27 @@ QVariant CollectionModel::AlbumIcon(const QModelIndex &idx) {
     return cached_pixmap;
   }
 
-  // Try to load it from the disk cache
-  if (use_disk_cache_ && sIconCache) {
-    ScopedPtr<QIODevice> disk_cache_img(sIconCache->data(AlbumIconPixmapDiskCacheKey(cache_key)));
-    if (disk_cache_img) {
-      QImage cached_image;
-      if (cached_image.load(&*disk_cache_img, "XPM")) {
-        QPixmapCache::insert(cache_key, QPixmap::fromImage(cached_image));
-        return QPixmap::fromImage(cached_image);
-      }
-    }
-  }
-
   // Maybe we're loading a pixmap already?
   if (pending_cache_keys_.contains(cache_key)) {
     return no_cover_icon_;
   }
 
+  // Try to load it from the disk cache, the tiles are already scaled so this is only a copy of the pixels.
+  if (use_disk_cache_ && sIconCache) {
+    const QImage cached_image = sIconCache->Find(cache_key);
+    if (!cached_image.isNull()) {
+      const QPixmap pixmap = QPixmap::fromImage(cached_image);
+      QPixmapCache::insert(cache_key, pixmap);
+      return pixmap;
+    }
+  }
+
   // No art is cached and we're not loading it already.  Load art for the first song in the album.
-  SongList songs = GetChildSongs(idx);
+  // The song items have all the art columns, so there's no need to load the full songs here.
+  QList<QUrl> urls;
+  SongList songs;
+  QSet<int> song_ids;
+  GetChildSongs(item, &urls, &songs, &song_ids);
   if (!songs.isEmpty()) {
     AlbumCoverLoaderOptions cover_loader_options(AlbumCoverLoaderOptions::Option::ScaledImage | AlbumCoverLoaderOptions::Option::PadScaledImage);
     cover_loader_options.desired_scaled_size = QSize(kPrettyCoverSize, kPrettyCoverSize);
@@ -681,12 +804,29 @@ QVariant CollectionModel::AlbumIcon(const QModelIndex &idx) {
     const quint64 id = app_->album_cover_loader()->LoadImageAsync(cover_loader_options, songs.first());
     pending_art_[id] = ItemAndCacheKey(item, cache_key);
     pending_cache_keys_.insert(cache_key);
+    if (pending_art_.count() > kMaxPendingArt) CancelOldestArt();
   }
 
   return no_cover_icon_;
 
 }
 
+void CollectionModel::CancelOldestArt() {
+
+  // The oldest requests are most likely for items that were scrolled out of view, so cancel them to get the visible ones loaded first.
+  // They are requested again if the items are shown again.
+  QSet<quint64> ids;
+  while (pending_art_.count() > kMaxPendingArt) {
+    QMap<quint64, ItemAndCacheKey>::iterator it = pending_art_.begin();
+    ids << it.key();
+    pending_cache_keys_.remove(it.value().second);
+    pending_art_.erase(it);
+  }
+
+  app_->album_cover_loader()->CancelTasks(ids);
+
+}
+
 void CollectionModel::AlbumCoverLoaded(const quint64 id, const AlbumCoverLoaderResult &result) {
 
   if (!pending_art_.contains(id)) return;
@@ -699,33 +839,18 @@ void CollectionModel::AlbumCoverLoaded(const quint64 id, const AlbumCoverLoaderR
 
   pending_cache_keys_.remove(cache_key);
 
-  // Insert this image in the cache.
+  // Insert this image in the cache, the cover loader already scaled it.
   if (!result.success || result.image_scaled.isNull() || result.type == AlbumCoverLoaderResult::Type::Unset) {
     // Set the no_cover image so we don't continually try to load art.
     QPixmapCache::insert(cache_key, no_cover_icon_);
   }
   else {
-    QPixmap image_pixmap;
-    image_pixmap = QPixmap::fromImage(result.image_scaled);
-    QPixmapCache::insert(cache_key, image_pixmap);
+    QPixmapCache::insert(cache_key, QPixmap::fromImage(result.image_scaled));
   }
 
   // If we have a valid cover not already in the disk cache
-  if (use_disk_cache_ && sIconCache && result.success && !result.image_scaled.isNull()) {
-    const QUrl disk_cache_key = AlbumIconPixmapDiskCacheKey(cache_key);
-    ScopedPtr<QIODevice> disk_cache_img(sIconCache->data(disk_cache_key));
-    if (!disk_cache_img) {
-      QNetworkCacheMetaData disk_cache_metadata;
-      disk_cache_metadata.setSaveToDisk(true);
-      disk_cache_metadata.setUrl(disk_cache_key);
-      // Qt 6 now ignores any entry without headers, so add a fake header.
-      disk_cache_metadata.setRawHeaders(QNetworkCacheMetaData::RawHeaderList() << qMakePair(QByteArray(), QByteArray()));
-      QIODevice *device_iconcache = sIconCache->prepare(disk_cache_metadata);
-      if (device_iconcache) {
-        result.image_scaled.save(device_iconcache, "XPM");
-        sIconCache->insert(device_iconcache);
-      }
-    }
+  if (use_disk_cache_ && sIconCache && result.success && !result.image_scaled.isNull() && !sIconCache->Contains(cache_key)) {
+    sIconCache->Insert(cache_key, result.image_scaled);
   }
 
   const QModelIndex idx = ItemToIndex(item);
@@ -801,6 +926,9 @@ QVariant CollectionModel::data(const CollectionItem *item, const int role) const
       return static_cast<int>(container_group_by);
 
     case Role_Key:
+      if (item->type == CollectionItem::Type_Song) {
+        return (item->parent->key.isEmpty() ? QString() : item->parent->key + QLatin1Char('-')) + TextOrUnknown(item->metadata.title());
+      }
       return item->key;
 
     case Role_Artist:
@@ -833,6 +961,10 @@ QVariant CollectionModel::data(const CollectionItem *item, const int role) const
 
     case Role_SortText:
       return item->SortText();
+
+    case Role_SortKey:
+      return Utilities::CollationKey(item->SortText());
+
     default:
       return QVariant();
   }
@@ -885,24 +1017,44 @@ CollectionQueryOptions CollectionModel::PrepareQuery(CollectionItem *parent) {
 
 }
 
-CollectionModel::QueryResult CollectionModel::RunQuery(const CollectionFilterOptions &filter_options, const CollectionQueryOptions &query_options) {
-
-  QMutexLocker l(backend_->db()->Mutex());
+CollectionModel::QueryResult CollectionModel::RunQuery(const CollectionFilterOptions &_filter_options, const CollectionQueryOptions &query_options) {
 
   QueryResult result;
+
+  // Use the in-memory index to match the filter text when it's loaded, and don't touch the database at all if nothing matched.
+  CollectionFilterOptions filter_options = _filter_options;
+  SharedPtr<CollectionFilterIndex> filter_index = filter_index_;
+  if (filter_index && filter_index->loaded() && !filter_options.filter_text().isEmpty() && filter_options.filter_mode() == CollectionFilterOptions::FilterMode::All) {
+    const std::optional<QList<int>> filter_ids = filter_index->Match(filter_options.filter_text());
+    if (filter_ids) {
+      if (filter_ids->isEmpty()) return result;
+      filter_options.set_filter_ids(*filter_ids);
+    }
+  }
+
+  QMutexLocker l(backend_->db()->ReadMutex());
+
   {
 
-    QSqlDatabase db(backend_->db()->Connect());
+    QSqlDatabase db(backend_->db()->ReadConnection());
     // Add the special Various artists node
     if (query_options.query_have_compilations() && HasCompilations(db, filter_options, query_options)) {
       result.create_va = true;
     }
 
     CollectionQuery q(db, backend_->songs_table(), backend_->fts_table(), filter_options);
-    q.SetColumnSpec(query_options.column_spec());
+    if (query_options.columns().isEmpty()) {
+      q.SetColumnSpec(query_options.column_spec());
+    }
+    else {
+      q.SetColumnSpec(QStringLiteral("%songs_table.ROWID, ") + query_options.columns().join(QStringLiteral(", ")));
+    }
     for (const CollectionQueryOptions::Where &where_clauses : query_options.where_clauses()) {
       q.AddWhere(where_clauses.column, where_clauses.value, where_clauses.op);
     }
+    if (!query_options.order_by().isEmpty()) {
+      q.SetOrderBy(query_options.order_by());
+    }
 
     if (result.create_va) {
       q.AddCompilationRequirement(false);
@@ -942,10 +1094,16 @@ void CollectionModel::PostQuery(CollectionItem *parent, const CollectionModel::Q
     CreateCompilationArtistNode(signal, parent);
   }
 
+  // Song rows may have only some of the columns, so find out which once for all of them.
+  std::optional<Song::QueryColumns> song_columns;
+  if (child_group_by == GroupBy::None && !result.rows.isEmpty()) {
+    song_columns.emplace(result.rows.first().record());
+  }
+
   // Step through the results
   for (const SqlRow &row : result.rows) {
     // Create the item - it will get inserted into the model here
-    CollectionItem *item = ItemFromQuery(child_group_by, separate_albums_by_grouping_, signal, child_level == 0, parent, row, child_level);
+    CollectionItem *item = ItemFromQuery(child_group_by, separate_albums_by_grouping_, signal, child_level == 0, parent, row, song_columns ? &*song_columns : nullptr, child_level);
 
     // Save a pointer to it for later
     if (child_group_by == GroupBy::None) {
@@ -965,16 +1123,210 @@ void CollectionModel::LazyPopulate(CollectionItem *parent, const bool signal) {
   if (parent->lazy_loaded) return;
   parent->lazy_loaded = true;
 
+  // Use the children prefetched in the background if we have them.
+  const QString prefetch_key = PrefetchKey(parent);
+  if (!prefetch_key.isEmpty()) {
+    ScopedPtr<QueryResult> prefetched_result(prefetch_cache_.take(prefetch_key));
+    if (prefetched_result) {
+      PostQuery(parent, *prefetched_result, signal);
+      return;
+    }
+  }
+
   CollectionQueryOptions query_options = PrepareQuery(parent);
   QueryResult result = RunQuery(filter_options_, query_options);
   PostQuery(parent, result, signal);
 
 }
 
+void CollectionModel::Prefetch(const QModelIndex &idx) {
+
+  if (!root_ || !idx.isValid() || !use_lazy_loading_) return;
+
+  CollectionItem *item = IndexToItem(idx);
+  if (!item || item->lazy_loaded) return;
+
+  const QString prefetch_key = PrefetchKey(item);
+  if (prefetch_key.isEmpty() || prefetch_cache_.contains(prefetch_key) || prefetch_running_.contains(prefetch_key)) return;
+
+  prefetch_queue_.removeAll(prefetch_key);
+  prefetch_queue_ << prefetch_key;
+  // Only the most recent requests are still interesting when scrolling or moving the mouse quickly.
+  while (prefetch_queue_.count() > kMaxPrefetchQueue) {
+    prefetch_queue_.removeFirst();
+  }
+
+  StartPrefetches();
+
+}
+
+QString CollectionModel::PrefetchKey(const CollectionItem *item) const {
+
+  if (item->type != CollectionItem::Type_Container || item->container_level < 0 || item->container_level >= 3) return QString();
+
+  // Various artists nodes aren't in the container index, so they can't be found again after the query.
+  if (container_nodes_[item->container_level].value(item->key) != item) return QString();
+
+  return QString::number(item->container_level) + QLatin1Char('/') + item->key;
+
+}
+
+CollectionItem *CollectionModel::PrefetchItem(const QString &prefetch_key) const {
+
+  const qint64 separator = prefetch_key.indexOf(QLatin1Char('/'));
+  if (separator <= 0) return nullptr;
+
+  bool ok = false;
+  const int container_level = prefetch_key.left(separator).toInt(&ok);
+  if (!ok || container_level < 0 || container_level >= 3) return nullptr;
+
+  return container_nodes_[container_level].value(prefetch_key.mid(separator + 1));
+
+}
+
+void CollectionModel::StartPrefetches() {
+
+  while (prefetch_running_.count() < kMaxPrefetchJobs && !prefetch_queue_.isEmpty()) {
+    // The newest requests first, they are the most likely to be expanded.
+    const QString prefetch_key = prefetch_queue_.takeLast();
+    CollectionItem *item = PrefetchItem(prefetch_key);
+    if (!item || item->lazy_loaded) continue;
+
+    prefetch_running_ << prefetch_key;
+    const quint64 generation = prefetch_generation_;
+    const CollectionQueryOptions query_options = PrepareQuery(item);
+
+#if QT_VERSION >= QT_VERSION_CHECK(6, 0, 0)
+    QFuture<CollectionModel::QueryResult> future = QtConcurrent::run(&CollectionModel::RunQuery, this, filter_options_, query_options);
+#else
+    QFuture<CollectionModel::QueryResult> future = QtConcurrent::run(this, &CollectionModel::RunQuery, filter_options_, query_options);
+#endif
+    QFutureWatcher<CollectionModel::QueryResult> *watcher = new QFutureWatcher<CollectionModel::QueryResult>();
+    QObject::connect(watcher, &QFutureWatcher<CollectionModel::QueryResult>::finished, this, [this, watcher, generation, prefetch_key]() {
+      QueryResult *result = new QueryResult(watcher->result());
+      watcher->deleteLater();
+      prefetch_running_.remove(prefetch_key);
+      // Drop the result if the tree or the songs changed since the query was started.
+      if (generation == prefetch_generation_) {
+        prefetch_cache_.insert(prefetch_key, result, std::max(1, static_cast<int>(result->rows.count())));
+      }
+      else {
+        delete result;
+      }
+      StartPrefetches();
+    });
+    watcher->setFuture(future);
+  }
+
+}
+
+void CollectionModel::ClearPrefetch() {
+
+  ++prefetch_generation_;
+  prefetch_cache_.clear();
+  prefetch_queue_.clear();
+
+}
+
+bool CollectionModel::CanUseTreeSnapshot() const {
+
+  return !tree_snapshot_filename_.isEmpty() &&
+         filter_options_.filter_mode() == CollectionFilterOptions::FilterMode::All &&
+         filter_options_.max_age() == -1 &&
+         filter_options_.filter_text().isEmpty();
+
+}
+
+QString CollectionModel::TreeSnapshotSignature() {
+
+  // Anything that changes which rows the top level query returns, including its columns.
+  return QStringLiteral("%1;%2;%3;%4;%5;%6;%7").arg(backend_->songs_table())
+                                              .arg(static_cast<int>(group_by_[0]))
+                                              .arg(static_cast<int>(group_by_[1]))
+                                              .arg(static_cast<int>(group_by_[2]))
+                                              .arg(separate_albums_by_grouping_)
+                                              .arg(show_various_artists_)
+                                              .arg(PrepareQuery(root_).column_spec());
+
+}
+
+bool CollectionModel::LoadTreeSnapshot() {
+
+  if (!root_ || !CanUseTreeSnapshot()) return false;
+
+  QueryResult result;
+  if (!CollectionTreeSnapshot::Read(tree_snapshot_filename_, TreeSnapshotSignature(), &result.create_va, &result.rows)) return false;
+
+  qLog(Debug) << "Loaded" << result.rows.count() << "top level collection items from" << tree_snapshot_filename_;
+
+  BeginReset();
+  root_->lazy_loaded = true;
+
+  PostQuery(root_, result, false);
+
+  tree_populated_ = true;
+  tree_group_by_ = group_by_;
+  tree_separate_albums_by_grouping_ = separate_albums_by_grouping_;
+
+  // The tree is usable now, even though it's still being checked against the database.
+  if (init_task_id_ != -1) {
+    if (app_) {
+      app_->task_manager()->SetTaskFinished(init_task_id_);
+    }
+    init_task_id_ = -1;
+  }
+
+  endResetModel();
+
+  return true;
+
+}
+
+void CollectionModel::SaveTreeSnapshot(const QueryResult &result) {
+
+  if (!root_ || !CanUseTreeSnapshot()) return;
+
+  tree_snapshot_timer_->stop();
+
+  const QString filename = tree_snapshot_filename_;
+  const QString signature = TreeSnapshotSignature();
+  (void)QtConcurrent::run([filename, signature, result]() { CollectionTreeSnapshot::Write(filename, signature, result.create_va, result.rows); });
+
+}
+
+void CollectionModel::SaveTreeSnapshotAsync() {
+
+  if (!root_ || !CanUseTreeSnapshot()) return;
+
+  const QString filename = tree_snapshot_filename_;
+  const QString signature = TreeSnapshotSignature();
+  const CollectionFilterOptions filter_options = filter_options_;
+  const CollectionQueryOptions query_options = PrepareQuery(root_);
+  (void)QtConcurrent::run([this, filename, signature, filter_options, query_options]() {
+    const QueryResult result = RunQuery(filter_options, query_options);
+    CollectionTreeSnapshot::Write(filename, signature, result.create_va, result.rows);
+  });
+
+}
+
 void CollectionModel::ResetAsync() {
 
   if (!root_) return;
 
+  ClearPrefetch();
+
+  // Show the tree from the snapshot right away, and patch it with what's actually in the database.
+  int comparable_levels = ComparableLevels();
+  if (comparable_levels == 0 && LoadTreeSnapshot()) {
+    comparable_levels = ComparableLevels();
+  }
+  if (comparable_levels > 0) {
+    PatchAsync(comparable_levels);
+    return;
+  }
+
+  const quint64 generation = ++tree_generation_;
+
   CollectionQueryOptions query_options = PrepareQuery(root_);
 
 #if QT_VERSION >= QT_VERSION_CHECK(6, 0, 0)
@@ -983,24 +1335,35 @@ void CollectionModel::ResetAsync() {
   QFuture<CollectionModel::QueryResult> future = QtConcurrent::run(this, &CollectionModel::RunQuery, filter_options_, query_options);
 #endif
   QFutureWatcher<CollectionModel::QueryResult> *watcher = new QFutureWatcher<CollectionModel::QueryResult>();
-  QObject::connect(watcher, &QFutureWatcher<CollectionModel::QueryResult>::finished, this, &CollectionModel::ResetAsyncQueryFinished);
+  QObject::connect(watcher, &QFutureWatcher<CollectionModel::QueryResult>::finished, this, [this, watcher, generation]() {
+    const QueryResult result = watcher->result();
+    watcher->deleteLater();
+    ResetAsyncQueryFinished(generation, result);
+  });
   watcher->setFuture(future);
 
 }
 
-void CollectionModel::ResetAsyncQueryFinished() {
+void CollectionModel::ResetAsyncQueryFinished(const quint64 generation, const QueryResult &result) {
+
+  TRACE_SCOPE("collection", "CollectionModel::ResetAsyncQueryFinished");
 
   if (!root_) return;
 
-  QFutureWatcher<CollectionModel::QueryResult> *watcher = static_cast<QFutureWatcher<CollectionModel::QueryResult>*>(sender());
-  const struct QueryResult result = watcher->result();
-  watcher->deleteLater();
+  // A newer query was started or the tree was reset in the meantime.
+  if (generation != tree_generation_) return;
 
   BeginReset();
   root_->lazy_loaded = true;
 
   PostQuery(root_, result, false);
 
+  tree_populated_ = true;
+  tree_group_by_ = group_by_;
+  tree_separate_albums_by_grouping_ = separate_albums_by_grouping_;
+
+  SaveTreeSnapshot(result);
+
   if (init_task_id_ != -1) {
     if (app_) {
       app_->task_manager()->SetTaskFinished(init_task_id_);
@@ -1012,6 +1375,313 @@ void CollectionModel::ResetAsyncQueryFinished() {
 
 }
 
+int CollectionModel::ComparableLevels() const {
+
+  if (!tree_populated_ || tree_separate_albums_by_grouping_ != separate_albums_by_grouping_) return 0;
+
+  // The keys of the containers include the keys of their parents, so they can only be matched up to the first level where the grouping changed.
+  int levels = 0;
+  while (levels < 3 && tree_group_by_[levels] == group_by_[levels]) ++levels;
+
+  return levels;
+
+}
+
+void CollectionModel::PatchAsync(const int comparable_levels) {
+
+  const quint64 generation = ++tree_generation_;
+
+  // Query the children of the root and of all the loaded containers that still exist with the new grouping.
+  QList<PatchQuery> patch_queries;
+  QList<CollectionItem*> parents = QList<CollectionItem*>() << root_;
+  while (!parents.isEmpty()) {
+    CollectionItem *parent = parents.takeFirst();
+    const int child_level = parent == root_ ? 0 : parent->container_level + 1;
+
+    PatchQuery patch_query;
+    if (parent != root_ && IsCompilationArtistNode(parent)) {
+      patch_query.parent_level = parent->parent == root_ ? -1 : parent->parent->container_level;
+      patch_query.parent_key = parent->parent == root_ ? QString() : parent->parent->key;
+      patch_query.compilation_artist_node = true;
+    }
+    else if (parent != root_) {
+      patch_query.parent_level = parent->container_level;
+      patch_query.parent_key = parent->key;
+    }
+    patch_query.replace = child_level >= comparable_levels && !(child_level == 3 && comparable_levels == 3);
+    patch_query.query_options = PrepareQuery(parent);
+    patch_queries << patch_query;
+
+    if (patch_query.replace) continue;
+
+    for (CollectionItem *child : std::as_const(parent->children)) {
+      if (child->type == CollectionItem::Type_Container && child->lazy_loaded) {
+        parents << child;
+      }
+    }
+  }
+
+  const CollectionFilterOptions filter_options = filter_options_;
+  QFuture<QList<QueryResult>> future = QtConcurrent::run([this, filter_options, patch_queries]() {
+    QList<QueryResult> results;
+    results.reserve(patch_queries.count());
+    for (const PatchQuery &patch_query : patch_queries) {
+      results << RunQuery(filter_options, patch_query.query_options);
+    }
+    return results;
+  });
+  QFutureWatcher<QList<QueryResult>> *watcher = new QFutureWatcher<QList<QueryResult>>();
+  QObject::connect(watcher, &QFutureWatcher<QList<QueryResult>>::finished, this, [this, watcher, generation, patch_queries]() {
+    const QList<QueryResult> results = watcher->result();
+    watcher->deleteLater();
+    PatchAsyncQueryFinished(generation, patch_queries, results);
+  });
+  watcher->setFuture(future);
+
+}
+
+void CollectionModel::PatchAsyncQueryFinished(const quint64 generation, const QList<PatchQuery> &patch_queries, const QList<QueryResult> &results) {
+
+  if (!root_) return;
+
+  // A newer query was started or the tree was reset in the meantime.
+  if (generation != tree_generation_) return;
+
+  // The queries are ordered from the root down, so parents are patched before their children.
+  for (qint64 i = 0; i < patch_queries.count() && i < results.count(); ++i) {
+    CollectionItem *parent = PatchQueryParent(patch_queries[i]);
+    // Removed by the patch of one of its parents, or replaced by a node that isn't loaded yet.
+    if (!parent || !parent->lazy_loaded) continue;
+    PatchChildren(parent, results[i], patch_queries[i].replace);
+  }
+
+  tree_group_by_ = group_by_;
+  tree_separate_albums_by_grouping_ = separate_albums_by_grouping_;
+
+  // The first query is always the one for the root.
+  if (!results.isEmpty()) {
+    SaveTreeSnapshot(results.first());
+  }
+
+}
+
+CollectionItem *CollectionModel::PatchQueryParent(const PatchQuery &patch_query) const {
+
+  CollectionItem *parent = patch_query.parent_level == -1 ? root_ : container_nodes_[patch_query.parent_level].value(patch_query.parent_key);
+  if (parent && patch_query.compilation_artist_node) {
+    parent = parent->compilation_artist_node_;
+  }
+
+  return parent;
+
+}
+
+void CollectionModel::PatchChildren(CollectionItem *parent, const QueryResult &result, const bool replace) {
+
+  const int child_level = parent == root_ ? 0 : parent->container_level + 1;
+  const GroupBy child_group_by = child_level >= 3 ? GroupBy::None : group_by_[child_level];
+
+  // Create the new children outside of the model first, so they can be matched against the existing ones and inserted together.
+  CollectionItem staging(CollectionItem::Type_Container);
+  if (parent != root_) staging.key = parent->key;
+  std::optional<Song::QueryColumns> song_columns;
+  if (child_group_by == GroupBy::None && !result.rows.isEmpty()) {
+    song_columns.emplace(result.rows.first().record());
+  }
+  for (const SqlRow &row : result.rows) {
+    ItemFromQuery(child_group_by, separate_albums_by_grouping_, false, false, &staging, row, song_columns ? &*song_columns : nullptr, child_level);
+  }
+  const QList<CollectionItem*> new_items = staging.children;
+  staging.children.clear();
+
+  auto identity = [](const CollectionItem *item) {
+    return item->type == CollectionItem::Type_Song ? QString::number(item->metadata.id()) : item->key;
+  };
+
+  QSet<QString> new_identities;
+  for (const CollectionItem *item : new_items) {
+    new_identities << identity(item);
+  }
+
+  // Remove the children that are gone, keep the rest as they are, including their children and expanded state.
+  QSet<QString> kept_identities;
+  QList<int> remove_rows;
+  for (CollectionItem *child : std::as_const(parent->children)) {
+    if (child->type == CollectionItem::Type_Divider) continue;
+    if (child == parent->compilation_artist_node_) {
+      if (replace || !result.create_va) remove_rows << child->row;
+      continue;
+    }
+    const QString child_identity = identity(child);
+    if (!replace && child->type != CollectionItem::Type_LoadingIndicator && new_identities.contains(child_identity)) {
+      kept_identities << child_identity;
+    }
+    else {
+      remove_rows << child->row;
+    }
+  }
+  RemoveChildItems(parent, remove_rows);
+
+  QList<CollectionItem*> inserted_items;
+  for (CollectionItem *item : new_items) {
+    if (kept_identities.contains(identity(item))) {
+      delete item;
+    }
+    else {
+      inserted_items << item;
+    }
+  }
+
+  QStringList new_divider_keys;
+  if (parent == root_ && show_dividers_) {
+    new_divider_keys = NewDividerKeys(child_group_by, inserted_items);
+  }
+
+  InsertChildItems(parent, inserted_items);
+  for (CollectionItem *item : std::as_const(inserted_items)) {
+    if (item->type == CollectionItem::Type_Song) {
+      song_nodes_.insert(item->metadata.id(), item);
+    }
+    else {
+      container_nodes_[child_level].insert(item->key, item);
+    }
+  }
+
+  if (result.create_va && parent->compilation_artist_node_ == nullptr) {
+    CreateCompilationArtistNode(true, parent);
+  }
+
+  if (parent != root_ || !show_dividers_) return;
+
+  InsertDividerItems(child_group_by, new_divider_keys);
+
+  // Remove the dividers that don't have any items under them anymore.
+  QSet<QString> used_divider_keys;
+  for (CollectionItem *child : std::as_const(root_->children)) {
+    if (child->type == CollectionItem::Type_Container && child != root_->compilation_artist_node_) {
+      used_divider_keys << DividerKey(child_group_by, child);
+    }
+  }
+  QList<int> divider_rows;
+  for (CollectionItem *divider : std::as_const(divider_nodes_)) {
+    if (!used_divider_keys.contains(divider->key)) divider_rows << divider->row;
+  }
+  RemoveChildItems(root_, divider_rows);
+
+}
+
+void CollectionModel::RemoveChildItems(CollectionItem *parent, QList<int> rows) {
+
+  std::sort(rows.begin(), rows.end());
+
+  // Remove each contiguous range from the end, so the rows of the ranges before it stay the same.
+  qint64 i = rows.count() - 1;
+  while (i >= 0) {
+    const int last_row = rows[i];
+    int first_row = last_row;
+    while (i > 0 && rows[i - 1] == first_row - 1) {
+      --i;
+      first_row = rows[i];
+    }
+    --i;
+
+    beginRemoveRows(ItemToIndex(parent), first_row, last_row);
+    for (int row = first_row; row <= last_row; ++row) {
+      UnregisterItem(parent->children[row]);
+    }
+    for (int row = last_row; row >= first_row; --row) {
+      delete parent->children.takeAt(row);
+    }
+    for (int row = first_row; row < parent->children.count(); ++row) {
+      parent->children[row]->row = row;
+    }
+    endRemoveRows();
+  }
+
+}
+
+void CollectionModel::InsertChildItems(CollectionItem *parent, const QList<CollectionItem*> &items) {
+
+  if (items.isEmpty()) return;
+
+  const int first_row = static_cast<int>(parent->children.count());
+  beginInsertRows(ItemToIndex(parent), first_row, first_row + static_cast<int>(items.count()) - 1);
+  for (CollectionItem *item : items) {
+    item->parent = parent;
+    item->model = parent->model;
+    item->row = static_cast<int>(parent->children.count());
+    parent->children << item;
+  }
+  endInsertRows();
+
+}
+
+QStringList CollectionModel::NewDividerKeys(const GroupBy group_by, const QList<CollectionItem*> &items) {
+
+  QStringList divider_keys;
+  for (CollectionItem *item : items) {
+    const QString divider_key = DividerKey(group_by, item);
+    if (divider_key.isEmpty()) continue;
+    item->sort_text.prepend(divider_key + QLatin1Char(' '));
+    if (!divider_nodes_.contains(divider_key) && !divider_keys.contains(divider_key)) {
+      divider_keys << divider_key;
+    }
+  }
+
+  return divider_keys;
+
+}
+
+void CollectionModel::InsertDividerItems(const GroupBy group_by, const QStringList &divider_keys) {
+
+  if (divider_keys.isEmpty()) return;
+
+  const int first_row = static_cast<int>(root_->children.count());
+  beginInsertRows(ItemToIndex(root_), first_row, first_row + static_cast<int>(divider_keys.count()) - 1);
+  for (const QString &divider_key : divider_keys) {
+    CreateDividerItem(group_by, divider_key);
+  }
+  endInsertRows();
+
+}
+
+void CollectionModel::UnregisterItem(CollectionItem *item) {
+
+  for (CollectionItem *child : std::as_const(item->children)) {
+    UnregisterItem(child);
+  }
+
+  switch (item->type) {
+    case CollectionItem::Type_Song:
+      if (song_nodes_.value(item->metadata.id()) == item) song_nodes_.remove(item->metadata.id());
+      break;
+    case CollectionItem::Type_Container:
+      if (IsCompilationArtistNode(item)) {
+        item->parent->compilation_artist_node_ = nullptr;
+      }
+      else if (item->container_level >= 0 && item->container_level < 3 && container_nodes_[item->container_level].value(item->key) == item) {
+        container_nodes_[item->container_level].remove(item->key);
+      }
+      break;
+    case CollectionItem::Type_Divider:
+      if (divider_nodes_.value(item->key) == item) divider_nodes_.remove(item->key);
+      break;
+    default:
+      break;
+  }
+
+  for (QMap<quint64, ItemAndCacheKey>::iterator it = pending_art_.begin(); it != pending_art_.end();) {
+    if (it.value().first == item) {
+      pending_cache_keys_.remove(it.value().second);
+      it = pending_art_.erase(it);  // clazy:exclude=strict-iterators
+    }
+    else {
+      ++it;
+    }
+  }
+
+}
+
 void CollectionModel::Clear() {
 
   if (root_) {
@@ -1025,6 +1695,9 @@ void CollectionModel::Clear() {
   divider_nodes_.clear();
   pending_art_.clear();
   pending_cache_keys_.clear();
+  ClearPrefetch();
+  interned_strings_.clear();
+  sort_text_cache_.clear();
 
 }
 
@@ -1033,6 +1706,9 @@ void CollectionModel::BeginReset() {
   beginResetModel();
   Clear();
 
+  ++tree_generation_;
+  tree_populated_ = false;
+
   root_ = new CollectionItem(this);
   root_->compilation_artist_node_ = nullptr;
   root_->lazy_loaded = false;
@@ -1041,10 +1717,20 @@ void CollectionModel::BeginReset() {
 
 void CollectionModel::Reset() {
 
+  TRACE_SCOPE("collection", "CollectionModel::Reset");
+
   BeginReset();
 
   // Populate top level
-  LazyPopulate(root_, false);
+  const QueryResult result = RunQuery(filter_options_, PrepareQuery(root_));
+  root_->lazy_loaded = true;
+  PostQuery(root_, result, false);
+
+  tree_populated_ = true;
+  tree_group_by_ = group_by_;
+  tree_separate_albums_by_grouping_ = separate_albums_by_grouping_;
+
+  SaveTreeSnapshot(result);
 
   endResetModel();
 
@@ -1135,6 +1821,7 @@ void CollectionModel::SetQueryColumnSpec(const GroupBy group_by, const bool sepa
     case GroupBy::None:
     case GroupBy::GroupByCount:
       query_options->set_column_spec(QStringLiteral("%songs_table.ROWID, ") + Song::kColumnSpec);
+      query_options->set_columns(kSongItemColumns);
       break;
   }
 
@@ -1265,7 +1952,7 @@ CollectionItem *CollectionModel::InitItem(const GroupBy group_by, const bool sig
 
 }
 
-CollectionItem *CollectionModel::ItemFromQuery(const GroupBy group_by, const bool separate_albums_by_grouping, const bool signal, const bool create_divider, CollectionItem *parent, const SqlRow &row, const int container_level) {
+CollectionItem *CollectionModel::ItemFromQuery(const GroupBy group_by, const bool separate_albums_by_grouping, const bool signal, const bool create_divider, CollectionItem *parent, const SqlRow &row, const Song::QueryColumns *song_columns, const int container_level) {
 
   CollectionItem *item = InitItem(group_by, signal, parent, container_level);
 
@@ -1278,14 +1965,14 @@ CollectionItem *CollectionModel::ItemFromQuery(const GroupBy group_by, const boo
       item->metadata.set_albumartist(row.value(0).toString());
       item->key.append(ContainerKey(group_by, separate_albums_by_grouping, item->metadata));
       item->display_text = TextOrUnknown(item->metadata.albumartist());
-      item->sort_text = SortTextForArtist(item->metadata.albumartist(), sort_skips_articles_);
+      item->sort_text = CachedSortTextForArtist(item->metadata.albumartist());
       break;
     }
     case GroupBy::Artist:{
       item->metadata.set_artist(row.value(0).toString());
       item->key.append(ContainerKey(group_by, separate_albums_by_grouping, item->metadata));
       item->display_text = TextOrUnknown(item->metadata.artist());
-      item->sort_text = SortTextForArtist(item->metadata.artist(), sort_skips_articles_);
+      item->sort_text = CachedSortTextForArtist(item->metadata.artist());
       break;
     }
     case GroupBy::Album:{
@@ -1294,7 +1981,7 @@ CollectionItem *CollectionModel::ItemFromQuery(const GroupBy group_by, const boo
       if (separate_albums_by_grouping) item->metadata.set_grouping(row.value(2).toString());
       item->key.append(ContainerKey(group_by, separate_albums_by_grouping, item->metadata));
       item->display_text = TextOrUnknown(item->metadata.album());
-      item->sort_text = SortTextForArtist(item->metadata.album(), sort_skips_articles_);
+      item->sort_text = CachedSortTextForArtist(item->metadata.album());
       break;
     }
     case GroupBy::AlbumDisc:{
@@ -1379,28 +2066,28 @@ CollectionItem *CollectionModel::ItemFromQuery(const GroupBy group_by, const boo
       item->metadata.set_genre(row.value(0).toString());
       item->key.append(ContainerKey(group_by, separate_albums_by_grouping, item->metadata));
       item->display_text = TextOrUnknown(item->metadata.genre());
-      item->sort_text = SortTextForArtist(item->metadata.genre(), sort_skips_articles_);
+      item->sort_text = CachedSortTextForArtist(item->metadata.genre());
       break;
     }
     case GroupBy::Composer:{
       item->metadata.set_composer(row.value(0).toString());
       item->key.append(ContainerKey(group_by, separate_albums_by_grouping, item->metadata));
       item->display_text = TextOrUnknown(item->metadata.composer());
-      item->sort_text = SortTextForArtist(item->metadata.composer(), sort_skips_articles_);
+      item->sort_text = CachedSortTextForArtist(item->metadata.composer());
       break;
     }
     case GroupBy::Performer:{
       item->metadata.set_performer(row.value(0).toString());
       item->key.append(ContainerKey(group_by, separate_albums_by_grouping, item->metadata));
       item->display_text = TextOrUnknown(item->metadata.performer());
-      item->sort_text = SortTextForArtist(item->metadata.performer(), sort_skips_articles_);
+      item->sort_text = CachedSortTextForArtist(item->metadata.performer());
       break;
     }
     case GroupBy::Grouping:{
       item->metadata.set_grouping(row.value(0).toString());
       item->key.append(ContainerKey(group_by, separate_albums_by_grouping, item->metadata));
       item->display_text = TextOrUnknown(item->metadata.grouping());
-      item->sort_text = SortTextForArtist(item->metadata.grouping(), sort_skips_articles_);
+      item->sort_text = CachedSortTextForArtist(item->metadata.grouping());
       break;
     }
     case GroupBy::FileType:{
@@ -1446,8 +2133,16 @@ CollectionItem *CollectionModel::ItemFromQuery(const GroupBy group_by, const boo
     }
     case GroupBy::None:
     case GroupBy::GroupByCount:
-      item->metadata.InitFromQuery(row, true);
-      item->key.append(TextOrUnknown(item->metadata.title()));
+      if (song_columns) {
+        item->metadata.InitFromQuery(row, *song_columns, true);
+        item->partial_metadata = row.columns() < Song::kRowIdColumns.count();
+      }
+      else {
+        item->metadata.InitFromQuery(row, true);
+      }
+      InternSongItemMetadata(&item->metadata);
+      // Song items are found by ID, so their key is only built when asked for.
+      item->key.clear();
       item->display_text = item->metadata.TitleWithCompilationArtist();
       if (item->container_level == 1 && !IsAlbumGroupBy(group_by_[0])) {
         item->sort_text = SortText(item->metadata.title());
@@ -1477,14 +2172,14 @@ CollectionItem *CollectionModel::ItemFromSong(const GroupBy group_by, const bool
       item->metadata.set_albumartist(s.effective_albumartist());
       item->key.append(ContainerKey(group_by, separate_albums_by_grouping, s));
       item->display_text = TextOrUnknown(s.effective_albumartist());
-      item->sort_text = SortTextForArtist(s.effective_albumartist(), sort_skips_articles_);
+      item->sort_text = CachedSortTextForArtist(s.effective_albumartist());
       break;
     }
     case GroupBy::Artist:{
       item->metadata.set_artist(s.artist());
       item->key.append(ContainerKey(group_by, separate_albums_by_grouping, s));
       item->display_text = TextOrUnknown(s.artist());
-      item->sort_text = SortTextForArtist(s.artist(), sort_skips_articles_);
+      item->sort_text = CachedSortTextForArtist(s.artist());
       break;
     }
     case GroupBy::Album:{
@@ -1493,7 +2188,7 @@ CollectionItem *CollectionModel::ItemFromSong(const GroupBy group_by, const bool
       item->metadata.set_grouping(s.grouping());
       item->key.append(ContainerKey(group_by, separate_albums_by_grouping, s));
       item->display_text = TextOrUnknown(s.album());
-      item->sort_text = SortTextForArtist(s.album(), sort_skips_articles_);
+      item->sort_text = CachedSortTextForArtist(s.album());
       break;
     }
     case GroupBy::AlbumDisc:{
@@ -1578,28 +2273,28 @@ CollectionItem *CollectionModel::ItemFromSong(const GroupBy group_by, const bool
       item->metadata.set_genre(s.genre());
       item->key.append(ContainerKey(group_by, separate_albums_by_grouping, s));
       item->display_text = TextOrUnknown(s.genre());
-      item->sort_text = SortTextForArtist(s.genre(), sort_skips_articles_);
+      item->sort_text = CachedSortTextForArtist(s.genre());
       break;
     }
     case GroupBy::Composer:{
       item->metadata.set_composer(s.composer());
       item->key.append(ContainerKey(group_by, separate_albums_by_grouping, s));
       item->display_text = TextOrUnknown(s.composer());
-      item->sort_text = SortTextForArtist(s.composer(), sort_skips_articles_);
+      item->sort_text = CachedSortTextForArtist(s.composer());
       break;
     }
     case GroupBy::Performer:{
       item->metadata.set_performer(s.performer());
       item->key.append(ContainerKey(group_by, separate_albums_by_grouping, s));
       item->display_text = TextOrUnknown(s.performer());
-      item->sort_text = SortTextForArtist(s.performer(), sort_skips_articles_);
+      item->sort_text = CachedSortTextForArtist(s.performer());
       break;
     }
     case GroupBy::Grouping:{
       item->metadata.set_grouping(s.grouping());
       item->key.append(ContainerKey(group_by, separate_albums_by_grouping, s));
       item->display_text = TextOrUnknown(s.grouping());
-      item->sort_text = SortTextForArtist(s.grouping(), sort_skips_articles_);
+      item->sort_text = CachedSortTextForArtist(s.grouping());
       break;
     }
     case GroupBy::FileType:{
@@ -1645,8 +2340,10 @@ CollectionItem *CollectionModel::ItemFromSong(const GroupBy group_by, const bool
     }
     case GroupBy::None:
     case GroupBy::GroupByCount:{
-      item->metadata = s;
-      item->key.append(TextOrUnknown(s.title()));
+      item->metadata = SongItemMetadata(s);
+      item->partial_metadata = true;
+      InternSongItemMetadata(&item->metadata);
+      item->key.clear();
       item->display_text = s.TitleWithCompilationArtist();
       if (item->container_level == 1 && !IsAlbumGroupBy(group_by_[0])) {
         item->sort_text = SortText(s.title());
@@ -1687,13 +2384,7 @@ void CollectionModel::FinishItem(const GroupBy group_by, const bool signal, cons
         beginInsertRows(ItemToIndex(parent), static_cast<int>(parent->children.count()), static_cast<int>(parent->children.count()));
       }
 
-      CollectionItem *divider = new CollectionItem(CollectionItem::Type_Divider, root_);
-      divider->key = divider_key;
-      divider->display_text = DividerDisplayText(group_by, divider_key);
-      divider->sort_text = divider_key + QStringLiteral("  ");
-      divider->lazy_loaded = true;
-
-      divider_nodes_[divider_key] = divider;
+      CreateDividerItem(group_by, divider_key);
 
       if (signal) {
         endInsertRows();
@@ -1703,6 +2394,20 @@ void CollectionModel::FinishItem(const GroupBy group_by, const bool signal, cons
 
 }
 
+CollectionItem *CollectionModel::CreateDividerItem(const GroupBy group_by, const QString &divider_key) {
+
+  CollectionItem *divider = new CollectionItem(CollectionItem::Type_Divider, root_);
+  divider->key = divider_key;
+  divider->display_text = DividerDisplayText(group_by, divider_key);
+  divider->sort_text = divider_key + QStringLiteral("  ");
+  divider->lazy_loaded = true;
+
+  divider_nodes_[divider_key] = divider;
+
+  return divider;
+
+}
+
 QString CollectionModel::TextOrUnknown(const QString &text) {
 
   if (text.isEmpty()) return tr("Unknown");
@@ -1757,6 +2462,85 @@ QString CollectionModel::SortText(QString text) {
 
 }
 
+QString CollectionModel::CachedSortTextForArtist(const QString &text) {
+
+  QHash<QString, QString>::const_iterator it = sort_text_cache_.constFind(text);
+  if (it != sort_text_cache_.constEnd()) return it.value();
+
+  const QString sort_text = SortTextForArtist(text, sort_skips_articles_);
+  sort_text_cache_.insert(text, sort_text);
+
+  return sort_text;
+
+}
+
+QString CollectionModel::InternString(const QString &str) {
+
+  if (str.isEmpty()) return str;
+
+  return *interned_strings_.insert(str);
+
+}
+
+void CollectionModel::InternSongItemMetadata(Song *song) {
+
+  song->set_album(InternString(song->album()));
+  song->set_artist(InternString(song->artist()));
+  song->set_albumartist(InternString(song->albumartist()));
+  song->set_genre(InternString(song->genre()));
+  song->set_composer(InternString(song->composer()));
+  song->set_performer(InternString(song->performer()));
+  song->set_grouping(InternString(song->grouping()));
+  song->set_album_id(InternString(song->album_id()));
+  song->set_cue_path(InternString(song->cue_path()));
+
+}
+
+Song CollectionModel::SongItemMetadata(const Song &song) {
+
+  // Keep in sync with kSongItemColumns.
+  Song item_song(song.source());
+  item_song.set_id(song.id());
+  item_song.set_valid(song.is_valid());
+  item_song.set_title(song.title());
+  item_song.set_album(song.album());
+  item_song.set_artist(song.artist());
+  item_song.set_albumartist(song.albumartist());
+  item_song.set_track(song.track());
+  item_song.set_disc(song.disc());
+  item_song.set_year(song.year());
+  item_song.set_originalyear(song.originalyear());
+  item_song.set_genre(song.genre());
+  item_song.set_compilation(song.compilation());
+  item_song.set_composer(song.composer());
+  item_song.set_performer(song.performer());
+  item_song.set_grouping(song.grouping());
+  item_song.set_album_id(song.album_id());
+  item_song.set_song_id(song.song_id());
+  item_song.set_beginning_nanosec(song.beginning_nanosec());
+  item_song.set_length_nanosec(song.length_nanosec());
+  item_song.set_bitrate(song.bitrate());
+  item_song.set_samplerate(song.samplerate());
+  item_song.set_bitdepth(song.bitdepth());
+  item_song.set_directory_id(song.directory_id());
+  item_song.set_url(song.url());
+  item_song.set_basefilename(song.basefilename());
+  item_song.set_filetype(song.filetype());
+  item_song.set_unavailable(song.unavailable());
+  item_song.set_rating(song.rating());
+  item_song.set_compilation_detected(song.compilation_detected());
+  item_song.set_compilation_on(song.compilation_on());
+  item_song.set_compilation_off(song.compilation_off());
+  item_song.set_art_embedded(song.art_embedded());
+  item_song.set_art_automatic(song.art_automatic());
+  item_song.set_art_manual(song.art_manual());
+  item_song.set_art_unset(song.art_unset());
+  item_song.set_cue_path(song.cue_path());
+
+  return item_song;
+
+}
+
 QString CollectionModel::SortTextForArtist(QString artist, const bool skip_articles) {
 
   artist = SortText(artist);
@@ -1833,7 +2617,11 @@ QMimeData *CollectionModel::mimeData(const QModelIndexList &indexes) const {
   data->backend = backend_;
 
   for (const QModelIndex &idx : indexes) {
-    GetChildSongs(IndexToItem(idx), &urls, &data->songs, &song_ids);
+    GetChildSongs(IndexToItem(idx), &urls, data, &song_ids);
+  }
+  LoadPartialSongs(&data->songs);
+  if (!data->queries.isEmpty()) {
+    data->filter_options = filter_options_;
   }
 
   data->setUrls(urls);
@@ -1845,17 +2633,8 @@ QMimeData *CollectionModel::mimeData(const QModelIndexList &indexes) const {
 
 bool CollectionModel::CompareItems(const CollectionItem *a, const CollectionItem *b) const {
 
-  QVariant left(data(a, CollectionModel::Role_SortText));
-  QVariant right(data(b, CollectionModel::Role_SortText));
-
-#if QT_VERSION >= QT_VERSION_CHECK(6, 0, 0)
-  if (left.metaType().id() == QMetaType::Int)
-#else
-  if (left.type() == QVariant::Int)
-#endif
-    return left.toInt() < right.toInt();
-  else
-    return left.toString() < right.toString();
+  // Compare the same way as the view sorts the items.
+  return Utilities::CollationKey(a->SortText()) < Utilities::CollationKey(b->SortText());
 
 }
 
@@ -1902,6 +2681,113 @@ void CollectionModel::GetChildSongs(CollectionItem *item, QList<QUrl> *urls, Son
 
 }
 
+void CollectionModel::GetChildSongs(CollectionItem *item, QList<QUrl> *urls, SongMimeData *data, QSet<int> *song_ids) const {
+
+  switch (item->type) {
+    case CollectionItem::Type_Container:{
+      // Populating big unloaded containers here would block the GUI thread, so leave them for the playlist to query in the background.
+      if (!item->lazy_loaded) {
+        data->queries << SongMimeData::Query(static_cast<int>(data->songs.count()), ChildSongsQuery(item));
+        break;
+      }
+
+      QList<CollectionItem*> children = item->children;
+      std::sort(children.begin(), children.end(), std::bind(&CollectionModel::CompareItems, this, std::placeholders::_1, std::placeholders::_2));
+
+      for (CollectionItem *child : children) {
+        GetChildSongs(child, urls, data, song_ids);
+      }
+      break;
+    }
+
+    case CollectionItem::Type_Song:
+      urls->append(item->metadata.url());
+      if (!song_ids->contains(item->metadata.id())) {
+        data->songs.append(item->metadata);
+        song_ids->insert(item->metadata.id());
+      }
+      break;
+
+    default:
+      break;
+  }
+
+}
+
+CollectionQueryOptions CollectionModel::ChildSongsQuery(CollectionItem *item) const {
+
+  CollectionQueryOptions query_options;
+  query_options.set_column_spec(QStringLiteral("%songs_table.ROWID, ") + Song::kColumnSpec);
+
+  for (CollectionItem *p = item; p && p->type == CollectionItem::Type_Container; p = p->parent) {
+    AddQueryWhere(group_by_[p->container_level], separate_albums_by_grouping_, p, &query_options);
+  }
+
+  // Sort by the levels below the container, then the same way as SortTextForSong.
+  QStringList order_by;
+  for (int level = item->container_level + 1; level < 3; ++level) {
+    const QString level_order_by = OrderByForGroupBy(group_by_[level]);
+    if (!level_order_by.isEmpty()) order_by << level_order_by;
+  }
+  order_by << QStringLiteral("disc, track, url");
+  query_options.set_order_by(order_by.join(QStringLiteral(", ")));
+
+  return query_options;
+
+}
+
+QString CollectionModel::OrderByForGroupBy(const GroupBy group_by) {
+
+  switch (group_by) {
+    case GroupBy::AlbumArtist:
+      return QStringLiteral("effective_albumartist COLLATE NOCASE");
+    case GroupBy::Artist:
+      return QStringLiteral("artist COLLATE NOCASE");
+    case GroupBy::Album:
+      return QStringLiteral("album COLLATE NOCASE");
+    case GroupBy::AlbumDisc:
+      return QStringLiteral("album COLLATE NOCASE, disc");
+    case GroupBy::YearAlbum:
+      return QStringLiteral("year, album COLLATE NOCASE");
+    case GroupBy::YearAlbumDisc:
+      return QStringLiteral("year, album COLLATE NOCASE, disc");
+    case GroupBy::OriginalYearAlbum:
+      return QStringLiteral("effective_originalyear, album COLLATE NOCASE");
+    case GroupBy::OriginalYearAlbumDisc:
+      return QStringLiteral("effective_originalyear, album COLLATE NOCASE, disc");
+    case GroupBy::Disc:
+      return QStringLiteral("disc");
+    case GroupBy::Year:
+      return QStringLiteral("year");
+    case GroupBy::OriginalYear:
+      return QStringLiteral("effective_originalyear");
+    case GroupBy::Genre:
+      return QStringLiteral("genre COLLATE NOCASE");
+    case GroupBy::Composer:
+      return QStringLiteral("composer COLLATE NOCASE");
+    case GroupBy::Performer:
+      return QStringLiteral("performer COLLATE NOCASE");
+    case GroupBy::Grouping:
+      return QStringLiteral("grouping COLLATE NOCASE");
+    case GroupBy::FileType:
+      return QStringLiteral("filetype");
+    case GroupBy::Format:
+      return QStringLiteral("filetype, samplerate, bitdepth");
+    case GroupBy::Samplerate:
+      return QStringLiteral("samplerate");
+    case GroupBy::Bitdepth:
+      return QStringLiteral("bitdepth");
+    case GroupBy::Bitrate:
+      return QStringLiteral("bitrate");
+    case GroupBy::None:
+    case GroupBy::GroupByCount:
+      break;
+  }
+
+  return QString();
+
+}
+
 SongList CollectionModel::GetChildSongs(const QModelIndexList &indexes) const {
 
   QList<QUrl> dontcare;
@@ -1911,6 +2797,7 @@ SongList CollectionModel::GetChildSongs(const QModelIndexList &indexes) const {
   for (const QModelIndex &idx : indexes) {
     GetChildSongs(IndexToItem(idx), &dontcare, &ret, &song_ids);
   }
+  LoadPartialSongs(&ret);
   return ret;
 
 }
@@ -1919,6 +2806,43 @@ SongList CollectionModel::GetChildSongs(const QModelIndex &idx) const {
   return GetChildSongs(QModelIndexList() << idx);
 }
 
+void CollectionModel::LoadFilterIndex(SharedPtr<CollectionBackend> backend, SharedPtr<CollectionFilterIndex> filter_index) {
+
+  {
+    QMutexLocker l(backend->db()->ReadMutex());
+    QSqlDatabase db(backend->db()->ReadConnection());
+    filter_index->Load(db, backend->songs_table());
+  }
+  backend->db()->Close();
+
+}
+
+void CollectionModel::LoadPartialSongs(SongList *songs) const {
+
+  QList<int> ids;
+  for (const Song &song : std::as_const(*songs)) {
+    CollectionItem *item = song_nodes_.value(song.id());
+    if (item && item->partial_metadata) {
+      ids << song.id();
+    }
+  }
+  if (ids.isEmpty()) return;
+
+  // Load the remaining columns of all the songs with a single query.
+  QMap<int, Song> full_songs;
+  const SongList loaded_songs = backend_->GetSongsById(ids);
+  for (const Song &song : loaded_songs) {
+    full_songs.insert(song.id(), song);
+  }
+
+  for (Song &song : *songs) {
+    if (full_songs.contains(song.id())) {
+      song = full_songs.value(song.id());
+    }
+  }
+
+}
+
 void CollectionModel::SetFilterMode(CollectionFilterOptions::FilterMode filter_mode) {
   filter_options_.set_filter_mode(filter_mode);
   ResetAsync();
@@ -2005,7 +2929,7 @@ void CollectionModel::TotalAlbumCountUpdatedSlot(const int count) {
 }
 
 void CollectionModel::ClearDiskCache() {
-  if (sIconCache) sIconCache->clear();
+  if (sIconCache) sIconCache->Clear();
 }
 
 void CollectionModel::ExpandAll(CollectionItem *item) const {
@@ -36,6 +36,8 @@
 #include <QSet>
 #include <QList>
 #include <QMap>
+#include <QHash>
+#include <QCache>
 #include <QVariant>
 #include <QString>
 #include <QStringList>
@@ -43,8 +45,8 @@
 #include <QImage>
 #include <QIcon>
 #include <QPixmap>
-#include <QNetworkDiskCache>
 
+#include "core/scoped_ptr.h"
 #include "core/shared_ptr.h"
 #include "core/simpletreemodel.h"
 #include "core/song.h"
@@ -54,12 +56,16 @@
 #include "collectionfilteroptions.h"
 #include "collectionqueryoptions.h"
 #include "collectionitem.h"
+#include "collectioniconatlas.h"
 
 class Settings;
 
 class Application;
 class CollectionBackend;
 class CollectionDirectoryModel;
+class CollectionFilterIndex;
+class SongMimeData;
+class QTimer;
 
 class CollectionModel : public SimpleTreeModel<CollectionItem> {
   Q_OBJECT
@@ -70,6 +76,8 @@ class CollectionModel : public SimpleTreeModel<CollectionItem> {
 
   static const int kPrettyCoverSize;
   static const char *kPixmapDiskCacheDir;
+  static const char *kIconAtlasFile;
+  static const char *kTreeSnapshotFile;
 
   enum Role {
     Role_Type = Qt::UserRole + 1,
@@ -79,6 +87,7 @@ class CollectionModel : public SimpleTreeModel<CollectionItem> {
     Role_Artist,
     Role_IsDivider,
     Role_Editable,
+    Role_SortKey,
     LastRole
   };
 
@@ -137,11 +146,14 @@ class CollectionModel : public SimpleTreeModel<CollectionItem> {
 
   // Call before Init()
   void set_show_various_artists(const bool show_various_artists) { show_various_artists_ = show_various_artists; }
+  // Where the top level of the tree is saved to be shown instantly on the next start, empty to disable it.
+  void set_tree_snapshot_filename(const QString &filename) { tree_snapshot_filename_ = filename; }
 
   // Get information about the collection
   void GetChildSongs(CollectionItem *item, QList<QUrl> *urls, SongList *songs, QSet<int> *song_ids) const;
   SongList GetChildSongs(const QModelIndex &idx) const;
   SongList GetChildSongs(const QModelIndexList &indexes) const;
+  void LoadPartialSongs(SongList *songs) const;
 
   // Might be accurate
   int total_song_count() const { return total_song_count_; }
@@ -181,7 +193,7 @@ class CollectionModel : public SimpleTreeModel<CollectionItem> {
   static QString SortTextForYear(const int year);
   static QString SortTextForBitrate(const int bitrate);
 
-  quint64 icon_cache_disk_size() { return sIconCache->cacheSize(); }
+  quint64 icon_cache_disk_size() { return sIconCache ? static_cast<quint64>(sIconCache->size()) : 0; }
 
   static bool IsArtistGroupBy(const GroupBy group_by) {
     return group_by == CollectionModel::GroupBy::Artist || group_by == CollectionModel::GroupBy::AlbumArtist;
@@ -190,12 +202,15 @@ class CollectionModel : public SimpleTreeModel<CollectionItem> {
 
   void set_use_lazy_loading(const bool value) { use_lazy_loading_ = value; }
 
-  QMap<QString, CollectionItem*> container_nodes(const int i) { return container_nodes_[i]; }
+  QHash<QString, CollectionItem*> container_nodes(const int i) { return container_nodes_[i]; }
   QList<CollectionItem*> song_nodes() const { return song_nodes_.values(); }
   int divider_nodes_count() const { return divider_nodes_.count(); }
 
   void ExpandAll(CollectionItem *item = nullptr) const;
 
+  // Queries the children of a container that is likely to be expanded soon in the background, so LazyPopulate doesn't have to wait for the database.
+  void Prefetch(const QModelIndex &idx);
+
   const CollectionModel::Grouping GetGroupBy() const { return group_by_; }
   void SetGroupBy(const CollectionModel::Grouping g, const std::optional<bool> separate_albums_by_grouping = std::optional<bool>());
 
@@ -231,11 +246,10 @@ class CollectionModel : public SimpleTreeModel<CollectionItem> {
   void TotalAlbumCountUpdatedSlot(const int count);
   static void ClearDiskCache();
 
-  // Called after ResetAsync
-  void ResetAsyncQueryFinished();
-
   void AlbumCoverLoaded(const quint64 id, const AlbumCoverLoaderResult &result);
 
+  void SaveTreeSnapshotAsync();
+
  private:
   // Provides some optimizations for loading the list of items in the root.
   // This gets called a lot when filtering the playlist, so it's nice to be able to do it in a background thread.
@@ -243,8 +257,38 @@ class CollectionModel : public SimpleTreeModel<CollectionItem> {
   QueryResult RunQuery(const CollectionFilterOptions &filter_options = CollectionFilterOptions(), const CollectionQueryOptions &query_options = CollectionQueryOptions());
   void PostQuery(CollectionItem *parent, const QueryResult &result, const bool signal);
 
+  // Called after ResetAsync
+  void ResetAsyncQueryFinished(const quint64 generation, const QueryResult &result);
+
+  // A node whose children are queried again by PatchAsync, found by key afterwards since the tree can change while the queries run.
+  struct PatchQuery {
+    PatchQuery() : parent_level(-1), compilation_artist_node(false), replace(false) {}
+    // Container level and key of the node, or of the parent of a Various artists node.
+    int parent_level;
+    QString parent_key;
+    bool compilation_artist_node;
+    // The children can't be matched with the existing ones when the grouping changed at their level.
+    bool replace;
+    CollectionQueryOptions query_options;
+  };
+
+  // Instead of resetting the model, run the queries for all the loaded nodes in a background thread and only insert and remove the children that changed.
+  int ComparableLevels() const;
+  void PatchAsync(const int comparable_levels);
+  void PatchAsyncQueryFinished(const quint64 generation, const QList<PatchQuery> &patch_queries, const QList<QueryResult> &results);
+  CollectionItem *PatchQueryParent(const PatchQuery &patch_query) const;
+  void PatchChildren(CollectionItem *parent, const QueryResult &result, const bool replace);
+  void RemoveChildItems(CollectionItem *parent, QList<int> rows);
+  void InsertChildItems(CollectionItem *parent, const QList<CollectionItem*> &items);
+  // Prefixes the sort text of new top level items with their divider key, and returns the keys of the dividers that don't exist yet.
+  QStringList NewDividerKeys(const GroupBy group_by, const QList<CollectionItem*> &items);
+  void InsertDividerItems(const GroupBy group_by, const QStringList &divider_keys);
+  void UnregisterItem(CollectionItem *item);
+
   bool HasCompilations(const QSqlDatabase &db, const CollectionFilterOptions &filter_options, const CollectionQueryOptions &query_options);
 
+  static void LoadFilterIndex(SharedPtr<CollectionBackend> backend, SharedPtr<CollectionFilterIndex> filter_index);
+
   void Clear();
   void BeginReset();
 
@@ -253,9 +297,15 @@ class CollectionModel : public SimpleTreeModel<CollectionItem> {
   // Filters are added for each parent item, restricting the songs returned to a particular album or artist for example.
   static void SetQueryColumnSpec(const GroupBy group_by, const bool separate_albums_by_grouping, CollectionQueryOptions *query_options);
   static void AddQueryWhere(const GroupBy group_by, const bool separate_albums_by_grouping, CollectionItem *item, CollectionQueryOptions *query_options);
+  static QString OrderByForGroupBy(const GroupBy group_by);
+
+  // Builds a query returning all the songs under a container, in the order they appear in the tree.
+  CollectionQueryOptions ChildSongsQuery(CollectionItem *item) const;
+  // Like GetChildSongs, but containers that aren't loaded yet are added as queries to the mime data instead of being populated.
+  void GetChildSongs(CollectionItem *item, QList<QUrl> *urls, SongMimeData *data, QSet<int> *song_ids) const;
 
   // Items can be created either from a query that's been run to populate a node, or by a spontaneous SongsDiscovered emission from the backend.
-  CollectionItem *ItemFromQuery(const GroupBy group_by, const bool separate_albums_by_grouping, const bool signal, const bool create_divider, CollectionItem *parent, const SqlRow &row, const int container_level);
+  CollectionItem *ItemFromQuery(const GroupBy group_by, const bool separate_albums_by_grouping, const bool signal, const bool create_divider, CollectionItem *parent, const SqlRow &row, const Song::QueryColumns *song_columns, const int container_level);
   CollectionItem *ItemFromSong(const GroupBy group_by, const bool separate_albums_by_grouping, const bool signal, const bool create_divider, CollectionItem *parent, const Song &s, const int container_level);
 
   // The "Various Artists" node is an annoying special case.
@@ -264,6 +314,7 @@ class CollectionModel : public SimpleTreeModel<CollectionItem> {
   // Helpers for ItemFromQuery and ItemFromSong
   CollectionItem *InitItem(const GroupBy group_by, const bool signal, CollectionItem *parent, const int container_level);
   void FinishItem(const GroupBy group_by, const bool signal, const bool create_divider, CollectionItem *parent, CollectionItem *item);
+  CollectionItem *CreateDividerItem(const GroupBy group_by, const QString &divider_key);
 
   static QString DividerKey(const GroupBy group_by, CollectionItem *item);
   static QString DividerDisplayText(const GroupBy group_by, const QString &key);
@@ -271,8 +322,27 @@ class CollectionModel : public SimpleTreeModel<CollectionItem> {
   // Helpers
   static bool IsCompilationArtistNode(const CollectionItem *node) { return node == node->parent->compilation_artist_node_; }
   QString AlbumIconPixmapCacheKey(const QModelIndex &idx) const;
-  QUrl AlbumIconPixmapDiskCacheKey(const QString &cache_key) const;
   QVariant AlbumIcon(const QModelIndex &idx);
+  void CancelOldestArt();
+
+  // Strings shared by many song items, like artist and album names, are stored once.
+  QString InternString(const QString &str);
+  void InternSongItemMetadata(Song *song);
+  // Only the columns needed to display, sort and load covers are kept for song items, the rest is loaded by ROWID when needed.
+  static Song SongItemMetadata(const Song &song);
+  // Sort texts are computed once for each distinct text.
+  QString CachedSortTextForArtist(const QString &text);
+
+  QString PrefetchKey(const CollectionItem *item) const;
+  CollectionItem *PrefetchItem(const QString &prefetch_key) const;
+  void StartPrefetches();
+  void ClearPrefetch();
+
+  // Snapshots are only used for the unfiltered tree.
+  bool CanUseTreeSnapshot() const;
+  QString TreeSnapshotSignature();
+  bool LoadTreeSnapshot();
+  void SaveTreeSnapshot(const QueryResult &result);
   QVariant data(const CollectionItem *item, const int role) const;
   bool CompareItems(const CollectionItem *a, const CollectionItem *b) const;
   static qint64 MaximumCacheSize(Settings *s, const char *size_id, const char *size_unit_id, const qint64 cache_size_default);
@@ -292,11 +362,18 @@ class CollectionModel : public SimpleTreeModel<CollectionItem> {
   Grouping group_by_;
   bool separate_albums_by_grouping_;
 
+  // Incremented whenever the tree is rebuilt or patched, so results of older queries are dropped.
+  quint64 tree_generation_;
+  // The grouping the current tree was built with.
+  bool tree_populated_;
+  Grouping tree_group_by_;
+  bool tree_separate_albums_by_grouping_;
+
   // Keyed on database ID
   QMap<int, CollectionItem*> song_nodes_;
 
   // Keyed on whatever the key is for that level - artist, album, year, etc.
-  QMap<QString, CollectionItem*> container_nodes_[3];
+  QHash<QString, CollectionItem*> container_nodes_[3];
 
   // Keyed on a letter, a year, a century, etc.
   QMap<QString, CollectionItem*> divider_nodes_;
@@ -306,7 +383,7 @@ class CollectionModel : public SimpleTreeModel<CollectionItem> {
   // Used as a generic icon to show when no cover art is found, fixed to the same size as the artwork (32x32)
   QPixmap no_cover_icon_;
 
-  static QNetworkDiskCache *sIconCache;
+  static ScopedPtr<CollectionIconAtlas> sIconCache;
 
   int init_task_id_;
 
@@ -315,11 +392,27 @@ class CollectionModel : public SimpleTreeModel<CollectionItem> {
   bool use_disk_cache_;
   bool use_lazy_loading_;
 
+  // Optional in-memory index used to evaluate the filter text.
+  SharedPtr<CollectionFilterIndex> filter_index_;
+
   AlbumCoverLoaderOptions::Types cover_types_;
 
   using ItemAndCacheKey = QPair<CollectionItem*, QString>;
   QMap<quint64, ItemAndCacheKey> pending_art_;
   QSet<QString> pending_cache_keys_;
+
+  QSet<QString> interned_strings_;
+  QHash<QString, QString> sort_text_cache_;
+
+  // Prefetched children keyed on container level and key, bounded by the number of rows.
+  QCache<QString, QueryResult> prefetch_cache_;
+  QStringList prefetch_queue_;
+  QSet<QString> prefetch_running_;
+  quint64 prefetch_generation_;
+
+  QString tree_snapshot_filename_;
+  // Saves the snapshot again a while after songs were added or removed.
+  QTimer *tree_snapshot_timer_;
 };
 
 Q_DECLARE_METATYPE(CollectionModel::Grouping)
@@ -26,6 +26,7 @@
 
 #include "collectionplaylistitem.h"
 #include "core/tagreaderclient.h"
+#include "core/songinterner.h"
 
 class SqlRow;
 
@@ -34,15 +35,17 @@ CollectionPlaylistItem::CollectionPlaylistItem() : PlaylistItem(Song::Source::Co
 }
 
 CollectionPlaylistItem::CollectionPlaylistItem(const Song &song) : PlaylistItem(Song::Source::Collection), song_(song) {
-  song_.set_source(Song::Source::Collection);
+  // Setting the source detaches the song from the collection's copy, so it's only set when it differs.
+  if (song_.source() != Song::Source::Collection) song_.set_source(Song::Source::Collection);
 }
 
 QUrl CollectionPlaylistItem::Url() const { return song_.url(); }
 
 void CollectionPlaylistItem::Reload() {
 
-  TagReaderClient::Instance()->ReadFileBlocking(song_.url().toLocalFile(), &song_);
+  TagReaderClient::Instance()->ReadFileBlocking(song_.url().toLocalFile(), &song_, TagReaderClient::ReadLevel::Full, TagReaderClient::Priority::Playback);
   UpdateTemporaryMetadata(song_);
+  DatabaseMetadataChanged();
 
 }
 
@@ -51,6 +54,7 @@ bool CollectionPlaylistItem::InitFromQuery(const SqlRow &query) {
   // Rows from the songs tables come first
   song_.InitFromQuery(query, true);
   song_.set_source(Song::Source::Collection);
+  song_ = SongInterner::Intern(song_);
   return song_.is_valid();
 
 }
@@ -75,5 +79,6 @@ void CollectionPlaylistItem::SetArtManual(const QUrl &cover_url) {
 
   song_.set_art_manual(cover_url);
   if (HasTemporaryMetadata()) temp_metadata_.set_art_manual(cover_url);
+  DatabaseMetadataChanged();
 
 }
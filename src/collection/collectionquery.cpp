@@ -47,7 +47,16 @@ CollectionQuery::CollectionQuery(const QSqlDatabase &db, const QString &songs_ta
       duplicates_only_(false),
       limit_(-1) {
 
-  if (!filter_options.filter_text().isEmpty()) {
+  if (filter_options.filter_ids()) {
+    // The filter text was already matched in memory, so there's no need to join with the FTS table.
+    QStringList ids;
+    ids.reserve(filter_options.filter_ids()->count());
+    for (const int id : *filter_options.filter_ids()) {
+      ids << QString::number(id);
+    }
+    where_clauses_ << (ids.isEmpty() ? QStringLiteral("0") : QStringLiteral("%songs_table.ROWID IN (%1)").arg(ids.join(QLatin1Char(','))));
+  }
+  else if (!filter_options.filter_text().isEmpty()) {
     // We need to munge the filter text a little bit to get it to work as expected with sqlite's FTS5:
     //  1) Append * to all tokens.
     //  2) Prefix "fts" to column names.
@@ -60,7 +69,22 @@ CollectionQuery::CollectionQuery(const QSqlDatabase &db, const QString &songs_ta
 #else
     QStringList tokens(filter_text.split(QRegularExpression(QStringLiteral("\\s+")), QString::SkipEmptyParts));
 #endif
+    // With substring search, words of at least 3 characters are matched anywhere in the columns with the trigram index.
+    // The trigram tokenizer can't match shorter words, so those are still matched as prefixes of words.
     QString query;
+    QString trigram_query;
+    const bool substring_search = filter_options.substring_search();
+    auto add_term = [&query, &trigram_query, substring_search](const QString &column, const QString &text) {
+      const QString term = (column.isEmpty() ? QString() : column + QLatin1Char(':')) + QLatin1Char('\"') + text + QLatin1Char('\"');
+      if (substring_search && text.length() >= 3) {
+        if (!trigram_query.isEmpty()) trigram_query.append(QLatin1Char(' '));
+        trigram_query += term;
+      }
+      else {
+        if (!query.isEmpty()) query.append(QLatin1Char(' '));
+        query += term + QLatin1Char('*');
+      }
+    };
     for (QString token : tokens) {
       token.remove(QLatin1Char('('))
            .remove(QLatin1Char(')'))
@@ -72,8 +96,7 @@ CollectionQuery::CollectionQuery(const QSqlDatabase &db, const QString &songs_ta
         QString subtoken = token.section(QLatin1Char(':'), 1, -1).replace(QLatin1String(":"), QLatin1String(" ")).trimmed();
         if (subtoken.isEmpty()) continue;
         if (Song::kFtsColumns.contains(QLatin1String("fts") + columntoken, Qt::CaseInsensitive)) {
-          if (!query.isEmpty()) query.append(QLatin1String(" "));
-          query += QStringLiteral("fts") + columntoken + QStringLiteral(":\"") + subtoken + QStringLiteral("\"*");
+          add_term(QStringLiteral("fts") + columntoken, subtoken);
         }
         else if (Song::kNumericalColumns.contains(columntoken, Qt::CaseInsensitive)) {
           QString comparator = RemoveSqlOperator(subtoken);
@@ -93,14 +116,12 @@ CollectionQuery::CollectionQuery(const QSqlDatabase &db, const QString &songs_ta
         else {
           token = token.replace(QLatin1String(":"), QLatin1String(" ")).trimmed();
           if (!token.isEmpty()) {
-            if (!query.isEmpty()) query.append(QLatin1Char(' '));
-            query += QLatin1Char('\"') + token + QStringLiteral("\"*");
+            add_term(QString(), token);
           }
         }
       }
       else {
-        if (!query.isEmpty()) query.append(QLatin1Char(' '));
-        query += QLatin1Char('\"') + token + QStringLiteral("\"*");
+        add_term(QString(), token);
       }
     }
     if (!query.isEmpty()) {
@@ -108,6 +129,11 @@ CollectionQuery::CollectionQuery(const QSqlDatabase &db, const QString &songs_ta
       bound_values_ << query;
       join_with_fts_ = true;
     }
+    if (!trigram_query.isEmpty()) {
+      // The trigram table is only used to look up the ROWIDs, which is faster than joining it.
+      where_clauses_ << QStringLiteral("%songs_table.ROWID IN (SELECT ROWID FROM %fts_table_trigram WHERE %fts_trigram_table_noprefix MATCH ?)");
+      bound_values_ << trigram_query;
+    }
   }
 
   if (filter_options.max_age() != -1) {
@@ -269,6 +295,8 @@ bool CollectionQuery::Exec() {
   if (limit_ != -1) sql += QStringLiteral(" LIMIT ") + QString::number(limit_);
 
   sql.replace(QLatin1String("%songs_table"), songs_table_);
+  sql.replace(QLatin1String("%fts_trigram_table_noprefix"), fts_table_.section(QLatin1Char('.'), -1, -1) + QStringLiteral("_trigram"));
+  sql.replace(QLatin1String("%fts_table_trigram"), fts_table_ + QStringLiteral("_trigram"));
   sql.replace(QLatin1String("%fts_table_noprefix"), fts_table_.section(QLatin1Char('.'), -1, -1));
   sql.replace(QLatin1String("%fts_table"), fts_table_);
 
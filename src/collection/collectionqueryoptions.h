@@ -23,6 +23,7 @@
 #include <QList>
 #include <QVariant>
 #include <QString>
+#include <QStringList>
 
 class CollectionQueryOptions {
  public:
@@ -43,20 +44,27 @@ class CollectionQueryOptions {
   };
 
   QString column_spec() const { return column_spec_; }
+  // Song columns to select for song rows instead of the column spec, the ROWID is always included.
+  QStringList columns() const { return columns_; }
   CompilationRequirement compilation_requirement() const { return compilation_requirement_; }
   bool query_have_compilations() const { return query_have_compilations_; }
+  QString order_by() const { return order_by_; }
 
   void set_column_spec(const QString &column_spec) { column_spec_ = column_spec; }
+  void set_columns(const QStringList &columns) { columns_ = columns; }
   void set_compilation_requirement(const CompilationRequirement compilation_requirement) { compilation_requirement_ = compilation_requirement; }
   void set_query_have_compilations(const bool query_have_compilations) { query_have_compilations_ = query_have_compilations; }
+  void set_order_by(const QString &order_by) { order_by_ = order_by; }
 
   QList<Where> where_clauses() const { return where_clauses_; }
   void AddWhere(const QString &column, const QVariant &value, const QString &op = QStringLiteral("="));
 
  private:
   QString column_spec_;
+  QStringList columns_;
   CompilationRequirement compilation_requirement_;
   bool query_have_compilations_;
+  QString order_by_;
   QList<Where> where_clauses_;
 };
 
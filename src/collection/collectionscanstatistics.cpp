@@ -0,0 +1,154 @@
+/*
+ * Strawberry Music Player
+ *
+ * Strawberry is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Strawberry is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Strawberry.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+
+#include "config.h"
+
+#include <algorithm>
+
+#include <QtGlobal>
+#include <QObject>
+#include <QList>
+#include <QPair>
+#include <QString>
+#include <QStringList>
+#include <QElapsedTimer>
+
+#include "utilities/strutils.h"
+#include "collectionscanstatistics.h"
+
+namespace {
+constexpr int kSlowestDirectoriesCount = 10;
+constexpr qint64 kNsecPerMsec = 1000000;
+constexpr qint64 kHistogramBucketLimits[] = { 1 * kNsecPerMsec, 10 * kNsecPerMsec, 100 * kNsecPerMsec, 1000 * kNsecPerMsec };
+}  // namespace
+
+CollectionScanStatistics::CollectionScanStatistics()
+    : files_scanned_(0),
+      files_read_(0),
+      bytes_read_(0),
+      directories_scanned_(0) {
+
+  elapsed_.start();
+
+}
+
+void CollectionScanStatistics::AddPhaseTime(const Phase phase, const qint64 nsec) {
+
+  PhaseStatistics &phase_statistics = phases_[static_cast<int>(phase)];
+  ++phase_statistics.count;
+  phase_statistics.nsec += nsec;
+
+  int bucket = 0;
+  while (bucket < kHistogramBucketCount - 1 && nsec >= kHistogramBucketLimits[bucket]) ++bucket;
+  ++phase_statistics.histogram[bucket];
+
+}
+
+void CollectionScanStatistics::AddDirectory(const QString &path, const qint64 nsec) {
+
+  ++directories_scanned_;
+
+  if (slowest_directories_.count() >= kSlowestDirectoriesCount && nsec <= slowest_directories_.last().first) return;
+
+  auto it = std::upper_bound(slowest_directories_.begin(), slowest_directories_.end(), nsec, [](const qint64 value, const QPair<qint64, QString> &directory) { return value > directory.first; });
+  slowest_directories_.insert(it, qMakePair(nsec, path));
+  if (slowest_directories_.count() > kSlowestDirectoriesCount) {
+    slowest_directories_.removeLast();
+  }
+
+}
+
+void CollectionScanStatistics::AddFileRead(const qint64 bytes) {
+
+  ++files_read_;
+  if (bytes > 0) bytes_read_ += static_cast<quint64>(bytes);
+
+}
+
+double CollectionScanStatistics::files_per_second() const {
+
+  const qint64 nsec = elapsed_.nsecsElapsed();
+  if (nsec <= 0) return 0.0;
+
+  return static_cast<double>(files_scanned_) * 1e9 / static_cast<double>(nsec);
+
+}
+
+QString CollectionScanStatistics::ShortSummary() const {
+
+  return QObject::tr("%1 files scanned, %2 files per second, %3 read").arg(files_scanned_).arg(files_per_second(), 0, 'f', 1).arg(Utilities::PrettySize(bytes_read_));
+
+}
+
+QString CollectionScanStatistics::Summary() const {
+
+  QStringList lines;
+  lines << QStringLiteral("Scanned %1 files in %2 directories in %3 ms (%4 files per second), read tags from %5 files (%6).")
+           .arg(files_scanned_)
+           .arg(directories_scanned_)
+           .arg(elapsed_.elapsed())
+           .arg(files_per_second(), 0, 'f', 1)
+           .arg(files_read_)
+           .arg(Utilities::PrettySize(bytes_read_));
+
+  for (int i = 0; i < kPhaseCount; ++i) {
+    const PhaseStatistics &phase_statistics = phases_[i];
+    if (phase_statistics.count == 0) continue;
+    QStringList histogram;
+    for (int bucket = 0; bucket < kHistogramBucketCount; ++bucket) {
+      histogram << QString::number(phase_statistics.histogram[bucket]);
+    }
+    lines << QStringLiteral("  %1: %2 ms in %3 calls (<1ms/<10ms/<100ms/<1s/>=1s: %4)")
+             .arg(PhaseName(static_cast<Phase>(i)))
+             .arg(phase_statistics.nsec / kNsecPerMsec)
+             .arg(phase_statistics.count)
+             .arg(histogram.join(QLatin1Char('/')));
+  }
+
+  if (!slowest_directories_.isEmpty()) {
+    lines << QStringLiteral("  Slowest directories:");
+    for (const QPair<qint64, QString> &directory : slowest_directories_) {
+      lines << QStringLiteral("    %1 ms %2").arg(directory.first / kNsecPerMsec).arg(directory.second);
+    }
+  }
+
+  return lines.join(QLatin1Char('\n'));
+
+}
+
+QString CollectionScanStatistics::PhaseName(const Phase phase) {
+
+  switch (phase) {
+    case Phase::DirectoryListing:
+      return QStringLiteral("Directory listing");
+    case Phase::MediaFileDetection:
+      return QStringLiteral("Media file detection");
+    case Phase::TagReading:
+      return QStringLiteral("Tag reading");
+    case Phase::CueParsing:
+      return QStringLiteral("CUE parsing");
+    case Phase::AlbumArt:
+      return QStringLiteral("Album art");
+    case Phase::Commit:
+      return QStringLiteral("Commit");
+  }
+
+  return QString();
+
+}
@@ -0,0 +1,99 @@
+/*
+ * Strawberry Music Player
+ *
+ * Strawberry is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Strawberry is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Strawberry.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+
+#ifndef COLLECTIONSCANSTATISTICS_H
+#define COLLECTIONSCANSTATISTICS_H
+
+#include "config.h"
+
+#include <QtGlobal>
+#include <QList>
+#include <QPair>
+#include <QString>
+#include <QElapsedTimer>
+
+// Collects counters and timings for a collection scan, so slow scans can be attributed to a phase or to a directory.
+class CollectionScanStatistics {
+ public:
+  CollectionScanStatistics();
+
+  enum class Phase {
+    DirectoryListing,
+    MediaFileDetection,
+    TagReading,
+    CueParsing,
+    AlbumArt,
+    Commit
+  };
+  static constexpr int kPhaseCount = static_cast<int>(Phase::Commit) + 1;
+
+  // Duration buckets of the per phase histograms: under 1 ms, 10 ms, 100 ms, 1 s and above.
+  static constexpr int kHistogramBucketCount = 5;
+
+  class ScopedPhaseTimer {
+   public:
+    explicit ScopedPhaseTimer(CollectionScanStatistics *statistics, const Phase phase) : statistics_(statistics), phase_(phase) { timer_.start(); }
+    ~ScopedPhaseTimer() { statistics_->AddPhaseTime(phase_, timer_.nsecsElapsed()); }
+
+   private:
+    CollectionScanStatistics *statistics_;
+    const Phase phase_;
+    QElapsedTimer timer_;
+
+    Q_DISABLE_COPY(ScopedPhaseTimer)
+  };
+
+  void AddPhaseTime(const Phase phase, const qint64 nsec);
+  void AddDirectory(const QString &path, const qint64 nsec);
+  void AddFilesScanned(const quint64 files) { files_scanned_ += files; }
+  void AddFileRead(const qint64 bytes);
+
+  quint64 files_scanned() const { return files_scanned_; }
+  quint64 files_read() const { return files_read_; }
+  quint64 bytes_read() const { return bytes_read_; }
+  quint64 directories_scanned() const { return directories_scanned_; }
+  qint64 elapsed_nsec() const { return elapsed_.nsecsElapsed(); }
+  qint64 phase_nsec(const Phase phase) const { return phases_[static_cast<int>(phase)].nsec; }
+  double files_per_second() const;
+
+  // One line summary for the task progress.
+  QString ShortSummary() const;
+  // Multi line summary with the time spent per phase and the slowest directories.
+  QString Summary() const;
+
+  static QString PhaseName(const Phase phase);
+
+ private:
+  struct PhaseStatistics {
+    PhaseStatistics() : count(0), nsec(0), histogram{} {}
+    quint64 count;
+    qint64 nsec;
+    quint64 histogram[kHistogramBucketCount];
+  };
+
+  QElapsedTimer elapsed_;
+  quint64 files_scanned_;
+  quint64 files_read_;
+  quint64 bytes_read_;
+  quint64 directories_scanned_;
+  PhaseStatistics phases_[kPhaseCount];
+  QList<QPair<qint64, QString>> slowest_directories_;
+};
+
+#endif  // COLLECTIONSCANSTATISTICS_H
@@ -0,0 +1,208 @@
+/*
+ * Strawberry Music Player
+ *
+ * Strawberry is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Strawberry is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Strawberry.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#include "config.h"
+
+#include <algorithm>
+#include <cmath>
+#include <cstddef>
+#include <optional>
+#include <utility>
+#include <vector>
+
+#include <QtGlobal>
+#include <QMutex>
+#include <QList>
+#include <QHash>
+#include <QSet>
+#include <QByteArray>
+#include <QString>
+#include <QUrl>
+#include <QRandomGenerator>
+
+#include "core/song.h"
+#include "collectionsimilarityindex.h"
+
+namespace {
+
+constexpr int kDimensions = 8;
+
+// Songs with another genre are this far away, about as far as half of one feature from one end to the other.
+constexpr int kGenreDistance = 127 * 127;
+
+// Mixes pick randomly from this many times the number of songs they want.
+constexpr int kCandidateFactor = 4;
+
+// Maps -1 to 1 to a signed byte.
+qint8 Quantize(const double value) {
+  return static_cast<qint8>(std::lround(std::clamp(value, -1.0, 1.0) * 127.0));
+}
+
+uint GenreHash(const QString &genre) {
+  return genre.isEmpty() ? 0 : qHash(genre.toLower());
+}
+
+}  // namespace
+
+CollectionSimilarityIndex::CollectionSimilarityIndex() : dirty_(true) {}
+
+void CollectionSimilarityIndex::Features(const Song &song, const Mood &mood, qint8 *features) {
+
+  // Features that aren't known are in the middle, so they don't pull the song in any direction.
+  const std::optional<double> lufs = song.ebur128_integrated_loudness_lufs();
+  const std::optional<double> lra = song.ebur128_loudness_range_lu();
+  features[0] = lufs ? Quantize((*lufs + 14.0) / 10.0) : 0;
+  features[1] = lra ? Quantize((*lra - 8.0) / 8.0) : 0;
+  features[2] = mood.low;
+  features[3] = mood.mid;
+  features[4] = mood.high;
+  features[5] = song.year() > 0 ? Quantize((song.year() - 1990) / 30.0) : 0;
+  features[6] = Quantize(std::log1p(song.playcount()) / std::log1p(100.0) * 2.0 - 1.0);
+  features[7] = song.rating() >= 0.0F ? Quantize(song.rating() * 2.0 - 1.0) : 0;
+
+}
+
+void CollectionSimilarityIndex::SetSongs(const SongList &songs) {
+
+  // Cleared first, so changes while the vectors are made are seen the next time.
+  dirty_ = false;
+
+  QMutexLocker l(&mutex_);
+
+  rows_.clear();
+  url_rows_.clear();
+  ids_.clear();
+  genres_.clear();
+  features_.clear();
+
+  rows_.reserve(songs.count());
+  url_rows_.reserve(songs.count());
+  ids_.reserve(songs.count());
+  genres_.reserve(songs.count());
+  features_.resize(static_cast<int>(songs.count()) * kDimensions);
+
+  qint8 *features = reinterpret_cast<qint8*>(features_.data());
+  for (const Song &song : songs) {
+    if (song.id() == -1 || song.unavailable()) continue;
+    const int row = static_cast<int>(ids_.count());
+    rows_.insert(song.id(), row);
+    url_rows_.insert(song.url(), row);
+    ids_ << song.id();
+    genres_ << GenreHash(song.genre());
+    Features(song, moods_.value(song.url()), features + row * kDimensions);
+  }
+  features_.resize(static_cast<int>(ids_.count()) * kDimensions);
+
+}
+
+void CollectionSimilarityIndex::SetMoodbar(const QUrl &url, const QByteArray &data) {
+
+  // The moodbar is the normalized energy of the low, mid and high bands as RGB values over the song.
+  const int frames = static_cast<int>(data.size() / 3);
+  if (frames == 0) return;
+
+  const uchar *p = reinterpret_cast<const uchar*>(data.constData());
+  qint64 totals[3] = { 0, 0, 0 };
+  for (int i = 0; i < frames; ++i) {
+    totals[0] += p[i * 3];
+    totals[1] += p[i * 3 + 1];
+    totals[2] += p[i * 3 + 2];
+  }
+
+  Mood mood;
+  mood.low = Quantize(static_cast<double>(totals[0]) / (frames * 255.0) * 2.0 - 1.0);
+  mood.mid = Quantize(static_cast<double>(totals[1]) / (frames * 255.0) * 2.0 - 1.0);
+  mood.high = Quantize(static_cast<double>(totals[2]) / (frames * 255.0) * 2.0 - 1.0);
+
+  QMutexLocker l(&mutex_);
+
+  moods_.insert(url, mood);
+
+  const int row = url_rows_.value(url, -1);
+  if (row != -1) {
+    qint8 *features = reinterpret_cast<qint8*>(features_.data()) + row * kDimensions;
+    features[2] = mood.low;
+    features[3] = mood.mid;
+    features[4] = mood.high;
+  }
+
+}
+
+QList<int> CollectionSimilarityIndex::Nearest(const QList<int> &seed_ids, const int count, const QSet<int> &exclude) const {
+
+  QMutexLocker l(&mutex_);
+
+  if (count <= 0 || ids_.isEmpty()) return QList<int>();
+
+  const qint8 *features = reinterpret_cast<const qint8*>(features_.constData());
+
+  // The mix follows the average of the seeds, and the genre most of them have.
+  int center[kDimensions] = {};
+  QHash<uint, int> genre_counts;
+  int seeds = 0;
+  for (const int id : seed_ids) {
+    const int row = rows_.value(id, -1);
+    if (row == -1) continue;
+    for (int i = 0; i < kDimensions; ++i) {
+      center[i] += features[row * kDimensions + i];
+    }
+    if (genres_[row] != 0) ++genre_counts[genres_[row]];
+    ++seeds;
+  }
+  if (seeds == 0) return QList<int>();
+
+  for (int i = 0; i < kDimensions; ++i) {
+    center[i] /= seeds;
+  }
+
+  uint genre = 0;
+  int genre_count = 0;
+  for (QHash<uint, int>::const_iterator it = genre_counts.constBegin(); it != genre_counts.constEnd(); ++it) {
+    if (it.value() > genre_count) {
+      genre = it.key();
+      genre_count = it.value();
+    }
+  }
+
+  std::vector<std::pair<int, int>> distances;
+  distances.reserve(static_cast<size_t>(ids_.count()));
+  for (int row = 0; row < ids_.count(); ++row) {
+    if (exclude.contains(ids_[row])) continue;
+    const qint8 *f = features + row * kDimensions;
+    int distance = 0;
+    for (int i = 0; i < kDimensions; ++i) {
+      const int d = f[i] - center[i];
+      distance += d * d;
+    }
+    if (genre != 0 && genres_[row] != genre) distance += kGenreDistance;
+    distances.emplace_back(distance, row);
+  }
+
+  const size_t candidates = std::min(distances.size(), static_cast<size_t>(count) * kCandidateFactor);
+  std::partial_sort(distances.begin(), distances.begin() + static_cast<std::ptrdiff_t>(candidates), distances.end());
+  std::shuffle(distances.begin(), distances.begin() + static_cast<std::ptrdiff_t>(candidates), *QRandomGenerator::global());
+
+  QList<int> ret;
+  ret.reserve(std::min(count, static_cast<int>(candidates)));
+  for (size_t i = 0; i < candidates && ret.count() < count; ++i) {
+    ret << ids_[distances[i].second];
+  }
+
+  return ret;
+
+}
@@ -0,0 +1,79 @@
+/*
+ * Strawberry Music Player
+ *
+ * Strawberry is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Strawberry is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Strawberry.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#ifndef COLLECTIONSIMILARITYINDEX_H
+#define COLLECTIONSIMILARITYINDEX_H
+
+#include "config.h"
+
+#include <atomic>
+
+#include <QtGlobal>
+#include <QMutex>
+#include <QList>
+#include <QHash>
+#include <QSet>
+#include <QByteArray>
+#include <QUrl>
+
+#include "core/song.h"
+
+// Compact feature vectors of the collection songs, used to find songs that sound like other songs for "more like this" mixes.
+// The vectors are made from data the collection already has: EBU R 128 loudness, moodbar band energies, year, play count and rating, and songs with another genre are further away.
+// Each song takes a few bytes, so comparing a mix with all the songs takes milliseconds even for large collections.
+// Thread-safe.
+class CollectionSimilarityIndex {
+ public:
+  CollectionSimilarityIndex();
+
+  // Set when the collection changed, the index should be built again with SetSongs before it's used.
+  bool is_dirty() const { return dirty_; }
+  void Invalidate() { dirty_ = true; }
+
+  void SetSongs(const SongList &songs);
+
+  // Moodbars are created separately, they're added to the index when they're loaded.
+  void SetMoodbar(const QUrl &url, const QByteArray &data);
+
+  // Returns up to count IDs of songs near the average of the seed songs, without the excluded IDs.
+  // The songs are picked randomly from the nearest ones, so the same seeds give different mixes.
+  QList<int> Nearest(const QList<int> &seed_ids, const int count, const QSet<int> &exclude) const;
+
+ private:
+  struct Mood {
+    Mood() : low(0), mid(0), high(0) {}
+    qint8 low;
+    qint8 mid;
+    qint8 high;
+  };
+
+  static void Features(const Song &song, const Mood &mood, qint8 *features);
+
+ private:
+  std::atomic<bool> dirty_;
+
+  mutable QMutex mutex_;
+  QHash<QUrl, Mood> moods_;
+  QHash<int, int> rows_;
+  QHash<QUrl, int> url_rows_;
+  QList<int> ids_;
+  QList<uint> genres_;
+  QByteArray features_;
+};
+
+#endif  // COLLECTIONSIMILARITYINDEX_H
@@ -0,0 +1,39 @@
+/*
+ * Strawberry Music Player
+ *
+ * Strawberry is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Strawberry is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Strawberry.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#include "config.h"
+
+#include <QObject>
+#include <QSortFilterProxyModel>
+#include <QModelIndex>
+#include <QByteArray>
+
+#include "collectionmodel.h"
+#include "collectionsortmodel.h"
+
+CollectionSortModel::CollectionSortModel(QObject *parent) : QSortFilterProxyModel(parent) {
+
+  setSortRole(CollectionModel::Role_SortText);
+
+}
+
+bool CollectionSortModel::lessThan(const QModelIndex &left, const QModelIndex &right) const {
+
+  return left.data(CollectionModel::Role_SortKey).toByteArray() < right.data(CollectionModel::Role_SortKey).toByteArray();
+
+}
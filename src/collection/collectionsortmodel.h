@@ -0,0 +1,41 @@
+/*
+ * Strawberry Music Player
+ *
+ * Strawberry is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Strawberry is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Strawberry.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#ifndef COLLECTIONSORTMODEL_H
+#define COLLECTIONSORTMODEL_H
+
+#include "config.h"
+
+#include <QSortFilterProxyModel>
+
+class QObject;
+class QModelIndex;
+
+// Sorts the items of a collection model on the collation keys of their sort text.
+// Comparing them is a byte comparison, instead of a locale aware string comparison for every pair of items.
+class CollectionSortModel : public QSortFilterProxyModel {
+  Q_OBJECT
+
+ public:
+  explicit CollectionSortModel(QObject *parent = nullptr);
+
+ protected:
+  bool lessThan(const QModelIndex &left, const QModelIndex &right) const override;
+};
+
+#endif  // COLLECTIONSORTMODEL_H
@@ -0,0 +1,133 @@
+/*
+ * Strawberry Music Player
+ *
+ * Strawberry is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Strawberry is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Strawberry.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+
+#include "config.h"
+
+#include <utility>
+
+#include <QtGlobal>
+#include <QIODevice>
+#include <QFile>
+#include <QSaveFile>
+#include <QDataStream>
+#include <QVariant>
+#include <QString>
+#include <QStringList>
+#include <QSqlField>
+#include <QSqlRecord>
+
+#include "core/logging.h"
+#include "core/sqlrow.h"
+#include "collectiontreesnapshot.h"
+
+namespace {
+constexpr quint32 kMagic = 0x53435453;  // "SCTS"
+constexpr quint32 kVersion = 1;
+}  // namespace
+
+namespace CollectionTreeSnapshot {
+
+bool Write(const QString &filename, const QString &signature, const bool create_va, const SqlRowList &rows) {
+
+  QSaveFile file(filename);
+  if (!file.open(QIODevice::WriteOnly)) {
+    qLog(Error) << "Failed to open collection tree snapshot" << filename << "for writing:" << file.errorString();
+    return false;
+  }
+
+  QDataStream s(&file);
+  s.setVersion(QDataStream::Qt_5_12);
+
+  s << kMagic << kVersion << signature << create_va;
+
+  QStringList columns;
+  if (!rows.isEmpty()) {
+    const QSqlRecord &record = rows.first().record();
+    for (int i = 0; i < record.count(); ++i) {
+      columns << record.fieldName(i);
+    }
+  }
+  s << columns;
+
+  s << static_cast<quint32>(rows.count());
+  for (const SqlRow &row : rows) {
+    for (int i = 0; i < columns.count(); ++i) {
+      s << row.value(i);
+    }
+  }
+
+  if (s.status() != QDataStream::Ok || !file.commit()) {
+    qLog(Error) << "Failed to write collection tree snapshot" << filename;
+    return false;
+  }
+
+  return true;
+
+}
+
+bool Read(const QString &filename, const QString &signature, bool *create_va, SqlRowList *rows) {
+
+  QFile file(filename);
+  if (!file.exists() || !file.open(QIODevice::ReadOnly)) return false;
+
+  QDataStream s(&file);
+  s.setVersion(QDataStream::Qt_5_12);
+
+  quint32 magic = 0;
+  quint32 version = 0;
+  QString snapshot_signature;
+  s >> magic >> version;
+  if (magic != kMagic || version != kVersion) return false;
+  s >> snapshot_signature;
+  if (snapshot_signature != signature) return false;
+
+  bool snapshot_create_va = false;
+  QStringList columns;
+  quint32 row_count = 0;
+  s >> snapshot_create_va >> columns >> row_count;
+  if (s.status() != QDataStream::Ok) return false;
+
+  QSqlRecord record;
+  for (const QString &column : std::as_const(columns)) {
+    record.append(QSqlField(column));
+  }
+
+  SqlRowList snapshot_rows;
+  for (quint32 row = 0; row < row_count && s.status() == QDataStream::Ok; ++row) {
+    for (int i = 0; i < columns.count(); ++i) {
+      QVariant value;
+      s >> value;
+      record.setValue(i, value);
+    }
+    snapshot_rows << SqlRow(record);
+  }
+
+  if (s.status() != QDataStream::Ok) {
+    qLog(Error) << "Collection tree snapshot" << filename << "is truncated";
+    return false;
+  }
+
+  *create_va = snapshot_create_va;
+  *rows = snapshot_rows;
+
+  return true;
+
+}
+
+}  // namespace CollectionTreeSnapshot
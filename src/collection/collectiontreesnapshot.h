@@ -0,0 +1,38 @@
+/*
+ * Strawberry Music Player
+ *
+ * Strawberry is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Strawberry is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Strawberry.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+
+#ifndef COLLECTIONTREESNAPSHOT_H
+#define COLLECTIONTREESNAPSHOT_H
+
+#include "config.h"
+
+#include <QString>
+
+#include "core/sqlrow.h"
+
+// Snapshot of the rows returned by the top level query of the collection model, so the tree can be shown at startup before the database is queried.
+// The signature describes the grouping and query the rows are from, a snapshot with another signature or format version is ignored.
+namespace CollectionTreeSnapshot {
+
+bool Write(const QString &filename, const QString &signature, const bool create_va, const SqlRowList &rows);
+bool Read(const QString &filename, const QString &signature, bool *create_va, SqlRowList *rows);
+
+}  // namespace CollectionTreeSnapshot
+
+#endif  // COLLECTIONTREESNAPSHOT_H
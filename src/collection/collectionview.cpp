@@ -45,6 +45,8 @@
 #include <QMenu>
 #include <QAction>
 #include <QMessageBox>
+#include <QScrollBar>
+#include <QTimer>
 #include <QSettings>
 #include <QtEvents>
 
@@ -102,7 +104,8 @@ CollectionView::CollectionView(QWidget *parent)
       action_no_show_in_various_(nullptr),
       action_delete_files_(nullptr),
       is_in_keyboard_search_(false),
-      delete_files_(false) {
+      delete_files_(false),
+      prefetch_timer_(new QTimer(this)) {
 
   setItemDelegate(new CollectionItemDelegate(this));
   setAttribute(Qt::WA_MacShowFocusRect, false);
@@ -114,6 +117,15 @@ CollectionView::CollectionView(QWidget *parent)
 
   setStyleSheet(QStringLiteral("QTreeView::item{padding-top:1px;}"));
 
+  // Needed to prefetch the children of hovered items.
+  setMouseTracking(true);
+
+  prefetch_timer_->setSingleShot(true);
+  prefetch_timer_->setInterval(200);
+  QObject::connect(prefetch_timer_, &QTimer::timeout, this, &CollectionView::PrefetchVisible);
+  QObject::connect(verticalScrollBar(), &QScrollBar::valueChanged, prefetch_timer_, QOverload<>::of(&QTimer::start));
+  QObject::connect(this, &CollectionView::expanded, prefetch_timer_, QOverload<>::of(&QTimer::start));
+
 }
 
 CollectionView::~CollectionView() = default;
@@ -347,6 +359,43 @@ void CollectionView::mouseReleaseEvent(QMouseEvent *e) {
 
 }
 
+void CollectionView::mouseMoveEvent(QMouseEvent *e) {
+
+  QTreeView::mouseMoveEvent(e);
+
+  if (e->buttons() == Qt::NoButton) {
+    Prefetch(indexAt(e->pos()));
+  }
+
+}
+
+void CollectionView::Prefetch(const QModelIndex &idx) {
+
+  if (!app_ || !idx.isValid() || isExpanded(idx) || !model()->canFetchMore(idx)) return;
+
+  QSortFilterProxyModel *proxy_model = qobject_cast<QSortFilterProxyModel*>(model());
+  if (!proxy_model) return;
+
+  app_->collection_model()->Prefetch(proxy_model->mapToSource(idx));
+
+}
+
+void CollectionView::PrefetchVisible() {
+
+  // The items at the top are requested last, since the model prefetches the most recent requests first.
+  QModelIndex idx = indexAt(viewport()->rect().topLeft());
+  QList<QModelIndex> visible_indexes;
+  while (idx.isValid() && visualRect(idx).top() < viewport()->rect().bottom()) {
+    visible_indexes.prepend(idx);
+    idx = indexBelow(idx);
+  }
+
+  for (const QModelIndex &visible_index : std::as_const(visible_indexes)) {
+    Prefetch(visible_index);
+  }
+
+}
+
 void CollectionView::keyPressEvent(QKeyEvent *e) {
 
   switch (e->key()) {
@@ -40,6 +40,7 @@ class QMenu;
 class QAction;
 class QContextMenuEvent;
 class QMouseEvent;
+class QTimer;
 class QPaintEvent;
 
 class Application;
@@ -95,6 +96,7 @@ class CollectionView : public AutoExpandingTreeView {
   void paintEvent(QPaintEvent *event) override;
   void keyPressEvent(QKeyEvent *e) override;
   void mouseReleaseEvent(QMouseEvent *e) override;
+  void mouseMoveEvent(QMouseEvent *e) override;
   void contextMenuEvent(QContextMenuEvent *e) override;
 
  private slots:
@@ -113,12 +115,14 @@ class CollectionView : public AutoExpandingTreeView {
   void NoShowInVarious();
   void Delete();
   void DeleteFilesFinished(const SongList &songs_with_errors);
+  void PrefetchVisible();
 
  private:
   void RecheckIsEmpty();
   void SetShowInVarious(const bool on);
   bool RestoreLevelFocus(const QModelIndex &parent = QModelIndex());
   void SaveContainerPath(const QModelIndex &child);
+  void Prefetch(const QModelIndex &idx);
 
  private:
   Application *app_;
@@ -157,6 +161,9 @@ class CollectionView : public AutoExpandingTreeView {
   bool is_in_keyboard_search_;
   bool delete_files_;
 
+  // Prefetches the children of the visible collapsed items after scrolling or expanding.
+  QTimer *prefetch_timer_;
+
   // Save focus
   Song last_selected_song_;
   QString last_selected_container_;
@@ -28,7 +28,6 @@
 #include <QThread>
 #include <QIODevice>
 #include <QDir>
-#include <QDirIterator>
 #include <QFile>
 #include <QFileInfo>
 #include <QMetaObject>
@@ -41,28 +40,32 @@
 #include <QString>
 #include <QStringList>
 #include <QUrl>
-#include <QImage>
+#include <QElapsedTimer>
+#include <QImageReader>
+#include <QSize>
+#include <QByteArray>
+#include <QCryptographicHash>
 #include <QSettings>
 
 #include "core/filesystemwatcherinterface.h"
 #include "core/logging.h"
 #include "core/tagreaderclient.h"
+#include "core/trace.h"
 #include "core/taskmanager.h"
 #include "core/settings.h"
+#include "utilities/fileutils.h"
 #include "utilities/imageutils.h"
+#include "utilities/mimeutils.h"
 #include "utilities/timeconstants.h"
 #include "collectiondirectory.h"
 #include "collectionbackend.h"
 #include "collectionwatcher.h"
+#include "collectionscanstatistics.h"
 #include "playlistparsers/cueparser.h"
 #include "settings/collectionsettingspage.h"
-#include "engine/ebur128measures.h"
 #ifdef HAVE_SONGFINGERPRINTING
 #  include "engine/chromaprinter.h"
 #endif
-#ifdef HAVE_EBUR128
-#  include "engine/ebur128analysis.h"
-#endif
 
 // This is defined by one of the windows headers that is included by taglib.
 #ifdef RemoveDirectory
@@ -71,6 +74,17 @@
 
 using namespace std::chrono_literals;
 
+namespace {
+constexpr int kReadFilesBatchSize = 8;
+constexpr int kReadFilesBatchesPerWorker = 2;
+constexpr int kReadDirectoryMinimumFiles = 16;
+constexpr int kNewSongsCommitBatchSize = 500;
+constexpr int kScanCheckpointInterval = 100;
+constexpr qint64 kScanJournalMaxAge = 7 * 86400;
+constexpr qint64 kTaskDetailsUpdateInterval = 1000;
+constexpr quint64 kDirectoryListingsMaxEntries = 200000;
+}  // namespace
+
 QStringList CollectionWatcher::sValidImages = QStringList() << QStringLiteral("jpg") << QStringLiteral("png") << QStringLiteral("gif") << QStringLiteral("jpeg");
 QStringList CollectionWatcher::kIgnoredExtensions = QStringList() << QStringLiteral("tmp") << QStringLiteral("tar") << QStringLiteral("gz") << QStringLiteral("bz2") << QStringLiteral("xz") << QStringLiteral("tbz") << QStringLiteral("tgz") << QStringLiteral("z") << QStringLiteral("zip") << QStringLiteral("rar");
 
@@ -84,13 +98,14 @@ CollectionWatcher::CollectionWatcher(Song::Source source, QObject *parent)
       scan_on_startup_(true),
       monitor_(true),
       song_tracking_(false),
-      song_ebur128_loudness_analysis_(false),
       mark_songs_unavailable_(source_ == Song::Source::Collection),
       expire_unavailable_songs_days_(60),
+      content_hash_change_detection_(false),
       overwrite_playcount_(false),
       overwrite_rating_(false),
       stop_requested_(false),
       abort_requested_(false),
+      resume_scan_queued_(false),
       rescan_timer_(new QTimer(this)),
       periodic_scan_timer_(new QTimer(this)),
       rescan_paused_(false),
@@ -116,6 +131,7 @@ CollectionWatcher::CollectionWatcher(Song::Source source, QObject *parent)
   ReloadSettings();
 
   QObject::connect(fs_watcher_, &FileSystemWatcherInterface::PathChanged, this, &CollectionWatcher::DirectoryChanged, Qt::UniqueConnection);
+  QObject::connect(fs_watcher_, &FileSystemWatcherInterface::PathsChanged, this, &CollectionWatcher::DirectoriesChanged, Qt::UniqueConnection);
   QObject::connect(rescan_timer_, &QTimer::timeout, this, &CollectionWatcher::RescanPathsNow);
   QObject::connect(periodic_scan_timer_, &QTimer::timeout, this, &CollectionWatcher::IncrementalScanCheck);
 
@@ -158,13 +174,13 @@ void CollectionWatcher::ReloadSettings() {
   const QStringList filters = s.value("cover_art_patterns", QStringList() << QStringLiteral("front") << QStringLiteral("cover")).toStringList();
   if (source_ == Song::Source::Collection) {
     song_tracking_ = s.value("song_tracking", false).toBool();
-    song_ebur128_loudness_analysis_ = s.value("song_ebur128_loudness_analysis", false).toBool();
     mark_songs_unavailable_ = song_tracking_ ? true : s.value("mark_songs_unavailable", true).toBool();
+    content_hash_change_detection_ = s.value("content_hash_change_detection", false).toBool();
   }
   else {
     song_tracking_ = false;
-    song_ebur128_loudness_analysis_ = false;
     mark_songs_unavailable_ = false;
+    content_hash_change_detection_ = false;
   }
   expire_unavailable_songs_days_ = s.value("expire_unavailable_songs", 60).toInt();
   overwrite_playcount_ = s.value("overwrite_playcount", false).toBool();
@@ -209,9 +225,9 @@ CollectionWatcher::ScanTransaction::ScanTransaction(CollectionWatcher *watcher,
       expire_unavailable_songs_days_(60),
       watcher_(watcher),
       cached_songs_dirty_(true),
-      cached_songs_missing_fingerprint_dirty_(true),
-      cached_songs_missing_loudness_characteristics_dirty_(true),
-      known_subdirs_dirty_(true) {
+      known_subdirs_dirty_(true),
+      directory_listings_entries_(0),
+      fingerprint_song_ids_loaded_(false) {
 
   QString description;
 
@@ -231,9 +247,18 @@ CollectionWatcher::ScanTransaction::~ScanTransaction() {
 
   // If we're stopping then don't commit the transaction
   if (!watcher_->stop_requested_ && !watcher_->abort_requested_) {
+    CollectionScanStatistics::ScopedPhaseTimer phase_timer(&statistics_, CollectionScanStatistics::Phase::Commit);
     CommitNewOrUpdatedSongs();
   }
 
+  if (statistics_.directories_scanned() > 0) {
+    qLog(Debug) << "Collection scan statistics for directory ID" << dir_;
+    const QStringList summary_lines = statistics_.Summary().split(QLatin1Char('\n'));
+    for (const QString &line : summary_lines) {
+      qLog(Debug) << line.toUtf8().constData();
+    }
+  }
+
   watcher_->task_manager_->SetTaskFinished(task_id_);
 
 }
@@ -243,6 +268,11 @@ void CollectionWatcher::ScanTransaction::AddToProgress(const quint64 n) {
   progress_ += n;
   watcher_->task_manager_->SetTaskProgress(task_id_, progress_, progress_max_);
 
+  if (!details_timer_.isValid() || details_timer_.hasExpired(kTaskDetailsUpdateInterval)) {
+    watcher_->task_manager_->SetTaskDetails(task_id_, statistics_.ShortSummary());
+    details_timer_.start();
+  }
+
 }
 
 void CollectionWatcher::ScanTransaction::AddToProgressMax(const quint64 n) {
@@ -252,7 +282,7 @@ void CollectionWatcher::ScanTransaction::AddToProgressMax(const quint64 n) {
 
 }
 
-void CollectionWatcher::ScanTransaction::CommitNewOrUpdatedSongs() {
+void CollectionWatcher::ScanTransaction::CommitNewOrUpdatedSongs(const bool update_last_seen) {
 
   if (!deleted_songs.isEmpty()) {
     if (mark_songs_unavailable_ && watcher_->source() == Song::Source::Collection) {
@@ -305,12 +335,26 @@ void CollectionWatcher::ScanTransaction::CommitNewOrUpdatedSongs() {
   }
   new_subdirs.clear();
 
-  if (incremental_ || ignores_mtime_) {
+  if (update_last_seen && (incremental_ || ignores_mtime_)) {
     emit watcher_->UpdateLastSeen(dir_, expire_unavailable_songs_days_);
   }
 
 }
 
+void CollectionWatcher::ScanTransaction::CommitNewSongs() {
+
+  if (!new_songs.isEmpty()) {
+    emit watcher_->NewOrUpdatedSongs(new_songs);
+    new_songs.clear();
+  }
+
+  if (!touched_songs.isEmpty()) {
+    emit watcher_->SongsMTimeUpdated(touched_songs);
+    touched_songs.clear();
+  }
+
+}
+
 
 SongList CollectionWatcher::ScanTransaction::FindSongsInSubdirectory(const QString &path) {
 
@@ -330,33 +374,34 @@ SongList CollectionWatcher::ScanTransaction::FindSongsInSubdirectory(const QStri
 
 }
 
-bool CollectionWatcher::ScanTransaction::HasSongsWithMissingFingerprint(const QString &path) {
+void CollectionWatcher::ScanTransaction::AddDirectoryListing(const QString &path, const QFileInfoList &entries) {
 
-  if (cached_songs_missing_fingerprint_dirty_) {
-    const SongList songs = watcher_->backend_->SongsWithMissingFingerprint(dir_);
-    for (const Song &song : songs) {
-      const QString p = song.url().toLocalFile().section(QLatin1Char('/'), 0, -2);
-      cached_songs_missing_fingerprint_.insert(p, song);
-    }
-    cached_songs_missing_fingerprint_dirty_ = false;
-  }
+  if (directory_listings_entries_ + static_cast<quint64>(entries.count()) > kDirectoryListingsMaxEntries) return;
 
-  return cached_songs_missing_fingerprint_.contains(path);
+  directory_listings_.insert(path, entries);
+  directory_listings_entries_ += static_cast<quint64>(entries.count());
 
 }
 
-bool CollectionWatcher::ScanTransaction::HasSongsWithMissingLoudnessCharacteristics(const QString &path) {
+bool CollectionWatcher::ScanTransaction::TakeDirectoryListing(const QString &path, QFileInfoList *entries) {
 
-  if (cached_songs_missing_loudness_characteristics_dirty_) {
-    const SongList songs = watcher_->backend_->SongsWithMissingLoudnessCharacteristics(dir_);
-    for (const Song &song : songs) {
-      const QString p = song.url().toLocalFile().section(QLatin1Char('/'), 0, -2);
-      cached_songs_missing_loudness_characteristics_.insert(p, song);
-    }
-    cached_songs_missing_loudness_characteristics_dirty_ = false;
+  if (!directory_listings_.contains(path)) return false;
+
+  *entries = directory_listings_.take(path);
+  directory_listings_entries_ -= static_cast<quint64>(entries->count());
+
+  return true;
+
+}
+
+QList<int> CollectionWatcher::ScanTransaction::FindSongIdsByFingerprint(const QString &fingerprint) {
+
+  if (!fingerprint_song_ids_loaded_) {
+    fingerprint_song_ids_ = watcher_->backend_->GetSongIdsByFingerprint();
+    fingerprint_song_ids_loaded_ = true;
   }
 
-  return cached_songs_missing_loudness_characteristics_.contains(path);
+  return fingerprint_song_ids_.values(fingerprint);
 
 }
 
@@ -436,14 +481,26 @@ void CollectionWatcher::AddDirectory(const CollectionDirectory &dir, const Colle
 
     last_scan_time_ = QDateTime::currentSecsSinceEpoch();
 
+    // A full scan was interrupted when the application last exited, resume it once all directories are added.
+    if (source_ == Song::Source::Collection && !resume_scan_queued_ && !stop_requested_ && !abort_requested_) {
+      qint64 scan_started = 0;
+      if (!backend_->ScanJournal(dir.id, &scan_started).isEmpty() && scan_started >= last_scan_time_ - kScanJournalMaxAge) {
+        resume_scan_queued_ = true;
+        QMetaObject::invokeMethod(this, &CollectionWatcher::ResumeFullScanNow, Qt::QueuedConnection);
+      }
+    }
+
   }
 
+  emit DirectoryScanned(dir.id);
   emit CompilationsNeedUpdating();
 
 }
 
 void CollectionWatcher::ScanSubdirectory(const QString &path, const CollectionSubdirectory &subdir, const quint64 files_count, ScanTransaction *t, const bool force_noincremental) {
 
+  TRACE_SCOPE("collection", "CollectionWatcher::ScanSubdirectory");
+
   QFileInfo path_info(path);
 
   // Do not scan symlinked dirs that are already in collection
@@ -456,20 +513,11 @@ void CollectionWatcher::ScanSubdirectory(const QString &path, const CollectionSu
     }
   }
 
-  bool songs_missing_fingerprint = false;
-  bool songs_missing_loudness_characteristics = false;
-#ifdef HAVE_SONGFINGERPRINTING
-  if (song_tracking_) {
-    songs_missing_fingerprint = t->HasSongsWithMissingFingerprint(path);
-  }
-#endif
-#ifdef HAVE_EBUR128
-  if (song_ebur128_loudness_analysis_) {
-    songs_missing_loudness_characteristics = t->HasSongsWithMissingLoudnessCharacteristics(path);
-  }
-#endif
+  // Use the listing from counting the files if there is one.
+  QFileInfoList entries;
+  const bool entries_listed = t->TakeDirectoryListing(path, &entries);
 
-  if (!t->ignores_mtime() && !force_noincremental && t->is_incremental() && subdir.mtime == path_info.lastModified().toSecsSinceEpoch() && !songs_missing_fingerprint && !songs_missing_loudness_characteristics) {
+  if (!t->ignores_mtime() && !force_noincremental && t->is_incremental() && subdir.mtime == path_info.lastModified().toSecsSinceEpoch()) {
     // The directory hasn't changed since last time
     t->AddToProgress(files_count);
     return;
@@ -488,14 +536,27 @@ void CollectionWatcher::ScanSubdirectory(const QString &path, const CollectionSu
     }
   }
 
+  QElapsedTimer directory_timer;
+  directory_timer.start();
+
+  // CUE sheets in this directory and their mtime, so we don't need to look for them for each file.
+  QHash<QString, quint64> cue_mtimes;
+
+  if (!entries_listed) {
+    entries = ListDirectory(path, t);
+  }
+
   // First we "quickly" get a list of the files in the directory that we think might be music.  While we're here, we also look for new subdirectories and possible album artwork.
-  QDirIterator it(path, QDir::Dirs | QDir::Files | QDir::NoDotAndDotDot);
-  while (it.hasNext()) {
+  for (const QFileInfo &child_info : std::as_const(entries)) {
 
     if (stop_requested_ || abort_requested_) return;
 
-    QString child(it.next());
-    QFileInfo child_info(child);
+    const QString child = child_info.filePath();
+
+    if (!child_info.isDir() && child_info.suffix().compare(QLatin1String("cue"), Qt::CaseInsensitive) == 0) {
+      const QDateTime cue_last_modified = child_info.lastModified();
+      cue_mtimes.insert(child, cue_last_modified.isValid() ? cue_last_modified.toSecsSinceEpoch() : 0);
+    }
 
     if (child_info.isDir()) {
       if (!t->HasSeenSubdir(child)) {
@@ -518,7 +579,7 @@ void CollectionWatcher::ScanSubdirectory(const QString &path, const CollectionSu
         album_art[dir_part] << child;
         t->AddToProgress(1);
       }
-      else if (TagReaderClient::Instance()->IsMediaFileBlocking(child)) {
+      else if (IsMediaFile(child, t)) {
         files_on_disk << child;
       }
       else {
@@ -529,19 +590,56 @@ void CollectionWatcher::ScanSubdirectory(const QString &path, const CollectionSu
 
   if (stop_requested_ || abort_requested_) return;
 
+  t->statistics()->AddFilesScanned(files_on_disk.count());
+
   // Ask the database for a list of files in this directory
   SongList songs_in_db = t->FindSongsInSubdirectory(path);
 
-  QSet<QString> cues_processed;
+  // Queue tag reading for the files we already know have to be read, so the tag reader workers process them in parallel while we go through the list below.
+  QStringList files_to_read;
+  for (const QString &file : std::as_const(files_on_disk)) {
+    const QString cue = FindCueFilename(file, cue_mtimes);
+    if (!cue.isEmpty() && GetMtimeForCue(cue, cue_mtimes) != 0) continue;
+    SongList matching_songs;
+    if (!FindSongsByPath(songs_in_db, file, &matching_songs)) {
+      files_to_read << file;
+      continue;
+    }
+    const Song &matching_song = matching_songs.first();
+    if (!t->ignores_mtime() && matching_song.mtime() == QFileInfo(file).lastModified().toSecsSinceEpoch()) continue;
+    // With content hash change detection, files with a different mtime but the same contents don't need to be read again.
+    if (content_hash_change_detection_ && !matching_song.has_cue() && !matching_song.content_hash().isEmpty() && ContentHashForFile(file) == matching_song.content_hash()) continue;
+    files_to_read << file;
+  }
+
+  // Chiptune collections have lots of tiny files, where a request per batch takes longer than parsing them.
+  QStringList chiptune_files;
+  for (const QString &file : std::as_const(files_to_read)) {
+    const QString suffix = QFileInfo(file).suffix();
+    if (suffix.compare(QLatin1String("spc"), Qt::CaseInsensitive) == 0 || suffix.compare(QLatin1String("vgm"), Qt::CaseInsensitive) == 0) {
+      chiptune_files << file;
+    }
+  }
+  if (chiptune_files.count() >= kReadDirectoryMinimumFiles) {
+    QueueReadDirectory(path, chiptune_files);
+    for (const QString &file : std::as_const(chiptune_files)) {
+      files_to_read.removeOne(file);
+    }
+  }
+
+  QueueReadFiles(files_to_read);
 
   // Now compare the list from the database with the list of files on disk
   QStringList files_on_disk_copy = files_on_disk;
   for (const QString &file : files_on_disk_copy) {
 
-    if (stop_requested_ || abort_requested_) return;
+    if (stop_requested_ || abort_requested_) {
+      ClearQueuedReadFiles();
+      return;
+    }
 
     // Associated CUE
-    QString new_cue = CueParser::FindCueFilename(file);
+    QString new_cue = FindCueFilename(file, cue_mtimes);
 
     SongList matching_songs;
     if (FindSongsByPath(songs_in_db, file, &matching_songs)) {  // Found matching song in DB by path.
@@ -560,12 +658,12 @@ void CollectionWatcher::ScanSubdirectory(const QString &path, const CollectionSu
       }
 
       // CUE sheet's path from collection (if any).
-      qint64 matching_song_cue_mtime = static_cast<qint64>(GetMtimeForCue(matching_song.cue_path()));
+      qint64 matching_song_cue_mtime = static_cast<qint64>(GetMtimeForCue(matching_song.cue_path(), cue_mtimes));
 
       // CUE sheet's path from this file (if any).
       qint64 new_cue_mtime = 0;
       if (!new_cue.isEmpty()) {
-        new_cue_mtime = static_cast<qint64>(GetMtimeForCue(new_cue));
+        new_cue_mtime = static_cast<qint64>(GetMtimeForCue(new_cue, cue_mtimes));
       }
 
       const bool cue_added = new_cue_mtime != 0 && !matching_song.has_cue();
@@ -575,54 +673,34 @@ void CollectionWatcher::ScanSubdirectory(const QString &path, const CollectionSu
       // Watch out for CUE songs which have their mtime equal to qMax(media_file_mtime, cue_sheet_mtime)
       bool changed = (matching_song.mtime() != qMax(fileinfo.lastModified().toSecsSinceEpoch(), matching_song_cue_mtime)) || cue_deleted || cue_added || cue_changed;
 
+      // If only the mtime changed, but the file contents are the same, just update the mtime.
+      const bool content_unchanged = content_hash_change_detection_ && !matching_song.has_cue() && new_cue_mtime == 0 && !matching_song.content_hash().isEmpty() && ContentHashForFile(file) == matching_song.content_hash();
+      const bool mtime_changed = content_unchanged && changed;
+      if (mtime_changed) {
+        changed = false;
+      }
+
       // Also want to look to see whether the album art has changed
-      const QUrl art_automatic = ArtForSong(file, album_art);
+      const QUrl art_automatic = ArtForSong(file, album_art, t);
       if (matching_song.art_automatic() != art_automatic || (!matching_song.art_automatic().isEmpty() && !matching_song.art_automatic_is_valid())) {
         changed = true;
       }
 
-      bool missing_fingerprint = false;
-      bool missing_loudness_characteristics = false;
-#ifdef HAVE_SONGFINGERPRINTING
-      if (song_tracking_ && matching_song.fingerprint().isEmpty()) {
-        missing_fingerprint = true;
-      }
-#endif
-#ifdef HAVE_EBUR128
-      if (song_ebur128_loudness_analysis_ && (!matching_song.ebur128_integrated_loudness_lufs() || !matching_song.ebur128_loudness_range_lu())) {
-        missing_loudness_characteristics = true;
-      }
-#endif
-
       if (changed) {
         qLog(Debug) << file << "has changed.";
       }
-      else if (missing_fingerprint) {
-        qLog(Debug) << file << "is missing fingerprint.";
-      }
-      else if (missing_loudness_characteristics) {
-        qLog(Debug) << file << "is missing EBU R 128 loudness characteristics.";
-      }
-
-      // The song's changed or missing fingerprint - create fingerprint and reread the metadata from file.
-      if (t->ignores_mtime() || changed || missing_fingerprint || missing_loudness_characteristics) {
-
-        QString fingerprint;
-#ifdef HAVE_SONGFINGERPRINTING
-        if (song_tracking_) {
-          Chromaprinter chromaprinter(file);
-          fingerprint = chromaprinter.CreateFingerprint();
-          if (fingerprint.isEmpty()) {
-            fingerprint = QStringLiteral("NONE");
-          }
-        }
-#endif
 
+      // The song's changed - reread the metadata from file.
+      // The fingerprint and EBU R 128 loudness characteristics are only kept when the audio is known to be the same,
+      // otherwise they're cleared and created again by the collection analysis queue.
+      if ((t->ignores_mtime() && !content_unchanged) || changed) {
+        const bool audio_unchanged = content_unchanged || (fileinfo.size() == matching_song.filesize() && matching_song.mtime() == qMax(fileinfo.lastModified().toSecsSinceEpoch(), matching_song_cue_mtime) && !cue_added && !cue_changed && !cue_deleted);
+        const QString fingerprint = audio_unchanged ? matching_song.fingerprint() : QString();
         if (new_cue.isEmpty() || new_cue_mtime == 0) {  // If no CUE or it's about to lose it.
-          UpdateNonCueAssociatedSong(file, fingerprint, matching_songs, art_automatic, cue_deleted, t);
+          UpdateNonCueAssociatedSong(file, fingerprint, audio_unchanged, matching_songs, art_automatic, cue_deleted, t);
         }
         else {  // If CUE associated.
-          UpdateCueAssociatedSongs(file, path, fingerprint, new_cue, art_automatic, matching_songs, t);
+          UpdateCueAssociatedSongs(file, path, fingerprint, audio_unchanged, new_cue, art_automatic, matching_songs, t);
         }
       }
 
@@ -632,6 +710,13 @@ void CollectionWatcher::ScanSubdirectory(const QString &path, const CollectionSu
         t->readded_songs << matching_songs;
       }
 
+      if (mtime_changed && !changed) {
+        qLog(Debug) << file << "has a new mtime, but the contents are unchanged.";
+        Song touched_song = matching_song;
+        touched_song.set_mtime(fileinfo.lastModified().toSecsSinceEpoch());
+        t->touched_songs << touched_song;
+      }
+
     }
     else {  // Search the DB by fingerprint.
       QString fingerprint;
@@ -644,7 +729,7 @@ void CollectionWatcher::ScanSubdirectory(const QString &path, const CollectionSu
         }
       }
 #endif
-      if (song_tracking_ && !fingerprint.isEmpty() && fingerprint != QStringLiteral("NONE") && FindSongsByFingerprint(file, fingerprint, &matching_songs)) {
+      if (song_tracking_ && !fingerprint.isEmpty() && fingerprint != QStringLiteral("NONE") && FindSongsByFingerprint(file, fingerprint, &matching_songs, t)) {
 
         // The song is in the database and still on disk.
         // Check the mtime to see if it's been changed since it was added.
@@ -675,23 +760,24 @@ void CollectionWatcher::ScanSubdirectory(const QString &path, const CollectionSu
         // CUE sheet's path from this file (if any).
         qint64 new_cue_mtime = 0;
         if (!new_cue.isEmpty()) {
-          new_cue_mtime = static_cast<qint64>(GetMtimeForCue(new_cue));
+          new_cue_mtime = static_cast<qint64>(GetMtimeForCue(new_cue, cue_mtimes));
         }
 
         // Get new album art
-        const QUrl art_automatic = ArtForSong(file, album_art);
+        const QUrl art_automatic = ArtForSong(file, album_art, t);
 
+        // The fingerprint matched, so the moved file has the same audio.
         if (new_cue.isEmpty() || new_cue_mtime == 0) {  // If no CUE or it's about to lose it.
-          UpdateNonCueAssociatedSong(file, fingerprint, matching_songs, art_automatic, matching_songs_has_cue && new_cue_mtime == 0, t);
+          UpdateNonCueAssociatedSong(file, fingerprint, true, matching_songs, art_automatic, matching_songs_has_cue && new_cue_mtime == 0, t);
         }
         else {  // If CUE associated.
-          UpdateCueAssociatedSongs(file, path, fingerprint, new_cue, art_automatic, matching_songs, t);
+          UpdateCueAssociatedSongs(file, path, fingerprint, true, new_cue, art_automatic, matching_songs, t);
         }
 
       }
       else {  // The song is on disk but not in the DB
 
-        const SongList songs = ScanNewFile(file, path, fingerprint, new_cue, &cues_processed);
+        const SongList songs = ScanNewFile(file, path, fingerprint, new_cue, t);
         if (songs.isEmpty()) {
           t->AddToProgress(1);
           continue;
@@ -700,7 +786,7 @@ void CollectionWatcher::ScanSubdirectory(const QString &path, const CollectionSu
         qLog(Debug) << file << "is new.";
 
         // Choose art for the song(s)
-        const QUrl art_automatic = ArtForSong(file, album_art);
+        const QUrl art_automatic = ArtForSong(file, album_art, t);
 
         for (Song song : songs) {
           song.set_directory_id(t->dir());
@@ -712,6 +798,16 @@ void CollectionWatcher::ScanSubdirectory(const QString &path, const CollectionSu
     t->AddToProgress(1);
   }
 
+  // Drop any requests that were not used, i.e. if the file turned out to be unchanged.
+  ClearQueuedReadFiles();
+
+  // The CUE sheets are only used by the files next to them, so they're not needed after this subdirectory.
+  t->cue_songs.clear();
+
+  if (t->new_songs.count() >= kNewSongsCommitBatchSize) {
+    t->CommitNewSongs();
+  }
+
   // Look for deleted songs
   for (const Song &song : std::as_const(songs_in_db)) {
     QString file = song.url().toLocalFile();
@@ -738,6 +834,8 @@ void CollectionWatcher::ScanSubdirectory(const QString &path, const CollectionSu
     t->deleted_subdirs << updated_subdir;
   }
 
+  t->statistics()->AddDirectory(path, directory_timer.nsecsElapsed());
+
   // Recurse into the new subdirs that we found
   for (const CollectionSubdirectory &my_new_subdir : std::as_const(my_new_subdirs)) {
     if (stop_requested_ || abort_requested_) return;
@@ -749,6 +847,7 @@ void CollectionWatcher::ScanSubdirectory(const QString &path, const CollectionSu
 void CollectionWatcher::UpdateCueAssociatedSongs(const QString &file,
                                                  const QString &path,
                                                  const QString &fingerprint,
+                                                 const bool audio_unchanged,
                                                  const QString &matching_cue,
                                                  const QUrl &art_automatic,
                                                  const SongList &old_cue_songs,
@@ -760,21 +859,14 @@ void CollectionWatcher::UpdateCueAssociatedSongs(const QString &file,
   }
 
   // Load new CUE songs
-  QFile cue_file(matching_cue);
-  if (!cue_file.exists()) return;
-  if (!cue_file.open(QIODevice::ReadOnly)) {
-    qLog(Error) << "Could not open CUE file" << matching_cue << "for reading:" << cue_file.errorString();
-    return;
-  }
-  const SongList songs = cue_parser_->Load(&cue_file, matching_cue, path, false);
-  cue_file.close();
+  SongList songs;
+  if (!LoadCueSongs(matching_cue, path, t, &songs)) return;
 
   // Update every song that's in the CUE and collection
   QSet<int> used_ids;
   for (Song new_cue_song : songs) {
     new_cue_song.set_source(source_);
     new_cue_song.set_directory_id(t->dir());
-    PerformEBUR128Analysis(new_cue_song);
     new_cue_song.set_fingerprint(fingerprint);
 
     if (sections_map.contains(new_cue_song.beginning_nanosec())) {  // Changed section
@@ -782,6 +874,10 @@ void CollectionWatcher::UpdateCueAssociatedSongs(const QString &file,
       new_cue_song.set_id(matching_cue_song.id());
       new_cue_song.set_art_automatic(art_automatic);
       new_cue_song.MergeUserSetData(matching_cue_song, true, true);
+      if (audio_unchanged) {
+        new_cue_song.set_ebur128_integrated_loudness_lufs(matching_cue_song.ebur128_integrated_loudness_lufs());
+        new_cue_song.set_ebur128_loudness_range_lu(matching_cue_song.ebur128_loudness_range_lu());
+      }
       AddChangedSong(file, matching_cue_song, new_cue_song, t);
       used_ids.insert(matching_cue_song.id());
     }
@@ -800,6 +896,7 @@ void CollectionWatcher::UpdateCueAssociatedSongs(const QString &file,
 
 void CollectionWatcher::UpdateNonCueAssociatedSong(const QString &file,
                                                    const QString &fingerprint,
+                                                   const bool audio_unchanged,
                                                    const SongList &matching_songs,
                                                    const QUrl &art_automatic,
                                                    const bool cue_deleted,
@@ -816,64 +913,65 @@ void CollectionWatcher::UpdateNonCueAssociatedSong(const QString &file,
   }
 
   Song song_on_disk(source_);
-  TagReaderClient::Instance()->ReadFileBlocking(file, &song_on_disk);
+  {
+    CollectionScanStatistics::ScopedPhaseTimer phase_timer(t->statistics(), CollectionScanStatistics::Phase::TagReading);
+    ReadSongFromFile(file, &song_on_disk);
+  }
+  t->statistics()->AddFileRead(song_on_disk.filesize());
   if (song_on_disk.is_valid()) {
     song_on_disk.set_source(source_);
     song_on_disk.set_directory_id(t->dir());
     song_on_disk.set_id(matching_song.id());
-    PerformEBUR128Analysis(song_on_disk);
     song_on_disk.set_fingerprint(fingerprint);
     song_on_disk.set_art_automatic(art_automatic);
+    if (content_hash_change_detection_) {
+      song_on_disk.set_content_hash(ContentHashForFile(file));
+    }
     song_on_disk.MergeUserSetData(matching_song, !overwrite_playcount_, !overwrite_rating_);
+    if (audio_unchanged) {
+      song_on_disk.set_ebur128_integrated_loudness_lufs(matching_song.ebur128_integrated_loudness_lufs());
+      song_on_disk.set_ebur128_loudness_range_lu(matching_song.ebur128_loudness_range_lu());
+    }
     AddChangedSong(file, matching_song, song_on_disk, t);
   }
 
 }
 
-SongList CollectionWatcher::ScanNewFile(const QString &file, const QString &path, const QString &fingerprint, const QString &matching_cue, QSet<QString> *cues_processed) {
+SongList CollectionWatcher::ScanNewFile(const QString &file, const QString &path, const QString &fingerprint, const QString &matching_cue, ScanTransaction *t) {
 
   SongList songs;
 
   quint64 matching_cue_mtime = GetMtimeForCue(matching_cue);
   if (matching_cue_mtime != 0) {  // If it's a CUE - create virtual tracks
 
-    // Don't process the same CUE many times
-    if (cues_processed->contains(matching_cue)) return songs;
-
-    QFile cue_file(matching_cue);
-    if (!cue_file.exists()) return songs;
-
-    if (!cue_file.open(QIODevice::ReadOnly)) {
-      qLog(Error) << "Could not open CUE file" << matching_cue << "for reading:" << cue_file.errorString();
-      return songs;
-    }
-
     // Ignore FILEs pointing to other media files.
     // Also, watch out for incorrect media files.
     // Playlist parser for CUEs considers every entry in sheet valid, and we don't want invalid media getting into collection!
     QString file_nfd = file.normalized(QString::NormalizationForm_D);
-    SongList cue_congs = cue_parser_->Load(&cue_file, matching_cue, path, false);
-    cue_file.close();
+    SongList cue_congs;
+    if (!LoadCueSongs(matching_cue, path, t, &cue_congs)) return songs;
     songs.reserve(cue_congs.count());
     for (Song &cue_song : cue_congs) {
       cue_song.set_source(source_);
-      PerformEBUR128Analysis(cue_song);
       cue_song.set_fingerprint(fingerprint);
       if (cue_song.url().toLocalFile().normalized(QString::NormalizationForm_D) == file_nfd) {
         songs << cue_song;
       }
     }
-    if (!songs.isEmpty()) {
-      *cues_processed << matching_cue;
-    }
   }
   else {  // It's a normal media file
     Song song(source_);
-    TagReaderClient::Instance()->ReadFileBlocking(file, &song);
+    {
+      CollectionScanStatistics::ScopedPhaseTimer phase_timer(t->statistics(), CollectionScanStatistics::Phase::TagReading);
+      ReadSongFromFile(file, &song);
+    }
+    t->statistics()->AddFileRead(song.filesize());
     if (song.is_valid()) {
       song.set_source(source_);
-      PerformEBUR128Analysis(song);
       song.set_fingerprint(fingerprint);
+      if (content_hash_change_detection_) {
+        song.set_content_hash(ContentHashForFile(file));
+      }
       songs << song;
     }
   }
@@ -882,6 +980,32 @@ SongList CollectionWatcher::ScanNewFile(const QString &file, const QString &path
 
 }
 
+bool CollectionWatcher::LoadCueSongs(const QString &cue_path, const QString &path, ScanTransaction *t, SongList *songs) {
+
+  if (t->cue_songs.contains(cue_path)) {
+    *songs = t->cue_songs.value(cue_path);
+    return true;
+  }
+
+  QFile cue_file(cue_path);
+  if (!cue_file.exists()) return false;
+  if (!cue_file.open(QIODevice::ReadOnly)) {
+    qLog(Error) << "Could not open CUE file" << cue_path << "for reading:" << cue_file.errorString();
+    return false;
+  }
+
+  {
+    CollectionScanStatistics::ScopedPhaseTimer phase_timer(t->statistics(), CollectionScanStatistics::Phase::CueParsing);
+    *songs = cue_parser_->Load(&cue_file, cue_path, path, false);
+  }
+  cue_file.close();
+
+  t->cue_songs.insert(cue_path, *songs);
+
+  return true;
+
+}
+
 void CollectionWatcher::AddChangedSong(const QString &file, const Song &matching_song, const Song &new_song, ScanTransaction *t) {
 
   bool notify_new = false;
@@ -950,17 +1074,137 @@ void CollectionWatcher::AddChangedSong(const QString &file, const Song &matching
 
 }
 
-void CollectionWatcher::PerformEBUR128Analysis(Song &song) const {
+void CollectionWatcher::QueueReadFiles(const QStringList &files) {
 
-  if (!song_ebur128_loudness_analysis_) return;
+  readfile_queue_ << files;
+  SendQueuedReadFiles();
+
+}
 
-#ifdef HAVE_EBUR128
-  std::optional<EBUR128Measures> loudness_characteristics = EBUR128Analysis::Compute(song);
-  if (loudness_characteristics) {
-    song.set_ebur128_integrated_loudness_lufs(loudness_characteristics->loudness_lufs);
-    song.set_ebur128_loudness_range_lu(loudness_characteristics->range_lu);
+void CollectionWatcher::SendQueuedReadFiles() {
+
+  // Keep a limited number of batches per worker in flight, so huge directories don't flood the workers.
+  const int max_batches = TagReaderClient::Instance()->worker_count() * kReadFilesBatchesPerWorker;
+  while (!readfile_queue_.isEmpty() && readfile_reply_files_count_.count() < max_batches) {
+    QStringList files;
+    while (!readfile_queue_.isEmpty() && files.count() < kReadFilesBatchSize) {
+      const QString file = readfile_queue_.takeFirst();
+      if (!readfile_replies_.contains(file) && !files.contains(file)) {
+        files << file;
+      }
+    }
+    if (files.isEmpty()) continue;
+    TagReaderReply *reply = TagReaderClient::Instance()->ReadFiles(files);
+    for (const QString &file : std::as_const(files)) {
+      readfile_replies_.insert(file, reply);
+    }
+    readfile_reply_files_count_.insert(reply, static_cast<int>(files.count()));
   }
-#endif
+
+}
+
+void CollectionWatcher::QueueReadDirectory(const QString &path, const QStringList &files) {
+
+  TagReaderReply *reply = TagReaderClient::Instance()->ReadDirectory(path);
+  for (const QString &file : files) {
+    readfile_replies_.insert(file, reply);
+  }
+  readfile_reply_files_count_.insert(reply, static_cast<int>(files.count()));
+
+}
+
+void CollectionWatcher::ReadSongFromFile(const QString &file, Song *song) {
+
+  TagReaderReply *reply = readfile_replies_.take(file);
+  if (reply) {
+    if (reply->WaitForFinished()) {
+      if (reply->request_message().has_read_directory_request()) {
+        const QByteArray url = QUrl::fromLocalFile(file).toEncoded();
+        for (const spb::tagreader::SongMetadata &metadata : reply->message().read_directory_response().metadata()) {
+          if (metadata.url() == url.constData()) {
+            song->InitFromProtobuf(metadata);
+            break;
+          }
+        }
+      }
+      else {
+        const spb::tagreader::ReadFilesRequest &request = reply->request_message().read_files_request();
+        const spb::tagreader::ReadFilesResponse &response = reply->message().read_files_response();
+        const QByteArray filename_data = file.toUtf8();
+        for (int i = 0; i < request.filenames_size() && i < response.metadata_size(); ++i) {
+          if (request.filenames(i) == filename_data.constData()) {
+            song->InitFromProtobuf(response.metadata(i));
+            break;
+          }
+        }
+      }
+    }
+    // The reply is shared by all files in the batch, delete it when the last one has been read.
+    if (--readfile_reply_files_count_[reply] == 0) {
+      readfile_reply_files_count_.remove(reply);
+      reply->deleteLater();
+    }
+  }
+  else {
+    readfile_queue_.removeAll(file);
+    TagReaderClient::Instance()->ReadFileBlocking(file, song, TagReaderClient::ReadLevel::Full, TagReaderClient::Priority::Background);
+  }
+
+  SendQueuedReadFiles();
+
+}
+
+void CollectionWatcher::ClearQueuedReadFiles() {
+
+  readfile_queue_.clear();
+  readfile_replies_.clear();
+
+  const QList<TagReaderReply*> replies = readfile_reply_files_count_.keys();
+  for (TagReaderReply *reply : replies) {
+    if (reply->is_finished()) {
+      reply->deleteLater();
+    }
+    else {
+      // Drop it if it hasn't been sent to a worker yet.  The handler still holds on to the reply, so it can only be deleted when it's finished.
+      reply->Cancel();
+      QObject::connect(reply, &TagReaderReply::Finished, reply, &TagReaderReply::deleteLater);
+    }
+  }
+  readfile_reply_files_count_.clear();
+  content_hashes_.clear();
+
+}
+
+QString CollectionWatcher::ContentHashForFile(const QString &file) {
+
+  if (!content_hashes_.contains(file)) {
+    content_hashes_.insert(file, Utilities::FileContentHash(file));
+  }
+
+  return content_hashes_.value(file);
+
+}
+
+QString CollectionWatcher::FindCueFilename(const QString &filename, const QHash<QString, quint64> &cue_mtimes) {
+
+  const QStringList cue_files = QStringList() << filename + QStringLiteral(".cue")
+                                              << filename.section(QLatin1Char('.'), 0, -2) + QStringLiteral(".cue");
+
+  for (const QString &cuefile : cue_files) {
+    if (cue_mtimes.contains(cuefile)) return cuefile;
+  }
+
+  return QString();
+
+}
+
+quint64 CollectionWatcher::GetMtimeForCue(const QString &cue_path, const QHash<QString, quint64> &cue_mtimes) {
+
+  if (cue_mtimes.contains(cue_path)) {
+    return cue_mtimes.value(cue_path);
+  }
+
+  return GetMtimeForCue(cue_path);
 
 }
 
@@ -1027,9 +1271,13 @@ bool CollectionWatcher::FindSongsByPath(const SongList &songs, const QString &pa
 
 }
 
-bool CollectionWatcher::FindSongsByFingerprint(const QString &file, const QString &fingerprint, SongList *out) {
+bool CollectionWatcher::FindSongsByFingerprint(const QString &file, const QString &fingerprint, SongList *out, ScanTransaction *t) {
+
+  // Only files with a fingerprint that's already in the database need a query, to get the matching songs.
+  const QList<int> song_ids = t->FindSongIdsByFingerprint(fingerprint);
+  if (song_ids.isEmpty()) return false;
 
-  SongList songs = backend_->GetSongsByFingerprint(fingerprint);
+  SongList songs = backend_->GetSongsById(song_ids);
   for (const Song &song : std::as_const(songs)) {
     QString filename = song.url().toLocalFile();
     QFileInfo info(filename);
@@ -1076,6 +1324,14 @@ void CollectionWatcher::DirectoryChanged(const QString &subdir) {
 
 }
 
+void CollectionWatcher::DirectoriesChanged(const QStringList &subdirs) {
+
+  for (const QString &subdir : subdirs) {
+    DirectoryChanged(subdir);
+  }
+
+}
+
 void CollectionWatcher::RescanPathsNow() {
 
   const QList<int> dirs = rescan_queue_.keys();
@@ -1104,11 +1360,14 @@ void CollectionWatcher::RescanPathsNow() {
 
   rescan_queue_.clear();
 
+  for (const int dir : dirs) {
+    emit DirectoryScanned(dir);
+  }
   emit CompilationsNeedUpdating();
 
 }
 
-QString CollectionWatcher::PickBestArt(const QStringList &art_automatic_list) {
+QString CollectionWatcher::PickBestArt(const QStringList &art_automatic_list, QSize *best_size) {
 
   // This is used when there is more than one image in a directory.
   // Pick the biggest image that matches the most important filter
@@ -1140,13 +1399,16 @@ QString CollectionWatcher::PickBestArt(const QStringList &art_automatic_list) {
   for (const QString &path : std::as_const(filtered)) {
     if (stop_requested_ || abort_requested_) break;
 
-    QImage image(path);
-    if (image.isNull()) continue;
+    // Only the header is read for the size, the images aren't decoded.
+    QImageReader reader(path);
+    const QSize image_size = reader.size();
+    if (!image_size.isValid()) continue;
 
-    int size = image.width() * image.height();
+    int size = image_size.width() * image_size.height();
     if (size > biggest_size) {
       biggest_size = size;
       biggest_path = path;
+      *best_size = image_size;
     }
   }
 
@@ -1154,7 +1416,45 @@ QString CollectionWatcher::PickBestArt(const QStringList &art_automatic_list) {
 
 }
 
-QUrl CollectionWatcher::ArtForSong(const QString &path, QMap<QString, QStringList> &art_automatic_list) {
+QString CollectionWatcher::AlbumArtHash(const QStringList &art_automatic_list) const {
+
+  QStringList paths = art_automatic_list;
+  paths.sort();
+
+  QCryptographicHash hash(QCryptographicHash::Sha1);
+  for (const QString &path : std::as_const(paths)) {
+    const QFileInfo fileinfo(path);
+    hash.addData(path.toUtf8());
+    hash.addData(QByteArray::number(fileinfo.size()));
+    hash.addData(QByteArray::number(fileinfo.lastModified().toSecsSinceEpoch()));
+  }
+  for (const QString &filter_text : best_art_filters_) {
+    hash.addData(filter_text.toUtf8());
+  }
+
+  return QString::fromLatin1(hash.result().toHex());
+
+}
+
+bool CollectionWatcher::IsMediaFile(const QString &file, ScanTransaction *t) {
+
+  CollectionScanStatistics::ScopedPhaseTimer phase_timer(t->statistics(), CollectionScanStatistics::Phase::MediaFileDetection);
+
+  // Most files can be decided by extension and file signature, only ask the tagreader for the others.
+  switch (Utilities::GuessMediaFile(file)) {
+    case Utilities::MediaFileGuess::MediaFile:
+      return true;
+    case Utilities::MediaFileGuess::NotMediaFile:
+      return false;
+    case Utilities::MediaFileGuess::Unknown:
+      break;
+  }
+
+  return TagReaderClient::Instance()->IsMediaFileBlocking(file, TagReaderClient::Priority::Background);
+
+}
+
+QUrl CollectionWatcher::ArtForSong(const QString &path, QMap<QString, QStringList> &art_automatic_list, ScanTransaction *t) {
 
   QString dir(DirectoryPart(path));
 
@@ -1163,7 +1463,17 @@ QUrl CollectionWatcher::ArtForSong(const QString &path, QMap<QString, QStringLis
       return QUrl::fromLocalFile(art_automatic_list[dir][0]);
     }
     else {
-      const QString best_art = PickBestArt(art_automatic_list[dir]);
+      CollectionScanStatistics::ScopedPhaseTimer phase_timer(t->statistics(), CollectionScanStatistics::Phase::AlbumArt);
+      // The image picked last time is used as long as the images in the directory and the filters are the same.
+      const QString hash = AlbumArtHash(art_automatic_list[dir]);
+      QString best_art = backend_->BestAlbumArt(dir, hash);
+      if (best_art.isEmpty()) {
+        QSize best_size;
+        best_art = PickBestArt(art_automatic_list[dir], &best_size);
+        if (!best_art.isEmpty() && !stop_requested_ && !abort_requested_) {
+          emit BestAlbumArtPicked(dir, best_art, hash, best_size.width(), best_size.height());
+        }
+      }
       art_automatic_list[dir] = QStringList() << best_art;
       return QUrl::fromLocalFile(best_art);
     }
@@ -1212,33 +1522,97 @@ void CollectionWatcher::IncrementalScanNow() { PerformScan(true, false); }
 
 void CollectionWatcher::FullScanNow() { PerformScan(false, true); }
 
-void CollectionWatcher::PerformScan(const bool incremental, const bool ignore_mtimes) {
+void CollectionWatcher::ResumeFullScanNow() {
+
+  resume_scan_queued_ = false;
+  PerformScan(false, true, true);
+
+}
+
+void CollectionWatcher::PerformScan(const bool incremental, const bool ignore_mtimes, const bool resume) {
+
+  TRACE_SCOPE("collection", "CollectionWatcher::PerformScan");
 
   stop_requested_ = false;
 
+  // Full scans of the collection are journaled, so a scan interrupted by exiting can resume on the next startup after the subdirectories it already committed.
+  // A full scan requested by the user always starts over.
+  const bool use_scan_journal = ignore_mtimes && source_ == Song::Source::Collection;
+  const qint64 scan_started = QDateTime::currentSecsSinceEpoch();
+
   for (const CollectionDirectory &dir : std::as_const(watched_dirs_)) {
 
     if (stop_requested_ || abort_requested_) break;
 
-    ScanTransaction transaction(this, dir.id, incremental, ignore_mtimes, mark_songs_unavailable_);
-    CollectionSubdirectoryList subdirs(transaction.GetAllSubdirs());
-
-    if (subdirs.isEmpty()) {
-      qLog(Debug) << "Collection directory wasn't in subdir list.";
-      CollectionSubdirectory subdir;
-      subdir.path = dir.path;
-      subdir.directory_id = dir.id;
-      subdirs << subdir;
+    qint64 journal_scan_started = scan_started;
+    QSet<QString> scanned_subdirs;
+    if (use_scan_journal) {
+      if (resume) {
+        const QStringList journal = backend_->ScanJournal(dir.id, &journal_scan_started);
+        if (journal.isEmpty()) continue;
+        if (journal_scan_started < scan_started - kScanJournalMaxAge) {
+          qLog(Debug) << "Discarding scan journal of" << dir.path << "from an old scan.";
+          emit ScanCompleted(dir.id);
+          continue;
+        }
+        for (const QString &path : journal) {
+          scanned_subdirs << path;
+        }
+        qLog(Debug) << "Resuming interrupted scan of" << dir.path << "after" << scanned_subdirs.count() << "subdirectories.";
+      }
+      else {
+        emit ScanStarted(dir.id);
+      }
     }
 
-    QMap<QString, quint64> subdir_files_count;
-    quint64 files_count = FilesCountForSubdirs(&transaction, subdirs, subdir_files_count);
-    transaction.AddToProgressMax(files_count);
+    {
+      ScanTransaction transaction(this, dir.id, incremental, ignore_mtimes, mark_songs_unavailable_);
+      CollectionSubdirectoryList subdirs(transaction.GetAllSubdirs());
 
-    for (const CollectionSubdirectory &subdir : std::as_const(subdirs)) {
-      if (stop_requested_ || abort_requested_) break;
-      ScanSubdirectory(subdir.path, subdir, subdir_files_count[subdir.path], &transaction);
+      if (subdirs.isEmpty()) {
+        qLog(Debug) << "Collection directory wasn't in subdir list.";
+        CollectionSubdirectory subdir;
+        subdir.path = dir.path;
+        subdir.directory_id = dir.id;
+        subdirs << subdir;
+      }
+
+      QMap<QString, quint64> subdir_files_count;
+      quint64 files_count = FilesCountForSubdirs(&transaction, subdirs, subdir_files_count);
+      transaction.AddToProgressMax(files_count);
+
+      QStringList checkpoint_subdirs;
+      for (const CollectionSubdirectory &subdir : std::as_const(subdirs)) {
+        if (stop_requested_ || abort_requested_) break;
+        if (scanned_subdirs.contains(subdir.path)) {
+          transaction.AddToProgress(subdir_files_count[subdir.path]);
+          continue;
+        }
+        ScanSubdirectory(subdir.path, subdir, subdir_files_count[subdir.path], &transaction);
+        if (use_scan_journal && !stop_requested_ && !abort_requested_) {
+          checkpoint_subdirs << subdir.path;
+          if (checkpoint_subdirs.count() >= kScanCheckpointInterval) {
+            // Commit what we have so far before recording the subdirectories as completed.
+            transaction.CommitNewOrUpdatedSongs(false);
+            emit ScanCheckpoint(dir.id, journal_scan_started, checkpoint_subdirs);
+            checkpoint_subdirs.clear();
+          }
+        }
+      }
+
+      if (stop_requested_ || abort_requested_) {
+        if (!checkpoint_subdirs.isEmpty()) {
+          transaction.CommitNewOrUpdatedSongs(false);
+          emit ScanCheckpoint(dir.id, journal_scan_started, checkpoint_subdirs);
+        }
+        break;
+      }
+    }
+
+    if (use_scan_journal) {
+      emit ScanCompleted(dir.id);
     }
+    emit DirectoryScanned(dir.id);
 
   }
 
@@ -1248,16 +1622,25 @@ void CollectionWatcher::PerformScan(const bool incremental, const bool ignore_mt
 
 }
 
+QFileInfoList CollectionWatcher::ListDirectory(const QString &path, ScanTransaction *t) {
+
+  CollectionScanStatistics::ScopedPhaseTimer phase_timer(t->statistics(), CollectionScanStatistics::Phase::DirectoryListing);
+  return QDir(path).entryInfoList(QDir::Dirs | QDir::Files | QDir::NoDotAndDotDot, QDir::NoSort);
+
+}
+
 quint64 CollectionWatcher::FilesCountForPath(ScanTransaction *t, const QString &path) {
 
+  // Keep the listing, so ScanSubdirectory doesn't need to list the directory again.
+  const QFileInfoList entries = ListDirectory(path, t);
+  t->AddDirectoryListing(path, entries);
+
   quint64 i = 0;
-  QDirIterator it(path, QDir::Dirs | QDir::Files | QDir::NoDotAndDotDot);
-  while (it.hasNext()) {
+  for (const QFileInfo &path_info : entries) {
 
     if (stop_requested_ || abort_requested_) break;
 
-    QString child = it.next();
-    QFileInfo path_info(child);
+    const QString child = path_info.filePath();
 
     if (path_info.isDir()) {
       if (path_info.isSymLink()) {
@@ -1309,6 +1692,7 @@ void CollectionWatcher::RescanSongs(const SongList &songs) {
   stop_requested_ = false;
 
   QStringList scanned_paths;
+  QSet<int> scanned_dirs;
   for (const Song &song : songs) {
     if (stop_requested_ || abort_requested_) break;
     const QString song_path = song.url().toLocalFile().section(QLatin1Char('/'), 0, -2);
@@ -1322,9 +1706,13 @@ void CollectionWatcher::RescanSongs(const SongList &songs) {
       quint64 files_count = FilesCountForPath(&transaction, subdir.path);
       ScanSubdirectory(song_path, subdir, files_count, &transaction);
       scanned_paths << subdir.path;
+      scanned_dirs << song.directory_id();
     }
   }
 
+  for (const int dir : std::as_const(scanned_dirs)) {
+    emit DirectoryScanned(dir);
+  }
   emit CompilationsNeedUpdating();
 
 }
@@ -33,10 +33,15 @@
 #include <QString>
 #include <QStringList>
 #include <QUrl>
+#include <QElapsedTimer>
+#include <QFileInfo>
+#include <QSize>
 
 #include "collectiondirectory.h"
+#include "collectionscanstatistics.h"
 #include "core/shared_ptr.h"
 #include "core/song.h"
+#include "core/tagreaderclient.h"
 
 class QThread;
 class QTimer;
@@ -81,6 +86,12 @@ class CollectionWatcher : public QObject {
   void SubdirsMTimeUpdated(const CollectionSubdirectoryList &subdirs);
   void CompilationsNeedUpdating();
   void UpdateLastSeen(const int directory_id, const int expire_unavailable_songs_days);
+  void ScanStarted(const int directory_id);
+  void ScanCheckpoint(const int directory_id, const qint64 scan_started, const QStringList &paths);
+  void ScanCompleted(const int directory_id);
+  void BestAlbumArtPicked(const QString &directory, const QString &path, const QString &hash, const int width, const int height);
+  // Emitted after songs in the directory were scanned and committed, also for partial rescans.
+  void DirectoryScanned(const int directory_id);
   void ExitFinished();
 
   void ScanStarted(const int task_id);
@@ -103,10 +114,13 @@ class CollectionWatcher : public QObject {
     ~ScanTransaction();
 
     SongList FindSongsInSubdirectory(const QString &path);
-    bool HasSongsWithMissingFingerprint(const QString &path);
-    bool HasSongsWithMissingLoudnessCharacteristics(const QString &path);
     bool HasSeenSubdir(const QString &path);
     void SetKnownSubdirs(const CollectionSubdirectoryList &subdirs);
+    // Directory listings made while counting the files, so the directories are only listed once per scan.
+    void AddDirectoryListing(const QString &path, const QFileInfoList &entries);
+    bool TakeDirectoryListing(const QString &path, QFileInfoList *entries);
+    // The fingerprints of the songs in the database are loaded once for each transaction, when the first file is looked up.
+    QList<int> FindSongIdsByFingerprint(const QString &fingerprint);
     CollectionSubdirectoryList GetImmediateSubdirs(const QString &path);
     CollectionSubdirectoryList GetAllSubdirs();
 
@@ -114,11 +128,16 @@ class CollectionWatcher : public QObject {
     void AddToProgressMax(const quint64 n);
 
     // Emits the signals for new & deleted songs etc and clears the lists. This causes the new stuff to be updated on UI.
-    void CommitNewOrUpdatedSongs();
+    void CommitNewOrUpdatedSongs(const bool update_last_seen = true);
+
+    // Emits only the new and touched songs collected so far, used to commit large scans in batches.
+    // Deleted songs are kept until the end, since a song might turn up again under a different path.
+    void CommitNewSongs();
 
     int dir() const { return dir_; }
     bool is_incremental() const { return incremental_; }
     bool ignores_mtime() const { return ignores_mtime_; }
+    CollectionScanStatistics *statistics() { return &statistics_; }
 
     SongList deleted_songs;
     SongList readded_songs;
@@ -130,6 +149,9 @@ class CollectionWatcher : public QObject {
 
     QStringList files_changed_path_;
 
+    // CUE sheets parsed in the subdirectory being scanned.
+    QHash<QString, SongList> cue_songs;
+
    private:
     ScanTransaction(const ScanTransaction&) {}
     ScanTransaction &operator=(const ScanTransaction&) { return *this; }
@@ -156,57 +178,81 @@ class CollectionWatcher : public QObject {
     QMultiMap<QString, Song> cached_songs_;
     bool cached_songs_dirty_;
 
-    QMultiMap<QString, Song> cached_songs_missing_fingerprint_;
-    bool cached_songs_missing_fingerprint_dirty_;
-
-    QMultiMap<QString, Song> cached_songs_missing_loudness_characteristics_;
-    bool cached_songs_missing_loudness_characteristics_dirty_;
+    CollectionScanStatistics statistics_;
+    QElapsedTimer details_timer_;
 
     CollectionSubdirectoryList known_subdirs_;
     bool known_subdirs_dirty_;
+
+    QHash<QString, QFileInfoList> directory_listings_;
+    quint64 directory_listings_entries_;
+
+    QMultiHash<QString, int> fingerprint_song_ids_;
+    bool fingerprint_song_ids_loaded_;
   };
 
  private slots:
   void ReloadSettings();
   void Exit();
   void DirectoryChanged(const QString &subdir);
+  void DirectoriesChanged(const QStringList &subdirs);
   void IncrementalScanCheck();
   void IncrementalScanNow();
   void FullScanNow();
+  void ResumeFullScanNow();
   void RescanPathsNow();
   void ScanSubdirectory(const QString &path, const CollectionSubdirectory &subdir, const quint64 files_count, CollectionWatcher::ScanTransaction *t, const bool force_noincremental = false);
   void RescanSongs(const SongList &songs);
 
  private:
   static bool FindSongsByPath(const SongList &songs, const QString &path, SongList *out);
-  bool FindSongsByFingerprint(const QString &file, const QString &fingerprint, SongList *out);
+  bool FindSongsByFingerprint(const QString &file, const QString &fingerprint, SongList *out, ScanTransaction *t);
   static bool FindSongsByFingerprint(const QString &file, const SongList &songs, const QString &fingerprint, SongList *out);
   inline static QString NoExtensionPart(const QString &fileName);
   inline static QString ExtensionPart(const QString &fileName);
   inline static QString DirectoryPart(const QString &fileName);
-  QString PickBestArt(const QStringList &art_automatic_list);
-  QUrl ArtForSong(const QString &path, QMap<QString, QStringList> &art_automatic_list);
+  QString PickBestArt(const QStringList &art_automatic_list, QSize *best_size);
+  // Changes when images are added, removed or modified, or when the filters for picking the best art change.
+  QString AlbumArtHash(const QStringList &art_automatic_list) const;
+  QUrl ArtForSong(const QString &path, QMap<QString, QStringList> &art_automatic_list, ScanTransaction *t);
+  bool IsMediaFile(const QString &file, ScanTransaction *t);
+  QFileInfoList ListDirectory(const QString &path, ScanTransaction *t);
   void AddWatch(const CollectionDirectory &dir, const QString &path);
   void RemoveWatch(const CollectionDirectory &dir, const CollectionSubdirectory &subdir);
   static quint64 GetMtimeForCue(const QString &cue_path);
-  void PerformScan(const bool incremental, const bool ignore_mtimes);
+  // Same as above, but uses the CUE sheets found when listing the directory.
+  static quint64 GetMtimeForCue(const QString &cue_path, const QHash<QString, quint64> &cue_mtimes);
+  void PerformScan(const bool incremental, const bool ignore_mtimes, const bool resume = false);
 
   // Updates the sections of a cue associated and altered (according to mtime) media file during a scan.
-  void UpdateCueAssociatedSongs(const QString &file, const QString &path, const QString &fingerprint, const QString &matching_cue, const QUrl &art_automatic, const SongList &old_cue_songs, ScanTransaction *t);
+  // The EBU R 128 loudness characteristics are only kept if the audio is unchanged.
+  void UpdateCueAssociatedSongs(const QString &file, const QString &path, const QString &fingerprint, const bool audio_unchanged, const QString &matching_cue, const QUrl &art_automatic, const SongList &old_cue_songs, ScanTransaction *t);
   // Updates a single non-cue associated and altered (according to mtime) song during a scan.
-  void UpdateNonCueAssociatedSong(const QString &file, const QString &fingerprint, const SongList &matching_songs, const QUrl &art_automatic, const bool cue_deleted, ScanTransaction *t);
+  void UpdateNonCueAssociatedSong(const QString &file, const QString &fingerprint, const bool audio_unchanged, const SongList &matching_songs, const QUrl &art_automatic, const bool cue_deleted, ScanTransaction *t);
   // Scans a single media file that's present on the disk but not yet in the collection.
   // It may result in a multiple files added to the collection when the media file has many sections (like a CUE related media file).
-  SongList ScanNewFile(const QString &file, const QString &path, const QString &fingerprint, const QString &matching_cue, QSet<QString> *cues_processed);
+  SongList ScanNewFile(const QString &file, const QString &path, const QString &fingerprint, const QString &matching_cue, ScanTransaction *t);
+  // Parses the CUE sheet, each CUE sheet is only parsed once per scan transaction.
+  bool LoadCueSongs(const QString &cue_path, const QString &path, ScanTransaction *t, SongList *songs);
 
   static void AddChangedSong(const QString &file, const Song &matching_song, const Song &new_song, ScanTransaction *t);
 
-  void PerformEBUR128Analysis(Song &song) const;
+  // Queues files for tag reading ahead of the scan, the files are sent in batches which are spread over all tag reader workers.
+  void QueueReadFiles(const QStringList &files);
+  void SendQueuedReadFiles();
+  // Reads all chiptune files in the directory with a single request, used for the files instead of a request per batch.
+  void QueueReadDirectory(const QString &path, const QStringList &files);
+  // Reads a song using the queued request for the file if there is one, otherwise reads it blocking.
+  void ReadSongFromFile(const QString &file, Song *song);
+  void ClearQueuedReadFiles();
+  // Returns the content hash of the file, computed once per scan of the subdirectory.
+  QString ContentHashForFile(const QString &file);
 
   quint64 FilesCountForPath(ScanTransaction *t, const QString &path);
   quint64 FilesCountForSubdirs(ScanTransaction *t, const CollectionSubdirectoryList &subdirs, QMap<QString, quint64> &subdir_files_count);
 
-  QString FindCueFilename(const QString &filename);
+  // Returns the CUE sheet for the media file from the CUE sheets found when listing the directory.
+  static QString FindCueFilename(const QString &filename, const QHash<QString, quint64> &cue_mtimes);
 
  private:
   Song::Source source_;
@@ -225,14 +271,15 @@ class CollectionWatcher : public QObject {
   bool scan_on_startup_;
   bool monitor_;
   bool song_tracking_;
-  bool song_ebur128_loudness_analysis_;
   bool mark_songs_unavailable_;
   int expire_unavailable_songs_days_;
+  bool content_hash_change_detection_;
   bool overwrite_playcount_;
   bool overwrite_rating_;
 
   bool stop_requested_;
   bool abort_requested_;
+  bool resume_scan_queued_;
 
   QMap<int, CollectionDirectory> watched_dirs_;
   QTimer *rescan_timer_;
@@ -244,6 +291,11 @@ class CollectionWatcher : public QObject {
 
   CueParser *cue_parser_;
 
+  QStringList readfile_queue_;
+  QHash<QString, TagReaderReply*> readfile_replies_;
+  QHash<TagReaderReply*, int> readfile_reply_files_count_;
+  QHash<QString, QString> content_hashes_;
+
   static QStringList sValidImages;
   static QStringList kIgnoredExtensions;
 
@@ -139,7 +139,7 @@ void ContextAlbum::UpdateWidth(const int new_width) {
 
 }
 
-void ContextAlbum::SetImage(QImage image) {
+void ContextAlbum::SetImage(QImage image, const QImage &image_scaled) {
 
   if (image.isNull()) {
     image = image_strawberry_;
@@ -156,7 +156,7 @@ void ContextAlbum::SetImage(QImage image) {
 
   image_original_ = image;
   pixmap_current_opacity_ = 0.0;
-  ScaleCover();
+  ScaleCover(image_scaled);
 
   if (!pixmap_previous.isNull()) {
     SharedPtr<PreviousCover> previous_cover = make_shared<PreviousCover>();
@@ -235,9 +235,13 @@ void ContextAlbum::FadePreviousCoverFinished(SharedPtr<PreviousCover> previous_c
 
 }
 
-void ContextAlbum::ScaleCover() {
+void ContextAlbum::ScaleCover(const QImage &image_scaled) {
 
-  const QImage image = ImageUtils::ScaleImage(image_original_, QSize(desired_height_, desired_height_), devicePixelRatioF(), true);
+  QImage image = image_scaled;
+  const QSize scale_size(static_cast<int>(desired_height_ * devicePixelRatioF()), static_cast<int>(desired_height_ * devicePixelRatioF()));
+  if (image.isNull() || image.size() != scale_size) {
+    image = ImageUtils::ScaleImage(image_original_, QSize(desired_height_, desired_height_), devicePixelRatioF(), true);
+  }
   if (image.isNull()) {
     pixmap_current_ = QPixmap();
   }
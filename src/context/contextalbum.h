@@ -51,8 +51,10 @@ class ContextAlbum : public QWidget {
   explicit ContextAlbum(QWidget *parent = nullptr);
 
   void Init(ContextView *context_view, AlbumCoverChoiceController *album_cover_choice_controller);
-  void SetImage(QImage image = QImage());
+  // The scaled image is used if it was scaled ahead of time to the current size, otherwise the image is scaled here.
+  void SetImage(QImage image = QImage(), const QImage &image_scaled = QImage());
   void UpdateWidth(const int width);
+  QSize cover_size() const { return QSize(desired_height_, desired_height_); }
 
  protected:
   QSize sizeHint() const override;
@@ -75,7 +77,7 @@ class ContextAlbum : public QWidget {
   void DrawImage(QPainter *p, const QPixmap &pixmap, const qreal opacity);
   void DrawSpinner(QPainter *p);
   void DrawPreviousCovers(QPainter *p);
-  void ScaleCover();
+  void ScaleCover(const QImage &image_scaled = QImage());
   void ScalePreviousCovers();
   void GetCoverAutomatically();
 
@@ -59,6 +59,13 @@
 #include "collection/collectionquery.h"
 #include "collection/collectionview.h"
 #include "covermanager/albumcoverchoicecontroller.h"
+#include "covermanager/albumcoverloader.h"
+#include "covermanager/albumcoverloaderoptions.h"
+#include "covermanager/albumcoverloaderresult.h"
+#include "covermanager/currentalbumcoverloader.h"
+#include "playlist/playlist.h"
+#include "playlist/playlistitem.h"
+#include "playlist/playlistmanager.h"
 #include "lyrics/lyricsfetcher.h"
 #include "settings/contextsettingspage.h"
 
@@ -250,6 +257,7 @@ void ContextView::Init(Application *app, CollectionView *collectionview, AlbumCo
   QObject::connect(collectionview_, &CollectionView::TotalArtistCountUpdated_, this, &ContextView::UpdateNoSong);
   QObject::connect(collectionview_, &CollectionView::TotalAlbumCountUpdated_, this, &ContextView::UpdateNoSong);
   QObject::connect(lyrics_fetcher_, &LyricsFetcher::LyricsFetched, this, &ContextView::UpdateLyrics);
+  QObject::connect(&*app_->album_cover_loader(), &AlbumCoverLoader::AlbumCoverLoaded, this, &ContextView::PreparedAlbumCoverLoaded);
 
   AddActions();
 
@@ -345,6 +353,8 @@ void ContextView::Stopped() {
 
   song_playing_ = Song();
   song_prev_ = Song();
+  prepared_playing_ = PreparedSong();
+  prepared_next_ = PreparedSong();
   lyrics_.clear();
   image_original_ = QImage();
   widget_album_->SetImage();
@@ -361,13 +371,74 @@ void ContextView::SongChanged(const Song &song) {
   else {
     song_prev_ = song_playing_;
     song_playing_ = song;
+    prepared_playing_ = song == prepared_next_.song ? prepared_next_ : PreparedSong();
+    prepared_next_ = PreparedSong();
     lyrics_ = song.lyrics();
     lyrics_id_ = -1;
     lyrics_tried_ = false;
+    if (lyrics_.isEmpty() && prepared_playing_.lyrics_cached) {
+      lyrics_ = prepared_playing_.lyrics;
+      lyrics_tried_ = true;
+    }
     SetSong();
   }
 
   SearchLyrics();
+  PrepareNextSong();
+
+}
+
+void ContextView::PrepareNextSong() {
+
+  Playlist *playlist = app_->playlist_manager()->active();
+  if (!playlist) return;
+
+  const QList<int> rows = playlist->next_rows(1);
+  if (rows.isEmpty() || !playlist->has_item_at(rows.first())) return;
+
+  const Song song = playlist->item_at(rows.first())->Metadata();
+  if (!song.is_valid() || song == prepared_next_.song) return;
+
+  prepared_next_ = PreparedSong();
+  prepared_next_.song = song;
+
+  if (action_show_album_->isChecked()) {
+    // Scaled by the cover loader to the size shown here, so changing songs doesn't scale the cover on the GUI thread.
+    AlbumCoverLoaderOptions options = app_->current_albumcover_loader()->options();
+    options.options = AlbumCoverLoaderOptions::Option::OriginalImage | AlbumCoverLoaderOptions::Option::ScaledImage | AlbumCoverLoaderOptions::Option::PadScaledImage;
+    options.desired_scaled_size = widget_album_->cover_size();
+    options.device_pixel_ratio = devicePixelRatioF();
+    prepared_next_.cover_id = app_->album_cover_loader()->LoadImageAsync(options, song);
+  }
+
+  if (action_show_lyrics_->isChecked() && action_search_lyrics_->isChecked() && song.lyrics().isEmpty() && !song.artist().isEmpty() && !song.title().isEmpty()) {
+    QString provider;
+    QString lyrics;
+    if (lyrics_fetcher_->CachedLyrics(song.artist(), song.title(), &provider, &lyrics)) {
+      prepared_next_.lyrics_cached = true;
+      prepared_next_.lyrics = LyricsText(provider, lyrics);
+    }
+  }
+
+}
+
+void ContextView::PreparedAlbumCoverLoaded(const quint64 id, const AlbumCoverLoaderResult &result) {
+
+  // The cover of the next song can still be loading when it starts playing.
+  PreparedSong *prepared = nullptr;
+  if (id == prepared_next_.cover_id) {
+    prepared = &prepared_next_;
+  }
+  else if (id == prepared_playing_.cover_id) {
+    prepared = &prepared_playing_;
+  }
+  if (!prepared || id == 0) return;
+
+  prepared->cover_id = 0;
+  if (!result.success) return;
+
+  prepared->image = result.album_cover.image;
+  prepared->image_scaled = result.image_scaled;
 
 }
 
@@ -632,12 +703,7 @@ void ContextView::UpdateLyrics(const quint64 id, const QString &provider, const
 
   if (static_cast<qint64>(id) != lyrics_id_) return;
 
-  if (lyrics.isEmpty()) {
-    lyrics_ = QStringLiteral("No lyrics found.\n");
-  }
-  else {
-    lyrics_ = lyrics + QStringLiteral("\n\n(Lyrics from ") + provider + QStringLiteral(")\n");
-  }
+  lyrics_ = LyricsText(provider, lyrics);
   lyrics_id_ = -1;
 
   if (action_show_lyrics_->isChecked() && !lyrics_.isEmpty()) {
@@ -651,6 +717,16 @@ void ContextView::UpdateLyrics(const quint64 id, const QString &provider, const
 
 }
 
+QString ContextView::LyricsText(const QString &provider, const QString &lyrics) {
+
+  if (lyrics.isEmpty()) {
+    return QStringLiteral("No lyrics found.\n");
+  }
+
+  return lyrics + QStringLiteral("\n\n(Lyrics from ") + provider + QStringLiteral(")\n");
+
+}
+
 void ContextView::contextMenuEvent(QContextMenuEvent *e) {
 
   if (menu_options_ && widget_stacked_->currentWidget() == widget_stop_) {
@@ -686,7 +762,13 @@ void ContextView::AlbumCoverLoaded(const Song &song, const QImage &image) {
 
   if (song != song_playing_ || image == image_original_) return;
 
-  widget_album_->SetImage(image);
+  // A cover prepared for the song only needs to be swapped in.
+  if (song == prepared_playing_.song && !prepared_playing_.image_scaled.isNull() && image == prepared_playing_.image) {
+    widget_album_->SetImage(image, prepared_playing_.image_scaled);
+  }
+  else {
+    widget_album_->SetImage(image);
+  }
   image_original_ = image;
 
 }
@@ -31,6 +31,7 @@
 #include <QAction>
 
 #include "core/song.h"
+#include "covermanager/albumcoverloaderresult.h"
 #include "contextalbum.h"
 
 class QMenu;
@@ -79,6 +80,8 @@ class ContextView : public QWidget {
   void GetCoverAutomatically();
   void SearchLyrics();
   void UpdateFonts();
+  void PrepareNextSong();
+  static QString LyricsText(const QString &provider, const QString &lyrics);
 
  signals:
   void AlbumEnabledChanged();
@@ -91,6 +94,7 @@ class ContextView : public QWidget {
   void UpdateNoSong();
   void FadeStopFinished();
   void UpdateLyrics(const quint64 id, const QString &provider, const QString &lyrics);
+  void PreparedAlbumCoverLoaded(const quint64 id, const AlbumCoverLoaderResult &result);
 
  public slots:
   void ReloadSettings();
@@ -103,6 +107,17 @@ class ContextView : public QWidget {
  private:
   static const int kWidgetSpacing;
 
+  // The cover and cached lyrics of a song, prepared in the background while the song before it plays.
+  struct PreparedSong {
+    PreparedSong() : cover_id(0), lyrics_cached(false) {}
+    Song song;
+    quint64 cover_id;
+    QImage image;
+    QImage image_scaled;
+    bool lyrics_cached;
+    QString lyrics;
+  };
+
   Application *app_;
   CollectionView *collectionview_;
   AlbumCoverChoiceController *album_cover_choice_controller_;
@@ -153,6 +168,8 @@ class ContextView : public QWidget {
   Song song_playing_;
   Song song_prev_;
   QImage image_original_;
+  PreparedSong prepared_playing_;
+  PreparedSong prepared_next_;
   bool lyrics_tried_;
   qint64 lyrics_id_;
   QString lyrics_;
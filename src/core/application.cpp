@@ -32,6 +32,7 @@
 #include <QString>
 
 #include "core/logging.h"
+#include "core/trace.h"
 
 #include "shared_ptr.h"
 #include "lazy.h"
@@ -40,6 +41,7 @@
 #include "taskmanager.h"
 #include "player.h"
 #include "networkaccessmanager.h"
+#include "startupscheduler.h"
 
 #include "engine/devicefinders.h"
 #ifndef Q_OS_WIN
@@ -80,6 +82,7 @@
 #endif
 
 #include "internet/internetservices.h"
+#include "internet/internetcoverdownloader.h"
 
 #ifdef HAVE_SUBSONIC
 #  include "subsonic/subsonicservice.h"
@@ -124,6 +127,9 @@ class ApplicationImpl {
         task_manager_([]() { return new TaskManager(); }),
         player_([app]() { return new Player(app); }),
         network_([]() { return new NetworkAccessManager(); }),
+        covers_network_([app]() { return new NetworkAccessManager(app->network()->scheduler()); }),
+        services_network_([app]() { return new NetworkAccessManager(app->network()->scheduler()); }),
+        scrobbler_network_([app]() { return new NetworkAccessManager(app->network()->scheduler()); }),
         device_finders_([]() { return new DeviceFinders(); }),
 #ifndef Q_OS_WIN
         device_manager_([app]() { return new DeviceManager(app); }),
@@ -137,19 +143,20 @@ class ApplicationImpl {
         playlist_manager_([app]() { return new PlaylistManager(app); }),
         cover_providers_([app]() {
           CoverProviders *cover_providers = new CoverProviders();
+          cover_providers->InitCache(app->database());
           // Initialize the repository of cover providers.
-          cover_providers->AddProvider(new LastFmCoverProvider(app, app->network()));
-          cover_providers->AddProvider(new MusicbrainzCoverProvider(app, app->network()));
-          cover_providers->AddProvider(new DiscogsCoverProvider(app, app->network()));
-          cover_providers->AddProvider(new DeezerCoverProvider(app, app->network()));
-          cover_providers->AddProvider(new MusixmatchCoverProvider(app, app->network()));
-          cover_providers->AddProvider(new SpotifyCoverProvider(app, app->network()));
-          cover_providers->AddProvider(new OpenTidalCoverProvider(app, app->network()));
+          cover_providers->AddProvider(new LastFmCoverProvider(app, app->covers_network()));
+          cover_providers->AddProvider(new MusicbrainzCoverProvider(app, app->covers_network()));
+          cover_providers->AddProvider(new DiscogsCoverProvider(app, app->covers_network()));
+          cover_providers->AddProvider(new DeezerCoverProvider(app, app->covers_network()));
+          cover_providers->AddProvider(new MusixmatchCoverProvider(app, app->covers_network()));
+          cover_providers->AddProvider(new SpotifyCoverProvider(app, app->covers_network()));
+          cover_providers->AddProvider(new OpenTidalCoverProvider(app, app->covers_network()));
 #ifdef HAVE_TIDAL
-          cover_providers->AddProvider(new TidalCoverProvider(app, app->network()));
+          cover_providers->AddProvider(new TidalCoverProvider(app, app->covers_network()));
 #endif
 #ifdef HAVE_QOBUZ
-          cover_providers->AddProvider(new QobuzCoverProvider(app, app->network()));
+          cover_providers->AddProvider(new QobuzCoverProvider(app, app->covers_network()));
 #endif
           cover_providers->ReloadSettings();
           return cover_providers;
@@ -157,11 +164,13 @@ class ApplicationImpl {
         album_cover_loader_([app]() {
           AlbumCoverLoader *loader = new AlbumCoverLoader();
           app->MoveToNewThread(loader);
+          QObject::connect(app, &Application::ClearPixmapDiskCache, loader, &AlbumCoverLoader::ClearCache);
           return loader;
         }),
         current_albumcover_loader_([app]() { return new CurrentAlbumCoverLoader(app); }),
         lyrics_providers_([app]() {
           LyricsProviders *lyrics_providers = new LyricsProviders(app);
+          lyrics_providers->InitCache(app->database());
           // Initialize the repository of lyrics providers.
           lyrics_providers->AddProvider(new GeniusLyricsProvider(app->network()));
           lyrics_providers->AddProvider(new OVHLyricsProvider(app->network()));
@@ -188,12 +197,13 @@ class ApplicationImpl {
 #endif
           return internet_services;
         }),
+        internet_cover_downloader_([app]() { return new InternetCoverDownloader(app->covers_network()); }),
         radio_services_([app]() { return new RadioServices(app); }),
         scrobbler_([app]() {
           AudioScrobbler *scrobbler = new AudioScrobbler(app);
-          scrobbler->AddService(make_shared<LastFMScrobbler>(scrobbler->settings(), app->network()));
-          scrobbler->AddService(make_shared<LibreFMScrobbler>(scrobbler->settings(), app->network()));
-          scrobbler->AddService(make_shared<ListenBrainzScrobbler>(scrobbler->settings(), app->network()));
+          scrobbler->AddService(make_shared<LastFMScrobbler>(scrobbler->settings(), app->scrobbler_network()));
+          scrobbler->AddService(make_shared<LibreFMScrobbler>(scrobbler->settings(), app->scrobbler_network()));
+          scrobbler->AddService(make_shared<ListenBrainzScrobbler>(scrobbler->settings(), app->scrobbler_network()));
 #ifdef HAVE_SUBSONIC
           scrobbler->AddService(make_shared<SubsonicScrobbler>(scrobbler->settings(), app));
 #endif
@@ -203,7 +213,7 @@ class ApplicationImpl {
         moodbar_loader_([app]() { return new MoodbarLoader(app); }),
         moodbar_controller_([app]() { return new MoodbarController(app); }),
 #endif
-        lastfm_import_([app]() { return new LastFMImport(app->network()); })
+        lastfm_import_([app]() { return new LastFMImport(app->scrobbler_network()); })
   {}
 
   Lazy<TagReaderClient> tag_reader_client_;
@@ -211,6 +221,9 @@ class ApplicationImpl {
   Lazy<TaskManager> task_manager_;
   Lazy<Player> player_;
   Lazy<NetworkAccessManager> network_;
+  Lazy<NetworkAccessManager> covers_network_;
+  Lazy<NetworkAccessManager> services_network_;
+  Lazy<NetworkAccessManager> scrobbler_network_;
   Lazy<DeviceFinders> device_finders_;
 #ifndef Q_OS_WIN
   Lazy<DeviceManager> device_manager_;
@@ -223,6 +236,7 @@ class ApplicationImpl {
   Lazy<CurrentAlbumCoverLoader> current_albumcover_loader_;
   Lazy<LyricsProviders> lyrics_providers_;
   Lazy<InternetServices> internet_services_;
+  Lazy<InternetCoverDownloader> internet_cover_downloader_;
   Lazy<RadioServices> radio_services_;
   Lazy<AudioScrobbler> scrobbler_;
 #ifdef HAVE_MOODBAR
@@ -234,9 +248,12 @@ class ApplicationImpl {
 };
 
 Application::Application(QObject *parent)
-    : QObject(parent), p_(new ApplicationImpl(this)) {
+    : QObject(parent),
+      p_(new ApplicationImpl(this)),
+      startup_scheduler_(new StartupScheduler(this)) {
+
+  TRACE_SCOPE("startup", "Application::Application");
 
-  device_finders()->Init();
   collection()->Init();
   tag_reader_client();
 
@@ -259,6 +276,23 @@ Application::~Application() {
 
 }
 
+void Application::StartDeferredInitialization() {
+
+  // Subsystems that were used by the main window already are skipped.
+  ApplicationImpl *p = p_.get();
+  startup_scheduler_->Add(QStringLiteral("album cover loader"), StartupScheduler::Priority::High, [p]() { if (!p->album_cover_loader_) p->album_cover_loader_.get(); });
+  startup_scheduler_->Add(QStringLiteral("current album cover loader"), StartupScheduler::Priority::High, [p]() { if (!p->current_albumcover_loader_) p->current_albumcover_loader_.get(); });
+  startup_scheduler_->Add(QStringLiteral("cover providers"), StartupScheduler::Priority::Normal, [p]() { if (!p->cover_providers_) p->cover_providers_.get(); });
+  startup_scheduler_->Add(QStringLiteral("lyrics providers"), StartupScheduler::Priority::Normal, [p]() { if (!p->lyrics_providers_) p->lyrics_providers_.get(); });
+  startup_scheduler_->Add(QStringLiteral("internet cover downloader"), StartupScheduler::Priority::Low, [p]() { if (!p->internet_cover_downloader_) p->internet_cover_downloader_.get(); });
+#ifdef HAVE_MOODBAR
+  startup_scheduler_->Add(QStringLiteral("moodbar loader"), StartupScheduler::Priority::Low, [p]() { if (!p->moodbar_loader_) p->moodbar_loader_.get(); });
+#endif
+
+  startup_scheduler_->Start();
+
+}
+
 QThread *Application::MoveToNewThread(QObject *object) {
 
   QThread *thread = new QThread(this);
@@ -340,6 +374,9 @@ SharedPtr<Database> Application::database() const { return p_->database_.ptr();
 SharedPtr<TaskManager> Application::task_manager() const { return p_->task_manager_.ptr(); }
 SharedPtr<Player> Application::player() const { return p_->player_.ptr(); }
 SharedPtr<NetworkAccessManager> Application::network() const { return p_->network_.ptr(); }
+SharedPtr<NetworkAccessManager> Application::covers_network() const { return p_->covers_network_.ptr(); }
+SharedPtr<NetworkAccessManager> Application::services_network() const { return p_->services_network_.ptr(); }
+SharedPtr<NetworkAccessManager> Application::scrobbler_network() const { return p_->scrobbler_network_.ptr(); }
 SharedPtr<DeviceFinders> Application::device_finders() const { return p_->device_finders_.ptr(); }
 #ifndef Q_OS_WIN
 SharedPtr<DeviceManager> Application::device_manager() const { return p_->device_manager_.ptr(); }
@@ -354,6 +391,7 @@ SharedPtr<LyricsProviders> Application::lyrics_providers() const { return p_->ly
 SharedPtr<PlaylistBackend> Application::playlist_backend() const { return p_->playlist_backend_.ptr(); }
 SharedPtr<PlaylistManager> Application::playlist_manager() const { return p_->playlist_manager_.ptr(); }
 SharedPtr<InternetServices> Application::internet_services() const { return p_->internet_services_.ptr(); }
+SharedPtr<InternetCoverDownloader> Application::internet_cover_downloader() const { return p_->internet_cover_downloader_.ptr(); }
 SharedPtr<RadioServices> Application::radio_services() const { return p_->radio_services_.ptr(); }
 SharedPtr<AudioScrobbler> Application::scrobbler() const { return p_->scrobbler_.ptr(); }
 SharedPtr<LastFMImport> Application::lastfm_import() const { return p_->lastfm_import_.ptr(); }
@@ -38,6 +38,7 @@ class QThread;
 
 class TaskManager;
 class ApplicationImpl;
+class StartupScheduler;
 class TagReaderClient;
 class Database;
 class DeviceFinders;
@@ -59,6 +60,7 @@ class LyricsProviders;
 class AudioScrobbler;
 class LastFMImport;
 class InternetServices;
+class InternetCoverDownloader;
 class RadioServices;
 #ifdef HAVE_MOODBAR
 class MoodbarController;
@@ -77,6 +79,10 @@ class Application : public QObject {
   SharedPtr<TaskManager> task_manager() const;
   SharedPtr<Player> player() const;
   SharedPtr<NetworkAccessManager> network() const;
+  // Separate network access managers for the subsystems that make many requests in the background.
+  SharedPtr<NetworkAccessManager> covers_network() const;
+  SharedPtr<NetworkAccessManager> services_network() const;
+  SharedPtr<NetworkAccessManager> scrobbler_network() const;
   SharedPtr<DeviceFinders> device_finders() const;
 #ifndef Q_OS_WIN
   SharedPtr<DeviceManager> device_manager() const;
@@ -98,6 +104,7 @@ class Application : public QObject {
   SharedPtr<AudioScrobbler> scrobbler() const;
 
   SharedPtr<InternetServices> internet_services() const;
+  SharedPtr<InternetCoverDownloader> internet_cover_downloader() const;
   SharedPtr<RadioServices> radio_services() const;
 
 #ifdef HAVE_MOODBAR
@@ -107,6 +114,9 @@ class Application : public QObject {
 
   SharedPtr<LastFMImport> lastfm_import() const;
 
+  // Creates the rest of the subsystems in idle time, should be called when the main window was created.
+  void StartDeferredInitialization();
+
   void Exit();
 
   QThread *MoveToNewThread(QObject *object);
@@ -129,6 +139,7 @@ class Application : public QObject {
 
  private:
   ScopedPtr<ApplicationImpl> p_;
+  StartupScheduler *startup_scheduler_;
   QList<QThread*> threads_;
   QList<QObject*> wait_for_exit_;
 
@@ -80,7 +80,9 @@ const char *CommandlineOptions::kHelpText =
     "      --quiet                %31\n"
     "      --verbose              %32\n"
     "      --log-levels <levels>  %33\n"
-    "      --version              %34\n";
+    "      --trace <file>         %34\n"
+    "      --memory-stats         %35\n"
+    "      --version              %36\n";
 
 const char *CommandlineOptions::kVersionText = "Strawberry %1";
 
@@ -163,6 +165,8 @@ bool CommandlineOptions::Parse() {
       {L"quiet", no_argument, nullptr, LongOptions::Quiet},
       {L"verbose", no_argument, nullptr, LongOptions::Verbose},
       {L"log-levels", required_argument, nullptr, LongOptions::LogLevels},
+      {L"trace", required_argument, nullptr, LongOptions::Trace},
+      {L"memory-stats", no_argument, nullptr, LongOptions::MemoryStats},
       {L"version", no_argument, nullptr, LongOptions::Version},
       {nullptr, 0, nullptr, 0}
 #else
@@ -194,6 +198,8 @@ bool CommandlineOptions::Parse() {
     { "quiet", no_argument, nullptr, LongOptions::Quiet },
     { "verbose", no_argument, nullptr, LongOptions::Verbose },
     { "log-levels", required_argument, nullptr, LongOptions::LogLevels },
+    { "trace", required_argument, nullptr, LongOptions::Trace },
+    { "memory-stats", no_argument, nullptr, LongOptions::MemoryStats },
     { "version", no_argument, nullptr, LongOptions::Version },
     { nullptr, 0, nullptr, 0 }
 #endif
@@ -244,7 +250,9 @@ bool CommandlineOptions::Parse() {
                      QObject::tr("Equivalent to --log-levels *:1"),
                      QObject::tr("Equivalent to --log-levels *:3"),
                      QObject::tr("Comma separated list of class:level, level is 0-3"))
-                .arg(QObject::tr("Print out version information"));
+                .arg(QObject::tr("Record a Chrome trace of startup and slow operations to the file"),
+                     QObject::tr("Write the memory usage of the running instance to its log"),
+                     QObject::tr("Print out version information"));
 
         std::cout << translated_help_text.toLocal8Bit().constData();
         return false;
@@ -309,6 +317,12 @@ bool CommandlineOptions::Parse() {
       case LongOptions::LogLevels:
         log_levels_ = OptArgToString(optarg);
         break;
+      case LongOptions::Trace:
+        trace_file_ = OptArgToString(optarg);
+        break;
+      case LongOptions::MemoryStats:
+        player_action_ = PlayerAction::LogMemoryStats;
+        break;
       case LongOptions::Version:{
         QString version_text = QString::fromUtf8(kVersionText).arg(QStringLiteral(STRAWBERRY_VERSION_DISPLAY));
         std::cout << version_text.toLocal8Bit().constData() << std::endl;
@@ -388,7 +402,7 @@ bool CommandlineOptions::is_empty() const {
 }
 
 bool CommandlineOptions::contains_play_options() const {
-  return player_action_ != PlayerAction::None || play_track_at_ != -1 || !urls_.isEmpty();
+  return (player_action_ != PlayerAction::None && player_action_ != PlayerAction::LogMemoryStats) || play_track_at_ != -1 || !urls_.isEmpty();
 }
 
 QByteArray CommandlineOptions::Serialize() const {
@@ -63,7 +63,8 @@ class CommandlineOptions {
     RestartOrPrevious = 7,
     StopAfterCurrent = 8,
     PlayPlaylist = 9,
-    ResizeWindow = 10
+    ResizeWindow = 10,
+    LogMemoryStats = 11
   };
 
   bool Parse();
@@ -85,6 +86,7 @@ class CommandlineOptions {
   QString log_levels() const { return log_levels_; }
   QString playlist_name() const { return playlist_name_; }
   QString window_size() const { return window_size_; }
+  QString trace_file() const { return trace_file_; }
 
   QByteArray Serialize() const;
   void Load(const QByteArray &serialized);
@@ -102,7 +104,9 @@ class CommandlineOptions {
     Version,
     VolumeIncreaseBy,
     VolumeDecreaseBy,
-    RestartOrPrevious
+    RestartOrPrevious,
+    Trace,
+    MemoryStats
   };
 
   void RemoveArg(const QString &starts_with, int count);
@@ -139,6 +143,9 @@ class CommandlineOptions {
   QString playlist_name_;
   QString window_size_;
 
+  // Only used by the first instance, so it's not serialized.
+  QString trace_file_;
+
   QList<QUrl> urls_;
 };
 
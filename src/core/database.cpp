@@ -22,6 +22,7 @@
 #include "config.h"
 
 #include <utility>
+#include <cstring>
 
 #include <sqlite3.h>
 
@@ -36,25 +37,40 @@
 #include <QStringList>
 #include <QRegularExpression>
 #include <QUrl>
+#include <QVariant>
 #include <QSqlDriver>
 #include <QSqlDatabase>
 #include <QSqlError>
 #include <QStandardPaths>
 #include <QScopeGuard>
+#include <QTimer>
+#include <QDateTime>
+#include <QVersionNumber>
 
 #include "core/logging.h"
+#include "core/settings.h"
+#include "core/song.h"
+#include "settings/collectionsettingspage.h"
 #include "taskmanager.h"
 #include "database.h"
 #include "application.h"
 #include "sqlquery.h"
 #include "scopedtransaction.h"
 
-const int Database::kSchemaVersion = 18;
+const int Database::kSchemaVersion = 27;
+const char *Database::kSettingsGroup = "Database";
 
 namespace {
 constexpr char kDatabaseFilename[] = "strawberry.db";
 constexpr int kMinSupportedSchemaVersion = 10;
 constexpr char kMagicAllSongsTables[] = "%allsongstables";
+constexpr int kMaintenanceCheckIntervalMsec = 300000;
+constexpr qint64 kMaintenanceIdleMsec = 60000;
+constexpr int kIncrementalVacuumPages = 1000;
+// No locks are held between the steps, so this only sets how often the progress is updated.
+constexpr int kBackupPagesPerStep = 1024;
+// The trigram tokenizer was added in SQLite 3.34.0.
+const QVersionNumber kMinFtsTrigramSqliteVersion(3, 34, 0);
 }  // namespace
 
 int Database::sNextConnectionId = 1;
@@ -69,10 +85,30 @@ Database::Database(Application *app, QObject *parent, const QString &database_na
       injected_database_name_(database_name),
       query_hash_(0),
       startup_schema_version_(-1),
-      original_thread_(nullptr) {
+      original_thread_(nullptr),
+      checkpoint_timer_(new QTimer(this)),
+      maintenance_timer_(new QTimer(this)) {
 
   original_thread_ = thread();
 
+  LoadConnectionProfile();
+
+  // Checkpoint from the database thread, so the UI thread never runs a checkpoint when committing.
+  if (connection_profile_.checkpoint_interval > 0) {
+    checkpoint_timer_->setInterval(connection_profile_.checkpoint_interval * 1000);
+    QObject::connect(checkpoint_timer_, &QTimer::timeout, this, &Database::Checkpoint);
+    // The timer has to be started from the thread the database is moved to.
+    QMetaObject::invokeMethod(checkpoint_timer_, QOverload<>::of(&QTimer::start), Qt::QueuedConnection);
+  }
+
+  SqlQuery::SetSlowQueryThreshold(connection_profile_.slow_query_threshold);
+
+  if (connection_profile_.maintenance_interval > 0 && injected_database_name_.isEmpty()) {
+    maintenance_timer_->setInterval(kMaintenanceCheckIntervalMsec);
+    QObject::connect(maintenance_timer_, &QTimer::timeout, this, &Database::Maintenance);
+    QMetaObject::invokeMethod(maintenance_timer_, QOverload<>::of(&QTimer::start), Qt::QueuedConnection);
+  }
+
   {
     QMutexLocker l(&sNextConnectionIdMutex);
     connection_id_ = sNextConnectionId++;
@@ -103,6 +139,16 @@ void Database::ExitAsync() {
 void Database::Exit() {
 
   Q_ASSERT(QThread::currentThread() == thread());
+  checkpoint_timer_->stop();
+  maintenance_timer_->stop();
+  if (wal_enabled()) {
+    QSqlDatabase db(Connect());
+    SqlQuery q(db);
+    q.prepare(QStringLiteral("PRAGMA wal_checkpoint(TRUNCATE)"));
+    if (!q.Exec()) {
+      ReportErrors(q);
+    }
+  }
   Close();
   moveToThread(original_thread_);
   emit ExitFinished();
@@ -148,6 +194,8 @@ QSqlDatabase Database::Connect() {
     return db;
   }
 
+  ApplyConnectionProfile(db);
+
   if (db.tables().count() == 0) {
     // Set up initial schema
     qLog(Info) << "Creating initial database schema";
@@ -177,6 +225,7 @@ QSqlDatabase Database::Connect() {
 
   if (startup_schema_version_ == -1) {
     UpdateMainSchema(&db);
+    UpdateFtsTrigramTables(db);
   }
 
   // We might have to initialize the schema in some attached databases now, if they were deleted and don't match up with the main schema version.
@@ -198,11 +247,91 @@ QSqlDatabase Database::Connect() {
 
 }
 
+QSqlDatabase Database::ReadConnection() {
+
+  // Without WAL a separate reader gains nothing, and the schema has to be set up by a writer connection first.
+  if (!wal_enabled() || startup_schema_version_ == -1) {
+    return Connect();
+  }
+
+  QMutexLocker l(&connect_mutex_);
+
+  const QString connection_id = QStringLiteral("%1_reader_thread_%2").arg(connection_id_).arg(reinterpret_cast<quint64>(QThread::currentThread()));
+
+  QSqlDatabase db;
+  if (QSqlDatabase::connectionNames().contains(connection_id)) {
+    db = QSqlDatabase::database(connection_id);
+  }
+  else {
+    db = QSqlDatabase::addDatabase(QStringLiteral("QSQLITE"), connection_id);
+  }
+  if (db.isOpen()) {
+    return db;
+  }
+  db.setConnectOptions(QStringLiteral("QSQLITE_BUSY_TIMEOUT=30000;QSQLITE_OPEN_READONLY"));
+
+  if (injected_database_name_.isNull()) {
+    db.setDatabaseName(directory_ + QLatin1Char('/') + QLatin1String(kDatabaseFilename));
+  }
+  else {
+    db.setDatabaseName(injected_database_name_);
+  }
+
+  if (!db.open()) {
+    app_->AddError(QStringLiteral("Database: ") + db.lastError().text());
+    return db;
+  }
+
+  ApplyConnectionProfile(db, true);
+
+  const QVariant handle = db.driver()->handle();
+  if (handle.isValid() && qstrcmp(handle.typeName(), "sqlite3*") == 0) {
+    read_handles_[QThread::currentThread()] = *static_cast<sqlite3* const*>(handle.constData());
+  }
+
+  const QStringList keys = attached_databases_.keys();
+  for (const QString &key : keys) {
+    QString filename = attached_databases_[key].filename_;
+
+    if (!injected_database_name_.isNull()) filename = injected_database_name_;
+
+    SqlQuery q(db);
+    q.prepare(QStringLiteral("ATTACH DATABASE :filename AS :alias"));
+    q.BindValue(QStringLiteral(":filename"), filename);
+    q.BindValue(QStringLiteral(":alias"), key);
+    if (!q.Exec()) {
+      qLog(Error) << "Couldn't attach external database" << key << "to reader connection" << q.lastError().text();
+    }
+  }
+
+  return db;
+
+}
+
 void Database::Close() {
 
   QMutexLocker l(&connect_mutex_);
 
-  const QString connection_id = QStringLiteral("%1_thread_%2").arg(connection_id_).arg(reinterpret_cast<quint64>(QThread::currentThread()));
+  const QString thread_id = QString::number(reinterpret_cast<quint64>(QThread::currentThread()));
+  CloseConnection(QStringLiteral("%1_thread_%2").arg(connection_id_).arg(thread_id));
+  CloseConnection(QStringLiteral("%1_reader_thread_%2").arg(connection_id_).arg(thread_id));
+  read_handles_.remove(QThread::currentThread());
+
+}
+
+void Database::InterruptReadConnection(QThread *thread) {
+
+  QMutexLocker l(&connect_mutex_);
+
+  // The handle stays valid while the mutex is locked, the connection is only closed with it locked.
+  sqlite3 *handle = read_handles_.value(thread, nullptr);
+  if (handle) {
+    sqlite3_interrupt(handle);
+  }
+
+}
+
+void Database::CloseConnection(const QString &connection_id) {
 
   // Try to find an existing connection for this thread
   if (QSqlDatabase::connectionNames().contains(connection_id)) {
@@ -251,6 +380,103 @@ void Database::UpdateMainSchema(QSqlDatabase *db) {
   }
 }
 
+void Database::UpdateFtsTrigramTables(QSqlDatabase &db) {
+
+  Settings s;
+  s.beginGroup(CollectionSettingsPage::kSettingsGroup);
+  bool substring_search = s.value("substring_search", false).toBool();
+  s.endGroup();
+
+  // The SQL driver might not use the same SQLite library as we're linked with, so ask the connection for the version.
+  if (substring_search) {
+    SqlQuery q(db);
+    q.prepare(QStringLiteral("SELECT sqlite_version()"));
+    const QString version = q.Exec() && q.next() ? q.value(0).toString() : QString();
+    if (QVersionNumber::fromString(version) < kMinFtsTrigramSqliteVersion) {
+      qLog(Warning) << "Substring search needs SQLite" << kMinFtsTrigramSqliteVersion.toString() << "or newer, SQLite" << version << "is used";
+      substring_search = false;
+    }
+  }
+
+  const QStringList tables = db.tables();
+
+  QStringList triggers;
+  {
+    SqlQuery q(db);
+    q.prepare(QStringLiteral("SELECT name FROM sqlite_master WHERE type = 'trigger'"));
+    if (q.Exec()) {
+      while (q.next()) triggers << q.value(0).toString();
+    }
+  }
+
+  // The FTS columns are the song columns with a "fts" prefix.
+  QStringList song_columns;
+  QStringList insert_values;
+  QStringList update_values;
+  for (const QString &fts_column : Song::kFtsColumns) {
+    const QString column = fts_column.mid(3);
+    song_columns << column;
+    insert_values << QStringLiteral("NEW.") + column;
+    update_values << QStringLiteral("%1 = NEW.%2").arg(fts_column, column);
+  }
+
+  ScopedTransaction t(&db);
+
+  for (const QString &fts_table : tables) {
+    if (!fts_table.endsWith(QLatin1String("_fts"))) continue;
+    const QString songs_table = fts_table.left(fts_table.length() - 4);
+    if (!tables.contains(songs_table)) continue;
+    const QString trigram_table = fts_table + QStringLiteral("_trigram");
+
+    // The trigram table is kept up to date by triggers on the songs table, which are dropped with the songs table when a schema update recreates it.
+    const bool exists = tables.contains(trigram_table) && triggers.contains(trigram_table + QStringLiteral("_delete"));
+    if (substring_search && exists) {
+      fts_trigram_tables_ << fts_table;
+      continue;
+    }
+
+    QStringList commands;
+    commands << QStringLiteral("DROP TRIGGER IF EXISTS %1_insert").arg(trigram_table)
+             << QStringLiteral("DROP TRIGGER IF EXISTS %1_update").arg(trigram_table)
+             << QStringLiteral("DROP TRIGGER IF EXISTS %1_delete").arg(trigram_table)
+             << QStringLiteral("DROP TABLE IF EXISTS %1").arg(trigram_table);
+
+    if (substring_search) {
+      qLog(Info) << "Creating trigram index for" << songs_table;
+      commands << QStringLiteral("CREATE VIRTUAL TABLE %1 USING fts5(%2, tokenize = \"trigram\")").arg(trigram_table, Song::kFtsColumnSpec)
+               << QStringLiteral("INSERT INTO %1 (ROWID, %2) SELECT ROWID, %3 FROM %4").arg(trigram_table, Song::kFtsColumnSpec, song_columns.join(QStringLiteral(", ")), songs_table)
+               << QStringLiteral("CREATE TRIGGER %1_insert AFTER INSERT ON %2 BEGIN INSERT INTO %1 (ROWID, %3) VALUES (NEW.ROWID, %4); END").arg(trigram_table, songs_table, Song::kFtsColumnSpec, insert_values.join(QStringLiteral(", ")))
+               << QStringLiteral("CREATE TRIGGER %1_update AFTER UPDATE OF %3 ON %2 BEGIN UPDATE %1 SET %4 WHERE ROWID = NEW.ROWID; END").arg(trigram_table, songs_table, song_columns.join(QStringLiteral(", ")), update_values.join(QStringLiteral(", ")))
+               << QStringLiteral("CREATE TRIGGER %1_delete AFTER DELETE ON %2 BEGIN DELETE FROM %1 WHERE ROWID = OLD.ROWID; END").arg(trigram_table, songs_table);
+    }
+    else if (!tables.contains(trigram_table)) {
+      continue;
+    }
+
+    if (ExecCommands(db, commands) && substring_search) {
+      fts_trigram_tables_ << fts_table;
+    }
+  }
+
+  t.Commit();
+
+}
+
+bool Database::ExecCommands(QSqlDatabase &db, const QStringList &commands) {
+
+  for (const QString &command : commands) {
+    SqlQuery q(db);
+    q.prepare(command);
+    if (!q.Exec()) {
+      ReportErrors(q);
+      return false;
+    }
+  }
+
+  return true;
+
+}
+
 void Database::RecreateAttachedDb(const QString &database_name) {
 
   if (!attached_databases_.contains(database_name)) {
@@ -478,6 +704,11 @@ QStringList Database::SongsTables(QSqlDatabase &db, const int schema_version) {
 void Database::ReportErrors(const SqlQuery &query) {
 
   const QSqlError sql_error = query.lastError();
+  // Queries aborted by InterruptReadConnection were cancelled on purpose.
+  if (sql_error.nativeErrorCode() == QString::number(SQLITE_INTERRUPT)) {
+    qLog(Debug) << "SQL query was interrupted:" << query.LastQuery();
+    return;
+  }
   if (sql_error.isValid()) {
     qLog(Error) << "Unable to execute SQL query:" << sql_error;
     qLog(Error) << "Failed SQL query:" << query.LastQuery();
@@ -529,20 +760,22 @@ void Database::DoBackup() {
 
   if (!db.isOpen()) return;
 
-  // Before we overwrite anything, make sure the database is not corrupt
-  QMutexLocker l(&mutex_);
+  // In WAL mode the integrity check and the backup read from a snapshot, so the collection and playlists can keep writing meanwhile.
+  // Without WAL the readers would block the writers anyway, so the database is locked for the duration.
+  QMutexLocker l(ReadMutex());
 
-  const bool ok = IntegrityCheck(db);
+  // Before we overwrite anything, make sure the database is not corrupt
+  const bool ok = IntegrityCheck(wal_enabled() ? ReadConnection() : db);
   if (ok && SchemaVersion(&db) == kSchemaVersion) {
     BackupFile(db.databaseName());
   }
 
 }
 
-bool Database::OpenDatabase(const QString &filename, sqlite3 **connection) {
+bool Database::OpenDatabase(const QString &filename, sqlite3 **connection, const int flags) {
 
   const QByteArray filename_data = filename.toUtf8();
-  int ret = sqlite3_open(filename_data.constData(), connection);
+  int ret = sqlite3_open_v2(filename_data.constData(), connection, flags, nullptr);
   if (ret != 0) {
     if (*connection) {
       const char *error_message = sqlite3_errmsg(*connection);
@@ -564,25 +797,33 @@ void Database::BackupFile(const QString &filename) {
   const int task_id = app_->task_manager()->StartTask(tr("Backing up database"));
 
   sqlite3 *source_connection = nullptr;
-  sqlite3 *dest_connection = nullptr;
 
-  const QScopeGuard db_backup_finish = qScopeGuard([this, task_id, &source_connection, &dest_connection]() {
+  const QScopeGuard db_backup_finish = qScopeGuard([this, task_id, &source_connection]() {
     if (source_connection) {
+      sqlite3_exec(source_connection, "COMMIT", nullptr, nullptr, nullptr);
       sqlite3_close(source_connection);
     }
-    if (dest_connection) {
-      sqlite3_close(dest_connection);
-    }
     app_->task_manager()->SetTaskFinished(task_id);
   });
 
-  bool success = OpenDatabase(filename, &source_connection);
-  if (!success) {
+  if (!OpenDatabase(filename, &source_connection, SQLITE_OPEN_READONLY)) {
     return;
   }
 
-  success = OpenDatabase(dest_filename, &dest_connection);
-  if (!success) {
+  // Keep a read transaction open for the whole backup, so every page is copied from the same snapshot.
+  // In WAL mode this doesn't block writers, and the backup isn't restarted when the database is written to meanwhile.
+  if (sqlite3_exec(source_connection, "BEGIN; SELECT COUNT(*) FROM sqlite_master;", nullptr, nullptr, nullptr) != SQLITE_OK) {
+    qLog(Error) << "Failed to start read transaction for backup:" << sqlite3_errmsg(source_connection);
+    return;
+  }
+
+  if (connection_profile_.incremental_backup && QFile::exists(dest_filename) && IncrementalBackup(source_connection, dest_filename, task_id)) {
+    return;
+  }
+
+  sqlite3 *dest_connection = nullptr;
+  if (!OpenDatabase(dest_filename, &dest_connection)) {
+    if (dest_connection) sqlite3_close(dest_connection);
     return;
   }
 
@@ -590,12 +831,13 @@ void Database::BackupFile(const QString &filename) {
   if (!backup) {
     const char *error_message = sqlite3_errmsg(dest_connection);
     qLog(Error) << "Failed to start database backup:" << error_message;
+    sqlite3_close(dest_connection);
     return;
   }
 
   int ret = SQLITE_OK;
   do {
-    ret = sqlite3_backup_step(backup, 16);
+    ret = sqlite3_backup_step(backup, kBackupPagesPerStep);
     const int page_count = sqlite3_backup_pagecount(backup);
     app_->task_manager()->SetTaskProgress(task_id, page_count - sqlite3_backup_remaining(backup), page_count);
   }
@@ -606,5 +848,209 @@ void Database::BackupFile(const QString &filename) {
   }
 
   sqlite3_backup_finish(backup);
+  sqlite3_close(dest_connection);
+
+}
+
+bool Database::IncrementalBackup(sqlite3 *source_connection, const QString &dest_filename, const int task_id) {
+
+  // Raw pages can only be read when SQLite was built with the sqlite_dbpage virtual table.
+  sqlite3_stmt *stmt = nullptr;
+  if (sqlite3_prepare_v2(source_connection, "SELECT pgno, data FROM sqlite_dbpage ORDER BY pgno", -1, &stmt, nullptr) != SQLITE_OK) {
+    qLog(Debug) << "Incremental backup is not available:" << sqlite3_errmsg(source_connection);
+    if (stmt) sqlite3_finalize(stmt);
+    return false;
+  }
+  const QScopeGuard finalize_stmt = qScopeGuard([stmt]() { sqlite3_finalize(stmt); });
+
+  qint64 page_size = 0;
+  qint64 page_count = 0;
+  {
+    sqlite3_stmt *pragma_stmt = nullptr;
+    if (sqlite3_prepare_v2(source_connection, "SELECT page_size, page_count FROM pragma_page_size, pragma_page_count", -1, &pragma_stmt, nullptr) == SQLITE_OK && sqlite3_step(pragma_stmt) == SQLITE_ROW) {
+      page_size = sqlite3_column_int64(pragma_stmt, 0);
+      page_count = sqlite3_column_int64(pragma_stmt, 1);
+    }
+    sqlite3_finalize(pragma_stmt);
+  }
+  if (page_size <= 0 || page_count <= 0) return false;
+
+  QFile dest_file(dest_filename);
+  if (!dest_file.open(QIODevice::ReadWrite)) {
+    qLog(Error) << "Failed to open" << dest_filename << "for incremental backup:" << dest_file.errorString();
+    return false;
+  }
+
+  // The page size is stored big endian at offset 16 of the header, 1 means 65536.
+  const QByteArray dest_header = dest_file.read(100);
+  if (dest_header.size() < 100 || !dest_header.startsWith("SQLite format 3")) return false;
+  qint64 dest_page_size = (static_cast<quint8>(dest_header[16]) << 8) | static_cast<quint8>(dest_header[17]);
+  if (dest_page_size == 1) dest_page_size = 65536;
+  if (dest_page_size != page_size) return false;
+
+  // Only pages that changed since the last backup are written, unchanged pages are only read.
+  qint64 pages_done = 0;
+  qint64 pages_written = 0;
+  int ret = SQLITE_ROW;
+  while ((ret = sqlite3_step(stmt)) == SQLITE_ROW) {
+    const qint64 pgno = sqlite3_column_int64(stmt, 0);
+    const char *data = static_cast<const char*>(sqlite3_column_blob(stmt, 1));
+    const int size = sqlite3_column_bytes(stmt, 1);
+    if (!data || size != page_size) return false;
+
+    const qint64 offset = (pgno - 1) * page_size;
+    if (!dest_file.seek(offset)) return false;
+    const QByteArray dest_page = dest_file.read(page_size);
+    if (dest_page.size() != size || std::memcmp(dest_page.constData(), data, static_cast<size_t>(size)) != 0) {
+      if (!dest_file.seek(offset) || dest_file.write(data, size) != size) {
+        qLog(Error) << "Failed to write" << dest_filename << dest_file.errorString();
+        return false;
+      }
+      ++pages_written;
+    }
+
+    if (++pages_done % kBackupPagesPerStep == 0) {
+      app_->task_manager()->SetTaskProgress(task_id, pages_done, page_count);
+    }
+  }
+
+  if (ret != SQLITE_DONE) {
+    qLog(Error) << "Incremental backup failed:" << sqlite3_errmsg(source_connection);
+    return false;
+  }
+
+  if (!dest_file.resize(page_count * page_size) || !dest_file.flush()) {
+    qLog(Error) << "Failed to write" << dest_filename << dest_file.errorString();
+    return false;
+  }
+  dest_file.close();
+
+  qLog(Debug) << "Incremental database backup wrote" << pages_written << "of" << page_count << "pages";
+
+  return true;
+
+}
+
+void Database::LoadConnectionProfile() {
+
+  Settings s;
+  s.beginGroup(kSettingsGroup);
+  connection_profile_.journal_mode = s.value("journal_mode", QStringLiteral("WAL")).toString();
+  connection_profile_.synchronous = s.value("synchronous", QStringLiteral("NORMAL")).toString();
+  connection_profile_.mmap_size = s.value("mmap_size", 256LL * 1024LL * 1024LL).toLongLong();
+  connection_profile_.cache_size_kib = s.value("cache_size", 16384).toInt();
+  connection_profile_.temp_store_memory = s.value("temp_store_memory", true).toBool();
+  connection_profile_.checkpoint_interval = s.value("checkpoint_interval", 30).toInt();
+  connection_profile_.maintenance_interval = s.value("maintenance_interval", 24).toInt();
+  connection_profile_.slow_query_threshold = s.value("slow_query_threshold", 1000).toInt();
+  connection_profile_.incremental_backup = s.value("incremental_backup", false).toBool();
+  s.endGroup();
+
+  if (!wal_enabled()) {
+    connection_profile_.checkpoint_interval = 0;
+  }
+
+}
+
+bool Database::wal_enabled() const {
+
+  return connection_profile_.journal_mode.compare(QLatin1String("WAL"), Qt::CaseInsensitive) == 0 && injected_database_name_ != QLatin1String(":memory:");
+
+}
+
+void Database::ApplyConnectionProfile(QSqlDatabase &db, const bool read_only) {
+
+  QStringList pragmas;
+  // The journal mode is persistent in the database file, and can only be changed by a writer.
+  if (!read_only && !connection_profile_.journal_mode.isEmpty()) {
+    pragmas << QStringLiteral("PRAGMA journal_mode = %1").arg(connection_profile_.journal_mode);
+  }
+  if (!connection_profile_.synchronous.isEmpty()) {
+    pragmas << QStringLiteral("PRAGMA synchronous = %1").arg(connection_profile_.synchronous);
+  }
+  if (connection_profile_.mmap_size > 0) {
+    pragmas << QStringLiteral("PRAGMA mmap_size = %1").arg(connection_profile_.mmap_size);
+  }
+  if (connection_profile_.cache_size_kib > 0) {
+    // A negative cache size is in KiB instead of pages.
+    pragmas << QStringLiteral("PRAGMA cache_size = -%1").arg(connection_profile_.cache_size_kib);
+  }
+  if (connection_profile_.temp_store_memory) {
+    pragmas << QStringLiteral("PRAGMA temp_store = MEMORY");
+  }
+  if (!read_only && connection_profile_.checkpoint_interval > 0) {
+    pragmas << QStringLiteral("PRAGMA wal_autocheckpoint = 0");
+  }
+  // This only takes effect for new databases, existing databases keep their auto_vacuum mode until they're vacuumed.
+  if (!read_only && connection_profile_.maintenance_interval > 0) {
+    pragmas << QStringLiteral("PRAGMA auto_vacuum = INCREMENTAL");
+  }
+
+  for (const QString &pragma : std::as_const(pragmas)) {
+    SqlQuery q(db);
+    q.prepare(pragma);
+    if (!q.Exec()) {
+      qLog(Error) << "Failed to set" << pragma << q.lastError().text();
+    }
+  }
+
+}
+
+void Database::Checkpoint() {
+
+  QSqlDatabase db(Connect());
+  SqlQuery q(db);
+  q.prepare(QStringLiteral("PRAGMA wal_checkpoint(PASSIVE)"));
+  if (!q.Exec()) {
+    ReportErrors(q);
+  }
+
+}
+
+void Database::Maintenance() {
+
+  // Only run when no queries were executed for a while, otherwise try again on the next check.
+  if (QDateTime::currentMSecsSinceEpoch() - SqlQuery::LastExecTime() < kMaintenanceIdleMsec) return;
+
+  Settings s;
+  s.beginGroup(kSettingsGroup);
+  const qint64 last_maintenance = s.value("last_maintenance", 0).toLongLong();
+  if (QDateTime::currentSecsSinceEpoch() - last_maintenance < connection_profile_.maintenance_interval * 3600LL) {
+    s.endGroup();
+    return;
+  }
+
+  qLog(Debug) << "Starting database maintenance";
+
+  QMutexLocker l(&mutex_);
+  QSqlDatabase db(Connect());
+
+  QStringList commands = QStringList() << QStringLiteral("ANALYZE") << QStringLiteral("PRAGMA optimize");
+
+  // Incremental vacuum only does anything if the database was created or vacuumed with auto_vacuum = INCREMENTAL.
+  {
+    SqlQuery q(db);
+    q.prepare(QStringLiteral("PRAGMA auto_vacuum"));
+    if (q.Exec() && q.next() && q.value(0).toInt() == 2) {
+      commands << QStringLiteral("PRAGMA incremental_vacuum(%1)").arg(kIncrementalVacuumPages);
+    }
+  }
+
+  for (const QString &command : std::as_const(commands)) {
+    SqlQuery q(db);
+    q.prepare(command);
+    if (!q.Exec()) {
+      ReportErrors(q);
+      s.endGroup();
+      return;
+    }
+    // incremental_vacuum returns a row for each freed page, step through them to run it to completion.
+    while (q.next()) {}
+  }
+
+  s.setValue("last_maintenance", QDateTime::currentSecsSinceEpoch());
+  s.endGroup();
+
+  qLog(Debug) << "Database maintenance finished";
 
 }
@@ -40,6 +40,7 @@
 
 #include "sqlquery.h"
 
+class QTimer;
 class QThread;
 class Application;
 
@@ -51,6 +52,25 @@ class Database : public QObject {
   ~Database() override;
 
   static const int kSchemaVersion;
+  static const char *kSettingsGroup;
+
+  // SQLite settings applied to every connection.
+  struct ConnectionProfile {
+    ConnectionProfile() : mmap_size(0), cache_size_kib(0), temp_store_memory(false), checkpoint_interval(0), maintenance_interval(0), slow_query_threshold(0), incremental_backup(false) {}
+    QString journal_mode;
+    QString synchronous;
+    qint64 mmap_size;
+    int cache_size_kib;
+    bool temp_store_memory;
+    // Interval in seconds for WAL checkpoints from the database thread, 0 leaves checkpoints to SQLite.
+    int checkpoint_interval;
+    // Minimum interval in hours between ANALYZE, PRAGMA optimize and incremental vacuum runs, 0 disables maintenance.
+    int maintenance_interval;
+    // Queries slower than this many milliseconds are logged with their query plan, 0 disables logging.
+    int slow_query_threshold;
+    // Only write the pages that changed since the last backup to the backup file, instead of copying the whole database.
+    bool incremental_backup;
+  };
 
   struct AttachedDatabase {
     AttachedDatabase() {}
@@ -64,13 +84,20 @@ class Database : public QObject {
 
   void ExitAsync();
   QSqlDatabase Connect();
+  // Read-only connection for the current thread. In WAL mode readers don't block and aren't blocked by the writer,
+  // so queries using this connection should lock ReadMutex() instead of Mutex().
+  QSqlDatabase ReadConnection();
+  // Aborts the query running on the reader connection of the given thread, it fails with SQLITE_INTERRUPT.
+  void InterruptReadConnection(QThread *thread);
   void Close();
   void ReportErrors(const SqlQuery &query);
 
 #if QT_VERSION >= QT_VERSION_CHECK(5, 14, 0)
   QRecursiveMutex *Mutex() { return &mutex_; }
+  QRecursiveMutex *ReadMutex() { return wal_enabled() ? nullptr : &mutex_; }
 #else
   QMutex *Mutex() { return &mutex_; }
+  QMutex *ReadMutex() { return wal_enabled() ? nullptr : &mutex_; }
 #endif
 
   void RecreateAttachedDb(const QString &database_name);
@@ -79,6 +106,9 @@ class Database : public QObject {
   int startup_schema_version() const { return startup_schema_version_; }
   int current_schema_version() const { return kSchemaVersion; }
 
+  // Whether the FTS table has a trigram tokenized copy, which can match any substring of the columns.
+  bool HasFtsTrigramTable(const QString &fts_table) const { return fts_trigram_tables_.contains(fts_table); }
+
   void AttachDatabase(const QString &database_name, const AttachedDatabase &database);
   void AttachDatabaseOnDbConnection(const QString &database_name, const AttachedDatabase &database, QSqlDatabase &db);
   void DetachDatabase(const QString &database_name);
@@ -90,6 +120,8 @@ class Database : public QObject {
 
  private slots:
   void Exit();
+  void Checkpoint();
+  void Maintenance();
 
  public slots:
   void DoBackup();
@@ -97,6 +129,8 @@ class Database : public QObject {
  private:
   static int SchemaVersion(QSqlDatabase *db);
   void UpdateMainSchema(QSqlDatabase *db);
+  void UpdateFtsTrigramTables(QSqlDatabase &db);
+  bool ExecCommands(QSqlDatabase &db, const QStringList &commands);
 
   void ExecSchemaCommandsFromFile(QSqlDatabase &db, const QString &filename, int schema_version, bool in_transaction = false);
   void ExecSongTablesCommands(QSqlDatabase &db, const QStringList &song_tables, const QStringList &commands);
@@ -106,7 +140,12 @@ class Database : public QObject {
   QStringList SongsTables(QSqlDatabase &db, const int schema_version);
   bool IntegrityCheck(const QSqlDatabase &db);
   void BackupFile(const QString &filename);
-  static bool OpenDatabase(const QString &filename, sqlite3 **connection);
+  static bool OpenDatabase(const QString &filename, sqlite3 **connection, const int flags = SQLITE_OPEN_READWRITE | SQLITE_OPEN_CREATE);
+  bool IncrementalBackup(sqlite3 *source_connection, const QString &dest_filename, const int task_id);
+  void LoadConnectionProfile();
+  void ApplyConnectionProfile(QSqlDatabase &db, const bool read_only = false);
+  bool wal_enabled() const;
+  void CloseConnection(const QString &connection_id);
 
   Application *app_;
 
@@ -115,6 +154,7 @@ class Database : public QObject {
 
   QString directory_;
   QMutex connect_mutex_;
+  QMap<QThread*, sqlite3*> read_handles_;
 #if QT_VERSION >= QT_VERSION_CHECK(5, 14, 0)
   QRecursiveMutex mutex_;
 #else
@@ -138,6 +178,11 @@ class Database : public QObject {
 
   QThread *original_thread_;
 
+  ConnectionProfile connection_profile_;
+  QStringList fts_trigram_tables_;
+  QTimer *checkpoint_timer_;
+  QTimer *maintenance_timer_;
+
 };
 
 class MemoryDatabase : public Database {
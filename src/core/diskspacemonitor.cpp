@@ -0,0 +1,128 @@
+/*
+ * Strawberry Music Player
+ *
+ * Strawberry is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Strawberry is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Strawberry.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#include "config.h"
+
+#include <QtGlobal>
+#include <QObject>
+#include <QtConcurrentRun>
+#include <QThreadPool>
+#include <QFuture>
+#include <QFutureWatcher>
+#include <QTimer>
+#include <QMap>
+#include <QString>
+#include <QStringList>
+
+#include "utilities/diskutils.h"
+#include "diskspacemonitor.h"
+
+const int DiskSpaceMonitor::kPollIntervalMsec = 30000;
+
+DiskSpaceMonitor::DiskSpaceMonitor(QObject *parent)
+    : QObject(parent),
+      timer_poll_(new QTimer(this)),
+      thread_pool_(new QThreadPool(this)),
+      polling_(false),
+      poll_again_(false) {
+
+  // A single thread, so a filesystem that doesn't answer doesn't pile up polls.
+  thread_pool_->setMaxThreadCount(1);
+
+  timer_poll_->setInterval(kPollIntervalMsec);
+  QObject::connect(timer_poll_, &QTimer::timeout, this, &DiskSpaceMonitor::Poll);
+
+}
+
+void DiskSpaceMonitor::Watch(const QString &path) {
+
+  if (path.isEmpty()) return;
+
+  if (++watched_[path] > 1) return;
+
+  if (!timer_poll_->isActive()) timer_poll_->start();
+  Poll();
+
+}
+
+void DiskSpaceMonitor::Unwatch(const QString &path) {
+
+  if (!watched_.contains(path)) return;
+
+  if (--watched_[path] > 0) return;
+
+  watched_.remove(path);
+  usage_.remove(path);
+
+  if (watched_.isEmpty()) timer_poll_->stop();
+
+}
+
+void DiskSpaceMonitor::Poll() {
+
+  if (watched_.isEmpty()) return;
+
+  if (polling_) {
+    poll_again_ = true;
+    return;
+  }
+
+  polling_ = true;
+  poll_again_ = false;
+
+  const QStringList paths = watched_.keys();
+  QFuture<UsageMap> future = QtConcurrent::run(thread_pool_, &DiskSpaceMonitor::PollPaths, paths);
+  QFutureWatcher<UsageMap> *watcher = new QFutureWatcher<UsageMap>();
+  QObject::connect(watcher, &QFutureWatcher<UsageMap>::finished, this, &DiskSpaceMonitor::PollFinished);
+  watcher->setFuture(future);
+
+}
+
+DiskSpaceMonitor::UsageMap DiskSpaceMonitor::PollPaths(const QStringList &paths) {
+
+  UsageMap usage;
+  for (const QString &path : paths) {
+    Usage path_usage;
+    path_usage.capacity = Utilities::FileSystemCapacity(path);
+    path_usage.free_space = Utilities::FileSystemFreeSpace(path);
+    usage.insert(path, path_usage);
+  }
+
+  return usage;
+
+}
+
+void DiskSpaceMonitor::PollFinished() {
+
+  QFutureWatcher<UsageMap> *watcher = static_cast<QFutureWatcher<UsageMap>*>(sender());
+  const UsageMap usage = watcher->result();
+  watcher->deleteLater();
+
+  polling_ = false;
+
+  for (UsageMap::const_iterator it = usage.constBegin(); it != usage.constEnd(); ++it) {
+    // The path could have been unwatched while it was polled.
+    if (!watched_.contains(it.key())) continue;
+    if (usage_.contains(it.key()) && usage_[it.key()] == it.value()) continue;
+    usage_[it.key()] = it.value();
+    emit UsageChanged(it.key());
+  }
+
+  if (poll_again_) Poll();
+
+}
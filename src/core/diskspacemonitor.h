@@ -0,0 +1,80 @@
+/*
+ * Strawberry Music Player
+ *
+ * Strawberry is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Strawberry is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Strawberry.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#ifndef DISKSPACEMONITOR_H
+#define DISKSPACEMONITOR_H
+
+#include "config.h"
+
+#include <QtGlobal>
+#include <QObject>
+#include <QMap>
+#include <QString>
+#include <QStringList>
+
+class QTimer;
+class QThreadPool;
+
+// Keeps the capacity and free space of a set of paths.
+// The filesystems are polled in a worker thread, so a slow network mount never blocks the GUI thread.
+// Reading the usage only returns the cached values, UsageChanged is emitted when they change.
+class DiskSpaceMonitor : public QObject {
+  Q_OBJECT
+
+ public:
+  explicit DiskSpaceMonitor(QObject *parent = nullptr);
+
+  static const int kPollIntervalMsec;
+
+  struct Usage {
+    Usage() : capacity(0), free_space(0) {}
+    bool operator==(const Usage &other) const { return capacity == other.capacity && free_space == other.free_space; }
+    bool operator!=(const Usage &other) const { return !(*this == other); }
+    quint64 capacity;
+    quint64 free_space;
+  };
+
+  void Watch(const QString &path);
+  void Unwatch(const QString &path);
+
+  // The capacity is 0 until the path has been polled once.
+  Usage usage(const QString &path) const { return usage_.value(path); }
+
+ public slots:
+  void Poll();
+
+ signals:
+  void UsageChanged(const QString &path);
+
+ private slots:
+  void PollFinished();
+
+ private:
+  using UsageMap = QMap<QString, Usage>;
+  static UsageMap PollPaths(const QStringList &paths);
+
+ private:
+  QTimer *timer_poll_;
+  QThreadPool *thread_pool_;
+  QMap<QString, int> watched_;
+  UsageMap usage_;
+  bool polling_;
+  bool poll_again_;
+};
+
+#endif  // DISKSPACEMONITOR_H
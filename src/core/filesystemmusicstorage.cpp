@@ -34,8 +34,19 @@
 
 #include "filesystemmusicstorage.h"
 
+namespace {
+constexpr int kMaxConcurrentCopies = 4;
+}
+
 FilesystemMusicStorage::FilesystemMusicStorage(const Song::Source source, const QString &root, const std::optional<int> collection_directory_id) : source_(source), root_(root), collection_directory_id_(collection_directory_id) {}
 
+int FilesystemMusicStorage::MaxConcurrentCopies() const {
+
+  // A local disk keeps up with a few copies at once, removable drives are usually slower and are limited further by FilesystemDevice.
+  return kMaxConcurrentCopies;
+
+}
+
 bool FilesystemMusicStorage::CopyToStorage(const CopyJob &job, QString &error_text) {
 
   const QFileInfo src = QFileInfo(job.source_);
@@ -74,10 +85,10 @@ bool FilesystemMusicStorage::CopyToStorage(const CopyJob &job, QString &error_te
       qLog(Error) << error_text;
     }
     else {
-      result = QFile::rename(src.absoluteFilePath(), dest.absoluteFilePath());
+      result = Utilities::FastMoveFile(src.absoluteFilePath(), dest.absoluteFilePath());
     }
     if ((!cover_dest.exists() || job.overwrite_) && !cover_src.filePath().isEmpty() && !cover_dest.filePath().isEmpty()) {
-      QFile::rename(cover_src.absoluteFilePath(), cover_dest.absoluteFilePath());
+      Utilities::FastMoveFile(cover_src.absoluteFilePath(), cover_dest.absoluteFilePath());
     }
     // Remove empty directories.
     QDir remove_dir(src.absolutePath(), QString(), QDir::Name, QDir::NoDotAndDotDot);
@@ -93,14 +104,14 @@ bool FilesystemMusicStorage::CopyToStorage(const CopyJob &job, QString &error_te
       qLog(Error) << error_text;
     }
     else {
-      result = QFile::copy(src.absoluteFilePath(), dest.absoluteFilePath());
+      result = Utilities::FastCopyFile(src.absoluteFilePath(), dest.absoluteFilePath());
       if (!result) {
         error_text = QObject::tr("Could not copy file %1 to %2.").arg(src.absoluteFilePath(), dest.absoluteFilePath());
         qLog(Error) << error_text;
       }
     }
     if ((!cover_dest.exists() || job.overwrite_) && !cover_src.filePath().isEmpty() && !cover_dest.filePath().isEmpty()) {
-      QFile::copy(cover_src.absoluteFilePath(), cover_dest.absoluteFilePath());
+      Utilities::FastCopyFile(cover_src.absoluteFilePath(), cover_dest.absoluteFilePath());
     }
   }
 
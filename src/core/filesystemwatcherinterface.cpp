@@ -29,13 +29,19 @@
 #  include "macfslistener.h"
 #endif
 
+#ifdef HAVE_INOTIFY
+#  include "inotifyfslistener.h"
+#endif
+
 FileSystemWatcherInterface::FileSystemWatcherInterface(QObject *parent)
     : QObject(parent) {}
 
 FileSystemWatcherInterface *FileSystemWatcherInterface::Create(QObject *parent) {
 
-#ifdef Q_OS_MACOS
+#if defined(Q_OS_MACOS)
   FileSystemWatcherInterface *ret = new MacFSListener(parent);
+#elif defined(HAVE_INOTIFY)
+  FileSystemWatcherInterface *ret = new InotifyFSListener(parent);
 #else
   FileSystemWatcherInterface *ret = new QtFSListener(parent);
 #endif
@@ -25,6 +25,7 @@
 
 #include <QObject>
 #include <QString>
+#include <QStringList>
 
 class FileSystemWatcherInterface : public QObject {
   Q_OBJECT
@@ -41,6 +42,8 @@ class FileSystemWatcherInterface : public QObject {
 
  signals:
   void PathChanged(const QString &path);
+  // Emitted instead of PathChanged() by listeners that coalesce events.
+  void PathsChanged(const QStringList &paths);
 };
 
 #endif
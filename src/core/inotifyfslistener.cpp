@@ -0,0 +1,191 @@
+/*
+ * Strawberry Music Player
+ *
+ * Strawberry is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Strawberry is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Strawberry.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#include "config.h"
+
+#include <sys/inotify.h>
+#include <unistd.h>
+#include <cerrno>
+#include <cstring>
+#include <chrono>
+
+#include <QObject>
+#include <QSocketNotifier>
+#include <QTimer>
+#include <QFile>
+#include <QByteArray>
+#include <QString>
+#include <QList>
+#include <QMultiHash>
+#include <QStringList>
+
+#include "core/logging.h"
+#include "filesystemwatcherinterface.h"
+#include "inotifyfslistener.h"
+
+using namespace std::chrono_literals;
+
+namespace {
+constexpr quint32 kWatchMask = IN_CREATE | IN_DELETE | IN_MOVED_FROM | IN_MOVED_TO | IN_CLOSE_WRITE | IN_ATTRIB | IN_DELETE_SELF | IN_MOVE_SELF | IN_ONLYDIR;
+constexpr int kEventBufferSize = 16384;
+}  // namespace
+
+InotifyFSListener::InotifyFSListener(QObject *parent)
+    : FileSystemWatcherInterface(parent),
+      fd_(-1),
+      notifier_(nullptr),
+      timer_emit_changed_(new QTimer(this)),
+      watch_limit_reached_(false) {
+
+  timer_emit_changed_->setSingleShot(true);
+  timer_emit_changed_->setInterval(500ms);
+  QObject::connect(timer_emit_changed_, &QTimer::timeout, this, &InotifyFSListener::EmitChangedPaths);
+
+}
+
+InotifyFSListener::~InotifyFSListener() {
+
+  if (fd_ != -1) {
+    close(fd_);
+  }
+
+}
+
+void InotifyFSListener::Init() {
+
+  fd_ = inotify_init1(IN_NONBLOCK | IN_CLOEXEC);
+  if (fd_ == -1) {
+    qLog(Error) << "Failed to initialize inotify:" << strerror(errno);
+    return;
+  }
+
+  notifier_ = new QSocketNotifier(fd_, QSocketNotifier::Read, this);
+  QObject::connect(notifier_, &QSocketNotifier::activated, this, &InotifyFSListener::ReadEvents);
+
+}
+
+void InotifyFSListener::AddPath(const QString &path) {
+
+  if (fd_ == -1 || paths_.contains(path)) return;
+
+  const int wd = inotify_add_watch(fd_, QFile::encodeName(path).constData(), kWatchMask);
+  if (wd == -1) {
+    if (errno == ENOSPC) {
+      if (!watch_limit_reached_) {
+        qLog(Error) << "Reached the inotify watch limit after" << paths_.count() << "directories, increase fs.inotify.max_user_watches to monitor the whole collection.";
+        watch_limit_reached_ = true;
+      }
+    }
+    else {
+      qLog(Error) << "Failed to add watch for path" << path << strerror(errno);
+    }
+    return;
+  }
+
+  // Watching the same directory through another path (i.e. a symlink) returns the same watch descriptor.
+  watches_.insert(wd, path);
+  paths_.insert(path, wd);
+
+}
+
+void InotifyFSListener::RemovePath(const QString &path) {
+
+  QHash<QString, int>::iterator it = paths_.find(path);
+  if (it == paths_.end()) {
+    qLog(Error) << "Failed to remove watch for path" << path;
+    return;
+  }
+
+  const int wd = it.value();
+  paths_.erase(it);
+  watches_.remove(wd, path);
+
+  // Keep the watch while other paths still use it.
+  if (!watches_.contains(wd)) {
+    inotify_rm_watch(fd_, wd);
+  }
+
+}
+
+void InotifyFSListener::Clear() {
+
+  const QList<int> wds = watches_.uniqueKeys();
+  for (const int wd : wds) {
+    inotify_rm_watch(fd_, wd);
+  }
+  watches_.clear();
+  paths_.clear();
+  changed_paths_.clear();
+  watch_limit_reached_ = false;
+
+}
+
+void InotifyFSListener::ReadEvents() {
+
+  alignas(inotify_event) char buffer[kEventBufferSize];
+
+  forever {
+    const ssize_t length = read(fd_, buffer, sizeof(buffer));
+    if (length <= 0) break;
+
+    for (const char *ptr = buffer; ptr < buffer + length;) {
+      const inotify_event *event = reinterpret_cast<const inotify_event*>(ptr);
+      ptr += sizeof(inotify_event) + event->len;
+
+      if (event->mask & IN_Q_OVERFLOW) {
+        // Events were lost, so we have to assume everything changed.
+        qLog(Debug) << "inotify event queue overflowed.";
+        for (QHash<QString, int>::const_iterator it = paths_.constBegin(); it != paths_.constEnd(); ++it) {
+          changed_paths_ << it.key();
+        }
+        continue;
+      }
+
+      const QList<QString> watch_paths = watches_.values(event->wd);
+      if (watch_paths.isEmpty()) continue;
+
+      for (const QString &watch_path : watch_paths) {
+        changed_paths_ << watch_path;
+      }
+
+      if (event->mask & IN_IGNORED) {
+        // The watch was removed by the kernel because the directory was deleted or unmounted.
+        for (const QString &watch_path : watch_paths) {
+          paths_.remove(watch_path);
+        }
+        watches_.remove(event->wd);
+      }
+    }
+  }
+
+  if (!changed_paths_.isEmpty() && !timer_emit_changed_->isActive()) {
+    timer_emit_changed_->start();
+  }
+
+}
+
+void InotifyFSListener::EmitChangedPaths() {
+
+  if (changed_paths_.isEmpty()) return;
+
+  const QStringList paths(changed_paths_.begin(), changed_paths_.end());
+  changed_paths_.clear();
+
+  emit PathsChanged(paths);
+
+}
@@ -0,0 +1,64 @@
+/*
+ * Strawberry Music Player
+ *
+ * Strawberry is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Strawberry is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Strawberry.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#ifndef INOTIFYFSLISTENER_H
+#define INOTIFYFSLISTENER_H
+
+#include "config.h"
+
+#include <QObject>
+#include <QHash>
+#include <QMultiHash>
+#include <QSet>
+#include <QString>
+
+#include "filesystemwatcherinterface.h"
+
+class QSocketNotifier;
+class QTimer;
+
+// Watches directories with a single inotify instance.
+// Events are coalesced and the changed directories are emitted in batches through PathsChanged().
+class InotifyFSListener : public FileSystemWatcherInterface {
+  Q_OBJECT
+
+ public:
+  explicit InotifyFSListener(QObject *parent = nullptr);
+  ~InotifyFSListener() override;
+
+  void Init() override;
+  void AddPath(const QString &path) override;
+  void RemovePath(const QString &path) override;
+  void Clear() override;
+
+ private slots:
+  void ReadEvents();
+  void EmitChangedPaths();
+
+ private:
+  int fd_;
+  QSocketNotifier *notifier_;
+  QTimer *timer_emit_changed_;
+  // Paths that resolve to the same directory share a watch descriptor.
+  QMultiHash<int, QString> watches_;
+  QHash<QString, int> paths_;
+  QSet<QString> changed_paths_;
+  bool watch_limit_reached_;
+};
+
+#endif  // INOTIFYFSLISTENER_H
@@ -79,6 +79,8 @@
 #endif
 
 #include "core/logging.h"
+#include "core/trace.h"
+#include "core/memorystats.h"
 
 #include "mainwindow.h"
 #include "ui_mainwindow.h"
@@ -133,6 +135,7 @@
 #include "collection/collectiondirectorymodel.h"
 #include "collection/collectionfilterwidget.h"
 #include "collection/collectionmodel.h"
+#include "collection/collectionsortmodel.h"
 #include "collection/collectionview.h"
 #include "collection/collectionviewcontainer.h"
 #include "playlist/playlist.h"
@@ -204,6 +207,7 @@
 #endif
 
 #include "smartplaylists/smartplaylistsviewcontainer.h"
+#include "smartplaylists/playlistsimilargenerator.h"
 
 #include "organize/organizeerrordialog.h"
 
@@ -311,7 +315,14 @@ MainWindow::MainWindow(Application *app, SharedPtr<SystemTrayIcon> tray_icon, OS
       qobuz_view_(new InternetTabsView(app_, app->internet_services()->ServiceBySource(Song::Source::Qobuz), QLatin1String(QobuzSettingsPage::kSettingsGroup), SettingsDialog::Page::Qobuz, this)),
 #endif
       radio_view_(new RadioViewContainer(this)),
-      lastfm_import_dialog_(new LastFMImportDialog(app_->lastfm_import(), this)),
+      lastfm_import_dialog_([this, app]() {
+        LastFMImportDialog *dialog = new LastFMImportDialog(app->lastfm_import(), this);
+        QObject::connect(&*app->lastfm_import(), &LastFMImport::Finished, dialog, &LastFMImportDialog::Finished);
+        QObject::connect(&*app->lastfm_import(), &LastFMImport::FinishedWithError, dialog, &LastFMImportDialog::FinishedWithError);
+        QObject::connect(&*app->lastfm_import(), &LastFMImport::UpdateTotal, dialog, &LastFMImportDialog::UpdateTotal);
+        QObject::connect(&*app->lastfm_import(), &LastFMImport::UpdateProgress, dialog, &LastFMImportDialog::UpdateProgress);
+        return dialog;
+      }),
       collection_show_all_(nullptr),
       collection_show_duplicates_(nullptr),
       collection_show_untagged_(nullptr),
@@ -332,10 +343,11 @@ MainWindow::MainWindow(Application *app, SharedPtr<SystemTrayIcon> tray_icon, OS
       playlist_queue_(nullptr),
       playlist_queue_play_next_(nullptr),
       playlist_skip_(nullptr),
+      playlist_similar_mix_(nullptr),
       playlist_add_to_another_(nullptr),
       playlistitem_actions_separator_(nullptr),
       playlist_rescan_songs_(nullptr),
-      collection_sort_model_(new QSortFilterProxyModel(this)),
+      collection_sort_model_(new CollectionSortModel(this)),
       track_position_timer_(new QTimer(this)),
       track_slider_timer_(new QTimer(this)),
       keep_running_(false),
@@ -358,6 +370,8 @@ MainWindow::MainWindow(Application *app, SharedPtr<SystemTrayIcon> tray_icon, OS
 
   qLog(Debug) << "Starting";
 
+  TRACE_SCOPE("startup", "MainWindow::MainWindow");
+
   QObject::connect(app, &Application::ErrorAdded, this, &MainWindow::ShowErrorDialog);
   QObject::connect(app, &Application::SettingsDialogRequested, this, &MainWindow::OpenSettingsDialogAtPage);
 
@@ -419,9 +433,7 @@ MainWindow::MainWindow(Application *app, SharedPtr<SystemTrayIcon> tray_icon, OS
   // Models
   qLog(Debug) << "Creating models";
   collection_sort_model_->setSourceModel(app_->collection()->model());
-  collection_sort_model_->setSortRole(CollectionModel::Role_SortText);
   collection_sort_model_->setDynamicSortFilter(true);
-  collection_sort_model_->setSortLocaleAware(true);
   collection_sort_model_->sort(0);
 
   qLog(Debug) << "Creating models finished";
@@ -514,6 +526,7 @@ MainWindow::MainWindow(Application *app, SharedPtr<SystemTrayIcon> tray_icon, OS
 #  endif
 #endif
   file_view_->SetTaskManager(app_->task_manager());
+  file_view_->SetCollectionBackend(app_->collection_backend());
 
   // Action connections
   QObject::connect(ui_->action_next_track, &QAction::triggered, &*app_->player(), &Player::Next);
@@ -536,7 +549,7 @@ MainWindow::MainWindow(Application *app, SharedPtr<SystemTrayIcon> tray_icon, OS
   QObject::connect(ui_->action_auto_complete_tags, &QAction::triggered, this, &MainWindow::AutoCompleteTags);
 #endif
   QObject::connect(ui_->action_settings, &QAction::triggered, this, &MainWindow::OpenSettingsDialog);
-  QObject::connect(ui_->action_import_data_from_last_fm, &QAction::triggered, lastfm_import_dialog_, &LastFMImportDialog::show);
+  QObject::connect(ui_->action_import_data_from_last_fm, &QAction::triggered, this, [this]() { lastfm_import_dialog_->show(); });
   QObject::connect(ui_->action_toggle_show_sidebar, &QAction::toggled, this, &MainWindow::ToggleSidebar);
   QObject::connect(ui_->action_about_strawberry, &QAction::triggered, this, &MainWindow::ShowAboutDialog);
   QObject::connect(ui_->action_about_qt, &QAction::triggered, qApp, &QApplication::aboutQt);
@@ -741,6 +754,7 @@ MainWindow::MainWindow(Application *app, SharedPtr<SystemTrayIcon> tray_icon, OS
   ui_->playlist->addAction(playlist_queue_play_next_);
   playlist_skip_ = playlist_menu_->addAction(IconLoader::Load(QStringLiteral("media-skip-forward")), tr("Toggle skip status"), this, &MainWindow::PlaylistSkip);
   ui_->playlist->addAction(playlist_skip_);
+  playlist_similar_mix_ = playlist_menu_->addAction(IconLoader::Load(QStringLiteral("media-playlist-shuffle")), tr("Start a similar mix"), this, &MainWindow::PlaylistSimilarMix);
 
   playlist_menu_->addSeparator();
   playlist_menu_->addAction(ui_->action_remove_from_playlist);
@@ -907,12 +921,6 @@ MainWindow::MainWindow(Application *app, SharedPtr<SystemTrayIcon> tray_icon, OS
   LoveButtonVisibilityChanged(app_->scrobbler()->love_button());
   ScrobblingEnabledChanged(app_->scrobbler()->enabled());
 
-  // Last.fm ImportData
-  QObject::connect(&*app_->lastfm_import(), &LastFMImport::Finished, lastfm_import_dialog_, &LastFMImportDialog::Finished);
-  QObject::connect(&*app_->lastfm_import(), &LastFMImport::FinishedWithError, lastfm_import_dialog_, &LastFMImportDialog::FinishedWithError);
-  QObject::connect(&*app_->lastfm_import(), &LastFMImport::UpdateTotal, lastfm_import_dialog_, &LastFMImportDialog::UpdateTotal);
-  QObject::connect(&*app_->lastfm_import(), &LastFMImport::UpdateProgress, lastfm_import_dialog_, &LastFMImportDialog::UpdateProgress);
-
   // Load settings
   qLog(Debug) << "Loading settings";
   settings_.beginGroup(kSettingsGroup);
@@ -1943,6 +1951,7 @@ void MainWindow::PlaylistRightClick(const QPoint global_pos, const QModelIndex &
   int in_skipped = 0;
   int not_in_skipped = 0;
   int local_songs = 0;
+  int collection_songs = 0;
 
   for (const QModelIndex &idx : selection) {
 
@@ -1953,6 +1962,7 @@ void MainWindow::PlaylistRightClick(const QPoint global_pos, const QModelIndex &
     if (!item) continue;
 
     if (item->Metadata().url().isLocalFile()) ++local_songs;
+    if (item->IsLocalCollectionItem() && item->Metadata().id() != -1) ++collection_songs;
 
     if (item->Metadata().has_cue()) {
       cue_selected = true;
@@ -2004,6 +2014,7 @@ void MainWindow::PlaylistRightClick(const QPoint global_pos, const QModelIndex &
   playlist_delete_->setVisible(false);
 
   playlist_copy_url_->setVisible(selected > 0);
+  playlist_similar_mix_->setVisible(collection_songs > 0);
 
   if (selected < 1) {
     playlist_queue_->setVisible(false);
@@ -2388,19 +2399,6 @@ void MainWindow::PlaylistRemoveCurrent() {
 
 void MainWindow::PlaylistClearCurrent() {
 
-  if (app_->playlist_manager()->current()->rowCount() > Playlist::kUndoItemLimit) {
-    QMessageBox messagebox(QMessageBox::Warning, tr("Clear playlist"), tr("Playlist has %1 songs, too large to undo, are you sure you want to clear the playlist?").arg(app_->playlist_manager()->current()->rowCount()), QMessageBox::Ok | QMessageBox::Cancel);
-    messagebox.setTextFormat(Qt::RichText);
-    int result = messagebox.exec();
-    switch (result) {
-      case QMessageBox::Ok:
-        break;
-      case QMessageBox::Cancel:
-      default:
-        return;
-    }
-  }
-
   app_->playlist_manager()->ClearCurrent();
 
 }
@@ -2501,6 +2499,14 @@ void MainWindow::CommandlineOptionsReceived(const CommandlineOptions &options) {
       break;
     }
 
+    case CommandlineOptions::PlayerAction::LogMemoryStats:{
+      const QStringList lines = memorystats::Report().split(QLatin1Char('\n'));
+      for (const QString &line : lines) {
+        qLog(Info) << line;
+      }
+      break;
+    }
+
     case CommandlineOptions::PlayerAction::None:
       break;
 
@@ -2815,6 +2821,27 @@ void MainWindow::PlaylistSkip() {
 
 }
 
+void MainWindow::PlaylistSimilarMix() {
+
+  QList<int> seed_ids;
+  QString title;
+  for (const QModelIndex &proxy_index : ui_->playlist->view()->selectionModel()->selectedRows()) {
+    const QModelIndex source_index = app_->playlist_manager()->current()->filter()->mapToSource(proxy_index);
+    if (!source_index.isValid()) continue;
+    PlaylistItemPtr item = app_->playlist_manager()->current()->item_at(source_index.row());
+    if (!item || !item->IsLocalCollectionItem() || item->Metadata().id() == -1) continue;
+    if (title.isEmpty()) title = item->Metadata().PrettyTitle();
+    seed_ids << item->Metadata().id();
+  }
+
+  if (seed_ids.isEmpty()) return;
+
+  PlaylistGeneratorPtr generator = make_shared<PlaylistSimilarGenerator>(tr("Similar to %1").arg(title), seed_ids);
+  generator->set_collection_backend(app_->collection_backend());
+  app_->playlist_manager()->PlaySmartPlaylist(generator, true, false);
+
+}
+
 void MainWindow::PlaylistCopyToDevice() {
 
 #ifndef Q_OS_WIN
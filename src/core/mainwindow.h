@@ -157,6 +157,7 @@ class MainWindow : public QMainWindow, public PlatformInterface {
   void PlaylistQueue();
   void PlaylistQueuePlayNext();
   void PlaylistSkip();
+  void PlaylistSimilarMix();
   void PlaylistRemoveCurrent();
   void PlaylistEditFinished(const int playlist_id, const QModelIndex &idx);
   void PlaylistClearCurrent();
@@ -346,7 +347,8 @@ class MainWindow : public QMainWindow, public PlatformInterface {
 
   RadioViewContainer *radio_view_;
 
-  LastFMImportDialog *lastfm_import_dialog_;
+  // Creating the dialog creates the Last.fm import, so it's only done when it's used.
+  Lazy<LastFMImportDialog> lastfm_import_dialog_;
 
   QAction *collection_show_all_;
   QAction *collection_show_duplicates_;
@@ -369,6 +371,7 @@ class MainWindow : public QMainWindow, public PlatformInterface {
   QAction *playlist_queue_;
   QAction *playlist_queue_play_next_;
   QAction *playlist_skip_;
+  QAction *playlist_similar_mix_;
   QAction *playlist_add_to_another_;
   QList<QAction*> playlistitem_actions_;
   QAction *playlistitem_actions_separator_;
@@ -0,0 +1,177 @@
+/*
+ * Strawberry Music Player
+ *
+ * Strawberry is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Strawberry is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Strawberry.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#include "config.h"
+
+#include <atomic>
+#include <utility>
+
+#include <QtGlobal>
+#include <QMutex>
+#include <QList>
+#include <QPair>
+#include <QByteArray>
+#include <QString>
+#include <QStringList>
+#include <QPixmapCache>
+#ifdef Q_OS_LINUX
+#  include <QFile>
+#  include <QIODevice>
+#  include <unistd.h>
+#endif
+
+#include <sqlite3.h>
+
+#include "utilities/strutils.h"
+#include "memorystats.h"
+
+// clazy:excludeall=non-pod-global-static
+
+namespace memorystats {
+
+namespace {
+
+constexpr int kCounterCount = 3;
+
+std::atomic<qint64> sObjects[kCounterCount];
+std::atomic<qint64> sBytes[kCounterCount];
+
+QMutex sProvidersMutex;
+QList<QPair<const void*, Provider>> sProviders;
+
+QString CounterName(const Counter counter) {
+
+  switch (counter) {
+    case Counter::SongPrivate:
+      return QStringLiteral("Song::Private");
+    case Counter::CollectionItem:
+      return QStringLiteral("CollectionItem");
+    case Counter::PlaylistItem:
+      return QStringLiteral("PlaylistItem");
+  }
+
+  return QString();
+
+}
+
+#ifdef Q_OS_LINUX
+qint64 ResidentBytes() {
+
+  QFile file(QStringLiteral("/proc/self/statm"));
+  if (!file.open(QIODevice::ReadOnly)) return -1;
+  const QList<QByteArray> fields = file.readAll().simplified().split(' ');
+  file.close();
+  if (fields.count() < 2) return -1;
+
+  return fields[1].toLongLong() * static_cast<qint64>(sysconf(_SC_PAGESIZE));
+
+}
+#endif
+
+QString PrettyBytes(const qint64 bytes) {
+  return bytes < 0 ? QStringLiteral("?") : Utilities::PrettySize(static_cast<quint64>(bytes));
+}
+
+}  // namespace
+
+void Add(const Counter counter, const qint64 objects, const qint64 bytes) {
+
+  const int i = static_cast<int>(counter);
+  sObjects[i].fetch_add(objects, std::memory_order_relaxed);
+  sBytes[i].fetch_add(bytes, std::memory_order_relaxed);
+
+}
+
+void AddProvider(const void *owner, const Provider &provider) {
+
+  QMutexLocker l(&sProvidersMutex);
+  sProviders << qMakePair(owner, provider);
+
+}
+
+void RemoveProviders(const void *owner) {
+
+  QMutexLocker l(&sProvidersMutex);
+  for (int i = sProviders.count() - 1; i >= 0; --i) {
+    if (sProviders[i].first == owner) sProviders.removeAt(i);
+  }
+
+}
+
+QList<Entry> Snapshot() {
+
+  QList<Entry> entries;
+
+  for (int i = 0; i < kCounterCount; ++i) {
+    entries << Entry(CounterName(static_cast<Counter>(i)), sObjects[i].load(std::memory_order_relaxed), sBytes[i].load(std::memory_order_relaxed));
+  }
+
+  {
+    // Caches with several instances, like one for each view, are reported together.
+    QMutexLocker l(&sProvidersMutex);
+    for (const QPair<const void*, Provider> &provider : std::as_const(sProviders)) {
+      const Entry entry = provider.second();
+      bool found = false;
+      for (Entry &existing_entry : entries) {
+        if (existing_entry.name != entry.name) continue;
+        existing_entry.objects += entry.objects;
+        existing_entry.bytes = existing_entry.bytes < 0 || entry.bytes < 0 ? -1 : existing_entry.bytes + entry.bytes;
+        if (entry.limit_bytes >= 0) existing_entry.limit_bytes = qMax(static_cast<qint64>(0), existing_entry.limit_bytes) + entry.limit_bytes;
+        found = true;
+        break;
+      }
+      if (!found) entries << entry;
+    }
+  }
+
+  // QPixmapCache only reports its limit.
+  entries << Entry(QStringLiteral("QPixmapCache"), 0, -1, static_cast<qint64>(QPixmapCache::cacheLimit()) * 1024);
+
+  // The page caches of all connections and the memory of the statements.
+  const sqlite3_int64 sqlite_limit = sqlite3_soft_heap_limit64(-1);
+  entries << Entry(QStringLiteral("SQLite"), 0, static_cast<qint64>(sqlite3_memory_used()), sqlite_limit > 0 ? static_cast<qint64>(sqlite_limit) : -1);
+
+  return entries;
+
+}
+
+QString Report() {
+
+  QStringList lines;
+
+#ifdef Q_OS_LINUX
+  lines << QStringLiteral("Resident size: %1").arg(PrettyBytes(ResidentBytes()));
+#endif
+
+  const QList<Entry> entries = Snapshot();
+  for (const Entry &entry : entries) {
+    QString line = QStringLiteral("%1: %2").arg(entry.name, PrettyBytes(entry.bytes));
+    if (entry.objects > 0) {
+      line += QStringLiteral(", %1 objects").arg(entry.objects);
+    }
+    if (entry.limit_bytes >= 0) {
+      line += QStringLiteral(", limit %1").arg(PrettyBytes(entry.limit_bytes));
+    }
+    lines << line;
+  }
+
+  return lines.join(QLatin1Char('\n'));
+
+}
+
+}  // namespace memorystats
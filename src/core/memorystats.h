@@ -0,0 +1,84 @@
+/*
+ * Strawberry Music Player
+ *
+ * Strawberry is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Strawberry is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Strawberry.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#ifndef MEMORYSTATS_H
+#define MEMORYSTATS_H
+
+#include "config.h"
+
+#include <functional>
+
+#include <QtGlobal>
+#include <QList>
+#include <QString>
+
+// Counters for the memory used by the objects and caches that usually make up most of the resident size.
+// Objects count themselves with an ObjectCounter member, which costs two atomic additions for each object.
+// Caches add a provider that is asked for its current size when a snapshot is made.
+// The bytes are the size of the objects themselves, memory they point to, like the strings of a song, isn't included.
+//
+// The report is shown in the console, and logged by the running instance with the --memory-stats commandline option.
+
+namespace memorystats {
+
+enum class Counter {
+  SongPrivate,
+  CollectionItem,
+  PlaylistItem
+};
+
+struct Entry {
+  explicit Entry(const QString &_name = QString(), const qint64 _objects = 0, const qint64 _bytes = 0, const qint64 _limit_bytes = -1) : name(_name), objects(_objects), bytes(_bytes), limit_bytes(_limit_bytes) {}
+
+  QString name;
+  qint64 objects;
+  // -1 if the cache doesn't report its size.
+  qint64 bytes;
+  // -1 if the cache doesn't have a limit.
+  qint64 limit_bytes;
+};
+
+using Provider = std::function<Entry()>;
+
+void Add(const Counter counter, const qint64 objects, const qint64 bytes);
+
+// Providers are called from the thread making the snapshot, so providers of caches used from other threads must lock them.
+void AddProvider(const void *owner, const Provider &provider);
+void RemoveProviders(const void *owner);
+
+// Must be called from the GUI thread.
+QList<Entry> Snapshot();
+QString Report();
+
+template<Counter counter>
+class ObjectCounter {
+ public:
+  explicit ObjectCounter(const quint32 bytes) : bytes_(bytes) { Add(counter, 1, bytes_); }
+  ObjectCounter(const ObjectCounter &other) : bytes_(other.bytes_) { Add(counter, 1, bytes_); }
+  ~ObjectCounter() { Add(counter, -1, -static_cast<qint64>(bytes_)); }
+
+  // The owner keeps its own size when it's assigned.
+  ObjectCounter &operator=(const ObjectCounter&) { return *this; }
+
+ private:
+  quint32 bytes_;
+};
+
+}  // namespace memorystats
+
+#endif  // MEMORYSTATS_H
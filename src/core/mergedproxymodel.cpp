@@ -34,13 +34,11 @@
 
 #include "mergedproxymodel.h"
 
-#include <boost/multi_index/detail/bidir_node_iterator.hpp>
 #include <boost/multi_index/detail/hash_index_iterator.hpp>
 #include <boost/multi_index/hashed_index.hpp>
 #include <boost/multi_index/identity.hpp>
 #include <boost/multi_index/indexed_by.hpp>
 #include <boost/multi_index/member.hpp>
-#include <boost/multi_index/ordered_index.hpp>
 #include <boost/multi_index/tag.hpp>
 #include <boost/multi_index_container.hpp>
 #include <boost/operators.hpp>
@@ -50,7 +48,6 @@ using boost::multi_index::identity;
 using boost::multi_index::indexed_by;
 using boost::multi_index::member;
 using boost::multi_index::multi_index_container;
-using boost::multi_index::ordered_unique;
 using boost::multi_index::tag;
 
 size_t hash_value(const QModelIndex &idx) { return qHash(idx); }
@@ -70,7 +67,8 @@ struct tag_by_pointer {};
 
 class MergedProxyModelPrivate {
  private:
-  using MappingContainer = multi_index_container<Mapping*, indexed_by<hashed_unique<tag<tag_by_source>, member<Mapping, QModelIndex, &Mapping::source_index>>, ordered_unique<tag<tag_by_pointer>, identity<Mapping*>>>>;
+  // Both indexes are hashed, mapToSource looks up the pointer of every proxy index it's given.
+  using MappingContainer = multi_index_container<Mapping*, indexed_by<hashed_unique<tag<tag_by_source>, member<Mapping, QModelIndex, &Mapping::source_index>>, hashed_unique<tag<tag_by_pointer>, identity<Mapping*>>>>;
 
  public:
   MappingContainer mappings_;
@@ -79,6 +77,7 @@ class MergedProxyModelPrivate {
 MergedProxyModel::MergedProxyModel(QObject *parent)
     : QAbstractProxyModel(parent),
       resetting_model_(nullptr),
+      merge_point_models_dirty_(true),
       p_(new MergedProxyModelPrivate) {}
 
 MergedProxyModel::~MergedProxyModel() { DeleteAllMappings(); }
@@ -105,6 +104,7 @@ void MergedProxyModel::AddSubModel(const QModelIndex &source_parent, QAbstractIt
   if (rows > 0) beginInsertRows(proxy_parent, 0, rows - 1);
 
   merge_points_.insert(submodel, source_parent);
+  InvalidateMergePointModels();
 
   if (rows > 0) endInsertRows();
 }
@@ -112,8 +112,9 @@ void MergedProxyModel::AddSubModel(const QModelIndex &source_parent, QAbstractIt
 void MergedProxyModel::RemoveSubModel(const QModelIndex &source_parent) {
 
   // Find the submodel that the parent corresponded to
-  QAbstractItemModel *submodel = merge_points_.key(source_parent);
+  QAbstractItemModel *submodel = MergePointModel(source_parent);
   merge_points_.remove(submodel);
+  InvalidateMergePointModels();
 
   // The submodel might have been deleted already so we must be careful not to dereference it.
 
@@ -181,6 +182,7 @@ void MergedProxyModel::SourceModelReset() {
   // Clear the containers
   p_->mappings_.clear();
   merge_points_.clear();
+  InvalidateMergePointModels();
 
   endResetModel();
 
@@ -250,6 +252,7 @@ void MergedProxyModel::RowsAboutToBeInserted(const QModelIndex &source_parent, i
 }
 
 void MergedProxyModel::RowsInserted(const QModelIndex&, int, int) {
+  InvalidateMergePointModels();
   endInsertRows();
 }
 
@@ -258,6 +261,7 @@ void MergedProxyModel::RowsAboutToBeRemoved(const QModelIndex &source_parent, in
 }
 
 void MergedProxyModel::RowsRemoved(const QModelIndex&, int, int) {
+  InvalidateMergePointModels();
   endRemoveRows();
 }
 
@@ -303,7 +307,7 @@ QModelIndex MergedProxyModel::index(int row, int column, const QModelIndex &pare
   }
   else {
     QModelIndex source_parent = mapToSource(parent);
-    const QAbstractItemModel *child_model = merge_points_.key(source_parent);
+    const QAbstractItemModel *child_model = MergePointModel(source_parent);
 
     if (child_model) {
       source_index = child_model->index(row, column, QModelIndex());
@@ -341,7 +345,7 @@ int MergedProxyModel::rowCount(const QModelIndex &parent) const {
   QModelIndex source_parent = mapToSource(parent);
   if (!IsKnownModel(source_parent.model())) return 0;
 
-  const QAbstractItemModel *child_model = merge_points_.key(source_parent);
+  const QAbstractItemModel *child_model = MergePointModel(source_parent);
   if (child_model) {
     // Query the source model but disregard what it says, so it gets a chance to lazy load
     source_parent.model()->rowCount(source_parent);
@@ -360,7 +364,7 @@ int MergedProxyModel::columnCount(const QModelIndex &parent) const {
   QModelIndex source_parent = mapToSource(parent);
   if (!IsKnownModel(source_parent.model())) return 0;
 
-  const QAbstractItemModel *child_model = merge_points_.key(source_parent);
+  const QAbstractItemModel *child_model = MergePointModel(source_parent);
   if (child_model) return child_model->columnCount(QModelIndex());
   return source_parent.model()->columnCount(source_parent);
 
@@ -373,7 +377,7 @@ bool MergedProxyModel::hasChildren(const QModelIndex &parent) const {
   QModelIndex source_parent = mapToSource(parent);
   if (!IsKnownModel(source_parent.model())) return false;
 
-  const QAbstractItemModel *child_model = merge_points_.key(source_parent);
+  const QAbstractItemModel *child_model = MergePointModel(source_parent);
 
   if (child_model) return child_model->hasChildren(QModelIndex()) || source_parent.model()->hasChildren(source_parent);
   return source_parent.model()->hasChildren(source_parent);
@@ -506,15 +510,33 @@ QAbstractItemModel *MergedProxyModel::GetModel(const QModelIndex &source_index)
   // This is essentially const_cast<QAbstractItemModel*>(source_index.model()), but without the const_cast
   const QAbstractItemModel *const_model = source_index.model();
   if (const_model == sourceModel()) return sourceModel();
-  const QList<QAbstractItemModel*> submodels = merge_points_.keys();
-  for (QAbstractItemModel *submodel : submodels) {
-    if (submodel == const_model) return submodel;
-  }
+  QAbstractItemModel *submodel = const_cast<QAbstractItemModel*>(const_model);
+  if (merge_points_.contains(submodel)) return submodel;
 
   return nullptr;
 
 }
 
+QAbstractItemModel *MergedProxyModel::MergePointModel(const QModelIndex &source_parent) const {
+
+  if (merge_point_models_dirty_) {
+    merge_point_models_.clear();
+    for (auto it = merge_points_.constBegin(); it != merge_points_.constEnd(); ++it) {
+      if (it.value().isValid()) {
+        merge_point_models_.insert(it.value(), it.key());
+      }
+    }
+    merge_point_models_dirty_ = false;
+  }
+
+  return merge_point_models_.value(source_parent, nullptr);
+
+}
+
+void MergedProxyModel::InvalidateMergePointModels() {
+  merge_point_models_dirty_ = true;
+}
+
 void MergedProxyModel::DataChanged(const QModelIndex &top_left, const QModelIndex &bottom_right) {
   emit dataChanged(mapFromSource(top_left), mapFromSource(bottom_right));
 }
@@ -531,6 +553,8 @@ void MergedProxyModel::LayoutAboutToBeChanged() {
 
 void MergedProxyModel::LayoutChanged() {
 
+  InvalidateMergePointModels();
+
   const QList<QAbstractItemModel*> models = merge_points_.keys();
   for (QAbstractItemModel *model : models) {
     if (!old_merge_points_.contains(model)) continue;
@@ -105,10 +105,16 @@ class MergedProxyModel : public QAbstractProxyModel {
  private:
   QModelIndex GetActualSourceParent(const QModelIndex &source_parent, QAbstractItemModel *model) const;
   QAbstractItemModel *GetModel(const QModelIndex &source_index) const;
+  // Returns the submodel merged at the given source index, or nullptr if there isn't one.
+  QAbstractItemModel *MergePointModel(const QModelIndex &source_parent) const;
+  void InvalidateMergePointModels();
   void DeleteAllMappings();
   bool IsKnownModel(const QAbstractItemModel *model) const;
 
   QHash<QAbstractItemModel*, QPersistentModelIndex> merge_points_;
+  // Reverse of merge_points_, rebuilt on demand when rows in the source model have moved.
+  mutable QHash<QModelIndex, QAbstractItemModel*> merge_point_models_;
+  mutable bool merge_point_models_dirty_;
   QAbstractItemModel *resetting_model_;
 
   QHash<QAbstractItemModel*, QModelIndex> old_merge_points_;
@@ -53,6 +53,7 @@
 #  include "engine/gstenginepipeline.h"
 #endif
 #include "collection/collectiondirectory.h"
+#include "collection/collectionbackend.h"
 #include "playlist/playlistitem.h"
 #include "playlist/playlistsequence.h"
 #include "covermanager/albumcoverloaderresult.h"
@@ -118,6 +119,8 @@ void RegisterMetaTypes() {
   qRegisterMetaType<CollectionDirectoryList>("CollectionDirectoryList");
   qRegisterMetaType<CollectionSubdirectory>("CollectionSubdirectory");
   qRegisterMetaType<CollectionSubdirectoryList>("CollectionSubdirectoryList");
+  qRegisterMetaType<CollectionBackend::PlayStatisticsUpdateList>("CollectionBackend::PlayStatisticsUpdateList");
+  qRegisterMetaType<CollectionBackend::PlayStatisticsByMetadataList>("CollectionBackend::PlayStatisticsByMetadataList");
   qRegisterMetaType<CollectionModel::Grouping>("CollectionModel::Grouping");
   qRegisterMetaType<PlaylistItemPtr>("PlaylistItemPtr");
   qRegisterMetaType<PlaylistItemPtrList>("PlaylistItemPtrList");
@@ -28,7 +28,9 @@
 #include <QCoreApplication>
 #include <QGuiApplication>
 #include <QObject>
+#include <QTimer>
 #include <QFile>
+#include <QMap>
 #include <QList>
 #include <QJsonArray>
 #include <QVariant>
@@ -101,8 +103,13 @@ constexpr char kFreedesktopPath[] = "org.freedesktop.DBus.Properties";
 Mpris2::Mpris2(Application *app, QObject *parent)
     : QObject(parent),
       app_(app),
+      timer_properties_changed_(new QTimer(this)),
       app_name_(QCoreApplication::applicationName()) {
 
+  timer_properties_changed_->setSingleShot(true);
+  timer_properties_changed_->setInterval(0);
+  QObject::connect(timer_properties_changed_, &QTimer::timeout, this, &Mpris2::EmitPropertiesChanged);
+
   new Mpris2Root(this);
   new Mpris2TrackList(this);
   new Mpris2Player(this);
@@ -165,6 +172,7 @@ void Mpris2::EngineStateChanged(EngineBase::State newState) {
 
   if (newState != EngineBase::State::Playing && newState != EngineBase::State::Paused) {
     last_metadata_ = QVariantMap();
+    last_metadata_song_ = Song();
     EmitNotification(QStringLiteral("Metadata"));
   }
 
@@ -195,12 +203,23 @@ void Mpris2::EmitNotification(const QString &name, const QVariant &value) {
 
 void Mpris2::EmitNotification(const QString &name, const QVariant &value, const QString &mprisEntity) {
 
-  QDBusMessage msg = QDBusMessage::createSignal(QLatin1String(kMprisObjectPath), QLatin1String(kFreedesktopPath), QStringLiteral("PropertiesChanged"));
-  QVariantMap map;
-  map.insert(name, value);
-  QVariantList args = QVariantList() << mprisEntity << map << QStringList();
-  msg.setArguments(args);
-  QDBusConnection::sessionBus().send(msg);
+  // A state or song change changes several properties, they're sent together in one signal when control returns to the event loop.
+  changed_properties_[mprisEntity].insert(name, value);
+  if (!timer_properties_changed_->isActive()) timer_properties_changed_->start();
+
+}
+
+void Mpris2::EmitPropertiesChanged() {
+
+  const QMap<QString, QVariantMap> changed_properties = changed_properties_;
+  changed_properties_.clear();
+
+  for (QMap<QString, QVariantMap>::const_iterator it = changed_properties.constBegin(); it != changed_properties.constEnd(); ++it) {
+    QDBusMessage msg = QDBusMessage::createSignal(QLatin1String(kMprisObjectPath), QLatin1String(kFreedesktopPath), QStringLiteral("PropertiesChanged"));
+    QVariantList args = QVariantList() << it.key() << it.value() << QStringList();
+    msg.setArguments(args);
+    QDBusConnection::sessionBus().send(msg);
+  }
 
 }
 
@@ -399,11 +418,7 @@ void Mpris2::CurrentSongChanged(const Song &song) {
 // ... and we add the cover information later, when it's available.
 void Mpris2::AlbumCoverLoaded(const Song &song, const AlbumCoverLoaderResult &result) {
 
-  last_metadata_ = QVariantMap();
-  song.ToXesam(&last_metadata_);
-
-  using mpris::AddMetadata;
-  AddMetadata(QStringLiteral("mpris:trackid"), current_track_id(), &last_metadata_);
+  const QDBusObjectPath track_id = current_track_id();
 
   QUrl cover_url;
   if (result.album_cover.cover_url.isValid() && result.album_cover.cover_url.isLocalFile() && QFile(result.album_cover.cover_url.toLocalFile()).exists()) {
@@ -419,6 +434,21 @@ void Mpris2::AlbumCoverLoaded(const Song &song, const AlbumCoverLoaderResult &re
     cover_url = song.art_automatic();
   }
 
+  // The metadata is only rebuilt and sent when the song, its position in the playlist or its cover changed.
+  if (!last_metadata_.isEmpty() && track_id == last_metadata_track_id_ && cover_url == last_metadata_cover_url_ && (song.SharesData(last_metadata_song_) || (song == last_metadata_song_ && song.IsAllMetadataEqual(last_metadata_song_)))) {
+    return;
+  }
+
+  last_metadata_song_ = song;
+  last_metadata_track_id_ = track_id;
+  last_metadata_cover_url_ = cover_url;
+
+  last_metadata_ = QVariantMap();
+  song.ToXesam(&last_metadata_);
+
+  using mpris::AddMetadata;
+  AddMetadata(QStringLiteral("mpris:trackid"), track_id, &last_metadata_);
+
   if (cover_url.isValid()) {
     AddMetadata(QStringLiteral("mpris:artUrl"), cover_url.toString(), &last_metadata_);
   }
@@ -33,16 +33,18 @@
 #include <QVariant>
 #include <QString>
 #include <QStringList>
+#include <QUrl>
 #include <QtDBus>
 #include <QDBusArgument>
 #include <qdbusextratypes.h>
 #include <QJsonObject>
 
+#include "core/song.h"
 #include "engine/enginebase.h"
 #include "covermanager/albumcoverloaderresult.h"
 
+class QTimer;
 class Application;
-class Song;
 class Playlist;
 
 using TrackMetadata = QList<QVariantMap>;
@@ -217,6 +219,7 @@ class Mpris2 : public QObject {
   void RepeatModeChanged();
   void PlaylistChangedSlot(Playlist *playlist);
   void PlaylistCollectionChanged(Playlist *playlist);
+  void EmitPropertiesChanged();
 
  private:
   void EmitNotification(const QString &name);
@@ -236,7 +239,13 @@ class Mpris2 : public QObject {
 
   QString app_name_;
   QString desktopfilepath_;
+  QTimer *timer_properties_changed_;
+  QMap<QString, QVariantMap> changed_properties_;
+
   QVariantMap last_metadata_;
+  Song last_metadata_song_;
+  QDBusObjectPath last_metadata_track_id_;
+  QUrl last_metadata_cover_url_;
 
 };
 
@@ -20,6 +20,8 @@
 
 #include "config.h"
 
+#include <limits>
+
 #include <QtGlobal>
 #include <QObject>
 #include <QAbstractItemModel>
@@ -29,26 +31,83 @@
 #include <QVariant>
 #include <QString>
 #include <QChar>
+#include <QCollator>
 
 #include "multisortfilterproxy.h"
 
 MultiSortFilterProxy::MultiSortFilterProxy(QObject *parent)
-    : QSortFilterProxyModel(parent) {}
+    : QSortFilterProxyModel(parent) {
+
+  QObject::connect(this, &QSortFilterProxyModel::sortCaseSensitivityChanged, this, &MultiSortFilterProxy::ClearSortKeys);
+  QObject::connect(this, &QSortFilterProxyModel::sortLocaleAwareChanged, this, &MultiSortFilterProxy::ClearSortKeys);
+
+}
 
 void MultiSortFilterProxy::AddSortSpec(int role, Qt::SortOrder order) {
   sorting_ << SortSpec(role, order);
+  ClearSortKeys();
+}
+
+void MultiSortFilterProxy::setSourceModel(QAbstractItemModel *source_model) {
+
+  if (sourceModel()) {
+    QObject::disconnect(sourceModel(), &QAbstractItemModel::dataChanged, this, &MultiSortFilterProxy::SourceDataChanged);
+    QObject::disconnect(sourceModel(), &QAbstractItemModel::rowsInserted, this, &MultiSortFilterProxy::ClearSortKeys);
+    QObject::disconnect(sourceModel(), &QAbstractItemModel::rowsRemoved, this, &MultiSortFilterProxy::ClearSortKeys);
+    QObject::disconnect(sourceModel(), &QAbstractItemModel::rowsMoved, this, &MultiSortFilterProxy::ClearSortKeys);
+    QObject::disconnect(sourceModel(), &QAbstractItemModel::layoutChanged, this, &MultiSortFilterProxy::ClearSortKeys);
+    QObject::disconnect(sourceModel(), &QAbstractItemModel::modelReset, this, &MultiSortFilterProxy::ClearSortKeys);
+  }
+
+  ClearSortKeys();
+
+  // Connect before QSortFilterProxyModel does, so stale keys are gone by the time it sorts the changed rows.
+  if (source_model) {
+    QObject::connect(source_model, &QAbstractItemModel::dataChanged, this, &MultiSortFilterProxy::SourceDataChanged);
+    QObject::connect(source_model, &QAbstractItemModel::rowsInserted, this, &MultiSortFilterProxy::ClearSortKeys);
+    QObject::connect(source_model, &QAbstractItemModel::rowsRemoved, this, &MultiSortFilterProxy::ClearSortKeys);
+    QObject::connect(source_model, &QAbstractItemModel::rowsMoved, this, &MultiSortFilterProxy::ClearSortKeys);
+    QObject::connect(source_model, &QAbstractItemModel::layoutChanged, this, &MultiSortFilterProxy::ClearSortKeys);
+    QObject::connect(source_model, &QAbstractItemModel::modelReset, this, &MultiSortFilterProxy::ClearSortKeys);
+  }
+
+  QSortFilterProxyModel::setSourceModel(source_model);
+
+}
+
+void MultiSortFilterProxy::ClearSortKeys() {
+  sort_keys_.clear();
+}
+
+void MultiSortFilterProxy::SourceDataChanged(const QModelIndex &top_left, const QModelIndex &bottom_right) {
+
+  if (!top_left.isValid() || !bottom_right.isValid()) {
+    ClearSortKeys();
+    return;
+  }
+
+  for (int row = top_left.row(); row <= bottom_right.row(); ++row) {
+    for (int column = top_left.column(); column <= bottom_right.column(); ++column) {
+      sort_keys_.remove(top_left.sibling(row, column));
+    }
+  }
+
 }
 
 bool MultiSortFilterProxy::lessThan(const QModelIndex &left, const QModelIndex &right) const {
 
-  for (const SortSpec &spec : sorting_) {
-    const int ret = Compare(left.data(spec.first), right.data(spec.first));
+  // Copies, since looking up the right keys can insert into the hash.
+  const SortKeys left_keys = GetSortKeys(left);
+  const SortKeys right_keys = GetSortKeys(right);
+
+  for (int i = 0; i < sorting_.count(); ++i) {
+    const int ret = Compare(left_keys[i], right_keys[i]);
 
     if (ret < 0) {
-      return spec.second == Qt::AscendingOrder;
+      return sorting_[i].second == Qt::AscendingOrder;
     }
     else if (ret > 0) {
-      return spec.second != Qt::AscendingOrder;
+      return sorting_[i].second != Qt::AscendingOrder;
     }
   }
 
@@ -56,53 +115,113 @@ bool MultiSortFilterProxy::lessThan(const QModelIndex &left, const QModelIndex &
 
 }
 
-template<typename T>
-static inline int DoCompare(T left, T right) {
+MultiSortFilterProxy::SortKeys MultiSortFilterProxy::GetSortKeys(const QModelIndex &idx) const {
 
-  if (left < right) return -1;
-  if (left > right) return 1;
-  return 0;
+  auto it = sort_keys_.find(idx);
+  if (it == sort_keys_.end()) {
+    SortKeys keys;
+    keys.reserve(sorting_.count());
+    for (const SortSpec &spec : sorting_) {
+      keys << MakeSortKey(idx.data(spec.first));
+    }
+    it = sort_keys_.insert(idx, keys);
+  }
+
+  return it.value();
 
 }
 
-int MultiSortFilterProxy::Compare(const QVariant &left, const QVariant &right) const {
+MultiSortFilterProxy::SortKey MultiSortFilterProxy::MakeSortKey(const QVariant &value) const {
 
-  // Copied from the QSortFilterProxyModel::lessThan implementation, but returns -1, 0 or 1 instead of true or false.
-  switch (left.userType()) {
+  // The types are the ones handled by QSortFilterProxyModel::lessThan, anything else is compared as a string.
+  SortKey key;
+  switch (value.userType()) {
 #if QT_VERSION >= QT_VERSION_CHECK(6, 0, 0)
-    case QMetaType::UnknownType:   return (right.metaType().id() != QMetaType::UnknownType) ? -1 : 0;
-    case QMetaType::Int:           return DoCompare(left.toInt(), right.toInt());
-    case QMetaType::UInt:          return DoCompare(left.toUInt(), right.toUInt());
-    case QMetaType::LongLong:      return DoCompare(left.toLongLong(), right.toLongLong());
-    case QMetaType::ULongLong:     return DoCompare(left.toULongLong(), right.toULongLong());
-    case QMetaType::Float:         return DoCompare(left.toFloat(), right.toFloat());
-    case QMetaType::Double:        return DoCompare(left.toDouble(), right.toDouble());
-    case QMetaType::Char:          return DoCompare(left.toChar(), right.toChar());
-    case QMetaType::QDate:         return DoCompare(left.toDate(), right.toDate());
-    case QMetaType::QTime:         return DoCompare(left.toTime(), right.toTime());
-    case QMetaType::QDateTime:     return DoCompare(left.toDateTime(), right.toDateTime());
-    case QMetaType::QString:
+    case QMetaType::UnknownType:
 #else
-    case QVariant::Invalid:   return (right.type() != QVariant::Invalid) ? -1 : 0;
-    case QVariant::Int:       return DoCompare(left.toInt(), right.toInt());
-    case QVariant::UInt:      return DoCompare(left.toUInt(), right.toUInt());
-    case QVariant::LongLong:  return DoCompare(left.toLongLong(), right.toLongLong());
-    case QVariant::ULongLong: return DoCompare(left.toULongLong(), right.toULongLong());
-    case QMetaType::Float:    return DoCompare(left.toFloat(), right.toFloat());
-    case QVariant::Double:    return DoCompare(left.toDouble(), right.toDouble());
-    case QVariant::Char:      return DoCompare(left.toChar(), right.toChar());
-    case QVariant::Date:      return DoCompare(left.toDate(), right.toDate());
-    case QVariant::Time:      return DoCompare(left.toTime(), right.toTime());
-    case QVariant::DateTime:  return DoCompare(left.toDateTime(), right.toDateTime());
-    case QVariant::String:
+    case QVariant::Invalid:
 #endif
+      break;
+    case QMetaType::Int:
+    case QMetaType::LongLong:
+      key.type = SortKey::Type::Integer;
+      key.integer = value.toLongLong();
+      break;
+    case QMetaType::UInt:
+    case QMetaType::ULongLong:
+      key.type = SortKey::Type::UnsignedInteger;
+      key.unsigned_integer = value.toULongLong();
+      break;
+    case QMetaType::QChar:
+      key.type = SortKey::Type::UnsignedInteger;
+      key.unsigned_integer = value.toChar().unicode();
+      break;
+    case QMetaType::Float:
+    case QMetaType::Double:
+      key.type = SortKey::Type::Double;
+      key.real = value.toDouble();
+      break;
+    case QMetaType::QDate:{
+      const QDate date = value.toDate();
+      key.type = SortKey::Type::Integer;
+      key.integer = date.isValid() ? date.toJulianDay() : std::numeric_limits<qint64>::min();
+      break;
+    }
+    case QMetaType::QTime:{
+      const QTime time = value.toTime();
+      key.type = SortKey::Type::Integer;
+      key.integer = time.isValid() ? time.msecsSinceStartOfDay() : std::numeric_limits<qint64>::min();
+      break;
+    }
+    case QMetaType::QDateTime:{
+      const QDateTime datetime = value.toDateTime();
+      key.type = SortKey::Type::Integer;
+      key.integer = datetime.isValid() ? datetime.toMSecsSinceEpoch() : std::numeric_limits<qint64>::min();
+      break;
+    }
     default:
-      if (isSortLocaleAware()) {
-        return left.toString().localeAwareCompare(right.toString());
+      key.type = SortKey::Type::String;
+      // Fold the case once here, so comparing is always case sensitive.
+      if (!isSortLocaleAware() && sortCaseSensitivity() == Qt::CaseInsensitive) {
+        key.string = value.toString().toCaseFolded();
       }
       else {
-        return left.toString().compare(right.toString(), sortCaseSensitivity());
+        key.string = value.toString();
+      }
+      break;
+  }
+
+  return key;
+
+}
+
+template<typename T>
+static inline int DoCompare(T left, T right) {
+
+  if (left < right) return -1;
+  if (left > right) return 1;
+  return 0;
+
+}
+
+int MultiSortFilterProxy::Compare(const SortKey &left, const SortKey &right) const {
+
+  if (left.type != right.type) {
+    if (left.type == SortKey::Type::Invalid) return -1;
+    if (right.type == SortKey::Type::Invalid) return 1;
+    return DoCompare(static_cast<int>(left.type), static_cast<int>(right.type));
+  }
+
+  switch (left.type) {
+    case SortKey::Type::Invalid:         return 0;
+    case SortKey::Type::Integer:         return DoCompare(left.integer, right.integer);
+    case SortKey::Type::UnsignedInteger: return DoCompare(left.unsigned_integer, right.unsigned_integer);
+    case SortKey::Type::Double:          return DoCompare(left.real, right.real);
+    case SortKey::Type::String:
+      if (isSortLocaleAware()) {
+        return collator_.compare(left.string, right.string);
       }
+      return left.string.compare(right.string, Qt::CaseSensitive);
   }
 
   return 0;
@@ -23,12 +23,17 @@
 
 #include "config.h"
 
+#include <QtGlobal>
 #include <QSortFilterProxyModel>
 #include <QList>
+#include <QHash>
 #include <QPair>
 #include <QVariant>
+#include <QString>
+#include <QCollator>
 
 class QObject;
+class QAbstractItemModel;
 
 class MultiSortFilterProxy : public QSortFilterProxyModel {
   Q_OBJECT
@@ -38,14 +43,45 @@ class MultiSortFilterProxy : public QSortFilterProxyModel {
 
   void AddSortSpec(int role, Qt::SortOrder order = Qt::AscendingOrder);
 
+  void setSourceModel(QAbstractItemModel *source_model) override;
+
  protected:
   bool lessThan(const QModelIndex &left, const QModelIndex &right) const override;
 
  private:
-  int Compare(const QVariant &left, const QVariant &right) const;
+  // The value of a sort role converted once to something that's cheap to compare, instead of comparing QVariants.
+  struct SortKey {
+    enum class Type {
+      Invalid,
+      Integer,
+      UnsignedInteger,
+      Double,
+      String
+    };
+    SortKey() : type(Type::Invalid), integer(0), unsigned_integer(0), real(0) {}
+    Type type;
+    qint64 integer;
+    quint64 unsigned_integer;
+    double real;
+    QString string;
+  };
+  using SortKeys = QList<SortKey>;
+
+  SortKeys GetSortKeys(const QModelIndex &idx) const;
+  SortKey MakeSortKey(const QVariant &value) const;
+  int Compare(const SortKey &left, const SortKey &right) const;
+
+ private slots:
+  void ClearSortKeys();
+  void SourceDataChanged(const QModelIndex &top_left, const QModelIndex &bottom_right);
 
+ private:
   using SortSpec = QPair<int, Qt::SortOrder>;
   QList<SortSpec> sorting_;
+
+  QCollator collator_;
+  // Sort keys of source indexes, dropped when source rows change.
+  mutable QHash<QModelIndex, SortKeys> sort_keys_;
 };
 
 #endif  // MULTISORTFILTERPROXY_H
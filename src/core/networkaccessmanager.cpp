@@ -33,9 +33,24 @@
 
 #include "networkaccessmanager.h"
 #include "threadsafenetworkdiskcache.h"
+#include "networkrequestscheduler.h"
 
 NetworkAccessManager::NetworkAccessManager(QObject *parent)
-    : QNetworkAccessManager(parent) {
+    : QNetworkAccessManager(parent),
+      scheduler_(new NetworkRequestScheduler(this)) {
+
+  setRedirectPolicy(QNetworkRequest::NoLessSafeRedirectPolicy);
+  setCache(new ThreadSafeNetworkDiskCache(this));
+
+  // MusicBrainz allows an average of one request per second, AcoustID three.
+  scheduler_->SetRate(QStringLiteral("musicbrainz.org"), 1.0);
+  scheduler_->SetRate(QStringLiteral("api.acoustid.org"), 3.0, 3);
+
+}
+
+NetworkAccessManager::NetworkAccessManager(NetworkRequestScheduler *scheduler, QObject *parent)
+    : QNetworkAccessManager(parent),
+      scheduler_(scheduler) {
 
   setRedirectPolicy(QNetworkRequest::NoLessSafeRedirectPolicy);
   setCache(new ThreadSafeNetworkDiskCache(this));
@@ -60,6 +75,13 @@ QNetworkReply *NetworkAccessManager::createRequest(Operation op, const QNetworkR
     new_request.setHeader(QNetworkRequest::ContentTypeHeader, QStringLiteral("application/x-www-form-urlencoded"));
   }
 
+#if QT_VERSION < QT_VERSION_CHECK(6, 0, 0)
+  // HTTP/2 is used by default since Qt 6, it sends all the requests to a host over one connection.
+  if (!request.attribute(QNetworkRequest::Http2AllowedAttribute).isValid()) {
+    new_request.setAttribute(QNetworkRequest::Http2AllowedAttribute, true);
+  }
+#endif
+
   // Prefer the cache unless the caller has changed the setting already
   if (request.attribute(QNetworkRequest::CacheLoadControlAttribute).toInt() == QNetworkRequest::PreferNetwork) {
     new_request.setAttribute(QNetworkRequest::CacheLoadControlAttribute, QNetworkRequest::PreferCache);
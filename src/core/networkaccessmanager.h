@@ -31,15 +31,26 @@
 
 class QIODevice;
 class QNetworkReply;
+class NetworkRequestScheduler;
 
+// Each network access manager has its own connection pool and HTTP thread, so subsystems that download a lot use their own manager,
+// and don't take the connections of the requests the user is waiting for.
 class NetworkAccessManager : public QNetworkAccessManager {
   Q_OBJECT
 
  public:
   explicit NetworkAccessManager(QObject *parent = nullptr);
+  // Uses the scheduler of another manager, so the rate limits are kept for all requests to a host.
+  explicit NetworkAccessManager(NetworkRequestScheduler *scheduler, QObject *parent = nullptr);
+
+  // Shared by the clients of rate limited services using this network access manager.
+  NetworkRequestScheduler *scheduler() const { return scheduler_; }
 
  protected:
   QNetworkReply *createRequest(Operation op, const QNetworkRequest &request, QIODevice *outgoingData) override;
+
+ private:
+  NetworkRequestScheduler *scheduler_;
 };
 
 #endif  // NETWORKACCESSMANAGER_H
@@ -0,0 +1,128 @@
+/*
+ * Strawberry Music Player
+ *
+ * Strawberry is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Strawberry is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Strawberry.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#include "config.h"
+
+#include <algorithm>
+#include <cmath>
+#include <functional>
+#include <utility>
+
+#include <QtGlobal>
+#include <QObject>
+#include <QList>
+#include <QString>
+#include <QUrl>
+#include <QTimer>
+
+#include "networkrequestscheduler.h"
+
+NetworkRequestScheduler::NetworkRequestScheduler(QObject *parent)
+    : QObject(parent),
+      timer_flush_(new QTimer(this)) {
+
+  timer_flush_->setSingleShot(true);
+  QObject::connect(timer_flush_, &QTimer::timeout, this, &NetworkRequestScheduler::Flush);
+
+  elapsed_.start();
+
+}
+
+void NetworkRequestScheduler::SetRate(const QString &host, const double requests_per_sec, const int burst) {
+
+  Host &h = hosts_[host];
+  h.requests_per_sec = requests_per_sec;
+  h.burst = std::max(1, burst);
+  h.tokens = static_cast<double>(h.burst);
+  h.refill_msec = elapsed_.elapsed();
+
+}
+
+void NetworkRequestScheduler::Schedule(const QUrl &url, const Priority priority, QObject *receiver, const std::function<void()> &send) {
+
+  Request request;
+  request.receiver = receiver;
+  request.send = send;
+
+  QHash<QString, Host>::iterator it = hosts_.find(url.host());
+  if (it == hosts_.end()) {
+    // Still called from the event loop, so callers see the same order for all hosts.
+    QTimer::singleShot(0, receiver, send);
+    return;
+  }
+
+  switch (priority) {
+    case Priority::Interactive:
+      it->interactive_requests.enqueue(request);
+      break;
+    case Priority::Background:
+      it->background_requests.enqueue(request);
+      break;
+  }
+
+  if (!timer_flush_->isActive()) {
+    timer_flush_->start(0);
+  }
+
+}
+
+void NetworkRequestScheduler::Cancel(QObject *receiver) {
+
+  const auto is_receiver = [receiver](const Request &request) { return request.receiver == receiver; };
+
+  for (Host &host : hosts_) {
+    host.interactive_requests.erase(std::remove_if(host.interactive_requests.begin(), host.interactive_requests.end(), is_receiver), host.interactive_requests.end());
+    host.background_requests.erase(std::remove_if(host.background_requests.begin(), host.background_requests.end(), is_receiver), host.background_requests.end());
+  }
+
+}
+
+void NetworkRequestScheduler::Flush() {
+
+  const qint64 now_msec = elapsed_.elapsed();
+
+  // The calls are collected first, a call can schedule new requests.
+  QList<Request> requests;
+  qint64 next_msec = -1;
+
+  for (Host &host : hosts_) {
+    host.tokens = std::min(static_cast<double>(host.burst), host.tokens + static_cast<double>(now_msec - host.refill_msec) * host.requests_per_sec / 1000.0);
+    host.refill_msec = now_msec;
+
+    while (host.tokens >= 1.0 && (!host.interactive_requests.isEmpty() || !host.background_requests.isEmpty())) {
+      const Request request = host.interactive_requests.isEmpty() ? host.background_requests.dequeue() : host.interactive_requests.dequeue();
+      if (!request.receiver) continue;
+      host.tokens -= 1.0;
+      requests << request;
+    }
+
+    if (!host.interactive_requests.isEmpty() || !host.background_requests.isEmpty()) {
+      const qint64 wait_msec = static_cast<qint64>(std::ceil((1.0 - host.tokens) * 1000.0 / host.requests_per_sec));
+      if (next_msec == -1 || wait_msec < next_msec) next_msec = wait_msec;
+    }
+  }
+
+  if (next_msec >= 0) {
+    timer_flush_->start(static_cast<int>(next_msec));
+  }
+
+  for (const Request &request : std::as_const(requests)) {
+    if (request.receiver) request.send();
+  }
+
+}
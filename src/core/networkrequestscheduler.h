@@ -0,0 +1,83 @@
+/*
+ * Strawberry Music Player
+ *
+ * Strawberry is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Strawberry is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Strawberry.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#ifndef NETWORKREQUESTSCHEDULER_H
+#define NETWORKREQUESTSCHEDULER_H
+
+#include "config.h"
+
+#include <functional>
+
+#include <QtGlobal>
+#include <QObject>
+#include <QPointer>
+#include <QHash>
+#include <QQueue>
+#include <QString>
+#include <QElapsedTimer>
+
+class QTimer;
+class QUrl;
+
+// Spaces the requests to rate limited hosts with a token bucket for each host, so clients sharing the network access manager don't trip the limit together.
+// Interactive requests waiting for a host are sent before background requests.
+class NetworkRequestScheduler : public QObject {
+  Q_OBJECT
+
+ public:
+  explicit NetworkRequestScheduler(QObject *parent = nullptr);
+
+  enum class Priority {
+    Interactive,
+    Background
+  };
+
+  // Requests to hosts without a rate are sent right away.
+  void SetRate(const QString &host, const double requests_per_sec, const int burst = 1);
+
+  // Calls send from the event loop when the host of the url has a token.  The call is dropped if receiver is destroyed first.
+  void Schedule(const QUrl &url, const Priority priority, QObject *receiver, const std::function<void()> &send);
+
+  // Drops the calls waiting for the receiver.
+  void Cancel(QObject *receiver);
+
+ private slots:
+  void Flush();
+
+ private:
+  struct Request {
+    QPointer<QObject> receiver;
+    std::function<void()> send;
+  };
+
+  struct Host {
+    Host() : requests_per_sec(1.0), burst(1), tokens(1.0), refill_msec(0) {}
+    double requests_per_sec;
+    int burst;
+    double tokens;
+    qint64 refill_msec;
+    QQueue<Request> interactive_requests;
+    QQueue<Request> background_requests;
+  };
+
+  QTimer *timer_flush_;
+  QElapsedTimer elapsed_;
+  QHash<QString, Host> hosts_;
+};
+
+#endif  // NETWORKREQUESTSCHEDULER_H
@@ -23,6 +23,7 @@
 
 #include "player.h"
 
+#include <utility>
 #include <algorithm>
 #include <memory>
 #include <chrono>
@@ -32,8 +33,11 @@
 #include <QMap>
 #include <QVariant>
 #include <QString>
+#include <QStringList>
 #include <QUrl>
+#include <QUrlQuery>
 #include <QDateTime>
+#include <QTimer>
 #include <QSettings>
 
 #include "core/logging.h"
@@ -75,6 +79,37 @@ using std::make_shared;
 
 const char *Player::kSettingsGroup = "Player";
 
+namespace {
+
+// Stream URLs from the streaming services expire, older ones are requested again.
+constexpr qint64 kResolvedStreamUrlMaxAgeSec = 300;
+// Stream URLs are requested again this long before they expire, so they're never expired when they're played.
+constexpr qint64 kResolvedStreamUrlRefreshSec = 30;
+
+QDateTime StreamUrlExpiry(const QUrl &stream_url, const QDateTime &now) {
+
+  QDateTime expiry = now.addSecs(kResolvedStreamUrlMaxAgeSec);
+
+  // Signed URLs have the expiry time as a Unix timestamp, Qobuz uses etsp.
+  const QUrlQuery url_query(stream_url);
+  const QStringList keys = QStringList() << QStringLiteral("etsp") << QStringLiteral("Expires") << QStringLiteral("expires");
+  for (const QString &key : keys) {
+    if (!url_query.hasQueryItem(key)) continue;
+    bool ok = false;
+    const qint64 timestamp = url_query.queryItemValue(key).toLongLong(&ok);
+    // A timestamp that is already close is most likely from a clock that's off, it would make the URLs be requested again and again.
+    if (ok && now.secsTo(QDateTime::fromSecsSinceEpoch(timestamp)) > kResolvedStreamUrlRefreshSec * 2) {
+      expiry = qMin(expiry, QDateTime::fromSecsSinceEpoch(timestamp));
+    }
+    break;
+  }
+
+  return expiry;
+
+}
+
+}  // namespace
+
 Player::Player(Application *app, QObject *parent)
     : PlayerInterface(parent),
       app_(app),
@@ -85,10 +120,12 @@ Player::Player(Application *app, QObject *parent)
       analyzer_(nullptr),
       equalizer_(nullptr),
       timer_save_volume_(new QTimer(this)),
+      timer_resolve_ahead_(new QTimer(this)),
       stream_change_type_(EngineBase::TrackChangeType::First),
       autoscroll_(Playlist::AutoScroll::Maybe),
       last_state_(EngineBase::State::Empty),
       nb_errors_received_(0),
+      stream_url_lookahead_(BackendSettingsPage::kDefaultStreamUrlLookahead),
       volume_(100),
       volume_before_mute_(100),
       last_pressed_previous_(QDateTime::currentDateTime()),
@@ -109,6 +146,9 @@ Player::Player(Application *app, QObject *parent)
   timer_save_volume_->setInterval(5s);
   QObject::connect(timer_save_volume_, &QTimer::timeout, this, &Player::SaveVolume);
 
+  timer_resolve_ahead_->setSingleShot(true);
+  QObject::connect(timer_resolve_ahead_, &QTimer::timeout, this, &Player::RefreshStreamUrlsAhead);
+
 }
 
 EngineBase::Type Player::CreateEngine(EngineBase::Type enginetype) {
@@ -219,6 +259,10 @@ void Player::ReloadSettings() {
   seek_step_sec_ = s.value("seek_step_sec", 10).toInt();
   s.endGroup();
 
+  s.beginGroup(BackendSettingsPage::kSettingsGroup);
+  stream_url_lookahead_ = s.value("stream_url_lookahead", BackendSettingsPage::kDefaultStreamUrlLookahead).toInt();
+  s.endGroup();
+
   engine_->ReloadSettings();
 
 }
@@ -245,6 +289,18 @@ void Player::SaveVolume() {
 
 void Player::HandleLoadResult(const UrlHandler::LoadResult &result) {
 
+  // A stream URL requested ahead is kept until the item is played, unless the item is already waiting for it.
+  if (resolving_ahead_.contains(result.media_url_) && result.type_ != UrlHandler::LoadResult::Type::WillLoadAsynchronously) {
+    resolving_ahead_.removeAll(result.media_url_);
+    if (!loading_async_.contains(result.media_url_)) {
+      if (result.type_ == UrlHandler::LoadResult::Type::TrackAvailable) {
+        resolved_ahead_.insert(result.media_url_, ResolvedStreamUrl{ result, StreamUrlExpiry(result.stream_url_, QDateTime::currentDateTime()) });
+        ScheduleStreamUrlsRefresh();
+      }
+      return;
+    }
+  }
+
   if (loading_async_.contains(result.media_url_)) {
     loading_async_.removeAll(result.media_url_);
   }
@@ -747,13 +803,102 @@ void Player::PlayAt(const int index, const quint64 offset_nanosec, EngineBase::T
 
     stream_change_type_ = change;
     autoscroll_ = autoscroll;
-    HandleLoadResult(url_handlers_[url.scheme()]->StartLoading(url));
+    HandleLoadResult(StartLoading(url));
   }
   else {
     qLog(Debug) << "Playing song" << current_item_->Metadata().title() << url << "position" << offset_nanosec;
     engine_->Play(current_item_->Url(), url, change, current_item_->Metadata().has_cue(), current_item_->effective_beginning_nanosec(), current_item_->effective_end_nanosec(), offset_nanosec, current_item_->effective_ebur128_integrated_loudness_lufs());
   }
 
+  ResolveStreamUrlsAhead();
+
+}
+
+UrlHandler::LoadResult Player::StartLoading(const QUrl &url) {
+
+  // Already requested ahead, the result is handled as a normal asynchronous load when it arrives.
+  if (resolving_ahead_.contains(url)) {
+    return UrlHandler::LoadResult(url, UrlHandler::LoadResult::Type::WillLoadAsynchronously);
+  }
+
+  if (resolved_ahead_.contains(url)) {
+    const ResolvedStreamUrl resolved = resolved_ahead_.take(url);
+    if (QDateTime::currentDateTime() < resolved.expiry) {
+      return resolved.result;
+    }
+  }
+
+  return url_handlers_[url.scheme()]->StartLoading(url);
+
+}
+
+void Player::ResolveStreamUrlsAhead() {
+
+  const QDateTime now = QDateTime::currentDateTime();
+  for (QMap<QUrl, ResolvedStreamUrl>::iterator it = resolved_ahead_.begin(); it != resolved_ahead_.end();) {
+    if (now.secsTo(it->expiry) <= kResolvedStreamUrlRefreshSec) {
+      it = resolved_ahead_.erase(it);
+    }
+    else {
+      ++it;
+    }
+  }
+
+  if (stream_url_lookahead_ <= 0) return;
+
+  Playlist *playlist = app_->playlist_manager()->active();
+  const QList<int> rows = playlist->next_rows(stream_url_lookahead_);
+  for (const int row : rows) {
+    PlaylistItemPtr item = playlist->item_at(row);
+    if (!item) continue;
+    const QUrl url = item->Url();
+    if (!url_handlers_.contains(url.scheme()) || loading_async_.contains(url) || resolving_ahead_.contains(url) || resolved_ahead_.contains(url)) {
+      continue;
+    }
+    const UrlHandler::LoadResult result = url_handlers_[url.scheme()]->StartLoading(url);
+    switch (result.type_) {
+      case UrlHandler::LoadResult::Type::WillLoadAsynchronously:
+        resolving_ahead_ << url;
+        break;
+      case UrlHandler::LoadResult::Type::TrackAvailable:
+        resolved_ahead_.insert(url, ResolvedStreamUrl{ result, StreamUrlExpiry(result.stream_url_, now) });
+        break;
+      default:
+        break;
+    }
+  }
+
+  ScheduleStreamUrlsRefresh();
+
+}
+
+void Player::ScheduleStreamUrlsRefresh() {
+
+  if (resolved_ahead_.isEmpty()) {
+    timer_resolve_ahead_->stop();
+    return;
+  }
+
+  QDateTime next_expiry;
+  for (const ResolvedStreamUrl &resolved : std::as_const(resolved_ahead_)) {
+    if (!next_expiry.isValid() || resolved.expiry < next_expiry) next_expiry = resolved.expiry;
+  }
+
+  const qint64 msec = qMax(0LL, QDateTime::currentDateTime().msecsTo(next_expiry) - kResolvedStreamUrlRefreshSec * 1000);
+  timer_resolve_ahead_->start(static_cast<int>(qMin(msec, kResolvedStreamUrlMaxAgeSec * 1000)));
+
+}
+
+void Player::RefreshStreamUrlsAhead() {
+
+  // Only refresh while something is playing, the stream URLs are requested again when playback starts.
+  if (engine_->state() != EngineBase::State::Playing && engine_->state() != EngineBase::State::Paused) {
+    resolved_ahead_.clear();
+    return;
+  }
+
+  ResolveStreamUrlsAhead();
+
 }
 
 void Player::CurrentMetadataChanged(const Song &metadata) {
@@ -904,7 +1049,7 @@ void Player::TrackAboutToEnd() {
   if (url_handlers_.contains(url.scheme())) {
     if (loading_async_.contains(url)) return;
     autoscroll_ = Playlist::AutoScroll::Maybe;
-    UrlHandler::LoadResult result = url_handlers_[url.scheme()]->StartLoading(url);
+    UrlHandler::LoadResult result = StartLoading(url);
     switch (result.type_) {
       case UrlHandler::LoadResult::Type::Error:
         emit Error(result.error_);
@@ -216,7 +216,19 @@ class Player : public PlayerInterface {
 
   void UnPause();
 
+  // Requests the stream URLs of the upcoming items from the URL handlers, so they are ready when the items are played.
+  void ResolveStreamUrlsAhead();
+  // Starts the timer that requests the stream URLs again before the first one expires.
+  void ScheduleStreamUrlsRefresh();
+  void RefreshStreamUrlsAhead();
+  UrlHandler::LoadResult StartLoading(const QUrl &url);
+
  private:
+  struct ResolvedStreamUrl {
+    UrlHandler::LoadResult result;
+    QDateTime expiry;
+  };
+
   Application *app_;
   SharedPtr<EngineBase> engine_;
 #ifdef HAVE_GSTREAMER
@@ -225,6 +237,7 @@ class Player : public PlayerInterface {
   AnalyzerContainer *analyzer_;
   SharedPtr<Equalizer> equalizer_;
   QTimer *timer_save_volume_;
+  QTimer *timer_resolve_ahead_;
 
   PlaylistItemPtr current_item_;
 
@@ -236,6 +249,9 @@ class Player : public PlayerInterface {
   QMap<QString, UrlHandler*> url_handlers_;
 
   QList<QUrl> loading_async_;
+  int stream_url_lookahead_;
+  QList<QUrl> resolving_ahead_;
+  QMap<QUrl, ResolvedStreamUrl> resolved_ahead_;
   uint volume_;
   uint volume_before_mute_;
   QDateTime last_pressed_previous_;
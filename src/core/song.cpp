@@ -49,6 +49,7 @@
 #include <QSqlRecord>
 
 #include "core/iconloader.h"
+#include "core/memorystats.h"
 #include "engine/enginemetadata.h"
 #include "utilities/strutils.h"
 #include "utilities/timeutils.h"
@@ -56,6 +57,7 @@
 #include "utilities/timeconstants.h"
 #include "utilities/sqlhelper.h"
 #include "song.h"
+#include "stringinterner.h"
 #include "sqlquery.h"
 #include "sqlrow.h"
 #ifdef HAVE_DBUS
@@ -96,6 +98,7 @@ const QStringList Song::kColumns = QStringList() << QStringLiteral("title")
                                                  << QStringLiteral("filetype")
                                                  << QStringLiteral("filesize")
                                                  << QStringLiteral("mtime")
+                                                 << QStringLiteral("content_hash")
                                                  << QStringLiteral("ctime")
                                                  << QStringLiteral("unavailable")
 
@@ -112,6 +115,10 @@ const QStringList Song::kColumns = QStringList() << QStringLiteral("title")
                                                  << QStringLiteral("compilation_effective")
 
                                                  << QStringLiteral("art_embedded")
+                                                 << QStringLiteral("art_embedded_size")
+                                                 << QStringLiteral("art_embedded_width")
+                                                 << QStringLiteral("art_embedded_height")
+                                                 << QStringLiteral("art_embedded_hash")
                                                  << QStringLiteral("art_automatic")
                                                  << QStringLiteral("art_manual")
                                                  << QStringLiteral("art_unset")
@@ -208,125 +215,165 @@ struct Song::Private : public QSharedData {
 
   explicit Private(Source source = Source::Unknown);
 
-  int id_;
-
-  bool valid_;
+  // Fields that most songs don't have are kept in a separate block that's only allocated when one of them is set.
+  struct Extra : public QSharedData {
+    QString comment_;
+    QString lyrics_;
+
+    QString acoustid_id_;
+    QString acoustid_fingerprint_;
+
+    QString musicbrainz_album_artist_id_;
+    QString musicbrainz_artist_id_;
+    QString musicbrainz_original_artist_id_;
+    QString musicbrainz_album_id_;
+    QString musicbrainz_original_album_id_;
+    QString musicbrainz_recording_id_;
+    QString musicbrainz_track_id_;
+    QString musicbrainz_disc_id_;
+    QString musicbrainz_release_group_id_;
+    QString musicbrainz_work_id_;
+  };
+
+  // The members are ordered by size so there's no padding between them.
+  // Strings that are repeated in many songs, such as artists, albums and genres, are interned by the setters.
 
   QString title_;
   QString album_;
   QString artist_;
   QString albumartist_;
-  int track_;
-  int disc_;
-  int year_;
-  int originalyear_;
   QString genre_;
-  bool compilation_;  // From the file tag
   QString composer_;
   QString performer_;
   QString grouping_;
-  QString comment_;
-  QString lyrics_;
 
   QString artist_id_;
   QString album_id_;
   QString song_id_;
 
+  QString basefilename_;
+  QUrl url_;
+  QString content_hash_;        // File size and hash of the beginning and end of the file, used when mtimes are unreliable.
+
+  QString fingerprint_;
+
+  QString art_embedded_hash_;
+  QUrl art_automatic_;          // Guessed by CollectionWatcher.
+  QUrl art_manual_;             // Set by the user - should take priority.
+
+  QString cue_path_;            // If the song has a CUE, this contains it's path.
+
+  QString title_sortable_;
+  QString album_sortable_;
+  QString artist_sortable_;
+  QString albumartist_sortable_;
+
+  QUrl stream_url_;             // Temporary stream url set by the URL handler.
+
+  QSharedDataPointer<Extra> extra_;
+
+  Extra *extra() {
+    if (!extra_) extra_ = new Extra;
+    return extra_.data();
+  }
+
   qint64 beginning_;
   qint64 end_;
 
+  qint64 filesize_;
+  qint64 mtime_;
+  qint64 ctime_;
+
+  qint64 lastplayed_;
+  qint64 lastseen_;
+
+  qint64 art_embedded_size_;    // Size, dimensions and hash of the embedded cover, recorded when scanning so it doesn't need to be loaded.
+
+  std::optional<double> ebur128_integrated_loudness_lufs_;
+  std::optional<double> ebur128_loudness_range_lu_;
+
+  int id_;
+
+  int track_;
+  int disc_;
+  int year_;
+  int originalyear_;
+
   int bitrate_;
   int samplerate_;
   int bitdepth_;
 
-  Source source_;
   int directory_id_;
-  QString basefilename_;
-  QUrl url_;
-  FileType filetype_;
-  qint64 filesize_;
-  qint64 mtime_;
-  qint64 ctime_;
-  bool unavailable_;
-
-  QString fingerprint_;
 
   uint playcount_;
   uint skipcount_;
-  qint64 lastplayed_;
-  qint64 lastseen_;
+
+  int art_embedded_width_;
+  int art_embedded_height_;
+
+  float rating_;                // Database rating, initial rating read from tag.
+
+  Source source_;
+  FileType filetype_;
+
+  bool valid_;
+  bool compilation_;            // From the file tag
+  bool unavailable_;
 
   bool compilation_detected_;   // From the collection scanner
   bool compilation_on_;         // Set by the user
   bool compilation_off_;        // Set by the user
 
   bool art_embedded_;           // if the song has embedded album cover art.
-  QUrl art_automatic_;          // Guessed by CollectionWatcher.
-  QUrl art_manual_;             // Set by the user - should take priority.
   bool art_unset_;              // If the art was unset by the user.
 
-  QString cue_path_;            // If the song has a CUE, this contains it's path.
-
-  float rating_;                // Database rating, initial rating read from tag.
-
-  QString acoustid_id_;
-  QString acoustid_fingerprint_;
-
-  QString musicbrainz_album_artist_id_;
-  QString musicbrainz_artist_id_;
-  QString musicbrainz_original_artist_id_;
-  QString musicbrainz_album_id_;
-  QString musicbrainz_original_album_id_;
-  QString musicbrainz_recording_id_;
-  QString musicbrainz_track_id_;
-  QString musicbrainz_disc_id_;
-  QString musicbrainz_release_group_id_;
-  QString musicbrainz_work_id_;
-
-  std::optional<double> ebur128_integrated_loudness_lufs_;
-  std::optional<double> ebur128_loudness_range_lu_;
-
   bool init_from_file_;         // Whether this song was loaded from a file using taglib.
   bool suspicious_tags_;        // Whether our encoding guesser thinks these tags might be incorrectly encoded.
 
-  QString title_sortable_;
-  QString album_sortable_;
-  QString artist_sortable_;
-  QString albumartist_sortable_;
-
-  QUrl stream_url_;             // Temporary stream url set by the URL handler.
+  memorystats::ObjectCounter<memorystats::Counter::SongPrivate> memory_counter_;
 
 };
 
 Song::Private::Private(const Source source)
-    : id_(-1),
-      valid_(false),
+    : beginning_(0),
+      end_(-1),
+
+      filesize_(-1),
+      mtime_(-1),
+      ctime_(-1),
+
+      lastplayed_(-1),
+      lastseen_(-1),
+
+      art_embedded_size_(-1),
+
+      id_(-1),
 
       track_(-1),
       disc_(-1),
       year_(-1),
       originalyear_(-1),
-      compilation_(false),
-
-      beginning_(0),
-      end_(-1),
 
       bitrate_(-1),
       samplerate_(-1),
       bitdepth_(-1),
 
-      source_(source),
       directory_id_(-1),
-      filetype_(FileType::Unknown),
-      filesize_(-1),
-      mtime_(-1),
-      ctime_(-1),
-      unavailable_(false),
 
       playcount_(0),
       skipcount_(0),
-      lastplayed_(-1),
-      lastseen_(-1),
+
+      art_embedded_width_(-1),
+      art_embedded_height_(-1),
+
+      rating_(-1),
+
+      source_(source),
+      filetype_(FileType::Unknown),
+
+      valid_(false),
+      compilation_(false),
+      unavailable_(false),
 
       compilation_detected_(false),
       compilation_on_(false),
@@ -335,13 +382,22 @@ Song::Private::Private(const Source source)
       art_embedded_(false),
       art_unset_(false),
 
-      rating_(-1),
-
       init_from_file_(false),
-      suspicious_tags_(false)
+      suspicious_tags_(false),
+
+      memory_counter_(sizeof(Private))
 
       {}
 
+namespace {
+
+const QString &EmptyString() {
+  static const QString empty;
+  return empty;
+}
+
+}  // namespace
+
 Song::Song(const Source source) : d(new Private(source)) {}
 Song::Song(const Song &other) = default;
 Song::~Song() = default;
@@ -362,6 +418,9 @@ Song &Song::operator=(const Song &other) {
 int Song::id() const { return d->id_; }
 bool Song::is_valid() const { return d->valid_; }
 
+bool Song::IsShared() const { return d->ref.loadAcquire() > 1; }
+bool Song::SharesData(const Song &other) const { return d == other.d; }
+
 const QString &Song::title() const { return d->title_; }
 const QString &Song::album() const { return d->album_; }
 const QString &Song::artist() const { return d->artist_; }
@@ -375,8 +434,8 @@ bool Song::compilation() const { return d->compilation_; }
 const QString &Song::composer() const { return d->composer_; }
 const QString &Song::performer() const { return d->performer_; }
 const QString &Song::grouping() const { return d->grouping_; }
-const QString &Song::comment() const { return d->comment_; }
-const QString &Song::lyrics() const { return d->lyrics_; }
+const QString &Song::comment() const { return d->extra_ ? d->extra_->comment_ : EmptyString(); }
+const QString &Song::lyrics() const { return d->extra_ ? d->extra_->lyrics_ : EmptyString(); }
 
 QString Song::artist_id() const { return d->artist_id_.isNull() ? QLatin1String("") : d->artist_id_; }
 QString Song::album_id() const { return d->album_id_.isNull() ? QLatin1String("") : d->album_id_; }
@@ -397,6 +456,7 @@ const QString &Song::basefilename() const { return d->basefilename_; }
 Song::FileType Song::filetype() const { return d->filetype_; }
 qint64 Song::filesize() const { return d->filesize_; }
 qint64 Song::mtime() const { return d->mtime_; }
+const QString &Song::content_hash() const { return d->content_hash_; }
 qint64 Song::ctime() const { return d->ctime_; }
 bool Song::unavailable() const { return d->unavailable_; }
 
@@ -412,6 +472,10 @@ bool Song::compilation_off() const { return d->compilation_off_; }
 bool Song::compilation_on() const { return d->compilation_on_; }
 
 bool Song::art_embedded() const { return d->art_embedded_; }
+qint64 Song::art_embedded_size() const { return d->art_embedded_size_; }
+int Song::art_embedded_width() const { return d->art_embedded_width_; }
+int Song::art_embedded_height() const { return d->art_embedded_height_; }
+const QString &Song::art_embedded_hash() const { return d->art_embedded_hash_; }
 const QUrl &Song::art_automatic() const { return d->art_automatic_; }
 const QUrl &Song::art_manual() const { return d->art_manual_; }
 bool Song::art_unset() const { return d->art_unset_; }
@@ -420,19 +484,19 @@ const QString &Song::cue_path() const { return d->cue_path_; }
 
 float Song::rating() const { return d->rating_; }
 
-const QString &Song::acoustid_id() const { return d->acoustid_id_; }
-const QString &Song::acoustid_fingerprint() const { return d->acoustid_fingerprint_; }
+const QString &Song::acoustid_id() const { return d->extra_ ? d->extra_->acoustid_id_ : EmptyString(); }
+const QString &Song::acoustid_fingerprint() const { return d->extra_ ? d->extra_->acoustid_fingerprint_ : EmptyString(); }
 
-const QString &Song::musicbrainz_album_artist_id() const { return d->musicbrainz_album_artist_id_; }
-const QString &Song::musicbrainz_artist_id() const { return d->musicbrainz_artist_id_; }
-const QString &Song::musicbrainz_original_artist_id() const { return d->musicbrainz_original_artist_id_; }
-const QString &Song::musicbrainz_album_id() const { return d->musicbrainz_album_id_; }
-const QString &Song::musicbrainz_original_album_id() const { return d->musicbrainz_original_album_id_; }
-const QString &Song::musicbrainz_recording_id() const { return d->musicbrainz_recording_id_; }
-const QString &Song::musicbrainz_track_id() const { return d->musicbrainz_track_id_; }
-const QString &Song::musicbrainz_disc_id() const { return d->musicbrainz_disc_id_; }
-const QString &Song::musicbrainz_release_group_id() const { return d->musicbrainz_release_group_id_; }
-const QString &Song::musicbrainz_work_id() const { return d->musicbrainz_work_id_; }
+const QString &Song::musicbrainz_album_artist_id() const { return d->extra_ ? d->extra_->musicbrainz_album_artist_id_ : EmptyString(); }
+const QString &Song::musicbrainz_artist_id() const { return d->extra_ ? d->extra_->musicbrainz_artist_id_ : EmptyString(); }
+const QString &Song::musicbrainz_original_artist_id() const { return d->extra_ ? d->extra_->musicbrainz_original_artist_id_ : EmptyString(); }
+const QString &Song::musicbrainz_album_id() const { return d->extra_ ? d->extra_->musicbrainz_album_id_ : EmptyString(); }
+const QString &Song::musicbrainz_original_album_id() const { return d->extra_ ? d->extra_->musicbrainz_original_album_id_ : EmptyString(); }
+const QString &Song::musicbrainz_recording_id() const { return d->extra_ ? d->extra_->musicbrainz_recording_id_ : EmptyString(); }
+const QString &Song::musicbrainz_track_id() const { return d->extra_ ? d->extra_->musicbrainz_track_id_ : EmptyString(); }
+const QString &Song::musicbrainz_disc_id() const { return d->extra_ ? d->extra_->musicbrainz_disc_id_ : EmptyString(); }
+const QString &Song::musicbrainz_release_group_id() const { return d->extra_ ? d->extra_->musicbrainz_release_group_id_ : EmptyString(); }
+const QString &Song::musicbrainz_work_id() const { return d->extra_ ? d->extra_->musicbrainz_work_id_ : EmptyString(); }
 
 std::optional<double> Song::ebur128_integrated_loudness_lufs() const { return d->ebur128_integrated_loudness_lufs_; }
 std::optional<double> Song::ebur128_loudness_range_lu() const { return d->ebur128_loudness_range_lu_; }
@@ -450,20 +514,20 @@ void Song::set_id(const int id) { d->id_ = id; }
 void Song::set_valid(const bool v) { d->valid_ = v; }
 
 void Song::set_title(const QString &v) { d->title_sortable_ = sortable(v); d->title_ = v; }
-void Song::set_album(const QString &v) { d->album_sortable_ = sortable(v); d->album_ = v; }
-void Song::set_artist(const QString &v) { d->artist_sortable_ = sortable(v); d->artist_ = v; }
-void Song::set_albumartist(const QString &v) { d->albumartist_sortable_ = sortable(v); d->albumartist_ = v; }
+void Song::set_album(const QString &v) { d->album_sortable_ = StringInterner::Intern(sortable(v)); d->album_ = StringInterner::Intern(v); }
+void Song::set_artist(const QString &v) { d->artist_sortable_ = StringInterner::Intern(sortable(v)); d->artist_ = StringInterner::Intern(v); }
+void Song::set_albumartist(const QString &v) { d->albumartist_sortable_ = StringInterner::Intern(sortable(v)); d->albumartist_ = StringInterner::Intern(v); }
 void Song::set_track(const int v) { d->track_ = v; }
 void Song::set_disc(const int v) { d->disc_ = v; }
 void Song::set_year(const int v) { d->year_ = v; }
 void Song::set_originalyear(const int v) { d->originalyear_ = v; }
-void Song::set_genre(const QString &v) { d->genre_ = v; }
+void Song::set_genre(const QString &v) { d->genre_ = StringInterner::Intern(v); }
 void Song::set_compilation(bool v) { d->compilation_ = v; }
-void Song::set_composer(const QString &v) { d->composer_ = v; }
-void Song::set_performer(const QString &v) { d->performer_ = v; }
-void Song::set_grouping(const QString &v) { d->grouping_ = v; }
-void Song::set_comment(const QString &v) { d->comment_ = v; }
-void Song::set_lyrics(const QString &v) { d->lyrics_ = v; }
+void Song::set_composer(const QString &v) { d->composer_ = StringInterner::Intern(v); }
+void Song::set_performer(const QString &v) { d->performer_ = StringInterner::Intern(v); }
+void Song::set_grouping(const QString &v) { d->grouping_ = StringInterner::Intern(v); }
+void Song::set_comment(const QString &v) { if (d->extra_ || !v.isEmpty()) d->extra()->comment_ = v; }
+void Song::set_lyrics(const QString &v) { if (d->extra_ || !v.isEmpty()) d->extra()->lyrics_ = v; }
 
 void Song::set_artist_id(const QString &v) { d->artist_id_ = v; }
 void Song::set_album_id(const QString &v) { d->album_id_ = v; }
@@ -484,6 +548,7 @@ void Song::set_basefilename(const QString &v) { d->basefilename_ = v; }
 void Song::set_filetype(const FileType v) { d->filetype_ = v; }
 void Song::set_filesize(const qint64 v) { d->filesize_ = v; }
 void Song::set_mtime(const qint64 v) { d->mtime_ = v; }
+void Song::set_content_hash(const QString &v) { d->content_hash_ = v; }
 void Song::set_ctime(const qint64 v) { d->ctime_ = v; }
 void Song::set_unavailable(const bool v) { d->unavailable_ = v; }
 
@@ -499,6 +564,10 @@ void Song::set_compilation_on(const bool v) { d->compilation_on_ = v; }
 void Song::set_compilation_off(const bool v) { d->compilation_off_ = v; }
 
 void Song::set_art_embedded(const bool v) { d->art_embedded_ = v; }
+void Song::set_art_embedded_size(const qint64 v) { d->art_embedded_size_ = v; }
+void Song::set_art_embedded_width(const int v) { d->art_embedded_width_ = v; }
+void Song::set_art_embedded_height(const int v) { d->art_embedded_height_ = v; }
+void Song::set_art_embedded_hash(const QString &v) { d->art_embedded_hash_ = v; }
 void Song::set_art_automatic(const QUrl &v) { d->art_automatic_ = v; }
 void Song::set_art_manual(const QUrl &v) { d->art_manual_ = v; }
 void Song::set_art_unset(const bool v) { d->art_unset_ = v; }
@@ -507,19 +576,19 @@ void Song::set_cue_path(const QString &v) { d->cue_path_ = v; }
 
 void Song::set_rating(const float v) { d->rating_ = v; }
 
-void Song::set_acoustid_id(const QString &v) { d->acoustid_id_ = v; }
-void Song::set_acoustid_fingerprint(const QString &v) { d->acoustid_fingerprint_ = v; }
+void Song::set_acoustid_id(const QString &v) { if (d->extra_ || !v.isEmpty()) d->extra()->acoustid_id_ = v; }
+void Song::set_acoustid_fingerprint(const QString &v) { if (d->extra_ || !v.isEmpty()) d->extra()->acoustid_fingerprint_ = v; }
 
-void Song::set_musicbrainz_album_artist_id(const QString &v) { d->musicbrainz_album_artist_id_ = v; }
-void Song::set_musicbrainz_artist_id(const QString &v) { d->musicbrainz_artist_id_ = v; }
-void Song::set_musicbrainz_original_artist_id(const QString &v) { d->musicbrainz_original_artist_id_ = v; }
-void Song::set_musicbrainz_album_id(const QString &v) { d->musicbrainz_album_id_ = v; }
-void Song::set_musicbrainz_original_album_id(const QString &v) { d->musicbrainz_original_album_id_ = v; }
-void Song::set_musicbrainz_recording_id(const QString &v) { d->musicbrainz_recording_id_ = v; }
-void Song::set_musicbrainz_track_id(const QString &v) { d->musicbrainz_track_id_ = v; }
-void Song::set_musicbrainz_disc_id(const QString &v) { d->musicbrainz_disc_id_ = v; }
-void Song::set_musicbrainz_release_group_id(const QString &v) { d->musicbrainz_release_group_id_ = v; }
-void Song::set_musicbrainz_work_id(const QString &v) { d->musicbrainz_work_id_ = v; }
+void Song::set_musicbrainz_album_artist_id(const QString &v) { if (d->extra_ || !v.isEmpty()) d->extra()->musicbrainz_album_artist_id_ = v; }
+void Song::set_musicbrainz_artist_id(const QString &v) { if (d->extra_ || !v.isEmpty()) d->extra()->musicbrainz_artist_id_ = v; }
+void Song::set_musicbrainz_original_artist_id(const QString &v) { if (d->extra_ || !v.isEmpty()) d->extra()->musicbrainz_original_artist_id_ = v; }
+void Song::set_musicbrainz_album_id(const QString &v) { if (d->extra_ || !v.isEmpty()) d->extra()->musicbrainz_album_id_ = v; }
+void Song::set_musicbrainz_original_album_id(const QString &v) { if (d->extra_ || !v.isEmpty()) d->extra()->musicbrainz_original_album_id_ = v; }
+void Song::set_musicbrainz_recording_id(const QString &v) { if (d->extra_ || !v.isEmpty()) d->extra()->musicbrainz_recording_id_ = v; }
+void Song::set_musicbrainz_track_id(const QString &v) { if (d->extra_ || !v.isEmpty()) d->extra()->musicbrainz_track_id_ = v; }
+void Song::set_musicbrainz_disc_id(const QString &v) { if (d->extra_ || !v.isEmpty()) d->extra()->musicbrainz_disc_id_ = v; }
+void Song::set_musicbrainz_release_group_id(const QString &v) { if (d->extra_ || !v.isEmpty()) d->extra()->musicbrainz_release_group_id_ = v; }
+void Song::set_musicbrainz_work_id(const QString &v) { if (d->extra_ || !v.isEmpty()) d->extra()->musicbrainz_work_id_ = v; }
 
 void Song::set_ebur128_integrated_loudness_lufs(const std::optional<double> v) { d->ebur128_integrated_loudness_lufs_ = v; }
 void Song::set_ebur128_loudness_range_lu(const std::optional<double> v) { d->ebur128_loudness_range_lu_ = v; }
@@ -804,8 +873,8 @@ bool Song::IsMetadataEqual(const Song &other) const {
     d->composer_ == other.d->composer_ &&
     d->performer_ == other.d->performer_ &&
     d->grouping_ == other.d->grouping_ &&
-    d->comment_ == other.d->comment_ &&
-    d->lyrics_ == other.d->lyrics_ &&
+    comment() == other.comment() &&
+    lyrics() == other.lyrics() &&
     d->artist_id_ == other.d->artist_id_ &&
     d->album_id_ == other.d->album_id_ &&
     d->song_id_ == other.d->song_id_ &&
@@ -839,22 +908,22 @@ bool Song::IsFingerprintEqual(const Song &other) const {
 
 bool Song::IsAcoustIdEqual(const Song &other) const {
 
-  return d->acoustid_id_ == other.d->acoustid_id_ && d->acoustid_fingerprint_ == other.d->acoustid_fingerprint_;
+  return acoustid_id() == other.acoustid_id() && acoustid_fingerprint() == other.acoustid_fingerprint();
 
 }
 
 bool Song::IsMusicBrainzEqual(const Song &other) const {
 
-  return d->musicbrainz_album_artist_id_ == other.d->musicbrainz_album_artist_id_ &&
-    d->musicbrainz_artist_id_ == other.d->musicbrainz_artist_id_ &&
-    d->musicbrainz_original_artist_id_ == other.d->musicbrainz_original_artist_id_ &&
-    d->musicbrainz_album_id_ == other.d->musicbrainz_album_id_ &&
-    d->musicbrainz_original_album_id_ == other.d->musicbrainz_original_album_id_ &&
-    d->musicbrainz_recording_id_ == other.d->musicbrainz_recording_id_ &&
-    d->musicbrainz_track_id_ == other.d->musicbrainz_track_id_ &&
-    d->musicbrainz_disc_id_ == other.d->musicbrainz_disc_id_ &&
-    d->musicbrainz_release_group_id_ == other.d->musicbrainz_release_group_id_ &&
-    d->musicbrainz_work_id_ == other.d->musicbrainz_work_id_;
+  return musicbrainz_album_artist_id() == other.musicbrainz_album_artist_id() &&
+    musicbrainz_artist_id() == other.musicbrainz_artist_id() &&
+    musicbrainz_original_artist_id() == other.musicbrainz_original_artist_id() &&
+    musicbrainz_album_id() == other.musicbrainz_album_id() &&
+    musicbrainz_original_album_id() == other.musicbrainz_original_album_id() &&
+    musicbrainz_recording_id() == other.musicbrainz_recording_id() &&
+    musicbrainz_track_id() == other.musicbrainz_track_id() &&
+    musicbrainz_disc_id() == other.musicbrainz_disc_id() &&
+    musicbrainz_release_group_id() == other.musicbrainz_release_group_id() &&
+    musicbrainz_work_id() == other.musicbrainz_work_id();
 
 }
 
@@ -868,6 +937,7 @@ bool Song::IsEBUR128Equal(const Song &other) const {
 bool Song::IsArtEqual(const Song &other) const {
 
   return d->art_embedded_ == other.d->art_embedded_ &&
+    d->art_embedded_hash_ == other.d->art_embedded_hash_ &&
     d->art_automatic_ == other.d->art_automatic_ &&
     d->art_manual_ == other.d->art_manual_ &&
     d->art_unset_ == other.d->art_unset_;
@@ -1273,13 +1343,13 @@ void Song::InitFromProtobuf(const spb::tagreader::SongMetadata &pb) {
   d->disc_ = pb.disc();
   d->year_ = pb.year();
   d->originalyear_ = pb.originalyear();
-  d->genre_ = QString::fromUtf8(pb.genre().data(), static_cast<qint64>(pb.genre().size()));
+  set_genre(QString::fromUtf8(pb.genre().data(), static_cast<qint64>(pb.genre().size())));
   d->compilation_ = pb.compilation();
-  d->composer_ = QString::fromUtf8(pb.composer().data(), static_cast<qint64>(pb.composer().size()));
-  d->performer_ = QString::fromUtf8(pb.performer().data(), static_cast<qint64>(pb.performer().size()));
-  d->grouping_ = QString::fromUtf8(pb.grouping().data(), static_cast<qint64>(pb.grouping().size()));
-  d->comment_ = QString::fromUtf8(pb.comment().data(), static_cast<qint64>(pb.comment().size()));
-  d->lyrics_ = QString::fromUtf8(pb.lyrics().data(), static_cast<qint64>(pb.lyrics().size()));
+  set_composer(QString::fromUtf8(pb.composer().data(), static_cast<qint64>(pb.composer().size())));
+  set_performer(QString::fromUtf8(pb.performer().data(), static_cast<qint64>(pb.performer().size())));
+  set_grouping(QString::fromUtf8(pb.grouping().data(), static_cast<qint64>(pb.grouping().size())));
+  set_comment(QString::fromUtf8(pb.comment().data(), static_cast<qint64>(pb.comment().size())));
+  set_lyrics(QString::fromUtf8(pb.lyrics().data(), static_cast<qint64>(pb.lyrics().size())));
   set_length_nanosec(static_cast<qint64>(pb.length_nanosec()));
   d->bitrate_ = pb.bitrate();
   d->samplerate_ = pb.samplerate();
@@ -1302,20 +1372,28 @@ void Song::InitFromProtobuf(const spb::tagreader::SongMetadata &pb) {
   }
 
   d->art_embedded_ = pb.has_art_embedded();
-
-  d->acoustid_id_ = QString::fromUtf8(pb.acoustid_id().data(), static_cast<qint64>(pb.acoustid_id().size()));
-  d->acoustid_fingerprint_ = QString::fromUtf8(pb.acoustid_fingerprint().data(), static_cast<qint64>(pb.acoustid_fingerprint().size()));
-
-  d->musicbrainz_album_artist_id_ = QString::fromUtf8(pb.musicbrainz_album_artist_id().data(), static_cast<qint64>(pb.musicbrainz_album_artist_id().size()));
-  d->musicbrainz_artist_id_ = QString::fromUtf8(pb.musicbrainz_artist_id().data(), static_cast<qint64>(pb.musicbrainz_artist_id().size()));
-  d->musicbrainz_original_artist_id_ = QString::fromUtf8(pb.musicbrainz_original_artist_id().data(), static_cast<qint64>(pb.musicbrainz_original_artist_id().size()));
-  d->musicbrainz_album_id_ = QString::fromUtf8(pb.musicbrainz_album_id().data(), static_cast<qint64>(pb.musicbrainz_album_id().size()));
-  d->musicbrainz_original_album_id_ = QString::fromUtf8(pb.musicbrainz_original_album_id().data(), static_cast<qint64>(pb.musicbrainz_original_album_id().size()));
-  d->musicbrainz_recording_id_ = QString::fromUtf8(pb.musicbrainz_recording_id().data(), static_cast<qint64>(pb.musicbrainz_recording_id().size()));
-  d->musicbrainz_track_id_ = QString::fromUtf8(pb.musicbrainz_track_id().data(), static_cast<qint64>(pb.musicbrainz_track_id().size()));
-  d->musicbrainz_disc_id_ = QString::fromUtf8(pb.musicbrainz_disc_id().data(), static_cast<qint64>(pb.musicbrainz_disc_id().size()));
-  d->musicbrainz_release_group_id_ = QString::fromUtf8(pb.musicbrainz_release_group_id().data(), static_cast<qint64>(pb.musicbrainz_release_group_id().size()));
-  d->musicbrainz_work_id_ = QString::fromUtf8(pb.musicbrainz_work_id().data(), static_cast<qint64>(pb.musicbrainz_work_id().size()));
+  if (pb.has_art_embedded_size()) {
+    d->art_embedded_size_ = pb.art_embedded_size();
+  }
+  if (pb.has_art_embedded_width() && pb.has_art_embedded_height()) {
+    d->art_embedded_width_ = pb.art_embedded_width();
+    d->art_embedded_height_ = pb.art_embedded_height();
+  }
+  d->art_embedded_hash_ = QString::fromUtf8(pb.art_embedded_hash().data(), static_cast<qint64>(pb.art_embedded_hash().size()));
+
+  set_acoustid_id(QString::fromUtf8(pb.acoustid_id().data(), static_cast<qint64>(pb.acoustid_id().size())));
+  set_acoustid_fingerprint(QString::fromUtf8(pb.acoustid_fingerprint().data(), static_cast<qint64>(pb.acoustid_fingerprint().size())));
+
+  set_musicbrainz_album_artist_id(QString::fromUtf8(pb.musicbrainz_album_artist_id().data(), static_cast<qint64>(pb.musicbrainz_album_artist_id().size())));
+  set_musicbrainz_artist_id(QString::fromUtf8(pb.musicbrainz_artist_id().data(), static_cast<qint64>(pb.musicbrainz_artist_id().size())));
+  set_musicbrainz_original_artist_id(QString::fromUtf8(pb.musicbrainz_original_artist_id().data(), static_cast<qint64>(pb.musicbrainz_original_artist_id().size())));
+  set_musicbrainz_album_id(QString::fromUtf8(pb.musicbrainz_album_id().data(), static_cast<qint64>(pb.musicbrainz_album_id().size())));
+  set_musicbrainz_original_album_id(QString::fromUtf8(pb.musicbrainz_original_album_id().data(), static_cast<qint64>(pb.musicbrainz_original_album_id().size())));
+  set_musicbrainz_recording_id(QString::fromUtf8(pb.musicbrainz_recording_id().data(), static_cast<qint64>(pb.musicbrainz_recording_id().size())));
+  set_musicbrainz_track_id(QString::fromUtf8(pb.musicbrainz_track_id().data(), static_cast<qint64>(pb.musicbrainz_track_id().size())));
+  set_musicbrainz_disc_id(QString::fromUtf8(pb.musicbrainz_disc_id().data(), static_cast<qint64>(pb.musicbrainz_disc_id().size())));
+  set_musicbrainz_release_group_id(QString::fromUtf8(pb.musicbrainz_release_group_id().data(), static_cast<qint64>(pb.musicbrainz_release_group_id().size())));
+  set_musicbrainz_work_id(QString::fromUtf8(pb.musicbrainz_work_id().data(), static_cast<qint64>(pb.musicbrainz_work_id().size())));
 
   d->suspicious_tags_ = pb.suspicious_tags();
 
@@ -1341,8 +1419,8 @@ void Song::ToProtobuf(spb::tagreader::SongMetadata *pb) const {
   pb->set_composer(d->composer_.toStdString());
   pb->set_performer(d->performer_.toStdString());
   pb->set_grouping(d->grouping_.toStdString());
-  pb->set_comment(d->comment_.toStdString());
-  pb->set_lyrics(d->lyrics_.toStdString());
+  pb->set_comment(comment().toStdString());
+  pb->set_lyrics(lyrics().toStdString());
   pb->set_length_nanosec(length_nanosec());
   pb->set_bitrate(d->bitrate_);
   pb->set_samplerate(d->samplerate_);
@@ -1358,100 +1436,246 @@ void Song::ToProtobuf(spb::tagreader::SongMetadata *pb) const {
   pb->set_lastplayed(d->lastplayed_);
   pb->set_lastseen(d->lastseen_);
   pb->set_art_embedded(d->art_embedded_);
+  if (d->art_embedded_size_ > 0) {
+    pb->set_art_embedded_size(d->art_embedded_size_);
+  }
+  if (d->art_embedded_width_ > 0 && d->art_embedded_height_ > 0) {
+    pb->set_art_embedded_width(d->art_embedded_width_);
+    pb->set_art_embedded_height(d->art_embedded_height_);
+  }
+  if (!d->art_embedded_hash_.isEmpty()) {
+    pb->set_art_embedded_hash(d->art_embedded_hash_.toStdString());
+  }
   pb->set_rating(d->rating_);
 
-  pb->set_acoustid_id(d->acoustid_id_.toStdString());
-  pb->set_acoustid_fingerprint(d->acoustid_fingerprint_.toStdString());
+  pb->set_acoustid_id(acoustid_id().toStdString());
+  pb->set_acoustid_fingerprint(acoustid_fingerprint().toStdString());
 
-  pb->set_musicbrainz_album_artist_id(d->musicbrainz_album_artist_id_.toStdString());
-  pb->set_musicbrainz_artist_id(d->musicbrainz_artist_id_.toStdString());
-  pb->set_musicbrainz_original_artist_id(d->musicbrainz_original_artist_id_.toStdString());
-  pb->set_musicbrainz_album_id(d->musicbrainz_album_id_.toStdString());
-  pb->set_musicbrainz_original_album_id(d->musicbrainz_original_album_id_.toStdString());
-  pb->set_musicbrainz_recording_id(d->musicbrainz_recording_id_.toStdString());
-  pb->set_musicbrainz_track_id(d->musicbrainz_track_id_.toStdString());
-  pb->set_musicbrainz_disc_id(d->musicbrainz_disc_id_.toStdString());
-  pb->set_musicbrainz_release_group_id(d->musicbrainz_release_group_id_.toStdString());
-  pb->set_musicbrainz_work_id(d->musicbrainz_work_id_.toStdString());
+  pb->set_musicbrainz_album_artist_id(musicbrainz_album_artist_id().toStdString());
+  pb->set_musicbrainz_artist_id(musicbrainz_artist_id().toStdString());
+  pb->set_musicbrainz_original_artist_id(musicbrainz_original_artist_id().toStdString());
+  pb->set_musicbrainz_album_id(musicbrainz_album_id().toStdString());
+  pb->set_musicbrainz_original_album_id(musicbrainz_original_album_id().toStdString());
+  pb->set_musicbrainz_recording_id(musicbrainz_recording_id().toStdString());
+  pb->set_musicbrainz_track_id(musicbrainz_track_id().toStdString());
+  pb->set_musicbrainz_disc_id(musicbrainz_disc_id().toStdString());
+  pb->set_musicbrainz_release_group_id(musicbrainz_release_group_id().toStdString());
+  pb->set_musicbrainz_work_id(musicbrainz_work_id().toStdString());
 
   pb->set_suspicious_tags(d->suspicious_tags_);
 
 }
 
-void Song::InitFromQuery(const QSqlRecord &r, const bool reliable_metadata, const int col) {
+namespace {
+
+// Positions in Song::kRowIdColumns, so hydrating a row doesn't need any column name lookups.
+const int kColumnRowId = Song::ColumnIndex(QStringLiteral("ROWID"));
+const int kColumnTitle = Song::ColumnIndex(QStringLiteral("title"));
+const int kColumnAlbum = Song::ColumnIndex(QStringLiteral("album"));
+const int kColumnArtist = Song::ColumnIndex(QStringLiteral("artist"));
+const int kColumnAlbumArtist = Song::ColumnIndex(QStringLiteral("albumartist"));
+const int kColumnTrack = Song::ColumnIndex(QStringLiteral("track"));
+const int kColumnDisc = Song::ColumnIndex(QStringLiteral("disc"));
+const int kColumnYear = Song::ColumnIndex(QStringLiteral("year"));
+const int kColumnOriginalYear = Song::ColumnIndex(QStringLiteral("originalyear"));
+const int kColumnGenre = Song::ColumnIndex(QStringLiteral("genre"));
+const int kColumnCompilation = Song::ColumnIndex(QStringLiteral("compilation"));
+const int kColumnComposer = Song::ColumnIndex(QStringLiteral("composer"));
+const int kColumnPerformer = Song::ColumnIndex(QStringLiteral("performer"));
+const int kColumnGrouping = Song::ColumnIndex(QStringLiteral("grouping"));
+const int kColumnComment = Song::ColumnIndex(QStringLiteral("comment"));
+const int kColumnLyrics = Song::ColumnIndex(QStringLiteral("lyrics"));
+const int kColumnArtistId = Song::ColumnIndex(QStringLiteral("artist_id"));
+const int kColumnAlbumId = Song::ColumnIndex(QStringLiteral("album_id"));
+const int kColumnSongId = Song::ColumnIndex(QStringLiteral("song_id"));
+const int kColumnBeginning = Song::ColumnIndex(QStringLiteral("beginning"));
+const int kColumnLength = Song::ColumnIndex(QStringLiteral("length"));
+const int kColumnBitrate = Song::ColumnIndex(QStringLiteral("bitrate"));
+const int kColumnSamplerate = Song::ColumnIndex(QStringLiteral("samplerate"));
+const int kColumnBitdepth = Song::ColumnIndex(QStringLiteral("bitdepth"));
+const int kColumnEBUR128IntegratedLoudness = Song::ColumnIndex(QStringLiteral("ebur128_integrated_loudness_lufs"));
+const int kColumnEBUR128LoudnessRange = Song::ColumnIndex(QStringLiteral("ebur128_loudness_range_lu"));
+const int kColumnSource = Song::ColumnIndex(QStringLiteral("source"));
+const int kColumnDirectoryId = Song::ColumnIndex(QStringLiteral("directory_id"));
+const int kColumnUrl = Song::ColumnIndex(QStringLiteral("url"));
+const int kColumnFileType = Song::ColumnIndex(QStringLiteral("filetype"));
+const int kColumnFileSize = Song::ColumnIndex(QStringLiteral("filesize"));
+const int kColumnMTime = Song::ColumnIndex(QStringLiteral("mtime"));
+const int kColumnContentHash = Song::ColumnIndex(QStringLiteral("content_hash"));
+const int kColumnCTime = Song::ColumnIndex(QStringLiteral("ctime"));
+const int kColumnUnavailable = Song::ColumnIndex(QStringLiteral("unavailable"));
+const int kColumnFingerprint = Song::ColumnIndex(QStringLiteral("fingerprint"));
+const int kColumnPlayCount = Song::ColumnIndex(QStringLiteral("playcount"));
+const int kColumnSkipCount = Song::ColumnIndex(QStringLiteral("skipcount"));
+const int kColumnLastPlayed = Song::ColumnIndex(QStringLiteral("lastplayed"));
+const int kColumnLastSeen = Song::ColumnIndex(QStringLiteral("lastseen"));
+const int kColumnCompilationDetected = Song::ColumnIndex(QStringLiteral("compilation_detected"));
+const int kColumnCompilationOn = Song::ColumnIndex(QStringLiteral("compilation_on"));
+const int kColumnCompilationOff = Song::ColumnIndex(QStringLiteral("compilation_off"));
+const int kColumnArtEmbedded = Song::ColumnIndex(QStringLiteral("art_embedded"));
+const int kColumnArtEmbeddedSize = Song::ColumnIndex(QStringLiteral("art_embedded_size"));
+const int kColumnArtEmbeddedWidth = Song::ColumnIndex(QStringLiteral("art_embedded_width"));
+const int kColumnArtEmbeddedHeight = Song::ColumnIndex(QStringLiteral("art_embedded_height"));
+const int kColumnArtEmbeddedHash = Song::ColumnIndex(QStringLiteral("art_embedded_hash"));
+const int kColumnArtAutomatic = Song::ColumnIndex(QStringLiteral("art_automatic"));
+const int kColumnArtManual = Song::ColumnIndex(QStringLiteral("art_manual"));
+const int kColumnArtUnset = Song::ColumnIndex(QStringLiteral("art_unset"));
+const int kColumnCuePath = Song::ColumnIndex(QStringLiteral("cue_path"));
+const int kColumnRating = Song::ColumnIndex(QStringLiteral("rating"));
+const int kColumnAcoustIdId = Song::ColumnIndex(QStringLiteral("acoustid_id"));
+const int kColumnAcoustIdFingerprint = Song::ColumnIndex(QStringLiteral("acoustid_fingerprint"));
+const int kColumnMusicBrainzAlbumArtistId = Song::ColumnIndex(QStringLiteral("musicbrainz_album_artist_id"));
+const int kColumnMusicBrainzArtistId = Song::ColumnIndex(QStringLiteral("musicbrainz_artist_id"));
+const int kColumnMusicBrainzOriginalArtistId = Song::ColumnIndex(QStringLiteral("musicbrainz_original_artist_id"));
+const int kColumnMusicBrainzAlbumId = Song::ColumnIndex(QStringLiteral("musicbrainz_album_id"));
+const int kColumnMusicBrainzOriginalAlbumId = Song::ColumnIndex(QStringLiteral("musicbrainz_original_album_id"));
+const int kColumnMusicBrainzRecordingId = Song::ColumnIndex(QStringLiteral("musicbrainz_recording_id"));
+const int kColumnMusicBrainzTrackId = Song::ColumnIndex(QStringLiteral("musicbrainz_track_id"));
+const int kColumnMusicBrainzDiscId = Song::ColumnIndex(QStringLiteral("musicbrainz_disc_id"));
+const int kColumnMusicBrainzReleaseGroupId = Song::ColumnIndex(QStringLiteral("musicbrainz_release_group_id"));
+const int kColumnMusicBrainzWorkId = Song::ColumnIndex(QStringLiteral("musicbrainz_work_id"));
+
+// Values of a row addressed by kRowIdColumns position, for use with SqlHelper.
+template<typename T>
+class SongRowValues {
+ public:
+  explicit SongRowValues(const T &row, const Song::QueryColumns &columns) : row_(row), columns_(columns) {}
+  int count() const { return static_cast<int>(Song::kRowIdColumns.count()); }
+  QVariant value(const int column) const { return columns_.contains(column) ? row_.value(columns_[column]) : QVariant(); }
+
+ private:
+  const T &row_;
+  const Song::QueryColumns &columns_;
+};
 
-  Q_ASSERT(kRowIdColumns.count() + col <= r.count());
+}  // namespace
+
+Song::QueryColumns::QueryColumns(const QSqlRecord &record, const int col) {
+
+  const int count = static_cast<int>(kRowIdColumns.count());
+  positions_.reserve(count);
 
-  d->id_ = SqlHelper::ValueToInt(r, ColumnIndex(QStringLiteral("ROWID")) + col);
-
-  set_title(SqlHelper::ValueToString(r, ColumnIndex(QStringLiteral("title")) + col));
-  set_album(SqlHelper::ValueToString(r, ColumnIndex(QStringLiteral("album")) + col));
-  set_artist(SqlHelper::ValueToString(r, ColumnIndex(QStringLiteral("artist")) + col));
-  set_albumartist(SqlHelper::ValueToString(r, ColumnIndex(QStringLiteral("albumartist")) + col));
-  d->track_ = SqlHelper::ValueToInt(r, ColumnIndex(QStringLiteral("track")) + col);
-  d->disc_ = SqlHelper::ValueToInt(r, ColumnIndex(QStringLiteral("disc")) + col);
-  d->year_ = SqlHelper::ValueToInt(r, ColumnIndex(QStringLiteral("year")) + col);
-  d->originalyear_ = SqlHelper::ValueToInt(r, ColumnIndex(QStringLiteral("originalyear")) + col);
-  d->genre_ = SqlHelper::ValueToString(r, ColumnIndex(QStringLiteral("genre")) + col);
-  d->compilation_ = r.value(ColumnIndex(QStringLiteral("compilation")) + col).toBool();
-  d->composer_ = SqlHelper::ValueToString(r, ColumnIndex(QStringLiteral("composer")) + col);
-  d->performer_ = SqlHelper::ValueToString(r, ColumnIndex(QStringLiteral("performer")) + col);
-  d->grouping_ = SqlHelper::ValueToString(r, ColumnIndex(QStringLiteral("grouping")) + col);
-  d->comment_ = SqlHelper::ValueToString(r, ColumnIndex(QStringLiteral("comment")) + col);
-  d->lyrics_ = SqlHelper::ValueToString(r, ColumnIndex(QStringLiteral("lyrics")) + col);
-  d->artist_id_ = SqlHelper::ValueToString(r, ColumnIndex(QStringLiteral("artist_id")) + col);
-  d->album_id_ = SqlHelper::ValueToString(r, ColumnIndex(QStringLiteral("album_id")) + col);
-  d->song_id_ = SqlHelper::ValueToString(r, ColumnIndex(QStringLiteral("song_id")) + col);
-  d->beginning_ = r.value(ColumnIndex(QStringLiteral("beginning")) + col).isNull() ? 0 : r.value(ColumnIndex(QStringLiteral("beginning")) + col).toLongLong();
-  set_length_nanosec(SqlHelper::ValueToLongLong(r, ColumnIndex(QStringLiteral("length")) + col));
-  d->bitrate_ = SqlHelper::ValueToInt(r, ColumnIndex(QStringLiteral("bitrate")) + col);
-  d->samplerate_ = SqlHelper::ValueToInt(r, ColumnIndex(QStringLiteral("samplerate")) + col);
-  d->bitdepth_ = SqlHelper::ValueToInt(r, ColumnIndex(QStringLiteral("bitdepth")) + col);
-  if (!r.value(ColumnIndex(QStringLiteral("ebur128_integrated_loudness_lufs")) + col).isNull()) {
-    d->ebur128_integrated_loudness_lufs_ = r.value(ColumnIndex(QStringLiteral("ebur128_integrated_loudness_lufs")) + col).toDouble();
+  // Queries selecting all song columns have them in kRowIdColumns order.
+  // Only trust the positions if the first and last columns are where we expect them, otherwise look up every column by name.
+  if (record.count() >= count + col &&
+      record.fieldName(col).compare(kRowIdColumns.first(), Qt::CaseInsensitive) == 0 &&
+      record.fieldName(col + count - 1).compare(kRowIdColumns.last(), Qt::CaseInsensitive) == 0) {
+    for (int i = 0; i < count; ++i) {
+      positions_ << i + col;
+    }
+    return;
   }
-  if (!r.value(ColumnIndex(QStringLiteral("ebur128_loudness_range_lu")) + col).isNull()) {
-    d->ebur128_loudness_range_lu_ = r.value(ColumnIndex(QStringLiteral("ebur128_loudness_range_lu")) + col).toDouble();
+
+  for (int i = 0; i < count; ++i) {
+    int position = -1;
+    for (int j = col; j < record.count(); ++j) {
+      if (record.fieldName(j).compare(kRowIdColumns[i], Qt::CaseInsensitive) == 0) {
+        position = j;
+        break;
+      }
+    }
+    positions_ << position;
   }
-  d->source_ = static_cast<Source>(r.value(ColumnIndex(QStringLiteral("source")) + col).isNull() ? 0 : r.value(ColumnIndex(QStringLiteral("source")) + col).toInt());
-  d->directory_id_ = SqlHelper::ValueToInt(r, ColumnIndex(QStringLiteral("directory_id")) + col);
-  set_url(QUrl::fromEncoded(SqlHelper::ValueToString(r, ColumnIndex(QStringLiteral("url")) + col).toUtf8()));
-  d->basefilename_ = QFileInfo(d->url_.toLocalFile()).fileName();
-  d->filetype_ = FileType(r.value(ColumnIndex(QStringLiteral("filetype")) + col).isNull() ? 0 : r.value(ColumnIndex(QStringLiteral("filetype")) + col).toInt());
-  d->filesize_ = SqlHelper::ValueToLongLong(r, ColumnIndex(QStringLiteral("filesize")) + col);
-  d->mtime_ = SqlHelper::ValueToLongLong(r, ColumnIndex(QStringLiteral("mtime")) + col);
-  d->ctime_ = SqlHelper::ValueToLongLong(r, ColumnIndex(QStringLiteral("ctime")) + col);
-  d->unavailable_ = r.value(ColumnIndex(QStringLiteral("unavailable")) + col).toBool();
-  d->fingerprint_ = SqlHelper::ValueToString(r, ColumnIndex(QStringLiteral("fingerprint")) + col);
-  d->playcount_ = SqlHelper::ValueToUInt(r, ColumnIndex(QStringLiteral("playcount")) + col);
-  d->skipcount_ = SqlHelper::ValueToUInt(r, ColumnIndex(QStringLiteral("skipcount")) + col);
-  d->lastplayed_ = SqlHelper::ValueToLongLong(r, ColumnIndex(QStringLiteral("lastplayed")) + col);
-  d->lastseen_ = SqlHelper::ValueToLongLong(r, ColumnIndex(QStringLiteral("lastseen")) + col);
-  d->compilation_detected_ = SqlHelper::ValueToBool(r, ColumnIndex(QStringLiteral("compilation_detected")) + col);
-  d->compilation_on_ = SqlHelper::ValueToBool(r, ColumnIndex(QStringLiteral("compilation_on")) + col);
-  d->compilation_off_ = SqlHelper::ValueToBool(r, ColumnIndex(QStringLiteral("compilation_off")) + col);
-
-  d->art_embedded_ = SqlHelper::ValueToBool(r, ColumnIndex(QStringLiteral("art_embedded")) + col);
-  d->art_automatic_ = QUrl::fromEncoded(SqlHelper::ValueToString(r, ColumnIndex(QStringLiteral("art_automatic")) + col).toUtf8());
-  d->art_manual_ = QUrl::fromEncoded(SqlHelper::ValueToString(r, ColumnIndex(QStringLiteral("art_manual")) + col).toUtf8());
-  d->art_unset_ = SqlHelper::ValueToBool(r, ColumnIndex(QStringLiteral("art_unset")) + col);
-
-  d->cue_path_ = SqlHelper::ValueToString(r, ColumnIndex(QStringLiteral("cue_path")) + col);
-  d->rating_ = SqlHelper::ValueToFloat(r, ColumnIndex(QStringLiteral("rating")) + col);
-
-  d->acoustid_id_ = SqlHelper::ValueToString(r, ColumnIndex(QStringLiteral("acoustid_id")) + col);
-  d->acoustid_fingerprint_ = SqlHelper::ValueToString(r, ColumnIndex(QStringLiteral("acoustid_fingerprint")) + col);
-
-  d->musicbrainz_album_artist_id_ = SqlHelper::ValueToString(r, ColumnIndex(QStringLiteral("musicbrainz_album_artist_id")) + col);
-  d->musicbrainz_artist_id_ = SqlHelper::ValueToString(r, ColumnIndex(QStringLiteral("musicbrainz_artist_id")) + col);
-  d->musicbrainz_original_artist_id_ = SqlHelper::ValueToString(r, ColumnIndex(QStringLiteral("musicbrainz_original_artist_id")) + col);
-  d->musicbrainz_album_id_ = SqlHelper::ValueToString(r, ColumnIndex(QStringLiteral("musicbrainz_album_id")) + col);
-  d->musicbrainz_original_album_id_ = SqlHelper::ValueToString(r, ColumnIndex(QStringLiteral("musicbrainz_original_album_id")) + col);
-  d->musicbrainz_recording_id_ = SqlHelper::ValueToString(r, ColumnIndex(QStringLiteral("musicbrainz_recording_id")) + col);
-  d->musicbrainz_track_id_ = SqlHelper::ValueToString(r, ColumnIndex(QStringLiteral("musicbrainz_track_id")) + col);
-  d->musicbrainz_disc_id_ = SqlHelper::ValueToString(r, ColumnIndex(QStringLiteral("musicbrainz_disc_id")) + col);
-  d->musicbrainz_release_group_id_ = SqlHelper::ValueToString(r, ColumnIndex(QStringLiteral("musicbrainz_release_group_id")) + col);
-  d->musicbrainz_work_id_ = SqlHelper::ValueToString(r, ColumnIndex(QStringLiteral("musicbrainz_work_id")) + col);
+
+}
+
+template<typename T>
+void Song::InitFromRow(const T &row, const QueryColumns &columns, const bool reliable_metadata) {
+
+  const SongRowValues<T> r(row, columns);
+
+  if (columns.contains(kColumnRowId)) d->id_ = SqlHelper::ValueToInt(r, kColumnRowId);
+
+  if (columns.contains(kColumnTitle)) set_title(SqlHelper::ValueToString(r, kColumnTitle));
+  if (columns.contains(kColumnAlbum)) set_album(SqlHelper::ValueToString(r, kColumnAlbum));
+  if (columns.contains(kColumnArtist)) set_artist(SqlHelper::ValueToString(r, kColumnArtist));
+  if (columns.contains(kColumnAlbumArtist)) set_albumartist(SqlHelper::ValueToString(r, kColumnAlbumArtist));
+  if (columns.contains(kColumnTrack)) d->track_ = SqlHelper::ValueToInt(r, kColumnTrack);
+  if (columns.contains(kColumnDisc)) d->disc_ = SqlHelper::ValueToInt(r, kColumnDisc);
+  if (columns.contains(kColumnYear)) d->year_ = SqlHelper::ValueToInt(r, kColumnYear);
+  if (columns.contains(kColumnOriginalYear)) d->originalyear_ = SqlHelper::ValueToInt(r, kColumnOriginalYear);
+  if (columns.contains(kColumnGenre)) set_genre(SqlHelper::ValueToString(r, kColumnGenre));
+  if (columns.contains(kColumnCompilation)) d->compilation_ = r.value(kColumnCompilation).toBool();
+  if (columns.contains(kColumnComposer)) set_composer(SqlHelper::ValueToString(r, kColumnComposer));
+  if (columns.contains(kColumnPerformer)) set_performer(SqlHelper::ValueToString(r, kColumnPerformer));
+  if (columns.contains(kColumnGrouping)) set_grouping(SqlHelper::ValueToString(r, kColumnGrouping));
+  if (columns.contains(kColumnComment)) set_comment(SqlHelper::ValueToString(r, kColumnComment));
+  if (columns.contains(kColumnLyrics)) set_lyrics(SqlHelper::ValueToString(r, kColumnLyrics));
+  if (columns.contains(kColumnArtistId)) d->artist_id_ = SqlHelper::ValueToString(r, kColumnArtistId);
+  if (columns.contains(kColumnAlbumId)) d->album_id_ = SqlHelper::ValueToString(r, kColumnAlbumId);
+  if (columns.contains(kColumnSongId)) d->song_id_ = SqlHelper::ValueToString(r, kColumnSongId);
+  if (columns.contains(kColumnBeginning)) {
+    const QVariant beginning = r.value(kColumnBeginning);
+    d->beginning_ = beginning.isNull() ? 0 : beginning.toLongLong();
+  }
+  if (columns.contains(kColumnLength)) set_length_nanosec(SqlHelper::ValueToLongLong(r, kColumnLength));
+  if (columns.contains(kColumnBitrate)) d->bitrate_ = SqlHelper::ValueToInt(r, kColumnBitrate);
+  if (columns.contains(kColumnSamplerate)) d->samplerate_ = SqlHelper::ValueToInt(r, kColumnSamplerate);
+  if (columns.contains(kColumnBitdepth)) d->bitdepth_ = SqlHelper::ValueToInt(r, kColumnBitdepth);
+  if (columns.contains(kColumnEBUR128IntegratedLoudness)) {
+    const QVariant ebur128_integrated_loudness_lufs = r.value(kColumnEBUR128IntegratedLoudness);
+    if (!ebur128_integrated_loudness_lufs.isNull()) {
+      d->ebur128_integrated_loudness_lufs_ = ebur128_integrated_loudness_lufs.toDouble();
+    }
+  }
+  if (columns.contains(kColumnEBUR128LoudnessRange)) {
+    const QVariant ebur128_loudness_range_lu = r.value(kColumnEBUR128LoudnessRange);
+    if (!ebur128_loudness_range_lu.isNull()) {
+      d->ebur128_loudness_range_lu_ = ebur128_loudness_range_lu.toDouble();
+    }
+  }
+  if (columns.contains(kColumnSource)) {
+    const QVariant source = r.value(kColumnSource);
+    d->source_ = static_cast<Source>(source.isNull() ? 0 : source.toInt());
+  }
+  if (columns.contains(kColumnDirectoryId)) d->directory_id_ = SqlHelper::ValueToInt(r, kColumnDirectoryId);
+  if (columns.contains(kColumnUrl)) {
+    set_url(QUrl::fromEncoded(SqlHelper::ValueToString(r, kColumnUrl).toUtf8()));
+    d->basefilename_ = QFileInfo(d->url_.toLocalFile()).fileName();
+  }
+  if (columns.contains(kColumnFileType)) {
+    const QVariant filetype = r.value(kColumnFileType);
+    d->filetype_ = FileType(filetype.isNull() ? 0 : filetype.toInt());
+  }
+  if (columns.contains(kColumnFileSize)) d->filesize_ = SqlHelper::ValueToLongLong(r, kColumnFileSize);
+  if (columns.contains(kColumnMTime)) d->mtime_ = SqlHelper::ValueToLongLong(r, kColumnMTime);
+  if (columns.contains(kColumnContentHash)) d->content_hash_ = SqlHelper::ValueToString(r, kColumnContentHash);
+  if (columns.contains(kColumnCTime)) d->ctime_ = SqlHelper::ValueToLongLong(r, kColumnCTime);
+  if (columns.contains(kColumnUnavailable)) d->unavailable_ = r.value(kColumnUnavailable).toBool();
+  if (columns.contains(kColumnFingerprint)) d->fingerprint_ = SqlHelper::ValueToString(r, kColumnFingerprint);
+  if (columns.contains(kColumnPlayCount)) d->playcount_ = SqlHelper::ValueToUInt(r, kColumnPlayCount);
+  if (columns.contains(kColumnSkipCount)) d->skipcount_ = SqlHelper::ValueToUInt(r, kColumnSkipCount);
+  if (columns.contains(kColumnLastPlayed)) d->lastplayed_ = SqlHelper::ValueToLongLong(r, kColumnLastPlayed);
+  if (columns.contains(kColumnLastSeen)) d->lastseen_ = SqlHelper::ValueToLongLong(r, kColumnLastSeen);
+  if (columns.contains(kColumnCompilationDetected)) d->compilation_detected_ = SqlHelper::ValueToBool(r, kColumnCompilationDetected);
+  if (columns.contains(kColumnCompilationOn)) d->compilation_on_ = SqlHelper::ValueToBool(r, kColumnCompilationOn);
+  if (columns.contains(kColumnCompilationOff)) d->compilation_off_ = SqlHelper::ValueToBool(r, kColumnCompilationOff);
+
+  if (columns.contains(kColumnArtEmbedded)) d->art_embedded_ = SqlHelper::ValueToBool(r, kColumnArtEmbedded);
+  if (columns.contains(kColumnArtEmbeddedSize)) d->art_embedded_size_ = SqlHelper::ValueToLongLong(r, kColumnArtEmbeddedSize);
+  if (columns.contains(kColumnArtEmbeddedWidth)) d->art_embedded_width_ = SqlHelper::ValueToInt(r, kColumnArtEmbeddedWidth);
+  if (columns.contains(kColumnArtEmbeddedHeight)) d->art_embedded_height_ = SqlHelper::ValueToInt(r, kColumnArtEmbeddedHeight);
+  if (columns.contains(kColumnArtEmbeddedHash)) d->art_embedded_hash_ = SqlHelper::ValueToString(r, kColumnArtEmbeddedHash);
+  if (columns.contains(kColumnArtAutomatic)) d->art_automatic_ = QUrl::fromEncoded(SqlHelper::ValueToString(r, kColumnArtAutomatic).toUtf8());
+  if (columns.contains(kColumnArtManual)) d->art_manual_ = QUrl::fromEncoded(SqlHelper::ValueToString(r, kColumnArtManual).toUtf8());
+  if (columns.contains(kColumnArtUnset)) d->art_unset_ = SqlHelper::ValueToBool(r, kColumnArtUnset);
+
+  if (columns.contains(kColumnCuePath)) d->cue_path_ = SqlHelper::ValueToString(r, kColumnCuePath);
+  if (columns.contains(kColumnRating)) d->rating_ = SqlHelper::ValueToFloat(r, kColumnRating);
+
+  if (columns.contains(kColumnAcoustIdId)) set_acoustid_id(SqlHelper::ValueToString(r, kColumnAcoustIdId));
+  if (columns.contains(kColumnAcoustIdFingerprint)) set_acoustid_fingerprint(SqlHelper::ValueToString(r, kColumnAcoustIdFingerprint));
+
+  if (columns.contains(kColumnMusicBrainzAlbumArtistId)) set_musicbrainz_album_artist_id(SqlHelper::ValueToString(r, kColumnMusicBrainzAlbumArtistId));
+  if (columns.contains(kColumnMusicBrainzArtistId)) set_musicbrainz_artist_id(SqlHelper::ValueToString(r, kColumnMusicBrainzArtistId));
+  if (columns.contains(kColumnMusicBrainzOriginalArtistId)) set_musicbrainz_original_artist_id(SqlHelper::ValueToString(r, kColumnMusicBrainzOriginalArtistId));
+  if (columns.contains(kColumnMusicBrainzAlbumId)) set_musicbrainz_album_id(SqlHelper::ValueToString(r, kColumnMusicBrainzAlbumId));
+  if (columns.contains(kColumnMusicBrainzOriginalAlbumId)) set_musicbrainz_original_album_id(SqlHelper::ValueToString(r, kColumnMusicBrainzOriginalAlbumId));
+  if (columns.contains(kColumnMusicBrainzRecordingId)) set_musicbrainz_recording_id(SqlHelper::ValueToString(r, kColumnMusicBrainzRecordingId));
+  if (columns.contains(kColumnMusicBrainzTrackId)) set_musicbrainz_track_id(SqlHelper::ValueToString(r, kColumnMusicBrainzTrackId));
+  if (columns.contains(kColumnMusicBrainzDiscId)) set_musicbrainz_disc_id(SqlHelper::ValueToString(r, kColumnMusicBrainzDiscId));
+  if (columns.contains(kColumnMusicBrainzReleaseGroupId)) set_musicbrainz_release_group_id(SqlHelper::ValueToString(r, kColumnMusicBrainzReleaseGroupId));
+  if (columns.contains(kColumnMusicBrainzWorkId)) set_musicbrainz_work_id(SqlHelper::ValueToString(r, kColumnMusicBrainzWorkId));
 
   d->valid_ = true;
   d->init_from_file_ = reliable_metadata;
@@ -1460,6 +1684,14 @@ void Song::InitFromQuery(const QSqlRecord &r, const bool reliable_metadata, cons
 
 }
 
+void Song::InitFromQuery(const QSqlRecord &r, const bool reliable_metadata, const int col) {
+
+  Q_ASSERT(kRowIdColumns.count() + col <= r.count());
+
+  InitFromRow(r, QueryColumns(r, col), reliable_metadata);
+
+}
+
 void Song::InitFromQuery(const SqlQuery &query, const bool reliable_metadata, const int col) {
 
   InitFromQuery(query.record(), reliable_metadata, col);
@@ -1472,6 +1704,19 @@ void Song::InitFromQuery(const SqlRow &row, const bool reliable_metadata, const
 
 }
 
+void Song::InitFromQuery(const SqlQuery &query, const QueryColumns &columns, const bool reliable_metadata) {
+
+  // Reads the values of the current row directly, without building a QSqlRecord of the whole row.
+  InitFromRow(query, columns, reliable_metadata);
+
+}
+
+void Song::InitFromQuery(const SqlRow &row, const QueryColumns &columns, const bool reliable_metadata) {
+
+  InitFromRow(row, columns, reliable_metadata);
+
+}
+
 void Song::InitFromFilePartial(const QString &filename, const QFileInfo &fileinfo) {
 
   set_url(QUrl::fromLocalFile(filename));
@@ -1523,11 +1768,11 @@ void Song::InitFromItdb(Itdb_Track *track, const QString &prefix) {
   d->track_ = track->track_nr;
   d->disc_ = track->cd_nr;
   d->year_ = track->year;
-  d->genre_ = QString::fromUtf8(track->genre);
+  set_genre(QString::fromUtf8(track->genre));
   d->compilation_ = track->compilation == 1;
-  d->composer_ = QString::fromUtf8(track->composer);
-  d->grouping_ = QString::fromUtf8(track->grouping);
-  d->comment_ = QString::fromUtf8(track->comment);
+  set_composer(QString::fromUtf8(track->composer));
+  set_grouping(QString::fromUtf8(track->grouping));
+  set_comment(QString::fromUtf8(track->comment));
 
   set_length_nanosec(track->tracklen * kNsecPerMsec);
 
@@ -1585,7 +1830,7 @@ void Song::ToItdb(Itdb_Track *track) const {
   track->compilation = d->compilation_;
   track->composer = strdup(d->composer_.toUtf8().constData());
   track->grouping = strdup(d->grouping_.toUtf8().constData());
-  track->comment = strdup(d->comment_.toUtf8().constData());
+  track->comment = strdup(comment().toUtf8().constData());
 
   track->tracklen = static_cast<int>(length_nanosec() / kNsecPerMsec);
 
@@ -1615,8 +1860,8 @@ void Song::InitFromMTP(const LIBMTP_track_t *track, const QString &host) {
   set_title(QString::fromUtf8(track->title));
   set_artist(QString::fromUtf8(track->artist));
   set_album(QString::fromUtf8(track->album));
-  d->genre_ = QString::fromUtf8(track->genre);
-  d->composer_ = QString::fromUtf8(track->composer);
+  set_genre(QString::fromUtf8(track->genre));
+  set_composer(QString::fromUtf8(track->composer));
   d->track_ = track->tracknumber;
 
   d->url_ = QUrl(QStringLiteral("mtp://%1/%2").arg(host, QString::number(track->item_id)));
@@ -1715,8 +1960,8 @@ void Song::BindToQuery(SqlQuery *query) const {
   query->BindStringValue(QStringLiteral(":composer"), d->composer_);
   query->BindStringValue(QStringLiteral(":performer"), d->performer_);
   query->BindStringValue(QStringLiteral(":grouping"), d->grouping_);
-  query->BindStringValue(QStringLiteral(":comment"), d->comment_);
-  query->BindStringValue(QStringLiteral(":lyrics"), d->lyrics_);
+  query->BindStringValue(QStringLiteral(":comment"), comment());
+  query->BindStringValue(QStringLiteral(":lyrics"), lyrics());
 
   query->BindStringValue(QStringLiteral(":artist_id"), d->artist_id_);
   query->BindStringValue(QStringLiteral(":album_id"), d->album_id_);
@@ -1735,6 +1980,7 @@ void Song::BindToQuery(SqlQuery *query) const {
   query->BindValue(QStringLiteral(":filetype"), static_cast<int>(d->filetype_));
   query->BindLongLongValueOrZero(QStringLiteral(":filesize"), d->filesize_);
   query->BindLongLongValueOrZero(QStringLiteral(":mtime"), d->mtime_);
+  query->BindStringValue(QStringLiteral(":content_hash"), d->content_hash_);
   query->BindLongLongValueOrZero(QStringLiteral(":ctime"), d->ctime_);
   query->BindBoolValue(QStringLiteral(":unavailable"), d->unavailable_);
 
@@ -1751,6 +1997,10 @@ void Song::BindToQuery(SqlQuery *query) const {
   query->BindBoolValue(QStringLiteral(":compilation_effective"), is_compilation());
 
   query->BindBoolValue(QStringLiteral(":art_embedded"), d->art_embedded_);
+  query->BindLongLongValue(QStringLiteral(":art_embedded_size"), d->art_embedded_size_);
+  query->BindIntValue(QStringLiteral(":art_embedded_width"), d->art_embedded_width_);
+  query->BindIntValue(QStringLiteral(":art_embedded_height"), d->art_embedded_height_);
+  query->BindStringValue(QStringLiteral(":art_embedded_hash"), d->art_embedded_hash_);
   query->BindUrlValue(QStringLiteral(":art_automatic"), d->art_automatic_);
   query->BindUrlValue(QStringLiteral(":art_manual"), d->art_manual_);
   query->BindBoolValue(QStringLiteral(":art_unset"), d->art_unset_);
@@ -1762,19 +2012,19 @@ void Song::BindToQuery(SqlQuery *query) const {
 
   query->BindFloatValue(QStringLiteral(":rating"), d->rating_);
 
-  query->BindStringValue(QStringLiteral(":acoustid_id"), d->acoustid_id_);
-  query->BindStringValue(QStringLiteral(":acoustid_fingerprint"), d->acoustid_fingerprint_);
+  query->BindStringValue(QStringLiteral(":acoustid_id"), acoustid_id());
+  query->BindStringValue(QStringLiteral(":acoustid_fingerprint"), acoustid_fingerprint());
 
-  query->BindStringValue(QStringLiteral(":musicbrainz_album_artist_id"), d->musicbrainz_album_artist_id_);
-  query->BindStringValue(QStringLiteral(":musicbrainz_artist_id"), d->musicbrainz_artist_id_);
-  query->BindStringValue(QStringLiteral(":musicbrainz_original_artist_id"), d->musicbrainz_original_artist_id_);
-  query->BindStringValue(QStringLiteral(":musicbrainz_album_id"), d->musicbrainz_album_id_);
-  query->BindStringValue(QStringLiteral(":musicbrainz_original_album_id"), d->musicbrainz_original_album_id_);
-  query->BindStringValue(QStringLiteral(":musicbrainz_recording_id"), d->musicbrainz_recording_id_);
-  query->BindStringValue(QStringLiteral(":musicbrainz_track_id"), d->musicbrainz_track_id_);
-  query->BindStringValue(QStringLiteral(":musicbrainz_disc_id"), d->musicbrainz_disc_id_);
-  query->BindStringValue(QStringLiteral(":musicbrainz_release_group_id"), d->musicbrainz_release_group_id_);
-  query->BindStringValue(QStringLiteral(":musicbrainz_work_id"), d->musicbrainz_work_id_);
+  query->BindStringValue(QStringLiteral(":musicbrainz_album_artist_id"), musicbrainz_album_artist_id());
+  query->BindStringValue(QStringLiteral(":musicbrainz_artist_id"), musicbrainz_artist_id());
+  query->BindStringValue(QStringLiteral(":musicbrainz_original_artist_id"), musicbrainz_original_artist_id());
+  query->BindStringValue(QStringLiteral(":musicbrainz_album_id"), musicbrainz_album_id());
+  query->BindStringValue(QStringLiteral(":musicbrainz_original_album_id"), musicbrainz_original_album_id());
+  query->BindStringValue(QStringLiteral(":musicbrainz_recording_id"), musicbrainz_recording_id());
+  query->BindStringValue(QStringLiteral(":musicbrainz_track_id"), musicbrainz_track_id());
+  query->BindStringValue(QStringLiteral(":musicbrainz_disc_id"), musicbrainz_disc_id());
+  query->BindStringValue(QStringLiteral(":musicbrainz_release_group_id"), musicbrainz_release_group_id());
+  query->BindStringValue(QStringLiteral(":musicbrainz_work_id"), musicbrainz_work_id());
 
   query->BindDoubleOrNullValue(QStringLiteral(":ebur128_integrated_loudness_lufs"), d->ebur128_integrated_loudness_lufs_);
   query->BindDoubleOrNullValue(QStringLiteral(":ebur128_loudness_range_lu"), d->ebur128_loudness_range_lu_);
@@ -1791,7 +2041,7 @@ void Song::BindToFtsQuery(SqlQuery *query) const {
   query->BindValue(QStringLiteral(":ftsperformer"), d->performer_);
   query->BindValue(QStringLiteral(":ftsgrouping"), d->grouping_);
   query->BindValue(QStringLiteral(":ftsgenre"), d->genre_);
-  query->BindValue(QStringLiteral(":ftscomment"), d->comment_);
+  query->BindValue(QStringLiteral(":ftscomment"), comment());
 
 }
 
@@ -184,6 +184,7 @@ class Song {
   FileType filetype() const;
   qint64 filesize() const;
   qint64 mtime() const;
+  const QString &content_hash() const;
   qint64 ctime() const;
   bool unavailable() const;
 
@@ -199,6 +200,10 @@ class Song {
   bool compilation_off() const;
 
   bool art_embedded() const;
+  qint64 art_embedded_size() const;
+  int art_embedded_width() const;
+  int art_embedded_height() const;
+  const QString &art_embedded_hash() const;
   const QUrl &art_automatic() const;
   const QUrl &art_manual() const;
   bool art_unset() const;
@@ -272,6 +277,7 @@ class Song {
   void set_filetype(const FileType v);
   void set_filesize(const qint64 v);
   void set_mtime(const qint64 v);
+  void set_content_hash(const QString &v);
   void set_ctime(const qint64 v);
   void set_unavailable(const bool v);
 
@@ -287,6 +293,10 @@ class Song {
   void set_compilation_off(const bool v);
 
   void set_art_embedded(const bool v);
+  void set_art_embedded_size(const qint64 v);
+  void set_art_embedded_width(const int v);
+  void set_art_embedded_height(const int v);
+  void set_art_embedded_hash(const QString &v);
   void set_art_automatic(const QUrl &v);
   void set_art_manual(const QUrl &v);
   void set_art_unset(const bool v);
@@ -356,6 +366,18 @@ class Song {
   static int ColumnIndex(const QString &field);
   static QString JoinSpec(const QString &table);
 
+  // Positions of the columns in kRowIdColumns within a query result, resolved once per query instead of for every row.
+  // Columns the query doesn't select have position -1, and those fields are left untouched by InitFromQuery.
+  class QueryColumns {
+   public:
+    explicit QueryColumns(const QSqlRecord &record, const int col = 0);
+    int operator[](const int column) const { return positions_[column]; }
+    bool contains(const int column) const { return positions_[column] != -1; }
+
+   private:
+    QList<int> positions_;
+  };
+
   // Pretty accessors
   QString PrettyTitle() const;
   QString PrettyTitleWithArtist() const;
@@ -391,6 +413,10 @@ class Song {
   bool IsOnSameAlbum(const Song &other) const;
   bool IsSimilar(const Song &other) const;
 
+  // Whether other copies of this song share its data, and whether the other song is a copy sharing the same data.
+  bool IsShared() const;
+  bool SharesData(const Song &other) const;
+
   static Source SourceFromURL(const QUrl &url);
   static QString TextForSource(const Source source);
   static QString DescriptionForSource(const Source source);
@@ -423,6 +449,8 @@ class Song {
   void InitFromQuery(const QSqlRecord &r, const bool reliable_metadata, const int col = 0);
   void InitFromQuery(const SqlQuery &query, const bool reliable_metadata, const int col = 0);
   void InitFromQuery(const SqlRow &row, const bool reliable_metadata, const int col = 0);
+  void InitFromQuery(const SqlQuery &query, const QueryColumns &columns, const bool reliable_metadata);
+  void InitFromQuery(const SqlRow &row, const QueryColumns &columns, const bool reliable_metadata);
   void InitFromFilePartial(const QString &filename, const QFileInfo &fileinfo);
   void InitArtManual();
   void InitArtAutomatic();
@@ -468,6 +496,9 @@ class Song {
 
   static QString sortable(const QString &v);
 
+  template<typename T>
+  void InitFromRow(const T &row, const QueryColumns &columns, const bool reliable_metadata);
+
   QSharedDataPointer<Private> d;
 };
 
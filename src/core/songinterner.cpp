@@ -0,0 +1,93 @@
+/*
+ * Strawberry Music Player
+ *
+ * Strawberry is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Strawberry is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Strawberry.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#include "config.h"
+
+#include <QtGlobal>
+#include <QMutex>
+#include <QHash>
+#include <QPair>
+#include <QUrl>
+
+#include "song.h"
+#include "songinterner.h"
+
+namespace {
+
+using UrlKey = QPair<QUrl, qint64>;
+
+// Songs that were released by everything else are only referenced by the interner.
+template<typename T>
+void Prune(QHash<T, Song> *songs) {
+
+  for (typename QHash<T, Song>::iterator it = songs->begin(); it != songs->end();) {
+    if (it.value().IsShared()) {
+      ++it;
+    }
+    else {
+      it = songs->erase(it);
+    }
+  }
+
+}
+
+template<typename T>
+Song InternSong(QHash<T, Song> *songs, const T &key, const Song &song) {
+
+  typename QHash<T, Song>::iterator it = songs->find(key);
+  if (it != songs->end()) {
+    const Song &interned = it.value();
+    if (interned.SharesData(song) || (interned.source() == song.source() && interned.mtime() == song.mtime() && interned.IsAllMetadataEqual(song))) {
+      return interned;
+    }
+    it.value() = song;
+    return song;
+  }
+
+  songs->insert(key, song);
+  return song;
+
+}
+
+}  // namespace
+
+QMutex SongInterner::sMutex;
+QHash<int, Song> SongInterner::sSongsById;
+QHash<UrlKey, Song> SongInterner::sSongsByUrl;
+int SongInterner::sPruneCount = 0;
+
+Song SongInterner::Intern(const Song &song) {
+
+  if (!song.is_valid() || (!song.is_collection_song() && song.url().isEmpty())) return song;
+
+  QMutexLocker l(&sMutex);
+
+  // Pruning is amortized by only doing it after the number of songs doubled.
+  if (sSongsById.count() + sSongsByUrl.count() >= qMax(1000, sPruneCount * 2)) {
+    Prune(&sSongsById);
+    Prune(&sSongsByUrl);
+    sPruneCount = sSongsById.count() + sSongsByUrl.count();
+  }
+
+  if (song.is_collection_song() && song.id() != -1) {
+    return InternSong(&sSongsById, song.id(), song);
+  }
+
+  return InternSong(&sSongsByUrl, UrlKey(song.url(), song.beginning_nanosec()), song);
+
+}
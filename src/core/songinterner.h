@@ -0,0 +1,50 @@
+/*
+ * Strawberry Music Player
+ *
+ * Strawberry is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Strawberry is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Strawberry.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#ifndef SONGINTERNER_H
+#define SONGINTERNER_H
+
+#include "config.h"
+
+#include <QtGlobal>
+#include <QMutex>
+#include <QHash>
+#include <QPair>
+#include <QUrl>
+
+#include "core/song.h"
+
+// Lets playlist items restored from the database share the metadata of identical songs, so a song that is in several playlists, or several times in one, is only kept in memory once.
+// Collection songs are keyed by their collection ID, other songs by their URL and beginning. A new song only replaces the interned one if the metadata or modification time differ.
+// Changing an interned song is safe, Song detaches its data when it's modified.
+class SongInterner {
+ public:
+  ~SongInterner() = delete;  // Do not construct variables of this class.
+
+  // Returns a copy of an identical song that was interned earlier, or interns this song and returns it.
+  // This method is thread-safe.
+  static Song Intern(const Song &song);
+
+ private:
+  static QMutex sMutex;
+  static QHash<int, Song> sSongsById;
+  static QHash<QPair<QUrl, qint64>, Song> sSongsByUrl;
+  static int sPruneCount;
+};
+
+#endif  // SONGINTERNER_H
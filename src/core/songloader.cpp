@@ -22,6 +22,7 @@
 #include "config.h"
 
 #include <algorithm>
+#include <utility>
 
 #ifdef HAVE_GSTREAMER
 #  include <gst/gst.h>
@@ -38,6 +39,7 @@
 #include <QSet>
 #include <QTimer>
 #include <QString>
+#include <QStringList>
 #include <QUrl>
 #include <QEventLoop>
 
@@ -64,6 +66,7 @@
 
 QSet<QString> SongLoader::sRawUriSchemes;
 const int SongLoader::kDefaultTimeout = 5000;
+const int SongLoader::kDirectoryBatchSize = 250;
 
 SongLoader::SongLoader(SharedPtr<CollectionBackendInterface> collection_backend, const SharedPtr<Player> player, QObject *parent)
     : QObject(parent),
@@ -109,12 +112,24 @@ SongLoader::~SongLoader() {
 
 SongLoader::Result SongLoader::Load(const QUrl &url) {
 
+  return LoadUrl(url, nullptr);
+
+}
+
+SongLoader::Result SongLoader::Load(const QUrl &url, const QHash<QUrl, SongList> &collection_songs) {
+
+  return LoadUrl(url, &collection_songs);
+
+}
+
+SongLoader::Result SongLoader::LoadUrl(const QUrl &url, const QHash<QUrl, SongList> *collection_songs) {
+
   if (url.isEmpty()) return Result::Error;
 
   url_ = url;
 
   if (url_.isLocalFile()) {
-    return LoadLocal(url_.toLocalFile());
+    return LoadLocal(url_.toLocalFile(), collection_songs);
   }
 
   if (sRawUriSchemes.contains(url_.scheme()) || player_->HandlerForUrl(url)) {
@@ -226,13 +241,27 @@ void SongLoader::AudioCDTracksTagsLoaded(const SongList &songs) {
 }
 #endif
 
-SongLoader::Result SongLoader::LoadLocal(const QString &filename) {
+SongLoader::Result SongLoader::LoadLocal(const QString &filename, const QHash<QUrl, SongList> *collection_songs) {
 
   qLog(Debug) << "Loading local file" << filename;
 
   // Search in the database.
   QUrl url = QUrl::fromLocalFile(filename);
 
+  if (collection_songs) {
+    const SongList songs = collection_songs->value(url);
+    for (const Song &song : songs) {
+      if (song.is_valid()) {
+        songs_ << song;
+      }
+    }
+    if (!songs_.isEmpty()) return Result::Success;
+
+    // It's not in the database, load it asynchronously.
+    preload_func_ = std::bind(&SongLoader::LoadLocalAsync, this, filename);
+    return Result::BlockingLoadRequired;
+  }
+
   QMutexLocker l(collection_backend_->db()->Mutex());
   QSqlDatabase db(collection_backend_->db()->Connect());
 
@@ -330,23 +359,49 @@ SongLoader::Result SongLoader::LoadLocalAsync(const QString &filename) {
 
 }
 
+static bool IsMetadataLoaded(const Song &song) {
+
+  // Maybe we loaded the metadata already, for example from a cuesheet.
+  return !song.url().isLocalFile() || (song.init_from_file() && song.filetype() != Song::FileType::Unknown);
+
+}
+
 void SongLoader::LoadMetadataBlocking() {
 
-  for (int i = 0; i < songs_.size(); i++) {
-    EffectiveSongLoad(&songs_[i]);
-  }
+  EffectiveSongsLoad(collection_backend_, &songs_);
 
 }
 
-void SongLoader::EffectiveSongLoad(Song *song) {
+void SongLoader::EffectiveSongsLoad(SharedPtr<CollectionBackendInterface> collection_backend, SongList *songs) {
 
-  if (!song || !song->url().isLocalFile()) return;
+  QList<QUrl> urls;
+  for (const Song &song : std::as_const(*songs)) {
+    if (!IsMetadataLoaded(song)) urls << song.url();
+  }
+  if (urls.isEmpty()) return;
 
-  if (song->init_from_file() && song->filetype() != Song::FileType::Unknown) {
-    // Maybe we loaded the metadata already, for example from a cuesheet.
-    return;
+  // First, try to get the songs from the collection
+  const QHash<QUrl, SongList> collection_songs = collection_backend->GetSongsByUrls(urls);
+
+  for (Song &song : *songs) {
+    if (IsMetadataLoaded(song)) continue;
+    const SongList sections = collection_songs.value(song.url());
+    auto collection_song = std::find_if(sections.begin(), sections.end(), [](const Song &section) { return section.beginning_nanosec() == 0; });
+    if (collection_song != sections.end() && collection_song->is_valid()) {
+      song = *collection_song;
+    }
+    else {
+      // It's a normal media file
+      TagReaderClient::Instance()->ReadFileBlocking(song.url().toLocalFile(), &song);
+    }
   }
 
+}
+
+void SongLoader::EffectiveSongLoad(Song *song) {
+
+  if (!song || IsMetadataLoaded(*song)) return;
+
   // First, try to get the song from the collection
   Song collection_song = collection_backend_->GetSongByUrl(song->url());
   if (collection_song.is_valid()) {
@@ -364,7 +419,10 @@ void SongLoader::LoadPlaylist(ParserBase *parser, const QString &filename) {
 
   QFile file(filename);
   if (file.open(QIODevice::ReadOnly)) {
+    // Big playlists pass on their songs while they're loaded.
+    parser->SetSongsLoadedCallback([this](const SongList &songs) { emit SongsFound(songs); });
     songs_ = parser->Load(&file, filename, QFileInfo(filename).path());
+    parser->SetSongsLoadedCallback(nullptr);
     file.close();
   }
   else {
@@ -373,36 +431,26 @@ void SongLoader::LoadPlaylist(ParserBase *parser, const QString &filename) {
 
 }
 
-static bool CompareSongs(const Song &left, const Song &right) {
-
-  // Order by artist, album, disc, track
-  if (left.artist() < right.artist()) return true;
-  if (left.artist() > right.artist()) return false;
-  if (left.album() < right.album()) return true;
-  if (left.album() > right.album()) return false;
-  if (left.disc() < right.disc()) return true;
-  if (left.disc() > right.disc()) return false;
-  if (left.track() < right.track()) return true;
-  if (left.track() > right.track()) return false;
-  return left.url() < right.url();
-
-}
-
 void SongLoader::LoadLocalDirectory(const QString &filename) {
 
+  // The songs are only partially loaded, so they're ordered by filename.
+  // The filenames are sorted first so the songs can be passed on in order while the rest of the directory is loaded.
+  QStringList filenames;
   QDirIterator it(filename, QDir::Files | QDir::NoDotAndDotDot | QDir::Readable, QDirIterator::Subdirectories);
-
   while (it.hasNext()) {
-    LoadLocalPartial(it.next());
+    filenames << it.next();
   }
+  std::sort(filenames.begin(), filenames.end());
 
-  std::stable_sort(songs_.begin(), songs_.end(), CompareSongs);
+  int found = static_cast<int>(songs_.count());
+  for (const QString &file : std::as_const(filenames)) {
+    LoadLocalPartial(file);
+    if (songs_.count() - found >= kDirectoryBatchSize) {
+      emit SongsFound(songs_.mid(found));
+      found = static_cast<int>(songs_.count());
+    }
+  }
 
-  // Load the first song:
-  // all songs will be loaded async, but we want the first one in our list to be fully loaded,
-  // so if the user has the "Start playing when adding to playlist" preference behaviour set,
-  // it can enjoy the first song being played (seek it, have moodbar, etc.)
-  if (!songs_.isEmpty()) EffectiveSongLoad(&(*songs_.begin()));
 }
 
 void SongLoader::AddAsRawStream() {
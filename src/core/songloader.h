@@ -36,6 +36,7 @@
 #include <QObject>
 #include <QThreadPool>
 #include <QByteArray>
+#include <QHash>
 #include <QSet>
 #include <QString>
 #include <QStringList>
@@ -69,6 +70,7 @@ class SongLoader : public QObject {
   };
 
   static const int kDefaultTimeout;
+  static const int kDirectoryBatchSize;
 
   const QUrl &url() const { return url_; }
   const SongList &songs() const { return songs_; }
@@ -78,12 +80,19 @@ class SongLoader : public QObject {
 
   // If Success is returned the songs are fully loaded. If BlockingLoadRequired is returned LoadFilenamesBlocking() needs to be called next.
   Result Load(const QUrl &url);
+  // Same as Load(), but local files are looked up in songs from CollectionBackend::GetSongsByUrls() instead of the database.
+  Result Load(const QUrl &url, const QHash<QUrl, SongList> &collection_songs);
   // Loads the files with only filenames. When finished, songs() contains a complete list of all Song objects, but without metadata.
   // This method is blocking, do not call it from the UI thread.
   SongLoader::Result LoadFilenamesBlocking();
   // Completely load songs previously loaded with LoadFilenamesBlocking().
   // When finished, the Song objects in songs() contain metadata now. This method is blocking, do not call it from the UI thread.
   void LoadMetadataBlocking();
+  // Completely loads a single song, from the collection if it's in it. This method is blocking, do not call it from the UI thread.
+  void EffectiveSongLoad(Song *song);
+  // Completely loads the songs, the ones in the collection are looked up with a single query.
+  // This method is blocking, do not call it from the UI thread.
+  static void EffectiveSongsLoad(SharedPtr<CollectionBackendInterface> collection_backend, SongList *songs);
   Result LoadAudioCD();
 
   QStringList errors() { return errors_; }
@@ -92,6 +101,8 @@ class SongLoader : public QObject {
   void AudioCDTracksLoadFinished();
   void LoadAudioCDFinished(const bool success);
   void LoadRemoteFinished();
+  // Emitted from the thread calling LoadFilenamesBlocking() while a directory or playlist is loaded, with the songs found since the last time.
+  void SongsFound(const SongList &songs);
 
  private slots:
   void ScheduleTimeout();
@@ -110,9 +121,9 @@ class SongLoader : public QObject {
     Finished
   };
 
-  Result LoadLocal(const QString &filename);
+  Result LoadUrl(const QUrl &url, const QHash<QUrl, SongList> *collection_songs);
+  Result LoadLocal(const QString &filename, const QHash<QUrl, SongList> *collection_songs);
   SongLoader::Result LoadLocalAsync(const QString &filename);
-  void EffectiveSongLoad(Song *song);
   Result LoadLocalPartial(const QString &filename);
   void LoadLocalDirectory(const QString &filename);
   void LoadPlaylist(ParserBase *parser, const QString &filename);
@@ -19,13 +19,35 @@
 
 #include "config.h"
 
+#include <atomic>
+
 #include <QMap>
+#include <QElapsedTimer>
+#include <QDateTime>
 #include <QVariant>
 #include <QString>
 #include <QUrl>
 
+#include "core/logging.h"
 #include "sqlquery.h"
 
+namespace {
+std::atomic<qint64> sSlowQueryThreshold(0);
+std::atomic<qint64> sLastExecTime(0);
+}  // namespace
+
+void SqlQuery::SetSlowQueryThreshold(const qint64 msec) {
+
+  sSlowQueryThreshold = msec;
+
+}
+
+qint64 SqlQuery::LastExecTime() {
+
+  return sLastExecTime;
+
+}
+
 void SqlQuery::BindValue(const QString &placeholder, const QVariant &value) {
 
 #if QT_VERSION >= QT_VERSION_CHECK(6, 0, 0)
@@ -92,9 +114,18 @@ void SqlQuery::BindNotNullIntValue(const QString &placeholder, const int value)
 
 bool SqlQuery::Exec() {
 
+  QElapsedTimer timer;
+  timer.start();
+
   bool success = exec();
   last_query_ = executedQuery();
 
+  sLastExecTime = QDateTime::currentMSecsSinceEpoch();
+  const qint64 slow_query_threshold = sSlowQueryThreshold;
+  if (success && slow_query_threshold > 0 && timer.elapsed() >= slow_query_threshold) {
+    LogSlowQuery(timer.elapsed());
+  }
+
 #if QT_VERSION >= QT_VERSION_CHECK(6, 0, 0)
   for (QMap<QString, QVariant>::const_iterator it = bound_values_.constBegin(); it != bound_values_.constEnd(); ++it) {
     last_query_.replace(it.key(), it.value().toString());
@@ -112,6 +143,35 @@ bool SqlQuery::Exec() {
 
 }
 
+void SqlQuery::LogSlowQuery(const qint64 elapsed) {
+
+  qLog(Warning) << "Slow SQL query took" << elapsed << "ms:" << lastQuery();
+
+  QSqlQuery plan(db_);
+  if (!plan.prepare(QStringLiteral("EXPLAIN QUERY PLAN ") + lastQuery())) return;
+
+#if QT_VERSION >= QT_VERSION_CHECK(6, 0, 0)
+  const QVariantList values = boundValues();
+  for (int i = 0; i < values.count(); ++i) {
+    plan.bindValue(i, values[i]);
+  }
+#else
+  QMapIterator<QString, QVariant> it(boundValues());
+  while (it.hasNext()) {
+    it.next();
+    plan.bindValue(it.key(), it.value());
+  }
+#endif
+
+  if (!plan.exec()) return;
+
+  // The last column is the description of each step, full table scans show up as "SCAN <table>" without an index.
+  while (plan.next()) {
+    qLog(Warning) << "Query plan:" << plan.value(plan.record().count() - 1).toString();
+  }
+
+}
+
 QString SqlQuery::LastQuery() const {
 
   return last_query_;
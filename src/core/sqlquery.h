@@ -34,7 +34,12 @@
 class SqlQuery : public QSqlQuery {
 
  public:
-  explicit SqlQuery(const QSqlDatabase &db) : QSqlQuery(db) {}
+  explicit SqlQuery(const QSqlDatabase &db) : QSqlQuery(db), db_(db) {}
+
+  // Queries slower than this are logged with their query plan, 0 disables logging.
+  static void SetSlowQueryThreshold(const qint64 msec);
+  // Time of the last executed query in milliseconds since epoch.
+  static qint64 LastExecTime();
 
   int columns() const { return QSqlQuery::record().count(); }
 
@@ -53,6 +58,9 @@ class SqlQuery : public QSqlQuery {
   QString LastQuery() const;
 
  private:
+  void LogSlowQuery(const qint64 elapsed);
+
+  QSqlDatabase db_;
 #if QT_VERSION >= QT_VERSION_CHECK(6, 0, 0)
   QMap<QString, QVariant> bound_values_;
 #endif
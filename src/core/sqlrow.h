@@ -32,6 +32,7 @@ class SqlRow {
 
  public:
   explicit SqlRow(const SqlQuery &query);
+  explicit SqlRow(const QSqlRecord &record) : record_(record) {}
 
   int columns() const { return record_.count(); }
   const QSqlRecord &record() const { return record_; }
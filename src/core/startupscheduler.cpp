@@ -0,0 +1,87 @@
+/*
+ * Strawberry Music Player
+ *
+ * Strawberry is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Strawberry is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Strawberry.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#include "config.h"
+
+#include <algorithm>
+#include <utility>
+
+#include <QObject>
+#include <QTimer>
+#include <QString>
+#include <QElapsedTimer>
+
+#include "core/logging.h"
+#include "core/trace.h"
+#include "startupscheduler.h"
+
+StartupScheduler::StartupScheduler(QObject *parent) : QObject(parent), started_(false) {
+
+  timer_.start();
+
+}
+
+void StartupScheduler::Add(const QString &name, const Priority priority, std::function<void()> init) {
+
+  Task task;
+  task.name = name;
+  task.priority = priority;
+  task.init = std::move(init);
+
+  const QList<Task>::iterator it = std::upper_bound(tasks_.begin(), tasks_.end(), priority, [](const Priority p, const Task &t) { return p < t.priority; });
+  tasks_.insert(it, task);
+
+}
+
+void StartupScheduler::Start() {
+
+  if (started_) return;
+  started_ = true;
+
+  // Timers with no interval are run when all the events that are queued now are handled, after the window is painted.
+  QTimer::singleShot(0, this, &StartupScheduler::Interactive);
+
+}
+
+void StartupScheduler::Interactive() {
+
+  qLog(Info) << "Main window interactive after" << timer_.elapsed() << "ms";
+
+  RunNext();
+
+}
+
+void StartupScheduler::RunNext() {
+
+  TRACE_SCOPE("startup", "StartupScheduler::RunNext");
+
+  if (tasks_.isEmpty()) {
+    qLog(Info) << "Startup finished after" << timer_.elapsed() << "ms";
+    return;
+  }
+
+  const Task task = tasks_.takeFirst();
+
+  QElapsedTimer task_timer;
+  task_timer.start();
+  task.init();
+  qLog(Debug) << "Created" << task.name << "at startup in" << task_timer.elapsed() << "ms";
+
+  QTimer::singleShot(0, this, &StartupScheduler::RunNext);
+
+}
@@ -0,0 +1,68 @@
+/*
+ * Strawberry Music Player
+ *
+ * Strawberry is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Strawberry is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Strawberry.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#ifndef STARTUPSCHEDULER_H
+#define STARTUPSCHEDULER_H
+
+#include "config.h"
+
+#include <functional>
+
+#include <QObject>
+#include <QList>
+#include <QString>
+#include <QElapsedTimer>
+
+// Creates the subsystems that the first frame of the main window doesn't need after it's shown.
+// One is created for each pass of the event loop in priority order, so the window stays responsive and they're ready before they're used.
+// The time until the main window is interactive and until all subsystems are created is logged.
+class StartupScheduler : public QObject {
+  Q_OBJECT
+
+ public:
+  explicit StartupScheduler(QObject *parent = nullptr);
+
+  enum class Priority {
+    High,
+    Normal,
+    Low
+  };
+
+  // Tasks are run in the order they were added within the same priority.
+  void Add(const QString &name, const Priority priority, std::function<void()> init);
+
+  // Should be called when the main window was created, the tasks are run when the event loop is idle.
+  void Start();
+
+ private slots:
+  void Interactive();
+  void RunNext();
+
+ private:
+  struct Task {
+    QString name;
+    Priority priority;
+    std::function<void()> init;
+  };
+
+  QElapsedTimer timer_;
+  QList<Task> tasks_;
+  bool started_;
+};
+
+#endif  // STARTUPSCHEDULER_H
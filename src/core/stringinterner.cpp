@@ -0,0 +1,57 @@
+/*
+ * Strawberry Music Player
+ *
+ * Strawberry is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Strawberry is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Strawberry.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#include "config.h"
+
+#include <QtGlobal>
+#include <QMutex>
+#include <QSet>
+#include <QString>
+
+#include "stringinterner.h"
+
+QMutex StringInterner::sMutex;
+QSet<QString> StringInterner::sStrings;
+qint64 StringInterner::sPruneCount = 0;
+
+QString StringInterner::Intern(const QString &str) {
+
+  if (str.isEmpty()) return str;
+
+  QMutexLocker l(&sMutex);
+
+  // Strings that aren't used by any song anymore are only referenced by the interner, pruning is amortized by only doing it after the number of strings doubled.
+  if (sStrings.count() >= qMax(static_cast<qint64>(1000), sPruneCount * 2)) {
+    for (QSet<QString>::iterator it = sStrings.begin(); it != sStrings.end();) {
+      if (it->isDetached()) {
+        it = sStrings.erase(it);
+      }
+      else {
+        ++it;
+      }
+    }
+    sPruneCount = sStrings.count();
+  }
+
+  QSet<QString>::const_iterator it = sStrings.constFind(str);
+  if (it != sStrings.constEnd()) return *it;
+
+  sStrings.insert(str);
+  return str;
+
+}
@@ -0,0 +1,45 @@
+/*
+ * Strawberry Music Player
+ *
+ * Strawberry is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Strawberry is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Strawberry.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#ifndef STRINGINTERNER_H
+#define STRINGINTERNER_H
+
+#include "config.h"
+
+#include <QtGlobal>
+#include <QMutex>
+#include <QSet>
+#include <QString>
+
+// Lets songs share the data of strings that are repeated in many songs, such as artists, albums and genres.
+// A collection with thousands of songs by the same artist then only keeps the artist once in memory.
+class StringInterner {
+ public:
+  ~StringInterner() = delete;  // Do not construct variables of this class.
+
+  // Returns a copy of an identical string that was interned earlier, or interns this string and returns it.
+  // This method is thread-safe.
+  static QString Intern(const QString &str);
+
+ private:
+  static QMutex sMutex;
+  static QSet<QString> sStrings;
+  static qint64 sPruneCount;
+};
+
+#endif  // STRINGINTERNER_H
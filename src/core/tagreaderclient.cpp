@@ -22,38 +22,126 @@
 #include "config.h"
 
 #include <string>
+#include <utility>
+#include <functional>
+#include <algorithm>
 
 #include <QtGlobal>
 #include <QObject>
 #include <QThread>
+#include <QThreadPool>
+#include <QRunnable>
+#include <QTimer>
+#include <QIODevice>
+#include <QDir>
+#include <QFile>
+#include <QTemporaryFile>
+#include <QStandardPaths>
 #include <QByteArray>
+#include <QList>
+#include <QSet>
 #include <QString>
+#include <QStringList>
 #include <QImage>
 
 #include "core/logging.h"
 #include "core/workerpool.h"
+#include "core/sharedpayload.h"
+#include "core/settings.h"
+#include "settings/collectionsettingspage.h"
+#ifdef USE_INPROCESS_TAGREADER
+#  include "tagreaderhandler.h"
+#endif
 
 #include "song.h"
 #include "tagreaderclient.h"
 
 namespace {
 constexpr char kWorkerExecutableName[] = "strawberry-tagreader";
+constexpr int kMaxWorkers = 4;
+constexpr int kReadFilesBatchSize = 16;
+constexpr int kSaveFilesBatchSize = 50;
+constexpr int kSaveCoalesceMsec = 3000;
+#ifdef USE_INPROCESS_TAGREADER
+constexpr char kJournalDirectory[] = "tagreaderjournal";
+constexpr char kBlacklistFile[] = "tagreaderblacklist";
+
+class FunctionRunnable : public QRunnable {
+ public:
+  explicit FunctionRunnable(std::function<void()> function) : function_(std::move(function)) {}
+  void run() override { function_(); }
+
+ private:
+  std::function<void()> function_;
+};
+#endif
 }
 
 TagReaderClient *TagReaderClient::sInstance = nullptr;
 
-TagReaderClient::TagReaderClient(QObject *parent) : QObject(parent), worker_pool_(new WorkerPool<HandlerType>(this)) {
+TagReaderClient::TagReaderClient(QObject *parent)
+    : QObject(parent),
+      worker_pool_(new WorkerPool<HandlerType>(this)),
+      save_timer_(new QTimer(this))
+#ifdef USE_INPROCESS_TAGREADER
+      ,
+      inprocess_(false),
+      thread_pool_(nullptr)
+#endif
+      {
 
   sInstance = this;
   original_thread_ = thread();
 
   worker_pool_->SetExecutableName(QLatin1String(kWorkerExecutableName));
+  // Start with one worker, the pool starts more during scans.
+  worker_pool_->SetWorkerCount(1);
+  worker_pool_->SetMaxWorkerCount(std::clamp(QThread::idealThreadCount() / 2, 1, kMaxWorkers));
   QObject::connect(worker_pool_, &WorkerPool<HandlerType>::WorkerFailedToStart, this, &TagReaderClient::WorkerFailedToStart);
 
+  save_timer_->setSingleShot(true);
+  save_timer_->setInterval(kSaveCoalesceMsec);
+  QObject::connect(save_timer_, &QTimer::timeout, this, &TagReaderClient::SavePendingFiles);
+
+  SharedPayload::RemoveStale();
+
+#ifdef USE_INPROCESS_TAGREADER
+  Settings s;
+  s.beginGroup(CollectionSettingsPage::kSettingsGroup);
+  inprocess_ = s.value("inprocess_tagreader", false).toBool();
+  s.endGroup();
+
+  if (inprocess_) {
+    thread_pool_ = new QThreadPool(this);
+    thread_pool_->setMaxThreadCount(QThread::idealThreadCount());
+    handler_.reset(new TagReaderHandler);
+    journal_path_ = QStandardPaths::writableLocation(QStandardPaths::AppLocalDataLocation) + QLatin1Char('/') + QLatin1String(kJournalDirectory);
+    LoadBlacklist();
+  }
+#endif
+
+}
+
+TagReaderClient::~TagReaderClient() {
+
+#ifdef USE_INPROCESS_TAGREADER
+  if (thread_pool_) thread_pool_->waitForDone();
+#endif
+
 }
 
 void TagReaderClient::Start() { worker_pool_->Start(); }
 
+int TagReaderClient::worker_count() const {
+
+#ifdef USE_INPROCESS_TAGREADER
+  if (inprocess_) return thread_pool_->maxThreadCount();
+#endif
+
+  return worker_pool_->worker_count();
+
+}
+
 void TagReaderClient::ExitAsync() {
   QMetaObject::invokeMethod(this, &TagReaderClient::Exit, Qt::QueuedConnection);
 }
@@ -61,6 +149,9 @@ void TagReaderClient::ExitAsync() {
 void TagReaderClient::Exit() {
 
   Q_ASSERT(QThread::currentThread() == thread());
+
+  save_timer_->stop();
+  SavePendingFiles();
   moveToThread(original_thread_);
   emit ExitFinished();
 
@@ -70,7 +161,7 @@ void TagReaderClient::WorkerFailedToStart() {
   qLog(Error) << "The" << kWorkerExecutableName << "executable was not found in the current directory or on the PATH.  Strawberry will not be able to read music file tags without it.";
 }
 
-TagReaderReply *TagReaderClient::IsMediaFile(const QString &filename) {
+TagReaderReply *TagReaderClient::IsMediaFile(const QString &filename, const Priority priority) {
 
   spb::tagreader::Message message;
   spb::tagreader::IsMediaFileRequest *request = message.mutable_is_media_file_request();
@@ -78,26 +169,193 @@ TagReaderReply *TagReaderClient::IsMediaFile(const QString &filename) {
   const QByteArray filename_data = filename.toUtf8();
   request->set_filename(filename_data.constData(), filename_data.length());
 
-  return worker_pool_->SendMessageWithReply(&message);
+  return SendReadMessage(&message, QStringList() << filename, priority);
 
 }
 
-TagReaderReply *TagReaderClient::ReadFile(const QString &filename) {
+TagReaderReply *TagReaderClient::ReadFile(const QString &filename, const ReadLevel read_level, const Priority priority) {
 
   spb::tagreader::Message message;
   spb::tagreader::ReadFileRequest *request = message.mutable_read_file_request();
 
   const QByteArray filename_data = filename.toUtf8();
   request->set_filename(filename_data.constData(), filename_data.length());
+  request->set_read_level(read_level == ReadLevel::Fast ? spb::tagreader::ReadFileRequest::FAST : spb::tagreader::ReadFileRequest::FULL);
 
-  return worker_pool_->SendMessageWithReply(&message);
+  return SendReadMessage(&message, QStringList() << filename, priority);
 
 }
 
-TagReaderReply *TagReaderClient::SaveFile(const QString &filename, const Song &metadata, const SaveTypes save_types, const SaveCoverOptions &save_cover_options) {
+TagReaderReply *TagReaderClient::ReadFiles(const QStringList &filenames, const ReadLevel read_level, const Priority priority) {
 
   spb::tagreader::Message message;
-  spb::tagreader::SaveFileRequest *request = message.mutable_save_file_request();
+  spb::tagreader::ReadFilesRequest *request = message.mutable_read_files_request();
+  request->set_read_level(read_level == ReadLevel::Fast ? spb::tagreader::ReadFileRequest::FAST : spb::tagreader::ReadFileRequest::FULL);
+
+  for (const QString &filename : filenames) {
+    const QByteArray filename_data = filename.toUtf8();
+    request->add_filenames(filename_data.constData(), filename_data.length());
+  }
+
+  return SendReadMessage(&message, filenames, priority);
+
+}
+
+TagReaderReply *TagReaderClient::ReadDirectory(const QString &directory, const Priority priority) {
+
+  spb::tagreader::Message message;
+  const QByteArray directory_data = directory.toUtf8();
+  message.mutable_read_directory_request()->set_directory(directory_data.constData(), directory_data.length());
+
+  return SendReadMessage(&message, QStringList() << directory, priority);
+
+}
+
+TagReaderReply *TagReaderClient::SendReadMessage(spb::tagreader::Message *message, const QStringList &filenames, const Priority priority) {
+
+#ifdef USE_INPROCESS_TAGREADER
+  if (inprocess_ && !IsBlacklisted(filenames)) {
+    ReplyType *reply = new ReplyType(*message);
+    // QThreadPool runs higher numbers first.
+    const int pool_priority = priority == Priority::Interactive ? 2 : priority == Priority::Playback ? 1 : 0;
+    thread_pool_->start(new FunctionRunnable([this, reply]() { HandleMessageInProcess(reply); }), pool_priority);
+    return reply;
+  }
+#else
+  Q_UNUSED(filenames)
+#endif
+
+  return worker_pool_->SendMessageWithReply(message, priority);
+
+}
+
+#ifdef USE_INPROCESS_TAGREADER
+
+void TagReaderClient::HandleMessageInProcess(ReplyType *reply) {
+
+  if (reply->is_cancelled()) {
+    QMetaObject::invokeMethod(this, [reply]() { reply->Abort(); }, Qt::QueuedConnection);
+    return;
+  }
+
+  QStringList filenames;
+  const spb::tagreader::Message &request = reply->request_message();
+  if (request.has_read_files_request()) {
+    for (const std::string &filename : request.read_files_request().filenames()) {
+      filenames << QString::fromStdString(filename);
+    }
+  }
+  else if (request.has_read_file_request()) {
+    filenames << QString::fromStdString(request.read_file_request().filename());
+  }
+  else if (request.has_is_media_file_request()) {
+    filenames << QString::fromStdString(request.is_media_file_request().filename());
+  }
+  else if (request.has_load_embedded_art_request()) {
+    filenames << QString::fromStdString(request.load_embedded_art_request().filename());
+  }
+  else if (request.has_read_directory_request()) {
+    filenames << QString::fromStdString(request.read_directory_request().directory());
+  }
+
+  // If the files crash Strawberry, the journal is still there on the next start.
+  const QString journal_filename = WriteJournal(filenames);
+
+  spb::tagreader::Message reply_message;
+  handler_->HandleMessage(request, &reply_message);
+  reply_message.set_id(request.id());
+
+  if (!journal_filename.isEmpty()) {
+    QFile::remove(journal_filename);
+  }
+
+  // Finish the reply on our own thread, the same as replies from the workers.
+  QMetaObject::invokeMethod(this, [reply, reply_message]() { reply->SetReply(reply_message); }, Qt::QueuedConnection);
+
+}
+
+QString TagReaderClient::WriteJournal(const QStringList &filenames) const {
+
+  if (!QDir().mkpath(journal_path_)) return QString();
+
+  QTemporaryFile file(journal_path_ + QStringLiteral("/XXXXXX"));
+  file.setAutoRemove(false);
+  if (!file.open()) {
+    qLog(Error) << "Failed to create tagreader journal" << file.errorString();
+    return QString();
+  }
+  file.write(filenames.join(QLatin1Char('\n')).toUtf8());
+  file.close();
+
+  return file.fileName();
+
+}
+
+void TagReaderClient::LoadBlacklist() {
+
+  const QString blacklist_filename = QStandardPaths::writableLocation(QStandardPaths::AppLocalDataLocation) + QLatin1Char('/') + QLatin1String(kBlacklistFile);
+
+  QFile blacklist_file(blacklist_filename);
+  if (blacklist_file.open(QIODevice::ReadOnly)) {
+    const QStringList filenames = QString::fromUtf8(blacklist_file.readAll()).split(QLatin1Char('\n'));
+    for (const QString &filename : filenames) {
+      if (!filename.isEmpty()) blacklist_ << filename;
+    }
+    blacklist_file.close();
+  }
+
+  // Journals left behind are from reads that never finished.
+  QDir journal_dir(journal_path_);
+  const QStringList journal_filenames = journal_dir.entryList(QDir::Files);
+  if (journal_filenames.isEmpty()) return;
+
+  QStringList new_filenames;
+  for (const QString &journal_filename : journal_filenames) {
+    QFile journal_file(journal_dir.filePath(journal_filename));
+    if (journal_file.open(QIODevice::ReadOnly)) {
+      const QStringList filenames = QString::fromUtf8(journal_file.readAll()).split(QLatin1Char('\n'));
+      for (const QString &filename : filenames) {
+        if (!filename.isEmpty() && !blacklist_.contains(filename)) {
+          blacklist_ << filename;
+          new_filenames << filename;
+        }
+      }
+      journal_file.close();
+    }
+    journal_file.remove();
+  }
+
+  if (new_filenames.isEmpty()) return;
+
+  qLog(Info) << "Reading" << new_filenames << "in the tagreader process from now on";
+
+  if (blacklist_file.open(QIODevice::WriteOnly | QIODevice::Append)) {
+    for (const QString &filename : std::as_const(new_filenames)) {
+      blacklist_file.write(filename.toUtf8() + '\n');
+    }
+    blacklist_file.close();
+  }
+  else {
+    qLog(Error) << "Failed to write tagreader blacklist" << blacklist_filename << blacklist_file.errorString();
+  }
+
+}
+
+bool TagReaderClient::IsBlacklisted(const QStringList &filenames) const {
+
+  if (blacklist_.isEmpty()) return false;
+
+  for (const QString &filename : filenames) {
+    if (blacklist_.contains(filename)) return true;
+  }
+
+  return false;
+
+}
+
+#endif  // USE_INPROCESS_TAGREADER
+
+void TagReaderClient::CreateSaveFileRequest(spb::tagreader::SaveFileRequest *request, const QString &filename, const Song &metadata, const SaveTypes save_types, const SaveCoverOptions &save_cover_options) {
 
   const QByteArray filename_data = filename.toUtf8();
   request->set_filename(filename_data.constData(), filename_data.length());
@@ -120,13 +378,32 @@ TagReaderReply *TagReaderClient::SaveFile(const QString &filename, const Song &m
   }
   metadata.ToProtobuf(request->mutable_metadata());
 
+}
+
+TagReaderReply *TagReaderClient::SaveFile(const QString &filename, const Song &metadata, const SaveTypes save_types, const SaveCoverOptions &save_cover_options) {
+
+  spb::tagreader::Message message;
+  CreateSaveFileRequest(message.mutable_save_file_request(), filename, metadata, save_types, save_cover_options);
+
   ReplyType *reply = worker_pool_->SendMessageWithReply(&message);
 
   return reply;
 
 }
 
-TagReaderReply *TagReaderClient::LoadEmbeddedArt(const QString &filename) {
+TagReaderReply *TagReaderClient::SaveFiles(const SongList &songs, const SaveTypes save_types, const Priority priority) {
+
+  spb::tagreader::Message message;
+  spb::tagreader::SaveFilesRequest *request = message.mutable_save_files_request();
+  for (const Song &song : songs) {
+    CreateSaveFileRequest(request->add_requests(), song.url().toLocalFile(), song, save_types, SaveCoverOptions());
+  }
+
+  return worker_pool_->SendMessageWithReply(&message, priority);
+
+}
+
+TagReaderReply *TagReaderClient::LoadEmbeddedArt(const QString &filename, const Priority priority) {
 
   spb::tagreader::Message message;
   spb::tagreader::LoadEmbeddedArtRequest *request = message.mutable_load_embedded_art_request();
@@ -134,7 +411,7 @@ TagReaderReply *TagReaderClient::LoadEmbeddedArt(const QString &filename) {
   const QByteArray filename_data = filename.toUtf8();
   request->set_filename(filename_data.constData(), filename_data.length());
 
-  return worker_pool_->SendMessageWithReply(&message);
+  return SendReadMessage(&message, QStringList() << filename, priority);
 
 }
 
@@ -170,16 +447,13 @@ TagReaderReply *TagReaderClient::UpdateSongPlaycount(const Song &metadata) {
   request->set_filename(filename_data.constData(), filename_data.length());
   metadata.ToProtobuf(request->mutable_metadata());
 
-  return worker_pool_->SendMessageWithReply(&message);
+  return worker_pool_->SendMessageWithReply(&message, Priority::Background);
 
 }
 
 void TagReaderClient::UpdateSongsPlaycount(const SongList &songs) {
 
-  for (const Song &song : songs) {
-    TagReaderReply *reply = UpdateSongPlaycount(song);
-    QObject::connect(reply, &TagReaderReply::Finished, reply, &TagReaderReply::deleteLater);
-  }
+  QMetaObject::invokeMethod(this, [this, songs]() { QueueSave(songs, SaveType::PlayCount); }, Qt::QueuedConnection);
 
 }
 
@@ -192,26 +466,98 @@ TagReaderReply *TagReaderClient::UpdateSongRating(const Song &metadata) {
   request->set_filename(filename_data.constData(), filename_data.length());
   metadata.ToProtobuf(request->mutable_metadata());
 
-  return worker_pool_->SendMessageWithReply(&message);
+  return worker_pool_->SendMessageWithReply(&message, Priority::Background);
 
 }
 
 void TagReaderClient::UpdateSongsRating(const SongList &songs) {
 
+  QMetaObject::invokeMethod(this, [this, songs]() { QueueSave(songs, SaveType::Rating); }, Qt::QueuedConnection);
+
+}
+
+void TagReaderClient::QueueSave(const SongList &songs, const SaveType save_type) {
+
+  Q_ASSERT(QThread::currentThread() == thread());
+
   for (const Song &song : songs) {
-    TagReaderReply *reply = UpdateSongRating(song);
-    QObject::connect(reply, &TagReaderReply::Finished, reply, &TagReaderReply::deleteLater);
+    if (!song.url().isLocalFile()) continue;
+    const QString filename = song.url().toLocalFile();
+    if (pending_saves_.contains(filename)) {
+      // The latest song has the latest statistics, so only the save types need to be merged.
+      PendingSave &pending_save = pending_saves_[filename];
+      pending_save.song = song;
+      pending_save.save_types |= save_type;
+    }
+    else {
+      pending_saves_.insert(filename, PendingSave{ song, save_type });
+    }
+  }
+
+  // Don't restart the timer, so a steady stream of changes is still written regularly.
+  if (!pending_saves_.isEmpty() && !save_timer_->isActive()) {
+    save_timer_->start();
+  }
+
+}
+
+void TagReaderClient::SavePendingFiles() {
+
+  Q_ASSERT(QThread::currentThread() == thread());
+
+  if (pending_saves_.isEmpty()) return;
+
+  // Group the songs by what needs to be written, and send them in batches.
+  QHash<int, SongList> songs_by_save_types;
+  for (QHash<QString, PendingSave>::const_iterator it = pending_saves_.constBegin(); it != pending_saves_.constEnd(); ++it) {
+    songs_by_save_types[static_cast<int>(it.value().save_types)] << it.value().song;
+  }
+  pending_saves_.clear();
+
+  for (QHash<int, SongList>::const_iterator it = songs_by_save_types.constBegin(); it != songs_by_save_types.constEnd(); ++it) {
+    const SaveTypes save_types(QFlag(it.key()));
+    const SongList &songs = it.value();
+    for (qint64 i = 0; i < songs.count(); i += kSaveFilesBatchSize) {
+      TagReaderReply *reply = SaveFiles(songs.mid(i, kSaveFilesBatchSize), save_types);
+      QObject::connect(reply, &TagReaderReply::Finished, reply, &TagReaderReply::deleteLater);
+    }
+  }
+
+}
+
+bool TagReaderClient::SaveFilesBlocking(const SongList &songs, const SaveTypes save_types) {
+
+  Q_ASSERT(QThread::currentThread() != thread());
+
+  QList<TagReaderReply*> replies;
+  for (qint64 i = 0; i < songs.count(); i += kSaveFilesBatchSize) {
+    replies << SaveFiles(songs.mid(i, kSaveFilesBatchSize), save_types);
+  }
+
+  bool success = true;
+  for (TagReaderReply *reply : std::as_const(replies)) {
+    if (reply->WaitForFinished()) {
+      for (const bool file_success : reply->message().save_files_response().success()) {
+        if (!file_success) success = false;
+      }
+    }
+    else {
+      success = false;
+    }
+    reply->deleteLater();
   }
 
+  return success;
+
 }
 
-bool TagReaderClient::IsMediaFileBlocking(const QString &filename) {
+bool TagReaderClient::IsMediaFileBlocking(const QString &filename, const Priority priority) {
 
   Q_ASSERT(QThread::currentThread() != thread());
 
   bool ret = false;
 
-  TagReaderReply *reply = IsMediaFile(filename);
+  TagReaderReply *reply = IsMediaFile(filename, priority);
   if (reply->WaitForFinished()) {
     ret = reply->message().is_media_file_response().success();
   }
@@ -221,11 +567,11 @@ bool TagReaderClient::IsMediaFileBlocking(const QString &filename) {
 
 }
 
-void TagReaderClient::ReadFileBlocking(const QString &filename, Song *song) {
+void TagReaderClient::ReadFileBlocking(const QString &filename, Song *song, const ReadLevel read_level, const Priority priority) {
 
   Q_ASSERT(QThread::currentThread() != thread());
 
-  TagReaderReply *reply = ReadFile(filename);
+  TagReaderReply *reply = ReadFile(filename, read_level, priority);
   if (reply->WaitForFinished()) {
     song->InitFromProtobuf(reply->message().read_file_response().metadata());
   }
@@ -233,6 +579,42 @@ void TagReaderClient::ReadFileBlocking(const QString &filename, Song *song) {
 
 }
 
+SongList TagReaderClient::ReadFilesBlocking(const QStringList &filenames) {
+
+  Q_ASSERT(QThread::currentThread() != thread());
+
+  // Send all batches at once so they are processed in parallel, then collect the replies as they come in.
+  QList<TagReaderReply*> replies;
+  for (qint64 i = 0; i < filenames.count(); i += kReadFilesBatchSize) {
+    replies << ReadFiles(filenames.mid(i, kReadFilesBatchSize));
+  }
+
+  SongList songs;
+  songs.reserve(filenames.count());
+  for (qint64 i = 0; i < replies.count(); ++i) {
+    TagReaderReply *reply = replies[i];
+    const qint64 batch_size = qMin(static_cast<qint64>(kReadFilesBatchSize), filenames.count() - i * kReadFilesBatchSize);
+    int metadata_count = 0;
+    if (reply->WaitForFinished()) {
+      const spb::tagreader::ReadFilesResponse &response = reply->message().read_files_response();
+      metadata_count = response.metadata_size();
+      for (const spb::tagreader::SongMetadata &metadata : response.metadata()) {
+        Song song;
+        song.InitFromProtobuf(metadata);
+        songs << song;
+      }
+    }
+    // Keep the songs aligned with the filenames if a batch failed.
+    for (qint64 j = metadata_count; j < batch_size; ++j) {
+      songs << Song();
+    }
+    reply->deleteLater();
+  }
+
+  return songs;
+
+}
+
 bool TagReaderClient::SaveFileBlocking(const QString &filename, const Song &metadata, const SaveTypes save_types, const SaveCoverOptions &save_cover_options) {
 
   Q_ASSERT(QThread::currentThread() != thread());
@@ -249,16 +631,25 @@ bool TagReaderClient::SaveFileBlocking(const QString &filename, const Song &meta
 
 }
 
-QByteArray TagReaderClient::LoadEmbeddedArtBlocking(const QString &filename) {
+QByteArray TagReaderClient::LoadEmbeddedArtBlocking(const QString &filename, const Priority priority) {
 
   Q_ASSERT(QThread::currentThread() != thread());
 
   QByteArray ret;
 
-  TagReaderReply *reply = LoadEmbeddedArt(filename);
+  TagReaderReply *reply = LoadEmbeddedArt(filename, priority);
   if (reply->WaitForFinished()) {
-    const std::string &data_str = reply->message().load_embedded_art_response().data();
-    ret = QByteArray(data_str.data(), static_cast<qint64>(data_str.size()));
+    const spb::tagreader::LoadEmbeddedArtResponse &response = reply->message().load_embedded_art_response();
+    if (response.has_data_filename()) {
+      SharedPayload payload(QString::fromStdString(response.data_filename()));
+      if (payload.is_valid()) {
+        ret = QByteArray(reinterpret_cast<const char*>(payload.data()), payload.size());
+      }
+    }
+    else {
+      const std::string &data_str = response.data();
+      ret = QByteArray(data_str.data(), static_cast<qint64>(data_str.size()));
+    }
   }
   reply->deleteLater();
 
@@ -266,16 +657,26 @@ QByteArray TagReaderClient::LoadEmbeddedArtBlocking(const QString &filename) {
 
 }
 
-QImage TagReaderClient::LoadEmbeddedArtAsImageBlocking(const QString &filename) {
+QImage TagReaderClient::LoadEmbeddedArtAsImageBlocking(const QString &filename, const Priority priority) {
 
   Q_ASSERT(QThread::currentThread() != thread());
 
   QImage ret;
 
-  TagReaderReply *reply = LoadEmbeddedArt(filename);
+  TagReaderReply *reply = LoadEmbeddedArt(filename, priority);
   if (reply->WaitForFinished()) {
-    const std::string &data_str = reply->message().load_embedded_art_response().data();
-    ret.loadFromData(QByteArray(data_str.data(), static_cast<qint64>(data_str.size())));
+    const spb::tagreader::LoadEmbeddedArtResponse &response = reply->message().load_embedded_art_response();
+    if (response.has_data_filename()) {
+      // Decode straight from the mapped file, without copying it first.
+      SharedPayload payload(QString::fromStdString(response.data_filename()));
+      if (payload.is_valid()) {
+        ret.loadFromData(payload.data(), static_cast<int>(payload.size()));
+      }
+    }
+    else {
+      const std::string &data_str = response.data();
+      ret.loadFromData(QByteArray(data_str.data(), static_cast<qint64>(data_str.size())));
+    }
   }
   reply->deleteLater();
 
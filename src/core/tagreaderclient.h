@@ -26,17 +26,24 @@
 
 #include <QObject>
 #include <QList>
+#include <QHash>
+#include <QSet>
 #include <QString>
+#include <QStringList>
 #include <QImage>
 
 #include "core/messagehandler.h"
 #include "core/workerpool.h"
+#include "core/scoped_ptr.h"
 
 #include "song.h"
 #include "tagreadermessages.pb.h"
 
 class QThread;
+class QThreadPool;
+class QTimer;
 class Song;
+class TagReaderHandler;
 template<typename HandlerType> class WorkerPool;
 
 class TagReaderClient : public QObject {
@@ -44,13 +51,17 @@ class TagReaderClient : public QObject {
 
  public:
   explicit TagReaderClient(QObject *parent = nullptr);
+  ~TagReaderClient() override;
 
   using HandlerType = AbstractMessageHandler<spb::tagreader::Message>;
   using ReplyType = HandlerType::ReplyType;
+  using Priority = _WorkerPoolBase::Priority;
 
   void Start();
   void ExitAsync();
 
+  int worker_count() const;
+
   enum class SaveType {
     NoType = 0,
     Tags = 1,
@@ -60,6 +71,12 @@ class TagReaderClient : public QObject {
   };
   Q_DECLARE_FLAGS(SaveTypes, SaveType)
 
+  // Fast skips embedded art detection and takes the audio properties from the file headers.
+  enum class ReadLevel {
+    Full,
+    Fast
+  };
+
   class SaveCoverOptions {
    public:
     explicit SaveCoverOptions(const QString &_cover_filename = QString(), const QByteArray &_cover_data = QByteArray(), const QString &_mime_type = QString()) : cover_filename(_cover_filename), cover_data(_cover_data), mime_type(_mime_type) {}
@@ -70,21 +87,31 @@ class TagReaderClient : public QObject {
     QString mime_type;
   };
 
-  ReplyType *IsMediaFile(const QString &filename);
-  ReplyType *ReadFile(const QString &filename);
+  // Requests are sent in order of priority, call Cancel() on the reply to drop a request that hasn't been sent yet.
+  ReplyType *IsMediaFile(const QString &filename, const Priority priority = Priority::Interactive);
+  ReplyType *ReadFile(const QString &filename, const ReadLevel read_level = ReadLevel::Full, const Priority priority = Priority::Interactive);
+  ReplyType *ReadFiles(const QStringList &filenames, const ReadLevel read_level = ReadLevel::Full, const Priority priority = Priority::Background);
+  // Reads all chiptune files in the directory in one request, the reply has the metadata of each file that could be read.
+  ReplyType *ReadDirectory(const QString &directory, const Priority priority = Priority::Background);
   ReplyType *SaveFile(const QString &filename, const Song &metadata, const SaveTypes types = SaveType::Tags, const SaveCoverOptions &save_cover_options = SaveCoverOptions());
-  ReplyType *LoadEmbeddedArt(const QString &filename);
+  // Saves all songs to their files in a single request.
+  ReplyType *SaveFiles(const SongList &songs, const SaveTypes types, const Priority priority = Priority::Background);
+  ReplyType *LoadEmbeddedArt(const QString &filename, const Priority priority = Priority::Interactive);
   ReplyType *SaveEmbeddedArt(const QString &filename, const SaveCoverOptions &save_cover_options);
   ReplyType *UpdateSongPlaycount(const Song &metadata);
   ReplyType *UpdateSongRating(const Song &metadata);
 
   // Convenience functions that call the above functions and wait for a response.
   // These block the calling thread with a semaphore, and must NOT be called from the TagReaderClient's thread.
-  void ReadFileBlocking(const QString &filename, Song *song);
+  void ReadFileBlocking(const QString &filename, Song *song, const ReadLevel read_level = ReadLevel::Full, const Priority priority = Priority::Interactive);
+  // Reads the files in batches spread over the workers, the songs are returned in the same order as the filenames.
+  SongList ReadFilesBlocking(const QStringList &filenames);
   bool SaveFileBlocking(const QString &filename, const Song &metadata,  const SaveTypes types = SaveType::Tags, const SaveCoverOptions &save_cover_options = SaveCoverOptions());
-  bool IsMediaFileBlocking(const QString &filename);
-  QByteArray LoadEmbeddedArtBlocking(const QString &filename);
-  QImage LoadEmbeddedArtAsImageBlocking(const QString &filename);
+  // Saves the songs in batches spread over the workers, returns true if all files were saved.
+  bool SaveFilesBlocking(const SongList &songs, const SaveTypes types);
+  bool IsMediaFileBlocking(const QString &filename, const Priority priority = Priority::Interactive);
+  QByteArray LoadEmbeddedArtBlocking(const QString &filename, const Priority priority = Priority::Interactive);
+  QImage LoadEmbeddedArtAsImageBlocking(const QString &filename, const Priority priority = Priority::Interactive);
   bool SaveEmbeddedArtBlocking(const QString &filename, const SaveCoverOptions &save_cover_options);
   bool UpdateSongPlaycountBlocking(const Song &metadata);
   bool UpdateSongRatingBlocking(const Song &metadata);
@@ -98,17 +125,52 @@ class TagReaderClient : public QObject {
  private slots:
   void Exit();
   void WorkerFailedToStart();
+  void SavePendingFiles();
 
  public slots:
+  // The changes are collected for a few seconds, so repeated changes to the same song only rewrite the file once.
   void UpdateSongsPlaycount(const SongList &songs);
   void UpdateSongsRating(const SongList &songs);
 
+ private:
+  // Reads in the main process if enabled and none of the files are blacklisted, otherwise sends the request to a worker.
+  ReplyType *SendReadMessage(spb::tagreader::Message *message, const QStringList &filenames, const Priority priority);
+
+  static void CreateSaveFileRequest(spb::tagreader::SaveFileRequest *request, const QString &filename, const Song &metadata, const SaveTypes save_types, const SaveCoverOptions &save_cover_options);
+
+  // Must be called from my thread.
+  void QueueSave(const SongList &songs, const SaveType save_type);
+
+#ifdef USE_INPROCESS_TAGREADER
+  // Files that were being read when Strawberry crashed are blacklisted, and read by the worker processes from then on.
+  void LoadBlacklist();
+  bool IsBlacklisted(const QStringList &filenames) const;
+  QString WriteJournal(const QStringList &filenames) const;
+  void HandleMessageInProcess(ReplyType *reply);
+#endif
+
  private:
   static TagReaderClient *sInstance;
 
   WorkerPool<HandlerType> *worker_pool_;
   QList<spb::tagreader::Message> message_queue_;
   QThread *original_thread_;
+
+  struct PendingSave {
+    Song song;
+    SaveTypes save_types;
+  };
+  QHash<QString, PendingSave> pending_saves_;
+  QTimer *save_timer_;
+
+#ifdef USE_INPROCESS_TAGREADER
+  bool inprocess_;
+  QThreadPool *thread_pool_;
+  ScopedPtr<TagReaderHandler> handler_;
+  QString journal_path_;
+  // Only written in the constructor, so it can be read from any thread.
+  QSet<QString> blacklist_;
+#endif
 };
 
 using TagReaderReply = TagReaderClient::ReplyType;
@@ -22,15 +22,123 @@
 #include "config.h"
 
 #include <algorithm>
+#include <utility>
 
 #include <QObject>
+#include <QThread>
+#include <QThreadPool>
+#include <QRunnable>
+#include <QTimer>
 #include <QMutex>
+#include <QDeadlineTimer>
 #include <QList>
 #include <QString>
 
 #include "taskmanager.h"
 
-TaskManager::TaskManager(QObject *parent) : QObject(parent), next_task_id_(1) {}
+const int TaskManager::kIOThreads = 4;
+
+TaskManager::TaskManager(QObject *parent)
+    : QObject(parent),
+      next_task_id_(1),
+      cpu_thread_pool_(new QThreadPool(this)),
+      io_thread_pool_(new QThreadPool(this)),
+      timer_pause_(new QTimer(this)) {
+
+  cpu_thread_pool_->setObjectName(QStringLiteral("TaskManagerCPU"));
+  cpu_thread_pool_->setMaxThreadCount(qMax(1, QThread::idealThreadCount()));
+  io_thread_pool_->setObjectName(QStringLiteral("TaskManagerIO"));
+  io_thread_pool_->setMaxThreadCount(kIOThreads);
+
+  timer_pause_->setSingleShot(true);
+  QObject::connect(timer_pause_, &QTimer::timeout, this, &TaskManager::PauseTimeout);
+
+}
+
+TaskManager::~TaskManager() {
+
+  // The jobs use the pause mutex, so they must be done before it's destroyed.
+  // Jobs that are held back are started so their futures finish.
+  ResumeBackgroundJobs();
+  cpu_thread_pool_->waitForDone();
+  io_thread_pool_->waitForDone();
+
+}
+
+QThreadPool *TaskManager::thread_pool(const Pool pool) const {
+
+  switch (pool) {
+    case Pool::CPU:
+      return cpu_thread_pool_;
+    case Pool::IO:
+      return io_thread_pool_;
+  }
+
+  return cpu_thread_pool_;
+
+}
+
+void TaskManager::PauseBackgroundJobs(const int msec) {
+
+  {
+    QMutexLocker l(&pause_mutex_);
+    const QDeadlineTimer deadline(msec);
+    if (!pause_deadline_.hasExpired() && deadline <= pause_deadline_) return;
+    pause_deadline_ = deadline;
+  }
+
+  QMetaObject::invokeMethod(this, [this, msec]() { timer_pause_->start(msec); });
+
+}
+
+void TaskManager::ResumeBackgroundJobs() {
+
+  QList<PendingJob> pending_jobs;
+  {
+    QMutexLocker l(&pause_mutex_);
+    pause_deadline_ = QDeadlineTimer();
+    pending_jobs = pending_jobs_;
+    pending_jobs_.clear();
+  }
+
+  for (const PendingJob &pending_job : std::as_const(pending_jobs)) {
+    pending_job.thread_pool->start(pending_job.job, static_cast<int>(pending_job.priority));
+  }
+
+}
+
+void TaskManager::PauseTimeout() {
+
+  qint64 remaining_msec = 0;
+  {
+    QMutexLocker l(&pause_mutex_);
+    if (!pause_deadline_.hasExpired()) {
+      remaining_msec = pause_deadline_.remainingTime();
+    }
+  }
+
+  // The pause was extended after the timer was started.
+  if (remaining_msec > 0) {
+    timer_pause_->start(static_cast<int>(remaining_msec));
+    return;
+  }
+
+  ResumeBackgroundJobs();
+
+}
+
+bool TaskManager::DeferIfPaused(QRunnable *job, QThreadPool *thread_pool, const Priority priority) {
+
+  if (priority == Priority::High) return false;
+
+  QMutexLocker l(&pause_mutex_);
+  if (pause_deadline_.hasExpired()) return false;
+
+  pending_jobs_ << PendingJob(job, thread_pool, priority);
+
+  return true;
+
+}
 
 int TaskManager::StartTask(const QString &name) {
 
@@ -108,6 +216,19 @@ void TaskManager::IncreaseTaskProgress(const int id, const quint64 progress, con
 
 }
 
+void TaskManager::SetTaskDetails(const int id, const QString &details) {
+
+  {
+    QMutexLocker l(&mutex_);
+    if (!tasks_.contains(id)) return;
+
+    tasks_[id].details = details;
+  }
+
+  emit TasksChanged();
+
+}
+
 void TaskManager::SetTaskFinished(const int id) {
 
   bool resume_collection_watchers = false;
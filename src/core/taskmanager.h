@@ -24,18 +24,43 @@
 
 #include "config.h"
 
+#include <type_traits>
+
 #include <QtGlobal>
 #include <QObject>
 #include <QMutex>
+#include <QDeadlineTimer>
+#include <QFuture>
+#include <QFutureInterface>
+#include <QRunnable>
 #include <QList>
 #include <QMap>
 #include <QString>
 
+class QThreadPool;
+class QTimer;
+
 class TaskManager : public QObject {
   Q_OBJECT
 
  public:
   explicit TaskManager(QObject *parent = nullptr);
+  ~TaskManager() override;
+
+  // CPU bound jobs such as decoding and analysis run in one pool, jobs that mostly wait for the disk or database in the other.
+  // This way slow disks don't keep the cores idle, and analysis doesn't hold up playlist and collection loading.
+  enum class Pool {
+    CPU,
+    IO
+  };
+
+  // Jobs with a higher priority are started first.
+  // Low and normal priority jobs are not started while background jobs are paused.
+  enum class Priority {
+    Low = 0,
+    Normal = 1,
+    High = 2
+  };
 
   struct Task {
     Task() : id(0), progress(0), progress_max(0), blocks_collection_scans(false) {}
@@ -44,6 +69,7 @@ class TaskManager : public QObject {
     quint64 progress;
     quint64 progress_max;
     bool blocks_collection_scans;
+    QString details;
   };
 
   class ScopedTask {
@@ -66,9 +92,24 @@ class TaskManager : public QObject {
   void SetTaskBlocksCollectionScans(const int id);
   void SetTaskProgress(const int id, const quint64 progress, const quint64 max = 0);
   void IncreaseTaskProgress(const int id, const quint64 progress, const quint64 max = 0);
+  // Sets additional information about the task, such as statistics, shown as tooltip of the task progress.
+  void SetTaskDetails(const int id, const QString &details);
   void SetTaskFinished(const int id);
   quint64 GetTaskProgress(const int id);
 
+  // Runs the function in a thread pool and returns a future for its result.
+  // Canceling the future before the job is started skips the job, the future then has no result.
+  template<typename F>
+  QFuture<std::invoke_result_t<F>> Run(const Pool pool, const Priority priority, F function);
+
+  QThreadPool *thread_pool(const Pool pool) const;
+
+  // Holds back low and normal priority jobs that haven't started yet, for at most msec.
+  // This is used while a track is starting, so background work doesn't compete with the playback pipeline.
+  // The held back jobs are kept aside and submitted to their pool again when resumed, they don't occupy the pool threads.
+  void PauseBackgroundJobs(const int msec);
+  void ResumeBackgroundJobs();
+
  signals:
   void TasksChanged();
 
@@ -76,11 +117,89 @@ class TaskManager : public QObject {
   void ResumeCollectionWatchers();
 
  private:
+  template<typename T, typename F>
+  class Job : public QRunnable {
+   public:
+    explicit Job(TaskManager *task_manager, QThreadPool *thread_pool, const Priority priority, F function) : task_manager_(task_manager), thread_pool_(thread_pool), priority_(priority), function_(function) {
+      // The job deletes itself when done, since it can be taken out of the pool while background jobs are paused.
+      setAutoDelete(false);
+      future_interface_.reportStarted();
+    }
+
+    QFuture<T> future() { return future_interface_.future(); }
+
+    void Start() {
+      if (!task_manager_->DeferIfPaused(this, thread_pool_, priority_)) {
+        thread_pool_->start(this, static_cast<int>(priority_));
+      }
+    }
+
+    void run() override {
+      if (!future_interface_.isCanceled() && task_manager_->DeferIfPaused(this, thread_pool_, priority_)) {
+        return;
+      }
+      if (!future_interface_.isCanceled()) {
+        if constexpr (std::is_void_v<T>) {
+          function_();
+        }
+        else {
+          future_interface_.reportResult(function_());
+        }
+      }
+      future_interface_.reportFinished();
+      delete this;
+    }
+
+   private:
+    TaskManager *task_manager_;
+    QThreadPool *thread_pool_;
+    const Priority priority_;
+    F function_;
+    QFutureInterface<T> future_interface_;
+  };
+
+  struct PendingJob {
+    PendingJob(QRunnable *_job = nullptr, QThreadPool *_thread_pool = nullptr, const Priority _priority = Priority::Normal) : job(_job), thread_pool(_thread_pool), priority(_priority) {}
+    QRunnable *job;
+    QThreadPool *thread_pool;
+    Priority priority;
+  };
+
+  // Keeps the job aside and returns true if it's a low or normal priority job while background jobs are paused.
+  bool DeferIfPaused(QRunnable *job, QThreadPool *thread_pool, const Priority priority);
+
+ private slots:
+  void PauseTimeout();
+
+ private:
+  static const int kIOThreads;
+
   QMutex mutex_;
   QMap<int, Task> tasks_;
   int next_task_id_;
 
+  QThreadPool *cpu_thread_pool_;
+  QThreadPool *io_thread_pool_;
+
+  QMutex pause_mutex_;
+  QDeadlineTimer pause_deadline_;
+  QList<PendingJob> pending_jobs_;
+  QTimer *timer_pause_;
+
   Q_DISABLE_COPY(TaskManager)
 };
 
+template<typename F>
+QFuture<std::invoke_result_t<F>> TaskManager::Run(const Pool pool, const Priority priority, F function) {
+
+  using T = std::invoke_result_t<F>;
+
+  Job<T, F> *job = new Job<T, F>(this, thread_pool(pool), priority, function);
+  QFuture<T> future = job->future();
+  job->Start();
+
+  return future;
+
+}
+
 #endif  // TASKMANAGER_H
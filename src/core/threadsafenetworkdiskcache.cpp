@@ -21,12 +21,20 @@
 
 #include "config.h"
 
+#include <atomic>
+
 #include <QtGlobal>
 #include <QObject>
 #include <QCoreApplication>
 #include <QStandardPaths>
+#include <QDir>
 #include <QIODevice>
 #include <QMutex>
+#include <QReadWriteLock>
+#include <QHash>
+#include <QStringList>
+#include <QtConcurrentRun>
+#include <QFuture>
 #include <QNetworkDiskCache>
 #include <QNetworkCacheMetaData>
 #include <QAbstractNetworkCache>
@@ -34,22 +42,98 @@
 
 #include "threadsafenetworkdiskcache.h"
 
+namespace {
+
+constexpr int kShards = 8;
+
+// The same as the default maximum size of QNetworkDiskCache, split between the shards.
+constexpr qint64 kMaxCacheSize = 50 * 1024 * 1024;
+
+// The metadata lookups kept in memory for each shard, they're dropped when there are more.
+constexpr int kMaxMetaDataEntries = 5000;
+
+QString CacheDirectory() {
+#ifdef Q_OS_WIN32
+  return QStandardPaths::writableLocation(QStandardPaths::TempLocation) + QStringLiteral("/strawberry/networkcache");
+#else
+  return QStandardPaths::writableLocation(QStandardPaths::CacheLocation) + QStringLiteral("/networkcache");
+#endif
+}
+
+// QNetworkDiskCache calls expire on every insert, which walks the cache directory once the cache is full.
+// Inserting only adds to the size here, the files are expired by ThreadSafeNetworkDiskCache in the background.
+class NetworkDiskCacheShard : public QNetworkDiskCache {
+ public:
+  NetworkDiskCacheShard() : in_background_(false), size_(-1) {}
+
+  bool needs_expire() const { return size_ < 0 || size_ >= maximumCacheSize(); }
+
+  void Expire() {
+    in_background_ = true;
+    expire();
+    in_background_ = false;
+  }
+
+  void insert(QIODevice *device) override {
+    if (size_ >= 0) size_ += 1024 + device->size();
+    QNetworkDiskCache::insert(device);
+  }
+
+ protected:
+  qint64 expire() override {
+    if (!in_background_ && size_ >= 0) return size_;
+    size_ = QNetworkDiskCache::expire();
+    return size_;
+  }
+
+ private:
+  bool in_background_;
+  qint64 size_;
+};
+
+}  // namespace
+
+struct ThreadSafeNetworkDiskCache::Shard {
+  Shard() : cache(nullptr), expiring(false) {}
+
+  QMutex mutex;
+  NetworkDiskCacheShard *cache;
+  QFuture<void> expire_future;
+  std::atomic<bool> expiring;
+
+  QReadWriteLock metadata_lock;
+  QHash<QUrl, QNetworkCacheMetaData> metadata;
+};
+
 QMutex ThreadSafeNetworkDiskCache::sMutex;
 int ThreadSafeNetworkDiskCache::sInstances = 0;
-QNetworkDiskCache *ThreadSafeNetworkDiskCache::sCache = nullptr;
+ThreadSafeNetworkDiskCache::Shard *ThreadSafeNetworkDiskCache::sShards = nullptr;
+QMutex ThreadSafeNetworkDiskCache::sPreparedMutex;
+QHash<QIODevice*, QUrl> ThreadSafeNetworkDiskCache::sPrepared;
 
 ThreadSafeNetworkDiskCache::ThreadSafeNetworkDiskCache(QObject *parent) : QAbstractNetworkCache(parent) {
 
   QMutexLocker l(&sMutex);
   ++sInstances;
 
-  if (!sCache) {
-    sCache = new QNetworkDiskCache;
-#ifdef Q_OS_WIN32
-    sCache->setCacheDirectory(QStandardPaths::writableLocation(QStandardPaths::TempLocation) + QStringLiteral("/strawberry/networkcache"));
-#else
-    sCache->setCacheDirectory(QStandardPaths::writableLocation(QStandardPaths::CacheLocation) + QStringLiteral("/networkcache"));
-#endif
+  if (!sShards) {
+    const QString directory = CacheDirectory();
+    sShards = new Shard[kShards];
+    for (int i = 0; i < kShards; ++i) {
+      sShards[i].cache = new NetworkDiskCacheShard;
+      sShards[i].cache->setCacheDirectory(directory + QLatin1Char('/') + QString::number(i));
+      sShards[i].cache->setMaximumCacheSize(kMaxCacheSize / kShards);
+      // Reads the size of the cache, so it's not done by the first insert.
+      ExpireInBackground(&sShards[i]);
+    }
+
+    // The cache was in one directory before it was split.
+    (void)QtConcurrent::run([directory]() {
+      const QStringList old_directories = QDir(directory).entryList(QStringList() << QStringLiteral("data*") << QStringLiteral("prepared"), QDir::Dirs | QDir::NoDotAndDotDot);
+      for (const QString &old_directory : old_directories) {
+        QDir(directory + QLatin1Char('/') + old_directory).removeRecursively();
+      }
+    });
   }
 
 }
@@ -59,49 +143,182 @@ ThreadSafeNetworkDiskCache::~ThreadSafeNetworkDiskCache() {
   QMutexLocker l(&sMutex);
   --sInstances;
 
-  if (sCache && sInstances == 0) {
-    sCache->deleteLater();
-    sCache = nullptr;
+  if (sShards && sInstances == 0) {
+    for (int i = 0; i < kShards; ++i) {
+      sShards[i].expire_future.waitForFinished();
+      sShards[i].cache->deleteLater();
+    }
+    delete[] sShards;
+    sShards = nullptr;
   }
 
 }
 
+ThreadSafeNetworkDiskCache::Shard *ThreadSafeNetworkDiskCache::ShardForUrl(const QUrl &url) {
+  return &sShards[qHash(url) % kShards];
+}
+
+void ThreadSafeNetworkDiskCache::CacheMetaData(Shard *shard, const QUrl &url, const QNetworkCacheMetaData &metadata) {
+
+  QWriteLocker l(&shard->metadata_lock);
+  if (shard->metadata.count() >= kMaxMetaDataEntries) shard->metadata.clear();
+  shard->metadata.insert(url, metadata);
+
+}
+
+void ThreadSafeNetworkDiskCache::InvalidateMetaData(Shard *shard, const QUrl &url) {
+
+  QWriteLocker l(&shard->metadata_lock);
+  shard->metadata.remove(url);
+
+}
+
+void ThreadSafeNetworkDiskCache::ExpireInBackground(Shard *shard) {
+
+  if (shard->expiring.exchange(true)) return;
+
+  shard->expire_future = QtConcurrent::run([shard]() {
+    {
+      QMutexLocker l(&shard->mutex);
+      shard->cache->Expire();
+    }
+    {
+      // Expired files might be in the metadata.
+      QWriteLocker l(&shard->metadata_lock);
+      shard->metadata.clear();
+    }
+    shard->expiring = false;
+  });
+
+}
+
 qint64 ThreadSafeNetworkDiskCache::cacheSize() const {
-  QMutexLocker l(&sMutex);
-  return sCache->cacheSize();
+
+  qint64 size = 0;
+  for (int i = 0; i < kShards; ++i) {
+    QMutexLocker l(&sShards[i].mutex);
+    size += sShards[i].cache->cacheSize();
+  }
+  return size;
+
 }
 
 QIODevice *ThreadSafeNetworkDiskCache::data(const QUrl &url) {
-  QMutexLocker l(&sMutex);
-  return sCache->data(url);
+
+  Shard *shard = ShardForUrl(url);
+  QMutexLocker l(&shard->mutex);
+  return shard->cache->data(url);
+
 }
 
 void ThreadSafeNetworkDiskCache::insert(QIODevice *device) {
-  QMutexLocker l(&sMutex);
-  sCache->insert(device);
+
+  QUrl url;
+  {
+    QMutexLocker l(&sPreparedMutex);
+    url = sPrepared.take(device);
+  }
+  if (url.isEmpty()) return;
+
+  Shard *shard = ShardForUrl(url);
+
+  bool needs_expire = false;
+  {
+    QMutexLocker l(&shard->mutex);
+    shard->cache->insert(device);
+    needs_expire = shard->cache->needs_expire();
+  }
+  InvalidateMetaData(shard, url);
+
+  if (needs_expire) ExpireInBackground(shard);
+
 }
 
 QNetworkCacheMetaData ThreadSafeNetworkDiskCache::metaData(const QUrl &url) {
-  QMutexLocker l(&sMutex);
-  return sCache->metaData(url);
+
+  Shard *shard = ShardForUrl(url);
+
+  {
+    QReadLocker l(&shard->metadata_lock);
+    QHash<QUrl, QNetworkCacheMetaData>::const_iterator it = shard->metadata.constFind(url);
+    if (it != shard->metadata.constEnd()) return it.value();
+  }
+
+  QNetworkCacheMetaData metadata;
+  {
+    QMutexLocker l(&shard->mutex);
+    metadata = shard->cache->metaData(url);
+  }
+  CacheMetaData(shard, url, metadata);
+
+  return metadata;
+
 }
 
 QIODevice *ThreadSafeNetworkDiskCache::prepare(const QNetworkCacheMetaData &metaData) {
-  QMutexLocker l(&sMutex);
-  return sCache->prepare(metaData);
+
+  Shard *shard = ShardForUrl(metaData.url());
+
+  QIODevice *device = nullptr;
+  {
+    QMutexLocker l(&shard->mutex);
+    device = shard->cache->prepare(metaData);
+  }
+
+  if (device) {
+    QMutexLocker l(&sPreparedMutex);
+    sPrepared.insert(device, metaData.url());
+  }
+
+  return device;
+
 }
 
 bool ThreadSafeNetworkDiskCache::remove(const QUrl &url) {
-  QMutexLocker l(&sMutex);
-  return sCache->remove(url);
+
+  {
+    // Devices that were prepared but not inserted are removed with the URL.
+    QMutexLocker l(&sPreparedMutex);
+    for (QHash<QIODevice*, QUrl>::iterator it = sPrepared.begin(); it != sPrepared.end();) {
+      if (it.value() == url) it = sPrepared.erase(it);
+      else ++it;
+    }
+  }
+
+  Shard *shard = ShardForUrl(url);
+
+  bool removed = false;
+  {
+    QMutexLocker l(&shard->mutex);
+    removed = shard->cache->remove(url);
+  }
+  InvalidateMetaData(shard, url);
+
+  return removed;
+
 }
 
 void ThreadSafeNetworkDiskCache::updateMetaData(const QNetworkCacheMetaData &metaData) {
-  QMutexLocker l(&sMutex);
-  sCache->updateMetaData(metaData);
+
+  Shard *shard = ShardForUrl(metaData.url());
+
+  {
+    QMutexLocker l(&shard->mutex);
+    shard->cache->updateMetaData(metaData);
+  }
+  InvalidateMetaData(shard, metaData.url());
+
 }
 
 void ThreadSafeNetworkDiskCache::clear() {
-  QMutexLocker l(&sMutex);
-  sCache->clear();
+
+  for (int i = 0; i < kShards; ++i) {
+    {
+      QMutexLocker l(&sShards[i].mutex);
+      sShards[i].cache->clear();
+    }
+    QWriteLocker l(&sShards[i].metadata_lock);
+    sShards[i].metadata.clear();
+  }
+
 }
@@ -28,12 +28,15 @@
 #include <QObject>
 #include <QAbstractNetworkCache>
 #include <QMutex>
+#include <QHash>
 #include <QUrl>
 #include <QNetworkCacheMetaData>
 
 class QIODevice;
-class QNetworkDiskCache;
 
+// The network cache shared by all network access managers.
+// The cache is split by URL into shards with their own disk cache and lock, so requests for different URLs don't wait for each other.
+// Metadata lookups are kept in memory, and the cache directories are only walked to expire old files in the background.
 class ThreadSafeNetworkDiskCache : public QAbstractNetworkCache {
   Q_OBJECT
 
@@ -52,10 +55,22 @@ class ThreadSafeNetworkDiskCache : public QAbstractNetworkCache {
  public slots:
   void clear() override;
 
+ private:
+  struct Shard;
+
+  static Shard *ShardForUrl(const QUrl &url);
+  static void CacheMetaData(Shard *shard, const QUrl &url, const QNetworkCacheMetaData &metadata);
+  static void InvalidateMetaData(Shard *shard, const QUrl &url);
+  static void ExpireInBackground(Shard *shard);
+
  private:
   static QMutex sMutex;
   static int sInstances;
-  static QNetworkDiskCache *sCache;
+  static Shard *sShards;
+
+  // The URLs of the devices returned by prepare, until they're inserted.
+  static QMutex sPreparedMutex;
+  static QHash<QIODevice*, QUrl> sPrepared;
 };
 
 #endif  // THREADSAFENETWORKDISKCACHE_H
@@ -0,0 +1,176 @@
+/*
+ * Strawberry Music Player
+ *
+ * Strawberry is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Strawberry is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Strawberry.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#include "config.h"
+
+#include <atomic>
+#include <vector>
+
+#include <QtGlobal>
+#include <QCoreApplication>
+#include <QThread>
+#include <QMutex>
+#include <QHash>
+#include <QFile>
+#include <QIODevice>
+#include <QByteArray>
+#include <QString>
+#include <QElapsedTimer>
+#include <QJsonDocument>
+#include <QJsonObject>
+#include <QJsonArray>
+
+#include "core/logging.h"
+#include "trace.h"
+
+// clazy:excludeall=non-pod-global-static
+
+namespace trace {
+
+namespace {
+
+// About 40 MB of spans, later spans are dropped.
+constexpr size_t kMaxSpans = 1000000;
+
+struct Span {
+  const char *category;
+  const char *name;
+  qint64 start_usec;
+  qint64 duration_usec;
+  int thread_id;
+};
+
+std::atomic<bool> sRecording(false);
+QMutex sMutex;
+QString sFilename;
+QElapsedTimer sTimer;
+std::vector<Span> sSpans;
+QHash<Qt::HANDLE, int> sThreadIds;
+QHash<int, QString> sThreadNames;
+
+}  // namespace
+
+void Start(const QString &filename) {
+
+  QMutexLocker l(&sMutex);
+
+  sFilename = filename;
+  sSpans.clear();
+  sSpans.reserve(kMaxSpans / 10);
+  sThreadIds.clear();
+  sThreadNames.clear();
+  sTimer.start();
+  sRecording = true;
+
+  qLog(Info) << "Recording trace to" << filename;
+
+}
+
+void Stop() {
+
+  if (!sRecording.exchange(false)) return;
+
+  QMutexLocker l(&sMutex);
+
+  const int pid = static_cast<int>(QCoreApplication::applicationPid());
+
+  QJsonArray events;
+  for (QHash<int, QString>::const_iterator it = sThreadNames.constBegin(); it != sThreadNames.constEnd(); ++it) {
+    QJsonObject args;
+    args[QLatin1String("name")] = it.value();
+    QJsonObject event;
+    event[QLatin1String("ph")] = QStringLiteral("M");
+    event[QLatin1String("name")] = QStringLiteral("thread_name");
+    event[QLatin1String("pid")] = pid;
+    event[QLatin1String("tid")] = it.key();
+    event[QLatin1String("args")] = args;
+    events.append(event);
+  }
+
+  for (const Span &span : sSpans) {
+    QJsonObject event;
+    event[QLatin1String("ph")] = QStringLiteral("X");
+    event[QLatin1String("cat")] = QLatin1String(span.category);
+    event[QLatin1String("name")] = QLatin1String(span.name);
+    event[QLatin1String("ts")] = span.start_usec;
+    event[QLatin1String("dur")] = span.duration_usec;
+    event[QLatin1String("pid")] = pid;
+    event[QLatin1String("tid")] = span.thread_id;
+    events.append(event);
+  }
+
+  QJsonObject root;
+  root[QLatin1String("traceEvents")] = events;
+  root[QLatin1String("displayTimeUnit")] = QStringLiteral("ms");
+
+  QFile file(sFilename);
+  if (!file.open(QIODevice::WriteOnly | QIODevice::Truncate)) {
+    qLog(Error) << "Could not open trace file" << sFilename << file.errorString();
+    return;
+  }
+  file.write(QJsonDocument(root).toJson(QJsonDocument::Compact));
+  file.close();
+
+  qLog(Info) << "Wrote" << sSpans.size() << "trace spans to" << sFilename;
+
+  sSpans.clear();
+
+}
+
+bool IsRecording() { return sRecording; }
+
+qint64 CurrentTimeUsec() {
+  return sTimer.nsecsElapsed() / 1000;
+}
+
+void AddSpan(const char *category, const char *name, const qint64 start_usec, const qint64 duration_usec) {
+
+  if (!sRecording) return;
+
+  QMutexLocker l(&sMutex);
+
+  if (sSpans.size() >= kMaxSpans) return;
+
+  // Chrome traces need small thread IDs, the names are taken from the QThread object names.
+  const Qt::HANDLE handle = QThread::currentThreadId();
+  int thread_id = sThreadIds.value(handle, -1);
+  if (thread_id == -1) {
+    thread_id = static_cast<int>(sThreadIds.count()) + 1;
+    sThreadIds.insert(handle, thread_id);
+    const QString thread_name = QThread::currentThread()->objectName();
+    sThreadNames.insert(thread_id, thread_name.isEmpty() ? QStringLiteral("Thread %1").arg(thread_id) : thread_name);
+  }
+
+  sSpans.push_back(Span{ category, name, start_usec, duration_usec, thread_id });
+
+}
+
+ScopedSpan::ScopedSpan(const char *category, const char *name)
+    : category_(category),
+      name_(name),
+      start_usec_(sRecording ? CurrentTimeUsec() : -1) {}
+
+ScopedSpan::~ScopedSpan() {
+
+  if (start_usec_ >= 0) {
+    AddSpan(category_, name_, start_usec_, CurrentTimeUsec() - start_usec_);
+  }
+
+}
+
+}  // namespace trace
@@ -0,0 +1,72 @@
+/*
+ * Strawberry Music Player
+ *
+ * Strawberry is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Strawberry is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Strawberry.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#ifndef TRACE_H
+#define TRACE_H
+
+#include "config.h"
+
+#include <QtGlobal>
+#include <QString>
+
+// Timing spans that are written to a Chrome trace file, which can be opened in Perfetto or chrome://tracing.
+// Recording is started with the --trace commandline option, spans cost one check of a flag when it's not recording.
+// Spans are compiled out when building without USE_TRACING.
+//
+// Usage:
+//    void Foo() {
+//      TRACE_SCOPE("collection", "Foo");
+//      ...
+//    }
+
+namespace trace {
+
+// Spans are recorded until the trace is written when the application exits.
+void Start(const QString &filename);
+void Stop();
+
+bool IsRecording();
+
+// The name and category must be string literals, only the pointers are kept.
+void AddSpan(const char *category, const char *name, const qint64 start_usec, const qint64 duration_usec);
+qint64 CurrentTimeUsec();
+
+class ScopedSpan {
+ public:
+  explicit ScopedSpan(const char *category, const char *name);
+  ~ScopedSpan();
+
+ private:
+  Q_DISABLE_COPY(ScopedSpan)
+
+  const char *category_;
+  const char *name_;
+  qint64 start_usec_;
+};
+
+}  // namespace trace
+
+#ifdef USE_TRACING
+#  define TRACE_CONCAT_INNER(a, b) a##b
+#  define TRACE_CONCAT(a, b) TRACE_CONCAT_INNER(a, b)
+#  define TRACE_SCOPE(category, name) trace::ScopedSpan TRACE_CONCAT(trace_span_, __LINE__)(category, name)
+#else
+#  define TRACE_SCOPE(category, name)
+#endif
+
+#endif  // TRACE_H
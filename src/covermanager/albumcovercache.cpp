@@ -0,0 +1,143 @@
+/*
+ * Strawberry Music Player
+ *
+ * Strawberry is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Strawberry is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Strawberry.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#include "config.h"
+
+#include <utility>
+#include <memory>
+
+#include <QtGlobal>
+#include <QMutex>
+#include <QCache>
+#include <QHash>
+#include <QList>
+#include <QString>
+#include <QImage>
+#include <QStandardPaths>
+
+#include "core/shared_ptr.h"
+#include "core/memorystats.h"
+#include "collection/collectioniconatlas.h"
+#include "albumcovercache.h"
+#include "albumcoverloaderresult.h"
+
+using std::make_shared;
+
+namespace {
+constexpr int kMemoryCacheSize = 64 * 1024 * 1024;
+constexpr qint64 kDiskCacheSize = 128 * 1024 * 1024;
+}  // namespace
+
+const int AlbumCoverCache::kMaxDiskTileSize = 512;
+
+AlbumCoverCache::AlbumCoverCache()
+    : memory_cache_(kMemoryCacheSize),
+      cache_dir_(QStandardPaths::writableLocation(QStandardPaths::CacheLocation) + QStringLiteral("/albumcovers")) {
+
+  memorystats::AddProvider(this, [this]() {
+    QMutexLocker l(&mutex_);
+    return memorystats::Entry(QStringLiteral("Album cover cache"), memory_cache_.count(), memory_cache_.totalCost(), memory_cache_.maxCost());
+  });
+
+}
+
+AlbumCoverCache::~AlbumCoverCache() {
+  memorystats::RemoveProviders(this);
+}
+
+QString AlbumCoverCache::DiskKey(const QString &key, const AlbumCoverLoaderResult::Type type) {
+
+  // The atlas only stores the pixels, so the result type is part of the key.
+  return key + QLatin1Char('#') + QString::number(static_cast<int>(type));
+
+}
+
+CollectionIconAtlas *AlbumCoverCache::Atlas(const int tile_size) {
+
+  if (tile_size <= 0 || tile_size > kMaxDiskTileSize) return nullptr;
+
+  if (!atlases_.contains(tile_size)) {
+    SharedPtr<CollectionIconAtlas> atlas = make_shared<CollectionIconAtlas>(QStringLiteral("%1/%2.atlas").arg(cache_dir_).arg(tile_size), tile_size);
+    atlas->Open(kDiskCacheSize);
+    atlases_.insert(tile_size, atlas);
+  }
+
+  CollectionIconAtlas *atlas = &*atlases_.value(tile_size);
+  return atlas->is_open() ? atlas : nullptr;
+
+}
+
+bool AlbumCoverCache::Find(const QString &key, const int tile_size, const qreal device_pixel_ratio, QImage *image, AlbumCoverLoaderResult::Type *type) {
+
+  QMutexLocker l(&mutex_);
+
+  if (const CachedImage *cached_image = memory_cache_.object(key)) {
+    *image = cached_image->image;
+    *type = cached_image->type;
+    return true;
+  }
+
+  CollectionIconAtlas *atlas = Atlas(tile_size);
+  if (!atlas) return false;
+
+  static const QList<AlbumCoverLoaderResult::Type> kTypes = QList<AlbumCoverLoaderResult::Type>() << AlbumCoverLoaderResult::Type::Manual
+                                                                                                   << AlbumCoverLoaderResult::Type::Automatic
+                                                                                                   << AlbumCoverLoaderResult::Type::Embedded
+                                                                                                   << AlbumCoverLoaderResult::Type::Unset
+                                                                                                   << AlbumCoverLoaderResult::Type::None;
+  for (const AlbumCoverLoaderResult::Type disk_type : kTypes) {
+    QImage disk_image = atlas->Find(DiskKey(key, disk_type));
+    if (disk_image.isNull()) continue;
+    disk_image.setDevicePixelRatio(device_pixel_ratio);
+    memory_cache_.insert(key, new CachedImage{ disk_image, disk_type }, static_cast<int>(disk_image.sizeInBytes()));
+    *image = disk_image;
+    *type = disk_type;
+    return true;
+  }
+
+  return false;
+
+}
+
+void AlbumCoverCache::Insert(const QString &key, const int tile_size, const QImage &image, const AlbumCoverLoaderResult::Type type) {
+
+  if (image.isNull()) return;
+
+  QMutexLocker l(&mutex_);
+
+  memory_cache_.insert(key, new CachedImage{ image, type }, static_cast<int>(image.sizeInBytes()));
+
+  // Only images that fill the tile are stored, the atlas would pad the others.
+  if (image.width() != tile_size || image.height() != tile_size) return;
+  CollectionIconAtlas *atlas = Atlas(tile_size);
+  if (atlas && !atlas->Contains(DiskKey(key, type))) {
+    atlas->Insert(DiskKey(key, type), image);
+  }
+
+}
+
+void AlbumCoverCache::Clear() {
+
+  QMutexLocker l(&mutex_);
+
+  memory_cache_.clear();
+  for (SharedPtr<CollectionIconAtlas> atlas : std::as_const(atlases_)) {
+    atlas->Clear();
+  }
+
+}
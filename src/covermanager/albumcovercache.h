@@ -0,0 +1,70 @@
+/*
+ * Strawberry Music Player
+ *
+ * Strawberry is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Strawberry is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Strawberry.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#ifndef ALBUMCOVERCACHE_H
+#define ALBUMCOVERCACHE_H
+
+#include "config.h"
+
+#include <QtGlobal>
+#include <QMutex>
+#include <QCache>
+#include <QHash>
+#include <QString>
+#include <QImage>
+
+#include "core/shared_ptr.h"
+#include "albumcoverloaderresult.h"
+
+class CollectionIconAtlas;
+
+// Cache for the scaled covers made by AlbumCoverLoader, so views asking for the same cover at the same size share one decode.
+// The key identifies the cover sources of the album and the scaled size.
+// Recently used images are kept in memory, square images are also kept on disk in one memory-mapped atlas per size.
+// It's used from the loader's thread pool, so all methods are thread-safe.
+class AlbumCoverCache {
+ public:
+  explicit AlbumCoverCache();
+  ~AlbumCoverCache();
+
+  static const int kMaxDiskTileSize;
+
+  // A tile size of 0 only uses the memory cache.
+  bool Find(const QString &key, const int tile_size, const qreal device_pixel_ratio, QImage *image, AlbumCoverLoaderResult::Type *type);
+  void Insert(const QString &key, const int tile_size, const QImage &image, const AlbumCoverLoaderResult::Type type);
+  void Clear();
+
+ private:
+  struct CachedImage {
+    QImage image;
+    AlbumCoverLoaderResult::Type type;
+  };
+
+  static QString DiskKey(const QString &key, const AlbumCoverLoaderResult::Type type);
+  // Opens the atlas for the tile size.  The mutex must be locked.
+  CollectionIconAtlas *Atlas(const int tile_size);
+
+  QMutex mutex_;
+  QCache<QString, CachedImage> memory_cache_;
+  QHash<int, SharedPtr<CollectionIconAtlas>> atlases_;
+  QString cache_dir_;
+
+  Q_DISABLE_COPY(AlbumCoverCache)
+};
+
+#endif  // ALBUMCOVERCACHE_H
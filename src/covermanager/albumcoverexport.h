@@ -61,10 +61,6 @@ class AlbumCoverExport : public QDialog {
     bool IsSizeForced() const {
       return forcesize_ && width_ > 0 && height_ > 0;
     }
-
-    bool RequiresCoverProcessing() const {
-      return IsSizeForced() || overwrite_ == OverwriteMode::Smaller;
-    }
   };
 
   DialogResult Exec();
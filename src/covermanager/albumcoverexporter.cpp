@@ -21,6 +21,7 @@
 #include "config.h"
 
 #include <QObject>
+#include <QThread>
 #include <QThreadPool>
 
 #include "core/song.h"
@@ -29,7 +30,7 @@
 #include "albumcoverexporter.h"
 #include "coverexportrunnable.h"
 
-const int AlbumCoverExporter::kMaxConcurrentRequests = 3;
+const int AlbumCoverExporter::kQueuedJobsPerThread = 2;
 
 AlbumCoverExporter::AlbumCoverExporter(QObject *parent)
     : QObject(parent),
@@ -37,7 +38,8 @@ AlbumCoverExporter::AlbumCoverExporter(QObject *parent)
       exported_(0),
       skipped_(0),
       all_(0) {
-  thread_pool_->setMaxThreadCount(kMaxConcurrentRequests);
+  // Reading, scaling and writing the covers is done on all cores, the embedded art is read by the tagreader workers.
+  thread_pool_->setMaxThreadCount(qMax(1, QThread::idealThreadCount()));
 }
 
 void AlbumCoverExporter::SetDialogResult(const AlbumCoverExport::DialogResult &dialog_result) {
@@ -65,9 +67,11 @@ void AlbumCoverExporter::StartExporting() {
 
 }
 
+// Keeps a few more jobs than threads queued in the pool, so a thread can start on the next cover without waiting for this thread.
 void AlbumCoverExporter::AddJobsToPool() {
 
-  while (!requests_.isEmpty() && thread_pool_->activeThreadCount() < thread_pool_->maxThreadCount()) {
+  const int max_jobs = kQueuedJobsPerThread * thread_pool_->maxThreadCount();
+  while (!requests_.isEmpty() && all_ - static_cast<int>(requests_.count()) - exported_ - skipped_ < max_jobs) {
     CoverExportRunnable *runnable = requests_.dequeue();
 
     QObject::connect(runnable, &CoverExportRunnable::CoverExported, this, &AlbumCoverExporter::CoverExported);
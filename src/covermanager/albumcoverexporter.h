@@ -40,8 +40,6 @@ class AlbumCoverExporter : public QObject {
  public:
   explicit AlbumCoverExporter(QObject *parent = nullptr);
 
-  static const int kMaxConcurrentRequests;
-
   void SetDialogResult(const AlbumCoverExport::DialogResult &dialog_result);
   void SetCoverTypes(const AlbumCoverLoaderOptions::Types &cover_types);
   void AddExportRequest(const Song &song);
@@ -58,6 +56,8 @@ class AlbumCoverExporter : public QObject {
   void CoverSkipped();
 
  private:
+  static const int kQueuedJobsPerThread;
+
   void AddJobsToPool();
 
   AlbumCoverLoaderOptions::Types cover_types_;
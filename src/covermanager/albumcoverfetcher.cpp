@@ -145,6 +145,9 @@ void AlbumCoverFetcher::SingleSearchFinished(const quint64 request_id, const Cov
   search->deleteLater();
   emit SearchFinished(request_id, results, search->statistics());
 
+  // Start the next search right away instead of on the next tick, the providers limit their own request rate.
+  StartRequests();
+
 }
 
 void AlbumCoverFetcher::SingleCoverFetched(const quint64 request_id, const AlbumCoverImageResult &result) {
@@ -155,4 +158,7 @@ void AlbumCoverFetcher::SingleCoverFetched(const quint64 request_id, const Album
   search->deleteLater();
   emit AlbumCoverFetched(request_id, result, search->statistics());
 
+  // Start the next search right away instead of on the next tick, the providers limit their own request rate.
+  StartRequests();
+
 }
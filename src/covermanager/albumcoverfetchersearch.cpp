@@ -45,6 +45,7 @@
 #include "albumcoverfetchersearch.h"
 #include "coverprovider.h"
 #include "coverproviders.h"
+#include "coverprovidercache.h"
 #include "albumcoverimageresult.h"
 
 const int AlbumCoverFetcherSearch::kSearchTimeoutMs = 20000;
@@ -55,9 +56,11 @@ const float AlbumCoverFetcherSearch::kGoodScore = 4.0;
 AlbumCoverFetcherSearch::AlbumCoverFetcherSearch(const CoverSearchRequest &request, SharedPtr<NetworkAccessManager> network, QObject *parent)
     : QObject(parent),
       request_(request),
+      cache_(nullptr),
       image_load_timeout_(new NetworkTimeouts(kImageLoadTimeoutMs, this)),
       network_(network),
-      cancel_requested_(false) {
+      cancel_requested_(false),
+      providers_finished_(false) {
 
   // We will terminate the search after kSearchTimeoutMs milliseconds if we are not able to find all of the results before that point in time
   QTimer::singleShot(kSearchTimeoutMs, this, &AlbumCoverFetcherSearch::TerminateSearch);
@@ -88,6 +91,9 @@ void AlbumCoverFetcherSearch::Start(SharedPtr<CoverProviders> cover_providers) {
     return;
   }
 
+  cache_ = cover_providers->cache();
+  search_timer_.start();
+
   QList<CoverProvider*> cover_providers_sorted = cover_providers->List();
   std::stable_sort(cover_providers_sorted.begin(), cover_providers_sorted.end(), ProviderCompareOrder);
 
@@ -110,6 +116,15 @@ void AlbumCoverFetcherSearch::Start(SharedPtr<CoverProviders> cover_providers) {
       continue;
     }
 
+    // When fetching, providers that were asked about this album recently aren't asked again, that includes the ones that found nothing.
+    CoverProviderCache::Lookup lookup;
+    if (cache_ && !request_.search && cache_->Find(provider->name(), request_.artist, request_.album, request_.title, &lookup)) {
+      ProviderSearchResults(provider, lookup.results);
+      ++statistics_.cached_lookups_;
+      statistics_.time_saved_msec_ += static_cast<quint64>(lookup.duration_msec);
+      continue;
+    }
+
     QObject::connect(provider, &CoverProvider::SearchResults, this, QOverload<const int, const CoverProviderSearchResults&>::of(&AlbumCoverFetcherSearch::ProviderSearchResults));
     QObject::connect(provider, &CoverProvider::SearchFinished, this, &AlbumCoverFetcherSearch::ProviderSearchFinished);
     const int id = cover_providers->NextId();
@@ -117,12 +132,13 @@ void AlbumCoverFetcherSearch::Start(SharedPtr<CoverProviders> cover_providers) {
 
     if (success) {
       pending_requests_[id] = provider;
+      pending_start_msec_[id] = search_timer_.elapsed();
       statistics_.network_requests_made_++;
     }
   }
 
-  // End this search before it even began if there are no providers...
-  if (pending_requests_.isEmpty()) {
+  // End this search before it even began if there are no providers, or a cached result is good enough.
+  if (pending_requests_.isEmpty() || (!request_.search && HasGoodResult())) {
     TerminateSearch();
   }
 
@@ -132,6 +148,7 @@ void AlbumCoverFetcherSearch::ProviderSearchResults(const int id, const CoverPro
 
   if (!pending_requests_.contains(id)) return;
   CoverProvider *provider = pending_requests_[id];
+  pending_results_[id].append(results);
   ProviderSearchResults(provider, results);
 
 }
@@ -233,8 +250,20 @@ void AlbumCoverFetcherSearch::ProviderSearchFinished(const int id, const CoverPr
   CoverProvider *provider = pending_requests_.take(id);
   ProviderSearchResults(provider, results);
 
+  // Only complete lookups are cached, not the ones that were cancelled or timed out.
+  const CoverProviderSearchResults provider_results = pending_results_.take(id) + results;
+  const qint64 duration_msec = search_timer_.elapsed() - pending_start_msec_.take(id);
+  if (cache_) {
+    cache_->Insert(provider->name(), request_.artist, request_.album, request_.title, provider_results, duration_msec);
+  }
+
   // Do we have more providers left?
   if (!pending_requests_.isEmpty()) {
+    // The image of a good result is loaded right away, the slower providers are cancelled, so they don't use their rate limits for nothing.
+    if (!request_.search && HasGoodResult()) {
+      qLog(Debug) << "Found a good cover from" << provider->name() << "cancelling" << pending_requests_.count() << "remaining providers";
+      TerminateSearch();
+    }
     return;
   }
 
@@ -242,11 +271,19 @@ void AlbumCoverFetcherSearch::ProviderSearchFinished(const int id, const CoverPr
 
 }
 
+bool AlbumCoverFetcherSearch::HasGoodResult() const {
+
+  return std::any_of(results_.begin(), results_.end(), [](const CoverProviderSearchResult &result) { return result.score() >= kGoodScore; });
+
+}
+
 void AlbumCoverFetcherSearch::AllProvidersFinished() {
 
-  if (cancel_requested_) {
+  // The search timeout can end a search that already finished.
+  if (cancel_requested_ || providers_finished_) {
     return;
   }
+  providers_finished_ = true;
 
   // If we only wanted to do the search then we're done
   if (request_.search) {
@@ -267,6 +304,10 @@ void AlbumCoverFetcherSearch::AllProvidersFinished() {
 
   std::stable_sort(results_.begin(), results_.end(), CoverProviderSearchResultCompareScore);
 
+  // The results that are good enough by their reported size are loaded first, the smallest first, so the first good image can be used with the least data transferred.
+  CoverProviderSearchResults::iterator good_end = std::stable_partition(results_.begin(), results_.end(), [](const CoverProviderSearchResult &result) { return result.score() >= kGoodScore && result.image_size.isValid() && !result.image_size.isEmpty(); });
+  std::stable_sort(results_.begin(), good_end, CoverProviderSearchResultCompareSize);
+
   FetchMoreImages();
 
 }
@@ -282,6 +323,10 @@ void AlbumCoverFetcherSearch::FetchMoreImages() {
 
     QNetworkRequest req(result.image_url);
     req.setAttribute(QNetworkRequest::RedirectPolicyAttribute, QNetworkRequest::NoLessSafeRedirectPolicy);
+#if QT_VERSION >= QT_VERSION_CHECK(5, 15, 0)
+    // The images of a provider usually come from the same host, so they can share one connection.
+    req.setAttribute(QNetworkRequest::Http2AllowedAttribute, true);
+#endif
     QNetworkReply *image_reply = network_->get(req);
     QObject::connect(image_reply, &QNetworkReply::finished, this, [this, image_reply]() { ProviderCoverFetchFinished(image_reply); });
     pending_image_loads_[image_reply] = result;
@@ -335,6 +380,11 @@ void AlbumCoverFetcherSearch::ProviderCoverFetchFinished(QNetworkReply *reply) {
         result.score_quality = ScoreImage(image.size());
         candidate_images_.insert(result.score(), CandidateImage(result, AlbumCoverImageResult(result.image_url, mime_type, image_data, image)));
         qLog(Debug) << reply->url() << "from" << result.provider << "scored" << result.score();
+        // There's a winner, the other images aren't needed.
+        if (result.score() >= kGoodScore && !pending_image_loads_.isEmpty()) {
+          qLog(Debug) << "Aborting" << pending_image_loads_.count() << "image loads";
+          AbortImageLoads();
+        }
       }
       else {
         qLog(Error) << "Error decoding image data from" << reply->url();
@@ -411,13 +461,7 @@ void AlbumCoverFetcherSearch::Cancel() {
     TerminateSearch();
   }
   else if (!pending_image_loads_.isEmpty()) {
-    QList<QNetworkReply*> replies = pending_image_loads_.keys();
-    for (QNetworkReply *reply : replies) {
-      QObject::disconnect(reply, &QNetworkReply::finished, this, nullptr);
-      reply->abort();
-      reply->deleteLater();
-    }
-    pending_image_loads_.clear();
+    AbortImageLoads();
   }
 
 }
@@ -426,10 +470,26 @@ bool AlbumCoverFetcherSearch::ProviderCompareOrder(CoverProvider *a, CoverProvid
   return a->order() < b->order();
 }
 
+void AlbumCoverFetcherSearch::AbortImageLoads() {
+
+  const QList<QNetworkReply*> replies = pending_image_loads_.keys();
+  for (QNetworkReply *reply : replies) {
+    QObject::disconnect(reply, &QNetworkReply::finished, this, nullptr);
+    reply->abort();
+    reply->deleteLater();
+  }
+  pending_image_loads_.clear();
+
+}
+
 bool AlbumCoverFetcherSearch::CoverProviderSearchResultCompareScore(const CoverProviderSearchResult &a, const CoverProviderSearchResult &b) {
   return a.score() > b.score();
 }
 
+bool AlbumCoverFetcherSearch::CoverProviderSearchResultCompareSize(const CoverProviderSearchResult &a, const CoverProviderSearchResult &b) {
+  return a.image_size.width() * a.image_size.height() < b.image_size.width() * b.image_size.height();
+}
+
 bool AlbumCoverFetcherSearch::CoverProviderSearchResultCompareNumber(const CoverProviderSearchResult &a, const CoverProviderSearchResult &b) {
   return a.number < b.number;
 }
@@ -34,6 +34,7 @@
 #include <QString>
 #include <QUrl>
 #include <QImage>
+#include <QElapsedTimer>
 
 #include "core/shared_ptr.h"
 #include "albumcoverfetcher.h"
@@ -43,12 +44,14 @@
 class QNetworkReply;
 class CoverProvider;
 class CoverProviders;
+class CoverProviderCache;
 class NetworkAccessManager;
 class NetworkTimeouts;
 
 // This class encapsulates a single search for covers initiated by an AlbumCoverFetcher.
 // The search engages all of the known cover providers.
 // AlbumCoverFetcherSearch signals search results to an interested AlbumCoverFetcher when all of the providers have done their part.
+// When fetching a cover, the search doesn't wait for the remaining providers once one of them returned a result that scores well enough.
 class AlbumCoverFetcherSearch : public QObject {
   Q_OBJECT
 
@@ -81,13 +84,16 @@ class AlbumCoverFetcherSearch : public QObject {
  private:
   void ProviderSearchResults(CoverProvider *provider, const CoverProviderSearchResults &results);
   void AllProvidersFinished();
+  bool HasGoodResult() const;
 
   void FetchMoreImages();
+  void AbortImageLoads();
   static float ScoreImage(const QSize size);
   void SendBestImage();
 
   static bool ProviderCompareOrder(CoverProvider *a, CoverProvider *b);
   static bool CoverProviderSearchResultCompareScore(const CoverProviderSearchResult &a, const CoverProviderSearchResult &b);
+  static bool CoverProviderSearchResultCompareSize(const CoverProviderSearchResult &a, const CoverProviderSearchResult &b);
 
  private:
   static const int kSearchTimeoutMs;
@@ -104,6 +110,11 @@ class AlbumCoverFetcherSearch : public QObject {
   CoverProviderSearchResults results_;
 
   QMap<int, CoverProvider*> pending_requests_;
+  // What each pending provider returned so far, and when it was asked, for the cache.
+  QHash<int, CoverProviderSearchResults> pending_results_;
+  QHash<int, qint64> pending_start_msec_;
+  QElapsedTimer search_timer_;
+  CoverProviderCache *cache_;
   QHash<QNetworkReply*, CoverProviderSearchResult> pending_image_loads_;
   NetworkTimeouts *image_load_timeout_;
 
@@ -118,6 +129,7 @@ class AlbumCoverFetcherSearch : public QObject {
   SharedPtr<NetworkAccessManager> network_;
 
   bool cancel_requested_;
+  bool providers_finished_;
 
 };
 
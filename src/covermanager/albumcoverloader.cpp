@@ -17,11 +17,16 @@
  *
  */
 
+#include <utility>
 #include <memory>
 
 #include <QtGlobal>
 #include <QObject>
 #include <QThread>
+#include <QThreadPool>
+#include <QFuture>
+#include <QFutureWatcher>
+#include <QtConcurrentRun>
 #include <QMutex>
 #include <QSet>
 #include <QQueue>
@@ -30,16 +35,25 @@
 #include <QString>
 #include <QUrl>
 #include <QFile>
+#include <QFileInfo>
+#include <QDateTime>
+#include <QStringList>
+#include <QBuffer>
+#include <QSize>
 #include <QImage>
+#include <QImageReader>
+#include <QImageIOHandler>
 #include <QNetworkReply>
 #include <QNetworkRequest>
 
 #include "core/networkaccessmanager.h"
 #include "core/song.h"
 #include "core/tagreaderclient.h"
+#include "core/trace.h"
 #include "utilities/mimeutils.h"
 #include "utilities/imageutils.h"
 #include "albumcoverloader.h"
+#include "albumcovercache.h"
 #include "albumcoverloaderoptions.h"
 #include "albumcoverloaderresult.h"
 #include "albumcoverimageresult.h"
@@ -49,12 +63,30 @@ using std::make_shared;
 AlbumCoverLoader::AlbumCoverLoader(QObject *parent)
     : QObject(parent),
       network_(new NetworkAccessManager(this)),
+      supported_schemes_(network_->supportedSchemes()),
+      thread_pool_(new QThreadPool(this)),
+      cache_(new AlbumCoverCache),
+      running_tasks_(0),
       stop_requested_(false),
       load_image_async_id_(1),
       original_thread_(nullptr) {
 
   original_thread_ = thread();
 
+  thread_pool_->setMaxThreadCount(qMax(1, QThread::idealThreadCount()));
+
+}
+
+AlbumCoverLoader::~AlbumCoverLoader() {
+
+  thread_pool_->waitForDone();
+
+}
+
+void AlbumCoverLoader::ClearCache() {
+
+  cache_->Clear();
+
 }
 
 void AlbumCoverLoader::ExitAsync() {
@@ -67,6 +99,13 @@ void AlbumCoverLoader::ExitAsync() {
 void AlbumCoverLoader::Exit() {
 
   Q_ASSERT(QThread::currentThread() == thread());
+
+  {
+    QMutexLocker l(&mutex_load_image_async_);
+    tasks_.clear();
+  }
+  thread_pool_->waitForDone();
+
   moveToThread(original_thread_);
   emit ExitFinished();
 
@@ -167,11 +206,50 @@ quint64 AlbumCoverLoader::EnqueueTask(TaskPtr task) {
 
 void AlbumCoverLoader::ProcessTasks() {
 
-  TaskPtr task;
-  {
-    QMutexLocker l(&mutex_load_image_async_);
-    if (tasks_.isEmpty()) return;
-    task = tasks_.dequeue();
+  while (!stop_requested_ && running_tasks_ < thread_pool_->maxThreadCount()) {
+    TaskPtr task;
+    {
+      QMutexLocker l(&mutex_load_image_async_);
+      if (tasks_.isEmpty()) return;
+      task = tasks_.dequeue();
+    }
+    StartTask(task);
+  }
+
+}
+
+void AlbumCoverLoader::StartTask(TaskPtr task) {
+
+  ++running_tasks_;
+  QFutureWatcher<void> *watcher = new QFutureWatcher<void>(this);
+  QObject::connect(watcher, &QFutureWatcher<void>::finished, this, [this, watcher, task]() { TaskFinished(watcher, task); });
+  watcher->setFuture(QtConcurrent::run(thread_pool_, [this, task]() { RunTask(task); }));
+
+}
+
+void AlbumCoverLoader::TaskFinished(QFutureWatcherBase *watcher, TaskPtr task) {
+
+  watcher->deleteLater();
+  --running_tasks_;
+
+  if (task->remote_cover_url.isValid() && !stop_requested_) {
+    LoadRemoteImage(task);
+  }
+
+  ProcessTasks();
+
+}
+
+void AlbumCoverLoader::RunTask(TaskPtr task) {
+
+  if (task->remote_reply) {
+    task->remote_reply = false;
+    if (DecodeImage(task)) {
+      task->success = true;
+      FinishTask(task, task->remote_result_type);
+      return;
+    }
+    qLog(Error) << "Unable to load album cover image from URL" << task->remote_cover_url;
   }
 
   ProcessTask(task);
@@ -180,12 +258,17 @@ void AlbumCoverLoader::ProcessTasks() {
 
 void AlbumCoverLoader::ProcessTask(TaskPtr task) {
 
+  task->remote_cover_url.clear();
+
   // If we have album cover already, only do scale and pad.
   if (task->album_cover.is_valid()) {
     task->success = true;
   }
-  else {
+  else if (!task->cache_checked) {
     InitArt(task);
+    task->cache_checked = true;
+    task->cache_key = CacheKey(task);
+    if (FinishCachedTask(task)) return;
   }
 
   while (!task->success && !task->options.types.isEmpty()) {
@@ -218,6 +301,9 @@ void AlbumCoverLoader::FinishTask(TaskPtr task, const AlbumCoverLoaderResult::Ty
     task->album_cover.mime_type = Utilities::MimeTypeFromData(task->album_cover.image_data);
     if (task->scaled_image()) {
       image_scaled = ImageUtils::ScaleImage(task->album_cover.image, task->options.desired_scaled_size, task->options.device_pixel_ratio, task->pad_scaled_image());
+      if (task->success && !task->cache_key.isEmpty()) {
+        cache_->Insert(task->cache_key, CacheTileSize(task), image_scaled, task->result_type);
+      }
     }
     if (!task->raw_image_data() && !task->album_cover.image_data.isNull()) {
       task->album_cover.image_data = QByteArray();
@@ -231,6 +317,91 @@ void AlbumCoverLoader::FinishTask(TaskPtr task, const AlbumCoverLoaderResult::Ty
 
 }
 
+QString AlbumCoverLoader::CacheKey(TaskPtr task) {
+
+  // Only the scaled image is cached, the same for every task with the same cover sources, options and size.
+  if (!task->scaled_image() || task->raw_image_data() || task->original_image()) return QString();
+
+  // Local files are identified with their modification time, so a changed cover isn't found in the cache.
+  auto source = [](const QUrl &url) {
+    if (!url.isLocalFile()) return url.toString();
+    const QFileInfo fileinfo(url.toLocalFile());
+    return url.toString() + QLatin1Char('@') + QString::number(fileinfo.exists() ? fileinfo.lastModified().toMSecsSinceEpoch() : -1);
+  };
+
+  QStringList parts;
+  for (const AlbumCoverLoaderOptions::Type type : std::as_const(task->options.types)) {
+    switch (type) {
+      case AlbumCoverLoaderOptions::Type::Unset:
+        if (task->art_unset) parts << QStringLiteral("unset");
+        break;
+      case AlbumCoverLoaderOptions::Type::Embedded:
+        if (task->art_embedded && task->song_url.isValid() && task->song_url.isLocalFile()) parts << QStringLiteral("embedded:") + source(task->song_url);
+        break;
+      case AlbumCoverLoaderOptions::Type::Automatic:
+        if (task->art_automatic.isValid()) parts << QStringLiteral("automatic:") + source(task->art_automatic);
+        break;
+      case AlbumCoverLoaderOptions::Type::Manual:
+        if (task->art_manual.isValid()) parts << QStringLiteral("manual:") + source(task->art_manual);
+        break;
+    }
+  }
+  if (!task->options.default_cover.isEmpty()) parts << QStringLiteral("default:") + task->options.default_cover;
+  if (parts.isEmpty()) return QString();
+
+  parts << QStringLiteral("%1x%2@%3%4").arg(task->options.desired_scaled_size.width()).arg(task->options.desired_scaled_size.height()).arg(task->options.device_pixel_ratio).arg(task->pad_scaled_image() ? QStringLiteral("p") : QString());
+
+  return parts.join(QLatin1Char('|'));
+
+}
+
+int AlbumCoverLoader::CacheTileSize(TaskPtr task) {
+
+  // Padded square images are stored on disk too, they fill the tiles.
+  const QSize size = task->options.desired_scaled_size;
+  if (!task->pad_scaled_image() || size.width() != size.height()) return 0;
+
+  return static_cast<int>(size.width() * task->options.device_pixel_ratio);
+
+}
+
+bool AlbumCoverLoader::FinishCachedTask(TaskPtr task) {
+
+  if (task->cache_key.isEmpty()) return false;
+
+  QImage image_scaled;
+  AlbumCoverLoaderResult::Type result_type = AlbumCoverLoaderResult::Type::None;
+  if (!cache_->Find(task->cache_key, CacheTileSize(task), task->options.device_pixel_ratio, &image_scaled, &result_type)) return false;
+
+  task->success = true;
+  task->result_type = result_type;
+  emit AlbumCoverLoaded(task->id, AlbumCoverLoaderResult(true, result_type, AlbumCoverImageResult(), image_scaled, task->art_manual_updated, task->art_automatic_updated));
+
+  return true;
+
+}
+
+bool AlbumCoverLoader::DecodeImage(TaskPtr task) {
+
+  // When only the scaled image is returned, formats that can decode at a lower resolution, like JPEG, are decoded at the scaled size.
+  // That's a lot less work and memory than decoding a large cover to throw most of it away.
+  if (task->scaled_image() && !task->original_image() && !task->options.desired_scaled_size.isEmpty()) {
+    QBuffer buffer(&task->album_cover.image_data);
+    buffer.open(QIODevice::ReadOnly);
+    QImageReader reader(&buffer);
+    const QSize image_size = reader.size();
+    const QSize scale_size(static_cast<int>(task->options.desired_scaled_size.width() * task->options.device_pixel_ratio), static_cast<int>(task->options.desired_scaled_size.height() * task->options.device_pixel_ratio));
+    if (reader.supportsOption(QImageIOHandler::ScaledSize) && image_size.isValid() && (image_size.width() > scale_size.width() || image_size.height() > scale_size.height())) {
+      reader.setScaledSize(image_size.scaled(scale_size, Qt::KeepAspectRatio));
+      task->album_cover.image = reader.read();
+      if (!task->album_cover.image.isNull()) return true;
+    }
+  }
+
+  return task->album_cover.image.loadFromData(task->album_cover.image_data);
+
+}
+
 void AlbumCoverLoader::InitArt(TaskPtr task) {
 
   // For local files and streams initialize art if found.
@@ -253,6 +424,8 @@ void AlbumCoverLoader::InitArt(TaskPtr task) {
 
 AlbumCoverLoader::LoadImageResult AlbumCoverLoader::LoadImage(TaskPtr task, const AlbumCoverLoaderOptions::Type type) {
 
+  TRACE_SCOPE("covers", "AlbumCoverLoader::LoadImage");
+
   switch (type) {
     case AlbumCoverLoaderOptions::Type::Unset:{
       if (task->art_unset) {
@@ -290,8 +463,8 @@ AlbumCoverLoader::LoadImageResult AlbumCoverLoader::LoadImage(TaskPtr task, cons
 AlbumCoverLoader::LoadImageResult AlbumCoverLoader::LoadEmbeddedImage(TaskPtr task) {
 
   if (task->art_embedded && task->song_url.isValid() && task->song_url.isLocalFile()) {
-    task->album_cover.image_data = TagReaderClient::Instance()->LoadEmbeddedArtBlocking(task->song_url.toLocalFile());
-    if (!task->album_cover.image_data.isEmpty() && task->album_cover.image.loadFromData(task->album_cover.image_data)) {
+    task->album_cover.image_data = TagReaderClient::Instance()->LoadEmbeddedArtBlocking(task->song_url.toLocalFile(), TagReaderClient::Priority::Playback);
+    if (!task->album_cover.image_data.isEmpty() && DecodeImage(task)) {
       return LoadImageResult(AlbumCoverLoaderResult::Type::Embedded, LoadImageResult::Status::Success);
     }
   }
@@ -306,7 +479,7 @@ AlbumCoverLoader::LoadImageResult AlbumCoverLoader::LoadUrlImage(TaskPtr task, c
     if (cover_url.isLocalFile()) {
       return LoadLocalUrlImage(task, result_type, cover_url);
     }
-    else if (network_->supportedSchemes().contains(cover_url.scheme())) {
+    else if (supported_schemes_.contains(cover_url.scheme())) {
       return LoadRemoteUrlImage(task, result_type, cover_url);
     }
   }
@@ -354,7 +527,7 @@ AlbumCoverLoader::LoadImageResult AlbumCoverLoader::LoadLocalFileImage(TaskPtr t
     return LoadImageResult(result_type, LoadImageResult::Status::Failure);
   }
 
-  if (!task->album_cover.image.loadFromData(task->album_cover.image_data)) {
+  if (!DecodeImage(task)) {
     qLog(Error) << "Failed to load image from cover file" << cover_file << ":" << file.errorString();
     return LoadImageResult(result_type, LoadImageResult::Status::Failure);
   }
@@ -365,15 +538,29 @@ AlbumCoverLoader::LoadImageResult AlbumCoverLoader::LoadLocalFileImage(TaskPtr t
 
 AlbumCoverLoader::LoadImageResult AlbumCoverLoader::LoadRemoteUrlImage(TaskPtr task, const AlbumCoverLoaderResult::Type result_type, const QUrl &cover_url) {
 
+  // The request is made when the task is back on the loader thread.
+  task->remote_cover_url = cover_url;
+  task->remote_result_type = result_type;
+
+  return LoadImageResult(result_type, LoadImageResult::Status::Async);
+
+}
+
+void AlbumCoverLoader::LoadRemoteImage(TaskPtr task) {
+
+  const QUrl cover_url = task->remote_cover_url;
+  const AlbumCoverLoaderResult::Type result_type = task->remote_result_type;
+
   qLog(Debug) << "Loading remote cover from URL" << cover_url;
 
   QNetworkRequest request(cover_url);
   request.setAttribute(QNetworkRequest::RedirectPolicyAttribute, QNetworkRequest::NoLessSafeRedirectPolicy);
+#if QT_VERSION >= QT_VERSION_CHECK(5, 15, 0)
+  request.setAttribute(QNetworkRequest::Http2AllowedAttribute, true);
+#endif
   QNetworkReply *reply = network_->get(request);
   QObject::connect(reply, &QNetworkReply::finished, this, [this, reply, task, result_type, cover_url]() { LoadRemoteImageFinished(reply, task, result_type, cover_url); });
 
-  return LoadImageResult(result_type, LoadImageResult::Status::Async);
-
 }
 
 void AlbumCoverLoader::LoadRemoteImageFinished(QNetworkReply *reply, TaskPtr task, const AlbumCoverLoaderResult::Type result_type, const QUrl &cover_url) {
@@ -387,7 +574,7 @@ void AlbumCoverLoader::LoadRemoteImageFinished(QNetworkReply *reply, TaskPtr tas
   if (redirect.isValid() && redirect.type() == QVariant::Url) {
 #endif
     if (task->redirects++ >= kMaxRedirects) {
-      ProcessTask(task);
+      StartTask(task);
       return;
     }
     const QUrl redirect_url = redirect.toUrl();
@@ -396,16 +583,17 @@ void AlbumCoverLoader::LoadRemoteImageFinished(QNetworkReply *reply, TaskPtr tas
     request.setAttribute(QNetworkRequest::RedirectPolicyAttribute, QNetworkRequest::NoLessSafeRedirectPolicy);
     request.setUrl(redirect_url);
     QNetworkReply *redirected_reply = network_->get(request);
-    QObject::connect(redirected_reply, &QNetworkReply::finished, this, [this, reply, task, result_type, redirect_url]() { LoadRemoteImageFinished(reply, task, result_type, redirect_url); });
+    QObject::connect(redirected_reply, &QNetworkReply::finished, this, [this, redirected_reply, task, result_type, redirect_url]() { LoadRemoteImageFinished(redirected_reply, task, result_type, redirect_url); });
     return;
   }
 
   if (reply->error() == QNetworkReply::NoError) {
     task->album_cover.image_data = reply->readAll();
-    if (!task->album_cover.image_data.isEmpty() && task->album_cover.image.loadFromData(task->album_cover.image_data)) {
-      task->success = true;
-      FinishTask(task, result_type);
-      return;
+    if (!task->album_cover.image_data.isEmpty()) {
+      // Decoded on the thread pool.
+      task->remote_cover_url = cover_url;
+      task->remote_result_type = result_type;
+      task->remote_reply = true;
     }
     else {
       qLog(Error) << "Unable to load album cover image from URL" << cover_url;
@@ -415,6 +603,7 @@ void AlbumCoverLoader::LoadRemoteImageFinished(QNetworkReply *reply, TaskPtr tas
     qLog(Error) << "Unable to get album cover from URL" << cover_url << reply->error() << reply->errorString();
   }
 
-  ProcessTask(task);
+  // Carry on with the next cover type, or decode the image.
+  StartTask(task);
 
 }
@@ -30,23 +30,29 @@
 #include <QQueue>
 #include <QByteArray>
 #include <QString>
+#include <QStringList>
 #include <QImage>
 
 #include "core/shared_ptr.h"
+#include "core/scoped_ptr.h"
 #include "core/song.h"
 #include "albumcoverloaderoptions.h"
 #include "albumcoverloaderresult.h"
 #include "albumcoverimageresult.h"
 
 class QThread;
+class QThreadPool;
+class QFutureWatcherBase;
 class QNetworkReply;
 class NetworkAccessManager;
+class AlbumCoverCache;
 
 class AlbumCoverLoader : public QObject {
   Q_OBJECT
 
  public:
   explicit AlbumCoverLoader(QObject *parent = nullptr);
+  ~AlbumCoverLoader() override;
 
   void ExitAsync();
   void Stop() { stop_requested_ = true; }
@@ -59,6 +65,9 @@ class AlbumCoverLoader : public QObject {
   void CancelTask(const quint64 id);
   void CancelTasks(const QSet<quint64> &ids);
 
+ public slots:
+  void ClearCache();
+
  signals:
   void ExitFinished();
   void AlbumCoverLoaded(const quint64 id, const AlbumCoverLoaderResult &result);
@@ -66,7 +75,7 @@ class AlbumCoverLoader : public QObject {
  private:
   class Task {
    public:
-    explicit Task() : id(0), success(false), art_embedded(false), art_unset(false), song_source(Song::Source::Unknown), result_type(AlbumCoverLoaderResult::Type::None), redirects(0) {}
+    explicit Task() : id(0), success(false), art_embedded(false), art_unset(false), song_source(Song::Source::Unknown), result_type(AlbumCoverLoaderResult::Type::None), redirects(0), remote_result_type(AlbumCoverLoaderResult::Type::None), remote_reply(false), cache_checked(false) {}
 
     quint64 id;
     bool success;
@@ -90,6 +99,14 @@ class AlbumCoverLoader : public QObject {
     QUrl art_manual_updated;
     QUrl art_automatic_updated;
     int redirects;
+    // Set on the thread pool when the image has to be fetched, the request is made from the loader thread.
+    QUrl remote_cover_url;
+    AlbumCoverLoaderResult::Type remote_result_type;
+    // The reply was received and the image data is waiting to be decoded on the thread pool.
+    bool remote_reply;
+    // Where the scaled image is cached, empty if it isn't.
+    bool cache_checked;
+    QString cache_key;
   };
   using TaskPtr = SharedPtr<Task>;
 
@@ -107,6 +124,9 @@ class AlbumCoverLoader : public QObject {
 
  private:
   quint64 EnqueueTask(TaskPtr task);
+  void StartTask(TaskPtr task);
+  void TaskFinished(QFutureWatcherBase *watcher, TaskPtr task);
+  void RunTask(TaskPtr task);
   void ProcessTask(TaskPtr task);
   void InitArt(TaskPtr task);
   LoadImageResult LoadImage(TaskPtr task, const AlbumCoverLoaderOptions::Type type);
@@ -116,6 +136,11 @@ class AlbumCoverLoader : public QObject {
   LoadImageResult LoadLocalFileImage(TaskPtr task, const AlbumCoverLoaderResult::Type result_type, const QString &cover_file);
   LoadImageResult LoadRemoteUrlImage(TaskPtr task, const AlbumCoverLoaderResult::Type result_type, const QUrl &cover_url);
   void FinishTask(TaskPtr task, const AlbumCoverLoaderResult::Type result_type);
+  static QString CacheKey(TaskPtr task);
+  static int CacheTileSize(TaskPtr task);
+  bool FinishCachedTask(TaskPtr task);
+  bool DecodeImage(TaskPtr task);
+  void LoadRemoteImage(TaskPtr task);
 
  private slots:
   void Exit();
@@ -125,6 +150,13 @@ class AlbumCoverLoader : public QObject {
  private:
   static const int kMaxRedirects = 3;
   SharedPtr<NetworkAccessManager> network_;
+  // Copied, so the tasks on the thread pool don't use the network access manager.
+  QStringList supported_schemes_;
+  // Loading, decoding and scaling run on the pool, at most one task per thread is taken from the queue, so queued tasks can still be cancelled.
+  QThreadPool *thread_pool_;
+  // Shared by every view loading covers through the loader.
+  ScopedPtr<AlbumCoverCache> cache_;
+  int running_tasks_;
   bool stop_requested_;
   QMutex mutex_load_image_async_;
   QQueue<TaskPtr> tasks_;
@@ -22,6 +22,7 @@
 #include "config.h"
 
 #include <algorithm>
+#include <utility>
 
 #include <QObject>
 #include <QMainWindow>
@@ -53,6 +54,7 @@
 #include <QStatusBar>
 #include <QLabel>
 #include <QListWidget>
+#include <QScrollBar>
 #include <QMessageBox>
 #include <QProgressBar>
 #include <QPushButton>
@@ -61,6 +63,7 @@
 #include <QSettings>
 #include <QFlags>
 #include <QSize>
+#include <QRect>
 #include <QtEvents>
 
 #include "core/scoped_ptr.h"
@@ -98,6 +101,7 @@
 
 const char *AlbumCoverManager::kSettingsGroup = "CoverManager";
 constexpr int AlbumCoverManager::kThumbnailSize = 120;
+constexpr int AlbumCoverManager::kLoadVisibleCoversDelayMsec = 100;
 
 AlbumCoverManager::AlbumCoverManager(Application *app, SharedPtr<CollectionBackend> collection_backend, QMainWindow *mainwindow, QWidget *parent)
     : QMainWindow(parent),
@@ -109,7 +113,8 @@ AlbumCoverManager::AlbumCoverManager(Application *app, SharedPtr<CollectionBacke
       filter_all_(nullptr),
       filter_with_covers_(nullptr),
       filter_without_covers_(nullptr),
-      cover_fetcher_(new AlbumCoverFetcher(app_->cover_providers(), app_->network(), this)),
+      timer_load_visible_covers_(new QTimer(this)),
+      cover_fetcher_(new AlbumCoverFetcher(app_->cover_providers(), app_->covers_network(), this)),
       cover_searcher_(nullptr),
       cover_export_(nullptr),
       cover_exporter_(new AlbumCoverExporter(this)),
@@ -239,6 +244,11 @@ void AlbumCoverManager::Init() {
 
   new ForceScrollPerPixel(ui_->albums, this);
 
+  timer_load_visible_covers_->setSingleShot(true);
+  timer_load_visible_covers_->setInterval(kLoadVisibleCoversDelayMsec);
+  QObject::connect(timer_load_visible_covers_, &QTimer::timeout, this, &AlbumCoverManager::LoadVisibleCovers);
+  QObject::connect(ui_->albums->verticalScrollBar(), &QScrollBar::valueChanged, timer_load_visible_covers_, QOverload<>::of(&QTimer::start));
+
 }
 
 void AlbumCoverManager::showEvent(QShowEvent *e) {
@@ -422,10 +432,6 @@ void AlbumCoverManager::ArtistChanged(QListWidgetItem *current) {
     album_item->setData(Role_ArtManual, album_info.art_manual);
     album_item->setData(Role_ArtUnset, album_info.art_unset);
 
-    if (album_info.art_embedded || !album_info.art_automatic.isEmpty() || !album_info.art_manual.isEmpty()) {
-      LoadAlbumCoverAsync(album_item);
-    }
-
   }
 
   UpdateFilter();
@@ -438,14 +444,19 @@ void AlbumCoverManager::AlbumCoverLoaded(const quint64 id, const AlbumCoverLoade
 
   AlbumItem *album_item = cover_loading_tasks_.take(id);
 
-  if (!result.success || result.image_scaled.isNull() || result.type == AlbumCoverLoaderResult::Type::Unset) {
+  const bool cover_missing = !result.success || result.image_scaled.isNull() || result.type == AlbumCoverLoaderResult::Type::Unset;
+  if (cover_missing) {
     album_item->setIcon(icon_nocover_item_);
   }
   else {
     album_item->setIcon(QPixmap::fromImage(result.image_scaled));
   }
+  album_item->cover_loaded = !cover_missing;
 
-  UpdateFilter();
+  if (album_item->cover_missing != cover_missing) {
+    album_item->cover_missing = cover_missing;
+    UpdateFilter();
+  }
 
 }
 
@@ -482,6 +493,8 @@ void AlbumCoverManager::UpdateFilter() {
   ui_->total_albums->setText(QString::number(total_count));
   ui_->without_cover->setText(QString::number(without_cover));
 
+  timer_load_visible_covers_->start();
+
 }
 
 bool AlbumCoverManager::ShouldHide(const AlbumItem &album_item, const QString &filter, const HideCovers hide_covers) const {
@@ -581,6 +594,10 @@ void AlbumCoverManager::UpdateStatusText() {
 
 bool AlbumCoverManager::eventFilter(QObject *obj, QEvent *e) {
 
+  if (obj == ui_->albums && e->type() == QEvent::Resize) {
+    timer_load_visible_covers_->start();
+  }
+
   if (obj == ui_->albums && e->type() == QEvent::ContextMenu) {
     context_menu_items_ = ui_->albums->selectedItems();
     if (context_menu_items_.isEmpty()) return QMainWindow::eventFilter(obj, e);
@@ -689,7 +706,7 @@ void AlbumCoverManager::UpdateCoverInList(AlbumItem *album_item, const QUrl &cov
 
   album_item->setData(Role_ArtManual, cover_url);
   album_item->setData(Role_ArtUnset, false);
-  LoadAlbumCoverAsync(album_item);
+  ReloadAlbumCover(album_item);
 
 }
 
@@ -718,7 +735,7 @@ void AlbumCoverManager::SaveCoverToFile() {
         return;
       case AlbumCoverLoaderOptions::Type::Embedded:
         if (song.art_embedded()) {
-          result.image_data = TagReaderClient::Instance()->LoadEmbeddedArtBlocking(song.url().toLocalFile());
+          result.image_data = TagReaderClient::Instance()->LoadEmbeddedArtBlocking(song.url().toLocalFile(), TagReaderClient::Priority::Background);
         }
         break;
       case AlbumCoverLoaderOptions::Type::Automatic:
@@ -1048,7 +1065,11 @@ void AlbumCoverManager::UpdateExportStatus(const int exported, const int skipped
 }
 
 bool AlbumCoverManager::ItemHasCover(const AlbumItem &album_item) const {
-  return album_item.icon().cacheKey() != icon_nocover_item_.cacheKey();
+
+  if (album_item.cover_missing || album_item.data(Role_ArtUnset).toBool()) return false;
+
+  return album_item.data(Role_ArtEmbedded).toBool() || !album_item.data(Role_ArtAutomatic).toUrl().isEmpty() || !album_item.data(Role_ArtManual).toUrl().isEmpty();
+
 }
 
 void AlbumCoverManager::SaveEmbeddedCoverFinished(TagReaderReply *reply, AlbumItem *album_item, const QUrl &url, const bool art_embedded) {
@@ -1070,7 +1091,7 @@ void AlbumCoverManager::SaveEmbeddedCoverFinished(TagReaderReply *reply, AlbumIt
   album_item->setData(Role_ArtUnset, false);
   Song song = AlbumItemAsSong(album_item);
   album_cover_choice_controller_->SaveArtEmbeddedToSong(&song, art_embedded);
-  LoadAlbumCoverAsync(album_item);
+  ReloadAlbumCover(album_item);
 
 }
 
@@ -1084,3 +1105,66 @@ void AlbumCoverManager::LoadAlbumCoverAsync(AlbumItem *album_item) {
   cover_loading_tasks_.insert(cover_load_id, album_item);
 
 }
+
+void AlbumCoverManager::ReloadAlbumCover(AlbumItem *album_item) {
+
+  // Pending loads are for the old cover.
+  QSet<quint64> cancel_ids;
+  for (QMap<quint64, AlbumItem*>::iterator it = cover_loading_tasks_.begin(); it != cover_loading_tasks_.end();) {
+    if (it.value() == album_item) {
+      cancel_ids.insert(it.key());
+      it = cover_loading_tasks_.erase(it);
+    }
+    else {
+      ++it;
+    }
+  }
+  if (!cancel_ids.isEmpty()) app_->album_cover_loader()->CancelTasks(cancel_ids);
+
+  album_item->cover_loaded = false;
+  album_item->cover_missing = false;
+
+  timer_load_visible_covers_->start();
+
+}
+
+// Covers are loaded for the visible albums and for a page above and below them.
+// The covers of the other albums are unloaded and their pending loads are cancelled, so only a few pages of covers are kept at a time.
+void AlbumCoverManager::LoadVisibleCovers() {
+
+  const QRect viewport_rect = ui_->albums->viewport()->rect();
+  const QRect load_rect = viewport_rect.adjusted(0, -viewport_rect.height(), 0, viewport_rect.height());
+
+  QSet<AlbumItem*> loading_items;
+  for (AlbumItem *album_item : std::as_const(cover_loading_tasks_)) {
+    loading_items.insert(album_item);
+  }
+
+  QSet<AlbumItem*> visible_items;
+  for (int i = 0; i < ui_->albums->count(); ++i) {
+    AlbumItem *album_item = static_cast<AlbumItem*>(ui_->albums->item(i));
+    if (!album_item->isHidden() && ItemHasCover(*album_item) && ui_->albums->visualItemRect(album_item).intersects(load_rect)) {
+      visible_items.insert(album_item);
+      if (!album_item->cover_loaded && !loading_items.contains(album_item)) {
+        LoadAlbumCoverAsync(album_item);
+      }
+    }
+    else if (album_item->icon().cacheKey() != icon_nocover_item_.cacheKey()) {
+      album_item->setIcon(icon_nocover_item_);
+      album_item->cover_loaded = false;
+    }
+  }
+
+  QSet<quint64> cancel_ids;
+  for (QMap<quint64, AlbumItem*>::iterator it = cover_loading_tasks_.begin(); it != cover_loading_tasks_.end();) {
+    if (visible_items.contains(it.value())) {
+      ++it;
+    }
+    else {
+      cancel_ids.insert(it.key());
+      it = cover_loading_tasks_.erase(it);
+    }
+  }
+  if (!cancel_ids.isEmpty()) app_->album_cover_loader()->CancelTasks(cancel_ids);
+
+}
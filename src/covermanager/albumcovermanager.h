@@ -50,6 +50,7 @@ class QMenu;
 class QAction;
 class QProgressBar;
 class QPushButton;
+class QTimer;
 class QEvent;
 class QCloseEvent;
 class QShowEvent;
@@ -66,8 +67,12 @@ class Ui_CoverManager;
 
 class AlbumItem : public QListWidgetItem {
  public:
-  AlbumItem(const QIcon &icon, const QString &text, QListWidget *parent = nullptr, int type = Type) : QListWidgetItem(icon, text, parent, type) {};
+  AlbumItem(const QIcon &icon, const QString &text, QListWidget *parent = nullptr, int type = Type) : QListWidgetItem(icon, text, parent, type), cover_loaded(false), cover_missing(false) {};
   QList<QUrl> urls;
+  // The icon has the current cover, covers are only kept for the albums near the visible part of the list.
+  bool cover_loaded;
+  // The cover couldn't be loaded, so the album is counted as an album without a cover.
+  bool cover_missing;
 
  private:
   Q_DISABLE_COPY(AlbumItem)
@@ -148,6 +153,7 @@ class AlbumCoverManager : public QMainWindow {
   bool ItemHasCover(const AlbumItem &album_item) const;
 
   void LoadAlbumCoverAsync(AlbumItem *album_item);
+  void ReloadAlbumCover(AlbumItem *album_item);
 
  signals:
   void Error(const QString &error);
@@ -161,6 +167,7 @@ class AlbumCoverManager : public QMainWindow {
   void ExportCovers();
   void AlbumCoverFetched(const quint64 id, const AlbumCoverImageResult &result, const CoverSearchStatistics &statistics);
   void CancelRequests();
+  void LoadVisibleCovers();
 
   // On the context menu
   void FetchSingleCover();
@@ -187,6 +194,7 @@ class AlbumCoverManager : public QMainWindow {
  private:
   static const char *kSettingsGroup;
   static const int kThumbnailSize;
+  static const int kLoadVisibleCoversDelayMsec;
 
   Ui_CoverManager *ui_;
   QMainWindow *mainwindow_;
@@ -199,6 +207,7 @@ class AlbumCoverManager : public QMainWindow {
   QAction *filter_without_covers_;
 
   QMap<quint64, AlbumItem*> cover_loading_tasks_;
+  QTimer *timer_load_visible_covers_;
 
   AlbumCoverFetcher *cover_fetcher_;
   QMap<quint64, AlbumItem*> cover_fetching_tasks_;
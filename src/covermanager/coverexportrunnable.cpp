@@ -24,9 +24,13 @@
 #include <utility>
 
 #include <QFile>
+#include <QFileInfo>
+#include <QBuffer>
+#include <QByteArray>
 #include <QSize>
 #include <QString>
 #include <QImage>
+#include <QImageReader>
 
 #include "core/song.h"
 #include "core/tagreaderclient.h"
@@ -44,194 +48,176 @@ void CoverExportRunnable::run() {
 
   if (song_.art_unset() || (!song_.art_embedded() && !song_.art_automatic_is_valid() && !song_.art_manual_is_valid())) {
     EmitCoverSkipped();
+    return;
   }
-  else {
-    if (dialog_result_.RequiresCoverProcessing()) {
-      ProcessAndExportCover();
-    }
-    else {
-      ExportCover();
-    }
+
+  Cover cover;
+  if (!LoadCover(&cover)) {
+    EmitCoverSkipped();
+    return;
   }
 
-}
+  ExportCover(cover);
 
-// Exports a single album cover using a "save QImage to file" approach.
-// For performance reasons this method will be invoked only if loading and in memory processing of images is necessary for current settings which means that:
-// - either the force size flag is being used
-// - or the "overwrite smaller" mode is used
-// In all other cases, the faster ExportCover() method will be used.
-void CoverExportRunnable::ProcessAndExportCover() {
+}
 
-  QImage image;
-  QString extension;
+// Finds the cover to export without decoding it, only the header is read to get the format and size.
+bool CoverExportRunnable::LoadCover(Cover *cover) {
 
   for (const AlbumCoverLoaderOptions::Type cover_type : std::as_const(cover_types_)) {
     switch (cover_type) {
       case AlbumCoverLoaderOptions::Type::Unset:
         if (song_.art_unset()) {
-          EmitCoverSkipped();
-          return;
+          return false;
         }
         break;
       case AlbumCoverLoaderOptions::Type::Embedded:
         if (song_.art_embedded() && dialog_result_.export_embedded_) {
-          image = TagReaderClient::Instance()->LoadEmbeddedArtAsImageBlocking(song_.url().toLocalFile());
-          if (!image.isNull()) {
-            extension = QStringLiteral("jpg");
+          QByteArray data = TagReaderClient::Instance()->LoadEmbeddedArtBlocking(song_.url().toLocalFile(), TagReaderClient::Priority::Background);
+          if (!data.isEmpty()) {
+            QBuffer buffer(&data);
+            buffer.open(QIODevice::ReadOnly);
+            QImageReader reader(&buffer);
+            if (reader.canRead()) {
+              cover->format = reader.format();
+              cover->size = reader.size();
+              cover->data = data;
+              cover->extension = QStringLiteral("jpg");
+              return true;
+            }
           }
         }
         break;
       case AlbumCoverLoaderOptions::Type::Manual:
         if (dialog_result_.export_downloaded_ && song_.art_manual_is_valid()) {
-          const QString cover_path = song_.art_manual().toLocalFile();
-          if (image.load(cover_path)) {
-            extension = cover_path.section(QLatin1Char('.'), -1);
-          }
+          if (LoadCoverFile(song_.art_manual().toLocalFile(), cover)) return true;
         }
         break;
       case AlbumCoverLoaderOptions::Type::Automatic:
         if (dialog_result_.export_downloaded_ && song_.art_automatic_is_valid()) {
-          const QString cover_path = song_.art_automatic().toLocalFile();
-          if (image.load(cover_path)) {
-            extension = cover_path.section(QLatin1Char('.'), -1);
-          }
+          if (LoadCoverFile(song_.art_automatic().toLocalFile(), cover)) return true;
         }
         break;
     }
-    if (!image.isNull() && !extension.isEmpty()) break;
   }
 
-  if (image.isNull() || extension.isEmpty()) {
-    EmitCoverSkipped();
-    return;
-  }
+  return false;
+
+}
+
+bool CoverExportRunnable::LoadCoverFile(const QString &cover_path, Cover *cover) {
+
+  QImageReader reader(cover_path);
+  if (!reader.canRead()) return false;
+
+  const QString extension = cover_path.section(QLatin1Char('.'), -1);
+  if (extension.isEmpty()) return false;
+
+  cover->path = cover_path;
+  cover->format = reader.format();
+  cover->size = reader.size();
+  cover->extension = extension;
+
+  return true;
+
+}
+
+// Covers are only decoded and encoded again when they need to be scaled, or when embedded art that isn't a JPEG is saved as one.
+// All other covers are written as they are, and they are skipped if the destination file already has the same content.
+void CoverExportRunnable::ExportCover(const Cover &cover) {
 
-  // Rescale if necessary
-  if (dialog_result_.IsSizeForced()) {
-    image = image.scaled(QSize(dialog_result_.width_, dialog_result_.height_), Qt::IgnoreAspectRatio);
+  const QSize forced_size = dialog_result_.IsSizeForced() ? QSize(dialog_result_.width_, dialog_result_.height_) : QSize();
+  const bool reencode = (forced_size.isValid() && cover.size != forced_size) || (!cover.data.isEmpty() && cover.format != "jpeg");
+
+  // The image is decoded before the destination is removed, since the destination can be the cover itself.
+  QImage image;
+  if (reencode) {
+    if (cover.data.isEmpty()) {
+      image.load(cover.path);
+    }
+    else {
+      image.loadFromData(cover.data);
+    }
+    if (image.isNull()) {
+      EmitCoverSkipped();
+      return;
+    }
+    if (forced_size.isValid() && image.size() != forced_size) {
+      image = image.scaled(forced_size, Qt::IgnoreAspectRatio);
+    }
   }
 
+  const QSize size = reencode ? image.size() : cover.size;
+
   QString cover_dir = song_.url().toLocalFile().section(QLatin1Char('/'), 0, -2);
-  QString new_file = cover_dir + QLatin1Char('/') + dialog_result_.filename_ + QLatin1Char('.') + (song_.art_embedded() ? QStringLiteral("jpg") : extension);
+  QString new_file = cover_dir + QLatin1Char('/') + dialog_result_.filename_ + QLatin1Char('.') + cover.extension;
 
-  // If the file exists, do not override!
-  if (dialog_result_.overwrite_ == AlbumCoverExport::OverwriteMode::None && QFile::exists(new_file)) {
-    EmitCoverSkipped();
-    return;
-  }
+  if (QFile::exists(new_file)) {
 
-  // We're handling overwrite as remove + copy so we need to delete the old file first
-  if (QFile::exists(new_file) && dialog_result_.overwrite_ != AlbumCoverExport::OverwriteMode::None) {
+    // If the file exists, do not override!
+    if (dialog_result_.overwrite_ == AlbumCoverExport::OverwriteMode::None) {
+      EmitCoverSkipped();
+      return;
+    }
 
-    // if the mode is "overwrite smaller" then skip the cover if a bigger one is already available in the folder
-    if (dialog_result_.overwrite_ == AlbumCoverExport::OverwriteMode::Smaller) {
-      QImage image_existing;
-      image_existing.load(new_file);
+    if (!reencode && DestinationMatches(cover, new_file)) {
+      EmitCoverSkipped();
+      return;
+    }
 
-      if (image_existing.isNull() || image_existing.size().height() >= image.size().height() || image_existing.size().width() >= image.size().width()) {
+    // If the mode is "overwrite smaller" then skip the cover if a bigger one is already available in the folder
+    if (dialog_result_.overwrite_ == AlbumCoverExport::OverwriteMode::Smaller) {
+      const QSize existing_size = QImageReader(new_file).size();
+      if (!existing_size.isValid() || !size.isValid() || existing_size.height() >= size.height() || existing_size.width() >= size.width()) {
         EmitCoverSkipped();
         return;
       }
     }
 
+    // We're handling overwrite as remove + copy so we need to delete the old file first
     if (!QFile::remove(new_file)) {
       EmitCoverSkipped();
       return;
     }
+
   }
 
-  if (image.save(new_file)) {
-    EmitCoverExported();
+  bool success = false;
+  if (reencode) {
+    success = image.save(new_file);
+  }
+  else if (!cover.data.isEmpty()) {
+    QFile file(new_file);
+    success = file.open(QIODevice::WriteOnly) && file.write(cover.data) == cover.data.size();
   }
   else {
-    EmitCoverSkipped();
+    // Automatic or manual cover, available in an image file
+    success = QFile::copy(cover.path, new_file);
   }
 
-}
-
-// Exports a single album cover using a "copy file" approach.
-void CoverExportRunnable::ExportCover() {
-
-  QImage image;
-  QString extension;
-  QString cover_path;
-  bool embedded_cover = false;
-
-  for (const AlbumCoverLoaderOptions::Type cover_type : std::as_const(cover_types_)) {
-    switch (cover_type) {
-      case AlbumCoverLoaderOptions::Type::Unset:
-        if (song_.art_unset()) {
-          EmitCoverSkipped();
-          return;
-        }
-        break;
-      case AlbumCoverLoaderOptions::Type::Embedded:
-        if (song_.art_embedded() && dialog_result_.export_embedded_) {
-          image = TagReaderClient::Instance()->LoadEmbeddedArtAsImageBlocking(song_.url().toLocalFile());
-          if (!image.isNull()) {
-            embedded_cover = true;
-            extension = QStringLiteral("jpg");
-          }
-        }
-        break;
-      case AlbumCoverLoaderOptions::Type::Manual:
-        if (dialog_result_.export_downloaded_ && song_.art_manual_is_valid()) {
-          cover_path = song_.art_manual().toLocalFile();
-          if (image.load(cover_path)) {
-            extension = cover_path.section(QLatin1Char('.'), -1);
-          }
-        }
-        break;
-      case AlbumCoverLoaderOptions::Type::Automatic:
-        if (dialog_result_.export_downloaded_ && song_.art_automatic_is_valid()) {
-          cover_path = song_.art_automatic().toLocalFile();
-          if (image.load(cover_path)) {
-            extension = cover_path.section(QLatin1Char('.'), -1);
-          }
-        }
-        break;
-    }
-    if (!image.isNull() && !extension.isEmpty() && (embedded_cover || !cover_path.isEmpty())) break;
+  if (success) {
+    EmitCoverExported();
   }
-
-  if (image.isNull() || extension.isEmpty()) {
+  else {
     EmitCoverSkipped();
-    return;
   }
 
-  QString cover_dir = song_.url().toLocalFile().section(QLatin1Char('/'), 0, -2);
-  QString new_file = cover_dir + QLatin1Char('/') + dialog_result_.filename_ + QLatin1Char('.') + extension;
+}
 
-  // If the file exists, do not override!
-  if (dialog_result_.overwrite_ == AlbumCoverExport::OverwriteMode::None && QFile::exists(new_file)) {
-    EmitCoverSkipped();
-    return;
-  }
+bool CoverExportRunnable::DestinationMatches(const Cover &cover, const QString &new_file) {
 
-  // We're handling overwrite as remove + copy so we need to delete the old file first
-  if (dialog_result_.overwrite_ != AlbumCoverExport::OverwriteMode::None && QFile::exists(new_file)) {
-    if (!QFile::remove(new_file)) {
-      EmitCoverSkipped();
-      return;
-    }
-  }
+  const qint64 cover_size = cover.data.isEmpty() ? QFileInfo(cover.path).size() : cover.data.size();
+  if (QFileInfo(new_file).size() != cover_size) return false;
 
-  if (embedded_cover) {
-    if (!image.save(new_file)) {
-      EmitCoverSkipped();
-      return;
-    }
-  }
-  else {
-    // Automatic or manual cover, available in an image file
-    if (!QFile::copy(cover_path, new_file)) {
-      EmitCoverSkipped();
-      return;
-    }
-  }
+  if (!cover.path.isEmpty() && QFileInfo(cover.path).canonicalFilePath() == QFileInfo(new_file).canonicalFilePath()) return true;
+
+  QFile file(new_file);
+  if (!file.open(QIODevice::ReadOnly)) return false;
+  if (!cover.data.isEmpty()) return file.readAll() == cover.data;
 
-  EmitCoverExported();
+  QFile cover_file(cover.path);
+  if (!cover_file.open(QIODevice::ReadOnly)) return false;
+  return file.readAll() == cover_file.readAll();
 
 }
 
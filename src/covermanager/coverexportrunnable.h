@@ -26,7 +26,9 @@
 
 #include <QObject>
 #include <QRunnable>
+#include <QByteArray>
 #include <QString>
+#include <QSize>
 
 #include "core/song.h"
 #include "albumcoverloaderoptions.h"
@@ -48,8 +50,18 @@ class CoverExportRunnable : public QObject, public QRunnable {
   void EmitCoverExported();
   void EmitCoverSkipped();
 
-  void ProcessAndExportCover();
-  void ExportCover();
+  struct Cover {
+    QString path;
+    QByteArray data;
+    QByteArray format;
+    QSize size;
+    QString extension;
+  };
+
+  bool LoadCover(Cover *cover);
+  static bool LoadCoverFile(const QString &cover_path, Cover *cover);
+  void ExportCover(const Cover &cover);
+  static bool DestinationMatches(const Cover &cover, const QString &new_file);
 
   AlbumCoverExport::DialogResult dialog_result_;
   AlbumCoverLoaderOptions::Types cover_types_;
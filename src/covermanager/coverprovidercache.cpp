@@ -0,0 +1,227 @@
+/*
+ * Strawberry Music Player
+ *
+ * Strawberry is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Strawberry is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Strawberry.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#include "config.h"
+
+#include <utility>
+#include <chrono>
+
+#include <QtGlobal>
+#include <QObject>
+#include <QTimer>
+#include <QMutexLocker>
+#include <QDateTime>
+#include <QHash>
+#include <QSet>
+#include <QString>
+#include <QUrl>
+#include <QSize>
+#include <QJsonDocument>
+#include <QJsonArray>
+#include <QJsonObject>
+#include <QJsonValue>
+#include <QSqlDatabase>
+
+#include "core/logging.h"
+#include "core/shared_ptr.h"
+#include "core/database.h"
+#include "core/sqlquery.h"
+#include "core/scopedtransaction.h"
+#include "coverprovidercache.h"
+
+using namespace std::chrono_literals;
+
+const int CoverProviderCache::kResultsMaxAgeDays = 30;
+const int CoverProviderCache::kMissMaxAgeDays = 7;
+
+CoverProviderCache::CoverProviderCache(SharedPtr<Database> db, QObject *parent)
+    : QObject(parent),
+      db_(db),
+      timer_flush_(new QTimer(this)),
+      loaded_(false) {
+
+  timer_flush_->setSingleShot(true);
+  timer_flush_->setInterval(10s);
+  QObject::connect(timer_flush_, &QTimer::timeout, this, &CoverProviderCache::Flush);
+
+}
+
+CoverProviderCache::~CoverProviderCache() {
+
+  Flush();
+
+}
+
+QString CoverProviderCache::Key(const QString &provider, const QString &artist, const QString &album, const QString &title) {
+
+  return provider + QLatin1Char('\n') + artist.toLower() + QLatin1Char('\n') + album.toLower() + QLatin1Char('\n') + title.toLower();
+
+}
+
+bool CoverProviderCache::Expired(const Lookup &lookup, const qint64 now) {
+
+  // Misses are asked again sooner, the provider could have added the album.
+  const int max_age_days = lookup.results.isEmpty() ? kMissMaxAgeDays : kResultsMaxAgeDays;
+  return now - lookup.time > static_cast<qint64>(max_age_days) * 86400;
+
+}
+
+QString CoverProviderCache::ResultsToJson(const CoverProviderSearchResults &results) {
+
+  QJsonArray array;
+  for (const CoverProviderSearchResult &result : results) {
+    QJsonObject object;
+    object[QLatin1String("artist")] = result.artist;
+    object[QLatin1String("album")] = result.album;
+    object[QLatin1String("image_url")] = result.image_url.toString();
+    object[QLatin1String("width")] = result.image_size.width();
+    object[QLatin1String("height")] = result.image_size.height();
+    object[QLatin1String("number")] = result.number;
+    array.append(object);
+  }
+
+  return QString::fromUtf8(QJsonDocument(array).toJson(QJsonDocument::Compact));
+
+}
+
+CoverProviderSearchResults CoverProviderCache::ResultsFromJson(const QString &json) {
+
+  CoverProviderSearchResults results;
+  const QJsonArray array = QJsonDocument::fromJson(json.toUtf8()).array();
+  for (const QJsonValue &value : array) {
+    const QJsonObject object = value.toObject();
+    CoverProviderSearchResult result;
+    result.artist = object[QLatin1String("artist")].toString();
+    result.album = object[QLatin1String("album")].toString();
+    result.image_url = QUrl(object[QLatin1String("image_url")].toString());
+    result.image_size = QSize(object[QLatin1String("width")].toInt(), object[QLatin1String("height")].toInt());
+    result.number = object[QLatin1String("number")].toInt();
+    results << result;
+  }
+
+  return results;
+
+}
+
+void CoverProviderCache::Load() {
+
+  loaded_ = true;
+
+  QMutexLocker l(db_->Mutex());
+  QSqlDatabase db(db_->Connect());
+
+  const qint64 now = QDateTime::currentSecsSinceEpoch();
+
+  {
+    SqlQuery q(db);
+    q.prepare(QStringLiteral("DELETE FROM cover_provider_lookups WHERE time < :results_time OR ((results IS NULL OR results = '[]') AND time < :miss_time)"));
+    q.BindValue(QStringLiteral(":results_time"), now - static_cast<qint64>(kResultsMaxAgeDays) * 86400);
+    q.BindValue(QStringLiteral(":miss_time"), now - static_cast<qint64>(kMissMaxAgeDays) * 86400);
+    if (!q.Exec()) {
+      db_->ReportErrors(q);
+    }
+  }
+
+  SqlQuery q(db);
+  q.setForwardOnly(true);
+  q.prepare(QStringLiteral("SELECT provider, artist, album, title, results, duration, time FROM cover_provider_lookups"));
+  if (!q.Exec()) {
+    db_->ReportErrors(q);
+    return;
+  }
+
+  while (q.next()) {
+    Entry entry;
+    entry.provider = q.value(0).toString();
+    entry.artist = q.value(1).toString();
+    entry.album = q.value(2).toString();
+    entry.title = q.value(3).toString();
+    entry.lookup.results = ResultsFromJson(q.value(4).toString());
+    entry.lookup.duration_msec = q.value(5).toLongLong();
+    entry.lookup.time = q.value(6).toLongLong();
+    entries_.insert(Key(entry.provider, entry.artist, entry.album, entry.title), entry);
+  }
+
+  qLog(Debug) << "Loaded" << entries_.count() << "cover provider lookups";
+
+}
+
+bool CoverProviderCache::Find(const QString &provider, const QString &artist, const QString &album, const QString &title, Lookup *lookup) {
+
+  if (!loaded_) Load();
+
+  const QHash<QString, Entry>::const_iterator it = entries_.constFind(Key(provider, artist, album, title));
+  if (it == entries_.constEnd() || Expired(it->lookup, QDateTime::currentSecsSinceEpoch())) return false;
+
+  *lookup = it->lookup;
+  return true;
+
+}
+
+void CoverProviderCache::Insert(const QString &provider, const QString &artist, const QString &album, const QString &title, const CoverProviderSearchResults &results, const qint64 duration_msec) {
+
+  if (!loaded_) Load();
+
+  Entry entry;
+  entry.provider = provider;
+  entry.artist = artist;
+  entry.album = album;
+  entry.title = title;
+  entry.lookup.results = results;
+  entry.lookup.duration_msec = duration_msec;
+  entry.lookup.time = QDateTime::currentSecsSinceEpoch();
+
+  const QString key = Key(provider, artist, album, title);
+  entries_.insert(key, entry);
+  unsaved_keys_.insert(key);
+
+  if (!timer_flush_->isActive()) timer_flush_->start();
+
+}
+
+void CoverProviderCache::Flush() {
+
+  timer_flush_->stop();
+
+  if (unsaved_keys_.isEmpty()) return;
+
+  QMutexLocker l(db_->Mutex());
+  QSqlDatabase db(db_->Connect());
+
+  ScopedTransaction transaction(&db);
+  SqlQuery q(db);
+  q.prepare(QStringLiteral("INSERT OR REPLACE INTO cover_provider_lookups (provider, artist, album, title, results, duration, time) VALUES (:provider, :artist, :album, :title, :results, :duration, :time)"));
+  for (const QString &key : std::as_const(unsaved_keys_)) {
+    const Entry entry = entries_.value(key);
+    q.BindValue(QStringLiteral(":provider"), entry.provider);
+    q.BindValue(QStringLiteral(":artist"), entry.artist.toLower());
+    q.BindValue(QStringLiteral(":album"), entry.album.toLower());
+    q.BindValue(QStringLiteral(":title"), entry.title.toLower());
+    q.BindValue(QStringLiteral(":results"), ResultsToJson(entry.lookup.results));
+    q.BindValue(QStringLiteral(":duration"), entry.lookup.duration_msec);
+    q.BindValue(QStringLiteral(":time"), entry.lookup.time);
+    if (!q.Exec()) {
+      db_->ReportErrors(q);
+      return;
+    }
+  }
+  transaction.Commit();
+
+  unsaved_keys_.clear();
+
+}
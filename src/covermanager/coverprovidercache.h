@@ -0,0 +1,85 @@
+/*
+ * Strawberry Music Player
+ *
+ * Strawberry is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Strawberry is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Strawberry.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#ifndef COVERPROVIDERCACHE_H
+#define COVERPROVIDERCACHE_H
+
+#include "config.h"
+
+#include <QtGlobal>
+#include <QObject>
+#include <QHash>
+#include <QSet>
+#include <QString>
+
+#include "core/shared_ptr.h"
+#include "albumcoverfetcher.h"
+
+class QTimer;
+class Database;
+
+// Remembers what each cover provider returned for an artist, album and title, including when it found nothing.
+// Fetching missing covers again doesn't ask the providers about the albums they were asked about recently.
+// The lookups are loaded from the database the first time they're needed, and new ones are written in batches.
+class CoverProviderCache : public QObject {
+  Q_OBJECT
+
+ public:
+  explicit CoverProviderCache(SharedPtr<Database> db, QObject *parent = nullptr);
+  ~CoverProviderCache() override;
+
+  static const int kResultsMaxAgeDays;
+  static const int kMissMaxAgeDays;
+
+  struct Lookup {
+    Lookup() : duration_msec(0), time(0) {}
+    CoverProviderSearchResults results;
+    // How long the provider took, that's the time saved when the lookup is used.
+    qint64 duration_msec;
+    qint64 time;
+  };
+
+  bool Find(const QString &provider, const QString &artist, const QString &album, const QString &title, Lookup *lookup);
+  void Insert(const QString &provider, const QString &artist, const QString &album, const QString &title, const CoverProviderSearchResults &results, const qint64 duration_msec);
+
+ public slots:
+  void Flush();
+
+ private:
+  struct Entry {
+    QString provider;
+    QString artist;
+    QString album;
+    QString title;
+    Lookup lookup;
+  };
+
+  static QString Key(const QString &provider, const QString &artist, const QString &album, const QString &title);
+  static bool Expired(const Lookup &lookup, const qint64 now);
+  static QString ResultsToJson(const CoverProviderSearchResults &results);
+  static CoverProviderSearchResults ResultsFromJson(const QString &json);
+  void Load();
+
+  SharedPtr<Database> db_;
+  QTimer *timer_flush_;
+  bool loaded_;
+  QHash<QString, Entry> entries_;
+  QSet<QString> unsaved_keys_;
+};
+
+#endif  // COVERPROVIDERCACHE_H
@@ -35,6 +35,7 @@
 #include "core/settings.h"
 #include "coverprovider.h"
 #include "coverproviders.h"
+#include "coverprovidercache.h"
 
 #include "settings/coverssettingspage.h"
 
@@ -44,6 +45,8 @@ CoverProviders::CoverProviders(QObject *parent) : QObject(parent) {}
 
 CoverProviders::~CoverProviders() {
 
+  cache_.reset();
+
   while (!cover_providers_.isEmpty()) {
     delete cover_providers_.firstKey();
   }
@@ -139,3 +142,9 @@ void CoverProviders::ProviderDestroyed() {
 }
 
 int CoverProviders::NextId() { return next_id_.fetchAndAddRelaxed(1); }
+
+void CoverProviders::InitCache(SharedPtr<Database> db) {
+
+  cache_.reset(new CoverProviderCache(db));
+
+}
@@ -32,7 +32,12 @@
 #include <QString>
 #include <QAtomicInt>
 
+#include "core/shared_ptr.h"
+#include "core/scoped_ptr.h"
+
+class Database;
 class CoverProvider;
+class CoverProviderCache;
 
 // This is a repository for cover providers.
 // Providers are automatically unregistered from the repository when they are deleted.  The class is thread safe.
@@ -59,6 +64,10 @@ class CoverProviders : public QObject {
 
   int NextId();
 
+  // The lookups of the providers are cached in the database.
+  void InitCache(SharedPtr<Database> db);
+  CoverProviderCache *cache() const { return cache_.get(); }
+
  private slots:
   void ProviderDestroyed();
 
@@ -71,6 +80,8 @@ class CoverProviders : public QObject {
   QMutex mutex_;
 
   QAtomicInt next_id_;
+
+  ScopedPtr<CoverProviderCache> cache_;
 };
 
 #endif  // COVERPROVIDERS_H
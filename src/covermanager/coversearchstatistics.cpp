@@ -33,7 +33,9 @@ CoverSearchStatistics::CoverSearchStatistics()
       chosen_images_(0),
       missing_images_(0),
       chosen_width_(0),
-      chosen_height_(0) {}
+      chosen_height_(0),
+      cached_lookups_(0),
+      time_saved_msec_(0) {}
 
 CoverSearchStatistics &CoverSearchStatistics::operator+=(const CoverSearchStatistics &other) {
 
@@ -55,6 +57,9 @@ CoverSearchStatistics &CoverSearchStatistics::operator+=(const CoverSearchStatis
   chosen_width_ += other.chosen_width_;
   chosen_height_ += other.chosen_height_;
 
+  cached_lookups_ += other.cached_lookups_;
+  time_saved_msec_ += other.time_saved_msec_;
+
   return *this;
 
 }
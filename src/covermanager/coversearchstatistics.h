@@ -45,6 +45,10 @@ struct CoverSearchStatistics {
   quint64 chosen_width_;
   quint64 chosen_height_;
 
+  // Provider lookups that were answered from the cache, and how long the providers took for them.
+  quint64 cached_lookups_;
+  quint64 time_saved_msec_;
+
   QString AverageDimensions() const;
 };
 
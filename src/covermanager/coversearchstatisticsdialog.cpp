@@ -32,6 +32,7 @@
 #include <QFrame>
 
 #include "utilities/strutils.h"
+#include "utilities/timeutils.h"
 #include "coversearchstatistics.h"
 #include "coversearchstatisticsdialog.h"
 #include "ui_coversearchstatisticsdialog.h"
@@ -79,6 +80,8 @@ void CoverSearchStatisticsDialog::Show(const CoverSearchStatistics &statistics)
   }
 
   AddLine(tr("Total network requests made"), QString::number(statistics.network_requests_made_));
+  AddLine(tr("Provider lookups from the cache"), QString::number(statistics.cached_lookups_));
+  AddLine(tr("Time saved by the cache"), Utilities::WordyTime(statistics.time_saved_msec_ / 1000));
   AddLine(tr("Average image size"), statistics.AverageDimensions());
   AddLine(tr("Total bytes transferred"), statistics.bytes_transferred_ > 0 ? Utilities::PrettySize(statistics.bytes_transferred_) : QStringLiteral("0 bytes"));
 
@@ -28,7 +28,6 @@
 #include <QString>
 #include <QUrl>
 #include <QUrlQuery>
-#include <QTimer>
 #include <QNetworkRequest>
 #include <QNetworkReply>
 #include <QJsonDocument>
@@ -39,6 +38,7 @@
 #include "core/shared_ptr.h"
 #include "core/application.h"
 #include "core/networkaccessmanager.h"
+#include "core/networkrequestscheduler.h"
 #include "core/logging.h"
 #include "albumcoverfetcher.h"
 #include "jsoncoverprovider.h"
@@ -48,18 +48,10 @@ namespace {
 constexpr char kReleaseSearchUrl[] = "https://musicbrainz.org/ws/2/release/";
 constexpr char kAlbumCoverUrl[] = "https://coverartarchive.org/release/%1/front";
 constexpr int kLimit = 8;
-constexpr int kRequestsDelay = 1000;
 }  // namespace
 
 MusicbrainzCoverProvider::MusicbrainzCoverProvider(Application *app, SharedPtr<NetworkAccessManager> network, QObject *parent)
-    : JsonCoverProvider(QStringLiteral("MusicBrainz"), true, false, 1.5, true, false, app, network, parent),
-      timer_flush_requests_(new QTimer(this)) {
-
-  timer_flush_requests_->setInterval(kRequestsDelay);
-  timer_flush_requests_->setSingleShot(false);
-  QObject::connect(timer_flush_requests_, &QTimer::timeout, this, &MusicbrainzCoverProvider::FlushRequests);
-
-}
+    : JsonCoverProvider(QStringLiteral("MusicBrainz"), true, false, 1.5, true, false, app, network, parent) {}
 
 MusicbrainzCoverProvider::~MusicbrainzCoverProvider() {
 
@@ -78,12 +70,9 @@ bool MusicbrainzCoverProvider::StartSearch(const QString &artist, const QString
 
   if (artist.isEmpty() || album.isEmpty()) return false;
 
+  // Cover searches are background requests, so they wait while tags are being fetched from MusicBrainz.
   SearchRequest request(id, artist, album);
-  queue_search_requests_ << request;
-
-  if (!timer_flush_requests_->isActive()) {
-    timer_flush_requests_->start();
-  }
+  network_->scheduler()->Schedule(QUrl(QString::fromLatin1(kReleaseSearchUrl)), NetworkRequestScheduler::Priority::Background, this, [this, request]() { SendSearchRequest(request); });
 
   return true;
 
@@ -108,17 +97,6 @@ void MusicbrainzCoverProvider::SendSearchRequest(const SearchRequest &request) {
 
 }
 
-void MusicbrainzCoverProvider::FlushRequests() {
-
-  if (!queue_search_requests_.isEmpty()) {
-    SendSearchRequest(queue_search_requests_.dequeue());
-    return;
-  }
-
-  timer_flush_requests_->stop();
-
-}
-
 void MusicbrainzCoverProvider::HandleSearchReply(QNetworkReply *reply, const int search_id) {
 
   if (!replies_.contains(reply)) return;
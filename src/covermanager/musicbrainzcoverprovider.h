@@ -24,7 +24,6 @@
 
 #include <QObject>
 #include <QList>
-#include <QQueue>
 #include <QByteArray>
 #include <QVariant>
 #include <QString>
@@ -34,7 +33,6 @@
 #include "jsoncoverprovider.h"
 
 class QNetworkReply;
-class QTimer;
 class Application;
 class NetworkAccessManager;
 
@@ -48,7 +46,6 @@ class MusicbrainzCoverProvider : public JsonCoverProvider {
   bool StartSearch(const QString &artist, const QString &album, const QString &title, const int id) override;
 
  private slots:
-  void FlushRequests();
   void HandleSearchReply(QNetworkReply *reply, const int search_id);
 
  private:
@@ -64,8 +61,6 @@ class MusicbrainzCoverProvider : public JsonCoverProvider {
   void Error(const QString &error, const QVariant &debug = QVariant()) override;
 
  private:
-  QTimer *timer_flush_requests_;
-  QQueue<SearchRequest> queue_search_requests_;
   QList<QNetworkReply*> replies_;
 };
 
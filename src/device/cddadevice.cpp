@@ -64,6 +64,7 @@ void CddaDevice::Refresh() {
 
 void CddaDevice::SongsLoaded(const SongList &songs) {
 
+  songs_ = songs;
   model_->Reset();
   emit SongsDiscovered(songs);
   song_count_ = songs.size();
@@ -54,6 +54,9 @@ class CddaDevice : public ConnectedDevice {
   bool CopyToStorage(const CopyJob&, QString&) override { return false; }
   bool DeleteFromStorage(const MusicStorage::DeleteJob&) override { return false; }
 
+  // The songs of the tracks on the disc.
+  SongList songs() const { return songs_; }
+
   static QStringList url_schemes() { return QStringList() << QStringLiteral("cdda"); }
 
  signals:
@@ -64,6 +67,7 @@ class CddaDevice : public ConnectedDevice {
 
  private:
   CddaSongLoader cdda_song_loader_;
+  SongList songs_;
 };
 
 #endif  // CDDADEVICE_H
@@ -88,8 +88,31 @@ const DeviceInfo::Backend *DeviceInfo::BestBackend() const {
 
 }
 
+void DeviceInfo::SetIcons(const QVariantList &icons, const QString &name_hint) {
+
+  icon_pending_ = true;
+  pending_icons_ = icons;
+  pending_icon_name_hint_ = name_hint;
+
+}
+
+void DeviceInfo::LoadPendingIcon() {
+
+  if (!icon_pending_) return;
+
+  // Copied, since LoadIcon clears them.
+  const QVariantList icons = pending_icons_;
+  const QString name_hint = pending_icon_name_hint_;
+  LoadIcon(icons, name_hint);
+
+}
+
 void DeviceInfo::LoadIcon(const QVariantList &icons, const QString &name_hint) {
 
+  icon_pending_ = false;
+  pending_icons_.clear();
+  pending_icon_name_hint_.clear();
+
   icon_name_ = QStringLiteral("device");
 
   if (icons.isEmpty()) {
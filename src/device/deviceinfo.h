@@ -66,6 +66,7 @@ class DeviceInfo : public SimpleTreeItem<DeviceInfo> {
         size_(0),
         transcode_mode_(MusicStorage::TranscodeMode::Transcode_Unsupported),
         transcode_format_(Song::FileType::Unknown),
+        icon_pending_(false),
         task_percentage_(-1),
         unmount_(false),
         forget_(false) {}
@@ -76,6 +77,7 @@ class DeviceInfo : public SimpleTreeItem<DeviceInfo> {
         size_(0),
         transcode_mode_(MusicStorage::TranscodeMode::Transcode_Unsupported),
         transcode_format_(Song::FileType::Unknown),
+        icon_pending_(false),
         task_percentage_(-1),
         unmount_(false),
         forget_(false) {}
@@ -98,6 +100,10 @@ class DeviceInfo : public SimpleTreeItem<DeviceInfo> {
   // Tries to load a good icon for the device.  Sets icon_name_ and icon_.
   void LoadIcon(const QVariantList &icons, const QString &name_hint);
 
+  // Keeps the icons to load them with LoadPendingIcon when the device is shown, so loading icon themes doesn't slow down startup.
+  void SetIcons(const QVariantList &icons, const QString &name_hint);
+  void LoadPendingIcon();
+
   // Gets the best backend available (the one with the highest priority)
   const Backend *BestBackend() const;
 
@@ -110,6 +116,9 @@ class DeviceInfo : public SimpleTreeItem<DeviceInfo> {
 
   QString icon_name_;
   QIcon icon_;
+  bool icon_pending_;
+  QVariantList pending_icons_;
+  QString pending_icon_name_hint_;
 
   MusicStorage::TranscodeMode transcode_mode_;
   Song::FileType transcode_format_;
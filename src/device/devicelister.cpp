@@ -26,6 +26,7 @@
 #endif
 
 #include <QThread>
+#include <QElapsedTimer>
 #include <QDir>
 #include <QFile>
 #include <QByteArray>
@@ -68,7 +69,15 @@ void DeviceLister::Start() {
 
 }
 
-void DeviceLister::ThreadStarted() { Init(); }
+void DeviceLister::ThreadStarted() {
+
+  // Each lister probes its devices in its own thread, so a slow one doesn't hold up the others.
+  QElapsedTimer timer;
+  timer.start();
+  Init();
+  qLog(Debug) << metaObject()->className() << "found" << DeviceUniqueIDs().count() << "devices in" << timer.elapsed() << "ms";
+
+}
 
 int DeviceLister::MountDeviceAsync(const QString &id) {
 
@@ -251,13 +251,13 @@ void DeviceManager::AddDeviceFromDB(DeviceInfo *info) {
   for (const QString &icon_name : icon_names) {
     icons << icon_name;
   }
-  info->LoadIcon(icons, info->friendly_name_);
+  info->SetIcons(icons, info->friendly_name_);
 
   DeviceInfo *existing = FindEquivalentDevice(info);
   if (existing) {
     qLog(Info) << "Found existing device: " << info->friendly_name_;
     existing->icon_name_ = info->icon_name_;
-    existing->icon_ = info->icon_;
+    existing->SetIcons(icons, info->friendly_name_);
     QModelIndex idx = ItemToIndex(existing);
     if (idx.isValid()) emit dataChanged(idx, idx);
     root_->Delete(info->row);
@@ -296,6 +296,7 @@ QVariant DeviceManager::data(const QModelIndex &idx, int role) const {
     }
 
     case Qt::DecorationRole:{
+      info->LoadPendingIcon();
       QPixmap pixmap = info->icon_.pixmap(kDeviceIconSize);
 
       if (info->backends_.isEmpty() || !info->BestBackend() || !info->BestBackend()->lister_) {
@@ -315,6 +316,7 @@ QVariant DeviceManager::data(const QModelIndex &idx, int role) const {
       return info->BestBackend()->unique_id_;
 
     case Role_IconName:
+      info->LoadPendingIcon();
       return info->icon_name_;
 
     case Role_Capacity:
@@ -472,7 +474,7 @@ void DeviceManager::PhysicalDeviceAdded(const QString &id) {
       if (info->database_id_ == -1 && info->BestBackend() && info->BestBackend()->lister_ == lister) {
         info->friendly_name_ = lister->MakeFriendlyName(id);
         info->size_ = lister->DeviceCapacity(id);
-        info->LoadIcon(lister->DeviceIcons(id), info->friendly_name_);
+        info->SetIcons(lister->DeviceIcons(id), info->friendly_name_);
       }
       QModelIndex idx = ItemToIndex(info);
       if (idx.isValid()) emit dataChanged(idx, idx);
@@ -483,7 +485,7 @@ void DeviceManager::PhysicalDeviceAdded(const QString &id) {
       info->backends_ << DeviceInfo::Backend(lister, id);
       info->friendly_name_ = lister->MakeFriendlyName(id);
       info->size_ = lister->DeviceCapacity(id);
-      info->LoadIcon(lister->DeviceIcons(id), info->friendly_name_);
+      info->SetIcons(lister->DeviceIcons(id), info->friendly_name_);
       beginInsertRows(ItemToIndex(root_), static_cast<int>(devices_.count()), static_cast<int>(devices_.count()));
       devices_ << info;
       endInsertRows();
@@ -584,6 +586,7 @@ SharedPtr<ConnectedDevice> DeviceManager::Connect(DeviceInfo *info) {
   bool first_time = (info->database_id_ == -1);
   if (first_time) {
     // We haven't stored this device in the database before
+    info->LoadPendingIcon();
     info->database_id_ = backend_->AddDevice(info->SaveToDb());
   }
 
@@ -797,7 +800,7 @@ void DeviceManager::RemoveFromDB(DeviceInfo *info, const QModelIndex &idx) {
     const QString id = info->BestBackend()->unique_id_;
 
     info->friendly_name_ = info->BestBackend()->lister_->MakeFriendlyName(id);
-    info->LoadIcon(info->BestBackend()->lister_->DeviceIcons(id), info->friendly_name_);
+    info->SetIcons(info->BestBackend()->lister_->DeviceIcons(id), info->friendly_name_);
     emit dataChanged(idx, idx);
   }
 
@@ -46,6 +46,9 @@
 #include <QFlags>
 #include <QPushButton>
 #include <QMessageBox>
+#include <QFileDialog>
+#include <QDir>
+#include <QFileInfo>
 #include <QtEvents>
 
 #include "core/scoped_ptr.h"
@@ -55,11 +58,14 @@
 #include "core/mergedproxymodel.h"
 #include "core/mimedata.h"
 #include "core/musicstorage.h"
+#include "core/settings.h"
 #include "utilities/colorutils.h"
 #include "organize/organizedialog.h"
 #include "organize/organizeerrordialog.h"
+#include "organize/organizeformat.h"
 #include "collection/collectiondirectorymodel.h"
 #include "collection/collectionmodel.h"
+#include "collection/collectionsortmodel.h"
 #include "collection/collectionitemdelegate.h"
 #include "connecteddevice.h"
 #include "devicelister.h"
@@ -67,8 +73,20 @@
 #include "deviceproperties.h"
 #include "deviceview.h"
 
+#if defined(HAVE_AUDIOCD) && defined(HAVE_GSTREAMER)
+#  include "transcoder/transcoder.h"
+#  include "ripper/ripper.h"
+#  include "cddadevice.h"
+#endif
+
 using std::make_unique;
 
+#if defined(HAVE_AUDIOCD) && defined(HAVE_GSTREAMER)
+namespace {
+constexpr char kRipperSettingsGroup[] = "Ripper";
+}
+#endif
+
 const int DeviceItemDelegate::kIconPadding = 6;
 
 DeviceItemDelegate::DeviceItemDelegate(QObject *parent) : CollectionItemDelegate(parent) {}
@@ -181,6 +199,7 @@ DeviceView::DeviceView(QWidget *parent)
       device_menu_(nullptr),
       eject_action_(nullptr),
       forget_action_(nullptr),
+      rip_action_(nullptr),
       properties_action_(nullptr),
       collection_menu_(nullptr),
       load_action_(nullptr),
@@ -237,6 +256,9 @@ void DeviceView::contextMenuEvent(QContextMenuEvent *e) {
     // Device menu
     eject_action_ = device_menu_->addAction(IconLoader::Load(QStringLiteral("media-eject")), tr("Safely remove device"), this, &DeviceView::Unmount);
     forget_action_ = device_menu_->addAction(IconLoader::Load(QStringLiteral("list-remove")), tr("Forget device"), this, &DeviceView::Forget);
+#if defined(HAVE_AUDIOCD) && defined(HAVE_GSTREAMER)
+    rip_action_ = device_menu_->addAction(IconLoader::Load(QStringLiteral("media-optical")), tr("Rip CD..."), this, &DeviceView::Rip);
+#endif
     device_menu_->addSeparator();
     properties_action_ = device_menu_->addAction(IconLoader::Load(QStringLiteral("configure")), tr("Device properties..."), this, &DeviceView::Properties);
 
@@ -261,6 +283,9 @@ void DeviceView::contextMenuEvent(QContextMenuEvent *e) {
 
     forget_action_->setEnabled(is_remembered);
     eject_action_->setEnabled(is_plugged_in);
+#if defined(HAVE_AUDIOCD) && defined(HAVE_GSTREAMER)
+    rip_action_->setVisible(static_cast<bool>(std::dynamic_pointer_cast<CddaDevice>(app_->device_manager()->GetConnectedDevice(device_index))));
+#endif
 
     device_menu_->popup(e->globalPos());
   }
@@ -321,9 +346,8 @@ void DeviceView::DeviceConnected(const QModelIndex &idx) {
   QModelIndex sort_idx = sort_model_->mapFromSource(idx);
   if (!sort_idx.isValid()) return;
 
-  QSortFilterProxyModel *sort_model = new QSortFilterProxyModel(device->model());
+  QSortFilterProxyModel *sort_model = new CollectionSortModel(device->model());
   sort_model->setSourceModel(device->model());
-  sort_model->setSortRole(CollectionModel::Role_SortText);
   sort_model->setDynamicSortFilter(true);
   sort_model->sort(0);
   merged_model_->AddSubModel(sort_idx, sort_model);
@@ -360,6 +384,58 @@ void DeviceView::Properties() {
   properties_dialog_->ShowDevice(MapToDevice(menu_index_));
 }
 
+#if defined(HAVE_AUDIOCD) && defined(HAVE_GSTREAMER)
+void DeviceView::Rip() {
+
+  SharedPtr<CddaDevice> device = std::dynamic_pointer_cast<CddaDevice>(app_->device_manager()->GetConnectedDevice(MapToDevice(menu_index_)));
+  if (!device) return;
+
+  const SongList songs = device->songs();
+  if (songs.isEmpty()) return;
+
+  Settings s;
+  s.beginGroup(kRipperSettingsGroup);
+  const QString last_output_dir = s.value("last_output_dir", QDir::homePath()).toString();
+  s.endGroup();
+
+  const QString output_dir = QFileDialog::getExistingDirectory(this, tr("Rip CD to"), last_output_dir);
+  if (output_dir.isEmpty()) return;
+
+  s.beginGroup(kRipperSettingsGroup);
+  s.setValue("last_output_dir", output_dir);
+  s.endGroup();
+
+  // Rip to a lossless format, it can be transcoded to anything later without losing quality.
+  const TranscoderPreset preset = Transcoder::PresetForFileType(Song::FileType::FLAC);
+  OrganizeFormat format(QStringLiteral("%albumartist/%album{ (Disc %disc)}/{%track - }%title"));
+  format.set_replace_spaces(false);
+  format.set_remove_problematic(true);
+
+  Ripper *ripper = new Ripper(device->url().path(), app_->task_manager(), this);
+  ripper->SetTrackCount(static_cast<int>(songs.count()));
+  for (const Song &song : songs) {
+    const OrganizeFormat::GetFilenameForSongResult result = format.GetFilenameForSong(song, preset.extension_);
+    const QString output = QDir(output_dir).filePath(result.filename);
+    QDir().mkpath(QFileInfo(output).path());
+    ripper->AddTrack(song, output, preset);
+  }
+  QObject::connect(ripper, &Ripper::Finished, this, &DeviceView::RipFinished);
+  QObject::connect(ripper, &Ripper::Finished, ripper, &Ripper::deleteLater);
+  ripper->Start();
+
+}
+
+void DeviceView::RipFinished(const QStringList &files_with_errors, const QStringList &log) {
+
+  if (files_with_errors.isEmpty()) return;
+
+  OrganizeErrorDialog *dialog = new OrganizeErrorDialog(this);
+  dialog->Show(OrganizeErrorDialog::OperationType::Copy, files_with_errors, log);
+  // It deletes itself when the user closes it
+
+}
+#endif
+
 void DeviceView::mouseDoubleClickEvent(QMouseEvent *e) {
 
   AutoExpandingTreeView::mouseDoubleClickEvent(e);
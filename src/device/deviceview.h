@@ -29,6 +29,7 @@
 #include <QStyleOptionViewItem>
 #include <QAbstractItemModel>
 #include <QString>
+#include <QStringList>
 
 #include "core/scoped_ptr.h"
 #include "core/song.h"
@@ -82,6 +83,10 @@ class DeviceView : public AutoExpandingTreeView {
   void Unmount();
   void Forget();
   void Properties();
+#if defined(HAVE_AUDIOCD) && defined(HAVE_GSTREAMER)
+  void Rip();
+  void RipFinished(const QStringList &files_with_errors, const QStringList &log);
+#endif
 
   // Collection menu actions
   void Load();
@@ -112,6 +117,7 @@ class DeviceView : public AutoExpandingTreeView {
   QMenu *device_menu_;
   QAction *eject_action_;
   QAction *forget_action_;
+  QAction *rip_action_;
   QAction *properties_action_;
 
   QMenu *collection_menu_;
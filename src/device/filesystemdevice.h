@@ -49,6 +49,9 @@ class FilesystemDevice : public ConnectedDevice, public virtual FilesystemMusicS
 
   Song::Source source() const final { return Song::Source::Device; }
 
+  // USB drives and memory cards don't gain much from more parallel writes.
+  int MaxConcurrentCopies() const override { return 2; }
+
   bool Init() override;
   void CloseAsync();
 
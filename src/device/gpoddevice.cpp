@@ -57,6 +57,7 @@ GPodDevice::GPodDevice(const QUrl &url, DeviceLister *lister, const QString &uni
     : ConnectedDevice(url, lister, unique_id, manager, app, database_id, first_time, parent),
       loader_(nullptr),
       loader_thread_(nullptr),
+      connected_from_cache_(false),
       db_(nullptr),
       closing_(false) {}
 
@@ -94,6 +95,12 @@ void GPodDevice::ConnectAsync() {
 
   loader_thread_->start();
 
+  // Show the songs from the last time while the database loads, copies wait for the database in Start().
+  if (!first_time_) {
+    connected_from_cache_ = true;
+    emit DeviceConnectFinished(unique_id_, true);
+  }
+
 }
 
 void GPodDevice::Close() {
@@ -128,7 +135,7 @@ void GPodDevice::LoadFinished(Itdb_iTunesDB *db, const bool success) {
   if (closing_) {
     ConnectedDevice::Close();
   }
-  else {
+  else if (!connected_from_cache_ || !success) {
     emit DeviceConnectFinished(unique_id_, success);
   }
 
@@ -250,13 +257,17 @@ bool GPodDevice::CopyToStorage(const CopyJob &job, QString &error_text) {
 
   // Put the track in the playlist, if one is specified
   if (!job.playlist_.isEmpty()) {
-    // Does the playlist already exist?
-    QByteArray playlist_name = job.playlist_.toUtf8();
-    Itdb_Playlist *playlist = itdb_playlist_by_name(db_, playlist_name.data());
+    Itdb_Playlist *playlist = playlists_.value(job.playlist_, nullptr);
     if (!playlist) {
-      // Create the playlist
-      playlist = itdb_playlist_new(playlist_name.data(), false);
-      itdb_playlist_add(db_, playlist, -1);
+      // Does the playlist already exist?
+      QByteArray playlist_name = job.playlist_.toUtf8();
+      playlist = itdb_playlist_by_name(db_, playlist_name.data());
+      if (!playlist) {
+        // Create the playlist
+        playlist = itdb_playlist_new(playlist_name.data(), false);
+        itdb_playlist_add(db_, playlist, -1);
+      }
+      playlists_.insert(job.playlist_, playlist);
     }
     // Playlist should exist so add the track to the playlist
     itdb_playlist_add_track(playlist, track, -1);
@@ -308,6 +319,8 @@ void GPodDevice::Finish(const bool success) {
   songs_to_add_.clear();
   songs_to_remove_.clear();
   cover_files_.clear();
+  playlists_.clear();
+  tracks_by_ipod_path_.clear();
 
   db_busy_.unlock();
 
@@ -333,15 +346,13 @@ bool GPodDevice::RemoveTrackFromITunesDb(const QString &path, const QString &rel
   ipod_filename.replace(QLatin1Char('/'), QLatin1Char(':'));
 
   // Find the track in the itdb, identify it by its filename
-  Itdb_Track *track = nullptr;
-  for (GList *tracks = db_->tracks; tracks != nullptr; tracks = tracks->next) {
-    Itdb_Track *t = static_cast<Itdb_Track*>(tracks->data);
-
-    if (QString::fromUtf8(t->ipod_path) == ipod_filename) {
-      track = t;
-      break;
+  if (tracks_by_ipod_path_.isEmpty()) {
+    for (GList *tracks = db_->tracks; tracks != nullptr; tracks = tracks->next) {
+      Itdb_Track *t = static_cast<Itdb_Track*>(tracks->data);
+      tracks_by_ipod_path_.insert(QString::fromUtf8(t->ipod_path), t);
     }
   }
+  Itdb_Track *track = tracks_by_ipod_path_.take(ipod_filename);
 
   if (track == nullptr) {
     qLog(Warning) << "Couldn't find song" << path << "in iTunesDB";
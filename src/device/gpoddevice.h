@@ -30,6 +30,8 @@
 #include <QMutex>
 #include <QWaitCondition>
 #include <QList>
+#include <QMap>
+#include <QHash>
 #include <QString>
 #include <QStringList>
 #include <QUrl>
@@ -88,6 +90,8 @@ class GPodDevice : public ConnectedDevice, public virtual MusicStorage {
  protected:
   GPodLoader *loader_;
   QThread *loader_thread_;
+  // Set when the songs from the last connection were shown before the device finished loading.
+  bool connected_from_cache_;
 
   QWaitCondition db_wait_cond_;
   QMutex db_mutex_;
@@ -98,6 +102,10 @@ class GPodDevice : public ConnectedDevice, public virtual MusicStorage {
   SongList songs_to_add_;
   SongList songs_to_remove_;
   QList<SharedPtr<QTemporaryFile>> cover_files_;
+  // The playlists the tracks are added to during this copy, so they aren't looked up in the database for every track.
+  QMap<QString, Itdb_Playlist*> playlists_;
+  // The tracks by iPod path, created on the first delete so removing many tracks doesn't search the whole database for each.
+  QHash<QString, Itdb_Track*> tracks_by_ipod_path_;
 };
 
 #endif  // GPODDEVICE_H
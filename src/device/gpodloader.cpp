@@ -26,6 +26,8 @@
 
 #include <QObject>
 #include <QDir>
+#include <QFileInfo>
+#include <QDateTime>
 #include <QByteArray>
 #include <QString>
 
@@ -33,9 +35,15 @@
 #include "core/shared_ptr.h"
 #include "core/song.h"
 #include "core/taskmanager.h"
+#include "core/settings.h"
 #include "collection/collectionbackend.h"
+#include "connecteddevice.h"
 #include "gpodloader.h"
 
+namespace {
+constexpr char kSettingsGroup[] = "GPodLoader";
+}
+
 GPodLoader::GPodLoader(const QString &mount_point, SharedPtr<TaskManager> task_manager, SharedPtr<CollectionBackend> backend, SharedPtr<ConnectedDevice> device, QObject *parent)
     : QObject(parent),
       device_(device),
@@ -84,6 +92,27 @@ Itdb_iTunesDB *GPodLoader::TryLoad() {
     return db;
   }
 
+  // The database is only written when the device is changed, so if it wasn't changed since it was loaded last time the songs from then are still right.
+  QString itunesdb_mtime;
+  gchar *itunesdb_path = itdb_get_itunesdb_path(mountpoint.constData());
+  if (itunesdb_path) {
+    itunesdb_mtime = QString::number(QFileInfo(QString::fromLocal8Bit(itunesdb_path)).lastModified().toSecsSinceEpoch()) + QLatin1Char(':') + path_prefix_ + QLatin1Char(':') + QString::number(static_cast<int>(type_));
+    g_free(itunesdb_path);
+  }
+  const QString settings_key = device_ ? QString::fromLatin1(device_->unique_id().toUtf8().toHex()) : QString();
+
+  if (!itunesdb_mtime.isEmpty() && !settings_key.isEmpty()) {
+    Settings s;
+    s.beginGroup(kSettingsGroup);
+    const bool unchanged = s.value(settings_key).toString() == itunesdb_mtime;
+    s.endGroup();
+    if (unchanged && !backend_->FindSongsInDirectory(1).isEmpty()) {
+      qLog(Debug) << "iPod database is unchanged since it was last loaded";
+      backend_->Close();
+      return db;
+    }
+  }
+
   // Convert all the tracks from libgpod structs into Song classes
   const QString prefix = path_prefix_.isEmpty() ? QDir::fromNativeSeparators(mount_point_) : path_prefix_;
 
@@ -102,12 +131,16 @@ Itdb_iTunesDB *GPodLoader::TryLoad() {
     songs << song;
   }
 
-  // Need to remove all the existing songs in the database first
-  backend_->DeleteSongs(backend_->FindSongsInDirectory(1));
-
   if (!abort_) {
-    // Add the songs we've just loaded
-    backend_->AddOrUpdateSongs(songs);
+    // The songs from the last time the device was connected are still in the database, only the differences are updated.
+    backend_->ReplaceSongsInDirectory(1, songs);
+
+    if (!itunesdb_mtime.isEmpty() && !settings_key.isEmpty()) {
+      Settings s;
+      s.beginGroup(kSettingsGroup);
+      s.setValue(settings_key, itunesdb_mtime);
+      s.endGroup();
+    }
   }
 
   // This is done in the loader thread so close the unique DB connection.
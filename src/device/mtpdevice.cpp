@@ -53,6 +53,7 @@ MtpDevice::MtpDevice(const QUrl &url, DeviceLister *lister, const QString &uniqu
     : ConnectedDevice(url, lister, unique_id, manager, app, database_id, first_time, parent),
       loader_(nullptr),
       loader_thread_(nullptr),
+      connected_from_cache_(false),
       closing_(false) {
 
   if (!sInitializedLibMTP) {
@@ -97,6 +98,12 @@ void MtpDevice::ConnectAsync() {
   db_busy_.lock();
   loader_thread_->start();
 
+  // Show the songs from the last time while the track listing loads, copies wait for the loader in StartCopy().
+  if (!first_time_) {
+    connected_from_cache_ = true;
+    emit DeviceConnectFinished(unique_id_, true);
+  }
+
 }
 
 void MtpDevice::Close() {
@@ -123,7 +130,7 @@ void MtpDevice::LoadFinished(const bool success, MtpConnection *connection) {
   if (closing_) {
     ConnectedDevice::Close();
   }
-  else {
+  else if (!connected_from_cache_ || !success) {
     emit DeviceConnectFinished(unique_id_, success);
   }
 
@@ -84,6 +84,8 @@ class MtpDevice : public ConnectedDevice {
 
   MtpLoader *loader_;
   QThread *loader_thread_;
+  // Set when the songs from the last connection were shown before the device finished loading.
+  bool connected_from_cache_;
   bool closing_;
 
   QMutex db_busy_;
@@ -98,11 +98,8 @@ bool MtpLoader::TryLoad() {
   }
 
   if (!abort_) {
-    // Need to remove all the existing songs in the database first
-    backend_->DeleteSongs(backend_->FindSongsInDirectory(1));
-
-    // Add the songs we've just loaded
-    backend_->AddOrUpdateSongs(songs);
+    // The songs from the last time the device was connected are still in the database, only the differences are updated.
+    backend_->ReplaceSongsInDirectory(1, songs);
   }
 
   // This is done in the loader thread so close the unique DB connection.
@@ -39,6 +39,10 @@
 #include "core/logging.h"
 #include "core/application.h"
 #include "core/database.h"
+#include "core/memorystats.h"
+#include "core/player.h"
+#include "engine/enginebase.h"
+#include "engine/enginemetrics.h"
 
 Console::Console(Application *app, QWidget *parent) : QDialog(parent), ui_{}, app_(app) {
 
@@ -47,6 +51,8 @@ Console::Console(Application *app, QWidget *parent) : QDialog(parent), ui_{}, ap
   setWindowFlags(windowFlags() | Qt::WindowMaximizeButtonHint);
 
   QObject::connect(ui_.run, &QPushButton::clicked, this, &Console::RunQuery);
+  QObject::connect(ui_.engine_metrics, &QPushButton::clicked, this, &Console::ShowEngineMetrics);
+  QObject::connect(ui_.memory_stats, &QPushButton::clicked, this, &Console::ShowMemoryStats);
 
   QFont font(QStringLiteral("Monospace"));
   font.setStyleHint(QFont::TypeWriter);
@@ -86,3 +92,21 @@ void Console::RunQuery() {
   ui_.output->verticalScrollBar()->setValue(ui_.output->verticalScrollBar()->maximum());
 
 }
+
+void Console::ShowEngineMetrics() {
+
+  if (!app_->player()->engine()) return;
+
+  ui_.output->append(QStringLiteral("<b>&gt; Engine metrics</b>"));
+  ui_.output->append(app_->player()->engine()->metrics().ToString().toHtmlEscaped().replace(QLatin1Char('\n'), QStringLiteral("<br>")));
+  ui_.output->verticalScrollBar()->setValue(ui_.output->verticalScrollBar()->maximum());
+
+}
+
+void Console::ShowMemoryStats() {
+
+  ui_.output->append(QStringLiteral("<b>&gt; Memory usage</b>"));
+  ui_.output->append(memorystats::Report().toHtmlEscaped().replace(QLatin1Char('\n'), QStringLiteral("<br>")));
+  ui_.output->verticalScrollBar()->setValue(ui_.output->verticalScrollBar()->maximum());
+
+}
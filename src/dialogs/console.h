@@ -41,6 +41,8 @@ class Console : public QDialog {
 
  private slots:
   void RunQuery();
+  void ShowEngineMetrics();
+  void ShowMemoryStats();
 
  private:
   Ui::Console ui_;
@@ -27,9 +27,6 @@
 #include <limits>
 
 #include <QtGlobal>
-#include <QtConcurrent>
-#include <QFuture>
-#include <QFutureWatcher>
 #include <QObject>
 #include <QWidget>
 #include <QDialog>
@@ -42,6 +39,7 @@
 #include <QMap>
 #include <QVariant>
 #include <QString>
+#include <QStringList>
 #include <QStringBuilder>
 #include <QUrl>
 #include <QPixmap>
@@ -105,6 +103,7 @@ constexpr char kTagsDifferentHintText[] = QT_TR_NOOP("(different across multiple
 constexpr char kArtDifferentHintText[] = QT_TR_NOOP("Different art across multiple songs.");
 constexpr char kSettingsGroup[] = "EditTagDialog";
 constexpr int kSmallImageSize = 128;
+constexpr int kLoadBatchSize = 16;
 }  // namespace
 
 EditTagDialog::EditTagDialog(Application *app, QWidget *parent)
@@ -119,11 +118,14 @@ EditTagDialog::EditTagDialog(Application *app, QWidget *parent)
       lyrics_fetcher_(new LyricsFetcher(app->lyrics_providers(), this)),
       image_no_cover_thumbnail_(ImageUtils::GenerateNoCoverImage(QSize(128, 128), devicePixelRatioF())),
       loading_(false),
+      load_id_(0),
+      load_next_(0),
       ignore_edits_(false),
       summary_cover_art_id_(-1),
       tags_cover_art_id_(-1),
       cover_art_is_set_(false),
       save_tag_pending_(0),
+      save_tag_count_(0),
       lyrics_id_(-1) {
 
   QObject::connect(&*app_->album_cover_loader(), &AlbumCoverLoader::AlbumCoverLoaded, this, &EditTagDialog::AlbumCoverLoaded);
@@ -141,6 +143,7 @@ EditTagDialog::EditTagDialog(Application *app, QWidget *parent)
   ui_->setupUi(this);
   ui_->splitter->setSizes(QList<int>() << 200 << width() - 200);
   ui_->loading_label->hide();
+  ui_->loading_progress->hide();
   ui_->label_lyrics->hide();
 
   ui_->fetch_tag->setIcon(QPixmap::fromImage(QImage(QStringLiteral(":/pictures/musicbrainz.png"))));
@@ -294,6 +297,9 @@ void EditTagDialog::showEvent(QShowEvent *e) {
 
 void EditTagDialog::hideEvent(QHideEvent *e) {
 
+  // Ignore the songs that are still being loaded.
+  ++load_id_;
+
   // Save the current tab
   Settings s;
   s.beginGroup(kSettingsGroup);
@@ -390,55 +396,93 @@ bool EditTagDialog::SetLoading(const QString &message) {
 
 }
 
-QList<EditTagDialog::Data> EditTagDialog::LoadData(const SongList &songs) {
+void EditTagDialog::SetSongs(const SongList &s, const PlaylistItemPtrList &items) {
 
-  QList<Data> ret;
+  // Show the loading indicator
+  if (!SetLoading(tr("Loading tracks") + QStringLiteral("..."))) return;
 
-  for (const Song &song : songs) {
-    if (song.IsEditable()) {
-      // Try reloading the tags from file
-      Song copy(song);
-      TagReaderClient::Instance()->ReadFileBlocking(copy.url().toLocalFile(), &copy);
-      if (copy.is_valid()) {
-        copy.MergeUserSetData(song, false, false);
-        ret << Data(copy);
-      }
+  data_.clear();
+  playlist_items_ = items;
+  ui_->song_list->clear();
+  collection_songs_.clear();
+
+  const quint64 load_id = ++load_id_;
+  load_songs_.clear();
+  loaded_songs_.clear();
+  load_next_ = 0;
+  for (const Song &song : s) {
+    if (song.IsEditable()) load_songs_ << song;
+  }
+
+  if (load_songs_.isEmpty()) {
+    AddLoadedSongs();
+    return;
+  }
+
+  // Reload tags in the background, the first song is read first so the dialog can show it right away while the others are loading.
+  for (int first = 0; first < load_songs_.count(); first += (first == 0 ? 1 : kLoadBatchSize)) {
+    const int count = first == 0 ? 1 : static_cast<int>(qMin(static_cast<qint64>(kLoadBatchSize), static_cast<qint64>(load_songs_.count() - first)));
+    QStringList filenames;
+    filenames.reserve(count);
+    for (int i = first; i < first + count; ++i) {
+      filenames << load_songs_[i].url().toLocalFile();
     }
+    TagReaderReply *reply = TagReaderClient::Instance()->ReadFiles(filenames, TagReaderClient::ReadLevel::Full, TagReaderClient::Priority::Interactive);
+    QObject::connect(reply, &TagReaderReply::Finished, this, [this, reply, load_id, first, count]() { LoadSongsFinished(reply, load_id, first, count); }, Qt::QueuedConnection);
   }
 
-  return ret;
+  SetProgress(0, static_cast<int>(load_songs_.count()));
 
 }
 
-void EditTagDialog::SetSongs(const SongList &s, const PlaylistItemPtrList &items) {
+void EditTagDialog::LoadSongsFinished(TagReaderReply *reply, const quint64 load_id, const int first, const int count) {
 
-  // Show the loading indicator
-  if (!SetLoading(tr("Loading tracks") + QStringLiteral("..."))) return;
+  reply->deleteLater();
 
-  data_.clear();
-  playlist_items_ = items;
-  ui_->song_list->clear();
-  collection_songs_.clear();
+  if (load_id != load_id_) return;
+
+  int i = first;
+  if (reply->is_successful()) {
+    for (const spb::tagreader::SongMetadata &metadata : reply->message().read_files_response().metadata()) {
+      if (i >= first + count) break;
+      const Song &original_song = load_songs_[i];
+      Song song(original_song);
+      song.InitFromProtobuf(metadata);
+      if (song.is_valid()) {
+        song.MergeUserSetData(original_song, false, false);
+      }
+      loaded_songs_.insert(i++, song);
+    }
+  }
+  // Keep the songs aligned if reading the batch failed.
+  for (; i < first + count; ++i) {
+    loaded_songs_.insert(i, Song());
+  }
 
-  // Reload tags in the background
-  QFuture<QList<Data>> future = QtConcurrent::run(&EditTagDialog::LoadData, s);
-  QFutureWatcher<QList<Data>> *watcher = new QFutureWatcher<QList<Data>>();
-  QObject::connect(watcher, &QFutureWatcher<QList<Data>>::finished, this, &EditTagDialog::SetSongsFinished);
-  watcher->setFuture(future);
+  AddLoadedSongs();
 
 }
 
-void EditTagDialog::SetSongsFinished() {
+void EditTagDialog::AddLoadedSongs() {
 
-  QFutureWatcher<QList<Data>> *watcher = static_cast<QFutureWatcher<QList<Data>>*>(sender());
-  QList<Data> result_data = watcher->result();
-  watcher->deleteLater();
+  const bool first_songs = data_.isEmpty();
 
-  if (!SetLoading(QString())) return;
+  while (loaded_songs_.contains(load_next_)) {
+    const Song song = loaded_songs_.take(load_next_++);
+    if (song.is_valid()) {
+      data_ << Data(song);
+      ui_->song_list->addItem(song.basefilename());
+    }
+  }
+
+  const bool finished = load_next_ >= load_songs_.count();
+  SetProgress(load_next_, static_cast<int>(load_songs_.count()));
 
-  data_ = result_data;
+  if (data_.isEmpty()) {
+    if (!finished) return;
+
+    if (!SetLoading(QString())) return;
 
-  if (data_.count() == 0) {
     // If there were no valid songs, disable everything
     ui_->song_list->setEnabled(false);
     ui_->tab_widget->setEnabled(false);
@@ -451,20 +495,40 @@ void EditTagDialog::SetSongsFinished() {
     return;
   }
 
-  // Add the filenames to the list
-  for (const Data &tag_data : data_) {
-    ui_->song_list->addItem(tag_data.current_.basefilename());
+  if (first_songs) {
+    // The first song can be viewed and edited while the others are loading, only saving waits for all of them.
+    SetLoading(QString());
+    ui_->song_list->setCurrentRow(0);
+    ui_->song_list->selectAll();
   }
 
-  // Select all
-  ui_->song_list->setCurrentRow(0);
-  ui_->song_list->selectAll();
+  if (!finished) {
+    ui_->button_box->setEnabled(false);
+    SetSongListVisibility(true);
+    return;
+  }
+
+  ui_->button_box->setEnabled(true);
+
+  // Select all, unless the selection or the songs were already changed.
+  const bool modified = std::any_of(data_.begin(), data_.end(), [](const Data &tag_data) { return tag_data.cover_action_ != UpdateCoverAction::None || !tag_data.current_.IsAllMetadataEqual(tag_data.original_); });
+  if (!modified && ui_->song_list->selectedItems().count() <= 1 && ui_->song_list->currentRow() == 0) {
+    ui_->song_list->selectAll();
+  }
 
   // Hide the list if there's only one song in it
   SetSongListVisibility(data_.count() != 1);
 
 }
 
+void EditTagDialog::SetProgress(const int progress, const int total) {
+
+  ui_->loading_progress->setMaximum(qMax(1, total));
+  ui_->loading_progress->setValue(progress);
+  ui_->loading_progress->setVisible(total > 1 && progress < total);
+
+}
+
 void EditTagDialog::SetSongListVisibility(bool visible) {
 
   ui_->song_list->setVisible(visible);
@@ -1309,12 +1373,18 @@ void EditTagDialog::SaveData() {
 
   }
 
+  // The files are saved in parallel by the tag reader workers.
+  save_tag_count_ = save_tag_pending_;
+  SetProgress(0, save_tag_count_);
+
   if (save_tag_pending_ <= 0) SaveDataFinished();
 
 }
 
 void EditTagDialog::SaveDataFinished() {
 
+  SetProgress(0, 0);
+
   if (!collection_songs_.isEmpty()) {
     app_->collection_backend()->AddOrUpdateSongsAsync(collection_songs_.values());
     collection_songs_.clear();
@@ -1449,6 +1519,7 @@ void EditTagDialog::UpdateLyrics(const quint64 id, const QString &provider, cons
 void EditTagDialog::SongSaveTagsComplete(TagReaderReply *reply, const QString &filename, Song song, const UpdateCoverAction cover_action) {
 
   --save_tag_pending_;
+  SetProgress(save_tag_count_ - save_tag_pending_, save_tag_count_);
   const bool success = reply->message().save_file_response().success();
   reply->deleteLater();
 
@@ -105,7 +105,6 @@ class EditTagDialog : public QDialog {
   };
 
  private slots:
-  void SetSongsFinished();
   void SaveDataFinished();
 
   void SelectionChanged();
@@ -167,8 +166,9 @@ class EditTagDialog : public QDialog {
   bool SetLoading(const QString &message);
   void SetSongListVisibility(bool visible);
 
-  // Called by QtConcurrentRun
-  static QList<Data> LoadData(const SongList &songs);
+  void LoadSongsFinished(TagReaderReply *reply, const quint64 load_id, const int first, const int count);
+  void AddLoadedSongs();
+  void SetProgress(const int progress, const int total);
   void SaveData();
 
   static void SetText(QLabel *label, const int value, const QString &suffix, const QString &def = QString());
@@ -189,6 +189,12 @@ class EditTagDialog : public QDialog {
 
   bool loading_;
 
+  // Songs are read from the files in batches by the tag reader workers, and added to the list in their original order.
+  quint64 load_id_;
+  SongList load_songs_;
+  QMap<int, Song> loaded_songs_;
+  int load_next_;
+
   PlaylistItemPtrList playlist_items_;
   QList<Data> data_;
   QList<FieldData> fields_;
@@ -205,6 +211,7 @@ class EditTagDialog : public QDialog {
   QPushButton *next_button_;
 
   int save_tag_pending_;
+  int save_tag_count_;
 
   QMap<int, Song> collection_songs_;
 
@@ -0,0 +1,124 @@
+/*
+ * Strawberry Music Player
+ *
+ * Strawberry is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Strawberry is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Strawberry.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#include "config.h"
+
+#include <QtGlobal>
+#include <QMutex>
+#include <QDir>
+#include <QFile>
+#include <QFileInfo>
+#include <QFileInfoList>
+#include <QDateTime>
+#include <QCryptographicHash>
+#include <QString>
+#include <QUrl>
+
+#include "core/logging.h"
+#include "audiocache.h"
+
+namespace {
+constexpr char kTemporarySuffix[] = ".part";
+// Downloads that were left behind when Strawberry was closed are removed after a day.
+constexpr qint64 kTemporaryFileMaxAgeSec = 86400;
+}  // namespace
+
+AudioCache::AudioCache(const QString &cache_dir)
+    : cache_dir_(cache_dir),
+      max_size_(0) {}
+
+void AudioCache::set_max_size(const qint64 max_size) {
+
+  QMutexLocker l(&mutex_);
+  if (max_size == max_size_) return;
+  max_size_ = max_size;
+  Evict();
+
+}
+
+QString AudioCache::FileName(const QUrl &media_url) const {
+
+  return cache_dir_ + QLatin1Char('/') + QString::fromLatin1(QCryptographicHash::hash(media_url.toEncoded(), QCryptographicHash::Sha1).toHex());
+
+}
+
+QUrl AudioCache::Find(const QUrl &media_url) {
+
+  QMutexLocker l(&mutex_);
+
+  QFile file(FileName(media_url));
+  if (max_size_ <= 0 || !file.exists()) return QUrl();
+
+  // The modification time is the last time the file was played.
+  if (file.open(QIODevice::ReadWrite)) {
+    file.setFileTime(QDateTime::currentDateTime(), QFileDevice::FileModificationTime);
+    file.close();
+  }
+
+  return QUrl::fromLocalFile(file.fileName());
+
+}
+
+QString AudioCache::TemporaryFileTemplate(const QUrl &media_url) const {
+
+  if (!QDir().mkpath(cache_dir_)) return QString();
+
+  return FileName(media_url) + QStringLiteral(".XXXXXX") + QLatin1String(kTemporarySuffix);
+
+}
+
+bool AudioCache::Insert(const QUrl &media_url, const QString &temporary_filename) {
+
+  QMutexLocker l(&mutex_);
+
+  const QString filename = FileName(media_url);
+  if (QFile::exists(filename)) QFile::remove(filename);
+  if (!QFile::rename(temporary_filename, filename)) {
+    qLog(Error) << "Unable to move" << temporary_filename << "to" << filename;
+    QFile::remove(temporary_filename);
+    return false;
+  }
+
+  qLog(Debug) << "Added" << media_url << "to the audio cache";
+
+  Evict();
+
+  return true;
+
+}
+
+void AudioCache::Evict() {
+
+  QDir dir(cache_dir_);
+  if (!dir.exists()) return;
+
+  const QDateTime now = QDateTime::currentDateTime();
+  qint64 size = 0;
+  const QFileInfoList fileinfos = dir.entryInfoList(QDir::Files, QDir::Time);
+  for (const QFileInfo &fileinfo : fileinfos) {
+    if (fileinfo.fileName().endsWith(QLatin1String(kTemporarySuffix))) {
+      if (fileinfo.lastModified().secsTo(now) > kTemporaryFileMaxAgeSec) QFile::remove(fileinfo.absoluteFilePath());
+      continue;
+    }
+    size += fileinfo.size();
+    if (size > max_size_) {
+      QFile::remove(fileinfo.absoluteFilePath());
+    }
+  }
+
+}
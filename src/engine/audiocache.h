@@ -0,0 +1,61 @@
+/*
+ * Strawberry Music Player
+ *
+ * Strawberry is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Strawberry is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Strawberry.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#ifndef AUDIOCACHE_H
+#define AUDIOCACHE_H
+
+#include "config.h"
+
+#include <QtGlobal>
+#include <QMutex>
+#include <QString>
+#include <QUrl>
+
+// Files of streamed songs kept on disk, so songs from the streaming services are only downloaded once.
+// The files are named after the media URL of the song, since the stream URLs change every time they're requested.
+// When the cache is larger than the maximum size, the least recently played files are removed.
+// Files are added from the streaming threads of the pipelines, so all methods are thread-safe.
+class AudioCache {
+ public:
+  explicit AudioCache(const QString &cache_dir);
+
+  qint64 max_size() const { return max_size_; }
+  void set_max_size(const qint64 max_size);
+
+  // Returns the URL of the cached file for the song, or an empty URL if it's not cached.
+  QUrl Find(const QUrl &media_url);
+
+  // The file the song is written to while it's downloaded, there can be more than one download of the same song.
+  QString TemporaryFileTemplate(const QUrl &media_url) const;
+
+  // Moves a completely downloaded file into the cache.
+  bool Insert(const QUrl &media_url, const QString &temporary_filename);
+
+ private:
+  QString FileName(const QUrl &media_url) const;
+  // Removes the least recently played files until the cache fits.  The mutex must be locked.
+  void Evict();
+
+  QMutex mutex_;
+  QString cache_dir_;
+  qint64 max_size_;
+
+  Q_DISABLE_COPY(AudioCache)
+};
+
+#endif  // AUDIOCACHE_H
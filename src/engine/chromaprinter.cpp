@@ -24,6 +24,7 @@
 #include <glib-object.h>
 #include <cstdlib>
 #include <cstring>
+#include <algorithm>
 #include <chromaprint.h>
 #include <gst/gst.h>
 
@@ -34,6 +35,10 @@
 #include <QByteArray>
 #include <QString>
 #include <QElapsedTimer>
+#include <QFileInfo>
+#include <QDateTime>
+#include <QMutex>
+#include <QCache>
 
 #include "chromaprinter.h"
 #include "core/logging.h"
@@ -47,6 +52,30 @@ static const int kDecodeRate = 11025;
 static const int kDecodeChannels = 1;
 static const int kPlayLengthSecs = 30;
 static const int kTimeoutSecs = 10;
+static const int kFingerprintCacheSize = 1000;
+
+namespace {
+
+// Fingerprints created in this session, the same files are often fingerprinted again by the collection watcher and the tag fetcher.
+QMutex &FingerprintCacheMutex() {
+  static QMutex mutex;
+  return mutex;
+}
+
+QCache<QString, QString> &FingerprintCache() {
+  static QCache<QString, QString> cache(kFingerprintCacheSize);
+  return cache;
+}
+
+// Identifies the contents of the file without reading it.
+QString FingerprintCacheKey(const QString &filename) {
+
+  const QFileInfo fileinfo(filename);
+  return QStringLiteral("%1:%2:%3").arg(fileinfo.absoluteFilePath()).arg(fileinfo.size()).arg(fileinfo.lastModified().toMSecsSinceEpoch());
+
+}
+
+}  // namespace
 
 Chromaprinter::Chromaprinter(const QString &filename)
     : filename_(filename),
@@ -70,6 +99,14 @@ QString Chromaprinter::CreateFingerprint() {
 
   Q_ASSERT(QThread::currentThread() != qApp->thread());
 
+  const QString cache_key = FingerprintCacheKey(filename_);
+  {
+    QMutexLocker l(&FingerprintCacheMutex());
+    if (const QString *cached_fingerprint = FingerprintCache().object(cache_key)) {
+      return *cached_fingerprint;
+    }
+  }
+
   if (!buffer_.open(QIODevice::WriteOnly)) return QString();
 
   GstElement *pipeline = gst_pipeline_new("pipeline");
@@ -96,8 +133,7 @@ QString Chromaprinter::CreateFingerprint() {
   gst_element_link_many(src, decode, nullptr);
   gst_element_link_many(convert, resample, nullptr);
 
-  // Chromaprint expects mono 16-bit ints at a sample rate of 11025Hz.
-  GstCaps *caps = gst_caps_new_simple("audio/x-raw", "format", G_TYPE_STRING, "S16LE", "channels", G_TYPE_INT, kDecodeChannels, "rate", G_TYPE_INT, kDecodeRate, nullptr);
+  GstCaps *caps = CreateDecodeCaps();
   gst_element_link_filtered(resample, sink, caps);
   gst_caps_unref(caps);
 
@@ -150,11 +186,45 @@ QString Chromaprinter::CreateFingerprint() {
   buffer_.close();
 
   // Generate fingerprint from recorded buffer data
-  QByteArray data = buffer_.data();
+  const QString fingerprint = FingerprintFromData(buffer_.data());
+
+  const qint64 codegen_time = time.elapsed();
+
+  qLog(Debug) << "Decode time:" << decode_time << "Codegen time:" << codegen_time;
+
+  // Cleanup
+  callbacks.new_sample = nullptr;
+  gst_object_unref(bus);
+  gst_element_set_state(pipeline, GST_STATE_NULL);
+  gst_object_unref(pipeline);
+
+  if (!fingerprint.isEmpty()) {
+    QMutexLocker l(&FingerprintCacheMutex());
+    FingerprintCache().insert(cache_key, new QString(fingerprint));
+  }
+
+  return fingerprint;
+
+}
+
+GstCaps *Chromaprinter::CreateDecodeCaps() {
+
+  // Chromaprint expects mono 16-bit ints at a sample rate of 11025Hz.
+  return gst_caps_new_simple("audio/x-raw", "format", G_TYPE_STRING, "S16LE", "channels", G_TYPE_INT, kDecodeChannels, "rate", G_TYPE_INT, kDecodeRate, nullptr);
+
+}
+
+qint64 Chromaprinter::DecodeDataSize() {
+
+  return static_cast<qint64>(kPlayLengthSecs) * kDecodeRate * kDecodeChannels * static_cast<qint64>(sizeof(int16_t));
+
+}
+
+QString Chromaprinter::FingerprintFromData(const QByteArray &data) {
 
   ChromaprintContext *chromaprint = chromaprint_new(CHROMAPRINT_ALGORITHM_DEFAULT);
   chromaprint_start(chromaprint, kDecodeRate, kDecodeChannels);
-  chromaprint_feed(chromaprint, reinterpret_cast<int16_t*>(data.data()), static_cast<int>(data.size() / 2));
+  chromaprint_feed(chromaprint, reinterpret_cast<const int16_t*>(data.constData()), static_cast<int>(data.size() / 2));
   chromaprint_finish(chromaprint);
 
   u_int32_t *fprint = nullptr;
@@ -173,16 +243,6 @@ QString Chromaprinter::CreateFingerprint() {
   }
   chromaprint_free(chromaprint);
 
-  const qint64 codegen_time = time.elapsed();
-
-  qLog(Debug) << "Decode time:" << decode_time << "Codegen time:" << codegen_time;
-
-  // Cleanup
-  callbacks.new_sample = nullptr;
-  gst_object_unref(bus);
-  gst_element_set_state(pipeline, GST_STATE_NULL);
-  gst_object_unref(pipeline);
-
   return QString::fromUtf8(fingerprint);
 
 }
@@ -208,16 +268,23 @@ GstFlowReturn Chromaprinter::NewBufferCallback(GstAppSink *app_sink, gpointer se
 
   GstSample *sample = gst_app_sink_pull_sample(app_sink);
   if (!sample) return GST_FLOW_ERROR;
+  const qint64 remaining = DecodeDataSize() - me->buffer_.size();
   GstBuffer *buffer = gst_sample_get_buffer(sample);
-  if (buffer) {
+  if (buffer && remaining > 0) {
     GstMapInfo map;
     if (gst_buffer_map(buffer, &map, GST_MAP_READ)) {
-      me->buffer_.write(reinterpret_cast<const char*>(map.data), static_cast<qint64>(map.size));
+      me->buffer_.write(reinterpret_cast<const char*>(map.data), std::min(static_cast<qint64>(map.size), remaining));
       gst_buffer_unmap(buffer, &map);
     }
   }
   gst_sample_unref(sample);
 
+  // Stop decoding as soon as there is enough data, also for streams where the seek doesn't limit the decoding.
+  if (me->buffer_.size() >= DecodeDataSize()) {
+    gst_element_post_message(GST_ELEMENT(app_sink), gst_message_new_eos(GST_OBJECT(app_sink)));
+    return GST_FLOW_EOS;
+  }
+
   return GST_FLOW_OK;
 
 }
@@ -28,7 +28,9 @@
 #include <gst/gst.h>
 #include <gst/app/gstappsink.h>
 
+#include <QtGlobal>
 #include <QBuffer>
+#include <QByteArray>
 #include <QString>
 
 class Chromaprinter {
@@ -46,6 +48,13 @@ class Chromaprinter {
   // Returns an empty string if no fingerprint could be created.
   QString CreateFingerprint();
 
+  // Caps of the PCM data the fingerprint is created from.
+  static GstCaps *CreateDecodeCaps();
+  // Size of the PCM data used for the fingerprint, anything after it is ignored.
+  static qint64 DecodeDataSize();
+  // Creates a fingerprint from PCM data in the format of CreateDecodeCaps().
+  static QString FingerprintFromData(const QByteArray &data);
+
  private:
   static GstElement *CreateElement(const QString &factory_name, GstElement *bin = nullptr);
 
@@ -22,6 +22,7 @@
 #include <QtAlgorithms>
 #include <QObject>
 #include <QList>
+#include <QElapsedTimer>
 
 #include "core/logging.h"
 #include "devicefinders.h"
@@ -49,12 +50,23 @@
 #  endif  // _MSC_VER
 #endif  // Q_OS_WIN32
 
-DeviceFinders::DeviceFinders(QObject *parent) : QObject(parent) {}
+DeviceFinders::DeviceFinders(QObject *parent) : QObject(parent), initialized_(false) {}
 
 DeviceFinders::~DeviceFinders() {
   qDeleteAll(device_finders_);
 }
 
+QList<DeviceFinder*> DeviceFinders::ListFinders() {
+
+  if (!initialized_) {
+    initialized_ = true;
+    Init();
+  }
+
+  return device_finders_;
+
+}
+
 void DeviceFinders::Init() {
 
   QList<DeviceFinder*> device_finders;
@@ -79,7 +91,11 @@ void DeviceFinders::Init() {
 #endif  // Q_OS_WIN32
 
   for (DeviceFinder *finder : device_finders) {
-    if (!finder->Initialize()) {
+    QElapsedTimer timer;
+    timer.start();
+    const bool success = finder->Initialize();
+    qLog(Debug) << "Initializing DeviceFinder for" << finder->name() << "took" << timer.elapsed() << "ms";
+    if (!success) {
       qLog(Warning) << "Failed to initialize DeviceFinder for" << finder->name();
       delete finder;
       continue;
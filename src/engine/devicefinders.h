@@ -35,10 +35,14 @@ class DeviceFinders : public QObject {
   explicit DeviceFinders(QObject *parent = nullptr);
   ~DeviceFinders() override;
 
+  // The device finders are only initialized when they are first needed, probing the audio systems is slow.
+  QList<DeviceFinder*> ListFinders();
+
+ private:
   void Init();
-  QList<DeviceFinder*> ListFinders() { return device_finders_; }
 
  private:
+  bool initialized_;
   QList<DeviceFinder*> device_finders_;
 };
 
@@ -36,6 +36,10 @@
 
 #include <QCoreApplication>
 #include <QElapsedTimer>
+#include <QList>
+#include <QFuture>
+#include <QThreadPool>
+#include <QtConcurrentRun>
 #include <QString>
 #include <QThread>
 #include <QtGlobal>
@@ -59,6 +63,10 @@ struct GstSampleDeleter {
   void operator()(GstSample *s) const { gst_sample_unref(s); };
 };
 
+struct GstCapsDeleter {
+  void operator()(GstCaps *c) const { gst_caps_unref(c); };
+};
+
 // Remap from the channels defined in SMPTE 2036-2-2008
 // to the channels defined in ITU R-REC-BS 1770-4.
 //
@@ -181,6 +189,8 @@ class EBUR128State {
 
   explicit EBUR128State(const FrameFormat &_dsc);
   const FrameFormat dsc;
+  // Caps of the last sample, the format is only parsed again when the caps change.
+  unique_ptr<GstCaps, GstCapsDeleter> caps;
 
   void AddFrames(const char *data, size_t size);
 
@@ -343,31 +353,54 @@ void EBUR128AnalysisImpl::NewPadCallback(GstElement *elt, GstPad *pad, gpointer
 
 }
 
-GstFlowReturn EBUR128AnalysisImpl::NewBufferCallback(GstAppSink *app_sink, gpointer self) {
-
-  EBUR128AnalysisImpl *me = reinterpret_cast<EBUR128AnalysisImpl*>(self);
+bool AddSampleToState(std::optional<EBUR128State> &state, GstSample *sample) {
 
-  unique_ptr<GstSample, GstSampleDeleter> sample(gst_app_sink_pull_sample(app_sink));
-  if (!sample) return GST_FLOW_ERROR;
+  GstCaps *caps = gst_sample_get_caps(sample);
+  if (!caps) return false;
 
-  const FrameFormat dsc(gst_sample_get_caps(&*sample));
-  if (!me->state) {
-    me->state.emplace(dsc);
+  if (!state) {
+    state.emplace(FrameFormat(caps));
+    state->caps.reset(gst_caps_ref(caps));
   }
-  else if (me->state->dsc != dsc) {
-    return GST_FLOW_ERROR;
+  else if (caps != state->caps.get()) {
+    if (FrameFormat(caps) != state->dsc) {
+      return false;
+    }
+    state->caps.reset(gst_caps_ref(caps));
   }
 
-  GstBuffer *buffer = gst_sample_get_buffer(&*sample);
+  GstBuffer *buffer = gst_sample_get_buffer(sample);
   if (buffer) {
     GstMapInfo map;
     if (gst_buffer_map(buffer, &map, GST_MAP_READ)) {
-      me->state->AddFrames(reinterpret_cast<const char*>(map.data), static_cast<qint64>(map.size));
+      state->AddFrames(reinterpret_cast<const char*>(map.data), static_cast<qint64>(map.size));
       gst_buffer_unmap(buffer, &map);
     }
   }
 
-  return GST_FLOW_OK;
+  return true;
+
+}
+
+GstCaps *CreateSampleCaps() {
+
+  GstStaticCaps static_caps = GST_STATIC_CAPS(
+    "audio/x-raw,"
+    "format = (string) { S16LE, S32LE, F32LE, F64LE },"
+    "layout = (string) interleaved");
+
+  return gst_static_caps_get(&static_caps);
+
+}
+
+GstFlowReturn EBUR128AnalysisImpl::NewBufferCallback(GstAppSink *app_sink, gpointer self) {
+
+  EBUR128AnalysisImpl *me = reinterpret_cast<EBUR128AnalysisImpl*>(self);
+
+  unique_ptr<GstSample, GstSampleDeleter> sample(gst_app_sink_pull_sample(app_sink));
+  if (!sample) return GST_FLOW_ERROR;
+
+  return AddSampleToState(me->state, &*sample) ? GST_FLOW_OK : GST_FLOW_ERROR;
 
 }
 
@@ -410,12 +443,7 @@ std::optional<EBUR128Measures> EBUR128AnalysisImpl::Compute(const Song &song) {
   // Connect the elements
   gst_element_link_many(src, decode, nullptr);
 
-  GstStaticCaps static_caps = GST_STATIC_CAPS(
-    "audio/x-raw,"
-    "format = (string) { S16LE, S32LE, F32LE, F64LE },"
-    "layout = (string) interleaved");
-
-  GstCaps *caps = gst_static_caps_get(&static_caps);
+  GstCaps *caps = CreateSampleCaps();
   // Place a queue before the sink. It really does matter for performance.
   gst_element_link_filtered(convert, queue, caps);
   gst_element_link_many(queue, sink, nullptr);
@@ -510,3 +538,58 @@ std::optional<EBUR128Measures> EBUR128Analysis::Compute(const Song &song) {
   return EBUR128AnalysisImpl::Compute(song);
 
 }
+
+QList<std::optional<EBUR128Measures>> EBUR128Analysis::Compute(const SongList &songs, QThreadPool *thread_pool) {
+
+  Q_ASSERT(QThread::currentThread() != qApp->thread());
+
+  if (!thread_pool) thread_pool = QThreadPool::globalInstance();
+
+  QList<QFuture<std::optional<EBUR128Measures>>> futures;
+  futures.reserve(songs.count());
+  for (const Song &song : songs) {
+    futures << QtConcurrent::run(thread_pool, &EBUR128AnalysisImpl::Compute, song);
+  }
+
+  QList<std::optional<EBUR128Measures>> results;
+  results.reserve(futures.count());
+  for (QFuture<std::optional<EBUR128Measures>> &future : futures) {
+    future.waitForFinished();
+    results << future.result();
+  }
+
+  return results;
+
+}
+
+class EBUR128Accumulator::Private {
+ public:
+  std::optional<EBUR128State> state;
+};
+
+EBUR128Accumulator::EBUR128Accumulator() : d_(new Private) {}
+
+EBUR128Accumulator::~EBUR128Accumulator() = default;
+
+GstCaps *EBUR128Accumulator::CreateCaps() {
+
+  return CreateSampleCaps();
+
+}
+
+bool EBUR128Accumulator::AddSample(GstSample *sample) {
+
+  return AddSampleToState(d_->state, sample);
+
+}
+
+std::optional<EBUR128Measures> EBUR128Accumulator::Finalize() {
+
+  if (!d_->state) return std::nullopt;
+
+  std::optional<EBUR128Measures> result = EBUR128State::Finalize(std::move(d_->state.value()));
+  d_->state.reset();
+
+  return result;
+
+}
@@ -23,10 +23,18 @@
 #include "config.h"
 
 #include <optional>
+#include <memory>
+
+#include <gst/gst.h>
+
+#include <QtGlobal>
+#include <QList>
 
 #include "core/song.h"
 #include "ebur128measures.h"
 
+class QThreadPool;
+
 class EBUR128Analysis {
  public:
   ~EBUR128Analysis() = delete;  // Do not construct variables of this class.
@@ -36,6 +44,34 @@ class EBUR128Analysis {
   //
   // This method is blocking, so you want to call it in another thread.
   static std::optional<EBUR128Measures> Compute(const Song &song);
+
+  // Performs the analyses of the songs in parallel, with one pipeline for each thread of the thread pool.
+  // Uses the global thread pool if none is given. The results are in the same order as the songs.
+  //
+  // This method is blocking too.
+  static QList<std::optional<EBUR128Measures>> Compute(const SongList &songs, QThreadPool *thread_pool = nullptr);
+};
+
+// Measures the loudness of decoded samples pulled from a pipeline created elsewhere.
+class EBUR128Accumulator {
+ public:
+  EBUR128Accumulator();
+  ~EBUR128Accumulator();
+
+  // Caps the samples need to be in.
+  static GstCaps *CreateCaps();
+
+  // Returns false if the format of the sample differs from the previous samples.
+  bool AddSample(GstSample *sample);
+
+  // Returns `std::nullopt` if no samples were added.
+  std::optional<EBUR128Measures> Finalize();
+
+ private:
+  Q_DISABLE_COPY(EBUR128Accumulator)
+
+  class Private;
+  std::unique_ptr<Private> d_;
 };
 
 #endif  // EBUR128ANALYSIS_H
@@ -41,6 +41,8 @@
 EngineBase::EngineBase(QObject *parent)
     : QObject(parent),
       exclusive_mode_(false),
+      low_latency_(false),
+      bit_perfect_(false),
       volume_control_(true),
       volume_(100),
       beginning_nanosec_(0),
@@ -57,6 +59,7 @@ EngineBase::EngineBase(QObject *parent)
       ebur128_loudness_normalization_(false),
       ebur128_target_level_lufs_(-23.0),
       buffer_duration_nanosec_(BackendSettingsPage::kDefaultBufferDuration * kNsecPerMsec),
+      adaptive_buffering_(false),
       buffer_low_watermark_(BackendSettingsPage::kDefaultBufferLowWatermark),
       buffer_high_watermark_(BackendSettingsPage::kDefaultBufferHighWatermark),
       fadeout_enabled_(true),
@@ -170,6 +173,8 @@ void EngineBase::ReloadSettings() {
   device_ = s.value("device");
 
   exclusive_mode_ = s.value("exclusive_mode", false).toBool();
+  low_latency_ = s.value("low_latency", false).toBool();
+  bit_perfect_ = s.value("bit_perfect", false).toBool();
 
   volume_control_ = s.value("volume_control", true).toBool();
 
@@ -177,6 +182,7 @@ void EngineBase::ReloadSettings() {
   channels_ = s.value("channels", 0).toInt();
 
   buffer_duration_nanosec_ = s.value("bufferduration", BackendSettingsPage::kDefaultBufferDuration).toLongLong() * kNsecPerMsec;
+  adaptive_buffering_ = s.value("adaptive_buffering", false).toBool();
   buffer_low_watermark_ = s.value("bufferlowwatermark", BackendSettingsPage::kDefaultBufferLowWatermark).toDouble();
   buffer_high_watermark_ = s.value("bufferhighwatermark", BackendSettingsPage::kDefaultBufferHighWatermark).toDouble();
 
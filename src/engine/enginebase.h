@@ -40,6 +40,7 @@
 
 #include "devicefinders.h"
 #include "enginemetadata.h"
+#include "enginemetrics.h"
 #include "core/song.h"
 
 class EngineBase : public QObject {
@@ -117,6 +118,10 @@ class EngineBase : public QObject {
 
   virtual const Scope &scope(const int chunk_length) { Q_UNUSED(chunk_length); return scope_; }
 
+  // Startup latency, underruns and queue levels of the playback so far.
+  const EngineMetrics &metrics() const { return metrics_; }
+  void ResetMetrics() { metrics_.Reset(); }
+
   // Sets new values for the beginning and end markers of the currently playing song.
   // This doesn't change the state of engine or the stream's current position.
   virtual void RefreshMarkers(const quint64 beginning_nanosec, const qint64 end_nanosec) {
@@ -190,6 +195,8 @@ class EngineBase : public QObject {
 
  protected:
   bool exclusive_mode_;
+  bool low_latency_;
+  bool bit_perfect_;
   bool volume_control_;
   uint volume_;
   quint64 beginning_nanosec_;
@@ -198,6 +205,7 @@ class EngineBase : public QObject {
   QUrl stream_url_;
   double ebur128_loudness_normalizing_gain_db_;
   Scope scope_;
+  EngineMetrics metrics_;
   bool buffering_;
   bool equalizer_enabled_;
 
@@ -218,6 +226,7 @@ class EngineBase : public QObject {
 
   // Buffering
   quint64 buffer_duration_nanosec_;
+  bool adaptive_buffering_;
   double buffer_low_watermark_;
   double buffer_high_watermark_;
 
@@ -0,0 +1,134 @@
+/*
+ * Strawberry Music Player
+ *
+ * Strawberry is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Strawberry is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Strawberry.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#include "config.h"
+
+#include <QtGlobal>
+#include <QList>
+#include <QString>
+#include <QStringList>
+
+#include "enginemetrics.h"
+
+EngineMetrics::Histogram::Histogram(const QList<qint64> &bounds)
+    : bounds_(bounds),
+      count_(0),
+      sum_(0),
+      max_(0) {
+
+  for (int i = 0; i <= bounds_.count(); ++i) {
+    buckets_ << 0;
+  }
+
+}
+
+void EngineMetrics::Histogram::Add(const qint64 value) {
+
+  int i = 0;
+  while (i < bounds_.count() && value > bounds_[i]) ++i;
+  ++buckets_[i];
+
+  ++count_;
+  sum_ += value;
+  max_ = qMax(max_, value);
+
+}
+
+void EngineMetrics::Histogram::Clear() {
+
+  for (int i = 0; i < buckets_.count(); ++i) {
+    buckets_[i] = 0;
+  }
+  count_ = 0;
+  sum_ = 0;
+  max_ = 0;
+
+}
+
+QString EngineMetrics::Histogram::ToString(const QString &unit) const {
+
+  QStringList buckets;
+  buckets.reserve(buckets_.count());
+  for (int i = 0; i < buckets_.count(); ++i) {
+    if (i < bounds_.count()) {
+      buckets << QStringLiteral("<=%1%2: %3").arg(bounds_[i]).arg(unit).arg(buckets_[i]);
+    }
+    else {
+      buckets << QStringLiteral(">%1%2: %3").arg(bounds_.isEmpty() ? 0 : bounds_.last()).arg(unit).arg(buckets_[i]);
+    }
+  }
+
+  return QStringLiteral("count %1, average %2%4, max %3%4 [%5]").arg(count_).arg(average()).arg(max_).arg(unit, buckets.join(QLatin1String(", ")));
+
+}
+
+EngineMetrics::EngineMetrics()
+    : tracks_started_(0),
+      underruns_(0),
+      errors_(0),
+      startup_latency_(QList<qint64>() << 50 << 100 << 250 << 500 << 1000 << 2000 << 5000),
+      underrun_duration_(QList<qint64>() << 100 << 500 << 1000 << 2000 << 5000 << 10000),
+      queue_level_(QList<qint64>() << 0 << 10 << 25 << 50 << 75 << 90 << 99) {}
+
+void EngineMetrics::AddTrackStarted(const qint64 startup_msec) {
+
+  ++tracks_started_;
+  startup_latency_.Add(startup_msec);
+
+}
+
+void EngineMetrics::AddUnderrun() {
+  ++underruns_;
+}
+
+void EngineMetrics::AddUnderrunFinished(const qint64 duration_msec) {
+  underrun_duration_.Add(duration_msec);
+}
+
+void EngineMetrics::AddQueueLevel(const int percent) {
+  queue_level_.Add(percent);
+}
+
+void EngineMetrics::AddError() {
+  ++errors_;
+}
+
+void EngineMetrics::Reset() {
+
+  tracks_started_ = 0;
+  underruns_ = 0;
+  errors_ = 0;
+  startup_latency_.Clear();
+  underrun_duration_.Clear();
+  queue_level_.Clear();
+
+}
+
+QString EngineMetrics::ToString() const {
+
+  QStringList lines;
+  lines << QStringLiteral("Tracks started: %1").arg(tracks_started_)
+        << QStringLiteral("Startup latency: %1").arg(startup_latency_.ToString(QStringLiteral("ms")))
+        << QStringLiteral("Underruns: %1").arg(underruns_)
+        << QStringLiteral("Underrun duration: %1").arg(underrun_duration_.ToString(QStringLiteral("ms")))
+        << QStringLiteral("Queue level: %1").arg(queue_level_.ToString(QStringLiteral("%")))
+        << QStringLiteral("Errors: %1").arg(errors_);
+
+  return lines.join(QLatin1Char('\n'));
+
+}
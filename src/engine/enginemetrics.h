@@ -0,0 +1,83 @@
+/*
+ * Strawberry Music Player
+ *
+ * Strawberry is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Strawberry is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Strawberry.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#ifndef ENGINEMETRICS_H
+#define ENGINEMETRICS_H
+
+#include "config.h"
+
+#include <QtGlobal>
+#include <QList>
+#include <QString>
+
+// Playback counters and histograms collected by the engine for diagnosing stalls.
+// Only used from the GUI thread.
+class EngineMetrics {
+ public:
+  EngineMetrics();
+
+  class Histogram {
+   public:
+    // Upper bounds of the buckets, values above the last bound go in an extra bucket.
+    explicit Histogram(const QList<qint64> &bounds = QList<qint64>());
+
+    void Add(const qint64 value);
+    void Clear();
+
+    quint64 count() const { return count_; }
+    qint64 max() const { return max_; }
+    qint64 average() const { return count_ > 0 ? sum_ / static_cast<qint64>(count_) : 0; }
+    const QList<qint64> &bounds() const { return bounds_; }
+    const QList<quint64> &buckets() const { return buckets_; }
+
+    QString ToString(const QString &unit) const;
+
+   private:
+    QList<qint64> bounds_;
+    QList<quint64> buckets_;
+    quint64 count_;
+    qint64 sum_;
+    qint64 max_;
+  };
+
+  void AddTrackStarted(const qint64 startup_msec);
+  void AddUnderrun();
+  void AddUnderrunFinished(const qint64 duration_msec);
+  void AddQueueLevel(const int percent);
+  void AddError();
+  void Reset();
+
+  quint64 tracks_started() const { return tracks_started_; }
+  quint64 underruns() const { return underruns_; }
+  quint64 errors() const { return errors_; }
+  const Histogram &startup_latency() const { return startup_latency_; }
+  const Histogram &underrun_duration() const { return underrun_duration_; }
+  const Histogram &queue_level() const { return queue_level_; }
+
+  QString ToString() const;
+
+ private:
+  quint64 tracks_started_;
+  quint64 underruns_;
+  quint64 errors_;
+  Histogram startup_latency_;
+  Histogram underrun_duration_;
+  Histogram queue_level_;
+};
+
+#endif  // ENGINEMETRICS_H
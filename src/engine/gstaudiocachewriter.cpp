@@ -0,0 +1,157 @@
+/*
+ * Strawberry Music Player
+ *
+ * Strawberry is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Strawberry is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Strawberry.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#include "config.h"
+
+#include <glib.h>
+#include <gst/gst.h>
+
+#include <QtGlobal>
+#include <QIODevice>
+#include <QByteArray>
+#include <QString>
+#include <QUrl>
+#include <QTemporaryFile>
+
+#include "core/logging.h"
+#include "core/shared_ptr.h"
+#include "audiocache.h"
+#include "gstaudiocachewriter.h"
+
+namespace {
+// Larger files are not cached, they would push out too many songs.
+constexpr int kMaxFileSizeDivisor = 4;
+}  // namespace
+
+GstAudioCacheWriter::GstAudioCacheWriter(SharedPtr<AudioCache> audio_cache, const QUrl &media_url, GstElement *source)
+    : audio_cache_(audio_cache),
+      media_url_(media_url),
+      source_(source),
+      file_(new QTemporaryFile(audio_cache->TemporaryFileTemplate(media_url))),
+      offset_(0),
+      failed_(false) {}
+
+// An unfinished temporary file removes itself.
+GstAudioCacheWriter::~GstAudioCacheWriter() = default;
+
+void GstAudioCacheWriter::Attach(SharedPtr<AudioCache> audio_cache, const QUrl &media_url, GstElement *source) {
+
+  if (!audio_cache || audio_cache->max_size() <= 0) return;
+
+  // The size is only known once souphttpsrc has the headers, so sources of streams without a length are skipped when the download finishes.
+  GstPad *pad = gst_element_get_static_pad(source, "src");
+  if (!pad) return;
+
+  GstAudioCacheWriter *writer = new GstAudioCacheWriter(audio_cache, media_url, source);
+  if (!writer->file_->open()) {
+    qLog(Error) << "Unable to open" << writer->file_->fileName() << "for the audio cache";
+    delete writer;
+    gst_object_unref(pad);
+    return;
+  }
+
+  gst_pad_add_probe(pad, static_cast<GstPadProbeType>(GST_PAD_PROBE_TYPE_BUFFER | GST_PAD_PROBE_TYPE_EVENT_DOWNSTREAM), &ProbeCallback, writer, &DestroyCallback);
+  gst_object_unref(pad);
+
+}
+
+GstPadProbeReturn GstAudioCacheWriter::ProbeCallback(GstPad *pad, GstPadProbeInfo *info, gpointer self) {
+
+  Q_UNUSED(pad)
+
+  GstAudioCacheWriter *instance = reinterpret_cast<GstAudioCacheWriter*>(self);
+  if (instance->failed_) return GST_PAD_PROBE_REMOVE;
+
+  if (info->type & GST_PAD_PROBE_TYPE_BUFFER) {
+    instance->WriteBuffer(gst_pad_probe_info_get_buffer(info));
+  }
+  else if (info->type & GST_PAD_PROBE_TYPE_EVENT_DOWNSTREAM) {
+    GstEvent *event = gst_pad_probe_info_get_event(info);
+    switch (GST_EVENT_TYPE(event)) {
+      case GST_EVENT_FLUSH_START:
+        // The source seeks, the rest of the file is downloaded from somewhere else.
+        instance->failed_ = true;
+        break;
+      case GST_EVENT_EOS:
+        instance->Finish();
+        return GST_PAD_PROBE_REMOVE;
+      default:
+        break;
+    }
+  }
+
+  return instance->failed_ ? GST_PAD_PROBE_REMOVE : GST_PAD_PROBE_OK;
+
+}
+
+void GstAudioCacheWriter::DestroyCallback(gpointer self) {
+
+  delete reinterpret_cast<GstAudioCacheWriter*>(self);
+
+}
+
+void GstAudioCacheWriter::WriteBuffer(GstBuffer *buffer) {
+
+  if (!buffer || !file_) return;
+
+  if (GST_BUFFER_OFFSET_IS_VALID(buffer) && GST_BUFFER_OFFSET(buffer) != offset_) {
+    failed_ = true;
+    return;
+  }
+
+  GstMapInfo map;
+  if (!gst_buffer_map(buffer, &map, GST_MAP_READ)) {
+    failed_ = true;
+    return;
+  }
+  const qint64 written = file_->write(reinterpret_cast<const char*>(map.data), static_cast<qint64>(map.size));
+  gst_buffer_unmap(buffer, &map);
+
+  if (written != static_cast<qint64>(map.size)) {
+    failed_ = true;
+    return;
+  }
+  offset_ += map.size;
+
+}
+
+void GstAudioCacheWriter::Finish() {
+
+  if (!file_ || failed_) return;
+
+  gint64 size = 0;
+  if (!gst_element_query_duration(source_, GST_FORMAT_BYTES, &size) || size <= 0 || static_cast<guint64>(size) != offset_) {
+    qLog(Debug) << "Not adding" << media_url_ << "to the audio cache, the size of the download is unknown or incomplete";
+    return;
+  }
+  if (size > audio_cache_->max_size() / kMaxFileSizeDivisor) return;
+
+  // A manifest or a playlist would be played as the song.
+  file_->flush();
+  file_->seek(0);
+  const QByteArray head = file_->read(16).trimmed();
+  if (head.startsWith('<') || head.startsWith("#EXTM3U") || head.startsWith('[')) return;
+
+  file_->setAutoRemove(false);
+  const QString filename = file_->fileName();
+  file_->close();
+  file_.reset();
+
+  audio_cache_->Insert(media_url_, filename);
+
+}
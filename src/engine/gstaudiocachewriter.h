@@ -0,0 +1,65 @@
+/*
+ * Strawberry Music Player
+ *
+ * Strawberry is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Strawberry is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Strawberry.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#ifndef GSTAUDIOCACHEWRITER_H
+#define GSTAUDIOCACHEWRITER_H
+
+#include "config.h"
+
+#include <glib.h>
+#include <gst/gst.h>
+
+#include <QtGlobal>
+#include <QUrl>
+
+#include "core/shared_ptr.h"
+#include "core/scoped_ptr.h"
+
+class QTemporaryFile;
+class AudioCache;
+
+// Writes the bytes an HTTP source downloads to the audio cache.
+// The writer is owned by a probe on the source pad, so it's removed together with the source.
+// Only downloads that go from the first to the last byte of the file without seeking are added, anything else is discarded.
+class GstAudioCacheWriter {
+ public:
+  ~GstAudioCacheWriter();
+
+  // Starts writing the download of the source if the size of the file is known, it's called from the source-setup callback.
+  static void Attach(SharedPtr<AudioCache> audio_cache, const QUrl &media_url, GstElement *source);
+
+ private:
+  explicit GstAudioCacheWriter(SharedPtr<AudioCache> audio_cache, const QUrl &media_url, GstElement *source);
+
+  static GstPadProbeReturn ProbeCallback(GstPad *pad, GstPadProbeInfo *info, gpointer self);
+  static void DestroyCallback(gpointer self);
+
+  void WriteBuffer(GstBuffer *buffer);
+  void Finish();
+
+  SharedPtr<AudioCache> audio_cache_;
+  QUrl media_url_;
+  GstElement *source_;
+  ScopedPtr<QTemporaryFile> file_;
+  guint64 offset_;
+  bool failed_;
+
+  Q_DISABLE_COPY(GstAudioCacheWriter)
+};
+
+#endif  // GSTAUDIOCACHEWRITER_H
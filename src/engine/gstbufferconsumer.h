@@ -36,7 +36,8 @@ class GstBufferConsumer {
 
   // This is called in some unspecified GStreamer thread.
   // Ownership of the buffer is transferred to the BufferConsumer, and it should gst_buffer_unref it.
-  virtual void ConsumeBuffer(GstBuffer *buffer, const int pipeline_id, const QString &format) = 0;
+  // Buffers in formats the analyzer converts are passed as interleaved S16LE samples, format is the name of the original format.
+  virtual void ConsumeBuffer(GstBuffer *buffer, const int pipeline_id, const QString &format, const int channels, const int rate) = 0;
 
  private:
   Q_DISABLE_COPY(GstBufferConsumer)
@@ -27,6 +27,7 @@
 #include <optional>
 #include <utility>
 #include <memory>
+#include <atomic>
 
 #include <glib.h>
 #include <glib-object.h>
@@ -48,17 +49,22 @@
 #include <QEasingCurve>
 #include <QMetaObject>
 #include <QTimerEvent>
+#include <QStandardPaths>
 
 #include "core/shared_ptr.h"
 #include "core/logging.h"
 #include "core/taskmanager.h"
+#include "core/trace.h"
 #include "core/signalchecker.h"
+#include "core/settings.h"
 #include "utilities/timeconstants.h"
 #include "enginebase.h"
 #include "gstengine.h"
 #include "gstenginepipeline.h"
 #include "gstbufferconsumer.h"
+#include "audiocache.h"
 #include "enginemetadata.h"
+#include "settings/backendsettingspage.h"
 
 using std::make_shared;
 
@@ -79,6 +85,12 @@ const int GstEngine::kDiscoveryTimeoutS = 10;
 const qint64 GstEngine::kTimerIntervalNanosec = 1000 * kNsecPerMsec;  // 1s
 const qint64 GstEngine::kPreloadGapNanosec = 8000 * kNsecPerMsec;     // 8s
 const qint64 GstEngine::kSeekDelayNanosec = 100 * kNsecPerMsec;       // 100msec
+const size_t GstEngine::kScopeBufferSize = 262144;                    // About 1.3s of 96kHz stereo
+const size_t GstEngine::kScopeMaxBacklogMsec = 500;
+const quint64 GstEngine::kAdaptiveBufferMinNanosec = 1000 * kNsecPerMsec;  // 1s
+const int GstEngine::kBackgroundJobsPauseMsec = 3000;
+const quint64 GstEngine::kAdaptiveBufferMaxNanosec = 60000 * kNsecPerMsec;  // 60s
+const int GstEngine::kAdaptiveBufferFastLinkFactor = 4;
 
 GstEngine::GstEngine(SharedPtr<TaskManager> task_manager, QObject *parent)
     : EngineBase(parent),
@@ -86,7 +98,7 @@ GstEngine::GstEngine(SharedPtr<TaskManager> task_manager, QObject *parent)
       gst_startup_(nullptr),
       discoverer_(nullptr),
       buffering_task_id_(-1),
-      latest_buffer_(nullptr),
+      audio_cache_enabled_(false),
       stereo_balancer_enabled_(false),
       stereo_balance_(0.0F),
       equalizer_enabled_(false),
@@ -97,9 +109,9 @@ GstEngine::GstEngine(SharedPtr<TaskManager> task_manager, QObject *parent)
       timer_id_(-1),
       is_fading_out_to_pause_(false),
       has_faded_out_(false),
-      scope_chunk_(0),
-      have_new_buffer_(false),
-      scope_chunks_(0),
+      scope_buffer_(kScopeBufferSize),
+      scope_pipeline_id_(-1),
+      adaptive_buffer_reduced_pipeline_id_(-1),
       discovery_finished_cb_id_(-1),
       discovery_discovered_cb_id_(-1) {
 
@@ -115,11 +127,7 @@ GstEngine::~GstEngine() {
 
   EnsureInitialized();
   current_pipeline_.reset();
-
-  if (latest_buffer_) {
-    gst_buffer_unref(latest_buffer_);
-    latest_buffer_ = nullptr;
-  }
+  spare_pipeline_.reset();
 
   if (discoverer_) {
 
@@ -167,7 +175,7 @@ void GstEngine::StartPreloading(const QUrl &media_url, const QUrl &stream_url, c
 
   EnsureInitialized();
 
-  const QByteArray gst_url = FixupUrl(stream_url);
+  const QByteArray gst_url = FixupUrl(AudioCacheUrl(media_url, stream_url));
 
   // No crossfading, so we can just queue the new URL in the existing pipeline and get gapless playback (hopefully)
   if (current_pipeline_) {
@@ -184,11 +192,13 @@ void GstEngine::StartPreloading(const QUrl &media_url, const QUrl &stream_url, c
 
 bool GstEngine::Load(const QUrl &media_url, const QUrl &stream_url, const EngineBase::TrackChangeFlags change, const bool force_stop_at_end, const quint64 beginning_nanosec, const qint64 end_nanosec, const std::optional<double> ebur128_integrated_loudness_lufs) {
 
+  TRACE_SCOPE("engine", "GstEngine::Load");
+
   EnsureInitialized();
 
   EngineBase::Load(stream_url, media_url, change, force_stop_at_end, beginning_nanosec, end_nanosec, ebur128_integrated_loudness_lufs);
 
-  const QByteArray gst_url = FixupUrl(stream_url);
+  const QByteArray gst_url = FixupUrl(AudioCacheUrl(media_url, stream_url));
 
   bool crossfade = current_pipeline_ && ((crossfade_enabled_ && change & EngineBase::TrackChangeType::Manual) || (autocrossfade_enabled_ && change & EngineBase::TrackChangeType::Auto) || ((crossfade_enabled_ || autocrossfade_enabled_) && change & EngineBase::TrackChangeType::Intro));
 
@@ -214,6 +224,8 @@ bool GstEngine::Load(const QUrl &media_url, const QUrl &stream_url, const Engine
   SetStereoBalance(stereo_balance_);
   SetEqualizerParameters(equalizer_preamp_, equalizer_gains_);
 
+  QMetaObject::invokeMethod(this, &GstEngine::CreateSparePipeline, Qt::QueuedConnection);
+
   // Maybe fade in this track
   if (crossfade) {
     current_pipeline_->StartFader(fadeout_duration_nanosec_, QTimeLine::Forward);
@@ -242,10 +254,15 @@ bool GstEngine::Load(const QUrl &media_url, const QUrl &stream_url, const Engine
 
 bool GstEngine::Play(const quint64 offset_nanosec) {
 
+  TRACE_SCOPE("engine", "GstEngine::Play");
+
   EnsureInitialized();
 
   if (!current_pipeline_ || current_pipeline_->is_buffering()) return false;
 
+  // Background jobs are held back until the pipeline is playing, so they don't delay the start of the track.
+  if (task_manager_) task_manager_->PauseBackgroundJobs(kBackgroundJobsPauseMsec);
+
   QFutureWatcher<GstStateChangeReturn> *watcher = new QFutureWatcher<GstStateChangeReturn>();
   const int pipeline_id = current_pipeline_->id();
   QObject::connect(watcher, &QFutureWatcher<GstStateChangeReturn>::finished, this, [this, watcher, pipeline_id, offset_nanosec]() {
@@ -382,24 +399,26 @@ qint64 GstEngine::length_nanosec() const {
 
 const EngineBase::Scope &GstEngine::scope(const int chunk_length) {
 
-  // The new buffer could have a different size
-  if (have_new_buffer_) {
-    if (latest_buffer_) {
-      scope_chunks_ = ceil((static_cast<double>(GST_BUFFER_DURATION(latest_buffer_) / static_cast<double>(chunk_length * kNsecPerMsec))));
-    }
+  // Only the current pipeline writes to the scope buffer, old samples are dropped when it changes.
+  const int pipeline_id = current_pipeline_ ? current_pipeline_->id() : -1;
+  if (pipeline_id != scope_pipeline_id_.load(std::memory_order_relaxed)) {
+    scope_pipeline_id_.store(pipeline_id, std::memory_order_release);
+    scope_buffer_.Clear();
+    return scope_;
+  }
 
-    // if the buffer is shorter than the chunk length
-    if (scope_chunks_ <= 0) {
-      scope_chunks_ = 1;
-    }
+  const size_t samples_per_sec = static_cast<size_t>(std::max(0, scope_buffer_.samples_per_sec()));
+  if (samples_per_sec == 0) return scope_;
 
-    scope_chunk_ = 0;
-    have_new_buffer_ = false;
+  // Read one chunk, keeping the count even so the channels stay interleaved the same way.
+  const size_t count = std::min(samples_per_sec * static_cast<size_t>(chunk_length) / 1000, scope_.size()) & ~static_cast<size_t>(1);
+  const size_t backlog = (samples_per_sec * kScopeMaxBacklogMsec / 1000) & ~static_cast<size_t>(1);
+  const size_t available = scope_buffer_.Available();
+  if (available > backlog + count) {
+    scope_buffer_.Skip((available - backlog - count) & ~static_cast<size_t>(1));
   }
 
-  if (latest_buffer_) {
-    UpdateScope(chunk_length);
-  }
+  scope_buffer_.Read(scope_.data(), count);
 
   return scope_;
 
@@ -471,22 +490,86 @@ void GstEngine::ReloadSettings() {
 
   if (output_.isEmpty()) output_ = QLatin1String(kAutoSink);
 
+  additional_outputs_.clear();
+  {
+    Settings s;
+    s.beginGroup(BackendSettingsPage::kSettingsGroup);
+    const int count = s.beginReadArray("additional_outputs");
+    for (int i = 0; i < count; ++i) {
+      s.setArrayIndex(i);
+      GstEnginePipeline::AdditionalOutput additional_output;
+      additional_output.description = s.value("description").toString();
+      additional_output.volume = s.value("volume", 100).toDouble() * 0.01;
+      additional_output.latency_nanosec = s.value("latency", 0).toLongLong() * kNsecPerMsec;
+      if (!additional_output.description.isEmpty()) {
+        additional_outputs_ << additional_output;
+      }
+    }
+    s.endArray();
+
+    // The cache is kept when it's turned off, so the files are used again when it's turned back on.
+    if (s.value("audio_cache", false).toBool()) {
+      if (!audio_cache_) audio_cache_ = make_shared<AudioCache>(QStandardPaths::writableLocation(QStandardPaths::CacheLocation) + QStringLiteral("/audio"));
+      audio_cache_->set_max_size(s.value("audio_cache_size", BackendSettingsPage::kDefaultAudioCacheSize).toLongLong() * 1024 * 1024);
+      audio_cache_enabled_ = true;
+    }
+    else {
+      audio_cache_enabled_ = false;
+    }
+    s.endGroup();
+  }
+
+  // The spare pipeline was created with the old settings.
+  ResetSparePipeline();
+
 }
 
-void GstEngine::ConsumeBuffer(GstBuffer *buffer, const int pipeline_id, const QString &format) {
+void GstEngine::ConsumeBuffer(GstBuffer *buffer, const int pipeline_id, const QString &format, const int channels, const int rate) {
+
+  Q_UNUSED(channels)
+  Q_UNUSED(rate)
 
-  // Schedule this to run in the GUI thread.  The buffer gets added to the queue and unreffed by UpdateScope.
-  if (!QMetaObject::invokeMethod(this, "AddBufferToScope", Q_ARG(GstBuffer*, buffer), Q_ARG(int, pipeline_id), Q_ARG(QString, format))) {
-    qLog(Warning) << "Failed to invoke AddBufferToScope on GstEngine";
+  // Runs in the streaming thread, the samples are copied to the scope buffer so the buffer can be unreffed right away.
+  // The flag keeps the scope buffer to a single producer while the pipelines are switched.
+  if (pipeline_id != scope_pipeline_id_.load(std::memory_order_acquire) || !IsScopeFormat(format) || scope_writing_.test_and_set(std::memory_order_acquire)) {
     gst_buffer_unref(buffer);
+    return;
+  }
+
+  GstMapInfo map;
+  if (GST_CLOCK_TIME_IS_VALID(GST_BUFFER_DURATION(buffer)) && GST_BUFFER_DURATION(buffer) > 0 && gst_buffer_map(buffer, &map, GST_MAP_READ)) {
+    const size_t count = map.size / sizeof(EngineBase::Scope::value_type);
+    scope_buffer_.set_samples_per_sec(static_cast<int>(gst_util_uint64_scale(count, GST_SECOND, GST_BUFFER_DURATION(buffer))));
+    scope_buffer_.Write(reinterpret_cast<const qint16*>(map.data), count);
+    gst_buffer_unmap(buffer, &map);
   }
 
+  scope_writing_.clear(std::memory_order_release);
+  gst_buffer_unref(buffer);
+
+}
+
+bool GstEngine::IsScopeFormat(const QString &format) {
+
+  return format.startsWith(QLatin1String("S16LE")) ||
+         format.startsWith(QLatin1String("U16LE")) ||
+         format.startsWith(QLatin1String("S24LE")) ||
+         format.startsWith(QLatin1String("S24_32LE")) ||
+         format.startsWith(QLatin1String("S32LE")) ||
+         format.startsWith(QLatin1String("F32LE")) ||
+         format.startsWith(QLatin1String("F64LE"));
+
 }
 
 void GstEngine::SetStereoBalancerEnabled(const bool enabled) {
 
   stereo_balancer_enabled_ = enabled;
   if (current_pipeline_) current_pipeline_->set_stereo_balancer_enabled(enabled);
+  ResetSparePipeline();
+
+  if (enabled && current_pipeline_ && !current_pipeline_->has_stereo_balancer()) {
+    RebuildPipeline();
+  }
 
 }
 
@@ -501,6 +584,11 @@ void GstEngine::SetEqualizerEnabled(const bool enabled) {
 
   equalizer_enabled_ = enabled;
   if (current_pipeline_) current_pipeline_->set_equalizer_enabled(enabled);
+  ResetSparePipeline();
+
+  if (enabled && current_pipeline_ && !current_pipeline_->has_equalizer()) {
+    RebuildPipeline();
+  }
 
 }
 
@@ -517,6 +605,7 @@ void GstEngine::AddBufferConsumer(GstBufferConsumer *consumer) {
 
   buffer_consumers_ << consumer;
   if (current_pipeline_) current_pipeline_->AddBufferConsumer(consumer);
+  if (spare_pipeline_) spare_pipeline_->AddBufferConsumer(consumer);
 
 }
 
@@ -524,6 +613,7 @@ void GstEngine::RemoveBufferConsumer(GstBufferConsumer *consumer) {
 
   buffer_consumers_.removeAll(consumer);
   if (current_pipeline_) current_pipeline_->RemoveBufferConsumer(consumer);
+  if (spare_pipeline_) spare_pipeline_->RemoveBufferConsumer(consumer);
 
 }
 
@@ -570,6 +660,8 @@ void GstEngine::HandlePipelineError(const int pipeline_id, const int domain, con
 
   qLog(Error) << "GStreamer error:" << domain << error_code << message;
 
+  metrics_.AddError();
+
   current_pipeline_.reset();
   BufferingFinished();
   emit StateChanged(EngineBase::State::Error);
@@ -600,23 +692,6 @@ void GstEngine::NewMetaData(const int pipeline_id, const EngineMetadata &engine_
 
 }
 
-void GstEngine::AddBufferToScope(GstBuffer *buf, const int pipeline_id, const QString &format) {
-
-  if (!current_pipeline_ || current_pipeline_->id() != pipeline_id) {
-    gst_buffer_unref(buf);
-    return;
-  }
-
-  if (latest_buffer_) {
-    gst_buffer_unref(latest_buffer_);
-  }
-
-  buffer_format_ = format;
-  latest_buffer_ = buf;
-  have_new_buffer_ = true;
-
-}
-
 void GstEngine::FadeoutFinished() {
 
   fadeout_pipeline_.reset();
@@ -655,6 +730,8 @@ void GstEngine::SeekNow() {
 
 void GstEngine::PlayDone(const GstStateChangeReturn ret, const quint64 offset_nanosec, const int pipeline_id) {
 
+  TRACE_SCOPE("engine", "GstEngine::PlayDone");
+
   if (!current_pipeline_ || pipeline_id != current_pipeline_->id()) {
     return;
   }
@@ -698,6 +775,17 @@ void GstEngine::BufferingStarted() {
   buffering_task_id_ = task_manager_->StartTask(tr("Buffering"));
   task_manager_->SetTaskProgress(buffering_task_id_, 0, 100);
 
+  // The pipelines only start buffering while playing, so this is an underrun.
+  metrics_.AddUnderrun();
+  underrun_timer_.start();
+
+  // Give streams from this server more time next time it runs dry.
+  if (adaptive_buffering_ && current_pipeline_ && IsNetworkStream(current_pipeline_->stream_url())) {
+    const quint64 duration = std::min(std::max(current_pipeline_->buffer_duration_nanosec(), kAdaptiveBufferMinNanosec) * 2, kAdaptiveBufferMaxNanosec);
+    adaptive_buffer_durations_.insert(current_pipeline_->stream_url().host(), duration);
+    current_pipeline_->SetBufferDurationNanosec(duration);
+  }
+
 }
 
 void GstEngine::BufferingProgress(const int percent) {
@@ -711,6 +799,63 @@ void GstEngine::BufferingFinished() {
     buffering_task_id_ = -1;
   }
 
+  if (underrun_timer_.isValid()) {
+    metrics_.AddUnderrunFinished(underrun_timer_.elapsed());
+    underrun_timer_.invalidate();
+  }
+
+}
+
+void GstEngine::PlaybackStarted(const int pipeline_id, const qint64 startup_nanosec) {
+
+  if (!current_pipeline_ || current_pipeline_->id() != pipeline_id) return;
+
+  qLog(Debug) << "Pipeline" << pipeline_id << "started playing after" << startup_nanosec / kNsecPerMsec << "ms";
+  if (task_manager_) task_manager_->ResumeBackgroundJobs();
+  metrics_.AddTrackStarted(startup_nanosec / kNsecPerMsec);
+
+}
+
+void GstEngine::QueueRatesChanged(const int pipeline_id, const int avg_in, const int avg_out) {
+
+  if (!adaptive_buffering_ || !current_pipeline_ || current_pipeline_->id() != pipeline_id || !IsNetworkStream(current_pipeline_->stream_url())) return;
+  if (adaptive_buffer_reduced_pipeline_id_ == pipeline_id || current_pipeline_->is_buffering()) return;
+
+  // Data arriving several times faster than it's played, the next streams from this server start faster with a smaller buffer.
+  if (avg_in >= avg_out * kAdaptiveBufferFastLinkFactor) {
+    adaptive_buffer_reduced_pipeline_id_ = pipeline_id;
+    const QString host = current_pipeline_->stream_url().host();
+    const quint64 duration = std::max(adaptive_buffer_durations_.value(host, buffer_duration_nanosec_) / 2, kAdaptiveBufferMinNanosec);
+    qLog(Debug) << "Fast connection to" << host << "using buffer duration" << duration / kNsecPerMsec << "ms for the next streams";
+    adaptive_buffer_durations_.insert(host, duration);
+  }
+
+}
+
+bool GstEngine::IsNetworkStream(const QUrl &url) {
+
+  return url.scheme() == QLatin1String("http") || url.scheme() == QLatin1String("https");
+
+}
+
+void GstEngine::QueueLevelChanged(const int pipeline_id, const int percent) {
+
+  if (!current_pipeline_ || current_pipeline_->id() != pipeline_id) return;
+
+  metrics_.AddQueueLevel(percent);
+
+}
+
+QUrl GstEngine::AudioCacheUrl(const QUrl &media_url, const QUrl &stream_url) {
+
+  if (!audio_cache_enabled_ || !audio_cache_) return stream_url;
+
+  const QUrl cached_url = audio_cache_->Find(media_url);
+  if (!cached_url.isValid()) return stream_url;
+
+  qLog(Debug) << "Playing" << media_url << "from the audio cache";
+  return cached_url;
+
 }
 
 QByteArray GstEngine::FixupUrl(const QUrl &url) {
@@ -801,6 +946,8 @@ SharedPtr<GstEnginePipeline> GstEngine::CreatePipeline() {
   SharedPtr<GstEnginePipeline> ret = make_shared<GstEnginePipeline>();
   ret->set_output_device(output_, device_);
   ret->set_exclusive_mode(exclusive_mode_);
+  ret->set_low_latency(low_latency_);
+  ret->set_bit_perfect(bit_perfect_);
   ret->set_volume_enabled(volume_control_);
   ret->set_stereo_balancer_enabled(stereo_balancer_enabled_);
   ret->set_equalizer_enabled(equalizer_enabled_);
@@ -813,7 +960,9 @@ SharedPtr<GstEnginePipeline> GstEngine::CreatePipeline() {
   ret->set_channels(channels_enabled_, channels_);
   ret->set_bs2b_enabled(bs2b_enabled_);
   ret->set_strict_ssl_enabled(strict_ssl_enabled_);
+  ret->set_audio_cache(audio_cache_enabled_ ? audio_cache_ : nullptr);
   ret->set_fading_enabled(fadeout_enabled_ || autocrossfade_enabled_ || fadeout_pause_enabled_);
+  ret->set_additional_outputs(additional_outputs_);
 
   ret->AddBufferConsumer(this);
   for (GstBufferConsumer *consumer : std::as_const(buffer_consumers_)) {
@@ -826,6 +975,9 @@ SharedPtr<GstEnginePipeline> GstEngine::CreatePipeline() {
   QObject::connect(&*ret, &GstEnginePipeline::BufferingStarted, this, &GstEngine::BufferingStarted);
   QObject::connect(&*ret, &GstEnginePipeline::BufferingProgress, this, &GstEngine::BufferingProgress);
   QObject::connect(&*ret, &GstEnginePipeline::BufferingFinished, this, &GstEngine::BufferingFinished);
+  QObject::connect(&*ret, &GstEnginePipeline::PlaybackStarted, this, &GstEngine::PlaybackStarted);
+  QObject::connect(&*ret, &GstEnginePipeline::QueueLevelChanged, this, &GstEngine::QueueLevelChanged);
+  QObject::connect(&*ret, &GstEnginePipeline::QueueRatesChanged, this, &GstEngine::QueueRatesChanged);
   QObject::connect(&*ret, &GstEnginePipeline::VolumeChanged, this, &EngineBase::UpdateVolume);
   QObject::connect(&*ret, &GstEnginePipeline::AboutToFinish, this, &EngineBase::EmitAboutToFinish);
 
@@ -835,7 +987,15 @@ SharedPtr<GstEnginePipeline> GstEngine::CreatePipeline() {
 
 SharedPtr<GstEnginePipeline> GstEngine::CreatePipeline(const QUrl &media_url, const QUrl &stream_url, const QByteArray &gst_url, const qint64 end_nanosec, const double ebur128_loudness_normalizing_gain_db) {
 
-  SharedPtr<GstEnginePipeline> ret = CreatePipeline();
+  SharedPtr<GstEnginePipeline> ret;
+  if (spare_pipeline_) {
+    ret = spare_pipeline_;
+    spare_pipeline_.reset();
+  }
+  else {
+    ret = CreatePipeline();
+  }
+
   QString error;
   if (!ret->InitFromUrl(media_url, stream_url, gst_url, end_nanosec, ebur128_loudness_normalizing_gain_db, error)) {
     ret.reset();
@@ -843,70 +1003,55 @@ SharedPtr<GstEnginePipeline> GstEngine::CreatePipeline(const QUrl &media_url, co
     emit StateChanged(EngineBase::State::Error);
     emit FatalError();
   }
+  else if (adaptive_buffering_ && IsNetworkStream(stream_url)) {
+    ret->SetBufferDurationNanosec(adaptive_buffer_durations_.value(stream_url.host(), buffer_duration_nanosec_));
+  }
 
   return ret;
 
 }
 
-void GstEngine::UpdateScope(const int chunk_length) {
+void GstEngine::CreateSparePipeline() {
 
-  using sample_type = EngineBase::Scope::value_type;
+  if (spare_pipeline_ || !current_pipeline_) return;
 
-  // Prevent dbz or invalid chunk size
-  if (!GST_CLOCK_TIME_IS_VALID(GST_BUFFER_DURATION(latest_buffer_))) return;
-  if (GST_BUFFER_DURATION(latest_buffer_) == 0) return;
+  // Built while the current track plays, so the next track that isn't gapless doesn't have to wait for the elements to be created and linked.
+  SharedPtr<GstEnginePipeline> pipeline = CreatePipeline();
+  QString error;
+  if (pipeline->Init(error)) {
+    spare_pipeline_ = pipeline;
+  }
+  else {
+    qLog(Error) << "Failed to create spare pipeline:" << error;
+  }
 
-  GstMapInfo map;
-  gst_buffer_map(latest_buffer_, &map, GST_MAP_READ);
+}
 
-  // Determine where to split the buffer
-  int chunk_density = static_cast<int>((map.size * kNsecPerMsec) / GST_BUFFER_DURATION(latest_buffer_));
+void GstEngine::RebuildPipeline() {
 
-  int chunk_size = chunk_length * chunk_density;
+  // Pipelines only get the elements for the processing that is enabled when they're created,
+  // so the current track is restarted at the same position with a new pipeline.
+  if (!current_pipeline_ || current_pipeline_->is_buffering() || state() != EngineBase::State::Playing) return;
 
-  // In case a buffer doesn't arrive in time
-  if (scope_chunk_ >= scope_chunks_) {
-    scope_chunk_ = 0;
-    gst_buffer_unmap(latest_buffer_, &map);
-    return;
-  }
+  qLog(Debug) << "Rebuilding pipeline for" << current_pipeline_->media_url();
 
-  const sample_type *source = reinterpret_cast<sample_type*>(map.data);
-  sample_type *dest = scope_.data();
-  source += (chunk_size / sizeof(sample_type)) * scope_chunk_;
+  const qint64 offset_nanosec = position_nanosec();
+  SharedPtr<GstEnginePipeline> pipeline = CreatePipeline(current_pipeline_->media_url(), current_pipeline_->stream_url(), current_pipeline_->gst_url(), end_nanosec_, current_pipeline_->ebur128_loudness_normalizing_gain_db());
+  if (!pipeline) return;
 
-  size_t bytes = 0;
+  current_pipeline_ = pipeline;
 
-  // Make sure we don't go beyond the end of the buffer
-  if (scope_chunk_ == scope_chunks_ - 1) {
-    bytes = qMin(static_cast<EngineBase::Scope::size_type>(map.size - (chunk_size * scope_chunk_)), scope_.size() * sizeof(sample_type));
-  }
-  else {
-    bytes = qMin(static_cast<EngineBase::Scope::size_type>(chunk_size), scope_.size() * sizeof(sample_type));
-  }
+  SetVolume(volume_);
+  SetStereoBalance(stereo_balance_);
+  SetEqualizerParameters(equalizer_preamp_, equalizer_gains_);
 
-  scope_chunk_++;
+  Play(offset_nanosec > 0 ? static_cast<quint64>(offset_nanosec) : 0);
 
-  if (buffer_format_.startsWith(QLatin1String("S16LE")) ||
-      buffer_format_.startsWith(QLatin1String("U16LE")) ||
-      buffer_format_.startsWith(QLatin1String("S24LE")) ||
-      buffer_format_.startsWith(QLatin1String("S24_32LE")) ||
-      buffer_format_.startsWith(QLatin1String("S32LE")) ||
-      buffer_format_.startsWith(QLatin1String("F32LE"))
-  ) {
-    memcpy(dest, source, bytes);
-  }
-  else {
-    memset(dest, 0, bytes);
-  }
+}
 
-  gst_buffer_unmap(latest_buffer_, &map);
+void GstEngine::ResetSparePipeline() {
 
-  if (scope_chunk_ == scope_chunks_) {
-    gst_buffer_unref(latest_buffer_);
-    latest_buffer_ = nullptr;
-    buffer_format_.clear();
-  }
+  if (spare_pipeline_) spare_pipeline_.reset();
 
 }
 
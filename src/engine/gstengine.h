@@ -26,6 +26,7 @@
 #include "config.h"
 
 #include <optional>
+#include <atomic>
 
 #include <gst/gst.h>
 #include <gst/pbutils/pbutils.h>
@@ -37,16 +38,20 @@
 #include <QList>
 #include <QString>
 #include <QUrl>
+#include <QElapsedTimer>
+#include <QHash>
 
 #include "core/shared_ptr.h"
 #include "enginebase.h"
 #include "gststartup.h"
 #include "gstbufferconsumer.h"
+#include "gstenginepipeline.h"
+#include "pcmringbuffer.h"
 
 class QTimer;
 class QTimerEvent;
 class TaskManager;
-class GstEnginePipeline;
+class AudioCache;
 
 class GstEngine : public EngineBase, public GstBufferConsumer {
   Q_OBJECT
@@ -86,7 +91,7 @@ class GstEngine : public EngineBase, public GstBufferConsumer {
   void SetStartup(GstStartup *gst_startup) { gst_startup_ = gst_startup; }
   void EnsureInitialized() { gst_startup_->EnsureInitialized(); }
 
-  void ConsumeBuffer(GstBuffer *buffer, const int pipeline_id, const QString &format) override;
+  void ConsumeBuffer(GstBuffer *buffer, const int pipeline_id, const QString &format, const int channels, const int rate) override;
 
  public slots:
   void ReloadSettings() override;
@@ -113,17 +118,23 @@ class GstEngine : public EngineBase, public GstBufferConsumer {
   void EndOfStreamReached(const int pipeline_id, const bool has_next_track);
   void HandlePipelineError(const int pipeline_id, const int domain, const int error_code, const QString &message, const QString &debugstr);
   void NewMetaData(const int pipeline_id, const EngineMetadata &engine_metadata);
-  void AddBufferToScope(GstBuffer *buf, const int pipeline_id, const QString &format);
   void FadeoutFinished();
   void FadeoutPauseFinished();
   void SeekNow();
   void PlayDone(const GstStateChangeReturn ret, const quint64, const int);
+  void CreateSparePipeline();
 
   void BufferingStarted();
   void BufferingProgress(int percent);
   void BufferingFinished();
 
+  void PlaybackStarted(const int pipeline_id, const qint64 startup_nanosec);
+  void QueueLevelChanged(const int pipeline_id, const int percent);
+  void QueueRatesChanged(const int pipeline_id, const int avg_in, const int avg_out);
+
  private:
+  // Returns the file from the audio cache instead of the stream URL if the song was downloaded before.
+  QUrl AudioCacheUrl(const QUrl &media_url, const QUrl &stream_url);
   QByteArray FixupUrl(const QUrl &url);
 
   void StartFadeout();
@@ -135,7 +146,11 @@ class GstEngine : public EngineBase, public GstBufferConsumer {
   SharedPtr<GstEnginePipeline> CreatePipeline();
   SharedPtr<GstEnginePipeline> CreatePipeline(const QUrl &media_url, const QUrl &stream_url, const QByteArray &gst_url, const qint64 end_nanosec, const double ebur128_loudness_normalizing_gain_db);
 
-  void UpdateScope(int chunk_length);
+  static bool IsScopeFormat(const QString &format);
+  static bool IsNetworkStream(const QUrl &url);
+
+  void ResetSparePipeline();
+  void RebuildPipeline();
 
   static void StreamDiscovered(GstDiscoverer*, GstDiscovererInfo *info, GError*, gpointer self);
   static void StreamDiscoveryFinished(GstDiscoverer*, gpointer);
@@ -158,20 +173,30 @@ class GstEngine : public EngineBase, public GstBufferConsumer {
   static const qint64 kTimerIntervalNanosec;
   static const qint64 kPreloadGapNanosec;
   static const qint64 kSeekDelayNanosec;
+  static const size_t kScopeBufferSize;
+  static const size_t kScopeMaxBacklogMsec;
+  static const quint64 kAdaptiveBufferMinNanosec;
+  static const int kBackgroundJobsPauseMsec;
+  static const quint64 kAdaptiveBufferMaxNanosec;
+  static const int kAdaptiveBufferFastLinkFactor;
 
   SharedPtr<TaskManager> task_manager_;
   GstStartup *gst_startup_;
   GstDiscoverer *discoverer_;
 
   int buffering_task_id_;
+  QElapsedTimer underrun_timer_;
 
   SharedPtr<GstEnginePipeline> current_pipeline_;
   SharedPtr<GstEnginePipeline> fadeout_pipeline_;
   SharedPtr<GstEnginePipeline> fadeout_pause_pipeline_;
+  // Pipeline with the audio bin already built, used for the next track that isn't played gapless.
+  SharedPtr<GstEnginePipeline> spare_pipeline_;
 
-  QList<GstBufferConsumer*> buffer_consumers_;
+  SharedPtr<AudioCache> audio_cache_;
+  bool audio_cache_enabled_;
 
-  GstBuffer *latest_buffer_;
+  QList<GstBufferConsumer*> buffer_consumers_;
 
   bool stereo_balancer_enabled_;
   float stereo_balance_;
@@ -190,10 +215,17 @@ class GstEngine : public EngineBase, public GstBufferConsumer {
   bool is_fading_out_to_pause_;
   bool has_faded_out_;
 
-  int scope_chunk_;
-  bool have_new_buffer_;
-  int scope_chunks_;
-  QString buffer_format_;
+  // Samples for the analyzers, written from the streaming thread of the current pipeline.
+  PCMRingBuffer scope_buffer_;
+  std::atomic<int> scope_pipeline_id_;
+  std::atomic_flag scope_writing_ = ATOMIC_FLAG_INIT;
+
+  // Buffer durations learned per server for the adaptive buffering.
+  QHash<QString, quint64> adaptive_buffer_durations_;
+  int adaptive_buffer_reduced_pipeline_id_;
+
+  // Extra outputs fed from the same decode as the main output.
+  GstEnginePipeline::AdditionalOutputList additional_outputs_;
 
   int discovery_finished_cb_id_;
   int discovery_discovered_cb_id_;
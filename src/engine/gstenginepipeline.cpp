@@ -26,11 +26,15 @@
 #include <cstdint>
 #include <cstring>
 #include <cmath>
+#include <algorithm>
+#include <limits>
 
 #include <glib.h>
 #include <glib-object.h>
 #include <gst/gst.h>
 #include <gst/audio/audio.h>
+#include <gst/controller/gstinterpolationcontrolsource.h>
+#include <gst/controller/gstdirectcontrolbinding.h>
 
 #ifdef Q_OS_UNIX
 #  include <pthread.h>
@@ -39,6 +43,14 @@
 #  include <windows.h>
 #endif
 
+#if defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#  define HAVE_SSE2
+#  include <emmintrin.h>
+#elif defined(__ARM_NEON) || defined(_M_ARM64)
+#  define HAVE_NEON
+#  include <arm_neon.h>
+#endif
+
 #include <QObject>
 #include <QCoreApplication>
 #include <QtConcurrent>
@@ -61,20 +73,124 @@
 #include "gstengine.h"
 #include "gstenginepipeline.h"
 #include "gstbufferconsumer.h"
+#include "gstaudiocachewriter.h"
 
 constexpr int GstEnginePipeline::kGstStateTimeoutNanosecs = 10000000;
 constexpr int GstEnginePipeline::kFaderFudgeMsec = 2000;
+constexpr int GstEnginePipeline::kFaderCurveStepMsec = 10;
+constexpr gint64 GstEnginePipeline::kLowLatencyBufferTimeUsec = 20000;
+constexpr gint64 GstEnginePipeline::kLowLatencyLatencyTimeUsec = 5000;
 
 constexpr int GstEnginePipeline::kEqBandCount = 10;
+constexpr int GstEnginePipeline::kEqualizerUpdateMsec = 20;
 constexpr int GstEnginePipeline::kEqBandFrequencies[] = { 60, 170, 310, 600, 1000, 3000, 6000, 12000, 14000, 16000 };
 
 int GstEnginePipeline::sId = 1;
 
+namespace {
+
+// Conversions of the buffers passed to the analyzer to S16LE, the vectorized loops handle 8 samples at a time and the rest is converted one by one.
+// Float samples are clamped, the same as the vector instructions saturate.
+
+void ConvertS32ToS16(const qint32 *s, qint16 *d, const gsize count) {
+
+  gsize i = 0;
+#if defined(HAVE_SSE2)
+  for (; i + 8 <= count; i += 8) {
+    const __m128i a = _mm_srai_epi32(_mm_loadu_si128(reinterpret_cast<const __m128i*>(s + i)), 16);
+    const __m128i b = _mm_srai_epi32(_mm_loadu_si128(reinterpret_cast<const __m128i*>(s + i + 4)), 16);
+    _mm_storeu_si128(reinterpret_cast<__m128i*>(d + i), _mm_packs_epi32(a, b));
+  }
+#elif defined(HAVE_NEON)
+  for (; i + 8 <= count; i += 8) {
+    vst1q_s16(d + i, vcombine_s16(vshrn_n_s32(vld1q_s32(s + i), 16), vshrn_n_s32(vld1q_s32(s + i + 4), 16)));
+  }
+#endif
+  for (; i < count; ++i) {
+    d[i] = static_cast<qint16>(s[i] >> 16);
+  }
+
+}
+
+void ConvertS24_32ToS16(const qint32 *s, qint16 *d, const gsize count) {
+
+  // The sample is in the lower 24 bits, the upper byte is ignored.
+  gsize i = 0;
+#if defined(HAVE_SSE2)
+  for (; i + 8 <= count; i += 8) {
+    const __m128i a = _mm_srai_epi32(_mm_slli_epi32(_mm_loadu_si128(reinterpret_cast<const __m128i*>(s + i)), 8), 16);
+    const __m128i b = _mm_srai_epi32(_mm_slli_epi32(_mm_loadu_si128(reinterpret_cast<const __m128i*>(s + i + 4)), 8), 16);
+    _mm_storeu_si128(reinterpret_cast<__m128i*>(d + i), _mm_packs_epi32(a, b));
+  }
+#elif defined(HAVE_NEON)
+  for (; i + 8 <= count; i += 8) {
+    vst1q_s16(d + i, vcombine_s16(vshrn_n_s32(vshlq_n_s32(vld1q_s32(s + i), 8), 16), vshrn_n_s32(vshlq_n_s32(vld1q_s32(s + i + 4), 8), 16)));
+  }
+#endif
+  for (; i < count; ++i) {
+    d[i] = static_cast<qint16>(static_cast<quint32>(s[i]) >> 8);
+  }
+
+}
+
+void ConvertS24ToS16(const guint8 *s, qint16 *d, const gsize count) {
+
+  // Packed 3 byte samples, the two upper bytes are the 16 bit sample.
+  for (gsize i = 0; i < count; ++i) {
+    d[i] = static_cast<qint16>(static_cast<quint16>(s[i * 3 + 1]) | (static_cast<quint16>(s[i * 3 + 2]) << 8));
+  }
+
+}
+
+void ConvertF32ToS16(const float *s, qint16 *d, const gsize count) {
+
+  gsize i = 0;
+#if defined(HAVE_SSE2)
+  const __m128 scale = _mm_set1_ps(32768.0F);
+  for (; i + 8 <= count; i += 8) {
+    const __m128i a = _mm_cvttps_epi32(_mm_mul_ps(_mm_loadu_ps(s + i), scale));
+    const __m128i b = _mm_cvttps_epi32(_mm_mul_ps(_mm_loadu_ps(s + i + 4), scale));
+    _mm_storeu_si128(reinterpret_cast<__m128i*>(d + i), _mm_packs_epi32(a, b));
+  }
+#elif defined(HAVE_NEON)
+  for (; i + 8 <= count; i += 8) {
+    const int16x4_t a = vqmovn_s32(vcvtq_s32_f32(vmulq_n_f32(vld1q_f32(s + i), 32768.0F)));
+    const int16x4_t b = vqmovn_s32(vcvtq_s32_f32(vmulq_n_f32(vld1q_f32(s + i + 4), 32768.0F)));
+    vst1q_s16(d + i, vcombine_s16(a, b));
+  }
+#endif
+  for (; i < count; ++i) {
+    d[i] = static_cast<qint16>(std::clamp(s[i] * 32768.0F, -32768.0F, 32767.0F));
+  }
+
+}
+
+void ConvertF64ToS16(const double *s, qint16 *d, const gsize count) {
+
+  gsize i = 0;
+#if defined(HAVE_SSE2)
+  const __m128d scale = _mm_set1_pd(32768.0);
+  for (; i + 8 <= count; i += 8) {
+    const __m128i a = _mm_unpacklo_epi64(_mm_cvttpd_epi32(_mm_mul_pd(_mm_loadu_pd(s + i), scale)), _mm_cvttpd_epi32(_mm_mul_pd(_mm_loadu_pd(s + i + 2), scale)));
+    const __m128i b = _mm_unpacklo_epi64(_mm_cvttpd_epi32(_mm_mul_pd(_mm_loadu_pd(s + i + 4), scale)), _mm_cvttpd_epi32(_mm_mul_pd(_mm_loadu_pd(s + i + 6), scale)));
+    _mm_storeu_si128(reinterpret_cast<__m128i*>(d + i), _mm_packs_epi32(a, b));
+  }
+#endif
+  for (; i < count; ++i) {
+    d[i] = static_cast<qint16>(std::clamp(s[i] * 32768.0, -32768.0, 32767.0));
+  }
+
+}
+
+}  // namespace
+
 GstEnginePipeline::GstEnginePipeline(QObject *parent)
     : QObject(parent),
       id_(sId++),
       valid_(false),
       exclusive_mode_(false),
+      low_latency_(false),
+      bit_perfect_(false),
       volume_enabled_(true),
       stereo_balancer_enabled_(false),
       eq_enabled_(false),
@@ -82,6 +198,8 @@ GstEnginePipeline::GstEnginePipeline(QObject *parent)
       fading_enabled_(false),
       stereo_balance_(0.0F),
       eq_preamp_(0),
+      eq_applied_preamp_(-1.0F),
+      equalizer_update_pending_(false),
       rg_mode_(0),
       rg_preamp_(0.0),
       rg_fallbackgain_(0.0),
@@ -102,6 +220,8 @@ GstEnginePipeline::GstEnginePipeline(QObject *parent)
       next_beginning_offset_nanosec_(-1),
       next_end_offset_nanosec_(-1),
       ignore_next_seek_(false),
+      seek_in_progress_(false),
+      coalesced_seek_nanosec_(-1),
       ignore_tags_(false),
       pipeline_is_active_(false),
       pipeline_is_connected_(false),
@@ -114,6 +234,13 @@ GstEnginePipeline::GstEnginePipeline(QObject *parent)
       volume_internal_(-1.0),
       volume_percent_(100),
       use_fudge_timer_(false),
+      fader_running_(false),
+      fader_direction_(QTimeLine::Forward),
+      fader_duration_msec_(0),
+      fader_start_time_msec_(0),
+      fader_anchor_stream_time_(GST_CLOCK_TIME_NONE),
+      fader_stream_time_(GST_CLOCK_TIME_NONE),
+      fader_control_source_(nullptr),
       pipeline_(nullptr),
       audiobin_(nullptr),
       audiosink_(nullptr),
@@ -129,6 +256,7 @@ GstEnginePipeline::GstEnginePipeline(QObject *parent)
       eventprobe_(nullptr),
       upstream_events_probe_cb_id_(0),
       buffer_probe_cb_id_(0),
+      fader_probe_cb_id_(0),
       playbin_probe_cb_id_(0),
       element_added_cb_id_(-1),
       element_removed_cb_id_(-1),
@@ -136,7 +264,15 @@ GstEnginePipeline::GstEnginePipeline(QObject *parent)
       notify_source_cb_id_(-1),
       about_to_finish_cb_id_(-1),
       notify_volume_cb_id_(-1),
+      last_taglist_(nullptr),
+      buffer_format_(BufferFormat::Unknown),
+      buffer_channels_(1),
+      buffer_rate_(0),
+      buffer_pool_(nullptr),
+      buffer_pool_size_(0),
       logged_unsupported_analyzer_format_(false),
+      playback_started_(false),
+      queue_level_(-1),
       about_to_finish_(false) {
 
   eq_band_gains_.reserve(kEqBandCount);
@@ -148,13 +284,6 @@ GstEnginePipeline::~GstEnginePipeline() {
 
   if (pipeline_) {
 
-    if (fader_) {
-      if (fader_->state() != QTimeLine::NotRunning) {
-        fader_->stop();
-      }
-      fader_.reset();
-    }
-
     if (element_added_cb_id_ != -1) {
       g_signal_handler_disconnect(G_OBJECT(audiobin_), element_added_cb_id_);
     }
@@ -195,6 +324,14 @@ GstEnginePipeline::~GstEnginePipeline() {
       }
     }
 
+    if (fader_probe_cb_id_ != 0) {
+      GstPad *pad = gst_element_get_static_pad(volume_fading_, "sink");
+      if (pad) {
+        gst_pad_remove_probe(pad, fader_probe_cb_id_);
+        gst_object_unref(pad);
+      }
+    }
+
     {
       GstBus *bus = gst_pipeline_get_bus(GST_PIPELINE(pipeline_));
       if (bus) {
@@ -218,6 +355,22 @@ GstEnginePipeline::~GstEnginePipeline() {
 
   }
 
+  if (last_taglist_) {
+    gst_tag_list_unref(last_taglist_);
+    last_taglist_ = nullptr;
+  }
+
+  if (buffer_pool_) {
+    gst_buffer_pool_set_active(buffer_pool_, FALSE);
+    gst_object_unref(buffer_pool_);
+    buffer_pool_ = nullptr;
+  }
+
+  if (fader_control_source_) {
+    gst_object_unref(fader_control_source_);
+    fader_control_source_ = nullptr;
+  }
+
 }
 
 void GstEnginePipeline::set_output_device(const QString &output, const QVariant &device) {
@@ -231,6 +384,14 @@ void GstEnginePipeline::set_exclusive_mode(const bool exclusive_mode) {
   exclusive_mode_ = exclusive_mode;
 }
 
+void GstEnginePipeline::set_low_latency(const bool low_latency) {
+  low_latency_ = low_latency;
+}
+
+void GstEnginePipeline::set_bit_perfect(const bool bit_perfect) {
+  bit_perfect_ = bit_perfect;
+}
+
 void GstEnginePipeline::set_volume_enabled(const bool enabled) {
   volume_enabled_ = enabled;
 }
@@ -268,6 +429,19 @@ void GstEnginePipeline::set_buffer_duration_nanosec(const quint64 buffer_duratio
   buffer_duration_nanosec_ = buffer_duration_nanosec;
 }
 
+void GstEnginePipeline::SetBufferDurationNanosec(const quint64 buffer_duration_nanosec) {
+
+  buffer_duration_nanosec_ = buffer_duration_nanosec;
+
+  if (audioqueue_ && buffer_duration_nanosec_ > 0) {
+    qLog(Debug) << "Changing buffer duration to" << buffer_duration_nanosec_;
+    g_object_set(G_OBJECT(audioqueue_), "max-size-buffers", 0, nullptr);
+    g_object_set(G_OBJECT(audioqueue_), "max-size-bytes", 0, nullptr);
+    g_object_set(G_OBJECT(audioqueue_), "max-size-time", buffer_duration_nanosec_, nullptr);
+  }
+
+}
+
 void GstEnginePipeline::set_buffer_low_watermark(const double value) {
   buffer_low_watermark_ = value;
 }
@@ -296,10 +470,18 @@ void GstEnginePipeline::set_strict_ssl_enabled(const bool enabled) {
   strict_ssl_enabled_ = enabled;
 }
 
+void GstEnginePipeline::set_audio_cache(SharedPtr<AudioCache> audio_cache) {
+  audio_cache_ = audio_cache;
+}
+
 void GstEnginePipeline::set_fading_enabled(const bool enabled) {
   fading_enabled_ = enabled;
 }
 
+void GstEnginePipeline::set_additional_outputs(const AdditionalOutputList &additional_outputs) {
+  additional_outputs_ = additional_outputs;
+}
+
 QString GstEnginePipeline::GstStateText(const GstState state) {
 
   switch (state) {
@@ -343,6 +525,27 @@ bool GstEnginePipeline::InitFromUrl(const QUrl &media_url, const QUrl &stream_ur
   ebur128_loudness_normalizing_gain_db_ = ebur128_loudness_normalizing_gain_db;
   end_offset_nanosec_ = end_nanosec;
 
+  // The pipeline might already have been created as a spare by the engine.
+  if (pipeline_) {
+    UpdateEBUR128LoudnessNormalizingGaindB();
+  }
+  else if (!Init(error)) {
+    return false;
+  }
+
+  g_object_set(G_OBJECT(pipeline_), "uri", gst_url.constData(), nullptr);
+
+  pipeline_is_connected_ = true;
+  startup_timer_.start();
+
+  return true;
+
+}
+
+bool GstEnginePipeline::Init(QString &error) {
+
+  if (pipeline_) return true;
+
   guint version_major = 0, version_minor = 0, version_micro = 0, version_nano = 0;
   gst_plugins_base_version(&version_major, &version_minor, &version_micro, &version_nano);
   if (QVersionNumber::compare(QVersionNumber(static_cast<int>(version_major), static_cast<int>(version_minor)), QVersionNumber(1, 22)) >= 0) {
@@ -387,10 +590,6 @@ bool GstEnginePipeline::InitFromUrl(const QUrl &media_url, const QUrl &stream_ur
   flags &= ~0x00000010;
   g_object_set(G_OBJECT(pipeline_), "flags", flags, nullptr);
 
-  g_object_set(G_OBJECT(pipeline_), "uri", gst_url.constData(), nullptr);
-
-  pipeline_is_connected_ = true;
-
   return true;
 
 }
@@ -399,6 +598,18 @@ bool GstEnginePipeline::InitAudioBin(QString &error) {
 
   gst_segment_init(&last_playbin_segment_, GST_FORMAT_TIME);
 
+  // Leave out all processing that isn't explicitly turned on by the user for this track, the samples then reach the sink in their native format.
+  // The converters below are in passthrough mode when the sink accepts the format.
+  if (bit_perfect_) {
+    qLog(Debug) << "Bit-perfect mode, disabling fading, replaygain, EBU R 128 loudness normalization, bs2b, channel mixing, software volume and additional outputs.";
+    fading_enabled_ = false;
+    rg_enabled_ = false;
+    ebur128_loudness_normalization_ = false;
+    bs2b_enabled_ = false;
+    channels_enabled_ = false;
+    additional_outputs_.clear();
+  }
+
   // Audio bin
   audiobin_ = gst_bin_new("audiobin");
   if (!audiobin_) return false;
@@ -557,6 +768,19 @@ bool GstEnginePipeline::InitAudioBin(QString &error) {
     g_object_set(G_OBJECT(audiosink_), "exclusive", exclusive_mode_, nullptr);
   }
 
+  // Small ring buffer and segments on the sink, so seeking and pausing take effect at the output right away.
+  // The audio converters are left in place, they're in passthrough mode when the caps already match.
+  if (low_latency_) {
+    if (g_object_class_find_property(G_OBJECT_GET_CLASS(audiosink_), "buffer-time") && g_object_class_find_property(G_OBJECT_GET_CLASS(audiosink_), "latency-time")) {
+      qLog(Debug) << "Setting low latency buffer time" << kLowLatencyBufferTimeUsec << "and latency time" << kLowLatencyLatencyTimeUsec << "for" << output_;
+      g_object_set(G_OBJECT(audiosink_), "buffer-time", kLowLatencyBufferTimeUsec, "latency-time", kLowLatencyLatencyTimeUsec, nullptr);
+    }
+    if (g_object_class_find_property(G_OBJECT_GET_CLASS(audiosink_), "low-latency")) {
+      qLog(Debug) << "Enabling low latency for" << output_;
+      g_object_set(G_OBJECT(audiosink_), "low-latency", TRUE, nullptr);
+    }
+  }
+
 #ifndef Q_OS_WIN32
   if (g_object_class_find_property(G_OBJECT_GET_CLASS(audiosink_), "volume")) {
     qLog(Debug) << output_ << "has volume, enabling volume synchronization.";
@@ -582,7 +806,7 @@ bool GstEnginePipeline::InitAudioBin(QString &error) {
   }
 
   // Create the volume element if it's enabled.
-  if (volume_enabled_ && !volume_) {
+  if (volume_enabled_ && !volume_ && !bit_perfect_) {
     volume_sw_ = CreateElement(QStringLiteral("volume"), QStringLiteral("volume_sw"), audiobin_, error);
     if (!volume_sw_) {
       return false;
@@ -594,6 +818,10 @@ bool GstEnginePipeline::InitAudioBin(QString &error) {
     if (!volume_fading_) {
       return false;
     }
+    // The fade curves are applied by the volume element itself, so the volume is interpolated for every sample.
+    fader_control_source_ = gst_interpolation_control_source_new();
+    g_object_set(G_OBJECT(fader_control_source_), "mode", GST_INTERPOLATION_MODE_LINEAR, nullptr);
+    gst_object_add_control_binding(GST_OBJECT(volume_fading_), gst_direct_control_binding_new_absolute(GST_OBJECT(volume_fading_), "volume", fader_control_source_));
   }
 
   // Create the stereo balancer elements if it's enabled.
@@ -683,7 +911,8 @@ bool GstEnginePipeline::InitAudioBin(QString &error) {
   }
 
   // Create the EBU R 128 loudness normalization volume element if enabled.
-  if (ebur128_loudness_normalization_) {
+  // With a software volume element the gain is folded into its multiplier instead, so only one gain stage runs.
+  if (ebur128_loudness_normalization_ && !volume_sw_) {
     volume_ebur128_ = CreateElement(QStringLiteral("volume"), QStringLiteral("ebur128_volume"), audiobin_, error);
     if (!volume_ebur128_) {
       return false;
@@ -832,10 +1061,9 @@ bool GstEnginePipeline::InitAudioBin(QString &error) {
       qLog(Debug) << "Setting channels to" << channels_;
       gst_caps_set_simple(caps, "channels", G_TYPE_INT, channels_, nullptr);
     }
-    const bool link_filtered_result = gst_element_link_filtered(audiosinkconverter, audiosink_, caps);
+    const bool link_outputs_result = LinkOutputs(audiosinkconverter, caps, error);
     gst_caps_unref(caps);
-    if (!link_filtered_result) {
-      error = QStringLiteral("Failed to link audio sink converter to audio sink with filter for ") + output_;
+    if (!link_outputs_result) {
       return false;
     }
   }
@@ -843,7 +1071,15 @@ bool GstEnginePipeline::InitAudioBin(QString &error) {
   {  // Add probes and handlers.
     GstPad *pad = gst_element_get_static_pad(audioqueueconverter_, "src");
     if (pad) {
-      buffer_probe_cb_id_ = gst_pad_add_probe(pad, GST_PAD_PROBE_TYPE_BUFFER, BufferProbeCallback, this, nullptr);
+      buffer_probe_cb_id_ = gst_pad_add_probe(pad, static_cast<GstPadProbeType>(GST_PAD_PROBE_TYPE_BUFFER | GST_PAD_PROBE_TYPE_EVENT_DOWNSTREAM), BufferProbeCallback, this, nullptr);
+      gst_object_unref(pad);
+    }
+  }
+
+  if (volume_fading_ && fader_control_source_) {
+    GstPad *pad = gst_element_get_static_pad(volume_fading_, "sink");
+    if (pad) {
+      fader_probe_cb_id_ = gst_pad_add_probe(pad, static_cast<GstPadProbeType>(GST_PAD_PROBE_TYPE_BUFFER | GST_PAD_PROBE_TYPE_EVENT_DOWNSTREAM), FaderProbeCallback, this, nullptr);
       gst_object_unref(pad);
     }
   }
@@ -863,6 +1099,105 @@ bool GstEnginePipeline::InitAudioBin(QString &error) {
 
 }
 
+bool GstEnginePipeline::LinkOutputs(GstElement *element_link, GstCaps *caps, QString &error) {
+
+  if (additional_outputs_.isEmpty()) {
+    if (!gst_element_link_filtered(element_link, audiosink_, caps)) {
+      error = QStringLiteral("Failed to link audio sink converter to audio sink with filter for ") + output_;
+      return false;
+    }
+    return true;
+  }
+
+  // Decode and process once, then fan out to the main sink and the additional outputs.
+  // Each output gets its own queue, so a blocking network sink doesn't stall the others.
+  GstElement *tee = CreateElement(QStringLiteral("tee"), QStringLiteral("outputtee"), audiobin_, error);
+  if (!tee) {
+    return false;
+  }
+  GstElement *audiosinkqueue = CreateElement(QStringLiteral("queue"), QStringLiteral("audiosinkqueue"), audiobin_, error);
+  if (!audiosinkqueue) {
+    return false;
+  }
+
+  if (!gst_element_link_filtered(element_link, tee, caps)) {
+    error = QStringLiteral("Failed to link audio sink converter to output tee with filter for ") + output_;
+    return false;
+  }
+  if (!gst_element_link_many(tee, audiosinkqueue, audiosink_, nullptr)) {
+    error = QStringLiteral("Failed to link output tee to audio sink ") + output_;
+    return false;
+  }
+
+  for (int i = 0; i < additional_outputs_.count(); ++i) {
+    if (!CreateAdditionalOutput(tee, i, additional_outputs_[i], error)) {
+      return false;
+    }
+  }
+
+  return true;
+
+}
+
+bool GstEnginePipeline::CreateAdditionalOutput(GstElement *tee, const int index, const AdditionalOutput &additional_output, QString &error) {
+
+  // An output that can't be created is skipped, it shouldn't prevent playback on the others.
+  GError *gerror = nullptr;
+  GstElement *output = gst_parse_bin_from_description(additional_output.description.toUtf8().constData(), TRUE, &gerror);
+  if (!output) {
+    qLog(Error) << "Failed to create additional output" << additional_output.description << (gerror ? gerror->message : "");
+    if (gerror) g_error_free(gerror);
+    return true;
+  }
+  if (gerror) {
+    qLog(Warning) << "Additional output" << additional_output.description << gerror->message;
+    g_error_free(gerror);
+  }
+  gst_bin_add(GST_BIN(audiobin_), output);
+
+  GstElement *queue = CreateElement(QStringLiteral("queue"), QStringLiteral("additionaloutputqueue%1").arg(index), audiobin_, error);
+  if (!queue) {
+    return false;
+  }
+  GstElement *converter = CreateElement(QStringLiteral("audioconvert"), QStringLiteral("additionaloutputconverter%1").arg(index), audiobin_, error);
+  if (!converter) {
+    return false;
+  }
+  GstElement *resampler = CreateElement(QStringLiteral("audioresample"), QStringLiteral("additionaloutputresampler%1").arg(index), audiobin_, error);
+  if (!resampler) {
+    return false;
+  }
+  GstElement *volume = CreateElement(QStringLiteral("volume"), QStringLiteral("additionaloutputvolume%1").arg(index), audiobin_, error);
+  if (!volume) {
+    return false;
+  }
+  g_object_set(G_OBJECT(volume), "volume", qBound(0.0, additional_output.volume, 10.0), nullptr);
+
+  if (!gst_element_link_many(tee, queue, converter, resampler, volume, output, nullptr)) {
+    error = QStringLiteral("Failed to link additional output ") + additional_output.description;
+    return false;
+  }
+
+  if (additional_output.latency_nanosec != 0) {
+    GstIterator *it = gst_bin_iterate_sinks(GST_BIN(output));
+    GValue item = G_VALUE_INIT;
+    while (gst_iterator_next(it, &item) == GST_ITERATOR_OK) {
+      GstElement *sink = GST_ELEMENT(g_value_get_object(&item));
+      if (g_object_class_find_property(G_OBJECT_GET_CLASS(sink), "ts-offset")) {
+        g_object_set(G_OBJECT(sink), "ts-offset", static_cast<gint64>(additional_output.latency_nanosec), nullptr);
+      }
+      g_value_reset(&item);
+    }
+    g_value_unset(&item);
+    gst_iterator_free(it);
+  }
+
+  qLog(Debug) << "Created additional output" << additional_output.description << "with volume" << additional_output.volume << "and latency" << additional_output.latency_nanosec;
+
+  return true;
+
+}
+
 void GstEnginePipeline::SetupVolume(GstElement *element) {
 
   if (volume_) {
@@ -877,14 +1212,9 @@ void GstEnginePipeline::SetupVolume(GstElement *element) {
   volume_ = element;
   volume_set_ = false;
 
-  // Make sure the unused volume element is set to 1.0.
+  // Make sure the unused volume element is only applying the loudness normalizing gain.
   if (volume_sw_ && volume_sw_ != volume_) {
-    double volume_internal = 1.0;
-    g_object_get(G_OBJECT(volume_sw_), "volume", &volume_internal, nullptr);
-    if (volume_internal != 1.0) {
-      volume_internal = 1.0;
-      g_object_set(G_OBJECT(volume_sw_), "volume", volume_internal, nullptr);
-    }
+    UpdateSoftwareVolume();
   }
 
 }
@@ -996,6 +1326,15 @@ void GstEnginePipeline::SourceSetupCallback(GstElement *playbin, GstElement *sou
     }
   }
 
+  // Only songs from the streaming services are cached, their media URL is resolved to an HTTP stream URL by a URL handler.
+  if (instance->audio_cache_ && qstrcmp(G_OBJECT_TYPE_NAME(source), "GstSoupHTTPSrc") == 0) {
+    const QUrl media_url = instance->next_uri_set_ ? instance->next_media_url_ : instance->media_url_;
+    const QUrl stream_url = instance->next_uri_set_ ? instance->next_stream_url_ : instance->stream_url_;
+    if (media_url.scheme() != stream_url.scheme() && (stream_url.scheme() == QLatin1String("http") || stream_url.scheme() == QLatin1String("https"))) {
+      GstAudioCacheWriter::Attach(instance->audio_cache_, media_url, source);
+    }
+  }
+
   // If the pipeline was buffering we stop that now.
   if (instance->buffering_) {
     instance->buffering_ = false;
@@ -1015,6 +1354,9 @@ void GstEnginePipeline::NotifyVolumeCallback(GstElement *element, GParamSpec *pa
   if (!instance->volume_set_) return;
 
   g_object_get(G_OBJECT(instance->volume_), "volume", &instance->volume_internal_, nullptr);
+  if (instance->volume_ == instance->volume_sw_) {
+    instance->volume_internal_ /= instance->EBUR128LoudnessNormalizingGainMultiplier();
+  }
 
   const uint volume_percent = static_cast<uint>(qBound(0L, lround(instance->volume_internal_ / 0.01), 100L));
   if (volume_percent != instance->volume_percent_) {
@@ -1096,128 +1438,169 @@ GstPadProbeReturn GstEnginePipeline::PlaybinProbeCallback(GstPad *pad, GstPadPro
 
 }
 
-GstPadProbeReturn GstEnginePipeline::BufferProbeCallback(GstPad *pad, GstPadProbeInfo *info, gpointer self) {
-
-  GstEnginePipeline *instance = reinterpret_cast<GstEnginePipeline*>(self);
+void GstEnginePipeline::SetBufferFormat(GstCaps *caps) {
 
-  QString format;
-  int channels = 1;
-  int rate = 0;
+  buffer_format_ = BufferFormat::Unknown;
+  buffer_format_name_.clear();
+  buffer_channels_ = 1;
+  buffer_rate_ = 0;
 
-  GstCaps *caps = gst_pad_get_current_caps(pad);
-  if (caps) {
-    GstStructure *structure = gst_caps_get_structure(caps, 0);
-    if (structure) {
-      format = QString::fromUtf8(gst_structure_get_string(structure, "format"));
-      gst_structure_get_int(structure, "channels", &channels);
-      gst_structure_get_int(structure, "rate", &rate);
-    }
-    gst_caps_unref(caps);
-  }
+  if (!caps) return;
 
-  GstBuffer *buf = gst_pad_probe_info_get_buffer(info);
-  GstBuffer *buf16 = nullptr;
+  GstStructure *structure = gst_caps_get_structure(caps, 0);
+  if (!structure) return;
 
-  quint64 start_time = GST_BUFFER_TIMESTAMP(buf) - instance->segment_start_;
-  quint64 duration = GST_BUFFER_DURATION(buf);
-  qint64 end_time = static_cast<qint64>(start_time + duration);
+  buffer_format_name_ = QString::fromUtf8(gst_structure_get_string(structure, "format"));
+  gst_structure_get_int(structure, "channels", &buffer_channels_);
+  gst_structure_get_int(structure, "rate", &buffer_rate_);
 
-  if (format.startsWith(QLatin1String("S16LE"))) {
-    instance->logged_unsupported_analyzer_format_ = false;
-  }
-  else if (format.startsWith(QLatin1String("S32LE"))) {
+  if (buffer_format_name_ == QLatin1String("S16LE")) buffer_format_ = BufferFormat::S16LE;
+  else if (buffer_format_name_ == QLatin1String("S32LE")) buffer_format_ = BufferFormat::S32LE;
+  else if (buffer_format_name_ == QLatin1String("F32LE")) buffer_format_ = BufferFormat::F32LE;
+  else if (buffer_format_name_ == QLatin1String("F64LE")) buffer_format_ = BufferFormat::F64LE;
+  else if (buffer_format_name_ == QLatin1String("S24LE")) buffer_format_ = BufferFormat::S24LE;
+  else if (buffer_format_name_ == QLatin1String("S24_32LE")) buffer_format_ = BufferFormat::S24_32LE;
 
-    GstMapInfo map_info;
-    gst_buffer_map(buf, &map_info, GST_MAP_READ);
+}
 
-    int32_t *s = reinterpret_cast<int32_t*>(map_info.data);
-    int samples = static_cast<int>((map_info.size / sizeof(int32_t)) / channels);
-    int buf16_size = samples * static_cast<int>(sizeof(int16_t)) * channels;
-    int16_t *d = static_cast<int16_t*>(g_malloc(buf16_size));
-    memset(d, 0, buf16_size);
-    for (int i = 0; i < (samples * channels); ++i) {
-      d[i] = static_cast<int16_t>((s[i] >> 16));
-    }
-    gst_buffer_unmap(buf, &map_info);
-    buf16 = gst_buffer_new_wrapped(d, buf16_size);
-    GST_BUFFER_DURATION(buf16) = GST_FRAMES_TO_CLOCK_TIME(samples * sizeof(int16_t) * channels, rate);
-    buf = buf16;
+gsize GstEnginePipeline::BufferFormatSampleSize(const BufferFormat buffer_format) {
 
-    instance->logged_unsupported_analyzer_format_ = false;
+  switch (buffer_format) {
+    case BufferFormat::S16LE:
+      return 2;
+    case BufferFormat::S24LE:
+      return 3;
+    case BufferFormat::S32LE:
+    case BufferFormat::F32LE:
+    case BufferFormat::S24_32LE:
+      return 4;
+    case BufferFormat::F64LE:
+      return 8;
+    case BufferFormat::Unknown:
+      break;
   }
 
-  else if (format.startsWith(QLatin1String("F32LE"))) {
+  return 1;
+
+}
 
-    GstMapInfo map_info;
-    gst_buffer_map(buf, &map_info, GST_MAP_READ);
+GstBuffer *GstEnginePipeline::AcquireS16Buffer(const gsize size) {
 
-    float *s = reinterpret_cast<float*>(map_info.data);
-    int samples = static_cast<int>((map_info.size / sizeof(float)) / channels);
-    int buf16_size = samples * static_cast<int>(sizeof(int16_t)) * channels;
-    int16_t *d = static_cast<int16_t*>(g_malloc(buf16_size));
-    memset(d, 0, buf16_size);
-    for (int i = 0; i < (samples * channels); ++i) {
-      float sample_float = (s[i] * static_cast<float>(32768.0));
-      d[i] = static_cast<int16_t>(sample_float);
+  // The buffers return to the pool when the consumers are done with them, a new pool is only needed when the buffers get bigger.
+  if (!buffer_pool_ || size > buffer_pool_size_) {
+    if (buffer_pool_) {
+      gst_buffer_pool_set_active(buffer_pool_, FALSE);
+      gst_object_unref(buffer_pool_);
     }
-    gst_buffer_unmap(buf, &map_info);
-    buf16 = gst_buffer_new_wrapped(d, buf16_size);
-    GST_BUFFER_DURATION(buf16) = GST_FRAMES_TO_CLOCK_TIME(samples * sizeof(int16_t) * channels, rate);
-    buf = buf16;
+    buffer_pool_ = gst_buffer_pool_new();
+    buffer_pool_size_ = size;
+    GstStructure *config = gst_buffer_pool_get_config(buffer_pool_);
+    gst_buffer_pool_config_set_params(config, nullptr, static_cast<guint>(buffer_pool_size_), 0, 0);
+    if (!gst_buffer_pool_set_config(buffer_pool_, config) || !gst_buffer_pool_set_active(buffer_pool_, TRUE)) {
+      gst_object_unref(buffer_pool_);
+      buffer_pool_ = nullptr;
+      buffer_pool_size_ = 0;
+      return nullptr;
+    }
+  }
 
-    instance->logged_unsupported_analyzer_format_ = false;
+  GstBuffer *buffer = nullptr;
+  if (gst_buffer_pool_acquire_buffer(buffer_pool_, &buffer, nullptr) != GST_FLOW_OK) {
+    return nullptr;
   }
-  else if (format.startsWith(QLatin1String("S24LE"))) {
+  gst_buffer_set_size(buffer, static_cast<gssize>(size));
 
-    GstMapInfo map_info;
-    gst_buffer_map(buf, &map_info, GST_MAP_READ);
+  return buffer;
 
-    int8_t *s24 = reinterpret_cast<int8_t*>(map_info.data);
-    int8_t *s24e = s24 + map_info.size;
-    int samples = static_cast<int>((map_info.size / sizeof(int8_t)) / channels);
-    int buf16_size = samples * static_cast<int>(sizeof(int16_t)) * channels;
-    int16_t *s16 = static_cast<int16_t*>(g_malloc(buf16_size));
-    memset(s16, 0, buf16_size);
-    for (int i = 0; i < (samples * channels); ++i) {
-      s16[i] = *(reinterpret_cast<int16_t*>(s24 + 1));
-      s24 += 3;
-      if (s24 >= s24e) break;
-    }
-    gst_buffer_unmap(buf, &map_info);
-    buf16 = gst_buffer_new_wrapped(s16, buf16_size);
-    GST_BUFFER_DURATION(buf16) = GST_FRAMES_TO_CLOCK_TIME(samples * sizeof(int16_t) * channels, rate);
-    buf = buf16;
+}
 
-    instance->logged_unsupported_analyzer_format_ = false;
-  }
-  else if (format.startsWith(QLatin1String("S24_32LE"))) {
+GstPadProbeReturn GstEnginePipeline::BufferProbeCallback(GstPad *pad, GstPadProbeInfo *info, gpointer self) {
 
-    GstMapInfo map_info;
-    gst_buffer_map(buf, &map_info, GST_MAP_READ);
+  GstEnginePipeline *instance = reinterpret_cast<GstEnginePipeline*>(self);
 
-    int32_t *s32 = reinterpret_cast<int32_t*>(map_info.data);
-    int32_t *s32e = s32 + map_info.size;
-    int32_t *s32p = s32;
-    int samples = static_cast<int>((map_info.size / sizeof(int32_t)) / channels);
-    int buf16_size = samples * static_cast<int>(sizeof(int16_t)) * channels;
-    int16_t *s16 = static_cast<int16_t*>(g_malloc(buf16_size));
-    memset(s16, 0, buf16_size);
-    for (int i = 0; i < (samples * channels); ++i) {
-      int8_t *s24 = reinterpret_cast<int8_t*>(s32p);
-      s16[i] = *(reinterpret_cast<int16_t*>(s24 + 1));
-      ++s32p;
-      if (s32p > s32e) break;
+  // The format only changes with a caps event, so it's parsed from the event instead of for every buffer.
+  if (GST_PAD_PROBE_INFO_TYPE(info) & GST_PAD_PROBE_TYPE_EVENT_DOWNSTREAM) {
+    GstEvent *e = gst_pad_probe_info_get_event(info);
+    if (GST_EVENT_TYPE(e) == GST_EVENT_CAPS) {
+      GstCaps *caps = nullptr;
+      gst_event_parse_caps(e, &caps);
+      instance->SetBufferFormat(caps);
     }
-    gst_buffer_unmap(buf, &map_info);
-    buf16 = gst_buffer_new_wrapped(s16, buf16_size);
-    GST_BUFFER_DURATION(buf16) = GST_FRAMES_TO_CLOCK_TIME(samples * sizeof(int16_t) * channels, rate);
-    buf = buf16;
+    return GST_PAD_PROBE_OK;
+  }
 
-    instance->logged_unsupported_analyzer_format_ = false;
+  if (instance->buffer_format_ == BufferFormat::Unknown && instance->buffer_format_name_.isEmpty()) {
+    GstCaps *caps = gst_pad_get_current_caps(pad);
+    if (caps) {
+      instance->SetBufferFormat(caps);
+      gst_caps_unref(caps);
+    }
   }
-  else if (!instance->logged_unsupported_analyzer_format_) {
-    instance->logged_unsupported_analyzer_format_ = true;
-    qLog(Error) << "Unsupported audio format for the analyzer" << format;
+
+  const BufferFormat buffer_format = instance->buffer_format_;
+  const QString &format = instance->buffer_format_name_;
+
+  GstBuffer *buf = gst_pad_probe_info_get_buffer(info);
+  GstBuffer *buf16 = nullptr;
+
+  quint64 start_time = GST_BUFFER_TIMESTAMP(buf) - instance->segment_start_;
+  quint64 duration = GST_BUFFER_DURATION(buf);
+  qint64 end_time = static_cast<qint64>(start_time + duration);
+
+  switch (buffer_format) {
+    case BufferFormat::S16LE:
+      instance->logged_unsupported_analyzer_format_ = false;
+      break;
+    case BufferFormat::S32LE:
+    case BufferFormat::F32LE:
+    case BufferFormat::F64LE:
+    case BufferFormat::S24LE:
+    case BufferFormat::S24_32LE: {
+      GstMapInfo map_info;
+      if (gst_buffer_map(buf, &map_info, GST_MAP_READ)) {
+        const gsize sample_count = map_info.size / GstEnginePipeline::BufferFormatSampleSize(buffer_format);
+        buf16 = instance->AcquireS16Buffer(sample_count * sizeof(qint16));
+        GstMapInfo map_info16;
+        if (buf16 && gst_buffer_map(buf16, &map_info16, GST_MAP_WRITE)) {
+          qint16 *d = reinterpret_cast<qint16*>(map_info16.data);
+          switch (buffer_format) {
+            case BufferFormat::S32LE:
+              ConvertS32ToS16(reinterpret_cast<const qint32*>(map_info.data), d, sample_count);
+              break;
+            case BufferFormat::F32LE:
+              ConvertF32ToS16(reinterpret_cast<const float*>(map_info.data), d, sample_count);
+              break;
+            case BufferFormat::F64LE:
+              ConvertF64ToS16(reinterpret_cast<const double*>(map_info.data), d, sample_count);
+              break;
+            case BufferFormat::S24LE:
+              ConvertS24ToS16(map_info.data, d, sample_count);
+              break;
+            case BufferFormat::S24_32LE:
+              ConvertS24_32ToS16(reinterpret_cast<const qint32*>(map_info.data), d, sample_count);
+              break;
+            default:
+              break;
+          }
+          gst_buffer_unmap(buf16, &map_info16);
+          GST_BUFFER_DURATION(buf16) = GST_BUFFER_DURATION(buf);
+        }
+        else if (buf16) {
+          gst_buffer_unref(buf16);
+          buf16 = nullptr;
+        }
+        gst_buffer_unmap(buf, &map_info);
+        if (buf16) buf = buf16;
+      }
+      instance->logged_unsupported_analyzer_format_ = false;
+      break;
+    }
+    case BufferFormat::Unknown:
+      if (!instance->logged_unsupported_analyzer_format_) {
+        instance->logged_unsupported_analyzer_format_ = true;
+        qLog(Error) << "Unsupported audio format for the analyzer" << format;
+      }
+      break;
   }
 
   QList<GstBufferConsumer*> consumers;
@@ -1228,7 +1611,7 @@ GstPadProbeReturn GstEnginePipeline::BufferProbeCallback(GstPad *pad, GstPadProb
 
   for (GstBufferConsumer *consumer : consumers) {
     gst_buffer_ref(buf);
-    consumer->ConsumeBuffer(buf, instance->id(), format);
+    consumer->ConsumeBuffer(buf, instance->id(), format, instance->buffer_channels_, instance->buffer_rate_);
   }
 
   if (buf16) {
@@ -1344,6 +1727,10 @@ gboolean GstEnginePipeline::BusWatchCallback(GstBus *bus, GstMessage *msg, gpoin
       instance->StateChangedMessageReceived(msg);
       break;
 
+    case GST_MESSAGE_ASYNC_DONE:
+      instance->AsyncDoneMessageReceived();
+      break;
+
     default:
       break;
   }
@@ -1472,6 +1859,16 @@ void GstEnginePipeline::TagMessageReceived(GstMessage *msg) {
   GstTagList *taglist = nullptr;
   gst_message_parse_tag(msg, &taglist);
 
+  // Tag messages are seen both by the bus sync handler and the bus watch, and some streams repeat the same tags many times per second.
+  // Skip the parsing when nothing changed.
+  QMutexLocker l(&tag_mutex_);
+  if (last_taglist_ && last_metadata_.media_url == media_url_ && last_metadata_.stream_url == stream_url_ && gst_tag_list_is_equal(last_taglist_, taglist)) {
+    gst_tag_list_unref(taglist);
+    return;
+  }
+  if (last_taglist_) gst_tag_list_unref(last_taglist_);
+  last_taglist_ = gst_tag_list_ref(taglist);
+
   EngineMetadata engine_metadata;
   engine_metadata.type = EngineMetadata::Type::Current;
   engine_metadata.media_url = media_url_;
@@ -1514,6 +1911,21 @@ void GstEnginePipeline::TagMessageReceived(GstMessage *msg) {
 
   gst_tag_list_unref(taglist);
 
+  // Different tag lists can still give the same metadata, for example when only the minimum bitrate changed.
+  if (last_metadata_.media_url == engine_metadata.media_url &&
+      last_metadata_.stream_url == engine_metadata.stream_url &&
+      last_metadata_.title == engine_metadata.title &&
+      last_metadata_.artist == engine_metadata.artist &&
+      last_metadata_.album == engine_metadata.album &&
+      last_metadata_.comment == engine_metadata.comment &&
+      last_metadata_.bitrate == engine_metadata.bitrate &&
+      last_metadata_.lyrics == engine_metadata.lyrics) {
+    return;
+  }
+  last_metadata_ = engine_metadata;
+
+  l.unlock();
+
   emit MetadataFound(id(), engine_metadata);
 
 }
@@ -1543,6 +1955,49 @@ guint GstEnginePipeline::ParseUIntTag(GstTagList *list, const char *tag) {
 
 }
 
+qint64 GstEnginePipeline::OutputLatencyNanosec() const {
+
+  if (!audiosink_) return -1;
+
+  // autoaudiosink and similar sinks are bins around the actual audio sink.
+  GstElement *sink = nullptr;
+  if (GST_IS_BIN(audiosink_)) {
+    GstIterator *it = gst_bin_iterate_sinks(GST_BIN(audiosink_));
+    GValue item = G_VALUE_INIT;
+    if (gst_iterator_next(it, &item) == GST_ITERATOR_OK) {
+      sink = GST_ELEMENT(g_value_dup_object(&item));
+      g_value_unset(&item);
+    }
+    gst_iterator_free(it);
+  }
+  else {
+    sink = GST_ELEMENT(gst_object_ref(audiosink_));
+  }
+
+  if (!sink) return -1;
+
+  qint64 latency = -1;
+  if (GST_IS_AUDIO_BASE_SINK(sink)) {
+    GstAudioBaseSink *audiobasesink = GST_AUDIO_BASE_SINK(sink);
+    GstAudioRingBuffer *ringbuffer = nullptr;
+    GST_OBJECT_LOCK(audiobasesink);
+    if (audiobasesink->ringbuffer) ringbuffer = GST_AUDIO_RING_BUFFER(gst_object_ref(audiobasesink->ringbuffer));
+    GST_OBJECT_UNLOCK(audiobasesink);
+    if (ringbuffer) {
+      const gint rate = GST_AUDIO_INFO_RATE(&ringbuffer->spec.info);
+      if (gst_audio_ring_buffer_is_acquired(ringbuffer) && rate > 0) {
+        // The negotiated ring buffer plus what the device still has queued.
+        latency = ringbuffer->spec.buffer_time * static_cast<qint64>(GST_USECOND) + static_cast<qint64>(gst_util_uint64_scale_int(gst_audio_ring_buffer_delay(ringbuffer), GST_SECOND, rate));
+      }
+      gst_object_unref(ringbuffer);
+    }
+  }
+  gst_object_unref(sink);
+
+  return latency;
+
+}
+
 void GstEnginePipeline::StateChangedMessageReceived(GstMessage *msg) {
 
   if (!pipeline_ || msg->src != GST_OBJECT(pipeline_)) {
@@ -1555,6 +2010,18 @@ void GstEnginePipeline::StateChangedMessageReceived(GstMessage *msg) {
 
   qLog(Debug) << "Pipeline state changed from" << GstStateText(old_state) << "to" << GstStateText(new_state);
 
+  if (new_state == GST_STATE_PLAYING && !playback_started_ && startup_timer_.isValid()) {
+    playback_started_ = true;
+    emit PlaybackStarted(id_, startup_timer_.nsecsElapsed());
+  }
+
+  if (new_state == GST_STATE_PLAYING) {
+    const qint64 output_latency_nanosec = OutputLatencyNanosec();
+    if (output_latency_nanosec >= 0) {
+      qLog(Debug) << "Output latency" << static_cast<double>(output_latency_nanosec) / static_cast<double>(kNsecPerMsec) << "ms";
+    }
+  }
+
   if (!pipeline_is_active_ && (new_state == GST_STATE_PAUSED || new_state == GST_STATE_PLAYING)) {
     qLog(Debug) << "Pipeline is active";
     pipeline_is_active_ = true;
@@ -1579,6 +2046,11 @@ void GstEnginePipeline::StateChangedMessageReceived(GstMessage *msg) {
   else if (pipeline_is_active_ && new_state != GST_STATE_PAUSED && new_state != GST_STATE_PLAYING) {
     qLog(Debug) << "Pipeline is inactive";
     pipeline_is_active_ = false;
+    seek_in_progress_ = false;
+    if (coalesced_seek_nanosec_ != -1) {
+      pending_seek_nanosec_ = coalesced_seek_nanosec_;
+      coalesced_seek_nanosec_ = -1;
+    }
     if (next_uri_set_ && new_state == GST_STATE_READY) {
       next_uri_set_ = false;
       g_object_set(G_OBJECT(pipeline_), "uri", gst_url_.constData(), nullptr);
@@ -1606,6 +2078,16 @@ void GstEnginePipeline::BufferingMessageReceived(GstMessage *msg) {
   int percent = 0;
   gst_message_parse_buffering(msg, &percent);
 
+  if (percent != queue_level_) {
+    queue_level_ = percent;
+    emit QueueLevelChanged(id_, percent);
+    gint avg_in = 0, avg_out = 0;
+    gst_message_parse_buffering_stats(msg, nullptr, &avg_in, &avg_out, nullptr);
+    if (avg_in > 0 && avg_out > 0) {
+      emit QueueRatesChanged(id_, avg_in, avg_out);
+    }
+  }
+
   const GstState current_state = state();
 
   if (percent == 0 && current_state == GST_STATE_PLAYING && !buffering_) {
@@ -1695,9 +2177,35 @@ bool GstEnginePipeline::Seek(const qint64 nanosec) {
   pending_seek_nanosec_ = -1;
   last_known_position_ns_ = nanosec;
 
+  // Every flushing seek restarts the preroll, so while one is still running only the latest position of a slider drag is kept.
+  if (seek_in_progress_) {
+    coalesced_seek_nanosec_ = nanosec;
+    return true;
+  }
+
   qLog(Debug) << "Seeking to" << nanosec;
 
-  return gst_element_seek_simple(pipeline_, GST_FORMAT_TIME, GST_SEEK_FLAG_FLUSH, nanosec);
+  // For network streams go to the nearest key unit instead of decoding up to the exact position.
+  GstSeekFlags seek_flags = GST_SEEK_FLAG_FLUSH;
+  if (stream_url_.scheme() == QLatin1String("http") || stream_url_.scheme() == QLatin1String("https")) {
+    seek_flags = static_cast<GstSeekFlags>(seek_flags | GST_SEEK_FLAG_KEY_UNIT | GST_SEEK_FLAG_SNAP_NEAREST);
+  }
+
+  seek_in_progress_ = gst_element_seek_simple(pipeline_, GST_FORMAT_TIME, seek_flags, nanosec);
+
+  return seek_in_progress_;
+
+}
+
+void GstEnginePipeline::AsyncDoneMessageReceived() {
+
+  seek_in_progress_ = false;
+
+  if (coalesced_seek_nanosec_ != -1) {
+    const qint64 nanosec = coalesced_seek_nanosec_;
+    coalesced_seek_nanosec_ = -1;
+    Seek(nanosec);
+  }
 
 }
 
@@ -1729,6 +2237,32 @@ void GstEnginePipeline::UpdateEBUR128LoudnessNormalizingGaindB() {
 
     g_object_set(G_OBJECT(volume_ebur128_), "volume", dB_to_mult(ebur128_loudness_normalizing_gain_db_), nullptr);
   }
+  else if (ebur128_loudness_normalization_ && volume_sw_) {
+    UpdateSoftwareVolume();
+  }
+
+}
+
+double GstEnginePipeline::EBUR128LoudnessNormalizingGainMultiplier() const {
+
+  // Only folded into the software volume when there is no separate EBU R 128 volume element.
+  if (!ebur128_loudness_normalization_ || volume_ebur128_) return 1.0;
+
+  return std::pow(10., ebur128_loudness_normalizing_gain_db_ / 20.);
+
+}
+
+void GstEnginePipeline::UpdateSoftwareVolume() {
+
+  if (!volume_sw_) return;
+
+  double volume_internal = EBUR128LoudnessNormalizingGainMultiplier();
+  if (volume_ == volume_sw_ && volume_internal_ >= 0.0) {
+    volume_internal *= volume_internal_;
+  }
+
+  // The volume element doesn't go above 10.0 (+20 dB).
+  g_object_set(G_OBJECT(volume_sw_), "volume", qMin(volume_internal, 10.0), nullptr);
 
 }
 
@@ -1738,7 +2272,12 @@ void GstEnginePipeline::SetVolume(const uint volume_percent) {
     const double volume_internal = static_cast<double>(volume_percent) * 0.01;
     if (!volume_set_ || volume_internal != volume_internal_) {
       volume_internal_ = volume_internal;
-      g_object_set(G_OBJECT(volume_), "volume", volume_internal, nullptr);
+      if (volume_ == volume_sw_) {
+        UpdateSoftwareVolume();
+      }
+      else {
+        g_object_set(G_OBJECT(volume_), "volume", volume_internal, nullptr);
+      }
       if (pipeline_is_active_) {
         volume_set_ = true;
       }
@@ -1751,10 +2290,95 @@ void GstEnginePipeline::SetVolume(const uint volume_percent) {
 
 void GstEnginePipeline::SetFaderVolume(const qreal volume) {
 
-  if (volume_fading_) {
-    g_object_set(G_OBJECT(volume_fading_), "volume", volume, nullptr);
+  if (!volume_fading_) return;
+
+  if (fader_control_source_) {
+    QMutexLocker l(&fader_mutex_);
+    fader_running_ = false;
+    fader_curve_.clear();
+    gst_timed_value_control_source_unset_all(GST_TIMED_VALUE_CONTROL_SOURCE(fader_control_source_));
+  }
+
+  g_object_set(G_OBJECT(volume_fading_), "volume", volume, nullptr);
+
+}
+
+qint64 GstEnginePipeline::FaderCurrentTimeMsec() const {
+
+  if (fader_anchor_stream_time_ == GST_CLOCK_TIME_NONE || fader_stream_time_ == GST_CLOCK_TIME_NONE || fader_stream_time_ <= fader_anchor_stream_time_) {
+    return fader_start_time_msec_;
+  }
+
+  const qint64 elapsed_msec = static_cast<qint64>(fader_stream_time_ - fader_anchor_stream_time_) / kNsecPerMsec;
+  if (fader_direction_ == QTimeLine::Forward) {
+    return std::min(fader_start_time_msec_ + elapsed_msec, fader_duration_msec_);
+  }
+
+  return std::max(fader_start_time_msec_ - elapsed_msec, static_cast<qint64>(0));
+
+}
+
+GstPadProbeReturn GstEnginePipeline::FaderProbeCallback(GstPad *pad, GstPadProbeInfo *info, gpointer self) {
+
+  Q_UNUSED(pad)
+
+  GstEnginePipeline *instance = reinterpret_cast<GstEnginePipeline*>(self);
+
+  if (GST_PAD_PROBE_INFO_TYPE(info) & GST_PAD_PROBE_TYPE_EVENT_DOWNSTREAM) {
+    GstEvent *event = GST_PAD_PROBE_INFO_EVENT(info);
+    switch (GST_EVENT_TYPE(event)) {
+      case GST_EVENT_SEGMENT:{
+        const GstSegment *segment = nullptr;
+        gst_event_parse_segment(event, &segment);
+        QMutexLocker l(&instance->fader_mutex_);
+        gst_segment_copy_into(segment, &instance->fader_segment_);
+        break;
+      }
+      case GST_EVENT_EOS:{
+        // The stream ended before the fader did, there is nothing left to fade.
+        QMutexLocker l(&instance->fader_mutex_);
+        if (instance->fader_running_) {
+          instance->fader_running_ = false;
+          QMetaObject::invokeMethod(instance, &GstEnginePipeline::FaderCurveFinished, Qt::QueuedConnection);
+        }
+        break;
+      }
+      default:
+        break;
+    }
+    return GST_PAD_PROBE_OK;
+  }
+
+  GstBuffer *buf = gst_pad_probe_info_get_buffer(info);
+  if (!buf || !GST_BUFFER_PTS_IS_VALID(buf)) return GST_PAD_PROBE_OK;
+
+  QMutexLocker l(&instance->fader_mutex_);
+  if (!instance->fader_running_) return GST_PAD_PROBE_OK;
+
+  const guint64 stream_time = gst_segment_to_stream_time(&instance->fader_segment_, GST_FORMAT_TIME, GST_BUFFER_PTS(buf));
+  if (stream_time == GST_CLOCK_TIME_NONE) return GST_PAD_PROBE_OK;
+
+  // Anchor the pending curve at the stream time of this buffer, which the volume element processes next.
+  if (!instance->fader_curve_.isEmpty()) {
+    GstTimedValueControlSource *control_source = GST_TIMED_VALUE_CONTROL_SOURCE(instance->fader_control_source_);
+    gst_timed_value_control_source_unset_all(control_source);
+    for (const QPair<qint64, qreal> &point : std::as_const(instance->fader_curve_)) {
+      gst_timed_value_control_source_set(control_source, stream_time + static_cast<guint64>(point.first), point.second);
+    }
+    instance->fader_curve_.clear();
+    instance->fader_anchor_stream_time_ = stream_time;
   }
 
+  instance->fader_stream_time_ = stream_time + (GST_BUFFER_DURATION_IS_VALID(buf) ? GST_BUFFER_DURATION(buf) : 0);
+
+  const qint64 current_time = instance->FaderCurrentTimeMsec();
+  if (current_time == (instance->fader_direction_ == QTimeLine::Forward ? instance->fader_duration_msec_ : 0)) {
+    instance->fader_running_ = false;
+    QMetaObject::invokeMethod(instance, &GstEnginePipeline::FaderCurveFinished, Qt::QueuedConnection);
+  }
+
+  return GST_PAD_PROBE_OK;
+
 }
 
 void GstEnginePipeline::SetStereoBalance(const float value) {
@@ -1776,7 +2400,15 @@ void GstEnginePipeline::SetEqualizerParams(const int preamp, const QList<int> &b
 
   eq_preamp_ = preamp;
   eq_band_gains_ = band_gains;
+
+  // Moving an equalizer slider sends a burst of changes, apply the first one right away and then at most one per interval.
+  if (equalizer_update_timer_.isActive()) {
+    equalizer_update_pending_ = true;
+    return;
+  }
+
   UpdateEqualizer();
+  equalizer_update_timer_.start(kEqualizerUpdateMsec, this);
 
 }
 
@@ -1784,7 +2416,14 @@ void GstEnginePipeline::UpdateEqualizer() {
 
   if (!equalizer_ || !equalizer_preamp_) return;
 
-  // Update band gains
+  equalizer_update_pending_ = false;
+
+  if (eq_applied_band_gains_.count() != kEqBandCount) {
+    eq_applied_band_gains_.clear();
+    for (int i = 0; i < kEqBandCount; ++i) eq_applied_band_gains_ << std::numeric_limits<float>::quiet_NaN();
+  }
+
+  // Update band gains, only the bands that changed, each band recalculates its filter coefficients when set.
   for (int i = 0; i < kEqBandCount; ++i) {
     float gain = eq_enabled_ ? static_cast<float>(eq_band_gains_[i]) : static_cast<float>(0.0);
     if (gain < 0) {
@@ -1794,6 +2433,9 @@ void GstEnginePipeline::UpdateEqualizer() {
       gain *= 0.12F;
     }
 
+    if (gain == eq_applied_band_gains_[i]) continue;
+    eq_applied_band_gains_[i] = gain;
+
     const int index_in_eq = i + 1;
     // Offset because of the first dummy band we created.
     GstObject *band = GST_OBJECT(gst_child_proxy_get_child_by_index(GST_CHILD_PROXY(equalizer_), index_in_eq));
@@ -1805,7 +2447,10 @@ void GstEnginePipeline::UpdateEqualizer() {
   float preamp = 1.0F;
   if (eq_enabled_) preamp = static_cast<float>(eq_preamp_ + 100) * 0.01F;  // To scale from 0.0 to 2.0
 
-  g_object_set(G_OBJECT(equalizer_preamp_), "volume", preamp, nullptr);
+  if (preamp != eq_applied_preamp_) {
+    eq_applied_preamp_ = preamp;
+    g_object_set(G_OBJECT(equalizer_preamp_), "volume", preamp, nullptr);
+  }
 
 }
 
@@ -1813,42 +2458,64 @@ void GstEnginePipeline::StartFader(const qint64 duration_nanosec, const QTimeLin
 
   const qint64 duration_msec = duration_nanosec / kNsecPerMsec;
 
+  fader_fudge_timer_.stop();
+  use_fudge_timer_ = use_fudge_timer;
+
+  const QEasingCurve curve(shape);
+
+  if (!fader_control_source_ || duration_msec <= 0) {
+    SetFaderVolume(curve.valueForProgress(direction == QTimeLine::Forward ? 1.0 : 0.0));
+    FaderCurveFinished();
+    return;
+  }
+
+  QMutexLocker l(&fader_mutex_);
+
   // If there's already another fader running then start from the same time that one was already at.
   qint64 start_time = direction == QTimeLine::Forward ? 0 : duration_msec;
-  if (fader_ && fader_->state() == QTimeLine::Running) {
-    if (duration_msec == fader_->duration()) {
-      start_time = fader_->currentTime();
+  if (fader_running_) {
+    const qint64 current_time = FaderCurrentTimeMsec();
+    if (duration_msec == fader_duration_msec_) {
+      start_time = current_time;
     }
     else {
       // Calculate the position in the new fader with the same value from the old fader, so no volume jumps appear
-      qreal time = static_cast<qreal>(duration_msec) * (static_cast<qreal>(fader_->currentTime()) / static_cast<qreal>(fader_->duration()));
+      qreal time = static_cast<qreal>(duration_msec) * (static_cast<qreal>(current_time) / static_cast<qreal>(fader_duration_msec_));
       start_time = qRound(time);
     }
   }
 
-  fader_.reset(new QTimeLine(static_cast<int>(duration_msec)), [](QTimeLine *timeline) {
-    if (timeline->state() != QTimeLine::NotRunning) {
-      timeline->stop();
-    }
-    timeline->deleteLater();
-  });
-  QObject::connect(&*fader_, &QTimeLine::valueChanged, this, &GstEnginePipeline::SetFaderVolume);
-  QObject::connect(&*fader_, &QTimeLine::finished, this, &GstEnginePipeline::FaderTimelineFinished);
-  fader_->setDirection(direction);
-  fader_->setEasingCurve(shape);
-  fader_->setCurrentTime(static_cast<int>(start_time));
-  fader_->resume();
+  // The curve is handed to the streaming thread, which schedules it on the fading volume from the next buffer
+  // and keeps track of the fader from the stream time of the buffers passing through.
+  const qint64 remaining_msec = direction == QTimeLine::Forward ? duration_msec - start_time : start_time;
+  fader_curve_.clear();
+  fader_curve_.reserve(static_cast<int>(remaining_msec / kFaderCurveStepMsec) + 2);
+  for (qint64 elapsed_msec = 0;; elapsed_msec = std::min(elapsed_msec + kFaderCurveStepMsec, remaining_msec)) {
+    const qint64 time_msec = direction == QTimeLine::Forward ? start_time + elapsed_msec : start_time - elapsed_msec;
+    fader_curve_ << qMakePair(elapsed_msec * kNsecPerMsec, curve.valueForProgress(static_cast<qreal>(time_msec) / static_cast<qreal>(duration_msec)));
+    if (elapsed_msec >= remaining_msec) break;
+  }
 
-  fader_fudge_timer_.stop();
-  use_fudge_timer_ = use_fudge_timer;
+  fader_running_ = true;
+  fader_direction_ = direction;
+  fader_duration_msec_ = duration_msec;
+  fader_start_time_msec_ = start_time;
+  fader_anchor_stream_time_ = GST_CLOCK_TIME_NONE;
+  fader_stream_time_ = GST_CLOCK_TIME_NONE;
 
-  SetFaderVolume(fader_->currentValue());
+  // Hold the start volume until the curve is anchored.
+  gst_timed_value_control_source_unset_all(GST_TIMED_VALUE_CONTROL_SOURCE(fader_control_source_));
+  g_object_set(G_OBJECT(volume_fading_), "volume", fader_curve_.first().second, nullptr);
 
 }
 
-void GstEnginePipeline::FaderTimelineFinished() {
+void GstEnginePipeline::FaderCurveFinished() {
 
-  fader_.reset();
+  {
+    // Ignore a finish queued by the streaming thread for a fader that was already replaced.
+    QMutexLocker l(&fader_mutex_);
+    if (fader_running_) return;
+  }
 
   // Wait a little while longer before emitting the finished signal (and probably destroying the pipeline) to account for delays in the audio server/driver.
   if (use_fudge_timer_) {
@@ -1871,6 +2538,16 @@ void GstEnginePipeline::timerEvent(QTimerEvent *e) {
     return;
   }
 
+  if (e->timerId() == equalizer_update_timer_.timerId()) {
+    if (equalizer_update_pending_) {
+      UpdateEqualizer();
+    }
+    else {
+      equalizer_update_timer_.stop();
+    }
+    return;
+  }
+
   QObject::timerEvent(e);
 
 }
@@ -37,7 +37,9 @@
 #include <QTimeLine>
 #include <QEasingCurve>
 #include <QBasicTimer>
+#include <QElapsedTimer>
 #include <QList>
+#include <QPair>
 #include <QByteArray>
 #include <QVariant>
 #include <QString>
@@ -48,6 +50,7 @@
 
 class QTimerEvent;
 class GstBufferConsumer;
+class AudioCache;
 struct GstPlayBin;
 
 class GstEnginePipeline : public QObject {
@@ -60,24 +63,44 @@ class GstEnginePipeline : public QObject {
   // Globally unique across all pipelines.
   int id() const { return id_; }
 
+  // Extra sink rendering the same decoded audio as the main output, described as a gst-launch style bin.
+  // The latency compensation delays this output so it plays in sync with slower outputs.
+  struct AdditionalOutput {
+    AdditionalOutput() : volume(1.0), latency_nanosec(0) {}
+    QString description;
+    double volume;
+    qint64 latency_nanosec;
+  };
+  using AdditionalOutputList = QList<AdditionalOutput>;
+
   // Call these setters before Init
   void set_output_device(const QString &output, const QVariant &device);
   void set_exclusive_mode(const bool exclusive_mode);
+  void set_low_latency(const bool low_latency);
+  void set_bit_perfect(const bool bit_perfect);
   void set_volume_enabled(const bool enabled);
   void set_stereo_balancer_enabled(const bool enabled);
   void set_equalizer_enabled(const bool enabled);
   void set_replaygain(const bool enabled, const int mode, const double preamp, const double fallbackgain, const bool compression);
   void set_ebur128_loudness_normalization(const bool enabled);
   void set_buffer_duration_nanosec(const quint64 duration_nanosec);
+  // Changes the buffer duration of an existing pipeline.
+  void SetBufferDurationNanosec(const quint64 buffer_duration_nanosec);
+  quint64 buffer_duration_nanosec() const { return buffer_duration_nanosec_; }
   void set_buffer_low_watermark(const double value);
   void set_buffer_high_watermark(const double value);
   void set_proxy_settings(const QString &address, const bool authentication, const QString &user, const QString &pass);
   void set_channels(const bool enabled, const int channels);
   void set_bs2b_enabled(const bool enabled);
   void set_strict_ssl_enabled(const bool enabled);
+  void set_audio_cache(SharedPtr<AudioCache> audio_cache);
   void set_fading_enabled(const bool enabled);
+  void set_additional_outputs(const AdditionalOutputList &additional_outputs);
+
+  // Creates the playbin and the audio bin without a URL, so it can be done before the pipeline is needed.
+  bool Init(QString &error);
 
-  // Creates the pipeline, returns false on error
+  // Creates the pipeline if needed and sets the URL, returns false on error
   bool InitFromUrl(const QUrl &media_url, const QUrl &stream_url, const QByteArray &gst_url, const qint64 end_nanosec, const double ebur128_loudness_normalizing_gain_db, QString &error);
 
   // GstBufferConsumers get fed audio data.  Thread-safe.
@@ -114,6 +137,8 @@ class GstEnginePipeline : public QObject {
   QUrl next_stream_url() const { return next_stream_url_; }
   QByteArray next_gst_url() const { return next_gst_url_; }
   bool is_valid() const { return valid_; }
+  bool has_equalizer() const { return equalizer_ != nullptr; }
+  bool has_stereo_balancer() const { return audiopanorama_ != nullptr; }
 
   // Please note that this method (unlike GstEngine's.position()) is multiple-section media unaware.
   qint64 position() const;
@@ -146,6 +171,12 @@ class GstEnginePipeline : public QObject {
   void BufferingProgress(const int percent);
   void BufferingFinished();
 
+  // For the engine metrics, the time from setting the URL until the pipeline is playing and the fill level of the queue in percent.
+  void PlaybackStarted(const int pipeline_id, const qint64 startup_nanosec);
+  void QueueLevelChanged(const int pipeline_id, const int percent);
+  // Average input and output rate of the queue in bytes per second.
+  void QueueRatesChanged(const int pipeline_id, const int avg_in, const int avg_out);
+
   void AboutToFinish();
 
  protected:
@@ -155,11 +186,31 @@ class GstEnginePipeline : public QObject {
   static QString GstStateText(const GstState state);
   GstElement *CreateElement(const QString &factory_name, const QString &name, GstElement *bin, QString &error) const;
   bool InitAudioBin(QString &error);
+  bool LinkOutputs(GstElement *element_link, GstCaps *caps, QString &error);
+  bool CreateAdditionalOutput(GstElement *tee, const int index, const AdditionalOutput &additional_output, QString &error);
   void SetupVolume(GstElement *element);
 
+  // Formats of the buffers passed to the analyzer, all except S16LE are converted.
+  enum class BufferFormat {
+    Unknown,
+    S16LE,
+    S32LE,
+    F32LE,
+    F64LE,
+    S24LE,
+    S24_32LE
+  };
+  // Ring buffer and device delay of the audio sink, -1 if it's unknown.
+  qint64 OutputLatencyNanosec() const;
+
+  void SetBufferFormat(GstCaps *caps);
+  static gsize BufferFormatSampleSize(const BufferFormat buffer_format);
+  GstBuffer *AcquireS16Buffer(const gsize size);
+
   // Static callbacks.  The GstEnginePipeline instance is passed in the last argument.
   static GstPadProbeReturn UpstreamEventsProbeCallback(GstPad *pad, GstPadProbeInfo *info, gpointer self);
   static GstPadProbeReturn BufferProbeCallback(GstPad *pad, GstPadProbeInfo *info, gpointer self);
+  static GstPadProbeReturn FaderProbeCallback(GstPad *pad, GstPadProbeInfo *info, gpointer self);
   static GstPadProbeReturn PlaybinProbeCallback(GstPad *pad, GstPadProbeInfo *info, gpointer self);
   static void ElementAddedCallback(GstBin *bin, GstBin*, GstElement *element, gpointer self);
   static void ElementRemovedCallback(GstBin *bin, GstBin*, GstElement *element, gpointer self);
@@ -178,21 +229,30 @@ class GstEnginePipeline : public QObject {
   void BufferingMessageReceived(GstMessage *msg);
   void StreamStatusMessageReceived(GstMessage *msg);
   void StreamStartMessageReceived();
+  void AsyncDoneMessageReceived();
 
   static QString ParseStrTag(GstTagList *list, const char *tag);
   static guint ParseUIntTag(GstTagList *list, const char *tag);
 
   void UpdateEBUR128LoudnessNormalizingGaindB();
+  double EBUR128LoudnessNormalizingGainMultiplier() const;
+  void UpdateSoftwareVolume();
   void UpdateStereoBalance();
   void UpdateEqualizer();
+  // Position of the fader on the curve, call with the fader mutex locked.
+  qint64 FaderCurrentTimeMsec() const;
 
  private slots:
-  void FaderTimelineFinished();
+  void FaderCurveFinished();
 
  private:
   static const int kGstStateTimeoutNanosecs;
   static const int kFaderFudgeMsec;
+  static const int kFaderCurveStepMsec;
+  static const gint64 kLowLatencyBufferTimeUsec;
+  static const gint64 kLowLatencyLatencyTimeUsec;
   static const int kEqBandCount;
+  static const int kEqualizerUpdateMsec;
   static const int kEqBandFrequencies[];
 
   // Using == to compare two pipelines is a bad idea, because new ones often get created in the same address as old ones.  This ID will be unique for each pipeline.
@@ -205,11 +265,14 @@ class GstEnginePipeline : public QObject {
   QString output_;
   QVariant device_;
   bool exclusive_mode_;
+  bool low_latency_;
+  bool bit_perfect_;
   bool volume_enabled_;
   bool stereo_balancer_enabled_;
   bool eq_enabled_;
   bool rg_enabled_;
   bool fading_enabled_;
+  AdditionalOutputList additional_outputs_;
 
   // Stereo balance:
   // From -1.0 - 1.0
@@ -219,6 +282,11 @@ class GstEnginePipeline : public QObject {
   // Equalizer
   int eq_preamp_;
   QList<int> eq_band_gains_;
+  // Values last set on the equalizer elements.
+  float eq_applied_preamp_;
+  QList<float> eq_applied_band_gains_;
+  QBasicTimer equalizer_update_timer_;
+  bool equalizer_update_pending_;
 
   // ReplayGain
   int rg_mode_;
@@ -248,6 +316,7 @@ class GstEnginePipeline : public QObject {
   // Options
   bool bs2b_enabled_;
   bool strict_ssl_enabled_;
+  SharedPtr<AudioCache> audio_cache_;
 
   // These get called when there is a new audio buffer available
   QList<GstBufferConsumer*> buffer_consumers_;
@@ -273,6 +342,10 @@ class GstEnginePipeline : public QObject {
   // Set temporarily when moving to the next contiguous section in a multipart file.
   bool ignore_next_seek_;
 
+  // A flushing seek was sent and the pipeline hasn't prerolled yet.
+  bool seek_in_progress_;
+  qint64 coalesced_seek_nanosec_;
+
   // Set temporarily when switching out the decode bin, so metadata doesn't get sent while the Player still thinks it's playing the last song
   bool ignore_tags_;
 
@@ -302,10 +375,22 @@ class GstEnginePipeline : public QObject {
   gdouble volume_internal_;
   uint volume_percent_;
 
-  SharedPtr<QTimeLine> fader_;
   QBasicTimer fader_fudge_timer_;
   bool use_fudge_timer_;
 
+  // Fader state, shared with the fader probe in the streaming thread.
+  QMutex fader_mutex_;
+  bool fader_running_;
+  QTimeLine::Direction fader_direction_;
+  qint64 fader_duration_msec_;
+  qint64 fader_start_time_msec_;
+  guint64 fader_anchor_stream_time_;
+  guint64 fader_stream_time_;
+  // Fade curve as offsets in nanoseconds and volumes, waiting to be scheduled on the fading volume by the fader probe.
+  QList<QPair<qint64, qreal>> fader_curve_;
+  GstSegment fader_segment_{};
+  GstControlSource *fader_control_source_;
+
   GstElement *pipeline_;
   GstElement *audiobin_;
   GstElement *audiosink_;
@@ -322,6 +407,7 @@ class GstEnginePipeline : public QObject {
 
   gulong upstream_events_probe_cb_id_;
   gulong buffer_probe_cb_id_;
+  gulong fader_probe_cb_id_;
   gulong playbin_probe_cb_id_;
   glong element_added_cb_id_;
   glong element_removed_cb_id_;
@@ -334,8 +420,26 @@ class GstEnginePipeline : public QObject {
 
   GstSegment last_playbin_segment_{};
 
+  // Last tags and the metadata emitted for them, used for skipping repeated tag messages.
+  QMutex tag_mutex_;
+  GstTagList *last_taglist_;
+  EngineMetadata last_metadata_;
+
+  // Negotiated format of the buffers in the buffer probe, only used from the streaming thread.
+  BufferFormat buffer_format_;
+  QString buffer_format_name_;
+  int buffer_channels_;
+  int buffer_rate_;
+  // Pool of the converted buffers for the analyzer.
+  GstBufferPool *buffer_pool_;
+  gsize buffer_pool_size_;
+
   bool logged_unsupported_analyzer_format_;
 
+  QElapsedTimer startup_timer_;
+  bool playback_started_;
+  int queue_level_;
+
   bool about_to_finish_;
 
 };
@@ -34,6 +34,7 @@
 #include <QDir>
 #include <QFile>
 #include <QAbstractEventDispatcher>
+#include <QElapsedTimer>
 
 #include "core/logging.h"
 #include "utilities/envutils.h"
@@ -75,11 +76,16 @@ GstStartup::~GstStartup() {
 
 void GstStartup::InitializeGStreamer() {
 
+  QElapsedTimer timer;
+  timer.start();
+
   SetEnvironment();
 
   gst_init(nullptr, nullptr);
   gst_pb_utils_init();
 
+  qLog(Debug) << "GStreamer initialized in" << timer.elapsed() << "ms";
+
 #ifdef HAVE_MOODBAR
   gstfastspectrum_register_static();
 #endif
@@ -178,6 +184,12 @@ void GstStartup::SetEnvironment() {
   QString gst_registry_filename = QStandardPaths::writableLocation(QStandardPaths::AppLocalDataLocation) + QStringLiteral("/gst-registry-%1-bin").arg(QCoreApplication::applicationVersion());
   qLog(Debug) << "Setting GStreamer registry file to" << gst_registry_filename;
   Utilities::SetEnv("GST_REGISTRY", gst_registry_filename);
+#  ifdef USE_BUNDLE
+  // The bundled plugins only change with the version, which is part of the registry filename, so don't stat all plugins to check the registry on every start.
+  if (QFile::exists(gst_registry_filename)) {
+    Utilities::SetEnv("GST_REGISTRY_UPDATE", QStringLiteral("no"));
+  }
+#  endif
 #endif
 
 }
@@ -0,0 +1,103 @@
+/*
+ * Strawberry Music Player
+ *
+ * Strawberry is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Strawberry is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Strawberry.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#include "config.h"
+
+#include <algorithm>
+#include <cstring>
+
+#include "pcmringbuffer.h"
+
+namespace {
+
+size_t NextPowerOfTwo(const size_t value) {
+
+  size_t result = 1;
+  while (result < value) result <<= 1;
+  return result;
+
+}
+
+}  // namespace
+
+PCMRingBuffer::PCMRingBuffer(const size_t capacity)
+    : samples_(NextPowerOfTwo(std::max(capacity, static_cast<size_t>(2)))),
+      mask_(samples_.size() - 1),
+      write_pos_(0),
+      read_pos_(0),
+      samples_per_sec_(0) {}
+
+size_t PCMRingBuffer::Write(const qint16 *samples, const size_t count) {
+
+  const size_t write_pos = write_pos_.load(std::memory_order_relaxed);
+  const size_t read_pos = read_pos_.load(std::memory_order_acquire);
+  const size_t length = std::min(count, samples_.size() - (write_pos - read_pos));
+  if (length == 0) return 0;
+
+  const size_t offset = write_pos & mask_;
+  const size_t first = std::min(length, samples_.size() - offset);
+  memcpy(samples_.data() + offset, samples, first * sizeof(qint16));
+  if (length > first) {
+    memcpy(samples_.data(), samples + first, (length - first) * sizeof(qint16));
+  }
+
+  write_pos_.store(write_pos + length, std::memory_order_release);
+
+  return length;
+
+}
+
+size_t PCMRingBuffer::Available() const {
+
+  return write_pos_.load(std::memory_order_acquire) - read_pos_.load(std::memory_order_relaxed);
+
+}
+
+size_t PCMRingBuffer::Read(qint16 *dest, const size_t count) {
+
+  const size_t read_pos = read_pos_.load(std::memory_order_relaxed);
+  const size_t write_pos = write_pos_.load(std::memory_order_acquire);
+  const size_t length = std::min(count, write_pos - read_pos);
+  if (length == 0) return 0;
+
+  const size_t offset = read_pos & mask_;
+  const size_t first = std::min(length, samples_.size() - offset);
+  memcpy(dest, samples_.data() + offset, first * sizeof(qint16));
+  if (length > first) {
+    memcpy(dest + first, samples_.data(), (length - first) * sizeof(qint16));
+  }
+
+  read_pos_.store(read_pos + length, std::memory_order_release);
+
+  return length;
+
+}
+
+void PCMRingBuffer::Skip(const size_t count) {
+
+  const size_t read_pos = read_pos_.load(std::memory_order_relaxed);
+  const size_t write_pos = write_pos_.load(std::memory_order_acquire);
+  read_pos_.store(read_pos + std::min(count, write_pos - read_pos), std::memory_order_release);
+
+}
+
+void PCMRingBuffer::Clear() {
+
+  read_pos_.store(write_pos_.load(std::memory_order_acquire), std::memory_order_release);
+
+}
@@ -0,0 +1,61 @@
+/*
+ * Strawberry Music Player
+ *
+ * Strawberry is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Strawberry is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Strawberry.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#ifndef PCMRINGBUFFER_H
+#define PCMRINGBUFFER_H
+
+#include "config.h"
+
+#include <atomic>
+#include <cstddef>
+#include <vector>
+
+#include <QtGlobal>
+
+// Lock-free ring buffer of interleaved S16 samples with a single producer and a single consumer.
+// The producer is the engine's streaming thread, the consumer is the GUI thread reading windows for the analyzers.
+// Samples that don't fit are dropped by the producer, the consumer skips ahead when it falls behind.
+class PCMRingBuffer {
+ public:
+  explicit PCMRingBuffer(const size_t capacity);
+
+  size_t capacity() const { return samples_.size(); }
+
+  // Producer
+  size_t Write(const qint16 *samples, const size_t count);
+  void set_samples_per_sec(const int samples_per_sec) { samples_per_sec_.store(samples_per_sec, std::memory_order_relaxed); }
+
+  // Consumer
+  size_t Available() const;
+  size_t Read(qint16 *dest, const size_t count);
+  void Skip(const size_t count);
+  void Clear();
+  int samples_per_sec() const { return samples_per_sec_.load(std::memory_order_relaxed); }
+
+ private:
+  Q_DISABLE_COPY(PCMRingBuffer)
+
+  std::vector<qint16> samples_;
+  size_t mask_;
+  // Both positions only ever increase and are masked when indexing.
+  alignas(64) std::atomic<size_t> write_pos_;
+  alignas(64) std::atomic<size_t> read_pos_;
+  std::atomic<int> samples_per_sec_;
+};
+
+#endif  // PCMRINGBUFFER_H
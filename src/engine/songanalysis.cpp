@@ -0,0 +1,342 @@
+/*
+ * Strawberry Music Player
+ *
+ * Strawberry is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Strawberry is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Strawberry.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#include "config.h"
+
+#include <cstdlib>
+#include <cstring>
+#include <optional>
+
+#include <glib.h>
+#include <glib-object.h>
+#include <gst/gst.h>
+#include <gst/app/gstappsink.h>
+
+#include <QtGlobal>
+#include <QCoreApplication>
+#include <QThread>
+#include <QByteArray>
+#include <QString>
+#include <QElapsedTimer>
+
+#include "core/logging.h"
+#include "core/signalchecker.h"
+#include "songanalysis.h"
+#ifdef HAVE_SONGFINGERPRINTING
+#  include "chromaprinter.h"
+#endif
+#ifdef HAVE_EBUR128
+#  include "ebur128measures.h"
+#  include "ebur128analysis.h"
+#endif
+
+namespace {
+
+constexpr int kTimeoutSecs = 60;
+constexpr int kFingerprintLengthSecs = 30;
+
+class SongAnalysisPipeline {
+ public:
+  explicit SongAnalysisPipeline(const bool fingerprint, const bool ebur128);
+
+  // Decodes the song once, feeding every requested analysis.
+  bool Run(const Song &song);
+
+#ifdef HAVE_SONGFINGERPRINTING
+  QByteArray fingerprint_data;
+#endif
+#ifdef HAVE_EBUR128
+  EBUR128Accumulator ebur128_accumulator;
+#endif
+
+ private:
+  static GstElement *CreateElement(const QString &factory_name, GstElement *bin);
+  static void NewPadCallback(GstElement*, GstPad *pad, gpointer self);
+#ifdef HAVE_SONGFINGERPRINTING
+  static GstFlowReturn NewFingerprintBufferCallback(GstAppSink *app_sink, gpointer self);
+#endif
+#ifdef HAVE_EBUR128
+  static GstFlowReturn NewEBUR128BufferCallback(GstAppSink *app_sink, gpointer self);
+#endif
+
+  bool fingerprint_;
+  bool ebur128_;
+  GstElement *convert_element_;
+};
+
+SongAnalysisPipeline::SongAnalysisPipeline(const bool fingerprint, const bool ebur128)
+    : fingerprint_(fingerprint),
+      ebur128_(ebur128),
+      convert_element_(nullptr) {}
+
+GstElement *SongAnalysisPipeline::CreateElement(const QString &factory_name, GstElement *bin) {
+
+  // The elements are not named, some of them are created more than once in the same pipeline.
+  GstElement *ret = gst_element_factory_make(factory_name.toLatin1().constData(), nullptr);
+
+  if (ret && bin) gst_bin_add(GST_BIN(bin), ret);
+
+  if (!ret) {
+    qLog(Warning) << "Couldn't create the gstreamer element" << factory_name;
+  }
+
+  return ret;
+
+}
+
+bool SongAnalysisPipeline::Run(const Song &song) {
+
+  GstElement *pipeline = gst_pipeline_new("analysis-pipeline");
+  if (!pipeline) return false;
+
+  GstElement *src = CreateElement(QStringLiteral("filesrc"), pipeline);
+  GstElement *decode = CreateElement(QStringLiteral("decodebin"), pipeline);
+  GstElement *convert = CreateElement(QStringLiteral("audioconvert"), pipeline);
+  GstElement *tee = CreateElement(QStringLiteral("tee"), pipeline);
+
+  if (!src || !decode || !convert || !tee) {
+    gst_object_unref(pipeline);
+    return false;
+  }
+
+  convert_element_ = convert;
+
+  gst_element_link_many(src, decode, nullptr);
+  gst_element_link_many(convert, tee, nullptr);
+
+  GstAppSinkCallbacks fingerprint_callbacks;
+  memset(&fingerprint_callbacks, 0, sizeof(fingerprint_callbacks));
+  GstAppSinkCallbacks ebur128_callbacks;
+  memset(&ebur128_callbacks, 0, sizeof(ebur128_callbacks));
+
+#ifdef HAVE_SONGFINGERPRINTING
+  if (fingerprint_) {
+    GstElement *queue = CreateElement(QStringLiteral("queue"), pipeline);
+    GstElement *fingerprint_convert = CreateElement(QStringLiteral("audioconvert"), pipeline);
+    GstElement *resample = CreateElement(QStringLiteral("audioresample"), pipeline);
+    GstElement *sink = CreateElement(QStringLiteral("appsink"), pipeline);
+    if (!queue || !fingerprint_convert || !resample || !sink) {
+      gst_object_unref(pipeline);
+      return false;
+    }
+    gst_element_link_many(tee, queue, fingerprint_convert, resample, nullptr);
+    GstCaps *caps = Chromaprinter::CreateDecodeCaps();
+    gst_element_link_filtered(resample, sink, caps);
+    gst_caps_unref(caps);
+
+    fingerprint_callbacks.new_sample = NewFingerprintBufferCallback;
+    gst_app_sink_set_callbacks(reinterpret_cast<GstAppSink*>(sink), &fingerprint_callbacks, this, nullptr);
+    g_object_set(G_OBJECT(sink), "sync", FALSE, nullptr);
+    g_object_set(G_OBJECT(sink), "emit-signals", TRUE, nullptr);
+  }
+#endif
+
+#ifdef HAVE_EBUR128
+  if (ebur128_) {
+    GstElement *queue = CreateElement(QStringLiteral("queue2"), pipeline);
+    GstElement *ebur128_convert = CreateElement(QStringLiteral("audioconvert"), pipeline);
+    GstElement *sink = CreateElement(QStringLiteral("appsink"), pipeline);
+    if (!queue || !ebur128_convert || !sink) {
+      gst_object_unref(pipeline);
+      return false;
+    }
+    gst_element_link_many(tee, queue, ebur128_convert, nullptr);
+    GstCaps *caps = EBUR128Accumulator::CreateCaps();
+    gst_element_link_filtered(ebur128_convert, sink, caps);
+    gst_caps_unref(caps);
+
+    // Same queue limits as the separate loudness analysis, see EBUR128Analysis.
+    g_object_set(G_OBJECT(queue), "max-size-time", 60 * GST_SECOND, nullptr);
+    g_object_set(G_OBJECT(queue), "max-size-buffers", 0, nullptr);
+    g_object_set(G_OBJECT(queue), "max-size-bytes", 0, nullptr);
+
+    ebur128_callbacks.new_sample = NewEBUR128BufferCallback;
+    gst_app_sink_set_callbacks(reinterpret_cast<GstAppSink*>(sink), &ebur128_callbacks, this, nullptr);
+    g_object_set(G_OBJECT(sink), "buffer-list", FALSE, nullptr);
+    g_object_set(G_OBJECT(sink), "sync", FALSE, nullptr);
+    g_object_set(G_OBJECT(sink), "emit-signals", TRUE, nullptr);
+    g_object_set(G_OBJECT(sink), "max-buffers", 1, nullptr);
+  }
+#endif
+
+  // Set the filename
+  g_object_set(src, "location", song.url().toLocalFile().toUtf8().constData(), nullptr);
+
+  // Connect signals
+  GstBus *bus = gst_pipeline_get_bus(GST_PIPELINE(pipeline));
+  CHECKED_GCONNECT(decode, "pad-added", &NewPadCallback, this);
+
+  gst_element_set_state(pipeline, GST_STATE_PAUSED);
+  // wait for state change before seeking
+  gst_element_get_state(pipeline, nullptr, nullptr, kTimeoutSecs * GST_SECOND);
+  // The loudness needs the whole song, a fingerprint only the first seconds.
+  if (ebur128_) {
+    gst_element_seek(pipeline, 1.0, GST_FORMAT_TIME, GST_SEEK_FLAG_FLUSH, GST_SEEK_TYPE_SET, song.beginning_nanosec() * GST_NSECOND, GST_SEEK_TYPE_SET, song.end_nanosec() * GST_NSECOND);
+  }
+  else {
+    gst_element_seek(pipeline, 1.0, GST_FORMAT_TIME, GST_SEEK_FLAG_FLUSH, GST_SEEK_TYPE_SET, 0 * GST_SECOND, GST_SEEK_TYPE_SET, kFingerprintLengthSecs * GST_SECOND);
+  }
+
+  QElapsedTimer time;
+  time.start();
+
+  gst_element_set_state(pipeline, GST_STATE_PLAYING);
+
+  // Wait until EOS or error
+  bool success = true;
+  GstMessage *msg = gst_bus_timed_pop_filtered(bus, kTimeoutSecs * GST_SECOND, static_cast<GstMessageType>(GST_MESSAGE_EOS | GST_MESSAGE_ERROR));
+  if (msg) {
+    if (msg->type == GST_MESSAGE_ERROR) {
+      success = false;
+      // Report error
+      GError *error = nullptr;
+      gchar *debugs = nullptr;
+      gst_message_parse_error(msg, &error, &debugs);
+      if (error) {
+        QString message = QString::fromLocal8Bit(error->message);
+        g_error_free(error);
+        qLog(Debug) << "Error processing" << song.url() << ":" << message;
+      }
+      if (debugs) free(debugs);
+    }
+    gst_message_unref(msg);
+  }
+
+  qLog(Debug) << "Analysis decode time:" << time.elapsed();
+
+  // Cleanup
+  fingerprint_callbacks.new_sample = nullptr;
+  ebur128_callbacks.new_sample = nullptr;
+  gst_object_unref(bus);
+  gst_element_set_state(pipeline, GST_STATE_NULL);
+  gst_object_unref(pipeline);
+
+  return success;
+
+}
+
+void SongAnalysisPipeline::NewPadCallback(GstElement*, GstPad *pad, gpointer self) {
+
+  SongAnalysisPipeline *instance = reinterpret_cast<SongAnalysisPipeline*>(self);
+  GstPad *const audiopad = gst_element_get_static_pad(instance->convert_element_, "sink");
+
+  if (GST_PAD_IS_LINKED(audiopad)) {
+    qLog(Warning) << "audiopad is already linked, unlinking old pad";
+    gst_pad_unlink(audiopad, GST_PAD_PEER(audiopad));
+  }
+
+  gst_pad_link(pad, audiopad);
+  gst_object_unref(audiopad);
+
+}
+
+#ifdef HAVE_SONGFINGERPRINTING
+GstFlowReturn SongAnalysisPipeline::NewFingerprintBufferCallback(GstAppSink *app_sink, gpointer self) {
+
+  SongAnalysisPipeline *instance = reinterpret_cast<SongAnalysisPipeline*>(self);
+
+  GstSample *sample = gst_app_sink_pull_sample(app_sink);
+  if (!sample) return GST_FLOW_ERROR;
+
+  // Keep pulling after the fingerprint has enough data, returning EOS here could stop the tee feeding the other branches.
+  const qint64 remaining = Chromaprinter::DecodeDataSize() - instance->fingerprint_data.size();
+  GstBuffer *buffer = gst_sample_get_buffer(sample);
+  if (buffer && remaining > 0) {
+    GstMapInfo map;
+    if (gst_buffer_map(buffer, &map, GST_MAP_READ)) {
+      instance->fingerprint_data.append(reinterpret_cast<const char*>(map.data), static_cast<int>(qMin(static_cast<qint64>(map.size), remaining)));
+      gst_buffer_unmap(buffer, &map);
+    }
+  }
+  gst_sample_unref(sample);
+
+  return GST_FLOW_OK;
+
+}
+#endif
+
+#ifdef HAVE_EBUR128
+GstFlowReturn SongAnalysisPipeline::NewEBUR128BufferCallback(GstAppSink *app_sink, gpointer self) {
+
+  SongAnalysisPipeline *instance = reinterpret_cast<SongAnalysisPipeline*>(self);
+
+  GstSample *sample = gst_app_sink_pull_sample(app_sink);
+  if (!sample) return GST_FLOW_ERROR;
+
+  const bool success = instance->ebur128_accumulator.AddSample(sample);
+  gst_sample_unref(sample);
+
+  return success ? GST_FLOW_OK : GST_FLOW_ERROR;
+
+}
+#endif
+
+}  // namespace
+
+Song SongAnalysis::Analyze(Song song, const bool fingerprint, const bool ebur128) {
+
+  Q_ASSERT(QThread::currentThread() != qApp->thread());
+
+#ifdef HAVE_SONGFINGERPRINTING
+  const bool create_fingerprint = fingerprint && song.fingerprint().isEmpty();
+#else
+  Q_UNUSED(fingerprint)
+  const bool create_fingerprint = false;
+#endif
+
+#ifdef HAVE_EBUR128
+  const bool measure_loudness = ebur128 && (!song.ebur128_integrated_loudness_lufs() || !song.ebur128_loudness_range_lu());
+#else
+  Q_UNUSED(ebur128)
+  const bool measure_loudness = false;
+#endif
+
+  if (!create_fingerprint && !measure_loudness) return song;
+
+  // The fingerprint is always created from the start of the file, while the loudness of a song from a cue sheet is measured from its own beginning.
+  // These can't share a decode.
+  if (create_fingerprint && measure_loudness && song.beginning_nanosec() > 0) {
+    song = Analyze(song, true, false);
+    return Analyze(song, false, true);
+  }
+
+  SongAnalysisPipeline pipeline(create_fingerprint, measure_loudness);
+  const bool success = pipeline.Run(song);
+
+#ifdef HAVE_SONGFINGERPRINTING
+  if (create_fingerprint) {
+    const QString song_fingerprint = Chromaprinter::FingerprintFromData(pipeline.fingerprint_data);
+    song.set_fingerprint(song_fingerprint.isEmpty() ? QStringLiteral("NONE") : song_fingerprint);
+  }
+#endif
+
+#ifdef HAVE_EBUR128
+  if (measure_loudness && success) {
+    std::optional<EBUR128Measures> loudness_characteristics = pipeline.ebur128_accumulator.Finalize();
+    if (loudness_characteristics) {
+      song.set_ebur128_integrated_loudness_lufs(loudness_characteristics->loudness_lufs);
+      song.set_ebur128_loudness_range_lu(loudness_characteristics->range_lu);
+    }
+  }
+#else
+  Q_UNUSED(success)
+#endif
+
+  return song;
+
+}
@@ -0,0 +1,38 @@
+/*
+ * Strawberry Music Player
+ *
+ * Strawberry is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Strawberry is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Strawberry.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#ifndef SONGANALYSIS_H
+#define SONGANALYSIS_H
+
+#include "config.h"
+
+#include "core/song.h"
+
+class SongAnalysis {
+ public:
+  ~SongAnalysis() = delete;  // Do not construct variables of this class.
+
+  // Creates the missing fingerprint and EBU R 128 loudness characteristics of the song from a single decode.
+  // The decoded audio is split with a tee into one branch for each analysis.
+  // Returns the song with the results set, a fingerprint that couldn't be created is set to "NONE".
+  //
+  // This method is blocking, so you want to call it in another thread.
+  static Song Analyze(Song song, const bool fingerprint, const bool ebur128);
+};
+
+#endif  // SONGANALYSIS_H
@@ -30,6 +30,7 @@
 #include <QMetaType>
 #include <QVariant>
 #include <QByteArray>
+#include <QString>
 #include <QUrl>
 
 #include "core/shared_ptr.h"
@@ -40,11 +41,17 @@
 #include "vlcengine.h"
 #include "vlcscopedref.h"
 
+const size_t VLCEngine::kScopeBufferSize = 262144;                    // About 1.3s of 96kHz stereo
+const size_t VLCEngine::kScopeMaxBacklogMsec = 500;
+const int VLCEngine::kPreloadParseTimeoutMsec = 5000;
+
 VLCEngine::VLCEngine(SharedPtr<TaskManager> task_manager, QObject *parent)
     : EngineBase(parent),
       instance_(nullptr),
       player_(nullptr),
-      state_(State::Empty) {
+      state_(State::Empty),
+      preload_media_(nullptr),
+      scope_buffer_(kScopeBufferSize) {
 
   Q_UNUSED(task_manager);
 
@@ -70,6 +77,8 @@ VLCEngine::~VLCEngine() {
     libvlc_event_detach(player_em, libvlc_MediaPlayerEndReached, StateChangedCallback, this);
   }
 
+  ReleasePreloadMedia();
+
   libvlc_media_player_release(player_);
   libvlc_release(instance_);
 
@@ -102,6 +111,28 @@ bool VLCEngine::Init() {
 
 }
 
+void VLCEngine::StartPreloading(const QUrl &media_url, const QUrl &stream_url, const bool force_stop_at_end, const qint64 beginning_nanosec, const qint64 end_nanosec) {
+
+  Q_UNUSED(media_url);
+  Q_UNUSED(force_stop_at_end);
+  Q_UNUSED(beginning_nanosec);
+  Q_UNUSED(end_nanosec);
+
+  if (!Initialized() || (preload_media_ && preload_url_ == stream_url)) return;
+
+  ReleasePreloadMedia();
+
+  preload_media_ = CreateMedia(stream_url);
+  if (!preload_media_) return;
+  preload_url_ = stream_url;
+
+  // Parsing is asynchronous, by the time the current track ends the next one is opened and probed.
+  if (libvlc_media_parse_with_options(preload_media_, libvlc_media_parse_network, kPreloadParseTimeoutMsec) != 0) {
+    qLog(Debug) << "Failed to start parsing" << stream_url;
+  }
+
+}
+
 bool VLCEngine::Load(const QUrl &media_url, const QUrl &stream_url, const EngineBase::TrackChangeFlags change, const bool force_stop_at_end, const quint64 beginning_nanosec, const qint64 end_nanosec, const std::optional<double> ebur128_integrated_loudness_lufs) {
 
   // FIXME: why is this not calling `EngineBase::Load()`?
@@ -115,10 +146,23 @@ bool VLCEngine::Load(const QUrl &media_url, const QUrl &stream_url, const Engine
 
   if (!Initialized()) return false;
 
-  // Create the media object
-  VlcScopedRef<libvlc_media_t> media(libvlc_media_new_location(instance_, stream_url.toEncoded().constData()));
+  // Use the preloaded media object if we have one for this URL, otherwise create it
+  libvlc_media_t *media = nullptr;
+  if (preload_media_ && preload_url_ == stream_url) {
+    media = preload_media_;
+    preload_media_ = nullptr;
+    preload_url_.clear();
+  }
+  else {
+    ReleasePreloadMedia();
+    media = CreateMedia(stream_url);
+  }
+  if (!media) return false;
 
-  libvlc_media_player_set_media(player_, media);
+  VlcScopedRef<libvlc_media_t> media_ref(media);
+  libvlc_media_player_set_media(player_, media_ref);
+
+  scope_buffer_.Clear();
 
   return true;
 
@@ -222,6 +266,25 @@ qint64 VLCEngine::length_nanosec() const {
 
 }
 
+const EngineBase::Scope &VLCEngine::scope(const int chunk_length) {
+
+  const size_t samples_per_sec = static_cast<size_t>(std::max(0, scope_buffer_.samples_per_sec()));
+  if (samples_per_sec == 0) return scope_;
+
+  // Read one chunk, keeping the count even so the channels stay interleaved the same way.
+  const size_t count = std::min(samples_per_sec * static_cast<size_t>(chunk_length) / 1000, scope_.size()) & ~static_cast<size_t>(1);
+  const size_t backlog = (samples_per_sec * kScopeMaxBacklogMsec / 1000) & ~static_cast<size_t>(1);
+  const size_t available = scope_buffer_.Available();
+  if (available > backlog + count) {
+    scope_buffer_.Skip((available - backlog - count) & ~static_cast<size_t>(1));
+  }
+
+  scope_buffer_.Read(scope_.data(), count);
+
+  return scope_;
+
+}
+
 EngineBase::OutputDetailsList VLCEngine::GetOutputsList() const {
 
   OutputDetailsList outputs;
@@ -339,6 +402,58 @@ void VLCEngine::StateChangedCallback(const libvlc_event_t *e, void *data) {
 
 }
 
+libvlc_media_t *VLCEngine::CreateMedia(const QUrl &stream_url) {
+
+  libvlc_media_t *media = libvlc_media_new_location(instance_, stream_url.toEncoded().constData());
+  if (!media) return nullptr;
+
+  // libvlc_audio_set_callbacks() would replace the audio output, so the decoded audio is duplicated to the output and to smem instead.
+  // The smem branch is converted to interleaved S16 stereo, the same format the GStreamer engine feeds the analyzers.
+  const QString sout = QStringLiteral(":sout=#duplicate{dst=display,dst=\"transcode{vcodec=none,acodec=s16l,channels=2,samplerate=44100}:smem{audio-prerender-callback=%1,audio-postrender-callback=%2,audio-data=%3}\"}")
+                           .arg(reinterpret_cast<quintptr>(&ScopePrerenderCallback))
+                           .arg(reinterpret_cast<quintptr>(&ScopePostrenderCallback))
+                           .arg(reinterpret_cast<quintptr>(this));
+  libvlc_media_add_option(media, sout.toUtf8().constData());
+
+  return media;
+
+}
+
+void VLCEngine::ReleasePreloadMedia() {
+
+  if (preload_media_) {
+    libvlc_media_release(preload_media_);
+    preload_media_ = nullptr;
+  }
+  preload_url_.clear();
+
+}
+
+void VLCEngine::ScopePrerenderCallback(void *data, uint8_t **buffer, size_t size) {
+
+  VLCEngine *engine = reinterpret_cast<VLCEngine*>(data);
+
+  if (engine->scope_render_buffer_.size() < size) {
+    engine->scope_render_buffer_.resize(size);
+  }
+  *buffer = engine->scope_render_buffer_.data();
+
+}
+
+void VLCEngine::ScopePostrenderCallback(void *data, uint8_t *buffer, unsigned int channels, unsigned int rate, unsigned int nb_samples, unsigned int bits_per_sample, size_t size, int64_t pts) {
+
+  Q_UNUSED(pts);
+
+  VLCEngine *engine = reinterpret_cast<VLCEngine*>(data);
+
+  if (bits_per_sample != 16 || channels == 0) return;
+
+  const size_t count = std::min(static_cast<size_t>(nb_samples) * channels, size / sizeof(qint16));
+  engine->scope_buffer_.set_samples_per_sec(static_cast<int>(rate * channels));
+  engine->scope_buffer_.Write(reinterpret_cast<const qint16*>(buffer), count);
+
+}
+
 void VLCEngine::GetDevicesList(const QString &output) const {
 
   Q_UNUSED(output);
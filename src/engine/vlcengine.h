@@ -25,6 +25,7 @@
 #include "config.h"
 
 #include <optional>
+#include <vector>
 
 #include <vlc/vlc.h>
 
@@ -36,6 +37,7 @@
 #include "core/shared_ptr.h"
 
 #include "enginebase.h"
+#include "pcmringbuffer.h"
 
 struct libvlc_event_t;
 
@@ -51,6 +53,7 @@ class VLCEngine : public EngineBase {
   Type type() const override { return Type::VLC; }
   bool Init() override;
   EngineBase::State state() const override { return state_; }
+  void StartPreloading(const QUrl &media_url, const QUrl &stream_url, const bool force_stop_at_end, const qint64 beginning_nanosec, const qint64 end_nanosec) override;
   bool Load(const QUrl &media_url, const QUrl &stream_url, const EngineBase::TrackChangeFlags change, const bool force_stop_at_end, const quint64 beginning_nanosec, const qint64 end_nanosec, const std::optional<double> ebur128_integrated_loudness_lufs) override;
   bool Play(const quint64 offset_nanosec) override;
   void Stop(const bool stop_after = false) override;
@@ -65,24 +68,41 @@ class VLCEngine : public EngineBase {
   qint64 position_nanosec() const override;
   qint64 length_nanosec() const override;
 
+  const Scope &scope(const int chunk_length) override;
+
   OutputDetailsList GetOutputsList() const override;
   bool ValidOutput(const QString &output) override;
   QString DefaultOutput() override { return QLatin1String(""); }
   bool CustomDeviceSupport(const QString &output) override;
   bool ALSADeviceSupport(const QString &output) override;
   bool ExclusiveModeSupport(const QString &output) override;
-
  private:
+  static const size_t kScopeBufferSize;
+  static const size_t kScopeMaxBacklogMsec;
+  static const int kPreloadParseTimeoutMsec;
+
   libvlc_instance_t *instance_;
   libvlc_media_player_t *player_;
   State state_;
 
+  // The next media is created and parsed ahead of time, so the track change doesn't have to wait for opening and probing it.
+  libvlc_media_t *preload_media_;
+  QUrl preload_url_;
+
+  // Decoded audio for the analyzers, written by the smem callbacks in a VLC thread and read in the GUI thread.
+  PCMRingBuffer scope_buffer_;
+  std::vector<uint8_t> scope_render_buffer_;
+
   bool Initialized() const { return (instance_ && player_); }
   uint position() const;
   uint length() const;
   static bool CanDecode(const QUrl &url);
   void AttachCallback(libvlc_event_manager_t *em, libvlc_event_type_t type, libvlc_callback_t callback);
   static void StateChangedCallback(const libvlc_event_t *e, void *data);
+  libvlc_media_t *CreateMedia(const QUrl &stream_url);
+  void ReleasePreloadMedia();
+  static void ScopePrerenderCallback(void *data, uint8_t **buffer, size_t size);
+  static void ScopePostrenderCallback(void *data, uint8_t *buffer, unsigned int channels, unsigned int rate, unsigned int nb_samples, unsigned int bits_per_sample, size_t size, int64_t pts);
 
   void GetDevicesList(const QString &output) const;
 };
@@ -0,0 +1,238 @@
+/*
+ * Strawberry Music Player
+ *
+ * Strawberry is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Strawberry is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Strawberry.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#include "config.h"
+
+#include <memory>
+#include <utility>
+
+#include <QtGlobal>
+#include <QObject>
+#include <QTimer>
+#include <QList>
+#include <QByteArray>
+#include <QByteArrayList>
+#include <QString>
+#include <QStringList>
+#include <QUrl>
+#include <QFile>
+#include <QImage>
+#include <QImageReader>
+#include <QNetworkRequest>
+#include <QNetworkReply>
+
+#include "core/logging.h"
+#include "core/networkaccessmanager.h"
+#include "core/networktimeouts.h"
+#include "utilities/imageutils.h"
+#include "internetcoverdownloader.h"
+
+using std::make_shared;
+
+const int InternetCoverDownloader::kInitialConcurrentRequestsPerHost = 2;
+const int InternetCoverDownloader::kMaxConcurrentRequestsPerHost = 6;
+const int InternetCoverDownloader::kTimeoutMsec = 30000;
+
+InternetCoverDownloader::Host::Host() : concurrency(kInitialConcurrentRequestsPerHost, kMaxConcurrentRequestsPerHost) {}
+
+InternetCoverDownloader::InternetCoverDownloader(SharedPtr<NetworkAccessManager> network, QObject *parent)
+    : QObject(parent),
+      network_(network),
+      timeouts_(new NetworkTimeouts(kTimeoutMsec, this)),
+      timer_flush_requests_(new QTimer(this)),
+      next_id_(1) {
+
+  timer_flush_requests_->setSingleShot(true);
+  QObject::connect(timer_flush_requests_, &QTimer::timeout, this, &InternetCoverDownloader::FlushRequests);
+
+}
+
+InternetCoverDownloader::~InternetCoverDownloader() {
+
+  while (!replies_.isEmpty()) {
+    QNetworkReply *reply = replies_.takeFirst();
+    QObject::disconnect(reply, nullptr, this, nullptr);
+    if (reply->isRunning()) reply->abort();
+    reply->deleteLater();
+  }
+
+}
+
+QString InternetCoverDownloader::HostKey(const QUrl &url) {
+
+  return url.host().toLower();
+
+}
+
+quint64 InternetCoverDownloader::Download(const QNetworkRequest &network_request, const QString &filename) {
+
+  const quint64 id = next_id_++;
+  const QUrl url = network_request.url();
+  ids_.insert(url, id);
+
+  // The cover was saved by an earlier request, it's answered from the event loop like a download.
+  if (downloaded_.contains(url) && QFile::exists(downloaded_[url])) {
+    const QString downloaded_filename = downloaded_[url];
+    QTimer::singleShot(0, this, [this, id, url, downloaded_filename]() {
+      if (!ids_.contains(url, id)) return;
+      ids_.remove(url, id);
+      emit Finished(id, downloaded_filename, QString());
+    });
+    return id;
+  }
+
+  if (requests_.contains(url)) return id;
+
+  CoverRequest request;
+  request.network_request = network_request;
+  request.filename = filename;
+  requests_.insert(url, request);
+
+  const QString host_key = HostKey(url);
+  if (!hosts_.contains(host_key)) hosts_.insert(host_key, make_shared<Host>());
+  SharedPtr<Host> host = hosts_.value(host_key);
+  host->queue.Enqueue(url);
+  FlushHostRequests(&*host);
+
+  return id;
+
+}
+
+void InternetCoverDownloader::Cancel(const quint64 id) {
+
+  for (QMultiHash<QUrl, quint64>::iterator it = ids_.begin(); it != ids_.end(); ++it) {
+    if (it.value() != id) continue;
+    const QUrl url = it.key();
+    ids_.erase(it);
+    // Queued requests nobody waits for anymore are dropped when they're flushed, running ones are left to finish.
+    if (!ids_.contains(url)) requests_.remove(url);
+    return;
+  }
+
+}
+
+void InternetCoverDownloader::FlushRequests() {
+
+  for (SharedPtr<Host> host : std::as_const(hosts_)) {
+    FlushHostRequests(&*host);
+  }
+
+}
+
+void InternetCoverDownloader::FlushHostRequests(Host *host) {
+
+  host->queue.Flush(host->concurrency.limit(), [this, host](const QUrl &url) -> QNetworkReply* {
+    if (!requests_.contains(url)) return nullptr;
+    QNetworkReply *reply = network_->get(requests_[url].network_request);
+    replies_ << reply;
+    host->concurrency.ReplyStarted(reply);
+    timeouts_->AddReply(reply);
+    QObject::connect(reply, &QNetworkReply::finished, this, [this, reply, url]() { ReplyReceived(reply, url); });
+    return reply;
+  });
+
+}
+
+void InternetCoverDownloader::ReplyReceived(QNetworkReply *reply, const QUrl &url) {
+
+  if (!replies_.contains(reply)) return;
+  replies_.removeAll(reply);
+  QObject::disconnect(reply, nullptr, this, nullptr);
+  reply->deleteLater();
+
+  SharedPtr<Host> host = hosts_.value(HostKey(url));
+  if (!host) return;
+
+  host->concurrency.ReplyFinished(reply);
+
+  if (requests_.contains(url) && InternetRequestConcurrency::IsThrottled(reply)) {
+    qint64 delay_msec = 0;
+    if (host->queue.Retry(reply, &delay_msec)) {
+      qLog(Debug) << "Cover request for" << url << "was throttled, retrying in" << delay_msec << "ms";
+      if (!timer_flush_requests_->isActive() || timer_flush_requests_->remainingTime() > delay_msec) {
+        timer_flush_requests_->start(static_cast<int>(delay_msec));
+      }
+      return;
+    }
+  }
+
+  host->queue.ReplyReceived(reply);
+
+  if (requests_.contains(url)) {
+    const QString filename = requests_[url].filename;
+    Finish(url, filename, SaveImage(reply, url, filename));
+  }
+
+  FlushHostRequests(&*host);
+
+}
+
+QString InternetCoverDownloader::SaveImage(QNetworkReply *reply, const QUrl &url, const QString &filename) {
+
+  if (reply->error() != QNetworkReply::NoError) {
+    return QStringLiteral("%1 (%2) for %3").arg(reply->errorString()).arg(reply->error()).arg(url.toString());
+  }
+
+  if (reply->attribute(QNetworkRequest::HttpStatusCodeAttribute).toInt() != 200) {
+    return QStringLiteral("Received HTTP code %1 for %2.").arg(reply->attribute(QNetworkRequest::HttpStatusCodeAttribute).toInt()).arg(url.toString());
+  }
+
+  QString mimetype = reply->header(QNetworkRequest::ContentTypeHeader).toString();
+  if (mimetype.contains(QLatin1Char(';'))) {
+    mimetype = mimetype.left(mimetype.indexOf(QLatin1Char(';')));
+  }
+  if (!ImageUtils::SupportedImageMimeTypes().contains(mimetype, Qt::CaseInsensitive) && !ImageUtils::SupportedImageFormats().contains(mimetype, Qt::CaseInsensitive)) {
+    return QStringLiteral("Unsupported mimetype for image reader %1 for %2").arg(mimetype, url.toString());
+  }
+
+  const QByteArray data = reply->readAll();
+  if (data.isEmpty()) {
+    return QStringLiteral("Received empty image data for %1").arg(url.toString());
+  }
+
+  QByteArrayList format_list = QImageReader::imageFormatsForMimeType(mimetype.toUtf8());
+  char *format = nullptr;
+  if (!format_list.isEmpty()) {
+    format = format_list.first().data();
+  }
+
+  QImage image;
+  if (!image.loadFromData(data, format)) {
+    return QStringLiteral("Error decoding image data from %1.").arg(url.toString());
+  }
+
+  if (!image.save(filename, format)) {
+    return QStringLiteral("Error saving image data to %1.").arg(filename);
+  }
+
+  return QString();
+
+}
+
+void InternetCoverDownloader::Finish(const QUrl &url, const QString &filename, const QString &error) {
+
+  requests_.remove(url);
+  if (error.isEmpty()) downloaded_.insert(url, filename);
+
+  const QList<quint64> ids = ids_.values(url);
+  ids_.remove(url);
+  for (const quint64 id : ids) {
+    emit Finished(id, filename, error);
+  }
+
+}
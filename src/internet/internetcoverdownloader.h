@@ -0,0 +1,97 @@
+/*
+ * Strawberry Music Player
+ *
+ * Strawberry is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Strawberry is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Strawberry.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#ifndef INTERNETCOVERDOWNLOADER_H
+#define INTERNETCOVERDOWNLOADER_H
+
+#include "config.h"
+
+#include <QtGlobal>
+#include <QObject>
+#include <QList>
+#include <QHash>
+#include <QMultiHash>
+#include <QString>
+#include <QUrl>
+#include <QNetworkRequest>
+
+#include "core/shared_ptr.h"
+#include "internetrequestconcurrency.h"
+#include "internetrequestqueue.h"
+
+class QTimer;
+class QNetworkReply;
+class NetworkAccessManager;
+class NetworkTimeouts;
+
+// Downloads the album covers for the requests of all streaming services.
+// Each host has its own queue and concurrency limit, so one slow server doesn't hold up the covers of the other services.
+// A cover URL that is requested for more than one album is only downloaded once, and the saved file is reused for the rest of the session.
+class InternetCoverDownloader : public QObject {
+  Q_OBJECT
+
+ public:
+  explicit InternetCoverDownloader(SharedPtr<NetworkAccessManager> network, QObject *parent = nullptr);
+  ~InternetCoverDownloader() override;
+
+  // Downloads the cover and saves it to the file, Finished is emitted with the returned id when it's done.
+  // If the URL was already downloaded or is being downloaded, the file of the first download is used instead.
+  quint64 Download(const QNetworkRequest &network_request, const QString &filename);
+  // Finished is not emitted for cancelled downloads.
+  void Cancel(const quint64 id);
+
+ signals:
+  void Finished(const quint64 id, const QString &filename, const QString &error);
+
+ private slots:
+  void FlushRequests();
+  void ReplyReceived(QNetworkReply *reply, const QUrl &url);
+
+ private:
+  struct CoverRequest {
+    QNetworkRequest network_request;
+    QString filename;
+  };
+  struct Host {
+    explicit Host();
+    InternetRequestQueue<QUrl> queue;
+    InternetRequestConcurrency concurrency;
+  };
+
+  static QString HostKey(const QUrl &url);
+  void FlushHostRequests(Host *host);
+  QString SaveImage(QNetworkReply *reply, const QUrl &url, const QString &filename);
+  void Finish(const QUrl &url, const QString &filename, const QString &error);
+
+  static const int kInitialConcurrentRequestsPerHost;
+  static const int kMaxConcurrentRequestsPerHost;
+  static const int kTimeoutMsec;
+
+  SharedPtr<NetworkAccessManager> network_;
+  NetworkTimeouts *timeouts_;
+  QTimer *timer_flush_requests_;
+  quint64 next_id_;
+
+  QHash<QString, SharedPtr<Host>> hosts_;
+  QHash<QUrl, CoverRequest> requests_;
+  QMultiHash<QUrl, quint64> ids_;
+  QHash<QUrl, QString> downloaded_;
+  QList<QNetworkReply*> replies_;
+};
+
+#endif  // INTERNETCOVERDOWNLOADER_H
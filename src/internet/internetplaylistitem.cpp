@@ -80,5 +80,6 @@ void InternetPlaylistItem::SetArtManual(const QUrl &cover_url) {
 
   metadata_.set_art_manual(cover_url);
   temp_metadata_.set_art_manual(cover_url);
+  DatabaseMetadataChanged();
 
 }
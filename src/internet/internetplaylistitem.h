@@ -46,7 +46,10 @@ class InternetPlaylistItem : public PlaylistItem {
   Song OriginalMetadata() const override { return metadata_; }
   QUrl Url() const override;
 
-  void SetMetadata(const Song &metadata) override { metadata_ = metadata; }
+  void SetMetadata(const Song &metadata) override {
+    metadata_ = metadata;
+    DatabaseMetadataChanged();
+  }
   void SetArtManual(const QUrl &cover_url) override;
 
  protected:
@@ -0,0 +1,183 @@
+/*
+ * Strawberry Music Player
+ *
+ * Strawberry is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Strawberry is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Strawberry.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#include "config.h"
+
+#include <QtGlobal>
+#include <QHash>
+#include <QByteArray>
+#include <QString>
+#include <QUrl>
+#include <QDir>
+#include <QFile>
+#include <QIODevice>
+#include <QDataStream>
+#include <QStandardPaths>
+#include <QCryptographicHash>
+#include <QNetworkRequest>
+#include <QNetworkReply>
+
+#include "core/logging.h"
+#include "internetreplycache.h"
+
+namespace {
+constexpr char kIndexFile[] = "index";
+constexpr quint32 kIndexVersion = 1;
+}  // namespace
+
+InternetReplyCache::InternetReplyCache(const QString &name)
+    : cache_dir_(QStandardPaths::writableLocation(QStandardPaths::CacheLocation) + QStringLiteral("/replies/") + name),
+      loaded_(false),
+      dirty_(false) {}
+
+InternetReplyCache::~InternetReplyCache() {
+  Save();
+}
+
+QString InternetReplyCache::Key(const QNetworkRequest &request) {
+
+  // The authorization is sent in headers, so the URL is the same for each session.
+  return request.url().toString(QUrl::FullyEncoded);
+
+}
+
+QString InternetReplyCache::DataFileName(const QString &key) const {
+
+  return cache_dir_ + QLatin1Char('/') + QString::fromLatin1(QCryptographicHash::hash(key.toUtf8(), QCryptographicHash::Sha1).toHex());
+
+}
+
+void InternetReplyCache::Load() {
+
+  if (loaded_) return;
+  loaded_ = true;
+
+  QFile file(cache_dir_ + QLatin1Char('/') + QLatin1String(kIndexFile));
+  if (!file.open(QIODevice::ReadOnly)) return;
+
+  QDataStream s(&file);
+  quint32 version = 0;
+  s >> version;
+  if (version != kIndexVersion) return;
+
+  quint32 count = 0;
+  s >> count;
+  for (quint32 i = 0; i < count && s.status() == QDataStream::Ok; ++i) {
+    QString key;
+    Entry entry;
+    s >> key >> entry.etag >> entry.last_modified;
+    if (s.status() == QDataStream::Ok) entries_.insert(key, entry);
+  }
+
+}
+
+void InternetReplyCache::AddValidators(QNetworkRequest *request) {
+
+  Load();
+
+  // The data is cached here, so the disk cache of the network access manager must not answer or store the request.
+  request->setAttribute(QNetworkRequest::CacheLoadControlAttribute, QNetworkRequest::AlwaysNetwork);
+  request->setAttribute(QNetworkRequest::CacheSaveControlAttribute, false);
+
+  const QString key = Key(*request);
+  if (!entries_.contains(key) || !QFile::exists(DataFileName(key))) return;
+
+  const Entry entry = entries_.value(key);
+  if (!entry.etag.isEmpty()) request->setRawHeader("If-None-Match", entry.etag);
+  if (!entry.last_modified.isEmpty()) request->setRawHeader("If-Modified-Since", entry.last_modified);
+
+}
+
+bool InternetReplyCache::NotModified(QNetworkReply *reply, QByteArray *data) {
+
+  if (reply->attribute(QNetworkRequest::HttpStatusCodeAttribute).toInt() != 304) return false;
+
+  QFile file(DataFileName(Key(reply->request())));
+  if (!file.open(QIODevice::ReadOnly)) {
+    qLog(Error) << "Unable to read cached reply" << file.fileName() << file.errorString();
+    return false;
+  }
+  *data = file.readAll();
+  file.close();
+
+  return !data->isEmpty();
+
+}
+
+void InternetReplyCache::Store(QNetworkReply *reply, const QByteArray &data) {
+
+  Load();
+
+  const QString key = Key(reply->request());
+
+  Entry entry;
+  entry.etag = reply->rawHeader("ETag");
+  entry.last_modified = reply->rawHeader("Last-Modified");
+  if ((entry.etag.isEmpty() && entry.last_modified.isEmpty()) || data.isEmpty()) {
+    if (entries_.remove(key) > 0) {
+      QFile::remove(DataFileName(key));
+      dirty_ = true;
+    }
+    return;
+  }
+
+  if (!QDir().mkpath(cache_dir_)) return;
+
+  QFile file(DataFileName(key));
+  if (!file.open(QIODevice::WriteOnly | QIODevice::Truncate)) {
+    qLog(Error) << "Unable to write cached reply" << file.fileName() << file.errorString();
+    return;
+  }
+  file.write(data);
+  file.close();
+
+  entries_.insert(key, entry);
+  dirty_ = true;
+
+}
+
+void InternetReplyCache::Save() {
+
+  if (!dirty_ || !QDir().mkpath(cache_dir_)) return;
+
+  QFile file(cache_dir_ + QLatin1Char('/') + QLatin1String(kIndexFile));
+  if (!file.open(QIODevice::WriteOnly | QIODevice::Truncate)) {
+    qLog(Error) << "Unable to write reply cache index" << file.fileName() << file.errorString();
+    return;
+  }
+
+  QDataStream s(&file);
+  s << kIndexVersion << static_cast<quint32>(entries_.count());
+  for (QHash<QString, Entry>::const_iterator it = entries_.constBegin(); it != entries_.constEnd(); ++it) {
+    s << it.key() << it.value().etag << it.value().last_modified;
+  }
+  file.close();
+
+  dirty_ = false;
+
+}
+
+void InternetReplyCache::Clear() {
+
+  entries_.clear();
+  loaded_ = true;
+  dirty_ = false;
+
+  QDir(cache_dir_).removeRecursively();
+
+}
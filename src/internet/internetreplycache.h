@@ -0,0 +1,70 @@
+/*
+ * Strawberry Music Player
+ *
+ * Strawberry is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Strawberry is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Strawberry.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#ifndef INTERNETREPLYCACHE_H
+#define INTERNETREPLYCACHE_H
+
+#include "config.h"
+
+#include <QtGlobal>
+#include <QHash>
+#include <QByteArray>
+#include <QString>
+
+class QNetworkRequest;
+class QNetworkReply;
+
+// Keeps the validators and the data of the replies of a streaming service on disk, so a refresh can revalidate pages with conditional requests.
+// A page that wasn't modified is answered with a 304 and the data from the last refresh is used instead.
+// The data is kept in one file per page, only the index with the validators is loaded.
+class InternetReplyCache {
+ public:
+  explicit InternetReplyCache(const QString &name);
+  ~InternetReplyCache();
+
+  // Sets If-None-Match and If-Modified-Since if the data for the URL was stored.
+  void AddValidators(QNetworkRequest *request);
+
+  // Returns true if the reply is a 304 and the data could be read from the cache.
+  bool NotModified(QNetworkReply *reply, QByteArray *data);
+
+  // Stores the data of a 200 reply that has an ETag or Last-Modified header.
+  void Store(QNetworkReply *reply, const QByteArray &data);
+
+  void Save();
+  void Clear();
+
+ private:
+  struct Entry {
+    QByteArray etag;
+    QByteArray last_modified;
+  };
+
+  static QString Key(const QNetworkRequest &request);
+  QString DataFileName(const QString &key) const;
+  void Load();
+
+  QString cache_dir_;
+  bool loaded_;
+  bool dirty_;
+  QHash<QString, Entry> entries_;
+
+  Q_DISABLE_COPY(InternetReplyCache)
+};
+
+#endif  // INTERNETREPLYCACHE_H
@@ -0,0 +1,92 @@
+/*
+ * Strawberry Music Player
+ *
+ * Strawberry is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Strawberry is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Strawberry.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#include "config.h"
+
+#include <QtGlobal>
+#include <QNetworkRequest>
+#include <QNetworkReply>
+
+#include "internetrequestconcurrency.h"
+
+const int InternetRequestConcurrency::kMinLimit = 1;
+const int InternetRequestConcurrency::kSlowLatencyFactor = 4;
+const qint64 InternetRequestConcurrency::kSlowLatencyMinMsec = 2000;
+
+InternetRequestConcurrency::InternetRequestConcurrency(const int initial_limit, const int max_limit)
+    : limit_(qBound(kMinLimit, initial_limit, max_limit)),
+      max_limit_(max_limit),
+      min_latency_msec_(-1),
+      last_decrease_msec_(-1) {
+
+  timer_.start();
+
+}
+
+int InternetRequestConcurrency::limit() const {
+
+  return qMax(kMinLimit, static_cast<int>(limit_));
+
+}
+
+void InternetRequestConcurrency::ReplyStarted(QNetworkReply *reply) {
+
+  replies_.insert(reply, timer_.elapsed());
+
+}
+
+void InternetRequestConcurrency::ReplyFinished(QNetworkReply *reply) {
+
+  if (!replies_.contains(reply)) return;
+
+  const qint64 start_msec = replies_.take(reply);
+  AddResult(start_msec, timer_.elapsed(), IsThrottled(reply));
+
+}
+
+bool InternetRequestConcurrency::IsThrottled(QNetworkReply *reply) {
+
+  const int http_status_code = reply->attribute(QNetworkRequest::HttpStatusCodeAttribute).toInt();
+  // Requests aborted by the network timeouts are treated like throttling.
+  return http_status_code == 429 || http_status_code >= 500 || reply->error() == QNetworkReply::OperationCanceledError || reply->error() == QNetworkReply::TimeoutError;
+
+}
+
+void InternetRequestConcurrency::AddResult(const qint64 start_msec, const qint64 finish_msec, const bool throttled) {
+
+  const qint64 latency_msec = finish_msec - start_msec;
+
+  bool slow = false;
+  if (!throttled) {
+    if (min_latency_msec_ < 0 || latency_msec < min_latency_msec_) {
+      min_latency_msec_ = latency_msec;
+    }
+    slow = latency_msec > qMax(kSlowLatencyMinMsec, min_latency_msec_ * kSlowLatencyFactor);
+  }
+
+  if (throttled || slow) {
+    if (start_msec >= last_decrease_msec_) {
+      limit_ = qMax(static_cast<double>(kMinLimit), limit_ / 2.0);
+      last_decrease_msec_ = finish_msec;
+    }
+    return;
+  }
+
+  limit_ = qMin(static_cast<double>(max_limit_), limit_ + 1.0 / limit_);
+
+}
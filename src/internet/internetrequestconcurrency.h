@@ -0,0 +1,60 @@
+/*
+ * Strawberry Music Player
+ *
+ * Strawberry is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Strawberry is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Strawberry.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#ifndef INTERNETREQUESTCONCURRENCY_H
+#define INTERNETREQUESTCONCURRENCY_H
+
+#include "config.h"
+
+#include <QtGlobal>
+#include <QHash>
+#include <QElapsedTimer>
+
+class QNetworkReply;
+
+// Limits the number of concurrent requests to a streaming service with additive increase and multiplicative decrease.
+// The limit grows by about one for each round of replies, and is halved when the server throttles, fails or gets slow.
+class InternetRequestConcurrency {
+ public:
+  explicit InternetRequestConcurrency(const int initial_limit, const int max_limit);
+
+  int limit() const;
+
+  void ReplyStarted(QNetworkReply *reply);
+  void ReplyFinished(QNetworkReply *reply);
+
+  // Returns true if the server throttled or failed the request, so it is worth sending it again later.
+  static bool IsThrottled(QNetworkReply *reply);
+
+  // The times are in milliseconds, replies to requests started before the last decrease don't decrease the limit again.
+  void AddResult(const qint64 start_msec, const qint64 finish_msec, const bool throttled);
+
+ private:
+  static const int kMinLimit;
+  static const int kSlowLatencyFactor;
+  static const qint64 kSlowLatencyMinMsec;
+
+  QElapsedTimer timer_;
+  QHash<QNetworkReply*, qint64> replies_;
+  double limit_;
+  int max_limit_;
+  qint64 min_latency_msec_;
+  qint64 last_decrease_msec_;
+};
+
+#endif  // INTERNETREQUESTCONCURRENCY_H
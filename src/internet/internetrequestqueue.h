@@ -0,0 +1,125 @@
+/*
+ * Strawberry Music Player
+ *
+ * Strawberry is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Strawberry is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Strawberry.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#ifndef INTERNETREQUESTQUEUE_H
+#define INTERNETREQUESTQUEUE_H
+
+#include "config.h"
+
+#include <QtGlobal>
+#include <QList>
+#include <QHash>
+#include <QElapsedTimer>
+
+class QNetworkReply;
+
+// Queue for the paged requests of the streaming services.
+// It keeps track of the requests that are queued, sent and received, so the request classes only need to build the requests and parse the replies.
+// Requests the server throttled can be retried, they go back to the front of the queue and are sent again after an increasing delay.
+// Usage:
+//    queue.Enqueue(request);
+//    queue.Flush(max_concurrent_requests(), [this](const Request &request) { return CreateRequest(...); });
+//    ...
+//    if (throttled && queue.Retry(reply)) return;
+//    queue.ReplyReceived(reply);
+
+template<typename T>
+class InternetRequestQueue {
+ public:
+  explicit InternetRequestQueue(const int max_attempts = 3, const qint64 retry_delay_msec = 1000) : max_attempts_(max_attempts), retry_delay_msec_(retry_delay_msec), total_(0), received_(0) {
+    timer_.start();
+  }
+
+  bool isEmpty() const { return queue_.isEmpty(); }
+  int total() const { return total_; }
+  int active() const { return static_cast<int>(active_.count()); }
+  int received() const { return received_; }
+  int progress() const { return total_ > 0 ? static_cast<int>((static_cast<float>(received_) / static_cast<float>(total_)) * 100.0F) : 0; }
+
+  void Enqueue(const T &request) {
+    Entry entry;
+    entry.request = request;
+    entry.attempt = 0;
+    entry.not_before_msec = 0;
+    queue_ << entry;
+    ++total_;
+  }
+
+  // Sends queued requests until there are max_active requests active.
+  // The send function returns the reply for the request, or nullptr to drop it.
+  template<typename SendFunction>
+  void Flush(const int max_active, SendFunction send) {
+    const qint64 now_msec = timer_.elapsed();
+    for (int i = 0; i < queue_.count() && active() < max_active;) {
+      if (queue_[i].not_before_msec > now_msec) {
+        ++i;
+        continue;
+      }
+      const Entry entry = queue_.takeAt(i);
+      QNetworkReply *reply = send(entry.request);
+      if (reply) {
+        active_.insert(reply, entry);
+      }
+      else {
+        ++received_;
+      }
+    }
+  }
+
+  // Queues the request of the reply again, returns false if it has been tried too many times.
+  // The delay until the request can be sent again is returned in delay_msec.
+  bool Retry(QNetworkReply *reply, qint64 *delay_msec = nullptr) {
+    if (!active_.contains(reply) || active_[reply].attempt + 1 >= max_attempts_) return false;
+    Entry entry = active_.take(reply);
+    ++entry.attempt;
+    const qint64 delay = retry_delay_msec_ << (entry.attempt - 1);
+    entry.not_before_msec = timer_.elapsed() + delay;
+    queue_.prepend(entry);
+    if (delay_msec) *delay_msec = delay;
+    return true;
+  }
+
+  void ReplyReceived(QNetworkReply *reply) {
+    if (active_.remove(reply) > 0) ++received_;
+  }
+
+  // Drops the queued requests and forgets the active ones, their replies need to be aborted by the owner.
+  void Clear() {
+    queue_.clear();
+    active_.clear();
+    total_ = 0;
+    received_ = 0;
+  }
+
+ private:
+  struct Entry {
+    T request;
+    int attempt;
+    qint64 not_before_msec;
+  };
+
+  const int max_attempts_;
+  const qint64 retry_delay_msec_;
+  QElapsedTimer timer_;
+  QList<Entry> queue_;
+  QHash<QNetworkReply*, Entry> active_;
+  int total_;
+  int received_;
+};
+
+#endif  // INTERNETREQUESTQUEUE_H
@@ -36,8 +36,11 @@
 #include <QPair>
 #include <QList>
 #include <QMap>
+#include <QSet>
+#include <QHash>
 #include <QString>
 #include <QStringList>
+#include <QUrl>
 #include <QRegularExpression>
 #include <QPixmap>
 #include <QPixmapCache>
@@ -50,6 +53,7 @@
 #include <QMenu>
 #include <QAction>
 #include <QActionGroup>
+#include <QSignalBlocker>
 #include <QSettings>
 #include <QStackedWidget>
 #include <QLabel>
@@ -77,6 +81,7 @@
 #include "covermanager/albumcoverloaderresult.h"
 #include "internetsongmimedata.h"
 #include "internetservice.h"
+#include "internetservices.h"
 #include "internetsearchitemdelegate.h"
 #include "internetsearchmodel.h"
 #include "internetsearchsortmodel.h"
@@ -88,6 +93,8 @@ using std::make_unique;
 
 const int InternetSearchView::kSwapModelsTimeoutMsec = 250;
 const int InternetSearchView::kDelayedSearchTimeoutMs = 200;
+const int InternetSearchView::kSearchCacheSize = 20;
+const int InternetSearchView::kSearchCacheMaxAgeSec = 600;
 const int InternetSearchView::kArtHeight = 32;
 
 InternetSearchView::InternetSearchView(QWidget *parent)
@@ -97,6 +104,7 @@ InternetSearchView::InternetSearchView(QWidget *parent)
       ui_(new Ui_InternetSearchView),
       context_menu_(nullptr),
       group_by_actions_(nullptr),
+      action_search_all_services_(nullptr),
       front_model_(nullptr),
       back_model_(nullptr),
       current_model_(nullptr),
@@ -107,8 +115,10 @@ InternetSearchView::InternetSearchView(QWidget *parent)
       use_pretty_covers_(true),
       search_type_(InternetSearchView::SearchType::Artists),
       search_error_(false),
+      search_all_services_(false),
       last_search_id_(0),
-      searches_next_id_(1) {
+      searches_next_id_(1),
+      search_cache_(kSearchCacheSize) {
 
   ui_->setupUi(this);
 
@@ -177,6 +187,10 @@ void InternetSearchView::Init(Application *app, InternetServicePtr service) {
   QMenu *settings_menu = new QMenu(this);
   settings_menu->addActions(group_by_actions_->actions());
   settings_menu->addSeparator();
+  action_search_all_services_ = settings_menu->addAction(tr("Search all logged in services"));
+  action_search_all_services_->setCheckable(true);
+  QObject::connect(action_search_all_services_, &QAction::toggled, this, &InternetSearchView::SearchAllServicesToggled);
+  settings_menu->addSeparator();
   settings_menu->addAction(IconLoader::Load(QStringLiteral("configure")), tr("Configure %1...").arg(Song::DescriptionForSource(service_->source())), this, &InternetSearchView::OpenSettingsDialog);
   ui_->settings->setMenu(settings_menu);
 
@@ -198,6 +212,7 @@ void InternetSearchView::Init(Application *app, InternetServicePtr service) {
   QObject::connect(&*service_, &InternetService::SearchProgressSetMaximum, this, &InternetSearchView::ProgressSetMaximum);
   QObject::connect(&*service_, &InternetService::SearchUpdateProgress, this, &InternetSearchView::UpdateProgress);
   QObject::connect(&*service_, &InternetService::SearchResults, this, &InternetSearchView::SearchDone);
+  QObject::connect(&*service_, &InternetService::SearchPartialResults, this, &InternetSearchView::SearchPartialResults);
 
   QObject::connect(app_, &Application::SettingsChanged, this, &InternetSearchView::ReloadSettings);
   QObject::connect(&*app_->album_cover_loader(), &AlbumCoverLoader::AlbumCoverLoaded, this, &InternetSearchView::AlbumCoverLoaded);
@@ -234,6 +249,12 @@ void InternetSearchView::ReloadSettings() {
       break;
   }
 
+  search_all_services_ = s.value("search_all_services", false).toBool();
+  {
+    const QSignalBlocker blocker(action_search_all_services_);
+    action_search_all_services_->setChecked(search_all_services_);
+  }
+
   int group_by_version = s.value("search_group_by_version", 0).toInt();
   if (group_by_version == 1 && s.contains("search_group_by1") && s.contains("search_group_by2") && s.contains("search_group_by3")) {
     SetGroupBy(CollectionModel::Grouping(
@@ -389,6 +410,10 @@ void InternetSearchView::TextEdited(const QString &text) {
 
   search_error_ = false;
   cover_loader_tasks_.clear();
+  result_urls_.clear();
+  result_keys_.clear();
+  result_songs_.clear();
+  last_search_query_ = trimmed;
 
   // Add results to the back model, switch models after some delay.
   back_model_->Clear();
@@ -409,7 +434,15 @@ void InternetSearchView::TextEdited(const QString &text) {
   }
   else {
     ui_->progressbar->reset();
-    last_search_id_ = SearchAsync(trimmed, search_type_);
+    const int id = searches_next_id_++;
+    last_search_id_ = id;
+    if (AddCachedResults(id, trimmed)) {
+      ui_->progressbar->hide();
+      ui_->label_status->clear();
+    }
+    else {
+      StartDelayedSearch(id, trimmed, search_type_);
+    }
   }
 
 }
@@ -463,53 +496,184 @@ bool InternetSearchView::Matches(const QStringList &tokens, const QString &strin
 
 }
 
-int InternetSearchView::SearchAsync(const QString &query, const SearchType type) {
-
-  const int id = searches_next_id_++;
+void InternetSearchView::StartDelayedSearch(const int id, const QString &query, const SearchType type) {
 
   int timer_id = startTimer(kDelayedSearchTimeoutMs);
   delayed_searches_[timer_id].id_ = id;
   delayed_searches_[timer_id].query_ = query;
   delayed_searches_[timer_id].type_ = type;
 
-  return id;
-
 }
 
 void InternetSearchView::SearchAsync(const int id, const QString &query, const SearchType type) {
 
-  const int service_id = service_->Search(query, type);
-  pending_searches_[service_id] = PendingState(id, TokenizeQuery(query));
+  SearchAsync(&*service_, id, query, type);
+
+  if (!search_all_services_) return;
+
+  const QList<InternetServicePtr> services = app_->internet_services()->services();
+  for (InternetServicePtr service : services) {
+    if (service == service_ || !service->authenticated()) continue;
+    // The signals of the other services are only connected once they are searched.
+    QObject::connect(&*service, &InternetService::SearchUpdateStatus, this, &InternetSearchView::UpdateStatus, Qt::UniqueConnection);
+    QObject::connect(&*service, &InternetService::SearchProgressSetMaximum, this, &InternetSearchView::ProgressSetMaximum, Qt::UniqueConnection);
+    QObject::connect(&*service, &InternetService::SearchUpdateProgress, this, &InternetSearchView::UpdateProgress, Qt::UniqueConnection);
+    QObject::connect(&*service, &InternetService::SearchResults, this, &InternetSearchView::SearchDone, Qt::UniqueConnection);
+    QObject::connect(&*service, &InternetService::SearchPartialResults, this, &InternetSearchView::SearchPartialResults, Qt::UniqueConnection);
+    SearchAsync(&*service, id, query, type);
+  }
 
 }
 
-void InternetSearchView::SearchDone(const int service_id, const SongMap &songs, const QString &error) {
+void InternetSearchView::SearchAsync(InternetService *service, const int id, const QString &query, const SearchType type) {
 
-  if (!pending_searches_.contains(service_id)) return;
+  const int service_id = service->Search(query, type);
+  if (service_id == 0) return;
+  pending_searches_[qMakePair(service, service_id)] = PendingState(id, TokenizeQuery(query));
 
-  // Map back to the original id.
-  const PendingState state = pending_searches_.take(service_id);
-  const int search_id = state.orig_id_;
+}
 
-  if (songs.isEmpty()) {
-    SearchError(search_id, error);
-    return;
+bool InternetSearchView::SenderPendingSearch(const int service_id, PendingState *state) {
+
+  InternetService *service = qobject_cast<InternetService*>(sender());
+  if (!service || !pending_searches_.contains(qMakePair(service, service_id))) return false;
+  *state = pending_searches_.value(qMakePair(service, service_id));
+  return true;
+
+}
+
+bool InternetSearchView::SearchPending(const int id) const {
+
+  for (const PendingState &state : pending_searches_) {
+    if (state.orig_id_ == id) return true;
   }
+  return false;
 
-  ResultList results;
-  results.reserve(songs.count());
+}
+
+SongList InternetSearchView::NewResults(const SongList &songs) {
+
+  SongList new_songs;
   for (const Song &song : songs) {
+    if (result_urls_.contains(song.url())) continue;
+    const QString key = song.artist().toLower() + QLatin1Char('\t') + song.title().toLower();
+    if (result_keys_.contains(key) && result_keys_.value(key) != song.source()) continue;
+    result_urls_.insert(song.url());
+    result_keys_.insert(key, song.source());
+    new_songs << song;
+  }
+  result_songs_ << new_songs;
+
+  return new_songs;
+
+}
+
+void InternetSearchView::AddResults(const int id, const SongList &songs) {
+
+  if (id != last_search_id_) return;
+
+  const SongList new_songs = NewResults(songs);
+
+  ResultList results;
+  results.reserve(new_songs.count());
+  for (const Song &song : new_songs) {
     Result result;
     result.metadata_ = song;
+    // Load cached pixmaps into the results
+    result.pixmap_cache_key_ = PixmapCacheKey(result);
     results << result;
   }
 
-  // Load cached pixmaps into the results
-  for (InternetSearchView::ResultList::iterator it = results.begin(); it != results.end(); ++it) {
-    it->pixmap_cache_key_ = PixmapCacheKey(*it);
+  AddResults(id, results);
+
+}
+
+QString InternetSearchView::SearchCacheKey(const QString &query) const {
+
+  return QStringLiteral("%1/%2/%3").arg(static_cast<int>(search_type_)).arg(search_all_services_ ? 1 : 0).arg(query.toLower());
+
+}
+
+bool InternetSearchView::AddCachedResults(const int id, const QString &query) {
+
+  const QDateTime now = QDateTime::currentDateTime();
+
+  // Find the longest recent query that the new query starts with.
+  QString cached_query;
+  const CachedSearch *cached_search = nullptr;
+  for (qsizetype length = query.length(); length > 0; --length) {
+    const QString prefix = query.left(length).trimmed();
+    if (prefix.isEmpty()) break;
+    CachedSearch *search = search_cache_.object(SearchCacheKey(prefix));
+    if (search && search->time_.secsTo(now) < kSearchCacheMaxAgeSec) {
+      cached_query = prefix;
+      cached_search = search;
+      break;
+    }
+  }
+  if (!cached_search) return false;
+
+  const bool same_query = cached_query.compare(query, Qt::CaseInsensitive) == 0;
+
+  SongList songs;
+  if (same_query) {
+    songs = cached_search->songs_;
+  }
+  else {
+    const QStringList tokens = TokenizeQuery(query);
+    for (const Song &song : cached_search->songs_) {
+      if (Matches(tokens, song.artist() + QLatin1Char(' ') + song.album() + QLatin1Char(' ') + song.title())) {
+        songs << song;
+      }
+    }
+  }
+
+  AddResults(id, songs);
+
+  // Show the results right away, the remote search adds to them.
+  if (!songs.isEmpty()) {
+    swap_models_timer_->stop();
+    SwapModels();
   }
 
-  AddResults(search_id, results);
+  return same_query;
+
+}
+
+void InternetSearchView::SearchPartialResults(const int service_id, const SongMap &songs) {
+
+  PendingState state;
+  if (!SenderPendingSearch(service_id, &state)) return;
+
+  AddResults(state.orig_id_, songs.values());
+
+}
+
+void InternetSearchView::SearchDone(const int service_id, const SongMap &songs, const QString &error) {
+
+  PendingState state;
+  if (!SenderPendingSearch(service_id, &state)) return;
+
+  // Map back to the original id.
+  pending_searches_.remove(qMakePair(qobject_cast<InternetService*>(sender()), service_id));
+  const int search_id = state.orig_id_;
+  if (search_id != last_search_id_) return;
+
+  AddResults(search_id, songs.values());
+
+  if (SearchPending(search_id)) return;
+
+  // With more than one service, the error is only shown if none of them found anything.
+  if (result_songs_.isEmpty()) {
+    SearchError(search_id, error);
+    return;
+  }
+
+  search_cache_.insert(SearchCacheKey(last_search_query_), new CachedSearch{ result_songs_, QDateTime::currentDateTime() });
+
+  ui_->label_status->clear();
+  ui_->progressbar->reset();
+  ui_->progressbar->hide();
 
 }
 
@@ -523,7 +687,21 @@ void InternetSearchView::CancelSearch(const int id) {
       return;
     }
   }
-  service_->CancelSearch();
+
+  QSet<InternetService*> services;
+  services << &*service_;
+  for (QMap<QPair<InternetService*, int>, PendingState>::iterator it_pending = pending_searches_.begin(); it_pending != pending_searches_.end();) {
+    if (it_pending.value().orig_id_ == id) {
+      services << it_pending.key().first;
+      it_pending = pending_searches_.erase(it_pending);
+    }
+    else {
+      ++it_pending;
+    }
+  }
+  for (InternetService *service : std::as_const(services)) {
+    service->CancelSearch();
+  }
 
 }
 
@@ -531,9 +709,6 @@ void InternetSearchView::AddResults(const int id, const InternetSearchView::Resu
 
   if (id != last_search_id_ || results.isEmpty()) return;
 
-  ui_->label_status->clear();
-  ui_->progressbar->reset();
-  ui_->progressbar->hide();
   current_model_->AddResults(results);
 
 }
@@ -553,10 +728,8 @@ void InternetSearchView::SearchError(const int id, const QString &error) {
 
 void InternetSearchView::UpdateStatus(const int service_id, const QString &text) {
 
-  if (!pending_searches_.contains(service_id)) return;
-  const PendingState state = pending_searches_[service_id];
-  const int search_id = state.orig_id_;
-  if (search_id != last_search_id_) return;
+  PendingState state;
+  if (!SenderPendingSearch(service_id, &state) || state.orig_id_ != last_search_id_) return;
   ui_->progressbar->show();
   ui_->label_status->setText(text);
 
@@ -564,20 +737,16 @@ void InternetSearchView::UpdateStatus(const int service_id, const QString &text)
 
 void InternetSearchView::ProgressSetMaximum(const int service_id, const int max) {
 
-  if (!pending_searches_.contains(service_id)) return;
-  const PendingState state = pending_searches_[service_id];
-  const int search_id = state.orig_id_;
-  if (search_id != last_search_id_) return;
+  PendingState state;
+  if (!SenderPendingSearch(service_id, &state) || state.orig_id_ != last_search_id_) return;
   ui_->progressbar->setMaximum(max);
 
 }
 
 void InternetSearchView::UpdateProgress(const int service_id, const int progress) {
 
-  if (!pending_searches_.contains(service_id)) return;
-  const PendingState state = pending_searches_[service_id];
-  const int search_id = state.orig_id_;
-  if (search_id != last_search_id_) return;
+  PendingState state;
+  if (!SenderPendingSearch(service_id, &state) || state.orig_id_ != last_search_id_) return;
   ui_->progressbar->setValue(progress);
 
 }
@@ -742,6 +911,19 @@ void InternetSearchView::SearchSongsClicked(const bool) {
   SetSearchType(InternetSearchView::SearchType::Songs);
 }
 
+void InternetSearchView::SearchAllServicesToggled(const bool enabled) {
+
+  search_all_services_ = enabled;
+
+  Settings s;
+  s.beginGroup(service_->settings_group());
+  s.setValue("search_all_services", search_all_services_);
+  s.endGroup();
+
+  TextEdited(ui_->search->text());
+
+}
+
 void InternetSearchView::SetSearchType(const InternetSearchView::SearchType type) {
 
   search_type_ = type;
@@ -760,7 +942,7 @@ void InternetSearchView::AddArtists() {
   MimeData *mimedata = SelectedMimeData();
   if (!mimedata) return;
   if (const InternetSongMimeData *internet_song_data = qobject_cast<const InternetSongMimeData*>(mimedata)) {
-    emit AddArtistsSignal(internet_song_data->songs);
+    emit AddArtistsSignal(ServiceSongs(internet_song_data->songs));
   }
 
 }
@@ -770,7 +952,7 @@ void InternetSearchView::AddAlbums() {
   MimeData *mimedata = SelectedMimeData();
   if (!mimedata) return;
   if (const InternetSongMimeData *internet_song_data = qobject_cast<const InternetSongMimeData*>(mimedata)) {
-    emit AddAlbumsSignal(internet_song_data->songs);
+    emit AddAlbumsSignal(ServiceSongs(internet_song_data->songs));
   }
 
 }
@@ -780,21 +962,32 @@ void InternetSearchView::AddSongs() {
   MimeData *mimedata = SelectedMimeData();
   if (!mimedata) return;
   if (const InternetSongMimeData *internet_song_data = qobject_cast<const InternetSongMimeData*>(mimedata)) {
-    emit AddSongsSignal(internet_song_data->songs);
+    emit AddSongsSignal(ServiceSongs(internet_song_data->songs));
   }
 
 }
 
+SongList InternetSearchView::ServiceSongs(const SongList &songs) const {
+
+  SongList service_songs;
+  for (const Song &song : songs) {
+    if (song.source() == service_->source()) service_songs << song;
+  }
+
+  return service_songs;
+
+}
+
 QString InternetSearchView::PixmapCacheKey(const InternetSearchView::Result &result) const {
 
   if (result.metadata_.art_automatic_is_valid()) {
-    return Song::TextForSource(service_->source()) + QLatin1Char('/') + result.metadata_.art_automatic().toString();
+    return Song::TextForSource(result.metadata_.source()) + QLatin1Char('/') + result.metadata_.art_automatic().toString();
   }
   else if (!result.metadata_.effective_albumartist().isEmpty() && !result.metadata_.album().isEmpty()) {
-    return Song::TextForSource(service_->source()) + QLatin1Char('/') + result.metadata_.effective_albumartist() + QLatin1Char('/') + result.metadata_.album();
+    return Song::TextForSource(result.metadata_.source()) + QLatin1Char('/') + result.metadata_.effective_albumartist() + QLatin1Char('/') + result.metadata_.album();
   }
   else {
-    return Song::TextForSource(service_->source()) + QLatin1Char('/') + result.metadata_.url().toString();
+    return Song::TextForSource(result.metadata_.source()) + QLatin1Char('/') + result.metadata_.url().toString();
   }
 
 }
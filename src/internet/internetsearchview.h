@@ -28,6 +28,9 @@
 #include <QObject>
 #include <QWidget>
 #include <QSet>
+#include <QHash>
+#include <QCache>
+#include <QDateTime>
 #include <QPair>
 #include <QList>
 #include <QMap>
@@ -119,6 +122,10 @@ class InternetSearchView : public QWidget {
     QString query_;
     SearchType type_;
   };
+  struct CachedSearch {
+    SongList songs_;
+    QDateTime time_;
+  };
 
   bool SearchKeyEvent(QKeyEvent *e);
   bool ResultsContextMenuEvent(QContextMenuEvent *e);
@@ -127,10 +134,24 @@ class InternetSearchView : public QWidget {
 
   void SetSearchType(const SearchType type);
 
-  int SearchAsync(const QString &query, SearchType type);
+  void StartDelayedSearch(const int id, const QString &query, const SearchType type);
   void SearchAsync(const int id, const QString &query, const SearchType type);
+  void SearchAsync(InternetService *service, const int id, const QString &query, const SearchType type);
   void SearchError(const int id, const QString &error);
   void CancelSearch(const int id);
+  // Returns the pending search of the service that sent the signal.
+  bool SenderPendingSearch(const int service_id, PendingState *state);
+  bool SearchPending(const int id) const;
+  // Removes the songs that were already added, and songs another service already found with the same artist and title.
+  SongList NewResults(const SongList &songs);
+  // Only the songs from our own service can be added to its favorites.
+  SongList ServiceSongs(const SongList &songs) const;
+
+  QString SearchCacheKey(const QString &query) const;
+  // Adds the results of a recent search for the query, or for a shorter query it starts with, filtered with Matches.
+  // Returns true if the results are for the same query, the remote search is not needed then.
+  bool AddCachedResults(const int id, const QString &query);
+  void AddResults(const int id, const SongList &songs);
 
   QString PixmapCacheKey(const Result &result) const;
   bool FindCachedPixmap(const Result &result, QPixmap *pixmap) const;
@@ -147,6 +168,7 @@ class InternetSearchView : public QWidget {
   void TextEdited(const QString &text);
   void StartSearch(const QString &query);
   void SearchDone(const int service_id, const SongMap &songs, const QString &error);
+  void SearchPartialResults(const int service_id, const SongMap &songs);
 
   void UpdateStatus(const int service_id, const QString &text);
   void ProgressSetMaximum(const int service_id, const int max);
@@ -168,6 +190,7 @@ class InternetSearchView : public QWidget {
   void SearchArtistsClicked(const bool);
   void SearchAlbumsClicked(const bool);
   void SearchSongsClicked(const bool);
+  void SearchAllServicesToggled(const bool enabled);
   void GroupByClicked(QAction *action);
   void SetGroupBy(const CollectionModel::Grouping g);
 
@@ -179,6 +202,8 @@ class InternetSearchView : public QWidget {
  private:
   static const int kSwapModelsTimeoutMsec;
   static const int kDelayedSearchTimeoutMs;
+  static const int kSearchCacheSize;
+  static const int kSearchCacheMaxAgeSec;
   static const int kArtHeight;
 
  private:
@@ -190,6 +215,7 @@ class InternetSearchView : public QWidget {
   QMenu *context_menu_;
   QList<QAction*> context_actions_;
   QActionGroup *group_by_actions_;
+  QAction *action_search_all_services_;
 
   // Like graphics APIs have a front buffer and a back buffer, there's a front model and a back model
   // The front model is the one that's shown in the UI and the back model is the one that lies in wait.
@@ -207,11 +233,21 @@ class InternetSearchView : public QWidget {
   bool use_pretty_covers_;
   SearchType search_type_;
   bool search_error_;
+  bool search_all_services_;
   int last_search_id_;
   int searches_next_id_;
 
   QMap<int, DelayedSearch> delayed_searches_;
-  QMap<int, PendingState> pending_searches_;
+  QMap<QPair<InternetService*, int>, PendingState> pending_searches_;
+
+  // The results of the last search, to merge the pages and the results of the other services.
+  QSet<QUrl> result_urls_;
+  QHash<QString, Song::Source> result_keys_;
+  SongList result_songs_;
+  QString last_search_query_;
+
+  // Recent results by query, to answer the same query again and refinements of it right away.
+  QCache<QString, CachedSearch> search_cache_;
 
   QMap<quint64, QPair<QModelIndex, QString>> cover_loader_tasks_;
 };
@@ -117,6 +117,8 @@ class InternetService : public QObject {
   void SongsUpdateProgress(const int max);
 
   void SearchResults(const int id, const SongMap &songs, const QString &error);
+  // Songs received so far, they are also included in SearchResults.
+  void SearchPartialResults(const int id, const SongMap &songs);
   void SearchUpdateStatus(const int id, const QString &text);
   void SearchProgressSetMaximum(const int id, const int max);
   void SearchUpdateProgress(const int id, const int max);
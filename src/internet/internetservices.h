@@ -44,6 +44,7 @@ class InternetServices : public QObject {
   ~InternetServices() override;
 
   SharedPtr<InternetService> ServiceBySource(const Song::Source source) const;
+  QList<SharedPtr<InternetService>> services() const { return services_.values(); }
 
   template <typename T>
   SharedPtr<T> Service() {
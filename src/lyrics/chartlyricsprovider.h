@@ -42,7 +42,6 @@ class ChartLyricsProvider : public LyricsProvider {
   ~ChartLyricsProvider() override;
 
   bool StartSearch(const int id, const LyricsSearchRequest &request) override;
-  void CancelSearch(int id) override;
 
  private:
   void Error(const QString &error, const QVariant &debug = QVariant()) override;
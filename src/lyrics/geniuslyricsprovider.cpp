@@ -309,14 +309,13 @@ bool GeniusLyricsProvider::StartSearch(const int id, const LyricsSearchRequest &
   req.setRawHeader("Authorization", "Bearer " + access_token_.toUtf8());
   QNetworkReply *reply = network_->get(req);
   replies_ << reply;
+  AddSearchReply(id, reply);
   QObject::connect(reply, &QNetworkReply::finished, this, [this, reply, id]() { HandleSearchReply(reply, id); });
 
   return true;
 
 }
 
-void GeniusLyricsProvider::CancelSearch(const int id) { Q_UNUSED(id); }
-
 void GeniusLyricsProvider::HandleSearchReply(QNetworkReply *reply, const int id) {
 
   if (!replies_.contains(reply)) return;
@@ -428,6 +427,7 @@ void GeniusLyricsProvider::HandleSearchReply(QNetworkReply *reply, const int id)
     req.setAttribute(QNetworkRequest::RedirectPolicyAttribute, QNetworkRequest::NoLessSafeRedirectPolicy);
     QNetworkReply *new_reply = network_->get(req);
     replies_ << new_reply;
+    AddSearchReply(search->id, new_reply);
     QObject::connect(new_reply, &QNetworkReply::finished, this, [this, new_reply, search, url]() { HandleLyricReply(new_reply, search->id, url); });
 
   }
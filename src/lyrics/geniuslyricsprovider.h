@@ -54,7 +54,6 @@ class GeniusLyricsProvider : public JsonLyricsProvider {
   void Deauthenticate() override { access_token_.clear(); }
 
   bool StartSearch(const int id, const LyricsSearchRequest &request) override;
-  void CancelSearch(const int id) override;
 
  private:
   struct GeniusLyricsLyricContext {
@@ -59,6 +59,7 @@ bool HtmlLyricsProvider::StartSearch(const int id, const LyricsSearchRequest &re
   req.setHeader(QNetworkRequest::UserAgentHeader, QStringLiteral("Mozilla/5.0 (X11; Linux x86_64; rv:122.0) Gecko/20100101 Firefox/122.0"));
   QNetworkReply *reply = network_->get(req);
   replies_ << reply;
+  AddSearchReply(id, reply);
   QObject::connect(reply, &QNetworkReply::finished, this, [this, reply, id, request]() { HandleLyricsReply(reply, id, request); });
 
   qLog(Debug) << name_ << "Sending request for" << url;
@@ -67,8 +68,6 @@ bool HtmlLyricsProvider::StartSearch(const int id, const LyricsSearchRequest &re
 
 }
 
-void HtmlLyricsProvider::CancelSearch(const int id) { Q_UNUSED(id); }
-
 void HtmlLyricsProvider::HandleLyricsReply(QNetworkReply *reply, const int id, const LyricsSearchRequest &request) {
 
   if (!replies_.contains(reply)) return;
@@ -44,7 +44,6 @@ class HtmlLyricsProvider : public LyricsProvider {
   ~HtmlLyricsProvider();
 
   virtual bool StartSearch(const int id, const LyricsSearchRequest &request) override;
-  virtual void CancelSearch(const int id) override;
 
   static QString ParseLyricsFromHTML(const QString &content, const QRegularExpression &start_tag, const QRegularExpression &end_tag, const QRegularExpression &lyrics_start, const bool multiple);
 
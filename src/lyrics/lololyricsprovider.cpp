@@ -66,14 +66,13 @@ bool LoloLyricsProvider::StartSearch(const int id, const LyricsSearchRequest &re
   req.setAttribute(QNetworkRequest::RedirectPolicyAttribute, QNetworkRequest::NoLessSafeRedirectPolicy);
   QNetworkReply *reply = network_->get(req);
   replies_ << reply;
+  AddSearchReply(id, reply);
   QObject::connect(reply, &QNetworkReply::finished, this, [this, reply, id, request]() { HandleSearchReply(reply, id, request); });
 
   return true;
 
 }
 
-void LoloLyricsProvider::CancelSearch(const int id) { Q_UNUSED(id); }
-
 void LoloLyricsProvider::HandleSearchReply(QNetworkReply *reply, const int id, const LyricsSearchRequest &request) {
 
   if (!replies_.contains(reply)) return;
@@ -0,0 +1,177 @@
+/*
+ * Strawberry Music Player
+ *
+ * Strawberry is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Strawberry is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Strawberry.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#include "config.h"
+
+#include <utility>
+#include <chrono>
+
+#include <QtGlobal>
+#include <QObject>
+#include <QTimer>
+#include <QMutexLocker>
+#include <QDateTime>
+#include <QHash>
+#include <QString>
+#include <QSqlDatabase>
+
+#include "core/logging.h"
+#include "core/shared_ptr.h"
+#include "core/database.h"
+#include "core/sqlquery.h"
+#include "core/scopedtransaction.h"
+#include "lyricscache.h"
+
+using namespace std::chrono_literals;
+
+const int LyricsCache::kLyricsMaxAgeDays = 90;
+const int LyricsCache::kMissMaxAgeDays = 7;
+
+LyricsCache::LyricsCache(SharedPtr<Database> db, QObject *parent)
+    : QObject(parent),
+      db_(db),
+      timer_flush_(new QTimer(this)),
+      expired_deleted_(false) {
+
+  timer_flush_->setSingleShot(true);
+  timer_flush_->setInterval(10s);
+  QObject::connect(timer_flush_, &QTimer::timeout, this, &LyricsCache::Flush);
+
+}
+
+LyricsCache::~LyricsCache() {
+
+  Flush();
+
+}
+
+QString LyricsCache::Key(const QString &artist, const QString &title) {
+
+  return artist.toLower() + QLatin1Char('\n') + title.toLower();
+
+}
+
+bool LyricsCache::Expired(const Lookup &lookup, const qint64 now) {
+
+  // Misses are asked again sooner, the providers could have added the lyrics.
+  const int max_age_days = lookup.lyrics.isEmpty() ? kMissMaxAgeDays : kLyricsMaxAgeDays;
+  return now - lookup.time > static_cast<qint64>(max_age_days) * 86400;
+
+}
+
+void LyricsCache::DeleteExpired() {
+
+  expired_deleted_ = true;
+
+  QMutexLocker l(db_->Mutex());
+  QSqlDatabase db(db_->Connect());
+
+  const qint64 now = QDateTime::currentSecsSinceEpoch();
+
+  SqlQuery q(db);
+  q.prepare(QStringLiteral("DELETE FROM lyrics_lookups WHERE time < :lyrics_time OR ((lyrics IS NULL OR lyrics = '') AND time < :miss_time)"));
+  q.BindValue(QStringLiteral(":lyrics_time"), now - static_cast<qint64>(kLyricsMaxAgeDays) * 86400);
+  q.BindValue(QStringLiteral(":miss_time"), now - static_cast<qint64>(kMissMaxAgeDays) * 86400);
+  if (!q.Exec()) {
+    db_->ReportErrors(q);
+  }
+
+}
+
+bool LyricsCache::Find(const QString &artist, const QString &title, Lookup *lookup) {
+
+  if (!expired_deleted_) DeleteExpired();
+
+  const qint64 now = QDateTime::currentSecsSinceEpoch();
+
+  // Lyrics are too big to keep them all in memory, so only the unsaved ones are, and the rest is looked up in the database.
+  const QHash<QString, Entry>::const_iterator it = unsaved_entries_.constFind(Key(artist, title));
+  if (it != unsaved_entries_.constEnd()) {
+    *lookup = it->lookup;
+    return true;
+  }
+
+  QMutexLocker l(db_->Mutex());
+  QSqlDatabase db(db_->Connect());
+
+  SqlQuery q(db);
+  q.prepare(QStringLiteral("SELECT provider, lyrics, time FROM lyrics_lookups WHERE artist = :artist AND title = :title"));
+  q.BindValue(QStringLiteral(":artist"), artist.toLower());
+  q.BindValue(QStringLiteral(":title"), title.toLower());
+  if (!q.Exec()) {
+    db_->ReportErrors(q);
+    return false;
+  }
+  if (!q.next()) return false;
+
+  Lookup result;
+  result.provider = q.value(0).toString();
+  result.lyrics = q.value(1).toString();
+  result.time = q.value(2).toLongLong();
+  if (Expired(result, now)) return false;
+
+  *lookup = result;
+  return true;
+
+}
+
+void LyricsCache::Insert(const QString &artist, const QString &title, const QString &provider, const QString &lyrics) {
+
+  Entry entry;
+  entry.artist = artist;
+  entry.title = title;
+  entry.lookup.provider = provider;
+  entry.lookup.lyrics = lyrics;
+  entry.lookup.time = QDateTime::currentSecsSinceEpoch();
+
+  unsaved_entries_.insert(Key(artist, title), entry);
+
+  if (!timer_flush_->isActive()) timer_flush_->start();
+
+}
+
+void LyricsCache::Flush() {
+
+  timer_flush_->stop();
+
+  if (unsaved_entries_.isEmpty()) return;
+
+  QMutexLocker l(db_->Mutex());
+  QSqlDatabase db(db_->Connect());
+
+  ScopedTransaction transaction(&db);
+  SqlQuery q(db);
+  q.prepare(QStringLiteral("INSERT OR REPLACE INTO lyrics_lookups (artist, title, provider, lyrics, time) VALUES (:artist, :title, :provider, :lyrics, :time)"));
+  for (const Entry &entry : std::as_const(unsaved_entries_)) {
+    q.BindValue(QStringLiteral(":artist"), entry.artist.toLower());
+    q.BindValue(QStringLiteral(":title"), entry.title.toLower());
+    q.BindValue(QStringLiteral(":provider"), entry.lookup.provider);
+    q.BindValue(QStringLiteral(":lyrics"), entry.lookup.lyrics);
+    q.BindValue(QStringLiteral(":time"), entry.lookup.time);
+    if (!q.Exec()) {
+      db_->ReportErrors(q);
+      return;
+    }
+  }
+  transaction.Commit();
+
+  qLog(Debug) << "Saved" << unsaved_entries_.count() << "lyrics lookups";
+
+  unsaved_entries_.clear();
+
+}
@@ -0,0 +1,78 @@
+/*
+ * Strawberry Music Player
+ *
+ * Strawberry is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Strawberry is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Strawberry.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#ifndef LYRICSCACHE_H
+#define LYRICSCACHE_H
+
+#include "config.h"
+
+#include <QtGlobal>
+#include <QObject>
+#include <QHash>
+#include <QString>
+
+#include "core/shared_ptr.h"
+
+class QTimer;
+class Database;
+
+// Remembers the lyrics found for an artist and title, and the songs no provider had lyrics for.
+// Songs shown again are answered from the database without asking the providers.
+// The lookups are read from the database when they're needed, and new ones are written in batches.
+class LyricsCache : public QObject {
+  Q_OBJECT
+
+ public:
+  explicit LyricsCache(SharedPtr<Database> db, QObject *parent = nullptr);
+  ~LyricsCache() override;
+
+  static const int kLyricsMaxAgeDays;
+  static const int kMissMaxAgeDays;
+
+  struct Lookup {
+    Lookup() : time(0) {}
+    // Both are empty if no provider had lyrics.
+    QString provider;
+    QString lyrics;
+    qint64 time;
+  };
+
+  bool Find(const QString &artist, const QString &title, Lookup *lookup);
+  void Insert(const QString &artist, const QString &title, const QString &provider, const QString &lyrics);
+
+ public slots:
+  void Flush();
+
+ private:
+  struct Entry {
+    QString artist;
+    QString title;
+    Lookup lookup;
+  };
+
+  static QString Key(const QString &artist, const QString &title);
+  static bool Expired(const Lookup &lookup, const qint64 now);
+  void DeleteExpired();
+
+  SharedPtr<Database> db_;
+  QTimer *timer_flush_;
+  bool expired_deleted_;
+  QHash<QString, Entry> unsaved_entries_;
+};
+
+#endif  // LYRICSCACHE_H
@@ -30,6 +30,8 @@
 #include "core/song.h"
 #include "lyricsfetcher.h"
 #include "lyricsfetchersearch.h"
+#include "lyricsproviders.h"
+#include "lyricscache.h"
 #include "lyricssearchrequest.h"
 #include "lyricssearchresult.h"
 
@@ -59,12 +61,35 @@ quint64 LyricsFetcher::Search(const QString &effective_albumartist, const QStrin
   Request request;
   request.id = ++next_id_;
   request.search_request = search_request;
+
+  LyricsCache *cache = lyrics_providers_->cache();
+  LyricsCache::Lookup lookup;
+  if (cache && cache->Find(search_request.artist, search_request.title, &lookup)) {
+    // Answered when control returns to the event loop, so the caller has the request ID by then.
+    cached_requests_.insert(request.id);
+    QMetaObject::invokeMethod(this, "CachedLyricsFetched", Qt::QueuedConnection, Q_ARG(quint64, request.id), Q_ARG(QString, lookup.provider), Q_ARG(QString, lookup.lyrics));
+    return request.id;
+  }
+
   AddRequest(request);
 
   return request.id;
 
 }
 
+bool LyricsFetcher::CachedLyrics(const QString &artist, const QString &title, QString *provider, QString *lyrics) const {
+
+  LyricsCache *cache = lyrics_providers_->cache();
+  LyricsCache::Lookup lookup;
+  if (!cache || !cache->Find(artist, Song::TitleRemoveMisc(title), &lookup)) return false;
+
+  *provider = lookup.provider;
+  *lyrics = lookup.lyrics;
+
+  return true;
+
+}
+
 void LyricsFetcher::AddRequest(const Request &request) {
 
   queued_requests_.enqueue(request);
@@ -78,6 +103,7 @@ void LyricsFetcher::AddRequest(const Request &request) {
 void LyricsFetcher::Clear() {
 
   queued_requests_.clear();
+  cached_requests_.clear();
 
   const QList<LyricsFetcherSearch*> searches = active_requests_.values();
   for (LyricsFetcherSearch *search : searches) {
@@ -126,6 +152,28 @@ void LyricsFetcher::SingleLyricsFetched(const quint64 request_id, const QString
 
   LyricsFetcherSearch *search = active_requests_.take(request_id);
   search->deleteLater();
+
+  LyricsCache *cache = lyrics_providers_->cache();
+  if (cache && (!lyrics.isEmpty() || !search->incomplete())) {
+    cache->Insert(search->request().artist, search->request().title, provider, lyrics);
+  }
+
+  emit LyricsFetched(request_id, provider, lyrics);
+
+}
+
+void LyricsFetcher::CachedLyricsFetched(const quint64 request_id, const QString &provider, const QString &lyrics) {
+
+  if (!cached_requests_.remove(request_id)) return;
+
+  LyricsSearchResults results;
+  if (!lyrics.isEmpty()) {
+    LyricsSearchResult result(lyrics);
+    result.provider = provider;
+    results << result;
+  }
+
   emit LyricsFetched(request_id, provider, lyrics);
+  emit SearchFinished(request_id, results);
 
 }
@@ -56,6 +56,9 @@ class LyricsFetcher : public QObject {
   quint64 Search(const QString &effective_albumartist, const QString &artist, const QString &album, const QString &title);
   void Clear();
 
+  // Returns true if a search would be answered from the cache, the lyrics are empty if no provider had lyrics.
+  bool CachedLyrics(const QString &artist, const QString &title, QString *provider, QString *lyrics) const;
+
  private:
   void AddRequest(const Request &request);
 
@@ -66,6 +69,7 @@ class LyricsFetcher : public QObject {
  private slots:
   void SingleSearchFinished(const quint64 request_id, const LyricsSearchResults &results);
   void SingleLyricsFetched(const quint64 request_id, const QString &provider, const QString &lyrics);
+  void CachedLyricsFetched(const quint64 request_id, const QString &provider, const QString &lyrics);
   void StartRequests();
 
  private:
@@ -76,6 +80,7 @@ class LyricsFetcher : public QObject {
 
   QQueue<Request> queued_requests_;
   QHash<quint64, LyricsFetcherSearch*> active_requests_;
+  QSet<quint64> cached_requests_;
 
   QTimer *request_starter_;
 };
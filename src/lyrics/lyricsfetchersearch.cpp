@@ -37,12 +37,16 @@
 const int LyricsFetcherSearch::kSearchTimeoutMs = 3000;
 const int LyricsFetcherSearch::kGoodLyricsLength = 60;
 const float LyricsFetcherSearch::kHighScore = 2.5;
+// Matching artist and title, and long enough, most providers don't return the album.
+const float LyricsFetcherSearch::kGoodScore = 2.0;
 
 LyricsFetcherSearch::LyricsFetcherSearch(const quint64 id, const LyricsSearchRequest &request, QObject *parent)
     : QObject(parent),
       id_(id),
       request_(request),
-      cancel_requested_(false) {
+      first_good_result_(false),
+      cancel_requested_(false),
+      incomplete_(false) {
 
   QTimer::singleShot(kSearchTimeoutMs, this, &LyricsFetcherSearch::TerminateSearch);
 
@@ -50,6 +54,8 @@ LyricsFetcherSearch::LyricsFetcherSearch(const quint64 id, const LyricsSearchReq
 
 void LyricsFetcherSearch::TerminateSearch() {
 
+  if (!pending_requests_.isEmpty()) incomplete_ = true;
+
   const QList<int> keys = pending_requests_.keys();
   for (const int id : keys) {
     pending_requests_.take(id)->CancelSearch(id);
@@ -66,11 +72,14 @@ void LyricsFetcherSearch::Start(SharedPtr<LyricsProviders> lyrics_providers) {
     return;
   }
 
+  first_good_result_ = lyrics_providers->first_good_result();
+
   QList<LyricsProvider*> lyrics_providers_sorted = lyrics_providers->List();
   std::stable_sort(lyrics_providers_sorted.begin(), lyrics_providers_sorted.end(), ProviderCompareOrder);
 
   for (LyricsProvider *provider : std::as_const(lyrics_providers_sorted)) {
     if (!provider->is_enabled() || !provider->IsAuthenticated()) continue;
+    provider_order_.insert(provider->name(), provider->order());
     QObject::connect(provider, &LyricsProvider::SearchFinished, this, &LyricsFetcherSearch::ProviderSearchFinished);
     const int id = lyrics_providers->NextId();
     const bool success = provider->StartSearch(id, request_);
@@ -110,10 +119,11 @@ void LyricsFetcherSearch::ProviderSearchFinished(const int id, const LyricsSearc
   }
 
   results_.append(results_copy);
-  std::stable_sort(results_.begin(), results_.end(), LyricsSearchResultCompareScore);
+  std::stable_sort(results_.begin(), results_.end(), [this](const LyricsSearchResult &a, const LyricsSearchResult &b) { return LyricsSearchResultCompareScore(a, b); });
 
   if (!pending_requests_.isEmpty()) {
-    if (!results_.isEmpty() && higest_score >= kHighScore) {  // Highest score, no need to wait for other providers.
+    // Good enough, no need to wait for other providers, their requests are cancelled.
+    if (!results_.isEmpty() && higest_score >= (first_good_result_ ? kGoodScore : kHighScore)) {
       qLog(Debug) << "Got lyrics with high score from" << results_.last().provider << "for" << request_.artist << request_.title << "score" << results_.last().score << "finishing search.";
       TerminateSearch();
     }
@@ -157,6 +167,10 @@ bool LyricsFetcherSearch::ProviderCompareOrder(LyricsProvider *a, LyricsProvider
   return a->order() < b->order();
 }
 
-bool LyricsFetcherSearch::LyricsSearchResultCompareScore(const LyricsSearchResult &a, const LyricsSearchResult &b) {
-  return a.score < b.score;
+bool LyricsFetcherSearch::LyricsSearchResultCompareScore(const LyricsSearchResult &a, const LyricsSearchResult &b) const {
+
+  // The best result is last, with equal scores the provider with the highest priority wins.
+  if (a.score != b.score) return a.score < b.score;
+  return provider_order_.value(a.provider) > provider_order_.value(b.provider);
+
 }
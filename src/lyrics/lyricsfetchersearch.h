@@ -43,6 +43,11 @@ class LyricsFetcherSearch : public QObject {
   void Start(SharedPtr<LyricsProviders> lyrics_providers);
   void Cancel();
 
+  const LyricsSearchRequest &request() const { return request_; }
+
+  // True if the search was ended before all providers answered, a miss then isn't worth remembering.
+  bool incomplete() const { return incomplete_; }
+
  signals:
   void SearchFinished(const quint64 id, const LyricsSearchResults &results);
   void LyricsFetched(const quint64 id, const QString &provider, const QString &lyrics);
@@ -54,18 +59,22 @@ class LyricsFetcherSearch : public QObject {
  private:
   void AllProvidersFinished();
   static bool ProviderCompareOrder(LyricsProvider *a, LyricsProvider *b);
-  static bool LyricsSearchResultCompareScore(const LyricsSearchResult &a, const LyricsSearchResult &b);
+  bool LyricsSearchResultCompareScore(const LyricsSearchResult &a, const LyricsSearchResult &b) const;
 
  private:
   static const int kSearchTimeoutMs;
   static const int kGoodLyricsLength;
   static const float kHighScore;
+  static const float kGoodScore;
 
   quint64 id_;
   LyricsSearchRequest request_;
   LyricsSearchResults results_;
   QMap<int, LyricsProvider*> pending_requests_;
+  QMap<QString, int> provider_order_;
+  bool first_good_result_;
   bool cancel_requested_;
+  bool incomplete_;
 };
 
 #endif  // LYRICSFETCHERSEARCH_H
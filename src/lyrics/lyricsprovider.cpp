@@ -20,7 +20,10 @@
 #include "config.h"
 
 #include <QObject>
+#include <QList>
+#include <QMultiHash>
 #include <QString>
+#include <QNetworkReply>
 
 #include "core/shared_ptr.h"
 #include "core/networkaccessmanager.h"
@@ -28,3 +31,21 @@
 
 LyricsProvider::LyricsProvider(const QString &name, const bool enabled, const bool authentication_required, SharedPtr<NetworkAccessManager> network, QObject *parent)
     : QObject(parent), network_(network), name_(name), enabled_(enabled), order_(0), authentication_required_(authentication_required) {}
+
+void LyricsProvider::AddSearchReply(const int id, QNetworkReply *reply) {
+
+  search_replies_.insert(id, reply);
+  QObject::connect(reply, &QNetworkReply::finished, this, [this, id, reply]() { search_replies_.remove(id, reply); });
+
+}
+
+void LyricsProvider::CancelSearch(const int id) {
+
+  // Aborting finishes the replies right away, the providers handle that like any other failed request.
+  const QList<QNetworkReply*> replies = search_replies_.values(id);
+  search_replies_.remove(id);
+  for (QNetworkReply *reply : replies) {
+    reply->abort();
+  }
+
+}
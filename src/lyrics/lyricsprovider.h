@@ -25,6 +25,7 @@
 #include <QtGlobal>
 #include <QObject>
 #include <QList>
+#include <QMultiHash>
 #include <QVariant>
 #include <QString>
 #include <QRegularExpression>
@@ -34,6 +35,8 @@
 #include "lyricssearchrequest.h"
 #include "lyricssearchresult.h"
 
+class QNetworkReply;
+
 class LyricsProvider : public QObject {
   Q_OBJECT
 
@@ -48,7 +51,8 @@ class LyricsProvider : public QObject {
   void set_order(const int order) { order_ = order; }
 
   virtual bool StartSearch(const int id, const LyricsSearchRequest &request) = 0;
-  virtual void CancelSearch(const int id) { Q_UNUSED(id); }
+  // Aborts the requests of the search, the provider then finishes it without results.
+  virtual void CancelSearch(const int id);
   virtual bool AuthenticationRequired() const { return authentication_required_; }
   virtual void Authenticate() {}
   virtual bool IsAuthenticated() const { return !authentication_required_; }
@@ -62,12 +66,19 @@ class LyricsProvider : public QObject {
   void AuthenticationFailure(const QStringList &errors);
   void SearchFinished(const int id, const LyricsSearchResults &results = LyricsSearchResults());
 
+ protected:
+  // Makes CancelSearch() abort the reply.
+  void AddSearchReply(const int id, QNetworkReply *reply);
+
  protected:
   SharedPtr<NetworkAccessManager> network_;
   const QString name_;
   bool enabled_;
   int order_;
   const bool authentication_required_;
+
+ private:
+  QMultiHash<int, QNetworkReply*> search_replies_;
 };
 
 #endif  // LYRICSPROVIDER_H
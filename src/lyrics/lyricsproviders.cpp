@@ -34,15 +34,18 @@
 
 #include "lyricsprovider.h"
 #include "lyricsproviders.h"
+#include "lyricscache.h"
 
 #include "settings/lyricssettingspage.h"
 
 int LyricsProviders::NextOrderId = 0;
 
-LyricsProviders::LyricsProviders(QObject *parent) : QObject(parent) {}
+LyricsProviders::LyricsProviders(QObject *parent) : QObject(parent), first_good_result_(true) {}
 
 LyricsProviders::~LyricsProviders() {
 
+  cache_.reset();
+
   while (!lyrics_providers_.isEmpty()) {
     delete lyrics_providers_.firstKey();
   }
@@ -61,6 +64,7 @@ void LyricsProviders::ReloadSettings() {
   Settings s;
   s.beginGroup(LyricsSettingsPage::kSettingsGroup);
   const QStringList providers_enabled = s.value("providers", QStringList() << all_providers.values()).toStringList();
+  first_good_result_ = s.value("first_good_result", true).toBool();
   s.endGroup();
 
   int i = 0;
@@ -138,3 +142,9 @@ void LyricsProviders::ProviderDestroyed() {
 }
 
 int LyricsProviders::NextId() { return next_id_.fetchAndAddRelaxed(1); }
+
+void LyricsProviders::InitCache(SharedPtr<Database> db) {
+
+  cache_.reset(new LyricsCache(db));
+
+}
@@ -30,7 +30,12 @@
 #include <QString>
 #include <QAtomicInt>
 
+#include "core/shared_ptr.h"
+#include "core/scoped_ptr.h"
+
+class Database;
 class LyricsProvider;
+class LyricsCache;
 
 class LyricsProviders : public QObject {
   Q_OBJECT
@@ -48,6 +53,13 @@ class LyricsProviders : public QObject {
   bool HasAnyProviders() const { return !lyrics_providers_.isEmpty(); }
   int NextId();
 
+  // Searches use the first good lyrics instead of waiting for all providers.
+  bool first_good_result() const { return first_good_result_; }
+
+  // The lyrics found by the providers are cached in the database.
+  void InitCache(SharedPtr<Database> db);
+  LyricsCache *cache() const { return cache_.get(); }
+
  private slots:
   void ProviderDestroyed();
 
@@ -61,6 +73,10 @@ class LyricsProviders : public QObject {
   QMutex mutex_;
 
   QAtomicInt next_id_;
+
+  bool first_good_result_;
+
+  ScopedPtr<LyricsCache> cache_;
 };
 
 #endif  // LYRICSPROVIDERS_H
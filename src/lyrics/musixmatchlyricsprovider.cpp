@@ -74,8 +74,6 @@ bool MusixmatchLyricsProvider::StartSearch(const int id, const LyricsSearchReque
 
 }
 
-void MusixmatchLyricsProvider::CancelSearch(const int id) { Q_UNUSED(id); }
-
 bool MusixmatchLyricsProvider::SendSearchRequest(LyricsSearchContextPtr search) {
 
   QUrlQuery url_query;
@@ -90,6 +88,7 @@ bool MusixmatchLyricsProvider::SendSearchRequest(LyricsSearchContextPtr search)
   req.setAttribute(QNetworkRequest::RedirectPolicyAttribute, QNetworkRequest::NoLessSafeRedirectPolicy);
   QNetworkReply *reply = network_->get(req);
   replies_ << reply;
+  AddSearchReply(search->id, reply);
   QObject::connect(reply, &QNetworkReply::finished, this, [this, reply, search]() { HandleSearchReply(reply, search); });
 
   qLog(Debug) << "MusixmatchLyrics: Sending request for" << url;
@@ -264,6 +263,7 @@ bool MusixmatchLyricsProvider::SendLyricsRequest(LyricsSearchContextPtr search,
   req.setAttribute(QNetworkRequest::RedirectPolicyAttribute, QNetworkRequest::NoLessSafeRedirectPolicy);
   QNetworkReply *reply = network_->get(req);
   replies_ << reply;
+  AddSearchReply(search->id, reply);
   QObject::connect(reply, &QNetworkReply::finished, this, [this, reply, search, url]() { HandleLyricsReply(reply, search, url); });
 
   qLog(Debug) << "MusixmatchLyrics: Sending request for" << url;
@@ -46,7 +46,6 @@ class MusixmatchLyricsProvider : public JsonLyricsProvider, public MusixmatchPro
   ~MusixmatchLyricsProvider() override;
 
   bool StartSearch(const int id, const LyricsSearchRequest &request) override;
-  void CancelSearch(const int id) override;
 
  private:
   struct LyricsSearchContext {
@@ -60,14 +60,13 @@ bool OVHLyricsProvider::StartSearch(const int id, const LyricsSearchRequest &req
   req.setAttribute(QNetworkRequest::RedirectPolicyAttribute, QNetworkRequest::NoLessSafeRedirectPolicy);
   QNetworkReply *reply = network_->get(req);
   replies_ << reply;
+  AddSearchReply(id, reply);
   QObject::connect(reply, &QNetworkReply::finished, this, [this, reply, id, request]() { HandleSearchReply(reply, id, request); });
 
   return true;
 
 }
 
-void OVHLyricsProvider::CancelSearch(const int id) { Q_UNUSED(id); }
-
 void OVHLyricsProvider::HandleSearchReply(QNetworkReply *reply, const int id, const LyricsSearchRequest &request) {
 
   if (!replies_.contains(reply)) return;
@@ -43,7 +43,6 @@ class OVHLyricsProvider : public JsonLyricsProvider {
   ~OVHLyricsProvider() override;
 
   bool StartSearch(const int id, const LyricsSearchRequest &request) override;
-  void CancelSearch(const int id) override;
 
  private:
   void Error(const QString &error, const QVariant &debug = QVariant()) override;
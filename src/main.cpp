@@ -97,6 +97,7 @@
 #include "core/commandlineoptions.h"
 #include "core/application.h"
 #include "core/networkproxyfactory.h"
+#include "core/trace.h"
 #ifdef Q_OS_MACOS
 #  include "core/macsystemtrayicon.h"
 #else
@@ -207,6 +208,14 @@ int main(int argc, char *argv[]) {
     return 0;
   }
 
+  if (!options.trace_file().isEmpty()) {
+#ifdef USE_TRACING
+    trace::Start(options.trace_file());
+#else
+    qLog(Warning) << "Strawberry was built without tracing, ignoring --trace";
+#endif
+  }
+
   QGuiApplication::setWindowIcon(IconLoader::Load(QStringLiteral("strawberry")));
 
 #if defined(USE_BUNDLE)
@@ -321,8 +330,12 @@ int main(int argc, char *argv[]) {
 #endif
   QObject::connect(&single_app, &KDSingleApplication::messageReceived, &w, QOverload<const QByteArray&>::of(&MainWindow::CommandlineOptionsReceived));
 
+  app.StartDeferredInitialization();
+
   int ret = QCoreApplication::exec();
 
+  trace::Stop();
+
   return ret;
 
 }
@@ -16,6 +16,7 @@
 */
 
 #include <algorithm>
+#include <vector>
 #include <cmath>
 
 #include <QList>
@@ -37,6 +38,31 @@ static const int sBarkBandCount = arraysize(sBarkBands);
 
 MoodbarBuilder::MoodbarBuilder() : bands_(0), rate_hz_(0) {}
 
+void MoodbarBuilder::Channel::Add(const double value) {
+
+  if (values.empty()) {
+    mini = value;
+    maxi = value;
+  }
+  else if (value > maxi) {
+    maxi = value;
+  }
+  else if (value < mini) {
+    mini = value;
+  }
+
+  values.push_back(value);
+
+}
+
+void MoodbarBuilder::Channel::Clear() {
+
+  values.clear();
+  mini = 0;
+  maxi = 0;
+
+}
+
 int MoodbarBuilder::BandFrequency(int band) const {
   return ((rate_hz_ / 2) * band + rate_hz_ / 4) / bands_;
 }
@@ -46,67 +72,63 @@ void MoodbarBuilder::Init(int bands, int rate_hz) {
   bands_ = bands;
   rate_hz_ = rate_hz;
 
-  barkband_table_.clear();
-  barkband_table_.reserve(bands + 1);
+  // The bark band of a magnitude never decreases with its index, so store where each band starts.
+  barkband_starts_.clear();
+  barkband_starts_.reserve(sBarkBandCount + 1);
+  barkband_starts_.append(0);
 
   int barkband = 0;
   for (int i = 0; i < bands + 1; ++i) {
     if (barkband < sBarkBandCount - 1 && BandFrequency(i) >= sBarkBands[barkband]) {
       barkband++;
+      barkband_starts_.append(i);
     }
-
-    barkband_table_.append(barkband);
   }
+  while (barkband_starts_.count() <= sBarkBandCount) {
+    barkband_starts_.append(bands + 1);
+  }
+
+  r_.Clear();
+  g_.Clear();
+  b_.Clear();
 
 }
 
 void MoodbarBuilder::AddFrame(const double *magnitudes, int size) {
 
-  if (size > barkband_table_.length()) {
+  if (size > bands_ + 1) {
     return;
   }
 
-  // Calculate total magnitudes for different bark bands.
-  double bands[sBarkBandCount];
-  for (int i = 0; i < sBarkBandCount; ++i) {
-    bands[i] = 0.0;
-  }
-
-  for (int i = 0; i < size; ++i) {
-    bands[barkband_table_[i]] += magnitudes[i];
-  }
-
-  // Now divide the bark bands into thirds and compute their total amplitudes.
+  // Calculate total magnitudes for different bark bands, then divide the bark bands into thirds and compute their total amplitudes.
   double rgb[] = { 0, 0, 0 };
-  for (int i = 0; i < sBarkBandCount; ++i) {
-    rgb[(i * 3) / sBarkBandCount] += bands[i] * bands[i];
+  for (int band = 0; band < sBarkBandCount; ++band) {
+    const int start = std::min(barkband_starts_[band], size);
+    const int end = std::min(barkband_starts_[band + 1], size);
+    double total = 0.0;
+    for (int i = start; i < end; ++i) {
+      total += magnitudes[i];
+    }
+    rgb[(band * 3) / sBarkBandCount] += total * total;
   }
 
-  frames_.append(Rgb(sqrt(rgb[0]), sqrt(rgb[1]), sqrt(rgb[2])));
+  r_.Add(sqrt(rgb[0]));
+  g_.Add(sqrt(rgb[1]));
+  b_.Add(sqrt(rgb[2]));
 
 }
 
-void MoodbarBuilder::Normalize(QList<Rgb> *vals, double Rgb::*member) {
-
-  const QList<Rgb> rgb_vals = *vals;
+void MoodbarBuilder::Normalize(Channel *channel) {
 
-  double mini = vals->at(0).*member;
-  double maxi = vals->at(0).*member;
-  for (int i = 1; i < vals->count(); i++) {
-    const double value = vals->at(i).*member;
-    if (value > maxi) {
-      maxi = value;
-    }
-    else if (value < mini) {
-      mini = value;
-    }
-  }
+  std::vector<double> &values = channel->values;
+  const double count = static_cast<double>(values.size());
+  double mini = channel->mini;
+  double maxi = channel->maxi;
 
   double avg = 0;
-  for (const Rgb &rgb : rgb_vals) {
-    const double value = rgb.*member;
+  for (const double value : values) {
     if (value != mini && value != maxi) {
-      avg += value / static_cast<double>(vals->count());
+      avg += value / count;
     }
   }
 
@@ -114,8 +136,7 @@ void MoodbarBuilder::Normalize(QList<Rgb> *vals, double Rgb::*member) {
   double tb = 0;
   double avgu = 0;
   double avgb = 0;
-  for (const Rgb &rgb : rgb_vals) {
-    const double value = rgb.*member;
+  for (const double value : values) {
     if (value != mini && value != maxi) {
       if (value > avg) {
         avgu += value;
@@ -134,8 +155,7 @@ void MoodbarBuilder::Normalize(QList<Rgb> *vals, double Rgb::*member) {
   tb = 0;
   double avguu = 0;
   double avgbb = 0;
-  for (const Rgb &rgb : rgb_vals) {
-    const double value = rgb.*member;
+  for (const double value : values) {
     if (value != mini && value != maxi) {
       if (value > avgu) {
         avguu += value;
@@ -157,9 +177,8 @@ void MoodbarBuilder::Normalize(QList<Rgb> *vals, double Rgb::*member) {
     delta = 1;
   }
 
-  for (auto it = vals->begin(); it != vals->end(); ++it) {
-    double *value = &((*it).*member);
-    *value = std::isfinite(*value) ? qBound(0.0, (*value - mini) / delta, 1.0) : 0;
+  for (double &value : values) {
+    value = std::isfinite(value) ? qBound(0.0, (value - mini) / delta, 1.0) : 0;
   }
 
 }
@@ -169,29 +188,35 @@ QByteArray MoodbarBuilder::Finish(int width) {
   QByteArray ret;
   ret.resize(width * 3);
   char *data = ret.data();
-  if (frames_.count() == 0) return ret;
+  const size_t frames = r_.values.size();
+  if (frames == 0) return ret;
+
+  Normalize(&r_);
+  Normalize(&g_);
+  Normalize(&b_);
 
-  Normalize(&frames_, &Rgb::r);
-  Normalize(&frames_, &Rgb::g);
-  Normalize(&frames_, &Rgb::b);
+  const double *r = r_.values.data();
+  const double *g = g_.values.data();
+  const double *b = b_.values.data();
 
   for (int i = 0; i < width; ++i) {
-    Rgb rgb;
-    const int start = static_cast<int>(i * frames_.count() / width);
-    const int end = std::max(static_cast<int>((i + 1) * frames_.count() / width), start + 1);
+    const int start = static_cast<int>(i * frames / width);
+    const int end = std::max(static_cast<int>((i + 1) * frames / width), start + 1);
 
+    double total_r = 0;
+    double total_g = 0;
+    double total_b = 0;
     for (int j = start; j < end; j++) {
-      const Rgb &frame = frames_[j];
-      rgb.r += frame.r * 255;
-      rgb.g += frame.g * 255;
-      rgb.b += frame.b * 255;
+      total_r += r[j] * 255;
+      total_g += g[j] * 255;
+      total_b += b[j] * 255;
     }
 
     const int n = end - start;
 
-    *(data++) = static_cast<char>(rgb.r / n);
-    *(data++) = static_cast<char>(rgb.g / n);
-    *(data++) = static_cast<char>(rgb.b / n);
+    *(data++) = static_cast<char>(total_r / n);
+    *(data++) = static_cast<char>(total_g / n);
+    *(data++) = static_cast<char>(total_b / n);
 
   }
   return ret;
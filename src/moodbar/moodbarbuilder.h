@@ -18,6 +18,8 @@
 #ifndef MOODBARBUILDER_H
 #define MOODBARBUILDER_H
 
+#include <vector>
+
 #include <QtGlobal>
 #include <QList>
 #include <QByteArray>
@@ -30,22 +32,32 @@ class MoodbarBuilder {
   void AddFrame(const double *magnitudes, int size);
   QByteArray Finish(int width);
 
- private:
-  struct Rgb {
-    Rgb() : r(0), g(0), b(0) {}
-    Rgb(double r_, double g_, double b_) : r(r_), g(g_), b(b_) {}
+  bool empty() const { return r_.values.empty(); }
 
-    double r, g, b;
+ private:
+  // The frame values of one color, stored contiguously.
+  // The minimum and maximum are tracked while adding frames so Normalize doesn't need a separate pass for them.
+  struct Channel {
+    Channel() : mini(0), maxi(0) {}
+    void Add(const double value);
+    void Clear();
+
+    std::vector<double> values;
+    double mini;
+    double maxi;
   };
 
   int BandFrequency(int band) const;
-  static void Normalize(QList<Rgb> *vals, double Rgb::*member);
+  static void Normalize(Channel *channel);
 
-  QList<uint> barkband_table_;
+  // The first magnitude index of each bark band, the bark bands are contiguous ranges of the magnitudes.
+  QList<int> barkband_starts_;
   int bands_;
   int rate_hz_;
 
-  QList<Rgb> frames_;
+  Channel r_;
+  Channel g_;
+  Channel b_;
 };
 
 #endif  // MOODBARBUILDER_H
@@ -24,25 +24,54 @@
 #include "core/song.h"
 #include "core/settings.h"
 #include "engine/enginebase.h"
+#include "engine/gstengine.h"
 #include "settings/moodbarsettingspage.h"
 #include "playlist/playlistmanager.h"
 
 #include "moodbarcontroller.h"
 #include "moodbarloader.h"
 #include "moodbarpipeline.h"
+#include "moodbarstreamanalyzer.h"
 
 MoodbarController::MoodbarController(Application *app, QObject *parent)
     : QObject(parent),
       app_(app),
+      stream_analyzer_(new MoodbarStreamAnalyzer(this)),
       enabled_(false) {
 
   QObject::connect(&*app_->playlist_manager(), &PlaylistManager::CurrentSongChanged, this, &MoodbarController::CurrentSongChanged);
   QObject::connect(&*app_->player(), &Player::Stopped, this, &MoodbarController::PlaybackStopped);
+  QObject::connect(&*app_->player(), &Player::Seeked, stream_analyzer_, &MoodbarStreamAnalyzer::SetIncomplete);
+  QObject::connect(&*app_->player(), &Player::EngineChanged, this, &MoodbarController::EngineChanged);
+  QObject::connect(stream_analyzer_, &MoodbarStreamAnalyzer::DataChanged, this, &MoodbarController::StreamDataChanged);
 
+  EngineChanged();
   ReloadSettings();
 
 }
 
+MoodbarController::~MoodbarController() {
+
+  if (engine_ && engine_->type() == EngineBase::Type::GStreamer) {
+    static_cast<GstEngine*>(&*engine_)->RemoveBufferConsumer(stream_analyzer_);
+  }
+
+}
+
+void MoodbarController::EngineChanged() {
+
+  if (engine_ && engine_->type() == EngineBase::Type::GStreamer) {
+    static_cast<GstEngine*>(&*engine_)->RemoveBufferConsumer(stream_analyzer_);
+  }
+  stream_analyzer_->Stop();
+
+  engine_ = app_->player()->engine();
+  if (engine_ && engine_->type() == EngineBase::Type::GStreamer) {
+    static_cast<GstEngine*>(&*engine_)->AddBufferConsumer(stream_analyzer_);
+  }
+
+}
+
 void MoodbarController::ReloadSettings() {
 
   Settings s;
@@ -56,6 +85,11 @@ void MoodbarController::CurrentSongChanged(const Song &song) {
 
   if (!enabled_) return;
 
+  // Metadata updates of radio streams don't start a new analysis.
+  if (!song.url().isLocalFile() && song.url() == stream_analyzer_->url()) return;
+
+  FinishStreamAnalysis();
+
   QByteArray data;
   MoodbarPipeline *pipeline = nullptr;
   const MoodbarLoader::Result result = app_->moodbar_loader()->Load(song.url(), song.has_cue(), &data, &pipeline);
@@ -63,6 +97,7 @@ void MoodbarController::CurrentSongChanged(const Song &song) {
   switch (result) {
     case MoodbarLoader::Result::CannotLoad:
       emit CurrentMoodbarDataChanged(QByteArray());
+      StartStreamAnalysis(song);
       break;
 
     case MoodbarLoader::Result::Loaded:
@@ -81,9 +116,43 @@ void MoodbarController::CurrentSongChanged(const Song &song) {
 }
 
 void MoodbarController::PlaybackStopped() {
+
+  FinishStreamAnalysis();
+
   if (enabled_) {
     emit CurrentMoodbarDataChanged(QByteArray());
   }
+
+}
+
+void MoodbarController::StartStreamAnalysis(const Song &song) {
+
+  if (song.url().isLocalFile() || song.has_cue() || !engine_ || engine_->type() != EngineBase::Type::GStreamer) return;
+
+  stream_analyzer_->Start(song.url(), song.length_nanosec());
+
+}
+
+void MoodbarController::FinishStreamAnalysis() {
+
+  if (stream_analyzer_->url().isEmpty()) return;
+
+  // Streams that were played from start to end are saved.
+  const QByteArray data = stream_analyzer_->CompleteData();
+  if (!data.isEmpty()) {
+    app_->moodbar_loader()->SaveStreamData(stream_analyzer_->url(), data);
+  }
+
+  stream_analyzer_->Stop();
+
+}
+
+void MoodbarController::StreamDataChanged(const QByteArray &data) {
+
+  if (enabled_) {
+    emit CurrentMoodbarDataChanged(data);
+  }
+
 }
 
 void MoodbarController::AsyncLoadComplete(MoodbarPipeline *pipeline, const QUrl &url) {
@@ -23,8 +23,12 @@
 #include <QString>
 #include <QUrl>
 
+#include "core/shared_ptr.h"
+
 class Application;
+class EngineBase;
 class MoodbarPipeline;
+class MoodbarStreamAnalyzer;
 class Song;
 
 class MoodbarController : public QObject {
@@ -32,6 +36,7 @@ class MoodbarController : public QObject {
 
  public:
   explicit MoodbarController(Application *app, QObject *parent = nullptr);
+  ~MoodbarController() override;
 
   void ReloadSettings();
 
@@ -42,9 +47,18 @@ class MoodbarController : public QObject {
   void CurrentSongChanged(const Song &song);
   void PlaybackStopped();
   void AsyncLoadComplete(MoodbarPipeline *pipeline, const QUrl &url);
+  void EngineChanged();
+  void StreamDataChanged(const QByteArray &data);
+
+ private:
+  void StartStreamAnalysis(const Song &song);
+  void FinishStreamAnalysis();
 
  private:
   Application *app_;
+  MoodbarStreamAnalyzer *stream_analyzer_;
+  // The GStreamer engine passes the played buffers to the stream analyzer.
+  SharedPtr<EngineBase> engine_;
   bool enabled_;
 };
 
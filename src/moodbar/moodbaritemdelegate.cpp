@@ -25,14 +25,18 @@
 #include <QAbstractItemModel>
 #include <QSettings>
 #include <QItemDelegate>
+#include <QList>
 #include <QByteArray>
 #include <QUrl>
 #include <QImage>
 #include <QPixmap>
+#include <QColor>
 #include <QPainter>
 #include <QRect>
+#include <QTimer>
 
 #include "core/application.h"
+#include "core/memorystats.h"
 #include "core/settings.h"
 #include "playlist/playlist.h"
 #include "playlist/playlistview.h"
@@ -45,18 +49,40 @@
 
 #include "settings/moodbarsettingspage.h"
 
+const int MoodbarItemDelegate::kImageWidthBucket = 32;
+const int MoodbarItemDelegate::kPendingImagesDelayMsec = 100;
+
 MoodbarItemDelegate::Data::Data() : state_(State::None) {}
 
 MoodbarItemDelegate::MoodbarItemDelegate(Application *app, PlaylistView *view, QObject *parent)
     : QItemDelegate(parent),
       app_(app),
       view_(view),
+      pending_images_timer_(new QTimer(this)),
       enabled_(false),
       style_(MoodbarRenderer::MoodbarStyle::Normal) {
 
+  pending_images_timer_->setSingleShot(true);
+  pending_images_timer_->setInterval(kPendingImagesDelayMsec);
+  QObject::connect(pending_images_timer_, &QTimer::timeout, this, &MoodbarItemDelegate::LoadPendingImages);
+
   QObject::connect(app_, &Application::SettingsChanged, this, &MoodbarItemDelegate::ReloadSettings);
   ReloadSettings();
 
+  memorystats::AddProvider(this, [this]() {
+    qint64 bytes = 0;
+    const QList<QUrl> urls = data_.keys();
+    for (const QUrl &url : urls) {
+      const Data *data = data_.object(url);
+      bytes += data->bytes_.size() + data->colors_.size() * static_cast<qint64>(sizeof(QColor)) + static_cast<qint64>(data->pixmap_.width()) * data->pixmap_.height() * data->pixmap_.depth() / 8;
+    }
+    return memorystats::Entry(QStringLiteral("Moodbar cache"), data_.count(), bytes);
+  });
+
+}
+
+MoodbarItemDelegate::~MoodbarItemDelegate() {
+  memorystats::RemoveProviders(this);
 }
 
 void MoodbarItemDelegate::ReloadSettings() {
@@ -69,6 +95,7 @@ void MoodbarItemDelegate::ReloadSettings() {
 
   if (!enabled_) {
     data_.clear();
+    pending_images_.clear();
   }
 
   if (new_style != style_) {
@@ -96,6 +123,12 @@ void MoodbarItemDelegate::paint(QPainter *painter, const QStyleOptionViewItem &o
 
 }
 
+QSize MoodbarItemDelegate::ImageSize(const QSize size) {
+
+  return QSize(((size.width() + kImageWidthBucket - 1) / kImageWidthBucket) * kImageWidthBucket, size.height());
+
+}
+
 QPixmap MoodbarItemDelegate::PixmapForIndex(const QModelIndex &idx, const QSize size) {
 
   // Pixmaps are keyed off URL.
@@ -112,7 +145,7 @@ QPixmap MoodbarItemDelegate::PixmapForIndex(const QModelIndex &idx, const QSize
   }
 
   data->indexes_.insert(idx);
-  data->desired_size_ = size;
+  data->desired_size_ = ImageSize(size);
 
   switch (data->state_) {
     case Data::State::CannotLoad:
@@ -122,9 +155,10 @@ QPixmap MoodbarItemDelegate::PixmapForIndex(const QModelIndex &idx, const QSize
       return data->pixmap_;
 
     case Data::State::Loaded:
-      // Is the pixmap the right size?
-      if (data->pixmap_.size() != size) {
-        StartLoadingImage(url, data);
+      // Is the pixmap the right size? The old one is scaled until the resize is over.
+      if (data->pixmap_.size() != data->desired_size_) {
+        pending_images_ << url;
+        pending_images_timer_->start();
       }
 
       return data->pixmap_;
@@ -154,6 +188,7 @@ void MoodbarItemDelegate::StartLoadingData(const QUrl &url, const bool has_cue,
 
     case MoodbarLoader::Result::Loaded:
       // We got the data immediately.
+      data->bytes_ = bytes;
       StartLoadingColors(url, bytes, data);
       break;
 
@@ -172,6 +207,7 @@ bool MoodbarItemDelegate::RemoveFromCacheIfIndexesInvalid(const QUrl &url, Data
   if (std::any_of(indexes.begin(), indexes.end(), [](const QPersistentModelIndex &idx) { return idx.isValid(); })) { return false; }
 
   data_.remove(url);
+  pending_images_.remove(url);
   return true;
 
 }
@@ -182,8 +218,9 @@ void MoodbarItemDelegate::ReloadAllColors() {
   for (const QUrl &url : urls) {
     Data *data = data_[url];
 
-    if (data->state_ == Data::State::Loaded) {
-      StartLoadingData(url, false, data);
+    // The current pixmap is kept until the new colors are rendered.
+    if (data->state_ == Data::State::Loaded && !data->bytes_.isEmpty()) {
+      StartLoadingColors(url, data->bytes_, data);
     }
   }
 
@@ -205,7 +242,8 @@ void MoodbarItemDelegate::DataLoaded(const QUrl &url, MoodbarPipeline *pipeline)
   }
 
   // Load the colors next.
-  StartLoadingColors(url, pipeline->data(), data);
+  data->bytes_ = pipeline->data();
+  StartLoadingColors(url, data->bytes_, data);
 
 }
 
@@ -213,17 +251,18 @@ void MoodbarItemDelegate::StartLoadingColors(const QUrl &url, const QByteArray &
 
   data->state_ = Data::State::LoadingColors;
 
-  QFuture<ColorVector> future = QtConcurrent::run(MoodbarRenderer::Colors, bytes, style_, qApp->palette());
+  const MoodbarRenderer::MoodbarStyle style = style_;
+  QFuture<ColorVector> future = QtConcurrent::run(MoodbarRenderer::Colors, bytes, style, qApp->palette());
   QFutureWatcher<ColorVector> *watcher = new QFutureWatcher<ColorVector>();
-  QObject::connect(watcher, &QFutureWatcher<ColorVector>::finished, this, [this, watcher, url]() {
-    ColorsLoaded(url, watcher->result());
+  QObject::connect(watcher, &QFutureWatcher<ColorVector>::finished, this, [this, watcher, url, style]() {
+    ColorsLoaded(url, style, watcher->result());
     watcher->deleteLater();
   });
   watcher->setFuture(future);
 
 }
 
-void MoodbarItemDelegate::ColorsLoaded(const QUrl &url, const ColorVector &colors) {
+void MoodbarItemDelegate::ColorsLoaded(const QUrl &url, const MoodbarRenderer::MoodbarStyle style, const ColorVector &colors) {
 
   if (!data_.contains(url)) return;
 
@@ -233,6 +272,12 @@ void MoodbarItemDelegate::ColorsLoaded(const QUrl &url, const ColorVector &color
     return;
   }
 
+  // The style was changed while the colors were loading.
+  if (style != style_) {
+    StartLoadingColors(url, data->bytes_, data);
+    return;
+  }
+
   data->colors_ = colors;
 
   // Load the image next.
@@ -240,9 +285,25 @@ void MoodbarItemDelegate::ColorsLoaded(const QUrl &url, const ColorVector &color
 
 }
 
+void MoodbarItemDelegate::LoadPendingImages() {
+
+  const QSet<QUrl> urls = pending_images_;
+  pending_images_.clear();
+
+  for (const QUrl &url : urls) {
+    if (!data_.contains(url)) continue;
+    Data *data = data_[url];
+    if (data->state_ == Data::State::Loaded && data->pixmap_.size() != data->desired_size_) {
+      StartLoadingImage(url, data);
+    }
+  }
+
+}
+
 void MoodbarItemDelegate::StartLoadingImage(const QUrl &url, Data *data) {
 
   data->state_ = Data::State::LoadingImage;
+  pending_images_.remove(url);
 
   QFuture<QImage> future = QtConcurrent::run(MoodbarRenderer::RenderToImage, data->colors_, data->desired_size_);
   QFutureWatcher<QImage> *watcher = new QFutureWatcher<QImage>();
@@ -30,6 +30,7 @@
 #include <QImage>
 #include <QPixmap>
 #include <QSize>
+#include <QTimer>
 #include <QStyleOption>
 
 class QPainter;
@@ -44,6 +45,7 @@ class MoodbarItemDelegate : public QItemDelegate {
 
  public:
   explicit MoodbarItemDelegate(Application *app, PlaylistView *view, QObject *parent = nullptr);
+  ~MoodbarItemDelegate() override;
 
   void paint(QPainter *painter, const QStyleOptionViewItem &option, const QModelIndex &idx) const override;
 
@@ -51,8 +53,9 @@ class MoodbarItemDelegate : public QItemDelegate {
   void ReloadSettings();
 
   void DataLoaded(const QUrl &url, MoodbarPipeline *pipeline);
-  void ColorsLoaded(const QUrl &url, const ColorVector &colors);
+  void ColorsLoaded(const QUrl &url, const MoodbarRenderer::MoodbarStyle style, const ColorVector &colors);
   void ImageLoaded(const QUrl &url, const QImage &image);
+  void LoadPendingImages();
 
  private:
   struct Data {
@@ -70,12 +73,19 @@ class MoodbarItemDelegate : public QItemDelegate {
     QSet<QPersistentModelIndex> indexes_;
 
     State state_;
+    QByteArray bytes_;
     ColorVector colors_;
     QSize desired_size_;
     QPixmap pixmap_;
   };
 
  private:
+  static const int kImageWidthBucket;
+  static const int kPendingImagesDelayMsec;
+
+  // Images are rendered with the width rounded up, so small resizes just scale the existing pixmap.
+  static QSize ImageSize(const QSize size);
+
   QPixmap PixmapForIndex(const QModelIndex &idx, const QSize size);
   void StartLoadingData(const QUrl &url, const bool has_cue, Data *data);
   void StartLoadingColors(const QUrl &url, const QByteArray &bytes, Data *data);
@@ -90,6 +100,10 @@ class MoodbarItemDelegate : public QItemDelegate {
   PlaylistView *view_;
   QCache<QUrl, Data> data_;
 
+  // Images needing a new size are rendered once a resize burst is over.
+  QSet<QUrl> pending_images_;
+  QTimer *pending_images_timer_;
+
   bool enabled_;
   MoodbarRenderer::MoodbarStyle style_;
 };
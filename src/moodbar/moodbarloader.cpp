@@ -36,13 +36,21 @@
 #include <QString>
 #include <QUrl>
 #include <QSettings>
+#include <QPointer>
+#include <QMetaObject>
 
 #include "core/logging.h"
 #include "core/scoped_ptr.h"
+#include "core/shared_ptr.h"
 #include "core/application.h"
 #include "core/settings.h"
+#include "core/player.h"
+#include "core/taskmanager.h"
+#include "collection/collectionbackend.h"
+#include "collection/collectionsimilarityindex.h"
 
 #include "moodbarpipeline.h"
+#include "moodbarstore.h"
 
 #include "settings/moodbarsettingspage.h"
 
@@ -54,20 +62,35 @@ using namespace std::chrono_literals;
 
 MoodbarLoader::MoodbarLoader(Application *app, QObject *parent)
     : QObject(parent),
+      app_(app),
       cache_(new QNetworkDiskCache(this)),
+      store_(new MoodbarStore(QStandardPaths::writableLocation(QStandardPaths::CacheLocation) + QStringLiteral("/moodbar.store"))),
       thread_(new QThread(this)),
       kMaxActiveRequests(qMax(1, QThread::idealThreadCount() / 2)),
-      save_(false) {
+      kMaxBackgroundRequests(qMax(1, QThread::idealThreadCount())),
+      background_paused_(false),
+      background_started_(false),
+      background_task_id_(-1),
+      background_done_(0),
+      background_total_(0),
+      enabled_(false),
+      save_(false),
+      generate_(false) {
 
   cache_->setCacheDirectory(QStandardPaths::writableLocation(QStandardPaths::CacheLocation) + QStringLiteral("/moodbar"));
   cache_->setMaximumCacheSize(60 * 1024 * 1024);  // 60MB - enough for 20,000 moodbars
 
+  QObject::connect(&*app->player(), &Player::Playing, this, [this]() { SetBackgroundPaused(true); });
+  QObject::connect(&*app->player(), &Player::Paused, this, [this]() { SetBackgroundPaused(false); });
+  QObject::connect(&*app->player(), &Player::Stopped, this, [this]() { SetBackgroundPaused(false); });
+
   QObject::connect(app, &Application::SettingsChanged, this, &MoodbarLoader::ReloadSettings);
   ReloadSettings();
 
 }
 
 MoodbarLoader::~MoodbarLoader() {
+  if (background_task_id_ != -1) app_->task_manager()->SetTaskFinished(background_task_id_);
   thread_->quit();
   thread_->wait(1000);
 }
@@ -76,9 +99,20 @@ void MoodbarLoader::ReloadSettings() {
 
   Settings s;
   s.beginGroup(MoodbarSettingsPage::kSettingsGroup);
+  enabled_ = s.value("enabled", false).toBool();
   save_ = s.value("save", false).toBool();
+  generate_ = s.value("generate", false).toBool();
   s.endGroup();
 
+  if (enabled_ && generate_) {
+    GenerateCollectionMoodbars();
+  }
+  else {
+    background_queue_.clear();
+    background_started_ = false;
+    UpdateBackgroundTask();
+  }
+
   MaybeTakeNextRequest();
 
 }
@@ -101,7 +135,16 @@ QUrl MoodbarLoader::CacheUrlEntry(const QString &filename) {
 
 MoodbarLoader::Result MoodbarLoader::Load(const QUrl &url, const bool has_cue, QByteArray *data, MoodbarPipeline **async_pipeline) {
 
-  if (!url.isLocalFile() || has_cue) {
+  if (has_cue) {
+    return Result::CannotLoad;
+  }
+
+  // Streams can't be analyzed on their own, but they might have been analyzed while they played before.
+  if (!url.isLocalFile()) {
+    if (store_->Contains(url)) {
+      *data = store_->Get(url);
+      if (!data->isEmpty()) return Result::Loaded;
+    }
     return Result::CannotLoad;
   }
 
@@ -111,6 +154,15 @@ MoodbarLoader::Result MoodbarLoader::Load(const QUrl &url, const bool has_cue, Q
     return Result::WillLoadAsync;
   }
 
+  // Most moodbars are in the store, looking them up there doesn't open any files.
+  if (store_->Contains(url)) {
+    *data = store_->Get(url);
+    if (!data->isEmpty()) {
+      UpdateSimilarityIndex(url, *data);
+      return Result::Loaded;
+    }
+  }
+
   // Check if a mood file exists for this file already
   const QString filename(url.toLocalFile());
 
@@ -122,6 +174,8 @@ MoodbarLoader::Result MoodbarLoader::Load(const QUrl &url, const bool has_cue, Q
         qLog(Info) << "Loading moodbar data from" << possible_mood_file;
         *data = f.readAll();
         f.close();
+        store_->Insert(url, *data);
+        UpdateSimilarityIndex(url, *data);
         return Result::Loaded;
       }
       else {
@@ -139,25 +193,160 @@ MoodbarLoader::Result MoodbarLoader::Load(const QUrl &url, const bool has_cue, Q
       qLog(Info) << "Loading cached moodbar data for" << filename;
       *data = device_cache_file->readAll();
       if (!data->isEmpty()) {
+        // Move it to the store, the old cache is only read from.
+        if (store_->Insert(url, *data)) {
+          device_cache_file.reset();
+          cache_->remove(disk_cache_metadata.url());
+        }
+        UpdateSimilarityIndex(url, *data);
         return Result::Loaded;
       }
     }
   }
 
+  // There was no existing file, analyze the audio file and create one.
+  MoodbarPipeline *pipeline = CreateRequest(url);
+  queued_requests_ << url;
+
+  MaybeTakeNextRequest();
+
+  *async_pipeline = pipeline;
+  return Result::WillLoadAsync;
+
+}
+
+void MoodbarLoader::SaveStreamData(const QUrl &url, const QByteArray &data) {
+
+  if (data.isEmpty()) return;
+
+  store_->Insert(url, data);
+
+}
+
+MoodbarPipeline *MoodbarLoader::CreateRequest(const QUrl &url) {
+
   if (!thread_->isRunning()) thread_->start(QThread::IdlePriority);
 
-  // There was no existing file, analyze the audio file and create one.
   MoodbarPipeline *pipeline = new MoodbarPipeline(url);
   pipeline->moveToThread(thread_);
   QObject::connect(pipeline, &MoodbarPipeline::Finished, this, [this, pipeline, url]() { RequestFinished(pipeline, url); });
 
   requests_[url] = pipeline;
-  queued_requests_ << url;
+
+  return pipeline;
+
+}
+
+bool MoodbarLoader::HasMoodbar(const QUrl &url) {
+
+  if (store_->Contains(url)) return true;
+
+  // Mood files next to the song are moved to the store, so they're not checked again.
+  const QStringList possible_mood_files = MoodFilenames(url.toLocalFile());
+  for (const QString &possible_mood_file : possible_mood_files) {
+    QFile f(possible_mood_file);
+    if (f.exists() && f.open(QIODevice::ReadOnly)) {
+      const QByteArray data = f.readAll();
+      f.close();
+      if (!data.isEmpty()) {
+        store_->Insert(url, data);
+        return true;
+      }
+    }
+  }
+
+  return cache_->metaData(CacheUrlEntry(url.toLocalFile())).isValid();
+
+}
+
+void MoodbarLoader::UpdateSimilarityIndex(const QUrl &url, const QByteArray &data) {
+
+  app_->collection_backend()->similarity_index()->SetMoodbar(url, data);
+
+}
+
+void MoodbarLoader::GenerateCollectionMoodbars() {
+
+  if (background_started_) return;
+  background_started_ = true;
+
+  // Query the songs in the backend thread.
+  SharedPtr<CollectionBackend> backend = app_->collection_backend();
+  QPointer<MoodbarLoader> moodbar_loader(this);
+  QMetaObject::invokeMethod(&*backend, [moodbar_loader, backend]() {
+    const SongList songs = backend->GetAllSongs();
+    QMetaObject::invokeMethod(moodbar_loader, [moodbar_loader, songs]() {
+      if (moodbar_loader) moodbar_loader->CollectionSongsLoaded(songs);
+    }, Qt::QueuedConnection);
+  }, Qt::QueuedConnection);
+
+}
+
+void MoodbarLoader::CollectionSongsLoaded(const SongList &songs) {
+
+  if (!background_started_) return;
+
+  for (const Song &song : songs) {
+    if (!song.url().isLocalFile() || song.has_cue() || requests_.contains(song.url())) continue;
+    if (store_->Contains(song.url())) UpdateSimilarityIndex(song.url(), store_->Get(song.url()));
+    background_queue_ << song.url();
+  }
+
+  qLog(Debug) << background_queue_.count() << "songs queued for moodbar generation";
+
+  background_done_ = 0;
+  background_total_ = static_cast<quint64>(background_queue_.count());
+  UpdateBackgroundTask();
 
   MaybeTakeNextRequest();
 
-  *async_pipeline = pipeline;
-  return Result::WillLoadAsync;
+}
+
+void MoodbarLoader::SetBackgroundPaused(const bool paused) {
+
+  background_paused_ = paused;
+  MaybeTakeNextRequest();
+
+}
+
+bool MoodbarLoader::TakeNextBackgroundRequest() {
+
+  // Songs that already have a moodbar are only counted, they're checked when they're taken, not when they're queued.
+  while (!background_queue_.isEmpty()) {
+    const QUrl url = background_queue_.takeFirst();
+    if (requests_.contains(url) || HasMoodbar(url)) {
+      ++background_done_;
+      continue;
+    }
+
+    CreateRequest(url);
+    active_requests_ << url;
+    background_active_ << url;
+
+    qLog(Debug) << "Creating moodbar data in the background for" << url.toLocalFile();
+    QMetaObject::invokeMethod(requests_[url], &MoodbarPipeline::Start, Qt::QueuedConnection);
+    return true;
+  }
+
+  return false;
+
+}
+
+void MoodbarLoader::UpdateBackgroundTask() {
+
+  const bool running = !background_queue_.isEmpty() || !background_active_.isEmpty();
+
+  if (running && background_task_id_ == -1) {
+    background_task_id_ = app_->task_manager()->StartTask(tr("Generating moodbars"));
+  }
+  else if (!running && background_task_id_ != -1) {
+    app_->task_manager()->SetTaskFinished(background_task_id_);
+    background_task_id_ = -1;
+  }
+
+  if (background_task_id_ != -1) {
+    app_->task_manager()->SetTaskProgress(background_task_id_, background_done_, background_total_);
+  }
 
 }
 
@@ -165,15 +354,23 @@ void MoodbarLoader::MaybeTakeNextRequest() {
 
   Q_ASSERT(QThread::currentThread() == qApp->thread());
 
-  if (active_requests_.count() >= kMaxActiveRequests || queued_requests_.isEmpty()) {
+  // Requests for songs that are played or shown come before the background generation.
+  if (!queued_requests_.isEmpty()) {
+    if (active_requests_.count() >= kMaxActiveRequests) return;
+
+    const QUrl url = queued_requests_.takeFirst();
+    active_requests_ << url;
+
+    qLog(Info) << "Creating moodbar data for" << url.toLocalFile();
+    QMetaObject::invokeMethod(requests_[url], &MoodbarPipeline::Start, Qt::QueuedConnection);
     return;
   }
 
-  const QUrl url = queued_requests_.takeFirst();
-  active_requests_ << url;
+  if (!background_paused_) {
+    while (active_requests_.count() < kMaxBackgroundRequests && TakeNextBackgroundRequest()) {}
+  }
 
-  qLog(Info) << "Creating moodbar data for" << url.toLocalFile();
-  QMetaObject::invokeMethod(requests_[url], &MoodbarPipeline::Start, Qt::QueuedConnection);
+  UpdateBackgroundTask();
 
 }
 
@@ -187,18 +384,22 @@ void MoodbarLoader::RequestFinished(MoodbarPipeline *request, const QUrl &url) {
 
     qLog(Info) << "Moodbar data generated successfully for" << filename;
 
-    // Save the data in the cache
-    QNetworkCacheMetaData disk_cache_metadata;
-    disk_cache_metadata.setSaveToDisk(true);
-    disk_cache_metadata.setUrl(CacheUrlEntry(filename));
-    // Qt 6 now ignores any entry without headers, so add a fake header.
-    disk_cache_metadata.setRawHeaders(QNetworkCacheMetaData::RawHeaderList() << qMakePair(QByteArray(), QByteArray()));
-
-    QIODevice *device_cache_file = cache_->prepare(disk_cache_metadata);
-    if (device_cache_file) {
-      const qint64 data_written = device_cache_file->write(request->data());
-      if (data_written > 0) {
-        cache_->insert(device_cache_file);
+    UpdateSimilarityIndex(url, request->data());
+
+    // Save the data in the store, or in the cache if it doesn't fit in a record.
+    if (!store_->Insert(url, request->data())) {
+      QNetworkCacheMetaData disk_cache_metadata;
+      disk_cache_metadata.setSaveToDisk(true);
+      disk_cache_metadata.setUrl(CacheUrlEntry(filename));
+      // Qt 6 now ignores any entry without headers, so add a fake header.
+      disk_cache_metadata.setRawHeaders(QNetworkCacheMetaData::RawHeaderList() << qMakePair(QByteArray(), QByteArray()));
+
+      QIODevice *device_cache_file = cache_->prepare(disk_cache_metadata);
+      if (device_cache_file) {
+        const qint64 data_written = device_cache_file->write(request->data());
+        if (data_written > 0) {
+          cache_->insert(device_cache_file);
+        }
       }
     }
 
@@ -227,6 +428,9 @@ void MoodbarLoader::RequestFinished(MoodbarPipeline *request, const QUrl &url) {
   // Remove the request from the active list and delete it
   requests_.remove(url);
   active_requests_.remove(url);
+  if (background_active_.remove(url)) {
+    ++background_done_;
+  }
 
   QTimer::singleShot(1s, request, &MoodbarLoader::deleteLater);
 
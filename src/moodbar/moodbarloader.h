@@ -26,11 +26,15 @@
 #include <QStringList>
 #include <QUrl>
 
+#include "core/scoped_ptr.h"
+#include "core/song.h"
+
 class QThread;
 class QByteArray;
 class QNetworkDiskCache;
 class Application;
 class MoodbarPipeline;
+class MoodbarStore;
 
 class MoodbarLoader : public QObject {
   Q_OBJECT
@@ -54,27 +58,56 @@ class MoodbarLoader : public QObject {
 
   Result Load(const QUrl &url, const bool has_cue, QByteArray *data, MoodbarPipeline **async_pipeline);
 
+  // Saves moodbar data created from the playback of a stream, so it's shown the next time the stream is played.
+  void SaveStreamData(const QUrl &url, const QByteArray &data);
+
  private slots:
   void ReloadSettings();
 
   void RequestFinished(MoodbarPipeline *request, const QUrl &url);
   void MaybeTakeNextRequest();
 
+  // Queues moodbars for all collection songs that don't have one yet.
+  void GenerateCollectionMoodbars();
+  void CollectionSongsLoaded(const SongList &songs);
+  void SetBackgroundPaused(const bool paused);
+
  private:
   static QStringList MoodFilenames(const QString &song_filename);
   static QUrl CacheUrlEntry(const QString &filename);
 
+  bool HasMoodbar(const QUrl &url);
+  // The band energies of the moodbar are used to find similar songs.
+  void UpdateSimilarityIndex(const QUrl &url, const QByteArray &data);
+  MoodbarPipeline *CreateRequest(const QUrl &url);
+  bool TakeNextBackgroundRequest();
+  void UpdateBackgroundTask();
+
  private:
+  Application *app_;
   QNetworkDiskCache *cache_;
+  ScopedPtr<MoodbarStore> store_;
   QThread *thread_;
 
   const int kMaxActiveRequests;
+  // Background generation uses all cores, but only while nothing is playing.
+  const int kMaxBackgroundRequests;
 
   QMap<QUrl, MoodbarPipeline*> requests_;
   QList<QUrl> queued_requests_;
   QSet<QUrl> active_requests_;
 
+  QList<QUrl> background_queue_;
+  QSet<QUrl> background_active_;
+  bool background_paused_;
+  bool background_started_;
+  int background_task_id_;
+  quint64 background_done_;
+  quint64 background_total_;
+
+  bool enabled_;
   bool save_;
+  bool generate_;
 };
 
 #endif  // MOODBARLOADER_H
@@ -40,6 +40,8 @@ class MoodbarPipeline : public QObject {
   explicit MoodbarPipeline(const QUrl &url, QObject *parent = nullptr);
   ~MoodbarPipeline() override;
 
+  static const int kBands;
+
   bool success() const { return success_; }
   const QByteArray &data() const { return data_; }
 
@@ -63,8 +65,6 @@ class MoodbarPipeline : public QObject {
   static GstBusSyncReply BusCallbackSync(GstBus*, GstMessage *msg, gpointer data);
 
  private:
-  static const int kBands;
-
   QUrl url_;
   GstElement *pipeline_;
   GstElement *convert_element_;
@@ -18,6 +18,7 @@
 #include <QProxyStyle>
 #include <QSettings>
 #include <QPixmap>
+#include <QImage>
 #include <QPainter>
 #include <QPen>
 #include <QPoint>
@@ -35,6 +36,9 @@
 #include <QActionGroup>
 #include <QEvent>
 #include <QContextMenuEvent>
+#include <QtConcurrentRun>
+#include <QFuture>
+#include <QFutureWatcher>
 
 #include "core/application.h"
 #include "core/settings.h"
@@ -58,6 +62,7 @@ MoodbarProxyStyle::MoodbarProxyStyle(Application *app, QSlider *slider, QObject*
       fade_timeline_(new QTimeLine(1000, this)),
       moodbar_colors_dirty_(true),
       moodbar_pixmap_dirty_(true),
+      moodbar_rendering_(false),
       context_menu_(nullptr),
       show_moodbar_action_(nullptr),
       style_action_group_(nullptr) {
@@ -257,17 +262,53 @@ void MoodbarProxyStyle::Render(ComplexControl control, const QStyleOptionSlider
 
 void MoodbarProxyStyle::EnsureMoodbarRendered(const QStyleOptionSlider *opt) {
 
+  Q_UNUSED(opt);
+
   if (moodbar_colors_dirty_) {
     moodbar_colors_ = MoodbarRenderer::Colors(data_, moodbar_style_, slider_->palette());
     moodbar_colors_dirty_ = false;
     moodbar_pixmap_dirty_ = true;
   }
 
-  if (moodbar_pixmap_dirty_) {
-    moodbar_pixmap_ = MoodbarPixmap(moodbar_colors_, slider_->size(), slider_->palette(), opt);
-    moodbar_pixmap_dirty_ = false;
+  if (!moodbar_pixmap_dirty_) return;
+
+  // While resizing, the old pixmap is scaled until the new one is rendered in the background.
+  if (!moodbar_pixmap_.isNull() && !moodbar_colors_dirty_ && state_ == State::MoodbarOn) {
+    StartRenderingMoodbar();
+    return;
   }
 
+  moodbar_pixmap_ = QPixmap::fromImage(MoodbarImage(moodbar_colors_, slider_->size(), slider_->palette()));
+  moodbar_pixmap_dirty_ = false;
+
+}
+
+void MoodbarProxyStyle::StartRenderingMoodbar() {
+
+  // Only one image is rendered at a time, further resizes are picked up when it's finished.
+  if (moodbar_rendering_) return;
+
+  moodbar_rendering_ = true;
+  moodbar_pixmap_dirty_ = false;
+
+  const ColorVector colors = moodbar_colors_;
+  QFuture<QImage> future = QtConcurrent::run(MoodbarImage, colors, slider_->size(), slider_->palette());
+  QFutureWatcher<QImage> *watcher = new QFutureWatcher<QImage>();
+  QObject::connect(watcher, &QFutureWatcher<QImage>::finished, this, [this, watcher, colors]() {
+    moodbar_rendering_ = false;
+    const QImage image = watcher->result();
+    watcher->deleteLater();
+    if (image.size() != slider_->size()) {
+      moodbar_pixmap_dirty_ = true;
+    }
+    // Drop the image if the song or style changed while it was rendered.
+    if (!moodbar_colors_dirty_ && colors == moodbar_colors_) {
+      moodbar_pixmap_ = QPixmap::fromImage(image);
+    }
+    slider_->update();
+  });
+  watcher->setFuture(future);
+
 }
 
 QRect MoodbarProxyStyle::subControlRect(ComplexControl cc, const QStyleOptionComplex *opt, SubControl sc, const QWidget *widget) const {
@@ -333,9 +374,7 @@ void MoodbarProxyStyle::DrawArrow(const QStyleOptionSlider *option, QPainter *pa
 
 }
 
-QPixmap MoodbarProxyStyle::MoodbarPixmap(const ColorVector &colors, const QSize size, const QPalette &palette, const QStyleOptionSlider *opt) {
-
-  Q_UNUSED(opt);
+QImage MoodbarProxyStyle::MoodbarImage(const ColorVector &colors, const QSize size, const QPalette &palette) {
 
   QRect rect(QPoint(0, 0), size);
   QRect border_rect(rect);
@@ -344,7 +383,8 @@ QPixmap MoodbarProxyStyle::MoodbarPixmap(const ColorVector &colors, const QSize
   QRect inner_rect(border_rect);
   inner_rect.adjust(kBorderSize, kBorderSize, -kBorderSize, -kBorderSize);
 
-  QPixmap ret(size);
+  QImage ret(size, QImage::Format_ARGB32_Premultiplied);
+  ret.fill(palette.color(QPalette::Active, QPalette::Window));
   QPainter p(&ret);
 
   // Draw the moodbar
@@ -24,6 +24,7 @@
 #include <QByteArray>
 #include <QString>
 #include <QPixmap>
+#include <QImage>
 #include <QPalette>
 #include <QRect>
 #include <QPoint>
@@ -82,10 +83,11 @@ class MoodbarProxyStyle : public QProxyStyle {
 
   void Render(ComplexControl control, const QStyleOptionSlider *option, QPainter *painter, const QWidget *widget);
   void EnsureMoodbarRendered(const QStyleOptionSlider *opt);
+  void StartRenderingMoodbar();
   void DrawArrow(const QStyleOptionSlider *option, QPainter *painter) const;
   void ShowContextMenu(const QPoint pos);
 
-  static QPixmap MoodbarPixmap(const ColorVector &colors, const QSize size, const QPalette &palette, const QStyleOptionSlider *opt);
+  static QImage MoodbarImage(const ColorVector &colors, const QSize size, const QPalette &palette);
 
  private slots:
   void ReloadSettings();
@@ -108,6 +110,7 @@ class MoodbarProxyStyle : public QProxyStyle {
 
   bool moodbar_colors_dirty_;
   bool moodbar_pixmap_dirty_;
+  bool moodbar_rendering_;
   ColorVector moodbar_colors_;
   QPixmap moodbar_pixmap_;
 
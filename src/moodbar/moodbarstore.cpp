@@ -0,0 +1,191 @@
+/*
+ * Strawberry Music Player
+ *
+ * Strawberry is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Strawberry is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Strawberry.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#include "config.h"
+
+#include <cstring>
+
+#include <QtGlobal>
+#include <QIODevice>
+#include <QFile>
+#include <QFileInfo>
+#include <QDir>
+#include <QByteArray>
+#include <QString>
+#include <QUrl>
+#include <QCryptographicHash>
+
+#include "core/logging.h"
+#include "moodbarstore.h"
+
+// Record layout: 8 byte key, 4 byte data size, 4 bytes unused, then the data padded to kMaxDataSize.
+const int MoodbarStore::kMaxDataSize = 3000;
+const quint32 MoodbarStore::kMagic = 0x4D4F4F44;  // "MOOD"
+const quint32 MoodbarStore::kVersion = 1;
+const qint64 MoodbarStore::kHeaderSize = 16;
+const qint64 MoodbarStore::kRecordSize = 16 + kMaxDataSize;
+const int MoodbarStore::kMaxRecords = 20000;  // About 60MB, the same as the old moodbar disk cache.
+
+MoodbarStore::MoodbarStore(const QString &filename)
+    : file_(filename),
+      map_(nullptr) {
+
+  if (!Open()) {
+    qLog(Error) << "Failed to open moodbar store" << filename << file_.errorString();
+  }
+
+}
+
+MoodbarStore::~MoodbarStore() {
+
+  if (map_) file_.unmap(map_);
+  file_.close();
+
+}
+
+quint64 MoodbarStore::Key(const QUrl &url) {
+
+  const QByteArray hash = QCryptographicHash::hash(url.toEncoded(), QCryptographicHash::Md5);
+  quint64 key = 0;
+  memcpy(&key, hash.constData(), sizeof(key));
+  return key;
+
+}
+
+bool MoodbarStore::Open() {
+
+  QDir().mkpath(QFileInfo(file_.fileName()).absolutePath());
+
+  if (!file_.open(QIODevice::ReadWrite)) return false;
+
+  if (file_.size() < kHeaderSize) return Reset();
+
+  if (!Map()) return false;
+
+  quint32 magic = 0, version = 0, record_size = 0;
+  memcpy(&magic, map_, sizeof(magic));
+  memcpy(&version, map_ + 4, sizeof(version));
+  memcpy(&record_size, map_ + 8, sizeof(record_size));
+  if (magic != kMagic || version != kVersion || record_size != kRecordSize) {
+    qLog(Info) << "Moodbar store" << file_.fileName() << "has an unknown format, recreating it";
+    return Reset();
+  }
+
+  // Drop a partially written record at the end.
+  const qint64 records = (file_.size() - kHeaderSize) / kRecordSize;
+  if (file_.size() != kHeaderSize + records * kRecordSize) {
+    file_.unmap(map_);
+    map_ = nullptr;
+    if (!file_.resize(kHeaderSize + records * kRecordSize) || !Map()) return false;
+  }
+
+  offsets_.reserve(static_cast<int>(records));
+  for (qint64 i = 0; i < records; ++i) {
+    const qint64 offset = kHeaderSize + i * kRecordSize;
+    quint64 key = 0;
+    memcpy(&key, map_ + offset, sizeof(key));
+    offsets_.insert(key, offset);
+  }
+
+  qLog(Debug) << "Opened moodbar store" << file_.fileName() << "with" << offsets_.count() << "moodbars";
+
+  return true;
+
+}
+
+bool MoodbarStore::Reset() {
+
+  if (map_) {
+    file_.unmap(map_);
+    map_ = nullptr;
+  }
+  offsets_.clear();
+
+  if (!file_.resize(0) || !file_.seek(0)) return false;
+
+  const quint32 header[4] = { kMagic, kVersion, static_cast<quint32>(kRecordSize), 0 };
+  if (file_.write(reinterpret_cast<const char*>(header), sizeof(header)) != kHeaderSize || !file_.flush()) return false;
+
+  return Map();
+
+}
+
+bool MoodbarStore::Map() {
+
+  if (map_) {
+    file_.unmap(map_);
+    map_ = nullptr;
+  }
+
+  map_ = file_.map(0, file_.size());
+  return map_ != nullptr;
+
+}
+
+bool MoodbarStore::Contains(const QUrl &url) const {
+
+  return map_ && offsets_.contains(Key(url));
+
+}
+
+QByteArray MoodbarStore::Get(const QUrl &url) const {
+
+  if (!map_) return QByteArray();
+
+  const qint64 offset = offsets_.value(Key(url), -1);
+  if (offset < 0) return QByteArray();
+
+  quint32 size = 0;
+  memcpy(&size, map_ + offset + 8, sizeof(size));
+  if (size == 0 || size > static_cast<quint32>(kMaxDataSize)) return QByteArray();
+
+  return QByteArray(reinterpret_cast<const char*>(map_ + offset + 16), static_cast<int>(size));
+
+}
+
+bool MoodbarStore::Insert(const QUrl &url, const QByteArray &data) {
+
+  if (!map_ || data.isEmpty() || data.size() > kMaxDataSize) return false;
+
+  // Start over when full, the moodbars are created again when needed.
+  if (offsets_.count() >= kMaxRecords && !Reset()) return false;
+
+  const quint64 key = Key(url);
+  QByteArray record(static_cast<int>(kRecordSize), '\0');
+  const quint32 size = static_cast<quint32>(data.size());
+  memcpy(record.data(), &key, sizeof(key));
+  memcpy(record.data() + 8, &size, sizeof(size));
+  memcpy(record.data() + 16, data.constData(), static_cast<size_t>(data.size()));
+
+  // Replace an existing record in place, otherwise append one and map the larger file.
+  qint64 offset = offsets_.value(key, -1);
+  if (offset >= 0) {
+    memcpy(map_ + offset, record.constData(), static_cast<size_t>(record.size()));
+    return true;
+  }
+
+  offset = file_.size();
+  if (!file_.seek(offset) || file_.write(record) != kRecordSize || !file_.flush() || !Map()) {
+    qLog(Error) << "Failed to write moodbar store" << file_.fileName() << file_.errorString();
+    return false;
+  }
+  offsets_.insert(key, offset);
+
+  return true;
+
+}
@@ -0,0 +1,65 @@
+/*
+ * Strawberry Music Player
+ *
+ * Strawberry is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Strawberry is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Strawberry.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#ifndef MOODBARSTORE_H
+#define MOODBARSTORE_H
+
+#include "config.h"
+
+#include <QtGlobal>
+#include <QFile>
+#include <QHash>
+#include <QByteArray>
+#include <QString>
+#include <QUrl>
+
+// Moodbar data of all songs in one memory-mapped file of fixed-size records, keyed by a hash of the song URL.
+// The index of the records is built when the file is opened, so a lookup doesn't open any files.
+// Only used from the thread that created it.
+class MoodbarStore {
+ public:
+  explicit MoodbarStore(const QString &filename);
+  ~MoodbarStore();
+
+  // The largest moodbar that fits in a record, the pipeline creates moodbars of 1000 RGB values.
+  static const int kMaxDataSize;
+
+  bool Contains(const QUrl &url) const;
+  QByteArray Get(const QUrl &url) const;
+  bool Insert(const QUrl &url, const QByteArray &data);
+
+ private:
+  Q_DISABLE_COPY(MoodbarStore)
+
+  static const quint32 kMagic;
+  static const quint32 kVersion;
+  static const qint64 kHeaderSize;
+  static const qint64 kRecordSize;
+  static const int kMaxRecords;
+
+  static quint64 Key(const QUrl &url);
+  bool Open();
+  bool Reset();
+  bool Map();
+
+  QFile file_;
+  uchar *map_;
+  QHash<quint64, qint64> offsets_;
+};
+
+#endif  // MOODBARSTORE_H
@@ -0,0 +1,293 @@
+/*
+ * Strawberry Music Player
+ *
+ * Strawberry is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Strawberry is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Strawberry.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#include "config.h"
+
+#include <memory>
+
+#include <glib.h>
+#include <glib-object.h>
+#include <gst/gst.h>
+#include <gst/app/gstappsrc.h>
+
+#include <QtGlobal>
+#include <QObject>
+#include <QTimer>
+#include <QMutex>
+#include <QByteArray>
+#include <QString>
+#include <QUrl>
+
+#include "core/logging.h"
+#include "moodbarstreamanalyzer.h"
+#include "moodbarbuilder.h"
+#include "moodbarpipeline.h"
+
+#include "ext/gstmoodbar/gstfastspectrum.h"
+
+using std::make_unique;
+
+namespace {
+
+// Buffers in these formats are converted to S16LE by the playback pipeline before they're passed on.
+bool IsS16Format(const QString &format) {
+
+  return format.startsWith(QLatin1String("S16LE")) ||
+         format.startsWith(QLatin1String("S24LE")) ||
+         format.startsWith(QLatin1String("S24_32LE")) ||
+         format.startsWith(QLatin1String("S32LE")) ||
+         format.startsWith(QLatin1String("F32LE")) ||
+         format.startsWith(QLatin1String("F64LE"));
+
+}
+
+}  // namespace
+
+const int MoodbarStreamAnalyzer::kUpdateIntervalMsec = 5000;
+const int MoodbarStreamAnalyzer::kWidth = 1000;
+
+MoodbarStreamAnalyzer::MoodbarStreamAnalyzer(QObject *parent)
+    : QObject(parent),
+      timer_update_(new QTimer(this)),
+      length_nanosec_(0),
+      running_(false),
+      complete_(false),
+      pipeline_(nullptr),
+      appsrc_(nullptr),
+      pipeline_id_(-1),
+      channels_(0),
+      rate_(0),
+      consumed_nanosec_(0) {
+
+  timer_update_->setInterval(kUpdateIntervalMsec);
+  QObject::connect(timer_update_, &QTimer::timeout, this, &MoodbarStreamAnalyzer::Update);
+
+}
+
+MoodbarStreamAnalyzer::~MoodbarStreamAnalyzer() {
+  Stop();
+}
+
+void MoodbarStreamAnalyzer::Start(const QUrl &url, const qint64 length_nanosec) {
+
+  Stop();
+
+  QMutexLocker l(&pipeline_mutex_);
+
+  url_ = url;
+  length_nanosec_ = length_nanosec;
+  running_ = true;
+  complete_ = true;
+  pipeline_id_ = -1;
+  consumed_nanosec_ = 0;
+
+  timer_update_->start();
+
+}
+
+void MoodbarStreamAnalyzer::Stop() {
+
+  timer_update_->stop();
+
+  QMutexLocker l(&pipeline_mutex_);
+
+  running_ = false;
+  url_.clear();
+  DestroyPipeline();
+
+}
+
+void MoodbarStreamAnalyzer::SetIncomplete() {
+
+  QMutexLocker l(&pipeline_mutex_);
+  complete_ = false;
+
+}
+
+void MoodbarStreamAnalyzer::ConsumeBuffer(GstBuffer *buffer, const int pipeline_id, const QString &format, const int channels, const int rate) {
+
+  QMutexLocker l(&pipeline_mutex_);
+
+  if (!running_ || !IsS16Format(format) || channels <= 0 || rate <= 0 || pipeline_id < pipeline_id_) {
+    gst_buffer_unref(buffer);
+    return;
+  }
+
+  // While crossfading two pipelines are playing, the newest one is playing the current song.
+  if (pipeline_id != pipeline_id_) {
+    DestroyPipeline();
+    pipeline_id_ = pipeline_id;
+    consumed_nanosec_ = 0;
+  }
+
+  if (pipeline_ && (channels != channels_ || rate != rate_)) {
+    qLog(Debug) << "Stream format changed, restarting moodbar analysis";
+    DestroyPipeline();
+    complete_ = false;
+  }
+
+  if (!pipeline_ && !CreatePipeline(channels, rate)) {
+    running_ = false;
+    gst_buffer_unref(buffer);
+    return;
+  }
+
+  // The buffer is copied, so buffers from the playback pipeline's pool aren't held while our pipeline processes them.
+  const gsize size = gst_buffer_get_size(buffer);
+  GstBuffer *copy = gst_buffer_new_allocate(nullptr, size, nullptr);
+  if (copy) {
+    GstMapInfo map;
+    if (gst_buffer_map(buffer, &map, GST_MAP_READ)) {
+      gst_buffer_fill(copy, 0, map.data, map.size);
+      gst_buffer_unmap(buffer, &map);
+      consumed_nanosec_ += gst_util_uint64_scale(size / (sizeof(qint16) * static_cast<gsize>(channels)), GST_SECOND, static_cast<guint64>(rate));
+      gst_app_src_push_buffer(GST_APP_SRC(appsrc_), copy);
+    }
+    else {
+      gst_buffer_unref(copy);
+    }
+  }
+
+  gst_buffer_unref(buffer);
+
+}
+
+bool MoodbarStreamAnalyzer::CreatePipeline(const int channels, const int rate) {
+
+  GstElement *pipeline = gst_pipeline_new("moodbar-stream-pipeline");
+  GstElement *appsrc = gst_element_factory_make("appsrc", nullptr);
+  GstElement *convert = gst_element_factory_make("audioconvert", nullptr);
+  GstElement *spectrum = gst_element_factory_make("fastspectrum", nullptr);
+  GstElement *fakesink = gst_element_factory_make("fakesink", nullptr);
+
+  if (!pipeline || !appsrc || !convert || !spectrum || !fakesink) {
+    qLog(Error) << "Unable to create gstreamer elements for the moodbar stream analyzer";
+    if (appsrc) gst_object_unref(appsrc);
+    if (convert) gst_object_unref(convert);
+    if (spectrum) gst_object_unref(spectrum);
+    if (fakesink) gst_object_unref(fakesink);
+    if (pipeline) gst_object_unref(pipeline);
+    return false;
+  }
+
+  gst_bin_add_many(GST_BIN(pipeline), appsrc, convert, spectrum, fakesink, nullptr);
+  if (!gst_element_link_many(appsrc, convert, spectrum, fakesink, nullptr)) {
+    qLog(Error) << "Failed to link elements";
+    gst_object_unref(pipeline);
+    return false;
+  }
+
+  GstCaps *caps = gst_caps_new_simple("audio/x-raw", "format", G_TYPE_STRING, "S16LE", "layout", G_TYPE_STRING, "interleaved", "rate", G_TYPE_INT, rate, "channels", G_TYPE_INT, channels, nullptr);
+  g_object_set(appsrc, "caps", caps, nullptr);
+  gst_caps_unref(caps);
+
+  g_object_set(spectrum, "bands", MoodbarPipeline::kBands, nullptr);
+
+  {
+    QMutexLocker l(&builder_mutex_);
+    builder_ = make_unique<MoodbarBuilder>();
+    builder_->Init(MoodbarPipeline::kBands, rate);
+  }
+
+  GstFastSpectrum *fast_spectrum = reinterpret_cast<GstFastSpectrum*>(spectrum);
+  fast_spectrum->output_callback = [this](double *magnitudes, int size) {
+    QMutexLocker l(&builder_mutex_);
+    if (builder_) builder_->AddFrame(magnitudes, size);
+  };
+
+  pipeline_ = pipeline;
+  appsrc_ = appsrc;
+  channels_ = channels;
+  rate_ = rate;
+
+  gst_element_set_state(pipeline_, GST_STATE_PLAYING);
+
+  return true;
+
+}
+
+void MoodbarStreamAnalyzer::DestroyPipeline() {
+
+  if (pipeline_) {
+    gst_element_set_state(pipeline_, GST_STATE_NULL);
+    gst_object_unref(pipeline_);
+    pipeline_ = nullptr;
+    appsrc_ = nullptr;
+  }
+
+  QMutexLocker l(&builder_mutex_);
+  builder_.reset();
+
+}
+
+QByteArray MoodbarStreamAnalyzer::Data(const int width) {
+
+  // Finishing normalizes the frames, so it's done on a copy and the builder can keep adding frames.
+  MoodbarBuilder builder;
+  {
+    QMutexLocker l(&builder_mutex_);
+    if (!builder_ || builder_->empty()) return QByteArray();
+    builder = *builder_;
+  }
+
+  return builder.Finish(width);
+
+}
+
+void MoodbarStreamAnalyzer::Update() {
+
+  quint64 consumed_nanosec = 0;
+  {
+    QMutexLocker l(&pipeline_mutex_);
+    consumed_nanosec = consumed_nanosec_;
+  }
+
+  // Only the part that was played is filled in, the rest is left black.
+  int width = kWidth;
+  if (length_nanosec_ > 0) {
+    width = static_cast<int>(qBound(static_cast<quint64>(1), static_cast<quint64>(kWidth) * consumed_nanosec / static_cast<quint64>(length_nanosec_), static_cast<quint64>(kWidth)));
+  }
+
+  QByteArray data = Data(width);
+  if (data.isEmpty()) return;
+
+  if (width < kWidth) {
+    data.append(QByteArray((kWidth - width) * 3, 0));
+  }
+
+  emit DataChanged(data);
+
+}
+
+QByteArray MoodbarStreamAnalyzer::CompleteData() {
+
+  if (length_nanosec_ <= 0) return QByteArray();
+
+  quint64 consumed_nanosec = 0;
+  {
+    QMutexLocker l(&pipeline_mutex_);
+    if (!running_ || !complete_) return QByteArray();
+    consumed_nanosec = consumed_nanosec_;
+  }
+
+  // Allow for the end of the song being cut off at a buffer boundary.
+  if (consumed_nanosec < static_cast<quint64>(length_nanosec_) / 100 * 95) return QByteArray();
+
+  return Data(kWidth);
+
+}
@@ -0,0 +1,102 @@
+/*
+ * Strawberry Music Player
+ *
+ * Strawberry is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Strawberry is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Strawberry.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#ifndef MOODBARSTREAMANALYZER_H
+#define MOODBARSTREAMANALYZER_H
+
+#include "config.h"
+
+#include <QtGlobal>
+#include <QObject>
+#include <QMutex>
+#include <QByteArray>
+#include <QString>
+#include <QUrl>
+
+#include <glib.h>
+#include <gst/gst.h>
+
+#include "core/scoped_ptr.h"
+#include "engine/gstbufferconsumer.h"
+
+class QTimer;
+class MoodbarBuilder;
+
+// Creates moodbar data for the playing song from the buffers of the playback pipeline.
+// This is used for streams, which MoodbarPipeline can't decode on its own, so the audio is never decoded twice.
+// The buffers are fed to a small appsrc ! audioconvert ! fastspectrum pipeline, and the data is updated while the song plays.
+class MoodbarStreamAnalyzer : public QObject, public GstBufferConsumer {
+  Q_OBJECT
+
+ public:
+  explicit MoodbarStreamAnalyzer(QObject *parent = nullptr);
+  ~MoodbarStreamAnalyzer() override;
+
+  static const int kUpdateIntervalMsec;
+
+  // The length is used to only fill the part of the moodbar that was played, streams without a length fill all of it.
+  void Start(const QUrl &url, const qint64 length_nanosec);
+  void Stop();
+
+  // Seeking skips parts of the song, so the result can't be saved.
+  void SetIncomplete();
+
+  // Only changed from the GUI thread.
+  const QUrl &url() const { return url_; }
+
+  // Creates the data for the whole song if it was played from start to end, or returns an empty array.
+  QByteArray CompleteData();
+
+  void ConsumeBuffer(GstBuffer *buffer, const int pipeline_id, const QString &format, const int channels, const int rate) override;
+
+ signals:
+  void DataChanged(const QByteArray &data);
+
+ private slots:
+  void Update();
+
+ private:
+  bool CreatePipeline(const int channels, const int rate);
+  void DestroyPipeline();
+  QByteArray Data(const int width);
+
+ private:
+  static const int kWidth;
+
+  QTimer *timer_update_;
+
+  QUrl url_;
+  qint64 length_nanosec_;
+  bool running_;
+  bool complete_;
+
+  // Protects the pipeline, it's fed from the streaming thread of the playback pipeline.
+  QMutex pipeline_mutex_;
+  GstElement *pipeline_;
+  GstElement *appsrc_;
+  int pipeline_id_;
+  int channels_;
+  int rate_;
+  quint64 consumed_nanosec_;
+
+  // Protects the builder, it's called from the streaming thread of our pipeline.
+  QMutex builder_mutex_;
+  ScopedPtr<MoodbarBuilder> builder_;
+};
+
+#endif  // MOODBARSTREAMANALYZER_H
@@ -22,18 +22,23 @@
 #include "config.h"
 
 #include <algorithm>
+#include <iterator>
+#include <utility>
 
 #include <QtGlobal>
 #include <QObject>
 #include <QPair>
 #include <QList>
+#include <QVariant>
 #include <QString>
 #include <QStringList>
 #include <QUrl>
 #include <QUrlQuery>
+#include <QSet>
 #include <QtAlgorithms>
 #include <QNetworkRequest>
 #include <QNetworkReply>
+#include <QTimer>
 #include <QJsonParseError>
 #include <QJsonArray>
 #include <QJsonDocument>
@@ -44,6 +49,7 @@
 #include "core/shared_ptr.h"
 #include "core/networkaccessmanager.h"
 #include "core/networktimeouts.h"
+#include "core/networkrequestscheduler.h"
 #include "utilities/timeconstants.h"
 
 #include "acoustidclient.h"
@@ -52,12 +58,22 @@ namespace {
 constexpr char kClientId[] = "0qjUoxbowg";
 constexpr char kUrl[] = "https://api.acoustid.org/v2/lookup";
 constexpr int kDefaultTimeout = 5000;  // msec
+constexpr int kBatchDelay = 500;  // msec
+constexpr int kMaxBatchSize = 20;
 }  // namespace
 
 AcoustidClient::AcoustidClient(SharedPtr<NetworkAccessManager> network, QObject *parent)
     : QObject(parent),
       network_(network),
-      timeouts_(new NetworkTimeouts(kDefaultTimeout, this)) {}
+      timeouts_(new NetworkTimeouts(kDefaultTimeout, this)),
+      timer_flush_requests_(new QTimer(this)),
+      flush_scheduled_(false) {
+
+  timer_flush_requests_->setInterval(kBatchDelay);
+  timer_flush_requests_->setSingleShot(true);
+  QObject::connect(timer_flush_requests_, &QTimer::timeout, this, &AcoustidClient::ScheduleFlush);
+
+}
 
 AcoustidClient::~AcoustidClient() {
 
@@ -69,41 +85,115 @@ void AcoustidClient::SetTimeout(const int msec) { timeouts_->SetTimeout(msec); }
 
 void AcoustidClient::Start(const int id, const QString &fingerprint, int duration_msec) {
 
-  using Param = QPair<QString, QString>;
-  using ParamList = QList<Param>;
+  // Tracks with the same fingerprint are looked up once.
+  auto it = std::find_if(requests_pending_.begin(), requests_pending_.end(), [fingerprint, duration_msec](const Request &request) { return request.fingerprint == fingerprint && request.duration_msec / kMsecPerSec == duration_msec / kMsecPerSec; });
+  if (it == requests_pending_.end()) {
+    requests_pending_ << Request(fingerprint, duration_msec);
+    it = std::prev(requests_pending_.end());
+  }
+  it->ids << id;
+
+  if (requests_pending_.count() >= kMaxBatchSize) {
+    timer_flush_requests_->stop();
+    ScheduleFlush();
+  }
+  else if (!timer_flush_requests_->isActive()) {
+    timer_flush_requests_->start();
+  }
 
-  const ParamList params = ParamList() << Param(QStringLiteral("format"), QStringLiteral("json"))
-                                       << Param(QStringLiteral("client"), QLatin1String(kClientId))
-                                       << Param(QStringLiteral("duration"), QString::number(duration_msec / kMsecPerSec))
-                                       << Param(QStringLiteral("meta"), QStringLiteral("recordingids+sources"))
-                                       << Param(QStringLiteral("fingerprint"), fingerprint);
+}
+
+void AcoustidClient::ScheduleFlush() {
+
+  if (flush_scheduled_ || requests_pending_.isEmpty()) return;
+
+  // The batch is taken when the request is sent, so requests queued while waiting for the rate limit are included.
+  flush_scheduled_ = true;
+  network_->scheduler()->Schedule(QUrl(QString::fromLatin1(kUrl)), NetworkRequestScheduler::Priority::Interactive, this, [this]() {
+    flush_scheduled_ = false;
+    FlushRequests();
+  });
+
+}
 
+void AcoustidClient::FlushRequests() {
+
+  if (requests_pending_.isEmpty()) return;
+
+  const QList<Request> batch = requests_pending_.mid(0, kMaxBatchSize);
+  requests_pending_.erase(requests_pending_.begin(), requests_pending_.begin() + batch.count());
+
+  // The fingerprints are sent with an index suffix, which makes AcoustID return the results for each index.
   QUrlQuery url_query;
-  url_query.setQueryItems(params);
-  QUrl url(QString::fromLatin1(kUrl));
-  url.setQuery(url_query);
+  url_query.addQueryItem(QStringLiteral("format"), QStringLiteral("json"));
+  url_query.addQueryItem(QStringLiteral("client"), QLatin1String(kClientId));
+  url_query.addQueryItem(QStringLiteral("meta"), QStringLiteral("recordingids+sources"));
+  for (int i = 0; i < batch.count(); ++i) {
+    url_query.addQueryItem(QStringLiteral("duration.%1").arg(i), QString::number(batch[i].duration_msec / kMsecPerSec));
+    url_query.addQueryItem(QStringLiteral("fingerprint.%1").arg(i), QString::fromLatin1(QUrl::toPercentEncoding(batch[i].fingerprint)));
+  }
 
-  QNetworkRequest req(url);
+  QNetworkRequest req(QUrl(QString::fromLatin1(kUrl)));
   req.setAttribute(QNetworkRequest::RedirectPolicyAttribute, QNetworkRequest::NoLessSafeRedirectPolicy);
-  QNetworkReply *reply = network_->get(req);
-  QObject::connect(reply, &QNetworkReply::finished, this, [this, reply, id]() { RequestFinished(reply, id); });
-  requests_[id] = reply;
+  req.setHeader(QNetworkRequest::ContentTypeHeader, QStringLiteral("application/x-www-form-urlencoded"));
+  QNetworkReply *reply = network_->post(req, url_query.toString(QUrl::FullyEncoded).toUtf8());
+  QObject::connect(reply, &QNetworkReply::finished, this, [this, reply, batch]() { RequestFinished(reply, batch); });
+  for (const Request &request : batch) {
+    for (const int id : request.ids) {
+      requests_.insert(id, reply);
+    }
+  }
 
   timeouts_->AddReply(reply);
 
+  ScheduleFlush();
+
 }
 
 void AcoustidClient::Cancel(const int id) {
 
-  if (requests_.contains(id)) delete requests_.take(id);
+  for (auto it = requests_pending_.begin(); it != requests_pending_.end();) {
+    it->ids.removeAll(id);
+    if (it->ids.isEmpty()) {
+      it = requests_pending_.erase(it);
+    }
+    else {
+      ++it;
+    }
+  }
+
+  const QList<QNetworkReply*> replies = requests_.values(id);
+  requests_.remove(id);
+  for (QNetworkReply *reply : replies) {
+    AbortUnusedReply(reply);
+  }
 
 }
 
 void AcoustidClient::CancelAll() {
 
-  QList<QNetworkReply*> replies = requests_.values();
-  qDeleteAll(replies);
+  timer_flush_requests_->stop();
+  network_->scheduler()->Cancel(this);
+  flush_scheduled_ = false;
+  requests_pending_.clear();
+
+  QSet<QNetworkReply*> replies;
+  for (QNetworkReply *reply : std::as_const(requests_)) {
+    replies << reply;
+  }
   requests_.clear();
+  qDeleteAll(replies);
+
+}
+
+void AcoustidClient::AbortUnusedReply(QNetworkReply *reply) {
+
+  // The reply is kept while another ID in the same batch is waiting for it.
+  if (requests_.key(reply, -1) != -1) return;
+
+  QObject::disconnect(reply, nullptr, this, nullptr);
+  if (reply->isRunning()) reply->abort();
+  reply->deleteLater();
 
 }
 
@@ -123,11 +213,29 @@ struct IdSource {
 
 }  // namespace
 
-void AcoustidClient::RequestFinished(QNetworkReply *reply, const int request_id) {
+void AcoustidClient::RequestFinished(QNetworkReply *reply, const QList<Request> &batch) {
 
   QObject::disconnect(reply, nullptr, this, nullptr);
   reply->deleteLater();
-  requests_.remove(request_id);
+
+  // IDs that were cancelled while the batch was running are left out.
+  QList<QList<int>> batch_ids;
+  batch_ids.reserve(batch.count());
+  for (const Request &request : batch) {
+    QList<int> ids;
+    for (const int id : request.ids) {
+      if (requests_.remove(id, reply) > 0) ids << id;
+    }
+    batch_ids << ids;
+  }
+
+  const auto finish_all = [this, &batch_ids](const QString &error) {
+    for (const QList<int> &ids : std::as_const(batch_ids)) {
+      for (const int id : ids) {
+        emit Finished(id, QStringList(), error);
+      }
+    }
+  };
 
   if (reply->error() != QNetworkReply::NoError || reply->attribute(QNetworkRequest::HttpStatusCodeAttribute).toInt() != 200) {
     if (reply->error() != QNetworkReply::NoError) {
@@ -136,7 +244,7 @@ void AcoustidClient::RequestFinished(QNetworkReply *reply, const int request_id)
     else {
       qLog(Error) << QStringLiteral("Acoustid: Received HTTP code %1").arg(reply->attribute(QNetworkRequest::HttpStatusCodeAttribute).toInt());
     }
-    emit Finished(request_id, QStringList());
+    finish_all(QString());
     return;
   }
 
@@ -144,7 +252,7 @@ void AcoustidClient::RequestFinished(QNetworkReply *reply, const int request_id)
   QJsonDocument json_document = QJsonDocument::fromJson(reply->readAll(), &error);
 
   if (error.error != QJsonParseError::NoError) {
-    emit Finished(request_id, QStringList());
+    finish_all(QString());
     return;
   }
 
@@ -152,42 +260,57 @@ void AcoustidClient::RequestFinished(QNetworkReply *reply, const int request_id)
 
   QString status = json_object[QStringLiteral("status")].toString();
   if (status != QStringLiteral("ok")) {
-    emit Finished(request_id, QStringList(), status);
+    finish_all(status);
     return;
   }
 
-  // Get the results:
+  // Get the results for each fingerprint:
   // -in a first step, gather ids and their corresponding number of sources
   // -then sort results by number of sources (the results are originally
   //  unsorted but results with more sources are likely to be more accurate)
   // -keep only the ids, as sources where useful only to sort the results
-  QJsonArray json_results = json_object[QStringLiteral("results")].toArray();
-
-  // List of <id, nb of sources> pairs
-  QList<IdSource> id_source_list;
-
-  for (const QJsonValueRef v : json_results) {
-    QJsonObject r = v.toObject();
-    if (!r[QStringLiteral("recordings")].isUndefined()) {
-      QJsonArray json_recordings = r[QStringLiteral("recordings")].toArray();
-      for (const QJsonValueRef recording : json_recordings) {
-        QJsonObject o = recording.toObject();
-        if (!o[QStringLiteral("id")].isUndefined()) {
-          id_source_list << IdSource(o[QStringLiteral("id")].toString(), o[QStringLiteral("sources")].toInt());
+  QList<QStringList> id_lists;
+  id_lists.reserve(batch.count());
+  for (int i = 0; i < batch.count(); ++i) {
+    id_lists << QStringList();
+  }
+
+  const QJsonArray json_fingerprints = json_object[QStringLiteral("fingerprints")].toArray();
+  for (const QJsonValue &value_fingerprint : json_fingerprints) {
+    const QJsonObject json_fingerprint = value_fingerprint.toObject();
+    const int index = json_fingerprint[QStringLiteral("index")].toVariant().toInt();
+    if (index < 0 || index >= id_lists.count()) continue;
+
+    // List of <id, nb of sources> pairs
+    QList<IdSource> id_source_list;
+
+    const QJsonArray json_results = json_fingerprint[QStringLiteral("results")].toArray();
+    for (const QJsonValue &v : json_results) {
+      QJsonObject r = v.toObject();
+      if (!r[QStringLiteral("recordings")].isUndefined()) {
+        QJsonArray json_recordings = r[QStringLiteral("recordings")].toArray();
+        for (const QJsonValueRef recording : json_recordings) {
+          QJsonObject o = recording.toObject();
+          if (!o[QStringLiteral("id")].isUndefined()) {
+            id_source_list << IdSource(o[QStringLiteral("id")].toString(), o[QStringLiteral("sources")].toInt());
+          }
         }
       }
     }
-  }
 
-  std::stable_sort(id_source_list.begin(), id_source_list.end());
+    std::stable_sort(id_source_list.begin(), id_source_list.end());
 
-  QStringList id_list;
-  id_list.reserve(id_source_list.count());
-  for (const IdSource &is : id_source_list) {
-    id_list << is.id_;
+    QStringList &id_list = id_lists[index];
+    id_list.reserve(id_source_list.count());
+    for (const IdSource &is : id_source_list) {
+      id_list << is.id_;
+    }
   }
 
-  emit Finished(request_id, id_list);
+  for (int i = 0; i < batch_ids.count(); ++i) {
+    for (const int id : std::as_const(batch_ids[i])) {
+      emit Finished(id, id_lists[i]);
+    }
+  }
 
 }
-
@@ -25,13 +25,15 @@
 #include "config.h"
 
 #include <QObject>
-#include <QMap>
+#include <QList>
+#include <QMultiMap>
 #include <QString>
 #include <QStringList>
 
 #include "core/shared_ptr.h"
 
 class QNetworkReply;
+class QTimer;
 class NetworkAccessManager;
 class NetworkTimeouts;
 
@@ -43,6 +45,7 @@ class AcoustidClient : public QObject {
   // An MBID identifies the actual song and can be passed to Musicbrainz to get metadata.
   // You can create one AcoustidClient and make multiple requests using it.
   // IDs are provided by the caller when a request is started and included in the Finished signal - they have no meaning to AcoustidClient.
+  // Requests started close together are sent as one multi-fingerprint lookup, and identical fingerprints are only looked up once.
 
  public:
   explicit AcoustidClient(SharedPtr<NetworkAccessManager> network, QObject *parent = nullptr);
@@ -51,7 +54,7 @@ class AcoustidClient : public QObject {
   // Network requests will be aborted after this interval.
   void SetTimeout(const int msec);
 
-  // Starts a request and returns immediately.  Finished() will be emitted later with the same ID.
+  // Queues a request and returns immediately.  Finished() will be emitted later with the same ID.
   void Start(const int id, const QString &fingerprint, int duration_msec);
 
   // Cancels the request with the given ID.  Finished() will never be emitted for that ID.  Does nothing if there is no request with the given ID.
@@ -63,13 +66,31 @@ class AcoustidClient : public QObject {
  signals:
   void Finished(const int id, const QStringList &mbid_list, const QString &error = QString());
 
+ private:
+  struct Request {
+    Request(const QString &_fingerprint, const int _duration_msec) : fingerprint(_fingerprint), duration_msec(_duration_msec) {}
+    QList<int> ids;
+    QString fingerprint;
+    int duration_msec;
+  };
+
  private slots:
-  void RequestFinished(QNetworkReply *reply, const int id);
+  void ScheduleFlush();
+  void FlushRequests();
+  void RequestFinished(QNetworkReply *reply, const QList<AcoustidClient::Request> &batch);
+
+ private:
+  void AbortUnusedReply(QNetworkReply *reply);
 
  private:
   SharedPtr<NetworkAccessManager> network_;
   NetworkTimeouts *timeouts_;
-  QMap<int, QNetworkReply*> requests_;
+  QTimer *timer_flush_requests_;
+  bool flush_scheduled_;
+  // Requests waiting to be sent with the next batch
+  QList<Request> requests_pending_;
+  // Replies for the IDs of the sent requests, IDs in the same batch share the reply
+  QMultiMap<int, QNetworkReply*> requests_;
 };
 
 #endif  // ACOUSTIDCLIENT_H
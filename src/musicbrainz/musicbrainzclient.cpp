@@ -22,6 +22,7 @@
 #include "config.h"
 
 #include <algorithm>
+#include <utility>
 
 #include <QObject>
 #include <QSet>
@@ -40,12 +41,12 @@
 #include <QJsonDocument>
 #include <QJsonObject>
 #include <QXmlStreamReader>
-#include <QTimer>
 
 #include "core/logging.h"
 #include "core/shared_ptr.h"
 #include "core/networkaccessmanager.h"
 #include "core/networktimeouts.h"
+#include "core/networkrequestscheduler.h"
 #include "utilities/xmlutils.h"
 #include "musicbrainzclient.h"
 
@@ -53,7 +54,6 @@ namespace {
 constexpr char kTrackUrl[] = "https://musicbrainz.org/ws/2/recording/";
 constexpr char kDiscUrl[] = "https://musicbrainz.org/ws/2/discid/";
 constexpr char kDateRegex[] = "^[12]\\d{3}";
-constexpr int kRequestsDelay = 1200;
 constexpr int kDefaultTimeout = 8000;
 constexpr int kMaxRequestPerTrack = 3;
 }  // namespace
@@ -62,13 +62,7 @@ MusicBrainzClient::MusicBrainzClient(SharedPtr<NetworkAccessManager> network, QO
     : QObject(parent),
       network_(network),
       timeouts_(new NetworkTimeouts(kDefaultTimeout, this)),
-      timer_flush_requests_(new QTimer(this)) {
-
-  timer_flush_requests_->setInterval(kRequestsDelay);
-  timer_flush_requests_->setSingleShot(true);
-  QObject::connect(timer_flush_requests_, &QTimer::timeout, this, &MusicBrainzClient::FlushRequests);
-
-}
+      flush_scheduled_(false) {}
 
 MusicBrainzClient::~MusicBrainzClient() {
 
@@ -119,8 +113,14 @@ QByteArray MusicBrainzClient::GetReplyData(QNetworkReply *reply, QString &error)
 
 void MusicBrainzClient::Cancel(int id) {
 
-  while (!requests_.isEmpty() && requests_.contains(id)) {
-    QNetworkReply *reply = requests_.take(id);
+  requests_pending_.remove(id);
+  pending_results_.remove(id);
+
+  // The reply is kept while it's fetching the recording for another track.
+  const QList<QNetworkReply*> replies = requests_.values(id);
+  requests_.remove(id);
+  for (QNetworkReply *reply : replies) {
+    if (requests_.key(reply, -1) != -1) continue;
     QObject::disconnect(reply, nullptr, this, nullptr);
     if (reply->isRunning()) reply->abort();
     reply->deleteLater();
@@ -130,8 +130,18 @@ void MusicBrainzClient::Cancel(int id) {
 
 void MusicBrainzClient::CancelAll() {
 
-  qDeleteAll(requests_.values());
+  QSet<QNetworkReply*> replies;
+  for (QNetworkReply *reply : std::as_const(requests_)) {
+    replies << reply;
+  }
   requests_.clear();
+  qDeleteAll(replies);
+
+  network_->scheduler()->Cancel(this);
+  flush_scheduled_ = false;
+  requests_pending_.clear();
+  pending_results_.clear();
+  recording_results_.clear();
 
 }
 
@@ -145,9 +155,19 @@ void MusicBrainzClient::Start(const int id, const QStringList &mbid_list) {
     requests_pending_.insert(id, request);
   }
 
-  if (!timer_flush_requests_->isActive()) {
-    timer_flush_requests_->start();
-  }
+  ScheduleFlush();
+
+}
+
+void MusicBrainzClient::ScheduleFlush() {
+
+  if (flush_scheduled_ || requests_pending_.isEmpty()) return;
+
+  flush_scheduled_ = true;
+  network_->scheduler()->Schedule(QUrl(QString::fromLatin1(kTrackUrl)), NetworkRequestScheduler::Priority::Interactive, this, [this]() {
+    flush_scheduled_ = false;
+    FlushRequests();
+  });
 
 }
 
@@ -160,50 +180,87 @@ void MusicBrainzClient::StartDiscIdRequest(const QString &discid) {
   QUrl url(QString::fromLatin1(kDiscUrl) + discid);
   url.setQuery(url_query);
 
-  QNetworkRequest req(url);
-  req.setAttribute(QNetworkRequest::RedirectPolicyAttribute, QNetworkRequest::NoLessSafeRedirectPolicy);
-  QNetworkReply *reply = network_->get(req);
-  QObject::connect(reply, &QNetworkReply::finished, this, [this, discid, reply]() { DiscIdRequestFinished(discid, reply); });
-
-  timeouts_->AddReply(reply);
+  network_->scheduler()->Schedule(url, NetworkRequestScheduler::Priority::Interactive, this, [this, url, discid]() {
+    QNetworkRequest req(url);
+    req.setAttribute(QNetworkRequest::RedirectPolicyAttribute, QNetworkRequest::NoLessSafeRedirectPolicy);
+    QNetworkReply *reply = network_->get(req);
+    QObject::connect(reply, &QNetworkReply::finished, this, [this, discid, reply]() { DiscIdRequestFinished(discid, reply); });
+    timeouts_->AddReply(reply);
+  });
 
 }
 
 void MusicBrainzClient::FlushRequests() {
 
-  if (!requests_.isEmpty() || requests_pending_.isEmpty()) return;
+  if (requests_pending_.isEmpty()) return;
+
+  // Recordings that were already fetched for another track don't need a new request.
+  QList<int> cached_ids;
+  for (QMultiMap<int, Request>::iterator it = requests_pending_.begin(); it != requests_pending_.end();) {
+    if (recording_results_.contains(it.value().mbid)) {
+      AddResults(it.value(), recording_results_.value(it.value().mbid));
+      if (!cached_ids.contains(it.key())) cached_ids << it.key();
+      it = requests_pending_.erase(it);
+    }
+    else {
+      ++it;
+    }
+  }
+  for (const int id : std::as_const(cached_ids)) {
+    FinishRequest(id);
+  }
 
-  Request request = requests_pending_.take(requests_pending_.firstKey());
+  if (requests_pending_.isEmpty()) return;
+
+  // Take the requests of all the tracks waiting for the same recording.
+  const QString mbid = requests_pending_.first().mbid;
+  QList<Request> requests;
+  for (QMultiMap<int, Request>::iterator it = requests_pending_.begin(); it != requests_pending_.end();) {
+    if (it.value().mbid == mbid) {
+      requests << it.value();
+      it = requests_pending_.erase(it);
+    }
+    else {
+      ++it;
+    }
+  }
 
   const ParamList params = ParamList() << Param(QStringLiteral("inc"), QStringLiteral("artists+releases+media"));
 
   QUrlQuery url_query;
   url_query.setQueryItems(params);
-  QUrl url(QString::fromLatin1(kTrackUrl) + request.mbid);
+  QUrl url(QString::fromLatin1(kTrackUrl) + mbid);
   url.setQuery(url_query);
 
   QNetworkRequest req(url);
   req.setAttribute(QNetworkRequest::RedirectPolicyAttribute, QNetworkRequest::NoLessSafeRedirectPolicy);
   QNetworkReply *reply = network_->get(req);
-  QObject::connect(reply, &QNetworkReply::finished, this, [this, reply, request]() { RequestFinished(reply, request.id, request.number); });
-  requests_.insert(request.id, reply);
+  QObject::connect(reply, &QNetworkReply::finished, this, [this, reply, mbid, requests]() { RequestFinished(reply, mbid, requests); });
+  for (const Request &request : std::as_const(requests)) {
+    if (!requests_.contains(request.id, reply)) {
+      requests_.insert(request.id, reply);
+    }
+  }
 
   timeouts_->AddReply(reply);
 
+  ScheduleFlush();
+
 }
 
-void MusicBrainzClient::RequestFinished(QNetworkReply *reply, const int id, const int request_number) {
+void MusicBrainzClient::RequestFinished(QNetworkReply *reply, const QString &mbid, const QList<Request> &requests) {
 
   QObject::disconnect(reply, nullptr, this, nullptr);
   reply->deleteLater();
 
-  const qint64 nb_removed = requests_.remove(id, reply);
-  if (nb_removed != 1) {
-    qLog(Debug) << "MusicBrainz: Unknown reply received:" << nb_removed << "requests removed, while only one was supposed to be removed";
-  }
-
-  if (!timer_flush_requests_->isActive() && requests_.isEmpty() && !requests_pending_.isEmpty()) {
-    timer_flush_requests_->start();
+  // Tracks that were cancelled while the request was running are left out.
+  QList<Request> requests_running;
+  QList<int> ids;
+  for (const Request &request : requests) {
+    if (ids.contains(request.id) || requests_.remove(request.id, reply) > 0) {
+      if (!ids.contains(request.id)) ids << request.id;
+      requests_running << request;
+    }
   }
 
   QString error;
@@ -221,20 +278,37 @@ void MusicBrainzClient::RequestFinished(QNetworkReply *reply, const int id, cons
         }
       }
     }
-    pending_results_[id] << PendingResults(request_number, res);
+    recording_results_.insert(mbid, res);
+    for (const Request &request : std::as_const(requests_running)) {
+      AddResults(request, res);
+    }
   }
 
+  for (const int id : std::as_const(ids)) {
+    FinishRequest(id, error);
+  }
+
+}
+
+void MusicBrainzClient::AddResults(const Request &request, const ResultList &results) {
+
+  pending_results_[request.id] << PendingResults(request.number, results);
+
+}
+
+void MusicBrainzClient::FinishRequest(const int id, const QString &error) {
+
   // No more pending requests for this id: emit the results we have.
-  if (!requests_.contains(id) && !requests_pending_.contains(id)) {
-    // Merge the results we have
-    ResultList ret;
-    QList<PendingResults> result_list_list = pending_results_.take(id);
-    std::sort(result_list_list.begin(), result_list_list.end());
-    for (const PendingResults &result_list : result_list_list) {
-      ret << result_list.results_;
-    }
-    emit Finished(id, UniqueResults(ret, UniqueResultsSortOption::KeepOriginalOrder), error);
+  if (requests_.contains(id) || requests_pending_.contains(id)) return;
+
+  // Merge the results we have
+  ResultList ret;
+  QList<PendingResults> result_list_list = pending_results_.take(id);
+  std::sort(result_list_list.begin(), result_list_list.end());
+  for (const PendingResults &result_list : result_list_list) {
+    ret << result_list.results_;
   }
+  emit Finished(id, UniqueResults(ret, UniqueResultsSortOption::KeepOriginalOrder), error);
 
 }
 
@@ -29,6 +29,7 @@
 #include <QList>
 #include <QMap>
 #include <QMultiMap>
+#include <QHash>
 #include <QVariant>
 #include <QString>
 #include <QStringList>
@@ -36,7 +37,6 @@
 #include "core/shared_ptr.h"
 
 class QNetworkReply;
-class QTimer;
 class QXmlStreamReader;
 class NetworkAccessManager;
 class NetworkTimeouts;
@@ -48,6 +48,7 @@ class MusicBrainzClient : public QObject {
   // An MBID is created from a fingerprint using MusicDnsClient.
   // You can create one MusicBrainzClient and make multiple requests using it.
   // IDs are provided by the caller when a request is started and included in the Finished signal - they have no meaning to MusicBrainzClient.
+  // A recording requested for several IDs is only fetched once, until the requests are cancelled.
 
  public:
   // The second argument allows for specifying a custom network access manager.
@@ -107,12 +108,6 @@ class MusicBrainzClient : public QObject {
   // Finished signal emitted when fechting album's songs tags using DiscId
   void DiscIdFinished(const QString &artist, const QString &album, const MusicBrainzClient::ResultList &result, const QString &error = QString());
 
- private slots:
-  void FlushRequests();
-  // id identifies the track, and request_number means it's the 'request_number'th request for this track
-  void RequestFinished(QNetworkReply *reply, const int id, const int request_number);
-  void DiscIdRequestFinished(const QString &discid, QNetworkReply *reply);
-
  private:
   using Param = QPair<QString, QString>;
   using ParamList = QList<Param>;
@@ -191,6 +186,17 @@ class MusicBrainzClient : public QObject {
     ResultList results_;
   };
 
+ private slots:
+  void FlushRequests();
+  // requests are the requests of all the tracks waiting for the recording
+  void RequestFinished(QNetworkReply *reply, const QString &mbid, const QList<MusicBrainzClient::Request> &requests);
+  void DiscIdRequestFinished(const QString &discid, QNetworkReply *reply);
+
+ private:
+  void ScheduleFlush();
+  void AddResults(const Request &request, const ResultList &results);
+  void FinishRequest(const int id, const QString &error = QString());
+
   static QByteArray GetReplyData(QNetworkReply *reply, QString &error);
   static bool MediumHasDiscid(const QString &discid, QXmlStreamReader *reader);
   static ResultList ParseMedium(QXmlStreamReader *reader);
@@ -208,7 +214,9 @@ class MusicBrainzClient : public QObject {
   QMultiMap<int, QNetworkReply*> requests_;
   // Results we received so far, kept here until all the replies are finished
   QMap<int, QList<PendingResults>> pending_results_;
-  QTimer *timer_flush_requests_;
+  // Recordings fetched so far, shared by the tracks with the same recording
+  QHash<QString, ResultList> recording_results_;
+  bool flush_scheduled_;
 
 };
 
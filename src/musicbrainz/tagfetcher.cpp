@@ -50,7 +50,14 @@ TagFetcher::TagFetcher(SharedPtr<NetworkAccessManager> network, QObject *parent)
 }
 
 QString TagFetcher::GetFingerprint(const Song &song) {
+
+  // Collection songs already have a fingerprint from the song tracking.
+  if (!song.fingerprint().isEmpty() && song.fingerprint() != QLatin1String("NONE")) {
+    return song.fingerprint();
+  }
+
   return Chromaprinter(song.url().toLocalFile()).CreateFingerprint();
+
 }
 
 void TagFetcher::StartFetch(const SongList &songs) {
@@ -29,6 +29,10 @@
 #include <QFile>
 #include <QFileInfo>
 #include <QTimer>
+#include <QThreadPool>
+#include <QFuture>
+#include <QFutureWatcher>
+#include <QtConcurrentRun>
 #include <QDateTime>
 #include <QList>
 #include <QString>
@@ -45,6 +49,7 @@
 #include "organize.h"
 #ifdef HAVE_GSTREAMER
 #  include "transcoder/transcoder.h"
+#  include "transcoder/transcodercache.h"
 #endif
 
 using namespace std::chrono_literals;
@@ -52,6 +57,7 @@ using namespace std::chrono_literals;
 class OrganizeFormat;
 
 const int Organize::kBatchSize = 10;
+const int Organize::kPreparedCopies = 2;
 #ifdef HAVE_GSTREAMER
 const int Organize::kTranscodeProgressInterval = 500;
 #endif
@@ -64,6 +70,7 @@ Organize::Organize(SharedPtr<TaskManager> task_manager, SharedPtr<MusicStorage>
       transcoder_(new Transcoder(this)),
 #endif
       process_files_timer_(new QTimer(this)),
+      copy_thread_pool_(new QThreadPool(this)),
       destination_(destination),
       format_(format),
       copy_(copy),
@@ -75,7 +82,7 @@ Organize::Organize(SharedPtr<TaskManager> task_manager, SharedPtr<MusicStorage>
       tasks_complete_(0),
       started_(false),
       task_id_(0),
-      current_copy_progress_(0),
+      next_copy_id_(0),
       finished_(false) {
 
   original_thread_ = thread();
@@ -84,6 +91,8 @@ Organize::Organize(SharedPtr<TaskManager> task_manager, SharedPtr<MusicStorage>
   process_files_timer_->setInterval(100ms);
   QObject::connect(process_files_timer_, &QTimer::timeout, this, &Organize::ProcessSomeFiles);
 
+  copy_thread_pool_->setMaxThreadCount(qMax(1, destination_->MaxConcurrentCopies()));
+
   tasks_pending_.reserve(songs_info.count());
   for (const NewSongInfo &song_info : songs_info) {
     tasks_pending_ << Task(song_info);
@@ -93,6 +102,8 @@ Organize::Organize(SharedPtr<TaskManager> task_manager, SharedPtr<MusicStorage>
 
 Organize::~Organize() {
 
+  copy_thread_pool_->waitForDone();
+
   if (thread_) {
     thread_->quit();
     thread_->deleteLater();
@@ -134,6 +145,8 @@ void Organize::ProcessSomeFiles() {
     started_ = true;
   }
 
+  FlushSongPathsChanged();
+
   // None left?
   if (tasks_pending_.isEmpty()) {
 #ifdef HAVE_GSTREAMER
@@ -145,6 +158,9 @@ void Organize::ProcessSomeFiles() {
     }
 #endif
 
+    // Wait for the copies, CopyFinished will start us off again.
+    if (!copy_progress_.isEmpty()) return;
+
     UpdateProgress();
 
     QString error_text;
@@ -167,10 +183,13 @@ void Organize::ProcessSomeFiles() {
     return;
   }
 
-  // We process files in batches so we can be cancelled part-way through.
-  for (int i = 0; i < kBatchSize; ++i) {
-    SetSongProgress(0);
+#ifdef HAVE_GSTREAMER
+  bool start_transcoder = false;
+#endif
 
+  // We process files in batches so we can be cancelled part-way through.
+  // The copies run in the background, only as many as the destination can handle are started at once, and a few more are prepared.
+  for (int i = 0; i < kBatchSize && copy_progress_.count() < MaxCopiesInFlight(); ++i) {
     if (tasks_pending_.isEmpty()) break;
 
     Task task = tasks_pending_.takeFirst();
@@ -207,13 +226,22 @@ void Organize::ProcessSomeFiles() {
         task.transcoded_filename_ = transcoder_->GetFile(task.song_info_.song_.url().toLocalFile(), preset);
         task.new_extension_ = preset.extension_;
         task.new_filetype_ = dest_type;
+        task.transcode_cache_key_ = TranscoderCache::Key(task.song_info_.song_.url().toLocalFile(), preset);
+
+        // The same file might have been transcoded for an earlier sync.
+        if (TranscoderCache::Get(task.transcode_cache_key_, task.transcoded_filename_)) {
+          qLog(Debug) << "Using cached transcode for" << task.song_info_.song_.url().toLocalFile();
+          tasks_pending_.prepend(task);
+          continue;
+        }
+
         tasks_transcoding_[task.song_info_.song_.url().toLocalFile()] = task;
         qLog(Debug) << "Transcoding to" << task.transcoded_filename_;
 
         // Start the transcoding - this will happen in the background and FileTranscoded() will get called when it's done.
         // At that point the task will get re-added to the pending queue with the new filename.
         transcoder_->AddJob(task.song_info_.song_.url().toLocalFile(), preset, task.transcoded_filename_);
-        transcoder_->Start();
+        start_transcoder = true;
         continue;
       }
     }
@@ -252,37 +280,101 @@ void Organize::ProcessSomeFiles() {
       job.cover_dest_ = QFileInfo(job.destination_).path() + QLatin1Char('/') + QFileInfo(job.cover_source_).fileName();
     }
 
-    job.progress_ = std::bind(&Organize::SetSongProgress, this, std::placeholders::_1, !task.transcoded_filename_.isEmpty());
+    // The progress is reported from the copy thread.
+    const int copy_id = next_copy_id_++;
+    const bool transcoded = !task.transcoded_filename_.isEmpty();
+    job.progress_ = [this, copy_id, transcoded](const float progress) {
+      QMetaObject::invokeMethod(this, [this, copy_id, progress, transcoded]() { SetCopyProgress(copy_id, progress, transcoded); }, Qt::QueuedConnection);
+    };
+    copy_progress_.insert(copy_id, transcoded ? 50 : 0);
+
+    SharedPtr<MusicStorage> destination = destination_;
+    QFuture<CopyResult> future = QtConcurrent::run(copy_thread_pool_, [destination, job, copy_id, task, song]() {
+      CopyResult result;
+      result.copy_id_ = copy_id;
+      result.task_ = task;
+      result.song_ = song;
+      result.remove_original_ = job.remove_original_;
+      result.success_ = destination->CopyToStorage(job, result.error_text_);
+      return result;
+    });
+    QFutureWatcher<CopyResult> *watcher = new QFutureWatcher<CopyResult>(this);
+    QObject::connect(watcher, &QFutureWatcher<CopyResult>::finished, this, &Organize::CopyFinished);
+    watcher->setFuture(future);
+  }
 
-    QString error_text;
-    if (destination_->CopyToStorage(job, error_text)) {
-      if (job.remove_original_ && song.is_collection_song() && destination_->source() == Song::Source::Collection) {
-        // Notify other aspects of system that song has been invalidated
-        QString root = destination_->LocalPath();
-        QFileInfo new_file = QFileInfo(root + QLatin1Char('/') + task.song_info_.new_filename_);
-        emit SongPathChanged(song, new_file, destination_->collection_directory_id());
-      }
-    }
-    else {
-      files_with_errors_ << task.song_info_.song_.basefilename();
-      if (!error_text.isEmpty()) {
-        log_ << error_text;
+#ifdef HAVE_GSTREAMER
+  // The transcoder runs as many jobs at once as it has threads.
+  if (start_transcoder) transcoder_->Start();
+#endif
+
+  UpdateProgress();
+
+  // Come back for more files if there is room for more copies, otherwise CopyFinished starts us off again.
+  if (copy_progress_.count() < MaxCopiesInFlight() && !process_files_timer_->isActive()) {
+    process_files_timer_->start();
+  }
+
+}
+
+int Organize::MaxCopiesInFlight() const {
+
+  // The next files are prepared while the current ones are copied, so a device is kept busy transferring.
+  return copy_thread_pool_->maxThreadCount() + kPreparedCopies;
+
+}
+
+void Organize::CopyFinished() {
+
+  QFutureWatcher<CopyResult> *watcher = static_cast<QFutureWatcher<CopyResult>*>(sender());
+  const CopyResult result = watcher->result();
+  watcher->deleteLater();
+
+  copy_progress_.remove(result.copy_id_);
+
+  const Task &task = result.task_;
+  if (result.success_) {
+    if (result.remove_original_ && result.song_.is_collection_song() && destination_->source() == Song::Source::Collection) {
+      // Notify other aspects of system that song has been invalidated
+      const QFileInfo new_file(destination_->LocalPath() + QLatin1Char('/') + task.song_info_.new_filename_);
+      Song song = result.song_;
+      song.set_url(QUrl::fromLocalFile(new_file.absoluteFilePath()));
+      song.set_basefilename(new_file.fileName());
+      const std::optional<int> collection_directory_id = destination_->collection_directory_id();
+      if (collection_directory_id) {
+        song.set_directory_id(collection_directory_id.value());
       }
+      songs_path_changed_ << song;
     }
-
-    // Clean up the temporary transcoded file
-    if (!task.transcoded_filename_.isEmpty()) {
-      QFile::remove(task.transcoded_filename_);
+  }
+  else {
+    files_with_errors_ << task.song_info_.song_.basefilename();
+    if (!result.error_text_.isEmpty()) {
+      log_ << result.error_text_;
     }
+  }
 
-    tasks_complete_++;
+  // Clean up the temporary transcoded file
+  if (!task.transcoded_filename_.isEmpty()) {
+    QFile::remove(task.transcoded_filename_);
   }
-  SetSongProgress(0);
+
+  tasks_complete_++;
+
+  UpdateProgress();
 
   if (!process_files_timer_->isActive()) {
     process_files_timer_->start();
   }
 
+}
+
+void Organize::FlushSongPathsChanged() {
+
+  if (songs_path_changed_.isEmpty()) return;
+
+  emit SongPathsChanged(songs_path_changed_);
+  songs_path_changed_.clear();
 
 }
 
@@ -315,10 +407,13 @@ Song::FileType Organize::CheckTranscode(Song::FileType original_type) const {
 }
 #endif
 
-void Organize::SetSongProgress(float progress, bool transcoded) {
+void Organize::SetCopyProgress(const int copy_id, const float progress, const bool transcoded) {
+
+  // The copy might have finished before the progress arrived.
+  if (!copy_progress_.contains(copy_id)) return;
 
   const int max = transcoded ? 50 : 100;
-  current_copy_progress_ = (transcoded ? 50 : 0) + qBound(0, static_cast<int>(progress * static_cast<float>(max)), max - 1);
+  copy_progress_[copy_id] = (transcoded ? 50 : 0) + qBound(0, static_cast<int>(progress * static_cast<float>(max)), max - 1);
   UpdateProgress();
 
 }
@@ -351,8 +446,10 @@ void Organize::UpdateProgress() {
   }
 #endif
 
-  // Add the progress of the track that's currently copying
-  progress += current_copy_progress_;
+  // Add the progress of the tracks that are currently copying
+  for (const int copy_progress : std::as_const(copy_progress_)) {
+    progress += copy_progress;
+  }
 
   task_manager_->SetTaskProgress(task_id_, progress, total);
 
@@ -360,7 +457,9 @@ void Organize::UpdateProgress() {
 
 void Organize::FileTranscoded(const QString &input, const QString &output, bool success) {
 
+#ifndef HAVE_GSTREAMER
   Q_UNUSED(output);
+#endif
 
   qLog(Info) << "File finished" << input << success;
   transcode_progress_timer_.stop();
@@ -370,6 +469,9 @@ void Organize::FileTranscoded(const QString &input, const QString &output, bool
     files_with_errors_ << input;
   }
   else {
+#ifdef HAVE_GSTREAMER
+    TranscoderCache::Add(task.transcode_cache_key_, output);
+#endif
     tasks_pending_ << task;
   }
 
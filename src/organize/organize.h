@@ -28,6 +28,7 @@
 
 #include <QObject>
 #include <QBasicTimer>
+#include <QFutureWatcher>
 #include <QFileInfo>
 #include <QSet>
 #include <QList>
@@ -41,6 +42,7 @@
 #include "organizeformat.h"
 
 class QThread;
+class QThreadPool;
 class QTimer;
 class QTimerEvent;
 
@@ -67,6 +69,7 @@ class Organize : public QObject {
   ~Organize() override;
 
   static const int kBatchSize;
+  static const int kPreparedCopies;
 #ifdef HAVE_GSTREAMER
   static const int kTranscodeProgressInterval;
 #endif
@@ -76,7 +79,7 @@ class Organize : public QObject {
  signals:
   void Finished(const QStringList &files_with_errors, const QStringList&);
   void FileCopied(const int database_id);
-  void SongPathChanged(const Song &song, const QFileInfo &new_file, const std::optional<int> new_collection_directory_id);
+  void SongPathsChanged(const SongList &songs);
 
  protected:
   void timerEvent(QTimerEvent *e) override;
@@ -85,10 +88,13 @@ class Organize : public QObject {
   void ProcessSomeFiles();
   void FileTranscoded(const QString &input, const QString &output, bool success);
   void LogLine(const QString &message);
+  void CopyFinished();
 
  private:
-  void SetSongProgress(float progress, bool transcoded = false);
+  void SetCopyProgress(const int copy_id, const float progress, const bool transcoded);
   void UpdateProgress();
+  void FlushSongPathsChanged();
+  int MaxCopiesInFlight() const;
 #ifdef HAVE_GSTREAMER
   Song::FileType CheckTranscode(Song::FileType original_type) const;
 #endif
@@ -102,10 +108,21 @@ class Organize : public QObject {
     NewSongInfo song_info_;
     float transcode_progress_;
     QString transcoded_filename_;
+    QString transcode_cache_key_;
     QString new_extension_;
     Song::FileType new_filetype_;
   };
 
+  struct CopyResult {
+    explicit CopyResult() : copy_id_(-1), remove_original_(false), success_(false) {}
+    int copy_id_;
+    Task task_;
+    Song song_;
+    bool remove_original_;
+    bool success_;
+    QString error_text_;
+  };
+
   QThread *thread_;
   QThread *original_thread_;
   SharedPtr<TaskManager> task_manager_;
@@ -113,6 +130,8 @@ class Organize : public QObject {
   Transcoder *transcoder_;
 #endif
   QTimer *process_files_timer_;
+  // Runs the copies, the number of threads depends on what the destination can handle.
+  QThreadPool *copy_thread_pool_;
   SharedPtr<MusicStorage> destination_;
   QList<Song::FileType> supported_filetypes_;
 
@@ -132,9 +151,13 @@ class Organize : public QObject {
   bool started_;
 
   int task_id_;
-  int current_copy_progress_;
+  int next_copy_id_;
+  QMap<int, int> copy_progress_;
   bool finished_;
 
+  // Collected and sent in one go, so the collection isn't updated for every file.
+  SongList songs_path_changed_;
+
   QStringList files_with_errors_;
   QStringList log_;
 };
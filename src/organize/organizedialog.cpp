@@ -24,10 +24,12 @@
 #include <functional>
 #include <algorithm>
 #include <memory>
+#include <utility>
 
 #include <QtGlobal>
 #include <QGuiApplication>
 #include <QtConcurrent>
+#include <QThread>
 #include <QFuture>
 #include <QFutureWatcher>
 #include <QAbstractItemModel>
@@ -41,6 +43,7 @@
 #include <QStringBuilder>
 #include <QStringList>
 #include <QUrl>
+#include <QIcon>
 #include <QAction>
 #include <QMenu>
 #include <QCheckBox>
@@ -79,8 +82,24 @@ using std::make_unique;
 namespace {
 constexpr char kSettingsGroup[] = "OrganizeDialog";
 constexpr char kDefaultFormat[] = "%albumartist/%album{ (Disc %disc)}/{%track - }{%albumartist - }%album{ (Disc %disc)} - %title.%extension";
+
+// Below this many songs the filenames are created in the GUI thread, it's faster than starting the threads.
+constexpr int kMinSongsForParallelFilenames = 500;
+
+QList<OrganizeFormat::GetFilenameForSongResult> FilenamesForSongs(const SongList &songs, const OrganizeFormat &format, const QString &extension) {
+
+  QList<OrganizeFormat::GetFilenameForSongResult> results;
+  results.reserve(songs.count());
+  for (const Song &song : songs) {
+    results << format.GetFilenameForSong(song, extension);
+  }
+
+  return results;
+
 }
 
+}  // namespace
+
 OrganizeDialog::OrganizeDialog(SharedPtr<TaskManager> task_manager, SharedPtr<CollectionBackend> collection_backend, QWidget *parentwindow, QWidget *parent)
     : QDialog(parent),
       parentwindow_(parentwindow),
@@ -159,6 +178,7 @@ OrganizeDialog::~OrganizeDialog() {
 void OrganizeDialog::SetDestinationModel(QAbstractItemModel *model, const bool devices) {
 
   ui_->destination->setModel(model);
+  QObject::connect(model, &QAbstractItemModel::dataChanged, this, &OrganizeDialog::DestinationDataChanged);
 
   ui_->eject_after->setVisible(devices);
 
@@ -194,7 +214,7 @@ void OrganizeDialog::accept() {
   QObject::connect(organize, &Organize::Finished, this, &OrganizeDialog::OrganizeFinished);
   QObject::connect(organize, &Organize::FileCopied, this, &OrganizeDialog::FileCopied);
   if (collection_backend_) {
-    QObject::connect(organize, &Organize::SongPathChanged, &*collection_backend_, &CollectionBackend::SongPathChanged);
+    QObject::connect(organize, &Organize::SongPathsChanged, &*collection_backend_, &CollectionBackend::SongPathsChanged);
   }
 
   organize->Start();
@@ -416,7 +436,8 @@ SongList OrganizeDialog::LoadSongsBlocking(const QStringList &filenames) {
       continue;
     }
 
-    TagReaderClient::Instance()->ReadFileBlocking(filename, &song);
+    // Only the tags are needed to build the destination filename.
+    TagReaderClient::Instance()->ReadFileBlocking(filename, &song, TagReaderClient::ReadLevel::Fast);
     if (song.is_valid()) songs << song;
   }
 
@@ -441,11 +462,31 @@ Organize::NewSongInfoList OrganizeDialog::ComputeNewSongsFilenames(const SongLis
   // Check if we will have multiple files with the same name.
   // If so, they will erase each other if the overwrite flag is set.
   // Better to rename them: e.g. foo.bar -> foo(2).bar
+
+  // The filenames of a large selection are created in parallel, the format is compiled once and shared by all threads.
+  QList<OrganizeFormat::GetFilenameForSongResult> results;
+  if (songs.count() >= kMinSongsForParallelFilenames) {
+    const int threads = qMax(1, QThread::idealThreadCount());
+    const qint64 chunk_size = (songs.count() + threads - 1) / threads;
+    QList<QFuture<QList<OrganizeFormat::GetFilenameForSongResult>>> futures;
+    for (qint64 i = 0; i < songs.count(); i += chunk_size) {
+      const SongList chunk = songs.mid(i, chunk_size);
+      futures << QtConcurrent::run([chunk, format, extension]() { return FilenamesForSongs(chunk, format, extension); });
+    }
+    for (const QFuture<QList<OrganizeFormat::GetFilenameForSongResult>> &future : std::as_const(futures)) {
+      results << future.result();
+    }
+  }
+  else {
+    results = FilenamesForSongs(songs, format, extension);
+  }
+
   QHash<QString, int> filenames;
   Organize::NewSongInfoList new_songs_info;
   new_songs_info.reserve(songs.count());
-  for (const Song &song : songs) {
-    OrganizeFormat::GetFilenameForSongResult result = format.GetFilenameForSong(song, extension);
+  for (qint64 i = 0; i < songs.count(); ++i) {
+    const Song &song = songs[i];
+    OrganizeFormat::GetFilenameForSongResult result = results[i];
     if (result.filename.isEmpty()) {
       return Organize::NewSongInfoList();
     }
@@ -464,6 +505,16 @@ Organize::NewSongInfoList OrganizeDialog::ComputeNewSongsFilenames(const SongLis
 
 }
 
+void OrganizeDialog::DestinationDataChanged(const QModelIndex &top_left, const QModelIndex &bottom_right, const QVector<int> &roles) {
+
+  // The free space of the destinations is updated in the background, so the free space bar and the check for enough space are updated when it changes.
+  if (!roles.contains(MusicStorage::Role_Capacity) && !roles.contains(MusicStorage::Role_FreeSpace)) return;
+
+  const int row = ui_->destination->currentIndex();
+  if (row >= top_left.row() && row <= bottom_right.row()) UpdatePreviews();
+
+}
+
 void OrganizeDialog::UpdatePreviews() {
 
   if (songs_future_.isRunning()) {
@@ -531,9 +582,11 @@ void OrganizeDialog::UpdatePreviews() {
   ui_->groupbox_preview->setVisible(has_local_destination);
   ui_->groupbox_naming->setVisible(has_local_destination);
   if (has_local_destination) {
+    const QIcon icon_unique = IconLoader::Load(QStringLiteral("dialog-ok-apply"));
+    const QIcon icon_not_unique = IconLoader::Load(QStringLiteral("dialog-warning"));
     for (const Organize::NewSongInfo &song_info : new_songs_info_) {
       QString filename = storage->LocalPath() + QLatin1Char('/') + song_info.new_filename_;
-      QListWidgetItem *item = new QListWidgetItem(song_info.unique_filename_ ? IconLoader::Load(QStringLiteral("dialog-ok-apply")) : IconLoader::Load(QStringLiteral("dialog-warning")), QDir::toNativeSeparators(filename), ui_->preview);
+      QListWidgetItem *item = new QListWidgetItem(song_info.unique_filename_ ? icon_unique : icon_not_unique, QDir::toNativeSeparators(filename), ui_->preview);
       ui_->preview->addItem(item);
       if (!song_info.unique_filename_) {
         ok = false;
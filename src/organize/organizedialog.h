@@ -33,6 +33,7 @@
 #include <QString>
 #include <QStringList>
 #include <QUrl>
+#include <QVector>
 #include <QtEvents>
 
 #include "core/scoped_ptr.h"
@@ -42,6 +43,7 @@
 #include "organizeformat.h"
 
 class QAbstractItemModel;
+class QModelIndex;
 class QWidget;
 class QResizeEvent;
 class QShowEvent;
@@ -99,6 +101,7 @@ class OrganizeDialog : public QDialog {
 
   void InsertTag(const QString &tag);
   void UpdatePreviews();
+  void DestinationDataChanged(const QModelIndex &top_left, const QModelIndex &bottom_right, const QVector<int> &roles);
 
   void OrganizeFinished(const QStringList &files_with_errors, const QStringList &log);
 
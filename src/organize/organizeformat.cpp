@@ -44,10 +44,38 @@
 #include "organizeformat.h"
 
 namespace {
+
 constexpr char kBlockPattern[] = "\\{([^{}]+)\\}";
 constexpr char kTagPattern[] = "\\%([a-zA-Z]*)";
+
+// The expressions are only created once, they're used for every song.
+const QRegularExpression &ProblematicCharactersRegex() {
+  static const QRegularExpression regex(QLatin1String(kProblematicCharactersRegex), QRegularExpression::PatternOption::CaseInsensitiveOption);
+  return regex;
+}
+
+const QRegularExpression &InvalidFatCharactersRegex() {
+  static const QRegularExpression regex(QLatin1String(kInvalidFatCharactersRegex), QRegularExpression::PatternOption::CaseInsensitiveOption);
+  return regex;
+}
+
+const QRegularExpression &InvalidDirCharactersRegex() {
+  static const QRegularExpression regex(QString::fromLatin1(kInvalidDirCharactersRegex), QRegularExpression::PatternOption::CaseInsensitiveOption);
+  return regex;
+}
+
+const QRegularExpression &LeadingTheRegex() {
+  static const QRegularExpression regex(QStringLiteral("^the\\s+"), QRegularExpression::CaseInsensitiveOption);
+  return regex;
+}
+
+const QRegularExpression &WhitespaceRegex() {
+  static const QRegularExpression regex(QStringLiteral("\\s"));
+  return regex;
 }
 
+}  // namespace
+
 const QStringList OrganizeFormat::kKnownTags = QStringList() << QStringLiteral("title")
                                                              << QStringLiteral("album")
                                                              << QStringLiteral("artist")
@@ -69,9 +97,6 @@ const QStringList OrganizeFormat::kKnownTags = QStringList() << QStringLiteral("
                                                              << QStringLiteral("grouping")
                                                              << QStringLiteral("lyrics");
 
-const QStringList OrganizeFormat::kUniqueTags = QStringList() << QStringLiteral("title")
-                                                              << QStringLiteral("track");
-
 const QRgb OrganizeFormat::SyntaxHighlighter::kValidTagColorLight = qRgb(64, 64, 255);
 const QRgb OrganizeFormat::SyntaxHighlighter::kInvalidTagColorLight = qRgb(255, 64, 64);
 const QRgb OrganizeFormat::SyntaxHighlighter::kBlockColorLight = qRgb(230, 230, 230);
@@ -81,16 +106,25 @@ const QRgb OrganizeFormat::SyntaxHighlighter::kInvalidTagColorDark = qRgb(255, 1
 const QRgb OrganizeFormat::SyntaxHighlighter::kBlockColorDark = qRgb(64, 64, 64);
 
 OrganizeFormat::OrganizeFormat(const QString &format)
-    : format_(format),
-      remove_problematic_(false),
+    : remove_problematic_(false),
       remove_non_fat_(false),
       remove_non_ascii_(false),
       allow_ascii_ext_(false),
-      replace_spaces_(true) {}
+      replace_spaces_(true) {
+
+  set_format(format);
+
+}
 
 void OrganizeFormat::set_format(const QString &v) {
-  format_ = v;
-  format_.replace(QLatin1Char('\\'), QLatin1Char('/'));
+
+  QString format = v;
+  format.replace(QLatin1Char('\\'), QLatin1Char('/'));
+  if (format == format_) return;
+
+  format_ = format;
+  parts_ = Compile(format_);
+
 }
 
 bool OrganizeFormat::IsValid() const {
@@ -106,7 +140,12 @@ bool OrganizeFormat::IsValid() const {
 OrganizeFormat::GetFilenameForSongResult OrganizeFormat::GetFilenameForSong(const Song &song, QString extension) const {
 
   bool unique_filename = false;
-  QString filepath = ParseBlock(format_, song, &unique_filename);
+  QString filepath;
+  for (const Part &part : parts_) {
+    bool empty = false;
+    const QString value = Evaluate(part.tokens, song, &unique_filename, &empty);
+    if (!part.block || !empty) filepath.append(value);
+  }
 
   if (filepath.isEmpty()) {
     filepath = song.basefilename();
@@ -133,9 +172,9 @@ OrganizeFormat::GetFilenameForSongResult OrganizeFormat::GetFilenameForSong(cons
     return GetFilenameForSongResult();
   }
 
-  if (remove_problematic_) filepath = filepath.remove(QRegularExpression(QLatin1String(kProblematicCharactersRegex), QRegularExpression::PatternOption::CaseInsensitiveOption));
+  if (remove_problematic_) filepath = filepath.remove(ProblematicCharactersRegex());
   if (remove_non_fat_ || (remove_non_ascii_ && !allow_ascii_ext_)) filepath = Utilities::Transliterate(filepath);
-  if (remove_non_fat_) filepath = filepath.remove(QRegularExpression(QLatin1String(kInvalidFatCharactersRegex), QRegularExpression::PatternOption::CaseInsensitiveOption));
+  if (remove_non_fat_) filepath = filepath.remove(InvalidFatCharactersRegex());
 
   if (remove_non_ascii_) {
     int ascii = 128;
@@ -192,7 +231,7 @@ OrganizeFormat::GetFilenameForSongResult OrganizeFormat::GetFilenameForSong(cons
   }
   filepath = parts_new.join(QStringLiteral("/"));
 
-  if (replace_spaces_) filepath.replace(QRegularExpression(QStringLiteral("\\s")), QStringLiteral("_"));
+  if (replace_spaces_) filepath.replace(WhitespaceRegex(), QStringLiteral("_"));
 
   if (!extension.isEmpty()) {
     filepath.append(QStringLiteral(".%1").arg(extension));
@@ -202,127 +241,199 @@ OrganizeFormat::GetFilenameForSongResult OrganizeFormat::GetFilenameForSong(cons
 
 }
 
-QString OrganizeFormat::ParseBlock(QString block, const Song &song, bool *have_tagdata, bool *any_empty) const {
+QList<OrganizeFormat::Part> OrganizeFormat::Compile(const QString &format) {
+
+  // Blocks are matched like kBlockPattern: a '{' followed by at least one character and a '}', without any other braces in between.
+  QList<Part> parts;
+  QString text;
+  int i = 0;
+  while (i < format.length()) {
+    if (format[i] == QLatin1Char('{')) {
+      int end = i + 1;
+      while (end < format.length() && format[end] != QLatin1Char('{') && format[end] != QLatin1Char('}')) ++end;
+      if (end < format.length() && format[end] == QLatin1Char('}') && end > i + 1) {
+        if (!text.isEmpty()) {
+          Part part;
+          part.tokens = CompileTokens(text);
+          parts << part;
+          text.clear();
+        }
+        Part part;
+        part.block = true;
+        part.tokens = CompileTokens(format.mid(i + 1, end - i - 1));
+        parts << part;
+        i = end + 1;
+        continue;
+      }
+    }
+    text.append(format[i]);
+    ++i;
+  }
 
-  // Find any blocks first
-  qint64 pos = 0;
-  const QRegularExpression block_regexp(QString::fromLatin1(kBlockPattern));
-  QRegularExpressionMatch re_match;
-  for (re_match = block_regexp.match(block, pos); re_match.hasMatch(); re_match = block_regexp.match(block, pos)) {
-    pos = re_match.capturedStart();
-    // Recursively parse the block
-    bool empty = false;
-    QString value = ParseBlock(re_match.captured(1), song, have_tagdata, &empty);
-    if (empty) value = QLatin1String("");
+  if (!text.isEmpty()) {
+    Part part;
+    part.tokens = CompileTokens(text);
+    parts << part;
+  }
+
+  return parts;
+
+}
 
-    // Replace the block's value
-    block.replace(pos, re_match.capturedLength(), value);
-    pos += value.length();
+QList<OrganizeFormat::Token> OrganizeFormat::CompileTokens(const QString &text) {
+
+  QList<Token> tokens;
+  const QRegularExpression tag_regexp(QString::fromLatin1(kTagPattern));
+  qint64 pos = 0;
+  for (QRegularExpressionMatch re_match = tag_regexp.match(text, pos); re_match.hasMatch(); re_match = tag_regexp.match(text, pos)) {
+    if (re_match.capturedStart() > pos) {
+      tokens << Token(text.mid(pos, re_match.capturedStart() - pos));
+    }
+    const QString name = re_match.captured(1);
+    tokens << Token(name, TagFromName(name), true);
+    pos = re_match.capturedEnd();
   }
+  if (pos < text.length()) {
+    tokens << Token(text.mid(pos));
+  }
+
+  return tokens;
+
+}
+
+OrganizeFormat::Tag OrganizeFormat::TagFromName(const QString &name) {
+
+  if (name == QStringLiteral("title")) return Tag::Title;
+  if (name == QStringLiteral("album")) return Tag::Album;
+  if (name == QStringLiteral("artist")) return Tag::Artist;
+  if (name == QStringLiteral("artistinitial")) return Tag::ArtistInitial;
+  if (name == QStringLiteral("albumartist")) return Tag::AlbumArtist;
+  if (name == QStringLiteral("composer")) return Tag::Composer;
+  if (name == QStringLiteral("track")) return Tag::Track;
+  if (name == QStringLiteral("disc")) return Tag::Disc;
+  if (name == QStringLiteral("year")) return Tag::Year;
+  if (name == QStringLiteral("originalyear")) return Tag::OriginalYear;
+  if (name == QStringLiteral("genre")) return Tag::Genre;
+  if (name == QStringLiteral("comment")) return Tag::Comment;
+  if (name == QStringLiteral("length")) return Tag::Length;
+  if (name == QStringLiteral("bitrate")) return Tag::Bitrate;
+  if (name == QStringLiteral("samplerate")) return Tag::Samplerate;
+  if (name == QStringLiteral("bitdepth")) return Tag::Bitdepth;
+  if (name == QStringLiteral("extension")) return Tag::Extension;
+  if (name == QStringLiteral("performer")) return Tag::Performer;
+  if (name == QStringLiteral("grouping")) return Tag::Grouping;
+  if (name == QStringLiteral("lyrics")) return Tag::Lyrics;
+
+  return Tag::Unknown;
 
-  // Now look for tags
+}
+
+QString OrganizeFormat::Evaluate(const QList<Token> &tokens, const Song &song, bool *have_tagdata, bool *any_empty) const {
+
+  QString value;
   bool empty = false;
-  pos = 0;
-  const QRegularExpression tag_regexp(QString::fromLatin1(kTagPattern));
-  for (re_match = tag_regexp.match(block, pos); re_match.hasMatch(); re_match = tag_regexp.match(block, pos)) {
-    pos = re_match.capturedStart();
-    const QString tag = re_match.captured(1);
-    const QString value = TagValue(tag, song);
-    if (value.isEmpty()) {
+  for (const Token &token : tokens) {
+    if (!token.is_tag) {
+      value.append(token.text);
+      continue;
+    }
+    const QString tag_value = TagValue(token.tag, song);
+    if (tag_value.isEmpty()) {
       empty = true;
     }
-    else if (have_tagdata && kUniqueTags.contains(tag)) {
+    else if (have_tagdata && (token.tag == Tag::Title || token.tag == Tag::Track)) {
+      // The title and track make the filename unique.
       *have_tagdata = true;
     }
-
-    block.replace(pos, re_match.capturedLength(), value);
-    pos += value.length();
+    value.append(tag_value);
   }
 
-  if (any_empty) {
-    *any_empty = empty;
-  }
+  if (any_empty) *any_empty = empty;
 
-  return block;
+  return value;
 
 }
 
-QString OrganizeFormat::TagValue(const QString &tag, const Song &song) const {
+QString OrganizeFormat::TagValue(const Tag tag, const Song &song) const {
 
   QString value;
 
-  if (tag == QStringLiteral("title")) {
-    value = song.title();
-  }
-  else if (tag == QStringLiteral("album")) {
-    value = song.album();
-  }
-  else if (tag == QStringLiteral("artist")) {
-    value = song.artist();
-  }
-  else if (tag == QStringLiteral("composer")) {
-    value = song.composer();
-  }
-  else if (tag == QStringLiteral("performer")) {
-    value = song.performer();
-  }
-  else if (tag == QStringLiteral("grouping")) {
-    value = song.grouping();
-  }
-  else if (tag == QStringLiteral("lyrics")) {
-    value = song.lyrics();
-  }
-  else if (tag == QStringLiteral("genre")) {
-    value = song.genre();
-  }
-  else if (tag == QStringLiteral("comment")) {
-    value = song.comment();
-  }
-  else if (tag == QStringLiteral("year")) {
-    value = QString::number(song.year());
-  }
-  else if (tag == QStringLiteral("originalyear")) {
-    value = QString::number(song.effective_originalyear());
-  }
-  else if (tag == QStringLiteral("track")) {
-    value = QString::number(song.track());
-  }
-  else if (tag == QStringLiteral("disc")) {
-    value = QString::number(song.disc());
-  }
-  else if (tag == QStringLiteral("length")) {
-    value = QString::number(song.length_nanosec() / kNsecPerSec);
-  }
-  else if (tag == QStringLiteral("bitrate")) {
-    value = QString::number(song.bitrate());
-  }
-  else if (tag == QStringLiteral("samplerate")) {
-    value = QString::number(song.samplerate());
-  }
-  else if (tag == QStringLiteral("bitdepth")) {
-    value = QString::number(song.bitdepth());
-  }
-  else if (tag == QStringLiteral("extension")) {
-    value = QFileInfo(song.url().toLocalFile()).suffix();
-  }
-  else if (tag == QStringLiteral("artistinitial")) {
-    value = song.effective_albumartist().trimmed();
-    if (!value.isEmpty()) {
-      value.replace(QRegularExpression(QStringLiteral("^the\\s+"), QRegularExpression::CaseInsensitiveOption), QLatin1String(""));
-      value = value[0].toUpper();
-    }
-  }
-  else if (tag == QStringLiteral("albumartist")) {
-    value = song.is_compilation() ? QStringLiteral("Various Artists") : song.effective_albumartist();
+  switch (tag) {
+    case Tag::Title:
+      value = song.title();
+      break;
+    case Tag::Album:
+      value = song.album();
+      break;
+    case Tag::Artist:
+      value = song.artist();
+      break;
+    case Tag::Composer:
+      value = song.composer();
+      break;
+    case Tag::Performer:
+      value = song.performer();
+      break;
+    case Tag::Grouping:
+      value = song.grouping();
+      break;
+    case Tag::Lyrics:
+      value = song.lyrics();
+      break;
+    case Tag::Genre:
+      value = song.genre();
+      break;
+    case Tag::Comment:
+      value = song.comment();
+      break;
+    case Tag::Year:
+      value = QString::number(song.year());
+      break;
+    case Tag::OriginalYear:
+      value = QString::number(song.effective_originalyear());
+      break;
+    case Tag::Track:
+      value = QString::number(song.track());
+      break;
+    case Tag::Disc:
+      value = QString::number(song.disc());
+      break;
+    case Tag::Length:
+      value = QString::number(song.length_nanosec() / kNsecPerSec);
+      break;
+    case Tag::Bitrate:
+      value = QString::number(song.bitrate());
+      break;
+    case Tag::Samplerate:
+      value = QString::number(song.samplerate());
+      break;
+    case Tag::Bitdepth:
+      value = QString::number(song.bitdepth());
+      break;
+    case Tag::Extension:
+      value = QFileInfo(song.url().toLocalFile()).suffix();
+      break;
+    case Tag::ArtistInitial:
+      value = song.effective_albumartist().trimmed();
+      if (!value.isEmpty()) {
+        value.remove(LeadingTheRegex());
+        value = value[0].toUpper();
+      }
+      break;
+    case Tag::AlbumArtist:
+      value = song.is_compilation() ? QStringLiteral("Various Artists") : song.effective_albumartist();
+      break;
+    case Tag::Unknown:
+      break;
   }
 
   if (value == QStringLiteral("0") || value == QStringLiteral("-1")) value = QLatin1String("");
 
   // Prepend a 0 to single-digit track numbers
-  if (tag == QStringLiteral("track") && value.length() == 1) value.prepend(QLatin1Char('0'));
+  if (tag == Tag::Track && value.length() == 1) value.prepend(QLatin1Char('0'));
 
   // Replace characters that really shouldn't be in paths
-  value = value.remove(QRegularExpression(QString::fromLatin1(kInvalidDirCharactersRegex), QRegularExpression::PatternOption::CaseInsensitiveOption));
+  value = value.remove(InvalidDirCharactersRegex());
   if (remove_problematic_) value = value.remove(QLatin1Char('.'));
   value = value.trimmed();
 
@@ -25,6 +25,7 @@
 #include "config.h"
 
 #include <QObject>
+#include <QList>
 #include <QString>
 #include <QStringList>
 #include <QRgb>
@@ -86,12 +87,54 @@ class OrganizeFormat {
 
  private:
   static const QStringList kKnownTags;
-  static const QStringList kUniqueTags;
 
-  QString ParseBlock(QString block, const Song &song, bool *have_tagdata = nullptr, bool *any_empty = nullptr) const;
-  QString TagValue(const QString &tag, const Song &song) const;
+  enum class Tag {
+    Unknown,
+    Title,
+    Album,
+    Artist,
+    ArtistInitial,
+    AlbumArtist,
+    Composer,
+    Track,
+    Disc,
+    Year,
+    OriginalYear,
+    Genre,
+    Comment,
+    Length,
+    Bitrate,
+    Samplerate,
+    Bitdepth,
+    Extension,
+    Performer,
+    Grouping,
+    Lyrics
+  };
+
+  // The format is compiled to a list of parts when it's set, so it isn't parsed again for every song.
+  // A part is either a block, which is left out when any of its tags are empty, or the text between blocks.
+  struct Token {
+    explicit Token(const QString &_text = QString(), const Tag _tag = Tag::Unknown, const bool _is_tag = false) : text(_text), tag(_tag), is_tag(_is_tag) {}
+    QString text;
+    Tag tag;
+    bool is_tag;
+  };
+  struct Part {
+    Part() : block(false) {}
+    bool block;
+    QList<Token> tokens;
+  };
+
+  static QList<Part> Compile(const QString &format);
+  static QList<Token> CompileTokens(const QString &text);
+  static Tag TagFromName(const QString &name);
+
+  QString Evaluate(const QList<Token> &tokens, const Song &song, bool *have_tagdata, bool *any_empty) const;
+  QString TagValue(const Tag tag, const Song &song) const;
 
   QString format_;
+  QList<Part> parts_;
   bool remove_problematic_;
   bool remove_non_fat_;
   bool remove_non_ascii_;
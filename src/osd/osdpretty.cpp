@@ -83,6 +83,10 @@ const int OSDPretty::kSnapProximity = 20;
 const QRgb OSDPretty::kPresetBlue = qRgb(102, 150, 227);
 const QRgb OSDPretty::kPresetRed = qRgb(202, 22, 16);
 
+namespace {
+constexpr int kMessageUpdateIntervalMsec = 250;
+}
+
 
 OSDPretty::OSDPretty(Mode mode, QWidget *parent)
     : QWidget(parent),
@@ -93,6 +97,10 @@ OSDPretty::OSDPretty(Mode mode, QWidget *parent)
       popup_screen_(nullptr),
       disable_duration_(false),
       timeout_(new QTimer(this)),
+      message_timer_(new QTimer(this)),
+      message_pending_(false),
+      icon_cache_key_(0),
+      icon_device_pixel_ratio_(0.0),
       fading_enabled_(false),
       fader_(new QTimeLine(300, this)),
       toggle_mode_(false) {
@@ -128,6 +136,11 @@ OSDPretty::OSDPretty(Mode mode, QWidget *parent)
   timeout_->setInterval(5s);
   QObject::connect(timeout_, &QTimer::timeout, this, &OSDPretty::hide);
 
+  // Messages that arrive in quick succession are coalesced
+  message_timer_->setSingleShot(true);
+  message_timer_->setInterval(kMessageUpdateIntervalMsec);
+  QObject::connect(message_timer_, &QTimer::timeout, this, &OSDPretty::ShowPendingMessage);
+
   ui_->icon->setMaximumSize(kMaxIconSize, kMaxIconSize);
 
   // Fader
@@ -240,6 +253,7 @@ void OSDPretty::Load() {
   foreground_color_ = QColor(s.value("foreground_color", 0).toInt());
   background_color_ = QColor(s.value("background_color", kPresetBlue).toInt());
   background_opacity_ = s.value("background_opacity", 0.85).toFloat();
+  frame_ = QPixmap();
   font_.fromString(s.value("font", QStringLiteral("Verdana,9,-1,5,50,0,0,0,0,0")).toString());
   disable_duration_ = s.value("disable_duration", false).toBool();
 #ifdef Q_OS_WIN
@@ -297,7 +311,24 @@ QRect OSDPretty::BoxBorder() const {
 
 void OSDPretty::paintEvent(QPaintEvent*) {
 
+  // Only the labels change with each message, the frame is drawn once for each size and color.
+  const qreal device_pixel_ratio = devicePixelRatioF();
+  if (frame_.isNull() || frame_.size() != size() * device_pixel_ratio || !qFuzzyCompare(frame_.devicePixelRatio(), device_pixel_ratio)) {
+    frame_ = RenderFrame(device_pixel_ratio);
+  }
+
   QPainter p(this);
+  p.drawPixmap(0, 0, frame_);
+
+}
+
+QPixmap OSDPretty::RenderFrame(const qreal device_pixel_ratio) const {
+
+  QPixmap frame(size() * device_pixel_ratio);
+  frame.setDevicePixelRatio(device_pixel_ratio);
+  frame.fill(Qt::transparent);
+
+  QPainter p(&frame);
   p.setRenderHint(QPainter::Antialiasing);
 
   QRect box(BoxBorder());
@@ -341,14 +372,23 @@ void OSDPretty::paintEvent(QPaintEvent*) {
   p.setPen(QPen(background_color_.darker(150), 2));
   p.drawRoundedRect(box, kBorderRadius, kBorderRadius);
 
+  p.end();
+
+  return frame;
+
 }
 
 void OSDPretty::SetMessage(const QString &summary, const QString &message, const QImage &image) {
 
   if (!image.isNull()) {
-    QImage scaled_image = image.scaled(static_cast<int>(kMaxIconSize * devicePixelRatioF()), static_cast<int>(kMaxIconSize * devicePixelRatioF()), Qt::KeepAspectRatio, Qt::SmoothTransformation);
-    scaled_image.setDevicePixelRatio(devicePixelRatioF());
-    ui_->icon->setPixmap(QPixmap::fromImage(scaled_image));
+    // The paused and stopped messages show the cover of the last song again, so it's only scaled once.
+    if (image.cacheKey() != icon_cache_key_ || !qFuzzyCompare(devicePixelRatioF(), icon_device_pixel_ratio_)) {
+      QImage scaled_image = image.scaled(static_cast<int>(kMaxIconSize * devicePixelRatioF()), static_cast<int>(kMaxIconSize * devicePixelRatioF()), Qt::KeepAspectRatio, Qt::SmoothTransformation);
+      scaled_image.setDevicePixelRatio(devicePixelRatioF());
+      ui_->icon->setPixmap(QPixmap::fromImage(scaled_image));
+      icon_cache_key_ = image.cacheKey();
+      icon_device_pixel_ratio_ = devicePixelRatioF();
+    }
     ui_->icon->show();
   }
   else {
@@ -365,10 +405,32 @@ void OSDPretty::SetMessage(const QString &summary, const QString &message, const
 // Set the desired message and then show the OSD
 void OSDPretty::ShowMessage(const QString &summary, const QString &message, const QImage &image) {
 
+  // When skipping through tracks, the OSD is updated with the first message right away, and with the last one when the skipping stops.
+  if (isVisible() && mode_ == Mode::Popup && !toggle_mode()) {
+    if (message_timer_->isActive()) {
+      pending_summary_ = summary;
+      pending_message_ = message;
+      pending_image_ = image;
+      message_pending_ = true;
+    }
+    else {
+      SetMessage(summary, message, image);
+    }
+    message_timer_->start();
+    if (!disable_duration()) {
+      timeout_->start();  // Restart the timer
+    }
+    return;
+  }
+
+  message_pending_ = false;
+  pending_image_ = QImage();
+  message_timer_->start();
+
   SetMessage(summary, message, image);
 
   if (isVisible() && mode_ == Mode::Popup) {
-    // The OSD is already visible, toggle or restart the timer
+    // The OSD is already visible, toggle the OSD
     if (toggle_mode()) {
       set_toggle_mode(false);
       // If timeout is disabled, timer hadn't been started
@@ -377,11 +439,6 @@ void OSDPretty::ShowMessage(const QString &summary, const QString &message, cons
       }
       hide();
     }
-    else {
-      if (!disable_duration()) {
-        timeout_->start();  // Restart the timer
-      }
-    }
   }
   else {
     if (toggle_mode()) {
@@ -393,6 +450,16 @@ void OSDPretty::ShowMessage(const QString &summary, const QString &message, cons
 
 }
 
+void OSDPretty::ShowPendingMessage() {
+
+  if (!message_pending_) return;
+
+  message_pending_ = false;
+  SetMessage(pending_summary_, pending_message_, pending_image_);
+  pending_image_ = QImage();
+
+}
+
 void OSDPretty::setVisible(bool visible) {
 
   if (!visible && fading_enabled_ && fader_->direction() == QTimeLine::Forward) {
@@ -571,11 +638,13 @@ QPoint OSDPretty::current_pos() const {
 
 void OSDPretty::set_background_color(const QRgb color) {
   background_color_ = color;
+  frame_ = QPixmap();
   if (isVisible()) update();
 }
 
 void OSDPretty::set_background_opacity(const qreal opacity) {
   background_opacity_ = opacity;
+  frame_ = QPixmap();
   if (isVisible()) update();
 }
 
@@ -130,10 +130,13 @@ class OSDPretty : public QWidget {
   void Load();
 
   QRect BoxBorder() const;
+  // Draws the shadow, background and border, which are the same for every message.
+  QPixmap RenderFrame(const qreal device_pixel_ratio) const;
 
  private slots:
   void FaderValueChanged(const qreal value);
   void FaderFinished();
+  void ShowPendingMessage();
   void ScreenAdded(QScreen *screen);
   void ScreenRemoved(QScreen *screen);
 
@@ -157,6 +160,7 @@ class OSDPretty : public QWidget {
   QPixmap shadow_edge_[4];
   QPixmap shadow_corner_[4];
   QPixmap background_;
+  QPixmap frame_;
 
   // For dragging the OSD
   QPoint original_window_pos_;
@@ -165,6 +169,17 @@ class OSDPretty : public QWidget {
   // For timeout of notification
   QTimer *timeout_;
 
+  // For coalescing messages, the last message that arrived while the OSD was updated recently
+  QTimer *message_timer_;
+  bool message_pending_;
+  QString pending_summary_;
+  QString pending_message_;
+  QImage pending_image_;
+
+  // The image the icon was scaled from
+  qint64 icon_cache_key_;
+  qreal icon_device_pixel_ratio_;
+
   // For fading
   bool fading_enabled_;
   QTimeLine *fader_;
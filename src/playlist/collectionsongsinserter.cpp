@@ -0,0 +1,192 @@
+/*
+ * Strawberry Music Player
+ *
+ * Strawberry is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Strawberry is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Strawberry.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+
+#include "config.h"
+
+#include <utility>
+
+#include <QtConcurrent>
+#include <QFuture>
+#include <QFutureWatcher>
+#include <QMutexLocker>
+#include <QSqlDatabase>
+
+#include "core/shared_ptr.h"
+#include "core/database.h"
+#include "core/taskmanager.h"
+#include "collection/collectionbackend.h"
+#include "collection/collectionquery.h"
+#include "collection/collectionqueryoptions.h"
+#include "playlist.h"
+#include "songmimedata.h"
+#include "collectionsongsinserter.h"
+
+namespace {
+constexpr int kChunkSize = 500;
+}
+
+CollectionSongsInserter::CollectionSongsInserter(SharedPtr<TaskManager> task_manager, QObject *parent)
+    : QObject(parent),
+      task_manager_(task_manager),
+      destination_(nullptr),
+      row_(-1),
+      play_now_(true),
+      enqueue_(false),
+      enqueue_next_(false),
+      abort_(false),
+      task_id_(0) {}
+
+void CollectionSongsInserter::Load(Playlist *destination, const int row, const bool play_now, const bool enqueue, const bool enqueue_next, const SongMimeData *data) {
+
+  destination_ = destination;
+  row_ = row;
+  play_now_ = play_now;
+  enqueue_ = enqueue;
+  enqueue_next_ = enqueue_next;
+
+  backend_ = data->backend;
+  filter_options_ = data->filter_options;
+  songs_ = data->songs;
+  queries_ = data->queries;
+
+  QObject::connect(destination, &Playlist::destroyed, this, &CollectionSongsInserter::DestinationDestroyed);
+  QObject::connect(this, &CollectionSongsInserter::SongsLoaded, this, &CollectionSongsInserter::InsertSongs);
+
+  task_id_ = task_manager_->StartTask(tr("Loading tracks"));
+
+  QFutureWatcher<void> *watcher = new QFutureWatcher<void>();
+  QObject::connect(watcher, &QFutureWatcher<void>::finished, this, [this, watcher]() {
+    watcher->deleteLater();
+    LoadFinished();
+  });
+#if QT_VERSION >= QT_VERSION_CHECK(6, 0, 0)
+  QFuture<void> future = QtConcurrent::run(&CollectionSongsInserter::AsyncLoad, this);
+#else
+  QFuture<void> future = QtConcurrent::run(this, &CollectionSongsInserter::AsyncLoad);
+#endif
+  watcher->setFuture(future);
+
+}
+
+void CollectionSongsInserter::DestinationDestroyed() {
+
+  destination_ = nullptr;
+  abort_ = true;
+
+}
+
+void CollectionSongsInserter::AsyncLoad() {
+
+  // Songs that were already loaded in the collection model go between the queried ones, so keep the order of the selection.
+  SongList chunk;
+  int position = 0;
+  int progress = 0;
+  for (const SongMimeData::Query &query : std::as_const(queries_)) {
+    for (; position < query.position && position < songs_.count(); ++position) {
+      AppendSong(songs_[position], &chunk);
+    }
+    if (abort_) break;
+    QuerySongs(query.query_options, &chunk);
+    task_manager_->SetTaskProgress(task_id_, ++progress, static_cast<int>(queries_.count()));
+  }
+
+  if (!abort_) {
+    for (; position < songs_.count(); ++position) {
+      AppendSong(songs_[position], &chunk);
+    }
+  }
+
+  if (!chunk.isEmpty()) {
+    emit SongsLoaded(chunk);
+  }
+
+  backend_->db()->Close();
+
+}
+
+void CollectionSongsInserter::QuerySongs(const CollectionQueryOptions &query_options, SongList *chunk) {
+
+  QMutexLocker l(backend_->db()->ReadMutex());
+  QSqlDatabase db(backend_->db()->ReadConnection());
+
+  CollectionQuery q(db, backend_->songs_table(), backend_->fts_table(), filter_options_);
+  q.SetColumnSpec(query_options.column_spec());
+  for (const CollectionQueryOptions::Where &where_clauses : query_options.where_clauses()) {
+    q.AddWhere(where_clauses.column, where_clauses.value, where_clauses.op);
+  }
+  if (query_options.compilation_requirement() != CollectionQueryOptions::CompilationRequirement::None) {
+    q.AddCompilationRequirement(query_options.compilation_requirement() == CollectionQueryOptions::CompilationRequirement::On);
+  }
+  if (!query_options.order_by().isEmpty()) {
+    q.SetOrderBy(query_options.order_by());
+  }
+
+  if (!q.Exec()) {
+    backend_->db()->ReportErrors(q);
+    return;
+  }
+
+  const Song::QueryColumns columns(q.record());
+  while (!abort_ && q.Next()) {
+    Song song(backend_->source());
+    song.InitFromQuery(q, columns, true);
+    AppendSong(song, chunk);
+  }
+
+}
+
+void CollectionSongsInserter::AppendSong(const Song &song, SongList *chunk) {
+
+  if (song_ids_.contains(song.id())) return;
+  song_ids_.insert(song.id());
+
+  chunk->append(song);
+  if (chunk->count() >= kChunkSize) {
+    emit SongsLoaded(*chunk);
+    chunk->clear();
+  }
+
+}
+
+void CollectionSongsInserter::InsertSongs(const SongList &songs) {
+
+  if (!destination_) return;
+
+  if (enqueue_next_) {
+    enqueue_next_songs_ << songs;
+    return;
+  }
+
+  destination_->InsertSongsOrCollectionItems(songs, row_, play_now_, enqueue_, false);
+  play_now_ = false;
+  if (row_ >= 0) row_ += static_cast<int>(songs.count());
+
+}
+
+void CollectionSongsInserter::LoadFinished() {
+
+  if (destination_ && !enqueue_next_songs_.isEmpty()) {
+    destination_->InsertSongsOrCollectionItems(enqueue_next_songs_, row_, play_now_, enqueue_, true);
+  }
+
+  task_manager_->SetTaskFinished(task_id_);
+
+  deleteLater();
+
+}
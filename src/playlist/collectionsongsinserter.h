@@ -0,0 +1,86 @@
+/*
+ * Strawberry Music Player
+ *
+ * Strawberry is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Strawberry is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Strawberry.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+
+#ifndef COLLECTIONSONGSINSERTER_H
+#define COLLECTIONSONGSINSERTER_H
+
+#include "config.h"
+
+#include <atomic>
+
+#include <QObject>
+#include <QList>
+#include <QSet>
+
+#include "core/shared_ptr.h"
+#include "core/song.h"
+#include "collection/collectionfilteroptions.h"
+#include "songmimedata.h"
+
+class TaskManager;
+class CollectionBackendInterface;
+class Playlist;
+
+// Resolves the collection queries in a SongMimeData in a background thread, and inserts the songs into the playlist in chunks as they're returned.
+class CollectionSongsInserter : public QObject {
+  Q_OBJECT
+
+ public:
+  explicit CollectionSongsInserter(SharedPtr<TaskManager> task_manager, QObject *parent = nullptr);
+
+  void Load(Playlist *destination, const int row, const bool play_now, const bool enqueue, const bool enqueue_next, const SongMimeData *data);
+
+ signals:
+  void SongsLoaded(const SongList &songs);
+
+ private slots:
+  void DestinationDestroyed();
+  void InsertSongs(const SongList &songs);
+  void LoadFinished();
+
+ private:
+  void AsyncLoad();
+  void AppendSong(const Song &song, SongList *chunk);
+  void QuerySongs(const CollectionQueryOptions &query_options, SongList *chunk);
+
+ private:
+  SharedPtr<TaskManager> task_manager_;
+
+  Playlist *destination_;
+  int row_;
+  bool play_now_;
+  bool enqueue_;
+  bool enqueue_next_;
+
+  SharedPtr<CollectionBackendInterface> backend_;
+  CollectionFilterOptions filter_options_;
+  SongList songs_;
+  QList<SongMimeData::Query> queries_;
+
+  // Only used by the background thread.
+  QSet<int> song_ids_;
+
+  // Enqueueing next inserts each chunk at the front of the queue, so those songs are inserted all at once in the end instead.
+  SongList enqueue_next_songs_;
+
+  std::atomic_bool abort_;
+  int task_id_;
+};
+
+#endif  // COLLECTIONSONGSINSERTER_H
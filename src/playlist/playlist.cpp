@@ -29,6 +29,8 @@
 #include <unordered_map>
 #include <random>
 #include <chrono>
+#include <limits>
+#include <vector>
 
 #include <QObject>
 #include <QCoreApplication>
@@ -43,11 +45,14 @@
 #include <QMap>
 #include <QHash>
 #include <QSet>
+#include <QPair>
 #include <QMimeData>
 #include <QVariant>
 #include <QString>
 #include <QStringList>
+#include <QByteArray>
 #include <QUrl>
+#include <QThread>
 #include <QFont>
 #include <QBrush>
 #include <QUndoStack>
@@ -61,11 +66,14 @@
 #include "core/shared_ptr.h"
 #include "core/application.h"
 #include "core/logging.h"
+#include "core/taskmanager.h"
+#include "core/trace.h"
 #include "core/mimedata.h"
 #include "core/tagreaderclient.h"
 #include "core/song.h"
 #include "core/settings.h"
 #include "utilities/timeconstants.h"
+#include "utilities/collationkey.h"
 #include "collection/collection.h"
 #include "collection/collectionbackend.h"
 #include "collection/collectionplaylistitem.h"
@@ -80,6 +88,7 @@
 #include "playlistitemmimedata.h"
 #include "playlistundocommands.h"
 #include "songloaderinserter.h"
+#include "collectionsongsinserter.h"
 #include "songmimedata.h"
 #include "songplaylistitem.h"
 
@@ -110,13 +119,14 @@ const QRgb Playlist::kDynamicHistoryColor = qRgb(0x80, 0x80, 0x80);
 const char *Playlist::kSettingsGroup = "Playlist";
 
 const int Playlist::kUndoStackSize = 20;
-const int Playlist::kUndoItemLimit = 500;
 
 const qint64 Playlist::kMinScrobblePointNsecs = 31LL * kNsecPerSec;
 const qint64 Playlist::kMaxScrobblePointNsecs = 240LL * kNsecPerSec;
 
 const int Playlist::kMaxPlayedIndexes = 100;
 
+const int Playlist::kMaxChangedRanges = 50;
+
 Playlist::Playlist(SharedPtr<PlaylistBackend> backend, SharedPtr<TaskManager> task_manager, SharedPtr<CollectionBackend> collection_backend, const int id, const QString &special_type, const bool favorite, QObject *parent)
     : QAbstractListModel(parent),
       is_loading_(false),
@@ -128,6 +138,8 @@ Playlist::Playlist(SharedPtr<PlaylistBackend> backend, SharedPtr<TaskManager> ta
       collection_backend_(collection_backend),
       id_(id),
       favorite_(favorite),
+      shuffle_generator_(std::random_device()()),
+      playable_indexes_valid_(false),
       current_is_paused_(false),
       current_virtual_index_(-1),
       playlist_sequence_(nullptr),
@@ -135,6 +147,8 @@ Playlist::Playlist(SharedPtr<PlaylistBackend> backend, SharedPtr<TaskManager> ta
       undo_stack_(new QUndoStack(this)),
       special_type_(special_type),
       cancel_restore_(false),
+      restore_requested_(false),
+      restored_(false),
       scrobbled_(false),
       scrobble_point_(-1),
       editing_(-1),
@@ -147,11 +161,15 @@ Playlist::Playlist(SharedPtr<PlaylistBackend> backend, SharedPtr<TaskManager> ta
   QObject::connect(this, &Playlist::rowsInserted, this, &Playlist::PlaylistChanged);
   QObject::connect(this, &Playlist::rowsRemoved, this, &Playlist::PlaylistChanged);
 
-  Restore();
-
   filter_->setSourceModel(this);
   queue_->setSourceModel(this);
 
+  QObject::connect(filter_, &PlaylistFilter::rowsInserted, this, &Playlist::InvalidatePlayableIndexes);
+  QObject::connect(filter_, &PlaylistFilter::rowsRemoved, this, &Playlist::InvalidatePlayableIndexes);
+  QObject::connect(filter_, &PlaylistFilter::layoutChanged, this, &Playlist::InvalidatePlayableIndexes);
+  QObject::connect(filter_, &PlaylistFilter::modelReset, this, &Playlist::InvalidatePlayableIndexes);
+  QObject::connect(this, &Playlist::dataChanged, this, &Playlist::PlayableRowsChanged);
+
   QObject::connect(queue_, &Queue::rowsAboutToBeRemoved, this, &Playlist::TracksAboutToBeDequeued);
   QObject::connect(queue_, &Queue::rowsRemoved, this, &Playlist::TracksDequeued);
 
@@ -297,7 +315,7 @@ QVariant Playlist::data(const QModelIndex &idx, int role) const {
       PlaylistItemPtr item = items_[idx.row()];
       Song song = item->Metadata();
 
-      // Don't forget to change Playlist::CompareItems when adding new columns
+      // Don't forget to change MakeSortKeys when adding new columns
       switch (idx.column()) {
         case Column_Title:              return song.PrettyTitle();
         case Column_Artist:             return song.artist();
@@ -500,6 +518,64 @@ bool Playlist::FilterContainsVirtualIndex(const int i) const {
   return filter_->filterAcceptsRow(virtual_items_[i], QModelIndex());
 }
 
+bool Playlist::IsPlayableVirtualIndex(const int i) const {
+  return FilterContainsVirtualIndex(i) && !item_at(virtual_items_[i])->GetShouldSkip();
+}
+
+void Playlist::InvalidatePlayableIndexes() {
+  playable_indexes_valid_ = false;
+}
+
+void Playlist::UpdatePlayableIndexes() const {
+
+  const int count = static_cast<int>(virtual_items_.count());
+  if (playable_indexes_valid_ && next_playable_.size() == static_cast<size_t>(count) + 1) return;
+
+  playable_.assign(static_cast<size_t>(count), 0);
+  next_playable_.assign(static_cast<size_t>(count) + 1, count);
+  previous_playable_.assign(static_cast<size_t>(count), -1);
+  row_virtual_indexes_.assign(static_cast<size_t>(items_.count()), -1);
+
+  for (int i = 0; i < count; ++i) {
+    playable_[static_cast<size_t>(i)] = IsPlayableVirtualIndex(i) ? 1 : 0;
+    const int row = virtual_items_[i];
+    if (row >= 0 && row < static_cast<int>(row_virtual_indexes_.size())) {
+      row_virtual_indexes_[static_cast<size_t>(row)] = i;
+    }
+  }
+
+  int previous = -1;
+  for (int i = 0; i < count; ++i) {
+    if (playable_[static_cast<size_t>(i)]) previous = i;
+    previous_playable_[static_cast<size_t>(i)] = previous;
+  }
+  for (int i = count - 1; i >= 0; --i) {
+    next_playable_[static_cast<size_t>(i)] = playable_[static_cast<size_t>(i)] ? i : next_playable_[static_cast<size_t>(i) + 1];
+  }
+
+  playable_indexes_valid_ = true;
+
+}
+
+void Playlist::PlayableRowsChanged(const QModelIndex &top_left, const QModelIndex &bottom_right) {
+
+  if (!playable_indexes_valid_) return;
+
+  // Most changes don't change what can be played, only rebuild when one of them did.
+  for (int row = top_left.row(); row <= bottom_right.row(); ++row) {
+    if (row < 0 || row >= static_cast<int>(row_virtual_indexes_.size())) {
+      InvalidatePlayableIndexes();
+      return;
+    }
+    const int i = row_virtual_indexes_[static_cast<size_t>(row)];
+    if (i < 0 || i >= static_cast<int>(playable_.size()) || (playable_[static_cast<size_t>(i)] != 0) != IsPlayableVirtualIndex(i)) {
+      InvalidatePlayableIndexes();
+      return;
+    }
+  }
+
+}
+
 int Playlist::NextVirtualIndex(int i, const bool ignore_repeat_track) const {
 
   const PlaylistSequence::RepeatMode repeat_mode = RepeatMode();
@@ -513,28 +589,26 @@ int Playlist::NextVirtualIndex(int i, const bool ignore_repeat_track) const {
     return i;
   }
 
+  UpdatePlayableIndexes();
+  const int count = static_cast<int>(virtual_items_.count());
+
   // If we're not bothered about whether a song is on the same album then return the next virtual index, whatever it is.
   if (!album_only) {
     ++i;
 
-    // Advance i until we find any track that is in the filter, skipping the selected to be skipped
-    while (i < virtual_items_.count() && (!FilterContainsVirtualIndex(i) || item_at(virtual_items_[i])->GetShouldSkip())) {
-      ++i;
-    }
-    return i;
+    // Advance i to any track that is in the filter, skipping the selected to be skipped
+    if (i < 0) i = 0;
+    if (i >= count) return i;
+    return next_playable_[static_cast<size_t>(i)];
   }
 
   // We need to advance i until we get something else on the same album
   Song last_song = current_item_metadata();
-  for (int j = i + 1; j < virtual_items_.count(); ++j) {
-    if (item_at(virtual_items_[j])->GetShouldSkip()) {
-      continue;
-    }
+  for (int j = next_playable_[static_cast<size_t>(std::clamp(i + 1, 0, count))]; j < count; j = next_playable_[static_cast<size_t>(j) + 1]) {
     Song this_song = item_at(virtual_items_[j])->Metadata();
     if (((last_song.is_compilation() && this_song.is_compilation()) ||
          last_song.effective_albumartist() == this_song.effective_albumartist()) &&
-        last_song.album() == this_song.album() &&
-        FilterContainsVirtualIndex(j)) {
+        last_song.album() == this_song.album()) {
       return j;  // Found one
     }
   }
@@ -555,23 +629,23 @@ int Playlist::PreviousVirtualIndex(int i, const bool ignore_repeat_track) const
     return i;
   }
 
+  UpdatePlayableIndexes();
+  const int count = static_cast<int>(virtual_items_.count());
+
   // If we're not bothered about whether a song is on the same album then return the previous virtual index, whatever it is.
   if (!album_only) {
-    --i;
-
-    // Decrement i until we find any track that is in the filter
-    while (i >= 0 && (!FilterContainsVirtualIndex(i) || item_at(virtual_items_[i])->GetShouldSkip())) --i;
-    return i;
+    // Decrement i to any track that is in the filter
+    i = std::min(i - 1, count - 1);
+    if (i < 0) return i;
+    return previous_playable_[static_cast<size_t>(i)];
   }
 
   // We need to decrement i until we get something else on the same album
   Song last_song = current_item_metadata();
-  for (int j = i - 1; j >= 0; --j) {
-    if (item_at(virtual_items_[j])->GetShouldSkip()) {
-      continue;
-    }
+  const int start = std::min(i - 1, count - 1);
+  for (int j = start < 0 ? -1 : previous_playable_[static_cast<size_t>(start)]; j >= 0; j = j > 0 ? previous_playable_[static_cast<size_t>(j) - 1] : -1) {
     Song this_song = item_at(virtual_items_[j])->Metadata();
-    if (((last_song.is_compilation() && this_song.is_compilation()) || last_song.artist() == this_song.artist()) && last_song.album() == this_song.album() && FilterContainsVirtualIndex(j)) {
+    if (((last_song.is_compilation() && this_song.is_compilation()) || last_song.artist() == this_song.artist()) && last_song.album() == this_song.album()) {
       return j;  // Found one
     }
   }
@@ -614,6 +688,26 @@ int Playlist::next_row(const bool ignore_repeat_track) {
 
 }
 
+QList<int> Playlist::next_rows(const int count) const {
+
+  QList<int> rows;
+  if (count <= 0) return rows;
+
+  if (!queue_->is_empty()) {
+    rows << queue_->PeekNext();
+  }
+
+  int virtual_index = current_virtual_index_;
+  while (rows.count() < count) {
+    virtual_index = NextVirtualIndex(virtual_index, true);
+    if (virtual_index < 0 || virtual_index >= virtual_items_.count()) break;
+    rows << virtual_items_[virtual_index];
+  }
+
+  return rows;
+
+}
+
 int Playlist::previous_row(const bool ignore_repeat_track) {
 
   while (!played_indexes_.isEmpty()) {
@@ -689,6 +783,7 @@ void Playlist::set_current_row(const int i, const AutoScroll autoscroll, const b
     // Bring the one we've been asked to play to the start of the list
     virtual_items_.takeAt(virtual_items_.indexOf(i));
     virtual_items_.prepend(i);
+    InvalidatePlayableIndexes();
     current_virtual_index_ = 0;
   }
   else if (ShuffleMode() != PlaylistSequence::ShuffleMode::Off) {
@@ -750,11 +845,19 @@ void Playlist::set_current_row(const int i, const AutoScroll autoscroll, const b
 
 void Playlist::InsertDynamicItems(const int count) {
 
+  // Items that were generated ahead are inserted right away, the generator only runs for the rest.
+  const PlaylistItemPtrList items = dynamic_playlist_->TakePrefetched(count);
+  if (!items.isEmpty()) {
+    InsertItems(items);
+    dynamic_playlist_->Prefetch();
+    if (items.count() >= count) return;
+  }
+
   PlaylistGeneratorInserter *inserter = new PlaylistGeneratorInserter(task_manager_, collection_backend_, this);
   QObject::connect(inserter, &PlaylistGeneratorInserter::Error, this, &Playlist::Error);
   QObject::connect(inserter, &PlaylistGeneratorInserter::PlayRequested, this, &Playlist::PlayRequested);
 
-  inserter->Load(this, -1, false, false, false, dynamic_playlist_, count);
+  inserter->Load(this, -1, false, false, false, dynamic_playlist_, count - static_cast<int>(items.count()));
 
 }
 
@@ -801,7 +904,12 @@ bool Playlist::dropMimeData(const QMimeData *data, Qt::DropAction action, int ro
   if (const SongMimeData *song_data = qobject_cast<const SongMimeData*>(data)) {
     // Dragged from a collection
     // We want to check if these songs are from the actual local file backend, if they are we treat them differently.
-    if (song_data->backend && song_data->backend->songs_table() == QLatin1String(SCollection::kSongsTable)) {
+    if (!song_data->queries.isEmpty()) {
+      // Some containers weren't loaded, query their songs in the background.
+      CollectionSongsInserter *inserter = new CollectionSongsInserter(task_manager_);
+      inserter->Load(this, row, play_now, enqueue_now, enqueue_next_now, song_data);
+    }
+    else if (song_data->backend && song_data->backend->songs_table() == QLatin1String(SCollection::kSongsTable)) {
       InsertSongItems<CollectionPlaylistItem>(song_data->songs, row, play_now, enqueue_now, enqueue_next_now);
     }
     else {
@@ -852,14 +960,7 @@ bool Playlist::dropMimeData(const QMimeData *data, Qt::DropAction action, int ro
       items.reserve(source_rows.count());
       for (const int i : source_rows) items << source_playlist->item_at(i);
 
-      if (items.count() > kUndoItemLimit) {
-        // Too big to keep in the undo stack. Also clear the stack because it might have been invalidated.
-        InsertItemsWithoutUndo(items, row, false, false);
-        undo_stack_->clear();
-      }
-      else {
-        undo_stack_->push(new PlaylistUndoCommands::InsertItems(this, items, row));
-      }
+      undo_stack_->push(new PlaylistUndoCommands::InsertItems(this, items, row));
 
       // Remove the items from the source playlist if it was a move event
       if (action == Qt::MoveAction) {
@@ -907,11 +1008,20 @@ void Playlist::InsertSmartPlaylist(PlaylistGeneratorPtr generator, const int pos
   if (generator->is_dynamic()) {
     TurnOnDynamicPlaylist(generator);
   }
+  else if (generator->is_live()) {
+    live_playlist_ = generator;
+    ScheduleSave();
+  }
 
 }
 
 void Playlist::TurnOnDynamicPlaylist(PlaylistGeneratorPtr gen) {
 
+  Settings s;
+  s.beginGroup(kSettingsGroup);
+  gen->set_prefetch_depth(s.value("dynamic_prefetch", PlaylistGenerator::kDefaultDynamicPrefetch).toInt());
+  s.endGroup();
+
   dynamic_playlist_ = gen;
   ShuffleModeChanged(PlaylistSequence::ShuffleMode::Off);
   emit DynamicModeChanged(true);
@@ -979,6 +1089,8 @@ void Playlist::MoveItemsWithoutUndo(const QList<int> &source_rows, int pos) {
     }
   }
 
+  InvalidatePlayableIndexes();
+
   // Update current virtual index
   if (current_item_index_.isValid()) {
     current_virtual_index_ = static_cast<int>(virtual_items_.indexOf(current_item_index_.row()));
@@ -1051,6 +1163,8 @@ void Playlist::MoveItemsWithoutUndo(int start, const QList<int> &dest_rows) {
     }
   }
 
+  InvalidatePlayableIndexes();
+
   // Update current virtual index
   if (current_item_index_.isValid()) {
     current_virtual_index_ = static_cast<int>(virtual_items_.indexOf(current_item_index_.row()));
@@ -1075,14 +1189,8 @@ void Playlist::InsertItems(const PlaylistItemPtrList &itemsIn, const int pos, co
 
   const int start = pos == -1 ? static_cast<int>(items_.count()) : pos;
 
-  if (items.count() > kUndoItemLimit) {
-    // Too big to keep in the undo stack. Also clear the stack because it might have been invalidated.
-    InsertItemsWithoutUndo(items, pos, enqueue, enqueue_next);
-    undo_stack_->clear();
-  }
-  else {
-    undo_stack_->push(new PlaylistUndoCommands::InsertItems(this, items, pos, enqueue, enqueue_next));
-  }
+  // The undo commands only keep references to the items, so this is cheap for any number of items.
+  undo_stack_->push(new PlaylistUndoCommands::InsertItems(this, items, pos, enqueue, enqueue_next));
 
   if (play_now) emit PlayRequested(index(start, 0), AutoScroll::Maybe);
 
@@ -1095,11 +1203,11 @@ void Playlist::InsertItemsWithoutUndo(const PlaylistItemPtrList &items, const in
   const int start = pos == -1 ? static_cast<int>(items_.count()) : pos;
   const int end = start + static_cast<int>(items.count()) - 1;
 
+  bool current_inserted = false;
   beginInsertRows(QModelIndex(), start, end);
   for (int i = start; i <= end; ++i) {
     PlaylistItemPtr item = items[i - start];
     items_.insert(i, item);
-    virtual_items_ << static_cast<int>(virtual_items_.count());
 
     if (item->source() == Song::Source::Collection) {
       int id = item->Metadata().id();
@@ -1112,10 +1220,16 @@ void Playlist::InsertItemsWithoutUndo(const PlaylistItemPtrList &items, const in
       // It's one we removed before that got re-added through an undo
       current_item_index_ = index(i, 0);
       last_played_item_index_ = current_item_index_;
+      current_inserted = true;
     }
   }
+  InsertVirtualIndices(start, static_cast<int>(items.count()));
   endInsertRows();
 
+  if (current_inserted) {
+    current_virtual_index_ = static_cast<int>(virtual_items_.indexOf(current_item_index_.row()));
+  }
+
   if (enqueue) {
     QModelIndexList indexes;
     for (int i = start; i <= end; ++i) {
@@ -1136,8 +1250,6 @@ void Playlist::InsertItemsWithoutUndo(const PlaylistItemPtrList &items, const in
     sort(sort_column_, sort_order_);
   }
 
-  ReshuffleIndices();
-
   ScheduleSave();
 
 }
@@ -1203,54 +1315,61 @@ void Playlist::UpdateItems(SongList songs) {
 
   qLog(Debug) << "Updating playlist with new tracks' info";
 
-  // We first convert our songs list into a linked list (a 'real' list), because removals are faster with QLinkedList.
-  // Next, we walk through the list of playlist's items then the list of songs
-  // we want to update: if an item corresponds to the song (we rely on URL for this), we update the item with the new metadata,
-  // then we remove song from our list because we will not need to check it again.
+  // We first build an index of the items that can be updated by URL, since we rely on URL to find the item corresponding to a song.
+  // Next, each song updates the first item with its URL that wasn't updated yet, and the changed rows are emitted together.
   // And we also update undo actions.
 
-  for (int i = 0; i < items_.size(); i++) {
-    // Update current items list
-    QMutableListIterator<Song> it(songs);
-    while (it.hasNext()) {
-      const Song &song = it.next();
-      const PlaylistItemPtr &item = items_[i];
-      if (item->Metadata().url() == song.url() && (item->Metadata().filetype() == Song::FileType::Unknown || item->Metadata().filetype() == Song::FileType::Stream || item->Metadata().filetype() == Song::FileType::CDDA || !item->Metadata().init_from_file())) {
-        PlaylistItemPtr new_item;
-        if (song.url().isLocalFile()) {
-          if (song.is_collection_song()) {
-            new_item = make_shared<CollectionPlaylistItem>(song);
-            if (collection_items_by_id_.contains(song.id(), item)) collection_items_by_id_.remove(song.id(), item);
-            collection_items_by_id_.insert(song.id(), new_item);
-          }
-          else {
-            new_item = make_shared<SongPlaylistItem>(song);
-          }
-        }
-        else {
-          if (song.is_radio()) {
-            new_item = make_shared<RadioPlaylistItem>(song);
-          }
-          else {
-            new_item = make_shared<InternetPlaylistItem>(song);
-          }
-        }
-        items_[i] = new_item;
-        emit dataChanged(index(i, 0), index(i, ColumnCount - 1));
-        // Also update undo actions
-        for (int y = 0; y < undo_stack_->count(); y++) {
-          QUndoCommand *undo_action = const_cast<QUndoCommand*>(undo_stack_->command(i));
-          PlaylistUndoCommands::InsertItems *undo_action_insert = dynamic_cast<PlaylistUndoCommands::InsertItems*>(undo_action);
-          if (undo_action_insert) {
-            bool found_and_updated = undo_action_insert->UpdateItem(new_item);
-            if (found_and_updated) break;
-          }
-        }
-        it.remove();
-        break;
+  QHash<QUrl, QList<int>> rows_by_url;
+  for (int row = 0; row < items_.count(); ++row) {
+    const Song &metadata = items_[row]->Metadata();
+    if (metadata.filetype() == Song::FileType::Unknown || metadata.filetype() == Song::FileType::Stream || metadata.filetype() == Song::FileType::CDDA || !metadata.init_from_file()) {
+      rows_by_url[metadata.url()] << row;
+    }
+  }
+  if (rows_by_url.isEmpty()) return;
+
+  QList<int> changed_rows;
+  QHash<QUrl, PlaylistItemPtr> new_items;
+  for (const Song &song : std::as_const(songs)) {
+    auto rows = rows_by_url.find(song.url());
+    if (rows == rows_by_url.end() || rows.value().isEmpty()) continue;
+    const int row = rows.value().takeFirst();
+    const PlaylistItemPtr &item = items_[row];
+    PlaylistItemPtr new_item;
+    if (song.url().isLocalFile()) {
+      if (song.is_collection_song()) {
+        new_item = make_shared<CollectionPlaylistItem>(song);
+        if (collection_items_by_id_.contains(song.id(), item)) collection_items_by_id_.remove(song.id(), item);
+        collection_items_by_id_.insert(song.id(), new_item);
+      }
+      else {
+        new_item = make_shared<SongPlaylistItem>(song);
       }
     }
+    else {
+      if (song.is_radio()) {
+        new_item = make_shared<RadioPlaylistItem>(song);
+      }
+      else {
+        new_item = make_shared<InternetPlaylistItem>(song);
+      }
+    }
+    items_[row] = new_item;
+    new_items.insert(song.url(), new_item);
+    changed_rows << row;
   }
+  if (changed_rows.isEmpty()) return;
+
+  // Also update undo actions
+  for (int i = 0; i < undo_stack_->count() && !new_items.isEmpty(); ++i) {
+    QUndoCommand *undo_action = const_cast<QUndoCommand*>(undo_stack_->command(i));
+    PlaylistUndoCommands::InsertItems *undo_action_insert = dynamic_cast<PlaylistUndoCommands::InsertItems*>(undo_action);
+    if (undo_action_insert) {
+      undo_action_insert->UpdateItems(&new_items);
+    }
+  }
+
+  RowsChanged(changed_rows);
 
   emit PlaylistChanged();
 
@@ -1298,77 +1417,246 @@ QMimeData *Playlist::mimeData(const QModelIndexList &indexes) const {
 
 }
 
-bool Playlist::CompareItems(const int column, const Qt::SortOrder order, PlaylistItemPtr _a, PlaylistItemPtr _b) {
+namespace {
 
-  PlaylistItemPtr a = order == Qt::AscendingOrder ? _a : _b;
-  PlaylistItemPtr b = order == Qt::AscendingOrder ? _b : _a;
+// Sorting by a full path sorts by the depth of the path first.
+constexpr int kPathDepthSortColumn = -1;
+
+constexpr int kMinItemsPerThread = 5000;
+
+// A sort column converted once for every item, so comparing doesn't copy the metadata and create strings.
+struct SortKeys {
+  enum class Type {
+    Integer,
+    Real,
+    String,
+    Collated
+  };
+  SortKeys() : type(Type::Integer), order(Qt::AscendingOrder) {}
+
+  int Compare(const int a, const int b) const {
+    switch (type) {
+      case Type::Integer:  return integers[a] < integers[b] ? -1 : (integers[a] > integers[b] ? 1 : 0);
+      case Type::Real:     return reals[a] < reals[b] ? -1 : (reals[a] > reals[b] ? 1 : 0);
+      case Type::String:   return strings[a] < strings[b] ? -1 : (strings[a] > strings[b] ? 1 : 0);
+      case Type::Collated: return collated[a] < collated[b] ? -1 : (collated[a] > collated[b] ? 1 : 0);
+    }
+    return 0;
+  }
+
+  Type type;
+  Qt::SortOrder order;
+  std::vector<qint64> integers;
+  std::vector<double> reals;
+  std::vector<QString> strings;
+  std::vector<QByteArray> collated;
+};
 
-#define cmp(field) return a->Metadata().field() < b->Metadata().field()
-#define strcmp(field) return QString::localeAwareCompare(a->Metadata().field().toLower(), b->Metadata().field().toLower()) < 0;
+using ItemRange = QPair<int, int>;
 
-  switch (column) {
+// Splits the items in one range for each thread, so every thread gets a big enough part to be worth it.
+QList<ItemRange> SplitItems(const int count) {
+
+  const int threads = std::max(1, std::min(QThread::idealThreadCount(), count / kMinItemsPerThread));
+  const int chunk_size = std::max(1, (count + threads - 1) / threads);
+
+  QList<ItemRange> ranges;
+  for (int start = 0; start < count; start += chunk_size) {
+    ranges << qMakePair(start, std::min(count, start + chunk_size));
+  }
 
-    case Column_Title:        strcmp(title_sortable);
-    case Column_Artist:       strcmp(artist_sortable);
-    case Column_Album:        strcmp(album_sortable);
-    case Column_Length:       cmp(length_nanosec);
-    case Column_Track:        cmp(track);
-    case Column_Disc:         cmp(disc);
-    case Column_Year:         cmp(year);
-    case Column_OriginalYear: cmp(effective_originalyear);
-    case Column_Genre:        strcmp(genre);
-    case Column_AlbumArtist:  strcmp(playlist_albumartist_sortable);
-    case Column_Composer:     strcmp(composer);
-    case Column_Performer:    strcmp(performer);
-    case Column_Grouping:     strcmp(grouping);
+  return ranges;
 
-    case Column_PlayCount:    cmp(playcount);
-    case Column_SkipCount:    cmp(skipcount);
-    case Column_LastPlayed:   cmp(lastplayed);
+}
 
-    case Column_Bitrate:      cmp(bitrate);
-    case Column_Samplerate:   cmp(samplerate);
-    case Column_Bitdepth:     cmp(bitdepth);
-    case Column_Filename:
-      return (QString::localeAwareCompare(a->Url().path().toLower(), b->Url().path().toLower()) < 0);
-    case Column_BaseFilename: cmp(basefilename);
-    case Column_Filesize:     cmp(filesize);
-    case Column_Filetype:     cmp(filetype);
-    case Column_DateModified: cmp(mtime);
-    case Column_DateCreated:  cmp(ctime);
+// Calls the function with the start and end of each range of the items, in parallel when there are enough of them.
+template<typename F>
+void ForEachRange(QList<ItemRange> &ranges, F function) {
 
-    case Column_Comment:      strcmp(comment);
-    case Column_Source:       cmp(source);
+  if (ranges.count() == 1) {
+    function(ranges.first().first, ranges.first().second);
+  }
+  else if (ranges.count() > 1) {
+    QtConcurrent::blockingMap(ranges, [&function](const ItemRange &range) { function(range.first, range.second); });
+  }
 
-    case Column_Rating:       cmp(rating);
+}
 
-    case Column_HasCUE:       cmp(has_cue);
+SortKeys MakeSortKeys(const int column, const Qt::SortOrder order, const PlaylistItemPtrList &items, const int first) {
 
-    case Column_EBUR128IntegratedLoudness: cmp(ebur128_integrated_loudness_lufs);
-    case Column_EBUR128LoudnessRange: cmp(ebur128_loudness_range_lu);
+  SortKeys keys;
+  keys.order = order;
+
+  const int count = static_cast<int>(items.count()) - first;
+
+  switch (column) {
+    case Playlist::Column_Title:
+    case Playlist::Column_Artist:
+    case Playlist::Column_Album:
+    case Playlist::Column_Genre:
+    case Playlist::Column_AlbumArtist:
+    case Playlist::Column_Composer:
+    case Playlist::Column_Performer:
+    case Playlist::Column_Grouping:
+    case Playlist::Column_Comment:
+    case Playlist::Column_Filename:
+      keys.type = SortKeys::Type::Collated;
+      keys.collated.resize(static_cast<size_t>(count));
+      break;
+    case Playlist::Column_BaseFilename:
+      keys.type = SortKeys::Type::String;
+      keys.strings.resize(static_cast<size_t>(count));
+      break;
+    case Playlist::Column_Rating:
+    case Playlist::Column_EBUR128IntegratedLoudness:
+    case Playlist::Column_EBUR128LoudnessRange:
+      keys.type = SortKeys::Type::Real;
+      keys.reals.resize(static_cast<size_t>(count));
+      break;
+    default:
+      keys.type = SortKeys::Type::Integer;
+      keys.integers.resize(static_cast<size_t>(count), 0);
+      break;
+  }
 
-    default: qLog(Error) << "No such column" << column;
+  switch (column) {
+    case kPathDepthSortColumn:
+    case Playlist::Column_Title:
+    case Playlist::Column_Artist:
+    case Playlist::Column_Album:
+    case Playlist::Column_Length:
+    case Playlist::Column_Track:
+    case Playlist::Column_Disc:
+    case Playlist::Column_Year:
+    case Playlist::Column_OriginalYear:
+    case Playlist::Column_Genre:
+    case Playlist::Column_AlbumArtist:
+    case Playlist::Column_Composer:
+    case Playlist::Column_Performer:
+    case Playlist::Column_Grouping:
+    case Playlist::Column_PlayCount:
+    case Playlist::Column_SkipCount:
+    case Playlist::Column_LastPlayed:
+    case Playlist::Column_Bitrate:
+    case Playlist::Column_Samplerate:
+    case Playlist::Column_Bitdepth:
+    case Playlist::Column_Filename:
+    case Playlist::Column_BaseFilename:
+    case Playlist::Column_Filesize:
+    case Playlist::Column_Filetype:
+    case Playlist::Column_DateModified:
+    case Playlist::Column_DateCreated:
+    case Playlist::Column_Comment:
+    case Playlist::Column_Source:
+    case Playlist::Column_Rating:
+    case Playlist::Column_HasCUE:
+    case Playlist::Column_EBUR128IntegratedLoudness:
+    case Playlist::Column_EBUR128LoudnessRange:
+      break;
+    default:
+      qLog(Error) << "No such column" << column;
+      return keys;
   }
 
-#undef cmp
-#undef strcmp
+  // Missing loudness values sort before all others.
+  const double no_value = -std::numeric_limits<double>::infinity();
 
-  return false;
+  QList<ItemRange> ranges = SplitItems(count);
+  ForEachRange(ranges, [column, first, &items, &keys, no_value](const int start, const int end) {
+    for (int i = start; i < end; ++i) {
+      const PlaylistItemPtr &item = items[first + i];
+      const size_t key = static_cast<size_t>(i);
+      if (column == kPathDepthSortColumn) {
+        keys.integers[key] = item->Url().path().count(QLatin1Char('/'));
+        continue;
+      }
+      if (column == Playlist::Column_Filename) {
+        keys.collated[key] = Utilities::CollationKey(item->Url().path().toLower());
+        continue;
+      }
+      const Song song = item->Metadata();
+      switch (column) {
+        case Playlist::Column_Title:        keys.collated[key] = Utilities::CollationKey(song.title_sortable().toLower()); break;
+        case Playlist::Column_Artist:       keys.collated[key] = Utilities::CollationKey(song.artist_sortable().toLower()); break;
+        case Playlist::Column_Album:        keys.collated[key] = Utilities::CollationKey(song.album_sortable().toLower()); break;
+        case Playlist::Column_Length:       keys.integers[key] = song.length_nanosec(); break;
+        case Playlist::Column_Track:        keys.integers[key] = song.track(); break;
+        case Playlist::Column_Disc:         keys.integers[key] = song.disc(); break;
+        case Playlist::Column_Year:         keys.integers[key] = song.year(); break;
+        case Playlist::Column_OriginalYear: keys.integers[key] = song.effective_originalyear(); break;
+        case Playlist::Column_Genre:        keys.collated[key] = Utilities::CollationKey(song.genre().toLower()); break;
+        case Playlist::Column_AlbumArtist:  keys.collated[key] = Utilities::CollationKey(song.playlist_albumartist_sortable().toLower()); break;
+        case Playlist::Column_Composer:     keys.collated[key] = Utilities::CollationKey(song.composer().toLower()); break;
+        case Playlist::Column_Performer:    keys.collated[key] = Utilities::CollationKey(song.performer().toLower()); break;
+        case Playlist::Column_Grouping:     keys.collated[key] = Utilities::CollationKey(song.grouping().toLower()); break;
+
+        case Playlist::Column_PlayCount:    keys.integers[key] = song.playcount(); break;
+        case Playlist::Column_SkipCount:    keys.integers[key] = song.skipcount(); break;
+        case Playlist::Column_LastPlayed:   keys.integers[key] = song.lastplayed(); break;
+
+        case Playlist::Column_Bitrate:      keys.integers[key] = song.bitrate(); break;
+        case Playlist::Column_Samplerate:   keys.integers[key] = song.samplerate(); break;
+        case Playlist::Column_Bitdepth:     keys.integers[key] = song.bitdepth(); break;
+        case Playlist::Column_BaseFilename: keys.strings[key] = song.basefilename(); break;
+        case Playlist::Column_Filesize:     keys.integers[key] = song.filesize(); break;
+        case Playlist::Column_Filetype:     keys.integers[key] = static_cast<qint64>(song.filetype()); break;
+        case Playlist::Column_DateModified: keys.integers[key] = song.mtime(); break;
+        case Playlist::Column_DateCreated:  keys.integers[key] = song.ctime(); break;
+
+        case Playlist::Column_Comment:      keys.collated[key] = Utilities::CollationKey(song.comment().toLower()); break;
+        case Playlist::Column_Source:       keys.integers[key] = static_cast<qint64>(song.source()); break;
+
+        case Playlist::Column_Rating:       keys.reals[key] = song.rating(); break;
+
+        case Playlist::Column_HasCUE:       keys.integers[key] = song.has_cue() ? 1 : 0; break;
+
+        case Playlist::Column_EBUR128IntegratedLoudness: keys.reals[key] = song.ebur128_integrated_loudness_lufs().value_or(no_value); break;
+        case Playlist::Column_EBUR128LoudnessRange: keys.reals[key] = song.ebur128_loudness_range_lu().value_or(no_value); break;
+
+        default: break;
+      }
+    }
+  });
+
+  return keys;
 
 }
 
-bool Playlist::ComparePathDepths(const Qt::SortOrder order, PlaylistItemPtr _a, PlaylistItemPtr _b) {
+// Stable sorts chunks of the rows in parallel and merges them.
+void StableSortRows(std::vector<int> *rows, const QList<SortKeys> &keys) {
 
-  PlaylistItemPtr a = order == Qt::AscendingOrder ? _a : _b;
-  PlaylistItemPtr b = order == Qt::AscendingOrder ? _b : _a;
+  auto less = [&keys](const int a, const int b) {
+    for (const SortKeys &column_keys : keys) {
+      const int ret = column_keys.Compare(a, b);
+      if (ret != 0) return column_keys.order == Qt::AscendingOrder ? ret < 0 : ret > 0;
+    }
+    return false;
+  };
 
-  qint64 a_dir_level = a->Url().path().count(QLatin1Char('/'));
-  qint64 b_dir_level = b->Url().path().count(QLatin1Char('/'));
+  QList<ItemRange> ranges = SplitItems(static_cast<int>(rows->size()));
+  ForEachRange(ranges, [rows, &less](const int start, const int end) {
+    std::stable_sort(rows->begin() + start, rows->begin() + end, less);
+  });
 
-  return a_dir_level < b_dir_level;
+  // Merge neighbouring ranges until there's one left, the left range comes first on ties so the order stays stable.
+  while (ranges.count() > 1) {
+    QList<ItemRange> merged;
+    QList<int> merges;
+    for (int i = 0; i + 1 < ranges.count(); i += 2) {
+      merged << qMakePair(ranges[i].first, ranges[i + 1].second);
+      merges << i;
+    }
+    if (ranges.count() % 2 == 1) merged << ranges.last();
+    QtConcurrent::blockingMap(merges, [rows, &ranges, &less](const int i) {
+      std::inplace_merge(rows->begin() + ranges[i].first, rows->begin() + ranges[i].second, rows->begin() + ranges[i + 1].second, less);
+    });
+    ranges = merged;
+  }
 
 }
 
+}  // namespace
+
 QString Playlist::column_name(Column column) {
 
   switch (column) {
@@ -1440,28 +1728,56 @@ void Playlist::sort(int column, Qt::SortOrder order) {
 
   if (ignore_sorting_) return;
 
-  PlaylistItemPtrList new_items(items_);
-  PlaylistItemPtrList::iterator begin = new_items.begin();
+  SortByColumns(QList<SortSpec>() << SortSpec(column, order));
 
-  if (dynamic_playlist_ && current_item_index_.isValid())
-    begin += current_item_index_.row() + 1;
+}
+
+void Playlist::SortByColumns(const QList<SortSpec> &sorting) {
 
-  if (column == Column_Album) {
-    // When sorting by album, also take into account discs and tracks.
-    std::stable_sort(begin, new_items.end(), std::bind(&Playlist::CompareItems, Column_Track, order, std::placeholders::_1, std::placeholders::_2));
-    std::stable_sort(begin, new_items.end(), std::bind(&Playlist::CompareItems, Column_Disc, order, std::placeholders::_1, std::placeholders::_2));
-    std::stable_sort(begin, new_items.end(), std::bind(&Playlist::CompareItems, Column_Album, order, std::placeholders::_1, std::placeholders::_2));
+  if (sorting.isEmpty()) return;
+
+  int first = 0;
+  if (dynamic_playlist_ && current_item_index_.isValid()) {
+    first = current_item_index_.row() + 1;
   }
-  else if (column == Column_Filename) {
-    // When sorting by full paths we also expect a hierarchical order. This returns a breath-first ordering of paths.
-    std::stable_sort(begin, new_items.end(), std::bind(&Playlist::CompareItems, Column_Filename, order, std::placeholders::_1, std::placeholders::_2));
-    std::stable_sort(begin, new_items.end(), std::bind(&Playlist::ComparePathDepths, order, std::placeholders::_1, std::placeholders::_2));
+
+  const int count = static_cast<int>(items_.count()) - first;
+  if (count <= 0) return;
+
+  QList<SortKeys> keys;
+  for (const SortSpec &spec : sorting) {
+    if (spec.first == Column_Album) {
+      // When sorting by album, also take into account discs and tracks.
+      keys << MakeSortKeys(Column_Album, spec.second, items_, first);
+      keys << MakeSortKeys(Column_Disc, spec.second, items_, first);
+      keys << MakeSortKeys(Column_Track, spec.second, items_, first);
+    }
+    else if (spec.first == Column_Filename) {
+      // When sorting by full paths we also expect a hierarchical order. This returns a breath-first ordering of paths.
+      keys << MakeSortKeys(kPathDepthSortColumn, spec.second, items_, first);
+      keys << MakeSortKeys(Column_Filename, spec.second, items_, first);
+    }
+    else {
+      keys << MakeSortKeys(spec.first, spec.second, items_, first);
+    }
   }
-  else {
-    std::stable_sort(begin, new_items.end(), std::bind(&Playlist::CompareItems, column, order, std::placeholders::_1, std::placeholders::_2));
+
+  std::vector<int> rows(static_cast<size_t>(count));
+  for (int i = 0; i < count; ++i) {
+    rows[static_cast<size_t>(i)] = i;
   }
+  StableSortRows(&rows, keys);
 
-  undo_stack_->push(new PlaylistUndoCommands::SortItems(this, column, order, new_items));
+  PlaylistItemPtrList new_items;
+  new_items.reserve(items_.count());
+  for (int i = 0; i < first; ++i) {
+    new_items << items_[i];
+  }
+  for (const int row : rows) {
+    new_items << items_[first + row];
+  }
+
+  undo_stack_->push(new PlaylistUndoCommands::SortItems(this, sorting.first().first, sorting.first().second, new_items));
 
 }
 
@@ -1490,6 +1806,8 @@ void Playlist::ReOrderWithoutUndo(const PlaylistItemPtrList &new_items) {
     }
   }
 
+  InvalidatePlayableIndexes();
+
   // Update current virtual index
   if (current_item_index_.isValid()) {
     current_virtual_index_ = static_cast<int>(virtual_items_.indexOf(current_item_index_.row()));
@@ -1539,6 +1857,9 @@ void Playlist::ScheduleSave() {
 
   if (!backend_ || is_loading_) return;
 
+  // Saving before the saved items are loaded would lose them.
+  RestoreIfNeeded();
+
   timer_save_->start();
 
 }
@@ -1547,7 +1868,13 @@ void Playlist::Save() {
 
   if (!backend_ || is_loading_) return;
 
-  backend_->SavePlaylistAsync(id_, items_, last_played_row(), dynamic_playlist_);
+  if (!restored_) {
+    timer_save_->start();
+    return;
+  }
+
+  // A live smart playlist is saved like a dynamic one, the generator knows which mode it's in.
+  backend_->SavePlaylistAsync(id_, items_, last_played_row(), dynamic_playlist_ ? dynamic_playlist_ : live_playlist_);
 
 }
 
@@ -1555,28 +1882,73 @@ void Playlist::Restore() {
 
   if (!backend_) return;
 
-  items_.clear();
-  virtual_items_.clear();
-  collection_items_by_id_.clear();
-
+  // Items added before the playlist was restored are kept after the restored ones.
+  restore_requested_ = true;
   cancel_restore_ = false;
-#if QT_VERSION >= QT_VERSION_CHECK(6, 0, 0)
-  QFuture<PlaylistItemPtrList> future = QtConcurrent::run(&PlaylistBackend::GetPlaylistItems, backend_, id_);
-#else
-  QFuture<PlaylistItemPtrList> future = QtConcurrent::run(&*backend_, &PlaylistBackend::GetPlaylistItems, id_);
-#endif
+  // The playlists are shown at startup, so they're loaded before any background jobs.
+  SharedPtr<PlaylistBackend> backend = backend_;
+  const int id = id_;
+  QFuture<PlaylistItemPtrList> future = task_manager_->Run(TaskManager::Pool::IO, TaskManager::Priority::High, [backend, id]() { return backend->GetPlaylistItems(id); });
   QFutureWatcher<PlaylistItemPtrList> *watcher = new QFutureWatcher<PlaylistItemPtrList>();
   QObject::connect(watcher, &QFutureWatcher<PlaylistItemPtrList>::finished, this, &Playlist::ItemsLoaded);
   watcher->setFuture(future);
 
 }
 
+void Playlist::RestoreIfNeeded() {
+
+  if (restore_requested_) return;
+
+  Restore();
+
+}
+
+bool Playlist::Unload() {
+
+  // Playlists with changes that weren't saved yet, or that are playing, queued, edited or dynamic are kept.
+  if (!backend_ || !restored_ || is_loading_ || timer_save_->isActive() || current_item_index_.isValid() || !queue_->is_empty() || editing_ != -1 || dynamic_playlist_) {
+    return false;
+  }
+
+  // Resetting is much cheaper than removing all rows, the persistent indexes that refer to the items are invalidated.
+  beginResetModel();
+  items_.clear();
+  virtual_items_.clear();
+  collection_items_by_id_.clear();
+  album_shuffle_positions_.clear();
+  played_indexes_.clear();
+  current_virtual_index_ = -1;
+  endResetModel();
+
+  InvalidatePlayableIndexes();
+  playable_.clear();
+  playable_.shrink_to_fit();
+  next_playable_.clear();
+  next_playable_.shrink_to_fit();
+  previous_playable_.clear();
+  previous_playable_.shrink_to_fit();
+  row_virtual_indexes_.clear();
+  row_virtual_indexes_.shrink_to_fit();
+
+  undo_stack_->clear();
+
+  restore_requested_ = false;
+  restored_ = false;
+
+  return true;
+
+}
+
 void Playlist::ItemsLoaded() {
 
+  TRACE_SCOPE("playlist", "Playlist::ItemsLoaded");
+
   QFutureWatcher<PlaylistItemPtrList> *watcher = static_cast<QFutureWatcher<PlaylistItemPtrList>*>(sender());
   PlaylistItemPtrList items = watcher->result();
   watcher->deleteLater();
 
+  restored_ = true;
+
   if (cancel_restore_) return;
 
   // Backend returns empty elements for collection items which it couldn't match (because they got deleted); we don't need those
@@ -1608,7 +1980,13 @@ void Playlist::ItemsLoaded() {
       if (backend) {
         gen->set_collection_backend(collection_backend_);
         gen->Load(p.dynamic_data);
-        TurnOnDynamicPlaylist(gen);
+        if (gen->is_live() && !gen->is_dynamic()) {
+          live_playlist_ = gen;
+        }
+        else {
+          TurnOnDynamicPlaylist(gen);
+          gen->Prefetch();
+        }
       }
 
     }
@@ -1665,14 +2043,7 @@ bool Playlist::removeRows(int row, int count, const QModelIndex &parent) {
     return false;
   }
 
-  if (count > kUndoItemLimit) {
-    // Too big to keep in the undo stack. Also clear the stack because it might have been invalidated.
-    RemoveItemsWithoutUndo(row, count);
-    undo_stack_->clear();
-  }
-  else {
-    undo_stack_->push(new PlaylistUndoCommands::RemoveItems(this, row, count));
-  }
+  undo_stack_->push(new PlaylistUndoCommands::RemoveItems(this, row, count));
 
   return true;
 
@@ -1744,6 +2115,8 @@ PlaylistItemPtrList Playlist::RemoveItemsWithoutUndo(const int row, const int co
 
   Q_ASSERT(items_.count() == virtual_items_.count());
 
+  InvalidatePlayableIndexes();
+
   // Update current virtual index
   if (current_item_index_.isValid()) {
     current_virtual_index_ = static_cast<int>(virtual_items_.indexOf(current_item_index_.row()));
@@ -1841,18 +2214,18 @@ void Playlist::Clear() {
   // If loading songs from session restore async, don't insert them
   cancel_restore_ = true;
 
+  // The saved items are replaced, so there's nothing left to restore.
+  if (!restore_requested_) {
+    restore_requested_ = true;
+    restored_ = true;
+  }
+
   const int count = static_cast<int>(items_.count());
 
-  if (count > kUndoItemLimit) {
-    // Too big to keep in the undo stack. Also clear the stack because it might have been invalidated.
-    RemoveItemsWithoutUndo(0, count);
-    undo_stack_->clear();
-  }
-  else {
-    undo_stack_->push(new PlaylistUndoCommands::RemoveItems(this, 0, count));
-  }
+  undo_stack_->push(new PlaylistUndoCommands::RemoveItems(this, 0, count));
 
   TurnOffDynamicPlaylist();
+  live_playlist_.reset();
 
   ScheduleSave();
 
@@ -1867,6 +2240,60 @@ void Playlist::RepopulateDynamicPlaylist() {
 
 }
 
+void Playlist::UpdateLiveSongs(const SongList &songs) {
+
+  if (!live_playlist_ || !restored_) return;
+
+  const int limit = live_playlist_->live_limit();
+
+  PlaylistItemPtrList new_items;
+  QList<int> rows_to_remove;
+  for (const Song &song : songs) {
+    const PlaylistItemPtrList items = collection_items_by_id(song.id());
+    if (live_playlist_->Matches(song)) {
+      if (items.isEmpty() && (limit < 0 || items_.count() + new_items.count() < limit)) {
+        new_items << PlaylistItem::NewFromSong(song);
+      }
+    }
+    else {
+      for (const PlaylistItemPtr &item : items) {
+        const int row = static_cast<int>(items_.indexOf(item));
+        // The song that's playing is left alone.
+        if (row != -1 && row != current_row()) rows_to_remove << row;
+      }
+    }
+  }
+
+  if (rows_to_remove.isEmpty() && new_items.isEmpty()) return;
+
+  // The undo stack is only for the user's changes.
+  if (!rows_to_remove.isEmpty()) RemoveItemsWithoutUndo(rows_to_remove);
+  if (!new_items.isEmpty()) InsertItemsWithoutUndo(new_items, -1);
+
+  ScheduleSave();
+
+}
+
+void Playlist::RemoveLiveSongs(const SongList &songs) {
+
+  if (!live_playlist_ || !restored_) return;
+
+  QList<int> rows_to_remove;
+  for (const Song &song : songs) {
+    const PlaylistItemPtrList items = collection_items_by_id(song.id());
+    for (const PlaylistItemPtr &item : items) {
+      const int row = static_cast<int>(items_.indexOf(item));
+      if (row != -1 && row != current_row()) rows_to_remove << row;
+    }
+  }
+
+  if (rows_to_remove.isEmpty()) return;
+
+  RemoveItemsWithoutUndo(rows_to_remove);
+  ScheduleSave();
+
+}
+
 void Playlist::ExpandDynamicPlaylist() {
 
   if (!dynamic_playlist_) return;
@@ -1956,20 +2383,6 @@ void Playlist::Shuffle() {
 
 }
 
-namespace {
-
-bool AlbumShuffleComparator(const QMap<QString, int> &album_key_positions, const QMap<int, QString> &album_keys, const int left, const int right) {
-
-  const int left_pos = album_key_positions[album_keys[left]];
-  const int right_pos = album_key_positions[album_keys[right]];
-
-  if (left_pos == right_pos) return left < right;
-  return left_pos < right_pos;
-
-}
-
-}  // namespace
-
 void Playlist::ReshuffleIndices() {
 
   const PlaylistSequence::ShuffleMode shuffle_mode = ShuffleMode();
@@ -1982,27 +2395,26 @@ void Playlist::ReshuffleIndices() {
 
     case PlaylistSequence::ShuffleMode::All:
     case PlaylistSequence::ShuffleMode::InsideAlbum:{
-      std::random_device rd;
-      std::shuffle(virtual_items_.begin(), virtual_items_.end(), std::mt19937(rd()));
+      std::shuffle(virtual_items_.begin(), virtual_items_.end(), shuffle_generator_);
       break;
     }
 
     case PlaylistSequence::ShuffleMode::Albums:{
-      QMap<int, QString> album_keys;  // real index -> key
-      QSet<QString> album_key_set;    // unique keys
-
       // Find all the unique albums in the playlist
-      for (QList<int>::const_iterator it = virtual_items_.constBegin(); it != virtual_items_.constEnd(); ++it) {
-        const int index = *it;
+      std::vector<QString> album_keys(static_cast<size_t>(items_.count()));  // real index -> key
+      QStringList shuffled_album_keys;
+      QSet<QString> album_key_set;
+      for (const int index : std::as_const(virtual_items_)) {
         const QString key = items_[index]->Metadata().AlbumKey();
-        album_keys[index] = key;
-        album_key_set << key;
+        album_keys[static_cast<size_t>(index)] = key;
+        if (!album_key_set.contains(key)) {
+          album_key_set << key;
+          shuffled_album_keys << key;
+        }
       }
 
       // Shuffle them
-      QStringList shuffled_album_keys = album_key_set.values();
-      std::random_device rd;
-      std::shuffle(shuffled_album_keys.begin(), shuffled_album_keys.end(), std::mt19937(rd()));
+      std::shuffle(shuffled_album_keys.begin(), shuffled_album_keys.end(), shuffle_generator_);
 
       // If the user is currently playing a song, force its album to be first
       // Or if the song was not playing but it was selected, force its album to be first.
@@ -2014,19 +2426,32 @@ void Playlist::ReshuffleIndices() {
         }
       }
 
-      // Create album key -> position mapping for fast lookup
-      QMap<QString, int> album_key_positions;
+      // Keep the album positions, so songs added later can be put with their album
+      album_shuffle_positions_.clear();
+      album_shuffle_positions_.reserve(shuffled_album_keys.count());
       for (int i = 0; i < shuffled_album_keys.count(); ++i) {
-        album_key_positions[shuffled_album_keys[i]] = i;
+        album_shuffle_positions_.insert(shuffled_album_keys[i], static_cast<qreal>(i));
+      }
+
+      std::vector<qreal> positions(album_keys.size());
+      for (const int index : std::as_const(virtual_items_)) {
+        positions[static_cast<size_t>(index)] = album_shuffle_positions_.value(album_keys[static_cast<size_t>(index)]);
       }
 
       // Sort the virtual items
-      std::stable_sort(virtual_items_.begin(), virtual_items_.end(), std::bind(AlbumShuffleComparator, album_key_positions, album_keys, std::placeholders::_1, std::placeholders::_2));
+      std::sort(virtual_items_.begin(), virtual_items_.end(), [&positions](const int left, const int right) {
+        const qreal left_pos = positions[static_cast<size_t>(left)];
+        const qreal right_pos = positions[static_cast<size_t>(right)];
+        if (left_pos == right_pos) return left < right;
+        return left_pos < right_pos;
+      });
 
       break;
     }
   }
 
+  InvalidatePlayableIndexes();
+
   // Update current virtual index
   if (current_item_index_.isValid()) {
     current_virtual_index_ = static_cast<int>(virtual_items_.indexOf(current_item_index_.row()));
@@ -2037,6 +2462,116 @@ void Playlist::ReshuffleIndices() {
 
 }
 
+void Playlist::InsertVirtualIndices(const int start, const int count) {
+
+  const int old_count = static_cast<int>(virtual_items_.count());
+
+  // The rows after the inserted ones moved down.
+  if (start < old_count) {
+    for (int &row : virtual_items_) {
+      if (row >= start) row += count;
+    }
+  }
+
+  const PlaylistSequence::ShuffleMode shuffle_mode = ShuffleMode();
+  if (shuffle_mode == PlaylistSequence::ShuffleMode::Off) {
+    // The virtual items are in the same order as the items.
+    if (start == old_count) {
+      for (int row = start; row < start + count; ++row) {
+        virtual_items_ << row;
+      }
+    }
+    else {
+      QList<int> virtual_items;
+      virtual_items.reserve(old_count + count);
+      for (int row = 0; row < old_count + count; ++row) {
+        virtual_items << row;
+      }
+      virtual_items_ = virtual_items;
+    }
+    if (current_virtual_index_ >= start) {
+      current_virtual_index_ += count;
+    }
+    InvalidatePlayableIndexes();
+    return;
+  }
+
+  // The songs that were played keep their order, the new ones go at random positions after the current one.
+  const int first = std::min(current_virtual_index_ + 1, old_count);
+
+  QList<int> virtual_items = virtual_items_.mid(0, first);
+  virtual_items.reserve(old_count + count);
+
+  if (shuffle_mode == PlaylistSequence::ShuffleMode::Albums) {
+    // Songs from albums that are in the playlist go with their album, new albums are put at a random position after the current album.
+    const qreal current_position = current_virtual_index_ == -1 ? -1.0 : album_shuffle_positions_.value(items_[virtual_items_[current_virtual_index_]]->Metadata().AlbumKey(), -1.0);
+    std::uniform_real_distribution<qreal> new_position(current_position, static_cast<qreal>(album_shuffle_positions_.count()));
+
+    std::vector<std::pair<qreal, int>> rows;
+    rows.reserve(static_cast<size_t>(count));
+    for (int row = start; row < start + count; ++row) {
+      const QString key = items_[row]->Metadata().AlbumKey();
+      auto it = album_shuffle_positions_.find(key);
+      if (it == album_shuffle_positions_.end()) {
+        it = album_shuffle_positions_.insert(key, new_position(shuffle_generator_));
+      }
+      rows.emplace_back(it.value(), row);
+    }
+    std::sort(rows.begin(), rows.end());
+
+    // The songs after the current one are sorted by album position, so each new song is merged in at its place.
+    int i = first;
+    for (const std::pair<qreal, int> &row : rows) {
+      int lower = i;
+      int upper = old_count;
+      while (lower < upper) {
+        const int middle = lower + (upper - lower) / 2;
+        const std::pair<qreal, int> middle_row(album_shuffle_positions_.value(items_[virtual_items_[middle]]->Metadata().AlbumKey()), virtual_items_[middle]);
+        if (middle_row < row) {
+          lower = middle + 1;
+        }
+        else {
+          upper = middle;
+        }
+      }
+      while (i < lower) {
+        virtual_items << virtual_items_[i++];
+      }
+      virtual_items << row.second;
+    }
+    while (i < old_count) {
+      virtual_items << virtual_items_[i++];
+    }
+  }
+  else {
+    QList<int> rows;
+    rows.reserve(count);
+    for (int row = start; row < start + count; ++row) {
+      rows << row;
+    }
+    std::shuffle(rows.begin(), rows.end(), shuffle_generator_);
+
+    // Interleave them randomly with the songs that weren't played yet, without changing the order of those.
+    int i = first;
+    int new_i = 0;
+    while (i < old_count || new_i < count) {
+      const int remaining = old_count - i;
+      const int new_remaining = count - new_i;
+      if (new_remaining > 0 && (remaining == 0 || std::uniform_int_distribution<int>(0, remaining + new_remaining - 1)(shuffle_generator_) < new_remaining)) {
+        virtual_items << rows[new_i++];
+      }
+      else {
+        virtual_items << virtual_items_[i++];
+      }
+    }
+  }
+
+  virtual_items_ = virtual_items;
+
+  InvalidatePlayableIndexes();
+
+}
+
 void Playlist::set_sequence(PlaylistSequence *v) {
 
   playlist_sequence_ = v;
@@ -2086,10 +2621,13 @@ void Playlist::TracksAboutToBeDequeued(const QModelIndex&, int begin, int end) {
 
 void Playlist::TracksDequeued() {
 
-  for (const QModelIndex &idx : temp_dequeue_change_indexes_) {
-    emit dataChanged(idx, idx);
+  QList<int> rows;
+  rows.reserve(temp_dequeue_change_indexes_.count());
+  for (const QModelIndex &idx : std::as_const(temp_dequeue_change_indexes_)) {
+    if (idx.isValid()) rows << idx.row();
   }
   temp_dequeue_change_indexes_.clear();
+  RowsChanged(rows);
   emit QueueChanged();
 
 }
@@ -2130,6 +2668,54 @@ void Playlist::ItemChanged(PlaylistItemPtr item) {
 
 }
 
+void Playlist::ItemsChanged(const PlaylistItemPtrList &items) {
+
+  if (items.isEmpty()) return;
+
+  QSet<const PlaylistItem*> changed_items;
+  changed_items.reserve(items.count());
+  for (const PlaylistItemPtr &item : items) {
+    changed_items << item.get();
+  }
+
+  QList<int> rows;
+  for (int row = 0; row < items_.count(); ++row) {
+    if (changed_items.contains(items_[row].get())) {
+      rows << row;
+    }
+  }
+
+  RowsChanged(rows);
+
+}
+
+void Playlist::RowsChanged(QList<int> rows) {
+
+  if (rows.isEmpty()) return;
+
+  std::sort(rows.begin(), rows.end());
+
+  // Contiguous rows are emitted as one range.
+  // With many ranges, a single range over all of them is cheaper for the views and the filter than a signal for each.
+  QList<QPair<int, int>> ranges;
+  for (const int row : std::as_const(rows)) {
+    if (!ranges.isEmpty() && row <= ranges.last().second + 1) {
+      ranges.last().second = std::max(ranges.last().second, row);
+    }
+    else {
+      ranges << qMakePair(row, row);
+    }
+  }
+  if (ranges.count() > kMaxChangedRanges) {
+    ranges = QList<QPair<int, int>>() << qMakePair(ranges.first().first, ranges.last().second);
+  }
+
+  for (const QPair<int, int> &range : std::as_const(ranges)) {
+    emit dataChanged(index(range.first, 0), index(range.second, ColumnCount - 1));
+  }
+
+}
+
 void Playlist::InformOfCurrentSongChange(const AutoScroll autoscroll, const bool minor) {
 
   // If the song is invalid, we won't play it - there's no point in informing anybody about the change
@@ -24,6 +24,9 @@
 
 #include "config.h"
 
+#include <vector>
+#include <random>
+
 #include <QtGlobal>
 #include <QObject>
 #include <QAbstractItemModel>
@@ -31,7 +34,9 @@
 #include <QPersistentModelIndex>
 #include <QFuture>
 #include <QList>
+#include <QPair>
 #include <QMap>
+#include <QHash>
 #include <QMultiMap>
 #include <QMetaType>
 #include <QVariant>
@@ -152,13 +157,10 @@ class Playlist : public QAbstractListModel {
   static const char *kSettingsGroup;
 
   static const int kUndoStackSize;
-  static const int kUndoItemLimit;
 
   static const qint64 kMinScrobblePointNsecs;
   static const qint64 kMaxScrobblePointNsecs;
 
-  static bool CompareItems(const int column, const Qt::SortOrder order, PlaylistItemPtr a, PlaylistItemPtr b);
-
   static QString column_name(Column column);
   static QString abbreviated_column_name(Column column);
 
@@ -167,6 +169,13 @@ class Playlist : public QAbstractListModel {
 
   // Persistence
   void Restore();
+  // Restores the playlist the first time it's needed, so playlists that aren't shown don't have to be loaded at startup.
+  void RestoreIfNeeded();
+  // Frees the items and the undo history of a saved playlist that isn't used, it's restored from the backend the next time it's needed.
+  // Returns false if the playlist is in use and can't be unloaded.
+  bool Unload();
+  bool restore_requested() const { return restore_requested_; }
+  bool restored() const { return restored_; }
   void ScheduleSaveAsync();
 
   // Accessors
@@ -184,12 +193,15 @@ class Playlist : public QAbstractListModel {
   void reset_last_played() { last_played_item_index_ = QPersistentModelIndex(); }
   void reset_played_indexes() { played_indexes_.clear(); }
   int next_row(const bool ignore_repeat_track = false);
+  // Upcoming rows without wrapping around or reshuffling, the queued item first.
+  QList<int> next_rows(const int count) const;
   int previous_row(const bool ignore_repeat_track = false);
 
   const QModelIndex current_index() const;
 
   bool stop_after_current() const;
   bool is_dynamic() const { return static_cast<bool>(dynamic_playlist_); }
+  bool is_live() const { return static_cast<bool>(live_playlist_); }
   int dynamic_history_length() const;
 
   QString special_type() const { return special_type_; }
@@ -232,6 +244,10 @@ class Playlist : public QAbstractListModel {
   void InsertInternetItems(InternetServicePtr service, const SongList &songs, const int pos = -1, const bool play_now = false, const bool enqueue = false, const bool enqueue_next = false);
   void InsertRadioItems(const SongList &songs, const int pos = -1, const bool play_now = false, const bool enqueue = false, const bool enqueue_next = false);
 
+  // Live smart playlists are updated from the songs that changed in the collection, without running the search again.
+  void UpdateLiveSongs(const SongList &songs);
+  void RemoveLiveSongs(const SongList &songs);
+
   void ReshuffleIndices();
 
   // If this playlist contains the current item, this method will apply the "valid" flag on it.
@@ -269,10 +285,13 @@ class Playlist : public QAbstractListModel {
   void sort(int column, Qt::SortOrder order) override;
   bool removeRows(int row, int count, const QModelIndex &parent = QModelIndex()) override;
 
-  static bool ComparePathDepths(Qt::SortOrder, PlaylistItemPtr, PlaylistItemPtr);
+  // Sorts by the first column, and items that are equal by the next ones. This can be undone.
+  using SortSpec = QPair<int, Qt::SortOrder>;
+  void SortByColumns(const QList<SortSpec> &sorting);
 
   void ItemChanged(PlaylistItemPtr item);
   void ItemChanged(const int row);
+  void ItemsChanged(const PlaylistItemPtrList &items);
 
   // Changes rating of a song to the given value asynchronously
   void RateSong(const QModelIndex &idx, const float rating);
@@ -335,6 +354,12 @@ class Playlist : public QAbstractListModel {
   int NextVirtualIndex(int i, const bool ignore_repeat_track) const;
   int PreviousVirtualIndex(int i, const bool ignore_repeat_track) const;
   bool FilterContainsVirtualIndex(const int i) const;
+  bool IsPlayableVirtualIndex(const int i) const;
+  void UpdatePlayableIndexes() const;
+  // Emits dataChanged for the rows, coalesced into ranges.
+  void RowsChanged(QList<int> rows);
+  // Adds the inserted rows to the virtual items, in shuffle mode they go at random positions after the current one.
+  void InsertVirtualIndices(const int start, const int count);
 
   template<typename T>
   void InsertSongItems(const SongList &songs, const int pos, const bool play_now, const bool enqueue, const bool enqueue_next = false);
@@ -365,9 +390,12 @@ class Playlist : public QAbstractListModel {
   void ItemsLoaded();
   void ScheduleSave();
   void Save();
+  void InvalidatePlayableIndexes();
+  void PlayableRowsChanged(const QModelIndex &top_left, const QModelIndex &bottom_right);
 
  private:
   static const int kMaxPlayedIndexes;
+  static const int kMaxChangedRanges;
 
   bool is_loading_;
   PlaylistFilter *filter_;
@@ -388,6 +416,18 @@ class Playlist : public QAbstractListModel {
   // Contains the indices into items_ in the order that they will be played.
   QList<int> virtual_items_;
 
+  std::mt19937 shuffle_generator_;
+  // The order of the albums in album shuffle mode, albums added later get a position after the current album.
+  QHash<QString, qreal> album_shuffle_positions_;
+
+  // The nearest virtual index in the filter that isn't skipped, from each virtual index.
+  // Rebuilt when it's needed after the virtual items, the filter or the skipped tracks changed.
+  mutable bool playable_indexes_valid_;
+  mutable std::vector<char> playable_;
+  mutable std::vector<int> next_playable_;
+  mutable std::vector<int> previous_playable_;
+  mutable std::vector<int> row_virtual_indexes_;
+
   QList<QPersistentModelIndex> played_indexes_;
 
   // A map of collection ID to playlist item - for fast lookups when collection items change.
@@ -412,6 +452,8 @@ class Playlist : public QAbstractListModel {
 
   // Cancel async restore if songs are already replaced
   bool cancel_restore_;
+  bool restore_requested_;
+  bool restored_;
 
   bool scrobbled_;
   qint64 scrobble_point_;
@@ -419,6 +461,7 @@ class Playlist : public QAbstractListModel {
   int editing_;
 
   PlaylistGeneratorPtr dynamic_playlist_;
+  PlaylistGeneratorPtr live_playlist_;
 
   bool auto_sort_;
   int sort_column_;
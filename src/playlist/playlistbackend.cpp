@@ -27,26 +27,33 @@
 #include <QObject>
 #include <QApplication>
 #include <QThread>
+#include <QTimer>
 #include <QMutex>
 #include <QIODevice>
 #include <QDir>
 #include <QFile>
+#include <QFileInfo>
+#include <QDateTime>
 #include <QByteArray>
 #include <QList>
+#include <QMap>
 #include <QString>
 #include <QStringList>
 #include <QUrl>
+#include <QSet>
 #include <QSqlDatabase>
 
 #include "core/shared_ptr.h"
 #include "core/application.h"
 #include "core/database.h"
+#include "core/trace.h"
 #include "core/logging.h"
 #include "core/scopedtransaction.h"
 #include "core/song.h"
 #include "core/sqlquery.h"
 #include "core/sqlrow.h"
 #include "collection/collectionbackend.h"
+#include "collection/collectionfilterindex.h"
 #include "playlistitem.h"
 #include "songplaylistitem.h"
 #include "playlistbackend.h"
@@ -56,17 +63,43 @@
 using std::make_shared;
 
 const int PlaylistBackend::kSongTableJoins = 2;
+const int PlaylistBackend::kSaveDelayMsec = 100;
+const int PlaylistBackend::kSaveRetryMsec = 100;
+const int PlaylistBackend::kMaxSaveRetries = 20;
 
 PlaylistBackend::PlaylistBackend(Application *app, QObject *parent)
     : QObject(parent),
       app_(app),
       db_(app_->database()),
-      original_thread_(nullptr) {
+      original_thread_(nullptr),
+      search_index_built_(false),
+      save_scheduled_(false),
+      save_retries_(0) {
 
   original_thread_ = thread();
 
 }
 
+PlaylistBackend::PlaylistBackend(SharedPtr<Database> db, SharedPtr<CollectionBackend> collection_backend, QObject *parent)
+    : QObject(parent),
+      app_(nullptr),
+      db_(db),
+      collection_backend_(collection_backend),
+      original_thread_(nullptr),
+      search_index_built_(false),
+      save_scheduled_(false),
+      save_retries_(0) {
+
+  original_thread_ = thread();
+
+}
+
+SharedPtr<CollectionBackend> PlaylistBackend::collection_backend() const {
+
+  return app_ ? app_->collection_backend() : collection_backend_;
+
+}
+
 void PlaylistBackend::Close() {
 
   if (db_) {
@@ -84,6 +117,11 @@ void PlaylistBackend::Exit() {
 
   Q_ASSERT(QThread::currentThread() == thread());
 
+  {
+    QMutexLocker l(db_->Mutex());
+    WritePendingPlaylists();
+  }
+
   moveToThread(original_thread_);
   emit ExitFinished();
 
@@ -178,11 +216,15 @@ PlaylistBackend::Playlist PlaylistBackend::GetPlaylist(const int id) {
 
 PlaylistItemPtrList PlaylistBackend::GetPlaylistItems(const int playlist) {
 
+  TRACE_SCOPE("playlist", "PlaylistBackend::GetPlaylistItems");
+
   PlaylistItemPtrList playlistitems;
 
   {
 
     QMutexLocker l(db_->Mutex());
+    // The items have to include the saves that weren't written yet.
+    WritePendingPlaylists();
     QSqlDatabase db(db_->Connect());
 
     QString query = QStringLiteral("SELECT %1, %2, p.type FROM playlist_items AS p LEFT JOIN songs ON p.collection_id = songs.ROWID WHERE p.playlist = :playlist").arg(Song::JoinSpec(QStringLiteral("songs")), Song::JoinSpec(QStringLiteral("p")));
@@ -199,8 +241,21 @@ PlaylistItemPtrList PlaylistBackend::GetPlaylistItems(const int playlist) {
 
     // it's probable that we'll have a few songs associated with the same CUE, so we're caching results of parsing CUEs
     SharedPtr<NewSongFromQueryState> state_ptr = make_shared<NewSongFromQueryState>();
+    SavedItemList saved_items;
+    const int rowid_column = static_cast<int>(Song::kRowIdColumns.count());
     while (q.next()) {
-      playlistitems << NewPlaylistItemFromQuery(SqlRow(q), state_ptr);
+      const SqlRow row(q);
+      PlaylistItemPtr item = NewPlaylistItemFromQuery(row, state_ptr);
+      playlistitems << item;
+      if (item) saved_items << SavedItem(item, item->database_revision(), row.value(rowid_column).toLongLong());
+    }
+
+    // The rows are only known if every one of them could be loaded.
+    if (saved_items.count() == playlistitems.count()) {
+      saved_items_[playlist] = saved_items;
+    }
+    else {
+      saved_items_.remove(playlist);
     }
 
   }
@@ -219,6 +274,8 @@ SongList PlaylistBackend::GetPlaylistSongs(const int playlist) {
 
   {
     QMutexLocker l(db_->Mutex());
+    // The items have to include the saves that weren't written yet.
+    WritePendingPlaylists();
     QSqlDatabase db(db_->Connect());
 
     QString query = QStringLiteral("SELECT %1, %2, p.type FROM playlist_items AS p LEFT JOIN songs ON p.collection_id = songs.ROWID WHERE p.playlist = :playlist").arg(Song::JoinSpec(QStringLiteral("songs")), Song::JoinSpec(QStringLiteral("p")));
@@ -278,17 +335,16 @@ PlaylistItemPtr PlaylistBackend::RestoreCueData(PlaylistItemPtr item, SharedPtr<
   // We need collection to run a CueParser; also, this method applies only to file-type PlaylistItems
   if (item->source() != Song::Source::LocalFile) return item;
 
-  CueParser cue_parser(app_->collection_backend());
-
   Song song = item->Metadata();
   // We're only interested in .cue songs here
   if (!song.has_cue()) return item;
 
   QString cue_path = song.cue_path();
-  // If .cue was deleted - reload the song
-  if (!QFile::exists(cue_path)) {
-    item->Reload();
-    return item;
+
+  // The collection already has the sections of the CUE sheets it contains, and it's updated when they change.
+  const Song collection_song = collection_backend()->GetSongByUrl(song.url(), song.beginning_nanosec());
+  if (collection_song.is_valid() && collection_song.has_cue() && collection_song.cue_path() == cue_path) {
+    return make_shared<SongPlaylistItem>(collection_song);
   }
 
   SongList song_list;
@@ -296,11 +352,38 @@ PlaylistItemPtr PlaylistBackend::RestoreCueData(PlaylistItemPtr item, SharedPtr<
     QMutexLocker locker(&state->mutex_);
 
     if (!state->cached_cues_.contains(cue_path)) {
-      QFile cue_file(cue_path);
-      if (!cue_file.open(QIODevice::ReadOnly)) return item;
+      const QFileInfo cue_fileinfo(cue_path);
+      // If .cue was deleted - reload the song
+      if (!cue_fileinfo.exists()) {
+        item->Reload();
+        return item;
+      }
+
+      const qint64 modified = cue_fileinfo.lastModified().toMSecsSinceEpoch();
+      bool cached = false;
+      {
+        QMutexLocker cue_cache_locker(&cue_cache_mutex_);
+        if (cue_cache_.contains(cue_path) && cue_cache_[cue_path].modified == modified) {
+          song_list = cue_cache_[cue_path].songs;
+          cached = true;
+        }
+      }
+
+      if (!cached) {
+        QFile cue_file(cue_path);
+        if (!cue_file.open(QIODevice::ReadOnly)) return item;
+
+        CueParser cue_parser(collection_backend());
+        song_list = cue_parser.Load(&cue_file, cue_path, QDir(cue_path.section(QLatin1Char('/'), 0, -2)));
+        cue_file.close();
+
+        CachedCue cached_cue;
+        cached_cue.modified = modified;
+        cached_cue.songs = song_list;
+        QMutexLocker cue_cache_locker(&cue_cache_mutex_);
+        cue_cache_[cue_path] = cached_cue;
+      }
 
-      song_list = cue_parser.Load(&cue_file, cue_path, QDir(cue_path.section(QLatin1Char('/'), 0, -2)));
-      cue_file.close();
       state->cached_cues_[cue_path] = song_list;
     }
     else {
@@ -322,42 +405,195 @@ PlaylistItemPtr PlaylistBackend::RestoreCueData(PlaylistItemPtr item, SharedPtr<
 
 }
 
-void PlaylistBackend::SavePlaylistAsync(int playlist, const PlaylistItemPtrList &items, int last_played, PlaylistGeneratorPtr dynamic) {
+void PlaylistBackend::SavePlaylistAsync(const int playlist, const PlaylistItemPtrList &items, const int last_played, PlaylistGeneratorPtr dynamic) {
+
+  QMutexLocker l(&pending_saves_mutex_);
 
-  QMetaObject::invokeMethod(this, "SavePlaylist", Qt::QueuedConnection, Q_ARG(int, playlist), Q_ARG(PlaylistItemPtrList, items), Q_ARG(int, last_played), Q_ARG(PlaylistGeneratorPtr, dynamic));
+  // Only the newest state of each playlist is written.
+  pending_saves_[playlist] = PendingSave(items, last_played, dynamic);
+
+  if (!save_scheduled_) {
+    save_scheduled_ = true;
+    QMetaObject::invokeMethod(this, &PlaylistBackend::ScheduleSavePendingPlaylists, Qt::QueuedConnection);
+  }
 
 }
 
-void PlaylistBackend::SavePlaylist(int playlist, const PlaylistItemPtrList &items, int last_played, PlaylistGeneratorPtr dynamic) {
+void PlaylistBackend::ScheduleSavePendingPlaylists() {
+
+  // Wait a little, so playlists that are changed together are saved together.
+  QTimer::singleShot(kSaveDelayMsec, this, &PlaylistBackend::SavePendingPlaylists);
+
+}
+
+void PlaylistBackend::SavePendingPlaylists() {
+
+  // Saving can wait, so it yields to the queries that use the database now.
+  if (!db_->Mutex()->tryLock()) {
+    if (save_retries_ < kMaxSaveRetries) {
+      ++save_retries_;
+      QTimer::singleShot(kSaveRetryMsec, this, &PlaylistBackend::SavePendingPlaylists);
+      return;
+    }
+    db_->Mutex()->lock();
+  }
+
+  save_retries_ = 0;
+  WritePendingPlaylists();
+
+  db_->Mutex()->unlock();
+
+}
+
+void PlaylistBackend::WritePendingPlaylists() {
+
+  // The pending saves are taken with the database locked, so an older save is never written after a newer one.
+  QMap<int, PendingSave> pending_saves;
+  {
+    QMutexLocker l(&pending_saves_mutex_);
+    pending_saves.swap(pending_saves_);
+    save_scheduled_ = false;
+  }
+
+  if (pending_saves.isEmpty()) return;
 
-  QMutexLocker l(db_->Mutex());
   QSqlDatabase db(db_->Connect());
 
-  qLog(Debug) << "Saving playlist" << playlist;
+  // All playlists are written in one transaction, if that fails they're written one by one, so one failing playlist doesn't lose the others.
+  if (pending_saves.count() > 1) {
+    QHash<int, SavedItemList> saved_items;
+    bool success = true;
+    {
+      ScopedTransaction transaction(&db);
+      for (QMap<int, PendingSave>::const_iterator it = pending_saves.constBegin(); it != pending_saves.constEnd(); ++it) {
+        if (!WritePlaylist(db, it.key(), it.value(), &saved_items[it.key()])) {
+          success = false;
+          break;
+        }
+      }
+      if (success) transaction.Commit();
+    }
+    if (success) {
+      for (QHash<int, SavedItemList>::const_iterator it = saved_items.constBegin(); it != saved_items.constEnd(); ++it) {
+        saved_items_[it.key()] = it.value();
+      }
+      for (QMap<int, PendingSave>::const_iterator it = pending_saves.constBegin(); it != pending_saves.constEnd(); ++it) {
+        IndexPlaylist(it.key(), it.value().items);
+      }
+      return;
+    }
+    qLog(Error) << "Failed to save" << pending_saves.count() << "playlists together, saving them one by one";
+  }
 
-  ScopedTransaction transaction(&db);
+  for (QMap<int, PendingSave>::const_iterator it = pending_saves.constBegin(); it != pending_saves.constEnd(); ++it) {
+    ScopedTransaction transaction(&db);
+    SavedItemList saved_items;
+    if (WritePlaylist(db, it.key(), it.value(), &saved_items)) {
+      transaction.Commit();
+      saved_items_[it.key()] = saved_items;
+      IndexPlaylist(it.key(), it.value().items);
+    }
+  }
+
+}
 
-  // Clear the existing items in the playlist
+void PlaylistBackend::SavePlaylist(const int playlist, const PlaylistItemPtrList &items, const int last_played, PlaylistGeneratorPtr dynamic) {
+
+  QMutexLocker l(db_->Mutex());
+
+  // A save that is still pending is older than this one.
   {
+    QMutexLocker pending_saves_locker(&pending_saves_mutex_);
+    pending_saves_.remove(playlist);
+  }
+
+  QSqlDatabase db(db_->Connect());
+
+  ScopedTransaction transaction(&db);
+  SavedItemList saved_items;
+  if (!WritePlaylist(db, playlist, PendingSave(items, last_played, dynamic), &saved_items)) return;
+  transaction.Commit();
+
+  saved_items_[playlist] = saved_items;
+  IndexPlaylist(playlist, items);
+
+}
+
+bool PlaylistBackend::WritePlaylist(QSqlDatabase &db, const int playlist, const PendingSave &save, SavedItemList *saved_items) {
+
+  const PlaylistItemPtrList &items = save.items;
+  const int last_played = save.last_played;
+  PlaylistGeneratorPtr dynamic = save.dynamic;
+
+  // Rows are ordered by ROWID, so the items before the first moved, inserted or removed one keep their rows.
+  // Changed items among those are updated in place, the rest of the playlist is rewritten.
+  const SavedItemList old_saved_items = saved_items_.value(playlist);
+  qint64 unchanged = 0;
+  while (unchanged < old_saved_items.count() && unchanged < items.count() && old_saved_items[unchanged].item.lock() == items[unchanged]) {
+    ++unchanged;
+  }
+
+  qLog(Debug) << "Saving playlist" << playlist << "keeping" << unchanged << "of" << items.count() << "items";
+
+  saved_items_.remove(playlist);
+  saved_items->reserve(items.count());
+
+  // Remove the rows that are rewritten.  Without earlier rows, everything is removed, there could be rows that were never loaded.
+  if (unchanged == 0 || unchanged < old_saved_items.count()) {
     SqlQuery q(db);
-    q.prepare(QStringLiteral("DELETE FROM playlist_items WHERE playlist = :playlist"));
+    if (unchanged == 0) {
+      q.prepare(QStringLiteral("DELETE FROM playlist_items WHERE playlist = :playlist"));
+    }
+    else {
+      q.prepare(QStringLiteral("DELETE FROM playlist_items WHERE playlist = :playlist AND ROWID >= :rowid"));
+      q.BindValue(QStringLiteral(":rowid"), old_saved_items[unchanged].rowid);
+    }
     q.BindValue(QStringLiteral(":playlist"), playlist);
     if (!q.Exec()) {
       db_->ReportErrors(q);
-      return;
+      return false;
+    }
+  }
+
+  // Update the items that were edited
+  {
+    SqlQuery q(db);
+    bool prepared = false;
+    for (qint64 i = 0; i < unchanged; ++i) {
+      const SavedItem &saved_item = old_saved_items[i];
+      PlaylistItemPtr item = items[i];
+      const quint64 revision = item->database_revision();
+      if (revision != saved_item.revision) {
+        if (!prepared) {
+          q.prepare(QStringLiteral("UPDATE playlist_items SET type = :type, collection_id = :collection_id, ") + Song::kUpdateSpec + QStringLiteral(" WHERE ROWID = :rowid"));
+          prepared = true;
+        }
+        item->BindToQuery(&q);
+        q.BindValue(QStringLiteral(":rowid"), saved_item.rowid);
+        if (!q.Exec()) {
+          db_->ReportErrors(q);
+          return false;
+        }
+      }
+      *saved_items << SavedItem(item, revision, saved_item.rowid);
     }
   }
 
   // Save the new ones
-  for (PlaylistItemPtr item : items) {  // clazy:exclude=range-loop-reference
+  if (unchanged < items.count()) {
     SqlQuery q(db);
     q.prepare(QStringLiteral("INSERT INTO playlist_items (playlist, type, collection_id, ") + Song::kColumnSpec + QStringLiteral(") VALUES (:playlist, :type, :collection_id, ") + Song::kBindSpec + QStringLiteral(")"));
-    q.BindValue(QStringLiteral(":playlist"), playlist);
-    item->BindToQuery(&q);
-
-    if (!q.Exec()) {
-      db_->ReportErrors(q);
-      return;
+    for (qint64 i = unchanged; i < items.count(); ++i) {
+      PlaylistItemPtr item = items[i];
+      const quint64 revision = item->database_revision();
+      q.BindValue(QStringLiteral(":playlist"), playlist);
+      item->BindToQuery(&q);
+
+      if (!q.Exec()) {
+        db_->ReportErrors(q);
+        return false;
+      }
+      *saved_items << SavedItem(item, revision, q.lastInsertId().toLongLong());
     }
   }
 
@@ -379,11 +615,11 @@ void PlaylistBackend::SavePlaylist(int playlist, const PlaylistItemPtrList &item
     q.BindValue(QStringLiteral(":playlist"), playlist);
     if (!q.Exec()) {
       db_->ReportErrors(q);
-      return;
+      return false;
     }
   }
 
-  transaction.Commit();
+  return true;
 
 }
 
@@ -410,6 +646,13 @@ void PlaylistBackend::RemovePlaylist(int id) {
   QMutexLocker l(db_->Mutex());
   QSqlDatabase db(db_->Connect());
 
+  saved_items_.remove(id);
+  {
+    QMutexLocker pending_saves_locker(&pending_saves_mutex_);
+    pending_saves_.remove(id);
+  }
+  UnindexPlaylist(id);
+
   ScopedTransaction transaction(&db);
 
   {
@@ -512,3 +755,159 @@ void PlaylistBackend::SetPlaylistUiPath(const int id, const QString &path) {
   transaction.Commit();
 
 }
+
+QStringList PlaylistBackend::SearchWords(const QString &text) {
+
+  // Normalized like the collection filter, so the same text finds the same songs.
+  const QString normalized = CollectionFilterIndex::Normalize(text);
+  if (normalized.isEmpty()) return QStringList();
+
+  return normalized.split(QLatin1Char(' '));
+
+}
+
+void PlaylistBackend::BuildSearchIndex() {
+
+  {
+    QMutexLocker l(&search_index_mutex_);
+    if (search_index_built_) return;
+  }
+
+  // The database is locked first, like when saving, which updates the index with the database locked.
+  QMutexLocker l(db_->Mutex());
+  WritePendingPlaylists();
+
+  QMutexLocker search_index_locker(&search_index_mutex_);
+  if (search_index_built_) return;
+
+  QSqlDatabase db(db_->Connect());
+
+  // Only the searched fields are read, items aren't created.  Collection items take their fields from the songs table.
+  SqlQuery q(db);
+  q.setForwardOnly(true);
+  q.prepare(QStringLiteral("SELECT p.playlist, songs.ROWID, songs.title, songs.artist, songs.album, songs.albumartist, songs.url, p.title, p.artist, p.album, p.albumartist, p.url FROM playlist_items AS p LEFT JOIN songs ON p.collection_id = songs.ROWID"));
+  if (!q.Exec()) {
+    db_->ReportErrors(q);
+    return;
+  }
+
+  QHash<int, IndexedPlaylist> indexed_playlists;
+  while (q.next()) {
+    const int offset = q.value(1).isNull() ? 5 : 0;
+    IndexedPlaylist &indexed_playlist = indexed_playlists[q.value(0).toInt()];
+    const QUrl url = QUrl::fromEncoded(q.value(offset + 6).toString().toUtf8());
+    for (int column = offset + 2; column < offset + 6; ++column) {
+      const QStringList words = SearchWords(q.value(column).toString());
+      for (const QString &word : words) indexed_playlist.words.insert(word);
+    }
+    const QStringList words = SearchWords(url.fileName());
+    for (const QString &word : words) indexed_playlist.words.insert(word);
+    if (url.isValid()) indexed_playlist.urls.insert(url);
+  }
+
+  for (QHash<int, IndexedPlaylist>::const_iterator it = indexed_playlists.constBegin(); it != indexed_playlists.constEnd(); ++it) {
+    SetIndexedPlaylist(it.key(), it.value());
+  }
+  search_index_built_ = true;
+
+  qLog(Debug) << "Built playlist search index with" << playlists_by_word_.count() << "words in" << indexed_playlists_.count() << "playlists";
+
+  if (QThread::currentThread() != thread() && QThread::currentThread() != qApp->thread()) {
+    db_->Close();
+  }
+
+}
+
+void PlaylistBackend::IndexPlaylist(const int playlist, const PlaylistItemPtrList &items) {
+
+  QMutexLocker l(&search_index_mutex_);
+
+  // Until the index is built, it's built from the database.
+  if (!search_index_built_) return;
+
+  IndexedPlaylist indexed_playlist;
+  for (PlaylistItemPtr item : items) {
+    const Song &song = item->Metadata();
+    const QStringList fields = QStringList() << song.title() << song.artist() << song.album() << song.albumartist() << song.url().fileName();
+    for (const QString &field : fields) {
+      const QStringList words = SearchWords(field);
+      for (const QString &word : words) indexed_playlist.words.insert(word);
+    }
+    if (song.url().isValid()) indexed_playlist.urls.insert(song.url());
+  }
+
+  SetIndexedPlaylist(playlist, indexed_playlist);
+
+}
+
+void PlaylistBackend::UnindexPlaylist(const int playlist) {
+
+  QMutexLocker l(&search_index_mutex_);
+  SetIndexedPlaylist(playlist, IndexedPlaylist());
+
+}
+
+void PlaylistBackend::SetIndexedPlaylist(const int playlist, const IndexedPlaylist &indexed_playlist) {
+
+  const IndexedPlaylist old_indexed_playlist = indexed_playlists_.take(playlist);
+
+  for (const QString &word : old_indexed_playlist.words) {
+    if (indexed_playlist.words.contains(word)) continue;
+    QMap<QString, QSet<int>>::iterator it = playlists_by_word_.find(word);
+    if (it == playlists_by_word_.end()) continue;
+    it->remove(playlist);
+    if (it->isEmpty()) playlists_by_word_.erase(it);
+  }
+  for (const QUrl &url : old_indexed_playlist.urls) {
+    if (indexed_playlist.urls.contains(url)) continue;
+    QHash<QUrl, QSet<int>>::iterator it = playlists_by_url_.find(url);
+    if (it == playlists_by_url_.end()) continue;
+    it->remove(playlist);
+    if (it->isEmpty()) playlists_by_url_.erase(it);
+  }
+
+  if (indexed_playlist.words.isEmpty() && indexed_playlist.urls.isEmpty()) return;
+
+  for (const QString &word : indexed_playlist.words) playlists_by_word_[word].insert(playlist);
+  for (const QUrl &url : indexed_playlist.urls) playlists_by_url_[url].insert(playlist);
+  indexed_playlists_.insert(playlist, indexed_playlist);
+
+}
+
+QList<int> PlaylistBackend::SearchPlaylists(const QString &text) {
+
+  const QStringList words = SearchWords(text);
+  if (words.isEmpty()) return QList<int>();
+
+  BuildSearchIndex();
+
+  QMutexLocker l(&search_index_mutex_);
+
+  QSet<int> playlists;
+  for (int i = 0; i < words.count(); ++i) {
+    // All words starting with the searched word are next to each other in the map.
+    QSet<int> word_playlists;
+    for (QMap<QString, QSet<int>>::const_iterator it = playlists_by_word_.lowerBound(words[i]); it != playlists_by_word_.constEnd() && it.key().startsWith(words[i]); ++it) {
+      word_playlists.unite(it.value());
+    }
+    if (i == 0) {
+      playlists = word_playlists;
+    }
+    else {
+      playlists.intersect(word_playlists);
+    }
+    if (playlists.isEmpty()) break;
+  }
+
+  return playlists.values();
+
+}
+
+QList<int> PlaylistBackend::PlaylistsContainingSong(const QUrl &url) {
+
+  BuildSearchIndex();
+
+  QMutexLocker l(&search_index_mutex_);
+  return playlists_by_url_.value(url).values();
+
+}
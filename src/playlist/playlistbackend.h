@@ -24,12 +24,17 @@
 
 #include "config.h"
 
+#include <memory>
+
 #include <QObject>
 #include <QMutex>
 #include <QHash>
+#include <QMap>
 #include <QList>
 #include <QSet>
 #include <QString>
+#include <QUrl>
+#include <QSqlDatabase>
 #include <QSqlQuery>
 
 #include "core/shared_ptr.h"
@@ -42,12 +47,15 @@
 class QThread;
 class Application;
 class Database;
+class CollectionBackend;
 
 class PlaylistBackend : public QObject {
   Q_OBJECT
 
  public:
   Q_INVOKABLE explicit PlaylistBackend(Application *app, QObject *parent = nullptr);
+  // Without an application, for the benchmarks.
+  explicit PlaylistBackend(SharedPtr<Database> db, SharedPtr<CollectionBackend> collection_backend, QObject *parent = nullptr);
 
   struct Playlist {
     Playlist() : id(-1), favorite(false), last_played(0) {}
@@ -65,6 +73,9 @@ class PlaylistBackend : public QObject {
   using PlaylistList = QList<Playlist>;
 
   static const int kSongTableJoins;
+  static const int kSaveDelayMsec;
+  static const int kSaveRetryMsec;
+  static const int kMaxSaveRetries;
 
   void Close();
   void ExitAsync();
@@ -81,11 +92,18 @@ class PlaylistBackend : public QObject {
   void SetPlaylistUiPath(const int id, const QString &path);
 
   int CreatePlaylist(const QString &name, const QString &special_type);
+  // Saves are coalesced, the playlists that were changed together are written in one transaction on the backend's thread.
   void SavePlaylistAsync(const int playlist, const PlaylistItemPtrList &items, const int last_played, PlaylistGeneratorPtr dynamic);
   void RenamePlaylist(const int id, const QString &new_name);
   void FavoritePlaylist(const int id, bool is_favorite);
   void RemovePlaylist(const int id);
 
+  // Searches the items of all playlists, including the ones that aren't open.
+  // Every word of the text has to be the start of a word in the title, artist, album, album artist or file name of an item of the playlist.
+  // The index is built the first time, after that it's kept up to date when playlists are saved.
+  QList<int> SearchPlaylists(const QString &text);
+  QList<int> PlaylistsContainingSong(const QUrl &url);
+
   Application *app() const { return app_; }
 
  public slots:
@@ -95,6 +113,10 @@ class PlaylistBackend : public QObject {
  signals:
   void ExitFinished();
 
+ private slots:
+  void ScheduleSavePendingPlaylists();
+  void SavePendingPlaylists();
+
  private:
   struct NewSongFromQueryState {
     QHash<QString, SongList> cached_cues_;
@@ -112,9 +134,78 @@ class PlaylistBackend : public QObject {
   };
   PlaylistList GetPlaylists(const GetPlaylistsFlags flags);
 
+  SharedPtr<CollectionBackend> collection_backend() const;
+
+  // The newest state of a playlist that wasn't written yet.
+  struct PendingSave {
+    PendingSave() : last_played(-1) {}
+    PendingSave(const PlaylistItemPtrList &_items, const int _last_played, PlaylistGeneratorPtr _dynamic) : items(_items), last_played(_last_played), dynamic(_dynamic) {}
+    PlaylistItemPtrList items;
+    int last_played;
+    PlaylistGeneratorPtr dynamic;
+  };
+
+  // An item as it was last saved to or loaded from the database.
+  // The item isn't kept alive, an item that was deleted never matches.
+  struct SavedItem {
+    SavedItem() : revision(0), rowid(-1) {}
+    SavedItem(PlaylistItemPtr _item, const quint64 _revision, const qint64 _rowid) : item(_item), revision(_revision), rowid(_rowid) {}
+    std::weak_ptr<PlaylistItem> item;
+    quint64 revision;
+    qint64 rowid;
+  };
+  using SavedItemList = QList<SavedItem>;
+
+  // Writes the pending saves.  The database mutex must be locked.
+  void WritePendingPlaylists();
+  // Writes the playlist without committing, the items that are in the database after the commit are added to saved_items.
+  bool WritePlaylist(QSqlDatabase &db, const int playlist, const PendingSave &save, SavedItemList *saved_items);
+
+  // The words and songs of a playlist in the search index.
+  struct IndexedPlaylist {
+    QSet<QString> words;
+    QSet<QUrl> urls;
+  };
+
+  static QStringList SearchWords(const QString &text);
+  // Builds the search index if it wasn't yet, from what's in the database.
+  void BuildSearchIndex();
+  void IndexPlaylist(const int playlist, const PlaylistItemPtrList &items);
+  void UnindexPlaylist(const int playlist);
+  // Replaces the words and songs of the playlist.  The search index mutex must be locked.
+  void SetIndexedPlaylist(const int playlist, const IndexedPlaylist &indexed_playlist);
+
+  // A parsed CUE sheet and when its file was last modified.
+  struct CachedCue {
+    CachedCue() : modified(0) {}
+    qint64 modified;
+    SongList songs;
+  };
+
   Application *app_;
   SharedPtr<Database> db_;
+  SharedPtr<CollectionBackend> collection_backend_;
   QThread *original_thread_;
+
+  // Parsed CUE sheets, kept between loads so restoring a playlist again only has to check if they changed.
+  QMutex cue_cache_mutex_;
+  QHash<QString, CachedCue> cue_cache_;
+
+  // What's in the database for each playlist, so saving only writes the difference.  Protected by the database mutex.
+  QHash<int, SavedItemList> saved_items_;
+
+  // An inverted index from the words and songs of the items to the playlists.
+  // The words are sorted, so all words starting with the same text are next to each other.
+  QMutex search_index_mutex_;
+  bool search_index_built_;
+  QHash<int, IndexedPlaylist> indexed_playlists_;
+  QMap<QString, QSet<int>> playlists_by_word_;
+  QHash<QUrl, QSet<int>> playlists_by_url_;
+
+  QMutex pending_saves_mutex_;
+  QMap<int, PendingSave> pending_saves_;
+  bool save_scheduled_;
+  int save_retries_;
 };
 
 #endif  // PLAYLISTBACKEND_H
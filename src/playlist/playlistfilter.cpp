@@ -21,8 +21,16 @@
 
 #include "config.h"
 
+#include <algorithm>
+#include <vector>
+
+#include <QtGlobal>
 #include <QObject>
+#include <QThread>
+#include <QtConcurrentMap>
+#include <QList>
 #include <QString>
+#include <QStringList>
 #include <QAbstractItemModel>
 #include <QSortFilterProxyModel>
 
@@ -33,7 +41,7 @@
 PlaylistFilter::PlaylistFilter(QObject *parent)
     : QSortFilterProxyModel(parent),
       filter_tree_(new NopFilter),
-      query_hash_(0) {
+      cached_rows_(-1) {
 
   setDynamicSortFilter(true);
 
@@ -75,6 +83,30 @@ PlaylistFilter::PlaylistFilter(QObject *parent)
 
 PlaylistFilter::~PlaylistFilter() = default;
 
+const int PlaylistFilter::kMinRowsPerThread = 2000;
+
+void PlaylistFilter::setSourceModel(QAbstractItemModel *source_model) {
+
+  if (sourceModel()) {
+    QObject::disconnect(sourceModel(), nullptr, this, nullptr);
+  }
+
+  InvalidateCache();
+
+  // Connected before QSortFilterProxyModel connects its own slots, so the cache is updated before it filters the changed rows.
+  if (source_model) {
+    QObject::connect(source_model, &QAbstractItemModel::rowsAboutToBeInserted, this, &PlaylistFilter::InvalidateCache);
+    QObject::connect(source_model, &QAbstractItemModel::rowsAboutToBeRemoved, this, &PlaylistFilter::InvalidateCache);
+    QObject::connect(source_model, &QAbstractItemModel::rowsAboutToBeMoved, this, &PlaylistFilter::InvalidateCache);
+    QObject::connect(source_model, &QAbstractItemModel::layoutAboutToBeChanged, this, &PlaylistFilter::InvalidateCache);
+    QObject::connect(source_model, &QAbstractItemModel::modelAboutToBeReset, this, &PlaylistFilter::InvalidateCache);
+    QObject::connect(source_model, &QAbstractItemModel::dataChanged, this, &PlaylistFilter::SourceDataChanged);
+  }
+
+  QSortFilterProxyModel::setSourceModel(source_model);
+
+}
+
 void PlaylistFilter::sort(int column, Qt::SortOrder order) {
   // Pass this through to the Playlist, it does sorting itself
   sourceModel()->sort(column, order);
@@ -82,17 +114,8 @@ void PlaylistFilter::sort(int column, Qt::SortOrder order) {
 
 bool PlaylistFilter::filterAcceptsRow(int row, const QModelIndex &parent) const {
 
-#if QT_VERSION >= QT_VERSION_CHECK(6, 0, 0)
-  size_t hash = qHash(filter_text_);
-#else
-  uint hash = qHash(filter_text_);
-#endif
-  if (hash != query_hash_) {
-    // Parse the query
-    FilterParser p(filter_text_, column_names_, numerical_columns_);
-    filter_tree_.reset(p.parse());
-
-    query_hash_ = hash;
+  if (!parent.isValid() && row >= 0 && static_cast<size_t>(row) < results_.size()) {
+    return results_[static_cast<size_t>(row)] != 0;
   }
 
   // Test the row
@@ -103,6 +126,126 @@ bool PlaylistFilter::filterAcceptsRow(int row, const QModelIndex &parent) const
 void PlaylistFilter::SetFilterText(const QString &filter_text) {
 
   filter_text_ = filter_text;
+
+  // Parse the query
+  FilterParser p(filter_text_, column_names_, numerical_columns_);
+  filter_tree_.reset(p.parse());
+  filter_columns_.clear();
+  filter_tree_->AddColumns(&filter_columns_);
+
+  UpdateResults();
+
   setFilterFixedString(filter_text);
 
 }
+
+void PlaylistFilter::InvalidateCache() {
+
+  column_values_.clear();
+  cached_rows_ = -1;
+  results_.clear();
+
+}
+
+void PlaylistFilter::UpdateColumnValues() {
+
+  const QAbstractItemModel *model = sourceModel();
+  if (!model) return;
+
+  const int rows = model->rowCount();
+  if (rows != cached_rows_) {
+    column_values_.clear();
+    cached_rows_ = rows;
+  }
+
+  const int columns = model->columnCount();
+  if (column_values_.size() < static_cast<size_t>(columns)) {
+    column_values_.resize(static_cast<size_t>(columns));
+  }
+
+  for (const int column : std::as_const(filter_columns_)) {
+    if (column < 0 || column >= columns) continue;
+    QStringList &values = column_values_[static_cast<size_t>(column)];
+    if (values.count() == rows) continue;
+    values.clear();
+    values.reserve(rows);
+    for (int row = 0; row < rows; ++row) {
+      values << model->index(row, column).data().toString().toLower();
+    }
+  }
+
+}
+
+void PlaylistFilter::UpdateResults() {
+
+  results_.clear();
+
+  const QAbstractItemModel *model = sourceModel();
+  if (!model || filter_text_.isEmpty()) return;
+
+  // The filter is only read from the GUI thread, and a column outside of the model has to be tested on the model.
+  const int columns = model->columnCount();
+  if (std::any_of(filter_columns_.begin(), filter_columns_.end(), [columns](const int column) { return column < 0 || column >= columns; })) return;
+
+  UpdateColumnValues();
+
+  const int rows = cached_rows_;
+  if (rows <= 0) return;
+
+  std::vector<char> results(static_cast<size_t>(rows));
+  const FilterTree *filter_tree = filter_tree_.data();
+  const FilterColumnValues &values = column_values_;
+
+  // Split the rows in chunks, so every thread gets a big enough part to be worth it.
+  const int threads = std::max(1, std::min(QThread::idealThreadCount(), rows / kMinRowsPerThread));
+  const int chunk_size = (rows + threads - 1) / threads;
+  QList<int> chunks;
+  for (int start = 0; start < rows; start += chunk_size) {
+    chunks << start;
+  }
+
+  auto test_chunk = [filter_tree, &values, &results, rows, chunk_size](const int start) {
+    const int end = std::min(rows, start + chunk_size);
+    for (int row = start; row < end; ++row) {
+      results[static_cast<size_t>(row)] = filter_tree->accept(row, values) ? 1 : 0;
+    }
+  };
+
+  if (chunks.count() == 1) {
+    test_chunk(0);
+  }
+  else {
+    QtConcurrent::blockingMap(chunks, test_chunk);
+  }
+
+  results_ = std::move(results);
+
+}
+
+void PlaylistFilter::SourceDataChanged(const QModelIndex &top_left, const QModelIndex &bottom_right) {
+
+  if (results_.empty() || top_left.parent().isValid()) return;
+
+  const QAbstractItemModel *model = sourceModel();
+  if (!model || model->rowCount() != cached_rows_ || static_cast<size_t>(cached_rows_) != results_.size()) {
+    InvalidateCache();
+    return;
+  }
+
+  const int top = std::max(0, top_left.row());
+  const int bottom = std::min(cached_rows_ - 1, bottom_right.row());
+
+  // Update the cached text of the changed rows, and test them again.
+  for (size_t column = 0; column < column_values_.size(); ++column) {
+    QStringList &values = column_values_[column];
+    if (values.count() != cached_rows_) continue;
+    for (int row = top; row <= bottom; ++row) {
+      values[row] = model->index(row, static_cast<int>(column)).data().toString().toLower();
+    }
+  }
+
+  for (int row = top; row <= bottom; ++row) {
+    results_[static_cast<size_t>(row)] = filter_tree_->accept(row, column_values_) ? 1 : 0;
+  }
+
+}
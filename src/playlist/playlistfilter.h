@@ -24,6 +24,8 @@
 
 #include "config.h"
 
+#include <vector>
+
 #include <QtGlobal>
 #include <QObject>
 #include <QMap>
@@ -32,7 +34,10 @@
 #include <QString>
 #include <QSortFilterProxyModel>
 
-class FilterTree;
+#include "playlistfilterparser.h"
+
+class QAbstractItemModel;
+class QModelIndex;
 
 class PlaylistFilter : public QSortFilterProxyModel {
   Q_OBJECT
@@ -42,6 +47,7 @@ class PlaylistFilter : public QSortFilterProxyModel {
   ~PlaylistFilter() override;
 
   // QAbstractItemModel
+  void setSourceModel(QAbstractItemModel *source_model) override;
   void sort(int column, Qt::SortOrder order = Qt::AscendingOrder) override;
 
   // QSortFilterProxyModel
@@ -54,13 +60,26 @@ class PlaylistFilter : public QSortFilterProxyModel {
   QMap<QString, int> column_names() const { return column_names_; }
 
  private:
-  // Mutable because they're modified from filterAcceptsRow() const
-  mutable QScopedPointer<FilterTree> filter_tree_;
-#if QT_VERSION >= QT_VERSION_CHECK(6, 0, 0)
-  mutable size_t query_hash_;
-#else
-  mutable uint query_hash_;
-#endif
+  // Reads the columns the filter needs that aren't cached yet.
+  void UpdateColumnValues();
+  void UpdateResults();
+
+ private slots:
+  void InvalidateCache();
+  void SourceDataChanged(const QModelIndex &top_left, const QModelIndex &bottom_right);
+
+ private:
+  static const int kMinRowsPerThread;
+
+  QScopedPointer<FilterTree> filter_tree_;
+  QSet<int> filter_columns_;
+
+  // The lowercase text of the source rows, kept between filter changes so typing doesn't read the model again.
+  FilterColumnValues column_values_;
+  int cached_rows_;
+
+  // The result for each source row, empty when it has to be tested on the model.
+  std::vector<char> results_;
 
   QMap<QString, int> column_names_;
   QSet<int> numerical_columns_;
@@ -260,6 +260,12 @@ class FilterTerm : public FilterTree {
     }
     return false;
   }
+  bool accept(const int row, const FilterColumnValues &values) const override {
+    return std::any_of(columns_.begin(), columns_.end(), [this, row, &values](const int column) { return cmp_->Matches(values[static_cast<size_t>(column)][row]); });
+  }
+  void AddColumns(QSet<int> *columns) const override {
+    for (const int column : columns_) columns->insert(column);
+  }
   FilterType type() override { return FilterType::Term; }
  private:
   QScopedPointer<SearchTermComparator> cmp_;
@@ -275,6 +281,10 @@ class FilterColumnTerm : public FilterTree {
     QModelIndex idx(model->index(row, col, parent));
     return cmp_->Matches(idx.data().toString().toLower());
   }
+  bool accept(const int row, const FilterColumnValues &values) const override {
+    return cmp_->Matches(values[static_cast<size_t>(col)][row]);
+  }
+  void AddColumns(QSet<int> *columns) const override { columns->insert(col); }
   FilterType type() override { return FilterType::Column; }
  private:
   int col;
@@ -288,6 +298,10 @@ class NotFilter : public FilterTree {
   bool accept(int row, const QModelIndex &parent, const QAbstractItemModel *const model) const override {
     return !child_->accept(row, parent, model);
   }
+  bool accept(const int row, const FilterColumnValues &values) const override {
+    return !child_->accept(row, values);
+  }
+  void AddColumns(QSet<int> *columns) const override { child_->AddColumns(columns); }
   FilterType type() override { return FilterType::Not; }
  private:
   QScopedPointer<const FilterTree> child_;
@@ -300,6 +314,12 @@ class OrFilter : public FilterTree {
   bool accept(int row, const QModelIndex &parent, const QAbstractItemModel *const model) const override {
     return std::any_of(children_.begin(), children_.end(), [row, parent, model](FilterTree *child) { return child->accept(row, parent, model); });
   }
+  bool accept(const int row, const FilterColumnValues &values) const override {
+    return std::any_of(children_.begin(), children_.end(), [row, &values](FilterTree *child) { return child->accept(row, values); });
+  }
+  void AddColumns(QSet<int> *columns) const override {
+    for (FilterTree *child : children_) child->AddColumns(columns);
+  }
   FilterType type() override { return FilterType::Or; }
  private:
   QList<FilterTree*> children_;
@@ -312,6 +332,12 @@ class AndFilter : public FilterTree {
   bool accept(int row, const QModelIndex &parent, const QAbstractItemModel *const model) const override {
     return !std::any_of(children_.begin(), children_.end(), [row, parent, model](FilterTree *child) { return !child->accept(row, parent, model); });
   }
+  bool accept(const int row, const FilterColumnValues &values) const override {
+    return !std::any_of(children_.begin(), children_.end(), [row, &values](FilterTree *child) { return !child->accept(row, values); });
+  }
+  void AddColumns(QSet<int> *columns) const override {
+    for (FilterTree *child : children_) child->AddColumns(columns);
+  }
   FilterType type() override { return FilterType::And; }
  private:
   QList<FilterTree*> children_;
@@ -23,19 +23,29 @@
 
 #include "config.h"
 
+#include <vector>
+
 #include <QSet>
 #include <QMap>
 #include <QString>
+#include <QStringList>
 
 class QAbstractItemModel;
 class QModelIndex;
 
+// The lowercase text of the rows, indexed by column.  Only the columns a filter reads need to be filled in.
+using FilterColumnValues = std::vector<QStringList>;
+
 // Structure for filter parse tree
 class FilterTree {
  public:
   FilterTree() = default;
   virtual ~FilterTree() {}
   virtual bool accept(int row, const QModelIndex &parent, const QAbstractItemModel *const model) const = 0;
+  // Same as above, but on text that was already read from the model. This is safe to call from several threads.
+  virtual bool accept(const int row, const FilterColumnValues &values) const = 0;
+  // Adds the columns accept() reads.
+  virtual void AddColumns(QSet<int> *columns) const = 0;
   enum class FilterType {
     Nop = 0,
     Or,
@@ -53,6 +63,8 @@ class FilterTree {
 class NopFilter : public FilterTree {
  public:
   bool accept(int row, const QModelIndex &parent, const QAbstractItemModel *const model) const override { Q_UNUSED(row); Q_UNUSED(parent); Q_UNUSED(model); return true; }
+  bool accept(const int row, const FilterColumnValues &values) const override { Q_UNUSED(row); Q_UNUSED(values); return true; }
+  void AddColumns(QSet<int> *columns) const override { Q_UNUSED(columns); }
   FilterType type() override { return FilterType::Nop; }
 };
 
@@ -25,6 +25,7 @@
 #include "config.h"
 
 #include <memory>
+#include <atomic>
 
 #include <QFuture>
 #include <QMetaType>
@@ -37,6 +38,7 @@
 #include <QColor>
 
 #include "core/shared_ptr.h"
+#include "core/memorystats.h"
 #include "core/song.h"
 
 class QAction;
@@ -48,7 +50,7 @@ using std::enable_shared_from_this;
 
 class PlaylistItem : public enable_shared_from_this<PlaylistItem> {
  public:
-  explicit PlaylistItem(const Song::Source source) : should_skip_(false), source_(source) {}
+  explicit PlaylistItem(const Song::Source source) : should_skip_(false), source_(source), database_revision_(0), memory_counter_(sizeof(PlaylistItem)) {}
   virtual ~PlaylistItem();
 
   static SharedPtr<PlaylistItem> NewFromSource(const Song::Source source);
@@ -73,6 +75,9 @@ class PlaylistItem : public enable_shared_from_this<PlaylistItem> {
 
   virtual bool InitFromQuery(const SqlRow &query) = 0;
   void BindToQuery(SqlQuery *query) const;
+
+  // Increased whenever the values bound by BindToQuery change, so the playlist backend only rewrites the items that changed.
+  quint64 database_revision() const { return database_revision_; }
   virtual void Reload() {}
   QFuture<void> BackgroundReload();
 
@@ -127,6 +132,9 @@ class PlaylistItem : public enable_shared_from_this<PlaylistItem> {
   }
   virtual Song DatabaseSongMetadata() const { return Song(); }
 
+  // Call this from everything that changes the metadata saved in the database.
+  void DatabaseMetadataChanged() { ++database_revision_; }
+
   Song::Source source_;
 
   Song temp_metadata_;
@@ -134,6 +142,12 @@ class PlaylistItem : public enable_shared_from_this<PlaylistItem> {
   QMap<short, QColor> background_colors_;
   QMap<short, QColor> foreground_colors_;
 
+ private:
+  // Items are reloaded in the background.
+  std::atomic<quint64> database_revision_;
+
+  memorystats::ObjectCounter<memorystats::Counter::PlaylistItem> memory_counter_;
+
   Q_DISABLE_COPY(PlaylistItem)
 };
 using PlaylistItemPtr = SharedPtr<PlaylistItem>;
@@ -45,6 +45,7 @@
 #include <QShowEvent>
 #include <QContextMenuEvent>
 #include <QMimeData>
+#include <QTimer>
 
 #include "core/application.h"
 #include "core/iconloader.h"
@@ -60,6 +61,7 @@
 #include "ui_playlistlistcontainer.h"
 #include "organize/organizedialog.h"
 #include "settings/appearancesettingspage.h"
+#include "widgets/qsearchfield.h"
 #ifndef Q_OS_WIN
 #  include "device/devicemanager.h"
 #  include "device/devicestatefiltermodel.h"
@@ -67,6 +69,8 @@
 
 using std::make_unique;
 
+const int PlaylistListContainer::kSearchDelayMsec = 250;
+
 PlaylistListContainer::PlaylistListContainer(QWidget *parent)
     : QWidget(parent),
       app_(nullptr),
@@ -80,6 +84,7 @@ PlaylistListContainer::PlaylistListContainer(QWidget *parent)
 #endif
       model_(new PlaylistListModel(this)),
       proxy_(new PlaylistListSortFilterModel(this)),
+      search_timer_(new QTimer(this)),
       loaded_icons_(false),
       active_playlist_id_(-1) {
 
@@ -114,6 +119,11 @@ PlaylistListContainer::PlaylistListContainer(QWidget *parent)
   QObject::connect(ui_->tree, &PlaylistListView::doubleClicked, this, &PlaylistListContainer::ItemDoubleClicked);
   QObject::connect(ui_->tree, &PlaylistListView::ItemMimeDataDroppedSignal, this, &PlaylistListContainer::ItemMimeDataDropped);
 
+  search_timer_->setSingleShot(true);
+  search_timer_->setInterval(kSearchDelayMsec);
+  QObject::connect(search_timer_, &QTimer::timeout, this, &PlaylistListContainer::Search);
+  QObject::connect(ui_->search_field, &QSearchField::textChanged, search_timer_, QOverload<>::of(&QTimer::start));
+
   model_->invisibleRootItem()->setData(PlaylistListModel::Type_Folder, PlaylistListModel::Role_Type);
 
   ReloadSettings();
@@ -340,6 +350,22 @@ void PlaylistListContainer::ItemsSelectedChanged(const bool selected) {
   ui_->save_playlist->setEnabled(selected);
 }
 
+void PlaylistListContainer::Search() {
+
+  if (!app_) return;
+
+  const QString text = ui_->search_field->text().trimmed();
+  if (text.isEmpty()) {
+    proxy_->ClearFilterPlaylists();
+    return;
+  }
+
+  // The backend searches the saved items of every playlist, so tabs don't have to be opened and filtered one by one.
+  proxy_->SetFilterPlaylists(app_->playlist_backend()->SearchPlaylists(text));
+  ui_->tree->expandAll();
+
+}
+
 void PlaylistListContainer::ItemDoubleClicked(const QModelIndex &proxy_idx) {
 
   const QModelIndex idx = proxy_->mapToSource(proxy_idx);
@@ -33,7 +33,7 @@
 #include "core/scoped_ptr.h"
 
 class QStandardItem;
-class QSortFilterProxyModel;
+class QTimer;
 class QMenu;
 class QAction;
 class QContextMenuEvent;
@@ -42,6 +42,7 @@ class QShowEvent;
 class Application;
 class Playlist;
 class PlaylistListModel;
+class PlaylistListSortFilterModel;
 class Ui_PlaylistListContainer;
 class OrganizeDialog;
 
@@ -83,12 +84,15 @@ class PlaylistListContainer : public QWidget {
   void ActiveStopped();
 
   void ItemsSelectedChanged(const bool selected);
+  void Search();
 
   void SavePlaylist();
   void Delete();
   void CopyToDevice();
 
  private:
+  static const int kSearchDelayMsec;
+
   QStandardItem *ItemForPlaylist(const QString &name, int id);
   QStandardItem *ItemForFolder(const QString &name) const;
   void RecursivelySetIcons(QStandardItem *parent) const;
@@ -109,7 +113,8 @@ class PlaylistListContainer : public QWidget {
 #endif
 
   PlaylistListModel *model_;
-  QSortFilterProxyModel *proxy_;
+  PlaylistListSortFilterModel *proxy_;
+  QTimer *search_timer_;
 
   bool loaded_icons_;
   QIcon padded_play_icon_;
@@ -23,13 +23,42 @@
 #define PLAYLISTLISTSORTFILTERMODEL_H
 
 #include <QSortFilterProxyModel>
+#include <QList>
+#include <QSet>
+
+#include "playlistlistmodel.h"
 
 class PlaylistListSortFilterModel : public QSortFilterProxyModel {
   Q_OBJECT
 
  public:
   explicit PlaylistListSortFilterModel(QObject *parent)
-      : QSortFilterProxyModel(parent) {}
+      : QSortFilterProxyModel(parent), filter_enabled_(false) {
+    // Folders are shown when any playlist in them is.
+    setRecursiveFilteringEnabled(true);
+  }
+
+  // Only shows these playlists, and the folders they are in.
+  void SetFilterPlaylists(const QList<int> &ids) {
+    filter_enabled_ = true;
+    filter_ids_.clear();
+    for (const int id : ids) filter_ids_.insert(id);
+    invalidateFilter();
+  }
+
+  void ClearFilterPlaylists() {
+    if (!filter_enabled_) return;
+    filter_enabled_ = false;
+    filter_ids_.clear();
+    invalidateFilter();
+  }
+
+  bool filterAcceptsRow(const int source_row, const QModelIndex &source_parent) const override {
+    if (!filter_enabled_) return true;
+    const QModelIndex idx = sourceModel()->index(source_row, 0, source_parent);
+    if (idx.data(PlaylistListModel::Role_Type).toInt() != PlaylistListModel::Type_Playlist) return false;
+    return filter_ids_.contains(idx.data(PlaylistListModel::Role_PlaylistId).toInt());
+  }
 
   bool lessThan(const QModelIndex &left, const QModelIndex &right) const override {
     // Compare the display text first.
@@ -40,6 +69,10 @@ class PlaylistListSortFilterModel : public QSortFilterProxyModel {
     // Now use the source model row order to ensure we always get a deterministic sorting even when two items are named the same.
     return left.row() < right.row();
   }
+
+ private:
+  bool filter_enabled_;
+  QSet<int> filter_ids_;
 };
 
 #endif  // PLAYLISTLISTSORTFILTERMODEL_H
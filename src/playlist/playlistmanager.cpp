@@ -41,9 +41,12 @@
 #include <QScrollBar>
 #include <QSettings>
 #include <QMessageBox>
+#include <QTimer>
+#include <QDateTime>
 
 #include "core/shared_ptr.h"
 #include "core/application.h"
+#include "core/logging.h"
 #include "core/player.h"
 #include "core/settings.h"
 #include "utilities/filenameconstants.h"
@@ -63,6 +66,9 @@
 
 class ParserBase;
 
+const int PlaylistManager::kDefaultUnloadInactiveMinutes = 60;
+const int PlaylistManager::kUnloadCheckIntervalMsec = 60000;
+
 PlaylistManager::PlaylistManager(Application *app, QObject *parent)
     : PlaylistManagerInterface(app, parent),
       app_(app),
@@ -71,6 +77,7 @@ PlaylistManager::PlaylistManager(Application *app, QObject *parent)
       sequence_(nullptr),
       parser_(nullptr),
       playlist_container_(nullptr),
+      timer_unload_(new QTimer(this)),
       current_(-1),
       active_(-1),
       playlists_loading_(0) {
@@ -79,6 +86,9 @@ PlaylistManager::PlaylistManager(Application *app, QObject *parent)
   QObject::connect(&*app_->player(), &Player::Playing, this, &PlaylistManager::SetActivePlaying);
   QObject::connect(&*app_->player(), &Player::Stopped, this, &PlaylistManager::SetActiveStopped);
 
+  timer_unload_->setInterval(kUnloadCheckIntervalMsec);
+  QObject::connect(timer_unload_, &QTimer::timeout, this, &PlaylistManager::UnloadInactivePlaylists);
+
 }
 
 PlaylistManager::~PlaylistManager() {
@@ -99,20 +109,48 @@ void PlaylistManager::Init(SharedPtr<CollectionBackend> collection_backend, Shar
   QObject::connect(&*collection_backend_, &CollectionBackend::SongsDiscovered, this, &PlaylistManager::SongsDiscovered);
   QObject::connect(&*collection_backend_, &CollectionBackend::SongsStatisticsChanged, this, &PlaylistManager::SongsDiscovered);
   QObject::connect(&*collection_backend_, &CollectionBackend::SongsRatingChanged, this, &PlaylistManager::SongsDiscovered);
+  QObject::connect(&*collection_backend_, &CollectionBackend::SongsDeleted, this, &PlaylistManager::SongsDeleted);
 
   for (const PlaylistBackend::Playlist &p : playlist_backend->GetAllOpenPlaylists()) {
-    ++playlists_loading_;
-    Playlist *ret = AddPlaylist(p.id, p.name, p.special_type, p.ui_path, p.favorite);
-    QObject::connect(ret, &Playlist::PlaylistLoaded, this, &PlaylistManager::PlaylistLoaded);
+    AddPlaylist(p.id, p.name, p.special_type, p.ui_path, p.favorite);
+  }
+
+  // Only the current and active playlists are restored now, the others are restored when they're first shown.
+  for (const Data &data : std::as_const(playlists_)) {
+    if (data.p->restore_requested() && !data.p->restored()) {
+      ++playlists_loading_;
+      QObject::connect(data.p, &Playlist::PlaylistLoaded, this, &PlaylistManager::PlaylistLoaded);
+    }
   }
 
   // If no playlist exists then make a new one
   if (playlists_.isEmpty()) New(tr("Playlist"));
 
+  timer_unload_->start();
+
   emit PlaylistManagerInitialized();
 
 }
 
+void PlaylistManager::UnloadInactivePlaylists() {
+
+  Settings s;
+  s.beginGroup(PlaylistSettingsPage::kSettingsGroup);
+  const int minutes = s.value("unload_inactive_minutes", kDefaultUnloadInactiveMinutes).toInt();
+  s.endGroup();
+
+  if (minutes <= 0) return;
+
+  const qint64 now = QDateTime::currentMSecsSinceEpoch();
+  for (QMap<int, Data>::const_iterator it = playlists_.constBegin(); it != playlists_.constEnd(); ++it) {
+    if (it.key() == current_ || it.key() == active_ || now - it->last_used < static_cast<qint64>(minutes) * 60000) continue;
+    if (it->p->Unload()) {
+      qLog(Debug) << "Unloaded inactive playlist" << it.key();
+    }
+  }
+
+}
+
 void PlaylistManager::PlaylistLoaded() {
 
   Playlist *playlist = qobject_cast<Playlist*>(sender());
@@ -161,6 +199,7 @@ Playlist *PlaylistManager::AddPlaylist(const int id, const QString &name, const
   QObject::connect(&*app_->current_albumcover_loader(), &CurrentAlbumCoverLoader::AlbumCoverLoaded, ret, &Playlist::AlbumCoverLoaded);
 
   playlists_[id] = Data(ret, name);
+  playlists_[id].last_used = QDateTime::currentMSecsSinceEpoch();
 
   emit PlaylistAdded(id, name, favorite);
 
@@ -214,11 +253,11 @@ void PlaylistManager::Load(const QString &filename) {
 
 void PlaylistManager::Save(const int id, const QString &filename, const PlaylistSettingsPage::PathType path_type) {
 
-  if (playlists_.contains(id)) {
+  if (playlists_.contains(id) && playlist(id)->restored()) {
     parser_->Save(playlist(id)->GetAllSongs(), filename, path_type);
   }
   else {
-    // Playlist is not in the playlist manager: probably save action was triggered from the left sidebar and the playlist isn't loaded.
+    // Playlist is not in the playlist manager, or its items aren't loaded: probably save action was triggered from the left sidebar and the playlist isn't loaded.
 #if QT_VERSION >= QT_VERSION_CHECK(6, 0, 0)
     QFuture<SongList> future = QtConcurrent::run(&PlaylistBackend::GetPlaylistSongs, playlist_backend_, id);
 #else
@@ -363,9 +402,12 @@ void PlaylistManager::SetCurrentPlaylist(const int id) {
   // Save the scroll position for the current playlist.
   if (playlists_.contains(current_)) {
     playlists_[current_].scroll_position = playlist_container_->view()->verticalScrollBar()->value();
+    playlists_[current_].last_used = QDateTime::currentMSecsSinceEpoch();
   }
 
   current_ = id;
+  playlists_[id].last_used = QDateTime::currentMSecsSinceEpoch();
+  current()->RestoreIfNeeded();
   emit CurrentChanged(current(), playlists_[id].scroll_position);
   UpdateSummaryText();
 
@@ -376,9 +418,14 @@ void PlaylistManager::SetActivePlaylist(const int id) {
   Q_ASSERT(playlists_.contains(id));
 
   // Kinda a hack: unset the current item from the old active playlist before setting the new one
-  if (active_ != -1 && active_ != id) active()->set_current_row(-1);
+  if (active_ != -1 && active_ != id) {
+    active()->set_current_row(-1);
+    playlists_[active_].last_used = QDateTime::currentMSecsSinceEpoch();
+  }
 
   active_ = id;
+  playlists_[id].last_used = QDateTime::currentMSecsSinceEpoch();
+  active()->RestoreIfNeeded();
 
   emit ActiveChanged(active());
 
@@ -467,16 +514,29 @@ void PlaylistManager::SongsDiscovered(const SongList &songs) {
 
   // Some songs might've changed in the collection, let's update any playlist items we have that match those songs
 
-  for (const Song &song : songs) {
-    for (const Data &data : std::as_const(playlists_)) {
+  for (const Data &data : std::as_const(playlists_)) {
+    PlaylistItemPtrList changed_items;
+    for (const Song &song : songs) {
       PlaylistItemPtrList items = data.p->collection_items_by_id(song.id());
       for (PlaylistItemPtr item : items) {
         if (item->Metadata().directory_id() != song.directory_id()) continue;
         item->SetMetadata(song);
         if (item->HasTemporaryMetadata()) item->UpdateTemporaryMetadata(song);
-        data.p->ItemChanged(item);
+        changed_items << item;
       }
     }
+    // The changed rows of each playlist are emitted together
+    data.p->ItemsChanged(changed_items);
+
+    data.p->UpdateLiveSongs(songs);
+  }
+
+}
+
+void PlaylistManager::SongsDeleted(const SongList &songs) {
+
+  for (const Data &data : std::as_const(playlists_)) {
+    data.p->RemoveLiveSongs(songs);
   }
 
 }
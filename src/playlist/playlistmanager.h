@@ -40,6 +40,7 @@
 #include "smartplaylists/playlistgenerator.h"
 
 class QModelIndex;
+class QTimer;
 
 class Application;
 class CollectionBackend;
@@ -146,6 +147,8 @@ class PlaylistManager : public PlaylistManagerInterface {
   explicit PlaylistManager(Application *app, QObject *parent = nullptr);
   ~PlaylistManager() override;
 
+  static const int kDefaultUnloadInactiveMinutes;
+
   int current_id() const override { return current_; }
   int active_id() const override { return active_; }
 
@@ -234,27 +237,34 @@ class PlaylistManager : public PlaylistManagerInterface {
   void OneOfPlaylistsChanged();
   void UpdateSummaryText();
   void SongsDiscovered(const SongList &songs);
+  void SongsDeleted(const SongList &songs);
   void ItemsLoadedForSavePlaylist(const SongList &songs, const QString &filename, const PlaylistSettingsPage::PathType path_type);
   void PlaylistLoaded();
+  void UnloadInactivePlaylists();
 
  private:
   Playlist *AddPlaylist(const int id, const QString &name, const QString &special_type, const QString &ui_path, const bool favorite);
 
  private:
   struct Data {
-    explicit Data(Playlist *_p = nullptr, const QString &_name = QString()) : p(_p), name(_name), scroll_position(0) {}
+    explicit Data(Playlist *_p = nullptr, const QString &_name = QString()) : p(_p), name(_name), scroll_position(0), last_used(0) {}
     Playlist *p;
     QString name;
     QItemSelection selection;
     int scroll_position;
+    // When the playlist was last current or active, in milliseconds since the epoch.
+    qint64 last_used;
   };
 
+  static const int kUnloadCheckIntervalMsec;
+
   Application *app_;
   SharedPtr<PlaylistBackend> playlist_backend_;
   SharedPtr<CollectionBackend> collection_backend_;
   PlaylistSequence *sequence_;
   PlaylistParser *parser_;
   PlaylistContainer *playlist_container_;
+  QTimer *timer_unload_;
 
   // key = id
   QMap<int, Data> playlists_;
@@ -223,7 +223,7 @@ void PlaylistTabBar::CloseSlot() {
 
   const bool ask_for_delete = s.value("warn_close_playlist", true).toBool();
 
-  if (ask_for_delete && !manager_->IsPlaylistFavorite(playlist_id) && !manager_->playlist(playlist_id)->GetAllSongs().empty()) {
+  if (ask_for_delete && !manager_->IsPlaylistFavorite(playlist_id) && (!manager_->playlist(playlist_id)->restored() || !manager_->playlist(playlist_id)->GetAllSongs().empty())) {
     QMessageBox confirmation_box;
     confirmation_box.setWindowIcon(QIcon(QStringLiteral(":/icons/64x64/strawberry.png")));
     confirmation_box.setWindowTitle(tr("Remove playlist"));
@@ -54,15 +54,14 @@ void InsertItems::undo() {
   playlist_->RemoveItemsWithoutUndo(start, static_cast<int>(items_.count()));
 }
 
-bool InsertItems::UpdateItem(const PlaylistItemPtr &updated_item) {
-  for (int i = 0; i < items_.size(); i++) {
-    PlaylistItemPtr item = items_[i];
-    if (item->Metadata().url() == updated_item->Metadata().url()) {
-      items_[i] = updated_item;
-      return true;
+void InsertItems::UpdateItems(QHash<QUrl, PlaylistItemPtr> *updated_items) {
+  for (int i = 0; i < items_.size() && !updated_items->isEmpty(); i++) {
+    auto it = updated_items->find(items_[i]->Metadata().url());
+    if (it != updated_items->end()) {
+      items_[i] = it.value();
+      updated_items->erase(it);
     }
   }
-  return false;
 }
 
 
@@ -25,6 +25,8 @@
 
 #include <QCoreApplication>
 #include <QList>
+#include <QHash>
+#include <QUrl>
 #include <QUndoStack>
 
 #include "playlistitem.h"
@@ -54,9 +56,9 @@ namespace PlaylistUndoCommands {
     void undo() override;
     void redo() override;
     // When load is async, items have already been pushed, so we need to update them.
-    // This function try to find the equivalent item, and replace it with the new (completely loaded) one.
-    // Return true if the was found (and updated), false otherwise
-    bool UpdateItem(const PlaylistItemPtr &updated_item);
+    // This function replaces the items with the same URL as the new (completely loaded) ones.
+    // The ones that were found (and updated) are removed from updated_items.
+    void UpdateItems(QHash<QUrl, PlaylistItemPtr> *updated_items);
 
    private:
     PlaylistItemPtrList items_;
@@ -51,6 +51,7 @@
 #include <QBrush>
 #include <QPen>
 #include <QPoint>
+#include <QCursor>
 #include <QRect>
 #include <QRegion>
 #include <QStyleOptionViewItem>
@@ -82,6 +83,7 @@
 #endif
 
 const int PlaylistView::kGlowIntensitySteps = 24;
+const int PlaylistView::kRowCacheSizeKB = 16384;
 const int PlaylistView::kAutoscrollGraceTimeout = 30;  // seconds
 const int PlaylistView::kDropIndicatorWidth = 2;
 const int PlaylistView::kDropIndicatorGradientWidth = 5;
@@ -131,6 +133,7 @@ PlaylistView::PlaylistView(QWidget *parent)
       currenttrack_play_(QStringLiteral(":/pictures/currenttrack_play.png")),
       currenttrack_pause_(QStringLiteral(":/pictures/currenttrack_pause.png")),
       cached_current_row_row_(-1),
+      hover_row_(-1),
       drop_indicator_row_(-1),
       drag_over_(false),
       header_state_version_(1),
@@ -152,6 +155,8 @@ PlaylistView::PlaylistView(QWidget *parent)
   setVerticalScrollMode(QAbstractItemView::ScrollPerPixel);
 #endif
 
+  cached_rows_.setMaxCost(kRowCacheSizeKB);
+
   QObject::connect(header_, &PlaylistHeader::sectionResized, this, &PlaylistView::SetHeaderState);
   QObject::connect(header_, &PlaylistHeader::sectionMoved, this, &PlaylistView::SetHeaderState);
   QObject::connect(header_, &PlaylistHeader::sortIndicatorChanged, this, &PlaylistView::SetHeaderState);
@@ -160,6 +165,9 @@ PlaylistView::PlaylistView(QWidget *parent)
   QObject::connect(header_, &PlaylistHeader::sectionResized, this, &PlaylistView::InvalidateCachedCurrentPixmap);
   QObject::connect(header_, &PlaylistHeader::sectionMoved, this, &PlaylistView::InvalidateCachedCurrentPixmap);
   QObject::connect(header_, &PlaylistHeader::SectionVisibilityChanged, this, &PlaylistView::InvalidateCachedCurrentPixmap);
+  QObject::connect(header_, &PlaylistHeader::sectionResized, this, &PlaylistView::InvalidateCachedRows);
+  QObject::connect(header_, &PlaylistHeader::sectionMoved, this, &PlaylistView::InvalidateCachedRows);
+  QObject::connect(header_, &PlaylistHeader::SectionVisibilityChanged, this, &PlaylistView::InvalidateCachedRows);
   QObject::connect(header_, &PlaylistHeader::StretchEnabledChanged, this, &PlaylistView::StretchChanged);
 
   QObject::connect(header_, &PlaylistHeader::SectionRatingLockStatusChanged, this, &PlaylistView::SetRatingLockStatus);
@@ -243,18 +251,31 @@ void PlaylistView::SetItemDelegates() {
 void PlaylistView::setModel(QAbstractItemModel *m) {
 
   if (model()) {
-    QObject::disconnect(model(), &QAbstractItemModel::dataChanged, this, &PlaylistView::InvalidateCachedCurrentPixmap);
+    QObject::disconnect(model(), &QAbstractItemModel::dataChanged, this, &PlaylistView::ModelDataChanged);
     QObject::disconnect(model(), &QAbstractItemModel::layoutAboutToBeChanged, this, &PlaylistView::RatingHoverOut);
+    QObject::disconnect(model(), &QAbstractItemModel::rowsInserted, this, &PlaylistView::InvalidateCachedRows);
+    QObject::disconnect(model(), &QAbstractItemModel::rowsRemoved, this, &PlaylistView::InvalidateCachedRows);
+    QObject::disconnect(model(), &QAbstractItemModel::rowsMoved, this, &PlaylistView::InvalidateCachedRows);
+    QObject::disconnect(model(), &QAbstractItemModel::layoutChanged, this, &PlaylistView::InvalidateCachedRows);
+    QObject::disconnect(model(), &QAbstractItemModel::modelReset, this, &PlaylistView::InvalidateCachedRows);
 
     // When changing the model, always invalidate the current pixmap.
     // If a remote client uses "stop after", without invaliding the stop mark would not appear.
     InvalidateCachedCurrentPixmap();
   }
 
+  InvalidateCachedRows();
+
   QTreeView::setModel(m);
 
-  QObject::connect(model(), &QAbstractItemModel::dataChanged, this, &PlaylistView::InvalidateCachedCurrentPixmap);
+  QObject::connect(model(), &QAbstractItemModel::dataChanged, this, &PlaylistView::ModelDataChanged);
   QObject::connect(model(), &QAbstractItemModel::layoutAboutToBeChanged, this, &PlaylistView::RatingHoverOut);
+  // The cached rows are drawn by row number, so they're gone when rows change places.
+  QObject::connect(model(), &QAbstractItemModel::rowsInserted, this, &PlaylistView::InvalidateCachedRows);
+  QObject::connect(model(), &QAbstractItemModel::rowsRemoved, this, &PlaylistView::InvalidateCachedRows);
+  QObject::connect(model(), &QAbstractItemModel::rowsMoved, this, &PlaylistView::InvalidateCachedRows);
+  QObject::connect(model(), &QAbstractItemModel::layoutChanged, this, &PlaylistView::InvalidateCachedRows);
+  QObject::connect(model(), &QAbstractItemModel::modelReset, this, &PlaylistView::InvalidateCachedRows);
 
 }
 
@@ -463,6 +484,7 @@ void PlaylistView::LoadTinyPlayPausePixmaps(const int desired_size) {
 void PlaylistView::drawTree(QPainter *painter, const QRegion &region) const {
 
   const_cast<PlaylistView*>(this)->current_paint_region_ = region;
+  const_cast<PlaylistView*>(this)->hover_row_ = indexAt(viewport()->mapFromGlobal(QCursor::pos())).row();
   QTreeView::drawTree(painter, region);
   const_cast<PlaylistView*>(this)->current_paint_region_ = QRegion();
 
@@ -565,11 +587,99 @@ void PlaylistView::drawRow(QPainter *painter, const QStyleOptionViewItem &option
     }
   }
   else {
-    QTreeView::drawRow(painter, opt, idx);
+    DrawCachedRow(painter, opt, idx);
+  }
+
+}
+
+void PlaylistView::DrawCachedRow(QPainter *painter, const QStyleOptionViewItem &option, const QModelIndex &idx) const {
+
+  // Same as for the current row, the cache can only be updated when the entire row is drawn.
+  // The rating delegate draws the stars under the mouse differently, so those rows aren't cached while hovering.
+  const bool whole_region = current_paint_region_.boundingRect().width() == viewport()->width();
+  if (!whole_region || rating_delegate_->mouse_over_index().isValid() || state() == QAbstractItemView::EditingState) {
+    QTreeView::drawRow(painter, option, idx);
+    return;
+  }
+
+  const QModelIndex current_index = currentIndex();
+  const bool is_current_row = current_index.isValid() && current_index.row() == idx.row();
+  quint64 state = static_cast<quint64>(option.state);
+  if (selectionModel()->isRowSelected(idx.row(), idx.parent())) state |= 1ULL << 32;
+  if (is_current_row) state |= 1ULL << 33;
+  if (hover_row_ == idx.row()) state |= 1ULL << 34;
+  if (hasFocus()) state |= 1ULL << 35;
+  const int current_column = is_current_row ? current_index.column() : -1;
+
+  CachedRow *cached_row = cached_rows_.object(idx.row());
+  if (!cached_row || cached_row->x != option.rect.x() || cached_row->size != option.rect.size() || cached_row->state != state || cached_row->current_column != current_column) {
+    cached_row = new CachedRow;
+    cached_row->x = option.rect.x();
+    cached_row->size = option.rect.size();
+    cached_row->state = state;
+    cached_row->current_column = current_column;
+    cached_row->pixmap = QPixmap(static_cast<int>(option.rect.width() * device_pixel_ratio_), static_cast<int>(option.rect.height() * device_pixel_ratio_));
+    cached_row->pixmap.setDevicePixelRatio(device_pixel_ratio_);
+    cached_row->pixmap.fill(Qt::transparent);
+
+    QStyleOptionViewItem opt(option);
+    opt.rect.moveTo(0, 0);
+    QPainter p(&cached_row->pixmap);
+    QTreeView::drawRow(&p, opt, idx);
+    p.end();
+
+    const int cost = std::max(1, static_cast<int>(static_cast<qint64>(cached_row->pixmap.width()) * cached_row->pixmap.height() * 4 / 1024));
+    if (!cached_rows_.insert(idx.row(), cached_row, cost)) {
+      // Too big for the cache, it was deleted.
+      QTreeView::drawRow(painter, option, idx);
+      return;
+    }
+  }
+
+  painter->drawPixmap(option.rect, cached_row->pixmap);
+
+}
+
+void PlaylistView::InvalidateCachedRows() {
+  cached_rows_.clear();
+}
+
+void PlaylistView::ModelDataChanged(const QModelIndex &top_left, const QModelIndex &bottom_right) {
+
+  if (!top_left.isValid() || !bottom_right.isValid()) {
+    InvalidateCachedCurrentPixmap();
+    InvalidateCachedRows();
+    return;
+  }
+
+  // Only the rows that changed are drawn again, so the current row keeps glowing from its cached pixmap when other rows change.
+  if (cached_current_row_row_ >= top_left.row() && cached_current_row_row_ <= bottom_right.row()) {
+    InvalidateCachedCurrentPixmap();
+  }
+  for (int row = top_left.row(); row <= bottom_right.row(); ++row) {
+    cached_rows_.remove(row);
   }
 
 }
 
+void PlaylistView::changeEvent(QEvent *event) {
+
+  switch (event->type()) {
+    case QEvent::PaletteChange:
+    case QEvent::StyleChange:
+    case QEvent::FontChange:
+    case QEvent::ActivationChange:
+      InvalidateCachedCurrentPixmap();
+      InvalidateCachedRows();
+      break;
+    default:
+      break;
+  }
+
+  QTreeView::changeEvent(event);
+
+}
+
 void PlaylistView::UpdateCachedCurrentRowPixmap(QStyleOptionViewItem option, const QModelIndex &idx) {  // clazy:exclude=function-args-by-ref
 
   cached_current_row_rect_ = option.rect;
@@ -898,6 +1008,7 @@ void PlaylistView::scrollContentsBy(int dx, int dy) {
 
   if (dx != 0) {
     InvalidateCachedCurrentPixmap();
+    InvalidateCachedRows();
   }
   cached_tree_ = QPixmap();
 
@@ -1173,6 +1284,8 @@ void PlaylistView::PlaylistDestroyed() {
 
 void PlaylistView::ReloadSettings() {
 
+  InvalidateCachedRows();
+
   Settings s;
 
   s.beginGroup(PlaylistSettingsPage::kSettingsGroup);
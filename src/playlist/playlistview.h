@@ -42,6 +42,7 @@
 #include <QStyleOption>
 #include <QPoint>
 #include <QBasicTimer>
+#include <QCache>
 
 #include "core/song.h"
 #include "covermanager/albumcoverloaderresult.h"
@@ -133,6 +134,7 @@ class PlaylistView : public QTreeView {
   bool eventFilter(QObject *object, QEvent *event) override;
   void focusInEvent(QFocusEvent *event) override;
   void resizeEvent(QResizeEvent *event) override;
+  void changeEvent(QEvent *event) override;
 
   // QTreeView
   void drawTree(QPainter *painter, const QRegion &region) const;
@@ -152,6 +154,8 @@ class PlaylistView : public QTreeView {
   void InhibitAutoscrollTimeout();
   void MaybeAutoscroll(const Playlist::AutoScroll autoscroll);
   void InvalidateCachedCurrentPixmap();
+  void InvalidateCachedRows();
+  void ModelDataChanged(const QModelIndex &top_left, const QModelIndex &bottom_right);
   void PlaylistDestroyed();
   void StretchChanged(const bool stretch);
   void FadePreviousBackgroundImage(const qreal value);
@@ -189,6 +193,7 @@ class PlaylistView : public QTreeView {
 
  private:
   static const int kGlowIntensitySteps;
+  static const int kRowCacheSizeKB;
   static const int kAutoscrollGraceTimeout;
   static const int kDropIndicatorWidth;
   static const int kDropIndicatorGradientWidth;
@@ -266,6 +271,20 @@ class PlaylistView : public QTreeView {
   QRect cached_current_row_rect_;
   int cached_current_row_row_;
 
+  // Pixmaps of the other rows, so repainting them doesn't fetch, format and elide the text of every cell again.
+  // The state is what QTreeView::drawRow draws differently for the same data.
+  struct CachedRow {
+    CachedRow() : x(0), state(0), current_column(-1) {}
+    int x;
+    QSize size;
+    quint64 state;
+    int current_column;
+    QPixmap pixmap;
+  };
+  void DrawCachedRow(QPainter *painter, const QStyleOptionViewItem &option, const QModelIndex &idx) const;
+  mutable QCache<int, CachedRow> cached_rows_;
+  int hover_row_;
+
   QPixmap cached_tree_;
   int drop_indicator_row_;
   bool drag_over_;
@@ -21,9 +21,13 @@
 
 #include "config.h"
 
+#include <utility>
+#include <vector>
+
 #include <QtConcurrent>
 #include <QtAlgorithms>
 #include <QList>
+#include <QHash>
 #include <QUrl>
 
 #include "core/logging.h"
@@ -33,6 +37,10 @@
 #include "playlist.h"
 #include "songloaderinserter.h"
 
+const int SongLoaderInserter::kBatchSize = 500;
+const int SongLoaderInserter::kBatchIntervalMsec = 200;
+const int SongLoaderInserter::kMaxParallelLoads = 4;
+
 SongLoaderInserter::SongLoaderInserter(SharedPtr<TaskManager> task_manager, SharedPtr<CollectionBackendInterface> collection_backend, const SharedPtr<Player> player, QObject *parent)
     : QObject(parent),
       task_manager_(task_manager),
@@ -41,6 +49,9 @@ SongLoaderInserter::SongLoaderInserter(SharedPtr<TaskManager> task_manager, Shar
       play_now_(true),
       enqueue_(false),
       enqueue_next_(false),
+      stream_(true),
+      first_loaded_(false),
+      found_songs_(0),
       collection_backend_(collection_backend),
       player_(player) {}
 
@@ -53,15 +64,23 @@ void SongLoaderInserter::Load(Playlist *destination, int row, bool play_now, boo
   play_now_ = play_now;
   enqueue_ = enqueue;
   enqueue_next_ = enqueue_next;
+  stream_ = !enqueue_next;
 
   QObject::connect(destination, &Playlist::destroyed, this, &SongLoaderInserter::DestinationDestroyed);
-  QObject::connect(this, &SongLoaderInserter::PreloadFinished, this, &SongLoaderInserter::InsertSongs);
+  QObject::connect(this, &SongLoaderInserter::SongsLoaded, this, &SongLoaderInserter::InsertSongs);
   QObject::connect(this, &SongLoaderInserter::EffectiveLoadFinished, destination, &Playlist::UpdateItems);
 
+  // Look up all local files in the collection at once, instead of a query for each file.
+  QList<QUrl> local_urls;
+  for (const QUrl &url : urls) {
+    if (url.isLocalFile()) local_urls << url;
+  }
+  const QHash<QUrl, SongList> collection_songs = collection_backend_->GetSongsByUrls(local_urls);
+
   for (const QUrl &url : urls) {
     SongLoader *loader = new SongLoader(collection_backend_, player_, this);
 
-    SongLoader::Result ret = loader->Load(url);
+    SongLoader::Result ret = loader->Load(url, collection_songs);
 
     if (ret == SongLoader::Result::BlockingLoadRequired) {
       pending_.append(loader);
@@ -80,10 +99,13 @@ void SongLoaderInserter::Load(Playlist *destination, int row, bool play_now, boo
   }
 
   if (pending_.isEmpty()) {
-    InsertSongs();
+    InsertSongs(songs_);
     deleteLater();
   }
   else {
+    // The songs from the collection are already complete, they're inserted first.
+    batch_ = songs_;
+    first_loaded_ = !songs_.isEmpty();
 #if QT_VERSION >= QT_VERSION_CHECK(6, 0, 0)
     (void)QtConcurrent::run(&SongLoaderInserter::AsyncLoad, this);
 #else
@@ -134,7 +156,7 @@ void SongLoaderInserter::AudioCDTracksLoadFinished(SongLoader *loader) {
     }
   }
   else {
-    InsertSongs();
+    InsertSongs(songs_);
   }
 
 }
@@ -155,66 +177,121 @@ void SongLoaderInserter::AudioCDTagsLoaded(const bool success) {
 
 }
 
-void SongLoaderInserter::InsertSongs() {
+void SongLoaderInserter::InsertSongs(const SongList &songs) {
 
   // Insert songs (that haven't been completely loaded) to allow user to see and play them while not loaded completely
-  if (destination_) {
-    destination_->InsertSongsOrCollectionItems(songs_, row_, play_now_, enqueue_, enqueue_next_);
+  if (!destination_) return;
+
+  // Rows could have been removed since the previous batch was inserted.
+  if (row_ > destination_->rowCount()) row_ = -1;
+
+  destination_->InsertSongsOrCollectionItems(songs, row_, play_now_, enqueue_, enqueue_next_);
+
+  // The next batch goes after this one, and only the first one can start playing.
+  if (row_ != -1) row_ += static_cast<int>(songs.count());
+  play_now_ = false;
+
+}
+
+void SongLoaderInserter::AddSongs(SongLoader *loader, SongList songs) {
+
+  if (songs.isEmpty()) return;
+
+  if (!first_loaded_) {
+    // Load everything from the first song.
+    // It'll start playing as soon as it's inserted, so it needs to have the duration set to show properly in the UI.
+    loader->EffectiveSongLoad(&songs[0]);
+    first_loaded_ = true;
+  }
+
+  batch_ << songs;
+
+  if (stream_ && (batch_.count() >= kBatchSize || batch_timer_.hasExpired(kBatchIntervalMsec))) {
+    FlushSongs();
+  }
+
+}
+
+void SongLoaderInserter::FlushSongs() {
+
+  if (!batch_.isEmpty()) {
+    emit SongsLoaded(batch_);
+    batch_.clear();
   }
+  batch_timer_.restart();
 
 }
 
 void SongLoaderInserter::AsyncLoad() {
 
-  // First, quick load raw songs.
+  struct PendingLoad {
+    SongLoader *loader;
+    SongLoader::Result result;
+  };
+
+  // First, quick load raw songs, they're inserted in batches while the rest is loading.
   int async_progress = 0;
   int async_load_id = task_manager_->StartTask(tr("Loading tracks"));
   task_manager_->SetTaskProgress(async_load_id, async_progress, pending_.count());
-  bool first_loaded = false;
-  for (int i = 0; i < pending_.count(); ++i) {
-    SongLoader *loader = pending_[i];
-    SongLoader::Result res = loader->LoadFilenamesBlocking();
-    task_manager_->SetTaskProgress(async_load_id, ++async_progress);
-
-    if (res == SongLoader::Result::Error) {
-      for (const QString &error : loader->errors()) {
-        emit Error(error);
+  batch_timer_.start();
+  if (stream_) FlushSongs();
+  for (int i = 0; i < pending_.count();) {
+    std::vector<PendingLoad> loads;
+    loads.push_back(PendingLoad{ pending_[i++], SongLoader::Result::Error });
+    SongLoader *loader = loads.front().loader;
+    if (loader->url().isLocalFile()) {
+      // Directories and playlists pass on their songs while they're loaded.
+      QMetaObject::Connection connection = QObject::connect(loader, &SongLoader::SongsFound, loader, [this, loader](const SongList &songs) {
+        found_songs_ += static_cast<int>(songs.count());
+        AddSongs(loader, songs);
+      }, Qt::DirectConnection);
+      loads.front().result = loader->LoadFilenamesBlocking();
+      QObject::disconnect(connection);
+    }
+    else {
+      // Remote URLs are mostly waiting for typefinding, so a few of them are loaded at the same time.
+      while (i < pending_.count() && static_cast<int>(loads.size()) < kMaxParallelLoads && !pending_[i]->url().isLocalFile()) {
+        loads.push_back(PendingLoad{ pending_[i++], SongLoader::Result::Error });
       }
-      continue;
+      QtConcurrent::blockingMap(loads, [](PendingLoad &load) { load.result = load.loader->LoadFilenamesBlocking(); });
     }
 
-    if (!first_loaded) {
-      // Load everything from the first song.
-      // It'll start playing as soon as we emit PreloadFinished, so it needs to have the duration set to show properly in the UI.
-      loader->LoadMetadataBlocking();
-      first_loaded = true;
-    }
+    for (const PendingLoad &load : loads) {
+      task_manager_->SetTaskProgress(async_load_id, ++async_progress);
 
-    songs_ << loader->songs();
+      if (load.result == SongLoader::Result::Error) {
+        for (const QString &error : load.loader->errors()) {
+          emit Error(error);
+        }
+        continue;
+      }
 
+      AddSongs(load.loader, load.loader->songs().mid(load.loader == loader ? found_songs_ : 0));
+    }
+    found_songs_ = 0;
   }
+  FlushSongs();
   task_manager_->SetTaskFinished(async_load_id);
-  emit PreloadFinished();
 
   // Songs are inserted in playlist, now load them completely.
+  SongList loaded_songs;
+  for (SongLoader *loader : std::as_const(pending_)) {
+    loaded_songs << loader->songs();
+  }
   async_progress = 0;
   async_load_id = task_manager_->StartTask(tr("Loading tracks info"));
-  task_manager_->SetTaskProgress(async_load_id, async_progress, songs_.count());
-  SongList songs;
-  for (int i = 0; i < pending_.count(); ++i) {
-    SongLoader *loader = pending_[i];
-    if (i != 0) {
-      // We already did this earlier for the first song.
-      loader->LoadMetadataBlocking();
-    }
-    songs << loader->songs();
-    task_manager_->SetTaskProgress(async_load_id, songs.count());
+  task_manager_->SetTaskProgress(async_load_id, async_progress, loaded_songs.count());
+  for (int i = 0; i < loaded_songs.count(); i += kBatchSize) {
+    // The songs in the collection are looked up for the whole batch at once.
+    SongList songs = loaded_songs.mid(i, kBatchSize);
+    SongLoader::EffectiveSongsLoad(collection_backend_, &songs);
+    async_progress += static_cast<int>(songs.count());
+    task_manager_->SetTaskProgress(async_load_id, async_progress);
+    // Replace the partially-loaded items by the new ones, fully loaded.
+    emit EffectiveLoadFinished(songs);
   }
   task_manager_->SetTaskFinished(async_load_id);
 
-  // Replace the partially-loaded items by the new ones, fully loaded.
-  emit EffectiveLoadFinished(songs);
-
   deleteLater();
 
 }
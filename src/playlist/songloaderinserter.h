@@ -28,6 +28,7 @@
 #include <QList>
 #include <QString>
 #include <QUrl>
+#include <QElapsedTimer>
 
 #include "core/shared_ptr.h"
 #include "core/song.h"
@@ -50,19 +51,25 @@ class SongLoaderInserter : public QObject {
 
  signals:
   void Error(const QString &message);
-  void PreloadFinished();
+  void SongsLoaded(const SongList &songs);
   void EffectiveLoadFinished(const SongList &songs);
 
  private slots:
   void DestinationDestroyed();
   void AudioCDTracksLoadFinished(SongLoader *loader);
   void AudioCDTagsLoaded(const bool success);
-  void InsertSongs();
+  void InsertSongs(const SongList &songs);
 
  private:
   void AsyncLoad();
+  void AddSongs(SongLoader *loader, SongList songs);
+  void FlushSongs();
 
  private:
+  static const int kBatchSize;
+  static const int kBatchIntervalMsec;
+  static const int kMaxParallelLoads;
+
   SharedPtr<TaskManager> task_manager_;
 
   Playlist *destination_;
@@ -73,6 +80,14 @@ class SongLoaderInserter : public QObject {
 
   SongList songs_;
 
+  // Only used from the loading thread.
+  // The loaded songs are inserted in batches, except when they're enqueued next, since the batches would end up in reverse order in the queue.
+  bool stream_;
+  bool first_loaded_;
+  int found_songs_;
+  SongList batch_;
+  QElapsedTimer batch_timer_;
+
   QList<SongLoader*> pending_;
   SharedPtr<CollectionBackendInterface> collection_backend_;
   const SharedPtr<Player> player_;
@@ -24,11 +24,14 @@
 #include "config.h"
 
 #include <QObject>
+#include <QList>
 #include <QMimeData>
 
 #include "core/shared_ptr.h"
 #include "core/mimedata.h"
 #include "core/song.h"
+#include "collection/collectionfilteroptions.h"
+#include "collection/collectionqueryoptions.h"
 
 class CollectionBackendInterface;
 
@@ -38,8 +41,19 @@ class SongMimeData : public MimeData {
  public:
   explicit SongMimeData(QObject* = nullptr) : MimeData(), backend(nullptr) {}
 
+  struct Query {
+    explicit Query(const int _position = 0, const CollectionQueryOptions &_query_options = CollectionQueryOptions()) : position(_position), query_options(_query_options) {}
+    // Index in songs that the songs returned by the query go before.
+    int position;
+    CollectionQueryOptions query_options;
+  };
+
   SharedPtr<CollectionBackendInterface> backend;
   SongList songs;
+
+  // Containers that weren't loaded when the selection was made, their songs are queried in the background when dropped.
+  CollectionFilterOptions filter_options;
+  QList<Query> queries;
 };
 
 #endif  // SONGMIMEDATA_H
@@ -25,6 +25,7 @@
 
 #include "core/tagreaderclient.h"
 #include "core/song.h"
+#include "core/songinterner.h"
 #include "core/sqlrow.h"
 #include "playlistitem.h"
 #include "songplaylistitem.h"
@@ -34,6 +35,7 @@ SongPlaylistItem::SongPlaylistItem(const Song &song) : PlaylistItem(song.source(
 
 bool SongPlaylistItem::InitFromQuery(const SqlRow &query) {
   song_.InitFromQuery(query, false, static_cast<int>(Song::kRowIdColumns.count()));
+  song_ = SongInterner::Intern(song_);
   return true;
 }
 
@@ -42,8 +44,9 @@ QUrl SongPlaylistItem::Url() const { return song_.url(); }
 void SongPlaylistItem::Reload() {
 
   if (!song_.url().isLocalFile()) return;
-  TagReaderClient::Instance()->ReadFileBlocking(song_.url().toLocalFile(), &song_);
+  TagReaderClient::Instance()->ReadFileBlocking(song_.url().toLocalFile(), &song_, TagReaderClient::ReadLevel::Full, TagReaderClient::Priority::Playback);
   UpdateTemporaryMetadata(song_);
+  DatabaseMetadataChanged();
 
 }
 
@@ -56,5 +59,6 @@ void SongPlaylistItem::SetArtManual(const QUrl &cover_url) {
 
   song_.set_art_manual(cover_url);
   if (HasTemporaryMetadata()) temp_metadata_.set_art_manual(cover_url);
+  DatabaseMetadataChanged();
 
 }
@@ -26,6 +26,7 @@
 #include <QFileInfo>
 #include <QDateTime>
 #include <QList>
+#include <QHash>
 #include <QString>
 #include <QStringList>
 #include <QRegularExpression>
@@ -244,11 +245,21 @@ SongList CueParser::Load(QIODevice *device, const QString &playlist_path, const
 
   QDateTime cue_mtime = QFileInfo(playlist_path).lastModified();
 
+  // Without collection search every track of a media file loads the same metadata from disk, so only read each media file once.
+  QHash<QString, Song> loaded_files;
+
   // Finalize parsing songs
   for (int i = 0; i < entries.length(); i++) {
     CueEntry entry = entries.at(i);
 
-    Song song = LoadSong(entry.file, IndexToMarker(entry.index), 0, dir, collection_search);
+    Song song;
+    if (!collection_search && loaded_files.contains(entry.file)) {
+      song = loaded_files.value(entry.file);
+    }
+    else {
+      song = LoadSong(entry.file, IndexToMarker(entry.index), 0, dir, collection_search);
+      if (!collection_search) loaded_files.insert(entry.file, song);
+    }
 
     // Cue song has mtime equal to qMax(media_file_mtime, cue_sheet_mtime)
     if (cue_mtime.isValid()) {
@@ -21,7 +21,7 @@
 #include <QObject>
 #include <QIODevice>
 #include <QDir>
-#include <QBuffer>
+#include <QList>
 #include <QByteArray>
 #include <QString>
 #include <QStringList>
@@ -47,22 +47,31 @@ SongList M3UParser::Load(QIODevice *device, const QString &playlist_path, const
   M3UType type = M3UType::STANDARD;
   Metadata current_metadata;
 
-  QString data = QString::fromUtf8(device->readAll());
-  data.replace(QLatin1Char('\r'), QLatin1Char('\n'));
-  data.replace(QLatin1String("\n\n"), QLatin1String("\n"));
-  QByteArray bytes = data.toUtf8();
-  QBuffer buffer(&bytes);
-  if (!buffer.open(QIODevice::ReadOnly)) return SongList();
+  // The playlist is read line by line, and the songs are loaded in batches while it's read.
+  // Lines are also split on '\r', for playlists with old Mac line endings.
+  QStringList lines;
+  auto read_line = [device, &lines](QString *line) {
+    while (lines.isEmpty()) {
+      if (device->atEnd()) return false;
+      lines = QString::fromUtf8(device->readLine()).split(QLatin1Char('\r'));
+    }
+    *line = lines.takeFirst().trimmed();
+    return true;
+  };
+
+  QString line;
+  if (!read_line(&line)) return SongList();
 
-  QString line = QString::fromUtf8(buffer.readLine()).trimmed();
   if (line.startsWith(QLatin1String("#EXTM3U"))) {
     // This is in extended M3U format.
     type = M3UType::EXTENDED;
-    line = QString::fromUtf8(buffer.readLine()).trimmed();
+    line.clear();
   }
 
   SongList ret;
-  forever {
+  QList<SongLocation> locations;
+  QList<Metadata> metadata;
+  do {
     if (line.startsWith(QLatin1Char('#'))) {
       // Extended info or comment.
       if (type == M3UType::EXTENDED && line.startsWith(QLatin1String("#EXT"))) {
@@ -72,29 +81,43 @@ SongList M3UParser::Load(QIODevice *device, const QString &playlist_path, const
       }
     }
     else if (!line.isEmpty()) {
-      Song song = LoadSong(line, 0, 0, dir, collection_search);
-      if (!current_metadata.title.isEmpty()) {
-        song.set_title(current_metadata.title);
-      }
-      if (!current_metadata.artist.isEmpty()) {
-        song.set_artist(current_metadata.artist);
-      }
-      if (current_metadata.length > 0) {
-        song.set_length_nanosec(current_metadata.length);
+      locations << SongLocation{ line, 0, 0 };
+      metadata << current_metadata;
+      current_metadata = Metadata();
+      if (locations.count() >= kLoadBatchSize) {
+        LoadBatch(locations, metadata, dir, collection_search, &ret);
+        locations.clear();
+        metadata.clear();
       }
-      ret << song;
+    }
+  } while (read_line(&line));
 
-      current_metadata = Metadata();
+  LoadBatch(locations, metadata, dir, collection_search, &ret);
+
+  return ret;
+
+}
+
+void M3UParser::LoadBatch(const QList<SongLocation> &locations, const QList<Metadata> &metadata, const QDir &dir, const bool collection_search, SongList *ret) const {
+
+  if (locations.isEmpty()) return;
+
+  SongList songs = LoadSongs(locations, dir, collection_search);
+  for (int i = 0; i < songs.count(); ++i) {
+    Song &song = songs[i];
+    if (!metadata[i].title.isEmpty()) {
+      song.set_title(metadata[i].title);
+    }
+    if (!metadata[i].artist.isEmpty()) {
+      song.set_artist(metadata[i].artist);
     }
-    if (buffer.atEnd()) {
-      break;
+    if (metadata[i].length > 0) {
+      song.set_length_nanosec(metadata[i].length);
     }
-    line = QString::fromUtf8(buffer.readLine()).trimmed();
   }
 
-  buffer.close();
-
-  return ret;
+  *ret << songs;
+  SongsLoaded(songs);
 
 }
 
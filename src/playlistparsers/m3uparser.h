@@ -25,6 +25,7 @@
 
 #include <QtGlobal>
 #include <QObject>
+#include <QList>
 #include <QByteArray>
 #include <QString>
 #include <QStringList>
@@ -70,6 +71,7 @@ class M3UParser : public ParserBase {
   };
 
   static bool ParseMetadata(const QString &line, Metadata *metadata);
+  void LoadBatch(const QList<SongLocation> &locations, const QList<Metadata> &metadata, const QDir &dir, const bool collection_search, SongList *ret) const;
 
 };
 
@@ -19,7 +19,11 @@
  *
  */
 
+#include <algorithm>
+
 #include <QtGlobal>
+#include <QList>
+#include <QHash>
 #include <QDir>
 #include <QFile>
 #include <QFileInfo>
@@ -34,13 +38,15 @@
 #include "settings/playlistsettingspage.h"
 #include "parserbase.h"
 
+const int ParserBase::kLoadBatchSize = 500;
+
 ParserBase::ParserBase(SharedPtr<CollectionBackendInterface> collection_backend, QObject *parent)
     : QObject(parent), collection_backend_(collection_backend) {}
 
-void ParserBase::LoadSong(const QString &filename_or_url, const qint64 beginning, const int track, const QDir &dir, Song *song, const bool collection_search) const {
+bool ParserBase::ResolveFilename(const QString &filename_or_url, const QDir &dir, Song *song, QString *filename_ret) const {
 
   if (filename_or_url.isEmpty()) {
-    return;
+    return false;
   }
 
   QString filename = filename_or_url;
@@ -55,11 +61,11 @@ void ParserBase::LoadSong(const QString &filename_or_url, const qint64 beginning
       song->set_url(QUrl::fromUserInput(filename_or_url));
       song->set_filetype(Song::FileType::Stream);
       song->set_valid(true);
-      return;
+      return false;
     }
     else {
       qLog(Error) << "Don't know how to handle" << url;
-      return;
+      return false;
     }
   }
 
@@ -77,22 +83,29 @@ void ParserBase::LoadSong(const QString &filename_or_url, const qint64 beginning
     filename = QFileInfo(filename).canonicalFilePath();
   }
 
-  const QUrl url = QUrl::fromLocalFile(filename);
+  *filename_ret = filename;
 
-  // Search in the collection
-  if (collection_backend_ && collection_search) {
-    Song collection_song;
-    if (track > 0) {
-      collection_song = collection_backend_->GetSongByUrlAndTrack(url, track);
-    }
-    if (!collection_song.is_valid()) {
-      collection_song = collection_backend_->GetSongByUrl(url, beginning);
-    }
-    // If it was found in the collection then use it, otherwise load metadata from disk.
-    if (collection_song.is_valid()) {
-      *song = collection_song;
-      return;
-    }
+  return true;
+
+}
+
+void ParserBase::LoadSongMetadata(const QString &filename, const qint64 beginning, const int track, const SongList &collection_songs, Song *song) {
+
+  // Search in the sections of the song from the collection
+  Song collection_song;
+  if (track > 0) {
+    auto it = std::find_if(collection_songs.begin(), collection_songs.end(), [track](const Song &section) { return section.track() == track; });
+    if (it != collection_songs.end()) collection_song = *it;
+  }
+  if (!collection_song.is_valid()) {
+    auto it = std::find_if(collection_songs.begin(), collection_songs.end(), [beginning](const Song &section) { return section.beginning_nanosec() == beginning; });
+    if (it != collection_songs.end()) collection_song = *it;
+  }
+
+  // If it was found in the collection then use it, otherwise load metadata from disk.
+  if (collection_song.is_valid()) {
+    *song = collection_song;
+    return;
   }
 
   if (!song->has_cue()) {
@@ -101,6 +114,61 @@ void ParserBase::LoadSong(const QString &filename_or_url, const qint64 beginning
 
 }
 
+void ParserBase::LoadSong(const QString &filename_or_url, const qint64 beginning, const int track, const QDir &dir, Song *song, const bool collection_search) const {
+
+  QString filename;
+  if (!ResolveFilename(filename_or_url, dir, song, &filename)) return;
+
+  SongList collection_songs;
+  if (collection_backend_ && collection_search) {
+    collection_songs = collection_backend_->GetSongsByUrl(QUrl::fromLocalFile(filename));
+  }
+
+  LoadSongMetadata(filename, beginning, track, collection_songs, song);
+
+}
+
+SongList ParserBase::LoadSongs(const QList<SongLocation> &locations, const QDir &dir, const bool collection_search) const {
+
+  SongList songs;
+  songs.reserve(locations.count());
+  QList<int> file_indexes;
+  QStringList filenames;
+  QList<QUrl> urls;
+  for (const SongLocation &location : locations) {
+    Song song(Song::Source::LocalFile);
+    QString filename;
+    if (ResolveFilename(location.filename_or_url, dir, &song, &filename)) {
+      file_indexes << static_cast<int>(songs.count());
+      filenames << filename;
+      urls << QUrl::fromLocalFile(filename);
+    }
+    songs << song;
+  }
+
+  QHash<QUrl, SongList> collection_songs;
+  if (collection_backend_ && collection_search && !urls.isEmpty()) {
+    collection_songs = collection_backend_->GetSongsByUrls(urls);
+  }
+
+  for (int i = 0; i < file_indexes.count(); ++i) {
+    const int index = file_indexes[i];
+    const SongLocation &location = locations[index];
+    LoadSongMetadata(filenames[i], location.beginning, location.track, collection_songs.value(urls[i]), &songs[index]);
+  }
+
+  return songs;
+
+}
+
+void ParserBase::SongsLoaded(const SongList &songs) const {
+
+  if (songs_loaded_callback_ && !songs.isEmpty()) {
+    songs_loaded_callback_(songs);
+  }
+
+}
+
 Song ParserBase::LoadSong(const QString &filename_or_url, const qint64 beginning, const int track, const QDir &dir, const bool collection_search) const {
 
   Song song(Song::Source::LocalFile);
@@ -24,9 +24,12 @@
 
 #include "config.h"
 
+#include <functional>
+
 #include <QtGlobal>
 #include <QObject>
 #include <QDir>
+#include <QList>
 #include <QByteArray>
 #include <QString>
 #include <QStringList>
@@ -61,20 +64,42 @@ class ParserBase : public QObject {
   virtual SongList Load(QIODevice *device, const QString &playlist_path = QLatin1String(""), const QDir &dir = QDir(), const bool collection_lookup = true) const = 0;
   virtual void Save(const SongList &songs, QIODevice *device, const QDir &dir = QDir(), const PlaylistSettingsPage::PathType path_type = PlaylistSettingsPage::PathType::Automatic) const = 0;
 
+  // Parsers that load the songs in batches call this from Load() with each batch, in the same order as the resulting SongList.
+  // This allows using the first songs of a big playlist before the rest of it is loaded.
+  using SongsLoadedCallback = std::function<void(const SongList &songs)>;
+  void SetSongsLoadedCallback(const SongsLoadedCallback &callback) { songs_loaded_callback_ = callback; }
+
  protected:
+  static const int kLoadBatchSize;
+
+  struct SongLocation {
+    QString filename_or_url;
+    qint64 beginning;
+    int track;
+  };
+
   // Loads a song.  If filename_or_url is a URL (with a scheme other than "file") then it is set on the song and the song marked as a stream.
   // If it is a filename or a file:// URL then it is made absolute and canonical and set as a file:// url on the song.
   // Also sets the song's metadata by searching in the Collection, or loading from the file as a fallback.
   // This function should always be used when loading a playlist.
   Song LoadSong(const QString &filename_or_url, const qint64 beginning, const int track, const QDir &dir, const bool collection_search) const;
   void LoadSong(const QString &filename_or_url, const qint64 beginning, const int track, const QDir &dir, Song *song, const bool collection_search) const;
+  // Same as LoadSong() for a batch of songs, the songs in the collection are looked up with a single query.
+  SongList LoadSongs(const QList<SongLocation> &locations, const QDir &dir, const bool collection_search) const;
+  void SongsLoaded(const SongList &songs) const;
 
   // If the URL is a file:// URL then returns its path, absolute or relative to the directory depending on the path_type option.
   // Otherwise, returns the URL as is. This function should always be used when saving a playlist.
   static QString URLOrFilename(const QUrl &url, const QDir &dir, const PlaylistSettingsPage::PathType path_type);
 
+ private:
+  // Sets streams on the song, returns true with the absolute and canonical filename if it's a file that needs to be loaded.
+  bool ResolveFilename(const QString &filename_or_url, const QDir &dir, Song *song, QString *filename) const;
+  static void LoadSongMetadata(const QString &filename, const qint64 beginning, const int track, const SongList &collection_songs, Song *song);
+
  private:
   SharedPtr<CollectionBackendInterface> collection_backend_;
+  SongsLoadedCallback songs_loaded_callback_;
 };
 
 #endif  // PARSERBASE_H
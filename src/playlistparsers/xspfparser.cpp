@@ -21,6 +21,7 @@
 #include <QtGlobal>
 #include <QObject>
 #include <QIODevice>
+#include <QList>
 #include <QDir>
 #include <QByteArray>
 #include <QString>
@@ -53,21 +54,24 @@ SongList XSPFParser::Load(QIODevice *device, const QString &playlist_path, const
     return ret;
   }
 
+  // The songs are loaded in batches while the tracks are read.
+  QList<Track> tracks;
   while (!reader.atEnd() && Utilities::ParseUntilElement(&reader, QStringLiteral("track"))) {
-    Song song = ParseTrack(&reader, dir, collection_search);
-    if (song.is_valid()) {
-      ret << song;
+    tracks << ParseTrack(&reader);
+    if (tracks.count() >= kLoadBatchSize) {
+      LoadBatch(tracks, dir, collection_search, &ret);
+      tracks.clear();
     }
   }
+  LoadBatch(tracks, dir, collection_search, &ret);
+
   return ret;
 
 }
 
-Song XSPFParser::ParseTrack(QXmlStreamReader *reader, const QDir &dir, const bool collection_search) const {
+XSPFParser::Track XSPFParser::ParseTrack(QXmlStreamReader *reader) {
 
-  QString title, artist, album, location, art;
-  qint64 nanosec = -1;
-  int track_num = -1;
+  Track track;
 
   while (!reader->atEnd()) {
     QXmlStreamReader::TokenType type = reader->readNext();
@@ -75,34 +79,34 @@ Song XSPFParser::ParseTrack(QXmlStreamReader *reader, const QDir &dir, const boo
     switch (type) {
       case QXmlStreamReader::StartElement:{
         if (name == QStringLiteral("location")) {
-          location = QUrl::fromPercentEncoding(reader->readElementText().toUtf8());
+          track.location = QUrl::fromPercentEncoding(reader->readElementText().toUtf8());
         }
         else if (name == QStringLiteral("title")) {
-          title = reader->readElementText();
+          track.title = reader->readElementText();
         }
         else if (name == QStringLiteral("creator")) {
-          artist = reader->readElementText();
+          track.artist = reader->readElementText();
         }
         else if (name == QStringLiteral("album")) {
-          album = reader->readElementText();
+          track.album = reader->readElementText();
         }
         else if (name == QStringLiteral("image")) {
-          art = QUrl::fromPercentEncoding(reader->readElementText().toUtf8());
+          track.art = QUrl::fromPercentEncoding(reader->readElementText().toUtf8());
         }
         else if (name == QStringLiteral("duration")) {  // in milliseconds.
           const QString duration = reader->readElementText();
           bool ok = false;
-          nanosec = duration.toInt(&ok) * kNsecPerMsec;
+          track.nanosec = duration.toInt(&ok) * kNsecPerMsec;
           if (!ok) {
-            nanosec = -1;
+            track.nanosec = -1;
           }
         }
         else if (name == QStringLiteral("trackNum")) {
           const QString track_num_str = reader->readElementText();
           bool ok = false;
-          track_num = track_num_str.toInt(&ok);
-          if (!ok || track_num < 1) {
-            track_num = -1;
+          track.track_num = track_num_str.toInt(&ok);
+          if (!ok || track.track_num < 1) {
+            track.track_num = -1;
           }
         }
         else if (name == QStringLiteral("info")) {
@@ -112,7 +116,7 @@ Song XSPFParser::ParseTrack(QXmlStreamReader *reader, const QDir &dir, const boo
       }
       case QXmlStreamReader::EndElement:{
         if (name == QStringLiteral("track")) {
-          goto return_song;
+          return track;
         }
       }
       default:
@@ -120,20 +124,43 @@ Song XSPFParser::ParseTrack(QXmlStreamReader *reader, const QDir &dir, const boo
     }
   }
 
-return_song:
-  Song song = LoadSong(location, 0, track_num, dir, collection_search);
-
-  // Override metadata with what was in the playlist
-  if (song.source() != Song::Source::Collection) {
-    if (!title.isEmpty()) song.set_title(title);
-    if (!artist.isEmpty()) song.set_artist(artist);
-    if (!album.isEmpty()) song.set_album(album);
-    if (!art.isEmpty()) song.set_art_manual(QUrl(art));
-    if (nanosec > 0) song.set_length_nanosec(nanosec);
-    if (track_num > 0) song.set_track(track_num);
+  return track;
+
+}
+
+void XSPFParser::LoadBatch(const QList<Track> &tracks, const QDir &dir, const bool collection_search, SongList *ret) const {
+
+  if (tracks.isEmpty()) return;
+
+  QList<SongLocation> locations;
+  locations.reserve(tracks.count());
+  for (const Track &track : tracks) {
+    locations << SongLocation{ track.location, 0, track.track_num };
+  }
+
+  const SongList songs = LoadSongs(locations, dir, collection_search);
+
+  SongList valid_songs;
+  for (int i = 0; i < songs.count(); ++i) {
+    Song song = songs[i];
+    if (!song.is_valid()) continue;
+    const Track &track = tracks[i];
+
+    // Override metadata with what was in the playlist
+    if (song.source() != Song::Source::Collection) {
+      if (!track.title.isEmpty()) song.set_title(track.title);
+      if (!track.artist.isEmpty()) song.set_artist(track.artist);
+      if (!track.album.isEmpty()) song.set_album(track.album);
+      if (!track.art.isEmpty()) song.set_art_manual(QUrl(track.art));
+      if (track.nanosec > 0) song.set_length_nanosec(track.nanosec);
+      if (track.track_num > 0) song.set_track(track.track_num);
+    }
+
+    valid_songs << song;
   }
 
-  return song;
+  *ret << valid_songs;
+  SongsLoaded(valid_songs);
 
 }
 
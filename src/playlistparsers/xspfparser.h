@@ -23,7 +23,9 @@
 
 #include "config.h"
 
+#include <QtGlobal>
 #include <QObject>
+#include <QList>
 #include <QByteArray>
 #include <QDir>
 #include <QString>
@@ -55,7 +57,19 @@ class XSPFParser : public XMLParser {
   void Save(const SongList &songs, QIODevice *device, const QDir &dir = QDir(), const PlaylistSettingsPage::PathType path_type = PlaylistSettingsPage::PathType::Automatic) const override;
 
  private:
-  Song ParseTrack(QXmlStreamReader *reader, const QDir &dir, const bool collection_search) const;
+  struct Track {
+    Track() : nanosec(-1), track_num(-1) {}
+    QString location;
+    QString title;
+    QString artist;
+    QString album;
+    QString art;
+    qint64 nanosec;
+    int track_num;
+  };
+
+  static Track ParseTrack(QXmlStreamReader *reader);
+  void LoadBatch(const QList<Track> &tracks, const QDir &dir, const bool collection_search, SongList *ret) const;
 };
 
 #endif
@@ -39,13 +39,21 @@
 #include "core/logging.h"
 #include "core/shared_ptr.h"
 #include "core/networkaccessmanager.h"
+#include "internet/internetreplycache.h"
 #include "qobuzservice.h"
 #include "qobuzbaserequest.h"
 
+namespace {
+constexpr int kInitialConcurrentRequests = 3;
+constexpr int kMaxConcurrentRequests = 12;
+}  // namespace
+
 QobuzBaseRequest::QobuzBaseRequest(QobuzService *service, SharedPtr<NetworkAccessManager> network, QObject *parent)
     : QObject(parent),
       service_(service),
-      network_(network) {}
+      network_(network),
+      concurrency_(kInitialConcurrentRequests, kMaxConcurrentRequests),
+      reply_cache_(nullptr) {}
 
 QobuzBaseRequest::~QobuzBaseRequest() = default;
 
@@ -69,8 +77,11 @@ QNetworkReply *QobuzBaseRequest::CreateRequest(const QString &ressource_name, co
   req.setRawHeader("X-App-Id", app_id().toUtf8());
   if (authenticated()) req.setRawHeader("X-User-Auth-Token", user_auth_token().toUtf8());
 
+  if (reply_cache_) reply_cache_->AddValidators(&req);
+
   QNetworkReply *reply = network_->get(req);
   QObject::connect(reply, &QNetworkReply::sslErrors, this, &QobuzBaseRequest::HandleSSLErrors);
+  concurrency_.ReplyStarted(reply);
 
   qLog(Debug) << "Qobuz: Sending request" << url;
 
@@ -78,6 +89,14 @@ QNetworkReply *QobuzBaseRequest::CreateRequest(const QString &ressource_name, co
 
 }
 
+bool QobuzBaseRequest::ReplyThrottled(QNetworkReply *reply) {
+
+  concurrency_.ReplyFinished(reply);
+
+  return InternetRequestConcurrency::IsThrottled(reply);
+
+}
+
 void QobuzBaseRequest::HandleSSLErrors(const QList<QSslError> &ssl_errors) {
 
   for (const QSslError &ssl_error : ssl_errors) {
@@ -88,10 +107,16 @@ void QobuzBaseRequest::HandleSSLErrors(const QList<QSslError> &ssl_errors) {
 
 QByteArray QobuzBaseRequest::GetReplyData(QNetworkReply *reply) {
 
+  concurrency_.ReplyFinished(reply);
+
   QByteArray data;
 
   if (reply->error() == QNetworkReply::NoError && reply->attribute(QNetworkRequest::HttpStatusCodeAttribute).toInt() == 200) {
     data = reply->readAll();
+    if (reply_cache_) reply_cache_->Store(reply, data);
+  }
+  else if (reply_cache_ && reply->error() == QNetworkReply::NoError && reply_cache_->NotModified(reply, &data)) {
+    // The page is unchanged since the last refresh, the cached data is used.
   }
   else {
     if (reply->error() != QNetworkReply::NoError && reply->error() < 200) {
@@ -131,27 +156,39 @@ QByteArray QobuzBaseRequest::GetReplyData(QNetworkReply *reply) {
 
 QJsonObject QobuzBaseRequest::ExtractJsonObj(QByteArray &data) {
 
+  QString error;
+  QJsonObject json_obj = ParseJsonObj(data, &error);
+  if (!error.isEmpty()) {
+    Error(error, data);
+  }
+
+  return json_obj;
+
+}
+
+QJsonObject QobuzBaseRequest::ParseJsonObj(const QByteArray &data, QString *error) {
+
   QJsonParseError json_error;
   QJsonDocument json_doc = QJsonDocument::fromJson(data, &json_error);
 
   if (json_error.error != QJsonParseError::NoError) {
-    Error(QStringLiteral("Reply from server missing Json data."), data);
+    *error = QStringLiteral("Reply from server missing Json data.");
     return QJsonObject();
   }
 
   if (json_doc.isEmpty()) {
-    Error(QStringLiteral("Received empty Json document."), data);
+    *error = QStringLiteral("Received empty Json document.");
     return QJsonObject();
   }
 
   if (!json_doc.isObject()) {
-    Error(QStringLiteral("Json document is not an object."), json_doc);
+    *error = QStringLiteral("Json document is not an object.");
     return QJsonObject();
   }
 
   QJsonObject json_obj = json_doc.object();
   if (json_obj.isEmpty()) {
-    Error(QStringLiteral("Received empty Json object."), json_doc);
+    *error = QStringLiteral("Received empty Json object.");
     return QJsonObject();
   }
 
@@ -35,11 +35,13 @@
 #include <QJsonValue>
 
 #include "core/shared_ptr.h"
+#include "internet/internetrequestconcurrency.h"
 #include "core/song.h"
 #include "qobuzservice.h"
 
 class QNetworkReply;
 class NetworkAccessManager;
+class InternetReplyCache;
 
 class QobuzBaseRequest : public QObject {
   Q_OBJECT
@@ -66,9 +68,18 @@ class QobuzBaseRequest : public QObject {
   QNetworkReply *CreateRequest(const QString &ressource_name, const ParamList &params_provided);
   QByteArray GetReplyData(QNetworkReply *reply);
   QJsonObject ExtractJsonObj(QByteArray &data);
+  // Thread safe version of ExtractJsonObj, the error is returned instead of reported.
+  static QJsonObject ParseJsonObj(const QByteArray &data, QString *error);
   QJsonValue ExtractItems(QByteArray &data);
   QJsonValue ExtractItems(QJsonObject &json_obj);
 
+  // The number of requests to keep in flight, it adapts to how fast the server replies.
+  int max_concurrent_requests() const { return concurrency_.limit(); }
+  // Returns true if the request should be sent again, the reply data is not read then.
+  bool ReplyThrottled(QNetworkReply *reply);
+  // Requests are sent with the validators of the cached replies, and unchanged replies are read from the cache.
+  void set_reply_cache(InternetReplyCache *reply_cache) { reply_cache_ = reply_cache; }
+
   virtual void Error(const QString &error, const QVariant &debug = QVariant()) = 0;
   static QString ErrorsToHTML(const QStringList &errors);
 
@@ -97,6 +108,8 @@ class QobuzBaseRequest : public QObject {
  private:
   QobuzService *service_;
   SharedPtr<NetworkAccessManager> network_;
+  InternetRequestConcurrency concurrency_;
+  InternetReplyCache *reply_cache_;
 };
 
 #endif  // QOBUZBASEREQUEST_H
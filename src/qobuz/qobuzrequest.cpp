@@ -22,17 +22,17 @@
 #include <QObject>
 #include <QList>
 #include <QByteArray>
-#include <QByteArrayList>
 #include <QString>
 #include <QUrl>
-#include <QImage>
-#include <QImageReader>
 #include <QNetworkRequest>
 #include <QNetworkReply>
 #include <QJsonObject>
 #include <QJsonArray>
 #include <QJsonValue>
 #include <QTimer>
+#include <QFuture>
+#include <QFutureWatcher>
+#include <QtConcurrentRun>
 
 #include "core/logging.h"
 #include "core/shared_ptr.h"
@@ -40,20 +40,14 @@
 #include "core/song.h"
 #include "core/application.h"
 #include "utilities/timeconstants.h"
-#include "utilities/imageutils.h"
 #include "utilities/coverutils.h"
+#include "internet/internetcoverdownloader.h"
 #include "qobuzservice.h"
 #include "qobuzurlhandler.h"
 #include "qobuzbaserequest.h"
 #include "qobuzrequest.h"
 
 namespace {
-constexpr int kMaxConcurrentArtistsRequests = 3;
-constexpr int kMaxConcurrentAlbumsRequests = 3;
-constexpr int kMaxConcurrentSongsRequests = 3;
-constexpr int kMaxConcurrentArtistAlbumsRequests = 3;
-constexpr int kMaxConcurrentAlbumSongsRequests = 3;
-constexpr int kMaxConcurrentAlbumCoverRequests = 1;
 constexpr int kFlushRequestsDelay = 200;
 }  // namespace
 
@@ -67,39 +61,28 @@ QobuzRequest::QobuzRequest(QobuzService *service, QobuzUrlHandler *url_handler,
       query_type_(query_type),
       query_id_(-1),
       finished_(false),
-      artists_requests_total_(0),
-      artists_requests_active_(0),
-      artists_requests_received_(0),
       artists_total_(0),
       artists_received_(0),
-      albums_requests_total_(0),
-      albums_requests_active_(0),
-      albums_requests_received_(0),
       albums_total_(0),
       albums_received_(0),
-      songs_requests_total_(0),
-      songs_requests_active_(0),
-      songs_requests_received_(0),
       songs_total_(0),
       songs_received_(0),
-      artist_albums_requests_total_(),
-      artist_albums_requests_active_(0),
-      artist_albums_requests_received_(0),
+      songs_pages_parsing_(0),
       artist_albums_total_(0),
       artist_albums_received_(0),
-      album_songs_requests_active_(0),
-      album_songs_requests_received_(0),
-      album_songs_requests_total_(0),
       album_songs_total_(0),
       album_songs_received_(0),
-      album_covers_requests_total_(0),
-      album_covers_requests_active_(0),
-      album_covers_requests_received_(0),
+      album_covers_total_(0),
+      album_covers_received_(0),
       no_results_(false) {
 
   timer_flush_requests_->setInterval(kFlushRequestsDelay);
   timer_flush_requests_->setSingleShot(false);
   QObject::connect(timer_flush_requests_, &QTimer::timeout, this, &QobuzRequest::FlushRequests);
+  QObject::connect(&*app_->internet_cover_downloader(), &InternetCoverDownloader::Finished, this, &QobuzRequest::AlbumCoverReceived);
+
+  // Refreshing the favourites only downloads the pages that changed.
+  if (IsQuery()) set_reply_cache(service->reply_cache());
 
 }
 
@@ -112,11 +95,9 @@ QobuzRequest::~QobuzRequest() {
     reply->deleteLater();
   }
 
-  while (!album_cover_replies_.isEmpty()) {
-    QNetworkReply *reply = album_cover_replies_.takeFirst();
-    QObject::disconnect(reply, nullptr, this, nullptr);
-    if (reply->isRunning()) reply->abort();
-    reply->deleteLater();
+  const QList<quint64> album_cover_downloads = album_cover_downloads_.keys();
+  for (const quint64 id : album_cover_downloads) {
+    app_->internet_cover_downloader()->Cancel(id);
   }
 
 }
@@ -159,36 +140,31 @@ void QobuzRequest::StartRequests() {
 
 void QobuzRequest::FlushRequests() {
 
-  if (!artists_requests_queue_.isEmpty()) {
+  if (!artists_requests_.isEmpty()) {
     FlushArtistsRequests();
     return;
   }
 
-  if (!albums_requests_queue_.isEmpty()) {
+  if (!albums_requests_.isEmpty()) {
     FlushAlbumsRequests();
     return;
   }
 
-  if (!artist_albums_requests_queue_.isEmpty()) {
+  if (!artist_albums_requests_.isEmpty()) {
     FlushArtistAlbumsRequests();
     return;
   }
 
-  if (!album_songs_requests_queue_.isEmpty()) {
+  if (!album_songs_requests_.isEmpty()) {
     FlushAlbumSongsRequests();
     return;
   }
 
-  if (!songs_requests_queue_.isEmpty()) {
+  if (!songs_requests_.isEmpty()) {
     FlushSongsRequests();
     return;
   }
 
-  if (!album_cover_requests_queue_.isEmpty()) {
-    FlushAlbumCoverRequests();
-    return;
-  }
-
   timer_flush_requests_->stop();
 
 }
@@ -211,9 +187,7 @@ void QobuzRequest::AddArtistsRequest(const int offset, const int limit) {
   Request request;
   request.limit = limit;
   request.offset = offset;
-  artists_requests_queue_.enqueue(request);
-
-  ++artists_requests_total_;
+  artists_requests_.Enqueue(request);
 
   StartRequests();
 
@@ -221,10 +195,7 @@ void QobuzRequest::AddArtistsRequest(const int offset, const int limit) {
 
 void QobuzRequest::FlushArtistsRequests() {
 
-  while (!artists_requests_queue_.isEmpty() && artists_requests_active_ < kMaxConcurrentArtistsRequests) {
-
-    Request request = artists_requests_queue_.dequeue();
-
+  artists_requests_.Flush(max_concurrent_requests(), [this](const Request &request) -> QNetworkReply* {
     ParamList params;
     if (query_type_ == QueryType::Artists) {
       params << Param(QStringLiteral("type"), QStringLiteral("artists"));
@@ -240,13 +211,11 @@ void QobuzRequest::FlushArtistsRequests() {
     else if (query_type_ == QueryType::SearchArtists) {
       reply = CreateRequest(QStringLiteral("artist/search"), params);
     }
-    if (!reply) continue;
+    if (!reply) return nullptr;
     replies_ << reply;
     QObject::connect(reply, &QNetworkReply::finished, this, [this, reply, request]() { ArtistsReplyReceived(reply, request.limit, request.offset); });
-
-    ++artists_requests_active_;
-
-  }
+    return reply;
+  });
 
 }
 
@@ -263,9 +232,7 @@ void QobuzRequest::AddAlbumsRequest(const int offset, const int limit) {
   Request request;
   request.limit = limit;
   request.offset = offset;
-  albums_requests_queue_.enqueue(request);
-
-  ++albums_requests_total_;
+  albums_requests_.Enqueue(request);
 
   StartRequests();
 
@@ -273,10 +240,7 @@ void QobuzRequest::AddAlbumsRequest(const int offset, const int limit) {
 
 void QobuzRequest::FlushAlbumsRequests() {
 
-  while (!albums_requests_queue_.isEmpty() && albums_requests_active_ < kMaxConcurrentAlbumsRequests) {
-
-    Request request = albums_requests_queue_.dequeue();
-
+  albums_requests_.Flush(max_concurrent_requests(), [this](const Request &request) -> QNetworkReply* {
     ParamList params;
     if (query_type_ == QueryType::Albums) {
       params << Param(QStringLiteral("type"), QStringLiteral("albums"));
@@ -292,13 +256,11 @@ void QobuzRequest::FlushAlbumsRequests() {
     else if (query_type_ == QueryType::SearchAlbums) {
       reply = CreateRequest(QStringLiteral("album/search"), params);
     }
-    if (!reply) continue;
+    if (!reply) return nullptr;
     replies_ << reply;
     QObject::connect(reply, &QNetworkReply::finished, this, [this, reply, request]() { AlbumsReplyReceived(reply, request.limit, request.offset); });
-
-    ++albums_requests_active_;
-
-  }
+    return reply;
+  });
 
 }
 
@@ -315,9 +277,7 @@ void QobuzRequest::AddSongsRequest(const int offset, const int limit) {
   Request request;
   request.limit = limit;
   request.offset = offset;
-  songs_requests_queue_.enqueue(request);
-
-  ++songs_requests_total_;
+  songs_requests_.Enqueue(request);
 
   StartRequests();
 
@@ -325,10 +285,7 @@ void QobuzRequest::AddSongsRequest(const int offset, const int limit) {
 
 void QobuzRequest::FlushSongsRequests() {
 
-  while (!songs_requests_queue_.isEmpty() && songs_requests_active_ < kMaxConcurrentSongsRequests) {
-
-    Request request = songs_requests_queue_.dequeue();
-
+  songs_requests_.Flush(max_concurrent_requests(), [this](const Request &request) -> QNetworkReply* {
     ParamList params;
     if (query_type_ == QueryType::Songs) {
       params << Param(QStringLiteral("type"), QStringLiteral("tracks"));
@@ -344,13 +301,11 @@ void QobuzRequest::FlushSongsRequests() {
     else if (query_type_ == QueryType::SearchSongs) {
       reply = CreateRequest(QStringLiteral("track/search"), params);
     }
-    if (!reply) continue;
+    if (!reply) return nullptr;
     replies_ << reply;
     QObject::connect(reply, &QNetworkReply::finished, this, [this, reply, request]() { SongsReplyReceived(reply, request.limit, request.offset); });
-
-    ++songs_requests_active_;
-
-  }
+    return reply;
+  });
 
 }
 
@@ -396,8 +351,27 @@ void QobuzRequest::AddSongsSearchRequest(const int offset) {
 
 }
 
+template<typename T>
+bool QobuzRequest::RetryRequest(QNetworkReply *reply, InternetRequestQueue<T> *queue) {
+
+  if (finished_ || !replies_.contains(reply) || !ReplyThrottled(reply) || !queue->Retry(reply)) return false;
+
+  qLog(Debug) << "Qobuz: Request throttled, retrying" << reply->url();
+
+  replies_.removeAll(reply);
+  QObject::disconnect(reply, nullptr, this, nullptr);
+  reply->deleteLater();
+
+  StartRequests();
+
+  return true;
+
+}
+
 void QobuzRequest::ArtistsReplyReceived(QNetworkReply *reply, const int limit_requested, const int offset_requested) {
 
+  if (RetryRequest(reply, &artists_requests_)) return;
+
   if (!replies_.contains(reply)) return;
   replies_.removeAll(reply);
   QObject::disconnect(reply, nullptr, this, nullptr);
@@ -405,8 +379,7 @@ void QobuzRequest::ArtistsReplyReceived(QNetworkReply *reply, const int limit_re
 
   QByteArray data = GetReplyData(reply);
 
-  --artists_requests_active_;
-  ++artists_requests_received_;
+  artists_requests_.ReplyReceived(reply);
 
   if (finished_) return;
 
@@ -539,7 +512,7 @@ void QobuzRequest::ArtistsFinishCheck(const int limit, const int offset, const i
     }
   }
 
-  if (artists_requests_queue_.isEmpty() && artists_requests_active_ <= 0) {  // Artist query is finished, get all albums for all artists.
+  if (artists_requests_.isEmpty() && artists_requests_.active() <= 0) {  // Artist query is finished, get all albums for all artists.
 
     // Get artist albums
     QList<ArtistAlbumsRequest> requests = artist_albums_requests_pending_.values();
@@ -548,9 +521,9 @@ void QobuzRequest::ArtistsFinishCheck(const int limit, const int offset, const i
     }
     artist_albums_requests_pending_.clear();
 
-    if (artist_albums_requests_total_ > 0) {
-      if (artist_albums_requests_total_ == 1) emit UpdateStatus(query_id_, tr("Receiving albums for %1 artist...").arg(artist_albums_requests_total_));
-      else emit UpdateStatus(query_id_, tr("Receiving albums for %1 artists...").arg(artist_albums_requests_total_));
+    if (artist_albums_requests_.total() > 0) {
+      if (artist_albums_requests_.total() == 1) emit UpdateStatus(query_id_, tr("Receiving albums for %1 artist...").arg(artist_albums_requests_.total()));
+      else emit UpdateStatus(query_id_, tr("Receiving albums for %1 artists...").arg(artist_albums_requests_.total()));
       emit UpdateProgress(query_id_, 0);
     }
 
@@ -562,8 +535,9 @@ void QobuzRequest::ArtistsFinishCheck(const int limit, const int offset, const i
 
 void QobuzRequest::AlbumsReplyReceived(QNetworkReply *reply, const int limit_requested, const int offset_requested) {
 
-  --albums_requests_active_;
-  ++albums_requests_received_;
+  if (RetryRequest(reply, &albums_requests_)) return;
+
+  albums_requests_.ReplyReceived(reply);
   AlbumsReceived(reply, Artist(), limit_requested, offset_requested);
 
 }
@@ -573,9 +547,7 @@ void QobuzRequest::AddArtistAlbumsRequest(const Artist &artist, const int offset
   ArtistAlbumsRequest request;
   request.artist = artist;
   request.offset = offset;
-  artist_albums_requests_queue_.enqueue(request);
-
-  ++artist_albums_requests_total_;
+  artist_albums_requests_.Enqueue(request);
 
   StartRequests();
 
@@ -583,10 +555,7 @@ void QobuzRequest::AddArtistAlbumsRequest(const Artist &artist, const int offset
 
 void QobuzRequest::FlushArtistAlbumsRequests() {
 
-  while (!artist_albums_requests_queue_.isEmpty() && artist_albums_requests_active_ < kMaxConcurrentArtistAlbumsRequests) {
-
-    const ArtistAlbumsRequest request = artist_albums_requests_queue_.dequeue();
-
+  artist_albums_requests_.Flush(max_concurrent_requests(), [this](const ArtistAlbumsRequest &request) -> QNetworkReply* {
     ParamList params = ParamList() << Param(QStringLiteral("artist_id"), request.artist.artist_id)
                                    << Param(QStringLiteral("extra"), QStringLiteral("albums"));
 
@@ -594,18 +563,17 @@ void QobuzRequest::FlushArtistAlbumsRequests() {
     QNetworkReply *reply = CreateRequest(QStringLiteral("artist/get"), params);
     QObject::connect(reply, &QNetworkReply::finished, this, [this, reply, request]() { ArtistAlbumsReplyReceived(reply, request.artist, request.offset); });
     replies_ << reply;
-
-    ++artist_albums_requests_active_;
-
-  }
+    return reply;
+  });
 
 }
 
 void QobuzRequest::ArtistAlbumsReplyReceived(QNetworkReply *reply, const Artist &artist, const int offset_requested) {
 
-  --artist_albums_requests_active_;
-  ++artist_albums_requests_received_;
-  emit UpdateProgress(query_id_, GetProgress(artist_albums_requests_received_, artist_albums_requests_total_));
+  if (RetryRequest(reply, &artist_albums_requests_)) return;
+
+  artist_albums_requests_.ReplyReceived(reply);
+  emit UpdateProgress(query_id_, artist_albums_requests_.progress());
   AlbumsReceived(reply, artist, 0, offset_requested);
 
 }
@@ -789,12 +757,12 @@ void QobuzRequest::AlbumsFinishCheck(const Artist &artist, const int limit, cons
   }
 
   if (
-      artists_requests_queue_.isEmpty() &&
-      artists_requests_active_ <= 0 &&
-      albums_requests_queue_.isEmpty() &&
-      albums_requests_active_ <= 0 &&
-      artist_albums_requests_queue_.isEmpty() &&
-      artist_albums_requests_active_ <= 0
+      artists_requests_.isEmpty() &&
+      artists_requests_.active() <= 0 &&
+      albums_requests_.isEmpty() &&
+      albums_requests_.active() <= 0 &&
+      artist_albums_requests_.isEmpty() &&
+      artist_albums_requests_.active() <= 0
       ) { // Artist albums query is finished, get all songs for all albums.
 
     // Get songs for all the albums.
@@ -805,9 +773,9 @@ void QobuzRequest::AlbumsFinishCheck(const Artist &artist, const int limit, cons
     }
     album_songs_requests_pending_.clear();
 
-    if (album_songs_requests_total_ > 0) {
-      if (album_songs_requests_total_ == 1) emit UpdateStatus(query_id_, tr("Receiving songs for %1 album...").arg(album_songs_requests_total_));
-      else emit UpdateStatus(query_id_, tr("Receiving songs for %1 albums...").arg(album_songs_requests_total_));
+    if (album_songs_requests_.total() > 0) {
+      if (album_songs_requests_.total() == 1) emit UpdateStatus(query_id_, tr("Receiving songs for %1 album...").arg(album_songs_requests_.total()));
+      else emit UpdateStatus(query_id_, tr("Receiving songs for %1 albums...").arg(album_songs_requests_.total()));
       emit UpdateProgress(query_id_, 0);
     }
   }
@@ -819,8 +787,9 @@ void QobuzRequest::AlbumsFinishCheck(const Artist &artist, const int limit, cons
 
 void QobuzRequest::SongsReplyReceived(QNetworkReply *reply, const int limit_requested, const int offset_requested) {
 
-  --songs_requests_active_;
-  ++songs_requests_received_;
+  if (RetryRequest(reply, &songs_requests_)) return;
+
+  songs_requests_.ReplyReceived(reply);
   SongsReceived(reply, Artist(), Album(), limit_requested, offset_requested);
 
 }
@@ -831,9 +800,7 @@ void QobuzRequest::AddAlbumSongsRequest(const Artist &artist, const Album &album
   request.artist = artist;
   request.album = album;
   request.offset = offset;
-  album_songs_requests_queue_.enqueue(request);
-
-  ++album_songs_requests_total_;
+  album_songs_requests_.Enqueue(request);
 
   StartRequests();
 
@@ -841,27 +808,24 @@ void QobuzRequest::AddAlbumSongsRequest(const Artist &artist, const Album &album
 
 void QobuzRequest::FlushAlbumSongsRequests() {
 
-  while (!album_songs_requests_queue_.isEmpty() && album_songs_requests_active_ < kMaxConcurrentAlbumSongsRequests) {
-
-    AlbumSongsRequest request = album_songs_requests_queue_.dequeue();
+  album_songs_requests_.Flush(max_concurrent_requests(), [this](const AlbumSongsRequest &request) -> QNetworkReply* {
     ParamList params = ParamList() << Param(QStringLiteral("album_id"), request.album.album_id);
     if (request.offset > 0) params << Param(QStringLiteral("offset"), QString::number(request.offset));
     QNetworkReply *reply = CreateRequest(QStringLiteral("album/get"), params);
     replies_ << reply;
     QObject::connect(reply, &QNetworkReply::finished, this, [this, reply, request]() { AlbumSongsReplyReceived(reply, request.artist, request.album, request.offset); });
-
-    ++album_songs_requests_active_;
-
-  }
+    return reply;
+  });
 
 }
 
 void QobuzRequest::AlbumSongsReplyReceived(QNetworkReply *reply, const Artist &artist, const Album &album, const int offset_requested) {
 
-  --album_songs_requests_active_;
-  ++album_songs_requests_received_;
+  if (RetryRequest(reply, &album_songs_requests_)) return;
+
+  album_songs_requests_.ReplyReceived(reply);
   if (offset_requested == 0) {
-    emit UpdateProgress(query_id_, GetProgress(album_songs_requests_received_, album_songs_requests_total_));
+    emit UpdateProgress(query_id_, album_songs_requests_.progress());
   }
   SongsReceived(reply, artist, album, 0, offset_requested);
 
@@ -883,16 +847,34 @@ void QobuzRequest::SongsReceived(QNetworkReply *reply, const Artist &artist_requ
     return;
   }
 
-  QJsonObject json_obj = ExtractJsonObj(data);
+  // Pages can have thousands of songs, so they're parsed in another thread.
+  ++songs_pages_parsing_;
+  QFuture<SongsPage> future = QtConcurrent::run(&QobuzRequest::ParseSongsPage, data, artist_requested, album_requested, offset_requested, url_handler_->scheme());
+  QFutureWatcher<SongsPage> *watcher = new QFutureWatcher<SongsPage>(this);
+  QObject::connect(watcher, &QFutureWatcher<SongsPage>::finished, this, [this, watcher, limit_requested, offset_requested]() {
+    SongsPageParsed(watcher->result(), limit_requested, offset_requested);
+    watcher->deleteLater();
+  });
+  watcher->setFuture(future);
+
+}
+
+QobuzRequest::SongsPage QobuzRequest::ParseSongsPage(const QByteArray &data, const Artist &artist_requested, const Album &album_requested, const int offset_requested, const QString &scheme) {
+
+  SongsPage page;
+  page.album_artist = artist_requested;
+  page.album = album_requested;
+
+  QString error;
+  QJsonObject json_obj = ParseJsonObj(data, &error);
   if (json_obj.isEmpty()) {
-    SongsFinishCheck(artist_requested, album_requested, limit_requested, offset_requested);
-    return;
+    page.errors << ParseError(error, data);
+    return page;
   }
 
   if (!json_obj.contains(QStringLiteral("tracks"))) {
-    Error(QStringLiteral("Json object is missing tracks."), json_obj);
-    SongsFinishCheck(artist_requested, album_requested, limit_requested, offset_requested);
-    return;
+    page.errors << ParseError(QStringLiteral("Json object is missing tracks."), json_obj);
+    return page;
   }
 
   Artist album_artist = artist_requested;
@@ -911,15 +893,13 @@ void QobuzRequest::SongsReceived(QNetworkReply *reply, const Artist &artist_requ
   if (json_obj.contains(QStringLiteral("artist"))) {
     QJsonValue value_artist = json_obj[QStringLiteral("artist")];
     if (!value_artist.isObject()) {
-      Error(QStringLiteral("Invalid Json reply, album artist is not a object."), value_artist);
-      SongsFinishCheck(artist_requested, album_requested, limit_requested, offset_requested);
-      return;
+      page.errors << ParseError(QStringLiteral("Invalid Json reply, album artist is not a object."), value_artist);
+      return page;
     }
     QJsonObject obj_artist = value_artist.toObject();
     if (!obj_artist.contains(QStringLiteral("id")) || !obj_artist.contains(QStringLiteral("name"))) {
-      Error(QStringLiteral("Invalid Json reply, album artist is missing id or name."), obj_artist);
-      SongsFinishCheck(artist_requested, album_requested, limit_requested, offset_requested);
-      return;
+      page.errors << ParseError(QStringLiteral("Invalid Json reply, album artist is missing id or name."), obj_artist);
+      return page;
     }
     if (obj_artist[QStringLiteral("id")].isString()) {
       album_artist.artist_id = obj_artist[QStringLiteral("id")].toString();
@@ -933,15 +913,13 @@ void QobuzRequest::SongsReceived(QNetworkReply *reply, const Artist &artist_requ
   if (json_obj.contains(QStringLiteral("image"))) {
     QJsonValue value_image = json_obj[QStringLiteral("image")];
     if (!value_image.isObject()) {
-      Error(QStringLiteral("Invalid Json reply, album image is not a object."), value_image);
-      SongsFinishCheck(artist_requested, album_requested, limit_requested, offset_requested);
-      return;
+      page.errors << ParseError(QStringLiteral("Invalid Json reply, album image is not a object."), value_image);
+      return page;
     }
     QJsonObject obj_image = value_image.toObject();
     if (!obj_image.contains(QStringLiteral("large"))) {
-      Error(QStringLiteral("Invalid Json reply, album image is missing large."), obj_image);
-      SongsFinishCheck(artist_requested, album_requested, limit_requested, offset_requested);
-      return;
+      page.errors << ParseError(QStringLiteral("Invalid Json reply, album image is missing large."), obj_image);
+      return page;
     }
     QString album_image = obj_image[QStringLiteral("large")].toString();
     if (!album_image.isEmpty()) {
@@ -951,9 +929,8 @@ void QobuzRequest::SongsReceived(QNetworkReply *reply, const Artist &artist_requ
 
   QJsonValue value_tracks = json_obj[QStringLiteral("tracks")];
   if (!value_tracks.isObject()) {
-    Error(QStringLiteral("Json tracks is not an object."), json_obj);
-    SongsFinishCheck(artist_requested, album_requested, limit_requested, offset_requested);
-    return;
+    page.errors << ParseError(QStringLiteral("Json tracks is not an object."), json_obj);
+    return page;
   }
   QJsonObject obj_tracks = value_tracks.toObject();
 
@@ -961,69 +938,95 @@ void QobuzRequest::SongsReceived(QNetworkReply *reply, const Artist &artist_requ
       !obj_tracks.contains(QStringLiteral("offset")) ||
       !obj_tracks.contains(QStringLiteral("total")) ||
       !obj_tracks.contains(QStringLiteral("items"))) {
-    SongsFinishCheck(artist_requested, album_requested, limit_requested, offset_requested);
-    Error(QStringLiteral("Json songs object is missing values."), json_obj);
-    return;
+    page.errors << ParseError(QStringLiteral("Json songs object is missing values."), json_obj);
+    return page;
   }
 
   //int limit = obj_tracks["limit"].toInt();
   int offset = obj_tracks[QStringLiteral("offset")].toInt();
-  int songs_total = obj_tracks[QStringLiteral("total")].toInt();
+  page.album_artist = album_artist;
+  page.album = album;
+  page.songs_total = obj_tracks[QStringLiteral("total")].toInt();
 
   if (offset != offset_requested) {
-    Error(QStringLiteral("Offset returned does not match offset requested! %1 != %2").arg(offset).arg(offset_requested));
-    SongsFinishCheck(album_artist, album, limit_requested, offset_requested, songs_total);
-    return;
+    page.errors << ParseError(QStringLiteral("Offset returned does not match offset requested! %1 != %2").arg(offset).arg(offset_requested), QVariant());
+    return page;
   }
 
-  QJsonValue value_items = ExtractItems(obj_tracks);
+  QJsonValue value_items = obj_tracks[QStringLiteral("items")];
   if (!value_items.isArray()) {
-    SongsFinishCheck(album_artist, album, limit_requested, offset_requested, songs_total);
-    return;
+    return page;
   }
 
   QJsonArray array_items = value_items.toArray();
   if (array_items.isEmpty()) {
-    if ((query_type_ == QueryType::Songs || query_type_ == QueryType::SearchSongs) && offset_requested == 0) {
-      no_results_ = true;
-    }
-    SongsFinishCheck(album_artist, album, limit_requested, offset_requested, songs_total);
-    return;
+    page.empty = true;
+    return page;
   }
 
   bool compilation = false;
   bool multidisc = false;
-  SongList songs;
-  int songs_received = 0;
   for (const QJsonValueRef value_item : array_items) {
 
     if (!value_item.isObject()) {
-      Error(QStringLiteral("Invalid Json reply, track is not a object."));
+      page.errors << ParseError(QStringLiteral("Invalid Json reply, track is not a object."), QVariant());
       continue;
     }
     QJsonObject obj_item = value_item.toObject();
 
-    ++songs_received;
+    ++page.songs_received;
     Song song(Song::Source::Qobuz);
-    ParseSong(song, obj_item, album_artist, album);
+    ParseSong(song, obj_item, album_artist, album, scheme, &page.errors);
     if (!song.is_valid()) continue;
     if (song.disc() >= 2) multidisc = true;
     if (song.is_compilation()) compilation = true;
-    songs << song;
+    page.songs << song;
   }
 
-  for (Song song : songs) {
+  for (Song &song : page.songs) {
     if (compilation) song.set_compilation_detected(true);
     if (!multidisc) song.set_disc(0);
+  }
+
+  return page;
+
+}
+
+void QobuzRequest::SongsPageParsed(const SongsPage &page, const int limit_requested, const int offset_requested) {
+
+  if (finished_) {
+    --songs_pages_parsing_;
+    return;
+  }
+
+  SongMap songs;
+  for (const Song &song : page.songs) {
+    songs.insert(song.song_id(), song);
     songs_.insert(song.song_id(), song);
   }
 
-  if (query_type_ == QueryType::Songs || query_type_ == QueryType::SearchSongs) {
-    songs_received_ += songs_received;
+  // Search results are shown while the rest of the pages are received.
+  if (IsSearch() && !songs.isEmpty()) {
+    emit PartialResults(query_id_, songs);
+  }
+
+  if (page.empty && (query_type_ == QueryType::Songs || query_type_ == QueryType::SearchSongs) && offset_requested == 0) {
+    no_results_ = true;
+  }
+
+  if (page.songs_received > 0 && (query_type_ == QueryType::Songs || query_type_ == QueryType::SearchSongs)) {
+    songs_received_ += page.songs_received;
     emit UpdateProgress(query_id_, GetProgress(songs_received_, songs_total_));
   }
 
-  SongsFinishCheck(album_artist, album, limit_requested, offset_requested, songs_total, songs_received);
+  // The page is still counted while the errors are reported, so they can't finish the request.
+  for (const ParseError &error : page.errors) {
+    Error(error.first, error.second);
+  }
+
+  --songs_pages_parsing_;
+
+  SongsFinishCheck(page.album_artist, page.album, limit_requested, offset_requested, page.songs_total, page.songs_received);
 
 }
 
@@ -1058,7 +1061,7 @@ void QobuzRequest::SongsFinishCheck(const Artist &artist, const Album &album, co
 
 }
 
-void QobuzRequest::ParseSong(Song &song, const QJsonObject &json_obj, const Artist &album_artist, const Album &album) {
+void QobuzRequest::ParseSong(Song &song, const QJsonObject &json_obj, const Artist &album_artist, const Album &album, const QString &scheme, QList<ParseError> *errors) {
 
   if (
       !json_obj.contains(QStringLiteral("id")) ||
@@ -1068,7 +1071,7 @@ void QobuzRequest::ParseSong(Song &song, const QJsonObject &json_obj, const Arti
       !json_obj.contains(QStringLiteral("copyright")) ||
       !json_obj.contains(QStringLiteral("streamable"))
     ) {
-    Error(QStringLiteral("Invalid Json reply, track is missing one or more values."), json_obj);
+    *errors << ParseError(QStringLiteral("Invalid Json reply, track is missing one or more values."), json_obj);
     return;
   }
 
@@ -1099,7 +1102,7 @@ void QobuzRequest::ParseSong(Song &song, const QJsonObject &json_obj, const Arti
 
     QJsonValue value_album = json_obj[QStringLiteral("album")];
     if (!value_album.isObject()) {
-      Error(QStringLiteral("Invalid Json reply, album is not an object."), value_album);
+      *errors << ParseError(QStringLiteral("Invalid Json reply, album is not an object."), value_album);
       return;
     }
     QJsonObject obj_album = value_album.toObject();
@@ -1120,12 +1123,12 @@ void QobuzRequest::ParseSong(Song &song, const QJsonObject &json_obj, const Arti
     if (obj_album.contains(QStringLiteral("artist"))) {
       QJsonValue value_artist = obj_album[QStringLiteral("artist")];
       if (!value_artist.isObject()) {
-        Error(QStringLiteral("Invalid Json reply, album artist is not a object."), value_artist);
+        *errors << ParseError(QStringLiteral("Invalid Json reply, album artist is not a object."), value_artist);
         return;
       }
       QJsonObject obj_artist = value_artist.toObject();
       if (!obj_artist.contains(QStringLiteral("id")) || !obj_artist.contains(QStringLiteral("name"))) {
-        Error(QStringLiteral("Invalid Json reply, album artist is missing id or name."), obj_artist);
+        *errors << ParseError(QStringLiteral("Invalid Json reply, album artist is missing id or name."), obj_artist);
         return;
       }
       if (obj_artist[QStringLiteral("id")].isString()) {
@@ -1140,12 +1143,12 @@ void QobuzRequest::ParseSong(Song &song, const QJsonObject &json_obj, const Arti
     if (obj_album.contains(QStringLiteral("image"))) {
       QJsonValue value_image = obj_album[QStringLiteral("image")];
       if (!value_image.isObject()) {
-        Error(QStringLiteral("Invalid Json reply, album image is not a object."), value_image);
+        *errors << ParseError(QStringLiteral("Invalid Json reply, album image is not a object."), value_image);
         return;
       }
       QJsonObject obj_image = value_image.toObject();
       if (!obj_image.contains(QStringLiteral("large"))) {
-        Error(QStringLiteral("Invalid Json reply, album image is missing large."), obj_image);
+        *errors << ParseError(QStringLiteral("Invalid Json reply, album image is missing large."), obj_image);
         return;
       }
       QString album_image = obj_image[QStringLiteral("large")].toString();
@@ -1158,12 +1161,12 @@ void QobuzRequest::ParseSong(Song &song, const QJsonObject &json_obj, const Arti
   if (json_obj.contains(QStringLiteral("composer"))) {
     QJsonValue value_composer = json_obj[QStringLiteral("composer")];
     if (!value_composer.isObject()) {
-      Error(QStringLiteral("Invalid Json reply, track composer is not a object."), value_composer);
+      *errors << ParseError(QStringLiteral("Invalid Json reply, track composer is not a object."), value_composer);
       return;
     }
     QJsonObject obj_composer = value_composer.toObject();
     if (!obj_composer.contains(QStringLiteral("id")) || !obj_composer.contains(QStringLiteral("name"))) {
-      Error(QStringLiteral("Invalid Json reply, track composer is missing id or name."), obj_composer);
+      *errors << ParseError(QStringLiteral("Invalid Json reply, track composer is missing id or name."), obj_composer);
       return;
     }
     composer = obj_composer[QStringLiteral("name")].toString();
@@ -1172,12 +1175,12 @@ void QobuzRequest::ParseSong(Song &song, const QJsonObject &json_obj, const Arti
   if (json_obj.contains(QStringLiteral("performer"))) {
     QJsonValue value_performer = json_obj[QStringLiteral("performer")];
     if (!value_performer.isObject()) {
-      Error(QStringLiteral("Invalid Json reply, track performer is not a object."), value_performer);
+      *errors << ParseError(QStringLiteral("Invalid Json reply, track performer is not a object."), value_performer);
       return;
     }
     QJsonObject obj_performer = value_performer.toObject();
     if (!obj_performer.contains(QStringLiteral("id")) || !obj_performer.contains(QStringLiteral("name"))) {
-      Error(QStringLiteral("Invalid Json reply, track performer is missing id or name."), obj_performer);
+      *errors << ParseError(QStringLiteral("Invalid Json reply, track performer is missing id or name."), obj_performer);
       return;
     }
     performer = obj_performer[QStringLiteral("name")].toString();
@@ -1188,7 +1191,7 @@ void QobuzRequest::ParseSong(Song &song, const QJsonObject &json_obj, const Arti
   //}
 
   QUrl url;
-  url.setScheme(url_handler_->scheme());
+  url.setScheme(scheme);
   url.setPath(song_id);
 
   title = Song::TitleRemoveMisc(title);
@@ -1228,21 +1231,21 @@ void QobuzRequest::GetAlbumCoversCheck() {
       !finished_ &&
       service_->download_album_covers() &&
       IsQuery() &&
-      artists_requests_queue_.isEmpty() &&
-      albums_requests_queue_.isEmpty() &&
-      songs_requests_queue_.isEmpty() &&
-      artist_albums_requests_queue_.isEmpty() &&
-      album_songs_requests_queue_.isEmpty() &&
-      album_cover_requests_queue_.isEmpty() &&
+      artists_requests_.isEmpty() &&
+      albums_requests_.isEmpty() &&
+      songs_requests_.isEmpty() &&
+      artist_albums_requests_.isEmpty() &&
+      album_songs_requests_.isEmpty() &&
+      album_cover_downloads_.isEmpty() &&
       artist_albums_requests_pending_.isEmpty() &&
       album_songs_requests_pending_.isEmpty() &&
       album_covers_requests_sent_.isEmpty() &&
-      artists_requests_active_ <= 0 &&
-      albums_requests_active_ <= 0 &&
-      songs_requests_active_ <= 0 &&
-      artist_albums_requests_active_ <= 0 &&
-      album_songs_requests_active_ <= 0 &&
-      album_covers_requests_active_ <= 0
+      artists_requests_.active() <= 0 &&
+      albums_requests_.active() <= 0 &&
+      songs_requests_.active() <= 0 &&
+      artist_albums_requests_.active() <= 0 &&
+      album_songs_requests_.active() <= 0 &&
+      songs_pages_parsing_ <= 0
   ) {
     GetAlbumCovers();
   }
@@ -1256,11 +1259,11 @@ void QobuzRequest::GetAlbumCovers() {
     AddAlbumCoverRequest(song);
   }
 
-  if (album_covers_requests_total_ == 1) emit UpdateStatus(query_id_, tr("Receiving album cover for %1 album...").arg(album_covers_requests_total_));
-  else emit UpdateStatus(query_id_, tr("Receiving album covers for %1 albums...").arg(album_covers_requests_total_));
+  if (album_covers_total_ == 1) emit UpdateStatus(query_id_, tr("Receiving album cover for %1 album...").arg(album_covers_total_));
+  else emit UpdateStatus(query_id_, tr("Receiving album covers for %1 albums...").arg(album_covers_total_));
   emit UpdateProgress(query_id_, 0);
 
-  StartRequests();
+  AlbumCoverFinishCheck();
 
 }
 
@@ -1274,117 +1277,40 @@ void QobuzRequest::AddAlbumCoverRequest(const Song &song) {
     return;
   }
 
-  AlbumCoverRequest request;
-  request.url = cover_url;
-  request.filename = CoverUtils::CoverFilePath(CoverOptions(), song.source(), song.effective_albumartist(), song.effective_album(), song.album_id(), QString(), cover_url);
-  if (request.filename.isEmpty()) return;
+  const QString filename = CoverUtils::CoverFilePath(CoverOptions(), song.source(), song.effective_albumartist(), song.effective_album(), song.album_id(), QString(), cover_url);
+  if (filename.isEmpty()) return;
 
   album_covers_requests_sent_.insert(cover_url, song.song_id());
-  ++album_covers_requests_total_;
 
-  album_cover_requests_queue_.enqueue(request);
+  QNetworkRequest req(cover_url);
+  req.setAttribute(QNetworkRequest::RedirectPolicyAttribute, QNetworkRequest::NoLessSafeRedirectPolicy);
+  album_cover_downloads_.insert(app_->internet_cover_downloader()->Download(req, filename), cover_url);
+  ++album_covers_total_;
 
 }
 
-void QobuzRequest::FlushAlbumCoverRequests() {
+void QobuzRequest::AlbumCoverReceived(const quint64 id, const QString &filename, const QString &error) {
 
-  while (!album_cover_requests_queue_.isEmpty() && album_covers_requests_active_ < kMaxConcurrentAlbumCoverRequests) {
+  if (!album_cover_downloads_.contains(id)) return;
 
-    AlbumCoverRequest request = album_cover_requests_queue_.dequeue();
-
-    QNetworkRequest req(request.url);
-    req.setAttribute(QNetworkRequest::RedirectPolicyAttribute, QNetworkRequest::NoLessSafeRedirectPolicy);
-    QNetworkReply *reply = network_->get(req);
-    album_cover_replies_ << reply;
-    QObject::connect(reply, &QNetworkReply::finished, this, [this, reply, request]() { AlbumCoverReceived(reply, request.url, request.filename); });
-
-    ++album_covers_requests_active_;
-
-  }
-
-}
-
-void QobuzRequest::AlbumCoverReceived(QNetworkReply *reply, const QUrl &cover_url, const QString &filename) {
-
-  if (album_cover_replies_.contains(reply)) {
-    album_cover_replies_.removeAll(reply);
-    QObject::disconnect(reply, nullptr, this, nullptr);
-    reply->deleteLater();
-  }
-  else {
-    AlbumCoverFinishCheck();
-    return;
-  }
-
-  --album_covers_requests_active_;
-  ++album_covers_requests_received_;
+  const QUrl cover_url = album_cover_downloads_.take(id);
+  ++album_covers_received_;
 
   if (finished_) return;
 
-  emit UpdateProgress(query_id_, GetProgress(album_covers_requests_received_, album_covers_requests_total_));
-
-  if (!album_covers_requests_sent_.contains(cover_url)) {
-    AlbumCoverFinishCheck();
-    return;
-  }
-
-  if (reply->error() != QNetworkReply::NoError) {
-    Error(QStringLiteral("%1 (%2)").arg(reply->errorString()).arg(reply->error()));
-    if (album_covers_requests_sent_.contains(cover_url)) album_covers_requests_sent_.remove(cover_url);
-    AlbumCoverFinishCheck();
-    return;
-  }
-
-  if (reply->attribute(QNetworkRequest::HttpStatusCodeAttribute).toInt() != 200) {
-    Error(QStringLiteral("Received HTTP code %1 for %2.").arg(reply->attribute(QNetworkRequest::HttpStatusCodeAttribute).toInt()).arg(cover_url.toString()));
-    if (album_covers_requests_sent_.contains(cover_url)) album_covers_requests_sent_.remove(cover_url);
-    AlbumCoverFinishCheck();
-    return;
-  }
-
-  QString mimetype = reply->header(QNetworkRequest::ContentTypeHeader).toString();
-  if (mimetype.contains(QLatin1Char(';'))) {
-    mimetype = mimetype.left(mimetype.indexOf(QLatin1Char(';')));
-  }
-  if (!ImageUtils::SupportedImageMimeTypes().contains(mimetype, Qt::CaseInsensitive) && !ImageUtils::SupportedImageFormats().contains(mimetype, Qt::CaseInsensitive)) {
-    Error(QStringLiteral("Unsupported mimetype for image reader %1 for %2").arg(mimetype, cover_url.toString()));
-    if (album_covers_requests_sent_.contains(cover_url)) album_covers_requests_sent_.remove(cover_url);
-    AlbumCoverFinishCheck();
-    return;
-  }
-
-  const QByteArray data = reply->readAll();
-  if (data.isEmpty()) {
-    Error(QStringLiteral("Received empty image data for %1").arg(cover_url.toString()));
-    if (album_covers_requests_sent_.contains(cover_url)) album_covers_requests_sent_.remove(cover_url);
-    AlbumCoverFinishCheck();
-    return;
-  }
-
-  QByteArrayList format_list = QImageReader::imageFormatsForMimeType(mimetype.toUtf8());
-  char *format = nullptr;
-  if (!format_list.isEmpty()) {
-    format = format_list.first().data();
-  }
+  emit UpdateProgress(query_id_, GetProgress(album_covers_received_, album_covers_total_));
 
-  QImage image;
-  if (image.loadFromData(data, format)) {
-    if (image.save(filename, format)) {
-      while (album_covers_requests_sent_.contains(cover_url)) {
-        const QString song_id = album_covers_requests_sent_.take(cover_url);
-        if (songs_.contains(song_id)) {
-          songs_[song_id].set_art_automatic(QUrl::fromLocalFile(filename));
-        }
+  if (error.isEmpty()) {
+    while (album_covers_requests_sent_.contains(cover_url)) {
+      const QString song_id = album_covers_requests_sent_.take(cover_url);
+      if (songs_.contains(song_id)) {
+        songs_[song_id].set_art_automatic(QUrl::fromLocalFile(filename));
       }
     }
-    else {
-      Error(QStringLiteral("Error saving image data to %1").arg(filename));
-      if (album_covers_requests_sent_.contains(cover_url)) album_covers_requests_sent_.remove(cover_url);
-    }
   }
   else {
-    if (album_covers_requests_sent_.contains(cover_url)) album_covers_requests_sent_.remove(cover_url);
-    Error(QStringLiteral("Error decoding image data from %1").arg(cover_url.toString()));
+    Error(error);
+    album_covers_requests_sent_.remove(cover_url);
   }
 
   AlbumCoverFinishCheck();
@@ -1401,21 +1327,21 @@ void QobuzRequest::FinishCheck() {
 
   if (
       !finished_ &&
-      artists_requests_queue_.isEmpty() &&
-      albums_requests_queue_.isEmpty() &&
-      songs_requests_queue_.isEmpty() &&
-      artist_albums_requests_queue_.isEmpty() &&
-      album_songs_requests_queue_.isEmpty() &&
-      album_cover_requests_queue_.isEmpty() &&
+      artists_requests_.isEmpty() &&
+      albums_requests_.isEmpty() &&
+      songs_requests_.isEmpty() &&
+      artist_albums_requests_.isEmpty() &&
+      album_songs_requests_.isEmpty() &&
+      album_cover_downloads_.isEmpty() &&
       artist_albums_requests_pending_.isEmpty() &&
       album_songs_requests_pending_.isEmpty() &&
       album_covers_requests_sent_.isEmpty() &&
-      artists_requests_active_ <= 0 &&
-      albums_requests_active_ <= 0 &&
-      songs_requests_active_ <= 0 &&
-      artist_albums_requests_active_ <= 0 &&
-      album_songs_requests_active_ <= 0 &&
-      album_covers_requests_active_ <= 0
+      artists_requests_.active() <= 0 &&
+      albums_requests_.active() <= 0 &&
+      songs_requests_.active() <= 0 &&
+      artist_albums_requests_.active() <= 0 &&
+      album_songs_requests_.active() <= 0 &&
+      songs_pages_parsing_ <= 0
   ) {
     if (timer_flush_requests_->isActive()) {
       timer_flush_requests_->stop();
@@ -30,8 +30,8 @@
 #include <QHash>
 #include <QMap>
 #include <QMultiMap>
-#include <QQueue>
 #include <QVariant>
+#include <QByteArray>
 #include <QString>
 #include <QStringList>
 #include <QUrl>
@@ -39,6 +39,7 @@
 
 #include "core/shared_ptr.h"
 #include "core/song.h"
+#include "internet/internetrequestqueue.h"
 #include "qobuzbaserequest.h"
 
 class QNetworkReply;
@@ -91,17 +92,23 @@ class QobuzRequest : public QobuzBaseRequest {
     int offset;
     int limit;
   };
-  struct AlbumCoverRequest {
-    QString artist_id;
-    QString album_id;
-    QUrl url;
-    QString filename;
+  using ParseError = QPair<QString, QVariant>;
+  struct SongsPage {
+    SongsPage() : songs_total(0), songs_received(0), empty(false) {}
+    Artist album_artist;
+    Album album;
+    int songs_total;
+    int songs_received;
+    bool empty;
+    SongList songs;
+    QList<ParseError> errors;
   };
 
  signals:
   void LoginSuccess();
   void LoginFailure(const QString &failure_reason);
   void Results(const int id, const SongMap &songs, const QString &error);
+  void PartialResults(const int id, const SongMap &songs);
   void UpdateStatus(const int id, const QString &text);
   void UpdateProgress(const int id, const int max);
   void StreamURLFinished(const QUrl &media_url, const QUrl &url, const Song::FileType filetype, const QString &error = QString());
@@ -117,7 +124,7 @@ class QobuzRequest : public QobuzBaseRequest {
 
   void ArtistAlbumsReplyReceived(QNetworkReply *reply, const Artist &artist, const int offset_requested);
   void AlbumSongsReplyReceived(QNetworkReply *reply, const Artist &artist, const Album &album, const int offset_requested);
-  void AlbumCoverReceived(QNetworkReply *reply, const QUrl &cover_url, const QString &filename);
+  void AlbumCoverReceived(const quint64 id, const QString &filename, const QString &error);
 
  private:
 
@@ -155,16 +162,20 @@ class QobuzRequest : public QobuzBaseRequest {
   void AddAlbumSongsRequest(const Artist &artist, const Album &album, const int offset = 0);
   void FlushAlbumSongsRequests();
 
-  void ParseSong(Song &song, const QJsonObject &json_obj, const Artist &album_artist, const Album &album);
+  static SongsPage ParseSongsPage(const QByteArray &data, const Artist &artist_requested, const Album &album_requested, const int offset_requested, const QString &scheme);
+  void SongsPageParsed(const SongsPage &page, const int limit_requested, const int offset_requested);
+  static void ParseSong(Song &song, const QJsonObject &json_obj, const Artist &album_artist, const Album &album, const QString &scheme, QList<ParseError> *errors);
 
   QString AlbumCoverFileName(const Song &song);
 
   void GetAlbumCoversCheck();
   void GetAlbumCovers();
   void AddAlbumCoverRequest(const Song &song);
-  void FlushAlbumCoverRequests();
   void AlbumCoverFinishCheck();
 
+  template<typename T>
+  bool RetryRequest(QNetworkReply *reply, InternetRequestQueue<T> *queue);
+
   int GetProgress(const int count, const int total);
 
   void FinishCheck();
@@ -183,57 +194,41 @@ class QobuzRequest : public QobuzBaseRequest {
 
   bool finished_;
 
-  QQueue<Request> artists_requests_queue_;
-  QQueue<Request> albums_requests_queue_;
-  QQueue<Request> songs_requests_queue_;
+  InternetRequestQueue<Request> artists_requests_;
+  InternetRequestQueue<Request> albums_requests_;
+  InternetRequestQueue<Request> songs_requests_;
 
-  QQueue<ArtistAlbumsRequest> artist_albums_requests_queue_;
-  QQueue<AlbumSongsRequest> album_songs_requests_queue_;
-  QQueue<AlbumCoverRequest> album_cover_requests_queue_;
+  InternetRequestQueue<ArtistAlbumsRequest> artist_albums_requests_;
+  InternetRequestQueue<AlbumSongsRequest> album_songs_requests_;
 
   QHash<QString, ArtistAlbumsRequest> artist_albums_requests_pending_;
   QHash<QString, AlbumSongsRequest> album_songs_requests_pending_;
   QMultiMap<QUrl, QString> album_covers_requests_sent_;
+  QHash<quint64, QUrl> album_cover_downloads_;
 
-  int artists_requests_total_;
-  int artists_requests_active_;
-  int artists_requests_received_;
   int artists_total_;
   int artists_received_;
 
-  int albums_requests_total_;
-  int albums_requests_active_;
-  int albums_requests_received_;
   int albums_total_;
   int albums_received_;
 
-  int songs_requests_total_;
-  int songs_requests_active_;
-  int songs_requests_received_;
   int songs_total_;
   int songs_received_;
+  int songs_pages_parsing_;
 
-  int artist_albums_requests_total_;
-  int artist_albums_requests_active_;
-  int artist_albums_requests_received_;
   int artist_albums_total_;
   int artist_albums_received_;
 
-  int album_songs_requests_active_;
-  int album_songs_requests_received_;
-  int album_songs_requests_total_;
   int album_songs_total_;
   int album_songs_received_;
 
-  int album_covers_requests_total_;
-  int album_covers_requests_active_;
-  int album_covers_requests_received_;
+  int album_covers_total_;
+  int album_covers_received_;
 
   SongMap songs_;
   QStringList errors_;
   bool no_results_;
   QList<QNetworkReply*> replies_;
-  QList<QNetworkReply*> album_cover_replies_;
 };
 
 #endif  // QOBUZREQUEST_H
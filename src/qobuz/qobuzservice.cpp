@@ -50,6 +50,7 @@
 #include "internet/internetsearchview.h"
 #include "collection/collectionbackend.h"
 #include "collection/collectionmodel.h"
+#include "collection/collectionsortmodel.h"
 #include "qobuzservice.h"
 #include "qobuzurlhandler.h"
 #include "qobuzbaserequest.h"
@@ -84,17 +85,18 @@ constexpr char kSongsFtsTable[] = "qobuz_songs_fts";
 QobuzService::QobuzService(Application *app, QObject *parent)
     : InternetService(Song::Source::Qobuz, QStringLiteral("Qobuz"), QStringLiteral("qobuz"), QLatin1String(QobuzSettingsPage::kSettingsGroup), SettingsDialog::Page::Qobuz, app, parent),
       app_(app),
-      network_(app->network()),
+      network_(app->services_network()),
       url_handler_(new QobuzUrlHandler(app, this)),
+      reply_cache_(QStringLiteral("qobuz")),
       artists_collection_backend_(nullptr),
       albums_collection_backend_(nullptr),
       songs_collection_backend_(nullptr),
       artists_collection_model_(nullptr),
       albums_collection_model_(nullptr),
       songs_collection_model_(nullptr),
-      artists_collection_sort_model_(new QSortFilterProxyModel(this)),
-      albums_collection_sort_model_(new QSortFilterProxyModel(this)),
-      songs_collection_sort_model_(new QSortFilterProxyModel(this)),
+      artists_collection_sort_model_(new CollectionSortModel(this)),
+      albums_collection_sort_model_(new CollectionSortModel(this)),
+      songs_collection_sort_model_(new CollectionSortModel(this)),
       timer_search_delay_(new QTimer(this)),
       timer_login_attempt_(new QTimer(this)),
       favorite_request_(new QobuzFavoriteRequest(this, network_, this)),
@@ -135,21 +137,15 @@ QobuzService::QobuzService(Application *app, QObject *parent)
   songs_collection_model_ = new CollectionModel(songs_collection_backend_, app_, this);
 
   artists_collection_sort_model_->setSourceModel(artists_collection_model_);
-  artists_collection_sort_model_->setSortRole(CollectionModel::Role_SortText);
   artists_collection_sort_model_->setDynamicSortFilter(true);
-  artists_collection_sort_model_->setSortLocaleAware(true);
   artists_collection_sort_model_->sort(0);
 
   albums_collection_sort_model_->setSourceModel(albums_collection_model_);
-  albums_collection_sort_model_->setSortRole(CollectionModel::Role_SortText);
   albums_collection_sort_model_->setDynamicSortFilter(true);
-  albums_collection_sort_model_->setSortLocaleAware(true);
   albums_collection_sort_model_->sort(0);
 
   songs_collection_sort_model_->setSourceModel(songs_collection_model_);
-  songs_collection_sort_model_->setSortRole(CollectionModel::Role_SortText);
   songs_collection_sort_model_->setDynamicSortFilter(true);
-  songs_collection_sort_model_->setSortLocaleAware(true);
   songs_collection_sort_model_->sort(0);
 
   // Search
@@ -476,6 +472,8 @@ void QobuzService::HandleAuthReply(QNetworkReply *reply) {
 
 void QobuzService::Logout() {
 
+  reply_cache_.Clear();
+
   user_auth_token_.clear();
   device_id_.clear();
   user_id_ = -1;
@@ -557,6 +555,7 @@ void QobuzService::ArtistsResultsReceived(const int id, const SongMap &songs, co
   Q_UNUSED(id);
   emit ArtistsResults(songs, error);
   ResetArtistsRequest();
+  reply_cache_.Save();
 
 }
 
@@ -607,6 +606,7 @@ void QobuzService::AlbumsResultsReceived(const int id, const SongMap &songs, con
   Q_UNUSED(id);
   emit AlbumsResults(songs, error);
   ResetAlbumsRequest();
+  reply_cache_.Save();
 
 }
 
@@ -657,6 +657,7 @@ void QobuzService::SongsResultsReceived(const int id, const SongMap &songs, cons
   Q_UNUSED(id);
   emit SongsResults(songs, error);
   ResetSongsRequest();
+  reply_cache_.Save();
 
 }
 
@@ -725,6 +726,7 @@ void QobuzService::SendSearch() {
   search_request_.reset(new QobuzRequest(this, url_handler_, app_, network_, query_type), [](QobuzRequest *request) { request->deleteLater(); } );
 
   QObject::connect(&*search_request_, &QobuzRequest::Results, this, &QobuzService::SearchResultsReceived);
+  QObject::connect(&*search_request_, &QobuzRequest::PartialResults, this, &QobuzService::SearchPartialResults);
   QObject::connect(&*search_request_, &QobuzRequest::UpdateStatus, this, &QobuzService::SearchUpdateStatus);
   QObject::connect(&*search_request_, &QobuzRequest::UpdateProgress, this, &QobuzService::SearchUpdateProgress);
 
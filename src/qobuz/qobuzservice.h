@@ -40,6 +40,7 @@
 #include "core/shared_ptr.h"
 #include "core/song.h"
 #include "internet/internetservice.h"
+#include "internet/internetreplycache.h"
 #include "internet/internetsearchview.h"
 
 class QTimer;
@@ -97,6 +98,8 @@ class QobuzService : public InternetService {
 
   uint GetStreamURL(const QUrl &url, QString &error);
 
+  InternetReplyCache *reply_cache() { return &reply_cache_; }
+
   SharedPtr<CollectionBackend> artists_collection_backend() override { return artists_collection_backend_; }
   SharedPtr<CollectionBackend> albums_collection_backend() override { return albums_collection_backend_; }
   SharedPtr<CollectionBackend> songs_collection_backend() override { return songs_collection_backend_; }
@@ -151,6 +154,7 @@ class QobuzService : public InternetService {
   Application *app_;
   SharedPtr<NetworkAccessManager> network_;
   QobuzUrlHandler *url_handler_;
+  InternetReplyCache reply_cache_;
 
   SharedPtr<CollectionBackend> artists_collection_backend_;
   SharedPtr<CollectionBackend> albums_collection_backend_;
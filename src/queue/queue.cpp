@@ -22,6 +22,7 @@
 #include "config.h"
 
 #include <algorithm>
+#include <functional>
 #include <utility>
 
 #include <QObject>
@@ -29,6 +30,7 @@
 #include <QDataStream>
 #include <QBuffer>
 #include <QList>
+#include <QSet>
 #include <QVariant>
 #include <QString>
 #include <QStringList>
@@ -44,7 +46,11 @@ namespace {
 constexpr char kRowsMimetype[] = "application/x-strawberry-queue-rows";
 }
 
-Queue::Queue(Playlist *playlist, QObject *parent) : QAbstractProxyModel(parent), playlist_(playlist), total_length_ns_(0) {
+Queue::Queue(Playlist *playlist, QObject *parent)
+    : QAbstractProxyModel(parent),
+      source_positions_valid_(true),
+      playlist_(playlist),
+      total_length_ns_(0) {
 
   signal_item_count_changed_ = QObject::connect(this, &Queue::ItemCountChanged, this, &Queue::UpdateTotalLength);
   QObject::connect(this, &Queue::TotalLengthChanged, this, &Queue::UpdateSummaryText);
@@ -57,22 +63,40 @@ QModelIndex Queue::mapFromSource(const QModelIndex &source_index) const {
 
   if (!source_index.isValid()) return QModelIndex();
 
-  const int source_row = source_index.row();
-  for (int i = 0; i < source_indexes_.count(); ++i) {
-    if (source_indexes_[i].row() == source_row) {
-      return index(i, source_index.column());
-    }
-  }
-  return QModelIndex();
+  const int position = SourcePosition(source_index.row());
+  if (position == -1) return QModelIndex();
+
+  return index(position, source_index.column());
 
 }
 
 bool Queue::ContainsSourceRow(const int source_row) const {
 
-  for (int i = 0; i < source_indexes_.count(); ++i) {
-    if (source_indexes_[i].row() == source_row) return true;
+  return SourcePosition(source_row) != -1;
+
+}
+
+int Queue::SourcePosition(const int source_row) const {
+
+  if (!source_positions_valid_) {
+    source_positions_.clear();
+    source_positions_.reserve(static_cast<int>(source_indexes_.count()));
+    // Backwards, so the first position wins if a row is queued twice.
+    for (int i = static_cast<int>(source_indexes_.count()) - 1; i >= 0; --i) {
+      if (source_indexes_[i].isValid()) {
+        source_positions_.insert(source_indexes_[i].row(), i);
+      }
+    }
+    source_positions_valid_ = true;
   }
-  return false;
+
+  return source_positions_.value(source_row, -1);
+
+}
+
+void Queue::InvalidatePositions() {
+
+  source_positions_valid_ = false;
 
 }
 
@@ -90,6 +114,9 @@ void Queue::setSourceModel(QAbstractItemModel *source_model) {
     QObject::disconnect(sourceModel(), &QAbstractItemModel::dataChanged, this, &Queue::SourceDataChanged);
     QObject::disconnect(sourceModel(), &QAbstractItemModel::rowsRemoved, this, &Queue::SourceLayoutChanged);
     QObject::disconnect(sourceModel(), &QAbstractItemModel::layoutChanged, this, &Queue::SourceLayoutChanged);
+    QObject::disconnect(sourceModel(), &QAbstractItemModel::rowsInserted, this, &Queue::InvalidatePositions);
+    QObject::disconnect(sourceModel(), &QAbstractItemModel::rowsMoved, this, &Queue::InvalidatePositions);
+    QObject::disconnect(sourceModel(), &QAbstractItemModel::modelReset, this, &Queue::InvalidatePositions);
   }
 
   QAbstractProxyModel::setSourceModel(source_model);
@@ -97,6 +124,12 @@ void Queue::setSourceModel(QAbstractItemModel *source_model) {
   QObject::connect(sourceModel(), &QAbstractItemModel::dataChanged, this, &Queue::SourceDataChanged);
   QObject::connect(sourceModel(), &QAbstractItemModel::rowsRemoved, this, &Queue::SourceLayoutChanged);
   QObject::connect(sourceModel(), &QAbstractItemModel::layoutChanged, this, &Queue::SourceLayoutChanged);
+  // The persistent indexes follow the source rows, but the positions are looked up by source row.
+  QObject::connect(sourceModel(), &QAbstractItemModel::rowsInserted, this, &Queue::InvalidatePositions);
+  QObject::connect(sourceModel(), &QAbstractItemModel::rowsMoved, this, &Queue::InvalidatePositions);
+  QObject::connect(sourceModel(), &QAbstractItemModel::modelReset, this, &Queue::InvalidatePositions);
+
+  InvalidatePositions();
 
 }
 
@@ -116,14 +149,13 @@ void Queue::SourceLayoutChanged() {
 
   QObject::disconnect(signal_item_count_changed_);
 
+  InvalidatePositions();
+
+  QList<int> invalid_rows;
   for (int i = 0; i < source_indexes_.count(); ++i) {
-    if (!source_indexes_[i].isValid()) {
-      beginRemoveRows(QModelIndex(), i, i);
-      source_indexes_.removeAt(i);
-      endRemoveRows();
-      --i;
-    }
+    if (!source_indexes_[i].isValid()) invalid_rows << i;
   }
+  RemoveRows(invalid_rows);
 
   signal_item_count_changed_ = QObject::connect(this, &Queue::ItemCountChanged, this, &Queue::UpdateTotalLength);
 
@@ -172,38 +204,37 @@ QVariant Queue::data(const QModelIndex &proxy_index, int role) const {
 
 void Queue::ToggleTracks(const QModelIndexList &source_indexes) {
 
+  // Queued tracks are dequeued, the others are enqueued in the order they were given.
+  QList<int> dequeue_rows;
+  QModelIndexList enqueue_indexes;
+  QSet<int> enqueue_source_rows;
   for (const QModelIndex &source_index : source_indexes) {
-    QModelIndex proxy_index = mapFromSource(source_index);
-    if (proxy_index.isValid()) {
-      // Dequeue the track
-      const int row = proxy_index.row();
-      beginRemoveRows(QModelIndex(), row, row);
-      source_indexes_.removeAt(row);
-      endRemoveRows();
+    const int row = SourcePosition(source_index.row());
+    if (row != -1) {
+      dequeue_rows << row;
     }
-    else {
-      // Enqueue the track
-      const int row = static_cast<int>(source_indexes_.count());
-      beginInsertRows(QModelIndex(), row, row);
-      source_indexes_ << QPersistentModelIndex(source_index);
-      endInsertRows();
+    else if (!enqueue_source_rows.contains(source_index.row())) {
+      enqueue_source_rows.insert(source_index.row());
+      enqueue_indexes << source_index;
     }
   }
 
+  RemoveRows(dequeue_rows);
+  Append(enqueue_indexes);
+
 }
 
 void Queue::InsertFirst(const QModelIndexList &source_indexes) {
 
+  // Already in the queue, so remove them to be reinserted at the beginning
+  QList<int> queued_rows;
   for (const QModelIndex &source_index : source_indexes) {
-    QModelIndex proxy_index = mapFromSource(source_index);
-    if (proxy_index.isValid()) {
-      // Already in the queue, so remove it to be reinserted later
-      const int row = proxy_index.row();
-      beginRemoveRows(QModelIndex(), row, row);
-      source_indexes_.removeAt(row);
-      endRemoveRows();
-    }
+    const int row = SourcePosition(source_index.row());
+    if (row != -1) queued_rows << row;
   }
+  RemoveRows(queued_rows);
+
+  if (source_indexes.isEmpty()) return;
 
   const int rows = static_cast<int>(source_indexes.count());
   // Enqueue the tracks at the beginning
@@ -213,10 +244,49 @@ void Queue::InsertFirst(const QModelIndexList &source_indexes) {
     source_indexes_.insert(offset, QPersistentModelIndex(source_index));
     offset++;
   }
+  InvalidatePositions();
+  endInsertRows();
+
+}
+
+void Queue::Append(const QModelIndexList &source_indexes) {
+
+  if (source_indexes.isEmpty()) return;
+
+  const int start = static_cast<int>(source_indexes_.count());
+  beginInsertRows(QModelIndex(), start, start + static_cast<int>(source_indexes.count()) - 1);
+  for (const QModelIndex &source_index : source_indexes) {
+    if (source_positions_valid_ && !source_positions_.contains(source_index.row())) {
+      source_positions_.insert(source_index.row(), static_cast<int>(source_indexes_.count()));
+    }
+    source_indexes_ << QPersistentModelIndex(source_index);
+  }
   endInsertRows();
 
 }
 
+void Queue::RemoveRows(QList<int> proxy_rows) {
+
+  if (proxy_rows.isEmpty()) return;
+
+  // From the end, so the rows of the ranges that are left don't change.
+  std::sort(proxy_rows.begin(), proxy_rows.end(), std::greater<int>());
+  proxy_rows.erase(std::unique(proxy_rows.begin(), proxy_rows.end()), proxy_rows.end());
+
+  for (int i = 0; i < proxy_rows.count();) {
+    const int last = proxy_rows[i];
+    int first = last;
+    for (++i; i < proxy_rows.count() && proxy_rows[i] == first - 1; ++i) {
+      first = proxy_rows[i];
+    }
+    beginRemoveRows(QModelIndex(), first, last);
+    source_indexes_.erase(source_indexes_.begin() + first, source_indexes_.begin() + last + 1);
+    InvalidatePositions();
+    endRemoveRows();
+  }
+
+}
+
 int Queue::PositionOf(const QModelIndex &source_index) const {
   return mapFromSource(source_index).row();
 }
@@ -268,6 +338,7 @@ void Queue::Clear() {
 
   beginRemoveRows(QModelIndex(), 0, static_cast<int>(source_indexes_.count() - 1));
   source_indexes_.clear();
+  InvalidatePositions();
   endRemoveRows();
 
 }
@@ -291,6 +362,7 @@ void Queue::Move(const QList<int> &proxy_rows, int pos) {
   for (int i = start; i < start + moved_items.count(); ++i) {
     source_indexes_.insert(i, moved_items[i - start]);
   }
+  InvalidatePositions();
 
   // Update persistent indexes
   const QModelIndexList pindexes = persistentIndexList();
@@ -383,8 +455,7 @@ bool Queue::dropMimeData(const QMimeData *data, Qt::DropAction action, int row,
     QModelIndexList source_indexes;
     for (int source_row : std::as_const(source_rows)) {
       const QModelIndex source_index = sourceModel()->index(source_row, 0);
-      const QModelIndex proxy_index = mapFromSource(source_index);
-      if (proxy_index.isValid()) {
+      if (ContainsSourceRow(source_row)) {
         // This row was already in the queue, so no need to add it again
         continue;
       }
@@ -398,6 +469,7 @@ bool Queue::dropMimeData(const QMimeData *data, Qt::DropAction action, int row,
       for (int i = 0; i < source_indexes.count(); ++i) {
         source_indexes_.insert(insert_point + i, source_indexes[i]);
       }
+      InvalidatePositions();
       endInsertRows();
     }
   }
@@ -434,6 +506,7 @@ int Queue::TakeNext() {
 
   beginRemoveRows(QModelIndex(), 0, 0);
   int ret = source_indexes_.takeFirst().row();
+  InvalidatePositions();
   endRemoveRows();
 
   return ret;
@@ -455,15 +528,7 @@ void Queue::Remove(QList<int> &proxy_rows) {
   // Reflects immediately changes in the playlist
   emit layoutAboutToBeChanged();
 
-  int removed_rows = 0;
-  for (int row : proxy_rows) {
-    // After the first row, the row number needs to be updated
-    const int real_row = row - removed_rows;
-    beginRemoveRows(QModelIndex(), real_row, real_row);
-    source_indexes_.removeAt(real_row);
-    endRemoveRows();
-    removed_rows++;
-  }
+  RemoveRows(proxy_rows);
 
   emit layoutChanged();
 
@@ -28,6 +28,7 @@
 #include <QAbstractItemModel>
 #include <QAbstractProxyModel>
 #include <QList>
+#include <QHash>
 #include <QVariant>
 #include <QString>
 #include <QStringList>
@@ -89,9 +90,22 @@ class Queue : public QAbstractProxyModel {
   void SourceDataChanged(const QModelIndex &top_left, const QModelIndex &bottom_right);
   void SourceLayoutChanged();
   void UpdateTotalLength();
+  void InvalidatePositions();
+
+ private:
+  // Returns the queue position of the source row, or -1 if it's not queued.
+  int SourcePosition(const int source_row) const;
+  // Appends the source indexes to the end of the queue.
+  void Append(const QModelIndexList &source_indexes);
+  // Removes the proxy rows from the queue, contiguous rows are removed at once.
+  void RemoveRows(QList<int> proxy_rows);
 
  private:
   QList<QPersistentModelIndex> source_indexes_;
+  // Source row to queue position, so the playlist can look up the position of each row it shows.
+  // It's updated when tracks are appended, and rebuilt on the next lookup after everything else.
+  mutable QHash<int, int> source_positions_;
+  mutable bool source_positions_valid_;
   const Playlist *playlist_;
   quint64 total_length_ns_;
   QMetaObject::Connection signal_item_count_changed_;
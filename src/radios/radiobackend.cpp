@@ -26,6 +26,7 @@
 #include "core/shared_ptr.h"
 #include "core/database.h"
 #include "core/sqlquery.h"
+#include "core/scopedtransaction.h"
 #include "core/song.h"
 #include "radiobackend.h"
 #include "radiochannel.h"
@@ -57,30 +58,44 @@ void RadioBackend::Exit() {
 
 }
 
-void RadioBackend::AddChannelsAsync(const RadioChannelList &channels) {
-  QMetaObject::invokeMethod(this, "AddChannels", Qt::QueuedConnection, Q_ARG(RadioChannelList, channels));
+void RadioBackend::ReplaceChannelsAsync(const Song::Source source, const RadioChannelList &channels) {
+  QMetaObject::invokeMethod(this, "ReplaceChannels", Qt::QueuedConnection, Q_ARG(Song::Source, source), Q_ARG(RadioChannelList, channels));
 }
 
-void RadioBackend::AddChannels(const RadioChannelList &channels) {
+void RadioBackend::ReplaceChannels(const Song::Source source, const RadioChannelList &channels) {
 
-  QMutexLocker l(db_->Mutex());
-  QSqlDatabase db(db_->Connect());
+  {
+    QMutexLocker l(db_->Mutex());
+    QSqlDatabase db(db_->Connect());
 
-  SqlQuery q(db);
-  q.prepare(QStringLiteral("INSERT INTO radio_channels (source, name, url, thumbnail_url) VALUES (:source, :name, :url, :thumbnail_url)"));
-
-  for (const RadioChannel &channel : channels) {
-    q.BindValue(QStringLiteral(":source"), static_cast<int>(channel.source));
-    q.BindValue(QStringLiteral(":name"), channel.name);
-    q.BindValue(QStringLiteral(":url"), channel.url);
-    q.BindValue(QStringLiteral(":thumbnail_url"), channel.thumbnail_url);
-    if (!q.Exec()) {
-      db_->ReportErrors(q);
+    ScopedTransaction t(&db);
+
+    SqlQuery q_delete(db);
+    q_delete.prepare(QStringLiteral("DELETE FROM radio_channels WHERE source = :source"));
+    q_delete.BindValue(QStringLiteral(":source"), static_cast<int>(source));
+    if (!q_delete.Exec()) {
+      db_->ReportErrors(q_delete);
       return;
     }
+
+    SqlQuery q(db);
+    q.prepare(QStringLiteral("INSERT INTO radio_channels (source, name, url, thumbnail_url) VALUES (:source, :name, :url, :thumbnail_url)"));
+
+    for (const RadioChannel &channel : channels) {
+      q.BindValue(QStringLiteral(":source"), static_cast<int>(channel.source));
+      q.BindValue(QStringLiteral(":name"), channel.name);
+      q.BindValue(QStringLiteral(":url"), channel.url);
+      q.BindValue(QStringLiteral(":thumbnail_url"), channel.thumbnail_url);
+      if (!q.Exec()) {
+        db_->ReportErrors(q);
+        return;
+      }
+    }
+
+    t.Commit();
   }
 
-  emit NewChannels(channels);
+  GetChannels();
 
 }
 
@@ -116,21 +131,3 @@ void RadioBackend::GetChannels() {
   emit NewChannels(channels);
 
 }
-
-void RadioBackend::DeleteChannelsAsync() {
-  QMetaObject::invokeMethod(this, &RadioBackend::DeleteChannels, Qt::QueuedConnection);
-}
-
-void RadioBackend::DeleteChannels() {
-
-  QMutexLocker l(db_->Mutex());
-  QSqlDatabase db(db_->Connect());
-
-  SqlQuery q(db);
-  q.prepare(QStringLiteral("DELETE FROM radio_channels"));
-
-  if (!q.Exec()) {
-    db_->ReportErrors(q);
-  }
-
-}
@@ -23,6 +23,7 @@
 #include <QObject>
 
 #include "core/shared_ptr.h"
+#include "core/song.h"
 #include "radiochannel.h"
 
 class QThread;
@@ -37,14 +38,13 @@ class RadioBackend : public QObject {
   void Close();
   void ExitAsync();
 
-  void AddChannelsAsync(const RadioChannelList &channels);
+  // Replaces the channels of the source, NewChannels is emitted with the channels of all sources.
+  void ReplaceChannelsAsync(const Song::Source source, const RadioChannelList &channels);
   void GetChannelsAsync();
-  void DeleteChannelsAsync();
 
  private slots:
-  void AddChannels(const RadioChannelList &channels);
+  void ReplaceChannels(const Song::Source source, const RadioChannelList &channels);
   void GetChannels();
-  void DeleteChannels();
 
  signals:
   void NewChannels(const RadioChannelList &channels);
@@ -55,12 +55,12 @@ void RadioParadiseService::Abort() {
 
 }
 
-void RadioParadiseService::GetChannels() {
+void RadioParadiseService::GetChannels(const bool force) {
 
   Abort();
 
   QUrl url(QString::fromLatin1(kApiChannelsUrl));
-  QNetworkRequest req(url);
+  QNetworkRequest req = ChannelsRequest(url, force);
   QNetworkReply *reply = network_->get(req);
   replies_ << reply;
   const int task_id = app_->task_manager()->StartTask(tr("Getting %1 channels").arg(name_));
@@ -73,6 +73,12 @@ void RadioParadiseService::GetChannelsReply(QNetworkReply *reply, const int task
   if (replies_.contains(reply)) replies_.removeAll(reply);
   reply->deleteLater();
 
+  if (ChannelsNotModified(reply)) {
+    app_->task_manager()->SetTaskFinished(task_id);
+    emit NewChannels();
+    return;
+  }
+
   QJsonObject object = ExtractJsonObj(reply);
   if (object.isEmpty()) {
     app_->task_manager()->SetTaskFinished(task_id);
@@ -120,6 +126,10 @@ void RadioParadiseService::GetChannelsReply(QNetworkReply *reply, const int task
     }
   }
 
+  if (!channels.isEmpty()) {
+    SaveChannelsCache(reply);
+  }
+
   app_->task_manager()->SetTaskFinished(task_id);
 
   emit NewChannels(channels);
@@ -42,7 +42,7 @@ class RadioParadiseService : public RadioService {
   void Abort();
 
  public slots:
-  void GetChannels() override;
+  void GetChannels(const bool force = true) override;
 
  private slots:
   void GetChannelsReply(QNetworkReply *reply, const int task_id);
@@ -70,5 +70,6 @@ void RadioPlaylistItem::SetArtManual(const QUrl &cover_url) {
 
   metadata_.set_art_manual(cover_url);
   temp_metadata_.set_art_manual(cover_url);
+  DatabaseMetadataChanged();
 
 }
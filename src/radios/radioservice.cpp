@@ -17,11 +17,16 @@
  *
  */
 
+#include <algorithm>
+
 #include <QObject>
 #include <QVariant>
 #include <QByteArray>
 #include <QString>
+#include <QDateTime>
+#include <QRegularExpression>
 #include <QIcon>
+#include <QNetworkRequest>
 #include <QNetworkReply>
 #include <QJsonDocument>
 #include <QJsonObject>
@@ -29,8 +34,15 @@
 #include "core/logging.h"
 #include "core/shared_ptr.h"
 #include "core/application.h"
+#include "core/settings.h"
 #include "radioservice.h"
 
+namespace {
+constexpr char kSettingsGroup[] = "Radios";
+constexpr qint64 kDefaultChannelsExpirySecs = 86400;
+constexpr qint64 kMinChannelsExpirySecs = 3600;
+}  // namespace
+
 RadioService::RadioService(const Song::Source source, const QString &name, const QIcon &icon, Application *app, SharedPtr<NetworkAccessManager> network, QObject *parent)
     : QObject(parent),
       app_(app),
@@ -39,6 +51,75 @@ RadioService::RadioService(const Song::Source source, const QString &name, const
       name_(name),
       icon_(icon) {}
 
+bool RadioService::ChannelsExpired() const {
+
+  Settings s;
+  s.beginGroup(kSettingsGroup);
+  const qint64 expiry = s.value(QStringLiteral("%1_channels_expiry").arg(Song::TextForSource(source_)), 0).toLongLong();
+  s.endGroup();
+
+  return QDateTime::currentSecsSinceEpoch() >= expiry;
+
+}
+
+QNetworkRequest RadioService::ChannelsRequest(const QUrl &url, const bool force) const {
+
+  QNetworkRequest req(url);
+
+  // The disk cache would answer the conditional request itself, so it's skipped to see the 304 reply.
+  req.setAttribute(QNetworkRequest::CacheLoadControlAttribute, QNetworkRequest::AlwaysNetwork);
+  req.setAttribute(QNetworkRequest::CacheSaveControlAttribute, false);
+
+  if (!force) {
+    Settings s;
+    s.beginGroup(kSettingsGroup);
+    const QByteArray etag = s.value(QStringLiteral("%1_channels_etag").arg(Song::TextForSource(source_))).toByteArray();
+    s.endGroup();
+    if (!etag.isEmpty()) {
+      req.setRawHeader("If-None-Match", etag);
+    }
+  }
+
+  return req;
+
+}
+
+bool RadioService::ChannelsNotModified(QNetworkReply *reply) {
+
+  if (reply->error() != QNetworkReply::NoError || reply->attribute(QNetworkRequest::HttpStatusCodeAttribute).toInt() != 304) {
+    return false;
+  }
+
+  qLog(Debug) << name_ << "channels are unchanged";
+  SaveChannelsCache(reply);
+
+  return true;
+
+}
+
+void RadioService::SaveChannelsCache(QNetworkReply *reply) {
+
+  // The expiry is taken from max-age in Cache-Control, falling back to a day.
+  qint64 expiry_secs = kDefaultChannelsExpirySecs;
+  const QRegularExpressionMatch match = QRegularExpression(QStringLiteral("max-age=(\\d+)")).match(QString::fromLatin1(reply->rawHeader("Cache-Control")));
+  if (match.hasMatch()) {
+    expiry_secs = std::max(kMinChannelsExpirySecs, match.captured(1).toLongLong());
+  }
+
+  Settings s;
+  s.beginGroup(kSettingsGroup);
+  const QByteArray etag = reply->rawHeader("ETag");
+  if (!etag.isEmpty()) {
+    s.setValue(QStringLiteral("%1_channels_etag").arg(Song::TextForSource(source_)), etag);
+  }
+  else if (reply->attribute(QNetworkRequest::HttpStatusCodeAttribute).toInt() != 304) {
+    s.remove(QStringLiteral("%1_channels_etag").arg(Song::TextForSource(source_)));
+  }
+  s.setValue(QStringLiteral("%1_channels_expiry").arg(Song::TextForSource(source_)), QDateTime::currentSecsSinceEpoch() + expiry_secs);
+  s.endGroup();
+
+}
+
 QByteArray RadioService::ExtractData(QNetworkReply *reply) {
 
   if (reply->error() != QNetworkReply::NoError) {
@@ -35,6 +35,7 @@
 #include "radiochannel.h"
 
 class QNetworkReply;
+class QNetworkRequest;
 
 class Application;
 class NetworkAccessManager;
@@ -50,6 +51,9 @@ class RadioService : public QObject {
 
   virtual void ReloadSettings() {}
 
+  // Returns true when the channel list from the last refresh should be checked for changes.
+  bool ChannelsExpired() const;
+
   virtual QUrl Homepage() = 0;
   virtual QUrl Donate() = 0;
 
@@ -57,9 +61,16 @@ class RadioService : public QObject {
   void NewChannels(const RadioChannelList &channels = RadioChannelList());
 
  public slots:
-  virtual void GetChannels() = 0;
+  // Unless force is set, the channel list is only sent again when it changed since the last refresh.
+  virtual void GetChannels(const bool force = true) = 0;
 
  protected:
+  QNetworkRequest ChannelsRequest(const QUrl &url, const bool force) const;
+  // Returns true if the server replied that the channel list didn't change.
+  bool ChannelsNotModified(QNetworkReply *reply);
+  // Saves the ETag and expiry of a channel list that was received.
+  void SaveChannelsCache(QNetworkReply *reply);
+
   QByteArray ExtractData(QNetworkReply *reply);
   QJsonObject ExtractJsonObj(const QByteArray &data);
   QJsonObject ExtractJsonObj(QNetworkReply *reply);
@@ -39,7 +39,7 @@ using std::make_shared;
 
 RadioServices::RadioServices(Application *app, QObject *parent)
     : QObject(parent),
-      network_(app->network()),
+      network_(app->services_network()),
       backend_(nullptr),
       model_(new RadioModel(app, this)),
       sort_model_(new QSortFilterProxyModel(this)),
@@ -108,13 +108,19 @@ void RadioServices::GetChannels() {
   model_->Reset();
   backend_->GetChannelsAsync();
 
+  // The stored channels are shown right away, while expired channel lists are checked for changes in the background.
+  QList<RadioService*> services = services_.values();
+  for (RadioService *service : services) {
+    if (service->ChannelsExpired()) {
+      service->GetChannels(false);
+    }
+  }
+
 }
 
 void RadioServices::RefreshChannels() {
 
   channels_refresh_ = true;
-  model_->Reset();
-  backend_->DeleteChannelsAsync();
 
   QList<RadioService*> services = services_.values();
   for (RadioService *service : services) {
@@ -131,6 +137,7 @@ void RadioServices::GotChannelsFromBackend(const RadioChannelList &channels) {
     }
   }
   else {
+    model_->Reset();
     model_->AddChannels(channels);
   }
 
@@ -141,6 +148,9 @@ void RadioServices::GotChannelsFromService(const RadioChannelList &channels) {
   RadioService *service = qobject_cast<RadioService*>(sender());
   if (!service) return;
 
-  backend_->AddChannelsAsync(channels);
+  // An empty list means the channels didn't change or couldn't be fetched, the stored channels are kept.
+  if (channels.isEmpty()) return;
+
+  backend_->ReplaceChannelsAsync(service->source(), channels);
 
 }
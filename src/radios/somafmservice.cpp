@@ -27,11 +27,12 @@
 #include <QJsonArray>
 
 #include "core/application.h"
+#include "core/player.h"
 #include "core/networkaccessmanager.h"
 #include "core/taskmanager.h"
 #include "core/iconloader.h"
-#include "playlistparsers/playlistparser.h"
 #include "somafmservice.h"
+#include "somafmurlhandler.h"
 #include "radiochannel.h"
 
 namespace {
@@ -39,7 +40,12 @@ constexpr char kApiChannelsUrl[] = "https://somafm.com/channels.json";
 }
 
 SomaFMService::SomaFMService(Application *app, SharedPtr<NetworkAccessManager> network, QObject *parent)
-    : RadioService(Song::Source::SomaFM, QStringLiteral("SomaFM"), IconLoader::Load(QStringLiteral("somafm")), app, network, parent) {}
+    : RadioService(Song::Source::SomaFM, QStringLiteral("SomaFM"), IconLoader::Load(QStringLiteral("somafm")), app, network, parent),
+      url_handler_(new SomaFMUrlHandler(network, this)) {
+
+  app->player()->RegisterUrlHandler(url_handler_);
+
+}
 
 SomaFMService::~SomaFMService() {
   Abort();
@@ -57,16 +63,14 @@ void SomaFMService::Abort() {
     reply->deleteLater();
   }
 
-  channels_.clear();
-
 }
 
-void SomaFMService::GetChannels() {
+void SomaFMService::GetChannels(const bool force) {
 
   Abort();
 
   QUrl url(QString::fromLatin1(kApiChannelsUrl));
-  QNetworkRequest req(url);
+  QNetworkRequest req = ChannelsRequest(url, force);
   QNetworkReply *reply = network_->get(req);
   replies_ << reply;
   const int task_id = app_->task_manager()->StartTask(tr("Getting %1 channels").arg(name_));
@@ -79,6 +83,12 @@ void SomaFMService::GetChannelsReply(QNetworkReply *reply, const int task_id) {
   if (replies_.contains(reply)) replies_.removeAll(reply);
   reply->deleteLater();
 
+  if (ChannelsNotModified(reply)) {
+    app_->task_manager()->SetTaskFinished(task_id);
+    emit NewChannels();
+    return;
+  }
+
   QJsonObject object = ExtractJsonObj(reply);
   if (object.isEmpty()) {
     app_->task_manager()->SetTaskFinished(task_id);
@@ -115,7 +125,9 @@ void SomaFMService::GetChannelsReply(QNetworkReply *reply, const int task_id) {
       if (quality != QStringLiteral("highest")) continue;
       channel.source = source_;
       channel.name = name;
+      // The stream URL is resolved from the playlist by SomaFMUrlHandler when the channel is played.
       channel.url.setUrl(obj_playlist[QStringLiteral("url")].toString());
+      channel.url.setScheme(QString::fromLatin1(SomaFMUrlHandler::kUrlScheme));
       channel.thumbnail_url.setUrl(image);
       if (obj_playlist.contains(QStringLiteral("format"))) {
         channel.name.append(QLatin1Char(' ') + obj_playlist[QStringLiteral("format")].toString().toUpper());
@@ -124,44 +136,12 @@ void SomaFMService::GetChannelsReply(QNetworkReply *reply, const int task_id) {
     }
   }
 
-  if (channels.isEmpty()) {
-    app_->task_manager()->SetTaskFinished(task_id);
-    emit NewChannels();
+  if (!channels.isEmpty()) {
+    SaveChannelsCache(reply);
   }
-  else {
-    for (const RadioChannel &channel : channels) {
-      GetStreamUrl(task_id, channel);
-    }
-  }
-
-}
 
-void SomaFMService::GetStreamUrl(const int task_id, const RadioChannel &channel) {
+  app_->task_manager()->SetTaskFinished(task_id);
 
-  QNetworkRequest req(channel.url);
-  QNetworkReply *reply = network_->get(req);
-  replies_ << reply;
-  QObject::connect(reply, &QNetworkReply::finished, this, [this, reply, task_id, channel]() { GetStreamUrlsReply(reply, task_id, channel); });
-
-}
-
-void SomaFMService::GetStreamUrlsReply(QNetworkReply *reply, const int task_id, RadioChannel channel) {  // clazy:exclude=function-args-by-ref
-
-  if (replies_.contains(reply)) replies_.removeAll(reply);
-  reply->deleteLater();
-
-  PlaylistParser parser;
-  SongList songs = parser.LoadFromDevice(reply);
-  if (!songs.isEmpty()) {
-    channel.url = songs.first().url();
-  }
-
-  channels_ << channel;
-
-  if (replies_.isEmpty()) {
-    app_->task_manager()->SetTaskFinished(task_id);
-    emit NewChannels(channels_);
-    channels_.clear();
-  }
+  emit NewChannels(channels);
 
 }
@@ -29,6 +29,7 @@
 
 class QNetworkReply;
 class NetworkAccessManager;
+class SomaFMUrlHandler;
 
 class SomaFMService : public RadioService {
   Q_OBJECT
@@ -43,18 +44,14 @@ class SomaFMService : public RadioService {
   void Abort();
 
  public slots:
-  void GetChannels() override;
-
- private:
-  void GetStreamUrl(const int task_id, const RadioChannel &channel);
+  void GetChannels(const bool force = true) override;
 
  private slots:
   void GetChannelsReply(QNetworkReply *reply, const int task_id);
-  void GetStreamUrlsReply(QNetworkReply *reply, const int task_id, RadioChannel channel);
 
  private:
+  SomaFMUrlHandler *url_handler_;
   QList<QNetworkReply*> replies_;
-  RadioChannelList channels_;
 };
 
 #endif  // SOMAFMSERVICE_H
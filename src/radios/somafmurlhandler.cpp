@@ -0,0 +1,99 @@
+/*
+ * Strawberry Music Player
+ * Copyright 2021, Jonas Kvinge <jonas@jkvinge.net>
+ *
+ * Strawberry is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Strawberry is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Strawberry.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#include "config.h"
+
+#include <QObject>
+#include <QString>
+#include <QUrl>
+#include <QNetworkRequest>
+#include <QNetworkReply>
+
+#include "core/logging.h"
+#include "core/shared_ptr.h"
+#include "core/networkaccessmanager.h"
+#include "core/song.h"
+#include "playlistparsers/playlistparser.h"
+#include "somafmurlhandler.h"
+
+const char *SomaFMUrlHandler::kUrlScheme = "somafm";
+
+SomaFMUrlHandler::SomaFMUrlHandler(SharedPtr<NetworkAccessManager> network, QObject *parent)
+    : UrlHandler(parent),
+      network_(network) {}
+
+SomaFMUrlHandler::~SomaFMUrlHandler() {
+
+  while (!replies_.isEmpty()) {
+    QNetworkReply *reply = replies_.take(replies_.firstKey());
+    QObject::disconnect(reply, nullptr, this, nullptr);
+    if (reply->isRunning()) reply->abort();
+    reply->deleteLater();
+  }
+
+}
+
+UrlHandler::LoadResult SomaFMUrlHandler::StartLoading(const QUrl &url) {
+
+  if (stream_urls_.contains(url)) {
+    return LoadResult(url, LoadResult::Type::TrackAvailable, stream_urls_.value(url));
+  }
+
+  // Already loading, AsyncLoadComplete is emitted once for all the callers.
+  if (replies_.contains(url)) {
+    return LoadResult(url, LoadResult::Type::WillLoadAsynchronously);
+  }
+
+  QUrl playlist_url(url);
+  playlist_url.setScheme(QStringLiteral("https"));
+
+  QNetworkRequest req(playlist_url);
+  QNetworkReply *reply = network_->get(req);
+  replies_.insert(url, reply);
+  QObject::connect(reply, &QNetworkReply::finished, this, [this, reply, url]() { PlaylistReceived(reply, url); });
+
+  return LoadResult(url, LoadResult::Type::WillLoadAsynchronously);
+
+}
+
+void SomaFMUrlHandler::PlaylistReceived(QNetworkReply *reply, const QUrl &media_url) {
+
+  if (replies_.value(media_url) == reply) replies_.remove(media_url);
+  QObject::disconnect(reply, nullptr, this, nullptr);
+  reply->deleteLater();
+
+  if (reply->error() != QNetworkReply::NoError || reply->attribute(QNetworkRequest::HttpStatusCodeAttribute).toInt() != 200) {
+    const QString error = reply->error() != QNetworkReply::NoError ? QStringLiteral("%1 (%2)").arg(reply->errorString()).arg(reply->error()) : QStringLiteral("Received HTTP code %1").arg(reply->attribute(QNetworkRequest::HttpStatusCodeAttribute).toInt());
+    qLog(Error) << "SomaFM:" << error;
+    emit AsyncLoadComplete(LoadResult(media_url, LoadResult::Type::Error, error));
+    return;
+  }
+
+  PlaylistParser parser;
+  const SongList songs = parser.LoadFromDevice(reply);
+  if (songs.isEmpty()) {
+    emit AsyncLoadComplete(LoadResult(media_url, LoadResult::Type::Error, tr("No streams in the SomaFM playlist.")));
+    return;
+  }
+
+  stream_urls_.insert(media_url, songs.first().url());
+
+  emit AsyncLoadComplete(LoadResult(media_url, LoadResult::Type::TrackAvailable, songs.first().url()));
+
+}
@@ -0,0 +1,60 @@
+/*
+ * Strawberry Music Player
+ * Copyright 2021, Jonas Kvinge <jonas@jkvinge.net>
+ *
+ * Strawberry is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Strawberry is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Strawberry.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#ifndef SOMAFMURLHANDLER_H
+#define SOMAFMURLHANDLER_H
+
+#include "config.h"
+
+#include <QObject>
+#include <QMap>
+#include <QString>
+#include <QUrl>
+
+#include "core/shared_ptr.h"
+#include "core/urlhandler.h"
+
+class QNetworkReply;
+class NetworkAccessManager;
+
+// Resolves the stream URL of a SomaFM channel from its playlist when the channel is played.
+// The channel URL is the playlist URL with the somafm scheme.
+class SomaFMUrlHandler : public UrlHandler {
+  Q_OBJECT
+
+ public:
+  explicit SomaFMUrlHandler(SharedPtr<NetworkAccessManager> network, QObject *parent = nullptr);
+  ~SomaFMUrlHandler() override;
+
+  static const char *kUrlScheme;
+
+  QString scheme() const override { return QString::fromLatin1(kUrlScheme); }
+  LoadResult StartLoading(const QUrl &url) override;
+
+ private slots:
+  void PlaylistReceived(QNetworkReply *reply, const QUrl &media_url);
+
+ private:
+  SharedPtr<NetworkAccessManager> network_;
+  QMap<QUrl, QNetworkReply*> replies_;
+  // The stream URLs don't change while the application is running, so they are only resolved once.
+  QMap<QUrl, QUrl> stream_urls_;
+};
+
+#endif  // SOMAFMURLHANDLER_H
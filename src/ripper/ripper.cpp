@@ -0,0 +1,475 @@
+/*
+ * Strawberry Music Player
+ *
+ * Strawberry is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Strawberry is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Strawberry.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#include "config.h"
+
+#include <vector>
+#include <atomic>
+#include <algorithm>
+#include <cstring>
+#include <utility>
+
+#include <glib.h>
+#include <glib-object.h>
+#include <gst/gst.h>
+
+#include <QtGlobal>
+#include <QObject>
+#include <QtConcurrentRun>
+#include <QThreadPool>
+#include <QFutureWatcher>
+#include <QFile>
+#include <QFileInfo>
+#include <QList>
+#include <QMap>
+#include <QString>
+#include <QStringList>
+#include <QUrl>
+
+#include "core/logging.h"
+#include "core/shared_ptr.h"
+#include "core/song.h"
+#include "core/taskmanager.h"
+#include "core/tagreaderclient.h"
+#include "transcoder/transcoder.h"
+#include "ripper.h"
+
+namespace {
+
+// AccurateRip leaves out the first five sectors of the first track and the last five sectors of the last track, a CD sector holds 588 stereo frames.
+constexpr quint64 kAccurateRipSkipFrames = 5 * 588;
+
+// cdparanoia's PARANOIA_MODE_FULL, the slowest mode that corrects the most read errors.
+constexpr int kParanoiaModeFull = 0xff;
+
+constexpr int kBusPollMsec = 100;
+
+const quint32 *Crc32Table() {
+
+  static quint32 table[256];
+  static const bool initialized = []() {
+    for (quint32 i = 0; i < 256; ++i) {
+      quint32 c = i;
+      for (int k = 0; k < 8; ++k) {
+        c = (c & 1) ? (0xEDB88320U ^ (c >> 1)) : (c >> 1);
+      }
+      table[i] = c;
+    }
+    return true;
+  }();
+  Q_UNUSED(initialized)
+
+  return table;
+
+}
+
+// Calculates the checksums of the audio of a track from the buffers going out of the CD source.
+class TrackChecksums {
+ public:
+  explicit TrackChecksums(const bool first_track, const bool last_track)
+      : first_track_(first_track),
+        last_track_(last_track),
+        crc32_(0xFFFFFFFFU),
+        position_(0),
+        accuraterip_v1_(0),
+        accuraterip_v2_(0),
+        pending_size_(0),
+        tail_(last_track ? kAccurateRipSkipFrames : 0, 0) {}
+
+  void AddData(const guint8 *data, const gsize size) {
+
+    const quint32 *table = Crc32Table();
+    for (gsize i = 0; i < size; ++i) {
+      crc32_ = table[(crc32_ ^ data[i]) & 0xFF] ^ (crc32_ >> 8);
+    }
+
+    // Buffers normally hold whole sectors, but a frame split between two buffers is put together here.
+    gsize i = 0;
+    while (pending_size_ > 0 && i < size) {
+      pending_[pending_size_++] = data[i++];
+      if (pending_size_ == sizeof(pending_)) {
+        AddFrame(pending_);
+        pending_size_ = 0;
+      }
+    }
+    for (; i + sizeof(pending_) <= size; i += sizeof(pending_)) {
+      AddFrame(data + i);
+    }
+    for (; i < size; ++i) {
+      pending_[pending_size_++] = data[i];
+    }
+
+  }
+
+  // The checksums of the last track can only be known once the length of the track is known.
+  void Finish() {
+
+    crc32_ ^= 0xFFFFFFFFU;
+
+    if (last_track_) {
+      const quint64 first_skipped = position_ > kAccurateRipSkipFrames ? position_ - kAccurateRipSkipFrames + 1 : 1;
+      for (quint64 position = first_skipped; position <= position_; ++position) {
+        if (!Included(position)) continue;
+        const quint32 sample = tail_[static_cast<size_t>((position - 1) % kAccurateRipSkipFrames)];
+        const quint64 product = static_cast<quint64>(sample) * position;
+        accuraterip_v1_ -= static_cast<quint32>(product);
+        accuraterip_v2_ -= static_cast<quint32>(product) + static_cast<quint32>(product >> 32);
+      }
+    }
+
+  }
+
+  quint32 crc32() const { return crc32_; }
+  quint32 accuraterip_v1() const { return accuraterip_v1_; }
+  quint32 accuraterip_v2() const { return accuraterip_v2_; }
+
+ private:
+  bool Included(const quint64 position) const {
+    return !first_track_ || position >= kAccurateRipSkipFrames;
+  }
+
+  // The frames are read as the left and right samples in native byte order, they're put together as a 32 bit word with the left sample in the low bits.
+  void AddFrame(const guint8 *data) {
+
+    qint16 left = 0;
+    qint16 right = 0;
+    memcpy(&left, data, sizeof(left));
+    memcpy(&right, data + sizeof(left), sizeof(right));
+    const quint32 sample = static_cast<quint32>(static_cast<quint16>(left)) | (static_cast<quint32>(static_cast<quint16>(right)) << 16);
+
+    ++position_;
+    if (Included(position_)) {
+      const quint64 product = static_cast<quint64>(sample) * position_;
+      accuraterip_v1_ += static_cast<quint32>(product);
+      accuraterip_v2_ += static_cast<quint32>(product) + static_cast<quint32>(product >> 32);
+    }
+
+    // Keep the last frames of the last track, so they can be taken out again when the track ends.
+    if (last_track_) {
+      tail_[static_cast<size_t>((position_ - 1) % kAccurateRipSkipFrames)] = sample;
+    }
+
+  }
+
+ private:
+  bool first_track_;
+  bool last_track_;
+  quint32 crc32_;
+  quint64 position_;
+  quint32 accuraterip_v1_;
+  quint32 accuraterip_v2_;
+  guint8 pending_[4];
+  size_t pending_size_;
+  std::vector<quint32> tail_;
+};
+
+GstPadProbeReturn ChecksumProbe(GstPad *pad, GstPadProbeInfo *info, gpointer data) {
+
+  Q_UNUSED(pad)
+
+  TrackChecksums *checksums = static_cast<TrackChecksums*>(data);
+  GstBuffer *buffer = gst_pad_probe_info_get_buffer(info);
+  GstMapInfo map;
+  if (buffer && gst_buffer_map(buffer, &map, GST_MAP_READ)) {
+    checksums->AddData(map.data, map.size);
+    gst_buffer_unmap(buffer, &map);
+  }
+
+  return GST_PAD_PROBE_OK;
+
+}
+
+QString Checksum(const quint32 checksum) {
+  return QStringLiteral("%1").arg(checksum, 8, 16, QLatin1Char('0')).toUpper();
+}
+
+}  // namespace
+
+Ripper::Ripper(const QString &device, SharedPtr<TaskManager> task_manager, QObject *parent)
+    : QObject(parent),
+      device_(device),
+      task_manager_(task_manager),
+      transcoder_(new Transcoder(this)),
+      read_thread_pool_(new QThreadPool(this)),
+      read_watcher_(new QFutureWatcher<ReadResult>(this)),
+      reading_(false),
+      track_count_(0),
+      tracks_total_(0),
+      tracks_read_(0),
+      tracks_done_(0),
+      task_id_(-1),
+      cancel_(false) {
+
+  // The disc is read in a single pass, reading two tracks at once would make the drive seek between them.
+  read_thread_pool_->setMaxThreadCount(1);
+
+  QObject::connect(read_watcher_, &QFutureWatcher<ReadResult>::finished, this, &Ripper::TrackRead);
+  QObject::connect(transcoder_, &Transcoder::JobComplete, this, &Ripper::TrackTranscoded);
+  QObject::connect(transcoder_, &Transcoder::LogLine, this, &Ripper::LogLine);
+  QObject::connect(this, &Ripper::LogLine, this, [this](const QString &message) { log_ << message; });
+
+}
+
+Ripper::~Ripper() {
+
+  cancel_ = true;
+  read_watcher_->waitForFinished();
+
+  for (const Track &track : std::as_const(tracks_transcoding_)) {
+    QFile::remove(track.temporary_filename);
+  }
+
+}
+
+void Ripper::AddTrack(const Song &song, const QString &output, const TranscoderPreset &preset) {
+
+  Track track;
+  track.song = song;
+  track.output = output;
+  track.preset = preset;
+  tracks_pending_ << track;
+
+}
+
+void Ripper::Start() {
+
+  if (tracks_pending_.isEmpty()) {
+    emit Finished(QStringList(), QStringList());
+    return;
+  }
+
+  if (!temporary_dir_.isValid()) {
+    for (const Track &track : std::as_const(tracks_pending_)) {
+      files_with_errors_ << track.output;
+    }
+    tracks_pending_.clear();
+    emit LogLine(tr("Unable to create a temporary directory"));
+    emit Finished(files_with_errors_, log_);
+    return;
+  }
+
+  // Read the tracks in the order they're on the disc.
+  std::stable_sort(tracks_pending_.begin(), tracks_pending_.end(), [](const Track &a, const Track &b) { return a.song.track() < b.song.track(); });
+
+  if (track_count_ <= 0) track_count_ = tracks_pending_.last().song.track();
+
+  tracks_total_ = static_cast<int>(tracks_pending_.count());
+  task_id_ = task_manager_->StartTask(tr("Ripping CD"));
+  UpdateProgress();
+
+  ReadNextTrack();
+
+}
+
+void Ripper::Cancel() {
+
+  cancel_ = true;
+
+  for (const Track &track : std::as_const(tracks_pending_)) {
+    files_with_errors_ << track.output;
+  }
+  tracks_pending_.clear();
+
+  transcoder_->Cancel();
+  for (const Track &track : std::as_const(tracks_transcoding_)) {
+    QFile::remove(track.temporary_filename);
+    files_with_errors_ << track.output;
+  }
+  tracks_transcoding_.clear();
+
+  MaybeFinish();
+
+}
+
+void Ripper::ReadNextTrack() {
+
+  if (cancel_ || tracks_pending_.isEmpty()) {
+    reading_ = false;
+    MaybeFinish();
+    return;
+  }
+
+  reading_ = true;
+  track_reading_ = tracks_pending_.takeFirst();
+
+  const int track_number = track_reading_.song.track();
+  track_reading_.temporary_filename = temporary_dir_.filePath(QStringLiteral("track%1.wav").arg(track_number, 2, 10, QLatin1Char('0')));
+
+  const QString device = device_;
+  const QString filename = track_reading_.temporary_filename;
+  const bool first_track = track_number == 1;
+  const bool last_track = track_number == track_count_;
+  const std::atomic<bool> *cancel = &cancel_;
+  read_watcher_->setFuture(QtConcurrent::run(read_thread_pool_, [device, track_number, filename, first_track, last_track, cancel]() { return ReadTrack(device, track_number, filename, first_track, last_track, cancel); }));
+
+}
+
+Ripper::ReadResult Ripper::ReadTrack(const QString &device, const int track_number, const QString &filename, const bool first_track, const bool last_track, const std::atomic<bool> *cancel) {
+
+  ReadResult result;
+
+  GstElement *pipeline = gst_pipeline_new("ripper");
+  GstElement *src = gst_element_make_from_uri(GST_URI_SRC, QStringLiteral("cdda://%1").arg(track_number).toUtf8().constData(), nullptr, nullptr);
+  GstElement *convert = gst_element_factory_make("audioconvert", nullptr);
+  GstElement *wavenc = gst_element_factory_make("wavenc", nullptr);
+  GstElement *sink = gst_element_factory_make("filesink", nullptr);
+
+  if (!pipeline || !src || !convert || !wavenc || !sink) {
+    if (src) gst_object_unref(src);
+    if (convert) gst_object_unref(convert);
+    if (wavenc) gst_object_unref(wavenc);
+    if (sink) gst_object_unref(sink);
+    if (pipeline) gst_object_unref(pipeline);
+    result.error = QObject::tr("Unable to create gstreamer elements for ripping");
+    return result;
+  }
+
+  g_object_set(src, "device", device.toLocal8Bit().constData(), nullptr);
+  if (g_object_class_find_property(G_OBJECT_GET_CLASS(src), "paranoia-mode")) {
+    g_object_set(src, "paranoia-mode", kParanoiaModeFull, nullptr);
+  }
+  g_object_set(sink, "location", filename.toUtf8().constData(), nullptr);
+
+  gst_bin_add_many(GST_BIN(pipeline), src, convert, wavenc, sink, nullptr);
+  if (!gst_element_link_many(src, convert, wavenc, sink, nullptr)) {
+    gst_object_unref(pipeline);
+    result.error = QObject::tr("Failed to link elements for ripping");
+    return result;
+  }
+
+  TrackChecksums checksums(first_track, last_track);
+  GstPad *pad = gst_element_get_static_pad(src, "src");
+  gst_pad_add_probe(pad, GST_PAD_PROBE_TYPE_BUFFER, ChecksumProbe, &checksums, nullptr);
+  gst_object_unref(pad);
+
+  GstBus *bus = gst_pipeline_get_bus(GST_PIPELINE(pipeline));
+  gst_element_set_state(pipeline, GST_STATE_PLAYING);
+
+  while (!cancel->load()) {
+    GstMessage *msg = gst_bus_timed_pop_filtered(bus, kBusPollMsec * GST_MSECOND, static_cast<GstMessageType>(GST_MESSAGE_EOS | GST_MESSAGE_ERROR));
+    if (!msg) continue;
+    if (GST_MESSAGE_TYPE(msg) == GST_MESSAGE_EOS) {
+      result.success = true;
+    }
+    else {
+      GError *error = nullptr;
+      gchar *debugs = nullptr;
+      gst_message_parse_error(msg, &error, &debugs);
+      if (error) {
+        result.error = QString::fromUtf8(error->message);
+        g_error_free(error);
+      }
+      g_free(debugs);
+    }
+    gst_message_unref(msg);
+    break;
+  }
+
+  gst_element_set_state(pipeline, GST_STATE_NULL);
+  gst_object_unref(bus);
+  gst_object_unref(pipeline);
+
+  if (result.success) {
+    checksums.Finish();
+    result.crc32 = checksums.crc32();
+    result.accuraterip_v1 = checksums.accuraterip_v1();
+    result.accuraterip_v2 = checksums.accuraterip_v2();
+  }
+
+  return result;
+
+}
+
+void Ripper::TrackRead() {
+
+  const ReadResult result = read_watcher_->result();
+  const Track track = track_reading_;
+  track_reading_ = Track();
+  ++tracks_read_;
+
+  if (result.success && !cancel_) {
+    const QString message = tr("Track %1: CRC32 %2, AccurateRip v1 %3, AccurateRip v2 %4").arg(track.song.track()).arg(Checksum(result.crc32), Checksum(result.accuraterip_v1), Checksum(result.accuraterip_v2));
+    qLog(Info) << message;
+    emit LogLine(message);
+
+    // The encode runs while the next track is read.
+    tracks_transcoding_.insert(track.temporary_filename, track);
+    transcoder_->AddJob(track.temporary_filename, track.preset, track.output);
+    transcoder_->Start();
+  }
+  else {
+    if (!result.error.isEmpty()) {
+      qLog(Error) << "Failed to read track" << track.song.track() << result.error;
+      emit LogLine(tr("Failed to read track %1: %2").arg(track.song.track()).arg(result.error));
+    }
+    QFile::remove(track.temporary_filename);
+    files_with_errors_ << track.output;
+    ++tracks_done_;
+  }
+
+  UpdateProgress();
+  ReadNextTrack();
+
+}
+
+void Ripper::TrackTranscoded(const QString &input, const QString &output, const bool success) {
+
+  QMap<QString, Track>::iterator it = tracks_transcoding_.find(input);
+  if (it == tracks_transcoding_.end()) return;
+  const Track track = it.value();
+  tracks_transcoding_.erase(it);
+
+  QFile::remove(input);
+  ++tracks_done_;
+
+  if (success) {
+    Song song = track.song;
+    song.set_url(QUrl::fromLocalFile(output));
+    song.set_basefilename(QFileInfo(output).fileName());
+    song.set_filetype(track.preset.filetype_);
+    TagReaderReply *reply = TagReaderClient::Instance()->SaveFile(output, song);
+    QObject::connect(reply, &TagReaderReply::Finished, reply, [reply]() { reply->deleteLater(); });
+  }
+  else {
+    files_with_errors_ << output;
+  }
+
+  UpdateProgress();
+  MaybeFinish();
+
+}
+
+void Ripper::UpdateProgress() {
+
+  if (task_id_ == -1) return;
+
+  // Reading and encoding are each half of the work of a track.
+  task_manager_->SetTaskProgress(task_id_, static_cast<quint64>(tracks_read_ + tracks_done_), static_cast<quint64>(tracks_total_ * 2));
+
+}
+
+void Ripper::MaybeFinish() {
+
+  if (reading_ || !tracks_transcoding_.isEmpty() || task_id_ == -1) return;
+
+  task_manager_->SetTaskFinished(task_id_);
+  task_id_ = -1;
+
+  emit Finished(files_with_errors_, log_);
+
+}
@@ -0,0 +1,118 @@
+/*
+ * Strawberry Music Player
+ *
+ * Strawberry is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Strawberry is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Strawberry.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#ifndef RIPPER_H
+#define RIPPER_H
+
+#include "config.h"
+
+#include <atomic>
+
+#include <QtGlobal>
+#include <QObject>
+#include <QList>
+#include <QMap>
+#include <QString>
+#include <QStringList>
+#include <QFutureWatcher>
+#include <QTemporaryDir>
+
+#include "core/shared_ptr.h"
+#include "core/song.h"
+#include "transcoder/transcoder.h"
+
+class QThreadPool;
+class TaskManager;
+
+// Rips the tracks of an audio CD.
+// The tracks are read one after the other into temporary WAV files, so the drive reads the disc in a single pass without seeking between tracks.
+// Each track is encoded by the transcoder while the next ones are read, the transcoder runs as many encodes as there are cores.
+// The CRC32 and AccurateRip v1 and v2 checksums of each track are calculated while it's read and logged when it's done.
+class Ripper : public QObject {
+  Q_OBJECT
+
+ public:
+  explicit Ripper(const QString &device, SharedPtr<TaskManager> task_manager, QObject *parent = nullptr);
+  ~Ripper() override;
+
+  // The track number of the song is the track that's ripped, the song is written as the tags of the output file.
+  void AddTrack(const Song &song, const QString &output, const TranscoderPreset &preset);
+
+  // The number of tracks on the disc, it's needed for the checksums of the last track. Defaults to the highest added track.
+  void SetTrackCount(const int track_count) { track_count_ = track_count; }
+
+  void Start();
+  void Cancel();
+
+ signals:
+  void LogLine(const QString &message);
+  void Finished(const QStringList &files_with_errors, const QStringList &log);
+
+ private:
+  struct Track {
+    Song song;
+    QString output;
+    TranscoderPreset preset;
+    QString temporary_filename;
+  };
+
+  struct ReadResult {
+    ReadResult() : success(false), crc32(0), accuraterip_v1(0), accuraterip_v2(0) {}
+    bool success;
+    QString error;
+    quint32 crc32;
+    quint32 accuraterip_v1;
+    quint32 accuraterip_v2;
+  };
+
+  // This method is blocking, so you want to call it in another thread.
+  static ReadResult ReadTrack(const QString &device, const int track_number, const QString &filename, const bool first_track, const bool last_track, const std::atomic<bool> *cancel);
+
+  void ReadNextTrack();
+  void UpdateProgress();
+  void MaybeFinish();
+
+ private slots:
+  void TrackRead();
+  void TrackTranscoded(const QString &input, const QString &output, const bool success);
+
+ private:
+  QString device_;
+  SharedPtr<TaskManager> task_manager_;
+  Transcoder *transcoder_;
+  QThreadPool *read_thread_pool_;
+  QFutureWatcher<ReadResult> *read_watcher_;
+  QTemporaryDir temporary_dir_;
+
+  QList<Track> tracks_pending_;
+  Track track_reading_;
+  bool reading_;
+  QMap<QString, Track> tracks_transcoding_;
+
+  int track_count_;
+  int tracks_total_;
+  int tracks_read_;
+  int tracks_done_;
+  int task_id_;
+
+  std::atomic<bool> cancel_;
+  QStringList files_with_errors_;
+  QStringList log_;
+};
+
+#endif  // RIPPER_H
@@ -23,6 +23,11 @@
 
 #include <QList>
 #include <QString>
+#include <QVariantMap>
+
+#ifdef HAVE_DBUS
+#  include <QDBusConnection>
+#endif
 
 #include "core/shared_ptr.h"
 #include "core/application.h"
@@ -33,9 +38,20 @@
 #include "audioscrobbler.h"
 #include "scrobblersettings.h"
 #include "scrobblerservice.h"
+#include "scrobblermetrics.h"
+
+#ifdef HAVE_DBUS
+#  include "scrobbler_dbus.h"
+#endif
 
 using std::make_shared;
 
+#ifdef HAVE_DBUS
+namespace {
+constexpr char kDBusObjectPath[] = "/org/strawberrymusicplayer/Scrobbler";
+}
+#endif
+
 AudioScrobbler::AudioScrobbler(Application *app, QObject *parent)
     : QObject(parent),
       app_(app),
@@ -43,6 +59,13 @@ AudioScrobbler::AudioScrobbler(Application *app, QObject *parent)
 
   ReloadSettings();
 
+#ifdef HAVE_DBUS
+  new ScrobblerDBus(this);
+  if (!QDBusConnection::sessionBus().registerObject(QLatin1String(kDBusObjectPath), this)) {
+    qLog(Warning) << "Failed to register" << kDBusObjectPath << "on the session bus";
+  }
+#endif
+
 }
 
 AudioScrobbler::~AudioScrobbler() {
@@ -77,6 +100,20 @@ void AudioScrobbler::RemoveService(ScrobblerServicePtr service) {
 
 }
 
+QVariantMap AudioScrobbler::Metrics() const {
+
+  QVariantMap metrics;
+  for (ScrobblerServicePtr service : services_) {
+    const QVariantMap service_metrics = service->metrics().ToVariantMap(service->name());
+    for (QVariantMap::const_iterator it = service_metrics.constBegin(); it != service_metrics.constEnd(); ++it) {
+      metrics.insert(it.key(), it.value());
+    }
+  }
+
+  return metrics;
+
+}
+
 QList<ScrobblerServicePtr> AudioScrobbler::GetAll() {
 
   QList<ScrobblerServicePtr> services;
@@ -29,6 +29,7 @@
 #include <QList>
 #include <QMap>
 #include <QString>
+#include <QVariantMap>
 
 #include "core/shared_ptr.h"
 #include "core/song.h"
@@ -78,6 +79,9 @@ class AudioScrobbler : public QObject {
   void Scrobble(const Song &song, const qint64 scrobble_point);
 
  public slots:
+  // The metrics of all the services, also exported on the session bus.
+  QVariantMap Metrics() const;
+
   void ToggleScrobbling();
   void ToggleOffline();
   void ErrorReceived(const QString &error);
@@ -29,6 +29,9 @@
 #include <QUrl>
 #include <QUrlQuery>
 #include <QDateTime>
+#include <QSet>
+#include <QHash>
+#include <QQueue>
 #include <QTimer>
 #include <QSettings>
 #include <QNetworkRequest>
@@ -42,6 +45,8 @@
 #include "core/shared_ptr.h"
 #include "core/networkaccessmanager.h"
 #include "core/settings.h"
+#include "collection/collectionbackend.h"
+#include "internet/internetrequestconcurrency.h"
 
 #include "lastfmimport.h"
 
@@ -49,19 +54,59 @@
 #include "lastfmscrobbler.h"
 
 namespace {
-constexpr int kRequestsDelay = 2000;
+
+constexpr char kSettingsGroup[] = "LastFMImport";
+
+// last.fm allows about 5 requests per second.
+constexpr int kRequestsDelay = 200;
+constexpr int kMaxConcurrentRequests = 4;
+constexpr int kMaxRetries = 3;
+
+constexpr int kPageSize = 500;
+constexpr int kCheckpointPages = 50;
+
+// Rate limit exceeded and temporary errors.
+bool IsTemporaryError(const int error_code) {
+  return error_code == 29 || error_code == 16 || error_code == 8;
 }
 
+QVariantList PagesToVariant(const QSet<int> &pages) {
+
+  QVariantList list;
+  list.reserve(pages.count());
+  for (const int page : pages) {
+    list << page;
+  }
+  return list;
+
+}
+
+QSet<int> PagesFromVariant(const QVariant &variant) {
+
+  QSet<int> pages;
+  const QVariantList list = variant.toList();
+  for (const QVariant &page : list) {
+    pages << page.toInt();
+  }
+  return pages;
+
+}
+
+}  // namespace
+
 LastFMImport::LastFMImport(SharedPtr<NetworkAccessManager> network, QObject *parent)
     : QObject(parent),
       network_(network),
       timer_flush_requests_(new QTimer(this)),
+      request_concurrency_(2, kMaxConcurrentRequests),
       lastplayed_(false),
       playcount_(false),
       playcount_total_(0),
       lastplayed_total_(0),
       playcount_received_(0),
-      lastplayed_received_(0) {
+      lastplayed_received_(0),
+      recent_tracks_to_(0),
+      pages_unsaved_(0) {
 
   timer_flush_requests_->setInterval(kRequestsDelay);
   timer_flush_requests_->setSingleShot(false);
@@ -84,6 +129,12 @@ void LastFMImport::AbortAll() {
     reply->deleteLater();
   }
 
+  // Keep what was received, the import continues from here the next time.
+  if (pages_unsaved_ > 0) {
+    ApplyStatistics();
+  }
+  statistics_.clear();
+
   playcount_total_ = 0;
   lastplayed_total_ = 0;
   playcount_received_ = 0;
@@ -128,6 +179,7 @@ QNetworkReply *LastFMImport::CreateRequest(const ParamList &request_params) {
 
   QNetworkReply *reply = network_->get(req);
   replies_ << reply;
+  request_concurrency_.ReplyStarted(reply);
 
   //qLog(Debug) << "Sending request" << url_query.toString(QUrl::FullyDecoded);
 
@@ -217,17 +269,127 @@ void LastFMImport::ImportData(const bool lastplayed, const bool playcount) {
   }
 
   AbortAll();
+  LoadCursor();
 
   lastplayed_ = lastplayed;
   playcount_ = playcount;
 
-  if (lastplayed) AddGetRecentTracksRequest(0);
-  if (playcount) AddGetTopTracksRequest(0);
+  if (lastplayed) {
+    if (recent_tracks_to_ <= 0) {
+      recent_tracks_pages_.clear();
+      recent_tracks_to_ = QDateTime::currentSecsSinceEpoch();
+    }
+    if (!recent_tracks_pages_.isEmpty()) {
+      qLog(Debug) << "Resuming last.fm last played import," << recent_tracks_pages_.count() << "pages already imported";
+    }
+    AddGetRecentTracksRequest(GetRecentTracksRequest(0));
+  }
+
+  if (playcount) {
+    if (!top_tracks_pages_.isEmpty()) {
+      qLog(Debug) << "Resuming last.fm playcount import," << top_tracks_pages_.count() << "pages already imported";
+    }
+    AddGetTopTracksRequest(GetTopTracksRequest(0));
+  }
+
+}
+
+void LastFMImport::LoadCursor() {
+
+  recent_tracks_to_ = 0;
+  recent_tracks_pages_.clear();
+  top_tracks_pages_.clear();
+  pages_unsaved_ = 0;
+
+  Settings s;
+  s.beginGroup(kSettingsGroup);
+  if (s.value("username").toString() == username_) {
+    recent_tracks_to_ = s.value("recent_tracks_to", 0).toLongLong();
+    recent_tracks_pages_ = PagesFromVariant(s.value("recent_tracks_pages"));
+    top_tracks_pages_ = PagesFromVariant(s.value("top_tracks_pages"));
+  }
+  s.endGroup();
+
+}
+
+void LastFMImport::SaveCursor() {
+
+  Settings s;
+  s.beginGroup(kSettingsGroup);
+  if (recent_tracks_pages_.isEmpty() && top_tracks_pages_.isEmpty()) {
+    s.remove(QString());
+  }
+  else {
+    s.setValue("username", username_);
+    s.setValue("recent_tracks_to", recent_tracks_to_);
+    s.setValue("recent_tracks_pages", PagesToVariant(recent_tracks_pages_));
+    s.setValue("top_tracks_pages", PagesToVariant(top_tracks_pages_));
+  }
+  s.endGroup();
+
+}
+
+void LastFMImport::ApplyStatistics() {
+
+  // The statistics are sent before the cursor is saved, so pages are never skipped without their statistics being applied.
+  if (!statistics_.isEmpty()) {
+    emit UpdatePlayStatistics(statistics_.values());
+    statistics_.clear();
+  }
+  pages_unsaved_ = 0;
+
+  SaveCursor();
+
+}
+
+void LastFMImport::AddLastPlayed(const QString &artist, const QString &album, const QString &title, const qint64 lastplayed) {
+
+  CollectionBackend::PlayStatisticsByMetadata &statistics = statistics_[artist.toLower() + QLatin1Char('\n') + album.toLower() + QLatin1Char('\n') + title.toLower()];
+  statistics.artist = artist;
+  statistics.album = album;
+  statistics.title = title;
+  statistics.lastplayed = qMax(statistics.lastplayed, lastplayed);
+
+}
+
+void LastFMImport::AddPlayCount(const QString &artist, const QString &title, const int playcount) {
+
+  CollectionBackend::PlayStatisticsByMetadata &statistics = statistics_[artist.toLower() + QLatin1Char('\n') + QLatin1Char('\n') + title.toLower()];
+  statistics.artist = artist;
+  statistics.title = title;
+  statistics.playcount = qMax(statistics.playcount, playcount);
+
+}
+
+void LastFMImport::PageReceived() {
+
+  ++pages_unsaved_;
+  if (pages_unsaved_ >= kCheckpointPages) {
+    ApplyStatistics();
+  }
+
+}
+
+template<typename T>
+bool LastFMImport::Retry(T request, QQueue<T> &requests) {
+
+  if (request.retries >= kMaxRetries) return false;
+
+  ++request.retries;
+  requests.enqueue(request);
+
+  if (!timer_flush_requests_->isActive()) {
+    timer_flush_requests_->start();
+  }
+
+  return true;
 
 }
 
 void LastFMImport::FlushRequests() {
 
+  if (replies_.count() >= request_concurrency_.limit()) return;
+
   if (!recent_tracks_requests_.isEmpty()) {
     SendGetRecentTracksRequest(recent_tracks_requests_.dequeue());
     return;
@@ -242,9 +404,9 @@ void LastFMImport::FlushRequests() {
 
 }
 
-void LastFMImport::AddGetRecentTracksRequest(const int page) {
+void LastFMImport::AddGetRecentTracksRequest(const GetRecentTracksRequest &request) {
 
-  recent_tracks_requests_.enqueue(GetRecentTracksRequest(page));
+  recent_tracks_requests_.enqueue(request);
 
   if (!timer_flush_requests_->isActive()) {
     timer_flush_requests_->start();
@@ -252,9 +414,10 @@ void LastFMImport::AddGetRecentTracksRequest(const int page) {
 
 }
 
-void LastFMImport::SendGetRecentTracksRequest(GetRecentTracksRequest request) {
+void LastFMImport::SendGetRecentTracksRequest(const GetRecentTracksRequest &request) {
 
   ParamList params = ParamList() << Param(QStringLiteral("method"), QStringLiteral("user.getRecentTracks"));
+  params << Param(QStringLiteral("to"), QString::number(recent_tracks_to_));
 
   if (request.page == 0) {
     params << Param(QStringLiteral("page"), QStringLiteral("1"));
@@ -262,21 +425,26 @@ void LastFMImport::SendGetRecentTracksRequest(GetRecentTracksRequest request) {
   }
   else {
     params << Param(QStringLiteral("page"), QString::number(request.page));
-    params << Param(QStringLiteral("limit"), QStringLiteral("500"));
+    params << Param(QStringLiteral("limit"), QString::number(kPageSize));
   }
 
   QNetworkReply *reply = CreateRequest(params);
-  QObject::connect(reply, &QNetworkReply::finished, this, [this, reply, request]() { GetRecentTracksRequestFinished(reply, request.page); });
+  QObject::connect(reply, &QNetworkReply::finished, this, [this, reply, request]() { GetRecentTracksRequestFinished(reply, request); });
 
 }
 
-void LastFMImport::GetRecentTracksRequestFinished(QNetworkReply *reply, const int page) {
+void LastFMImport::GetRecentTracksRequestFinished(QNetworkReply *reply, const GetRecentTracksRequest &request) {
 
   if (!replies_.contains(reply)) return;
   replies_.removeAll(reply);
   QObject::disconnect(reply, nullptr, this, nullptr);
   reply->deleteLater();
 
+  request_concurrency_.ReplyFinished(reply);
+  if (InternetRequestConcurrency::IsThrottled(reply) && Retry(request, recent_tracks_requests_)) {
+    return;
+  }
+
   QByteArray data = GetReplyData(reply);
   if (data.isEmpty()) {
     return;
@@ -289,6 +457,9 @@ void LastFMImport::GetRecentTracksRequestFinished(QNetworkReply *reply, const in
 
   if (json_obj.contains(QStringLiteral("error")) && json_obj.contains(QStringLiteral("message"))) {
     int error_code = json_obj[QStringLiteral("error")].toInt();
+    if (IsTemporaryError(error_code) && Retry(request, recent_tracks_requests_)) {
+      return;
+    }
     QString error_message = json_obj[QStringLiteral("message")].toString();
     QString error_reason = QStringLiteral("%1 (%2)").arg(error_message).arg(error_code);
     Error(error_reason);
@@ -341,13 +512,20 @@ void LastFMImport::GetRecentTracksRequestFinished(QNetworkReply *reply, const in
     return;
   }
 
-  int total = obj_attr[QStringLiteral("total")].toString().toInt();
-  int pages = obj_attr[QStringLiteral("totalPages")].toString().toInt();
+  const int total = obj_attr[QStringLiteral("total")].toString().toInt();
 
-  if (page == 0) {
+  if (request.page == 0) {
     lastplayed_total_ = total;
+    lastplayed_received_ = qMin(total, static_cast<int>(recent_tracks_pages_.count()) * kPageSize);
     UpdateTotalCheck();
-    AddGetRecentTracksRequest(1);
+    UpdateProgressCheck();
+    // All pages are queued at once, so they're sent concurrently.
+    const int pages = (total + kPageSize - 1) / kPageSize;
+    for (int page = 1; page <= pages; ++page) {
+      if (!recent_tracks_pages_.contains(page)) {
+        AddGetRecentTracksRequest(GetRecentTracksRequest(page));
+      }
+    }
   }
   else {
 
@@ -386,18 +564,14 @@ void LastFMImport::GetRecentTracksRequestFinished(QNetworkReply *reply, const in
       QString title = obj_track[QStringLiteral("name")].toString();
       QDateTime datetime = QDateTime::fromString(date, QStringLiteral("dd MMM yyyy, hh:mm"));
       if (datetime.isValid()) {
-        emit UpdateLastPlayed(artist, album, title, datetime.toSecsSinceEpoch());
+        AddLastPlayed(artist, album, title, datetime.toSecsSinceEpoch());
       }
 
-      UpdateProgressCheck();
-
     }
 
-    if (page == 1) {
-      for (int i = 2; i <= pages; ++i) {
-        AddGetRecentTracksRequest(i);
-      }
-    }
+    recent_tracks_pages_ << request.page;
+    UpdateProgressCheck();
+    PageReceived();
 
   }
 
@@ -405,9 +579,9 @@ void LastFMImport::GetRecentTracksRequestFinished(QNetworkReply *reply, const in
 
 }
 
-void LastFMImport::AddGetTopTracksRequest(const int page) {
+void LastFMImport::AddGetTopTracksRequest(const GetTopTracksRequest &request) {
 
-  top_tracks_requests_.enqueue(GetTopTracksRequest(page));
+  top_tracks_requests_.enqueue(request);
 
   if (!timer_flush_requests_->isActive()) {
     timer_flush_requests_->start();
@@ -415,7 +589,7 @@ void LastFMImport::AddGetTopTracksRequest(const int page) {
 
 }
 
-void LastFMImport::SendGetTopTracksRequest(GetTopTracksRequest request) {
+void LastFMImport::SendGetTopTracksRequest(const GetTopTracksRequest &request) {
 
   ParamList params = ParamList() << Param(QStringLiteral("method"), QStringLiteral("user.getTopTracks"));
 
@@ -425,21 +599,26 @@ void LastFMImport::SendGetTopTracksRequest(GetTopTracksRequest request) {
   }
   else {
     params << Param(QStringLiteral("page"), QString::number(request.page));
-    params << Param(QStringLiteral("limit"), QStringLiteral("500"));
+    params << Param(QStringLiteral("limit"), QString::number(kPageSize));
   }
 
   QNetworkReply *reply = CreateRequest(params);
-  QObject::connect(reply, &QNetworkReply::finished, this, [this, reply, request]() { GetTopTracksRequestFinished(reply, request.page); });
+  QObject::connect(reply, &QNetworkReply::finished, this, [this, reply, request]() { GetTopTracksRequestFinished(reply, request); });
 
 }
 
-void LastFMImport::GetTopTracksRequestFinished(QNetworkReply *reply, const int page) {
+void LastFMImport::GetTopTracksRequestFinished(QNetworkReply *reply, const GetTopTracksRequest &request) {
 
   if (!replies_.contains(reply)) return;
   replies_.removeAll(reply);
   QObject::disconnect(reply, nullptr, this, nullptr);
   reply->deleteLater();
 
+  request_concurrency_.ReplyFinished(reply);
+  if (InternetRequestConcurrency::IsThrottled(reply) && Retry(request, top_tracks_requests_)) {
+    return;
+  }
+
   QByteArray data = GetReplyData(reply);
   if (data.isEmpty()) {
     return;
@@ -452,6 +631,9 @@ void LastFMImport::GetTopTracksRequestFinished(QNetworkReply *reply, const int p
 
   if (json_obj.contains(QStringLiteral("error")) && json_obj.contains(QStringLiteral("message"))) {
     int error_code = json_obj[QStringLiteral("error")].toInt();
+    if (IsTemporaryError(error_code) && Retry(request, top_tracks_requests_)) {
+      return;
+    }
     QString error_message = json_obj[QStringLiteral("message")].toString();
     QString error_reason = QStringLiteral("%1 (%2)").arg(error_message).arg(error_code);
     Error(error_reason);
@@ -504,13 +686,19 @@ void LastFMImport::GetTopTracksRequestFinished(QNetworkReply *reply, const int p
     return;
   }
 
-  int pages = obj_attr[QStringLiteral("totalPages")].toString().toInt();
-  int total = obj_attr[QStringLiteral("total")].toString().toInt();
+  const int total = obj_attr[QStringLiteral("total")].toString().toInt();
 
-  if (page == 0) {
+  if (request.page == 0) {
     playcount_total_ = total;
+    playcount_received_ = qMin(total, static_cast<int>(top_tracks_pages_.count()) * kPageSize);
     UpdateTotalCheck();
-    AddGetTopTracksRequest(1);
+    UpdateProgressCheck();
+    const int pages = (total + kPageSize - 1) / kPageSize;
+    for (int page = 1; page <= pages; ++page) {
+      if (!top_tracks_pages_.contains(page)) {
+        AddGetTopTracksRequest(GetTopTracksRequest(page));
+      }
+    }
   }
   else {
 
@@ -545,16 +733,13 @@ void LastFMImport::GetTopTracksRequestFinished(QNetworkReply *reply, const int p
 
       if (playcount <= 0) continue;
 
-      emit UpdatePlayCount(artist, title, playcount, false);
-      UpdateProgressCheck();
+      AddPlayCount(artist, title, playcount);
 
     }
 
-    if (page == 1) {
-      for (int i = 2; i <= pages; ++i) {
-        AddGetTopTracksRequest(i);
-      }
-    }
+    top_tracks_pages_ << request.page;
+    UpdateProgressCheck();
+    PageReceived();
 
   }
 
@@ -574,7 +759,23 @@ void LastFMImport::UpdateProgressCheck() {
 }
 
 void LastFMImport::FinishCheck() {
-  if (replies_.isEmpty() && recent_tracks_requests_.isEmpty() && top_tracks_requests_.isEmpty()) emit Finished();
+
+  if (!replies_.isEmpty() || !recent_tracks_requests_.isEmpty() || !top_tracks_requests_.isEmpty()) return;
+
+  // The import is complete, so the next one starts from the beginning.
+  if (lastplayed_) {
+    recent_tracks_to_ = 0;
+    recent_tracks_pages_.clear();
+  }
+  if (playcount_) {
+    top_tracks_pages_.clear();
+  }
+  ApplyStatistics();
+
+  timer_flush_requests_->stop();
+
+  emit Finished();
+
 }
 
 void LastFMImport::Error(const QString &error, const QVariant &debug) {
@@ -29,15 +29,22 @@
 #include <QByteArray>
 #include <QString>
 #include <QQueue>
+#include <QSet>
+#include <QHash>
 #include <QDateTime>
 
 #include "core/shared_ptr.h"
+#include "collection/collectionbackend.h"
+#include "internet/internetrequestconcurrency.h"
 
 class QTimer;
 class QNetworkReply;
 
 class NetworkAccessManager;
 
+// Imports the last played times and play counts from last.fm.
+// The pages are fetched concurrently and the statistics are collected in memory and sent to the collection in bulk.
+// The completed pages are saved with the statistics, so an interrupted import continues where it stopped.
 class LastFMImport : public QObject {
   Q_OBJECT
 
@@ -54,12 +61,14 @@ class LastFMImport : public QObject {
   using ParamList = QList<Param>;
 
   struct GetRecentTracksRequest {
-    explicit GetRecentTracksRequest(const int _page) : page(_page) {}
+    explicit GetRecentTracksRequest(const int _page) : page(_page), retries(0) {}
     int page;
+    int retries;
   };
   struct GetTopTracksRequest {
-    explicit GetTopTracksRequest(const int _page) : page(_page) {}
+    explicit GetTopTracksRequest(const int _page) : page(_page), retries(0) {}
     int page;
+    int retries;
   };
 
  private:
@@ -67,11 +76,23 @@ class LastFMImport : public QObject {
   QByteArray GetReplyData(QNetworkReply *reply);
   QJsonObject ExtractJsonObj(const QByteArray &data);
 
-  void AddGetRecentTracksRequest(const int page = 0);
-  void AddGetTopTracksRequest(const int page = 0);
+  void AddGetRecentTracksRequest(const GetRecentTracksRequest &request);
+  void AddGetTopTracksRequest(const GetTopTracksRequest &request);
 
-  void SendGetRecentTracksRequest(GetRecentTracksRequest request);
-  void SendGetTopTracksRequest(GetTopTracksRequest request);
+  void SendGetRecentTracksRequest(const GetRecentTracksRequest &request);
+  void SendGetTopTracksRequest(const GetTopTracksRequest &request);
+
+  // Queues a throttled request again, returns false if it was retried too many times.
+  template<typename T>
+  bool Retry(T request, QQueue<T> &requests);
+
+  void AddLastPlayed(const QString &artist, const QString &album, const QString &title, const qint64 lastplayed);
+  void AddPlayCount(const QString &artist, const QString &title, const int playcount);
+  void PageReceived();
+
+  void LoadCursor();
+  void SaveCursor();
+  void ApplyStatistics();
 
   void Error(const QString &error, const QVariant &debug = QVariant());
 
@@ -81,8 +102,7 @@ class LastFMImport : public QObject {
   void FinishCheck();
 
  signals:
-  void UpdatePlayCount(const QString&, const QString&, const int, const bool = false);
-  void UpdateLastPlayed(const QString&, const QString&, const QString&, const qint64);
+  void UpdatePlayStatistics(const CollectionBackend::PlayStatisticsByMetadataList &statistics);
   void UpdateTotal(const int, const int);
   void UpdateProgress(const int, const int);
   void Finished();
@@ -90,12 +110,13 @@ class LastFMImport : public QObject {
 
  private slots:
   void FlushRequests();
-  void GetRecentTracksRequestFinished(QNetworkReply *reply, const int page);
-  void GetTopTracksRequestFinished(QNetworkReply *reply, const int page);
+  void GetRecentTracksRequestFinished(QNetworkReply *reply, const GetRecentTracksRequest &request);
+  void GetTopTracksRequestFinished(QNetworkReply *reply, const GetTopTracksRequest &request);
 
  private:
   SharedPtr<NetworkAccessManager> network_;
   QTimer *timer_flush_requests_;
+  InternetRequestConcurrency request_concurrency_;
 
   QString username_;
   bool lastplayed_;
@@ -107,6 +128,14 @@ class LastFMImport : public QObject {
   QQueue<GetRecentTracksRequest> recent_tracks_requests_;
   QQueue<GetTopTracksRequest> top_tracks_requests_;
   QList<QNetworkReply*> replies_;
+
+  // The recent tracks are requested up to the time the import started, so the pages don't move when new tracks are scrobbled.
+  qint64 recent_tracks_to_;
+  QSet<int> recent_tracks_pages_;
+  QSet<int> top_tracks_pages_;
+  // Pages received since the statistics were last sent to the collection and the cursor was saved.
+  int pages_unsaved_;
+  QHash<QString, CollectionBackend::PlayStatisticsByMetadata> statistics_;
 };
 
 #endif  // LASTFMIMPORT_H
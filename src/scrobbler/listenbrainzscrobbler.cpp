@@ -67,18 +67,21 @@ constexpr char kApiUrl[] = "https://api.listenbrainz.org";
 constexpr char kClientIDB64[] = "b2VBVU53cVNRZXIwZXIwOUZpcWkwUQ==";
 constexpr char kClientSecretB64[] = "Uk9GZ2hrZVEzRjNvUHlFaHFpeVdQQQ==";
 constexpr char kCacheFile[] = "listenbrainzscrobbler.cache";
-constexpr int kScrobblesPerRequest = 10;
+constexpr int kScrobblesPerRequest = 100;
+constexpr int kMaxConcurrentSubmits = 4;
 }  // namespace
 
 ListenBrainzScrobbler::ListenBrainzScrobbler(SharedPtr<ScrobblerSettings> settings, SharedPtr<NetworkAccessManager> network, QObject *parent)
     : ScrobblerService(QLatin1String(kName), settings, parent),
       network_(network),
-      cache_(new ScrobblerCache(QLatin1String(kCacheFile), this)),
+      cache_(new ScrobblerCache(QLatin1String(kCacheFile), &metrics_, this)),
       server_(nullptr),
       enabled_(false),
       expires_in_(-1),
       login_time_(0),
-      submitted_(false),
+      submits_active_(0),
+      backlog_(false),
+      submit_concurrency_(1, kMaxConcurrentSubmits),
       scrobbled_(false),
       timestamp_(0),
       submit_error_(false),
@@ -362,6 +365,7 @@ QNetworkReply *ListenBrainzScrobbler::CreateRequest(const QUrl &url, const QJson
   req.setRawHeader("Authorization", QStringLiteral("Token %1").arg(user_token_).toUtf8());
   QNetworkReply *reply = network_->post(req, json_doc.toJson());
   replies_ << reply;
+  AddRequestMetrics(reply);
 
   //qLog(Debug) << "ListenBrainz: Sending request" << json_doc.toJson();
 
@@ -521,7 +525,13 @@ void ListenBrainzScrobbler::Scrobble(const Song &song) {
 
 void ListenBrainzScrobbler::StartSubmit(const bool initial) {
 
-  if (!submitted_ && cache_->Count() > 0) {
+  // While draining a backlog the next batches are sent as soon as the replies come in, unless we have to wait for the rate limit.
+  if (backlog_ && !submit_error_) {
+    if (!timer_submit_.isActive()) Submit();
+    return;
+  }
+
+  if (submits_active_ <= 0 && cache_->Count() > 0) {
     if (initial && settings_->submit_delay() <= 0 && !submit_error_) {
       if (timer_submit_.isActive()) {
         timer_submit_.stop();
@@ -543,6 +553,15 @@ void ListenBrainzScrobbler::Submit() {
 
   if (!enabled() || !authenticated() || settings_->offline()) return;
 
+  // A backlog is imported with several batches at the same time, as many as the server handles without slowing down.
+  while (submits_active_ < submit_concurrency_.limit()) {
+    if (!SubmitBatch()) break;
+  }
+
+}
+
+bool ListenBrainzScrobbler::SubmitBatch() {
+
   QJsonArray array;
   ScrobblerCacheItemPtrList cache_items_sent;
   ScrobblerCacheItemPtrList all_cache_items = cache_->List();
@@ -558,9 +577,11 @@ void ListenBrainzScrobbler::Submit() {
     if (cache_items_sent.count() >= kScrobblesPerRequest || cache_item->error) break;
   }
 
-  if (cache_items_sent.count() <= 0) return;
+  backlog_ = cache_items_sent.count() >= kScrobblesPerRequest;
+
+  if (cache_items_sent.count() <= 0) return false;
 
-  submitted_ = true;
+  ++submits_active_;
 
   QJsonObject object;
   object.insert(QStringLiteral("listen_type"), QStringLiteral("import"));
@@ -569,8 +590,11 @@ void ListenBrainzScrobbler::Submit() {
 
   QUrl url(QStringLiteral("%1/1/submit-listens").arg(QLatin1String(kApiUrl)));
   QNetworkReply *reply = CreateRequest(url, doc);
+  submit_concurrency_.ReplyStarted(reply);
   QObject::connect(reply, &QNetworkReply::finished, this, [this, reply, cache_items_sent]() { ScrobbleRequestFinished(reply, cache_items_sent); });
 
+  return true;
+
 }
 
 void ListenBrainzScrobbler::ScrobbleRequestFinished(QNetworkReply *reply, ScrobblerCacheItemPtrList cache_items) {
@@ -580,7 +604,18 @@ void ListenBrainzScrobbler::ScrobbleRequestFinished(QNetworkReply *reply, Scrobb
   QObject::disconnect(reply, nullptr, this, nullptr);
   reply->deleteLater();
 
-  submitted_ = false;
+  --submits_active_;
+  submit_concurrency_.ReplyFinished(reply);
+
+  // Wait for the rate limit window to reset before sending the next batches.
+  if (reply->hasRawHeader("X-RateLimit-Remaining") && reply->hasRawHeader("X-RateLimit-Reset-In") && reply->rawHeader("X-RateLimit-Remaining").toInt() <= 0) {
+    const int reset_in = reply->rawHeader("X-RateLimit-Reset-In").toInt();
+    if (reset_in > 0) {
+      qLog(Debug) << "ListenBrainz: Rate limit reached, waiting" << reset_in << "seconds.";
+      timer_submit_.setInterval(static_cast<int>(reset_in * kMsecPerSec));
+      timer_submit_.start();
+    }
+  }
 
   QJsonObject json_obj;
   QString error_message;
@@ -34,6 +34,7 @@
 
 #include "core/shared_ptr.h"
 #include "core/song.h"
+#include "internet/internetrequestconcurrency.h"
 #include "scrobblerservice.h"
 #include "scrobblercache.h"
 #include "scrobblemetadata.h"
@@ -59,7 +60,7 @@ class ListenBrainzScrobbler : public ScrobblerService {
 
   bool enabled() const override { return enabled_; }
   bool authenticated() const override { return !access_token_.isEmpty() && !user_token_.isEmpty(); }
-  bool submitted() const override { return submitted_; }
+  bool submitted() const override { return submits_active_ > 0; }
   QString user_token() const { return user_token_; }
 
   void Authenticate();
@@ -99,6 +100,7 @@ class ListenBrainzScrobbler : public ScrobblerService {
   void Error(const QString &error, const QVariant &debug = QVariant());
   void RequestAccessToken(const QUrl &redirect_url = QUrl(), const QString &code = QString());
   void StartSubmit(const bool initial = false) override;
+  bool SubmitBatch();
   void CheckScrobblePrevSong();
 
   SharedPtr<NetworkAccessManager> network_;
@@ -111,7 +113,9 @@ class ListenBrainzScrobbler : public ScrobblerService {
   QString token_type_;
   QString refresh_token_;
   quint64 login_time_;
-  bool submitted_;
+  int submits_active_;
+  bool backlog_;
+  InternetRequestConcurrency submit_concurrency_;
   Song song_playing_;
   bool scrobbled_;
   quint64 timestamp_;
@@ -22,14 +22,21 @@
 #include <functional>
 #include <chrono>
 #include <memory>
+#include <utility>
 
 #include <QObject>
+#include <QList>
+#include <QMultiHash>
+#include <QSet>
 #include <QStandardPaths>
 #include <QString>
+#include <QByteArray>
 #include <QFile>
+#include <QSaveFile>
 #include <QIODevice>
 #include <QTextStream>
 #include <QTimer>
+#include <QDateTime>
 #include <QJsonDocument>
 #include <QJsonValue>
 #include <QJsonObject>
@@ -40,18 +47,33 @@
 
 #include "scrobblercache.h"
 #include "scrobblercacheitem.h"
+#include "scrobblermetrics.h"
 
 using std::make_shared;
 using namespace std::chrono_literals;
 
-ScrobblerCache::ScrobblerCache(const QString &filename, QObject *parent)
+namespace {
+
+// The journal is compacted into the cache file when it has more records than this, and more records than there are items.
+constexpr int kMinCompactJournalRecords = 1000;
+
+QString ItemKey(const quint64 timestamp, const QString &artist, const QString &title) {
+  return QString::number(timestamp) + QLatin1Char('\t') + artist + QLatin1Char('\t') + title;
+}
+
+}  // namespace
+
+ScrobblerCache::ScrobblerCache(const QString &filename, ScrobblerMetrics *metrics, QObject *parent)
     : QObject(parent),
+      metrics_(metrics),
       timer_flush_(new QTimer(this)),
       filename_(QStandardPaths::writableLocation(QStandardPaths::CacheLocation) + QLatin1Char('/') + filename),
-      loaded_(false) {
+      journal_filename_(filename_ + QStringLiteral(".journal")),
+      loaded_(false),
+      journal_records_(0) {
 
   ReadCache();
-  loaded_ = true;
+  metrics_->SetBacklog(scrobbler_cache_.count());
 
   timer_flush_->setSingleShot(true);
   timer_flush_->setInterval(10min);
@@ -65,6 +87,19 @@ ScrobblerCache::~ScrobblerCache() {
 
 void ScrobblerCache::ReadCache() {
 
+  ReadCacheFile();
+  const bool journal_complete = ReadJournal();
+  loaded_ = true;
+
+  // Compact a damaged journal right away, so new records aren't appended to a torn line.
+  if (!journal_complete) {
+    WriteCache();
+  }
+
+}
+
+void ScrobblerCache::ReadCacheFile() {
+
   QFile file(filename_);
   bool result = file.open(QIODevice::ReadOnly | QIODevice::Text);
   if (!result) return;
@@ -119,73 +154,208 @@ void ScrobblerCache::ReadCache() {
       qLog(Debug) << value;
       continue;
     }
-    QJsonObject json_obj_track = value.toObject();
-    if (
-        !json_obj_track.contains(QStringLiteral("timestamp")) ||
-        !json_obj_track.contains(QStringLiteral("artist")) ||
-        !json_obj_track.contains(QStringLiteral("album")) ||
-        !json_obj_track.contains(QStringLiteral("title")) ||
-        !json_obj_track.contains(QStringLiteral("track")) ||
-        !json_obj_track.contains(QStringLiteral("albumartist")) ||
-        !json_obj_track.contains(QStringLiteral("length_nanosec"))
-    ) {
-      qLog(Error) << "Scrobbler cache JSON tracks array value is missing data.";
-      qLog(Debug) << value;
-      continue;
+    ScrobblerCacheItemPtr cache_item = ItemFromJson(value.toObject());
+    if (cache_item) {
+      scrobbler_cache_ << cache_item;
     }
+  }
 
-    ScrobbleMetadata metadata;
-    quint64 timestamp = json_obj_track[QStringLiteral("timestamp")].toVariant().toULongLong();
-    metadata.artist = json_obj_track[QStringLiteral("artist")].toString();
-    metadata.album = json_obj_track[QStringLiteral("album")].toString();
-    metadata.title = json_obj_track[QStringLiteral("title")].toString();
-    metadata.track = json_obj_track[QStringLiteral("track")].toInt();
-    metadata.albumartist = json_obj_track[QStringLiteral("albumartist")].toString();
-    metadata.length_nanosec = json_obj_track[QStringLiteral("length_nanosec")].toVariant().toLongLong();
-
-    if (timestamp == 0 || metadata.artist.isEmpty() || metadata.title.isEmpty() || metadata.length_nanosec <= 0) {
-      qLog(Error) << "Invalid cache data" << "for song" << metadata.title;
-      continue;
-    }
+}
 
-    if (json_obj_track.contains(QStringLiteral("grouping"))) {
-      metadata.grouping = json_obj_track[QStringLiteral("grouping")].toString();
-    }
+bool ScrobblerCache::ReadJournal() {
 
-    if (json_obj_track.contains(QStringLiteral("musicbrainz_album_artist_id"))) {
-      metadata.musicbrainz_album_artist_id = json_obj_track[QStringLiteral("musicbrainz_album_artist_id")].toString();
-    }
-    if (json_obj_track.contains(QStringLiteral("musicbrainz_artist_id"))) {
-      metadata.musicbrainz_artist_id = json_obj_track[QStringLiteral("musicbrainz_artist_id")].toString();
-    }
-    if (json_obj_track.contains(QStringLiteral("musicbrainz_original_artist_id"))) {
-      metadata.musicbrainz_original_artist_id = json_obj_track[QStringLiteral("musicbrainz_original_artist_id")].toString();
+  QFile file(journal_filename_);
+  if (!file.open(QIODevice::ReadOnly)) return true;
+
+  QMultiHash<QString, ScrobblerCacheItemPtr> items;
+  for (ScrobblerCacheItemPtr cache_item : std::as_const(scrobbler_cache_)) {
+    items.insert(ItemKey(cache_item->timestamp, cache_item->metadata.artist, cache_item->metadata.title), cache_item);
+  }
+
+  bool complete = true;
+  QSet<ScrobblerCacheItem*> removed_items;
+  while (!file.atEnd()) {
+    const QByteArray raw_line = file.readLine();
+    // The last record can be cut off if we were killed while writing it.
+    if (!raw_line.endsWith('\n')) {
+      complete = false;
     }
-    if (json_obj_track.contains(QStringLiteral("musicbrainz_album_id"))) {
-      metadata.musicbrainz_album_id = json_obj_track[QStringLiteral("musicbrainz_album_id")].toString();
+    const QByteArray line = raw_line.trimmed();
+    if (line.isEmpty()) continue;
+    ++journal_records_;
+    QJsonParseError error;
+    const QJsonDocument json_doc = QJsonDocument::fromJson(line, &error);
+    if (error.error != QJsonParseError::NoError || !json_doc.isObject()) {
+      qLog(Error) << "Scrobbler cache journal has an invalid record.";
+      complete = false;
+      continue;
     }
-    if (json_obj_track.contains(QStringLiteral("musicbrainz_original_album_id"))) {
-      metadata.musicbrainz_original_album_id = json_obj_track[QStringLiteral("musicbrainz_original_album_id")].toString();
+    const QJsonObject json_obj = json_doc.object();
+    const QString type = json_obj[QStringLiteral("type")].toString();
+    const QJsonObject json_obj_track = json_obj[QStringLiteral("track")].toObject();
+    if (type == QLatin1String("add")) {
+      ScrobblerCacheItemPtr cache_item = ItemFromJson(json_obj_track);
+      if (cache_item) {
+        scrobbler_cache_ << cache_item;
+        items.insert(ItemKey(cache_item->timestamp, cache_item->metadata.artist, cache_item->metadata.title), cache_item);
+      }
     }
-    if (json_obj_track.contains(QStringLiteral("musicbrainz_recording_id"))) {
-      metadata.musicbrainz_recording_id = json_obj_track[QStringLiteral("musicbrainz_recording_id")].toString();
+    else if (type == QLatin1String("remove")) {
+      const QString key = ItemKey(json_obj_track[QStringLiteral("timestamp")].toVariant().toULongLong(), json_obj_track[QStringLiteral("artist")].toString(), json_obj_track[QStringLiteral("title")].toString());
+      if (items.contains(key)) {
+        removed_items.insert(&*items.take(key));
+      }
     }
-    if (json_obj_track.contains(QStringLiteral("musicbrainz_track_id"))) {
-      metadata.musicbrainz_track_id = json_obj_track[QStringLiteral("musicbrainz_track_id")].toString();
+    else {
+      qLog(Error) << "Scrobbler cache journal has an unknown record type" << type;
     }
-    if (json_obj_track.contains(QStringLiteral("musicbrainz_disc_id"))) {
-      metadata.musicbrainz_disc_id = json_obj_track[QStringLiteral("musicbrainz_disc_id")].toString();
+  }
+  file.close();
+
+  if (!removed_items.isEmpty()) {
+    ScrobblerCacheItemPtrList cache_items;
+    cache_items.reserve(scrobbler_cache_.count() - removed_items.count());
+    for (ScrobblerCacheItemPtr cache_item : std::as_const(scrobbler_cache_)) {
+      if (!removed_items.contains(&*cache_item)) cache_items << cache_item;
     }
-    if (json_obj_track.contains(QStringLiteral("musicbrainz_release_group_id"))) {
-      metadata.musicbrainz_release_group_id = json_obj_track[QStringLiteral("musicbrainz_release_group_id")].toString();
+    scrobbler_cache_ = cache_items;
+  }
+
+  return complete;
+
+}
+
+ScrobblerCacheItemPtr ScrobblerCache::ItemFromJson(const QJsonObject &json_obj_track) {
+
+  if (
+      !json_obj_track.contains(QStringLiteral("timestamp")) ||
+      !json_obj_track.contains(QStringLiteral("artist")) ||
+      !json_obj_track.contains(QStringLiteral("album")) ||
+      !json_obj_track.contains(QStringLiteral("title")) ||
+      !json_obj_track.contains(QStringLiteral("track")) ||
+      !json_obj_track.contains(QStringLiteral("albumartist")) ||
+      !json_obj_track.contains(QStringLiteral("length_nanosec"))
+  ) {
+    qLog(Error) << "Scrobbler cache JSON tracks array value is missing data.";
+    qLog(Debug) << json_obj_track;
+    return nullptr;
+  }
+
+  ScrobbleMetadata metadata;
+  quint64 timestamp = json_obj_track[QStringLiteral("timestamp")].toVariant().toULongLong();
+  metadata.artist = json_obj_track[QStringLiteral("artist")].toString();
+  metadata.album = json_obj_track[QStringLiteral("album")].toString();
+  metadata.title = json_obj_track[QStringLiteral("title")].toString();
+  metadata.track = json_obj_track[QStringLiteral("track")].toInt();
+  metadata.albumartist = json_obj_track[QStringLiteral("albumartist")].toString();
+  metadata.length_nanosec = json_obj_track[QStringLiteral("length_nanosec")].toVariant().toLongLong();
+
+  if (timestamp == 0 || metadata.artist.isEmpty() || metadata.title.isEmpty() || metadata.length_nanosec <= 0) {
+    qLog(Error) << "Invalid cache data" << "for song" << metadata.title;
+    return nullptr;
+  }
+
+  if (json_obj_track.contains(QStringLiteral("grouping"))) {
+    metadata.grouping = json_obj_track[QStringLiteral("grouping")].toString();
+  }
+
+  if (json_obj_track.contains(QStringLiteral("musicbrainz_album_artist_id"))) {
+    metadata.musicbrainz_album_artist_id = json_obj_track[QStringLiteral("musicbrainz_album_artist_id")].toString();
+  }
+  if (json_obj_track.contains(QStringLiteral("musicbrainz_artist_id"))) {
+    metadata.musicbrainz_artist_id = json_obj_track[QStringLiteral("musicbrainz_artist_id")].toString();
+  }
+  if (json_obj_track.contains(QStringLiteral("musicbrainz_original_artist_id"))) {
+    metadata.musicbrainz_original_artist_id = json_obj_track[QStringLiteral("musicbrainz_original_artist_id")].toString();
+  }
+  if (json_obj_track.contains(QStringLiteral("musicbrainz_album_id"))) {
+    metadata.musicbrainz_album_id = json_obj_track[QStringLiteral("musicbrainz_album_id")].toString();
+  }
+  if (json_obj_track.contains(QStringLiteral("musicbrainz_original_album_id"))) {
+    metadata.musicbrainz_original_album_id = json_obj_track[QStringLiteral("musicbrainz_original_album_id")].toString();
+  }
+  if (json_obj_track.contains(QStringLiteral("musicbrainz_recording_id"))) {
+    metadata.musicbrainz_recording_id = json_obj_track[QStringLiteral("musicbrainz_recording_id")].toString();
+  }
+  if (json_obj_track.contains(QStringLiteral("musicbrainz_track_id"))) {
+    metadata.musicbrainz_track_id = json_obj_track[QStringLiteral("musicbrainz_track_id")].toString();
+  }
+  if (json_obj_track.contains(QStringLiteral("musicbrainz_disc_id"))) {
+    metadata.musicbrainz_disc_id = json_obj_track[QStringLiteral("musicbrainz_disc_id")].toString();
+  }
+  if (json_obj_track.contains(QStringLiteral("musicbrainz_release_group_id"))) {
+    metadata.musicbrainz_release_group_id = json_obj_track[QStringLiteral("musicbrainz_release_group_id")].toString();
+  }
+  if (json_obj_track.contains(QStringLiteral("musicbrainz_work_id"))) {
+    metadata.musicbrainz_work_id = json_obj_track[QStringLiteral("musicbrainz_work_id")].toString();
+  }
+
+  return make_shared<ScrobblerCacheItem>(metadata, timestamp);
+
+}
+
+QJsonObject ScrobblerCache::ItemToJson(ScrobblerCacheItemPtr cache_item) {
+
+  QJsonObject object;
+  object.insert(QStringLiteral("timestamp"), QJsonValue::fromVariant(cache_item->timestamp));
+  object.insert(QStringLiteral("artist"), QJsonValue::fromVariant(cache_item->metadata.artist));
+  object.insert(QStringLiteral("album"), QJsonValue::fromVariant(cache_item->metadata.album));
+  object.insert(QStringLiteral("title"), QJsonValue::fromVariant(cache_item->metadata.title));
+  object.insert(QStringLiteral("track"), QJsonValue::fromVariant(cache_item->metadata.track));
+  object.insert(QStringLiteral("albumartist"), QJsonValue::fromVariant(cache_item->metadata.albumartist));
+  object.insert(QStringLiteral("grouping"), QJsonValue::fromVariant(cache_item->metadata.grouping));
+  object.insert(QStringLiteral("musicbrainz_album_artist_id"), QJsonValue::fromVariant(cache_item->metadata.musicbrainz_album_artist_id));
+  object.insert(QStringLiteral("musicbrainz_artist_id"), QJsonValue::fromVariant(cache_item->metadata.musicbrainz_artist_id));
+  object.insert(QStringLiteral("musicbrainz_original_artist_id"), QJsonValue::fromVariant(cache_item->metadata.musicbrainz_original_artist_id));
+  object.insert(QStringLiteral("musicbrainz_album_id"), QJsonValue::fromVariant(cache_item->metadata.musicbrainz_album_id));
+  object.insert(QStringLiteral("musicbrainz_original_album_id"), QJsonValue::fromVariant(cache_item->metadata.musicbrainz_original_album_id));
+  object.insert(QStringLiteral("musicbrainz_recording_id"), QJsonValue::fromVariant(cache_item->metadata.musicbrainz_recording_id));
+  object.insert(QStringLiteral("musicbrainz_track_id"), QJsonValue::fromVariant(cache_item->metadata.musicbrainz_track_id));
+  object.insert(QStringLiteral("musicbrainz_disc_id"), QJsonValue::fromVariant(cache_item->metadata.musicbrainz_disc_id));
+  object.insert(QStringLiteral("musicbrainz_release_group_id"), QJsonValue::fromVariant(cache_item->metadata.musicbrainz_release_group_id));
+  object.insert(QStringLiteral("musicbrainz_work_id"), QJsonValue::fromVariant(cache_item->metadata.musicbrainz_work_id));
+  object.insert(QStringLiteral("length_nanosec"), QJsonValue::fromVariant(cache_item->metadata.length_nanosec));
+
+  return object;
+
+}
+
+void ScrobblerCache::AppendJournal(const QString &type, const ScrobblerCacheItemPtrList &cache_items) {
+
+  if (!loaded_ || cache_items.isEmpty()) return;
+
+  QByteArray data;
+  for (ScrobblerCacheItemPtr cache_item : cache_items) {
+    QJsonObject object;
+    object.insert(QStringLiteral("type"), type);
+    if (type == QLatin1String("add")) {
+      object.insert(QStringLiteral("track"), ItemToJson(cache_item));
     }
-    if (json_obj_track.contains(QStringLiteral("musicbrainz_work_id"))) {
-      metadata.musicbrainz_work_id = json_obj_track[QStringLiteral("musicbrainz_work_id")].toString();
+    else {
+      QJsonObject object_track;
+      object_track.insert(QStringLiteral("timestamp"), QJsonValue::fromVariant(cache_item->timestamp));
+      object_track.insert(QStringLiteral("artist"), cache_item->metadata.artist);
+      object_track.insert(QStringLiteral("title"), cache_item->metadata.title);
+      object.insert(QStringLiteral("track"), object_track);
     }
+    data.append(QJsonDocument(object).toJson(QJsonDocument::Compact));
+    data.append('\n');
+  }
+
+  QFile file(journal_filename_);
+  if (!file.open(QIODevice::WriteOnly | QIODevice::Append)) {
+    qLog(Error) << "Unable to open scrobbler cache journal" << journal_filename_;
+    return;
+  }
+  if (file.write(data) != data.size()) {
+    qLog(Error) << "Unable to write scrobbler cache journal" << journal_filename_;
+  }
+  file.close();
 
-    ScrobblerCacheItemPtr cache_item = make_shared<ScrobblerCacheItem>(metadata, timestamp);
-    scrobbler_cache_ << cache_item;
+  journal_records_ += static_cast<int>(cache_items.count());
 
+  if (journal_records_ >= qMax(kMinCompactJournalRecords, static_cast<int>(scrobbler_cache_.count())) && !timer_flush_->isActive()) {
+    timer_flush_->start();
   }
 
 }
@@ -194,56 +364,42 @@ void ScrobblerCache::WriteCache() {
 
   if (!loaded_) return;
 
+  timer_flush_->stop();
+
   qLog(Debug) << "Writing scrobbler cache file" << filename_;
 
   if (scrobbler_cache_.isEmpty()) {
     QFile file(filename_);
     if (file.exists()) file.remove();
+    if (QFile::exists(journal_filename_)) QFile::remove(journal_filename_);
+    journal_records_ = 0;
     return;
   }
 
   QJsonArray array;
-  for (ScrobblerCacheItemPtr cache_item : scrobbler_cache_) {
-    QJsonObject object;
-    object.insert(QStringLiteral("timestamp"), QJsonValue::fromVariant(cache_item->timestamp));
-    object.insert(QStringLiteral("artist"), QJsonValue::fromVariant(cache_item->metadata.artist));
-    object.insert(QStringLiteral("album"), QJsonValue::fromVariant(cache_item->metadata.album));
-    object.insert(QStringLiteral("title"), QJsonValue::fromVariant(cache_item->metadata.title));
-    object.insert(QStringLiteral("track"), QJsonValue::fromVariant(cache_item->metadata.track));
-    object.insert(QStringLiteral("albumartist"), QJsonValue::fromVariant(cache_item->metadata.albumartist));
-    object.insert(QStringLiteral("grouping"), QJsonValue::fromVariant(cache_item->metadata.grouping));
-    object.insert(QStringLiteral("musicbrainz_album_artist_id"), QJsonValue::fromVariant(cache_item->metadata.musicbrainz_album_artist_id));
-    object.insert(QStringLiteral("musicbrainz_artist_id"), QJsonValue::fromVariant(cache_item->metadata.musicbrainz_artist_id));
-    object.insert(QStringLiteral("musicbrainz_original_artist_id"), QJsonValue::fromVariant(cache_item->metadata.musicbrainz_original_artist_id));
-    object.insert(QStringLiteral("musicbrainz_album_id"), QJsonValue::fromVariant(cache_item->metadata.musicbrainz_album_id));
-    object.insert(QStringLiteral("musicbrainz_original_album_id"), QJsonValue::fromVariant(cache_item->metadata.musicbrainz_original_album_id));
-    object.insert(QStringLiteral("musicbrainz_recording_id"), QJsonValue::fromVariant(cache_item->metadata.musicbrainz_recording_id));
-    object.insert(QStringLiteral("musicbrainz_track_id"), QJsonValue::fromVariant(cache_item->metadata.musicbrainz_track_id));
-    object.insert(QStringLiteral("musicbrainz_disc_id"), QJsonValue::fromVariant(cache_item->metadata.musicbrainz_disc_id));
-    object.insert(QStringLiteral("musicbrainz_release_group_id"), QJsonValue::fromVariant(cache_item->metadata.musicbrainz_release_group_id));
-    object.insert(QStringLiteral("musicbrainz_work_id"), QJsonValue::fromVariant(cache_item->metadata.musicbrainz_work_id));
-    object.insert(QStringLiteral("length_nanosec"), QJsonValue::fromVariant(cache_item->metadata.length_nanosec));
-    array.append(QJsonValue::fromVariant(object));
+  for (ScrobblerCacheItemPtr cache_item : std::as_const(scrobbler_cache_)) {
+    array.append(ItemToJson(cache_item));
   }
 
   QJsonObject object;
   object.insert(QStringLiteral("tracks"), array);
   QJsonDocument doc(object);
 
-  QFile file(filename_);
+  // The journal is only removed after the new cache file replaced the old one, so nothing is lost if we're killed while writing it.
+  QSaveFile file(filename_);
   bool result = file.open(QIODevice::WriteOnly | QIODevice::Text);
   if (!result) {
     qLog(Error) << "Unable to open scrobbler cache file" << filename_;
     return;
   }
-  QTextStream stream(&file);
-#if (QT_VERSION >= QT_VERSION_CHECK(6, 0, 0))
-  stream.setEncoding(QStringConverter::Encoding::Utf8);
-#else
-  stream.setCodec("UTF-8");
-#endif
-  stream << doc.toJson();
-  file.close();
+  file.write(doc.toJson());
+  if (!file.commit()) {
+    qLog(Error) << "Unable to write scrobbler cache file" << filename_;
+    return;
+  }
+
+  if (QFile::exists(journal_filename_)) QFile::remove(journal_filename_);
+  journal_records_ = 0;
 
 }
 
@@ -252,10 +408,10 @@ ScrobblerCacheItemPtr ScrobblerCache::Add(const Song &song, const quint64 timest
   ScrobblerCacheItemPtr cache_item = make_shared<ScrobblerCacheItem>(ScrobbleMetadata(song), timestamp);
 
   scrobbler_cache_ << cache_item;
+  metrics_->AddScrobbleQueued();
+  metrics_->SetBacklog(scrobbler_cache_.count());
 
-  if (loaded_ && !timer_flush_->isActive()) {
-    timer_flush_->start();
-  }
+  AppendJournal(QStringLiteral("add"), ScrobblerCacheItemPtrList() << cache_item);
 
   return cache_item;
 
@@ -265,6 +421,8 @@ void ScrobblerCache::Remove(ScrobblerCacheItemPtr cache_item) {
 
   if (scrobbler_cache_.contains(cache_item)) {
     scrobbler_cache_.removeAll(cache_item);
+    AddSubmittedMetrics(ScrobblerCacheItemPtrList() << cache_item);
+    AppendJournal(QStringLiteral("remove"), ScrobblerCacheItemPtrList() << cache_item);
   }
 }
 
@@ -274,6 +432,8 @@ void ScrobblerCache::ClearSent(ScrobblerCacheItemPtrList cache_items) {
     cache_item->sent = false;
   }
 
+  metrics_->AddScrobblesFailed(static_cast<int>(cache_items.count()));
+
 }
 
 void ScrobblerCache::SetError(ScrobblerCacheItemPtrList cache_items) {
@@ -286,14 +446,25 @@ void ScrobblerCache::SetError(ScrobblerCacheItemPtrList cache_items) {
 
 void ScrobblerCache::Flush(ScrobblerCacheItemPtrList cache_items) {
 
+  ScrobblerCacheItemPtrList removed_items;
   for (ScrobblerCacheItemPtr cache_item : cache_items) {
     if (scrobbler_cache_.contains(cache_item)) {
       scrobbler_cache_.removeAll(cache_item);
+      removed_items << cache_item;
     }
   }
 
-  if (!timer_flush_->isActive()) {
-    timer_flush_->start();
+  AddSubmittedMetrics(removed_items);
+  AppendJournal(QStringLiteral("remove"), removed_items);
+
+}
+
+void ScrobblerCache::AddSubmittedMetrics(const ScrobblerCacheItemPtrList &cache_items) {
+
+  const qint64 now = QDateTime::currentSecsSinceEpoch();
+  for (ScrobblerCacheItemPtr cache_item : cache_items) {
+    metrics_->AddScrobbleSubmitted(now - static_cast<qint64>(cache_item->timestamp));
   }
+  metrics_->SetBacklog(scrobbler_cache_.count());
 
 }
@@ -32,13 +32,18 @@
 #include "scrobblercacheitem.h"
 
 class QTimer;
+class QJsonObject;
 class Song;
+class ScrobblerMetrics;
 
+// Scrobbles that are not sent yet, they are kept in a JSON cache file.
+// Changes are appended to a journal next to the cache file, the cache file is only rewritten when the journal is compacted.
 class ScrobblerCache : public QObject {
   Q_OBJECT
 
  public:
-  explicit ScrobblerCache(const QString &filename, QObject *parent);
+  // The metrics are owned by the scrobbler service and get the backlog and the submitted scrobbles.
+  explicit ScrobblerCache(const QString &filename, ScrobblerMetrics *metrics, QObject *parent);
   ~ScrobblerCache() override;
 
   void ReadCache();
@@ -52,12 +57,25 @@ class ScrobblerCache : public QObject {
   void Flush(ScrobblerCacheItemPtrList cache_items);
 
  public slots:
+  // Writes all items to the cache file and removes the journal.
   void WriteCache();
 
  private:
+  void ReadCacheFile();
+  // Returns false if the journal has a torn or invalid record.
+  bool ReadJournal();
+  static ScrobblerCacheItemPtr ItemFromJson(const QJsonObject &json_obj_track);
+  static QJsonObject ItemToJson(ScrobblerCacheItemPtr cache_item);
+  void AppendJournal(const QString &type, const ScrobblerCacheItemPtrList &cache_items);
+  void AddSubmittedMetrics(const ScrobblerCacheItemPtrList &cache_items);
+
+ private:
+  ScrobblerMetrics *metrics_;
   QTimer *timer_flush_;
   QString filename_;
+  QString journal_filename_;
   bool loaded_;
+  int journal_records_;
   QList<ScrobblerCacheItemPtr> scrobbler_cache_;
 };
 
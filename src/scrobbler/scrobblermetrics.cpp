@@ -0,0 +1,105 @@
+/*
+ * Strawberry Music Player
+ *
+ * Strawberry is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Strawberry is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Strawberry.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#include "config.h"
+
+#include <QtGlobal>
+#include <QList>
+#include <QString>
+#include <QStringList>
+#include <QVariant>
+#include <QVariantMap>
+
+#include "scrobblermetrics.h"
+
+namespace {
+
+void AddHistogram(QVariantMap &map, const QString &name, const ScrobblerMetrics::Histogram &histogram) {
+
+  map.insert(name + QLatin1String(".count"), histogram.count());
+  map.insert(name + QLatin1String(".avg"), histogram.average());
+  map.insert(name + QLatin1String(".max"), histogram.max());
+  for (int i = 0; i < histogram.buckets().count(); ++i) {
+    const QString bucket = i < histogram.bounds().count() ? QString::number(histogram.bounds()[i]) : QStringLiteral("inf");
+    map.insert(name + QLatin1String(".le_") + bucket, histogram.buckets()[i]);
+  }
+
+}
+
+}  // namespace
+
+ScrobblerMetrics::ScrobblerMetrics()
+    : requests_(0),
+      request_errors_(0),
+      scrobbles_queued_(0),
+      scrobbles_submitted_(0),
+      scrobbles_failed_(0),
+      backlog_(0),
+      request_latency_(QList<qint64>() << 100 << 250 << 500 << 1000 << 2000 << 5000 << 10000),
+      scrobble_wait_(QList<qint64>() << 60 << 300 << 900 << 3600 << 21600 << 86400 << 604800) {}
+
+void ScrobblerMetrics::AddRequest(const qint64 latency_msec, const bool success) {
+
+  ++requests_;
+  if (!success) ++request_errors_;
+  request_latency_.Add(latency_msec);
+
+}
+
+void ScrobblerMetrics::AddScrobbleQueued() {
+  ++scrobbles_queued_;
+}
+
+void ScrobblerMetrics::AddScrobbleSubmitted(const qint64 wait_secs) {
+
+  ++scrobbles_submitted_;
+  scrobble_wait_.Add(qMax(static_cast<qint64>(0), wait_secs));
+
+}
+
+void ScrobblerMetrics::AddScrobblesFailed(const int count) {
+  scrobbles_failed_ += static_cast<quint64>(count);
+}
+
+QString ScrobblerMetrics::ToString() const {
+
+  QStringList lines;
+  lines << QStringLiteral("Requests: %1, failed %2").arg(requests_).arg(request_errors_)
+        << QStringLiteral("Request latency: %1").arg(request_latency_.ToString(QStringLiteral("ms")))
+        << QStringLiteral("Scrobbles: queued %1, submitted %2, failed submissions %3, backlog %4").arg(scrobbles_queued_).arg(scrobbles_submitted_).arg(scrobbles_failed_).arg(backlog_)
+        << QStringLiteral("Scrobble wait: %1").arg(scrobble_wait_.ToString(QStringLiteral("s")));
+
+  return lines.join(QLatin1Char('\n'));
+
+}
+
+QVariantMap ScrobblerMetrics::ToVariantMap(const QString &prefix) const {
+
+  QVariantMap map;
+  map.insert(prefix + QLatin1String(".requests"), requests_);
+  map.insert(prefix + QLatin1String(".request_errors"), request_errors_);
+  map.insert(prefix + QLatin1String(".scrobbles_queued"), scrobbles_queued_);
+  map.insert(prefix + QLatin1String(".scrobbles_submitted"), scrobbles_submitted_);
+  map.insert(prefix + QLatin1String(".scrobbles_failed"), scrobbles_failed_);
+  map.insert(prefix + QLatin1String(".backlog"), backlog_);
+  AddHistogram(map, prefix + QLatin1String(".request_latency_ms"), request_latency_);
+  AddHistogram(map, prefix + QLatin1String(".scrobble_wait_s"), scrobble_wait_);
+
+  return map;
+
+}
@@ -0,0 +1,71 @@
+/*
+ * Strawberry Music Player
+ *
+ * Strawberry is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Strawberry is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Strawberry.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#ifndef SCROBBLERMETRICS_H
+#define SCROBBLERMETRICS_H
+
+#include "config.h"
+
+#include <QtGlobal>
+#include <QList>
+#include <QString>
+#include <QVariantMap>
+
+#include "engine/enginemetrics.h"
+
+// Submission counters and histograms of a scrobbler service, for monitoring the backlog and the requests.
+// Only used from the GUI thread.
+class ScrobblerMetrics {
+ public:
+  ScrobblerMetrics();
+
+  using Histogram = EngineMetrics::Histogram;
+
+  void AddRequest(const qint64 latency_msec, const bool success);
+  void AddScrobbleQueued();
+  // The wait is the time from the scrobble until it was accepted by the server.
+  void AddScrobbleSubmitted(const qint64 wait_secs);
+  void AddScrobblesFailed(const int count);
+  void SetBacklog(const int count) { backlog_ = count; }
+
+  quint64 requests() const { return requests_; }
+  quint64 request_errors() const { return request_errors_; }
+  quint64 scrobbles_queued() const { return scrobbles_queued_; }
+  quint64 scrobbles_submitted() const { return scrobbles_submitted_; }
+  quint64 scrobbles_failed() const { return scrobbles_failed_; }
+  int backlog() const { return backlog_; }
+  const Histogram &request_latency() const { return request_latency_; }
+  const Histogram &scrobble_wait() const { return scrobble_wait_; }
+
+  QString ToString() const;
+
+  // Flat map of the values, histogram values have the bucket bound or count, avg and max as suffix.
+  QVariantMap ToVariantMap(const QString &prefix) const;
+
+ private:
+  quint64 requests_;
+  quint64 request_errors_;
+  quint64 scrobbles_queued_;
+  quint64 scrobbles_submitted_;
+  quint64 scrobbles_failed_;
+  int backlog_;
+  Histogram request_latency_;
+  Histogram scrobble_wait_;
+};
+
+#endif  // SCROBBLERMETRICS_H
@@ -25,6 +25,9 @@
 #include <QByteArray>
 #include <QJsonDocument>
 #include <QJsonObject>
+#include <QElapsedTimer>
+#include <QNetworkRequest>
+#include <QNetworkReply>
 
 #include "scrobblerservice.h"
 #include "scrobblersettings.h"
@@ -51,6 +54,17 @@ bool ScrobblerService::ExtractJsonObj(const QByteArray &data, QJsonObject &json_
 
 }
 
+void ScrobblerService::AddRequestMetrics(QNetworkReply *reply) {
+
+  QElapsedTimer timer;
+  timer.start();
+  QObject::connect(reply, &QNetworkReply::finished, this, [this, reply, timer]() {
+    const int http_code = reply->attribute(QNetworkRequest::HttpStatusCodeAttribute).toInt();
+    metrics_.AddRequest(timer.elapsed(), reply->error() == QNetworkReply::NoError && http_code >= 200 && http_code < 300);
+  });
+
+}
+
 QString ScrobblerService::StripAlbum(const QString &album) const {
 
   if (settings_->strip_remastered()) {
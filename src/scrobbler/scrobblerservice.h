@@ -34,6 +34,9 @@
 #include "core/song.h"
 
 #include "scrobblersettings.h"
+#include "scrobblermetrics.h"
+
+class QNetworkReply;
 
 class ScrobblerService : public QObject {
   Q_OBJECT
@@ -56,6 +59,8 @@ class ScrobblerService : public QObject {
   virtual void StartSubmit(const bool initial = false) = 0;
   virtual bool submitted() const { return false; }
 
+  const ScrobblerMetrics &metrics() const { return metrics_; }
+
  protected:
   using Param = QPair<QString, QString>;
   using ParamList = QList<Param>;
@@ -63,6 +68,9 @@ class ScrobblerService : public QObject {
 
   bool ExtractJsonObj(const QByteArray &data, QJsonObject &json_obj, QString &error_description);
 
+  // Adds the latency and result of the reply to the metrics when it's finished, call it before connecting the reply.
+  void AddRequestMetrics(QNetworkReply *reply);
+
   QString StripAlbum(const QString &album) const;
   QString StripTitle(const QString &title) const;
 
@@ -76,6 +84,7 @@ class ScrobblerService : public QObject {
  protected:
   QString name_;
   SharedPtr<ScrobblerSettings> settings_;
+  ScrobblerMetrics metrics_;
 };
 
 using ScrobblerServicePtr = SharedPtr<ScrobblerService>;
@@ -65,6 +65,7 @@ const char *ScrobblingAPI20::kApiKey = "211990b4c96782c05d1536e7219eb56e";
 namespace {
 constexpr char kSecret[] = "80fd738f49596e9709b1bf9319c444a8";
 constexpr int kScrobblesPerRequest = 50;
+constexpr int kMaxConcurrentSubmits = 4;
 }
 
 ScrobblingAPI20::ScrobblingAPI20(const QString &name, const QString &settings_group, const QString &auth_url, const QString &api_url, const bool batch, const QString &cache_file, SharedPtr<ScrobblerSettings> settings, SharedPtr<NetworkAccessManager> network, QObject *parent)
@@ -75,12 +76,14 @@ ScrobblingAPI20::ScrobblingAPI20(const QString &name, const QString &settings_gr
       api_url_(api_url),
       batch_(batch),
       network_(network),
-      cache_(new ScrobblerCache(cache_file, this)),
+      cache_(new ScrobblerCache(cache_file, &metrics_, this)),
       server_(nullptr),
       enabled_(false),
       prefer_albumartist_(false),
       subscriber_(false),
-      submitted_(false),
+      submits_active_(0),
+      backlog_(false),
+      submit_concurrency_(1, kMaxConcurrentSubmits),
       scrobbled_(false),
       timestamp_(0),
       submit_error_(false) {
@@ -380,6 +383,7 @@ QNetworkReply *ScrobblingAPI20::CreateRequest(const ParamList &request_params) {
   QByteArray query = url_query.toString(QUrl::FullyEncoded).toUtf8();
   QNetworkReply *reply = network_->post(req, query);
   replies_ << reply;
+  AddRequestMetrics(reply);
 
   //qLog(Debug) << name_ << "Sending request" << url_query.toString(QUrl::FullyDecoded);
 
@@ -468,7 +472,13 @@ void ScrobblingAPI20::Scrobble(const Song &song) {
 
 void ScrobblingAPI20::StartSubmit(const bool initial) {
 
-  if (!submitted_ && cache_->Count() > 0) {
+  // While draining a backlog the next batches are sent as soon as the replies come in.
+  if (backlog_ && !submit_error_) {
+    Submit();
+    return;
+  }
+
+  if (submits_active_ <= 0 && cache_->Count() > 0) {
     if (initial && (!batch_ || settings_->submit_delay() <= 0) && !submit_error_) {
       if (timer_submit_.isActive()) {
         timer_submit_.stop();
@@ -490,6 +500,15 @@ void ScrobblingAPI20::Submit() {
 
   qLog(Debug) << name_ << "Submitting scrobbles.";
 
+  // A backlog is sent with several batches at the same time, as many as the server handles without slowing down.
+  while (submits_active_ < submit_concurrency_.limit()) {
+    if (!SubmitBatch()) break;
+  }
+
+}
+
+bool ScrobblingAPI20::SubmitBatch() {
+
   ParamList params = ParamList() << Param(QStringLiteral("method"), QStringLiteral("track.scrobble"));
 
   int i = 0;
@@ -520,13 +539,18 @@ void ScrobblingAPI20::Submit() {
     if (cache_items_sent.count() >= kScrobblesPerRequest) break;
   }
 
-  if (!batch_ || cache_items_sent.count() <= 0) return;
+  backlog_ = batch_ && cache_items_sent.count() >= kScrobblesPerRequest;
 
-  submitted_ = true;
+  if (!batch_ || cache_items_sent.count() <= 0) return false;
+
+  ++submits_active_;
 
   QNetworkReply *reply = CreateRequest(params);
+  submit_concurrency_.ReplyStarted(reply);
   QObject::connect(reply, &QNetworkReply::finished, this, [this, reply, cache_items_sent]() { ScrobbleRequestFinished(reply, cache_items_sent); });
 
+  return true;
+
 }
 
 void ScrobblingAPI20::ScrobbleRequestFinished(QNetworkReply *reply, ScrobblerCacheItemPtrList cache_items) {
@@ -536,11 +560,13 @@ void ScrobblingAPI20::ScrobbleRequestFinished(QNetworkReply *reply, ScrobblerCac
   QObject::disconnect(reply, nullptr, this, nullptr);
   reply->deleteLater();
 
-  submitted_ = false;
+  --submits_active_;
+  submit_concurrency_.ReplyFinished(reply);
 
   QJsonObject json_obj;
   QString error_message;
   if (GetJsonObject(reply, json_obj, error_message) != ReplyResult::Success) {
+    // The batch is sent again later, together with the other batches that failed.
     Error(error_message);
     cache_->ClearSent(cache_items);
     submit_error_ = true;
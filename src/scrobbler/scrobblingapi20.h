@@ -32,6 +32,7 @@
 
 #include "core/shared_ptr.h"
 #include "core/song.h"
+#include "internet/internetrequestconcurrency.h"
 #include "scrobblerservice.h"
 #include "scrobblercache.h"
 #include "scrobblercacheitem.h"
@@ -57,7 +58,7 @@ class ScrobblingAPI20 : public ScrobblerService {
   bool enabled() const override { return enabled_; }
   bool authenticated() const override { return !username_.isEmpty() && !session_key_.isEmpty(); }
   bool subscriber() const { return subscriber_; }
-  bool submitted() const override { return submitted_; }
+  bool submitted() const override { return submits_active_ > 0; }
   QString username() const { return username_; }
 
   void Authenticate();
@@ -125,6 +126,7 @@ class ScrobblingAPI20 : public ScrobblerService {
 
   void RequestSession(const QString &token);
   void AuthError(const QString &error);
+  bool SubmitBatch();
   void SendSingleScrobble(ScrobblerCacheItemPtr item);
   void Error(const QString &error, const QVariant &debug = QVariant());
   static QString ErrorString(const ScrobbleErrorCode error);
@@ -149,7 +151,9 @@ class ScrobblingAPI20 : public ScrobblerService {
   QString username_;
   QString session_key_;
 
-  bool submitted_;
+  int submits_active_;
+  bool backlog_;
+  InternetRequestConcurrency submit_concurrency_;
   Song song_playing_;
   bool scrobbled_;
   quint64 timestamp_;
@@ -71,12 +71,32 @@ SubsonicServicePtr SubsonicScrobbler::service() {
 
   if (!service_) {
     service_ = app_->internet_services()->Service<SubsonicService>();
+    if (service_) {
+      QObject::connect(&*service_, &SubsonicService::ScrobbleRequestFinished, this, &SubsonicScrobbler::ScrobbleRequestFinished);
+    }
   }
 
   return service_;
 
 }
 
+void SubsonicScrobbler::ScrobbleRequestFinished(const bool submission, const qint64 wait_secs, const qint64 latency_msec, const bool success) {
+
+  metrics_.AddRequest(latency_msec, success);
+
+  // Subsonic scrobbles aren't cached, so they are counted as queued when they are sent.
+  if (submission) {
+    metrics_.AddScrobbleQueued();
+    if (success) {
+      metrics_.AddScrobbleSubmitted(wait_secs);
+    }
+    else {
+      metrics_.AddScrobblesFailed(1);
+    }
+  }
+
+}
+
 void SubsonicScrobbler::UpdateNowPlaying(const Song &song) {
 
   if (song.source() != Song::Source::Subsonic) return;
@@ -62,6 +62,9 @@ class SubsonicScrobbler : public ScrobblerService {
   void WriteCache() override {}
   void Submit() override;
 
+ private slots:
+  void ScrobbleRequestFinished(const bool submission, const qint64 wait_secs, const qint64 latency_msec, const bool success);
+
  private:
   Application *app_;
   SharedPtr<SubsonicService> service_;
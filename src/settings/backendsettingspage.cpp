@@ -59,6 +59,8 @@ const char *BackendSettingsPage::kSettingsGroup = "Backend";
 const qint64 BackendSettingsPage::kDefaultBufferDuration = 4000;
 const double BackendSettingsPage::kDefaultBufferLowWatermark = 0.33;
 const double BackendSettingsPage::kDefaultBufferHighWatermark = 0.99;
+const int BackendSettingsPage::kDefaultStreamUrlLookahead = 1;
+const int BackendSettingsPage::kDefaultAudioCacheSize = 2048;
 
 namespace {
 constexpr char kOutputAutomaticallySelect[] = "Automatically select";
@@ -98,6 +100,7 @@ BackendSettingsPage::BackendSettingsPage(SettingsDialog *dialog, QWidget *parent
   QObject::connect(ui_->checkbox_fadeout_cross, &QCheckBox::toggled, this, &BackendSettingsPage::FadingOptionsChanged);
   QObject::connect(ui_->checkbox_fadeout_auto, &QCheckBox::toggled, this, &BackendSettingsPage::FadingOptionsChanged);
   QObject::connect(ui_->checkbox_channels, &QCheckBox::toggled, ui_->widget_channels, &QSpinBox::setEnabled);
+  QObject::connect(ui_->checkbox_audio_cache, &QCheckBox::toggled, ui_->spinbox_audio_cache_size, &QSpinBox::setEnabled);
   QObject::connect(ui_->button_buffer_defaults, &QPushButton::clicked, this, &BackendSettingsPage::BufferDefaults);
 
 #ifdef Q_OS_WIN32
@@ -161,6 +164,8 @@ void BackendSettingsPage::Load() {
 
 #ifdef Q_OS_WIN32
   ui_->checkbox_exclusive_mode->setChecked(s.value("exclusive_mode", false).toBool());
+  ui_->checkbox_low_latency->setChecked(s.value("low_latency", false).toBool());
+  ui_->checkbox_bit_perfect->setChecked(s.value("bit_perfect", false).toBool());
 #endif
 
   if (EngineInitialized()) Load_Engine(enginetype);
@@ -175,10 +180,15 @@ void BackendSettingsPage::Load() {
 
   ui_->checkbox_http2->setChecked(s.value("http2", false).toBool());
   ui_->checkbox_strict_ssl->setChecked(s.value("strict_ssl", false).toBool());
+  ui_->checkbox_audio_cache->setChecked(s.value("audio_cache", false).toBool());
+  ui_->spinbox_audio_cache_size->setValue(s.value("audio_cache_size", kDefaultAudioCacheSize).toInt());
+  ui_->spinbox_audio_cache_size->setEnabled(ui_->checkbox_audio_cache->isChecked());
 
   ui_->spinbox_bufferduration->setValue(s.value("bufferduration", kDefaultBufferDuration).toInt());
   ui_->spinbox_low_watermark->setValue(s.value("bufferlowwatermark", kDefaultBufferLowWatermark).toDouble());
   ui_->spinbox_high_watermark->setValue(s.value("bufferhighwatermark", kDefaultBufferHighWatermark).toDouble());
+  ui_->spinbox_stream_url_lookahead->setValue(s.value("stream_url_lookahead", kDefaultStreamUrlLookahead).toInt());
+  ui_->checkbox_adaptive_buffering->setChecked(s.value("adaptive_buffering", false).toBool());
 
   ui_->radiobutton_replaygain->setChecked(s.value("rgenabled", false).toBool());
   ui_->combobox_replaygainmode->setCurrentIndex(s.value("rgmode", 0).toInt());
@@ -501,6 +511,8 @@ void BackendSettingsPage::Save() {
 
 #ifdef Q_OS_WIN32
   s.setValue("exclusive_mode", ui_->checkbox_exclusive_mode->isChecked());
+  s.setValue("low_latency", ui_->checkbox_low_latency->isChecked());
+  s.setValue("bit_perfect", ui_->checkbox_bit_perfect->isChecked());
 #endif
 
   s.setValue("volume_control", ui_->checkbox_volume_control->isChecked());
@@ -512,10 +524,14 @@ void BackendSettingsPage::Save() {
 
   s.setValue("http2", ui_->checkbox_http2->isChecked());
   s.setValue("strict_ssl", ui_->checkbox_strict_ssl->isChecked());
+  s.setValue("audio_cache", ui_->checkbox_audio_cache->isChecked());
+  s.setValue("audio_cache_size", ui_->spinbox_audio_cache_size->value());
 
   s.setValue("bufferduration", ui_->spinbox_bufferduration->value());
   s.setValue("bufferlowwatermark", ui_->spinbox_low_watermark->value());
   s.setValue("bufferhighwatermark", ui_->spinbox_high_watermark->value());
+  s.setValue("stream_url_lookahead", ui_->spinbox_stream_url_lookahead->value());
+  s.setValue("adaptive_buffering", ui_->checkbox_adaptive_buffering->isChecked());
 
   s.setValue("rgenabled", ui_->radiobutton_replaygain->isChecked());
   s.setValue("rgmode", ui_->combobox_replaygainmode->currentIndex());
@@ -874,5 +890,7 @@ void BackendSettingsPage::BufferDefaults() {
   ui_->spinbox_bufferduration->setValue(kDefaultBufferDuration);
   ui_->spinbox_low_watermark->setValue(kDefaultBufferLowWatermark);
   ui_->spinbox_high_watermark->setValue(kDefaultBufferHighWatermark);
+  ui_->spinbox_stream_url_lookahead->setValue(kDefaultStreamUrlLookahead);
+  ui_->checkbox_adaptive_buffering->setChecked(false);
 
 }
@@ -47,6 +47,8 @@ class BackendSettingsPage : public SettingsPage {
   static const qint64 kDefaultBufferDuration;
   static const double kDefaultBufferLowWatermark;
   static const double kDefaultBufferHighWatermark;
+  static const int kDefaultStreamUrlLookahead;
+  static const int kDefaultAudioCacheSize;
 
   void Load() override;
   void Save() override;
@@ -107,6 +107,10 @@ CollectionSettingsPage::CollectionSettingsPage(SettingsDialog *dialog, QWidget *
   ui_->song_ebur128_loudness_analysis->hide();
 #endif
 
+#ifndef USE_INPROCESS_TAGREADER
+  ui_->inprocess_tagreader->hide();
+#endif
+
 }
 
 CollectionSettingsPage::~CollectionSettingsPage() { delete ui_; }
@@ -181,12 +185,16 @@ void CollectionSettingsPage::Load() {
   ui_->pretty_covers->setChecked(s.value("pretty_covers", true).toBool());
   ui_->show_dividers->setChecked(s.value("show_dividers", true).toBool());
   ui_->sort_skips_articles->setChecked(s.value("sort_skips_articles", true).toBool());
+  ui_->filter_index->setChecked(s.value("filter_index", false).toBool());
+  ui_->substring_search->setChecked(s.value("substring_search", false).toBool());
   ui_->startup_scan->setChecked(s.value("startup_scan", true).toBool());
   ui_->monitor->setChecked(s.value("monitor", true).toBool());
   ui_->song_tracking->setChecked(s.value("song_tracking", false).toBool());
   ui_->song_ebur128_loudness_analysis->setChecked(s.value("song_ebur128_loudness_analysis", false).toBool());
   ui_->mark_songs_unavailable->setChecked(ui_->song_tracking->isChecked() ? true : s.value("mark_songs_unavailable", true).toBool());
   ui_->expire_unavailable_songs_days->setValue(s.value("expire_unavailable_songs", 60).toInt());
+  ui_->content_hash_change_detection->setChecked(s.value("content_hash_change_detection", false).toBool());
+  ui_->inprocess_tagreader->setChecked(s.value("inprocess_tagreader", false).toBool());
 
   QStringList filters = s.value("cover_art_patterns", QStringList() << QStringLiteral("front") << QStringLiteral("cover")).toStringList();
   ui_->cover_art_patterns->setText(filters.join(QStringLiteral(",")));
@@ -229,12 +237,16 @@ void CollectionSettingsPage::Save() {
   s.setValue("pretty_covers", ui_->pretty_covers->isChecked());
   s.setValue("show_dividers", ui_->show_dividers->isChecked());
   s.setValue("sort_skips_articles", ui_->sort_skips_articles->isChecked());
+  s.setValue("filter_index", ui_->filter_index->isChecked());
+  s.setValue("substring_search", ui_->substring_search->isChecked());
   s.setValue("startup_scan", ui_->startup_scan->isChecked());
   s.setValue("monitor", ui_->monitor->isChecked());
   s.setValue("song_tracking", ui_->song_tracking->isChecked());
   s.setValue("song_ebur128_loudness_analysis", ui_->song_ebur128_loudness_analysis->isChecked());
   s.setValue("mark_songs_unavailable", ui_->song_tracking->isChecked() ? true : ui_->mark_songs_unavailable->isChecked());
   s.setValue("expire_unavailable_songs", ui_->expire_unavailable_songs_days->value());
+  s.setValue("content_hash_change_detection", ui_->content_hash_change_detection->isChecked());
+  s.setValue("inprocess_tagreader", ui_->inprocess_tagreader->isChecked());
 
   QString filter_text = ui_->cover_art_patterns->text();
 
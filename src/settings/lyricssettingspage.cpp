@@ -30,6 +30,7 @@
 #include <QPalette>
 #include <QSettings>
 #include <QGroupBox>
+#include <QCheckBox>
 #include <QPushButton>
 #include <QListWidget>
 #include <QListWidgetItem>
@@ -89,6 +90,11 @@ void LyricsSettingsPage::Load() {
     item->setForeground(provider->is_enabled() ? palette().color(QPalette::Active, QPalette::Text) : palette().color(QPalette::Disabled, QPalette::Text));
   }
 
+  Settings s;
+  s.beginGroup(kSettingsGroup);
+  ui_->checkbox_first_good_result->setChecked(s.value("first_good_result", true).toBool());
+  s.endGroup();
+
   Init(ui_->layout_lyricssettingspage->parentWidget());
 
   if (!Settings().childGroups().contains(QLatin1String(kSettingsGroup))) set_changed();
@@ -106,6 +112,7 @@ void LyricsSettingsPage::Save() {
   Settings s;
   s.beginGroup(kSettingsGroup);
   s.setValue("providers", providers);
+  s.setValue("first_good_result", ui_->checkbox_first_good_result->isChecked());
   s.endGroup();
 
 }
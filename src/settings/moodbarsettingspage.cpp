@@ -71,6 +71,7 @@ void MoodbarSettingsPage::Load() {
   ui_->moodbar_show->setChecked(s.value("show", false).toBool());
   ui_->moodbar_style->setCurrentIndex(s.value("style", 0).toInt());
   ui_->moodbar_save->setChecked(s.value("save", false).toBool());
+  ui_->moodbar_generate->setChecked(s.value("generate", false).toBool());
   s.endGroup();
 
   InitMoodbarPreviews();
@@ -89,6 +90,7 @@ void MoodbarSettingsPage::Save() {
   s.setValue("show", ui_->moodbar_show->isChecked());
   s.setValue("style", ui_->moodbar_style->currentIndex());
   s.setValue("save", ui_->moodbar_save->isChecked());
+  s.setValue("generate", ui_->moodbar_generate->isChecked());
   s.endGroup();
 }
 
@@ -25,10 +25,13 @@
 #include <QSettings>
 #include <QCheckBox>
 #include <QRadioButton>
+#include <QSpinBox>
 
 #include "core/iconloader.h"
 #include "core/settings.h"
 #include "playlist/playlist.h"
+#include "playlist/playlistmanager.h"
+#include "smartplaylists/playlistgenerator.h"
 #include "settingspage.h"
 #include "playlistsettingspage.h"
 #include "ui_playlistsettingspage.h"
@@ -76,6 +79,8 @@ void PlaylistSettingsPage::Load() {
   ui_->checkbox_show_toolbar->setChecked(s.value("show_toolbar", true).toBool());
   ui_->checkbox_playlist_clear->setChecked(s.value("playlist_clear", true).toBool());
   ui_->checkbox_auto_sort->setChecked(s.value("auto_sort", false).toBool());
+  ui_->spinbox_dynamic_prefetch->setValue(s.value("dynamic_prefetch", PlaylistGenerator::kDefaultDynamicPrefetch).toInt());
+  ui_->spinbox_unload_inactive->setValue(s.value("unload_inactive_minutes", PlaylistManager::kDefaultUnloadInactiveMinutes).toInt());
 
   const PathType path_type = static_cast<PathType>(s.value("path_type", static_cast<int>(PathType::Automatic)).toInt());
   switch (path_type) {
@@ -143,6 +148,8 @@ void PlaylistSettingsPage::Save() {
   s.setValue("write_metadata", ui_->checkbox_writemetadata->isChecked());
   s.setValue("delete_files", ui_->checkbox_delete_files->isChecked());
   s.setValue("auto_sort", ui_->checkbox_auto_sort->isChecked());
+  s.setValue("dynamic_prefetch", ui_->spinbox_dynamic_prefetch->value());
+  s.setValue("unload_inactive_minutes", ui_->spinbox_unload_inactive->value());
   s.endGroup();
 
 }
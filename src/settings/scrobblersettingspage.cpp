@@ -28,6 +28,8 @@
 #include <QLineEdit>
 #include <QPushButton>
 #include <QSpinBox>
+#include <QPlainTextEdit>
+#include <QStringList>
 
 #include "settingsdialog.h"
 #include "settingspage.h"
@@ -38,6 +40,8 @@
 #include "widgets/loginstatewidget.h"
 
 #include "scrobbler/audioscrobbler.h"
+#include "scrobbler/scrobblerservice.h"
+#include "scrobbler/scrobblermetrics.h"
 #include "scrobbler/lastfmscrobbler.h"
 #include "scrobbler/librefmscrobbler.h"
 #include "scrobbler/listenbrainzscrobbler.h"
@@ -123,6 +127,12 @@ void ScrobblerSettingsPage::Load() {
   ui_->lineedit_listenbrainz_user_token->setText(listenbrainzscrobbler_->user_token());
   ListenBrainz_RefreshControls(listenbrainzscrobbler_->authenticated());
 
+  QStringList statistics;
+  for (SharedPtr<ScrobblerService> service : scrobbler_->List()) {
+    statistics << service->name() + QLatin1Char('\n') + service->metrics().ToString();
+  }
+  ui_->plaintextedit_statistics->setPlainText(statistics.join(QLatin1String("\n\n")));
+
   Init(ui_->layout_scrobblersettingspage->parentWidget());
 
   if (!Settings().childGroups().contains(QLatin1String(kSettingsGroup))) set_changed();
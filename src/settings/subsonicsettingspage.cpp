@@ -83,6 +83,7 @@ void SubsonicSettingsPage::Load() {
   ui_->checkbox_http2->setChecked(s.value("http2", false).toBool());
   ui_->checkbox_verify_certificate->setChecked(s.value("verifycertificate", false).toBool());
   ui_->checkbox_download_album_covers->setChecked(s.value("downloadalbumcovers", true).toBool());
+  ui_->checkbox_incremental_sync->setChecked(s.value("incrementalsync", true).toBool());
   ui_->checkbox_server_scrobbling->setChecked(s.value("serversidescrobbling", false).toBool());
 
   const AuthMethod auth_method = static_cast<AuthMethod>(s.value("authmethod", static_cast<int>(AuthMethod::MD5)).toInt());
@@ -114,6 +115,7 @@ void SubsonicSettingsPage::Save() {
   s.setValue("http2", ui_->checkbox_http2->isChecked());
   s.setValue("verifycertificate", ui_->checkbox_verify_certificate->isChecked());
   s.setValue("downloadalbumcovers", ui_->checkbox_download_album_covers->isChecked());
+  s.setValue("incrementalsync", ui_->checkbox_incremental_sync->isChecked());
   s.setValue("serversidescrobbling", ui_->checkbox_server_scrobbling->isChecked());
   if (ui_->auth_method_hex->isChecked()) {
     s.setValue("authmethod", static_cast<int>(AuthMethod::Hex));
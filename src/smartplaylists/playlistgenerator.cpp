@@ -23,23 +23,106 @@
 #include <memory>
 
 #include <QObject>
+#include <QMutex>
 #include <QString>
+#include <QtConcurrentRun>
+#include <QFuture>
+#include <QFutureWatcher>
 
 #include "playlistgenerator.h"
 #include "playlistquerygenerator.h"
+#include "playlistsimilargenerator.h"
 
 using std::make_shared;
 
 const int PlaylistGenerator::kDefaultLimit = 20;
 const int PlaylistGenerator::kDefaultDynamicHistory = 5;
 const int PlaylistGenerator::kDefaultDynamicFuture = 15;
+const int PlaylistGenerator::kDefaultDynamicPrefetch = 15;
 
-PlaylistGenerator::PlaylistGenerator(QObject *parent) : QObject(parent), collection_backend_(nullptr) {}
+PlaylistGenerator::PlaylistGenerator(QObject *parent)
+    : QObject(parent),
+      collection_backend_(nullptr),
+      prefetch_depth_(0),
+      prefetching_(false),
+      prefetch_generation_(0) {}
 
 PlaylistGeneratorPtr PlaylistGenerator::Create(const Type type) {
 
-  Q_UNUSED(type)
+  switch (type) {
+    case Type::Similar:
+      return make_shared<PlaylistSimilarGenerator>();
+    case Type::None:
+    case Type::Query:
+      break;
+  }
 
   return make_shared<PlaylistQueryGenerator>();
 
 }
+
+PlaylistItemPtrList PlaylistGenerator::GenerateItems(const int count) {
+
+  QMutexLocker l(&generate_mutex_);
+
+  if (count > 0) {
+    return GenerateMore(count);
+  }
+  else {
+    return Generate();
+  }
+
+}
+
+void PlaylistGenerator::Prefetch() {
+
+  if (prefetching_ || !is_dynamic() || prefetched_.count() >= prefetch_depth_) return;
+
+  prefetching_ = true;
+
+  const int count = prefetch_depth_ - static_cast<int>(prefetched_.count());
+  PlaylistGeneratorPtr generator = shared_from_this();
+  QFuture<PlaylistItemPtrList> future = QtConcurrent::run([generator, count]() { return generator->GenerateItems(count); });
+  QFutureWatcher<PlaylistItemPtrList> *watcher = new QFutureWatcher<PlaylistItemPtrList>(this);
+  const int generation = prefetch_generation_;
+  QObject::connect(watcher, &QFutureWatcher<PlaylistItemPtrList>::finished, this, [this, watcher, generation]() { PrefetchFinished(watcher, generation); });
+  watcher->setFuture(future);
+
+}
+
+void PlaylistGenerator::PrefetchFinished(QFutureWatcher<PlaylistItemPtrList> *watcher, const int generation) {
+
+  const PlaylistItemPtrList items = watcher->result();
+  watcher->deleteLater();
+
+  prefetching_ = false;
+
+  // The generator started over while these were generated.
+  if (generation != prefetch_generation_) {
+    Prefetch();
+    return;
+  }
+
+  // Nothing more matches the search, so don't keep asking.
+  if (items.isEmpty()) return;
+
+  prefetched_ << items;
+  Prefetch();
+
+}
+
+PlaylistItemPtrList PlaylistGenerator::TakePrefetched(const int count) {
+
+  const PlaylistItemPtrList items = prefetched_.mid(0, count);
+  prefetched_.erase(prefetched_.begin(), prefetched_.begin() + items.count());
+
+  return items;
+
+}
+
+void PlaylistGenerator::ClearPrefetched() {
+
+  prefetched_.clear();
+  ++prefetch_generation_;
+
+}
@@ -24,8 +24,11 @@
 #include "config.h"
 
 #include <memory>
+#include <atomic>
 
 #include <QObject>
+#include <QMutex>
+#include <QFutureWatcher>
 #include <QByteArray>
 #include <QString>
 
@@ -45,10 +48,12 @@ class PlaylistGenerator : public QObject, public enable_shared_from_this<Playlis
   static const int kDefaultLimit;
   static const int kDefaultDynamicHistory;
   static const int kDefaultDynamicFuture;
+  static const int kDefaultDynamicPrefetch;
 
   enum class Type {
     None = 0,
-    Query = 1
+    Query = 1,
+    Similar = 2
   };
 
   // Creates a new PlaylistGenerator of the given type
@@ -84,17 +89,57 @@ class PlaylistGenerator : public QObject, public enable_shared_from_this<Playlis
     return PlaylistItemPtrList();
   }
 
+  // A live playlist is kept up to date with the collection: matching songs that are added or changed are appended, and songs that stop matching are removed.
+  // Called on UI-thread.
+  virtual bool is_live() const { return false; }
+  virtual void set_live(const bool live) { Q_UNUSED(live); }
+  virtual bool Matches(const Song &song) const {
+    Q_UNUSED(song);
+    return false;
+  }
+  // The most songs a live playlist has, or -1.
+  virtual int live_limit() const { return -1; }
+
   virtual int GetDynamicHistory() { return kDefaultDynamicHistory; }
   virtual int GetDynamicFuture() { return kDefaultDynamicFuture; }
 
+  // Calls Generate, or GenerateMore if count is more than 0.
+  // Calls from different threads are serialized, so prefetching and inserting never run the subclass at the same time.
+  // Called from non-UI thread.
+  PlaylistItemPtrList GenerateItems(const int count);
+
+  // Dynamic playlists keep this many items generated ahead in the background, so they don't wait for the collection at track changes.
+  // Called on UI-thread.
+  int prefetch_depth() const { return prefetch_depth_; }
+  void set_prefetch_depth(const int depth) { prefetch_depth_ = depth; }
+
+  // Starts generating items in the background until prefetch_depth() items are waiting.
+  // Called on UI-thread.
+  void Prefetch();
+  // Returns up to count items that were generated ahead, and removes them.
+  // Called on UI-thread.
+  PlaylistItemPtrList TakePrefetched(const int count);
+  // Drops the items that were generated ahead, and the ones that are generated now.
+  // Should be called when the generator starts over.  Called on UI-thread.
+  void ClearPrefetched();
+
  signals:
   void Error(const QString &message);
 
  protected:
   SharedPtr<CollectionBackend> collection_backend_;
 
+ private:
+  void PrefetchFinished(QFutureWatcher<PlaylistItemPtrList> *watcher, const int generation);
+
  private:
   QString name_;
+
+  QMutex generate_mutex_;
+  std::atomic_int prefetch_depth_;
+  bool prefetching_;
+  int prefetch_generation_;
+  PlaylistItemPtrList prefetched_;
 };
 
 #include "playlistgenerator_fwd.h"
@@ -47,17 +47,6 @@ PlaylistGeneratorInserter::PlaylistGeneratorInserter(SharedPtr<TaskManager> task
       enqueue_next_(false),
       is_dynamic_(false) {}
 
-PlaylistItemPtrList PlaylistGeneratorInserter::Generate(PlaylistGeneratorPtr generator, int dynamic_count) {
-
-  if (dynamic_count > 0) {
-    return generator->GenerateMore(dynamic_count);
-  }
-  else {
-    return generator->Generate();
-  }
-
-}
-
 void PlaylistGeneratorInserter::Load(Playlist *destination, const int row, const bool play_now, const bool enqueue, const bool enqueue_next, PlaylistGeneratorPtr generator, const int dynamic_count) {
 
   task_id_ = task_manager_->StartTask(tr("Loading smart playlist"));
@@ -68,10 +57,16 @@ void PlaylistGeneratorInserter::Load(Playlist *destination, const int row, const
   enqueue_ = enqueue;
   enqueue_next_ = enqueue_next;
   is_dynamic_ = generator->is_dynamic();
+  generator_ = generator;
+
+  // Items generated ahead would repeat the ones the generator returns when it starts over.
+  if (dynamic_count == 0) {
+    generator->ClearPrefetched();
+  }
 
   QObject::connect(&*generator, &PlaylistGenerator::Error, this, &PlaylistGeneratorInserter::Error);
 
-  QFuture<PlaylistItemPtrList> future = QtConcurrent::run(PlaylistGeneratorInserter::Generate, generator, dynamic_count);
+  QFuture<PlaylistItemPtrList> future = QtConcurrent::run([generator, dynamic_count]() { return generator->GenerateItems(dynamic_count); });
   QFutureWatcher<PlaylistItemPtrList> *watcher = new QFutureWatcher<PlaylistItemPtrList>();
   QObject::connect(watcher, &QFutureWatcher<PlaylistItemPtrList>::finished, this, &PlaylistGeneratorInserter::Finished);
   watcher->setFuture(future);
@@ -91,6 +86,10 @@ void PlaylistGeneratorInserter::Finished() {
   }
   else {
     destination_->InsertItems(items, row_, play_now_, enqueue_);
+    // Generating ahead is started after the items were generated, so it continues where they ended.
+    if (is_dynamic_) {
+      generator_->Prefetch();
+    }
   }
 
   task_manager_->SetTaskFinished(task_id_);
@@ -45,9 +45,6 @@ class PlaylistGeneratorInserter : public QObject {
 
   void Load(Playlist *destination, const int row, const bool play_now, const bool enqueue, const bool enqueue_next, PlaylistGeneratorPtr generator, const int dynamic_count = 0);
 
- private:
-  static PlaylistItemPtrList Generate(PlaylistGeneratorPtr generator, const int dynamic_count);
-
  signals:
   void Error(const QString &message);
   void PlayRequested(const QModelIndex idx, const Playlist::AutoScroll autoscroll);
@@ -66,6 +63,7 @@ class PlaylistGeneratorInserter : public QObject {
   bool enqueue_;
   bool enqueue_next_;
   bool is_dynamic_;
+  PlaylistGeneratorPtr generator_;
 
 };
 
@@ -20,21 +20,40 @@
 
 #include "config.h"
 
+#include <utility>
+
 #include <QIODevice>
 #include <QDataStream>
 #include <QByteArray>
 #include <QString>
+#include <QList>
+#include <QSet>
+#include <QHash>
+#include <QRandomGenerator>
 
+#include "core/song.h"
 #include "playlistquerygenerator.h"
 #include "collection/collectionbackend.h"
 
-PlaylistQueryGenerator::PlaylistQueryGenerator(QObject *parent) : PlaylistGenerator(parent), dynamic_(false), current_pos_(0) {}
+// Some terms depend on the time, like songs played in the last days, so the IDs are also read again after a while.
+const int PlaylistQueryGenerator::kIdsMaxAgeMsec = 600000;
+
+PlaylistQueryGenerator::PlaylistQueryGenerator(QObject *parent)
+    : PlaylistGenerator(parent),
+      dynamic_(false),
+      live_(false),
+      current_pos_(0),
+      ids_backend_(nullptr),
+      ids_dirty_(true) {}
 
 PlaylistQueryGenerator::PlaylistQueryGenerator(const QString &name, const SmartPlaylistSearch &search, const bool dynamic, QObject *parent)
     : PlaylistGenerator(parent),
       search_(search),
       dynamic_(dynamic),
-      current_pos_(0) {
+      live_(false),
+      current_pos_(0),
+      ids_backend_(nullptr),
+      ids_dirty_(true) {
 
   set_name(name);
 
@@ -44,7 +63,9 @@ void PlaylistQueryGenerator::Load(const SmartPlaylistSearch &search) {
 
   search_ = search;
   dynamic_ = false;
+  live_ = false;
   current_pos_ = 0;
+  ids_dirty_ = true;
 
 }
 
@@ -53,6 +74,10 @@ void PlaylistQueryGenerator::Load(const QByteArray &data) {
   QDataStream s(data);
   s >> search_;
   s >> dynamic_;
+  // Live mode was added later, older smart playlists don't have it.
+  live_ = false;
+  if (!s.atEnd()) s >> live_;
+  ids_dirty_ = true;
 
 }
 
@@ -62,6 +87,7 @@ QByteArray PlaylistQueryGenerator::Save() const {
   QDataStream s(&ret, QIODevice::WriteOnly);
   s << search_;
   s << dynamic_;
+  s << live_;
 
   return ret;
 
@@ -88,14 +114,15 @@ PlaylistItemPtrList PlaylistQueryGenerator::GenerateMore(const int count) {
     current_pos_ += search_copy.limit_;
   }
 
-  const SongList songs = collection_backend_->SmartPlaylistsFindSongs(search_copy);
+  const SongList songs = search_copy.sort_type_ == SmartPlaylistSearch::SortType::Random ? RandomSongs(search_copy.limit_) : collection_backend_->SmartPlaylistsFindSongs(search_copy);
   PlaylistItemPtrList items;
   items.reserve(songs.count());
   for (const Song &song : songs) {
     items << PlaylistItem::NewFromSong(song);
     previous_ids_ << song.id();
 
-    if (previous_ids_.count() > GetDynamicFuture() + GetDynamicHistory()) {
+    // Items that were generated ahead aren't in the playlist yet, so they are remembered too.
+    if (previous_ids_.count() > GetDynamicFuture() + GetDynamicHistory() + prefetch_depth()) {
       previous_ids_.removeFirst();
     }
   }
@@ -103,3 +130,78 @@ PlaylistItemPtrList PlaylistQueryGenerator::GenerateMore(const int count) {
   return items;
 
 }
+
+SongList PlaylistQueryGenerator::RandomSongs(const int limit) {
+
+  UpdateIds();
+
+  QSet<int> previous_ids;
+  for (const int id : std::as_const(previous_ids_)) {
+    previous_ids.insert(id);
+  }
+
+  // A partial shuffle of the cached IDs, only the songs that are picked are moved.
+  const int wanted = limit < 0 ? static_cast<int>(ids_.count()) : limit;
+  QList<int> ids;
+  for (int i = 0; i < ids_.count() && ids.count() < wanted; ++i) {
+    const int j = i + QRandomGenerator::global()->bounded(static_cast<int>(ids_.count()) - i);
+    std::swap(ids_[i], ids_[j]);
+    if (!previous_ids.contains(ids_[i])) ids << ids_[i];
+  }
+
+  if (ids.isEmpty()) return SongList();
+
+  // Keep the random order, the songs are read in the order of the database.
+  QHash<int, Song> songs_by_id;
+  const SongList songs = collection_backend_->GetSongsById(ids);
+  for (const Song &song : songs) {
+    songs_by_id.insert(song.id(), song);
+  }
+
+  SongList ret;
+  ret.reserve(ids.count());
+  for (const int id : std::as_const(ids)) {
+    if (songs_by_id.contains(id)) ret << songs_by_id.value(id);
+  }
+
+  return ret;
+
+}
+
+void PlaylistQueryGenerator::UpdateIds() {
+
+  if (ids_backend_ != &*collection_backend_) {
+    ids_backend_ = &*collection_backend_;
+    ids_dirty_ = true;
+    QObject::connect(ids_backend_, &CollectionBackend::SongsDiscovered, this, [this]() { ids_dirty_ = true; });
+    QObject::connect(ids_backend_, &CollectionBackend::SongsDeleted, this, [this]() { ids_dirty_ = true; });
+    QObject::connect(ids_backend_, &CollectionBackend::DatabaseReset, this, [this]() { ids_dirty_ = true; });
+    QObject::connect(ids_backend_, &CollectionBackend::SongsStatisticsChanged, this, [this]() { if (UsesStatistics()) ids_dirty_ = true; });
+    QObject::connect(ids_backend_, &CollectionBackend::SongsRatingChanged, this, [this]() { if (UsesStatistics()) ids_dirty_ = true; });
+  }
+
+  if (!ids_dirty_ && ids_timer_.isValid() && ids_timer_.elapsed() < kIdsMaxAgeMsec) return;
+
+  ids_dirty_ = false;
+  ids_ = collection_backend_->SmartPlaylistsFindSongIds(search_);
+  ids_timer_.start();
+
+}
+
+bool PlaylistQueryGenerator::UsesStatistics() const {
+
+  for (const SmartPlaylistSearchTerm &term : search_.terms_) {
+    switch (term.field_) {
+      case SmartPlaylistSearchTerm::Field::PlayCount:
+      case SmartPlaylistSearchTerm::Field::SkipCount:
+      case SmartPlaylistSearchTerm::Field::LastPlayed:
+      case SmartPlaylistSearchTerm::Field::Rating:
+        return true;
+      default:
+        break;
+    }
+  }
+
+  return false;
+
+}
@@ -23,9 +23,12 @@
 
 #include "config.h"
 
+#include <atomic>
+
 #include <QList>
 #include <QByteArray>
 #include <QString>
+#include <QElapsedTimer>
 
 #include "playlistgenerator.h"
 #include "smartplaylistsearch.h"
@@ -47,16 +50,35 @@ class PlaylistQueryGenerator : public PlaylistGenerator {
   PlaylistItemPtrList GenerateMore(const int count) override;
   bool is_dynamic() const override { return dynamic_; }
   void set_dynamic(bool dynamic) override { dynamic_ = dynamic; }
+  bool is_live() const override { return live_; }
+  void set_live(const bool live) override { live_ = live; }
+  bool Matches(const Song &song) const override { return search_.Matches(song); }
+  int live_limit() const override { return search_.limit_; }
 
   SmartPlaylistSearch search() const { return search_; }
   int GetDynamicFuture() override { return search_.limit_; }
 
+ private:
+  static const int kIdsMaxAgeMsec;
+
+  // Random playlists pick their songs from the cached IDs of all the matching songs, instead of sorting them all with ORDER BY random() each time.
+  SongList RandomSongs(const int limit);
+  void UpdateIds();
+  bool UsesStatistics() const;
+
  private:
   SmartPlaylistSearch search_;
   bool dynamic_;
+  bool live_;
 
   QList<int> previous_ids_;
   int current_pos_;
+
+  CollectionBackend *ids_backend_;
+  QList<int> ids_;
+  QElapsedTimer ids_timer_;
+  // Set from the UI thread when the collection changes.
+  std::atomic_bool ids_dirty_;
 };
 
 #endif  // PLAYLISTQUERYGENERATOR_H
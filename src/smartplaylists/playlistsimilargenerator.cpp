@@ -0,0 +1,126 @@
+/*
+ * Strawberry Music Player
+ *
+ * Strawberry is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Strawberry is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Strawberry.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#include "config.h"
+
+#include <utility>
+
+#include <QIODevice>
+#include <QDataStream>
+#include <QByteArray>
+#include <QString>
+#include <QList>
+#include <QSet>
+#include <QHash>
+
+#include "core/song.h"
+#include "collection/collectionbackend.h"
+#include "collection/collectionsimilarityindex.h"
+#include "playlistsimilargenerator.h"
+
+const int PlaylistSimilarGenerator::kRecentSeeds = 3;
+
+PlaylistSimilarGenerator::PlaylistSimilarGenerator(QObject *parent) : PlaylistGenerator(parent) {}
+
+PlaylistSimilarGenerator::PlaylistSimilarGenerator(const QString &name, const QList<int> &seed_ids, QObject *parent)
+    : PlaylistGenerator(parent),
+      seed_ids_(seed_ids) {
+
+  set_name(name);
+
+}
+
+void PlaylistSimilarGenerator::Load(const QByteArray &data) {
+
+  QDataStream s(data);
+  s >> seed_ids_;
+
+}
+
+QByteArray PlaylistSimilarGenerator::Save() const {
+
+  QByteArray ret;
+  QDataStream s(&ret, QIODevice::WriteOnly);
+  s << seed_ids_;
+
+  return ret;
+
+}
+
+PlaylistItemPtrList PlaylistSimilarGenerator::Generate() {
+
+  previous_ids_.clear();
+
+  // The mix starts with the seed songs.
+  PlaylistItemPtrList items = ItemsForIds(seed_ids_);
+  items << GenerateMore(GetDynamicFuture());
+  return items;
+
+}
+
+PlaylistItemPtrList PlaylistSimilarGenerator::GenerateMore(const int count) {
+
+  SharedPtr<CollectionSimilarityIndex> index = collection_backend_->similarity_index();
+  if (index->is_dirty()) {
+    index->SetSongs(collection_backend_->GetAllSongs());
+  }
+
+  QList<int> seed_ids = seed_ids_;
+  seed_ids << previous_ids_.mid(qMax(0, static_cast<int>(previous_ids_.count()) - kRecentSeeds));
+
+  QSet<int> exclude;
+  for (const int id : std::as_const(seed_ids_)) exclude.insert(id);
+  for (const int id : std::as_const(previous_ids_)) exclude.insert(id);
+
+  const QList<int> ids = index->Nearest(seed_ids, count > 0 ? count : GetDynamicFuture(), exclude);
+  const PlaylistItemPtrList items = ItemsForIds(ids);
+  for (const PlaylistItemPtr &item : items) {
+    previous_ids_ << item->Metadata().id();
+
+    // Items that were generated ahead aren't in the playlist yet, so they are remembered too.
+    if (previous_ids_.count() > GetDynamicFuture() + GetDynamicHistory() + prefetch_depth()) {
+      previous_ids_.removeFirst();
+    }
+  }
+
+  return items;
+
+}
+
+PlaylistItemPtrList PlaylistSimilarGenerator::ItemsForIds(const QList<int> &ids) {
+
+  if (ids.isEmpty()) return PlaylistItemPtrList();
+
+  // Keep the order of the IDs, the songs are read in the order of the database.
+  QHash<int, Song> songs_by_id;
+  const SongList songs = collection_backend_->GetSongsById(ids);
+  for (const Song &song : songs) {
+    songs_by_id.insert(song.id(), song);
+  }
+
+  PlaylistItemPtrList items;
+  items.reserve(ids.count());
+  for (const int id : ids) {
+    if (songs_by_id.contains(id)) {
+      items << PlaylistItem::NewFromSong(songs_by_id[id]);
+    }
+  }
+
+  return items;
+
+}
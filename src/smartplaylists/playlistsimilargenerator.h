@@ -0,0 +1,58 @@
+/*
+ * Strawberry Music Player
+ *
+ * Strawberry is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Strawberry is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Strawberry.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#ifndef PLAYLISTSIMILARGENERATOR_H
+#define PLAYLISTSIMILARGENERATOR_H
+
+#include "config.h"
+
+#include <QList>
+#include <QByteArray>
+#include <QString>
+
+#include "playlistgenerator.h"
+
+// A dynamic mix of songs like the songs it was started from, picked with the similarity index of the collection.
+// The last songs that were added are used as seeds too, so the mix slowly moves away from where it started.
+class PlaylistSimilarGenerator : public PlaylistGenerator {
+  Q_OBJECT
+
+ public:
+  explicit PlaylistSimilarGenerator(QObject *parent = nullptr);
+  explicit PlaylistSimilarGenerator(const QString &name, const QList<int> &seed_ids, QObject *parent = nullptr);
+
+  Type type() const override { return Type::Similar; }
+
+  void Load(const QByteArray &data) override;
+  QByteArray Save() const override;
+
+  PlaylistItemPtrList Generate() override;
+  PlaylistItemPtrList GenerateMore(const int count) override;
+  bool is_dynamic() const override { return true; }
+
+ private:
+  static const int kRecentSeeds;
+
+  PlaylistItemPtrList ItemsForIds(const QList<int> &ids);
+
+ private:
+  QList<int> seed_ids_;
+  QList<int> previous_ids_;
+};
+
+#endif  // PLAYLISTSIMILARGENERATOR_H
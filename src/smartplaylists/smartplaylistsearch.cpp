@@ -49,9 +49,7 @@ void SmartPlaylistSearch::Reset() {
 
 }
 
-QString SmartPlaylistSearch::ToSql(const QString &songs_table) const {
-
-  QString sql = QStringLiteral("SELECT %1 FROM %2").arg(Song::kRowIdColumnSpec, songs_table);
+QString SmartPlaylistSearch::WhereSql() const {
 
   // Add search terms
   QStringList where_clauses;
@@ -79,9 +77,13 @@ QString SmartPlaylistSearch::ToSql(const QString &songs_table) const {
   // but are still kept in the database in case the directory containing them has just been unmounted.
   where_clauses << QStringLiteral("unavailable = 0");
 
-  if (!where_clauses.isEmpty()) {
-    sql += QStringLiteral(" WHERE ") + where_clauses.join(QStringLiteral(" AND "));
-  }
+  return QStringLiteral(" WHERE ") + where_clauses.join(QStringLiteral(" AND "));
+
+}
+
+QString SmartPlaylistSearch::ToSql(const QString &songs_table) const {
+
+  QString sql = QStringLiteral("SELECT %1 FROM %2").arg(Song::kRowIdColumnSpec, songs_table) + WhereSql();
 
   // Add sort by
   if (sort_type_ == SortType::Random) {
@@ -104,6 +106,28 @@ QString SmartPlaylistSearch::ToSql(const QString &songs_table) const {
 
 }
 
+QString SmartPlaylistSearch::ToIdsSql(const QString &songs_table) const {
+
+  return QStringLiteral("SELECT ROWID FROM %1").arg(songs_table) + WhereSql();
+
+}
+
+bool SmartPlaylistSearch::Matches(const Song &song) const {
+
+  if (song.unavailable()) return false;
+
+  if (terms_.isEmpty() || search_type_ == SearchType::All) return true;
+
+  for (const SmartPlaylistSearchTerm &term : terms_) {
+    const bool matches = term.Matches(song);
+    if (search_type_ == SearchType::And && !matches) return false;
+    if (search_type_ == SearchType::Or && matches) return true;
+  }
+
+  return search_type_ == SearchType::And;
+
+}
+
 bool SmartPlaylistSearch::is_valid() const {
 
   if (search_type_ == SearchType::All) return true;
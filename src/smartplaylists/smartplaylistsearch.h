@@ -30,6 +30,8 @@
 #include "playlistgenerator.h"
 #include "smartplaylistsearchterm.h"
 
+class Song;
+
 class SmartPlaylistSearch {
 
  public:
@@ -68,6 +70,13 @@ class SmartPlaylistSearch {
 
   void Reset();
   QString ToSql(const QString &songs_table) const;
+  // Checks a song in memory against the search terms, the sort and limit aren't applied.
+  bool Matches(const Song &song) const;
+  // Only selects the ROWIDs of all the matching songs, without sorting or limit.
+  QString ToIdsSql(const QString &songs_table) const;
+
+ private:
+  QString WhereSql() const;
 };
 
 QDataStream &operator<<(QDataStream &s, const SmartPlaylistSearch &search);
@@ -20,9 +20,11 @@
 
 #include "config.h"
 
-#include <memory>
+#include <algorithm>
 
 #include <QWidget>
+#include <QThread>
+#include <QTimer>
 #include <QAbstractItemView>
 #include <QString>
 #include <QtConcurrentRun>
@@ -30,20 +32,39 @@
 #include <QFutureWatcher>
 
 #include "core/shared_ptr.h"
+#include "core/database.h"
+#include "core/song.h"
 
 #include "smartplaylistsearchpreview.h"
 #include "ui_smartplaylistsearchpreview.h"
 
+#include "collection/collectionbackend.h"
 #include "playlist/playlist.h"
-#include "playlistquerygenerator.h"
+#include "playlist/playlistitem.h"
+#include "playlistgenerator.h"
 
-using std::make_shared;
+namespace {
+
+struct SearchPreviewResult {
+  SearchPreviewResult() : search_id(-1), total(0) {}
+  int search_id;
+  SongList songs;
+  int total;
+};
+
+}  // namespace
+
+const int SmartPlaylistSearchPreview::kSearchDelayMsec = 300;
 
 SmartPlaylistSearchPreview::SmartPlaylistSearchPreview(QWidget *parent)
     : QWidget(parent),
       ui_(new Ui_SmartPlaylistSearchPreview),
       collection_backend_(nullptr),
-      model_(nullptr) {
+      model_(nullptr),
+      timer_search_(new QTimer(this)),
+      search_thread_(nullptr),
+      search_id_(0),
+      running_searches_(0) {
 
   ui_->setupUi(this);
 
@@ -56,10 +77,26 @@ SmartPlaylistSearchPreview::SmartPlaylistSearchPreview(QWidget *parent)
   ui_->preview_label->setFont(bold_font);
   ui_->busy_container->hide();
 
+  timer_search_->setSingleShot(true);
+  timer_search_->setInterval(kSearchDelayMsec);
+  QObject::connect(timer_search_, &QTimer::timeout, this, &SmartPlaylistSearchPreview::StartSearch);
+
+  // The thread is kept, so the query running in it can be interrupted on its reader connection.
+  thread_pool_.setMaxThreadCount(1);
+  thread_pool_.setExpiryTimeout(-1);
+
 }
 
 SmartPlaylistSearchPreview::~SmartPlaylistSearchPreview() {
+
+  ++search_id_;
+  if (running_searches_ > 0 && collection_backend_) {
+    collection_backend_->db()->InterruptReadConnection(search_thread_);
+  }
+  thread_pool_.waitForDone();
+
   delete ui_;
+
 }
 
 void SmartPlaylistSearchPreview::set_application(Application *app) {
@@ -81,79 +118,118 @@ void SmartPlaylistSearchPreview::set_collection(SharedPtr<CollectionBackend> col
 
 void SmartPlaylistSearchPreview::Update(const SmartPlaylistSearch &search) {
 
-  if (search == last_search_) {
-    // This search was the same as the last one we did
+  if (search == current_search_ && !pending_search_.is_valid()) {
+    // This search is running or was the last one we did
     return;
   }
 
-  if (generator_ || isHidden()) {
-    // It's busy generating something already, or the widget isn't visible
-    pending_search_ = search;
+  pending_search_ = search;
+
+  if (isHidden()) {
+    // The search is started when the widget is shown
     return;
   }
 
-  RunSearch(search);
+  timer_search_->start();
 
 }
 
 void SmartPlaylistSearchPreview::showEvent(QShowEvent *e) {
 
-  if (pending_search_.is_valid() && !generator_) {
+  if (pending_search_.is_valid()) {
     // There was a search waiting while we were hidden, so run it now
-    RunSearch(pending_search_);
-    pending_search_ = SmartPlaylistSearch();
+    timer_search_->stop();
+    StartSearch();
   }
 
   QWidget::showEvent(e);
 
 }
 
-namespace {
-PlaylistItemPtrList DoRunSearch(PlaylistGeneratorPtr gen) { return gen->Generate(); }
-}  // namespace
+void SmartPlaylistSearchPreview::StartSearch() {
+
+  if (!pending_search_.is_valid()) return;
+
+  const SmartPlaylistSearch search = pending_search_;
+  pending_search_ = SmartPlaylistSearch();
+
+  if (search == current_search_) {
+    // The terms were changed back before the delay ran out
+    return;
+  }
+
+  RunSearch(search);
+
+}
 
 void SmartPlaylistSearchPreview::RunSearch(const SmartPlaylistSearch &search) {
 
-  generator_ = make_shared<PlaylistQueryGenerator>();
-  generator_->set_collection_backend(collection_backend_);
-  std::dynamic_pointer_cast<PlaylistQueryGenerator>(generator_)->Load(search);
+  current_search_ = search;
+  const int search_id = ++search_id_;
+
+  if (running_searches_ > 0) {
+    collection_backend_->db()->InterruptReadConnection(search_thread_);
+  }
+  ++running_searches_;
 
   ui_->busy_container->show();
   ui_->count_label->hide();
-  QFuture<PlaylistItemPtrList> future = QtConcurrent::run(DoRunSearch, generator_);
-  QFutureWatcher<PlaylistItemPtrList> *watcher = new QFutureWatcher<PlaylistItemPtrList>();
-  QObject::connect(watcher, &QFutureWatcher<PlaylistItemPtrList>::finished, this, &SmartPlaylistSearchPreview::SearchFinished);
+
+  // Only the songs that are displayed are read, the rest are just counted.
+  SmartPlaylistSearch displayed_search = search;
+  displayed_search.limit_ = search.limit_ == -1 ? PlaylistGenerator::kDefaultLimit : std::min(search.limit_, PlaylistGenerator::kDefaultLimit);
+
+  SharedPtr<CollectionBackend> collection_backend = collection_backend_;
+  QFuture<SearchPreviewResult> future = QtConcurrent::run(&thread_pool_, [this, collection_backend, search, displayed_search, search_id]() {
+    search_thread_ = QThread::currentThread();
+    SearchPreviewResult result;
+    result.search_id = search_id;
+    // A newer search was started while this one was waiting
+    if (search_id != search_id_) return result;
+    result.songs = collection_backend->SmartPlaylistsFindSongs(displayed_search);
+    if (search_id != search_id_) return result;
+    if (result.songs.count() < displayed_search.limit_) {
+      result.total = result.songs.count();
+    }
+    else {
+      result.total = collection_backend->SmartPlaylistsCountSongs(search);
+      if (search.limit_ != -1) result.total = std::min(result.total, search.limit_);
+    }
+    return result;
+  });
+  QFutureWatcher<SearchPreviewResult> *watcher = new QFutureWatcher<SearchPreviewResult>();
+  QObject::connect(watcher, &QFutureWatcher<SearchPreviewResult>::finished, this, &SmartPlaylistSearchPreview::SearchFinished);
   watcher->setFuture(future);
 
 }
 
 void SmartPlaylistSearchPreview::SearchFinished() {
 
-  QFutureWatcher<PlaylistItemPtrList> *watcher = static_cast<QFutureWatcher<PlaylistItemPtrList>*>(sender());
-  PlaylistItemPtrList all_items = watcher->result();
+  QFutureWatcher<SearchPreviewResult> *watcher = static_cast<QFutureWatcher<SearchPreviewResult>*>(sender());
+  const SearchPreviewResult result = watcher->result();
   watcher->deleteLater();
 
-  last_search_ = std::dynamic_pointer_cast<PlaylistQueryGenerator>(generator_)->search();
-  generator_.reset();
+  --running_searches_;
 
-  if (pending_search_.is_valid() && pending_search_ != last_search_) {
-    // There was another search done while we were running
-    // throw away these results and do that one now instead
-    RunSearch(pending_search_);
-    pending_search_ = SmartPlaylistSearch();
+  if (result.search_id != search_id_) {
+    // There was another search started while we were running, throw away these results
     return;
   }
 
-  PlaylistItemPtrList displayed_items = all_items.mid(0, PlaylistGenerator::kDefaultLimit);
+  PlaylistItemPtrList items;
+  items.reserve(result.songs.count());
+  for (const Song &song : result.songs) {
+    items << PlaylistItem::NewFromSong(song);
+  }
 
   model_->Clear();
-  model_->InsertItems(displayed_items);
+  model_->InsertItems(items);
 
-  if (displayed_items.count() < all_items.count()) {
-    ui_->count_label->setText(tr("%1 songs found (showing %2)").arg(all_items.count()).arg(displayed_items.count()));
+  if (items.count() < result.total) {
+    ui_->count_label->setText(tr("%1 songs found (showing %2)").arg(result.total).arg(items.count()));
   }
   else {
-    ui_->count_label->setText(tr("%1 songs found").arg(all_items.count()));
+    ui_->count_label->setText(tr("%1 songs found").arg(result.total));
   }
 
   ui_->busy_container->hide();
@@ -23,15 +23,19 @@
 
 #include "config.h"
 
+#include <atomic>
+
 #include <QWidget>
 #include <QList>
+#include <QThreadPool>
 
 #include "core/shared_ptr.h"
 
 #include "smartplaylistsearch.h"
-#include "playlistgenerator_fwd.h"
 
 class QShowEvent;
+class QThread;
+class QTimer;
 
 class Application;
 class CollectionBackend;
@@ -48,6 +52,7 @@ class SmartPlaylistSearchPreview : public QWidget {
   void set_application(Application *app);
   void set_collection(SharedPtr<CollectionBackend> backend);
 
+  // Searches are started after a short delay, so editing terms doesn't run a query for every key press.
   void Update(const SmartPlaylistSearch &search);
 
  protected:
@@ -57,18 +62,28 @@ class SmartPlaylistSearchPreview : public QWidget {
   void RunSearch(const SmartPlaylistSearch &search);
 
  private slots:
+  void StartSearch();
   void SearchFinished();
 
  private:
+  static const int kSearchDelayMsec;
+
   Ui_SmartPlaylistSearchPreview *ui_;
   QList<SmartPlaylistSearchTerm::Field> fields_;
 
   SharedPtr<CollectionBackend> collection_backend_;
   Playlist *model_;
 
+  QTimer *timer_search_;
+
+  // Searches run one at a time, a new search interrupts the query of the running one and its results are thrown away.
+  QThreadPool thread_pool_;
+  std::atomic<QThread*> search_thread_;
+  std::atomic<int> search_id_;
+  int running_searches_;
+
   SmartPlaylistSearch pending_search_;
-  SmartPlaylistSearch last_search_;
-  PlaylistGeneratorPtr generator_;
+  SmartPlaylistSearch current_search_;
 };
 
 #endif  // SMARTPLAYLISTSEARCHPREVIEW_H
@@ -25,7 +25,11 @@
 #include <QVariant>
 #include <QString>
 #include <QUrl>
+#include <QDate>
+#include <QDateTime>
 
+#include "core/song.h"
+#include "utilities/timeconstants.h"
 #include "smartplaylistsearchterm.h"
 #include "playlist/playlist.h"
 
@@ -155,6 +159,195 @@ QString SmartPlaylistSearchTerm::ToSql() const {
   return QString();
 }
 
+namespace {
+
+QString TextValue(const SmartPlaylistSearchTerm::Field field, const Song &song) {
+
+  switch (field) {
+    case SmartPlaylistSearchTerm::Field::AlbumArtist:
+      return song.albumartist();
+    case SmartPlaylistSearchTerm::Field::Artist:
+      return song.artist();
+    case SmartPlaylistSearchTerm::Field::Album:
+      return song.album();
+    case SmartPlaylistSearchTerm::Field::Title:
+      return song.title();
+    case SmartPlaylistSearchTerm::Field::Genre:
+      return song.genre();
+    case SmartPlaylistSearchTerm::Field::Composer:
+      return song.composer();
+    case SmartPlaylistSearchTerm::Field::Performer:
+      return song.performer();
+    case SmartPlaylistSearchTerm::Field::Grouping:
+      return song.grouping();
+    case SmartPlaylistSearchTerm::Field::Comment:
+      return song.comment();
+    case SmartPlaylistSearchTerm::Field::Filepath:
+      return QString::fromUtf8(song.url().toEncoded());
+    case SmartPlaylistSearchTerm::Field::Filetype:
+      return QString::number(static_cast<int>(song.filetype()));
+    default:
+      return QString();
+  }
+
+}
+
+qint64 NumberValue(const SmartPlaylistSearchTerm::Field field, const Song &song) {
+
+  switch (field) {
+    case SmartPlaylistSearchTerm::Field::Track:
+      return song.track();
+    case SmartPlaylistSearchTerm::Field::Disc:
+      return song.disc();
+    case SmartPlaylistSearchTerm::Field::Year:
+      return song.year();
+    case SmartPlaylistSearchTerm::Field::OriginalYear:
+      return song.originalyear();
+    case SmartPlaylistSearchTerm::Field::Filesize:
+      return song.filesize();
+    case SmartPlaylistSearchTerm::Field::PlayCount:
+      return song.playcount();
+    case SmartPlaylistSearchTerm::Field::SkipCount:
+      return song.skipcount();
+    case SmartPlaylistSearchTerm::Field::Samplerate:
+      return song.samplerate();
+    case SmartPlaylistSearchTerm::Field::Bitdepth:
+      return song.bitdepth();
+    case SmartPlaylistSearchTerm::Field::Bitrate:
+      return song.bitrate();
+    case SmartPlaylistSearchTerm::Field::Length:
+      return song.length_nanosec();
+    case SmartPlaylistSearchTerm::Field::LastPlayed:
+      return song.lastplayed();
+    case SmartPlaylistSearchTerm::Field::DateCreated:
+      return song.ctime();
+    case SmartPlaylistSearchTerm::Field::DateModified:
+      return song.mtime();
+    default:
+      return 0;
+  }
+
+}
+
+// Like DATETIME('now', '-N unit', 'localtime').
+QDateTime DateTimeAgo(const SmartPlaylistSearchTerm::DateType datetype, const int value) {
+
+  const QDateTime now = QDateTime::currentDateTime();
+  switch (datetype) {
+    case SmartPlaylistSearchTerm::DateType::Hour:
+      return now.addSecs(-3600LL * value);
+    case SmartPlaylistSearchTerm::DateType::Day:
+      return now.addDays(-value);
+    case SmartPlaylistSearchTerm::DateType::Week:
+      return now.addDays(-7LL * value);
+    case SmartPlaylistSearchTerm::DateType::Month:
+      return now.addMonths(-value);
+    case SmartPlaylistSearchTerm::DateType::Year:
+      return now.addYears(-value);
+  }
+
+  return now;
+
+}
+
+// See the comment about the ratings in ToSql.
+int RatingStep(const float rating) {
+  return static_cast<int>((rating + 0.05F) * 10.0F);
+}
+
+template<typename T>
+bool Compare(const SmartPlaylistSearchTerm::Operator op, const T &a, const T &b) {
+
+  switch (op) {
+    case SmartPlaylistSearchTerm::Operator::Equals:
+      return a == b;
+    case SmartPlaylistSearchTerm::Operator::NotEquals:
+      return a != b;
+    case SmartPlaylistSearchTerm::Operator::GreaterThan:
+      return a > b;
+    case SmartPlaylistSearchTerm::Operator::LessThan:
+      return a < b;
+    case SmartPlaylistSearchTerm::Operator::NotEmpty:
+      return true;
+    default:
+      return false;
+  }
+
+}
+
+}  // namespace
+
+bool SmartPlaylistSearchTerm::Matches(const Song &song) const {
+
+  switch (TypeOf(field_)) {
+    case Type::Text:{
+      const QString text = TextValue(field_, song);
+      QString value = value_.toString();
+      if (field_ == Field::Filetype) {
+        Song::FileType filetype = Song::FiletypeByExtension(value);
+        if (filetype == Song::FileType::Unknown) {
+          filetype = Song::FiletypeByDescription(value);
+        }
+        value = QString::number(static_cast<int>(filetype));
+      }
+      else if (field_ == Field::Filepath) {
+        if (operator_ == Operator::StartsWith || operator_ == Operator::Equals) {
+          value = QString::fromUtf8(QUrl::fromLocalFile(value).toEncoded());
+        }
+        else {
+          value = QString::fromUtf8(QUrl(value).toEncoded());
+        }
+      }
+      // LIKE is case insensitive, = and <> are not.
+      switch (operator_) {
+        case Operator::Contains:
+          return text.contains(value, Qt::CaseInsensitive);
+        case Operator::NotContains:
+          return !text.contains(value, Qt::CaseInsensitive);
+        case Operator::StartsWith:
+          return text.startsWith(value, Qt::CaseInsensitive);
+        case Operator::EndsWith:
+          return text.endsWith(value, Qt::CaseInsensitive);
+        case Operator::Equals:
+          return text.compare(value, Qt::CaseInsensitive) == 0;
+        case Operator::NotEquals:
+          return text != value;
+        case Operator::Empty:
+          return text.isEmpty();
+        case Operator::NotEmpty:
+          return !text.isEmpty();
+        default:
+          return false;
+      }
+    }
+    case Type::Number:
+      return Compare(operator_, NumberValue(field_, song), value_.toLongLong());
+    case Type::Time:
+      return Compare(operator_, NumberValue(field_, song), static_cast<qint64>(value_.toDouble() * static_cast<double>(kNsecPerSec)));
+    case Type::Rating:
+      return Compare(operator_, RatingStep(song.rating() < 0.0F ? 0.0F : song.rating()), RatingStep(value_.toFloat()));
+    case Type::Date:{
+      const QDateTime datetime = QDateTime::fromSecsSinceEpoch(NumberValue(field_, song));
+      switch (operator_) {
+        case Operator::NumericDate:
+          return datetime > DateTimeAgo(datetype_, value_.toInt());
+        case Operator::NumericDateNot:
+          return datetime < DateTimeAgo(datetype_, value_.toInt());
+        case Operator::RelativeDate:
+          return datetime < DateTimeAgo(datetype_, value_.toInt()) && datetime > DateTimeAgo(datetype_, second_value_.toInt());
+        default:
+          // The exact dates are compared without the time.
+          return Compare(operator_, datetime.date(), QDateTime::fromSecsSinceEpoch(value_.toLongLong()).date());
+      }
+    }
+    case Type::Invalid:
+      break;
+  }
+
+  return false;
+
+}
+
 bool SmartPlaylistSearchTerm::is_valid() const {
 
   // We can accept also a zero value in these cases
@@ -29,6 +29,8 @@
 #include <QVariant>
 #include <QString>
 
+class Song;
+
 class SmartPlaylistSearchTerm {
  public:
   // These values are persisted, so add to the end of the enum only
@@ -122,6 +124,8 @@ class SmartPlaylistSearchTerm {
   QVariant second_value_;
 
   QString ToSql() const;
+  // Evaluates the term in memory like the SQL from ToSql, so it can be checked against songs that changed.
+  bool Matches(const Song &song) const;
   bool is_valid() const;
   bool operator==(const SmartPlaylistSearchTerm &other) const;
   bool operator!=(const SmartPlaylistSearchTerm &other) const { return !(*this == other); }
@@ -24,6 +24,7 @@
 #include <QWizardPage>
 #include <QLabel>
 #include <QRadioButton>
+#include <QCheckBox>
 #include <QVBoxLayout>
 #include <QStyle>
 
@@ -94,6 +95,9 @@ SmartPlaylistWizard::SmartPlaylistWizard(Application *app, SharedPtr<CollectionB
   finish_page_->setSubTitle(tr("Choose a name for your smart playlist"));
   finish_id_ = addPage(finish_page_);
 
+  // Dynamic playlists replace their songs as they're played, so they can't be live.
+  QObject::connect(finish_page_->ui_->dynamic, &QCheckBox::toggled, finish_page_->ui_->live, &QCheckBox::setDisabled);
+
   new QVBoxLayout(type_page_);
   AddPlugin(new SmartPlaylistQueryWizardPlugin(app_, collection_backend, this));
 
@@ -128,6 +132,7 @@ void SmartPlaylistWizard::SetGenerator(PlaylistGeneratorPtr gen) {
   }
   finish_page_->ui_->name->setText(gen->name());
   finish_page_->ui_->dynamic->setChecked(gen->is_dynamic());
+  finish_page_->ui_->live->setChecked(gen->is_live());
 
   // Tell the plugin to load
   plugins_[type_index_]->SetGenerator(gen);
@@ -172,6 +177,7 @@ PlaylistGeneratorPtr SmartPlaylistWizard::CreateGenerator() const {
 
   ret->set_name(finish_page_->ui_->name->text());
   ret->set_dynamic(finish_page_->ui_->dynamic->isChecked());
+  ret->set_live(!finish_page_->ui_->dynamic->isChecked() && finish_page_->ui_->live->isChecked());
   return ret;
 
 }
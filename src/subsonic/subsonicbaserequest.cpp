@@ -43,10 +43,16 @@
 
 #include "settings/subsonicsettingspage.h"
 
+namespace {
+constexpr int kInitialConcurrentRequests = 3;
+constexpr int kMaxConcurrentRequests = 12;
+}  // namespace
+
 SubsonicBaseRequest::SubsonicBaseRequest(SubsonicService *service, QObject *parent)
     : QObject(parent),
       service_(service),
-      network_(new QNetworkAccessManager) {
+      network_(new QNetworkAccessManager),
+      concurrency_(kInitialConcurrentRequests, kMaxConcurrentRequests) {
 
   network_->setRedirectPolicy(QNetworkRequest::NoLessSafeRedirectPolicy);
 
@@ -92,7 +98,7 @@ QUrl SubsonicBaseRequest::CreateUrl(const QUrl &server_url, const SubsonicSettin
 
 }
 
-QNetworkReply *SubsonicBaseRequest::CreateGetRequest(const QString &ressource_name, const ParamList &params_provided) const {
+QNetworkReply *SubsonicBaseRequest::CreateGetRequest(const QString &ressource_name, const ParamList &params_provided) {
 
   QUrl url = CreateUrl(server_url(), auth_method(), username(), password(), ressource_name, params_provided);
   QNetworkRequest req(url);
@@ -112,6 +118,7 @@ QNetworkReply *SubsonicBaseRequest::CreateGetRequest(const QString &ressource_na
 
   QNetworkReply *reply = network_->get(req);
   QObject::connect(reply, &QNetworkReply::sslErrors, this, &SubsonicBaseRequest::HandleSSLErrors);
+  concurrency_.ReplyStarted(reply);
 
   //qLog(Debug) << "Subsonic: Sending request" << url;
 
@@ -119,6 +126,14 @@ QNetworkReply *SubsonicBaseRequest::CreateGetRequest(const QString &ressource_na
 
 }
 
+bool SubsonicBaseRequest::ReplyThrottled(QNetworkReply *reply) {
+
+  concurrency_.ReplyFinished(reply);
+
+  return InternetRequestConcurrency::IsThrottled(reply);
+
+}
+
 void SubsonicBaseRequest::HandleSSLErrors(const QList<QSslError> &ssl_errors) {
 
   for (const QSslError &ssl_error : ssl_errors) {
@@ -129,6 +144,8 @@ void SubsonicBaseRequest::HandleSSLErrors(const QList<QSslError> &ssl_errors) {
 
 QByteArray SubsonicBaseRequest::GetReplyData(QNetworkReply *reply) {
 
+  concurrency_.ReplyFinished(reply);
+
   QByteArray data;
 
   if (reply->error() == QNetworkReply::NoError && reply->attribute(QNetworkRequest::HttpStatusCodeAttribute).toInt() == 200) {
@@ -35,6 +35,7 @@
 #include <QJsonObject>
 
 #include "core/scoped_ptr.h"
+#include "internet/internetrequestconcurrency.h"
 #include "subsonicservice.h"
 #include "settings/subsonicsettingspage.h"
 
@@ -55,10 +56,15 @@ class SubsonicBaseRequest : public QObject {
   static QUrl CreateUrl(const QUrl &server_url, const SubsonicSettingsPage::AuthMethod auth_method, const QString &username, const QString &password, const QString &ressource_name, const ParamList &params_provided);
 
  protected:
-  QNetworkReply *CreateGetRequest(const QString &ressource_name, const ParamList &params_provided) const;
+  QNetworkReply *CreateGetRequest(const QString &ressource_name, const ParamList &params_provided);
   QByteArray GetReplyData(QNetworkReply *reply);
   QJsonObject ExtractJsonObj(QByteArray &data);
 
+  // The number of requests to keep in flight, it adapts to how fast the server replies.
+  int max_concurrent_requests() const { return concurrency_.limit(); }
+  // Returns true if the request should be sent again, the reply data is not read then.
+  bool ReplyThrottled(QNetworkReply *reply);
+
   virtual void Error(const QString &error, const QVariant &debug = QVariant()) = 0;
   static QString ErrorsToHTML(const QStringList &errors);
 
@@ -76,6 +82,7 @@ class SubsonicBaseRequest : public QObject {
  private:
   SubsonicService *service_;
   ScopedPtr<QNetworkAccessManager> network_;
+  InternetRequestConcurrency concurrency_;
 };
 
 #endif  // SUBSONICBASEREQUEST_H
@@ -19,17 +19,20 @@
 
 #include "config.h"
 
+#include <utility>
+
 #include <QObject>
+#include <QTimer>
 #include <QDir>
 #include <QMimeDatabase>
 #include <QByteArray>
-#include <QByteArrayList>
+#include <QMap>
+#include <QMultiHash>
 #include <QString>
+#include <QStringList>
 #include <QUrl>
 #include <QUrlQuery>
 #include <QDateTime>
-#include <QImage>
-#include <QImageReader>
 #include <QNetworkAccessManager>
 #include <QNetworkRequest>
 #include <QNetworkReply>
@@ -43,19 +46,14 @@
 #include "core/logging.h"
 #include "core/song.h"
 #include "core/networktimeouts.h"
-#include "utilities/imageutils.h"
+#include "collection/collectionbackend.h"
+#include "internet/internetcoverdownloader.h"
 #include "utilities/timeconstants.h"
 #include "subsonicservice.h"
 #include "subsonicurlhandler.h"
 #include "subsonicbaserequest.h"
 #include "subsonicrequest.h"
 
-namespace {
-constexpr int kMaxConcurrentAlbumsRequests = 3;
-constexpr int kMaxConcurrentAlbumSongsRequests = 3;
-constexpr int kMaxConcurrentAlbumCoverRequests = 1;
-}  // namespace
-
 SubsonicRequest::SubsonicRequest(SubsonicService *service, SubsonicUrlHandler *url_handler, Application *app, QObject *parent)
     : SubsonicBaseRequest(service, parent),
       service_(service),
@@ -64,17 +62,14 @@ SubsonicRequest::SubsonicRequest(SubsonicService *service, SubsonicUrlHandler *u
       network_(new QNetworkAccessManager(this)),
       timeouts_(new NetworkTimeouts(30000, this)),
       finished_(false),
-      albums_requests_active_(0),
-      album_songs_requests_active_(0),
-      album_songs_requested_(0),
-      album_songs_received_(0),
-      album_covers_requests_active_(0),
-      album_covers_requested_(0),
+      album_covers_total_(0),
       album_covers_received_(0),
       no_results_(false) {
 
   network_->setRedirectPolicy(QNetworkRequest::NoLessSafeRedirectPolicy);
 
+  QObject::connect(&*app_->internet_cover_downloader(), &InternetCoverDownloader::Finished, this, &SubsonicRequest::AlbumCoverReceived);
+
 }
 
 SubsonicRequest::~SubsonicRequest() {
@@ -86,11 +81,9 @@ SubsonicRequest::~SubsonicRequest() {
     reply->deleteLater();
   }
 
-  while (!album_cover_replies_.isEmpty()) {
-    QNetworkReply *reply = album_cover_replies_.takeFirst();
-    QObject::disconnect(reply, nullptr, this, nullptr);
-    if (reply->isRunning()) reply->abort();
-    reply->deleteLater();
+  const QList<quint64> album_cover_downloads = album_cover_downloads_.keys();
+  for (const quint64 id : album_cover_downloads) {
+    app_->internet_cover_downloader()->Cancel(id);
   }
 
 }
@@ -99,26 +92,25 @@ void SubsonicRequest::Reset() {
 
   finished_ = false;
 
-  albums_requests_queue_.clear();
-  album_songs_requests_queue_.clear();
-  album_cover_requests_queue_.clear();
+  albums_requests_.Clear();
+  album_songs_requests_.Clear();
   album_songs_requests_pending_.clear();
   album_covers_requests_sent_.clear();
 
-  albums_requests_active_ = 0;
-  album_songs_requests_active_ = 0;
-  album_songs_requested_ = 0;
-  album_songs_received_ = 0;
-  album_covers_requests_active_ = 0;
-  album_covers_requested_ = 0;
+  const QList<quint64> album_cover_downloads = album_cover_downloads_.keys();
+  for (const quint64 id : album_cover_downloads) {
+    app_->internet_cover_downloader()->Cancel(id);
+  }
+  album_cover_downloads_.clear();
+  album_covers_total_ = 0;
   album_covers_received_ = 0;
+  album_signatures_.clear();
 
   songs_.clear();
   cover_urls_.clear();
   errors_.clear();
   no_results_ = false;
   replies_.clear();
-  album_cover_replies_.clear();
 
 }
 
@@ -135,18 +127,14 @@ void SubsonicRequest::AddAlbumsRequest(const int offset, const int size) {
   Request request;
   request.size = size;
   request.offset = offset;
-  albums_requests_queue_.enqueue(request);
-  if (albums_requests_active_ < kMaxConcurrentAlbumsRequests) FlushAlbumsRequests();
+  albums_requests_.Enqueue(request);
+  if (albums_requests_.active() < max_concurrent_requests()) FlushAlbumsRequests();
 
 }
 
 void SubsonicRequest::FlushAlbumsRequests() {
 
-  while (!albums_requests_queue_.isEmpty() && albums_requests_active_ < kMaxConcurrentAlbumsRequests) {
-
-    Request request = albums_requests_queue_.dequeue();
-    ++albums_requests_active_;
-
+  albums_requests_.Flush(max_concurrent_requests(), [this](const Request &request) -> QNetworkReply* {
     ParamList params = ParamList() << Param(QStringLiteral("type"), QStringLiteral("alphabeticalByName"));
     if (request.size > 0) params << Param(QStringLiteral("size"), QString::number(request.size));
     if (request.offset > 0) params << Param(QStringLiteral("offset"), QString::number(request.offset));
@@ -155,19 +143,39 @@ void SubsonicRequest::FlushAlbumsRequests() {
     replies_ << reply;
     QObject::connect(reply, &QNetworkReply::finished, this, [this, reply, request]() { AlbumsReplyReceived(reply, request.offset, request.size); });
     timeouts_->AddReply(reply);
+    return reply;
+  });
 
-  }
+}
+
+template<typename T>
+bool SubsonicRequest::RetryRequest(QNetworkReply *reply, InternetRequestQueue<T> *queue, void (SubsonicRequest::*flush)()) {
+
+  qint64 delay_msec = 0;
+  if (finished_ || !replies_.contains(reply) || !ReplyThrottled(reply) || !queue->Retry(reply, &delay_msec)) return false;
+
+  qLog(Debug) << "Subsonic: Request throttled, retrying in" << delay_msec << "ms";
+
+  replies_.removeAll(reply);
+  QObject::disconnect(reply, nullptr, this, nullptr);
+  reply->deleteLater();
+
+  QTimer::singleShot(static_cast<int>(delay_msec), this, flush);
+
+  return true;
 
 }
 
 void SubsonicRequest::AlbumsReplyReceived(QNetworkReply *reply, const int offset_requested, const int size_requested) {
 
+  if (RetryRequest(reply, &albums_requests_, &SubsonicRequest::FlushAlbumsRequests)) return;
+
   if (!replies_.contains(reply)) return;
   replies_.removeAll(reply);
   QObject::disconnect(reply, nullptr, this, nullptr);
   reply->deleteLater();
 
-  --albums_requests_active_;
+  albums_requests_.ReplyReceived(reply);
 
   QByteArray data = GetReplyData(reply);
 
@@ -280,6 +288,8 @@ void SubsonicRequest::AlbumsReplyReceived(QNetworkReply *reply, const int offset
 
     if (album_songs_requests_pending_.contains(album_id)) continue;
 
+    album_signatures_.insert(album_id, AlbumSignature(obj_album));
+
     Request request;
     request.album_id = album_id;
     request.album_artist = artist;
@@ -302,20 +312,46 @@ void SubsonicRequest::AlbumsFinishCheck(const int offset, const int size, const
     }
   }
 
-  if (!albums_requests_queue_.isEmpty() && albums_requests_active_ < kMaxConcurrentAlbumsRequests) FlushAlbumsRequests();
+  if (!albums_requests_.isEmpty() && albums_requests_.active() < max_concurrent_requests()) FlushAlbumsRequests();
 
-  if (albums_requests_queue_.isEmpty() && albums_requests_active_ <= 0) { // Albums list is finished, get songs for all albums.
+  if (albums_requests_.isEmpty() && albums_requests_.active() <= 0) { // Albums list is finished, get songs for all albums.
 
+    // With incremental sync the songs of albums that are unchanged since the last refresh are taken from the collection.
+    QMap<QString, QString> previous_album_signatures;
+    QMultiHash<QString, Song> collection_songs;
+    if (service_->incremental_sync() && !album_songs_requests_pending_.isEmpty()) {
+      previous_album_signatures = service_->AlbumSignatures();
+      if (!previous_album_signatures.isEmpty()) {
+        const SongList songs = service_->collection_backend()->GetAllSongs();
+        for (const Song &song : songs) {
+          if (!song.album_id().isEmpty()) collection_songs.insert(song.album_id(), song);
+        }
+      }
+    }
+
+    int albums_unchanged = 0;
     for (QHash<QString, Request> ::iterator it = album_songs_requests_pending_.begin(); it != album_songs_requests_pending_.end(); ++it) {
       Request request = it.value();
+      if (collection_songs.contains(request.album_id) && previous_album_signatures.value(request.album_id) == album_signatures_.value(request.album_id)) {
+        const SongList album_songs = collection_songs.values(request.album_id);
+        for (const Song &song : album_songs) {
+          songs_.insert(song.song_id(), song);
+        }
+        ++albums_unchanged;
+        continue;
+      }
       AddAlbumSongsRequest(request.artist_id, request.album_id, request.album_artist);
     }
     album_songs_requests_pending_.clear();
 
-    if (album_songs_requested_ > 0) {
-      if (album_songs_requested_ == 1) emit UpdateStatus(tr("Retrieving songs for %1 album...").arg(album_songs_requested_));
-      else emit UpdateStatus(tr("Retrieving songs for %1 albums...").arg(album_songs_requested_));
-      emit ProgressSetMaximum(album_songs_requested_);
+    if (albums_unchanged > 0) {
+      qLog(Debug) << "Subsonic:" << albums_unchanged << "albums are unchanged," << album_songs_requests_.total() << "albums need to be fetched";
+    }
+
+    if (album_songs_requests_.total() > 0) {
+      if (album_songs_requests_.total() == 1) emit UpdateStatus(tr("Retrieving songs for %1 album...").arg(album_songs_requests_.total()));
+      else emit UpdateStatus(tr("Retrieving songs for %1 albums...").arg(album_songs_requests_.total()));
+      emit ProgressSetMaximum(album_songs_requests_.total());
       emit UpdateProgress(0);
     }
   }
@@ -331,38 +367,35 @@ void SubsonicRequest::AddAlbumSongsRequest(const QString &artist_id, const QStri
   request.album_id = album_id;
   request.album_artist = album_artist;
   request.offset = offset;
-  album_songs_requests_queue_.enqueue(request);
-  ++album_songs_requested_;
-  if (album_songs_requests_active_ < kMaxConcurrentAlbumSongsRequests) FlushAlbumSongsRequests();
+  album_songs_requests_.Enqueue(request);
+  if (album_songs_requests_.active() < max_concurrent_requests()) FlushAlbumSongsRequests();
 
 }
 
 void SubsonicRequest::FlushAlbumSongsRequests() {
 
-  while (!album_songs_requests_queue_.isEmpty() && album_songs_requests_active_ < kMaxConcurrentAlbumSongsRequests) {
-
-    Request request = album_songs_requests_queue_.dequeue();
-    ++album_songs_requests_active_;
+  album_songs_requests_.Flush(max_concurrent_requests(), [this](const Request &request) -> QNetworkReply* {
     QNetworkReply *reply = CreateGetRequest(QStringLiteral("getAlbum"), ParamList() << Param(QStringLiteral("id"), request.album_id));
     replies_ << reply;
     QObject::connect(reply, &QNetworkReply::finished, this, [this, reply, request]() { AlbumSongsReplyReceived(reply, request.artist_id, request.album_id, request.album_artist); });
     timeouts_->AddReply(reply);
-
-  }
+    return reply;
+  });
 
 }
 
 void SubsonicRequest::AlbumSongsReplyReceived(QNetworkReply *reply, const QString &artist_id, const QString &album_id, const QString &album_artist) {
 
+  if (RetryRequest(reply, &album_songs_requests_, &SubsonicRequest::FlushAlbumSongsRequests)) return;
+
   if (!replies_.contains(reply)) return;
   replies_.removeAll(reply);
   QObject::disconnect(reply, nullptr, this, nullptr);
   reply->deleteLater();
 
-  --album_songs_requests_active_;
-  ++album_songs_received_;
+  album_songs_requests_.ReplyReceived(reply);
 
-  emit UpdateProgress(album_songs_received_);
+  emit UpdateProgress(album_songs_requests_.received());
 
   QByteArray data = GetReplyData(reply);
 
@@ -467,16 +500,15 @@ void SubsonicRequest::SongsFinishCheck() {
 
   if (finished_) return;
 
-  if (!album_songs_requests_queue_.isEmpty() && album_songs_requests_active_ < kMaxConcurrentAlbumSongsRequests) FlushAlbumSongsRequests();
+  if (!album_songs_requests_.isEmpty() && album_songs_requests_.active() < max_concurrent_requests()) FlushAlbumSongsRequests();
 
   if (
       download_album_covers() &&
-      album_songs_requests_queue_.isEmpty() &&
-      album_songs_requests_active_ <= 0 &&
-      album_cover_requests_queue_.isEmpty() &&
-      album_covers_received_ <= 0 &&
+      album_songs_requests_.isEmpty() &&
+      album_songs_requests_.active() <= 0 &&
+      album_covers_total_ <= 0 &&
       album_covers_requests_sent_.isEmpty() &&
-      album_songs_received_ >= album_songs_requested_
+      album_songs_requests_.received() >= album_songs_requests_.total()
   ) {
     GetAlbumCovers();
   }
@@ -683,13 +715,13 @@ void SubsonicRequest::GetAlbumCovers() {
 
   const SongList songs = songs_.values();
   for (const Song &song : songs) {
-    if (!song.art_automatic().isEmpty()) AddAlbumCoverRequest(song);
+    // Songs from the collection already have the downloaded cover.
+    if (!song.art_automatic().isEmpty() && !song.art_automatic().isLocalFile()) AddAlbumCoverRequest(song);
   }
-  FlushAlbumCoverRequests();
 
-  if (album_covers_requested_ == 1) emit UpdateStatus(tr("Retrieving album cover for %1 album...").arg(album_covers_requested_));
-  else emit UpdateStatus(tr("Retrieving album covers for %1 albums...").arg(album_covers_requested_));
-  emit ProgressSetMaximum(album_covers_requested_);
+  if (album_covers_total_ == 1) emit UpdateStatus(tr("Retrieving album cover for %1 album...").arg(album_covers_total_));
+  else emit UpdateStatus(tr("Retrieving album covers for %1 albums...").arg(album_covers_total_));
+  emit ProgressSetMaximum(album_covers_total_);
   emit UpdateProgress(0);
 
 }
@@ -719,130 +751,50 @@ void SubsonicRequest::AddAlbumCoverRequest(const Song &song) {
   QDir dir(cover_path);
   if (!dir.exists()) dir.mkpath(cover_path);
 
-  AlbumCoverRequest request;
-  request.album_id = song.album_id();
-  request.cover_id = cover_id;
-  request.url = cover_url;
-  request.filename = cover_path + QLatin1Char('/') + cover_id + QStringLiteral(".jpg");
-  if (request.filename.isEmpty()) return;
+  const QString filename = cover_path + QLatin1Char('/') + cover_id + QStringLiteral(".jpg");
 
   album_covers_requests_sent_.insert(cover_id, song.song_id());
-  ++album_covers_requested_;
 
-  album_cover_requests_queue_.enqueue(request);
-
-}
-
-void SubsonicRequest::FlushAlbumCoverRequests() {
-
-  while (!album_cover_requests_queue_.isEmpty() && album_covers_requests_active_ < kMaxConcurrentAlbumCoverRequests) {
-
-    AlbumCoverRequest request = album_cover_requests_queue_.dequeue();
-    ++album_covers_requests_active_;
-
-    QNetworkRequest req(request.url);
-    req.setAttribute(QNetworkRequest::RedirectPolicyAttribute, QNetworkRequest::NoLessSafeRedirectPolicy);
+  QNetworkRequest req(cover_url);
+  req.setAttribute(QNetworkRequest::RedirectPolicyAttribute, QNetworkRequest::NoLessSafeRedirectPolicy);
 
 #if QT_VERSION >= QT_VERSION_CHECK(5, 15, 0)
-    req.setAttribute(QNetworkRequest::Http2AllowedAttribute, http2());
+  req.setAttribute(QNetworkRequest::Http2AllowedAttribute, http2());
 #endif
 
-    if (!verify_certificate()) {
-      QSslConfiguration sslconfig = QSslConfiguration::defaultConfiguration();
-      sslconfig.setPeerVerifyMode(QSslSocket::VerifyNone);
-      req.setSslConfiguration(sslconfig);
-    }
-
-    QNetworkReply *reply = network_->get(req);
-    album_cover_replies_ << reply;
-    QObject::connect(reply, &QNetworkReply::finished, this, [this, reply, request]() { AlbumCoverReceived(reply, request); });
-    timeouts_->AddReply(reply);
-
+  if (!verify_certificate()) {
+    QSslConfiguration sslconfig = QSslConfiguration::defaultConfiguration();
+    sslconfig.setPeerVerifyMode(QSslSocket::VerifyNone);
+    req.setSslConfiguration(sslconfig);
   }
 
+  album_cover_downloads_.insert(app_->internet_cover_downloader()->Download(req, filename), cover_id);
+  ++album_covers_total_;
+
 }
 
-void SubsonicRequest::AlbumCoverReceived(QNetworkReply *reply, const AlbumCoverRequest &request) {
+void SubsonicRequest::AlbumCoverReceived(const quint64 id, const QString &filename, const QString &error) {
 
-  if (album_cover_replies_.contains(reply)) {
-    album_cover_replies_.removeAll(reply);
-    QObject::disconnect(reply, nullptr, this, nullptr);
-    reply->deleteLater();
-  }
-  else {
-    AlbumCoverFinishCheck();
-    return;
-  }
+  if (!album_cover_downloads_.contains(id)) return;
 
-  --album_covers_requests_active_;
+  const QString cover_id = album_cover_downloads_.take(id);
   ++album_covers_received_;
 
   if (finished_) return;
 
   emit UpdateProgress(album_covers_received_);
 
-  if (!album_covers_requests_sent_.contains(request.cover_id)) {
-    AlbumCoverFinishCheck();
-    return;
-  }
-
-  if (reply->error() != QNetworkReply::NoError) {
-    Error(QStringLiteral("%1 (%2) for %3").arg(reply->errorString()).arg(reply->error()).arg(request.url.toString()));
-    if (album_covers_requests_sent_.contains(request.cover_id)) album_covers_requests_sent_.remove(request.cover_id);
-    AlbumCoverFinishCheck();
-    return;
-  }
-
-  if (reply->attribute(QNetworkRequest::HttpStatusCodeAttribute).toInt() != 200) {
-    Error(QStringLiteral("Received HTTP code %1 for %2.").arg(reply->attribute(QNetworkRequest::HttpStatusCodeAttribute).toInt()).arg(request.url.toString()));
-    if (album_covers_requests_sent_.contains(request.cover_id)) album_covers_requests_sent_.remove(request.cover_id);
-    AlbumCoverFinishCheck();
-    return;
-  }
-
-  QString mimetype = reply->header(QNetworkRequest::ContentTypeHeader).toString();
-  if (mimetype.contains(QLatin1Char(';'))) {
-    mimetype = mimetype.left(mimetype.indexOf(QLatin1Char(';')));
-  }
-  if (!ImageUtils::SupportedImageMimeTypes().contains(mimetype, Qt::CaseInsensitive) && !ImageUtils::SupportedImageFormats().contains(mimetype, Qt::CaseInsensitive)) {
-    Error(QStringLiteral("Unsupported mimetype for image reader %1 for %2").arg(mimetype, request.url.toString()));
-    if (album_covers_requests_sent_.contains(request.cover_id)) album_covers_requests_sent_.remove(request.cover_id);
-    AlbumCoverFinishCheck();
-    return;
-  }
-
-  QByteArray data = reply->readAll();
-  if (data.isEmpty()) {
-    Error(QStringLiteral("Received empty image data for %1").arg(request.url.toString()));
-    if (album_covers_requests_sent_.contains(request.cover_id)) album_covers_requests_sent_.remove(request.cover_id);
-    AlbumCoverFinishCheck();
-    return;
-  }
-
-  QByteArrayList format_list = QImageReader::imageFormatsForMimeType(mimetype.toUtf8());
-  char *format = nullptr;
-  if (!format_list.isEmpty()) {
-    format = format_list.first().data();
-  }
-
-  QImage image;
-  if (image.loadFromData(data, format)) {
-    if (image.save(request.filename, format)) {
-      while (album_covers_requests_sent_.contains(request.cover_id)) {
-        const QString song_id = album_covers_requests_sent_.take(request.cover_id);
-        if (songs_.contains(song_id)) {
-          songs_[song_id].set_art_automatic(QUrl::fromLocalFile(request.filename));
-        }
+  if (error.isEmpty()) {
+    while (album_covers_requests_sent_.contains(cover_id)) {
+      const QString song_id = album_covers_requests_sent_.take(cover_id);
+      if (songs_.contains(song_id)) {
+        songs_[song_id].set_art_automatic(QUrl::fromLocalFile(filename));
       }
     }
-    else {
-      Error(QStringLiteral("Error saving image data to %1.").arg(request.filename));
-      if (album_covers_requests_sent_.contains(request.cover_id)) album_covers_requests_sent_.remove(request.cover_id);
-    }
   }
   else {
-    Error(QStringLiteral("Error decoding image data from %1.").arg(request.url.toString()));
-    if (album_covers_requests_sent_.contains(request.cover_id)) album_covers_requests_sent_.remove(request.cover_id);
+    Error(error);
+    album_covers_requests_sent_.remove(cover_id);
   }
 
   AlbumCoverFinishCheck();
@@ -851,10 +803,6 @@ void SubsonicRequest::AlbumCoverReceived(QNetworkReply *reply, const AlbumCoverR
 
 void SubsonicRequest::AlbumCoverFinishCheck() {
 
-  if (!album_cover_requests_queue_.isEmpty() && album_covers_requests_active_ < kMaxConcurrentAlbumCoverRequests) {
-    FlushAlbumCoverRequests();
-  }
-
   FinishCheck();
 
 }
@@ -863,18 +811,20 @@ void SubsonicRequest::FinishCheck() {
 
   if (
       !finished_ &&
-      albums_requests_queue_.isEmpty() &&
-      album_songs_requests_queue_.isEmpty() &&
-      album_cover_requests_queue_.isEmpty() &&
+      albums_requests_.isEmpty() &&
+      album_songs_requests_.isEmpty() &&
+      album_cover_downloads_.isEmpty() &&
       album_songs_requests_pending_.isEmpty() &&
       album_covers_requests_sent_.isEmpty() &&
-      albums_requests_active_ <= 0 &&
-      album_songs_requests_active_ <= 0 &&
-      album_songs_received_ >= album_songs_requested_ &&
-      album_covers_requests_active_ <= 0 &&
-      album_covers_received_ >= album_covers_requested_
+      albums_requests_.active() <= 0 &&
+      album_songs_requests_.active() <= 0 &&
+      album_songs_requests_.received() >= album_songs_requests_.total() &&
+      album_covers_received_ >= album_covers_total_
   ) {
     finished_ = true;
+    if (!songs_.isEmpty()) {
+      SaveAlbumSignatures();
+    }
     if (no_results_ && songs_.isEmpty()) {
       emit Results(SongMap(), QString());
     }
@@ -891,6 +841,33 @@ void SubsonicRequest::FinishCheck() {
 
 }
 
+// Any change to these values makes the songs of the album be fetched again.
+QString SubsonicRequest::AlbumSignature(const QJsonObject &obj_album) {
+
+  QStringList signature;
+  const QStringList keys = QStringList() << QStringLiteral("changed") << QStringLiteral("created") << QStringLiteral("songCount") << QStringLiteral("duration") << QStringLiteral("name") << QStringLiteral("album") << QStringLiteral("artist") << QStringLiteral("year") << QStringLiteral("genre") << QStringLiteral("coverArt");
+  for (const QString &key : keys) {
+    signature << obj_album[key].toVariant().toString();
+  }
+
+  return signature.join(QLatin1Char('|'));
+
+}
+
+// Only albums with songs in the results are saved, so albums that failed are fetched again next time.
+void SubsonicRequest::SaveAlbumSignatures() {
+
+  QMap<QString, QString> album_signatures;
+  for (const Song &song : std::as_const(songs_)) {
+    if (album_signatures_.contains(song.album_id())) {
+      album_signatures.insert(song.album_id(), album_signatures_.value(song.album_id()));
+    }
+  }
+
+  service_->SaveAlbumSignatures(album_signatures);
+
+}
+
 void SubsonicRequest::Error(const QString &error, const QVariant &debug) {
 
   if (!error.isEmpty()) {
@@ -30,7 +30,7 @@
 #include <QHash>
 #include <QMap>
 #include <QMultiMap>
-#include <QQueue>
+#include <QMultiHash>
 #include <QVariant>
 #include <QString>
 #include <QStringList>
@@ -38,6 +38,7 @@
 #include <QJsonObject>
 
 #include "core/song.h"
+#include "internet/internetrequestqueue.h"
 #include "subsonicbaserequest.h"
 
 class QNetworkAccessManager;
@@ -69,13 +70,6 @@ class SubsonicRequest : public SubsonicBaseRequest {
     int size;
     QString album_artist;
   };
-  struct AlbumCoverRequest {
-    QString artist_id;
-    QString album_id;
-    QString cover_id;
-    QUrl url;
-    QString filename;
-  };
 
  signals:
   void Results(const SongMap &songs, const QString &error);
@@ -86,7 +80,7 @@ class SubsonicRequest : public SubsonicBaseRequest {
  private slots:
   void AlbumsReplyReceived(QNetworkReply *reply, const int offset_requested, const int size_requested);
   void AlbumSongsReplyReceived(QNetworkReply *reply, const QString &artist_id, const QString &album_id, const QString &album_artist);
-  void AlbumCoverReceived(QNetworkReply *reply, const AlbumCoverRequest &request);
+  void AlbumCoverReceived(const quint64 id, const QString &filename, const QString &error);
 
  private:
 
@@ -103,9 +97,14 @@ class SubsonicRequest : public SubsonicBaseRequest {
 
   void GetAlbumCovers();
   void AddAlbumCoverRequest(const Song &song);
-  void FlushAlbumCoverRequests();
   void AlbumCoverFinishCheck();
 
+  static QString AlbumSignature(const QJsonObject &obj_album);
+  void SaveAlbumSignatures();
+
+  template<typename T>
+  bool RetryRequest(QNetworkReply *reply, InternetRequestQueue<T> *queue, void (SubsonicRequest::*flush)());
+
   void FinishCheck();
   static void Warn(const QString &error, const QVariant &debug = QVariant());
   void Error(const QString &error, const QVariant &debug = QVariant()) override;
@@ -118,21 +117,15 @@ class SubsonicRequest : public SubsonicBaseRequest {
 
   bool finished_;
 
-  QQueue<Request> albums_requests_queue_;
-  QQueue<Request> album_songs_requests_queue_;
-  QQueue<AlbumCoverRequest> album_cover_requests_queue_;
+  InternetRequestQueue<Request> albums_requests_;
+  InternetRequestQueue<Request> album_songs_requests_;
 
   QHash<QString, Request> album_songs_requests_pending_;
   QMultiMap<QString, QString> album_covers_requests_sent_;
+  QHash<quint64, QString> album_cover_downloads_;
+  QHash<QString, QString> album_signatures_;
 
-  int albums_requests_active_;
-
-  int album_songs_requests_active_;
-  int album_songs_requested_;
-  int album_songs_received_;
-
-  int album_covers_requests_active_;
-  int album_covers_requested_;
+  int album_covers_total_;
   int album_covers_received_;
 
   SongMap songs_;
@@ -140,7 +133,6 @@ class SubsonicRequest : public SubsonicBaseRequest {
   QStringList errors_;
   bool no_results_;
   QList<QNetworkReply*> replies_;
-  QList<QNetworkReply*> album_cover_replies_;
 };
 
 #endif  // SUBSONICREQUEST_H
@@ -24,6 +24,8 @@
 #include <QByteArray>
 #include <QString>
 #include <QDateTime>
+#include <QElapsedTimer>
+#include <QNetworkRequest>
 #include <QNetworkReply>
 #include <QJsonObject>
 #include <QJsonArray>
@@ -31,6 +33,7 @@
 
 #include "core/application.h"
 #include "core/logging.h"
+#include "utilities/timeconstants.h"
 #include "subsonicservice.h"
 #include "subsonicbaserequest.h"
 #include "subsonicscrobblerequest.h"
@@ -79,15 +82,17 @@ void SubsonicScrobbleRequest::FlushScrobbleRequests() {
                                    << Param(QStringLiteral("submission"), QVariant(request.submission).toString())
                                    << Param(QStringLiteral("time"), QVariant(request.time_ms).toString());
 
+    QElapsedTimer timer;
+    timer.start();
     QNetworkReply *reply = CreateGetRequest(QStringLiteral("scrobble"), params);
     replies_ << reply;
-    QObject::connect(reply, &QNetworkReply::finished, this, [this, reply]() { ScrobbleReplyReceived(reply); });
+    QObject::connect(reply, &QNetworkReply::finished, this, [this, reply, request, timer]() { ScrobbleReplyReceived(reply, request, timer); });
 
   }
 
 }
 
-void SubsonicScrobbleRequest::ScrobbleReplyReceived(QNetworkReply *reply) {
+void SubsonicScrobbleRequest::ScrobbleReplyReceived(QNetworkReply *reply, const Request &request, const QElapsedTimer &timer) {
 
   if (!replies_.contains(reply)) return;
   replies_.removeAll(reply);
@@ -96,6 +101,8 @@ void SubsonicScrobbleRequest::ScrobbleReplyReceived(QNetworkReply *reply) {
 
   --scrobble_requests_active_;
 
+  emit ScrobbleRequestFinished(request.submission, QDateTime::currentSecsSinceEpoch() - request.time_ms / kMsecPerSec, timer.elapsed(), reply->error() == QNetworkReply::NoError && reply->attribute(QNetworkRequest::HttpStatusCodeAttribute).toInt() == 200);
+
   // "subsonic-response" is empty on success, but some keys like status, version, or type might be present.
   // Therefore, we can only check for errors.
   QByteArray data = GetReplyData(reply);
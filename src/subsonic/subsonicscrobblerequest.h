@@ -28,6 +28,7 @@
 #include <QtGlobal>
 #include <QObject>
 #include <QDateTime>
+#include <QElapsedTimer>
 #include <QQueue>
 #include <QVariant>
 #include <QString>
@@ -49,11 +50,10 @@ class SubsonicScrobbleRequest : public SubsonicBaseRequest {
 
   void CreateScrobbleRequest(const QString &song_id, const bool submission, const QDateTime &start_time);
 
- private slots:
-  void ScrobbleReplyReceived(QNetworkReply *reply);
+ signals:
+  void ScrobbleRequestFinished(const bool submission, const qint64 wait_secs, const qint64 latency_msec, const bool success);
 
  private:
-
   struct Request {
     explicit Request() : submission(false) {}
     // subsonic song id
@@ -65,6 +65,7 @@ class SubsonicScrobbleRequest : public SubsonicBaseRequest {
   };
 
   void FlushScrobbleRequests();
+  void ScrobbleReplyReceived(QNetworkReply *reply, const Request &request, const QElapsedTimer &timer);
   void FinishCheck();
 
   void Error(const QString &error, const QVariant &debug = QVariant()) override;
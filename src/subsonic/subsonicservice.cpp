@@ -41,6 +41,8 @@
 #include <QJsonObject>
 #include <QSettings>
 #include <QSortFilterProxyModel>
+#include <QMutexLocker>
+#include <QSqlDatabase>
 
 #include "core/logging.h"
 #include "core/shared_ptr.h"
@@ -48,10 +50,13 @@
 #include "core/player.h"
 #include "core/database.h"
 #include "core/song.h"
+#include "core/sqlquery.h"
+#include "core/scopedtransaction.h"
 #include "core/settings.h"
 #include "utilities/randutils.h"
 #include "collection/collectionbackend.h"
 #include "collection/collectionmodel.h"
+#include "collection/collectionsortmodel.h"
 #include "subsonicservice.h"
 #include "subsonicurlhandler.h"
 #include "subsonicrequest.h"
@@ -78,10 +83,11 @@ SubsonicService::SubsonicService(Application *app, QObject *parent)
       url_handler_(new SubsonicUrlHandler(app, this)),
       collection_backend_(nullptr),
       collection_model_(nullptr),
-      collection_sort_model_(new QSortFilterProxyModel(this)),
+      collection_sort_model_(new CollectionSortModel(this)),
       http2_(false),
       verify_certificate_(false),
       download_album_covers_(true),
+      incremental_sync_(true),
       auth_method_(SubsonicSettingsPage::AuthMethod::MD5),
       ping_redirects_(0) {
 
@@ -98,9 +104,7 @@ SubsonicService::SubsonicService(Application *app, QObject *parent)
 
   collection_model_ = new CollectionModel(collection_backend_, app_, this);
   collection_sort_model_->setSourceModel(collection_model_);
-  collection_sort_model_->setSortRole(CollectionModel::Role_SortText);
   collection_sort_model_->setDynamicSortFilter(true);
-  collection_sort_model_->setSortLocaleAware(true);
   collection_sort_model_->sort(0);
 
   SubsonicService::ReloadSettings();
@@ -143,6 +147,7 @@ void SubsonicService::ReloadSettings() {
   http2_ = s.value("http2", false).toBool();
   verify_certificate_ = s.value("verifycertificate", false).toBool();
   download_album_covers_ = s.value("downloadalbumcovers", true).toBool();
+  incremental_sync_ = s.value("incrementalsync", true).toBool();
   auth_method_ = static_cast<SubsonicSettingsPage::AuthMethod>(s.value("authmethod", static_cast<int>(SubsonicSettingsPage::AuthMethod::MD5)).toInt());
 
   s.endGroup();
@@ -406,6 +411,7 @@ void SubsonicService::Scrobble(const QString &song_id, const bool submission, co
   if (!scrobble_request_) {
     // We're doing requests every 30-240s the whole time, so keep reusing this instance
     scrobble_request_.reset(new SubsonicScrobbleRequest(this, url_handler_, app_), [](SubsonicScrobbleRequest *request) { request->deleteLater(); });
+    QObject::connect(&*scrobble_request_, &SubsonicScrobbleRequest::ScrobbleRequestFinished, this, &SubsonicService::ScrobbleRequestFinished);
   }
 
   scrobble_request_->CreateScrobbleRequest(song_id, submission, time);
@@ -447,10 +453,65 @@ void SubsonicService::GetSongs() {
 
 void SubsonicService::DeleteSongs() {
 
+  SaveAlbumSignatures(QMap<QString, QString>());
   collection_backend_->DeleteAllAsync();
 
 }
 
+QMap<QString, QString> SubsonicService::AlbumSignatures() const {
+
+  SharedPtr<Database> database = app_->database();
+  QMutexLocker l(database->Mutex());
+  QSqlDatabase db(database->Connect());
+
+  SqlQuery q(db);
+  q.prepare(QStringLiteral("SELECT album_id, signature FROM subsonic_albums"));
+  if (!q.Exec()) {
+    database->ReportErrors(q);
+    return QMap<QString, QString>();
+  }
+
+  QMap<QString, QString> album_signatures;
+  while (q.next()) {
+    album_signatures.insert(q.value(0).toString(), q.value(1).toString());
+  }
+
+  return album_signatures;
+
+}
+
+void SubsonicService::SaveAlbumSignatures(const QMap<QString, QString> &album_signatures) {
+
+  SharedPtr<Database> database = app_->database();
+  QMutexLocker l(database->Mutex());
+  QSqlDatabase db(database->Connect());
+
+  ScopedTransaction transaction(&db);
+
+  {
+    SqlQuery q(db);
+    q.prepare(QStringLiteral("DELETE FROM subsonic_albums"));
+    if (!q.Exec()) {
+      database->ReportErrors(q);
+      return;
+    }
+  }
+
+  for (QMap<QString, QString>::const_iterator it = album_signatures.constBegin(); it != album_signatures.constEnd(); ++it) {
+    SqlQuery q(db);
+    q.prepare(QStringLiteral("INSERT INTO subsonic_albums (album_id, signature) VALUES (:album_id, :signature)"));
+    q.BindValue(QStringLiteral(":album_id"), it.key());
+    q.BindValue(QStringLiteral(":signature"), it.value());
+    if (!q.Exec()) {
+      database->ReportErrors(q);
+      return;
+    }
+  }
+
+  transaction.Commit();
+
+}
+
 void SubsonicService::SongsResultsReceived(const SongMap &songs, const QString &error) {
 
   emit SongsResults(songs, error);
@@ -27,6 +27,7 @@
 #include <QSet>
 #include <QList>
 #include <QMap>
+#include <QMap>
 #include <QVariant>
 #include <QByteArray>
 #include <QString>
@@ -74,6 +75,7 @@ class SubsonicService : public InternetService {
   bool http2() const { return http2_; }
   bool verify_certificate() const { return verify_certificate_; }
   bool download_album_covers() const { return download_album_covers_; }
+  bool incremental_sync() const { return incremental_sync_; }
   SubsonicSettingsPage::AuthMethod auth_method() const { return auth_method_; }
 
   SharedPtr<CollectionBackend> collection_backend() const { return collection_backend_; }
@@ -87,6 +89,14 @@ class SubsonicService : public InternetService {
   void CheckConfiguration();
   void Scrobble(const QString &song_id, const bool submission, const QDateTime &time);
 
+  // The signatures of the albums in the collection, used to only fetch the songs of changed albums.
+  QMap<QString, QString> AlbumSignatures() const;
+  void SaveAlbumSignatures(const QMap<QString, QString> &album_signatures);
+
+ signals:
+  // Emitted for each scrobble request with the time since the song started playing and the request latency.
+  void ScrobbleRequestFinished(const bool submission, const qint64 wait_secs, const qint64 latency_msec, const bool success);
+
  public slots:
   void ShowConfig() override;
   void SendPing();
@@ -120,6 +130,7 @@ class SubsonicService : public InternetService {
   bool http2_;
   bool verify_certificate_;
   bool download_album_covers_;
+  bool incremental_sync_;
   SubsonicSettingsPage::AuthMethod auth_method_;
 
   QStringList errors_;
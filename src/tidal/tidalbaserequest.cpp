@@ -37,13 +37,21 @@
 #include "core/logging.h"
 #include "core/shared_ptr.h"
 #include "core/networkaccessmanager.h"
+#include "internet/internetreplycache.h"
 #include "tidalservice.h"
 #include "tidalbaserequest.h"
 
+namespace {
+constexpr int kInitialConcurrentRequests = 3;
+constexpr int kMaxConcurrentRequests = 12;
+}  // namespace
+
 TidalBaseRequest::TidalBaseRequest(TidalService *service, SharedPtr<NetworkAccessManager> network, QObject *parent)
     : QObject(parent),
       service_(service),
-      network_(network) {}
+      network_(network),
+      concurrency_(kInitialConcurrentRequests, kMaxConcurrentRequests),
+      reply_cache_(nullptr) {}
 
 QNetworkReply *TidalBaseRequest::CreateRequest(const QString &ressource_name, const ParamList &params_provided) {
 
@@ -63,8 +71,11 @@ QNetworkReply *TidalBaseRequest::CreateRequest(const QString &ressource_name, co
   if (oauth() && !access_token().isEmpty()) req.setRawHeader("authorization", "Bearer " + access_token().toUtf8());
   else if (!session_id().isEmpty()) req.setRawHeader("X-Tidal-SessionId", session_id().toUtf8());
 
+  if (reply_cache_) reply_cache_->AddValidators(&req);
+
   QNetworkReply *reply = network_->get(req);
   QObject::connect(reply, &QNetworkReply::sslErrors, this, &TidalBaseRequest::HandleSSLErrors);
+  concurrency_.ReplyStarted(reply);
 
   //qLog(Debug) << "Tidal: Sending request" << url;
 
@@ -72,6 +83,14 @@ QNetworkReply *TidalBaseRequest::CreateRequest(const QString &ressource_name, co
 
 }
 
+bool TidalBaseRequest::ReplyThrottled(QNetworkReply *reply) {
+
+  concurrency_.ReplyFinished(reply);
+
+  return InternetRequestConcurrency::IsThrottled(reply);
+
+}
+
 void TidalBaseRequest::HandleSSLErrors(const QList<QSslError> &ssl_errors) {
 
   for (const QSslError &ssl_error : ssl_errors) {
@@ -82,10 +101,16 @@ void TidalBaseRequest::HandleSSLErrors(const QList<QSslError> &ssl_errors) {
 
 QByteArray TidalBaseRequest::GetReplyData(QNetworkReply *reply, const bool send_login) {
 
+  concurrency_.ReplyFinished(reply);
+
   QByteArray data;
 
   if (reply->error() == QNetworkReply::NoError && reply->attribute(QNetworkRequest::HttpStatusCodeAttribute).toInt() == 200) {
     data = reply->readAll();
+    if (reply_cache_) reply_cache_->Store(reply, data);
+  }
+  else if (reply_cache_ && reply->error() == QNetworkReply::NoError && reply_cache_->NotModified(reply, &data)) {
+    // The page is unchanged since the last refresh, the cached data is used.
   }
   else {
     if (reply->error() != QNetworkReply::NoError && reply->error() < 200) {
@@ -147,27 +172,39 @@ QByteArray TidalBaseRequest::GetReplyData(QNetworkReply *reply, const bool send_
 
 QJsonObject TidalBaseRequest::ExtractJsonObj(const QByteArray &data) {
 
+  QString error;
+  QJsonObject json_obj = ParseJsonObj(data, &error);
+  if (!error.isEmpty()) {
+    Error(error, data);
+  }
+
+  return json_obj;
+
+}
+
+QJsonObject TidalBaseRequest::ParseJsonObj(const QByteArray &data, QString *error) {
+
   QJsonParseError json_error;
   QJsonDocument json_doc = QJsonDocument::fromJson(data, &json_error);
 
   if (json_error.error != QJsonParseError::NoError) {
-    Error(QStringLiteral("Reply from server missing Json data."), data);
+    *error = QStringLiteral("Reply from server missing Json data.");
     return QJsonObject();
   }
 
   if (json_doc.isEmpty()) {
-    Error(QStringLiteral("Received empty Json document."), data);
+    *error = QStringLiteral("Received empty Json document.");
     return QJsonObject();
   }
 
   if (!json_doc.isObject()) {
-    Error(QStringLiteral("Json document is not an object."), json_doc);
+    *error = QStringLiteral("Json document is not an object.");
     return QJsonObject();
   }
 
   QJsonObject json_obj = json_doc.object();
   if (json_obj.isEmpty()) {
-    Error(QStringLiteral("Received empty Json object."), json_doc);
+    *error = QStringLiteral("Received empty Json object.");
     return QJsonObject();
   }
 
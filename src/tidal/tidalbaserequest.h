@@ -37,10 +37,12 @@
 #include <QJsonValue>
 
 #include "core/shared_ptr.h"
+#include "internet/internetrequestconcurrency.h"
 #include "tidalservice.h"
 
 class QNetworkReply;
 class NetworkAccessManager;
+class InternetReplyCache;
 
 class TidalBaseRequest : public QObject {
   Q_OBJECT
@@ -66,9 +68,18 @@ class TidalBaseRequest : public QObject {
   QNetworkReply *CreateRequest(const QString &ressource_name, const ParamList &params_provided);
   QByteArray GetReplyData(QNetworkReply *reply, const bool send_login);
   QJsonObject ExtractJsonObj(const QByteArray &data);
+  // Thread safe version of ExtractJsonObj, the error is returned instead of reported.
+  static QJsonObject ParseJsonObj(const QByteArray &data, QString *error);
   QJsonValue ExtractItems(const QByteArray &data);
   QJsonValue ExtractItems(const QJsonObject &json_obj);
 
+  // The number of requests to keep in flight, it adapts to how fast the server replies.
+  int max_concurrent_requests() const { return concurrency_.limit(); }
+  // Returns true if the request should be sent again, the reply data is not read then.
+  bool ReplyThrottled(QNetworkReply *reply);
+  // Requests are sent with the validators of the cached replies, and unchanged replies are read from the cache.
+  void set_reply_cache(InternetReplyCache *reply_cache) { reply_cache_ = reply_cache; }
+
   virtual void Error(const QString &error, const QVariant &debug = QVariant()) = 0;
   static QString ErrorsToHTML(const QStringList &errors);
 
@@ -103,6 +114,8 @@ class TidalBaseRequest : public QObject {
  private:
   TidalService *service_;
   SharedPtr<NetworkAccessManager> network_;
+  InternetRequestConcurrency concurrency_;
+  InternetReplyCache *reply_cache_;
 };
 
 #endif  // TIDALBASEREQUEST_H
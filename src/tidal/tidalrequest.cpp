@@ -22,17 +22,17 @@
 #include <QObject>
 #include <QList>
 #include <QByteArray>
-#include <QByteArrayList>
 #include <QString>
 #include <QUrl>
-#include <QImage>
-#include <QImageReader>
 #include <QNetworkRequest>
 #include <QNetworkReply>
 #include <QJsonObject>
 #include <QJsonArray>
 #include <QJsonValue>
 #include <QTimer>
+#include <QFuture>
+#include <QFutureWatcher>
+#include <QtConcurrentRun>
 
 #include "core/logging.h"
 #include "core/shared_ptr.h"
@@ -40,8 +40,8 @@
 #include "core/song.h"
 #include "core/application.h"
 #include "utilities/timeconstants.h"
-#include "utilities/imageutils.h"
 #include "utilities/coverutils.h"
+#include "internet/internetcoverdownloader.h"
 #include "tidalservice.h"
 #include "tidalurlhandler.h"
 #include "tidalbaserequest.h"
@@ -49,12 +49,6 @@
 
 namespace {
 constexpr char kResourcesUrl[] = "https://resources.tidal.com";
-constexpr int kMaxConcurrentArtistsRequests = 3;
-constexpr int kMaxConcurrentAlbumsRequests = 3;
-constexpr int kMaxConcurrentSongsRequests = 3;
-constexpr int kMaxConcurrentArtistAlbumsRequests = 3;
-constexpr int kMaxConcurrentAlbumSongsRequests = 3;
-constexpr int kMaxConcurrentAlbumCoverRequests = 1;
 constexpr int kFlushRequestsDelay = 200;
 }  // namespace
 
@@ -70,39 +64,28 @@ TidalRequest::TidalRequest(TidalService *service, TidalUrlHandler *url_handler,
       coversize_(service->coversize()),
       query_id_(-1),
       finished_(false),
-      artists_requests_total_(0),
-      artists_requests_active_(0),
-      artists_requests_received_(0),
       artists_total_(0),
       artists_received_(0),
-      albums_requests_total_(0),
-      albums_requests_active_(0),
-      albums_requests_received_(0),
       albums_total_(0),
       albums_received_(0),
-      songs_requests_total_(0),
-      songs_requests_active_(0),
-      songs_requests_received_(0),
       songs_total_(0),
       songs_received_(0),
-      artist_albums_requests_total_(),
-      artist_albums_requests_active_(0),
-      artist_albums_requests_received_(0),
+      songs_pages_parsing_(0),
       artist_albums_total_(0),
       artist_albums_received_(0),
-      album_songs_requests_active_(0),
-      album_songs_requests_received_(0),
-      album_songs_requests_total_(0),
       album_songs_total_(0),
       album_songs_received_(0),
-      album_covers_requests_total_(0),
-      album_covers_requests_active_(0),
-      album_covers_requests_received_(0),
+      album_covers_total_(0),
+      album_covers_received_(0),
       need_login_(false) {
 
   timer_flush_requests_->setInterval(kFlushRequestsDelay);
   timer_flush_requests_->setSingleShot(false);
   QObject::connect(timer_flush_requests_, &QTimer::timeout, this, &TidalRequest::FlushRequests);
+  QObject::connect(&*app_->internet_cover_downloader(), &InternetCoverDownloader::Finished, this, &TidalRequest::AlbumCoverReceived);
+
+  // Refreshing the favourites only downloads the pages that changed.
+  if (IsQuery()) set_reply_cache(service->reply_cache());
 
 }
 
@@ -115,11 +98,9 @@ TidalRequest::~TidalRequest() {
     reply->deleteLater();
   }
 
-  while (!album_cover_replies_.isEmpty()) {
-    QNetworkReply *reply = album_cover_replies_.takeFirst();
-    QObject::disconnect(reply, nullptr, this, nullptr);
-    if (reply->isRunning()) reply->abort();
-    reply->deleteLater();
+  const QList<quint64> album_cover_downloads = album_cover_downloads_.keys();
+  for (const quint64 id : album_cover_downloads) {
+    app_->internet_cover_downloader()->Cancel(id);
   }
 
 }
@@ -183,36 +164,31 @@ void TidalRequest::StartRequests() {
 
 void TidalRequest::FlushRequests() {
 
-  if (!artists_requests_queue_.isEmpty()) {
+  if (!artists_requests_.isEmpty()) {
     FlushArtistsRequests();
     return;
   }
 
-  if (!albums_requests_queue_.isEmpty()) {
+  if (!albums_requests_.isEmpty()) {
     FlushAlbumsRequests();
     return;
   }
 
-  if (!artist_albums_requests_queue_.isEmpty()) {
+  if (!artist_albums_requests_.isEmpty()) {
     FlushArtistAlbumsRequests();
     return;
   }
 
-  if (!album_songs_requests_queue_.isEmpty()) {
+  if (!album_songs_requests_.isEmpty()) {
     FlushAlbumSongsRequests();
     return;
   }
 
-  if (!songs_requests_queue_.isEmpty()) {
+  if (!songs_requests_.isEmpty()) {
     FlushSongsRequests();
     return;
   }
 
-  if (!album_cover_requests_queue_.isEmpty()) {
-    FlushAlbumCoverRequests();
-    return;
-  }
-
   timer_flush_requests_->stop();
 
 }
@@ -235,9 +211,7 @@ void TidalRequest::AddArtistsRequest(const int offset, const int limit) {
   Request request;
   request.limit = limit;
   request.offset = offset;
-  artists_requests_queue_.enqueue(request);
-
-  ++artists_requests_total_;
+  artists_requests_.Enqueue(request);
 
   StartRequests();
 
@@ -245,10 +219,7 @@ void TidalRequest::AddArtistsRequest(const int offset, const int limit) {
 
 void TidalRequest::FlushArtistsRequests() {
 
-  while (!artists_requests_queue_.isEmpty() && artists_requests_active_ < kMaxConcurrentArtistsRequests) {
-
-    Request request = artists_requests_queue_.dequeue();
-
+  artists_requests_.Flush(max_concurrent_requests(), [this](const Request &request) -> QNetworkReply* {
     ParamList parameters;
     if (query_type_ == QueryType::SearchArtists) parameters << Param(QStringLiteral("query"), search_text_);
     if (request.limit > 0) parameters << Param(QStringLiteral("limit"), QString::number(request.limit));
@@ -260,13 +231,11 @@ void TidalRequest::FlushArtistsRequests() {
     if (query_type_ == QueryType::SearchArtists) {
       reply = CreateRequest(QStringLiteral("search/artists"), parameters);
     }
-    if (!reply) continue;
+    if (!reply) return nullptr;
     replies_ << reply;
     QObject::connect(reply, &QNetworkReply::finished, this, [this, reply, request]() { ArtistsReplyReceived(reply, request.limit, request.offset); });
-
-    ++artists_requests_active_;
-
-  }
+    return reply;
+  });
 
 }
 
@@ -283,9 +252,7 @@ void TidalRequest::AddAlbumsRequest(const int offset, const int limit) {
   Request request;
   request.limit = limit;
   request.offset = offset;
-  albums_requests_queue_.enqueue(request);
-
-  ++albums_requests_total_;
+  albums_requests_.Enqueue(request);
 
   StartRequests();
 
@@ -293,10 +260,7 @@ void TidalRequest::AddAlbumsRequest(const int offset, const int limit) {
 
 void TidalRequest::FlushAlbumsRequests() {
 
-  while (!albums_requests_queue_.isEmpty() && albums_requests_active_ < kMaxConcurrentAlbumsRequests) {
-
-    Request request = albums_requests_queue_.dequeue();
-
+  albums_requests_.Flush(max_concurrent_requests(), [this](const Request &request) -> QNetworkReply* {
     ParamList parameters;
     if (query_type_ == QueryType::SearchAlbums) parameters << Param(QStringLiteral("query"), search_text_);
     if (request.limit > 0) parameters << Param(QStringLiteral("limit"), QString::number(request.limit));
@@ -308,13 +272,11 @@ void TidalRequest::FlushAlbumsRequests() {
     if (query_type_ == QueryType::SearchAlbums) {
       reply = CreateRequest(QStringLiteral("search/albums"), parameters);
     }
-    if (!reply) continue;
+    if (!reply) return nullptr;
     replies_ << reply;
     QObject::connect(reply, &QNetworkReply::finished, this, [this, reply, request]() { AlbumsReplyReceived(reply, request.limit, request.offset); });
-
-    ++albums_requests_active_;
-
-  }
+    return reply;
+  });
 
 }
 
@@ -331,9 +293,7 @@ void TidalRequest::AddSongsRequest(const int offset, const int limit) {
   Request request;
   request.limit = limit;
   request.offset = offset;
-  songs_requests_queue_.enqueue(request);
-
-  ++songs_requests_total_;
+  songs_requests_.Enqueue(request);
 
   StartRequests();
 
@@ -341,10 +301,7 @@ void TidalRequest::AddSongsRequest(const int offset, const int limit) {
 
 void TidalRequest::FlushSongsRequests() {
 
-  while (!songs_requests_queue_.isEmpty() && songs_requests_active_ < kMaxConcurrentSongsRequests) {
-
-    Request request = songs_requests_queue_.dequeue();
-
+  songs_requests_.Flush(max_concurrent_requests(), [this](const Request &request) -> QNetworkReply* {
     ParamList parameters;
     if (query_type_ == QueryType::SearchSongs) parameters << Param(QStringLiteral("query"), search_text_);
     if (request.limit > 0) parameters << Param(QStringLiteral("limit"), QString::number(request.limit));
@@ -356,13 +313,11 @@ void TidalRequest::FlushSongsRequests() {
     if (query_type_ == QueryType::SearchSongs) {
       reply = CreateRequest(QStringLiteral("search/tracks"), parameters);
     }
-    if (!reply) continue;
+    if (!reply) return nullptr;
     replies_ << reply;
     QObject::connect(reply, &QNetworkReply::finished, this, [this, reply, request]() { SongsReplyReceived(reply, request.limit, request.offset); });
-
-    ++songs_requests_active_;
-
-  }
+    return reply;
+  });
 
 }
 
@@ -408,8 +363,27 @@ void TidalRequest::AddSongsSearchRequest(const int offset) {
 
 }
 
+template<typename T>
+bool TidalRequest::RetryRequest(QNetworkReply *reply, InternetRequestQueue<T> *queue) {
+
+  if (finished_ || !replies_.contains(reply) || !ReplyThrottled(reply) || !queue->Retry(reply)) return false;
+
+  qLog(Debug) << "Tidal: Request throttled, retrying" << reply->url();
+
+  replies_.removeAll(reply);
+  QObject::disconnect(reply, nullptr, this, nullptr);
+  reply->deleteLater();
+
+  StartRequests();
+
+  return true;
+
+}
+
 void TidalRequest::ArtistsReplyReceived(QNetworkReply *reply, const int limit_requested, const int offset_requested) {
 
+  if (RetryRequest(reply, &artists_requests_)) return;
+
   if (!replies_.contains(reply)) return;
   replies_.removeAll(reply);
   QObject::disconnect(reply, nullptr, this, nullptr);
@@ -417,8 +391,7 @@ void TidalRequest::ArtistsReplyReceived(QNetworkReply *reply, const int limit_re
 
   QByteArray data = GetReplyData(reply, (offset_requested == 0));
 
-  --artists_requests_active_;
-  ++artists_requests_received_;
+  artists_requests_.ReplyReceived(reply);
 
   if (finished_) return;
 
@@ -537,7 +510,7 @@ void TidalRequest::ArtistsFinishCheck(const int limit, const int offset, const i
     }
   }
 
-  if (artists_requests_queue_.isEmpty() && artists_requests_active_ <= 0) {  // Artist query is finished, get all albums for all artists.
+  if (artists_requests_.isEmpty() && artists_requests_.active() <= 0) {  // Artist query is finished, get all albums for all artists.
 
     // Get artist albums
     QList<ArtistAlbumsRequest> requests = artist_albums_requests_pending_.values();
@@ -546,9 +519,9 @@ void TidalRequest::ArtistsFinishCheck(const int limit, const int offset, const i
     }
     artist_albums_requests_pending_.clear();
 
-    if (artist_albums_requests_total_ > 0) {
-      if (artist_albums_requests_total_ == 1) emit UpdateStatus(query_id_, tr("Receiving albums for %1 artist...").arg(artist_albums_requests_total_));
-      else emit UpdateStatus(query_id_, tr("Receiving albums for %1 artists...").arg(artist_albums_requests_total_));
+    if (artist_albums_requests_.total() > 0) {
+      if (artist_albums_requests_.total() == 1) emit UpdateStatus(query_id_, tr("Receiving albums for %1 artist...").arg(artist_albums_requests_.total()));
+      else emit UpdateStatus(query_id_, tr("Receiving albums for %1 artists...").arg(artist_albums_requests_.total()));
       emit UpdateProgress(query_id_, 0);
     }
 
@@ -560,8 +533,9 @@ void TidalRequest::ArtistsFinishCheck(const int limit, const int offset, const i
 
 void TidalRequest::AlbumsReplyReceived(QNetworkReply *reply, const int limit_requested, const int offset_requested) {
 
-  --albums_requests_active_;
-  ++albums_requests_received_;
+  if (RetryRequest(reply, &albums_requests_)) return;
+
+  albums_requests_.ReplyReceived(reply);
   AlbumsReceived(reply, Artist(), limit_requested, offset_requested, offset_requested == 0);
 
 }
@@ -571,9 +545,7 @@ void TidalRequest::AddArtistAlbumsRequest(const Artist &artist, const int offset
   ArtistAlbumsRequest request;
   request.artist = artist;
   request.offset = offset;
-  artist_albums_requests_queue_.enqueue(request);
-
-  ++artist_albums_requests_total_;
+  artist_albums_requests_.Enqueue(request);
 
   StartRequests();
 
@@ -581,27 +553,23 @@ void TidalRequest::AddArtistAlbumsRequest(const Artist &artist, const int offset
 
 void TidalRequest::FlushArtistAlbumsRequests() {
 
-  while (!artist_albums_requests_queue_.isEmpty() && artist_albums_requests_active_ < kMaxConcurrentArtistAlbumsRequests) {
-
-    const ArtistAlbumsRequest request = artist_albums_requests_queue_.dequeue();
-
+  artist_albums_requests_.Flush(max_concurrent_requests(), [this](const ArtistAlbumsRequest &request) -> QNetworkReply* {
     ParamList parameters;
     if (request.offset > 0) parameters << Param(QStringLiteral("offset"), QString::number(request.offset));
     QNetworkReply *reply = CreateRequest(QStringLiteral("artists/%1/albums").arg(request.artist.artist_id), parameters);
     QObject::connect(reply, &QNetworkReply::finished, this, [this, reply, request]() { ArtistAlbumsReplyReceived(reply, request.artist, request.offset); });
     replies_ << reply;
-
-    ++artist_albums_requests_active_;
-
-  }
+    return reply;
+  });
 
 }
 
 void TidalRequest::ArtistAlbumsReplyReceived(QNetworkReply *reply, const Artist &artist, const int offset_requested) {
 
-  --artist_albums_requests_active_;
-  ++artist_albums_requests_received_;
-  emit UpdateProgress(query_id_, GetProgress(artist_albums_requests_received_, artist_albums_requests_total_));
+  if (RetryRequest(reply, &artist_albums_requests_)) return;
+
+  artist_albums_requests_.ReplyReceived(reply);
+  emit UpdateProgress(query_id_, artist_albums_requests_.progress());
   AlbumsReceived(reply, artist, 0, offset_requested, false);
 
 }
@@ -800,12 +768,12 @@ void TidalRequest::AlbumsFinishCheck(const Artist &artist, const int limit, cons
   }
 
   if (
-      artists_requests_queue_.isEmpty() &&
-      artists_requests_active_ <= 0 &&
-      albums_requests_queue_.isEmpty() &&
-      albums_requests_active_ <= 0 &&
-      artist_albums_requests_queue_.isEmpty() &&
-      artist_albums_requests_active_ <= 0
+      artists_requests_.isEmpty() &&
+      artists_requests_.active() <= 0 &&
+      albums_requests_.isEmpty() &&
+      albums_requests_.active() <= 0 &&
+      artist_albums_requests_.isEmpty() &&
+      artist_albums_requests_.active() <= 0
       ) { // Artist albums query is finished, get all songs for all albums.
 
     // Get songs for all the albums.
@@ -816,9 +784,9 @@ void TidalRequest::AlbumsFinishCheck(const Artist &artist, const int limit, cons
     }
     album_songs_requests_pending_.clear();
 
-    if (album_songs_requests_total_ > 0) {
-      if (album_songs_requests_total_ == 1) emit UpdateStatus(query_id_, tr("Receiving songs for %1 album...").arg(album_songs_requests_total_));
-      else emit UpdateStatus(query_id_, tr("Receiving songs for %1 albums...").arg(album_songs_requests_total_));
+    if (album_songs_requests_.total() > 0) {
+      if (album_songs_requests_.total() == 1) emit UpdateStatus(query_id_, tr("Receiving songs for %1 album...").arg(album_songs_requests_.total()));
+      else emit UpdateStatus(query_id_, tr("Receiving songs for %1 albums...").arg(album_songs_requests_.total()));
       emit UpdateProgress(query_id_, 0);
     }
   }
@@ -830,8 +798,9 @@ void TidalRequest::AlbumsFinishCheck(const Artist &artist, const int limit, cons
 
 void TidalRequest::SongsReplyReceived(QNetworkReply *reply, const int limit_requested, const int offset_requested) {
 
-  --songs_requests_active_;
-  ++songs_requests_received_;
+  if (RetryRequest(reply, &songs_requests_)) return;
+
+  songs_requests_.ReplyReceived(reply);
   if (query_type_ == QueryType::SearchSongs && fetchalbums_) {
     AlbumsReceived(reply, Artist(), limit_requested, offset_requested, offset_requested == 0);
   }
@@ -847,9 +816,7 @@ void TidalRequest::AddAlbumSongsRequest(const Artist &artist, const Album &album
   request.artist = artist;
   request.album = album;
   request.offset = offset;
-  album_songs_requests_queue_.enqueue(request);
-
-  ++album_songs_requests_total_;
+  album_songs_requests_.Enqueue(request);
 
   StartRequests();
 
@@ -857,27 +824,24 @@ void TidalRequest::AddAlbumSongsRequest(const Artist &artist, const Album &album
 
 void TidalRequest::FlushAlbumSongsRequests() {
 
-  while (!album_songs_requests_queue_.isEmpty() && album_songs_requests_active_ < kMaxConcurrentAlbumSongsRequests) {
-
-    AlbumSongsRequest request = album_songs_requests_queue_.dequeue();
+  album_songs_requests_.Flush(max_concurrent_requests(), [this](const AlbumSongsRequest &request) -> QNetworkReply* {
     ParamList parameters;
     if (request.offset > 0) parameters << Param(QStringLiteral("offset"), QString::number(request.offset));
     QNetworkReply *reply = CreateRequest(QStringLiteral("albums/%1/tracks").arg(request.album.album_id), parameters);
     replies_ << reply;
     QObject::connect(reply, &QNetworkReply::finished, this, [this, reply, request]() { AlbumSongsReplyReceived(reply, request.artist, request.album, request.offset); });
-
-    ++album_songs_requests_active_;
-
-  }
+    return reply;
+  });
 
 }
 
 void TidalRequest::AlbumSongsReplyReceived(QNetworkReply *reply, const Artist &artist, const Album &album, const int offset_requested) {
 
-  --album_songs_requests_active_;
-  ++album_songs_requests_received_;
+  if (RetryRequest(reply, &album_songs_requests_)) return;
+
+  album_songs_requests_.ReplyReceived(reply);
   if (offset_requested == 0) {
-    emit UpdateProgress(query_id_, GetProgress(album_songs_requests_received_, album_songs_requests_total_));
+    emit UpdateProgress(query_id_, album_songs_requests_.progress());
   }
   SongsReceived(reply, artist, album, 0, offset_requested, false);
 
@@ -899,51 +863,62 @@ void TidalRequest::SongsReceived(QNetworkReply *reply, const Artist &artist, con
     return;
   }
 
-  QJsonObject json_obj = ExtractJsonObj(data);
+  // Pages can have thousands of songs, so they're parsed in another thread.
+  ++songs_pages_parsing_;
+  QFuture<SongsPage> future = QtConcurrent::run(&TidalRequest::ParseSongsPage, data, artist, album, offset_requested, url_handler_->scheme(), coversize_);
+  QFutureWatcher<SongsPage> *watcher = new QFutureWatcher<SongsPage>(this);
+  QObject::connect(watcher, &QFutureWatcher<SongsPage>::finished, this, [this, watcher, artist, album, limit_requested, offset_requested]() {
+    SongsPageParsed(watcher->result(), artist, album, limit_requested, offset_requested);
+    watcher->deleteLater();
+  });
+  watcher->setFuture(future);
+
+}
+
+TidalRequest::SongsPage TidalRequest::ParseSongsPage(const QByteArray &data, const Artist &artist, const Album &album, const int offset_requested, const QString &scheme, const QString &coversize) {
+
+  SongsPage page;
+
+  QString error;
+  QJsonObject json_obj = ParseJsonObj(data, &error);
   if (json_obj.isEmpty()) {
-    SongsFinishCheck(artist, album, limit_requested, offset_requested);
-    return;
+    page.errors << ParseError(error, data);
+    return page;
   }
 
   if (!json_obj.contains(QStringLiteral("limit")) ||
       !json_obj.contains(QStringLiteral("offset")) ||
       !json_obj.contains(QStringLiteral("totalNumberOfItems")) ||
       !json_obj.contains(QStringLiteral("items"))) {
-    Error(QStringLiteral("Json object missing values."), json_obj);
-    SongsFinishCheck(artist, album, limit_requested, offset_requested);
-    return;
+    page.errors << ParseError(QStringLiteral("Json object missing values."), json_obj);
+    return page;
   }
 
   //int limit = json_obj["limit"].toInt();
   int offset = json_obj[QStringLiteral("offset")].toInt();
-  int songs_total = json_obj[QStringLiteral("totalNumberOfItems")].toInt();
+  page.songs_total = json_obj[QStringLiteral("totalNumberOfItems")].toInt();
 
   if (offset != offset_requested) {
-    Error(QStringLiteral("Offset returned does not match offset requested! %1 != %2").arg(offset).arg(offset_requested));
-    SongsFinishCheck(artist, album, limit_requested, offset_requested, songs_total, 0);
-    return;
+    page.errors << ParseError(QStringLiteral("Offset returned does not match offset requested! %1 != %2").arg(offset).arg(offset_requested), QVariant());
+    return page;
   }
 
-  QJsonValue json_value = ExtractItems(json_obj);
+  QJsonValue json_value = json_obj[QStringLiteral("items")];
   if (!json_value.isArray()) {
-    SongsFinishCheck(artist, album, limit_requested, offset_requested, songs_total, 0);
-    return;
+    return page;
   }
 
   QJsonArray array_items = json_value.toArray();
   if (array_items.isEmpty()) {
-    SongsFinishCheck(artist, album, limit_requested, offset_requested, songs_total, 0);
-    return;
+    return page;
   }
 
   bool compilation = false;
   bool multidisc = false;
-  SongList songs;
-  int songs_received = 0;
   for (const QJsonValueRef value_item : array_items) {
 
     if (!value_item.isObject()) {
-      Error(QStringLiteral("Invalid Json reply, track is not a object."));
+      page.errors << ParseError(QStringLiteral("Invalid Json reply, track is not a object."), QVariant());
       continue;
     }
     QJsonObject obj_item = value_item.toObject();
@@ -951,33 +926,61 @@ void TidalRequest::SongsReceived(QNetworkReply *reply, const Artist &artist, con
     if (obj_item.contains(QStringLiteral("item"))) {
       QJsonValue item = obj_item[QStringLiteral("item")];
       if (!item.isObject()) {
-        Error(QStringLiteral("Invalid Json reply, item is not a object."), item);
+        page.errors << ParseError(QStringLiteral("Invalid Json reply, item is not a object."), item);
         continue;
       }
       obj_item = item.toObject();
     }
 
-    ++songs_received;
+    ++page.songs_received;
     Song song(Song::Source::Tidal);
-    ParseSong(song, obj_item, artist, album);
+    ParseSong(song, obj_item, artist, album, scheme, coversize, &page.errors);
     if (!song.is_valid()) continue;
     if (song.disc() >= 2) multidisc = true;
     if (song.is_compilation()) compilation = true;
-    songs << song;
+    page.songs << song;
   }
 
-  for (Song song : songs) {
+  for (Song &song : page.songs) {
     if (compilation) song.set_compilation_detected(true);
     if (!multidisc) song.set_disc(0);
+  }
+
+  return page;
+
+}
+
+void TidalRequest::SongsPageParsed(const SongsPage &page, const Artist &artist, const Album &album, const int limit_requested, const int offset_requested) {
+
+  if (finished_) {
+    --songs_pages_parsing_;
+    return;
+  }
+
+  SongMap songs;
+  for (const Song &song : page.songs) {
+    songs.insert(song.song_id(), song);
     songs_.insert(song.song_id(), song);
   }
 
-  if (query_type_ == QueryType::Songs || query_type_ == QueryType::SearchSongs) {
-    songs_received_ += songs_received;
+  // Search results are shown while the rest of the pages are received.
+  if (IsSearch() && !songs.isEmpty()) {
+    emit PartialResults(query_id_, songs);
+  }
+
+  if (page.songs_received > 0 && (query_type_ == QueryType::Songs || query_type_ == QueryType::SearchSongs)) {
+    songs_received_ += page.songs_received;
     emit UpdateProgress(query_id_, GetProgress(songs_received_, songs_total_));
   }
 
-  SongsFinishCheck(artist, album, limit_requested, offset_requested, songs_total, songs_received);
+  // The page is still counted while the errors are reported, so they can't finish the request.
+  for (const ParseError &error : page.errors) {
+    Error(error.first, error.second);
+  }
+
+  --songs_pages_parsing_;
+
+  SongsFinishCheck(artist, album, limit_requested, offset_requested, page.songs_total, page.songs_received);
 
 }
 
@@ -1016,7 +1019,7 @@ void TidalRequest::SongsFinishCheck(const Artist &artist, const Album &album, co
 
 }
 
-void TidalRequest::ParseSong(Song &song, const QJsonObject &json_obj, const Artist &album_artist, const Album &album) {
+void TidalRequest::ParseSong(Song &song, const QJsonObject &json_obj, const Artist &album_artist, const Album &album, const QString &scheme, const QString &coversize, QList<ParseError> *errors) {
 
   if (
       !json_obj.contains(QStringLiteral("album")) ||
@@ -1033,7 +1036,7 @@ void TidalRequest::ParseSong(Song &song, const QJsonObject &json_obj, const Arti
       !json_obj.contains(QStringLiteral("volumeNumber")) ||
       !json_obj.contains(QStringLiteral("copyright"))
     ) {
-    Error(QStringLiteral("Invalid Json reply, track is missing one or more values."), json_obj);
+    *errors << ParseError(QStringLiteral("Invalid Json reply, track is missing one or more values."), json_obj);
     return;
   }
 
@@ -1059,12 +1062,12 @@ void TidalRequest::ParseSong(Song &song, const QJsonObject &json_obj, const Arti
   QString copyright = json_obj[QStringLiteral("copyright")].toString();
 
   if (!value_artist.isObject()) {
-    Error(QStringLiteral("Invalid Json reply, track artist is not a object."), value_artist);
+    *errors << ParseError(QStringLiteral("Invalid Json reply, track artist is not a object."), value_artist);
     return;
   }
   QJsonObject obj_artist = value_artist.toObject();
   if (!obj_artist.contains(QStringLiteral("id")) || !obj_artist.contains(QStringLiteral("name"))) {
-    Error(QStringLiteral("Invalid Json reply, track artist is missing id or name."), obj_artist);
+    *errors << ParseError(QStringLiteral("Invalid Json reply, track artist is missing id or name."), obj_artist);
     return;
   }
   QString artist_id;
@@ -1077,12 +1080,12 @@ void TidalRequest::ParseSong(Song &song, const QJsonObject &json_obj, const Arti
   QString artist = obj_artist[QStringLiteral("name")].toString();
 
   if (!value_album.isObject()) {
-    Error(QStringLiteral("Invalid Json reply, track album is not a object."), value_album);
+    *errors << ParseError(QStringLiteral("Invalid Json reply, track album is not a object."), value_album);
     return;
   }
   QJsonObject obj_album = value_album.toObject();
   if (!obj_album.contains(QStringLiteral("id")) || !obj_album.contains(QStringLiteral("title"))) {
-    Error(QStringLiteral("Invalid Json reply, track album is missing ID or title."), obj_album);
+    *errors << ParseError(QStringLiteral("Invalid Json reply, track album is missing ID or title."), obj_album);
     return;
   }
   QString album_id;
@@ -1093,7 +1096,7 @@ void TidalRequest::ParseSong(Song &song, const QJsonObject &json_obj, const Arti
     album_id = QString::number(obj_album[QStringLiteral("id")].toInt());
   }
   if (!album.album_id.isEmpty() && album.album_id != album_id) {
-    Error(QStringLiteral("Invalid Json reply, track album id is wrong."), obj_album);
+    *errors << ParseError(QStringLiteral("Invalid Json reply, track album id is wrong."), obj_album);
     return;
   }
   QString album_title = obj_album[QStringLiteral("title")].toString();
@@ -1110,7 +1113,7 @@ void TidalRequest::ParseSong(Song &song, const QJsonObject &json_obj, const Arti
   }
 
   QUrl url;
-  url.setScheme(url_handler_->scheme());
+  url.setScheme(scheme);
   url.setPath(song_id);
 
   QVariant q_duration = json_duration.toVariant();
@@ -1119,7 +1122,7 @@ void TidalRequest::ParseSong(Song &song, const QJsonObject &json_obj, const Arti
     duration = q_duration.toLongLong() * kNsecPerSec;
   }
   else {
-    Error(QStringLiteral("Invalid duration for song."), json_duration);
+    *errors << ParseError(QStringLiteral("Invalid duration for song."), json_duration);
     return;
   }
 
@@ -1127,7 +1130,7 @@ void TidalRequest::ParseSong(Song &song, const QJsonObject &json_obj, const Arti
   if (obj_album.contains(QStringLiteral("cover"))) {
     const QString cover = obj_album[QStringLiteral("cover")].toString().replace(QLatin1String("-"), QLatin1String("/"));
     if (!cover.isEmpty()) {
-      cover_url.setUrl(QStringLiteral("%1/images/%2/%3.jpg").arg(QLatin1String(kResourcesUrl), cover, coversize_));
+      cover_url.setUrl(QStringLiteral("%1/images/%2/%3.jpg").arg(QLatin1String(kResourcesUrl), cover, coversize));
     }
   }
 
@@ -1166,21 +1169,21 @@ void TidalRequest::GetAlbumCoversCheck() {
       !finished_ &&
       service_->download_album_covers() &&
       IsQuery() &&
-      artists_requests_queue_.isEmpty() &&
-      albums_requests_queue_.isEmpty() &&
-      songs_requests_queue_.isEmpty() &&
-      artist_albums_requests_queue_.isEmpty() &&
-      album_songs_requests_queue_.isEmpty() &&
-      album_cover_requests_queue_.isEmpty() &&
+      artists_requests_.isEmpty() &&
+      albums_requests_.isEmpty() &&
+      songs_requests_.isEmpty() &&
+      artist_albums_requests_.isEmpty() &&
+      album_songs_requests_.isEmpty() &&
+      album_cover_downloads_.isEmpty() &&
       artist_albums_requests_pending_.isEmpty() &&
       album_songs_requests_pending_.isEmpty() &&
       album_covers_requests_sent_.isEmpty() &&
-      artists_requests_active_ <= 0 &&
-      albums_requests_active_ <= 0 &&
-      songs_requests_active_ <= 0 &&
-      artist_albums_requests_active_ <= 0 &&
-      album_songs_requests_active_ <= 0 &&
-      album_covers_requests_active_ <= 0
+      artists_requests_.active() <= 0 &&
+      albums_requests_.active() <= 0 &&
+      songs_requests_.active() <= 0 &&
+      artist_albums_requests_.active() <= 0 &&
+      album_songs_requests_.active() <= 0 &&
+      songs_pages_parsing_ <= 0
   ) {
     GetAlbumCovers();
   }
@@ -1194,11 +1197,11 @@ void TidalRequest::GetAlbumCovers() {
     AddAlbumCoverRequest(song);
   }
 
-  if (album_covers_requests_total_ == 1) emit UpdateStatus(query_id_, tr("Receiving album cover for %1 album...").arg(album_covers_requests_total_));
-  else emit UpdateStatus(query_id_, tr("Receiving album covers for %1 albums...").arg(album_covers_requests_total_));
+  if (album_covers_total_ == 1) emit UpdateStatus(query_id_, tr("Receiving album cover for %1 album...").arg(album_covers_total_));
+  else emit UpdateStatus(query_id_, tr("Receiving album covers for %1 albums...").arg(album_covers_total_));
   emit UpdateProgress(query_id_, 0);
 
-  StartRequests();
+  AlbumCoverFinishCheck();
 
 }
 
@@ -1209,118 +1212,41 @@ void TidalRequest::AddAlbumCoverRequest(const Song &song) {
     return;
   }
 
-  AlbumCoverRequest request;
-  request.album_id = song.album_id();
-  request.url = song.art_automatic();
-  request.filename = CoverUtils::CoverFilePath(CoverOptions(), song.source(), song.effective_albumartist(), song.effective_album(), song.album_id(), QString(), request.url);
-  if (request.filename.isEmpty()) return;
+  const QUrl url = song.art_automatic();
+  const QString filename = CoverUtils::CoverFilePath(CoverOptions(), song.source(), song.effective_albumartist(), song.effective_album(), song.album_id(), QString(), url);
+  if (filename.isEmpty()) return;
 
   album_covers_requests_sent_.insert(song.album_id(), song.song_id());
-  ++album_covers_requests_total_;
 
-  album_cover_requests_queue_.enqueue(request);
-
-}
-
-void TidalRequest::FlushAlbumCoverRequests() {
-
-  while (!album_cover_requests_queue_.isEmpty() && album_covers_requests_active_ < kMaxConcurrentAlbumCoverRequests) {
-
-    AlbumCoverRequest request = album_cover_requests_queue_.dequeue();
-
-    QNetworkRequest req(request.url);
-    req.setAttribute(QNetworkRequest::RedirectPolicyAttribute, QNetworkRequest::NoLessSafeRedirectPolicy);
-    QNetworkReply *reply = network_->get(req);
-    album_cover_replies_ << reply;
-    QObject::connect(reply, &QNetworkReply::finished, this, [this, reply, request]() { AlbumCoverReceived(reply, request.album_id, request.url, request.filename); });
-
-    ++album_covers_requests_active_;
-
-  }
+  QNetworkRequest req(url);
+  req.setAttribute(QNetworkRequest::RedirectPolicyAttribute, QNetworkRequest::NoLessSafeRedirectPolicy);
+  album_cover_downloads_.insert(app_->internet_cover_downloader()->Download(req, filename), song.album_id());
+  ++album_covers_total_;
 
 }
 
-void TidalRequest::AlbumCoverReceived(QNetworkReply *reply, const QString &album_id, const QUrl &url, const QString &filename) {
+void TidalRequest::AlbumCoverReceived(const quint64 id, const QString &filename, const QString &error) {
 
-  if (album_cover_replies_.contains(reply)) {
-    album_cover_replies_.removeAll(reply);
-    QObject::disconnect(reply, nullptr, this, nullptr);
-    reply->deleteLater();
-  }
-  else {
-    AlbumCoverFinishCheck();
-    return;
-  }
+  if (!album_cover_downloads_.contains(id)) return;
 
-  --album_covers_requests_active_;
-  ++album_covers_requests_received_;
+  const QString album_id = album_cover_downloads_.take(id);
+  ++album_covers_received_;
 
   if (finished_) return;
 
-  emit UpdateProgress(query_id_, GetProgress(album_covers_requests_received_, album_covers_requests_total_));
-
-  if (!album_covers_requests_sent_.contains(album_id)) {
-    AlbumCoverFinishCheck();
-    return;
-  }
-
-  if (reply->error() != QNetworkReply::NoError) {
-    Error(QStringLiteral("%1 (%2)").arg(reply->errorString()).arg(reply->error()));
-    album_covers_requests_sent_.remove(album_id);
-    AlbumCoverFinishCheck();
-    return;
-  }
-
-  if (reply->attribute(QNetworkRequest::HttpStatusCodeAttribute).toInt() != 200) {
-    Error(QStringLiteral("Received HTTP code %1 for %2.").arg(reply->attribute(QNetworkRequest::HttpStatusCodeAttribute).toInt()).arg(url.toString()));
-    if (album_covers_requests_sent_.contains(album_id)) album_covers_requests_sent_.remove(album_id);
-    AlbumCoverFinishCheck();
-    return;
-  }
+  emit UpdateProgress(query_id_, GetProgress(album_covers_received_, album_covers_total_));
 
-  QString mimetype = reply->header(QNetworkRequest::ContentTypeHeader).toString();
-  if (mimetype.contains(QLatin1Char(';'))) {
-    mimetype = mimetype.left(mimetype.indexOf(QLatin1Char(';')));
-  }
-  if (!ImageUtils::SupportedImageMimeTypes().contains(mimetype, Qt::CaseInsensitive) && !ImageUtils::SupportedImageFormats().contains(mimetype, Qt::CaseInsensitive)) {
-    Error(QStringLiteral("Unsupported mimetype for image reader %1 for %2").arg(mimetype, url.toString()));
-    if (album_covers_requests_sent_.contains(album_id)) album_covers_requests_sent_.remove(album_id);
-    AlbumCoverFinishCheck();
-    return;
-  }
-
-  const QByteArray data = reply->readAll();
-  if (data.isEmpty()) {
-    Error(QStringLiteral("Received empty image data for %1").arg(url.toString()));
-    if (album_covers_requests_sent_.contains(album_id)) album_covers_requests_sent_.remove(album_id);
-    AlbumCoverFinishCheck();
-    return;
-  }
-
-  QByteArrayList format_list = QImageReader::imageFormatsForMimeType(mimetype.toUtf8());
-  char *format = nullptr;
-  if (!format_list.isEmpty()) {
-    format = format_list.first().data();
-  }
-
-  QImage image;
-  if (image.loadFromData(data, format)) {
-    if (image.save(filename, format)) {
-      while (album_covers_requests_sent_.contains(album_id)) {
-        const QString song_id = album_covers_requests_sent_.take(album_id);
-        if (songs_.contains(song_id)) {
-          songs_[song_id].set_art_automatic(QUrl::fromLocalFile(filename));
-        }
+  if (error.isEmpty()) {
+    while (album_covers_requests_sent_.contains(album_id)) {
+      const QString song_id = album_covers_requests_sent_.take(album_id);
+      if (songs_.contains(song_id)) {
+        songs_[song_id].set_art_automatic(QUrl::fromLocalFile(filename));
       }
     }
-    else {
-      Error(QStringLiteral("Error saving image data to %1").arg(filename));
-      if (album_covers_requests_sent_.contains(album_id)) album_covers_requests_sent_.remove(album_id);
-    }
   }
   else {
-    if (album_covers_requests_sent_.contains(album_id)) album_covers_requests_sent_.remove(album_id);
-    Error(QStringLiteral("Error decoding image data from %1").arg(url.toString()));
+    Error(error);
+    album_covers_requests_sent_.remove(album_id);
   }
 
   AlbumCoverFinishCheck();
@@ -1338,21 +1264,21 @@ void TidalRequest::FinishCheck() {
   if (
       !finished_ &&
       !need_login_ &&
-      artists_requests_queue_.isEmpty() &&
-      albums_requests_queue_.isEmpty() &&
-      songs_requests_queue_.isEmpty() &&
-      artist_albums_requests_queue_.isEmpty() &&
-      album_songs_requests_queue_.isEmpty() &&
-      album_cover_requests_queue_.isEmpty() &&
+      artists_requests_.isEmpty() &&
+      albums_requests_.isEmpty() &&
+      songs_requests_.isEmpty() &&
+      artist_albums_requests_.isEmpty() &&
+      album_songs_requests_.isEmpty() &&
+      album_cover_downloads_.isEmpty() &&
       artist_albums_requests_pending_.isEmpty() &&
       album_songs_requests_pending_.isEmpty() &&
       album_covers_requests_sent_.isEmpty() &&
-      artists_requests_active_ <= 0 &&
-      albums_requests_active_ <= 0 &&
-      songs_requests_active_ <= 0 &&
-      artist_albums_requests_active_ <= 0 &&
-      album_songs_requests_active_ <= 0 &&
-      album_covers_requests_active_ <= 0
+      artists_requests_.active() <= 0 &&
+      albums_requests_.active() <= 0 &&
+      songs_requests_.active() <= 0 &&
+      artist_albums_requests_.active() <= 0 &&
+      album_songs_requests_.active() <= 0 &&
+      songs_pages_parsing_ <= 0
   ) {
     if (timer_flush_requests_->isActive()) {
       timer_flush_requests_->stop();
@@ -30,8 +30,8 @@
 #include <QHash>
 #include <QMap>
 #include <QMultiMap>
-#include <QQueue>
 #include <QVariant>
+#include <QByteArray>
 #include <QString>
 #include <QStringList>
 #include <QUrl>
@@ -39,6 +39,7 @@
 
 #include "core/shared_ptr.h"
 #include "core/song.h"
+#include "internet/internetrequestqueue.h"
 
 #include "tidalbaserequest.h"
 
@@ -92,17 +93,20 @@ class TidalRequest : public TidalBaseRequest {
     int offset;
     int limit;
   };
-  struct AlbumCoverRequest {
-    QString artist_id;
-    QString album_id;
-    QUrl url;
-    QString filename;
+  using ParseError = QPair<QString, QVariant>;
+  struct SongsPage {
+    SongsPage() : songs_total(0), songs_received(0) {}
+    int songs_total;
+    int songs_received;
+    SongList songs;
+    QList<ParseError> errors;
   };
 
  signals:
   void LoginSuccess();
   void LoginFailure(const QString &failure_reason);
   void Results(const int id, const SongMap &songs = SongMap(), const QString &error = QString());
+  void PartialResults(const int id, const SongMap &songs);
   void UpdateStatus(const int id, const QString &text);
   void UpdateProgress(const int id, const int max);
   void StreamURLFinished(const QUrl &media_url, const QUrl &url, const Song::FileType filetype, const QString &error = QString());
@@ -118,7 +122,7 @@ class TidalRequest : public TidalBaseRequest {
 
   void ArtistAlbumsReplyReceived(QNetworkReply *reply, const Artist &artist, const int offset_requested);
   void AlbumSongsReplyReceived(QNetworkReply *reply, const Artist &artist, const Album &album, const int offset_requested);
-  void AlbumCoverReceived(QNetworkReply *reply, const QString &album_id, const QUrl &url, const QString &filename);
+  void AlbumCoverReceived(const quint64 id, const QString &filename, const QString &error);
 
  public slots:
   void LoginComplete(const bool success, const QString &error = QString());
@@ -158,14 +162,18 @@ class TidalRequest : public TidalBaseRequest {
   void AddAlbumSongsRequest(const Artist &artist, const Album &album, const int offset = 0);
   void FlushAlbumSongsRequests();
 
-  void ParseSong(Song &song, const QJsonObject &json_obj, const Artist &album_artist, const Album &album);
+  static SongsPage ParseSongsPage(const QByteArray &data, const Artist &artist, const Album &album, const int offset_requested, const QString &scheme, const QString &coversize);
+  void SongsPageParsed(const SongsPage &page, const Artist &artist, const Album &album, const int limit_requested, const int offset_requested);
+  static void ParseSong(Song &song, const QJsonObject &json_obj, const Artist &album_artist, const Album &album, const QString &scheme, const QString &coversize, QList<ParseError> *errors);
 
   void GetAlbumCoversCheck();
   void GetAlbumCovers();
   void AddAlbumCoverRequest(const Song &song);
-  void FlushAlbumCoverRequests();
   void AlbumCoverFinishCheck();
 
+  template<typename T>
+  bool RetryRequest(QNetworkReply *reply, InternetRequestQueue<T> *queue);
+
   int GetProgress(const int count, const int total);
 
   void FinishCheck();
@@ -187,57 +195,41 @@ class TidalRequest : public TidalBaseRequest {
 
   bool finished_;
 
-  QQueue<Request> artists_requests_queue_;
-  QQueue<Request> albums_requests_queue_;
-  QQueue<Request> songs_requests_queue_;
+  InternetRequestQueue<Request> artists_requests_;
+  InternetRequestQueue<Request> albums_requests_;
+  InternetRequestQueue<Request> songs_requests_;
 
-  QQueue<ArtistAlbumsRequest> artist_albums_requests_queue_;
-  QQueue<AlbumSongsRequest> album_songs_requests_queue_;
-  QQueue<AlbumCoverRequest> album_cover_requests_queue_;
+  InternetRequestQueue<ArtistAlbumsRequest> artist_albums_requests_;
+  InternetRequestQueue<AlbumSongsRequest> album_songs_requests_;
 
   QHash<QString, ArtistAlbumsRequest> artist_albums_requests_pending_;
   QHash<QString, AlbumSongsRequest> album_songs_requests_pending_;
   QMultiMap<QString, QString> album_covers_requests_sent_;
+  QHash<quint64, QString> album_cover_downloads_;
 
-  int artists_requests_total_;
-  int artists_requests_active_;
-  int artists_requests_received_;
   int artists_total_;
   int artists_received_;
 
-  int albums_requests_total_;
-  int albums_requests_active_;
-  int albums_requests_received_;
   int albums_total_;
   int albums_received_;
 
-  int songs_requests_total_;
-  int songs_requests_active_;
-  int songs_requests_received_;
   int songs_total_;
   int songs_received_;
+  int songs_pages_parsing_;
 
-  int artist_albums_requests_total_;
-  int artist_albums_requests_active_;
-  int artist_albums_requests_received_;
   int artist_albums_total_;
   int artist_albums_received_;
 
-  int album_songs_requests_active_;
-  int album_songs_requests_received_;
-  int album_songs_requests_total_;
   int album_songs_total_;
   int album_songs_received_;
 
-  int album_covers_requests_total_;
-  int album_covers_requests_active_;
-  int album_covers_requests_received_;
+  int album_covers_total_;
+  int album_covers_received_;
 
   SongMap songs_;
   QStringList errors_;
   bool need_login_;
   QList<QNetworkReply*> replies_;
-  QList<QNetworkReply*> album_cover_replies_;
 };
 
 #endif  // TIDALREQUEST_H
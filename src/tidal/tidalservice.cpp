@@ -54,6 +54,7 @@
 #include "internet/internetsearchview.h"
 #include "collection/collectionbackend.h"
 #include "collection/collectionmodel.h"
+#include "collection/collectionsortmodel.h"
 #include "tidalservice.h"
 #include "tidalurlhandler.h"
 #include "tidalbaserequest.h"
@@ -94,17 +95,18 @@ constexpr char kSongsFtsTable[] = "tidal_songs_fts";
 TidalService::TidalService(Application *app, QObject *parent)
     : InternetService(Song::Source::Tidal, QStringLiteral("Tidal"), QStringLiteral("tidal"), QLatin1String(TidalSettingsPage::kSettingsGroup), SettingsDialog::Page::Tidal, app, parent),
       app_(app),
-      network_(app->network()),
+      network_(app->services_network()),
       url_handler_(new TidalUrlHandler(app, this)),
+      reply_cache_(QStringLiteral("tidal")),
       artists_collection_backend_(nullptr),
       albums_collection_backend_(nullptr),
       songs_collection_backend_(nullptr),
       artists_collection_model_(nullptr),
       albums_collection_model_(nullptr),
       songs_collection_model_(nullptr),
-      artists_collection_sort_model_(new QSortFilterProxyModel(this)),
-      albums_collection_sort_model_(new QSortFilterProxyModel(this)),
-      songs_collection_sort_model_(new QSortFilterProxyModel(this)),
+      artists_collection_sort_model_(new CollectionSortModel(this)),
+      albums_collection_sort_model_(new CollectionSortModel(this)),
+      songs_collection_sort_model_(new CollectionSortModel(this)),
       timer_search_delay_(new QTimer(this)),
       timer_login_attempt_(new QTimer(this)),
       timer_refresh_login_(new QTimer(this)),
@@ -150,21 +152,15 @@ TidalService::TidalService(Application *app, QObject *parent)
   songs_collection_model_ = new CollectionModel(songs_collection_backend_, app_, this);
 
   artists_collection_sort_model_->setSourceModel(artists_collection_model_);
-  artists_collection_sort_model_->setSortRole(CollectionModel::Role_SortText);
   artists_collection_sort_model_->setDynamicSortFilter(true);
-  artists_collection_sort_model_->setSortLocaleAware(true);
   artists_collection_sort_model_->sort(0);
 
   albums_collection_sort_model_->setSourceModel(albums_collection_model_);
-  albums_collection_sort_model_->setSortRole(CollectionModel::Role_SortText);
   albums_collection_sort_model_->setDynamicSortFilter(true);
-  albums_collection_sort_model_->setSortLocaleAware(true);
   albums_collection_sort_model_->sort(0);
 
   songs_collection_sort_model_->setSourceModel(songs_collection_model_);
-  songs_collection_sort_model_->setSortRole(CollectionModel::Role_SortText);
   songs_collection_sort_model_->setDynamicSortFilter(true);
-  songs_collection_sort_model_->setSortLocaleAware(true);
   songs_collection_sort_model_->sort(0);
 
   // Search
@@ -679,6 +675,8 @@ void TidalService::HandleAuthReply(QNetworkReply *reply) {
 
 void TidalService::Logout() {
 
+  reply_cache_.Clear();
+
   user_id_ = 0;
   country_code_.clear();
   access_token_.clear();
@@ -771,6 +769,7 @@ void TidalService::ArtistsResultsReceived(const int id, const SongMap &songs, co
   Q_UNUSED(id);
   emit ArtistsResults(songs, error);
   ResetArtistsRequest();
+  reply_cache_.Save();
 
 }
 
@@ -826,6 +825,7 @@ void TidalService::AlbumsResultsReceived(const int id, const SongMap &songs, con
   Q_UNUSED(id);
   emit AlbumsResults(songs, error);
   ResetAlbumsRequest();
+  reply_cache_.Save();
 
 }
 
@@ -881,6 +881,7 @@ void TidalService::SongsResultsReceived(const int id, const SongMap &songs, cons
   Q_UNUSED(id);
   emit SongsResults(songs, error);
   ResetSongsRequest();
+  reply_cache_.Save();
 
 }
 
@@ -960,6 +961,7 @@ void TidalService::SendSearch() {
 
   QObject::connect(&*search_request_, &TidalRequest::RequestLogin, this, &TidalService::SendLogin);
   QObject::connect(&*search_request_, &TidalRequest::Results, this, &TidalService::SearchResultsReceived);
+  QObject::connect(&*search_request_, &TidalRequest::PartialResults, this, &TidalService::SearchPartialResults);
   QObject::connect(&*search_request_, &TidalRequest::UpdateStatus, this, &TidalService::SearchUpdateStatus);
   QObject::connect(&*search_request_, &TidalRequest::UpdateProgress, this, &TidalService::SearchUpdateProgress);
   QObject::connect(this, &TidalService::LoginComplete, &*search_request_, &TidalRequest::LoginComplete);
@@ -39,6 +39,7 @@
 #include "core/shared_ptr.h"
 #include "core/song.h"
 #include "internet/internetservice.h"
+#include "internet/internetreplycache.h"
 #include "internet/internetsearchview.h"
 #include "settings/tidalsettingspage.h"
 
@@ -104,6 +105,8 @@ class TidalService : public InternetService {
 
   uint GetStreamURL(const QUrl &url, QString &error);
 
+  InternetReplyCache *reply_cache() { return &reply_cache_; }
+
   SharedPtr<CollectionBackend> artists_collection_backend() override { return artists_collection_backend_; }
   SharedPtr<CollectionBackend> albums_collection_backend() override { return albums_collection_backend_; }
   SharedPtr<CollectionBackend> songs_collection_backend() override { return songs_collection_backend_; }
@@ -163,6 +166,7 @@ class TidalService : public InternetService {
   Application *app_;
   SharedPtr<NetworkAccessManager> network_;
   TidalUrlHandler *url_handler_;
+  InternetReplyCache reply_cache_;
 
   SharedPtr<CollectionBackend> artists_collection_backend_;
   SharedPtr<CollectionBackend> albums_collection_backend_;
@@ -25,6 +25,7 @@
 
 #include <algorithm>
 #include <memory>
+#include <ctime>
 
 #include <glib.h>
 #include <glib/gtypes.h>
@@ -41,6 +42,7 @@
 #include <QVariant>
 #include <QString>
 #include <QSettings>
+#include <QElapsedTimer>
 
 #include "core/logging.h"
 #include "core/shared_ptr.h"
@@ -52,6 +54,23 @@ using std::make_shared;
 
 int Transcoder::JobFinishedEvent::sEventType = -1;
 
+namespace {
+
+// The CPU usage is sampled over at least this long before the number of running jobs is changed.
+constexpr qint64 kMinSampleMsec = 2000;
+
+// Below this share of the CPU cores in use, the jobs are mostly waiting for I/O, for example on network shares, so more are started.
+constexpr double kIOBoundUtilisation = 0.5;
+// Above this the CPU is saturated, and more jobs than cores only compete with each other.
+constexpr double kSaturatedUtilisation = 0.9;
+
+// Process CPU time used by all threads, including the GStreamer streaming threads.
+qint64 ProcessCpuMsec() {
+  return static_cast<qint64>(std::clock()) * 1000 / CLOCKS_PER_SEC;
+}
+
+}  // namespace
+
 TranscoderPreset::TranscoderPreset(const Song::FileType filetype, const QString &name, const QString &extension, const QString &codec_mimetype, const QString &muxer_mimetype)
     : filetype_(filetype),
       name_(name),
@@ -207,7 +226,12 @@ void Transcoder::JobState::PostFinished(const bool success) {
 Transcoder::Transcoder(QObject *parent, const QString &settings_postfix)
     : QObject(parent),
       max_threads_(QThread::idealThreadCount()),
-      settings_postfix_(settings_postfix) {
+      settings_postfix_(settings_postfix),
+      running_jobs_limit_(max_threads_),
+      sample_cpu_msec_(0),
+      run_files_(0),
+      run_bytes_(0),
+      run_jobs_msec_(0) {
 
   if (JobFinishedEvent::sEventType == -1)
     JobFinishedEvent::sEventType = QEvent::registerEventType();
@@ -329,13 +353,27 @@ void Transcoder::AddJob(const QString &input, const TranscoderPreset &preset, co
   job.input = input;
   job.preset = preset;
   job.output = output;
+  job.size = QFileInfo(input).size();
   queued_jobs_ << job;
 
 }
 
 void Transcoder::Start() {
 
-  emit LogLine(tr("Transcoding %1 files using %2 threads").arg(queued_jobs_.count()).arg(max_threads()));
+  if (current_jobs_.isEmpty()) {
+    running_jobs_limit_ = qMax(1, max_threads());
+    sample_timer_.start();
+    sample_cpu_msec_ = ProcessCpuMsec();
+    run_timer_.start();
+    run_files_ = 0;
+    run_bytes_ = 0;
+    run_jobs_msec_ = 0;
+  }
+
+  // Start with the largest files, so a large file isn't left running on its own at the end.
+  std::stable_sort(queued_jobs_.begin(), queued_jobs_.end(), [](const Job &a, const Job &b) { return a.size > b.size; });
+
+  emit LogLine(tr("Transcoding %1 files using %2 threads").arg(queued_jobs_.count()).arg(running_jobs_limit_));
 
   forever {
     StartJobStatus status = MaybeStartNextJob();
@@ -346,9 +384,10 @@ void Transcoder::Start() {
 
 Transcoder::StartJobStatus Transcoder::MaybeStartNextJob() {
 
-  if (current_jobs_.count() >= max_threads()) return StartJobStatus::AllThreadsBusy;
+  if (current_jobs_.count() >= running_jobs_limit_) return StartJobStatus::AllThreadsBusy;
   if (queued_jobs_.isEmpty()) {
     if (current_jobs_.isEmpty()) {
+      LogSummary();
       emit AllJobsComplete();
     }
 
@@ -465,6 +504,7 @@ bool Transcoder::StartJob(const Job &job) {
   gst_bus_set_sync_handler(gst_pipeline_get_bus(GST_PIPELINE(state->pipeline_)), BusCallbackSync, state.get(), nullptr);
 
   // Start the pipeline
+  state->timer_.start();
   gst_element_set_state(state->pipeline_, GST_STATE_PLAYING);
 
   // GStreamer now transcodes in another thread, so we can return now and do something else.
@@ -502,6 +542,12 @@ bool Transcoder::event(QEvent *e) {
     QString input = (*it)->job_.input;
     QString output = (*it)->job_.output;
 
+    ++run_files_;
+    run_jobs_msec_ += (*it)->timer_.elapsed();
+    if (finished_event->success_) run_bytes_ += (*it)->job_.size;
+
+    AdaptRunningJobs();
+
     // Remove event handlers from the gstreamer pipeline, so they don't get called after the pipeline is shutting down
     gst_bus_set_sync_handler(gst_pipeline_get_bus(GST_PIPELINE(finished_event->state_->pipeline_)), nullptr, nullptr, nullptr);
 
@@ -512,7 +558,10 @@ bool Transcoder::event(QEvent *e) {
     emit JobComplete(input, output, finished_event->success_);
 
     // Start some more jobs
-    MaybeStartNextJob();
+    forever {
+      const StartJobStatus status = MaybeStartNextJob();
+      if (status == StartJobStatus::AllThreadsBusy || status == StartJobStatus::NoMoreJobs) break;
+    }
 
     return true;
   }
@@ -521,6 +570,54 @@ bool Transcoder::event(QEvent *e) {
 
 }
 
+void Transcoder::AdaptRunningJobs() {
+
+  // clock() returns the wall time on Windows, so the number of jobs is left as it is there.
+#ifndef Q_OS_WIN
+  const qint64 wall_msec = sample_timer_.elapsed();
+  if (wall_msec < kMinSampleMsec || current_jobs_.isEmpty()) return;
+
+  const qint64 cpu_msec = ProcessCpuMsec() - sample_cpu_msec_;
+  const int cores = qMax(1, QThread::idealThreadCount());
+  const double utilisation = static_cast<double>(cpu_msec) / static_cast<double>(wall_msec * cores);
+  // More than one core for each job means the encoders are multithreaded themselves.
+  const double cores_per_job = static_cast<double>(cpu_msec) / static_cast<double>(wall_msec * current_jobs_.count());
+
+  const int running_jobs_limit = running_jobs_limit_;
+  if (utilisation < kIOBoundUtilisation && running_jobs_limit_ < qMax(1, max_threads()) * 2) {
+    ++running_jobs_limit_;
+  }
+  else if (utilisation > kSaturatedUtilisation && running_jobs_limit_ > 1 && (running_jobs_limit_ > qMax(1, max_threads()) || cores_per_job > 1.0)) {
+    --running_jobs_limit_;
+  }
+
+  if (running_jobs_limit_ != running_jobs_limit) {
+    qLog(Debug) << "Transcoder CPU utilisation" << utilisation << "running" << running_jobs_limit_ << "jobs at once";
+  }
+
+  sample_timer_.restart();
+  sample_cpu_msec_ = ProcessCpuMsec();
+#endif
+
+}
+
+void Transcoder::LogSummary() {
+
+  if (!run_timer_.isValid() || run_files_ == 0) return;
+
+  const qint64 msec = qMax(static_cast<qint64>(1), run_timer_.elapsed());
+  const double mb = static_cast<double>(run_bytes_) / (1024.0 * 1024.0);
+  emit LogLine(tr("Transcoded %1 files (%2 MB) in %3 seconds, %4 MB/s with %5 jobs running on average")
+                   .arg(run_files_)
+                   .arg(mb, 0, 'f', 1)
+                   .arg(static_cast<double>(msec) / 1000.0, 0, 'f', 1)
+                   .arg(mb * 1000.0 / static_cast<double>(msec), 0, 'f', 1)
+                   .arg(static_cast<double>(run_jobs_msec_) / static_cast<double>(msec), 0, 'f', 1));
+
+  run_timer_.invalidate();
+
+}
+
 void Transcoder::Cancel() {
 
   // Remove all pending jobs
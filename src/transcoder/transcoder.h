@@ -35,6 +35,7 @@
 #include <QSet>
 #include <QString>
 #include <QEvent>
+#include <QElapsedTimer>
 
 #include "core/shared_ptr.h"
 #include "core/song.h"
@@ -61,6 +62,7 @@ class Transcoder : public QObject {
   static QList<TranscoderPreset> GetAllPresets();
   static Song::FileType PickBestFormat(const QList<Song::FileType> &supported);
 
+  // The number of jobs to run at once to start with, this is adjusted to the CPU usage while transcoding.
   int max_threads() const { return max_threads_; }
   void set_max_threads(int count) { max_threads_ = count; }
 
@@ -85,9 +87,11 @@ class Transcoder : public QObject {
  private:
   // The description of a file to transcode - lives in the main thread.
   struct Job {
+    Job() : size(0) {}
     QString input;
     QString output;
     TranscoderPreset preset;
+    qint64 size;
   };
 
   // State held by a job and shared across gstreamer callbacks - lives in the job's thread.
@@ -106,6 +110,7 @@ class Transcoder : public QObject {
     Transcoder *parent_;
     GstElement *pipeline_;
     GstElement *convert_element_;
+    QElapsedTimer timer_;
    private:
     Q_DISABLE_COPY(JobState)
   };
@@ -131,6 +136,8 @@ class Transcoder : public QObject {
 
   StartJobStatus MaybeStartNextJob();
   bool StartJob(const Job &job);
+  void AdaptRunningJobs();
+  void LogSummary();
 
   GstElement *CreateElement(const QString &factory_name, GstElement *bin = nullptr, const QString &name = QString());
   GstElement *CreateElementForMimeType(const QString &element_type, const QString &mime_type, GstElement *bin = nullptr);
@@ -146,6 +153,17 @@ class Transcoder : public QObject {
   QList<Job> queued_jobs_;
   JobStateList current_jobs_;
   QString settings_postfix_;
+
+  // How many jobs are run at once, adjusted from the CPU time used by the running jobs.
+  int running_jobs_limit_;
+  QElapsedTimer sample_timer_;
+  qint64 sample_cpu_msec_;
+
+  // For the summary that's logged when all jobs are complete.
+  QElapsedTimer run_timer_;
+  int run_files_;
+  qint64 run_bytes_;
+  qint64 run_jobs_msec_;
 };
 
 #endif  // TRANSCODER_H
@@ -0,0 +1,151 @@
+/*
+ * Strawberry Music Player
+ *
+ * Strawberry is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Strawberry is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Strawberry.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#include "config.h"
+
+#include <algorithm>
+#include <utility>
+
+#include <QtGlobal>
+#include <QByteArray>
+#include <QString>
+#include <QStringList>
+#include <QDir>
+#include <QFile>
+#include <QFileInfo>
+#include <QDateTime>
+#include <QStandardPaths>
+#include <QCryptographicHash>
+
+#include "core/logging.h"
+#include "core/settings.h"
+#include "utilities/fileutils.h"
+#include "transcoder.h"
+#include "transcodercache.h"
+
+namespace {
+constexpr char kSettingsGroup[] = "Transcoder";
+constexpr qint64 kMaxCacheSize = 4LL * 1024 * 1024 * 1024;
+}  // namespace
+
+QString TranscoderCache::CachePath() {
+
+  return QStandardPaths::writableLocation(QStandardPaths::CacheLocation) + QStringLiteral("/transcodercache");
+
+}
+
+QString TranscoderCache::Key(const QString &input, const TranscoderPreset &preset, const QString &settings_postfix) {
+
+  const QString content_hash = Utilities::FileContentHash(input);
+  if (content_hash.isEmpty()) return QString();
+
+  QCryptographicHash hash(QCryptographicHash::Sha1);
+  hash.addData(content_hash.toUtf8());
+  hash.addData(QByteArray::number(static_cast<int>(preset.filetype_)));
+  hash.addData(preset.codec_mimetype_.toUtf8());
+  hash.addData(preset.muxer_mimetype_.toUtf8());
+
+  // The encoder is picked when the pipeline is created, so the settings of all the encoders are part of the key.
+  Settings s;
+  s.beginGroup(kSettingsGroup);
+  QStringList groups = s.childGroups();
+  std::sort(groups.begin(), groups.end());
+  for (const QString &group : std::as_const(groups)) {
+    if (!group.endsWith(settings_postfix)) continue;
+    s.beginGroup(group);
+    QStringList keys = s.childKeys();
+    std::sort(keys.begin(), keys.end());
+    for (const QString &key : std::as_const(keys)) {
+      hash.addData(QStringLiteral("%1/%2=%3").arg(group, key, s.value(key).toString()).toUtf8());
+    }
+    s.endGroup();
+  }
+  s.endGroup();
+
+  return QString::fromLatin1(hash.result().toHex()) + QLatin1Char('.') + preset.extension_;
+
+}
+
+bool TranscoderCache::Get(const QString &key, const QString &output) {
+
+  if (key.isEmpty()) return false;
+
+  const QString filename = CachePath() + QLatin1Char('/') + key;
+  if (!QFile::exists(filename)) return false;
+
+  if (QFile::exists(output)) QFile::remove(output);
+  if (!Utilities::FastCopyFile(filename, output)) {
+    qLog(Error) << "Failed to copy cached transcode" << filename << "to" << output;
+    return false;
+  }
+
+  // Mark it as recently used, so it's kept when the cache is pruned.
+  QFile file(filename);
+  if (file.open(QIODevice::ReadWrite)) {
+    file.setFileTime(QDateTime::currentDateTime(), QFileDevice::FileModificationTime);
+    file.close();
+  }
+
+  return true;
+
+}
+
+void TranscoderCache::Add(const QString &key, const QString &filename) {
+
+  if (key.isEmpty()) return;
+
+  const QString path = CachePath();
+  if (!QDir().mkpath(path)) {
+    qLog(Error) << "Failed to create" << path;
+    return;
+  }
+
+  const QString cache_filename = path + QLatin1Char('/') + key;
+  if (QFile::exists(cache_filename)) return;
+
+  // Copied to a temporary file first, so another organize never sees a partial file.
+  const QString temp_filename = cache_filename + QStringLiteral(".part");
+  QFile::remove(temp_filename);
+  if (!Utilities::FastCopyFile(filename, temp_filename) || !QFile::rename(temp_filename, cache_filename)) {
+    qLog(Error) << "Failed to add" << filename << "to the transcoder cache";
+    QFile::remove(temp_filename);
+    return;
+  }
+
+  Prune(path);
+
+}
+
+void TranscoderCache::Prune(const QString &path) {
+
+  QFileInfoList files = QDir(path).entryInfoList(QDir::Files, QDir::Time);
+
+  qint64 total_size = 0;
+  for (const QFileInfo &fileinfo : std::as_const(files)) {
+    total_size += fileinfo.size();
+  }
+
+  // The list is sorted by time with the newest first, so the least recently used files are removed from the end.
+  while (total_size > kMaxCacheSize && files.count() > 1) {
+    const QFileInfo fileinfo = files.takeLast();
+    if (QFile::remove(fileinfo.absoluteFilePath())) {
+      total_size -= fileinfo.size();
+    }
+  }
+
+}
@@ -0,0 +1,47 @@
+/*
+ * Strawberry Music Player
+ *
+ * Strawberry is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Strawberry is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Strawberry.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#ifndef TRANSCODERCACHE_H
+#define TRANSCODERCACHE_H
+
+#include "config.h"
+
+#include <QString>
+
+struct TranscoderPreset;
+
+// Keeps the output of transcodes, so syncing the same files to a device again copies the earlier results instead of encoding them again.
+// The files are addressed by the content of the source file, the preset and the encoder settings.
+class TranscoderCache {
+ public:
+  ~TranscoderCache() = delete;  // Do not construct variables of this class.
+
+  static QString Key(const QString &input, const TranscoderPreset &preset, const QString &settings_postfix = QString());
+
+  // Copies the cached output to the given filename, returns false if there is none.
+  static bool Get(const QString &key, const QString &output);
+
+  // Adds a copy of the transcoded file, the least recently used files are removed when the cache is full.
+  static void Add(const QString &key, const QString &filename);
+
+ private:
+  static QString CachePath();
+  static void Prune(const QString &path);
+};
+
+#endif  // TRANSCODERCACHE_H
@@ -0,0 +1,136 @@
+/*
+ * Strawberry Music Player
+ *
+ * Strawberry is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Strawberry is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Strawberry.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#include "config.h"
+
+#ifdef HAVE_ICU
+#  include <unicode/ucol.h>
+#endif
+
+#include <QtGlobal>
+#include <QHash>
+#include <QByteArray>
+#include <QString>
+#include <QChar>
+#include <QLocale>
+#include <QReadWriteLock>
+
+#include "collationkey.h"
+
+namespace {
+
+// The cache is cleared when it's full, most keys are for the same strings again when the collection or playlist is sorted next time.
+constexpr qint64 kMaxCachedKeys = 200000;
+
+QReadWriteLock sCacheLock;
+QHash<QString, QByteArray> sCache;
+
+#ifdef HAVE_ICU
+
+// A collator can't be used by more than one thread at a time, so each thread gets its own.
+class Collator {
+ public:
+  Collator() : collator_(nullptr) {
+    UErrorCode status = U_ZERO_ERROR;
+    collator_ = ucol_open(QLocale().name().toUtf8().constData(), &status);
+    if (U_FAILURE(status)) {
+      if (collator_) ucol_close(collator_);
+      collator_ = nullptr;
+    }
+  }
+  ~Collator() {
+    if (collator_) ucol_close(collator_);
+  }
+
+  Collator(const Collator&) = delete;
+  Collator &operator=(const Collator&) = delete;
+
+  UCollator *collator() const { return collator_; }
+
+ private:
+  UCollator *collator_;
+};
+
+#endif  // HAVE_ICU
+
+// The code units in big endian order sort like QString compares them.
+QByteArray CodeUnitKey(const QString &str) {
+
+  QByteArray key;
+  key.reserve(str.size() * 2);
+  for (const QChar c : str) {
+    key.append(static_cast<char>(c.unicode() >> 8));
+    key.append(static_cast<char>(c.unicode() & 0xFF));
+  }
+
+  return key;
+
+}
+
+QByteArray MakeKey(const QString &str) {
+
+#ifdef HAVE_ICU
+
+  thread_local Collator collator;
+  if (collator.collator()) {
+    const UChar *text = reinterpret_cast<const UChar*>(str.utf16());
+    const int32_t length = static_cast<int32_t>(str.size());
+    QByteArray key(qMax(length * 4, static_cast<int32_t>(64)), Qt::Uninitialized);
+    int32_t key_size = ucol_getSortKey(collator.collator(), text, length, reinterpret_cast<uint8_t*>(key.data()), static_cast<int32_t>(key.size()));
+    if (key_size > key.size()) {
+      key.resize(key_size);
+      key_size = ucol_getSortKey(collator.collator(), text, length, reinterpret_cast<uint8_t*>(key.data()), static_cast<int32_t>(key.size()));
+    }
+    if (key_size > 0) {
+      // The size includes the terminating null byte, which isn't needed to compare the keys.
+      key.resize(key_size - 1);
+      return key;
+    }
+  }
+
+#endif  // HAVE_ICU
+
+  return CodeUnitKey(str);
+
+}
+
+}  // namespace
+
+namespace Utilities {
+
+QByteArray CollationKey(const QString &str) {
+
+  if (str.isEmpty()) return QByteArray();
+
+  {
+    QReadLocker l(&sCacheLock);
+    QHash<QString, QByteArray>::const_iterator it = sCache.constFind(str);
+    if (it != sCache.constEnd()) return it.value();
+  }
+
+  const QByteArray key = MakeKey(str);
+
+  QWriteLocker l(&sCacheLock);
+  if (sCache.count() >= kMaxCachedKeys) sCache.clear();
+  sCache.insert(str, key);
+
+  return key;
+
+}
+
+}  // namespace Utilities
@@ -0,0 +1,35 @@
+/*
+ * Strawberry Music Player
+ *
+ * Strawberry is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Strawberry is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Strawberry.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#ifndef COLLATIONKEY_H
+#define COLLATIONKEY_H
+
+#include <QByteArray>
+#include <QString>
+
+namespace Utilities {
+
+// Returns a key for the string that sorts with a plain byte comparison like the string sorts in the current locale.
+// Keys are computed once for every unique string and cached, so sorting and building trees only compare bytes.
+// Without ICU the key sorts like the string itself.
+// This function is thread-safe.
+QByteArray CollationKey(const QString &str);
+
+}  // namespace Utilities
+
+#endif  // COLLATIONKEY_H
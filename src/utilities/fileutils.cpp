@@ -22,11 +22,28 @@
 
 #include <memory>
 
+#ifdef Q_OS_UNIX
+#  include <sys/types.h>
+#  include <sys/stat.h>
+#  include <fcntl.h>
+#  include <unistd.h>
+#  include <cerrno>
+#endif
+#ifdef Q_OS_LINUX
+#  include <sys/ioctl.h>
+#  include <linux/fs.h>
+#  if defined(__GLIBC__) && (__GLIBC__ > 2 || (__GLIBC__ == 2 && __GLIBC_MINOR__ >= 27))
+#    define HAVE_COPY_FILE_RANGE
+#  endif
+#endif
+
 #include <QByteArray>
 #include <QString>
 #include <QIODevice>
 #include <QDir>
 #include <QFile>
+#include <QFileInfo>
+#include <QCryptographicHash>
 
 #include "core/logging.h"
 #include "core/scoped_ptr.h"
@@ -37,6 +54,53 @@ namespace Utilities {
 
 using std::unique_ptr;
 
+namespace {
+
+constexpr qint64 kContentHashChunkSize = 65536;
+
+#ifdef Q_OS_LINUX
+
+enum class KernelCopyResult {
+  Copied,
+  Failed,
+  Unsupported,
+};
+
+// Clones the file, or copies it with copy_file_range, without the data passing through user space.
+KernelCopyResult KernelCopy(const int source_fd, const int destination_fd, const off_t size) {
+
+#ifdef FICLONE
+  if (ioctl(destination_fd, FICLONE, source_fd) == 0) return KernelCopyResult::Copied;
+#endif
+
+#ifdef HAVE_COPY_FILE_RANGE
+  off_t remaining = size;
+  while (remaining > 0) {
+    const ssize_t copied = copy_file_range(source_fd, nullptr, destination_fd, nullptr, static_cast<size_t>(remaining), 0);
+    if (copied < 0) {
+      // Nothing is written yet if it fails on the first call for these, so a normal copy can be done instead.
+      if (remaining == size && (errno == EXDEV || errno == ENOSYS || errno == EINVAL || errno == EOPNOTSUPP || errno == EPERM)) {
+        return KernelCopyResult::Unsupported;
+      }
+      return KernelCopyResult::Failed;
+    }
+    if (copied == 0) break;
+    remaining -= copied;
+  }
+  return remaining == 0 ? KernelCopyResult::Copied : KernelCopyResult::Failed;
+#else
+  Q_UNUSED(source_fd);
+  Q_UNUSED(destination_fd);
+  Q_UNUSED(size);
+  return KernelCopyResult::Unsupported;
+#endif
+
+}
+
+#endif  // Q_OS_LINUX
+
+}  // namespace
+
 QByteArray ReadDataFromFile(const QString &filename) {
 
   QFile file(filename);
@@ -132,4 +196,86 @@ bool RemoveRecursive(const QString &path) {
 
 }
 
+bool FastCopyFile(const QString &source, const QString &destination) {
+
+#ifdef Q_OS_LINUX
+  const QByteArray source_path = QFile::encodeName(source);
+  const QByteArray destination_path = QFile::encodeName(destination);
+
+  const int source_fd = open(source_path.constData(), O_RDONLY | O_CLOEXEC);
+  if (source_fd < 0) return false;
+
+  struct stat source_stat {};
+  if (fstat(source_fd, &source_stat) != 0 || !S_ISREG(source_stat.st_mode)) {
+    close(source_fd);
+    return QFile::copy(source, destination);
+  }
+
+  // Like QFile::copy, the destination must not exist.
+  const int destination_fd = open(destination_path.constData(), O_WRONLY | O_CREAT | O_EXCL | O_CLOEXEC, source_stat.st_mode & 0777);
+  if (destination_fd < 0) {
+    close(source_fd);
+    return false;
+  }
+
+  const KernelCopyResult result = KernelCopy(source_fd, destination_fd, source_stat.st_size);
+  close(source_fd);
+  const bool closed = close(destination_fd) == 0;
+
+  if (result == KernelCopyResult::Copied && closed) return true;
+
+  QFile::remove(destination);
+  if (result == KernelCopyResult::Failed) {
+    qLog(Error) << "Failed to copy" << source << "to" << destination;
+    return false;
+  }
+#endif
+
+  return QFile::copy(source, destination);
+
+}
+
+bool FastMoveFile(const QString &source, const QString &destination) {
+
+#ifdef Q_OS_UNIX
+  // The destination doesn't exist yet, so the device of the directory it goes to is compared.
+  struct stat source_stat {};
+  struct stat destination_stat {};
+  if (stat(QFile::encodeName(source).constData(), &source_stat) == 0 &&
+      stat(QFile::encodeName(QFileInfo(destination).absolutePath()).constData(), &destination_stat) == 0 &&
+      source_stat.st_dev != destination_stat.st_dev) {
+    if (!FastCopyFile(source, destination)) return false;
+    if (!QFile::remove(source)) {
+      qLog(Error) << "Failed to remove" << source << "after copying it to" << destination;
+    }
+    return true;
+  }
+#endif
+
+  return QFile::rename(source, destination);
+
+}
+
+QString FileContentHash(const QString &filename) {
+
+  QFile file(filename);
+  if (!file.open(QIODevice::ReadOnly)) {
+    qLog(Error) << "Failed to open file" << filename << "for reading:" << file.errorString();
+    return QString();
+  }
+
+  const qint64 size = file.size();
+
+  QCryptographicHash hash(QCryptographicHash::Sha1);
+  hash.addData(file.read(kContentHashChunkSize));
+  if (size > kContentHashChunkSize * 2) {
+    if (!file.seek(size - kContentHashChunkSize)) return QString();
+  }
+  hash.addData(file.read(kContentHashChunkSize));
+  file.close();
+
+  return QString::number(size) + QLatin1Char(':') + QString::fromLatin1(hash.result().toHex());
+
+}
+
 }  // namespace Utilities
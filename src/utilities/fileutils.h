@@ -30,8 +30,18 @@ namespace Utilities {
 QByteArray ReadDataFromFile(const QString &filename);
 bool Copy(QIODevice *source, QIODevice *destination);
 bool CopyRecursive(const QString &source, const QString &destination);
+
+// Like QFile::copy, but shares the data blocks with a reflink, or copies in the kernel, when the filesystem supports it.
+bool FastCopyFile(const QString &source, const QString &destination);
+
+// Renames the file when the destination is on the same filesystem, otherwise copies it with FastCopyFile and removes the source.
+bool FastMoveFile(const QString &source, const QString &destination);
+
 bool RemoveRecursive(const QString &path);
 
+// Returns a cheap fingerprint of the file contents: the file size and a hash of the first and last 64 KiB.
+QString FileContentHash(const QString &filename);
+
 }  // namespace Utilities
 
 #endif  // FILEUTILS_H
@@ -39,6 +39,8 @@ class ImageUtils {
   static QStringList SupportedImageFormats();
   static QByteArray SaveImageToJpegData(const QImage &image = QImage());
   static QByteArray FileToJpegData(const QString &filename);
+  // Smoothly scales the image to exactly the given size, large reductions are done with a fast box filter.
+  static QImage SmoothScaleImage(const QImage &image, const QSize size);
   static QImage ScaleImage(const QImage &image, const QSize desired_size, const qreal device_pixel_ratio = 1.0F, const bool pad = true);
   static QImage GenerateNoCoverImage(const QSize size, const qreal device_pixel_ratio);
 };
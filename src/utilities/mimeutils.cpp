@@ -19,10 +19,46 @@
 
 #include <QByteArray>
 #include <QString>
+#include <QStringList>
+#include <QFile>
+#include <QFileInfo>
 #include <QMimeDatabase>
 
+#include "core/song.h"
 #include "mimeutils.h"
 
+namespace {
+
+constexpr qint64 kMediaFileHeaderSize = 16;
+
+const QStringList kNotMediaFileExtensions = QStringList() << QStringLiteral("txt") << QStringLiteral("log") << QStringLiteral("nfo") << QStringLiteral("cue") << QStringLiteral("m3u") << QStringLiteral("m3u8") << QStringLiteral("pls") << QStringLiteral("xspf")
+                                                          << QStringLiteral("pdf") << QStringLiteral("sfv") << QStringLiteral("md5") << QStringLiteral("ffp") << QStringLiteral("accurip") << QStringLiteral("url") << QStringLiteral("htm") << QStringLiteral("html")
+                                                          << QStringLiteral("xml") << QStringLiteral("json") << QStringLiteral("ini") << QStringLiteral("db") << QStringLiteral("bmp") << QStringLiteral("webp") << QStringLiteral("tif") << QStringLiteral("tiff");
+
+bool HasMediaFileSignature(const QByteArray &header) {
+
+  static const QByteArray kASFGuid = QByteArray::fromHex("3026b2758e66cf11");
+  static const QByteArray kEBMLMagic = QByteArray::fromHex("1a45dfa3");
+  static const QByteArray kAC3Magic = QByteArray::fromHex("0b77");
+  static const QByteArray kDTSMagic = QByteArray::fromHex("7ffe8001");
+
+  if (header.startsWith("fLaC") || header.startsWith("OggS") || header.startsWith("ID3") || header.startsWith("MAC ") || header.startsWith("wvpk") || header.startsWith("MPCK") || header.startsWith("MP+") || header.startsWith("TTA1") || header.startsWith("DSD ") || header.startsWith("Vgm ") || header.startsWith("SNES-SPC700")) {
+    return true;
+  }
+  if (header.startsWith("RIFF") && header.mid(8, 4) == "WAVE") return true;
+  if (header.startsWith("FORM") && (header.mid(8, 4) == "AIFF" || header.mid(8, 4) == "AIFC")) return true;
+  if (header.mid(4, 4) == "ftyp") return true;
+  if (header.startsWith(kASFGuid) || header.startsWith(kEBMLMagic) || header.startsWith(kAC3Magic) || header.startsWith(kDTSMagic)) return true;
+
+  // MPEG audio or ADTS frame sync.
+  if (header.size() >= 2 && static_cast<unsigned char>(header[0]) == 0xFF && (static_cast<unsigned char>(header[1]) & 0xE0) == 0xE0) return true;
+
+  return false;
+
+}
+
+}  // namespace
+
 namespace Utilities {
 
 QString MimeTypeFromData(const QByteArray &data) {
@@ -33,4 +69,19 @@ QString MimeTypeFromData(const QByteArray &data) {
 
 }
 
+MediaFileGuess GuessMediaFile(const QString &filename) {
+
+  const QString suffix = QFileInfo(filename).suffix().toLower();
+  if (kNotMediaFileExtensions.contains(suffix)) return MediaFileGuess::NotMediaFile;
+  if (!Song::kAcceptedExtensions.contains(suffix)) return MediaFileGuess::Unknown;
+
+  QFile file(filename);
+  if (!file.open(QIODevice::ReadOnly)) return MediaFileGuess::Unknown;
+  const QByteArray header = file.read(kMediaFileHeaderSize);
+  file.close();
+
+  return HasMediaFileSignature(header) ? MediaFileGuess::MediaFile : MediaFileGuess::Unknown;
+
+}
+
 }  // namespace Utilities
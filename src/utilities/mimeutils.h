@@ -27,6 +27,16 @@ namespace Utilities {
 
 QString MimeTypeFromData(const QByteArray &data);
 
+enum class MediaFileGuess {
+  NotMediaFile,
+  MediaFile,
+  Unknown
+};
+
+// Guesses from the extension and the first bytes of the file whether it's a media file.
+// Files that can't be decided this way return MediaFileGuess::Unknown and need to be checked by the tagreader.
+MediaFileGuess GuessMediaFile(const QString &filename);
+
 } //  namespace Utilities
 
 #endif  // MIMEUTILS_H
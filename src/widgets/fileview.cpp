@@ -25,6 +25,9 @@
 #include <QDir>
 #include <QFileInfo>
 #include <QFileSystemModel>
+#include <QAbstractItemModel>
+#include <QTimer>
+#include <QRect>
 #include <QFileIconProvider>
 #include <QString>
 #include <QStringList>
@@ -45,12 +48,17 @@
 #include "dialogs/deleteconfirmationdialog.h"
 #include "fileview.h"
 #include "fileviewlist.h"
+#include "fileviewmodel.h"
 #include "ui_fileview.h"
 #include "organize/organizeerrordialog.h"
 #include "settings/appearancesettingspage.h"
 
 using std::make_unique;
 
+namespace {
+constexpr int kPrefetchDelayMsec = 200;
+}
+
 const char *FileView::kFileFilter =
     "*.wav *.flac *.wv *.ogg *.oga *.opus *.spx *.ape *.mpc "
     "*.mp2 *.mp3 *.m4a *.mp4 *.aac *.asf *.asx *.wma "
@@ -65,6 +73,7 @@ FileView::FileView(QWidget *parent)
       ui_(new Ui_FileView),
       model_(nullptr),
       undo_stack_(new QUndoStack(this)),
+      timer_prefetch_(new QTimer(this)),
       task_manager_(nullptr),
       storage_(new FilesystemMusicStorage(Song::Source::LocalFile, QStringLiteral("/"))) {
 
@@ -94,6 +103,12 @@ FileView::FileView(QWidget *parent)
   QObject::connect(ui_->list, &FileViewList::Delete, this, &FileView::Delete);
   QObject::connect(ui_->list, &FileViewList::EditTags, this, &FileView::EditTags);
 
+  // Wait until scrolling stops before the visible files are prefetched.
+  timer_prefetch_->setSingleShot(true);
+  timer_prefetch_->setInterval(kPrefetchDelayMsec);
+  QObject::connect(timer_prefetch_, &QTimer::timeout, this, &FileView::PrefetchVisible);
+  QObject::connect(ui_->list->verticalScrollBar(), &QScrollBar::valueChanged, timer_prefetch_, QOverload<>::of(&QTimer::start));
+
   QString filter = QLatin1String(FileView::kFileFilter);
   filter_list_ << filter.split(QLatin1Char(' '));
 
@@ -134,6 +149,13 @@ void FileView::SetTaskManager(SharedPtr<TaskManager> task_manager) {
   task_manager_ = task_manager;
 }
 
+void FileView::SetCollectionBackend(SharedPtr<CollectionBackendInterface> collection_backend) {
+
+  collection_backend_ = collection_backend;
+  if (model_) model_->SetCollectionBackend(collection_backend);
+
+}
+
 void FileView::FileUp() {
 
   QDir dir(model_->rootDirectory());
@@ -184,6 +206,24 @@ void FileView::ChangeFilePathWithoutUndo(const QString &new_path) {
 
   emit PathChanged(new_path);
 
+  timer_prefetch_->start();
+
+}
+
+void FileView::PrefetchVisible() {
+
+  if (!model_ || !isVisible()) return;
+
+  const QModelIndex root = ui_->list->rootIndex();
+  const int rows = model_->rowCount(root);
+  if (rows == 0) return;
+
+  const QRect rect = ui_->list->viewport()->rect();
+  const QModelIndex first = ui_->list->indexAt(rect.topLeft());
+  const QModelIndex last = ui_->list->indexAt(rect.bottomLeft());
+
+  model_->Prefetch(root, first.isValid() ? first.row() : 0, last.isValid() ? last.row() : rows - 1);
+
 }
 
 void FileView::ItemActivated(const QModelIndex &idx) {
@@ -272,7 +312,8 @@ void FileView::showEvent(QShowEvent *e) {
 
   if (model_) return;
 
-  model_ = new QFileSystemModel(this);
+  model_ = new FileViewModel(this);
+  model_->SetCollectionBackend(collection_backend_);
   if (!model_->iconProvider() || model_->iconProvider()->icon(QFileIconProvider::Folder).isNull()) {
     file_icon_provider_ = make_unique<QFileIconProvider>();
     model_->setIconProvider(&*file_icon_provider_);
@@ -282,6 +323,9 @@ void FileView::showEvent(QShowEvent *e) {
   // if an item fails the filter, hide it
   model_->setNameFilterDisables(false);
 
+  QObject::connect(model_, &FileViewModel::directoryLoaded, timer_prefetch_, QOverload<>::of(&QTimer::start));
+  QObject::connect(model_, &FileViewModel::rowsInserted, timer_prefetch_, QOverload<>::of(&QTimer::start));
+
   ui_->list->setModel(model_);
   ChangeFilePathWithoutUndo(QDir::homePath());
 
@@ -35,12 +35,15 @@
 #include "core/song.h"
 
 class QMimeData;
-class QFileSystemModel;
 class QFileIconProvider;
 class QUndoStack;
 class QKeyEvent;
 class QShowEvent;
 
+class QTimer;
+
+class FileViewModel;
+class CollectionBackendInterface;
 class MusicStorage;
 class TaskManager;
 class Ui_FileView;
@@ -58,6 +61,7 @@ class FileView : public QWidget {
 
   void SetPath(const QString &path);
   void SetTaskManager(SharedPtr<TaskManager> task_manager);
+  void SetCollectionBackend(SharedPtr<CollectionBackendInterface> collection_backend);
 
  protected:
   void showEvent(QShowEvent*) override;
@@ -82,6 +86,8 @@ class FileView : public QWidget {
   void Delete(const QStringList &filenames);
   void DeleteFinished(const SongList &songs_with_errors);
 
+  void PrefetchVisible();
+
  private:
   void ChangeFilePathWithoutUndo(const QString &new_path);
 
@@ -111,10 +117,12 @@ class FileView : public QWidget {
 
   Ui_FileView *ui_;
 
-  QFileSystemModel *model_;
+  FileViewModel *model_;
   QUndoStack *undo_stack_;
+  QTimer *timer_prefetch_;
 
   SharedPtr<TaskManager> task_manager_;
+  SharedPtr<CollectionBackendInterface> collection_backend_;
   SharedPtr<MusicStorage> storage_;
 
   QString lazy_set_path_;
@@ -33,8 +33,10 @@
 
 #include "core/iconloader.h"
 #include "core/mimedata.h"
+#include "playlist/songmimedata.h"
 #include "utilities/filemanagerutils.h"
 #include "fileviewlist.h"
+#include "fileviewmodel.h"
 
 FileViewList::FileViewList(QWidget *parent)
     : QListView(parent),
@@ -92,8 +94,18 @@ QList<QUrl> FileViewList::UrlListFromSelection() const {
 
 MimeData *FileViewList::MimeDataFromSelection() const {
 
-  MimeData *mimedata = new MimeData;
-  mimedata->setUrls(UrlListFromSelection());
+  const QList<QUrl> urls = UrlListFromSelection();
+
+  // Use the prefetched songs if they're all loaded, so they don't have to be loaded again.
+  MimeData *mimedata = nullptr;
+  FileViewModel *file_view_model = qobject_cast<FileViewModel*>(model());
+  if (file_view_model) {
+    mimedata = file_view_model->SongMimeDataForUrls(urls);
+  }
+  if (!mimedata) {
+    mimedata = new MimeData;
+    mimedata->setUrls(urls);
+  }
 
   const QStringList filenames = FilenamesFromSelection();
 
@@ -201,8 +213,7 @@ void FileViewList::mousePressEvent(QMouseEvent *e) {
       // we need to update the menu selection
       menu_selection_ = selectionModel()->selection();
 
-      MimeData *mimedata = new MimeData;
-      mimedata->setUrls(UrlListFromSelection());
+      MimeData *mimedata = MimeDataFromSelection();
       mimedata->enqueue_now_ = true;
       emit AddToPlaylist(mimedata);
       break;
@@ -0,0 +1,256 @@
+/*
+ * Strawberry Music Player
+ *
+ * Strawberry is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Strawberry is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Strawberry.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#include "config.h"
+
+#include <QtGlobal>
+#include <QObject>
+#include <QtConcurrentRun>
+#include <QFuture>
+#include <QFutureWatcher>
+#include <QFileSystemModel>
+#include <QFileInfo>
+#include <QDateTime>
+#include <QHash>
+#include <QSet>
+#include <QList>
+#include <QVariant>
+#include <QString>
+#include <QStringList>
+#include <QUrl>
+#include <QMimeData>
+
+#include "core/shared_ptr.h"
+#include "core/song.h"
+#include "core/tagreaderclient.h"
+#include "collection/collectionbackend.h"
+#include "playlist/songmimedata.h"
+#include "fileviewmodel.h"
+
+#include "tagreadermessages.pb.h"
+
+const int FileViewModel::kPrefetchBatchSize = 32;
+const int FileViewModel::kMaxCachedSongs = 5000;
+
+FileViewModel::FileViewModel(QObject *parent) : QFileSystemModel(parent) {}
+
+void FileViewModel::Prefetch(const QModelIndex &parent, const int first, const int last) {
+
+  // Cue sheets contain several songs per file, those are left to the song loader.
+  QSet<QString> cue_basenames;
+  const int rows = rowCount(parent);
+  for (int row = 0; row < rows; ++row) {
+    const QFileInfo fileinfo = fileInfo(index(row, 0, parent));
+    if (fileinfo.suffix().compare(QLatin1String("cue"), Qt::CaseInsensitive) == 0) {
+      cue_basenames << fileinfo.completeBaseName();
+    }
+  }
+
+  QStringList filenames;
+  for (int row = qMax(0, first); row <= qMin(last, rows - 1); ++row) {
+    const QFileInfo fileinfo = fileInfo(index(row, 0, parent));
+    if (!fileinfo.isFile() || !Song::kAcceptedExtensions.contains(fileinfo.suffix(), Qt::CaseInsensitive) || cue_basenames.contains(fileinfo.completeBaseName())) continue;
+    const QString filename = fileinfo.filePath();
+    if (songs_.contains(filename) || pending_.contains(filename)) continue;
+    pending_ << filename;
+    filenames << filename;
+    if (filenames.count() >= kPrefetchBatchSize) {
+      LoadFromCollection(filenames);
+      filenames.clear();
+    }
+  }
+
+  if (!filenames.isEmpty()) {
+    LoadFromCollection(filenames);
+  }
+
+}
+
+void FileViewModel::LoadFromCollection(const QStringList &filenames) {
+
+  if (!collection_backend_) {
+    ReadFiles(filenames);
+    return;
+  }
+
+  QList<QUrl> urls;
+  urls.reserve(filenames.count());
+  for (const QString &filename : filenames) {
+    urls << QUrl::fromLocalFile(filename);
+  }
+
+  SharedPtr<CollectionBackendInterface> collection_backend = collection_backend_;
+  QFuture<QHash<QUrl, SongList>> future = QtConcurrent::run([collection_backend, urls]() { return collection_backend->GetSongsByUrls(urls); });
+  QFutureWatcher<QHash<QUrl, SongList>> *watcher = new QFutureWatcher<QHash<QUrl, SongList>>();
+  QObject::connect(watcher, &QFutureWatcher<QHash<QUrl, SongList>>::finished, this, [this, watcher, filenames]() {
+    CollectionSongsLoaded(filenames, watcher->result());
+    watcher->deleteLater();
+  });
+  watcher->setFuture(future);
+
+}
+
+void FileViewModel::CollectionSongsLoaded(const QStringList &filenames, const QHash<QUrl, SongList> &collection_songs) {
+
+  QStringList read_filenames;
+  for (const QString &filename : filenames) {
+    const SongList songs = collection_songs.value(QUrl::fromLocalFile(filename));
+    // Files with more than one song in the collection are sections of a cue sheet.
+    if (songs.count() == 1 && songs.first().beginning_nanosec() == 0) {
+      AddSong(filename, songs.first());
+    }
+    else {
+      read_filenames << filename;
+    }
+  }
+
+  if (!read_filenames.isEmpty()) {
+    ReadFiles(read_filenames);
+  }
+
+}
+
+void FileViewModel::ReadFiles(const QStringList &filenames) {
+
+  TagReaderReply *reply = TagReaderClient::Instance()->ReadFiles(filenames, TagReaderClient::ReadLevel::Full, TagReaderClient::Priority::Background);
+  QObject::connect(reply, &TagReaderReply::Finished, this, [this, reply, filenames]() { ReadFilesFinished(reply, filenames); }, Qt::QueuedConnection);
+
+}
+
+void FileViewModel::ReadFilesFinished(TagReaderReply *reply, const QStringList &filenames) {
+
+  reply->deleteLater();
+
+  int i = 0;
+  if (reply->is_successful()) {
+    for (const spb::tagreader::SongMetadata &metadata : reply->message().read_files_response().metadata()) {
+      if (i >= filenames.count()) break;
+      const QString &filename = filenames[i++];
+      const QFileInfo fileinfo(filename);
+      Song song(Song::Source::LocalFile);
+      song.InitFromFilePartial(filename, fileinfo);
+      song.InitFromProtobuf(metadata);
+      song.set_mtime(fileinfo.lastModified().toSecsSinceEpoch());
+      if (song.is_valid()) {
+        AddSong(filename, song);
+      }
+      else {
+        pending_.remove(filename);
+      }
+    }
+  }
+
+  // Files that couldn't be read are tried again the next time they are shown.
+  for (; i < filenames.count(); ++i) {
+    pending_.remove(filenames[i]);
+  }
+
+}
+
+void FileViewModel::AddSong(const QString &filename, const Song &song) {
+
+  pending_.remove(filename);
+
+  if (songs_.count() >= kMaxCachedSongs) {
+    songs_.clear();
+  }
+  songs_.insert(filename, song);
+
+  const QModelIndex idx = index(filename);
+  if (idx.isValid()) {
+    emit dataChanged(idx, idx, QList<int>() << Qt::ToolTipRole);
+  }
+
+}
+
+Song FileViewModel::CachedSong(const QString &filename) const {
+
+  QHash<QString, Song>::const_iterator it = songs_.constFind(filename);
+  if (it == songs_.constEnd()) return Song();
+
+  // Don't use the song if the file was modified after it was loaded.
+  if (it.value().mtime() != QFileInfo(filename).lastModified().toSecsSinceEpoch()) return Song();
+
+  return it.value();
+
+}
+
+SongMimeData *FileViewModel::SongMimeDataForUrls(const QList<QUrl> &urls) const {
+
+  if (urls.isEmpty()) return nullptr;
+
+  // Collection songs are inserted as collection items, so all songs need to be either from the collection or not.
+  SongList songs;
+  songs.reserve(urls.count());
+  int collection_songs = 0;
+  for (const QUrl &url : urls) {
+    if (!url.isLocalFile()) return nullptr;
+    const Song song = CachedSong(url.toLocalFile());
+    if (!song.is_valid()) return nullptr;
+    if (song.is_collection_song()) ++collection_songs;
+    songs << song;
+  }
+
+  if (collection_songs != 0 && collection_songs != songs.count()) return nullptr;
+
+  SongMimeData *mimedata = new SongMimeData;
+  mimedata->setUrls(urls);
+  mimedata->songs = songs;
+  if (collection_songs != 0) {
+    mimedata->backend = collection_backend_;
+  }
+
+  return mimedata;
+
+}
+
+QVariant FileViewModel::data(const QModelIndex &idx, const int role) const {
+
+  if (role == Qt::ToolTipRole && idx.isValid() && idx.column() == 0) {
+    const Song song = CachedSong(filePath(idx));
+    if (song.is_valid()) {
+      QString tooltip = song.PrettyTitleWithArtist();
+      if (!song.album().isEmpty()) {
+        tooltip += QLatin1Char('\n') + song.album();
+      }
+      if (song.length_nanosec() > 0) {
+        tooltip += QLatin1Char('\n') + song.PrettyLength();
+      }
+      return tooltip;
+    }
+  }
+
+  return QFileSystemModel::data(idx, role);
+
+}
+
+QMimeData *FileViewModel::mimeData(const QModelIndexList &indexes) const {
+
+  QList<QUrl> urls;
+  for (const QModelIndex &idx : indexes) {
+    if (idx.column() == 0) {
+      urls << QUrl::fromLocalFile(filePath(idx));
+    }
+  }
+
+  SongMimeData *mimedata = SongMimeDataForUrls(urls);
+  if (mimedata) return mimedata;
+
+  return QFileSystemModel::mimeData(indexes);
+
+}
@@ -0,0 +1,83 @@
+/*
+ * Strawberry Music Player
+ *
+ * Strawberry is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Strawberry is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Strawberry.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#ifndef FILEVIEWMODEL_H
+#define FILEVIEWMODEL_H
+
+#include "config.h"
+
+#include <QtGlobal>
+#include <QObject>
+#include <QFileSystemModel>
+#include <QHash>
+#include <QSet>
+#include <QList>
+#include <QVariant>
+#include <QString>
+#include <QStringList>
+#include <QUrl>
+
+#include "core/shared_ptr.h"
+#include "core/song.h"
+#include "core/tagreaderclient.h"
+
+class QMimeData;
+class QModelIndex;
+class CollectionBackendInterface;
+class SongMimeData;
+
+// The file system model lists the directories in a separate thread and caches them.
+// On top of that, the metadata of the media files that are visible is prefetched, from the collection or else with the tag reader,
+// so the song is shown in the tooltip and adding the files to a playlist doesn't have to load them again.
+class FileViewModel : public QFileSystemModel {
+  Q_OBJECT
+
+ public:
+  explicit FileViewModel(QObject *parent = nullptr);
+
+  void SetCollectionBackend(SharedPtr<CollectionBackendInterface> collection_backend) { collection_backend_ = collection_backend; }
+
+  // Loads the metadata of the files in the rows of the parent, if it isn't cached already.
+  void Prefetch(const QModelIndex &parent, const int first, const int last);
+
+  // Returns mime data with the songs if the metadata of all files was prefetched, otherwise nullptr.
+  SongMimeData *SongMimeDataForUrls(const QList<QUrl> &urls) const;
+
+  QVariant data(const QModelIndex &idx, const int role = Qt::DisplayRole) const override;
+  QMimeData *mimeData(const QModelIndexList &indexes) const override;
+
+ private:
+  void LoadFromCollection(const QStringList &filenames);
+  void CollectionSongsLoaded(const QStringList &filenames, const QHash<QUrl, SongList> &collection_songs);
+  void ReadFiles(const QStringList &filenames);
+  void ReadFilesFinished(TagReaderReply *reply, const QStringList &filenames);
+  void AddSong(const QString &filename, const Song &song);
+  Song CachedSong(const QString &filename) const;
+
+ private:
+  static const int kPrefetchBatchSize;
+  static const int kMaxCachedSongs;
+
+  SharedPtr<CollectionBackendInterface> collection_backend_;
+
+  // Songs by filename, a song is only used as long as the file wasn't modified.
+  QHash<QString, Song> songs_;
+  QSet<QString> pending_;
+};
+
+#endif  // FILEVIEWMODEL_H
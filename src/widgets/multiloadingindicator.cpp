@@ -69,8 +69,13 @@ void MultiLoadingIndicator::UpdateText() {
   const QList<TaskManager::Task> tasks = task_manager_->GetTasks();
 
   QStringList strings;
+  QStringList details;
   strings.reserve(tasks.count());
   for (const TaskManager::Task &task : tasks) {
+    if (!task.details.isEmpty()) {
+      details << task.name + QLatin1String(": ") + task.details;
+    }
+
     QString task_text(task.name);
     task_text[0] = task_text[0].toLower();
 
@@ -87,6 +92,7 @@ void MultiLoadingIndicator::UpdateText() {
     text_[0] = text_[0].toUpper();
     text_ += QLatin1String("...");
   }
+  setToolTip(details.join(QLatin1Char('\n')));
 
   emit TaskCountChange(static_cast<int>(tasks.count()));
   update();
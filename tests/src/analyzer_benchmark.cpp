@@ -0,0 +1,189 @@
+/*
+ * Strawberry Music Player
+ *
+ * Strawberry is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Strawberry is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Strawberry.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+
+// Benchmarks for the analyzers, each one renders frames of synthetic scope data to an offscreen image at fixed sizes and device pixel ratios.
+// The number of frames can be set with STRAWBERRY_BENCHMARK_FRAMES.
+// The frame time percentiles are recorded as test properties named <analyzer>_<width>x<height>@<ratio>_p<percentile>_us, so --gtest_output=json:<file> writes them in a machine-readable form.
+
+#include <algorithm>
+#include <cmath>
+#include <vector>
+
+#include <gtest/gtest.h>
+
+#include <QtGlobal>
+#include <QList>
+#include <QString>
+#include <QSize>
+#include <QImage>
+#include <QPainter>
+#include <QElapsedTimer>
+#include <QResizeEvent>
+#include <QCoreApplication>
+
+#include "core/logging.h"
+#include "analyzer/fht.h"
+#include "analyzer/blockanalyzer.h"
+#include "analyzer/boomanalyzer.h"
+#include "analyzer/rainbowanalyzer.h"
+#include "analyzer/sonogram.h"
+
+// clazy:excludeall=non-pod-global-static,returning-void-expression
+
+namespace {
+
+constexpr int kDefaultFrames = 2000;
+constexpr int kFhtSizeExp = 9;
+
+struct BenchmarkSize {
+  QSize size;
+  qreal device_pixel_ratio;
+};
+
+const QList<BenchmarkSize> kSizes = QList<BenchmarkSize>() << BenchmarkSize{ QSize(120, 40), 1.0 } << BenchmarkSize{ QSize(400, 100), 1.0 } << BenchmarkSize{ QSize(400, 100), 2.0 } << BenchmarkSize{ QSize(1600, 400), 1.0 };
+
+int BenchmarkFrames() {
+
+  bool ok = false;
+  const int frames = qEnvironmentVariableIntValue("STRAWBERRY_BENCHMARK_FRAMES", &ok);
+  return ok && frames > 0 ? frames : kDefaultFrames;
+
+}
+
+// A few sines with a slowly moving pitch, so the analyzers see changing data like they would while playing.
+std::vector<float> SyntheticScope(const int size, const int frame) {
+
+  std::vector<float> scope(static_cast<size_t>(size));
+  const float shift = 1.0F + 0.5F * std::sin(static_cast<float>(frame) / 50.0F);
+  for (int i = 0; i < size; ++i) {
+    const float t = static_cast<float>(i) / static_cast<float>(size);
+    scope[static_cast<size_t>(i)] = 0.5F * std::sin(t * 40.0F * shift) + 0.3F * std::sin(t * 310.0F * shift) + 0.1F * std::sin(t * 1900.0F);
+  }
+
+  return scope;
+
+}
+
+// Gives the benchmark access to the protected transform and analyze of the analyzer.
+template<typename T>
+class BenchmarkAnalyzer : public T {
+ public:
+  BenchmarkAnalyzer() : T(nullptr) {}
+
+  void Resize(const QSize size) {
+    T::resize(size);
+    QResizeEvent e(size, QSize());
+    QCoreApplication::sendEvent(this, &e);
+  }
+
+  int ScopeSize() const { return T::fht_->size(); }
+
+  void Frame(QPainter &p, std::vector<float> &scope) {
+    T::transform(scope);
+    T::analyze(p, scope, true);
+  }
+};
+
+class AnalyzerBenchmark : public ::testing::Test {
+ protected:
+  void Record(const QString &name, std::vector<qint64> &nsecs) {
+
+    std::sort(nsecs.begin(), nsecs.end());
+    const QList<int> percentiles = QList<int>() << 50 << 90 << 99;
+    for (const int percentile : percentiles) {
+      const qint64 usec = nsecs[std::min(nsecs.size() - 1, nsecs.size() * static_cast<size_t>(percentile) / 100)] / 1000;
+      qLog(Info) << name << "p" << percentile << usec << "us";
+      RecordProperty(QStringLiteral("%1_p%2_us").arg(name).arg(percentile).toStdString(), static_cast<int>(usec));
+    }
+
+  }
+
+  template<typename T>
+  void Run(const QString &name) {
+
+    const int frames = BenchmarkFrames();
+
+    for (const BenchmarkSize &benchmark_size : kSizes) {
+      BenchmarkAnalyzer<T> analyzer;
+      analyzer.Resize(benchmark_size.size);
+
+      QImage image(benchmark_size.size * benchmark_size.device_pixel_ratio, QImage::Format_ARGB32_Premultiplied);
+      image.setDevicePixelRatio(benchmark_size.device_pixel_ratio);
+
+      std::vector<qint64> nsecs;
+      nsecs.reserve(static_cast<size_t>(frames));
+      QElapsedTimer timer;
+      for (int frame = 0; frame < frames; ++frame) {
+        std::vector<float> scope = SyntheticScope(analyzer.ScopeSize(), frame);
+        image.fill(Qt::black);
+        QPainter p(&image);
+        timer.start();
+        analyzer.Frame(p, scope);
+        nsecs.push_back(timer.nsecsElapsed());
+        p.end();
+      }
+
+      Record(QStringLiteral("%1_%2x%3@%4").arg(name).arg(benchmark_size.size.width()).arg(benchmark_size.size.height()).arg(benchmark_size.device_pixel_ratio), nsecs);
+      analyzer.StopProducer();
+    }
+
+  }
+};
+
+TEST_F(AnalyzerBenchmark, LogSpectrum) {
+
+  const int frames = BenchmarkFrames();
+  FHT fht(kFhtSizeExp);
+  std::vector<float> out(static_cast<size_t>(fht.size() / 2));
+  std::vector<qint64> nsecs;
+  nsecs.reserve(static_cast<size_t>(frames));
+
+  QElapsedTimer timer;
+  for (int frame = 0; frame < frames; ++frame) {
+    std::vector<float> scope = SyntheticScope(fht.size(), frame);
+    timer.start();
+    fht.logSpectrum(out.data(), scope.data());
+    nsecs.push_back(timer.nsecsElapsed());
+  }
+
+  Record(QStringLiteral("FHTLogSpectrum_%1").arg(fht.size()), nsecs);
+
+}
+
+TEST_F(AnalyzerBenchmark, BlockAnalyzer) {
+  Run<BlockAnalyzer>(QStringLiteral("BlockAnalyzer"));
+}
+
+TEST_F(AnalyzerBenchmark, BoomAnalyzer) {
+  Run<BoomAnalyzer>(QStringLiteral("BoomAnalyzer"));
+}
+
+TEST_F(AnalyzerBenchmark, Sonogram) {
+  Run<Sonogram>(QStringLiteral("Sonogram"));
+}
+
+TEST_F(AnalyzerBenchmark, NyanCatAnalyzer) {
+  Run<NyanCatAnalyzer>(QStringLiteral("NyanCatAnalyzer"));
+}
+
+TEST_F(AnalyzerBenchmark, RainbowDashAnalyzer) {
+  Run<RainbowDashAnalyzer>(QStringLiteral("RainbowDashAnalyzer"));
+}
+
+}  // namespace
@@ -0,0 +1,212 @@
+/*
+ * Strawberry Music Player
+ *
+ * Strawberry is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Strawberry is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Strawberry.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+
+// Benchmarks for the collection backend and model, run with synthetic collections of different sizes.
+// The sizes can be set with STRAWBERRY_BENCHMARK_SIZES, a comma separated list of song counts.
+// Each timing is recorded as a test property named <operation>_<songs>_ms, so --gtest_output=json:<file> writes them in a machine-readable form.
+
+#include <algorithm>
+#include <memory>
+
+#include <gtest/gtest.h>
+
+#include <QtGlobal>
+#include <QList>
+#include <QString>
+#include <QStringList>
+#include <QUrl>
+#include <QElapsedTimer>
+#include <QModelIndex>
+#include <QSqlDatabase>
+#include <QObject>
+#include <QMetaObject>
+
+#include "core/logging.h"
+#include "core/scoped_ptr.h"
+#include "core/shared_ptr.h"
+#include "core/database.h"
+#include "core/song.h"
+#include "utilities/timeconstants.h"
+#include "collection/collection.h"
+#include "collection/collectionbackend.h"
+#include "collection/collectionfilteroptions.h"
+#include "collection/collectionmodel.h"
+#include "collection/collectionquery.h"
+
+using std::make_unique;
+using std::make_shared;
+
+// clazy:excludeall=non-pod-global-static,returning-void-expression
+
+namespace {
+
+constexpr int kSongsPerAlbum = 10;
+constexpr int kSongsPerArtist = 100;
+constexpr int kAddChunkSize = 10000;
+constexpr int kMaxLazyPopulateItems = 1000;
+
+QList<int> BenchmarkSizes() {
+
+  QList<int> sizes;
+  const QStringList values = qEnvironmentVariable("STRAWBERRY_BENCHMARK_SIZES", QStringLiteral("10000,100000,1000000")).split(QLatin1Char(','));
+  for (const QString &value : values) {
+    bool ok = false;
+    const int size = value.trimmed().toInt(&ok);
+    if (ok && size > 0) sizes << size;
+  }
+
+  return sizes;
+
+}
+
+SongList GenerateSongs(const int first, const int count) {
+
+  static const QStringList genres = QStringList() << QStringLiteral("Rock") << QStringLiteral("Pop") << QStringLiteral("Jazz") << QStringLiteral("Blues") << QStringLiteral("Classical") << QStringLiteral("Electronic") << QStringLiteral("Folk") << QStringLiteral("Metal");
+
+  SongList songs;
+  songs.reserve(count);
+  for (int i = first; i < first + count; ++i) {
+    const int artist = i / kSongsPerArtist;
+    const int album = i / kSongsPerAlbum;
+    Song song(Song::Source::Collection);
+    song.Init(QStringLiteral("Title %1").arg(i), QStringLiteral("Artist %1").arg(artist), QStringLiteral("Album %1").arg(album), 180 * kNsecPerSec);
+    song.set_track(i % kSongsPerAlbum + 1);
+    song.set_year(1960 + artist % 60);
+    song.set_genre(genres[artist % genres.count()]);
+    song.set_directory_id(1);
+    song.set_url(QUrl::fromLocalFile(QStringLiteral("/music/Artist %1/Album %2/%3.flac").arg(artist).arg(album).arg(i)));
+    song.set_filetype(Song::FileType::FLAC);
+    song.set_filesize(20000000);
+    song.set_mtime(1);
+    song.set_ctime(1);
+    songs << song;
+  }
+
+  return songs;
+
+}
+
+class CollectionBenchmark : public ::testing::Test {
+ protected:
+  void SetUp() override {
+    database_ = make_shared<MemoryDatabase>(nullptr);
+    backend_ = make_shared<CollectionBackend>();
+    backend_->Init(database_, nullptr, Song::Source::Collection, QLatin1String(SCollection::kSongsTable), QLatin1String(SCollection::kFtsTable), QLatin1String(SCollection::kDirsTable), QLatin1String(SCollection::kSubdirsTable));
+    backend_->AddDirectory(QStringLiteral("/music"));
+  }
+
+  void Record(const QString &operation, const int songs, const qint64 msec) {
+    qLog(Info) << operation << songs << "songs:" << msec << "ms";
+    RecordProperty(QStringLiteral("%1_%2_ms").arg(operation).arg(songs).toStdString(), static_cast<int>(msec));
+  }
+
+  void Run(const int size);
+
+  SharedPtr<Database> database_;  // NOLINT(cppcoreguidelines-non-private-member-variables-in-classes)
+  SharedPtr<CollectionBackend> backend_;  // NOLINT(cppcoreguidelines-non-private-member-variables-in-classes)
+};
+
+void CollectionBenchmark::Run(const int size) {
+
+  QElapsedTimer timer;
+
+  {
+    // Nothing is listening yet, so this only measures the database.
+    timer.start();
+    for (int i = 0; i < size; i += kAddChunkSize) {
+      backend_->AddOrUpdateSongs(GenerateSongs(i, std::min(kAddChunkSize, size - i)));
+    }
+    Record(QStringLiteral("AddOrUpdateSongs"), size, timer.elapsed());
+  }
+
+  {
+    timer.start();
+    const CollectionBackend::AlbumList albums = backend_->GetAllAlbums();
+    Record(QStringLiteral("GetAllAlbums"), size, timer.elapsed());
+    EXPECT_EQ((size + kSongsPerAlbum - 1) / kSongsPerAlbum, albums.count());
+  }
+
+  {
+    CollectionFilterOptions filter_options;
+    filter_options.set_filter_text(QStringLiteral("artist 42"));
+    QSqlDatabase db(database_->Connect());
+    CollectionQuery query(db, backend_->songs_table(), backend_->fts_table(), filter_options);
+    SongList songs;
+    timer.start();
+    EXPECT_TRUE(backend_->ExecCollectionQuery(&query, songs));
+    Record(QStringLiteral("CollectionQueryFts"), size, timer.elapsed());
+  }
+
+  ScopedPtr<CollectionModel> model = make_unique<CollectionModel>(backend_, nullptr);
+
+  {
+    timer.start();
+    model->Reset();
+    Record(QStringLiteral("CollectionModelReset"), size, timer.elapsed());
+  }
+
+  {
+    // Load the first top level containers down to their songs.
+    int items = 0;
+    timer.start();
+    for (int row = 0; row < model->rowCount(QModelIndex()) && items < kMaxLazyPopulateItems; ++row) {
+      const QModelIndex idx = model->index(row, 0, QModelIndex());
+      if (!model->canFetchMore(idx)) continue;
+      model->fetchMore(idx);
+      for (int child_row = 0; child_row < model->rowCount(idx); ++child_row) {
+        const QModelIndex child_idx = model->index(child_row, 0, idx);
+        if (model->canFetchMore(child_idx)) model->fetchMore(child_idx);
+      }
+      ++items;
+    }
+    Record(QStringLiteral("LazyPopulate"), size, timer.elapsed());
+  }
+
+  {
+    // Add one percent more songs on new albums.  Collect them from the backend without the model seeing them, so only the model is measured.
+    SongList discovered_songs;
+    const int count = std::max(1, size / 100);
+    {
+      QObject::disconnect(&*backend_, &CollectionBackend::SongsDiscovered, &*model, &CollectionModel::SongsDiscovered);
+      QMetaObject::Connection connection = QObject::connect(&*backend_, &CollectionBackend::SongsDiscovered, [&discovered_songs](const SongList &songs) { discovered_songs << songs; });
+      backend_->AddOrUpdateSongs(GenerateSongs(size, count));
+      QObject::disconnect(connection);
+    }
+    timer.start();
+    model->SongsDiscovered(discovered_songs);
+    Record(QStringLiteral("SongsDiscovered"), size, timer.elapsed());
+  }
+
+}
+
+TEST_F(CollectionBenchmark, Collection) {
+
+  const QList<int> sizes = BenchmarkSizes();
+  ASSERT_FALSE(sizes.isEmpty());
+
+  for (const int size : sizes) {
+    // Start every size with an empty database.
+    TearDown();
+    SetUp();
+    Run(size);
+  }
+
+}
+
+}  // namespace
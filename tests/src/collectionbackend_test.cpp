@@ -32,6 +32,7 @@
 #include "core/shared_ptr.h"
 #include "core/song.h"
 #include "core/database.h"
+#include "core/sqlquery.h"
 #include "utilities/timeconstants.h"
 #include "collection/collectionbackend.h"
 #include "collection/collection.h"
@@ -114,6 +115,22 @@ TEST_F(CollectionBackendTest, RemoveDirectory) {
 
 TEST_F(CollectionBackendTest, GetAlbumArtNonExistent) {}
 
+TEST_F(CollectionBackendTest, BestAlbumArt) {
+
+  EXPECT_TRUE(backend_->BestAlbumArt(QStringLiteral("/music/album"), QStringLiteral("hash1")).isEmpty());
+
+  backend_->UpdateBestAlbumArt(QStringLiteral("/music/album"), QStringLiteral("/music/album/front.jpg"), QStringLiteral("hash1"), 500, 500);
+  EXPECT_EQ(QStringLiteral("/music/album/front.jpg"), backend_->BestAlbumArt(QStringLiteral("/music/album"), QStringLiteral("hash1")));
+
+  // A different hash means the images in the directory changed.
+  EXPECT_TRUE(backend_->BestAlbumArt(QStringLiteral("/music/album"), QStringLiteral("hash2")).isEmpty());
+
+  backend_->UpdateBestAlbumArt(QStringLiteral("/music/album"), QStringLiteral("/music/album/cover.png"), QStringLiteral("hash2"), 1000, 1000);
+  EXPECT_EQ(QStringLiteral("/music/album/cover.png"), backend_->BestAlbumArt(QStringLiteral("/music/album"), QStringLiteral("hash2")));
+  EXPECT_TRUE(backend_->BestAlbumArt(QStringLiteral("/music/album"), QStringLiteral("hash1")).isEmpty());
+
+}
+
 // Test adding a single song to the database, then getting various information back about it.
 class SingleSong : public CollectionBackendTest {
  protected:
@@ -229,6 +246,27 @@ TEST_F(SingleSong, GetSongs) {
 
 }
 
+TEST_F(SingleSong, InitFromPartialQuery) {
+
+  AddDummySong();
+  if (HasFatalFailure()) return;
+
+  QSqlDatabase db(database_->Connect());
+  SqlQuery q(db);
+  q.prepare(QStringLiteral("SELECT ROWID, title, track FROM %1").arg(QLatin1String(SCollection::kSongsTable)));
+  ASSERT_TRUE(q.Exec());
+
+  const Song::QueryColumns columns(q.record());
+  ASSERT_TRUE(q.next());
+  Song song;
+  song.set_album(QStringLiteral("Unchanged"));
+  song.InitFromQuery(q, columns, true);
+  EXPECT_EQ(1, song.id());
+  EXPECT_EQ(song_.title(), song.title());
+  EXPECT_EQ(QStringLiteral("Unchanged"), song.album());
+
+}
+
 TEST_F(SingleSong, GetSongById) {
 
   AddDummySong();
@@ -317,6 +355,133 @@ TEST_F(SingleSong, DeleteSongs) {
 
 }
 
+TEST_F(CollectionBackendTest, CompilationsNeedUpdating) {
+
+  backend_->AddDirectory(QStringLiteral("/mnt/music"));
+
+  SongList songs;
+  for (int i = 0; i < 2; ++i) {
+    Song song = MakeDummySong(1);
+    song.set_title(QStringLiteral("Title %1").arg(i));
+    song.set_artist(QStringLiteral("Artist %1").arg(i));
+    song.set_album(QStringLiteral("Album"));
+    song.set_url(QUrl::fromLocalFile(QStringLiteral("/mnt/music/Album/%1.flac").arg(i)));
+    songs << song;
+  }
+  Song other_song = MakeDummySong(1);
+  other_song.set_artist(QStringLiteral("Artist"));
+  other_song.set_album(QStringLiteral("Other album"));
+  other_song.set_url(QUrl::fromLocalFile(QStringLiteral("/mnt/music/Other album/1.flac")));
+  songs << other_song;
+  backend_->AddOrUpdateSongs(songs);
+
+  QSignalSpy deleted_spy(&*backend_, &CollectionBackend::SongsDeleted);
+  QSignalSpy added_spy(&*backend_, &CollectionBackend::SongsDiscovered);
+
+  backend_->CompilationsNeedUpdating();
+
+  // Only the two songs of the compilation changed.
+  ASSERT_EQ(1, deleted_spy.size());
+  ASSERT_EQ(1, added_spy.size());
+  SongList songs_added = *(reinterpret_cast<SongList*>(added_spy[0][0].data()));
+  ASSERT_EQ(2, songs_added.size());
+  EXPECT_TRUE(songs_added[0].compilation_detected());
+  EXPECT_TRUE(songs_added[1].compilation_detected());
+  EXPECT_TRUE(backend_->GetSongById(1).is_compilation());
+  EXPECT_TRUE(backend_->GetSongById(2).is_compilation());
+  EXPECT_FALSE(backend_->GetSongById(3).is_compilation());
+
+  // Nothing changed since the last pass.
+  backend_->CompilationsNeedUpdating();
+  EXPECT_EQ(1, deleted_spy.size());
+
+  // Removing one of the artists turns it back into a normal album.
+  Song song = backend_->GetSongById(2);
+  backend_->DeleteSongs(SongList() << song);
+  deleted_spy.clear();
+  added_spy.clear();
+  backend_->CompilationsNeedUpdating();
+  ASSERT_EQ(1, added_spy.size());
+  songs_added = *(reinterpret_cast<SongList*>(added_spy[0][0].data()));
+  ASSERT_EQ(1, songs_added.size());
+  EXPECT_EQ(1, songs_added[0].id());
+  EXPECT_FALSE(songs_added[0].compilation_detected());
+  EXPECT_FALSE(backend_->GetSongById(1).is_compilation());
+
+}
+
+TEST_F(SingleSong, UpdatePlayStatistics) {
+
+  AddDummySong();
+  if (HasFatalFailure()) return;
+
+  QSignalSpy statistics_spy(&*backend_, &CollectionBackend::SongsStatisticsChanged);
+
+  CollectionBackend::PlayStatisticsUpdateList updates;
+  for (int i = 0; i < 3; ++i) {
+    CollectionBackend::PlayStatisticsUpdate update;
+    update.id = 1;
+    update.playcount = 2;
+    update.skipcount = i == 0 ? 1 : 0;
+    update.lastplayed = 100 + i;
+    updates << update;
+  }
+  backend_->UpdatePlayStatistics(updates);
+
+  // All the updates are reported in a single signal, with the song only once.
+  ASSERT_EQ(1, statistics_spy.size());
+  SongList songs = *(reinterpret_cast<SongList*>(statistics_spy[0][0].data()));
+  ASSERT_EQ(1, songs.size());
+  EXPECT_EQ(6, songs[0].playcount());
+  EXPECT_EQ(1, songs[0].skipcount());
+  EXPECT_EQ(102, songs[0].lastplayed());
+
+  // An older last played time doesn't replace a newer one.
+  CollectionBackend::PlayStatisticsUpdate update;
+  update.id = 1;
+  update.lastplayed = 50;
+  backend_->UpdatePlayStatistics(CollectionBackend::PlayStatisticsUpdateList() << update);
+  EXPECT_EQ(102, backend_->GetSongById(1).lastplayed());
+
+}
+
+TEST_F(SingleSong, TotalCounts) {
+
+  QSignalSpy song_count_spy(&*backend_, &CollectionBackend::TotalSongCountUpdated);
+  QSignalSpy artist_count_spy(&*backend_, &CollectionBackend::TotalArtistCountUpdated);
+  QSignalSpy album_count_spy(&*backend_, &CollectionBackend::TotalAlbumCountUpdated);
+
+  AddDummySong();
+  if (HasFatalFailure()) return;
+
+  ASSERT_EQ(1, song_count_spy.size());
+  EXPECT_EQ(1, song_count_spy.last()[0].toInt());
+  EXPECT_EQ(1, artist_count_spy.last()[0].toInt());
+  EXPECT_EQ(1, album_count_spy.last()[0].toInt());
+
+  Song new_song(song_);
+  new_song.set_id(1);
+
+  backend_->MarkSongsUnavailable(SongList() << new_song);
+  EXPECT_EQ(0, song_count_spy.last()[0].toInt());
+  EXPECT_EQ(0, artist_count_spy.last()[0].toInt());
+  EXPECT_EQ(0, album_count_spy.last()[0].toInt());
+
+  backend_->MarkSongsUnavailable(SongList() << new_song, false);
+  EXPECT_EQ(1, song_count_spy.last()[0].toInt());
+
+  new_song.set_artist(QStringLiteral("Another artist"));
+  backend_->AddOrUpdateSongs(SongList() << new_song);
+  EXPECT_EQ(1, song_count_spy.last()[0].toInt());
+  EXPECT_EQ(1, artist_count_spy.last()[0].toInt());
+
+  backend_->DeleteSongs(SongList() << new_song);
+  EXPECT_EQ(0, song_count_spy.last()[0].toInt());
+  EXPECT_EQ(0, artist_count_spy.last()[0].toInt());
+  EXPECT_EQ(0, album_count_spy.last()[0].toInt());
+
+}
+
 TEST_F(SingleSong, MarkSongsUnavailable) {
 
   AddDummySong();
@@ -29,6 +29,11 @@
 #include <QThread>
 #include <QSignalSpy>
 #include <QSortFilterProxyModel>
+#include <QMimeData>
+#include <QSqlDatabase>
+#include <QFile>
+#include <QTemporaryDir>
+#include <QThreadPool>
 #include <QtDebug>
 
 #include "core/logging.h"
@@ -36,8 +41,12 @@
 #include "core/shared_ptr.h"
 #include "core/database.h"
 #include "collection/collectionmodel.h"
+#include "collection/collectionfilterindex.h"
 #include "collection/collectionbackend.h"
 #include "collection/collection.h"
+#include "collection/collectionquery.h"
+#include "collection/collectionqueryoptions.h"
+#include "playlist/songmimedata.h"
 
 using std::make_unique;
 using std::make_shared;
@@ -267,8 +276,9 @@ TEST_F(CollectionModelTest, RemoveSongsLazyLoaded) {
 
   backend_->DeleteSongs(SongList() << one << two);
 
-  ASSERT_EQ(2, spy_preremove.count());
-  ASSERT_EQ(2, spy_remove.count());
+  // Both songs are removed as one range
+  ASSERT_EQ(1, spy_preremove.count());
+  ASSERT_EQ(1, spy_remove.count());
   ASSERT_EQ(0, spy_reset.count());
 
   artist_index = model_->index(0, 0, QModelIndex());
@@ -279,6 +289,42 @@ TEST_F(CollectionModelTest, RemoveSongsLazyLoaded) {
 
 }
 
+TEST_F(CollectionModelTest, AddSongsLazyLoaded) {
+
+  AddSong(QStringLiteral("Title 1"), QStringLiteral("Artist"), QStringLiteral("Album"), 123);
+  model_->Init(false);
+
+  // Lazy load the items
+  QModelIndex artist_index = model_->index(0, 0, QModelIndex());
+  model_->fetchMore(artist_index);
+  ASSERT_EQ(1, model_->rowCount(artist_index));
+  QModelIndex album_index = model_->index(0, 0, artist_index);
+  model_->fetchMore(album_index);
+  ASSERT_EQ(1, model_->rowCount(album_index));
+
+  QSignalSpy spy_insert(&*model_, &CollectionModel::rowsInserted);
+
+  // Add two songs to the album and one new artist in one batch
+  SongList songs;
+  for (int i = 2; i <= 4; ++i) {
+    Song song;
+    song.Init(QStringLiteral("Title %1").arg(i), i == 4 ? QStringLiteral("Foo") : QStringLiteral("Artist"), QStringLiteral("Album"), 123);
+    song.set_directory_id(1);
+    song.set_mtime(1);
+    song.set_ctime(1);
+    song.set_url(QUrl(QStringLiteral("file:///tmp/foo%1").arg(i)));
+    song.set_filesize(1);
+    songs << song;
+  }
+  backend_->AddOrUpdateSongs(songs);
+
+  // One range for the album, one for the new artist and one for its divider
+  ASSERT_EQ(3, spy_insert.count());
+  ASSERT_EQ(2, model_->rowCount(album_index));
+  EXPECT_EQ(4, model_->rowCount(QModelIndex()));
+
+}
+
 TEST_F(CollectionModelTest, RemoveSongsNotLazyLoaded) {
 
   Song one = AddSong(QStringLiteral("Title 1"), QStringLiteral("Artist"), QStringLiteral("Album"), 123); one.set_id(1);
@@ -356,6 +402,115 @@ TEST_F(CollectionModelTest, RemoveEmptyArtists) {
 
 // WARNING: This test can take up to 30 minutes to complete.
 #if 0
+TEST_F(CollectionModelTest, FilterKeepsLoadedItems) {
+
+  AddSong(QStringLiteral("Title 1"), QStringLiteral("Artist 1"), QStringLiteral("Album"), 123);
+  AddSong(QStringLiteral("Title 2"), QStringLiteral("Artist 1"), QStringLiteral("Album"), 123);
+  AddSong(QStringLiteral("Title 3"), QStringLiteral("Foo"), QStringLiteral("Album"), 123);
+  model_->Init(false);
+
+  // Lazy load the first artist
+  ASSERT_EQ(4, model_sorted_->rowCount(QModelIndex()));
+  QModelIndex artist_index = model_sorted_->mapToSource(model_sorted_->index(1, 0, QModelIndex()));
+  ASSERT_EQ(QStringLiteral("Artist 1"), artist_index.data().toString());
+  model_->fetchMore(artist_index);
+  ASSERT_EQ(1, model_->rowCount(artist_index));
+  CollectionItem *artist_item = model_->IndexToItem(artist_index);
+
+  QSignalSpy spy_remove(&*model_, &CollectionModel::rowsRemoved);
+  QSignalSpy spy_reset(&*model_, &CollectionModel::modelReset);
+
+  // Only the other artist and its divider should be removed
+  model_->SetFilterText(QStringLiteral("title 1"));
+  ASSERT_TRUE(spy_remove.wait());
+  EXPECT_EQ(0, spy_reset.count());
+
+  ASSERT_EQ(2, model_sorted_->rowCount(QModelIndex()));
+  artist_index = model_sorted_->mapToSource(model_sorted_->index(1, 0, QModelIndex()));
+  EXPECT_EQ(artist_item, model_->IndexToItem(artist_index));
+  EXPECT_TRUE(artist_item->lazy_loaded);
+
+  QModelIndex album_index = model_->index(0, 0, artist_index);
+  model_->fetchMore(album_index);
+  ASSERT_EQ(1, model_->rowCount(album_index));
+  EXPECT_EQ(QStringLiteral("Title 1"), model_->index(0, 0, album_index).data().toString());
+
+}
+
+TEST_F(CollectionModelTest, MimeDataQueriesUnloadedContainers) {
+
+  AddSong(QStringLiteral("Title 1"), QStringLiteral("Artist 1"), QStringLiteral("Album"), 123);
+  AddSong(QStringLiteral("Title 2"), QStringLiteral("Artist 1"), QStringLiteral("Album"), 123);
+  AddSong(QStringLiteral("Title 3"), QStringLiteral("Foo"), QStringLiteral("Album"), 123);
+  model_->Init(false);
+
+  // Load the first artist down to its songs, but leave the other one alone
+  ASSERT_EQ(4, model_sorted_->rowCount(QModelIndex()));
+  const QModelIndex artist_index = model_sorted_->mapToSource(model_sorted_->index(1, 0, QModelIndex()));
+  const QModelIndex foo_index = model_sorted_->mapToSource(model_sorted_->index(3, 0, QModelIndex()));
+  ASSERT_EQ(QStringLiteral("Foo"), foo_index.data().toString());
+  model_->fetchMore(artist_index);
+  const QModelIndex album_index = model_->index(0, 0, artist_index);
+  model_->fetchMore(album_index);
+  ASSERT_EQ(2, model_->rowCount(album_index));
+
+  ScopedPtr<QMimeData> mimedata(model_->mimeData(QModelIndexList() << foo_index << artist_index));
+  const SongMimeData *song_mimedata = qobject_cast<const SongMimeData*>(mimedata.get());
+  ASSERT_TRUE(song_mimedata);
+  EXPECT_FALSE(model_->IndexToItem(foo_index)->lazy_loaded);
+
+  ASSERT_EQ(2, song_mimedata->songs.count());
+  ASSERT_EQ(1, song_mimedata->queries.count());
+  EXPECT_EQ(0, song_mimedata->queries[0].position);
+
+  // The query should return the songs of the unloaded artist
+  QSqlDatabase db(database_->Connect());
+  CollectionQuery q(db, backend_->songs_table(), backend_->fts_table(), song_mimedata->filter_options);
+  const CollectionQueryOptions &query_options = song_mimedata->queries[0].query_options;
+  q.SetColumnSpec(query_options.column_spec());
+  for (const CollectionQueryOptions::Where &where_clauses : query_options.where_clauses()) {
+    q.AddWhere(where_clauses.column, where_clauses.value, where_clauses.op);
+  }
+  q.SetOrderBy(query_options.order_by());
+  ASSERT_TRUE(q.Exec());
+  const Song::QueryColumns columns(q.record());
+  ASSERT_TRUE(q.Next());
+  Song song;
+  song.InitFromQuery(q, columns, true);
+  EXPECT_EQ(QStringLiteral("Title 3"), song.title());
+  EXPECT_FALSE(q.Next());
+
+}
+
+TEST_F(CollectionModelTest, TreeSnapshot) {
+
+  QTemporaryDir temp_dir;
+  ASSERT_TRUE(temp_dir.isValid());
+  const QString filename = temp_dir.path() + QStringLiteral("/collectiontree.snapshot");
+
+  AddSong(QStringLiteral("Title 1"), QStringLiteral("Artist 1"), QStringLiteral("Album"), 123);
+  AddSong(QStringLiteral("Title 2"), QStringLiteral("Artist 2"), QStringLiteral("Album"), 123);
+  model_->set_tree_snapshot_filename(filename);
+  model_->Init(false);
+  QThreadPool::globalInstance()->waitForDone();
+  ASSERT_TRUE(QFile::exists(filename));
+
+  AddSong(QStringLiteral("Title 3"), QStringLiteral("Foo"), QStringLiteral("Album"), 123);
+
+  // Another model shows the snapshot straight away, then adds what's missing from it
+  ScopedPtr<CollectionModel> model = make_unique<CollectionModel>(backend_, nullptr);
+  model->set_tree_snapshot_filename(filename);
+  model->Init(true);
+  EXPECT_EQ(3, model->rowCount(QModelIndex()));
+
+  QSignalSpy spy_insert(&*model, &CollectionModel::rowsInserted);
+  for (int i = 0; i < 50 && model->rowCount(QModelIndex()) < 5; ++i) {
+    spy_insert.wait(100);
+  }
+  EXPECT_EQ(5, model->rowCount(QModelIndex()));
+
+}
+
 TEST_F(CollectionModelTest, TestContainerNodes) {
 
   SongList songs;
@@ -699,4 +854,35 @@ TEST_F(CollectionModelTest, TestContainerNodes) {
 }
 #endif
 
+TEST(CollectionFilterIndexTest, Match) {
+
+  Song song1;
+  song1.set_id(1);
+  song1.set_title(QStringLiteral("Blue in Green"));
+  song1.set_artist(QStringLiteral("Miles Davis"));
+  song1.set_year(1959);
+
+  Song song2;
+  song2.set_id(2);
+  song2.set_title(QStringLiteral("Café Blue"));
+  song2.set_artist(QStringLiteral("Patricia Barber"));
+  song2.set_year(1994);
+
+  CollectionFilterIndex index;
+  index.AddOrUpdateSongs(SongList() << song1 << song2);
+  ASSERT_EQ(2, index.size());
+
+  EXPECT_FALSE(index.Match(QStringLiteral("()")));
+  EXPECT_EQ(QList<int>() << 1 << 2, index.Match(QStringLiteral("blu")).value());
+  EXPECT_EQ(QList<int>() << 2, index.Match(QStringLiteral("cafe")).value());
+  EXPECT_EQ(QList<int>() << 1, index.Match(QStringLiteral("artist:miles blue")).value());
+  EXPECT_EQ(QList<int>() << 1, index.Match(QStringLiteral("\"in green\"")).value());
+  EXPECT_EQ(QList<int>() << 2, index.Match(QStringLiteral("year:>1960")).value());
+  EXPECT_TRUE(index.Match(QStringLiteral("lue")).value().isEmpty());
+
+  index.RemoveSongs(SongList() << song1);
+  EXPECT_EQ(QList<int>() << 2, index.Match(QStringLiteral("blu")).value());
+
+}
+
 }  // namespace
@@ -181,3 +181,26 @@ TEST_F(MergedProxyModelTest, SubRemove) {
   EXPECT_EQ(0, after_spy[0][2].toInt());
 
 }
+
+TEST_F(MergedProxyModelTest, MergePointMovedBySourceInsert) {
+
+  source_.appendRow(new QStandardItem(QStringLiteral("one")));
+
+  QStandardItemModel submodel;
+  submodel.appendRow(new QStandardItem(QStringLiteral("two")));
+
+  merged_.AddSubModel(source_.index(0, 0, QModelIndex()), &submodel);
+  ASSERT_EQ(1, merged_.rowCount(merged_.index(0, 0, QModelIndex())));
+
+  // The merge point moves down a row, and the submodel should follow it
+  source_.insertRow(0, new QStandardItem(QStringLiteral("zero")));
+
+  ASSERT_EQ(2, merged_.rowCount(QModelIndex()));
+  const QModelIndex zero_i = merged_.index(0, 0, QModelIndex());
+  const QModelIndex one_i = merged_.index(1, 0, QModelIndex());
+  EXPECT_EQ(QStringLiteral("one"), merged_.data(one_i).toString());
+  EXPECT_EQ(0, merged_.rowCount(zero_i));
+  ASSERT_EQ(1, merged_.rowCount(one_i));
+  EXPECT_EQ(QStringLiteral("two"), merged_.data(merged_.index(0, 0, one_i)).toString());
+
+}
@@ -0,0 +1,304 @@
+/*
+ * Strawberry Music Player
+ *
+ * Strawberry is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Strawberry is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Strawberry.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+
+// Benchmarks for the playlist, run with synthetic playlists of different sizes.
+// The sizes can be set with STRAWBERRY_BENCHMARK_SIZES, a comma separated list of item counts.
+// Each timing is recorded as a test property named <operation>_<items>_ms, so --gtest_output=json:<file> writes them in a machine-readable form.
+
+#include <algorithm>
+#include <memory>
+
+#include <gtest/gtest.h>
+
+#include <QtGlobal>
+#include <QList>
+#include <QMap>
+#include <QSet>
+#include <QString>
+#include <QStringList>
+#include <QUrl>
+#include <QElapsedTimer>
+#include <QModelIndex>
+#include <QScopedPointer>
+#include <QUndoStack>
+
+#include "core/logging.h"
+#include "core/shared_ptr.h"
+#include "core/database.h"
+#include "core/song.h"
+#include "utilities/timeconstants.h"
+#include "playlist/playlist.h"
+#include "playlist/playlistbackend.h"
+#include "playlist/playlistfilter.h"
+#include "playlist/playlistfilterparser.h"
+#include "playlist/playlistsequence.h"
+#include "playlist/playlistundocommands.h"
+#include "playlist/songplaylistitem.h"
+#include "mock_settingsprovider.h"
+
+using std::make_shared;
+
+// clazy:excludeall=non-pod-global-static,returning-void-expression
+
+namespace {
+
+constexpr int kSongsPerAlbum = 10;
+constexpr int kSongsPerArtist = 100;
+constexpr int kNextRowCalls = 1000;
+constexpr int kFilterParses = 1000;
+
+const QString kFilterText = QStringLiteral("artist:\"artist 42\" OR (album:7 AND year:>1990) OR -title:1");
+
+QList<int> BenchmarkSizes() {
+
+  QList<int> sizes;
+  const QStringList values = qEnvironmentVariable("STRAWBERRY_BENCHMARK_SIZES", QStringLiteral("10000,100000,1000000")).split(QLatin1Char(','));
+  for (const QString &value : values) {
+    bool ok = false;
+    const int size = value.trimmed().toInt(&ok);
+    if (ok && size > 0) sizes << size;
+  }
+
+  return sizes;
+
+}
+
+// Real items are used instead of MockPlaylistItem, every call to a mock goes through gmock, which would take longer than the playlist itself.
+PlaylistItemPtrList GenerateItems(const int first, const int count) {
+
+  PlaylistItemPtrList items;
+  items.reserve(count);
+  for (int i = first; i < first + count; ++i) {
+    const int artist = i / kSongsPerArtist;
+    const int album = i / kSongsPerAlbum;
+    Song song(Song::Source::LocalFile);
+    song.Init(QStringLiteral("Title %1").arg(i), QStringLiteral("Artist %1").arg(artist), QStringLiteral("Album %1").arg(album), 180 * kNsecPerSec);
+    song.set_track(i % kSongsPerAlbum + 1);
+    song.set_year(1960 + artist % 60);
+    song.set_url(QUrl::fromLocalFile(QStringLiteral("/music/Artist %1/Album %2/%3.flac").arg(artist).arg(album).arg(i)));
+    song.set_filetype(Song::FileType::FLAC);
+    items << make_shared<SongPlaylistItem>(song);
+  }
+
+  return items;
+
+}
+
+// Every hundredth row, at least one.
+QList<int> SpreadRows(const int size) {
+
+  QList<int> rows;
+  for (int row = 0; row < size; row += 100) {
+    rows << row;
+  }
+
+  return rows;
+
+}
+
+class PlaylistBenchmark : public ::testing::Test {
+ protected:
+  PlaylistBenchmark() : sequence_(nullptr, new DummySettingsProvider) {}
+
+  void SetUp() override {
+    database_ = make_shared<MemoryDatabase>(nullptr);
+    backend_ = make_shared<PlaylistBackend>(database_, nullptr);
+    playlist_.reset(new Playlist(nullptr, nullptr, nullptr, 1));
+    playlist_->set_sequence(&sequence_);
+  }
+
+  void TearDown() override {
+    playlist_.reset();
+    backend_.reset();
+    database_.reset();
+  }
+
+  void Record(const QString &operation, const int items, const qint64 msec) {
+    qLog(Info) << operation << items << "items:" << msec << "ms";
+    RecordProperty(QStringLiteral("%1_%2_ms").arg(operation).arg(items).toStdString(), static_cast<int>(msec));
+  }
+
+  void Run(const int size);
+  void RunNextRow(const int size);
+
+  PlaylistSequence sequence_;  // NOLINT(cppcoreguidelines-non-private-member-variables-in-classes)
+  SharedPtr<Database> database_;  // NOLINT(cppcoreguidelines-non-private-member-variables-in-classes)
+  SharedPtr<PlaylistBackend> backend_;  // NOLINT(cppcoreguidelines-non-private-member-variables-in-classes)
+  QScopedPointer<Playlist> playlist_;  // NOLINT(cppcoreguidelines-non-private-member-variables-in-classes)
+};
+
+void PlaylistBenchmark::Run(const int size) {
+
+  QElapsedTimer timer;
+
+  {
+    const PlaylistItemPtrList items = GenerateItems(0, size);
+    timer.start();
+    playlist_->InsertItems(items);
+    Record(QStringLiteral("InsertItems"), size, timer.elapsed());
+    ASSERT_EQ(size, playlist_->rowCount());
+  }
+
+  {
+    // In the middle, so the rows after it are moved.
+    const PlaylistItemPtrList items = GenerateItems(size, std::max(1, size / 100));
+    timer.start();
+    playlist_->InsertItems(items, size / 2);
+    Record(QStringLiteral("InsertItemsMiddle"), size, timer.elapsed());
+  }
+
+  playlist_->undo_stack()->clear();
+
+  {
+    timer.start();
+    playlist_->undo_stack()->push(new PlaylistUndoCommands::MoveItems(playlist_.data(), SpreadRows(playlist_->rowCount()), 0));
+    Record(QStringLiteral("MoveItems"), size, timer.elapsed());
+  }
+
+  playlist_->undo_stack()->clear();
+
+  {
+    timer.start();
+    playlist_->sort(Playlist::Column_Artist, Qt::AscendingOrder);
+    Record(QStringLiteral("SortArtist"), size, timer.elapsed());
+  }
+
+  {
+    timer.start();
+    playlist_->sort(Playlist::Column_Title, Qt::DescendingOrder);
+    Record(QStringLiteral("SortTitle"), size, timer.elapsed());
+  }
+
+  playlist_->undo_stack()->clear();
+
+  {
+    // Parsing doesn't depend on the number of items, it's repeated so it can be measured.
+    const QMap<QString, int> column_names = playlist_->filter()->column_names();
+    const QSet<int> numerical_columns = QSet<int>() << Playlist::Column_Year << Playlist::Column_Track;
+    timer.start();
+    for (int i = 0; i < kFilterParses; ++i) {
+      FilterParser parser(kFilterText, column_names, numerical_columns);
+      QScopedPointer<FilterTree> tree(parser.parse());
+    }
+    Record(QStringLiteral("FilterParse"), size, timer.elapsed());
+  }
+
+  {
+    timer.start();
+    playlist_->filter()->SetFilterText(kFilterText);
+    EXPECT_GT(playlist_->filter()->rowCount(), 0);
+    Record(QStringLiteral("FilterEvaluate"), size, timer.elapsed());
+  }
+
+  {
+    // Like typing one more character.
+    timer.start();
+    playlist_->filter()->SetFilterText(QStringLiteral("artist 4"));
+    playlist_->filter()->SetFilterText(QStringLiteral("artist 42"));
+    Record(QStringLiteral("FilterRefine"), size, timer.elapsed());
+  }
+
+  playlist_->filter()->SetFilterText(QString());
+
+  RunNextRow(size);
+
+  {
+    const int id = backend_->CreatePlaylist(QStringLiteral("Benchmark"), QString());
+    ASSERT_NE(-1, id);
+
+    timer.start();
+    backend_->SavePlaylist(id, playlist_->GetAllItems(), -1, nullptr);
+    Record(QStringLiteral("SavePlaylist"), size, timer.elapsed());
+
+    // Only the items after the first changed one are written again.
+    playlist_->removeRows(playlist_->rowCount() - 1, 1);
+    timer.start();
+    backend_->SavePlaylist(id, playlist_->GetAllItems(), -1, nullptr);
+    Record(QStringLiteral("SavePlaylistChanged"), size, timer.elapsed());
+
+    timer.start();
+    const PlaylistItemPtrList items = backend_->GetPlaylistItems(id);
+    Record(QStringLiteral("GetPlaylistItems"), size, timer.elapsed());
+    EXPECT_EQ(playlist_->rowCount(), items.count());
+  }
+
+  {
+    QList<int> rows = SpreadRows(playlist_->rowCount());
+    timer.start();
+    playlist_->RemoveItemsWithoutUndo(rows);
+    Record(QStringLiteral("RemoveItems"), size, timer.elapsed());
+  }
+
+  {
+    timer.start();
+    playlist_->removeRows(0, playlist_->rowCount() / 2);
+    Record(QStringLiteral("RemoveRows"), size, timer.elapsed());
+  }
+
+  playlist_->undo_stack()->clear();
+
+}
+
+void PlaylistBenchmark::RunNextRow(const int size) {
+
+  const QList<PlaylistSequence::ShuffleMode> shuffle_modes = QList<PlaylistSequence::ShuffleMode>() << PlaylistSequence::ShuffleMode::Off << PlaylistSequence::ShuffleMode::All << PlaylistSequence::ShuffleMode::InsideAlbum << PlaylistSequence::ShuffleMode::Albums;
+  const QList<PlaylistSequence::RepeatMode> repeat_modes = QList<PlaylistSequence::RepeatMode>() << PlaylistSequence::RepeatMode::Off << PlaylistSequence::RepeatMode::Track << PlaylistSequence::RepeatMode::Album << PlaylistSequence::RepeatMode::Playlist << PlaylistSequence::RepeatMode::OneByOne << PlaylistSequence::RepeatMode::Intro;
+
+  QElapsedTimer timer;
+
+  for (const PlaylistSequence::ShuffleMode shuffle_mode : shuffle_modes) {
+    {
+      timer.start();
+      sequence_.SetShuffleMode(shuffle_mode);
+      Record(QStringLiteral("Shuffle%1").arg(static_cast<int>(shuffle_mode)), size, timer.elapsed());
+    }
+    for (const PlaylistSequence::RepeatMode repeat_mode : repeat_modes) {
+      sequence_.SetRepeatMode(repeat_mode);
+      playlist_->set_current_row(0);
+      timer.start();
+      for (int i = 0; i < kNextRowCalls; ++i) {
+        const int row = playlist_->next_row();
+        if (row == -1) break;
+        playlist_->set_current_row(row);
+      }
+      Record(QStringLiteral("NextRow_Shuffle%1_Repeat%2").arg(static_cast<int>(shuffle_mode)).arg(static_cast<int>(repeat_mode)), size, timer.elapsed());
+      playlist_->set_current_row(-1);
+    }
+  }
+
+  sequence_.SetShuffleMode(PlaylistSequence::ShuffleMode::Off);
+  sequence_.SetRepeatMode(PlaylistSequence::RepeatMode::Off);
+
+}
+
+TEST_F(PlaylistBenchmark, Playlist) {
+
+  const QList<int> sizes = BenchmarkSizes();
+  ASSERT_FALSE(sizes.isEmpty());
+
+  for (const int size : sizes) {
+    // Start every size with an empty playlist and database.
+    TearDown();
+    SetUp();
+    Run(size);
+  }
+
+}
+
+}  // namespace
@@ -360,6 +360,27 @@ TEST_F(PlaylistTest, UndoRemove) {
 
 }
 
+TEST_F(PlaylistTest, UndoRemoveMany) {
+
+  PlaylistItemPtrList items;
+  for (int i = 0; i < 2000; ++i) {
+    items << MakeMockItemP(QStringLiteral("Title %1").arg(i));
+  }
+  playlist_.InsertItems(items);
+  ASSERT_EQ(2000, playlist_.rowCount(QModelIndex()));
+  ASSERT_TRUE(playlist_.undo_stack()->canUndo());
+
+  playlist_.removeRows(0, 2000);
+  EXPECT_EQ(0, playlist_.rowCount(QModelIndex()));
+  ASSERT_TRUE(playlist_.undo_stack()->canUndo());
+
+  playlist_.undo_stack()->undo();
+  ASSERT_EQ(2000, playlist_.rowCount(QModelIndex()));
+  EXPECT_EQ(QStringLiteral("Title 0"), playlist_.data(playlist_.index(0, Playlist::Column_Title)));
+  EXPECT_EQ(QStringLiteral("Title 1999"), playlist_.data(playlist_.index(1999, Playlist::Column_Title)));
+
+}
+
 TEST_F(PlaylistTest, UndoMultiRemove) {
 
   // Add 3 items
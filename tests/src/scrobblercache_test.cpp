@@ -0,0 +1,143 @@
+/*
+ * Strawberry Music Player
+ *
+ * Strawberry is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Strawberry is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Strawberry.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+#include <gtest/gtest.h>
+
+#include <QDir>
+#include <QFile>
+#include <QIODevice>
+#include <QStandardPaths>
+#include <QString>
+#include <QByteArray>
+
+#include "test_utils.h"
+
+#include "core/song.h"
+#include "utilities/timeconstants.h"
+#include "scrobbler/scrobblercache.h"
+#include "scrobbler/scrobblermetrics.h"
+
+// clazy:excludeall=non-pod-global-static
+
+namespace {
+
+class ScrobblerCacheTest : public ::testing::Test {
+ protected:
+  void SetUp() override {
+    QStandardPaths::setTestModeEnabled(true);
+    const QString cache_path = QStandardPaths::writableLocation(QStandardPaths::CacheLocation);
+    QDir().mkpath(cache_path);
+    filename_ = cache_path + QStringLiteral("/scrobblercache_test.json");
+    journal_filename_ = filename_ + QStringLiteral(".journal");
+    RemoveFiles();
+  }
+
+  void TearDown() override {
+    RemoveFiles();
+  }
+
+  void RemoveFiles() {
+    QFile::remove(filename_);
+    QFile::remove(journal_filename_);
+  }
+
+  static Song MakeSong(const QString &title) {
+    Song song;
+    song.Init(title, QStringLiteral("Artist"), QStringLiteral("Album"), 123 * kNsecPerSec);
+    return song;
+  }
+
+  ScrobblerMetrics metrics_;
+  QString filename_;
+  QString journal_filename_;
+};
+
+TEST_F(ScrobblerCacheTest, ReplaysJournal) {
+
+  {
+    ScrobblerCache cache(QStringLiteral("scrobblercache_test.json"), &metrics_, nullptr);
+    cache.Add(MakeSong(QStringLiteral("Title 1")), 1000);
+    ScrobblerCacheItemPtr cache_item = cache.Add(MakeSong(QStringLiteral("Title 2")), 2000);
+    cache.Add(MakeSong(QStringLiteral("Title 3")), 3000);
+    cache.Remove(cache_item);
+  }
+
+  EXPECT_FALSE(QFile::exists(filename_));
+  EXPECT_TRUE(QFile::exists(journal_filename_));
+
+  ScrobblerCache cache(QStringLiteral("scrobblercache_test.json"), &metrics_, nullptr);
+  ASSERT_EQ(2, cache.Count());
+  EXPECT_EQ(QStringLiteral("Title 1"), cache.List()[0]->metadata.title);
+  EXPECT_EQ(QStringLiteral("Title 3"), cache.List()[1]->metadata.title);
+
+}
+
+TEST_F(ScrobblerCacheTest, RepairsTornJournal) {
+
+  {
+    ScrobblerCache cache(QStringLiteral("scrobblercache_test.json"), &metrics_, nullptr);
+    cache.Add(MakeSong(QStringLiteral("Title 1")), 1000);
+  }
+
+  // Simulate being killed while writing a record.
+  {
+    QFile file(journal_filename_);
+    ASSERT_TRUE(file.open(QIODevice::WriteOnly | QIODevice::Append));
+    file.write(QByteArray("{\"type\":\"add\",\"track\":{\"timestamp\":2000,\"art"));
+  }
+
+  {
+    ScrobblerCache cache(QStringLiteral("scrobblercache_test.json"), &metrics_, nullptr);
+    EXPECT_EQ(1, cache.Count());
+    // The damaged journal is compacted into the cache file.
+    EXPECT_TRUE(QFile::exists(filename_));
+    EXPECT_FALSE(QFile::exists(journal_filename_));
+    cache.Add(MakeSong(QStringLiteral("Title 3")), 3000);
+  }
+
+  ScrobblerCache cache(QStringLiteral("scrobblercache_test.json"), &metrics_, nullptr);
+  ASSERT_EQ(2, cache.Count());
+  EXPECT_EQ(QStringLiteral("Title 1"), cache.List()[0]->metadata.title);
+  EXPECT_EQ(QStringLiteral("Title 3"), cache.List()[1]->metadata.title);
+
+}
+
+TEST_F(ScrobblerCacheTest, CompactsJournal) {
+
+  {
+    ScrobblerCache cache(QStringLiteral("scrobblercache_test.json"), &metrics_, nullptr);
+    cache.Add(MakeSong(QStringLiteral("Title 1")), 1000);
+    cache.Add(MakeSong(QStringLiteral("Title 2")), 2000);
+    cache.WriteCache();
+    EXPECT_TRUE(QFile::exists(filename_));
+    EXPECT_FALSE(QFile::exists(journal_filename_));
+    cache.Remove(cache.List()[0]);
+  }
+
+  ScrobblerCache cache(QStringLiteral("scrobblercache_test.json"), &metrics_, nullptr);
+  ASSERT_EQ(1, cache.Count());
+  EXPECT_EQ(QStringLiteral("Title 2"), cache.List()[0]->metadata.title);
+
+  cache.Remove(cache.List()[0]);
+  cache.WriteCache();
+  EXPECT_FALSE(QFile::exists(filename_));
+  EXPECT_FALSE(QFile::exists(journal_filename_));
+
+}
+
+}  // namespace
@@ -0,0 +1,287 @@
+/*
+ * Strawberry Music Player
+ *
+ * Strawberry is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 3 of the License, or
+ * (at your option) any later version.
+ *
+ * Strawberry is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with Strawberry.  If not, see <http://www.gnu.org/licenses/>.
+ *
+ */
+
+// Benchmarks for the tag reader backends, run over a corpus generated from the test audio files.
+// Every sample is copied STRAWBERRY_BENCHMARK_TAGREADER_FILES times (default 200), tagged and given an embedded cover.
+// ReadFile, LoadEmbeddedArt and SaveFile are timed for each backend and format, as files per second and heap allocations per file.
+// Each result is recorded as a test property named <backend>_<format>_<operation>_files_per_sec or _allocs_per_file,
+// so --gtest_output=json:<file> writes them in a machine-readable form.
+
+#include "config.h"
+
+#include <atomic>
+#include <cstdlib>
+#include <memory>
+#include <new>
+#include <utility>
+
+#include <gtest/gtest.h>
+
+#include <QtGlobal>
+#include <QBuffer>
+#include <QByteArray>
+#include <QColor>
+#include <QElapsedTimer>
+#include <QFile>
+#include <QImage>
+#include <QList>
+#include <QString>
+#include <QStringList>
+#include <QTemporaryDir>
+
+#include "core/logging.h"
+#include "core/song.h"
+#include "tagreaderbase.h"
+#if defined(USE_TAGLIB)
+#  include "tagreadertaglib.h"
+#endif
+#if defined(USE_TAGPARSER)
+#  include "tagreadertagparser.h"
+#endif
+#include "tagreadermessages.pb.h"
+
+// clazy:excludeall=non-pod-global-static,returning-void-expression
+
+namespace {
+std::atomic<quint64> allocations(0);
+}  // namespace
+
+// Count all heap allocations made by this executable.
+void *operator new(std::size_t size) {
+  allocations.fetch_add(1, std::memory_order_relaxed);
+  if (void *p = std::malloc(size == 0 ? 1 : size)) return p;
+  throw std::bad_alloc();
+}
+
+void *operator new[](std::size_t size) {
+  allocations.fetch_add(1, std::memory_order_relaxed);
+  if (void *p = std::malloc(size == 0 ? 1 : size)) return p;
+  throw std::bad_alloc();
+}
+
+void operator delete(void *p) noexcept { std::free(p); }
+void operator delete[](void *p) noexcept { std::free(p); }
+void operator delete(void *p, std::size_t) noexcept { std::free(p); }
+void operator delete[](void *p, std::size_t) noexcept { std::free(p); }
+
+namespace {
+
+constexpr int kCoverSize = 500;
+
+struct Format {
+  QString name;
+  QString resource;
+};
+
+QList<Format> Formats() {
+
+  return QList<Format>() << Format{ QStringLiteral("WAV"), QStringLiteral(":/audio/strawberry.wav") }
+                         << Format{ QStringLiteral("FLAC"), QStringLiteral(":/audio/strawberry.flac") }
+                         << Format{ QStringLiteral("WavPack"), QStringLiteral(":/audio/strawberry.wv") }
+                         << Format{ QStringLiteral("OggFLAC"), QStringLiteral(":/audio/strawberry.oga") }
+                         << Format{ QStringLiteral("OggVorbis"), QStringLiteral(":/audio/strawberry.ogg") }
+                         << Format{ QStringLiteral("OggOpus"), QStringLiteral(":/audio/strawberry.opus") }
+                         << Format{ QStringLiteral("OggSpeex"), QStringLiteral(":/audio/strawberry.spx") }
+                         << Format{ QStringLiteral("AIFF"), QStringLiteral(":/audio/strawberry.aif") }
+                         << Format{ QStringLiteral("ASF"), QStringLiteral(":/audio/strawberry.asf") }
+                         << Format{ QStringLiteral("MPEG"), QStringLiteral(":/audio/strawberry.mp3") }
+                         << Format{ QStringLiteral("MP4"), QStringLiteral(":/audio/strawberry.m4a") };
+
+}
+
+int CorpusFilesPerFormat() {
+
+  bool ok = false;
+  const int count = qEnvironmentVariableIntValue("STRAWBERRY_BENCHMARK_TAGREADER_FILES", &ok);
+  return ok && count > 0 ? count : 200;
+
+}
+
+QList<std::pair<QString, std::shared_ptr<TagReaderBase>>> Backends() {
+
+  QList<std::pair<QString, std::shared_ptr<TagReaderBase>>> backends;
+#if defined(USE_TAGLIB)
+  backends << std::make_pair(QStringLiteral("TagLib"), std::shared_ptr<TagReaderBase>(new TagReaderTagLib));
+#endif
+#if defined(USE_TAGPARSER)
+  backends << std::make_pair(QStringLiteral("TagParser"), std::shared_ptr<TagReaderBase>(new TagReaderTagParser));
+#endif
+  return backends;
+
+}
+
+QByteArray CoverData() {
+
+  QImage image(kCoverSize, kCoverSize, QImage::Format_RGB32);
+  for (int y = 0; y < kCoverSize; ++y) {
+    for (int x = 0; x < kCoverSize; ++x) {
+      image.setPixel(x, y, qRgb(x % 256, y % 256, (x * y) % 256));
+    }
+  }
+
+  QByteArray data;
+  QBuffer buffer(&data);
+  buffer.open(QIODevice::WriteOnly);
+  image.save(&buffer, "JPEG");
+  return data;
+
+}
+
+spb::tagreader::SaveFileRequest SaveFileRequest(const QString &filename, const int i, const QByteArray &cover_data) {
+
+  Song song;
+  song.set_title(QStringLiteral("Title %1").arg(i));
+  song.set_artist(QStringLiteral("Artist %1").arg(i / 100));
+  song.set_album(QStringLiteral("Album %1").arg(i / 10));
+  song.set_albumartist(QStringLiteral("Album artist %1").arg(i / 100));
+  song.set_genre(QStringLiteral("Rock"));
+  song.set_track(i % 10 + 1);
+  song.set_disc(1);
+  song.set_year(2000 + i % 25);
+  song.set_lyrics(QStringLiteral("Lyrics %1").arg(i).repeated(50));
+
+  spb::tagreader::SaveFileRequest request;
+  const QByteArray filename_data = filename.toUtf8();
+  request.set_filename(filename_data.constData(), filename_data.length());
+  request.set_save_tags(true);
+  if (!cover_data.isEmpty()) {
+    request.set_save_cover(true);
+    request.set_cover_data(cover_data.constData(), cover_data.size());
+    request.set_cover_mime_type("image/jpeg");
+  }
+  song.ToProtobuf(request.mutable_metadata());
+
+  return request;
+
+}
+
+class TagReaderBenchmark : public ::testing::Test {
+ protected:
+  static void SetUpTestSuite() {
+
+    corpus_dir_ = new QTemporaryDir;
+    corpus_ = new QList<QStringList>;
+    ASSERT_TRUE(corpus_dir_->isValid());
+
+    const QList<std::pair<QString, std::shared_ptr<TagReaderBase>>> backends = Backends();
+    ASSERT_FALSE(backends.isEmpty());
+    const std::shared_ptr<TagReaderBase> writer = backends.first().second;
+
+    const QByteArray cover_data = CoverData();
+    const int count = CorpusFilesPerFormat();
+    for (const Format &format : Formats()) {
+      QFile resource(format.resource);
+      ASSERT_TRUE(resource.open(QIODevice::ReadOnly));
+      const QByteArray data = resource.readAll();
+      resource.close();
+      const QString suffix = format.resource.mid(format.resource.lastIndexOf(QLatin1Char('.')));
+      QStringList filenames;
+      for (int i = 0; i < count; ++i) {
+        const QString filename = corpus_dir_->filePath(format.name + QString::number(i) + suffix);
+        QFile file(filename);
+        ASSERT_TRUE(file.open(QIODevice::WriteOnly));
+        file.write(data);
+        file.close();
+        writer->SaveFile(SaveFileRequest(filename, i, cover_data));
+        filenames << filename;
+      }
+      *corpus_ << filenames;
+    }
+
+  }
+
+  static void TearDownTestSuite() {
+    delete corpus_;
+    corpus_ = nullptr;
+    delete corpus_dir_;
+    corpus_dir_ = nullptr;
+  }
+
+  void Record(const QString &backend, const QString &format, const QString &operation, const int files, const qint64 nsec, const quint64 allocs) {
+    const int files_per_sec = nsec > 0 ? static_cast<int>(static_cast<double>(files) * 1e9 / static_cast<double>(nsec)) : 0;
+    const int allocs_per_file = files > 0 ? static_cast<int>(allocs / static_cast<quint64>(files)) : 0;
+    qLog(Info) << backend << format << operation << files_per_sec << "files/s" << allocs_per_file << "allocations/file";
+    const QString name = QStringLiteral("%1_%2_%3").arg(backend, format, operation);
+    RecordProperty(QStringLiteral("%1_files_per_sec").arg(name).toStdString(), files_per_sec);
+    RecordProperty(QStringLiteral("%1_allocs_per_file").arg(name).toStdString(), allocs_per_file);
+  }
+
+  // Runs the operation on every file of every format with every backend.
+  template<typename Function>
+  void Run(const QString &operation, Function function) {
+    const QList<Format> formats = Formats();
+    const QList<std::pair<QString, std::shared_ptr<TagReaderBase>>> backends = Backends();
+    for (const std::pair<QString, std::shared_ptr<TagReaderBase>> &backend : backends) {
+      for (int i = 0; i < formats.count(); ++i) {
+        const QStringList &filenames = (*corpus_)[i];
+        QElapsedTimer timer;
+        const quint64 allocations_start = allocations.load();
+        timer.start();
+        for (int j = 0; j < filenames.count(); ++j) {
+          function(backend.second.get(), filenames[j], j);
+        }
+        const qint64 nsec = timer.nsecsElapsed();
+        Record(backend.first, formats[i].name, operation, static_cast<int>(filenames.count()), nsec, allocations.load() - allocations_start);
+      }
+    }
+  }
+
+  static QTemporaryDir *corpus_dir_;
+  // Generated filenames, one list per format in the same order as Formats().
+  static QList<QStringList> *corpus_;
+};
+
+QTemporaryDir *TagReaderBenchmark::corpus_dir_ = nullptr;
+QList<QStringList> *TagReaderBenchmark::corpus_ = nullptr;
+
+TEST_F(TagReaderBenchmark, ReadFile) {
+
+  Run(QStringLiteral("ReadFile"), [](TagReaderBase *reader, const QString &filename, const int) {
+    spb::tagreader::SongMetadata metadata;
+    reader->ReadFile(filename, &metadata);
+  });
+
+}
+
+TEST_F(TagReaderBenchmark, ReadFileFast) {
+
+  Run(QStringLiteral("ReadFileFast"), [](TagReaderBase *reader, const QString &filename, const int) {
+    spb::tagreader::SongMetadata metadata;
+    reader->ReadFile(filename, &metadata, spb::tagreader::ReadFileRequest::FAST);
+  });
+
+}
+
+TEST_F(TagReaderBenchmark, LoadEmbeddedArt) {
+
+  Run(QStringLiteral("LoadEmbeddedArt"), [](TagReaderBase *reader, const QString &filename, const int) {
+    reader->LoadEmbeddedArt(filename);
+  });
+
+}
+
+TEST_F(TagReaderBenchmark, SaveFile) {
+
+  // Writes the tags without the cover, like editing tags does.
+  Run(QStringLiteral("SaveFile"), [](TagReaderBase *reader, const QString &filename, const int i) {
+    reader->SaveFile(SaveFileRequest(filename, i + 1, QByteArray()));
+  });
+
+}
+
+}  // namespace
@@ -24,6 +24,10 @@
 #include <QByteArray>
 #include <QString>
 #include <QDateTime>
+#include <QDir>
+#include <QTemporaryFile>
+#include <QImage>
+#include <QColor>
 #include <QtDebug>
 
 #include "test_utils.h"
@@ -33,7 +37,10 @@
 #include "utilities/randutils.h"
 #include "utilities/cryptutils.h"
 #include "utilities/colorutils.h"
+#include "utilities/fileutils.h"
+#include "utilities/mimeutils.h"
 #include "utilities/transliterate.h"
+#include "utilities/imageutils.h"
 #include "core/logging.h"
 
 TEST(UtilitiesTest, PrettyTimeDelta) {
@@ -244,3 +251,71 @@ TEST(UtilitiesTest, ReplaceMessage) {
   ASSERT_EQ(Utilities::ReplaceMessage(QStringLiteral("%title% - %artist%"), song, QLatin1String("")), song.title() + QStringLiteral(" - ") + song.artist());
 
 }
+
+TEST(UtilitiesTest, FileContentHash) {
+
+  QTemporaryFile file;
+  ASSERT_TRUE(file.open());
+  file.write(QByteArray(200000, 'a'));
+  file.flush();
+
+  const QString hash = Utilities::FileContentHash(file.fileName());
+  ASSERT_TRUE(hash.startsWith(QStringLiteral("200000:")));
+  ASSERT_EQ(Utilities::FileContentHash(file.fileName()), hash);
+
+  // Changing the middle of the file is not detected, changing the beginning is.
+  file.seek(100000);
+  file.write("b");
+  file.flush();
+  ASSERT_EQ(Utilities::FileContentHash(file.fileName()), hash);
+
+  file.seek(0);
+  file.write("b");
+  file.flush();
+  ASSERT_NE(Utilities::FileContentHash(file.fileName()), hash);
+
+}
+
+TEST(UtilitiesTest, GuessMediaFile) {
+
+  QTemporaryFile flac_file(QDir::tempPath() + QStringLiteral("/XXXXXX.flac"));
+  ASSERT_TRUE(flac_file.open());
+  flac_file.write("fLaC");
+  flac_file.flush();
+  ASSERT_EQ(Utilities::GuessMediaFile(flac_file.fileName()), Utilities::MediaFileGuess::MediaFile);
+
+  QTemporaryFile unknown_file(QDir::tempPath() + QStringLiteral("/XXXXXX.flac"));
+  ASSERT_TRUE(unknown_file.open());
+  unknown_file.write("not a flac file");
+  unknown_file.flush();
+  ASSERT_EQ(Utilities::GuessMediaFile(unknown_file.fileName()), Utilities::MediaFileGuess::Unknown);
+
+  ASSERT_EQ(Utilities::GuessMediaFile(QStringLiteral("/music/album/notes.txt")), Utilities::MediaFileGuess::NotMediaFile);
+  ASSERT_EQ(Utilities::GuessMediaFile(QStringLiteral("/music/album/track.xyz")), Utilities::MediaFileGuess::Unknown);
+
+}
+
+TEST(UtilitiesTest, SmoothScaleImage) {
+
+  // Columns alternating between black and white are averaged to grey by the box filter.
+  QImage image(400, 300, QImage::Format_RGB32);
+  for (int x = 0; x < image.width(); ++x) {
+    for (int y = 0; y < image.height(); ++y) {
+      image.setPixel(x, y, x % 2 == 0 ? qRgb(0, 0, 0) : qRgb(255, 255, 255));
+    }
+  }
+
+  const QImage image_quarter = ImageUtils::SmoothScaleImage(image, QSize(100, 75));
+  ASSERT_EQ(image_quarter.size(), QSize(100, 75));
+  ASSERT_EQ(qRed(image_quarter.pixel(50, 30)), 128);
+
+  const QImage image_scaled = ImageUtils::SmoothScaleImage(image, QSize(70, 50));
+  ASSERT_EQ(image_scaled.size(), QSize(70, 50));
+  ASSERT_NEAR(qRed(image_scaled.pixel(35, 25)), 128, 2);
+
+  const QImage image_padded = ImageUtils::ScaleImage(image, QSize(50, 50), 2.0, true);
+  ASSERT_EQ(image_padded.size(), QSize(100, 100));
+  ASSERT_EQ(qAlpha(image_padded.pixel(50, 5)), 0);
+  ASSERT_EQ(qAlpha(image_padded.pixel(50, 50)), 255);
+
+}